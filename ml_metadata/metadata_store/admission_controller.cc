@@ -0,0 +1,154 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/admission_controller.h"
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ml_metadata {
+namespace {
+
+// Returns true if the calls of `method` list or traverse the nodes, and cost
+// `heavy_method_cost` by default.
+bool IsHeavyMethod(absl::string_view method) {
+  static const auto* const kHeavyMethods =
+      new absl::flat_hash_set<absl::string_view>({
+          "GetArtifacts",
+          "GetExecutions",
+          "GetContexts",
+          "GetArtifactsByType",
+          "GetExecutionsByType",
+          "GetContextsByType",
+          "GetArtifactsByContext",
+          "GetExecutionsByContext",
+          "GetAncestorContexts",
+          "GetDescendantContexts",
+          "GetLineageGraph",
+          "GetArtifactsByDerivation",
+          "GetChanges",
+          "CountArtifacts",
+          "CountExecutions",
+          "CountContexts",
+          "StreamArtifacts",
+          "StreamExecutions",
+          "StreamArtifactsByType",
+          "StreamLineageGraph",
+          "StreamChanges",
+      });
+  return kHeavyMethods->contains(method);
+}
+
+// Returns true if a call of `cost` fits in the `limit` of a cost in flight
+// `in_flight`. A non-positive limit is unlimited.
+bool Fits(const int64 in_flight, const int64 cost, const int64 limit) {
+  return limit <= 0 || in_flight == 0 || in_flight + cost <= limit;
+}
+
+// Returns the value of `key` in `map`, or 0 if it is absent.
+template <typename Map>
+int64 FindOrZero(const Map& map, absl::string_view key) {
+  const auto it = map.find(std::string(key));
+  return it == map.end() ? 0 : it->second;
+}
+
+// Subtracts `cost` from the cost of `key` in `cost_by_key`, and removes the
+// entry once it drops to 0.
+void Subtract(const std::string& key, const int64 cost,
+              absl::flat_hash_map<std::string, int64>* cost_by_key) {
+  auto it = cost_by_key->find(key);
+  if (it == cost_by_key->end()) return;
+  it->second -= cost;
+  if (it->second <= 0) {
+    cost_by_key->erase(it);
+  }
+}
+
+}  // namespace
+
+void AdmissionController::Ticket::Release() {
+  if (controller_ == nullptr) return;
+  controller_->Release(*this);
+  controller_ = nullptr;
+}
+
+AdmissionController::AdmissionController(const AdmissionControlConfig& config)
+    : config_(config) {}
+
+int64 AdmissionController::Cost(absl::string_view method) const {
+  const auto it = config_.method_costs().find(std::string(method));
+  if (it != config_.method_costs().end()) {
+    return it->second;
+  }
+  return IsHeavyMethod(method) ? config_.heavy_method_cost() : 1;
+}
+
+absl::Status AdmissionController::Admit(absl::string_view method,
+                                        absl::string_view client,
+                                        Ticket* ticket) {
+  if (ticket->controller_ != nullptr) {
+    return absl::FailedPreconditionError("The ticket is already in use.");
+  }
+  const int64 cost = Cost(method);
+  absl::MutexLock lock(&mu_);
+  if (!Fits(cost_in_flight_, cost, config_.max_cost())) {
+    return absl::ResourceExhaustedError(
+        absl::StrCat("The server is overloaded; ", method,
+                     " is rejected. Retry with backoff."));
+  }
+  const auto method_limit =
+      config_.max_cost_per_method().find(std::string(method));
+  if (method_limit != config_.max_cost_per_method().end() &&
+      !Fits(FindOrZero(cost_by_method_, method), cost,
+            method_limit->second)) {
+    return absl::ResourceExhaustedError(
+        absl::StrCat("Too many ", method,
+                     " calls are in flight. Retry with backoff."));
+  }
+  if (!Fits(FindOrZero(cost_by_client_, client), cost,
+            config_.max_cost_per_client())) {
+    return absl::ResourceExhaustedError(
+        absl::StrCat("Too many calls of the client ", client,
+                     " are in flight; ", method,
+                     " is rejected. Retry with backoff."));
+  }
+  cost_in_flight_ += cost;
+  cost_by_method_[std::string(method)] += cost;
+  cost_by_client_[std::string(client)] += cost;
+  ticket->controller_ = this;
+  ticket->method_ = std::string(method);
+  ticket->client_ = std::string(client);
+  ticket->cost_ = cost;
+  return absl::OkStatus();
+}
+
+int64 AdmissionController::cost_in_flight() const {
+  absl::MutexLock lock(&mu_);
+  return cost_in_flight_;
+}
+
+void AdmissionController::Release(const Ticket& ticket) {
+  absl::MutexLock lock(&mu_);
+  cost_in_flight_ -= ticket.cost_;
+  Subtract(ticket.method_, ticket.cost_, &cost_by_method_);
+  Subtract(ticket.client_, ticket.cost_, &cost_by_client_);
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,105 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_ADMISSION_CONTROLLER_H_
+#define ML_METADATA_METADATA_STORE_ADMISSION_CONTROLLER_H_
+
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// Admits the calls of a server while the total cost of the calls in flight,
+// and their cost by method and by client, are within the limits of `config`,
+// and rejects the others at once with RESOURCE_EXHAUSTED, instead of queueing
+// them for a connection. A call is admitted if no other call is in flight
+// for a limit, even if it costs more than the limit. It is thread-safe.
+//
+// Usage example:
+//
+//    AdmissionController controller(config);
+//    AdmissionController::Ticket ticket;
+//    MLMD_RETURN_IF_ERROR(
+//        controller.Admit("GetArtifacts", client_id, &ticket));
+//    // the call is in flight until `ticket` is destroyed.
+class AdmissionController {
+ public:
+  using AdmissionControlConfig =
+      MetadataStoreServerConfig::AdmissionControlConfig;
+
+  // The admission of a call, which is released once destroyed.
+  class Ticket {
+   public:
+    Ticket() = default;
+    ~Ticket() { Release(); }
+
+    // Disallows copy.
+    Ticket(const Ticket&) = delete;
+    Ticket& operator=(const Ticket&) = delete;
+
+    // Releases the admission, if any, e.g., before the call returns.
+    void Release();
+
+   private:
+    friend class AdmissionController;
+
+    AdmissionController* controller_ = nullptr;
+    std::string method_;
+    std::string client_;
+    int64 cost_ = 0;
+  };
+
+  explicit AdmissionController(const AdmissionControlConfig& config);
+
+  // Disallows copy.
+  AdmissionController(const AdmissionController&) = delete;
+  AdmissionController& operator=(const AdmissionController&) = delete;
+
+  // Admits a call of `method` by `client`, which stays in flight until
+  // `ticket` is released.
+  // Returns RESOURCE_EXHAUSTED error, if the call exceeds a limit.
+  // Returns FAILED_PRECONDITION error, if `ticket` is already in use.
+  absl::Status Admit(absl::string_view method, absl::string_view client,
+                     Ticket* ticket);
+
+  // Returns the cost of a call of `method`.
+  int64 Cost(absl::string_view method) const;
+
+  // Returns the total cost of the calls in flight.
+  int64 cost_in_flight() const;
+
+ private:
+  // Releases the call of `ticket`.
+  void Release(const Ticket& ticket);
+
+  const AdmissionControlConfig config_;
+
+  mutable absl::Mutex mu_;
+  int64 cost_in_flight_ ABSL_GUARDED_BY(mu_) = 0;
+  // The cost in flight by method and by client. The entries are removed once
+  // their cost drops to 0.
+  absl::flat_hash_map<std::string, int64> cost_by_method_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, int64> cost_by_client_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_ADMISSION_CONTROLLER_H_
@@ -0,0 +1,90 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/admission_controller.h"
+
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using testing::ParseTextProtoOrDie;
+
+TEST(AdmissionControllerTest, CostsHeavyMethodsMore) {
+  AdmissionController controller(
+      ParseTextProtoOrDie<AdmissionController::AdmissionControlConfig>(R"pb(
+        heavy_method_cost: 5
+        method_costs { key: 'GetArtifactsByID' value: 2 }
+      )pb"));
+  EXPECT_EQ(controller.Cost("GetArtifacts"), 5);
+  EXPECT_EQ(controller.Cost("GetLineageGraph"), 5);
+  EXPECT_EQ(controller.Cost("GetArtifactsByID"), 2);
+  EXPECT_EQ(controller.Cost("PutArtifacts"), 1);
+}
+
+TEST(AdmissionControllerTest, RejectsCallsOverClientLimit) {
+  AdmissionController controller(
+      ParseTextProtoOrDie<AdmissionController::AdmissionControlConfig>(R"pb(
+        max_cost: 100 max_cost_per_client: 10 heavy_method_cost: 4
+      )pb"));
+  AdmissionController::Ticket tickets[3];
+  ASSERT_EQ(absl::OkStatus(),
+            controller.Admit("GetArtifacts", "notebook", &tickets[0]));
+  ASSERT_EQ(absl::OkStatus(),
+            controller.Admit("GetArtifacts", "notebook", &tickets[1]));
+  EXPECT_TRUE(absl::IsResourceExhausted(
+      controller.Admit("GetArtifacts", "notebook", &tickets[2])));
+  // The light calls and the other clients are still admitted.
+  ASSERT_EQ(absl::OkStatus(),
+            controller.Admit("GetArtifactType", "notebook", &tickets[2]));
+  AdmissionController::Ticket pipeline_ticket;
+  EXPECT_EQ(absl::OkStatus(),
+            controller.Admit("GetArtifacts", "pipeline", &pipeline_ticket));
+  EXPECT_EQ(controller.cost_in_flight(), 13);
+
+  tickets[0].Release();
+  EXPECT_EQ(controller.cost_in_flight(), 9);
+  AdmissionController::Ticket ticket;
+  EXPECT_EQ(absl::OkStatus(),
+            controller.Admit("GetArtifacts", "notebook", &ticket));
+}
+
+TEST(AdmissionControllerTest, RejectsCallsOverMethodAndTotalLimits) {
+  AdmissionController controller(
+      ParseTextProtoOrDie<AdmissionController::AdmissionControlConfig>(R"pb(
+        max_cost: 3
+        max_cost_per_client: 0
+        max_cost_per_method { key: 'GetLineageGraph' value: 1 }
+        method_costs { key: 'GetLineageGraph' value: 2 }
+      )pb"));
+  // A call costing more than a limit is admitted if nothing is in flight.
+  AdmissionController::Ticket lineage_ticket;
+  ASSERT_EQ(absl::OkStatus(),
+            controller.Admit("GetLineageGraph", "a", &lineage_ticket));
+  AdmissionController::Ticket ticket;
+  EXPECT_TRUE(absl::IsResourceExhausted(
+      controller.Admit("GetLineageGraph", "b", &ticket)));
+  ASSERT_EQ(absl::OkStatus(), controller.Admit("PutEvents", "b", &ticket));
+  AdmissionController::Ticket another_ticket;
+  EXPECT_TRUE(absl::IsResourceExhausted(
+      controller.Admit("PutEvents", "c", &another_ticket)));
+  EXPECT_TRUE(absl::IsFailedPrecondition(
+      controller.Admit("PutEvents", "c", &ticket)));
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -0,0 +1,166 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/batch_id_reference.h"
+
+#include <string>
+#include <vector>
+
+#include "google/protobuf/descriptor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::google::protobuf::FieldDescriptor;
+using ::google::protobuf::Message;
+using ::google::protobuf::Reflection;
+
+// A field of a path, with the index of its element if it is repeated.
+struct PathSegment {
+  const FieldDescriptor* field = nullptr;
+  int index = -1;
+};
+
+// Resolves the `path` from the messages of `descriptor` to its `segments`.
+// Returns INVALID_ARGUMENT error, if the path is malformed, or does not name
+// an int64 field.
+absl::Status ParsePath(const google::protobuf::Descriptor* descriptor,
+                       const absl::string_view path,
+                       std::vector<PathSegment>* segments) {
+  const auto invalid_path = [root = descriptor,
+                              path](absl::string_view reason) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Invalid id path `", path, "` of ", root->name(), ": ", reason));
+  };
+  segments->clear();
+  const std::vector<absl::string_view> parts = absl::StrSplit(path, '.');
+  for (int i = 0; i < parts.size(); i++) {
+    absl::string_view name = parts[i];
+    PathSegment segment;
+    const size_t bracket = name.find('[');
+    if (bracket != absl::string_view::npos) {
+      if (name.back() != ']' ||
+          !absl::SimpleAtoi(
+              name.substr(bracket + 1, name.size() - bracket - 2),
+              &segment.index) ||
+          segment.index < 0) {
+        return invalid_path(absl::StrCat("malformed index in ", name));
+      }
+      name = name.substr(0, bracket);
+    }
+    if (descriptor == nullptr) {
+      return invalid_path(absl::StrCat(parts[i - 1], " is not a message"));
+    }
+    segment.field = descriptor->FindFieldByName(std::string(name));
+    if (segment.field == nullptr) {
+      return invalid_path(absl::StrCat("no field ", name));
+    }
+    if (segment.field->is_repeated() != (segment.index >= 0)) {
+      return invalid_path(
+          absl::StrCat(name, segment.field->is_repeated()
+                                 ? " is repeated and needs an index"
+                                 : " is not repeated"));
+    }
+    descriptor = segment.field->message_type();
+    segments->push_back(segment);
+  }
+  if (segments->back().field->cpp_type() != FieldDescriptor::CPPTYPE_INT64) {
+    return invalid_path(
+        absl::StrCat(segments->back().field->name(), " is not an int64"));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status GetIdAtPath(const Message& message, const absl::string_view path,
+                         int64* id) {
+  std::vector<PathSegment> segments;
+  MLMD_RETURN_IF_ERROR(ParsePath(message.GetDescriptor(), path, &segments));
+  const Message* current = &message;
+  for (const PathSegment& segment : segments) {
+    const Reflection* reflection = current->GetReflection();
+    if (segment.field->is_repeated()
+            ? segment.index >= reflection->FieldSize(*current, segment.field)
+            : !reflection->HasField(*current, segment.field)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("The id path `", path, "` of ",
+                       message.GetDescriptor()->name(), " is not set"));
+    }
+    if (segment.field->cpp_type() == FieldDescriptor::CPPTYPE_INT64) {
+      *id = segment.field->is_repeated()
+                ? reflection->GetRepeatedInt64(*current, segment.field,
+                                               segment.index)
+                : reflection->GetInt64(*current, segment.field);
+      return absl::OkStatus();
+    }
+    current = segment.field->is_repeated()
+                  ? &reflection->GetRepeatedMessage(*current, segment.field,
+                                                    segment.index)
+                  : &reflection->GetMessage(*current, segment.field);
+  }
+  return absl::InternalError("The id path is not resolved");
+}
+
+absl::Status SetIdAtPath(const absl::string_view path, const int64 id,
+                         Message* message) {
+  std::vector<PathSegment> segments;
+  MLMD_RETURN_IF_ERROR(ParsePath(message->GetDescriptor(), path, &segments));
+  Message* current = message;
+  for (const PathSegment& segment : segments) {
+    const Reflection* reflection = current->GetReflection();
+    const bool adds_element =
+        segment.field->is_repeated() &&
+        segment.index == reflection->FieldSize(*current, segment.field);
+    if (segment.field->is_repeated() && !adds_element &&
+        segment.index > reflection->FieldSize(*current, segment.field)) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "The id path `", path, "` of ", message->GetDescriptor()->name(),
+          " is past the last element of ", segment.field->name()));
+    }
+    if (segment.field->cpp_type() == FieldDescriptor::CPPTYPE_INT64) {
+      if (adds_element) {
+        reflection->AddInt64(current, segment.field, id);
+      } else if (segment.field->is_repeated()) {
+        reflection->SetRepeatedInt64(current, segment.field, segment.index,
+                                     id);
+      } else {
+        reflection->SetInt64(current, segment.field, id);
+      }
+      return absl::OkStatus();
+    }
+    if (adds_element) {
+      current = reflection->AddMessage(current, segment.field);
+    } else if (segment.field->is_repeated()) {
+      current = reflection->MutableRepeatedMessage(current, segment.field,
+                                                   segment.index);
+    } else {
+      current = reflection->MutableMessage(current, segment.field);
+    }
+  }
+  return absl::InternalError("The id path is not resolved");
+}
+
+absl::Status ApplyIdReference(const BatchRequest::Call::IdReference& reference,
+                              const Message& response, Message* request) {
+  int64 id;
+  MLMD_RETURN_IF_ERROR(GetIdAtPath(response, reference.response_path(), &id));
+  return SetIdAtPath(reference.request_path(), id, request);
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,54 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_BATCH_ID_REFERENCE_H_
+#define ML_METADATA_METADATA_STORE_BATCH_ID_REFERENCE_H_
+
+#include "google/protobuf/message.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+
+// Utilities to resolve the id references of the calls of a BatchRequest, whose
+// paths name an int64 field of a message, e.g., `attributions[0].artifact_id`.
+// See BatchRequest.Call.IdReference for the syntax of the paths.
+
+// Reads the id at `path` in `message` to `id`.
+// Returns INVALID_ARGUMENT error, if the path is malformed, does not name an
+// int64 field of the message, or names an element or a field that is not set.
+absl::Status GetIdAtPath(const google::protobuf::Message& message,
+                         absl::string_view path, int64* id);
+
+// Sets the field at `path` in `message` to `id`, adding the element of a
+// repeated field one past its last.
+// Returns INVALID_ARGUMENT error, if the path is malformed, does not name an
+// int64 field of the message, or names an element further past the last.
+absl::Status SetIdAtPath(absl::string_view path, int64 id,
+                         google::protobuf::Message* message);
+
+// Copies the id at the response_path of `reference` in the `response` of the
+// referenced call to its request_path in the `request` of the referencing
+// call.
+// Returns INVALID_ARGUMENT error, if either path cannot be resolved.
+absl::Status ApplyIdReference(
+    const BatchRequest::Call::IdReference& reference,
+    const google::protobuf::Message& response,
+    google::protobuf::Message* request);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_BATCH_ID_REFERENCE_H_
@@ -0,0 +1,101 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/batch_id_reference.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+namespace testing {
+namespace {
+
+TEST(BatchIdReferenceTest, GetIdAtPath) {
+  const PutExecutionResponse response =
+      ParseTextProtoOrDie<PutExecutionResponse>(R"(
+        execution_id: 3 artifact_ids: 5 artifact_ids: 7 context_ids: 11
+      )");
+  int64 id = 0;
+  ASSERT_EQ(absl::OkStatus(), GetIdAtPath(response, "execution_id", &id));
+  EXPECT_EQ(id, 3);
+  ASSERT_EQ(absl::OkStatus(), GetIdAtPath(response, "artifact_ids[1]", &id));
+  EXPECT_EQ(id, 7);
+
+  const GetArtifactsByIDResponse nested_response =
+      ParseTextProtoOrDie<GetArtifactsByIDResponse>(R"(
+        artifacts { id: 13 } artifacts { id: 17 }
+      )");
+  ASSERT_EQ(absl::OkStatus(),
+            GetIdAtPath(nested_response, "artifacts[1].id", &id));
+  EXPECT_EQ(id, 17);
+}
+
+TEST(BatchIdReferenceTest, GetIdAtInvalidPath) {
+  const PutExecutionResponse response =
+      ParseTextProtoOrDie<PutExecutionResponse>("execution_id: 3");
+  int64 id = 0;
+  EXPECT_TRUE(absl::IsInvalidArgument(GetIdAtPath(response, "", &id)));
+  EXPECT_TRUE(absl::IsInvalidArgument(GetIdAtPath(response, "no_id", &id)));
+  EXPECT_TRUE(
+      absl::IsInvalidArgument(GetIdAtPath(response, "artifact_ids", &id)));
+  EXPECT_TRUE(
+      absl::IsInvalidArgument(GetIdAtPath(response, "execution_id[0]", &id)));
+  EXPECT_TRUE(
+      absl::IsInvalidArgument(GetIdAtPath(response, "artifact_ids[x]", &id)));
+  EXPECT_TRUE(
+      absl::IsInvalidArgument(GetIdAtPath(response, "artifact_ids[0]", &id)));
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      GetIdAtPath(GetArtifactsByIDResponse(), "artifacts[0]", &id)));
+}
+
+TEST(BatchIdReferenceTest, SetIdAtPath) {
+  PutAttributionsAndAssociationsRequest request =
+      ParseTextProtoOrDie<PutAttributionsAndAssociationsRequest>(R"(
+        attributions { artifact_id: 1 }
+      )");
+  ASSERT_EQ(absl::OkStatus(),
+            SetIdAtPath("attributions[0].context_id", 2, &request));
+  ASSERT_EQ(absl::OkStatus(),
+            SetIdAtPath("associations[0].execution_id", 3, &request));
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      SetIdAtPath("associations[2].context_id", 4, &request)));
+  EXPECT_THAT(request,
+              EqualsProto(
+                  ParseTextProtoOrDie<PutAttributionsAndAssociationsRequest>(
+                      R"(
+                        attributions { artifact_id: 1 context_id: 2 }
+                        associations { execution_id: 3 }
+                      )")));
+}
+
+TEST(BatchIdReferenceTest, ApplyIdReference) {
+  const PutExecutionResponse response =
+      ParseTextProtoOrDie<PutExecutionResponse>("execution_id: 3");
+  const BatchRequest::Call::IdReference reference =
+      ParseTextProtoOrDie<BatchRequest::Call::IdReference>(R"(
+        call_index: 0
+        response_path: "execution_id"
+        request_path: "execution_ids[0]"
+      )");
+  GetExecutionsByIDRequest request;
+  ASSERT_EQ(absl::OkStatus(), ApplyIdReference(reference, response, &request));
+  EXPECT_THAT(request.execution_ids(), ::testing::ElementsAre(3));
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace ml_metadata
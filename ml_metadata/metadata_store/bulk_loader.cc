@@ -0,0 +1,342 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/bulk_loader.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+namespace {
+
+// The retries of the aborted batches, if neither the loader nor the connection
+// configures them.
+constexpr int kDefaultMaxNumRetries = 5;
+
+// Identifies an artifact by its type_id and name.
+using ArtifactKey = std::pair<int64, std::string>;
+
+// The ids of the artifacts put by the runs of a partition.
+using ArtifactIds = absl::flat_hash_map<ArtifactKey, int64>;
+
+// Returns the connection of the loader's stores, which retries the aborted
+// transactions with the retry options of `config`, or of `connection_config`.
+ConnectionConfig LoaderConnectionConfig(
+    const BulkLoadConfig& config, const ConnectionConfig& connection_config) {
+  ConnectionConfig loader_connection_config = connection_config;
+  if (config.has_transaction_retry_options()) {
+    *loader_connection_config.mutable_transaction_retry_options() =
+        config.transaction_retry_options();
+  } else if (!connection_config.has_transaction_retry_options()) {
+    loader_connection_config.mutable_transaction_retry_options()
+        ->set_max_num_retries(kDefaultMaxNumRetries);
+  }
+  return loader_connection_config;
+}
+
+// Returns a pool with a store per worker.
+MetadataStorePool::ConnectionPoolConfig LoaderPoolConfig(
+    const BulkLoadConfig& config) {
+  MetadataStorePool::ConnectionPoolConfig pool_config;
+  pool_config.set_max_size(config.num_workers());
+  return pool_config;
+}
+
+// Returns the key of the partition of `run`, i.e., its first context, or
+// an empty key if it has none.
+std::string PartitionKey(const PutExecutionRequest& run) {
+  if (run.contexts().empty()) {
+    return "";
+  }
+  const Context& context = run.contexts(0);
+  return context.has_id()
+             ? absl::StrFormat("id:%d", context.id())
+             : absl::StrFormat("%d:%s", context.type_id(), context.name());
+}
+
+// Splits the indices of `runs` into `num_partitions` partitions. The runs of
+// a partition key are kept in order in the same partition; each new key and
+// each run without key go to the smallest partition.
+std::vector<std::vector<int>> PartitionRuns(
+    absl::Span<const PutExecutionRequest> runs, const int num_partitions) {
+  std::vector<std::vector<int>> partitions(num_partitions);
+  absl::flat_hash_map<std::string, int> partition_of_key;
+  for (int i = 0; i < runs.size(); i++) {
+    const std::string key = PartitionKey(runs[i]);
+    auto it = partition_of_key.find(key);
+    int partition;
+    if (!key.empty() && it != partition_of_key.end()) {
+      partition = it->second;
+    } else {
+      partition =
+          std::min_element(partitions.begin(), partitions.end(),
+                           [](const std::vector<int>& a,
+                              const std::vector<int>& b) {
+                             return a.size() < b.size();
+                           }) -
+          partitions.begin();
+      if (!key.empty()) {
+        partition_of_key.insert({key, partition});
+      }
+    }
+    partitions[partition].push_back(i);
+  }
+  return partitions;
+}
+
+// Returns the id of the artifact with `key` in `batch_artifact_ids` or
+// `artifact_ids`, or -1 if it is not put yet.
+int64 FindArtifactId(const ArtifactKey& key, const ArtifactIds& artifact_ids,
+                     const ArtifactIds& batch_artifact_ids) {
+  for (const ArtifactIds* ids : {&batch_artifact_ids, &artifact_ids}) {
+    auto it = ids->find(key);
+    if (it != ids->end()) {
+      return it->second;
+    }
+  }
+  return -1;
+}
+
+// Puts `run` with `store`. The artifacts of `run` put by the earlier runs,
+// i.e., in `artifact_ids` or `batch_artifact_ids`, refer to the stored ones,
+// and the new artifacts are added to `batch_artifact_ids`.
+absl::Status PutRun(const PutExecutionRequest& run,
+                    const ArtifactIds& artifact_ids, MetadataStore* store,
+                    ArtifactIds* batch_artifact_ids,
+                    PutExecutionResponse* response) {
+  PutExecutionRequest request = run;
+  request.mutable_options()->set_reuse_context_if_already_exist(true);
+  std::vector<int> new_artifact_pairs;
+  for (int i = 0; i < request.artifact_event_pairs_size(); i++) {
+    PutExecutionRequest::ArtifactAndEvent& pair =
+        *request.mutable_artifact_event_pairs(i);
+    if (!pair.has_artifact() || pair.artifact().has_id() ||
+        !pair.artifact().has_name()) {
+      continue;
+    }
+    const int64 artifact_id = FindArtifactId(
+        {pair.artifact().type_id(), pair.artifact().name()}, artifact_ids,
+        *batch_artifact_ids);
+    if (artifact_id == -1) {
+      new_artifact_pairs.push_back(i);
+    } else if (pair.has_event()) {
+      pair.mutable_event()->set_artifact_id(artifact_id);
+      pair.clear_artifact();
+    } else {
+      pair.mutable_artifact()->set_id(artifact_id);
+    }
+  }
+  MLMD_RETURN_IF_ERROR(store->PutExecution(request, response));
+  for (const int i : new_artifact_pairs) {
+    const Artifact& artifact = request.artifact_event_pairs(i).artifact();
+    batch_artifact_ids->insert(
+        {{artifact.type_id(), artifact.name()}, response->artifact_ids(i)});
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+struct BulkLoader::PendingLoad {
+  bool AllDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+    return num_pending == 0;
+  }
+
+  absl::Span<const PutExecutionRequest> runs;
+  std::vector<PutExecutionResponse>* responses;
+  std::vector<absl::Status>* statuses;
+
+  absl::Mutex mu;
+  int num_pending ABSL_GUARDED_BY(mu) = 0;
+};
+
+double BulkLoader::Report::runs_per_sec() const {
+  const double elapsed_sec = absl::ToDoubleSeconds(elapsed);
+  return elapsed_sec > 0 ? (num_runs_put + num_runs_failed) / elapsed_sec : 0;
+}
+
+std::string BulkLoader::Report::DebugString() const {
+  return absl::StrFormat(
+      "%d/%d runs put, %d failed, in %d batches (%d redone run by run) in %s: "
+      "%.1f runs/sec",
+      num_runs_put, num_runs, num_runs_failed, num_batches, num_batches_redone,
+      absl::FormatDuration(elapsed), runs_per_sec());
+}
+
+BulkLoader::BulkLoader(const BulkLoadConfig& config,
+                       const ConnectionConfig& connection_config)
+    : batch_size_(config.batch_size()),
+      num_workers_(config.num_workers()),
+      progress_log_interval_(
+          absl::Seconds(config.progress_log_interval_sec())),
+      pool_(LoaderConnectionConfig(config, connection_config),
+            LoaderPoolConfig(config)),
+      worker_pool_(config.num_workers(), config.num_workers()) {
+  CHECK_GT(batch_size_, 0) << "batch_size must be positive.";
+  absl::MutexLock lock(&mu_);
+  start_time_ = absl::Now();
+  last_log_time_ = start_time_;
+}
+
+absl::Status BulkLoader::Load(absl::Span<const PutExecutionRequest> runs,
+                              std::vector<PutExecutionResponse>* responses,
+                              std::vector<absl::Status>* statuses,
+                              Report* report) {
+  absl::MutexLock load_lock(&load_mu_);
+  responses->assign(runs.size(), PutExecutionResponse());
+  statuses->assign(runs.size(), absl::OkStatus());
+  {
+    absl::MutexLock lock(&mu_);
+    progress_ = Report();
+    progress_.num_runs = runs.size();
+    start_time_ = absl::Now();
+    last_log_time_ = start_time_;
+  }
+  const std::vector<std::vector<int>> partitions =
+      PartitionRuns(runs, num_workers_);
+  PendingLoad load;
+  load.runs = runs;
+  load.responses = responses;
+  load.statuses = statuses;
+  {
+    absl::MutexLock lock(&load.mu);
+    load.num_pending = absl::c_count_if(
+        partitions,
+        [](const std::vector<int>& partition) { return !partition.empty(); });
+  }
+  for (const std::vector<int>& partition : partitions) {
+    if (partition.empty()) {
+      continue;
+    }
+    const std::vector<int>* partition_ptr = &partition;
+    if (!worker_pool_.Schedule([this, partition_ptr, &load] {
+          LoadPartition(*partition_ptr, &load);
+        })) {
+      LoadPartition(partition, &load);
+    }
+  }
+  {
+    absl::MutexLock lock(&load.mu);
+    load.mu.Await(absl::Condition(&load, &PendingLoad::AllDone));
+  }
+  const Report final_progress = progress();
+  if (progress_log_interval_ > absl::ZeroDuration()) {
+    LOG(INFO) << "Bulk load done: " << final_progress.DebugString();
+  }
+  if (report != nullptr) {
+    *report = final_progress;
+  }
+  for (const absl::Status& status : *statuses) {
+    MLMD_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+BulkLoader::Report BulkLoader::progress() const {
+  absl::MutexLock lock(&mu_);
+  Report report = progress_;
+  report.elapsed = absl::Now() - start_time_;
+  return report;
+}
+
+void BulkLoader::LoadPartition(const std::vector<int>& partition,
+                               PendingLoad* load) {
+  MetadataStorePool::ScopedStore store;
+  const absl::Status acquire_status = pool_.Acquire(&store);
+  ArtifactIds artifact_ids;
+  for (int begin = 0; begin < partition.size(); begin += batch_size_) {
+    const int end = std::min<int>(begin + batch_size_, partition.size());
+    if (!acquire_status.ok()) {
+      for (int i = begin; i < end; i++) {
+        (*load->statuses)[partition[i]] = acquire_status;
+      }
+      RecordBatch(/*num_runs_put=*/0, /*num_runs_failed=*/end - begin,
+                  /*redone=*/false);
+      continue;
+    }
+    // The batch is retried if it is aborted, so it starts over from the
+    // artifacts put by the committed batches.
+    ArtifactIds batch_artifact_ids;
+    const absl::Status batch_status =
+        store->RunInTransaction([&]() -> absl::Status {
+          batch_artifact_ids.clear();
+          for (int i = begin; i < end; i++) {
+            MLMD_RETURN_IF_ERROR(PutRun(
+                load->runs[partition[i]], artifact_ids, store.get(),
+                &batch_artifact_ids, &(*load->responses)[partition[i]]));
+          }
+          return absl::OkStatus();
+        });
+    if (batch_status.ok()) {
+      artifact_ids.insert(batch_artifact_ids.begin(),
+                          batch_artifact_ids.end());
+      RecordBatch(/*num_runs_put=*/end - begin, /*num_runs_failed=*/0,
+                  /*redone=*/false);
+      continue;
+    }
+    // The failed batch is rolled back, and each run is redone in its own
+    // transaction, so that a failed run does not fail the others.
+    int num_runs_failed = 0;
+    for (int i = begin; i < end; i++) {
+      ArtifactIds run_artifact_ids;
+      absl::Status& status = (*load->statuses)[partition[i]];
+      status = PutRun(load->runs[partition[i]], artifact_ids, store.get(),
+                      &run_artifact_ids, &(*load->responses)[partition[i]]);
+      if (status.ok()) {
+        artifact_ids.insert(run_artifact_ids.begin(), run_artifact_ids.end());
+      } else {
+        num_runs_failed++;
+      }
+    }
+    RecordBatch(/*num_runs_put=*/end - begin - num_runs_failed,
+                num_runs_failed, /*redone=*/true);
+  }
+  store.Reset();
+  absl::MutexLock lock(&load->mu);
+  load->num_pending--;
+}
+
+void BulkLoader::RecordBatch(const int num_runs_put, const int num_runs_failed,
+                             const bool redone) {
+  absl::MutexLock lock(&mu_);
+  progress_.num_runs_put += num_runs_put;
+  progress_.num_runs_failed += num_runs_failed;
+  progress_.num_batches++;
+  if (redone) {
+    progress_.num_batches_redone++;
+  }
+  const absl::Time now = absl::Now();
+  if (progress_log_interval_ > absl::ZeroDuration() &&
+      now - last_log_time_ >= progress_log_interval_) {
+    last_log_time_ = now;
+    Report report = progress_;
+    report.elapsed = now - start_time_;
+    LOG(INFO) << "Bulk load progress: " << report.DebugString();
+  }
+}
+
+}  // namespace ml_metadata
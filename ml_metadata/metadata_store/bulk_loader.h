@@ -0,0 +1,136 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_BULK_LOADER_H_
+#define ML_METADATA_METADATA_STORE_BULK_LOADER_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/metadata_store/worker_pool.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+
+// Puts a large number of runs, i.e., PutExecutionRequests, e.g., to backfill
+// the historical runs of a new team. The runs are partitioned by their first
+// context, so that the runs of a pipeline are put in order by the same worker,
+// and each worker puts its partition with its own store in batches of
+// `batch_size` runs per transaction.
+//
+// A run may consume the artifacts produced by the earlier runs of its
+// partition: an artifact without id whose type_id and name match an artifact
+// put by an earlier run refers to the stored one, instead of being inserted
+// again. The contexts without id are created once and reused by the other
+// runs, as if `reuse_context_if_already_exist` were set.
+//
+// A batch aborted, e.g., by a deadlock with another worker, is retried with
+// the `transaction_retry_options`. If a batch fails otherwise, it is rolled
+// back and each of its runs is redone in its own transaction, so that a
+// failed run does not fail the others. It is thread-safe.
+//
+// Usage example:
+//
+//    BulkLoader loader(config, connection_config);
+//    std::vector<absl::Status> statuses;
+//    BulkLoader::Report report;
+//    MLMD_RETURN_IF_ERROR(
+//        loader.Load(runs, &responses, &statuses, &report));
+//    LOG(INFO) << report.DebugString();
+class BulkLoader {
+ public:
+  // The progress of a load.
+  struct Report {
+    // Returns the number of runs put or failed per second so far.
+    double runs_per_sec() const;
+
+    // Returns a human readable summary, e.g., for logging.
+    std::string DebugString() const;
+
+    // The number of runs of the load.
+    int64 num_runs = 0;
+    // The number of runs put, and the ones that failed.
+    int64 num_runs_put = 0;
+    int64 num_runs_failed = 0;
+    // The number of batches done, and the ones of them that failed and were
+    // redone run by run.
+    int64 num_batches = 0;
+    int64 num_batches_redone = 0;
+    // The time since the load started.
+    absl::Duration elapsed;
+  };
+
+  // Creates a loader connecting to `connection_config`. No store is opened
+  // until the first Load(). Check-fails if `num_workers` or `batch_size` is
+  // not positive.
+  BulkLoader(const BulkLoadConfig& config,
+             const ConnectionConfig& connection_config);
+
+  // Disallows copy.
+  BulkLoader(const BulkLoader&) = delete;
+  BulkLoader& operator=(const BulkLoader&) = delete;
+
+  // Puts `runs`, and returns once all of them are done. The runs must not
+  // carry transaction_options. `responses` and `statuses` are set to the
+  // response and the status of each run. `report` is optional, and is set to
+  // the final progress of the load. Concurrent loads run one after the other.
+  // Returns the first error of the runs, or of leasing the stores.
+  absl::Status Load(absl::Span<const PutExecutionRequest> runs,
+                    std::vector<PutExecutionResponse>* responses,
+                    std::vector<absl::Status>* statuses,
+                    Report* report = nullptr);
+
+  // Returns the progress of the ongoing load, or of the last one, e.g., to be
+  // polled by a monitoring thread.
+  Report progress() const;
+
+ private:
+  // A load in progress.
+  struct PendingLoad;
+
+  // Puts the runs of `partition`, i.e., indices of `load->runs`, in order with
+  // a store leased from `pool_`.
+  void LoadPartition(const std::vector<int>& partition, PendingLoad* load);
+
+  // Records a batch of `num_runs_put` and `num_runs_failed` runs in
+  // `progress_`, and logs the progress if it has not been logged for
+  // `progress_log_interval_`.
+  void RecordBatch(int num_runs_put, int num_runs_failed, bool redone);
+
+  const int batch_size_;
+  const int num_workers_;
+  const absl::Duration progress_log_interval_;
+  MetadataStorePool pool_;
+  WorkerPool worker_pool_;
+
+  // Serializes the loads.
+  absl::Mutex load_mu_;
+
+  mutable absl::Mutex mu_;
+  Report progress_ ABSL_GUARDED_BY(mu_);
+  absl::Time start_time_ ABSL_GUARDED_BY(mu_);
+  absl::Time last_log_time_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_BULK_LOADER_H_
@@ -0,0 +1,159 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/bulk_loader.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using testing::ParseTextProtoOrDie;
+
+class BulkLoaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const std::string filename_uri =
+        absl::StrCat(::testing::TempDir(), "/bulk_loader_test.db");
+    std::remove(filename_uri.c_str());
+    connection_config_.mutable_sqlite()->set_filename_uri(filename_uri);
+    pool_ = absl::make_unique<MetadataStorePool>(
+        connection_config_, MetadataStorePool::ConnectionPoolConfig());
+    ASSERT_EQ(absl::OkStatus(), pool_->Acquire(&store_));
+    PutTypesResponse put_types_response;
+    ASSERT_EQ(absl::OkStatus(),
+              store_->PutTypes(ParseTextProtoOrDie<PutTypesRequest>(R"pb(
+                                 artifact_types: { name: 'artifact_type' }
+                                 execution_types: { name: 'execution_type' }
+                                 context_types: { name: 'context_type' }
+                               )pb"),
+                               &put_types_response));
+    artifact_type_id_ = put_types_response.artifact_type_ids(0);
+    execution_type_id_ = put_types_response.execution_type_ids(0);
+    context_type_id_ = put_types_response.context_type_ids(0);
+  }
+
+  // Returns a run of the pipeline `pipeline`, which outputs the artifact
+  // `output` and, if given, inputs the artifact `input`.
+  PutExecutionRequest Run(const std::string& pipeline,
+                          const std::string& output,
+                          const std::string& input = "") {
+    PutExecutionRequest run;
+    run.mutable_execution()->set_type_id(execution_type_id_);
+    Context* context = run.add_contexts();
+    context->set_type_id(context_type_id_);
+    context->set_name(pipeline);
+    for (const std::string& name : {input, output}) {
+      if (name.empty()) {
+        continue;
+      }
+      PutExecutionRequest::ArtifactAndEvent* pair =
+          run.add_artifact_event_pairs();
+      pair->mutable_artifact()->set_type_id(artifact_type_id_);
+      pair->mutable_artifact()->set_name(name);
+      pair->mutable_event()->set_type(name == input ? Event::INPUT
+                                                    : Event::OUTPUT);
+    }
+    return run;
+  }
+
+  ConnectionConfig connection_config_;
+  std::unique_ptr<MetadataStorePool> pool_;
+  MetadataStorePool::ScopedStore store_;
+  int64 artifact_type_id_;
+  int64 execution_type_id_;
+  int64 context_type_id_;
+};
+
+TEST_F(BulkLoaderTest, LoadsRunsOfPipelines) {
+  // Each run of a pipeline inputs the artifact output by the previous one.
+  std::vector<PutExecutionRequest> runs;
+  for (int i = 0; i < 5; i++) {
+    for (int j = 0; j < 6; j++) {
+      const std::string pipeline = absl::StrCat("pipeline_", j);
+      runs.push_back(
+          Run(pipeline, absl::StrCat(pipeline, "_output_", i),
+              i > 0 ? absl::StrCat(pipeline, "_output_", i - 1) : ""));
+    }
+  }
+  BulkLoader loader(ParseTextProtoOrDie<BulkLoadConfig>(
+                        "num_workers: 4 batch_size: 2"),
+                    connection_config_);
+  std::vector<PutExecutionResponse> responses;
+  std::vector<absl::Status> statuses;
+  BulkLoader::Report report;
+  ASSERT_EQ(absl::OkStatus(),
+            loader.Load(runs, &responses, &statuses, &report));
+  EXPECT_EQ(report.num_runs, 30);
+  EXPECT_EQ(report.num_runs_put, 30);
+  EXPECT_EQ(report.num_runs_failed, 0);
+  EXPECT_EQ(report.num_batches_redone, 0);
+  ASSERT_EQ(responses.size(), 30);
+  for (int i = 6; i < 30; i++) {
+    // The input of a run is the output of the previous run of its pipeline,
+    // i.e., its last artifact.
+    EXPECT_EQ(responses[i].artifact_ids(0),
+              *responses[i - 6].artifact_ids().rbegin());
+    EXPECT_EQ(responses[i].context_ids(0), responses[i - 6].context_ids(0));
+  }
+
+  GetArtifactsResponse get_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            store_->GetArtifacts({}, &get_artifacts_response));
+  EXPECT_EQ(get_artifacts_response.artifacts_size(), 30);
+  GetContextsResponse get_contexts_response;
+  ASSERT_EQ(absl::OkStatus(), store_->GetContexts({}, &get_contexts_response));
+  EXPECT_EQ(get_contexts_response.contexts_size(), 6);
+}
+
+TEST_F(BulkLoaderTest, RedoesFailedBatchRunByRun) {
+  std::vector<PutExecutionRequest> runs = {
+      Run("pipeline", "output_0"), Run("pipeline", "output_1", "output_0"),
+      Run("pipeline", "output_2", "output_1")};
+  // A run without execution fails.
+  runs[1].clear_execution();
+  BulkLoader loader(ParseTextProtoOrDie<BulkLoadConfig>(
+                        "num_workers: 2 batch_size: 10"),
+                    connection_config_);
+  std::vector<PutExecutionResponse> responses;
+  std::vector<absl::Status> statuses;
+  BulkLoader::Report report;
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      loader.Load(runs, &responses, &statuses, &report)));
+  ASSERT_EQ(statuses.size(), 3);
+  EXPECT_EQ(absl::OkStatus(), statuses[0]);
+  EXPECT_TRUE(absl::IsInvalidArgument(statuses[1]));
+  EXPECT_EQ(absl::OkStatus(), statuses[2]);
+  EXPECT_EQ(report.num_runs_put, 2);
+  EXPECT_EQ(report.num_runs_failed, 1);
+  EXPECT_EQ(report.num_batches, 1);
+  EXPECT_EQ(report.num_batches_redone, 1);
+  EXPECT_EQ(loader.progress().num_runs_put, 2);
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -0,0 +1,89 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_CALL_MEMORY_ACCOUNT_H_
+#define ML_METADATA_METADATA_STORE_CALL_MEMORY_ACCOUNT_H_
+
+#include <atomic>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/types.h"
+
+namespace ml_metadata {
+
+// The memory budget of a call, e.g., of an RPC, against which the metadata
+// source charges the serialized size of the query results of the call. The
+// results are converted to the nodes of the response of the call, which are
+// held until the call returns, so the charged bytes are never released, and
+// bound the peak memory of the call. It is thread-safe.
+//
+// Usage example:
+//
+//    CallMemoryAccount account(/*soft_limit_bytes=*/64 << 20,
+//                              /*hard_limit_bytes=*/512 << 20);
+//    metadata_store->set_memory_account(&account);
+//    // calls a method of the store, which fails with RESOURCE_EXHAUSTED once
+//    // its queries read more than 512MiB.
+class CallMemoryAccount {
+ public:
+  // A zero limit is unlimited.
+  CallMemoryAccount(const int64 soft_limit_bytes, const int64 hard_limit_bytes)
+      : soft_limit_bytes_(soft_limit_bytes),
+        hard_limit_bytes_(hard_limit_bytes) {}
+
+  // Disallows copy.
+  CallMemoryAccount(const CallMemoryAccount&) = delete;
+  CallMemoryAccount& operator=(const CallMemoryAccount&) = delete;
+
+  // Charges `num_bytes` to the call.
+  // Returns RESOURCE_EXHAUSTED error, if the bytes charged so far exceed the
+  // hard limit. Once exceeded, every later charge fails.
+  absl::Status Charge(const int64 num_bytes) {
+    const int64 charged_bytes =
+        charged_bytes_.fetch_add(num_bytes, std::memory_order_relaxed) +
+        num_bytes;
+    if (hard_limit_bytes_ > 0 && charged_bytes > hard_limit_bytes_) {
+      hard_limit_exceeded_.store(true, std::memory_order_relaxed);
+      return absl::ResourceExhaustedError(absl::StrCat(
+          "The call read ", charged_bytes,
+          " bytes of query results, over its memory limit of ",
+          hard_limit_bytes_, " bytes"));
+    }
+    return absl::OkStatus();
+  }
+
+  int64 soft_limit_bytes() const { return soft_limit_bytes_; }
+
+  int64 hard_limit_bytes() const { return hard_limit_bytes_; }
+
+  // Returns the bytes charged so far, which are the peak memory of the call.
+  int64 charged_bytes() const {
+    return charged_bytes_.load(std::memory_order_relaxed);
+  }
+
+  bool hard_limit_exceeded() const {
+    return hard_limit_exceeded_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const int64 soft_limit_bytes_;
+  const int64 hard_limit_bytes_;
+  std::atomic<int64> charged_bytes_{0};
+  std::atomic<bool> hard_limit_exceeded_{false};
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_CALL_MEMORY_ACCOUNT_H_
@@ -0,0 +1,77 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_CANCELLATION_TOKEN_H_
+#define ML_METADATA_METADATA_STORE_CANCELLATION_TOKEN_H_
+
+#include <atomic>
+
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace ml_metadata {
+
+// The deadline and the cancellation of a call, e.g., of an RPC, shared by the
+// layers running its transactions and queries, so that they stop the work of
+// a call whose client has gone away. It is thread-safe.
+//
+// Usage example:
+//
+//    CancellationToken token(absl::Now() + absl::Seconds(10));
+//    metadata_store->set_cancellation_token(&token);
+//    // from another thread, once the client goes away.
+//    token.Cancel();
+class CancellationToken {
+ public:
+  explicit CancellationToken(absl::Time deadline = absl::InfiniteFuture())
+      : deadline_(deadline) {}
+
+  // Disallows copy.
+  CancellationToken(const CancellationToken&) = delete;
+  CancellationToken& operator=(const CancellationToken&) = delete;
+
+  // Cancels the call, e.g., once its client has gone away.
+  void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+  bool IsCancelled() const {
+    return cancelled_.load(std::memory_order_relaxed);
+  }
+
+  absl::Time deadline() const { return deadline_; }
+
+  // Returns the time left before the deadline, which is infinite if the call
+  // has no deadline.
+  absl::Duration TimeLeft() const { return deadline_ - absl::Now(); }
+
+  // Returns CANCELLED error, if the call is cancelled.
+  // Returns DEADLINE_EXCEEDED error, if the deadline of the call has passed.
+  absl::Status Check() const {
+    if (IsCancelled()) {
+      return absl::CancelledError("The call is cancelled.");
+    }
+    if (absl::Now() >= deadline_) {
+      return absl::DeadlineExceededError("The deadline of the call passed.");
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  const absl::Time deadline_;
+  std::atomic<bool> cancelled_{false};
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_CANCELLATION_TOKEN_H_
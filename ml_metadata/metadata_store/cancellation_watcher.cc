@@ -0,0 +1,96 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/cancellation_watcher.h"
+
+#include <utility>
+
+#include <glog/logging.h>
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace ml_metadata {
+
+CancellationWatcher::CancellationWatcher(const absl::Duration poll_interval)
+    : poll_interval_(poll_interval) {
+  CHECK_GT(poll_interval_, absl::ZeroDuration())
+      << "poll_interval must be positive.";
+  poll_thread_ = std::thread([this]() { PollLoop(); });
+}
+
+CancellationWatcher::~CancellationWatcher() {
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+  }
+  poll_thread_.join();
+}
+
+void CancellationWatcher::Watch(const void* key, IsAbandoned is_abandoned,
+                                Cancel cancel) {
+  absl::MutexLock lock(&mu_);
+  calls_[key] = Call{std::move(is_abandoned), std::move(cancel)};
+}
+
+void CancellationWatcher::Unwatch(const void* key) {
+  absl::MutexLock lock(&mu_);
+  // A call is not unwatched, and its store released, while it is being
+  // cancelled.
+  auto it = calls_.find(key);
+  while (it != calls_.end() && it->second.cancelling) {
+    cancels_done_.Wait(&mu_);
+    it = calls_.find(key);
+  }
+  if (it != calls_.end()) {
+    calls_.erase(it);
+  }
+}
+
+std::vector<std::pair<const void*, CancellationWatcher::Cancel>>
+CancellationWatcher::TakeAbandonedCalls() {
+  std::vector<std::pair<const void*, Cancel>> cancels;
+  for (auto& key_and_call : calls_) {
+    Call& call = key_and_call.second;
+    if (!call.cancelled && call.is_abandoned()) {
+      call.cancelled = true;
+      call.cancelling = true;
+      cancels.emplace_back(key_and_call.first, call.cancel);
+    }
+  }
+  return cancels;
+}
+
+void CancellationWatcher::PollLoop() {
+  absl::MutexLock lock(&mu_);
+  while (!mu_.AwaitWithTimeout(absl::Condition(&stopping_), poll_interval_)) {
+    std::vector<std::pair<const void*, Cancel>> cancels = TakeAbandonedCalls();
+    if (cancels.empty()) {
+      continue;
+    }
+    // The calls are cancelled without `mu_`, as a cancel may block, e.g., on
+    // connecting to the database to kill a query, which must not block the
+    // Watch and Unwatch of the other calls.
+    mu_.Unlock();
+    for (auto& key_and_cancel : cancels) {
+      key_and_cancel.second();
+    }
+    mu_.Lock();
+    for (const auto& key_and_cancel : cancels) {
+      calls_.at(key_and_cancel.first).cancelling = false;
+    }
+    cancels_done_.SignalAll();
+  }
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,103 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_CANCELLATION_WATCHER_H_
+#define ML_METADATA_METADATA_STORE_CANCELLATION_WATCHER_H_
+
+#include <functional>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace ml_metadata {
+
+// Polls the watched calls, e.g., the RPCs of a server, every `poll_interval`
+// in a background thread, and cancels the ones whose client has gone away,
+// so that their running queries are interrupted instead of running to
+// completion. It is thread-safe.
+//
+// Usage example:
+//
+//    CancellationWatcher watcher(absl::Milliseconds(100));
+//    watcher.Watch(&call, [&]() { return context->IsCancelled(); },
+//                  [&]() { metadata_store->CancelQuery(); });
+//    ...
+//    watcher.Unwatch(&call);
+class CancellationWatcher {
+ public:
+  // Returns true if the client of a call has gone away.
+  using IsAbandoned = std::function<bool()>;
+
+  // Interrupts the work of a call.
+  using Cancel = std::function<void()>;
+
+  // Starts the polling thread. Check-fails if `poll_interval` is not
+  // positive.
+  explicit CancellationWatcher(absl::Duration poll_interval);
+
+  // Disallows copy.
+  CancellationWatcher(const CancellationWatcher&) = delete;
+  CancellationWatcher& operator=(const CancellationWatcher&) = delete;
+
+  // Stops the polling thread. All calls must be unwatched first.
+  ~CancellationWatcher();
+
+  // Watches the call identified by `key` until Unwatch(key). `cancel` is
+  // called at most once, by the polling thread, once `is_abandoned` returns
+  // true. `is_abandoned` is called with the watcher locked, so it must not
+  // block, while `cancel` may block, e.g., to connect to the database.
+  void Watch(const void* key, IsAbandoned is_abandoned, Cancel cancel);
+
+  // Stops watching the call of `key`. Once it returns, `cancel` of the call is
+  // neither running nor called anymore: it waits for the `cancel` of the call
+  // if it is running, but not for the ones of the other calls.
+  void Unwatch(const void* key);
+
+ private:
+  // A watched call.
+  struct Call {
+    IsAbandoned is_abandoned;
+    Cancel cancel;
+    bool cancelled = false;
+    // True while `cancel` is running, which is done without `mu_`.
+    bool cancelling = false;
+  };
+
+  // Cancels the abandoned calls every `poll_interval_` until stopped.
+  void PollLoop();
+
+  // Marks the abandoned calls as cancelled and cancelling, and returns their
+  // keys and cancels to run.
+  std::vector<std::pair<const void*, Cancel>> TakeAbandonedCalls()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const absl::Duration poll_interval_;
+
+  absl::Mutex mu_;
+  absl::flat_hash_map<const void*, Call> calls_ ABSL_GUARDED_BY(mu_);
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+  // Signaled when the cancels of a poll have returned.
+  absl::CondVar cancels_done_;
+
+  std::thread poll_thread_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_CANCELLATION_WATCHER_H_
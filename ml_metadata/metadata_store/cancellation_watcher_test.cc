@@ -0,0 +1,107 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/cancellation_watcher.h"
+
+#include <atomic>
+#include <thread>  // NOLINT
+
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/cancellation_token.h"
+
+namespace ml_metadata {
+namespace {
+
+TEST(CancellationWatcherTest, CancelsAbandonedCallsOnce) {
+  CancellationWatcher watcher(absl::Milliseconds(1));
+  std::atomic<bool> abandoned{false};
+  std::atomic<int> num_cancels{0};
+  absl::Notification cancelled;
+  int call;
+  watcher.Watch(
+      &call, [&abandoned]() { return abandoned.load(); },
+      [&num_cancels, &cancelled]() {
+        if (++num_cancels == 1) {
+          cancelled.Notify();
+        }
+      });
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_EQ(num_cancels, 0);
+
+  abandoned = true;
+  cancelled.WaitForNotification();
+  absl::SleepFor(absl::Milliseconds(10));
+  watcher.Unwatch(&call);
+  EXPECT_EQ(num_cancels, 1);
+}
+
+TEST(CancellationWatcherTest, UnwatchedCallsAreNotCancelled) {
+  CancellationWatcher watcher(absl::Milliseconds(1));
+  std::atomic<int> num_cancels{0};
+  int call;
+  watcher.Watch(
+      &call, []() { return false; }, [&num_cancels]() { num_cancels++; });
+  watcher.Unwatch(&call);
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_EQ(num_cancels, 0);
+}
+
+TEST(CancellationWatcherTest, BlockingCancelOnlyBlocksItsOwnUnwatch) {
+  CancellationWatcher watcher(absl::Milliseconds(1));
+  absl::Notification cancel_started;
+  absl::Notification release_cancel;
+  std::atomic<bool> cancel_returned{false};
+  int abandoned_call;
+  watcher.Watch(
+      &abandoned_call, []() { return true; },
+      [&]() {
+        cancel_started.Notify();
+        release_cancel.WaitForNotification();
+        cancel_returned = true;
+      });
+  cancel_started.WaitForNotification();
+
+  // The other calls are watched and unwatched while the cancel blocks.
+  int other_call;
+  watcher.Watch(
+      &other_call, []() { return false; }, []() {});
+  watcher.Unwatch(&other_call);
+
+  // The abandoned call is unwatched once its cancel returns.
+  std::thread unwatch_thread(
+      [&watcher, &abandoned_call]() { watcher.Unwatch(&abandoned_call); });
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_FALSE(cancel_returned);
+  release_cancel.Notify();
+  unwatch_thread.join();
+  EXPECT_TRUE(cancel_returned);
+}
+
+TEST(CancellationTokenTest, Check) {
+  CancellationToken token;
+  EXPECT_EQ(absl::OkStatus(), token.Check());
+  token.Cancel();
+  EXPECT_TRUE(absl::IsCancelled(token.Check()));
+
+  CancellationToken expired_token(absl::Now() - absl::Seconds(1));
+  EXPECT_TRUE(absl::IsDeadlineExceeded(expired_token.Check()));
+  EXPECT_LT(expired_token.TimeLeft(), absl::ZeroDuration());
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -30,6 +30,17 @@ enum class TypeKind { EXECUTION_TYPE = 0, ARTIFACT_TYPE = 1, CONTEXT_TYPE = 2 };
 // Default maximum number of returned resources for List operation.
 constexpr int kDefaultMaxListOperationResultSize = 100;
 
+// Maximum number of returned resources for List operation in the bulk export
+// mode.
+constexpr int kMaxBulkExportListOperationResultSize = 100000;
+
+// Maximum number of nodes deleted in a transaction by the bulk deletions,
+// which keeps the ids bound to a statement under the default limit of SQLite.
+constexpr int kMaxBulkDeleteChunkSize = 500;
+
+// Maximum number of change log entries returned by GetChanges.
+constexpr int kMaxChangeLogResultSize = 1000;
+
 }  // namespace ml_metadata
 
 #endif  // THIRD_PARTY_ML_METADATA_METADATA_STORE_CONSTANTS_H_
@@ -0,0 +1,114 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/group_committer.h"
+
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+
+namespace ml_metadata {
+
+struct GroupCommitter::PendingWrite {
+  explicit PendingWrite(const Write& write) : write(write) {}
+
+  // Returns true if the group of the write is done, or the write is to lead
+  // the next group.
+  bool DoneOrLeading() const { return done || leading; }
+
+  const Write& write;
+  absl::Status status;
+  bool done = false;
+  bool leading = false;
+};
+
+GroupCommitter::GroupCommitter(const GroupCommitConfig& config,
+                               ReplicatedMetadataStorePool* pool)
+    : max_delay_(absl::Microseconds(config.max_delay_us())),
+      max_batch_size_(config.max_batch_size()),
+      pool_(pool) {
+  CHECK_GT(max_batch_size_, 0) << "max_batch_size must be positive.";
+  CHECK_GE(config.max_delay_us(), 0) << "max_delay_us cannot be negative.";
+}
+
+absl::Status GroupCommitter::Commit(const Write& write) {
+  PendingWrite pending(write);
+  std::vector<PendingWrite*> group;
+  {
+    absl::MutexLock lock(&mu_);
+    pending_writes_.push_back(&pending);
+    if (has_leader_) {
+      mu_.Await(absl::Condition(&pending, &PendingWrite::DoneOrLeading));
+      if (pending.done) {
+        return pending.status;
+      }
+    }
+    // The leader is the first of `pending_writes_`, and waits for the others
+    // to join its group.
+    has_leader_ = true;
+    mu_.AwaitWithTimeout(absl::Condition(this, &GroupCommitter::GroupIsFull),
+                         max_delay_);
+    while (!pending_writes_.empty() &&
+           group.size() < static_cast<size_t>(max_batch_size_)) {
+      group.push_back(pending_writes_.front());
+      pending_writes_.pop_front();
+    }
+    // The writes left out of the group are led by the first of them.
+    if (pending_writes_.empty()) {
+      has_leader_ = false;
+    } else {
+      pending_writes_.front()->leading = true;
+    }
+  }
+  CommitGroup(group);
+  return pending.status;
+}
+
+bool GroupCommitter::GroupIsFull() const {
+  return pending_writes_.size() >= static_cast<size_t>(max_batch_size_);
+}
+
+void GroupCommitter::CommitGroup(const std::vector<PendingWrite*>& group) {
+  std::vector<absl::Status> statuses(group.size());
+  MetadataStorePool::ScopedStore store;
+  const absl::Status connection_status = pool_->AcquireForWrite(&store);
+  if (!connection_status.ok()) {
+    statuses.assign(group.size(), connection_status);
+  } else if (group.size() == 1) {
+    statuses[0] = group[0]->write(store.get());
+  } else {
+    std::vector<std::function<absl::Status()>> writes;
+    writes.reserve(group.size());
+    for (PendingWrite* pending : group) {
+      writes.push_back(
+          [pending, &store]() { return pending->write(store.get()); });
+    }
+    const absl::Status group_status = store->GroupCommit(writes, &statuses);
+    LOG_IF(WARNING, !group_status.ok())
+        << "A group of " << group.size()
+        << " writes failed, and they are redone one by one: " << group_status;
+  }
+  absl::MutexLock lock(&mu_);
+  for (int i = 0; i < group.size(); i++) {
+    group[i]->status = std::move(statuses[i]);
+    group[i]->done = true;
+  }
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,92 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_GROUP_COMMITTER_H_
+#define ML_METADATA_METADATA_STORE_GROUP_COMMITTER_H_
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/replicated_metadata_store_pool.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// Commits the concurrent small writes in groups, each in a single transaction
+// of a store leased from the primary of `pool`. The first write of a group
+// waits up to `max_delay_us` for other writes to join it, then the group of at
+// most `max_batch_size` writes is committed by MetadataStore::GroupCommit in
+// the calling thread, while the joining threads wait for their statuses.
+// It is thread-safe.
+//
+// Usage example:
+//
+//    GroupCommitter committer(config, &pool);
+//    MLMD_RETURN_IF_ERROR(committer.Commit([&](MetadataStore* store) {
+//      return store->PutEvents(request, &response);
+//    }));
+class GroupCommitter {
+ public:
+  using GroupCommitConfig = MetadataStoreServerConfig::GroupCommitConfig;
+
+  // A write of a group, e.g., a call of PutEvents of `store` without
+  // transaction_options.
+  using Write = std::function<absl::Status(MetadataStore* store)>;
+
+  // `pool` is not owned, and must outlast the committer. Check-fails if
+  // `max_batch_size` is not positive or `max_delay_us` is negative.
+  GroupCommitter(const GroupCommitConfig& config,
+                 ReplicatedMetadataStorePool* pool);
+
+  // Disallows copy.
+  GroupCommitter(const GroupCommitter&) = delete;
+  GroupCommitter& operator=(const GroupCommitter&) = delete;
+
+  // Runs `write` in a group with the concurrent writes, and returns its
+  // status once the group is done.
+  // Returns detailed errors of the write, or of leasing the store.
+  absl::Status Commit(const Write& write);
+
+ private:
+  // A write waiting for its group.
+  struct PendingWrite;
+
+  // Returns true if the writes fill a group.
+  bool GroupIsFull() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Commits the writes of `group` in a single transaction, and sets their
+  // statuses.
+  void CommitGroup(const std::vector<PendingWrite*>& group);
+
+  const absl::Duration max_delay_;
+  const int max_batch_size_;
+  ReplicatedMetadataStorePool* const pool_;
+
+  absl::Mutex mu_;
+  // The writes waiting to be taken by a group, in arrival order.
+  std::deque<PendingWrite*> pending_writes_ ABSL_GUARDED_BY(mu_);
+  // Whether a write of `pending_writes_` leads the next group, i.e., waits for
+  // the others to join it.
+  bool has_leader_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_GROUP_COMMITTER_H_
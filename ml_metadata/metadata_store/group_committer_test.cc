@@ -0,0 +1,189 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/group_committer.h"
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "ml_metadata/metadata_store/metadata_source_instrumentation.h"
+#include "ml_metadata/metadata_store/metadata_source_metrics.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/replicated_metadata_store_pool.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using testing::ParseTextProtoOrDie;
+
+class GroupCommitterTest : public ::testing::Test {
+ protected:
+  GroupCommitterTest() {
+    // The stores of the pool record their commits.
+    SetDefaultMetadataSourceInstrumentation(&metrics_);
+    ConnectionConfig connection_config;
+    connection_config.mutable_fake_database();
+    // A single store keeps the fake database of the writes.
+    pool_ = absl::make_unique<ReplicatedMetadataStorePool>(
+        connection_config,
+        ParseTextProtoOrDie<MetadataStorePool::ConnectionPoolConfig>(
+            "max_size: 1"));
+  }
+
+  ~GroupCommitterTest() override {
+    pool_.reset();
+    SetDefaultMetadataSourceInstrumentation(nullptr);
+  }
+
+  // Puts an execution and `num_artifacts` artifacts, and an event of each
+  // artifact to be put by the tests.
+  void PutEventsToCommit(int num_artifacts) {
+    MetadataStorePool::ScopedStore store;
+    ASSERT_EQ(absl::OkStatus(), pool_->AcquireForWrite(&store));
+    PutTypesResponse types_response;
+    ASSERT_EQ(absl::OkStatus(),
+              store->PutTypes(ParseTextProtoOrDie<PutTypesRequest>(R"pb(
+                                artifact_types: { name: 'artifact_type' }
+                                execution_types: { name: 'execution_type' }
+                              )pb"),
+                              &types_response));
+    PutExecutionRequest request;
+    request.mutable_execution()->set_type_id(
+        types_response.execution_type_ids(0));
+    for (int i = 0; i < num_artifacts; i++) {
+      request.add_artifact_event_pairs()->mutable_artifact()->set_type_id(
+          types_response.artifact_type_ids(0));
+    }
+    PutExecutionResponse response;
+    ASSERT_EQ(absl::OkStatus(), store->PutExecution(request, &response));
+    execution_id_ = response.execution_id();
+    for (const int64 artifact_id : response.artifact_ids()) {
+      Event event;
+      event.set_artifact_id(artifact_id);
+      event.set_execution_id(execution_id_);
+      event.set_type(Event::INPUT);
+      events_.push_back(event);
+    }
+  }
+
+  // Puts each of `requests` in its own thread via `committer`, and returns
+  // their statuses.
+  std::vector<absl::Status> CommitConcurrently(
+      const std::vector<PutEventsRequest>& requests,
+      GroupCommitter* committer) {
+    std::vector<absl::Status> statuses(requests.size());
+    std::vector<std::thread> threads;
+    for (int i = 0; i < requests.size(); i++) {
+      threads.emplace_back([&requests, &statuses, committer, i]() {
+        PutEventsResponse response;
+        statuses[i] = committer->Commit([&](MetadataStore* store) {
+          return store->PutEvents(requests[i], &response);
+        });
+      });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    return statuses;
+  }
+
+  int NumEvents() {
+    MetadataStorePool::ScopedStore store;
+    EXPECT_EQ(absl::OkStatus(), pool_->AcquireForWrite(&store));
+    GetEventsByExecutionIDsRequest request;
+    request.add_execution_ids(execution_id_);
+    GetEventsByExecutionIDsResponse response;
+    EXPECT_EQ(absl::OkStatus(),
+              store->GetEventsByExecutionIDs(request, &response));
+    return response.events_size();
+  }
+
+  int64 NumCommits() const {
+    return metrics_.GetTransactionLatency(TransactionOperation::kCommit)
+        .bucket_counts.back();
+  }
+
+  MetadataSourceMetrics metrics_;
+  std::unique_ptr<ReplicatedMetadataStorePool> pool_;
+  int64 execution_id_ = -1;
+  std::vector<Event> events_;
+};
+
+TEST_F(GroupCommitterTest, CommitsConcurrentWritesInOneTransaction) {
+  constexpr int kNumWrites = 8;
+  ASSERT_NO_FATAL_FAILURE(PutEventsToCommit(kNumWrites));
+  // The leader waits until the group is full.
+  GroupCommitter committer(
+      ParseTextProtoOrDie<GroupCommitter::GroupCommitConfig>(
+          "max_delay_us: 60000000 max_batch_size: 8"),
+      pool_.get());
+  std::vector<PutEventsRequest> requests(kNumWrites);
+  for (int i = 0; i < kNumWrites; i++) {
+    *requests[i].add_events() = events_[i];
+  }
+  const int64 num_commits = NumCommits();
+
+  for (const absl::Status& status : CommitConcurrently(requests, &committer)) {
+    EXPECT_EQ(absl::OkStatus(), status);
+  }
+  EXPECT_EQ(NumCommits() - num_commits, 1);
+  EXPECT_EQ(NumEvents(), kNumWrites);
+}
+
+TEST_F(GroupCommitterTest, FailedWriteDoesNotFailTheGroup) {
+  ASSERT_NO_FATAL_FAILURE(PutEventsToCommit(/*num_artifacts=*/2));
+  GroupCommitter committer(
+      ParseTextProtoOrDie<GroupCommitter::GroupCommitConfig>(
+          "max_delay_us: 60000000 max_batch_size: 3"),
+      pool_.get());
+  std::vector<PutEventsRequest> requests(3);
+  *requests[0].add_events() = events_[0];
+  *requests[1].add_events() = events_[1];
+  // The execution of the event does not exist.
+  Event* invalid_event = requests[2].add_events();
+  *invalid_event = events_[0];
+  invalid_event->set_execution_id(execution_id_ + 1);
+
+  const std::vector<absl::Status> statuses =
+      CommitConcurrently(requests, &committer);
+  EXPECT_EQ(absl::OkStatus(), statuses[0]);
+  EXPECT_EQ(absl::OkStatus(), statuses[1]);
+  EXPECT_TRUE(absl::IsInvalidArgument(statuses[2]));
+  EXPECT_EQ(NumEvents(), 2);
+}
+
+TEST_F(GroupCommitterTest, CommitsLoneWriteAfterMaxDelay) {
+  ASSERT_NO_FATAL_FAILURE(PutEventsToCommit(/*num_artifacts=*/1));
+  GroupCommitter committer(
+      ParseTextProtoOrDie<GroupCommitter::GroupCommitConfig>(
+          "max_delay_us: 1000 max_batch_size: 8"),
+      pool_.get());
+  PutEventsRequest request;
+  *request.add_events() = events_[0];
+  PutEventsResponse response;
+  EXPECT_EQ(absl::OkStatus(), committer.Commit([&](MetadataStore* store) {
+    return store->PutEvents(request, &response);
+  }));
+  EXPECT_EQ(NumEvents(), 1);
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -0,0 +1,3035 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/in_memory_metadata_access_object.h"
+
+#include <algorithm>
+#include <climits>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include "google/protobuf/util/message_differencer.h"
+#include "absl/algorithm/container.h"
+#include "absl/container/btree_map.h"
+#include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/list_operation_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/simple_types/simple_types_constants.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+namespace {
+
+// The tables of the relational schema at the library version.
+constexpr const char* kTableNames[] = {
+    "Type",          "TypeProperty",       "ParentType",    "Artifact",
+    "ArtifactProperty", "Execution",       "ExecutionProperty", "Event",
+    "EventPath",     "ArtifactDerivation", "ChangeLog",     "MLMDEnv",
+    "Context",       "ContextProperty",    "ParentContext", "Association",
+    "Attribution"};
+
+// The tables of the v0.13.2 release, which has no schema version.
+constexpr const char* kTableNamesInV0_13_2[] = {
+    "Artifact",         "Event",     "Execution",         "Type",
+    "ArtifactProperty", "EventPath", "ExecutionProperty", "TypeProperty"};
+
+constexpr char kSchemaVersionTable[] = "MLMDEnv";
+
+template <typename Type>
+InMemoryTypeTable<Type>& GetTypeTable(InMemoryDatabase& db) {
+  return std::get<InMemoryTypeTable<Type>>(db.type_tables);
+}
+
+template <typename Type>
+const InMemoryTypeTable<Type>& GetTypeTable(const InMemoryDatabase& db) {
+  return std::get<InMemoryTypeTable<Type>>(db.type_tables);
+}
+
+template <typename Node>
+InMemoryNodeTable<Node>& GetNodeTable(InMemoryDatabase& db) {
+  return std::get<InMemoryNodeTable<Node>>(db.node_tables);
+}
+
+template <typename Node>
+const InMemoryNodeTable<Node>& GetNodeTable(const InMemoryDatabase& db) {
+  return std::get<InMemoryNodeTable<Node>>(db.node_tables);
+}
+
+// Returns the archived node with `id`, or nullptr if there is none. Only the
+// executions are archived.
+template <typename Node>
+const Node* FindArchivedNode(const InMemoryDatabase& db, const int64 id) {
+  return nullptr;
+}
+
+template <>
+const Execution* FindArchivedNode<Execution>(const InMemoryDatabase& db,
+                                             const int64 id) {
+  const auto it = db.archived_executions.find(id);
+  return it == db.archived_executions.end() ? nullptr : &it->second;
+}
+
+// Returns INVALID_ARGUMENT error, if any of the `ids` is missing in the
+// `nodes` of a kind.
+template <typename Node>
+absl::Status CheckNodesFound(const absl::flat_hash_set<int64>& ids,
+                             const InMemoryDatabase& db,
+                             absl::string_view node_kind) {
+  const InMemoryNodeTable<Node>& table = GetNodeTable<Node>(db);
+  for (const int64 id : ids) {
+    if (!table.nodes.contains(id)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("No ", node_kind, " with the given id ", id));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Validates properties in a `Node` with the properties defined in a `Type`.
+// `Node` is one of {`Artifact`, `Execution`, `Context`}. `Type` is one of
+// {`ArtifactType`, `ExecutionType`, `ContextType`}.
+// Returns INVALID_ARGUMENT error, if there is unknown or mismatched property
+// w.r.t. its definition.
+template <typename Node, typename Type>
+absl::Status ValidatePropertiesWithType(const Node& node, const Type& type) {
+  const google::protobuf::Map<std::string, PropertyType>& type_properties =
+      type.properties();
+  for (const auto& p : node.properties()) {
+    const std::string& property_name = p.first;
+    const Value& property_value = p.second;
+    if (type_properties.find(property_name) == type_properties.end())
+      return absl::InvalidArgumentError(
+          absl::StrCat("Found unknown property: ", property_name));
+    bool is_type_match = false;
+    switch (type_properties.at(property_name)) {
+      case PropertyType::INT: {
+        is_type_match = property_value.has_int_value();
+        break;
+      }
+      case PropertyType::DOUBLE: {
+        is_type_match = property_value.has_double_value();
+        break;
+      }
+      case PropertyType::STRING: {
+        is_type_match = property_value.has_string_value();
+        break;
+      }
+      case PropertyType::STRUCT: {
+        is_type_match = property_value.has_struct_value();
+        break;
+      }
+      case PropertyType::PROTO: {
+        is_type_match = property_value.has_proto_value();
+        break;
+      }
+      default: {
+        return absl::InternalError(absl::StrCat(
+            "Unknown registered property type: ", type.DebugString()));
+      }
+    }
+    if (!is_type_match)
+      return absl::InvalidArgumentError(
+          absl::StrCat("Found unmatched property type: ", property_name));
+  }
+  return absl::OkStatus();
+}
+
+// A util to handle `version` in ArtifactType/ExecutionType/ContextType protos.
+template <typename T>
+absl::optional<std::string> GetTypeVersion(const T& type_message) {
+  return type_message.has_version() && !type_message.version().empty()
+             ? absl::make_optional(type_message.version())
+             : absl::nullopt;
+}
+
+// Returns the type with only the columns of the Type table, i.e., without
+// its properties and the input and output types of an ExecutionType.
+template <typename Type>
+Type GetTypeHeader(const Type& type) {
+  Type header;
+  header.set_id(type.id());
+  header.set_name(type.name());
+  if (type.has_version()) header.set_version(type.version());
+  if (type.has_description()) header.set_description(type.description());
+  return header;
+}
+
+// Returns true if the two property maps have the same values.
+bool PropertiesEqual(const google::protobuf::Map<std::string, Value>& a,
+                     const google::protobuf::Map<std::string, Value>& b) {
+  if (a.size() != b.size()) return false;
+  for (const auto& p : a) {
+    const auto it = b.find(p.first);
+    if (it == b.end() || !google::protobuf::util::MessageDifferencer::Equals(
+                             p.second, it->second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Keeps the properties of the `node` in the `projection`.
+template <typename Node>
+Node ProjectNode(const Node& node,
+                 const ListOperationOptions::PropertyProjection& projection) {
+  Node result = node;
+  if (projection.headers_only()) {
+    result.clear_properties();
+    result.clear_custom_properties();
+    return result;
+  }
+  if (projection.property_names().empty()) {
+    return result;
+  }
+  const absl::flat_hash_set<std::string> names(
+      projection.property_names().begin(), projection.property_names().end());
+  for (google::protobuf::Map<std::string, Value>* properties :
+       {result.mutable_properties(), result.mutable_custom_properties()}) {
+    for (auto it = properties->begin(); it != properties->end();) {
+      if (names.contains(it->first)) {
+        ++it;
+      } else {
+        it = properties->erase(it);
+      }
+    }
+  }
+  return result;
+}
+
+// Sets `nodes` to the nodes that only have the `ids`.
+template <typename Node>
+void SetIdOnlyNodes(absl::Span<const int64> ids, std::vector<Node>& nodes) {
+  nodes.resize(ids.size());
+  for (int i = 0; i < ids.size(); i++) {
+    nodes[i].set_id(ids[i]);
+  }
+}
+
+// Adds the uri of an artifact to the uri index. Other nodes have no uri.
+void AddToUriIndex(const Artifact& artifact, InMemoryDatabase& db) {
+  db.artifact_ids_by_uri[artifact.uri()].insert(artifact.id());
+}
+void AddToUriIndex(const Execution&, InMemoryDatabase&) {}
+void AddToUriIndex(const Context&, InMemoryDatabase&) {}
+
+// Removes the uri of an artifact from the uri index.
+void RemoveFromUriIndex(const Artifact& artifact, InMemoryDatabase& db) {
+  auto it = db.artifact_ids_by_uri.find(artifact.uri());
+  if (it == db.artifact_ids_by_uri.end()) return;
+  it->second.erase(artifact.id());
+  if (it->second.empty()) db.artifact_ids_by_uri.erase(it);
+}
+void RemoveFromUriIndex(const Execution&, InMemoryDatabase&) {}
+void RemoveFromUriIndex(const Context&, InMemoryDatabase&) {}
+
+// Stores the `node` and indexes it.
+template <typename Node>
+void InsertNode(Node node, InMemoryDatabase& db) {
+  InMemoryNodeTable<Node>& table = GetNodeTable<Node>(db);
+  table.ids_by_type_id[node.type_id()].insert(node.id());
+  if (node.has_name()) {
+    table.id_by_type_id_and_name[{node.type_id(), node.name()}] = node.id();
+  }
+  AddToUriIndex(node, db);
+  const int64 node_id = node.id();
+  table.nodes[node_id] = std::move(node);
+}
+
+// Removes the node with `node_id` and its index entries, if it exists.
+template <typename Node>
+void EraseNode(const int64 node_id, InMemoryDatabase& db) {
+  InMemoryNodeTable<Node>& table = GetNodeTable<Node>(db);
+  auto it = table.nodes.find(node_id);
+  if (it == table.nodes.end()) return;
+  const Node& node = it->second;
+  auto type_it = table.ids_by_type_id.find(node.type_id());
+  if (type_it != table.ids_by_type_id.end()) {
+    type_it->second.erase(node_id);
+    if (type_it->second.empty()) table.ids_by_type_id.erase(type_it);
+  }
+  if (node.has_name()) {
+    table.id_by_type_id_and_name.erase({node.type_id(), node.name()});
+  }
+  RemoveFromUriIndex(node, db);
+  table.nodes.erase(it);
+}
+
+// Returns the node to store for the given `node` to create, which only has
+// the fields of its table and properties.
+Artifact GetNodeToStore(const Artifact& node) {
+  Artifact result = node;
+  result.clear_type();
+  // The uri column is always set.
+  result.set_uri(node.uri());
+  return result;
+}
+Execution GetNodeToStore(const Execution& node) {
+  Execution result = node;
+  result.clear_type();
+  return result;
+}
+Context GetNodeToStore(const Context& node) {
+  Context result = node;
+  result.clear_type();
+  return result;
+}
+
+// Applies the update of the non-property fields of the `node` to the stored
+// node, i.e., the type id and uri and state of an Artifact.
+void ApplyNodeUpdate(const Artifact& node, const int64 now, Artifact& stored) {
+  stored.set_type_id(node.type_id());
+  stored.set_uri(node.uri());
+  if (node.has_state()) {
+    stored.set_state(node.state());
+  } else {
+    stored.clear_state();
+  }
+  // The last update times of an artifact are strictly increasing.
+  stored.set_last_update_time_since_epoch(
+      now > stored.last_update_time_since_epoch()
+          ? now
+          : stored.last_update_time_since_epoch() + 1);
+}
+
+// Applies the update of the type id and state of an Execution.
+void ApplyNodeUpdate(const Execution& node, const int64 now,
+                     Execution& stored) {
+  stored.set_type_id(node.type_id());
+  if (node.has_last_known_state()) {
+    stored.set_last_known_state(node.last_known_state());
+  } else {
+    stored.clear_last_known_state();
+  }
+  stored.set_last_update_time_since_epoch(now);
+}
+
+// Applies the update of the type id and name of a Context.
+void ApplyNodeUpdate(const Context& node, const int64 now, Context& stored) {
+  stored.set_type_id(node.type_id());
+  stored.set_name(node.name());
+  stored.set_last_update_time_since_epoch(now);
+}
+
+// Returns INVALID_ARGUMENT error, if a context to store has no name.
+absl::Status ValidateNodeName(const Artifact&) { return absl::OkStatus(); }
+absl::Status ValidateNodeName(const Execution&) { return absl::OkStatus(); }
+absl::Status ValidateNodeName(const Context& context) {
+  if (!context.has_name() || context.name().empty()) {
+    return absl::InvalidArgumentError("Context name should not be empty");
+  }
+  return absl::OkStatus();
+}
+
+// Returns the kind of the change log entries of a node.
+ChangeLogEntry::Kind ChangeLogKind(const Artifact&) {
+  return ChangeLogEntry::ARTIFACT;
+}
+ChangeLogEntry::Kind ChangeLogKind(const Execution&) {
+  return ChangeLogEntry::EXECUTION;
+}
+ChangeLogEntry::Kind ChangeLogKind(const Context&) {
+  return ChangeLogEntry::CONTEXT;
+}
+
+// Returns the prefix of the NOT_FOUND message of the lookups by type id.
+absl::string_view NodesNotFoundPrefix(const Artifact&) {
+  return "No artifacts found for type_id:";
+}
+absl::string_view NodesNotFoundPrefix(const Execution&) {
+  return "No executions found for type_id:";
+}
+absl::string_view NodesNotFoundPrefix(const Context&) {
+  return "No contexts found with type_id: ";
+}
+
+// Returns the separator of the name in the NOT_FOUND message of the lookups by
+// type id and name.
+absl::string_view NameSeparator(const Artifact&) { return ", name:"; }
+absl::string_view NameSeparator(const Execution&) { return ", name:"; }
+absl::string_view NameSeparator(const Context&) { return ", name: "; }
+
+// Appends the change log entries of the `operation` on the nodes of `kind`
+// with `node_ids`.
+void AppendNodeChangeLogEntries(const ChangeLogEntry::Kind kind,
+                                const ChangeLogEntry::Operation operation,
+                                absl::Span<const int64> node_ids,
+                                InMemoryDatabase& db) {
+  const int64 now = absl::ToUnixMillis(absl::Now());
+  for (const int64 node_id : node_ids) {
+    ChangeLogEntry entry;
+    entry.set_sequence_number(db.change_log.size() + 1);
+    entry.set_kind(kind);
+    entry.set_operation(operation);
+    entry.set_milliseconds_since_epoch(now);
+    switch (kind) {
+      case ChangeLogEntry::ARTIFACT:
+        entry.set_artifact_id(node_id);
+        break;
+      case ChangeLogEntry::EXECUTION:
+        entry.set_execution_id(node_id);
+        break;
+      case ChangeLogEntry::CONTEXT:
+        entry.set_context_id(node_id);
+        break;
+      default:
+        LOG(FATAL) << "Unexpected kind of node: " << kind;
+    }
+    db.change_log.push_back(std::move(entry));
+  }
+}
+
+// Appends the change log entry of the creation of `event`.
+void AppendEventChangeLogEntry(const Event& event, InMemoryDatabase& db) {
+  ChangeLogEntry entry;
+  entry.set_sequence_number(db.change_log.size() + 1);
+  entry.set_kind(ChangeLogEntry::EVENT);
+  entry.set_operation(ChangeLogEntry::CREATED);
+  entry.set_artifact_id(event.artifact_id());
+  entry.set_execution_id(event.execution_id());
+  entry.set_milliseconds_since_epoch(absl::ToUnixMillis(absl::Now()));
+  db.change_log.push_back(std::move(entry));
+}
+
+using LinkIndex = absl::flat_hash_map<int64, absl::btree_set<int64>>;
+
+// Returns the linked ids of `id` in the `index`, or an empty set.
+const absl::btree_set<int64>& GetLinkedIds(const LinkIndex& index,
+                                           const int64 id) {
+  static const auto* const kEmpty = new absl::btree_set<int64>();
+  const auto it = index.find(id);
+  return it == index.end() ? *kEmpty : it->second;
+}
+
+// Returns the linked ids of the distinct `ids` in the `index`, ordered by id
+// and then by linked id.
+std::vector<int64> GetAllLinkedIds(const LinkIndex& index,
+                                   const absl::Span<const int64> ids) {
+  std::vector<int64> linked_ids;
+  for (const int64 id : absl::btree_set<int64>(ids.begin(), ids.end())) {
+    const absl::btree_set<int64>& id_linked_ids = GetLinkedIds(index, id);
+    linked_ids.insert(linked_ids.end(), id_linked_ids.begin(),
+                      id_linked_ids.end());
+  }
+  return linked_ids;
+}
+
+// Returns the pairs of the `context_ids` and their linked ids in the `index`,
+// ordered by context id and then by linked id in descending order. If
+// `max_num_per_context` is positive, at most that many linked ids of each
+// context are returned.
+std::vector<std::pair<int64, int64>> GetContextAndLinkedIds(
+    const LinkIndex& index, const absl::Span<const int64> context_ids,
+    const int64 max_num_per_context) {
+  const absl::btree_set<int64> sorted_context_ids(context_ids.begin(),
+                                                  context_ids.end());
+  std::vector<std::pair<int64, int64>> links;
+  for (const int64 context_id : sorted_context_ids) {
+    const absl::btree_set<int64>& linked_ids = GetLinkedIds(index, context_id);
+    int64 num_links = 0;
+    for (auto it = linked_ids.rbegin(); it != linked_ids.rend(); ++it) {
+      if (max_num_per_context > 0 && num_links++ >= max_num_per_context) {
+        break;
+      }
+      links.emplace_back(context_id, *it);
+    }
+  }
+  return links;
+}
+
+// Links `from_id` and `to_id` in both directions. Returns false if they are
+// already linked.
+bool AddLink(const int64 from_id, const int64 to_id, LinkIndex& forward,
+             LinkIndex& backward) {
+  if (!forward[from_id].insert(to_id).second) return false;
+  backward[to_id].insert(from_id);
+  return true;
+}
+
+// Removes all links of the `ids` in the `forward` index, and their reverse
+// links in the `backward` index.
+void RemoveLinks(absl::Span<const int64> ids, LinkIndex& forward,
+                 LinkIndex& backward) {
+  for (const int64 id : ids) {
+    auto it = forward.find(id);
+    if (it == forward.end()) continue;
+    for (const int64 linked_id : it->second) {
+      auto backward_it = backward.find(linked_id);
+      if (backward_it == backward.end()) continue;
+      backward_it->second.erase(id);
+      if (backward_it->second.empty()) backward.erase(backward_it);
+    }
+    forward.erase(it);
+  }
+}
+
+// Check whether there is a cyclic dependency. We do a DFS traversal from
+// root node's id(`parent_id`) through the `parent_ids` and it introduces a
+// cycle if any ancestors' id is `child_id`.
+absl::Status CheckCyClicDependency(const int64 child_id, const int64 parent_id,
+                                   const LinkIndex& parent_ids) {
+  std::vector<int64> ancestor_ids = {parent_id};
+  absl::flat_hash_set<int64> visited_ancestors_ids;
+  while (!ancestor_ids.empty()) {
+    const int64 ancestor_id = ancestor_ids.back();
+    if (ancestor_id == child_id) {
+      return absl::InvalidArgumentError(
+          "There is a cycle detected of the given relationship.");
+    }
+    ancestor_ids.pop_back();
+    if (!visited_ancestors_ids.insert(ancestor_id).second) {
+      continue;
+    }
+    for (const int64 id : GetLinkedIds(parent_ids, ancestor_id)) {
+      ancestor_ids.push_back(id);
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Removes the event with `event_id` and its index entries.
+void EraseEvent(const int64 event_id, InMemoryDatabase& db) {
+  auto it = db.events.find(event_id);
+  if (it == db.events.end()) return;
+  const Event& event = it->second;
+  for (auto* index : {&db.event_ids_by_artifact_id,
+                      &db.event_ids_by_execution_id}) {
+    const int64 key = index == &db.event_ids_by_artifact_id
+                          ? event.artifact_id()
+                          : event.execution_id();
+    auto index_it = index->find(key);
+    if (index_it == index->end()) continue;
+    index_it->second.erase(event_id);
+    if (index_it->second.empty()) index->erase(index_it);
+  }
+  db.event_keys.erase(
+      {event.artifact_id(), event.execution_id(), event.type()});
+  db.archived_event_ids.erase(event_id);
+  db.events.erase(it);
+}
+
+// Returns true if the event type is an input of its execution.
+bool IsInputEvent(const Event::Type type) {
+  return type == Event::DECLARED_INPUT || type == Event::INPUT ||
+         type == Event::INTERNAL_INPUT;
+}
+
+// Returns true if the event type is an output of its execution.
+bool IsOutputEvent(const Event::Type type) {
+  return type == Event::DECLARED_OUTPUT || type == Event::OUTPUT ||
+         type == Event::INTERNAL_OUTPUT;
+}
+
+// Returns the ordering field value of the `node` for List operations.
+template <typename Node>
+int64 GetOrderingFieldValue(const Node& node,
+                            const ListOperationOptions::OrderByField::Field
+                                field) {
+  switch (field) {
+    case ListOperationOptions::OrderByField::CREATE_TIME:
+      return node.create_time_since_epoch();
+    case ListOperationOptions::OrderByField::LAST_UPDATE_TIME:
+      return node.last_update_time_since_epoch();
+    default:
+      return node.id();
+  }
+}
+
+// Decodes the next page token of `options`, and validates that the options
+// have not changed since the token was built.
+absl::Status ValidateAndDecodeNextPageToken(
+    const ListOperationOptions& options,
+    ListOperationNextPageToken& next_page_token) {
+  MLMD_RETURN_IF_ERROR(DecodeListOperationNextPageToken(
+      options.next_page_token(), next_page_token));
+  if (options.bulk_export() !=
+      next_page_token.has_bulk_export_order_by_field()) {
+    return absl::InvalidArgumentError(
+        "The next_page_token of bulk export can only be used with the "
+        "bulk_export ListOperationOptions.");
+  }
+  if (options.bulk_export()) {
+    ListOperationOptions previous_options;
+    *previous_options.mutable_order_by_field() =
+        next_page_token.bulk_export_order_by_field();
+    previous_options.set_bulk_export(true);
+    return ValidateListOperationOptionsAreIdentical(previous_options, options);
+  }
+  return ValidateListOperationOptionsAreIdentical(
+      next_page_token.set_options(), options);
+}
+
+// Returns the state of `node` grouped by the CountOptions::STATE counts.
+absl::optional<int64> GetCountedState(const Artifact& artifact) {
+  if (!artifact.has_state()) return absl::nullopt;
+  return artifact.state();
+}
+
+absl::optional<int64> GetCountedState(const Execution& execution) {
+  if (!execution.has_last_known_state()) return absl::nullopt;
+  return execution.last_known_state();
+}
+
+absl::optional<int64> GetCountedState(const Context& context) {
+  return absl::nullopt;
+}
+
+// Returns the context ids of `node` grouped by the CountOptions::CONTEXT
+// counts.
+const absl::btree_set<int64>& GetCountedContextIds(const InMemoryDatabase& db,
+                                                   const Artifact& artifact) {
+  return GetLinkedIds(db.context_ids_by_artifact_id, artifact.id());
+}
+
+const absl::btree_set<int64>& GetCountedContextIds(const InMemoryDatabase& db,
+                                                   const Execution& execution) {
+  return GetLinkedIds(db.context_ids_by_execution_id, execution.id());
+}
+
+const absl::btree_set<int64>& GetCountedContextIds(const InMemoryDatabase& db,
+                                                   const Context& context) {
+  static const auto* const kNoContextIds = new absl::btree_set<int64>();
+  return *kNoContextIds;
+}
+
+}  // namespace
+
+absl::Status InMemoryMetadataAccessObject::InitMetadataSource() {
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  for (const char* table_name : kTableNames) {
+    db->tables.insert(table_name);
+  }
+  if (!db->schema_version) {
+    db->schema_version = library_version_;
+  } else if (*db->schema_version != library_version_) {
+    return absl::DataLossError(absl::StrCat(
+        "The database cannot be initialized with the schema_version in the "
+        "current library. Current library version: ",
+        library_version_, ", the db version on record is: ",
+        *db->schema_version,
+        ". It may result from a data race condition caused by other "
+        "concurrent MLMD's migration procedures."));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::InitMetadataSourceIfNotExists(
+    const bool enable_upgrade_migration) {
+  int64 db_version = 0;
+  const absl::Status get_schema_version_status = GetSchemaVersion(&db_version);
+  if (absl::IsNotFound(get_schema_version_status)) {
+    db_version = library_version_;
+  } else {
+    MLMD_RETURN_IF_ERROR(get_schema_version_status);
+  }
+  if (db_version > library_version_) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "MLMD database version ", db_version,
+        " is greater than library version ", library_version_,
+        ". Please upgrade the library to use the given database in order to "
+        "prevent potential data loss. If data loss is acceptable, please"
+        " downgrade the database using a newer version of library."));
+  }
+  if (db_version < library_version_) {
+    if (!enable_upgrade_migration) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "MLMD database version ", db_version,
+          " is older than library version ", library_version_,
+          ". Schema migration is disabled. Please upgrade the database then "
+          "use the library version; or switch to a older library version to "
+          "use the current database."));
+    }
+    // The schema is not materialized, so the upgrade creates the tables
+    // missing in the earlier versions, and records the library version.
+    MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                          metadata_source_->GetMutableDatabase());
+    for (const char* table_name : kTableNames) {
+      db->tables.insert(table_name);
+    }
+    db->schema_version = library_version_;
+  }
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  std::vector<std::string> missing_tables;
+  for (const char* table_name : kTableNames) {
+    if (!db->tables.contains(table_name)) {
+      missing_tables.push_back(table_name);
+    }
+  }
+  // all table required by the current lib version exists
+  if (missing_tables.empty()) return absl::OkStatus();
+  // some table exists, but not all.
+  if (!db->tables.empty()) {
+    return absl::AbortedError(absl::StrCat(
+        "There are a subset of tables in MLMD instance. This may be due to "
+        "concurrent connection to the empty database. "
+        "Please retry the connection. missing tables: ",
+        absl::StrJoin(missing_tables, ", ")));
+  }
+  // no table exists, then init the MetadataSource
+  return InitMetadataSource();
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteMetadataSource() {
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  *db = InMemoryDatabase();
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::DowngradeMetadataSource(
+    const int64 to_schema_version) {
+  if (to_schema_version < 0 || to_schema_version > library_version_) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "MLMD cannot be downgraded to schema_version: ", to_schema_version,
+        ". The target version should be greater or equal to 0, and the current"
+        " library version: ",
+        library_version_, " needs to be greater than the target version."));
+  }
+  int64 db_version = 0;
+  const absl::Status get_schema_version_status = GetSchemaVersion(&db_version);
+  // if it is an empty database, then we skip downgrade and returns.
+  if (absl::IsNotFound(get_schema_version_status)) {
+    return absl::InvalidArgumentError(
+        "Empty database is given. Downgrade operation is not needed.");
+  }
+  MLMD_RETURN_IF_ERROR(get_schema_version_status);
+  if (db_version > library_version_) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("MLMD database version ", db_version,
+                     " is greater than library version ", library_version_,
+                     ". The current library does not know how to downgrade it. "
+                     "Please upgrade the library to downgrade the schema."));
+  }
+  if (db_version <= to_schema_version) {
+    return absl::OkStatus();
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  // at version 0, v0.13.2, there is no schema version information.
+  if (to_schema_version == 0) {
+    db->tables.erase(kSchemaVersionTable);
+    db->schema_version.reset();
+  } else {
+    db->schema_version = to_schema_version;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::GetSchemaVersion(
+    int64* db_version) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  if (db->tables.contains(kSchemaVersionTable)) {
+    if (!db->schema_version) {
+      return absl::AbortedError(
+          "In the given db, MLMDEnv table exists but no schema_version can be "
+          "found. This may be due to concurrent connection to the empty "
+          "database. Please retry connection.");
+    }
+    *db_version = *db->schema_version;
+    return absl::OkStatus();
+  }
+  // if MLMDEnv does not exist, it may be the v0.13.2 release or an empty db.
+  const bool is_v0_13_2 = absl::c_all_of(
+      kTableNamesInV0_13_2,
+      [db](const char* table_name) { return db->tables.contains(table_name); });
+  if (is_v0_13_2) {
+    *db_version = 0;
+    return absl::OkStatus();
+  }
+  return absl::NotFoundError("it looks an empty db is given.");
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::CreateTypeImpl(const Type& type,
+                                                          int64* type_id) {
+  // validate the given type
+  if (type.name().empty()) {
+    return absl::InvalidArgumentError("No type name is specified.");
+  }
+  for (const auto& property : type.properties()) {
+    if (property.second == PropertyType::UNKNOWN) {
+      LOG(ERROR) << "Property " << property.first
+                 << "'s value type is UNKNOWN.";
+      return absl::InvalidArgumentError(
+          absl::StrCat("Property ", property.first, " is UNKNOWN."));
+    }
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  Type stored_type = type;
+  stored_type.clear_base_type();
+  const absl::optional<std::string> version = GetTypeVersion(type);
+  if (!version) stored_type.clear_version();
+  *type_id = ++db->last_type_id;
+  stored_type.set_id(*type_id);
+  InMemoryTypeTable<Type>& table = GetTypeTable<Type>(*db);
+  table.ids_by_name_and_version[{type.name(), version.value_or("")}].insert(
+      *type_id);
+  table.types[*type_id] = std::move(stored_type);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateType(const ArtifactType& type,
+                                                      int64* type_id) {
+  return CreateTypeImpl(type, type_id);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateType(const ExecutionType& type,
+                                                      int64* type_id) {
+  return CreateTypeImpl(type, type_id);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateType(const ContextType& type,
+                                                      int64* type_id) {
+  return CreateTypeImpl(type, type_id);
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::UpdateTypeImpl(const Type& type) {
+  if (!type.has_name()) {
+    return absl::InvalidArgumentError("No type name is specified.");
+  }
+  // find the current stored type and validate the id.
+  Type stored_type;
+  MLMD_RETURN_IF_ERROR(
+      FindTypeImpl(type.name(), GetTypeVersion(type), &stored_type));
+  if (type.has_id() && type.id() != stored_type.id()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Given type id is different from the existing type: ",
+                     stored_type.DebugString()));
+  }
+  // validates the list of type properties before adding the new ones.
+  const google::protobuf::Map<std::string, PropertyType>& stored_properties =
+      stored_type.properties();
+  std::vector<std::pair<std::string, PropertyType>> new_properties;
+  for (const auto& p : type.properties()) {
+    const std::string& property_name = p.first;
+    const PropertyType property_type = p.second;
+    if (property_type == PropertyType::UNKNOWN) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Property:", property_name, " type should not be UNKNOWN."));
+    }
+    const auto it = stored_properties.find(property_name);
+    if (it == stored_properties.end()) {
+      new_properties.push_back({property_name, property_type});
+    } else if (it->second != property_type) {
+      // for stored properties, type should not be changed.
+      return absl::AlreadyExistsError(
+          absl::StrCat("Property:", property_name,
+                       " type is different from the existing type: ",
+                       stored_type.DebugString()));
+    }
+  }
+  if (new_properties.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  Type& type_to_update = GetTypeTable<Type>(*db).types.at(stored_type.id());
+  for (const auto& property : new_properties) {
+    (*type_to_update.mutable_properties())[property.first] = property.second;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateType(
+    const ArtifactType& type) {
+  return UpdateTypeImpl(type);
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateType(
+    const ExecutionType& type) {
+  return UpdateTypeImpl(type);
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateType(const ContextType& type) {
+  return UpdateTypeImpl(type);
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::FindTypeImpl(const int64 type_id,
+                                                        Type* type) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const InMemoryTypeTable<Type>& table = GetTypeTable<Type>(*db);
+  const auto it = table.types.find(type_id);
+  if (it == table.types.end()) {
+    return absl::NotFoundError(
+        absl::StrCat("No type found for query, type_id: ", type_id));
+  }
+  *type = it->second;
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::FindTypeImpl(
+    const absl::string_view name,
+    const absl::optional<absl::string_view> version, Type* type) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const InMemoryTypeTable<Type>& table = GetTypeTable<Type>(*db);
+  // An empty version is treated as unset, which is indexed as empty.
+  const auto it = table.ids_by_name_and_version.find(
+      std::make_pair(std::string(name), std::string(version.value_or(""))));
+  if (it == table.ids_by_name_and_version.end() || it->second.empty()) {
+    return absl::NotFoundError(
+        absl::StrCat("No type found for query, name: `", name, "`, version: `",
+                     version ? *version : "nullopt", "`"));
+  }
+  *type = table.types.at(*it->second.begin());
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypeById(
+    const int64 type_id, ArtifactType* artifact_type) {
+  return FindTypeImpl(type_id, artifact_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypeById(
+    const int64 type_id, ExecutionType* execution_type) {
+  return FindTypeImpl(type_id, execution_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypeById(
+    const int64 type_id, ContextType* context_type) {
+  return FindTypeImpl(type_id, context_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypeByNameAndVersion(
+    absl::string_view name, absl::optional<absl::string_view> version,
+    ArtifactType* artifact_type) {
+  return FindTypeImpl(name, version, artifact_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypeByNameAndVersion(
+    absl::string_view name, absl::optional<absl::string_view> version,
+    ExecutionType* execution_type) {
+  return FindTypeImpl(name, version, execution_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypeByNameAndVersion(
+    absl::string_view name, absl::optional<absl::string_view> version,
+    ContextType* context_type) {
+  return FindTypeImpl(name, version, context_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypeIdByNameAndVersion(
+    absl::string_view name, absl::optional<absl::string_view> version,
+    TypeKind type_kind, int64* type_id) {
+  switch (type_kind) {
+    case TypeKind::ARTIFACT_TYPE: {
+      ArtifactType type;
+      MLMD_RETURN_IF_ERROR(FindTypeImpl(name, version, &type));
+      *type_id = type.id();
+      return absl::OkStatus();
+    }
+    case TypeKind::EXECUTION_TYPE: {
+      ExecutionType type;
+      MLMD_RETURN_IF_ERROR(FindTypeImpl(name, version, &type));
+      *type_id = type.id();
+      return absl::OkStatus();
+    }
+    case TypeKind::CONTEXT_TYPE: {
+      ContextType type;
+      MLMD_RETURN_IF_ERROR(FindTypeImpl(name, version, &type));
+      *type_id = type.id();
+      return absl::OkStatus();
+    }
+    default:
+      return absl::InvalidArgumentError("Unknown type kind.");
+  }
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::FindAllTypeInstancesImpl(
+    std::vector<Type>* types) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const InMemoryTypeTable<Type>& table = GetTypeTable<Type>(*db);
+  types->clear();
+  types->reserve(table.types.size());
+  for (const auto& id_and_type : table.types) {
+    types->push_back(id_and_type.second);
+  }
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::CreateTypesImpl(
+    const absl::Span<const Type> types, std::vector<int64>* type_ids) {
+  type_ids->clear();
+  for (const Type& type : types) {
+    int64 type_id;
+    MLMD_RETURN_IF_ERROR(CreateTypeImpl(type, &type_id));
+    type_ids->push_back(type_id);
+  }
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::AddTypePropertiesImpl(
+    const absl::Span<const Type> types) {
+  for (const Type& type : types) {
+    if (!type.has_id()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("No type id is specified: ", type.DebugString()));
+    }
+    for (const auto& property : type.properties()) {
+      if (property.second == PropertyType::UNKNOWN) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Property ", property.first, " is UNKNOWN."));
+      }
+    }
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  InMemoryTypeTable<Type>& table = GetTypeTable<Type>(*db);
+  for (const Type& type : types) {
+    const auto it = table.types.find(type.id());
+    if (it == table.types.end()) {
+      return absl::NotFoundError(
+          absl::StrCat("No type found for query, type_id: ", type.id()));
+    }
+    for (const auto& property : type.properties()) {
+      (*it->second.mutable_properties())[property.first] = property.second;
+    }
+  }
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::FindTypesByNamesImpl(
+    const absl::Span<const std::string> names, std::vector<Type>* types) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const absl::flat_hash_set<std::string> name_set(names.begin(), names.end());
+  types->clear();
+  for (const auto& id_and_type : GetTypeTable<Type>(*db).types) {
+    if (name_set.contains(id_and_type.second.name())) {
+      types->push_back(id_and_type.second);
+    }
+  }
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::FindTypesByIdsImpl(
+    const absl::Span<const int64> type_ids, std::vector<Type>* types) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const InMemoryTypeTable<Type>& table = GetTypeTable<Type>(*db);
+  const absl::flat_hash_set<int64> id_set(type_ids.begin(), type_ids.end());
+  types->clear();
+  for (const int64 type_id : id_set) {
+    const auto it = table.types.find(type_id);
+    if (it != table.types.end()) {
+      types->push_back(it->second);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateTypes(
+    const absl::Span<const ArtifactType> types, std::vector<int64>* type_ids) {
+  return CreateTypesImpl(types, type_ids);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateTypes(
+    const absl::Span<const ExecutionType> types, std::vector<int64>* type_ids) {
+  return CreateTypesImpl(types, type_ids);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateTypes(
+    const absl::Span<const ContextType> types, std::vector<int64>* type_ids) {
+  return CreateTypesImpl(types, type_ids);
+}
+
+absl::Status InMemoryMetadataAccessObject::AddTypeProperties(
+    const absl::Span<const ArtifactType> types) {
+  return AddTypePropertiesImpl(types);
+}
+
+absl::Status InMemoryMetadataAccessObject::AddTypeProperties(
+    const absl::Span<const ExecutionType> types) {
+  return AddTypePropertiesImpl(types);
+}
+
+absl::Status InMemoryMetadataAccessObject::AddTypeProperties(
+    const absl::Span<const ContextType> types) {
+  return AddTypePropertiesImpl(types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypesByNames(
+    const absl::Span<const std::string> names,
+    std::vector<ArtifactType>* types) {
+  return FindTypesByNamesImpl(names, types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypesByNames(
+    const absl::Span<const std::string> names,
+    std::vector<ExecutionType>* types) {
+  return FindTypesByNamesImpl(names, types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypesByNames(
+    const absl::Span<const std::string> names,
+    std::vector<ContextType>* types) {
+  return FindTypesByNamesImpl(names, types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypesByIds(
+    const absl::Span<const int64> type_ids, std::vector<ArtifactType>* types) {
+  return FindTypesByIdsImpl(type_ids, types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypesByIds(
+    const absl::Span<const int64> type_ids, std::vector<ExecutionType>* types) {
+  return FindTypesByIdsImpl(type_ids, types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypesByIds(
+    const absl::Span<const int64> type_ids, std::vector<ContextType>* types) {
+  return FindTypesByIdsImpl(type_ids, types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypes(
+    std::vector<ArtifactType>* artifact_types) {
+  return FindAllTypeInstancesImpl(artifact_types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypes(
+    std::vector<ExecutionType>* execution_types) {
+  return FindAllTypeInstancesImpl(execution_types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindTypes(
+    std::vector<ContextType>* context_types) {
+  return FindAllTypeInstancesImpl(context_types);
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::CreateParentTypeInheritanceLinkImpl(
+    const Type& type, const Type& parent_type) {
+  if (!type.has_id() || !parent_type.has_id()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Missing id in the given types: ", type.DebugString(),
+                     parent_type.DebugString()));
+  }
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  MLMD_RETURN_IF_ERROR(CheckCyClicDependency(
+      /*child_id=*/type.id(), /*parent_id=*/parent_type.id(),
+      db->parent_type_ids));
+  if (GetLinkedIds(db->parent_type_ids, type.id())
+          .contains(parent_type.id())) {
+    return absl::AlreadyExistsError("The ParentType already exists.");
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * mutable_db,
+                        metadata_source_->GetMutableDatabase());
+  mutable_db->parent_type_ids[type.id()].insert(parent_type.id());
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateParentTypeInheritanceLink(
+    const ArtifactType& type, const ArtifactType& parent_type) {
+  return CreateParentTypeInheritanceLinkImpl(type, parent_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateParentTypeInheritanceLink(
+    const ExecutionType& type, const ExecutionType& parent_type) {
+  return CreateParentTypeInheritanceLinkImpl(type, parent_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateParentTypeInheritanceLink(
+    const ContextType& type, const ContextType& parent_type) {
+  return CreateParentTypeInheritanceLinkImpl(type, parent_type);
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteParentTypeInheritanceLink(
+    const int64 type_id, const int64 parent_type_id) {
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  auto it = db->parent_type_ids.find(type_id);
+  if (it == db->parent_type_ids.end()) return absl::OkStatus();
+  it->second.erase(parent_type_id);
+  if (it->second.empty()) db->parent_type_ids.erase(it);
+  return absl::OkStatus();
+}
+
+template <typename Type>
+absl::Status InMemoryMetadataAccessObject::FindParentTypesByTypeIdImpl(
+    const absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, Type>& output_parent_types) {
+  if (type_ids.empty()) {
+    return absl::InvalidArgumentError("type_ids cannot be empty");
+  }
+  if (!output_parent_types.empty()) {
+    return absl::InvalidArgumentError("output_parent_types is not empty");
+  }
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  // Only single inheritance is supported, so the first parent type is used.
+  absl::btree_map<int64, int64> parent_type_id_by_type_id;
+  for (const int64 type_id : type_ids) {
+    const absl::btree_set<int64>& parent_ids =
+        GetLinkedIds(db->parent_type_ids, type_id);
+    if (!parent_ids.empty()) {
+      parent_type_id_by_type_id[type_id] = *parent_ids.begin();
+    }
+  }
+  const InMemoryTypeTable<Type>& table = GetTypeTable<Type>(*db);
+  absl::btree_set<int64> missing_ids;
+  for (const auto& ids : parent_type_id_by_type_id) {
+    const auto it = table.types.find(ids.second);
+    if (it == table.types.end()) {
+      missing_ids.insert(ids.second);
+      continue;
+    }
+    output_parent_types.insert({ids.first, GetTypeHeader(it->second)});
+  }
+  if (!missing_ids.empty()) {
+    output_parent_types.clear();
+    return absl::NotFoundError(absl::StrCat("Results missing for ids: {",
+                                            absl::StrJoin(missing_ids, ","),
+                                            "}"));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindParentTypesByTypeId(
+    absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, ArtifactType>& output_parent_types) {
+  return FindParentTypesByTypeIdImpl(type_ids, output_parent_types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindParentTypesByTypeId(
+    absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, ExecutionType>& output_parent_types) {
+  return FindParentTypesByTypeIdImpl(type_ids, output_parent_types);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindParentTypesByTypeId(
+    absl::Span<const int64> type_ids,
+    absl::flat_hash_map<int64, ContextType>& output_parent_types) {
+  return FindParentTypesByTypeIdImpl(type_ids, output_parent_types);
+}
+
+template <typename Node, typename NodeType>
+absl::Status InMemoryMetadataAccessObject::CreateNodesImpl(
+    const absl::Span<const Node> nodes, std::vector<int64>* node_ids) {
+  node_ids->clear();
+  // validate the nodes, and find each of their types once
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const InMemoryNodeTable<Node>& table = GetNodeTable<Node>(*db);
+  absl::flat_hash_map<int64, NodeType> node_types;
+  absl::flat_hash_set<std::pair<int64, std::string>> names;
+  for (const Node& node : nodes) {
+    if (!node.has_type_id())
+      return absl::InvalidArgumentError("Type id is missing.");
+    auto it = node_types.find(node.type_id());
+    if (it == node_types.end()) {
+      NodeType node_type;
+      MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+          FindTypeImpl(node.type_id(), &node_type), "Cannot find type for ",
+          node.ShortDebugString());
+      it = node_types.insert({node.type_id(), node_type}).first;
+    }
+    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+        ValidatePropertiesWithType(node, it->second),
+        "Cannot validate properties of ", node.ShortDebugString());
+    MLMD_RETURN_IF_ERROR(ValidateNodeName(node));
+    if (node.has_name()) {
+      std::pair<int64, std::string> name = {node.type_id(), node.name()};
+      if (table.id_by_type_id_and_name.contains(name) ||
+          !names.insert(std::move(name)).second) {
+        return absl::AlreadyExistsError(absl::StrCat(
+            "Some of the given nodes already exist: ", node.DebugString()));
+      }
+    }
+  }
+  if (nodes.empty()) {
+    return absl::OkStatus();
+  }
+
+  // insert the nodes and assign the ids
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * mutable_db,
+                        metadata_source_->GetMutableDatabase());
+  InMemoryNodeTable<Node>& mutable_table = GetNodeTable<Node>(*mutable_db);
+  const int64 now = absl::ToUnixMillis(absl::Now());
+  node_ids->reserve(nodes.size());
+  for (const Node& node : nodes) {
+    Node stored_node = GetNodeToStore(node);
+    stored_node.set_id(++mutable_table.last_id);
+    stored_node.set_create_time_since_epoch(now);
+    stored_node.set_last_update_time_since_epoch(now);
+    node_ids->push_back(stored_node.id());
+    InsertNode(std::move(stored_node), *mutable_db);
+  }
+  AppendNodeChangeLogEntries(ChangeLogKind(nodes.front()),
+                             ChangeLogEntry::CREATED, *node_ids, *mutable_db);
+  return absl::OkStatus();
+}
+
+template <typename Node, typename NodeType>
+absl::Status InMemoryMetadataAccessObject::CreateNodeIfNotExistImpl(
+    const Node& node, int64* node_id, bool* is_created) {
+  *node_id = 0;
+  *is_created = false;
+  if (!node.has_name() || node.name().empty()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Node name should not be empty: ",
+                     node.ShortDebugString()));
+  }
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const InMemoryNodeTable<Node>& table = GetNodeTable<Node>(*db);
+  const auto it =
+      table.id_by_type_id_and_name.find({node.type_id(), node.name()});
+  if (it != table.id_by_type_id_and_name.end()) {
+    // the stored node is kept, but the given one is validated as if created
+    NodeType node_type;
+    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+        FindTypeImpl(node.type_id(), &node_type), "Cannot find type for ",
+        node.ShortDebugString());
+    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+        ValidatePropertiesWithType(node, node_type),
+        "Cannot validate properties of ", node.ShortDebugString());
+    *node_id = it->second;
+    return absl::OkStatus();
+  }
+  std::vector<int64> node_ids;
+  MLMD_RETURN_IF_ERROR(CreateNodesImpl<Node, NodeType>(
+      absl::MakeConstSpan(&node, 1), &node_ids));
+  *node_id = node_ids.front();
+  *is_created = true;
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::FindNodesImpl(
+    const absl::Span<const int64> node_ids, const bool skipped_ids_ok,
+    std::vector<Node>& nodes,
+    const ListOperationOptions::PropertyProjection& projection) {
+  if (node_ids.empty()) {
+    return absl::InvalidArgumentError("ids cannot be empty");
+  }
+  if (!nodes.empty()) {
+    return absl::InvalidArgumentError("nodes parameter is not empty");
+  }
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const InMemoryNodeTable<Node>& table = GetNodeTable<Node>(*db);
+  // The nodes are returned once in the id order.
+  const absl::btree_set<int64> ids(node_ids.begin(), node_ids.end());
+  nodes.reserve(ids.size());
+  for (const int64 id : ids) {
+    const auto it = table.nodes.find(id);
+    if (it != table.nodes.end()) {
+      nodes.push_back(ProjectNode(it->second, projection));
+    } else if (const Node* archived_node = FindArchivedNode<Node>(*db, id)) {
+      nodes.push_back(ProjectNode(*archived_node, projection));
+    }
+  }
+  if (node_ids.size() != nodes.size()) {
+    std::vector<int64> found_ids;
+    absl::c_transform(nodes, std::back_inserter(found_ids),
+                      [](const Node& node) { return node.id(); });
+    const std::string message = absl::StrCat(
+        "Results missing for ids: {", absl::StrJoin(node_ids, ","),
+        "}. Found results for {", absl::StrJoin(found_ids, ","), "}");
+    if (!skipped_ids_ok) {
+      return absl::InternalError(message);
+    } else {
+      return absl::NotFoundError(message);
+    }
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::FindAllNodesImpl(
+    std::vector<Node>* nodes) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const InMemoryNodeTable<Node>& table = GetNodeTable<Node>(*db);
+  nodes->reserve(nodes->size() + table.nodes.size());
+  for (const auto& id_and_node : table.nodes) {
+    nodes->push_back(id_and_node.second);
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::FindNodesByTypeIdImpl(
+    const int64 type_id, absl::optional<ListOperationOptions> list_options,
+    std::vector<Node>* nodes, std::string* next_page_token) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const InMemoryNodeTable<Node>& table = GetNodeTable<Node>(*db);
+  const absl::btree_set<int64>& id_set =
+      GetLinkedIds(table.ids_by_type_id, type_id);
+  const std::vector<int64> ids(id_set.begin(), id_set.end());
+  if (ids.empty()) {
+    return absl::NotFoundError(
+        absl::StrCat(NodesNotFoundPrefix(Node()), type_id));
+  }
+  if (list_options) {
+    return ListNodes<Node>(list_options.value(), ids, nodes, next_page_token);
+  }
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *nodes);
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::FindNodeByTypeIdAndNameImpl(
+    const int64 type_id, const absl::string_view name, Node* node) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const InMemoryNodeTable<Node>& table = GetNodeTable<Node>(*db);
+  const auto it =
+      table.id_by_type_id_and_name.find({type_id, std::string(name)});
+  if (it == table.id_by_type_id_and_name.end()) {
+    return absl::NotFoundError(absl::StrCat(NodesNotFoundPrefix(Node()),
+                                            type_id, NameSeparator(Node()),
+                                            name));
+  }
+  *node = table.nodes.at(it->second);
+  return absl::OkStatus();
+}
+
+template <typename Node, typename NodeType>
+absl::Status InMemoryMetadataAccessObject::UpdateNodeImpl(const Node& node) {
+  // validate node
+  if (!node.has_id()) return absl::InvalidArgumentError("No id is given.");
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const InMemoryNodeTable<Node>& table = GetNodeTable<Node>(*db);
+  const auto it = table.nodes.find(node.id());
+  if (it == table.nodes.end()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Cannot find the given id ", node.id()));
+  }
+  const Node& stored_node = it->second;
+  if (node.has_type_id() && node.type_id() != stored_node.type_id()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Given type_id ", node.type_id(),
+        " is different from the one known before: ", stored_node.type_id()));
+  }
+  NodeType stored_type;
+  MLMD_RETURN_IF_ERROR(FindTypeImpl(stored_node.type_id(), &stored_type));
+  MLMD_RETURN_IF_ERROR(ValidatePropertiesWithType(node, stored_type));
+
+  // Update node if attributes are different or properties are updated, so that
+  // the last_update_time_since_epoch is updated properly.
+  google::protobuf::util::MessageDifferencer diff;
+  diff.IgnoreField(Node::descriptor()->FindFieldByName("properties"));
+  diff.IgnoreField(Node::descriptor()->FindFieldByName("custom_properties"));
+  // create_time_since_epoch and last_update_time_since_epoch are output only
+  // fields. Two nodes are treated as equal as long as other fields match.
+  diff.IgnoreField(
+      Node::descriptor()->FindFieldByName("create_time_since_epoch"));
+  diff.IgnoreField(
+      Node::descriptor()->FindFieldByName("last_update_time_since_epoch"));
+  if (diff.Compare(node, stored_node) &&
+      PropertiesEqual(node.properties(), stored_node.properties()) &&
+      PropertiesEqual(node.custom_properties(),
+                      stored_node.custom_properties())) {
+    return absl::OkStatus();
+  }
+  MLMD_RETURN_IF_ERROR(ValidateNodeName(node));
+  Node updated_node = stored_node;
+  ApplyNodeUpdate(node, absl::ToUnixMillis(absl::Now()), updated_node);
+  *updated_node.mutable_properties() = node.properties();
+  *updated_node.mutable_custom_properties() = node.custom_properties();
+  if (updated_node.has_name()) {
+    const auto name_it = table.id_by_type_id_and_name.find(
+        {updated_node.type_id(), updated_node.name()});
+    if (name_it != table.id_by_type_id_and_name.end() &&
+        name_it->second != node.id()) {
+      return absl::AlreadyExistsError(absl::StrCat(
+          "Given node already exists: ", updated_node.DebugString()));
+    }
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * mutable_db,
+                        metadata_source_->GetMutableDatabase());
+  EraseNode<Node>(node.id(), *mutable_db);
+  InsertNode(std::move(updated_node), *mutable_db);
+  AppendNodeChangeLogEntries(ChangeLogKind(node), ChangeLogEntry::UPDATED,
+                             {node.id()}, *mutable_db);
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::ListNodes(
+    const ListOperationOptions& options,
+    absl::optional<absl::Span<const int64>> candidate_ids,
+    std::vector<Node>* nodes, std::string* next_page_token) {
+  if (options.max_result_size() <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("max_result_size field value is required to be greater "
+                     "than 0 and less than or equal to 100. Set value:",
+                     options.max_result_size()));
+  }
+  if (!nodes->empty()) {
+    return absl::InvalidArgumentError("nodes argument is not empty");
+  }
+  MLMD_RETURN_IF_ERROR(ValidateBulkExportListOperationOptions(options));
+  if (options.has_filter_query() && !options.filter_query().empty()) {
+    return absl::UnimplementedError(
+        "Filter queries are not supported by the in-memory metadata access "
+        "object.");
+  }
+  const ListOperationOptions::OrderByField::Field field =
+      options.order_by_field().field();
+  if (field != ListOperationOptions::OrderByField::CREATE_TIME &&
+      field != ListOperationOptions::OrderByField::LAST_UPDATE_TIME &&
+      field != ListOperationOptions::OrderByField::ID) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unsupported field: ",
+                     ListOperationOptions::OrderByField::Field_Name(field),
+                     " specified in ListOperationOptions"));
+  }
+  *next_page_token = "";
+  if (candidate_ids && candidate_ids->empty()) {
+    return absl::OkStatus();
+  }
+  const bool is_asc = options.order_by_field().is_asc();
+
+  // The ordering threshold of the page, i.e., the (field, id) offsets of the
+  // last node of the previous page, or the listed ids of the ties on the last
+  // update time.
+  int64 field_offset = is_asc ? 0 : LLONG_MAX;
+  absl::optional<int64> id_offset;
+  absl::flat_hash_set<int64> listed_ids;
+  if (!options.next_page_token().empty()) {
+    ListOperationNextPageToken next_page_token_proto;
+    MLMD_RETURN_IF_ERROR(
+        ValidateAndDecodeNextPageToken(options, next_page_token_proto));
+    field_offset = next_page_token_proto.field_offset();
+    if (field == ListOperationOptions::OrderByField::CREATE_TIME) {
+      id_offset = next_page_token_proto.id_offset();
+    } else if (field == ListOperationOptions::OrderByField::LAST_UPDATE_TIME) {
+      if (next_page_token_proto.listed_ids().empty()) {
+        return absl::InternalError(
+            "Invalid NextPageToken in List Operation. listed_ids field should "
+            "not be empty.");
+      }
+      listed_ids.insert(next_page_token_proto.listed_ids().begin(),
+                        next_page_token_proto.listed_ids().end());
+    }
+  }
+  const auto is_in_page = [&](const Node& node) {
+    const int64 value = GetOrderingFieldValue(node, field);
+    // The ids are unique, so the threshold on the ids is strict.
+    if (field == ListOperationOptions::OrderByField::ID) {
+      return is_asc ? value > field_offset : value < field_offset;
+    }
+    if (is_asc ? value < field_offset : value > field_offset) return false;
+    if (id_offset) {
+      return is_asc ? node.id() > *id_offset : node.id() < *id_offset;
+    }
+    return !listed_ids.contains(node.id());
+  };
+
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const InMemoryNodeTable<Node>& table = GetNodeTable<Node>(*db);
+  std::vector<std::pair<int64, int64>> keys;
+  const auto add_if_in_page = [&](const Node& node) {
+    if (is_in_page(node)) {
+      keys.push_back({GetOrderingFieldValue(node, field), node.id()});
+    }
+  };
+  if (candidate_ids) {
+    for (const int64 id : absl::btree_set<int64>(candidate_ids->begin(),
+                                                 candidate_ids->end())) {
+      const auto it = table.nodes.find(id);
+      if (it != table.nodes.end()) add_if_in_page(it->second);
+    }
+  } else {
+    for (const auto& id_and_node : table.nodes) {
+      add_if_in_page(id_and_node.second);
+    }
+  }
+  // Retrieving page of size 1 greater that max_result_size to detect if this
+  // is the last page.
+  const size_t num_nodes =
+      std::min<size_t>(options.max_result_size() + 1,
+                       GetMaxListOperationResultSize(options) + 1);
+  const auto comparator = [is_asc](const std::pair<int64, int64>& a,
+                                   const std::pair<int64, int64>& b) {
+    return is_asc ? a < b : a > b;
+  };
+  if (keys.size() > num_nodes) {
+    absl::c_nth_element(keys, keys.begin() + num_nodes, comparator);
+    keys.resize(num_nodes);
+  }
+  absl::c_sort(keys, comparator);
+  nodes->reserve(keys.size());
+  for (const auto& key : keys) {
+    nodes->push_back(
+        ProjectNode(table.nodes.at(key.second), options.property_projection()));
+  }
+
+  if (nodes->size() > options.max_result_size()) {
+    // Removing the extra node retrieved for last page detection.
+    nodes->pop_back();
+    MLMD_RETURN_IF_ERROR(BuildListOperationNextPageToken<Node>(
+        *nodes, options, next_page_token));
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::DeleteNodesImpl(
+    const absl::Span<const int64> node_ids) {
+  if (node_ids.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  for (const int64 node_id : node_ids) {
+    EraseNode<Node>(node_id, *db);
+  }
+  AppendNodeChangeLogEntries(ChangeLogKind(Node()), ChangeLogEntry::DELETED,
+                             node_ids, *db);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateArtifact(
+    const Artifact& artifact, int64* artifact_id) {
+  *artifact_id = 0;
+  std::vector<int64> artifact_ids;
+  const absl::Status status = CreateNodesImpl<Artifact, ArtifactType>(
+      absl::MakeConstSpan(&artifact, 1), &artifact_ids);
+  if (absl::IsAlreadyExists(status)) {
+    return absl::AlreadyExistsError(
+        absl::StrCat("Given node already exists: ", artifact.DebugString()));
+  }
+  MLMD_RETURN_IF_ERROR(status);
+  *artifact_id = artifact_ids.front();
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateArtifacts(
+    const absl::Span<const Artifact> artifacts,
+    std::vector<int64>* artifact_ids) {
+  return CreateNodesImpl<Artifact, ArtifactType>(artifacts, artifact_ids);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateArtifactIfNotExist(
+    const Artifact& artifact, int64* artifact_id, bool* is_created) {
+  return CreateNodeIfNotExistImpl<Artifact, ArtifactType>(artifact,
+                                                          artifact_id,
+                                                          is_created);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateExecution(
+    const Execution& execution, int64* execution_id) {
+  *execution_id = 0;
+  std::vector<int64> execution_ids;
+  const absl::Status status = CreateNodesImpl<Execution, ExecutionType>(
+      absl::MakeConstSpan(&execution, 1), &execution_ids);
+  if (absl::IsAlreadyExists(status)) {
+    return absl::AlreadyExistsError(
+        absl::StrCat("Given node already exists: ", execution.DebugString()));
+  }
+  MLMD_RETURN_IF_ERROR(status);
+  *execution_id = execution_ids.front();
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateExecutions(
+    const absl::Span<const Execution> executions,
+    std::vector<int64>* execution_ids) {
+  return CreateNodesImpl<Execution, ExecutionType>(executions, execution_ids);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateContext(const Context& context,
+                                                         int64* context_id) {
+  *context_id = 0;
+  std::vector<int64> context_ids;
+  const absl::Status status = CreateNodesImpl<Context, ContextType>(
+      absl::MakeConstSpan(&context, 1), &context_ids);
+  if (absl::IsAlreadyExists(status)) {
+    return absl::AlreadyExistsError(
+        absl::StrCat("Given node already exists: ", context.DebugString()));
+  }
+  MLMD_RETURN_IF_ERROR(status);
+  *context_id = context_ids.front();
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateContexts(
+    const absl::Span<const Context> contexts, std::vector<int64>* context_ids) {
+  return CreateNodesImpl<Context, ContextType>(contexts, context_ids);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateContextIfNotExist(
+    const Context& context, int64* context_id, bool* is_created) {
+  return CreateNodeIfNotExistImpl<Context, ContextType>(context, context_id,
+                                                        is_created);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsById(
+    const absl::Span<const int64> artifact_ids,
+    std::vector<Artifact>* artifacts) {
+  if (artifact_ids.empty()) {
+    return absl::OkStatus();
+  }
+  return FindNodesImpl(artifact_ids, /*skipped_ids_ok=*/true, *artifacts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutionsById(
+    const absl::Span<const int64> execution_ids,
+    std::vector<Execution>* executions) {
+  if (execution_ids.empty()) {
+    return absl::OkStatus();
+  }
+  return FindNodesImpl(execution_ids, /*skipped_ids_ok=*/true, *executions);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextsById(
+    const absl::Span<const int64> context_ids, std::vector<Context>* contexts) {
+  if (context_ids.empty()) {
+    return absl::OkStatus();
+  }
+  return FindNodesImpl(context_ids, /*skipped_ids_ok=*/true, *contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactLastUpdateTimes(
+    const absl::Span<const int64> artifact_ids,
+    absl::flat_hash_map<int64, int64>* last_update_times) {
+  last_update_times->clear();
+  if (artifact_ids.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const InMemoryNodeTable<Artifact>& table = GetNodeTable<Artifact>(*db);
+  for (const int64 artifact_id : artifact_ids) {
+    const auto it = table.nodes.find(artifact_id);
+    if (it != table.nodes.end()) {
+      last_update_times->insert(
+          {artifact_id, it->second.last_update_time_since_epoch()});
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifacts(
+    std::vector<Artifact>* artifacts) {
+  return FindAllNodesImpl(artifacts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutions(
+    std::vector<Execution>* executions) {
+  return FindAllNodesImpl(executions);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContexts(
+    std::vector<Context>* contexts) {
+  return FindAllNodesImpl(contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::ListArtifacts(
+    const ListOperationOptions& options, std::vector<Artifact>* artifacts,
+    std::string* next_page_token) {
+  return ListNodes<Artifact>(options, absl::nullopt, artifacts,
+                             next_page_token);
+}
+
+absl::Status InMemoryMetadataAccessObject::ListExecutions(
+    const ListOperationOptions& options, std::vector<Execution>* executions,
+    std::string* next_page_token) {
+  return ListNodes<Execution>(options, absl::nullopt, executions,
+                              next_page_token);
+}
+
+absl::Status InMemoryMetadataAccessObject::ListContexts(
+    const ListOperationOptions& options, std::vector<Context>* contexts,
+    std::string* next_page_token) {
+  return ListNodes<Context>(options, absl::nullopt, contexts, next_page_token);
+}
+
+template <typename Node>
+absl::Status InMemoryMetadataAccessObject::CountNodesImpl(
+    const CountOptions& options, std::vector<NodeCount>* counts) {
+  MLMD_RETURN_IF_ERROR(ValidateCountOptions(
+      options, /*counts_contexts=*/std::is_same<Node, Context>::value));
+  if (!options.filter_query().empty()) {
+    return absl::UnimplementedError(
+        "Filter queries are not supported by the in-memory metadata access "
+        "object.");
+  }
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  using Group = std::vector<absl::optional<int64>>;
+  // The counts keyed by the dimensions of the groups, which are ordered with
+  // the missing values first, as the GROUP BY queries order the NULL values.
+  absl::btree_map<Group, int64> count_by_group;
+  if (options.group_by().empty()) {
+    count_by_group[Group()] = 0;
+  }
+  for (const auto& id_and_node : GetNodeTable<Node>(*db).nodes) {
+    const Node& node = id_and_node.second;
+    // A node is in a group per context when grouped by context.
+    std::vector<Group> groups(1);
+    for (const int group_by : options.group_by()) {
+      if (group_by == CountOptions::CONTEXT) {
+        std::vector<Group> context_groups;
+        for (const int64 context_id : GetCountedContextIds(*db, node)) {
+          for (Group group : groups) {
+            group.push_back(context_id);
+            context_groups.push_back(std::move(group));
+          }
+        }
+        groups = std::move(context_groups);
+        continue;
+      }
+      absl::optional<int64> value;
+      if (group_by == CountOptions::TYPE) {
+        value = node.type_id();
+      } else if (group_by == CountOptions::STATE) {
+        value = GetCountedState(node);
+      } else if (group_by == CountOptions::CREATE_TIME_BUCKET) {
+        value = node.create_time_since_epoch() -
+                node.create_time_since_epoch() % options.time_bucket_ms();
+      }
+      for (Group& group : groups) {
+        group.push_back(value);
+      }
+    }
+    for (Group& group : groups) {
+      count_by_group[std::move(group)]++;
+    }
+  }
+
+  counts->clear();
+  counts->reserve(count_by_group.size());
+  for (const auto& group_and_count : count_by_group) {
+    NodeCount& count = counts->emplace_back();
+    for (int i = 0; i < options.group_by_size(); i++) {
+      const absl::optional<int64>& value = group_and_count.first[i];
+      if (!value) continue;
+      switch (options.group_by(i)) {
+        case CountOptions::TYPE:
+          count.set_type_id(*value);
+          break;
+        case CountOptions::STATE:
+          count.set_state(*value);
+          break;
+        case CountOptions::CONTEXT:
+          count.set_context_id(*value);
+          break;
+        case CountOptions::CREATE_TIME_BUCKET:
+          count.set_create_time_bucket_start(*value);
+          break;
+        case CountOptions::GROUP_BY_UNSPECIFIED:
+          // Rejected by ValidateCountOptions.
+          break;
+      }
+    }
+    count.set_count(group_and_count.second);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CountArtifacts(
+    const CountOptions& options, std::vector<NodeCount>* counts) {
+  return CountNodesImpl<Artifact>(options, counts);
+}
+
+absl::Status InMemoryMetadataAccessObject::CountExecutions(
+    const CountOptions& options, std::vector<NodeCount>* counts) {
+  return CountNodesImpl<Execution>(options, counts);
+}
+
+absl::Status InMemoryMetadataAccessObject::CountContexts(
+    const CountOptions& options, std::vector<NodeCount>* counts) {
+  return CountNodesImpl<Context>(options, counts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactByTypeIdAndArtifactName(
+    const int64 type_id, const absl::string_view name, Artifact* artifact) {
+  return FindNodeByTypeIdAndNameImpl(type_id, name, artifact);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsByTypeId(
+    const int64 type_id, absl::optional<ListOperationOptions> list_options,
+    std::vector<Artifact>* artifacts, std::string* next_page_token) {
+  return FindNodesByTypeIdImpl(type_id, list_options, artifacts,
+                               next_page_token);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsByURI(
+    const absl::string_view uri, std::vector<Artifact>* artifacts) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const auto it = db->artifact_ids_by_uri.find(std::string(uri));
+  if (it == db->artifact_ids_by_uri.end()) {
+    return absl::NotFoundError(
+        absl::StrCat("No artifacts found for uri:", uri));
+  }
+  const std::vector<int64> ids(it->second.begin(), it->second.end());
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *artifacts);
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateArtifact(
+    const Artifact& artifact) {
+  return UpdateNodeImpl<Artifact, ArtifactType>(artifact);
+}
+
+absl::Status
+InMemoryMetadataAccessObject::FindExecutionByTypeIdAndExecutionName(
+    const int64 type_id, const absl::string_view name, Execution* execution) {
+  return FindNodeByTypeIdAndNameImpl(type_id, name, execution);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutionsByTypeId(
+    const int64 type_id, absl::optional<ListOperationOptions> list_options,
+    std::vector<Execution>* executions, std::string* next_page_token) {
+  return FindNodesByTypeIdImpl(type_id, list_options, executions,
+                               next_page_token);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindActiveExecutionsByTypeId(
+    const int64 type_id, std::vector<Execution>* executions) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const InMemoryNodeTable<Execution>& table = GetNodeTable<Execution>(*db);
+  std::vector<int64> ids;
+  for (const int64 id : GetLinkedIds(table.ids_by_type_id, type_id)) {
+    const Execution::State state = table.nodes.at(id).last_known_state();
+    if (state == Execution::NEW || state == Execution::RUNNING) {
+      ids.push_back(id);
+    }
+  }
+  if (ids.empty()) {
+    return absl::NotFoundError(
+        absl::StrCat("No active executions found for type_id:", type_id));
+  }
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *executions);
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateExecution(
+    const Execution& execution) {
+  return UpdateNodeImpl<Execution, ExecutionType>(execution);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextsByTypeId(
+    const int64 type_id, absl::optional<ListOperationOptions> list_options,
+    std::vector<Context>* contexts, std::string* next_page_token) {
+  return FindNodesByTypeIdImpl(type_id, list_options, contexts,
+                               next_page_token);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextByTypeIdAndContextName(
+    const int64 type_id, const absl::string_view name, Context* context) {
+  return FindNodeByTypeIdAndNameImpl(type_id, name, context);
+}
+
+absl::Status InMemoryMetadataAccessObject::UpdateContext(
+    const Context& context) {
+  return UpdateNodeImpl<Context, ContextType>(context);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateEvent(const Event& event,
+                                                       int64* event_id) {
+  std::vector<int64> event_ids;
+  const absl::Status status =
+      CreateEvents(absl::MakeConstSpan(&event, 1), &event_ids);
+  if (absl::IsAlreadyExists(status)) {
+    return absl::AlreadyExistsError(
+        absl::StrCat("Given event already exists: ", event.DebugString()));
+  }
+  MLMD_RETURN_IF_ERROR(status);
+  *event_id = event_ids.front();
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateEvents(
+    const absl::Span<const Event> events, std::vector<int64>* event_ids) {
+  event_ids->clear();
+  if (events.empty()) {
+    return absl::OkStatus();
+  }
+  // validate the given events, and set the event time if not given.
+  const int64 now = absl::ToUnixMillis(absl::Now());
+  std::vector<Event> new_events(events.begin(), events.end());
+  absl::flat_hash_set<int64> artifact_ids, execution_ids;
+  for (Event& event : new_events) {
+    if (!event.has_artifact_id())
+      return absl::InvalidArgumentError("No artifact id is specified.");
+    if (!event.has_execution_id())
+      return absl::InvalidArgumentError("No execution id is specified.");
+    if (!event.has_type() || event.type() == Event::UNKNOWN)
+      return absl::InvalidArgumentError("No event type is specified.");
+    if (!event.has_milliseconds_since_epoch()) {
+      event.set_milliseconds_since_epoch(now);
+    }
+    // Only the steps of the path are stored.
+    if (event.path().steps().empty()) {
+      event.clear_path();
+    }
+    artifact_ids.insert(event.artifact_id());
+    execution_ids.insert(event.execution_id());
+  }
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  MLMD_RETURN_IF_ERROR(
+      CheckNodesFound<Artifact>(artifact_ids, *db, "artifact"));
+  MLMD_RETURN_IF_ERROR(
+      CheckNodesFound<Execution>(execution_ids, *db, "execution"));
+  absl::flat_hash_set<std::tuple<int64, int64, int>> keys;
+  for (const Event& event : new_events) {
+    std::tuple<int64, int64, int> key = {event.artifact_id(),
+                                         event.execution_id(), event.type()};
+    if (db->event_keys.contains(key) || !keys.insert(key).second) {
+      return absl::AlreadyExistsError(absl::StrCat(
+          "Some of the given events already exist: ", event.DebugString()));
+    }
+  }
+
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * mutable_db,
+                        metadata_source_->GetMutableDatabase());
+  event_ids->reserve(new_events.size());
+  for (Event& event : new_events) {
+    const int64 event_id = ++mutable_db->last_event_id;
+    event_ids->push_back(event_id);
+    mutable_db->event_ids_by_artifact_id[event.artifact_id()].insert(event_id);
+    mutable_db->event_ids_by_execution_id[event.execution_id()].insert(
+        event_id);
+    mutable_db->event_keys.insert(
+        {event.artifact_id(), event.execution_id(), event.type()});
+    AppendEventChangeLogEntry(event, *mutable_db);
+    mutable_db->events[event_id] = std::move(event);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindEventsImpl(
+    const absl::Span<const int64> keys, const bool by_artifacts,
+    const absl::string_view not_found_message, std::vector<Event>* events) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const LinkIndex& index = by_artifacts ? db->event_ids_by_artifact_id
+                                        : db->event_ids_by_execution_id;
+  absl::btree_set<int64> event_ids;
+  for (const int64 key : keys) {
+    const absl::btree_set<int64>& ids = GetLinkedIds(index, key);
+    event_ids.insert(ids.begin(), ids.end());
+  }
+  if (event_ids.empty()) {
+    return absl::NotFoundError(not_found_message);
+  }
+  events->reserve(events->size() + event_ids.size());
+  for (const int64 event_id : event_ids) {
+    events->push_back(db->events.at(event_id));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindEventsByArtifacts(
+    const std::vector<int64>& artifact_ids, std::vector<Event>* events) {
+  if (events == nullptr) {
+    return absl::InvalidArgumentError("Given events is NULL.");
+  }
+  return FindEventsImpl(artifact_ids, /*by_artifacts=*/true,
+                        "Cannot find events by given artifact ids.", events);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindEventsByExecutions(
+    const std::vector<int64>& execution_ids, std::vector<Event>* events) {
+  if (events == nullptr) {
+    return absl::InvalidArgumentError("Given events is NULL.");
+  }
+  return FindEventsImpl(execution_ids, /*by_artifacts=*/false,
+                        "Cannot find events by given execution ids.", events);
+}
+
+template <typename EventIds>
+absl::Status InMemoryMetadataAccessObject::ListEventsImpl(
+    EventIds event_ids, const absl::Span<const Event::Type> event_types,
+    const ListOperationOptions& options, std::vector<Event>* events,
+    std::string* next_page_token) {
+  if (events == nullptr) {
+    return absl::InvalidArgumentError("Given events is NULL.");
+  }
+  if (options.max_result_size() <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("max_result_size field value is required to be greater "
+                     "than 0 and less than or equal to 100. Set value:",
+                     options.max_result_size()));
+  }
+  MLMD_RETURN_IF_ERROR(ValidateBulkExportListOperationOptions(options));
+  if (options.has_filter_query() && !options.filter_query().empty()) {
+    return absl::InvalidArgumentError(
+        "filter_query is not supported when listing the events.");
+  }
+  const ListOperationOptions::OrderByField::Field field =
+      options.order_by_field().field();
+  if (field != ListOperationOptions::OrderByField::CREATE_TIME &&
+      field != ListOperationOptions::OrderByField::ID) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unsupported field: ",
+                     ListOperationOptions::OrderByField::Field_Name(field),
+                     " specified in ListOperationOptions of the events"));
+  }
+  *next_page_token = "";
+  const bool is_asc = options.order_by_field().is_asc();
+
+  // The (field, id) keyset of the last event of the previous page, if any.
+  absl::optional<std::pair<int64, int64>> offset;
+  if (!options.next_page_token().empty()) {
+    ListOperationNextPageToken next_page_token_proto;
+    MLMD_RETURN_IF_ERROR(
+        ValidateAndDecodeNextPageToken(options, next_page_token_proto));
+    offset = {next_page_token_proto.field_offset(),
+              next_page_token_proto.id_offset()};
+  }
+  const absl::flat_hash_set<int> types(event_types.begin(), event_types.end());
+
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  // The (field, id) of the events in the page.
+  std::vector<std::pair<int64, int64>> page_keys;
+  for (const int64 event_id : event_ids(*db)) {
+    if (db->archived_event_ids.contains(event_id)) continue;
+    const Event& event = db->events.at(event_id);
+    if (!types.empty() && !types.contains(event.type())) continue;
+    const std::pair<int64, int64> page_key = {
+        field == ListOperationOptions::OrderByField::ID
+            ? event_id
+            : event.milliseconds_since_epoch(),
+        event_id};
+    if (offset && (is_asc ? page_key <= *offset : page_key >= *offset)) {
+      continue;
+    }
+    page_keys.push_back(page_key);
+  }
+  // Retrieving page of size 1 greater that max_result_size to detect if this
+  // is the last page.
+  const size_t num_events =
+      std::min<size_t>(options.max_result_size() + 1,
+                       GetMaxListOperationResultSize(options) + 1);
+  const auto comparator = [is_asc](const std::pair<int64, int64>& a,
+                                   const std::pair<int64, int64>& b) {
+    return is_asc ? a < b : a > b;
+  };
+  if (page_keys.size() > num_events) {
+    absl::c_nth_element(page_keys, page_keys.begin() + num_events, comparator);
+    page_keys.resize(num_events);
+  }
+  absl::c_sort(page_keys, comparator);
+  if (page_keys.size() > options.max_result_size()) {
+    // Removing the extra event retrieved for last page detection.
+    page_keys.pop_back();
+    ListOperationNextPageToken list_operation_next_page_token;
+    list_operation_next_page_token.set_field_offset(page_keys.back().first);
+    list_operation_next_page_token.set_id_offset(page_keys.back().second);
+    MLMD_RETURN_IF_ERROR(EncodeListOperationNextPageToken(
+        options, list_operation_next_page_token, next_page_token));
+  }
+  events->reserve(events->size() + page_keys.size());
+  for (const auto& page_key : page_keys) {
+    events->push_back(db->events.at(page_key.second));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::ListEventsByArtifacts(
+    const absl::Span<const int64> artifact_ids,
+    const absl::Span<const Event::Type> event_types,
+    const ListOperationOptions& options, std::vector<Event>* events,
+    std::string* next_page_token) {
+  return ListEventsImpl(
+      [artifact_ids](const InMemoryDatabase& db) {
+        return GetAllLinkedIds(db.event_ids_by_artifact_id, artifact_ids);
+      },
+      event_types, options, events, next_page_token);
+}
+
+absl::Status InMemoryMetadataAccessObject::ListEventsByExecutions(
+    const absl::Span<const int64> execution_ids,
+    const absl::Span<const Event::Type> event_types,
+    const ListOperationOptions& options, std::vector<Event>* events,
+    std::string* next_page_token) {
+  return ListEventsImpl(
+      [execution_ids](const InMemoryDatabase& db) {
+        return GetAllLinkedIds(db.event_ids_by_execution_id, execution_ids);
+      },
+      event_types, options, events, next_page_token);
+}
+
+absl::Status InMemoryMetadataAccessObject::ListEventsByTimeRange(
+    const int64 min_milliseconds_since_epoch,
+    const absl::optional<int64> max_milliseconds_since_epoch,
+    const absl::Span<const Event::Type> event_types,
+    const ListOperationOptions& options, std::vector<Event>* events,
+    std::string* next_page_token) {
+  return ListEventsImpl(
+      [&](const InMemoryDatabase& db) {
+        std::vector<int64> event_ids;
+        for (const auto& id_and_event : db.events) {
+          const int64 time = id_and_event.second.milliseconds_since_epoch();
+          if (time >= min_milliseconds_since_epoch &&
+              (!max_milliseconds_since_epoch ||
+               time < *max_milliseconds_since_epoch)) {
+            event_ids.push_back(id_and_event.first);
+          }
+        }
+        return event_ids;
+      },
+      event_types, options, events, next_page_token);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateAssociation(
+    const Association& association, int64* association_id) {
+  if (!association.has_context_id())
+    return absl::InvalidArgumentError("No context id is specified.");
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  if (!GetNodeTable<Context>(*db).nodes.contains(association.context_id()))
+    return absl::InvalidArgumentError("Context id not found.");
+  if (!association.has_execution_id())
+    return absl::InvalidArgumentError("No execution id is specified");
+  if (!GetNodeTable<Execution>(*db).nodes.contains(association.execution_id()))
+    return absl::InvalidArgumentError("Execution id not found.");
+  if (GetLinkedIds(db->execution_ids_by_context_id, association.context_id())
+          .contains(association.execution_id())) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Given association already exists: ", association.DebugString()));
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * mutable_db,
+                        metadata_source_->GetMutableDatabase());
+  AddLink(association.context_id(), association.execution_id(),
+          mutable_db->execution_ids_by_context_id,
+          mutable_db->context_ids_by_execution_id);
+  *association_id = ++mutable_db->last_association_id;
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateAssociationsIfNotExist(
+    const absl::Span<const Association> associations) {
+  if (associations.empty()) {
+    return absl::OkStatus();
+  }
+  absl::flat_hash_set<int64> context_ids, execution_ids;
+  for (const Association& association : associations) {
+    if (!association.has_context_id())
+      return absl::InvalidArgumentError("No context id is specified.");
+    if (!association.has_execution_id())
+      return absl::InvalidArgumentError("No execution id is specified");
+    context_ids.insert(association.context_id());
+    execution_ids.insert(association.execution_id());
+  }
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  MLMD_RETURN_IF_ERROR(CheckNodesFound<Context>(context_ids, *db, "context"));
+  MLMD_RETURN_IF_ERROR(
+      CheckNodesFound<Execution>(execution_ids, *db, "execution"));
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * mutable_db,
+                        metadata_source_->GetMutableDatabase());
+  for (const Association& association : associations) {
+    if (AddLink(association.context_id(), association.execution_id(),
+                mutable_db->execution_ids_by_context_id,
+                mutable_db->context_ids_by_execution_id)) {
+      ++mutable_db->last_association_id;
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextsByExecution(
+    const int64 execution_id, std::vector<Context>* contexts) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const absl::btree_set<int64>& ids =
+      GetLinkedIds(db->context_ids_by_execution_id, execution_id);
+  if (ids.empty()) {
+    return absl::NotFoundError(
+        absl::StrCat("No contexts found for execution_id: ", execution_id));
+  }
+  return FindNodesImpl(std::vector<int64>(ids.begin(), ids.end()),
+                       /*skipped_ids_ok=*/false, *contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextsByExecutions(
+    const absl::Span<const int64> execution_ids,
+    std::vector<Association>* associations, std::vector<Context>* contexts) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  associations->clear();
+  contexts->clear();
+  const absl::btree_set<int64> sorted_execution_ids(execution_ids.begin(),
+                                                    execution_ids.end());
+  absl::btree_set<int64> context_ids;
+  for (const int64 execution_id : sorted_execution_ids) {
+    for (const int64 context_id :
+         GetLinkedIds(db->context_ids_by_execution_id, execution_id)) {
+      Association& association = associations->emplace_back();
+      association.set_execution_id(execution_id);
+      association.set_context_id(context_id);
+      context_ids.insert(context_id);
+    }
+  }
+  if (context_ids.empty()) {
+    return absl::OkStatus();
+  }
+  return FindNodesImpl(
+      std::vector<int64>(context_ids.begin(), context_ids.end()),
+      /*skipped_ids_ok=*/false, *contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutionsByContext(
+    const int64 context_id, std::vector<Execution>* executions) {
+  std::string unused_next_page_token;
+  return FindExecutionsByContext(context_id, absl::nullopt, executions,
+                                 &unused_next_page_token);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutionsByContext(
+    const int64 context_id, absl::optional<ListOperationOptions> list_options,
+    std::vector<Execution>* executions, std::string* next_page_token) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const absl::btree_set<int64>& id_set =
+      GetLinkedIds(db->execution_ids_by_context_id, context_id);
+  const std::vector<int64> ids(id_set.begin(), id_set.end());
+  if (ids.empty()) {
+    return absl::OkStatus();
+  }
+  if (list_options.has_value()) {
+    return ListNodes<Execution>(list_options.value(), ids, executions,
+                                next_page_token);
+  }
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *executions);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateAttribution(
+    const Attribution& attribution, int64* attribution_id) {
+  if (!attribution.has_context_id())
+    return absl::InvalidArgumentError("No context id is specified.");
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  if (!GetNodeTable<Context>(*db).nodes.contains(attribution.context_id()))
+    return absl::InvalidArgumentError("Context id not found.");
+  if (!attribution.has_artifact_id())
+    return absl::InvalidArgumentError("No artifact id is specified");
+  if (!GetNodeTable<Artifact>(*db).nodes.contains(attribution.artifact_id()))
+    return absl::InvalidArgumentError("Artifact id not found.");
+  if (GetLinkedIds(db->artifact_ids_by_context_id, attribution.context_id())
+          .contains(attribution.artifact_id())) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Given attribution already exists: ", attribution.DebugString()));
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * mutable_db,
+                        metadata_source_->GetMutableDatabase());
+  AddLink(attribution.context_id(), attribution.artifact_id(),
+          mutable_db->artifact_ids_by_context_id,
+          mutable_db->context_ids_by_artifact_id);
+  *attribution_id = ++mutable_db->last_attribution_id;
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateAttributionsIfNotExist(
+    const absl::Span<const Attribution> attributions) {
+  if (attributions.empty()) {
+    return absl::OkStatus();
+  }
+  absl::flat_hash_set<int64> context_ids, artifact_ids;
+  for (const Attribution& attribution : attributions) {
+    if (!attribution.has_context_id())
+      return absl::InvalidArgumentError("No context id is specified.");
+    if (!attribution.has_artifact_id())
+      return absl::InvalidArgumentError("No artifact id is specified");
+    context_ids.insert(attribution.context_id());
+    artifact_ids.insert(attribution.artifact_id());
+  }
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  MLMD_RETURN_IF_ERROR(CheckNodesFound<Context>(context_ids, *db, "context"));
+  MLMD_RETURN_IF_ERROR(
+      CheckNodesFound<Artifact>(artifact_ids, *db, "artifact"));
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * mutable_db,
+                        metadata_source_->GetMutableDatabase());
+  for (const Attribution& attribution : attributions) {
+    if (AddLink(attribution.context_id(), attribution.artifact_id(),
+                mutable_db->artifact_ids_by_context_id,
+                mutable_db->context_ids_by_artifact_id)) {
+      ++mutable_db->last_attribution_id;
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextsByArtifact(
+    const int64 artifact_id, std::vector<Context>* contexts) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const absl::btree_set<int64>& ids =
+      GetLinkedIds(db->context_ids_by_artifact_id, artifact_id);
+  if (ids.empty()) {
+    return absl::NotFoundError(
+        absl::StrCat("No contexts found for artifact_id: ", artifact_id));
+  }
+  return FindNodesImpl(std::vector<int64>(ids.begin(), ids.end()),
+                       /*skipped_ids_ok=*/false, *contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsByContext(
+    const int64 context_id, std::vector<Artifact>* artifacts) {
+  std::string unused_next_page_token;
+  return FindArtifactsByContext(context_id, absl::nullopt, artifacts,
+                                &unused_next_page_token);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsByContext(
+    const int64 context_id, absl::optional<ListOperationOptions> list_options,
+    std::vector<Artifact>* artifacts, std::string* next_page_token) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const absl::btree_set<int64>& id_set =
+      GetLinkedIds(db->artifact_ids_by_context_id, context_id);
+  const std::vector<int64> ids(id_set.begin(), id_set.end());
+  if (ids.empty()) {
+    return absl::OkStatus();
+  }
+  if (list_options.has_value()) {
+    return ListNodes<Artifact>(list_options.value(), ids, artifacts,
+                               next_page_token);
+  }
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *artifacts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsByContexts(
+    const absl::Span<const int64> context_ids, const int64 max_num_per_context,
+    std::vector<Attribution>* attributions,
+    std::vector<Artifact>* artifacts) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  attributions->clear();
+  artifacts->clear();
+  absl::btree_set<int64> artifact_ids;
+  for (const auto& [context_id, artifact_id] : GetContextAndLinkedIds(
+           db->artifact_ids_by_context_id, context_ids, max_num_per_context)) {
+    Attribution& attribution = attributions->emplace_back();
+    attribution.set_context_id(context_id);
+    attribution.set_artifact_id(artifact_id);
+    artifact_ids.insert(artifact_id);
+  }
+  if (artifact_ids.empty()) {
+    return absl::OkStatus();
+  }
+  return FindNodesImpl(
+      std::vector<int64>(artifact_ids.begin(), artifact_ids.end()),
+      /*skipped_ids_ok=*/false, *artifacts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindExecutionsByContexts(
+    const absl::Span<const int64> context_ids, const int64 max_num_per_context,
+    std::vector<Association>* associations,
+    std::vector<Execution>* executions) {
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  associations->clear();
+  executions->clear();
+  absl::btree_set<int64> execution_ids;
+  for (const auto& [context_id, execution_id] : GetContextAndLinkedIds(
+           db->execution_ids_by_context_id, context_ids, max_num_per_context)) {
+    Association& association = associations->emplace_back();
+    association.set_context_id(context_id);
+    association.set_execution_id(execution_id);
+    execution_ids.insert(execution_id);
+  }
+  if (execution_ids.empty()) {
+    return absl::OkStatus();
+  }
+  return FindNodesImpl(
+      std::vector<int64>(execution_ids.begin(), execution_ids.end()),
+      /*skipped_ids_ok=*/false, *executions);
+}
+
+absl::Status InMemoryMetadataAccessObject::CreateParentContext(
+    const ParentContext& parent_context) {
+  if (!parent_context.has_parent_id() || !parent_context.has_child_id()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Missing parent / child id in the parent_context: ",
+                     parent_context.DebugString()));
+  }
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const InMemoryNodeTable<Context>& table = GetNodeTable<Context>(*db);
+  if (!table.nodes.contains(parent_context.parent_id()) ||
+      !table.nodes.contains(parent_context.child_id())) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Given parent / child id in the parent_context cannot be found: ",
+        parent_context.DebugString()));
+  }
+  MLMD_RETURN_IF_ERROR(CheckCyClicDependency(
+      /*child_id=*/parent_context.child_id(),
+      /*parent_id=*/parent_context.parent_id(), db->parent_ids_by_context_id));
+  if (GetLinkedIds(db->parent_ids_by_context_id, parent_context.child_id())
+          .contains(parent_context.parent_id())) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Given parent_context already exists: ", parent_context.DebugString()));
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * mutable_db,
+                        metadata_source_->GetMutableDatabase());
+  AddLink(parent_context.child_id(), parent_context.parent_id(),
+          mutable_db->parent_ids_by_context_id,
+          mutable_db->child_ids_by_context_id);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindLinkedContextsImpl(
+    const int64 context_id, const bool is_parent,
+    std::vector<Context>* contexts) {
+  if (contexts == nullptr) {
+    return absl::InvalidArgumentError("Given contexts is NULL.");
+  }
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const absl::btree_set<int64>& ids = GetLinkedIds(
+      is_parent ? db->parent_ids_by_context_id : db->child_ids_by_context_id,
+      context_id);
+  contexts->clear();
+  if (ids.empty()) {
+    return absl::OkStatus();
+  }
+  return FindNodesImpl(std::vector<int64>(ids.begin(), ids.end()),
+                       /*skipped_ids_ok=*/false, *contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindParentContextsByContextId(
+    const int64 context_id, std::vector<Context>* contexts) {
+  return FindLinkedContextsImpl(context_id, /*is_parent=*/true, contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindChildContextsByContextId(
+    const int64 context_id, std::vector<Context>* contexts) {
+  return FindLinkedContextsImpl(context_id, /*is_parent=*/false, contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindContextHierarchyImpl(
+    const int64 context_id, const int64 max_depth, const bool is_parent,
+    std::vector<Context>* contexts) {
+  if (contexts == nullptr) {
+    return absl::InvalidArgumentError("Given contexts is NULL.");
+  }
+  if (max_depth <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("max_depth must be positive: ", max_depth));
+  }
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  const LinkIndex& index =
+      is_parent ? db->parent_ids_by_context_id : db->child_ids_by_context_id;
+  // A breadth first traversal from the context keeps the minimum depth of
+  // each reached context, which includes the context itself on a cycle.
+  std::vector<std::pair<int64, int64>> depths_and_ids;
+  absl::flat_hash_set<int64> visited_ids;
+  std::vector<int64> frontier = {context_id};
+  for (int64 depth = 1; depth <= max_depth && !frontier.empty(); depth++) {
+    std::vector<int64> next_frontier;
+    for (const int64 id : frontier) {
+      for (const int64 linked_id : GetLinkedIds(index, id)) {
+        if (visited_ids.insert(linked_id).second) {
+          depths_and_ids.push_back({depth, linked_id});
+          next_frontier.push_back(linked_id);
+        }
+      }
+    }
+    frontier = std::move(next_frontier);
+  }
+  contexts->clear();
+  if (depths_and_ids.empty()) {
+    return absl::OkStatus();
+  }
+  absl::c_sort(depths_and_ids);
+  std::vector<int64> ids;
+  ids.reserve(depths_and_ids.size());
+  absl::flat_hash_map<int64, int> positions;
+  for (const auto& depth_and_id : depths_and_ids) {
+    positions[depth_and_id.second] = ids.size();
+    ids.push_back(depth_and_id.second);
+  }
+  MLMD_RETURN_IF_ERROR(FindNodesImpl(ids, /*skipped_ids_ok=*/false, *contexts));
+  absl::c_sort(*contexts, [&positions](const Context& a, const Context& b) {
+    return positions.at(a.id()) < positions.at(b.id());
+  });
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindAncestorContextsByContextId(
+    const int64 context_id, const int64 max_depth,
+    std::vector<Context>* contexts) {
+  return FindContextHierarchyImpl(context_id, max_depth, /*is_parent=*/true,
+                                  contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindDescendantContextsByContextId(
+    const int64 context_id, const int64 max_depth,
+    std::vector<Context>* contexts) {
+  return FindContextHierarchyImpl(context_id, max_depth, /*is_parent=*/false,
+                                  contexts);
+}
+
+absl::Status InMemoryMetadataAccessObject::QueryLineageGraphImpl(
+    const std::vector<Artifact>& query_nodes, const int64 max_num_hops,
+    const absl::optional<int64> max_nodes,
+    const absl::optional<std::string> boundary_artifacts,
+    const absl::optional<std::string> boundary_executions, const bool ids_only,
+    LineageGraph& subgraph) {
+  if (boundary_artifacts || boundary_executions) {
+    return absl::UnimplementedError(
+        "Boundary conditions of lineage graph queries are not supported by "
+        "the in-memory metadata access object.");
+  }
+  absl::c_copy(query_nodes, google::protobuf::RepeatedFieldBackInserter(
+                                subgraph.mutable_artifacts()));
+  // If max_nodes is not set, set nodes quota to max int64 value to effectively
+  // disable limit the lineage graph by nodes count.
+  const int64 nodes_quota = max_nodes
+                                ? max_nodes.value() - query_nodes.size()
+                                : std::numeric_limits<int64>::max();
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  if (!query_nodes.empty() && max_num_hops > 0 && nodes_quota > 0) {
+    // A breadth first traversal over the events from the query nodes, which
+    // alternates between artifacts and executions. The nodes are ordered by
+    // (distance, is_artifact, id), so the nodes nearest to the query nodes
+    // are kept if more than nodes_quota nodes are reached.
+    const InMemoryNodeTable<Artifact>& artifacts = GetNodeTable<Artifact>(*db);
+    absl::flat_hash_set<int64> visited_artifact_ids, visited_execution_ids;
+    std::vector<int64> frontier;
+    for (const Artifact& query_node : query_nodes) {
+      if (artifacts.nodes.contains(query_node.id()) &&
+          visited_artifact_ids.insert(query_node.id()).second) {
+        frontier.push_back(query_node.id());
+      }
+    }
+    absl::flat_hash_set<int64> artifact_ids(visited_artifact_ids.begin(),
+                                            visited_artifact_ids.end());
+    for (const Artifact& query_node : query_nodes) {
+      artifact_ids.insert(query_node.id());
+    }
+    std::vector<int64> expand_artifact_ids;
+    std::vector<int64> expand_execution_ids;
+    bool is_full = false;
+    for (int64 distance = 1;
+         distance <= max_num_hops && !frontier.empty() && !is_full;
+         distance++) {
+      const bool from_artifacts = distance % 2 == 1;
+      const LinkIndex& index = from_artifacts ? db->event_ids_by_artifact_id
+                                              : db->event_ids_by_execution_id;
+      absl::btree_set<int64> next_frontier;
+      for (const int64 id : frontier) {
+        for (const int64 event_id : GetLinkedIds(index, id)) {
+          const Event& event = db->events.at(event_id);
+          const int64 next_id =
+              from_artifacts ? event.execution_id() : event.artifact_id();
+          if ((from_artifacts ? visited_execution_ids : visited_artifact_ids)
+                  .insert(next_id)
+                  .second) {
+            next_frontier.insert(next_id);
+          }
+        }
+      }
+      frontier.assign(next_frontier.begin(), next_frontier.end());
+      for (const int64 id : frontier) {
+        if (expand_artifact_ids.size() + expand_execution_ids.size() >=
+            nodes_quota) {
+          is_full = true;
+          break;
+        }
+        if (from_artifacts) {
+          expand_execution_ids.push_back(id);
+        } else if (artifact_ids.insert(id).second) {
+          expand_artifact_ids.push_back(id);
+        }
+      }
+    }
+    if (!expand_execution_ids.empty()) {
+      // The events between any two of the kept nodes are in the subgraph.
+      std::vector<Event> events;
+      MLMD_RETURN_IF_ERROR(
+          FindEventsByExecutions(expand_execution_ids, &events));
+      for (Event& event : events) {
+        if (artifact_ids.contains(event.artifact_id())) {
+          *subgraph.add_events() = std::move(event);
+        }
+      }
+      std::vector<Execution> executions;
+      if (ids_only) {
+        SetIdOnlyNodes(expand_execution_ids, executions);
+      } else {
+        MLMD_RETURN_IF_ERROR(FindNodesImpl(
+            expand_execution_ids, /*skipped_ids_ok=*/false, executions));
+      }
+      absl::c_move(executions, google::protobuf::RepeatedFieldBackInserter(
+                                   subgraph.mutable_executions()));
+      if (!expand_artifact_ids.empty()) {
+        std::vector<Artifact> found_artifacts;
+        if (ids_only) {
+          SetIdOnlyNodes(expand_artifact_ids, found_artifacts);
+        } else {
+          MLMD_RETURN_IF_ERROR(FindNodesImpl(expand_artifact_ids,
+                                             /*skipped_ids_ok=*/false,
+                                             found_artifacts));
+        }
+        absl::c_move(found_artifacts,
+                     google::protobuf::RepeatedFieldBackInserter(
+                         subgraph.mutable_artifacts()));
+      }
+    }
+  }
+  // Add node types.
+  const auto is_simple_type = [](const std::string& type_name) {
+    return std::find(kSimpleTypeNames.begin(), kSimpleTypeNames.end(),
+                     type_name) != kSimpleTypeNames.end();
+  };
+  for (const auto& id_and_type : GetTypeTable<ArtifactType>(*db).types) {
+    if (!is_simple_type(id_and_type.second.name())) {
+      *subgraph.add_artifact_types() = id_and_type.second;
+    }
+  }
+  for (const auto& id_and_type : GetTypeTable<ExecutionType>(*db).types) {
+    if (!is_simple_type(id_and_type.second.name())) {
+      *subgraph.add_execution_types() = id_and_type.second;
+    }
+  }
+  for (const auto& id_and_type : GetTypeTable<ContextType>(*db).types) {
+    *subgraph.add_context_types() = id_and_type.second;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::QueryLineageGraph(
+    const std::vector<Artifact>& query_nodes, int64 max_num_hops,
+    absl::optional<int64> max_nodes,
+    absl::optional<std::string> boundary_artifacts,
+    absl::optional<std::string> boundary_executions, LineageGraph& subgraph) {
+  return QueryLineageGraphImpl(query_nodes, max_num_hops, max_nodes,
+                               boundary_artifacts, boundary_executions,
+                               /*ids_only=*/false, subgraph);
+}
+
+absl::Status InMemoryMetadataAccessObject::QueryLineageGraphIds(
+    const std::vector<Artifact>& query_nodes, int64 max_num_hops,
+    absl::optional<int64> max_nodes,
+    absl::optional<std::string> boundary_artifacts,
+    absl::optional<std::string> boundary_executions, LineageGraph& subgraph) {
+  return QueryLineageGraphImpl(query_nodes, max_num_hops, max_nodes,
+                               boundary_artifacts, boundary_executions,
+                               /*ids_only=*/true, subgraph);
+}
+
+absl::Status InMemoryMetadataAccessObject::FindArtifactsByDerivation(
+    const absl::Span<const int64> artifact_ids, const bool upstream,
+    const int64 max_num_hops, const absl::optional<int64> context_id,
+    std::vector<Artifact>* artifacts) {
+  artifacts->clear();
+  if (artifact_ids.empty() || max_num_hops <= 0) {
+    return absl::OkStatus();
+  }
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  // The executions linking the derived artifacts, if a context is given.
+  const absl::btree_set<int64>* context_execution_ids =
+      context_id.value_or(0) != 0
+          ? &GetLinkedIds(db->execution_ids_by_context_id, *context_id)
+          : nullptr;
+  // An artifact is derived from the artifacts read by the executions that
+  // write it, so the downstream artifacts are found the other way round.
+  const auto for_each_derived_artifact = [&](const int64 artifact_id,
+                                             const auto& visit) {
+    for (const int64 event_id :
+         GetLinkedIds(db->event_ids_by_artifact_id, artifact_id)) {
+      const Event& event = db->events.at(event_id);
+      if (upstream ? !IsOutputEvent(event.type())
+                   : !IsInputEvent(event.type())) {
+        continue;
+      }
+      if (context_execution_ids != nullptr &&
+          !context_execution_ids->contains(event.execution_id())) {
+        continue;
+      }
+      for (const int64 linked_event_id :
+           GetLinkedIds(db->event_ids_by_execution_id, event.execution_id())) {
+        const Event& linked_event = db->events.at(linked_event_id);
+        if ((upstream ? IsInputEvent(linked_event.type())
+                      : IsOutputEvent(linked_event.type())) &&
+            linked_event.artifact_id() != artifact_id) {
+          visit(linked_event.artifact_id());
+        }
+      }
+    }
+  };
+  // A breadth first traversal keeps the minimum distance of each derived
+  // artifact, which includes the given artifacts reached through a cycle.
+  const InMemoryNodeTable<Artifact>& table = GetNodeTable<Artifact>(*db);
+  absl::flat_hash_set<int64> visited_ids;
+  std::vector<int64> frontier;
+  for (const int64 artifact_id : artifact_ids) {
+    if (table.nodes.contains(artifact_id) &&
+        visited_ids.insert(artifact_id).second) {
+      frontier.push_back(artifact_id);
+    }
+  }
+  absl::flat_hash_set<int64> derived_ids;
+  std::vector<std::pair<int64, int64>> distances_and_ids;
+  for (int64 distance = 1; distance <= max_num_hops && !frontier.empty();
+       distance++) {
+    std::vector<int64> next_frontier;
+    for (const int64 artifact_id : frontier) {
+      for_each_derived_artifact(artifact_id, [&](const int64 derived_id) {
+        if (derived_ids.insert(derived_id).second) {
+          distances_and_ids.push_back({distance, derived_id});
+        }
+        if (visited_ids.insert(derived_id).second) {
+          next_frontier.push_back(derived_id);
+        }
+      });
+    }
+    frontier = std::move(next_frontier);
+  }
+  if (distances_and_ids.empty()) {
+    return absl::OkStatus();
+  }
+  absl::c_sort(distances_and_ids);
+  std::vector<int64> ids;
+  ids.reserve(distances_and_ids.size());
+  absl::flat_hash_map<int64, int> positions;
+  for (const auto& distance_and_id : distances_and_ids) {
+    positions[distance_and_id.second] = ids.size();
+    ids.push_back(distance_and_id.second);
+  }
+  std::vector<Artifact> found_artifacts;
+  MLMD_RETURN_IF_ERROR(FindArtifactsById(ids, &found_artifacts));
+  // Keeps the order of the distances, as the artifacts are read by ids.
+  absl::c_sort(found_artifacts, [&positions](const Artifact& a,
+                                             const Artifact& b) {
+    return positions[a.id()] < positions[b.id()];
+  });
+  *artifacts = std::move(found_artifacts);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::FindChangeLogEntries(
+    const int64 after_sequence_number, const int64 max_num_entries,
+    std::vector<ChangeLogEntry>* entries) {
+  entries->clear();
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  // The sequence number of an entry is its position in the log plus one.
+  for (int64 i = std::max<int64>(after_sequence_number, 0);
+       i < db->change_log.size() && entries->size() < max_num_entries; i++) {
+    entries->push_back(db->change_log[i]);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::ArchiveExecutions(
+    const int64 max_last_update_time_since_epoch,
+    const int64 max_num_executions, int64* num_archived_executions) {
+  *num_archived_executions = 0;
+  MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                        metadata_source_->GetDatabase());
+  // The (last_update_time_since_epoch, id) of the cold executions, of which
+  // the least recently updated ones are archived.
+  std::vector<std::pair<int64, int64>> cold_keys;
+  for (const auto& id_and_execution : GetNodeTable<Execution>(*db).nodes) {
+    const Execution& execution = id_and_execution.second;
+    if (execution.last_update_time_since_epoch() <=
+            max_last_update_time_since_epoch &&
+        execution.last_known_state() != Execution::NEW &&
+        execution.last_known_state() != Execution::RUNNING) {
+      cold_keys.emplace_back(execution.last_update_time_since_epoch(),
+                             id_and_execution.first);
+    }
+  }
+  if (static_cast<int64>(cold_keys.size()) > max_num_executions) {
+    absl::c_nth_element(cold_keys, cold_keys.begin() + max_num_executions);
+    cold_keys.resize(max_num_executions);
+  }
+  if (cold_keys.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * mutable_db,
+                        metadata_source_->GetMutableDatabase());
+  // The archived executions and events stay in the lineage graph, so no
+  // change log entries are written.
+  for (const auto& cold_key : cold_keys) {
+    const int64 execution_id = cold_key.second;
+    Execution execution =
+        GetNodeTable<Execution>(*mutable_db).nodes.at(execution_id);
+    EraseNode<Execution>(execution_id, *mutable_db);
+    mutable_db->archived_executions[execution_id] = std::move(execution);
+    for (const int64 event_id :
+         GetLinkedIds(mutable_db->event_ids_by_execution_id, execution_id)) {
+      mutable_db->archived_event_ids.insert(event_id);
+    }
+  }
+  *num_archived_executions = cold_keys.size();
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteArtifactsById(
+    const absl::Span<const int64> artifact_ids) {
+  return DeleteNodesImpl<Artifact>(artifact_ids);
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteExecutionsById(
+    const absl::Span<const int64> execution_ids) {
+  MLMD_RETURN_IF_ERROR(DeleteNodesImpl<Execution>(execution_ids));
+  if (execution_ids.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  for (const int64 execution_id : execution_ids) {
+    db->archived_executions.erase(execution_id);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteContextsById(
+    const absl::Span<const int64> context_ids) {
+  return DeleteNodesImpl<Context>(context_ids);
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteEventsByArtifactsId(
+    const absl::Span<const int64> artifact_ids) {
+  if (artifact_ids.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  for (const int64 artifact_id : artifact_ids) {
+    const absl::btree_set<int64> event_ids =
+        GetLinkedIds(db->event_ids_by_artifact_id, artifact_id);
+    for (const int64 event_id : event_ids) {
+      EraseEvent(event_id, *db);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteEventsByExecutionsId(
+    const absl::Span<const int64> execution_ids) {
+  if (execution_ids.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  for (const int64 execution_id : execution_ids) {
+    const absl::btree_set<int64> event_ids =
+        GetLinkedIds(db->event_ids_by_execution_id, execution_id);
+    for (const int64 event_id : event_ids) {
+      EraseEvent(event_id, *db);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteAssociationsByContextsId(
+    const absl::Span<const int64> context_ids) {
+  if (context_ids.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  RemoveLinks(context_ids, db->execution_ids_by_context_id,
+              db->context_ids_by_execution_id);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteAssociationsByExecutionsId(
+    const absl::Span<const int64> execution_ids) {
+  if (execution_ids.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  RemoveLinks(execution_ids, db->context_ids_by_execution_id,
+              db->execution_ids_by_context_id);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteAttributionsByContextsId(
+    const absl::Span<const int64> context_ids) {
+  if (context_ids.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  RemoveLinks(context_ids, db->artifact_ids_by_context_id,
+              db->context_ids_by_artifact_id);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteAttributionsByArtifactsId(
+    const absl::Span<const int64> artifact_ids) {
+  if (artifact_ids.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  RemoveLinks(artifact_ids, db->context_ids_by_artifact_id,
+              db->artifact_ids_by_context_id);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteParentContextsByParentIds(
+    const absl::Span<const int64> parent_context_ids) {
+  if (parent_context_ids.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  RemoveLinks(parent_context_ids, db->child_ids_by_context_id,
+              db->parent_ids_by_context_id);
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataAccessObject::DeleteParentContextsByChildIds(
+    const absl::Span<const int64> child_context_ids) {
+  if (child_context_ids.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                        metadata_source_->GetMutableDatabase());
+  RemoveLinks(child_context_ids, db->parent_ids_by_context_id,
+              db->child_ids_by_context_id);
+  return absl::OkStatus();
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,613 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_ACCESS_OBJECT_H_
+#define ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_ACCESS_OBJECT_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
+#include "ml_metadata/metadata_store/lineage_graph_index.h"
+#include "ml_metadata/metadata_store/metadata_access_object.h"
+#include "ml_metadata/metadata_store/property_string_dictionary.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// An implementation of MetadataAccessObject that reads and writes the
+// InMemoryDatabase of an InMemoryMetadataSource directly, without composing
+// any queries. It keeps the semantics of the RDBMSMetadataAccessObject, i.e.,
+// the same validations, error codes, id assignment and result orders, so that
+// it can replace a SQLite database in tests and ephemeral pipelines.
+//
+// The lookups by type, name, URI, events, associations, attributions and
+// parent contexts are served by the hash map indices of the database. The
+// schema is not materialized: the migrations only record the schema version.
+// Filter queries and the boundaries of lineage graph queries, which are
+// compiled to SQL, are not supported.
+class InMemoryMetadataAccessObject : public MetadataAccessObject {
+ public:
+  // The `metadata_source` is not owned, and must outlast the object. The
+  // `library_version` is the schema version the object initializes.
+  InMemoryMetadataAccessObject(InMemoryMetadataSource* metadata_source,
+                               int64 library_version)
+      : metadata_source_(metadata_source), library_version_(library_version) {}
+  ~InMemoryMetadataAccessObject() override = default;
+
+  // default & copy constructors are disallowed.
+  InMemoryMetadataAccessObject() = delete;
+  InMemoryMetadataAccessObject(const InMemoryMetadataAccessObject&) = delete;
+  InMemoryMetadataAccessObject& operator=(
+      const InMemoryMetadataAccessObject&) = delete;
+
+  absl::Status InitMetadataSource() final;
+
+  absl::Status InitMetadataSourceIfNotExists(
+      bool enable_upgrade_migration = false) final;
+
+  // The in-memory metadata has no rows to backfill, and is upgraded at once.
+  absl::Status UpgradeMetadataSourceOnlineStep(int64 batch_size,
+                                               bool* done) final {
+    *done = true;
+    return InitMetadataSourceIfNotExists(/*enable_upgrade_migration=*/true);
+  }
+
+  absl::Status DeleteMetadataSource() final;
+
+  absl::Status DowngradeMetadataSource(int64 to_schema_version) final;
+
+  absl::Status CreateType(const ArtifactType& type, int64* type_id) final;
+  absl::Status CreateType(const ExecutionType& type, int64* type_id) final;
+  absl::Status CreateType(const ContextType& type, int64* type_id) final;
+
+  absl::Status UpdateType(const ArtifactType& type) final;
+  absl::Status UpdateType(const ExecutionType& type) final;
+  absl::Status UpdateType(const ContextType& type) final;
+
+  absl::Status FindTypeById(int64 type_id, ArtifactType* artifact_type) final;
+  absl::Status FindTypeById(int64 type_id, ExecutionType* execution_type) final;
+  absl::Status FindTypeById(int64 type_id, ContextType* context_type) final;
+
+  absl::Status FindTypeByNameAndVersion(
+      absl::string_view name, absl::optional<absl::string_view> version,
+      ArtifactType* artifact_type) final;
+  absl::Status FindTypeByNameAndVersion(
+      absl::string_view name, absl::optional<absl::string_view> version,
+      ExecutionType* execution_type) final;
+  absl::Status FindTypeByNameAndVersion(
+      absl::string_view name, absl::optional<absl::string_view> version,
+      ContextType* context_type) final;
+
+  absl::Status FindTypeIdByNameAndVersion(
+      absl::string_view name, absl::optional<absl::string_view> version,
+      TypeKind type_kind, int64* type_id) final;
+
+  absl::Status FindTypes(std::vector<ArtifactType>* artifact_types) final;
+  absl::Status FindTypes(std::vector<ExecutionType>* execution_types) final;
+  absl::Status FindTypes(std::vector<ContextType>* context_types) final;
+
+  absl::Status CreateTypes(absl::Span<const ArtifactType> types,
+                           std::vector<int64>* type_ids) final;
+  absl::Status CreateTypes(absl::Span<const ExecutionType> types,
+                           std::vector<int64>* type_ids) final;
+  absl::Status CreateTypes(absl::Span<const ContextType> types,
+                           std::vector<int64>* type_ids) final;
+
+  absl::Status AddTypeProperties(absl::Span<const ArtifactType> types) final;
+  absl::Status AddTypeProperties(absl::Span<const ExecutionType> types) final;
+  absl::Status AddTypeProperties(absl::Span<const ContextType> types) final;
+
+  absl::Status FindTypesByNames(absl::Span<const std::string> names,
+                                std::vector<ArtifactType>* types) final;
+  absl::Status FindTypesByNames(absl::Span<const std::string> names,
+                                std::vector<ExecutionType>* types) final;
+  absl::Status FindTypesByNames(absl::Span<const std::string> names,
+                                std::vector<ContextType>* types) final;
+
+  absl::Status FindTypesByIds(absl::Span<const int64> type_ids,
+                              std::vector<ArtifactType>* types) final;
+  absl::Status FindTypesByIds(absl::Span<const int64> type_ids,
+                              std::vector<ExecutionType>* types) final;
+  absl::Status FindTypesByIds(absl::Span<const int64> type_ids,
+                              std::vector<ContextType>* types) final;
+
+  absl::Status CreateParentTypeInheritanceLink(
+      const ArtifactType& type, const ArtifactType& parent_type) final;
+  absl::Status CreateParentTypeInheritanceLink(
+      const ExecutionType& type, const ExecutionType& parent_type) final;
+  absl::Status CreateParentTypeInheritanceLink(
+      const ContextType& type, const ContextType& parent_type) final;
+
+  absl::Status DeleteParentTypeInheritanceLink(int64 type_id,
+                                               int64 parent_type_id) final;
+
+  absl::Status FindParentTypesByTypeId(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, ArtifactType>& output_parent_types) final;
+  absl::Status FindParentTypesByTypeId(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, ExecutionType>& output_parent_types) final;
+  absl::Status FindParentTypesByTypeId(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, ContextType>& output_parent_types) final;
+
+  absl::Status CreateArtifact(const Artifact& artifact,
+                              int64* artifact_id) final;
+  absl::Status CreateArtifacts(absl::Span<const Artifact> artifacts,
+                               std::vector<int64>* artifact_ids) final;
+  absl::Status CreateArtifactIfNotExist(const Artifact& artifact,
+                                        int64* artifact_id,
+                                        bool* is_created) final;
+
+  absl::Status FindArtifactsById(absl::Span<const int64> artifact_ids,
+                                 std::vector<Artifact>* artifacts) final;
+
+  absl::Status FindArtifactLastUpdateTimes(
+      absl::Span<const int64> artifact_ids,
+      absl::flat_hash_map<int64, int64>* last_update_times) final;
+
+  absl::Status FindArtifacts(std::vector<Artifact>* artifacts) final;
+
+  absl::Status ListArtifacts(const ListOperationOptions& options,
+                             std::vector<Artifact>* artifacts,
+                             std::string* next_page_token) final;
+
+  absl::Status ListExecutions(const ListOperationOptions& options,
+                              std::vector<Execution>* executions,
+                              std::string* next_page_token) final;
+
+  absl::Status ListContexts(const ListOperationOptions& options,
+                            std::vector<Context>* contexts,
+                            std::string* next_page_token) final;
+
+  absl::Status CountArtifacts(const CountOptions& options,
+                              std::vector<NodeCount>* counts) final;
+
+  absl::Status CountExecutions(const CountOptions& options,
+                               std::vector<NodeCount>* counts) final;
+
+  absl::Status CountContexts(const CountOptions& options,
+                             std::vector<NodeCount>* counts) final;
+
+  absl::Status FindArtifactByTypeIdAndArtifactName(int64 artifact_type_id,
+                                                   absl::string_view name,
+                                                   Artifact* artifact) final;
+
+  absl::Status FindArtifactsByTypeId(
+      int64 artifact_type_id, absl::optional<ListOperationOptions> list_options,
+      std::vector<Artifact>* artifacts, std::string* next_page_token) final;
+
+  absl::Status FindArtifactsByURI(absl::string_view uri,
+                                  std::vector<Artifact>* artifacts) final;
+
+  absl::Status UpdateArtifact(const Artifact& artifact) final;
+
+  absl::Status CreateExecution(const Execution& execution,
+                               int64* execution_id) final;
+  absl::Status CreateExecutions(absl::Span<const Execution> executions,
+                                std::vector<int64>* execution_ids) final;
+
+  absl::Status FindExecutionsById(absl::Span<const int64> execution_ids,
+                                  std::vector<Execution>* executions) final;
+
+  absl::Status FindExecutions(std::vector<Execution>* executions) final;
+
+  absl::Status FindExecutionByTypeIdAndExecutionName(
+      int64 execution_type_id, absl::string_view name,
+      Execution* execution) final;
+
+  absl::Status FindExecutionsByTypeId(
+      int64 execution_type_id,
+      absl::optional<ListOperationOptions> list_options,
+      std::vector<Execution>* executions, std::string* next_page_token) final;
+
+  absl::Status FindActiveExecutionsByTypeId(
+      int64 execution_type_id, std::vector<Execution>* executions) final;
+
+  absl::Status UpdateExecution(const Execution& execution) final;
+
+  absl::Status CreateContext(const Context& context, int64* context_id) final;
+  absl::Status CreateContexts(absl::Span<const Context> contexts,
+                              std::vector<int64>* context_ids) final;
+  absl::Status CreateContextIfNotExist(const Context& context,
+                                       int64* context_id,
+                                       bool* is_created) final;
+
+  absl::Status FindContextsById(absl::Span<const int64> context_ids,
+                                std::vector<Context>* contexts) final;
+
+  absl::Status FindContexts(std::vector<Context>* contexts) final;
+
+  absl::Status FindContextsByTypeId(
+      int64 type_id, absl::optional<ListOperationOptions> list_options,
+      std::vector<Context>* contexts, std::string* next_page_token) final;
+
+  absl::Status FindContextByTypeIdAndContextName(int64 type_id,
+                                                 absl::string_view name,
+                                                 Context* context) final;
+
+  absl::Status UpdateContext(const Context& context) final;
+
+  absl::Status CreateEvent(const Event& event, int64* event_id) final;
+  absl::Status CreateEvents(absl::Span<const Event> events,
+                            std::vector<int64>* event_ids) final;
+
+  absl::Status FindEventsByArtifacts(const std::vector<int64>& artifact_ids,
+                                     std::vector<Event>* events) final;
+
+  absl::Status FindEventsByExecutions(const std::vector<int64>& execution_ids,
+                                      std::vector<Event>* events) final;
+
+  absl::Status ListEventsByArtifacts(absl::Span<const int64> artifact_ids,
+                                     absl::Span<const Event::Type> event_types,
+                                     const ListOperationOptions& options,
+                                     std::vector<Event>* events,
+                                     std::string* next_page_token) final;
+
+  absl::Status ListEventsByExecutions(absl::Span<const int64> execution_ids,
+                                      absl::Span<const Event::Type> event_types,
+                                      const ListOperationOptions& options,
+                                      std::vector<Event>* events,
+                                      std::string* next_page_token) final;
+
+  absl::Status ListEventsByTimeRange(
+      int64 min_milliseconds_since_epoch,
+      absl::optional<int64> max_milliseconds_since_epoch,
+      absl::Span<const Event::Type> event_types,
+      const ListOperationOptions& options, std::vector<Event>* events,
+      std::string* next_page_token) final;
+
+  absl::Status CreateAssociation(const Association& association,
+                                 int64* association_id) final;
+  absl::Status CreateAssociationsIfNotExist(
+      absl::Span<const Association> associations) final;
+
+  absl::Status FindContextsByExecution(int64 execution_id,
+                                       std::vector<Context>* contexts) final;
+
+  absl::Status FindContextsByExecutions(
+      absl::Span<const int64> execution_ids,
+      std::vector<Association>* associations,
+      std::vector<Context>* contexts) final;
+
+  absl::Status FindExecutionsByContexts(
+      absl::Span<const int64> context_ids, int64 max_num_per_context,
+      std::vector<Association>* associations,
+      std::vector<Execution>* executions) final;
+
+  absl::Status FindArtifactsByContexts(
+      absl::Span<const int64> context_ids, int64 max_num_per_context,
+      std::vector<Attribution>* attributions,
+      std::vector<Artifact>* artifacts) final;
+
+  absl::Status FindExecutionsByContext(
+      int64 context_id, std::vector<Execution>* executions) final;
+
+  absl::Status FindExecutionsByContext(
+      int64 context_id, absl::optional<ListOperationOptions> list_options,
+      std::vector<Execution>* executions, std::string* next_page_token) final;
+
+  absl::Status CreateAttribution(const Attribution& attribution,
+                                 int64* attribution_id) final;
+  absl::Status CreateAttributionsIfNotExist(
+      absl::Span<const Attribution> attributions) final;
+
+  absl::Status FindContextsByArtifact(int64 artifact_id,
+                                      std::vector<Context>* contexts) final;
+
+  absl::Status FindArtifactsByContext(int64 context_id,
+                                      std::vector<Artifact>* artifacts) final;
+
+  absl::Status FindArtifactsByContext(
+      int64 context_id, absl::optional<ListOperationOptions> list_options,
+      std::vector<Artifact>* artifacts, std::string* next_page_token) final;
+
+  absl::Status CreateParentContext(const ParentContext& parent_context) final;
+
+  absl::Status FindParentContextsByContextId(
+      int64 context_id, std::vector<Context>* contexts) final;
+
+  absl::Status FindChildContextsByContextId(
+      int64 context_id, std::vector<Context>* contexts) final;
+
+  absl::Status FindAncestorContextsByContextId(
+      int64 context_id, int64 max_depth, std::vector<Context>* contexts) final;
+
+  absl::Status FindDescendantContextsByContextId(
+      int64 context_id, int64 max_depth, std::vector<Context>* contexts) final;
+
+  absl::Status GetSchemaVersion(int64* db_version) final;
+
+  int64 GetLibraryVersion() final { return library_version_; }
+
+  // Returns FAILED_PRECONDITION error, as the types have no generation.
+  absl::Status GetTypeGeneration(int64* type_generation) final {
+    return absl::FailedPreconditionError(
+        "The in-memory metadata source has no type generation.");
+  }
+
+  // Returns UNIMPLEMENTED error, if any boundary condition is given.
+  absl::Status QueryLineageGraph(
+      const std::vector<Artifact>& query_nodes, int64 max_num_hops,
+      absl::optional<int64> max_nodes,
+      absl::optional<std::string> boundary_artifacts,
+      absl::optional<std::string> boundary_executions,
+      LineageGraph& subgraph) final;
+
+  // Returns UNIMPLEMENTED error, if any boundary condition is given.
+  absl::Status QueryLineageGraphIds(
+      const std::vector<Artifact>& query_nodes, int64 max_num_hops,
+      absl::optional<int64> max_nodes,
+      absl::optional<std::string> boundary_artifacts,
+      absl::optional<std::string> boundary_executions,
+      LineageGraph& subgraph) final;
+
+  // The in-memory lineage graph is traversed without the index.
+  void set_lineage_graph_index(
+      std::shared_ptr<LineageGraphIndex> index) final {}
+
+  // The in-memory properties are not interned.
+  void set_property_string_dictionary(
+      std::shared_ptr<PropertyStringDictionary> dictionary) final {}
+
+  // The in-memory properties are not compressed.
+  void set_property_value_compression(
+      const PropertyValueCompressionConfig& config) final {}
+
+  // The in-memory properties have no indices.
+  void set_indexed_properties(
+      std::vector<IndexedProperty> indexed_properties) final {}
+
+  absl::Status FindArtifactsByDerivation(
+      absl::Span<const int64> artifact_ids, bool upstream, int64 max_num_hops,
+      absl::optional<int64> context_id,
+      std::vector<Artifact>* artifacts) final;
+
+  absl::Status FindChangeLogEntries(int64 after_sequence_number,
+                                    int64 max_num_entries,
+                                    std::vector<ChangeLogEntry>* entries) final;
+
+  absl::Status ArchiveExecutions(int64 max_last_update_time_since_epoch,
+                                 int64 max_num_executions,
+                                 int64* num_archived_executions) final;
+
+  absl::Status DeleteArtifactsById(absl::Span<const int64> artifact_ids) final;
+
+  absl::Status DeleteExecutionsById(
+      absl::Span<const int64> execution_ids) final;
+
+  absl::Status DeleteContextsById(absl::Span<const int64> context_ids) final;
+
+  absl::Status DeleteEventsByArtifactsId(
+      absl::Span<const int64> artifact_ids) final;
+
+  absl::Status DeleteEventsByExecutionsId(
+      absl::Span<const int64> execution_ids) final;
+
+  absl::Status DeleteAssociationsByContextsId(
+      absl::Span<const int64> context_ids) final;
+
+  absl::Status DeleteAssociationsByExecutionsId(
+      absl::Span<const int64> execution_ids) final;
+
+  absl::Status DeleteAttributionsByContextsId(
+      absl::Span<const int64> context_ids) final;
+
+  absl::Status DeleteAttributionsByArtifactsId(
+      absl::Span<const int64> artifact_ids) final;
+
+  absl::Status DeleteParentContextsByParentIds(
+      absl::Span<const int64> parent_context_ids) final;
+
+  absl::Status DeleteParentContextsByChildIds(
+      absl::Span<const int64> child_context_ids) final;
+
+ private:
+  ///////// These methods are implementations details //////////////////////////
+
+  // Creates a `Type` where acceptable ones are in {ArtifactType, ExecutionType,
+  // ContextType}.
+  // Returns INVALID_ARGUMENT error, if name field is not given.
+  // Returns INVALID_ARGUMENT error, if any property type is unknown.
+  template <typename Type>
+  absl::Status CreateTypeImpl(const Type& type, int64* type_id);
+
+  // Updates an existing type by adding its new properties.
+  // Returns INVALID_ARGUMENT error, if name field is not given.
+  // Returns INVALID_ARGUMENT error, if id field is given and is different.
+  // Returns INVALID_ARGUMENT error, if any property type is unknown.
+  // Returns ALREADY_EXISTS error, if any property type is different.
+  template <typename Type>
+  absl::Status UpdateTypeImpl(const Type& type);
+
+  // Creates the `types` in order with CreateTypeImpl.
+  template <typename Type>
+  absl::Status CreateTypesImpl(absl::Span<const Type> types,
+                               std::vector<int64>* type_ids);
+
+  // Adds the properties of the `types` to the stored types of their ids.
+  // Returns INVALID_ARGUMENT error, if any type has no id.
+  // Returns INVALID_ARGUMENT error, if any property type is unknown.
+  // Returns NOT_FOUND error, if any type id cannot be found.
+  template <typename Type>
+  absl::Status AddTypePropertiesImpl(absl::Span<const Type> types);
+
+  // Finds the types of all versions with the given `names` in the id order.
+  template <typename Type>
+  absl::Status FindTypesByNamesImpl(absl::Span<const std::string> names,
+                                    std::vector<Type>* types);
+
+  // Finds the types with the given `type_ids`, skipping the unknown ones.
+  template <typename Type>
+  absl::Status FindTypesByIdsImpl(absl::Span<const int64> type_ids,
+                                  std::vector<Type>* types);
+
+  // Finds a type by its type_id.
+  // Returns NOT_FOUND error, if the given type_id cannot be found.
+  template <typename Type>
+  absl::Status FindTypeImpl(int64 type_id, Type* type);
+
+  // Finds the type with the smallest id of the given name and version.
+  // Returns NOT_FOUND error, if the given name and version cannot be found.
+  template <typename Type>
+  absl::Status FindTypeImpl(absl::string_view name,
+                            absl::optional<absl::string_view> version,
+                            Type* type);
+
+  // Finds all types of the kind `Type` in the id order.
+  template <typename Type>
+  absl::Status FindAllTypeInstancesImpl(std::vector<Type>* types);
+
+  // Links the type with id `type_id` to its parent type.
+  template <typename Type>
+  absl::Status CreateParentTypeInheritanceLinkImpl(const Type& type,
+                                                   const Type& parent_type);
+
+  // Queries the parent type of each type_id in `type_ids`. The parent types
+  // only have their ids, names, versions and descriptions.
+  // Returns INVALID_ARGUMENT error, if the given `type_ids` is empty, or
+  // `output_parent_types` is not empty.
+  template <typename Type>
+  absl::Status FindParentTypesByTypeIdImpl(
+      absl::Span<const int64> type_ids,
+      absl::flat_hash_map<int64, Type>& output_parent_types);
+
+  // Creates a batch of `Node`s, which is one of {`Artifact`, `Execution`,
+  // `Context`}, then returns the assigned node ids in the same order. The
+  // nodes are validated before any of them is stored.
+  // Returns INVALID_ARGUMENT error, if any node does not align with its type.
+  // Returns ALREADY_EXISTS error, if any (type_id, name) of the nodes is taken.
+  template <typename Node, typename NodeType>
+  absl::Status CreateNodesImpl(absl::Span<const Node> nodes,
+                               std::vector<int64>* node_ids);
+
+  // Creates a `Node`, which is one of {`Artifact`, `Context`}, unless its
+  // type has a node with the same name, then returns the id of the created or
+  // the stored node.
+  // Returns INVALID_ARGUMENT error, if the node has no name, or does not align
+  // with its type.
+  template <typename Node, typename NodeType>
+  absl::Status CreateNodeIfNotExistImpl(const Node& node, int64* node_id,
+                                        bool* is_created);
+
+  // Retrieves a set of `Node` which is one of {`Artifact`, `Execution`,
+  // `Context`} by the given 'ids' in the id order, with the properties of
+  // `projection`.
+  // Returns INVALID_ARGUMENT if node_ids is empty or nodes is not empty.
+  // If any ids are not found then returns NOT_FOUND if skipped_ids_ok is true,
+  // otherwise INTERNAL error.
+  template <typename Node>
+  absl::Status FindNodesImpl(
+      absl::Span<const int64> node_ids, bool skipped_ids_ok,
+      std::vector<Node>& nodes,
+      const ListOperationOptions::PropertyProjection& projection =
+          ListOperationOptions::PropertyProjection::default_instance());
+
+  // Finds all nodes of the kind `Node` in the id order.
+  template <typename Node>
+  absl::Status FindAllNodesImpl(std::vector<Node>* nodes);
+
+  // Finds the nodes of the kind `Node` with the given type id, and lists them
+  // if `list_options` is given.
+  // Returns NOT_FOUND error, if no node has the type id.
+  template <typename Node>
+  absl::Status FindNodesByTypeIdImpl(
+      int64 type_id, absl::optional<ListOperationOptions> list_options,
+      std::vector<Node>* nodes, std::string* next_page_token);
+
+  // Finds the node of the kind `Node` with the given type id and name.
+  // Returns NOT_FOUND error, if no node has the type id and name.
+  template <typename Node>
+  absl::Status FindNodeByTypeIdAndNameImpl(int64 type_id,
+                                           absl::string_view name, Node* node);
+
+  // Updates a `Node` which is one of {`Artifact`, `Execution`, `Context`}.
+  // Returns INVALID_ARGUMENT error, if the node cannot be found
+  // Returns INVALID_ARGUMENT error, if the node does not match with its type
+  template <typename Node, typename NodeType>
+  absl::Status UpdateNodeImpl(const Node& node);
+
+  // Lists the nodes of the kind `Node` among `candidate_ids` if given, or
+  // among all stored nodes otherwise, based on `options`.
+  // Returns INVALID_ARGUMENT error, if the `options` are invalid.
+  // Returns UNIMPLEMENTED error, if the `options` have a filter query.
+  template <typename Node>
+  absl::Status ListNodes(const ListOperationOptions& options,
+                         absl::optional<absl::Span<const int64>> candidate_ids,
+                         std::vector<Node>* nodes,
+                         std::string* next_page_token);
+
+  // Counts the nodes of the kind `Node` grouped by the dimensions of
+  // `options`.
+  // Returns INVALID_ARGUMENT error, if the `options` are invalid.
+  // Returns UNIMPLEMENTED error, if the `options` have a filter query.
+  template <typename Node>
+  absl::Status CountNodesImpl(const CountOptions& options,
+                              std::vector<NodeCount>* counts);
+
+  // Deletes the nodes of the kind `Node` with the given ids and their
+  // properties, and logs their deletion.
+  template <typename Node>
+  absl::Status DeleteNodesImpl(absl::Span<const int64> node_ids);
+
+  // Finds the parent (`is_parent`) or child contexts of the context.
+  absl::Status FindLinkedContextsImpl(int64 context_id, bool is_parent,
+                                      std::vector<Context>* contexts);
+
+  // Finds the ancestor (`is_parent`) or descendant contexts of the context
+  // within `max_depth` levels, ordered by their distance and id.
+  absl::Status FindContextHierarchyImpl(int64 context_id, int64 max_depth,
+                                        bool is_parent,
+                                        std::vector<Context>* contexts);
+
+  // Finds the events with the given ids in the event id order.
+  // Returns NOT_FOUND error with `not_found_message`, if no event is found.
+  absl::Status FindEventsImpl(absl::Span<const int64> keys, bool by_artifacts,
+                              absl::string_view not_found_message,
+                              std::vector<Event>* events);
+
+  // Lists a page of the events using `options` among the ids returned by
+  // `event_ids`, a callable of (const InMemoryDatabase&) returning the ids of
+  // the candidate events.
+  template <typename EventIds>
+  absl::Status ListEventsImpl(EventIds event_ids,
+                              absl::Span<const Event::Type> event_types,
+                              const ListOperationOptions& options,
+                              std::vector<Event>* events,
+                              std::string* next_page_token);
+
+  // Traverses the lineage graph of the `query_nodes` within `max_num_hops` and
+  // `max_nodes` other nodes, and adds the reached nodes and events to the
+  // `subgraph`.
+  absl::Status QueryLineageGraphImpl(
+      const std::vector<Artifact>& query_nodes, int64 max_num_hops,
+      absl::optional<int64> max_nodes,
+      absl::optional<std::string> boundary_artifacts,
+      absl::optional<std::string> boundary_executions, bool ids_only,
+      LineageGraph& subgraph);
+
+  InMemoryMetadataSource* const metadata_source_;
+  const int64 library_version_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_ACCESS_OBJECT_H_
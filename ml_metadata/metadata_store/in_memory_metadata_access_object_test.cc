@@ -0,0 +1,168 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Test suite for an InMemoryMetadataSource based MetadataAccessObject.
+
+#include <memory>
+#include <tuple>
+
+#include <glog/logging.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
+#include "ml_metadata/metadata_store/metadata_access_object_factory.h"
+#include "ml_metadata/metadata_store/metadata_access_object_test.h"
+#include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/util/metadata_source_query_config.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+namespace testing {
+
+namespace {
+
+// InMemoryMetadataAccessObjectContainer implements
+// MetadataAccessObjectContainer to generate and retrieve a MetadataAccessObject
+// based on an InMemoryMetadataSource. The schema is not materialized, so the
+// migrations only change the recorded schema version, and the tables are
+// emulated by the names kept in the database.
+class InMemoryMetadataAccessObjectContainer
+    : public MetadataAccessObjectContainer {
+ public:
+  InMemoryMetadataAccessObjectContainer() {
+    metadata_source_ = absl::make_unique<InMemoryMetadataSource>();
+    CHECK_EQ(absl::OkStatus(),
+             CreateMetadataAccessObject(
+                 util::GetInMemoryMetadataSourceQueryConfig(),
+                 metadata_source_.get(), &metadata_access_object_));
+  }
+
+  ~InMemoryMetadataAccessObjectContainer() override = default;
+
+  MetadataSource* GetMetadataSource() override {
+    return metadata_source_.get();
+  }
+  MetadataAccessObject* GetMetadataAccessObject() override {
+    return metadata_access_object_.get();
+  }
+
+  // Only the upgrade from the previous schema version is emulated.
+  bool HasUpgradeVerification(int64 version) override {
+    return version == metadata_access_object_->GetLibraryVersion() - 1;
+  }
+
+  bool HasDowngradeVerification(int64 version) override { return false; }
+
+  absl::Status SetupPreviousVersionForDowngrade(int64 version) override {
+    return metadata_access_object_->InitMetadataSourceIfNotExists();
+  }
+
+  absl::Status DowngradeVerification(int64 version) override {
+    return absl::OkStatus();
+  }
+
+  absl::Status SetupPreviousVersionForUpgrade(int64 version) override {
+    MLMD_RETURN_IF_ERROR(metadata_access_object_->InitMetadataSource());
+    return metadata_access_object_->DowngradeMetadataSource(version);
+  }
+
+  absl::Status UpgradeVerification(int64 version) override {
+    return absl::OkStatus();
+  }
+
+  absl::Status DropTypeTable() override {
+    MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                          metadata_source_->GetMutableDatabase());
+    db->tables.erase("Type");
+    return absl::OkStatus();
+  }
+
+  absl::Status DropArtifactTable() override {
+    MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                          metadata_source_->GetMutableDatabase());
+    db->tables.erase("Artifact");
+    return absl::OkStatus();
+  }
+
+  absl::Status DeleteSchemaVersion() override {
+    MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                          metadata_source_->GetMutableDatabase());
+    db->schema_version.reset();
+    return absl::OkStatus();
+  }
+
+  // The property tables are emulated by the properties of the stored nodes.
+  absl::StatusOr<bool> CheckTableEmpty(absl::string_view table_name) override {
+    MLMD_ASSIGN_OR_RETURN(const InMemoryDatabase* db,
+                          metadata_source_->GetDatabase());
+    if (table_name == "ArtifactProperty") {
+      return HasNoProperties(std::get<InMemoryNodeTable<Artifact>>(
+          db->node_tables));
+    }
+    if (table_name == "ExecutionProperty") {
+      return HasNoProperties(std::get<InMemoryNodeTable<Execution>>(
+          db->node_tables));
+    }
+    if (table_name == "ContextProperty") {
+      return HasNoProperties(std::get<InMemoryNodeTable<Context>>(
+          db->node_tables));
+    }
+    return absl::UnimplementedError(
+        absl::StrCat("Unsupported table: ", table_name));
+  }
+
+  absl::Status SetDatabaseVersionIncompatible() override {
+    MLMD_ASSIGN_OR_RETURN(InMemoryDatabase * db,
+                          metadata_source_->GetMutableDatabase());
+    db->schema_version = metadata_access_object_->GetLibraryVersion() + 1;
+    return absl::OkStatus();
+  }
+
+  int64 MinimumVersion() override {
+    return metadata_access_object_->GetLibraryVersion() - 1;
+  }
+
+  bool PerformExtendedTests() override { return false; }
+
+ private:
+  template <typename Node>
+  static bool HasNoProperties(const InMemoryNodeTable<Node>& table) {
+    for (const auto& id_and_node : table.nodes) {
+      if (!id_and_node.second.properties().empty() ||
+          !id_and_node.second.custom_properties().empty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::unique_ptr<InMemoryMetadataSource> metadata_source_;
+  std::unique_ptr<MetadataAccessObject> metadata_access_object_;
+};
+
+}  // namespace
+
+INSTANTIATE_TEST_SUITE_P(
+    InMemoryMetadataAccessObjectTest, MetadataAccessObjectTest,
+    ::testing::Values([]() {
+      return absl::make_unique<InMemoryMetadataAccessObjectContainer>();
+    }));
+
+}  // namespace testing
+}  // namespace ml_metadata
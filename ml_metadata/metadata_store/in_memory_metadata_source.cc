@@ -0,0 +1,80 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+namespace ml_metadata {
+
+absl::StatusOr<const InMemoryDatabase*> InMemoryMetadataSource::GetDatabase()
+    const {
+  if (!is_connected())
+    return absl::FailedPreconditionError("No opened connection for querying.");
+  if (!transaction_open())
+    return absl::FailedPreconditionError("Transaction not open.");
+  return database_.get();
+}
+
+absl::StatusOr<InMemoryDatabase*> InMemoryMetadataSource::GetMutableDatabase() {
+  if (!is_connected())
+    return absl::FailedPreconditionError("No opened connection for querying.");
+  if (!transaction_open())
+    return absl::FailedPreconditionError("Transaction not open.");
+  if (snapshot_ == nullptr) {
+    snapshot_ = absl::make_unique<InMemoryDatabase>(*database_);
+  }
+  return database_.get();
+}
+
+absl::Status InMemoryMetadataSource::ConnectImpl() {
+  database_ = absl::make_unique<InMemoryDatabase>();
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataSource::CloseImpl() {
+  database_.reset();
+  snapshot_.reset();
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataSource::ExecuteQueryImpl(const std::string& query,
+                                                      RecordSet* results) {
+  return absl::UnimplementedError(
+      "Queries are not supported by the in-memory metadata source.");
+}
+
+absl::Status InMemoryMetadataSource::BeginImpl() {
+  snapshot_.reset();
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataSource::CommitImpl() {
+  snapshot_.reset();
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryMetadataSource::RollbackImpl() {
+  if (snapshot_ != nullptr) {
+    database_ = std::move(snapshot_);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,181 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_SOURCE_H_
+#define ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_SOURCE_H_
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// The stored types of a kind, i.e., ArtifactType, ExecutionType or ContextType.
+// The types are keyed by id, and indexed by (name, version), where an unset
+// version is indexed as an empty version.
+template <typename Type>
+struct InMemoryTypeTable {
+  absl::btree_map<int64, Type> types;
+  absl::flat_hash_map<std::pair<std::string, std::string>,
+                      absl::btree_set<int64>>
+      ids_by_name_and_version;
+};
+
+// The stored nodes of a kind, i.e., Artifact, Execution or Context, and their
+// properties. The nodes are keyed by id, so that scans return them in the id
+// order, and indexed by type id and by (type id, name) for the named nodes.
+template <typename Node>
+struct InMemoryNodeTable {
+  absl::btree_map<int64, Node> nodes;
+  absl::flat_hash_map<int64, absl::btree_set<int64>> ids_by_type_id;
+  absl::flat_hash_map<std::pair<int64, std::string>, int64>
+      id_by_type_id_and_name;
+  int64 last_id = 0;
+};
+
+// The metadata kept by an InMemoryMetadataSource. It mirrors the tables of the
+// relational schema: the primary tables are ordered maps keyed by id, and the
+// lookups of the MetadataAccessObject are served by the hash map indices.
+struct InMemoryDatabase {
+  // The names of the created tables of the relational schema, which are used
+  // to tell an empty, a partially created and an initialized database apart.
+  absl::btree_set<std::string> tables;
+  // The schema version recorded in the MLMDEnv table, if any.
+  absl::optional<int64> schema_version;
+
+  // Types of all kinds share the ids of the Type table.
+  int64 last_type_id = 0;
+  std::tuple<InMemoryTypeTable<ArtifactType>, InMemoryTypeTable<ExecutionType>,
+             InMemoryTypeTable<ContextType>>
+      type_tables;
+  // The parent type ids keyed by the type id.
+  absl::flat_hash_map<int64, absl::btree_set<int64>> parent_type_ids;
+
+  std::tuple<InMemoryNodeTable<Artifact>, InMemoryNodeTable<Execution>,
+             InMemoryNodeTable<Context>>
+      node_tables;
+  absl::flat_hash_map<std::string, absl::btree_set<int64>> artifact_ids_by_uri;
+
+  // The events keyed by event id, and indexed by their artifacts and
+  // executions. `event_keys` keeps the unique (artifact id, execution id,
+  // type) of the events.
+  int64 last_event_id = 0;
+  absl::btree_map<int64, Event> events;
+  absl::flat_hash_map<int64, absl::btree_set<int64>> event_ids_by_artifact_id;
+  absl::flat_hash_map<int64, absl::btree_set<int64>> event_ids_by_execution_id;
+  absl::flat_hash_set<std::tuple<int64, int64, int>> event_keys;
+
+  // The archived executions, which are moved out of the Execution table, so
+  // that they are only found by id. Their events stay in `events` and its
+  // indices for the event reads and the lineage graph, and are kept in
+  // `archived_event_ids` so that the event lists skip them.
+  absl::btree_map<int64, Execution> archived_executions;
+  absl::btree_set<int64> archived_event_ids;
+
+  // The associations and attributions indexed in both directions.
+  int64 last_association_id = 0;
+  absl::flat_hash_map<int64, absl::btree_set<int64>>
+      execution_ids_by_context_id;
+  absl::flat_hash_map<int64, absl::btree_set<int64>>
+      context_ids_by_execution_id;
+  int64 last_attribution_id = 0;
+  absl::flat_hash_map<int64, absl::btree_set<int64>>
+      artifact_ids_by_context_id;
+  absl::flat_hash_map<int64, absl::btree_set<int64>>
+      context_ids_by_artifact_id;
+
+  // The parent contexts indexed in both directions.
+  absl::flat_hash_map<int64, absl::btree_set<int64>> parent_ids_by_context_id;
+  absl::flat_hash_map<int64, absl::btree_set<int64>> child_ids_by_context_id;
+
+  // The change log entries in the order of their sequence numbers.
+  std::vector<ChangeLogEntry> change_log;
+};
+
+// A MetadataSource keeping the metadata in an InMemoryDatabase instead of a
+// relational database. It does not run any queries: it is used with the
+// InMemoryMetadataAccessObject, which reads and writes the database directly.
+// The database is created on connect, and destroyed on close.
+//
+// The first write of a transaction copies the database, so that a rollback
+// restores the copy. The source is meant for tests and short-lived stores of
+// ephemeral pipelines, whose databases are small.
+// This class is thread-unsafe.
+class InMemoryMetadataSource : public MetadataSource {
+ public:
+  InMemoryMetadataSource() = default;
+  ~InMemoryMetadataSource() override = default;
+
+  // Disallow copy and assign.
+  InMemoryMetadataSource(const InMemoryMetadataSource&) = delete;
+  InMemoryMetadataSource& operator=(const InMemoryMetadataSource&) = delete;
+
+  // No query is composed, so the value is returned as is.
+  std::string EscapeString(absl::string_view value) const final {
+    return std::string(value);
+  }
+
+  // Returns the database to read in the open transaction.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns FAILED_PRECONDITION error, if a transaction has not begun.
+  absl::StatusOr<const InMemoryDatabase*> GetDatabase() const;
+
+  // Returns the database to write in the open transaction. The database is
+  // copied at the first write of the transaction for the rollback.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns FAILED_PRECONDITION error, if a transaction has not begun.
+  absl::StatusOr<InMemoryDatabase*> GetMutableDatabase();
+
+ private:
+  // Creates an empty database.
+  absl::Status ConnectImpl() final;
+
+  // Destroys the database. All data stored will be cleaned up.
+  absl::Status CloseImpl() final;
+
+  // Returns UNIMPLEMENTED error, as the source does not run queries.
+  absl::Status ExecuteQueryImpl(const std::string& query,
+                                RecordSet* results) final;
+
+  // Begins a transaction.
+  absl::Status BeginImpl() final;
+
+  // Commits a transaction by dropping its copy of the database.
+  absl::Status CommitImpl() final;
+
+  // Rollbacks a transaction by restoring its copy of the database.
+  absl::Status RollbackImpl() final;
+
+  std::unique_ptr<InMemoryDatabase> database_;
+
+  // The database before the first write of the open transaction, if any.
+  std::unique_ptr<InMemoryDatabase> snapshot_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_IN_MEMORY_METADATA_SOURCE_H_
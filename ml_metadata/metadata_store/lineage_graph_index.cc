@@ -0,0 +1,310 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/lineage_graph_index.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace ml_metadata {
+namespace {
+
+// The applied changes are merged into the CSR once they reach a quarter of its
+// edges, or this many edges and nodes for a small CSR.
+constexpr int64 kMinCompactionSize = 1024;
+
+}  // namespace
+
+LineageGraphIndex::LineageGraphIndex(const Config& config,
+                                     std::function<absl::Time()> clock)
+    : rebuild_interval_(absl::Seconds(config.rebuild_interval_sec())),
+      clock_(std::move(clock)) {}
+
+bool LineageGraphIndex::built() const {
+  absl::ReaderMutexLock lock(&mu_);
+  return built_;
+}
+
+bool LineageGraphIndex::StartRebuild() {
+  absl::MutexLock lock(&mu_);
+  if (rebuilding_) {
+    return false;
+  }
+  if (built_ && (rebuild_interval_ <= absl::ZeroDuration() ||
+                 clock_() - build_time_ < rebuild_interval_)) {
+    return false;
+  }
+  rebuilding_ = true;
+  return true;
+}
+
+void LineageGraphIndex::Rebuild(std::vector<Edge> edges,
+                                const int64 sequence_number) {
+  Adjacency artifact_adjacency;
+  Adjacency execution_adjacency;
+  BuildAdjacencies(std::move(edges), &artifact_adjacency,
+                   &execution_adjacency);
+  absl::MutexLock lock(&mu_);
+  artifact_adjacency_ = std::move(artifact_adjacency);
+  execution_adjacency_ = std::move(execution_adjacency);
+  added_artifact_edges_.clear();
+  added_execution_edges_.clear();
+  num_added_edges_ = 0;
+  deleted_artifact_ids_.clear();
+  deleted_execution_ids_.clear();
+  sequence_number_ = sequence_number;
+  build_time_ = clock_();
+  built_ = true;
+  rebuilding_ = false;
+}
+
+void LineageGraphIndex::AbortRebuild() {
+  absl::MutexLock lock(&mu_);
+  rebuilding_ = false;
+}
+
+int64 LineageGraphIndex::sequence_number() const {
+  absl::ReaderMutexLock lock(&mu_);
+  return sequence_number_;
+}
+
+void LineageGraphIndex::Apply(absl::Span<const ChangeLogEntry> entries) {
+  absl::MutexLock lock(&mu_);
+  if (!built_) {
+    return;
+  }
+  for (const ChangeLogEntry& entry : entries) {
+    if (entry.sequence_number() <= sequence_number_) {
+      continue;
+    }
+    sequence_number_ = entry.sequence_number();
+    switch (entry.kind()) {
+      case ChangeLogEntry::EVENT:
+        if (entry.operation() == ChangeLogEntry::CREATED) {
+          added_artifact_edges_[entry.artifact_id()].push_back(
+              entry.execution_id());
+          added_execution_edges_[entry.execution_id()].push_back(
+              entry.artifact_id());
+          num_added_edges_++;
+        }
+        break;
+      case ChangeLogEntry::ARTIFACT:
+        if (entry.operation() == ChangeLogEntry::DELETED) {
+          deleted_artifact_ids_.insert(entry.artifact_id());
+        }
+        break;
+      case ChangeLogEntry::EXECUTION:
+        if (entry.operation() == ChangeLogEntry::DELETED) {
+          deleted_execution_ids_.insert(entry.execution_id());
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  const int64 num_changes = num_added_edges_ + deleted_artifact_ids_.size() +
+                            deleted_execution_ids_.size();
+  if (num_changes >=
+      std::max<int64>(kMinCompactionSize,
+                      artifact_adjacency_.neighbors.size() / 4)) {
+    Compact();
+  }
+}
+
+void LineageGraphIndex::Traverse(absl::Span<const int64> query_artifact_ids,
+                                 const int64 max_num_hops,
+                                 const int64 max_nodes,
+                                 std::vector<Node>* nodes) const {
+  nodes->clear();
+  std::vector<int64> frontier(query_artifact_ids.begin(),
+                              query_artifact_ids.end());
+  absl::c_sort(frontier);
+  frontier.erase(std::unique(frontier.begin(), frontier.end()),
+                 frontier.end());
+  absl::flat_hash_set<int64> visited_artifact_ids(frontier.begin(),
+                                                  frontier.end());
+  absl::flat_hash_set<int64> visited_execution_ids;
+  for (const int64 id : frontier) {
+    if (nodes->size() >= max_nodes) {
+      return;
+    }
+    nodes->push_back({/*is_artifact=*/true, id});
+  }
+
+  absl::ReaderMutexLock lock(&mu_);
+  // Each hop reaches the nodes of the other direction, and the nodes reached
+  // by a hop are at the same distance, so they are ordered by id.
+  bool from_artifacts = true;
+  std::vector<int64> neighbors;
+  for (int64 hop = 0; hop < max_num_hops && !frontier.empty(); hop++) {
+    neighbors.clear();
+    for (const int64 id : frontier) {
+      if (from_artifacts) {
+        AppendNeighbors(id, artifact_adjacency_, execution_adjacency_,
+                        added_artifact_edges_, deleted_execution_ids_,
+                        &neighbors);
+      } else {
+        AppendNeighbors(id, execution_adjacency_, artifact_adjacency_,
+                        added_execution_edges_, deleted_artifact_ids_,
+                        &neighbors);
+      }
+    }
+    absl::flat_hash_set<int64>& visited_ids =
+        from_artifacts ? visited_execution_ids : visited_artifact_ids;
+    frontier.clear();
+    for (const int64 id : neighbors) {
+      if (visited_ids.insert(id).second) {
+        frontier.push_back(id);
+      }
+    }
+    absl::c_sort(frontier);
+    for (const int64 id : frontier) {
+      if (nodes->size() >= max_nodes) {
+        return;
+      }
+      nodes->push_back({/*is_artifact=*/!from_artifacts, id});
+    }
+    from_artifacts = !from_artifacts;
+  }
+}
+
+int64 LineageGraphIndex::num_edges() const {
+  absl::ReaderMutexLock lock(&mu_);
+  return artifact_adjacency_.neighbors.size() + num_added_edges_;
+}
+
+void LineageGraphIndex::BuildAdjacencies(std::vector<Edge> edges,
+                                         Adjacency* artifact_adjacency,
+                                         Adjacency* execution_adjacency) {
+  // The events of the same artifact and execution, e.g., of an input and an
+  // output, are a single edge.
+  absl::c_sort(edges);
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  // Sets the ids of `adjacency` to the sorted unique `first` or `second` ids
+  // of the edges.
+  const auto set_ids = [&edges](const bool first, Adjacency* adjacency) {
+    adjacency->ids.clear();
+    adjacency->ids.reserve(edges.size());
+    for (const Edge& edge : edges) {
+      adjacency->ids.push_back(first ? edge.first : edge.second);
+    }
+    absl::c_sort(adjacency->ids);
+    adjacency->ids.erase(
+        std::unique(adjacency->ids.begin(), adjacency->ids.end()),
+        adjacency->ids.end());
+    adjacency->ids.shrink_to_fit();
+  };
+  set_ids(/*first=*/true, artifact_adjacency);
+  set_ids(/*first=*/false, execution_adjacency);
+
+  // Sets the offsets and neighbors of `from` of the `edges` sorted by `from`
+  // node, whose neighbors are positions in the ids of `to`.
+  const auto set_neighbors = [&edges](const bool from_first,
+                                      const Adjacency& to, Adjacency* from) {
+    from->offsets.assign(1, 0);
+    from->offsets.reserve(from->ids.size() + 1);
+    from->neighbors.clear();
+    from->neighbors.reserve(edges.size());
+    for (int64 i = 0; i < edges.size(); i++) {
+      const int64 from_id = from_first ? edges[i].first : edges[i].second;
+      const int64 to_id = from_first ? edges[i].second : edges[i].first;
+      if (i > 0 &&
+          from_id != (from_first ? edges[i - 1].first : edges[i - 1].second)) {
+        from->offsets.push_back(from->neighbors.size());
+      }
+      from->neighbors.push_back(
+          absl::c_lower_bound(to.ids, to_id) - to.ids.begin());
+    }
+    if (!edges.empty()) {
+      from->offsets.push_back(from->neighbors.size());
+    }
+  };
+  set_neighbors(/*from_first=*/true, *execution_adjacency, artifact_adjacency);
+  absl::c_sort(edges, [](const Edge& a, const Edge& b) {
+    return std::make_pair(a.second, a.first) <
+           std::make_pair(b.second, b.first);
+  });
+  set_neighbors(/*from_first=*/false, *artifact_adjacency,
+                execution_adjacency);
+}
+
+void LineageGraphIndex::AppendNeighbors(
+    const int64 id, const Adjacency& from, const Adjacency& to,
+    const absl::flat_hash_map<int64, std::vector<int64>>& added_edges,
+    const absl::flat_hash_set<int64>& deleted_ids,
+    std::vector<int64>* neighbors) const {
+  const auto it = absl::c_lower_bound(from.ids, id);
+  if (it != from.ids.end() && *it == id) {
+    const int64 position = it - from.ids.begin();
+    for (int64 i = from.offsets[position]; i < from.offsets[position + 1];
+         i++) {
+      const int64 neighbor_id = to.ids[from.neighbors[i]];
+      if (!deleted_ids.contains(neighbor_id)) {
+        neighbors->push_back(neighbor_id);
+      }
+    }
+  }
+  const auto added_it = added_edges.find(id);
+  if (added_it != added_edges.end()) {
+    for (const int64 neighbor_id : added_it->second) {
+      if (!deleted_ids.contains(neighbor_id)) {
+        neighbors->push_back(neighbor_id);
+      }
+    }
+  }
+}
+
+void LineageGraphIndex::Compact() {
+  std::vector<Edge> edges;
+  edges.reserve(artifact_adjacency_.neighbors.size() + num_added_edges_);
+  for (int64 i = 0; i < artifact_adjacency_.ids.size(); i++) {
+    const int64 artifact_id = artifact_adjacency_.ids[i];
+    if (deleted_artifact_ids_.contains(artifact_id)) {
+      continue;
+    }
+    for (int64 k = artifact_adjacency_.offsets[i];
+         k < artifact_adjacency_.offsets[i + 1]; k++) {
+      const int64 execution_id =
+          execution_adjacency_.ids[artifact_adjacency_.neighbors[k]];
+      if (!deleted_execution_ids_.contains(execution_id)) {
+        edges.push_back({artifact_id, execution_id});
+      }
+    }
+  }
+  for (const auto& added : added_artifact_edges_) {
+    if (deleted_artifact_ids_.contains(added.first)) {
+      continue;
+    }
+    for (const int64 execution_id : added.second) {
+      if (!deleted_execution_ids_.contains(execution_id)) {
+        edges.push_back({added.first, execution_id});
+      }
+    }
+  }
+  BuildAdjacencies(std::move(edges), &artifact_adjacency_,
+                   &execution_adjacency_);
+  added_artifact_edges_.clear();
+  added_execution_edges_.clear();
+  num_added_edges_ = 0;
+  deleted_artifact_ids_.clear();
+  deleted_execution_ids_.clear();
+}
+
+}  // namespace ml_metadata
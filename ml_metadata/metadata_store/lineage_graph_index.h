@@ -0,0 +1,174 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_LINEAGE_GRAPH_INDEX_H_
+#define ML_METADATA_METADATA_STORE_LINEAGE_GRAPH_INDEX_H_
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// An in-memory index of the lineage graph, i.e., of the edges between the
+// artifacts and the executions of the events, shared by the MetadataStores of
+// a pool, so that QueryLineageGraph traverses it instead of running a
+// recursive query. It is thread-safe.
+//
+// The edges are kept in a compressed sparse row (CSR) adjacency of each
+// direction: the sorted ids of the nodes with edges, and for each of them the
+// offset of its neighbors in an array of the positions of the neighbors in the
+// other direction, i.e., 4 bytes per edge and direction. The index is built
+// from the events read at a change log sequence number, and is kept current by
+// applying the change log entries after it, i.e., the events created and the
+// nodes deleted. The applied changes are kept aside, and merged into the CSR
+// once they reach a quarter of its edges.
+//
+// As the change log entries of a transaction may commit after the entries of
+// another with larger sequence numbers, and the events deleted without their
+// nodes are not logged, the index is rebuilt every `rebuild_interval_sec`.
+//
+// Usage example:
+//
+//    if (index->StartRebuild()) {
+//      index->Rebuild(ReadAllEdges(), last_sequence_number);
+//    }
+//    index->Apply(ReadChangeLogAfter(index->sequence_number()));
+//    std::vector<LineageGraphIndex::Node> nodes;
+//    index->Traverse(query_artifact_ids, max_num_hops, max_nodes, &nodes);
+class LineageGraphIndex {
+ public:
+  using Config =
+      MetadataStoreServerConfig::ConnectionPoolConfig::LineageGraphIndexConfig;
+
+  // An edge of an event, i.e., its artifact_id and execution_id.
+  using Edge = std::pair<int64, int64>;
+
+  // A node reached by a traversal.
+  struct Node {
+    bool is_artifact;
+    int64 id;
+  };
+
+  // Creates an empty index of `config`, which is rebuilt by the time of
+  // `clock`.
+  explicit LineageGraphIndex(const Config& config,
+                             std::function<absl::Time()> clock = absl::Now);
+
+  // Not copyable or movable
+  LineageGraphIndex(const LineageGraphIndex&) = delete;
+  LineageGraphIndex& operator=(const LineageGraphIndex&) = delete;
+
+  // Returns true if the index is built, and can be traversed.
+  bool built() const;
+
+  // Returns true if the caller is to rebuild the index, i.e., it is not built
+  // or is older than rebuild_interval_sec, and no other caller is rebuilding
+  // it. The caller must then call Rebuild or AbortRebuild.
+  bool StartRebuild();
+
+  // Replaces the edges of the index with `edges`, e.g., of all the events read
+  // at the change log `sequence_number`, which may repeat.
+  void Rebuild(std::vector<Edge> edges, int64 sequence_number);
+
+  // Ends a rebuild started by StartRebuild that failed, e.g., to read the
+  // edges, so that a later caller retries it.
+  void AbortRebuild();
+
+  // Returns the sequence number of the last change log entry applied.
+  int64 sequence_number() const;
+
+  // Applies the change log `entries` ordered by their sequence numbers. The
+  // entries up to sequence_number() are skipped, as are the entries of the
+  // contexts and the updates of the nodes.
+  void Apply(absl::Span<const ChangeLogEntry> entries);
+
+  // Sets `nodes` to the `query_artifact_ids` and the nodes reached from them
+  // within `max_num_hops` edges, ordered by their least distance, then the
+  // executions before the artifacts, and then by id, as the rows of
+  // QueryExecutor::SelectLineageGraphNodeDistances. At most `max_nodes` nodes
+  // are kept.
+  void Traverse(absl::Span<const int64> query_artifact_ids,
+                int64 max_num_hops, int64 max_nodes,
+                std::vector<Node>* nodes) const;
+
+  // Returns the number of edges in the CSR and of the applied changes.
+  int64 num_edges() const;
+
+ private:
+  // The CSR adjacency of a direction, e.g., from the artifacts.
+  struct Adjacency {
+    // The sorted ids of the nodes with edges.
+    std::vector<int64> ids;
+    // The neighbors of ids[i] are neighbors[offsets[i]..offsets[i + 1]).
+    std::vector<int64> offsets;
+    // The positions of the neighbors in the ids of the other direction.
+    std::vector<uint32> neighbors;
+  };
+
+  // Builds the `artifact_adjacency` and the `execution_adjacency` of `edges`.
+  static void BuildAdjacencies(std::vector<Edge> edges,
+                               Adjacency* artifact_adjacency,
+                               Adjacency* execution_adjacency);
+
+  // Appends the undeleted neighbors of the node `id` of a direction to
+  // `neighbors`. `from` is the adjacency of the direction and `to` the one of
+  // the other direction.
+  void AppendNeighbors(int64 id, const Adjacency& from, const Adjacency& to,
+                       const absl::flat_hash_map<int64, std::vector<int64>>&
+                           added_edges,
+                       const absl::flat_hash_set<int64>& deleted_ids,
+                       std::vector<int64>* neighbors) const
+      ABSL_SHARED_LOCKS_REQUIRED(mu_);
+
+  // Merges the applied changes into the CSR.
+  void Compact() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const absl::Duration rebuild_interval_;
+  const std::function<absl::Time()> clock_;
+
+  mutable absl::Mutex mu_;
+  bool built_ ABSL_GUARDED_BY(mu_) = false;
+  bool rebuilding_ ABSL_GUARDED_BY(mu_) = false;
+  absl::Time build_time_ ABSL_GUARDED_BY(mu_);
+  int64 sequence_number_ ABSL_GUARDED_BY(mu_) = 0;
+  // The neighbors of the artifacts are positions in `execution_adjacency_`,
+  // and vice versa.
+  Adjacency artifact_adjacency_ ABSL_GUARDED_BY(mu_);
+  Adjacency execution_adjacency_ ABSL_GUARDED_BY(mu_);
+  // The edges of the events created since the CSR was built, by artifact and
+  // by execution.
+  absl::flat_hash_map<int64, std::vector<int64>> added_artifact_edges_
+      ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<int64, std::vector<int64>> added_execution_edges_
+      ABSL_GUARDED_BY(mu_);
+  int64 num_added_edges_ ABSL_GUARDED_BY(mu_) = 0;
+  // The nodes deleted since the CSR was built, whose edges are skipped.
+  absl::flat_hash_set<int64> deleted_artifact_ids_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_set<int64> deleted_execution_ids_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_LINEAGE_GRAPH_INDEX_H_
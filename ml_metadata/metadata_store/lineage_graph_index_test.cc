@@ -0,0 +1,179 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/lineage_graph_index.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+
+class LineageGraphIndexTest : public ::testing::Test {
+ protected:
+  // Creates an index of `config_text` built of `edges` at sequence number 0,
+  // whose clock is `now_`.
+  std::unique_ptr<LineageGraphIndex> CreateIndex(
+      const std::string& config_text,
+      std::vector<LineageGraphIndex::Edge> edges) {
+    auto index = absl::make_unique<LineageGraphIndex>(
+        ParseTextProtoOrDie<LineageGraphIndex::Config>(config_text),
+        [this]() { return now_; });
+    EXPECT_TRUE(index->StartRebuild());
+    index->Rebuild(std::move(edges), /*sequence_number=*/0);
+    return index;
+  }
+
+  // Returns the nodes of `index` reached from `query_artifact_ids`, as
+  // `a<id>` for the artifacts and `e<id>` for the executions.
+  static std::vector<std::string> Traverse(
+      const LineageGraphIndex& index,
+      const std::vector<int64>& query_artifact_ids, int64 max_num_hops,
+      int64 max_nodes = 100) {
+    std::vector<LineageGraphIndex::Node> nodes;
+    index.Traverse(query_artifact_ids, max_num_hops, max_nodes, &nodes);
+    std::vector<std::string> names;
+    for (const LineageGraphIndex::Node& node : nodes) {
+      names.push_back(absl::StrCat(node.is_artifact ? "a" : "e", node.id));
+    }
+    return names;
+  }
+
+  absl::Time now_ = absl::UnixEpoch();
+};
+
+// a1 -> e1 -> a2 -> e2 -> a3, and a1 -> e3 -> a4.
+std::vector<LineageGraphIndex::Edge> ChainEdges() {
+  return {{1, 1}, {2, 1}, {2, 2}, {3, 2}, {1, 3}, {4, 3}, {1, 1}};
+}
+
+TEST_F(LineageGraphIndexTest, TraverseOrdersNodesByDistance) {
+  const auto index = CreateIndex("", ChainEdges());
+  EXPECT_EQ(index->num_edges(), 6);
+  EXPECT_EQ(Traverse(*index, {1}, /*max_num_hops=*/4),
+            std::vector<std::string>({"a1", "e1", "e3", "a2", "a4", "e2",
+                                      "a3"}));
+  EXPECT_EQ(Traverse(*index, {1}, /*max_num_hops=*/2),
+            std::vector<std::string>({"a1", "e1", "e3", "a2", "a4"}));
+  EXPECT_EQ(Traverse(*index, {3, 1}, /*max_num_hops=*/1),
+            std::vector<std::string>({"a1", "a3", "e1", "e2", "e3"}));
+  EXPECT_EQ(Traverse(*index, {1}, /*max_num_hops=*/4, /*max_nodes=*/4),
+            std::vector<std::string>({"a1", "e1", "e3", "a2"}));
+  // An artifact without events is only the query node.
+  EXPECT_EQ(Traverse(*index, {5}, /*max_num_hops=*/4),
+            std::vector<std::string>({"a5"}));
+}
+
+TEST_F(LineageGraphIndexTest, ApplyChangeLogEntries) {
+  const auto index = CreateIndex("", ChainEdges());
+  index->Apply({ParseTextProtoOrDie<ChangeLogEntry>(R"pb(
+                  sequence_number: 1
+                  kind: EVENT
+                  operation: CREATED
+                  artifact_id: 3
+                  execution_id: 4
+                )pb"),
+                ParseTextProtoOrDie<ChangeLogEntry>(R"pb(
+                  sequence_number: 2
+                  kind: EVENT
+                  operation: CREATED
+                  artifact_id: 5
+                  execution_id: 4
+                )pb"),
+                ParseTextProtoOrDie<ChangeLogEntry>(R"pb(
+                  sequence_number: 3
+                  kind: EXECUTION
+                  operation: DELETED
+                  execution_id: 3
+                )pb"),
+                ParseTextProtoOrDie<ChangeLogEntry>(R"pb(
+                  sequence_number: 4
+                  kind: CONTEXT
+                  operation: CREATED
+                  context_id: 1
+                )pb")});
+  EXPECT_EQ(index->sequence_number(), 4);
+  EXPECT_EQ(index->num_edges(), 8);
+  EXPECT_EQ(Traverse(*index, {1}, /*max_num_hops=*/10),
+            std::vector<std::string>({"a1", "e1", "a2", "e2", "a3", "e4",
+                                      "a5"}));
+
+  // The entries already applied are skipped.
+  index->Apply({ParseTextProtoOrDie<ChangeLogEntry>(R"pb(
+    sequence_number: 2
+    kind: ARTIFACT
+    operation: DELETED
+    artifact_id: 2
+  )pb")});
+  EXPECT_EQ(index->sequence_number(), 4);
+  EXPECT_EQ(Traverse(*index, {1}, /*max_num_hops=*/2),
+            std::vector<std::string>({"a1", "e1", "a2"}));
+}
+
+TEST_F(LineageGraphIndexTest, CompactKeepsTheTraversal) {
+  const auto index = CreateIndex("", {});
+  // a0 -> e0 -> a1 -> e1 -> ..., added by enough entries to be compacted.
+  std::vector<ChangeLogEntry> entries;
+  for (int i = 0; i < 1000; i++) {
+    ChangeLogEntry entry;
+    entry.set_kind(ChangeLogEntry::EVENT);
+    entry.set_operation(ChangeLogEntry::CREATED);
+    entry.set_artifact_id(i);
+    entry.set_execution_id(i);
+    entry.set_sequence_number(entries.size() + 1);
+    entries.push_back(entry);
+    entry.set_artifact_id(i + 1);
+    entry.set_sequence_number(entries.size() + 1);
+    entries.push_back(entry);
+  }
+  entries.back().set_kind(ChangeLogEntry::ARTIFACT);
+  entries.back().set_operation(ChangeLogEntry::DELETED);
+  entries.back().set_artifact_id(3);
+  index->Apply(entries);
+  // The edges of the deleted a3 are dropped by the compaction.
+  EXPECT_EQ(index->num_edges(), 1999 - 2);
+  EXPECT_EQ(Traverse(*index, {0}, /*max_num_hops=*/20),
+            std::vector<std::string>({"a0", "e0", "a1", "e1", "a2", "e2"}));
+}
+
+TEST_F(LineageGraphIndexTest, StartRebuildAfterTheInterval) {
+  const auto index = CreateIndex("rebuild_interval_sec: 60", ChainEdges());
+  EXPECT_TRUE(index->built());
+  EXPECT_FALSE(index->StartRebuild());
+  now_ += absl::Seconds(60);
+  EXPECT_TRUE(index->StartRebuild());
+  // A single caller rebuilds the index at a time.
+  EXPECT_FALSE(index->StartRebuild());
+  index->AbortRebuild();
+  EXPECT_TRUE(index->StartRebuild());
+  index->Rebuild({{1, 1}}, /*sequence_number=*/10);
+  EXPECT_EQ(index->sequence_number(), 10);
+  EXPECT_EQ(Traverse(*index, {1}, /*max_num_hops=*/4),
+            std::vector<std::string>({"a1", "e1"}));
+  EXPECT_FALSE(index->StartRebuild());
+}
+
+}  // namespace
+}  // namespace ml_metadata
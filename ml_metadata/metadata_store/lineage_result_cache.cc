@@ -0,0 +1,166 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/lineage_result_cache.h"
+
+#include <iterator>
+#include <utility>
+
+#include <glog/logging.h>
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+
+namespace ml_metadata {
+
+LineageResultCache::LineageResultCache(const Config& config,
+                                       std::function<absl::Time()> clock)
+    : config_(config), clock_(std::move(clock)) {
+  CHECK_GT(config_.max_entries(), 0)
+      << "The max_entries of the lineage result cache must be positive.";
+}
+
+std::string LineageResultCache::Key(const LineageGraphQueryOptions& options,
+                                    const int64 max_num_hops,
+                                    const bool ids_only) {
+  LineageGraphQueryOptions normalized_options = options;
+  normalized_options.mutable_stop_conditions()->set_max_num_hops(max_num_hops);
+  if (normalized_options.max_node_size() <= 0) {
+    normalized_options.clear_max_node_size();
+  }
+  return absl::StrCat(ids_only ? "GetLineageGraphIds:" : "GetLineageGraph:",
+                      normalized_options.SerializeAsString());
+}
+
+bool LineageResultCache::FiltersByContexts(
+    const LineageGraphQueryOptions& options) {
+  // The filter queries join the contexts by the contexts_$alias,
+  // parent_contexts_$alias and child_contexts_$alias of the filter syntax.
+  static constexpr char kContextsAlias[] = "contexts_";
+  return absl::StrContains(options.artifacts_options().filter_query(),
+                           kContextsAlias) ||
+         absl::StrContains(options.stop_conditions().boundary_artifacts(),
+                           kContextsAlias) ||
+         absl::StrContains(options.stop_conditions().boundary_executions(),
+                           kContextsAlias);
+}
+
+absl::Status LineageResultCache::ReadThrough(
+    const std::string& key, const bool depends_on_contexts, const Read& read,
+    GetLineageGraphResponse* response) {
+  if (Find(key, response)) {
+    return absl::OkStatus();
+  }
+  // The watermarks are captured before the read by the call running it, so
+  // that its result is not cached if a write advances them meanwhile. The
+  // calls joining the read of another call do not cache its result, and do
+  // not join a read started before a write advanced the watermarks.
+  const Watermarks arrival_watermarks = watermarks();
+  absl::optional<Watermarks> read_watermarks;
+  const absl::Status status = coalescer_.Coalesce(
+      key,
+      /*write_generation=*/arrival_watermarks.lineage +
+          arrival_watermarks.contexts,
+      absl::InfiniteFuture(),
+      [this, &read, &read_watermarks]() {
+        read_watermarks = watermarks();
+        return read();
+      },
+      response);
+  if (status.ok() && read_watermarks) {
+    Insert(key, depends_on_contexts, *read_watermarks, *response);
+  }
+  return status;
+}
+
+LineageResultCache::Watermarks LineageResultCache::watermarks() const {
+  absl::MutexLock lock(&mu_);
+  return watermarks_;
+}
+
+void LineageResultCache::Advance(const Write& write) {
+  if (write.empty()) {
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  if (write.lineage) {
+    watermarks_.lineage++;
+  }
+  if (write.contexts) {
+    watermarks_.contexts++;
+  }
+}
+
+int LineageResultCache::size() const {
+  absl::MutexLock lock(&mu_);
+  return entries_.size();
+}
+
+bool LineageResultCache::IsCurrent(const Watermarks& watermarks,
+                                   const bool depends_on_contexts) const {
+  return watermarks.lineage == watermarks_.lineage &&
+         (!depends_on_contexts || watermarks.contexts == watermarks_.contexts);
+}
+
+bool LineageResultCache::Find(const std::string& key,
+                              GetLineageGraphResponse* response) {
+  const absl::Time now = clock_();
+  absl::MutexLock lock(&mu_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return false;
+  }
+  if (it->second->expire_time <= now ||
+      !IsCurrent(it->second->watermarks, it->second->depends_on_contexts)) {
+    Erase(it->second);
+    return false;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  *response = it->second->response;
+  return true;
+}
+
+void LineageResultCache::Insert(const std::string& key,
+                                const bool depends_on_contexts,
+                                const Watermarks& watermarks,
+                                const GetLineageGraphResponse& response) {
+  const absl::Duration ttl = absl::Seconds(config_.ttl_sec());
+  if (ttl <= absl::ZeroDuration()) {
+    return;
+  }
+  const absl::Time expire_time = clock_() + ttl;
+  absl::MutexLock lock(&mu_);
+  if (!IsCurrent(watermarks, depends_on_contexts)) {
+    return;
+  }
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    Erase(it->second);
+  }
+  entries_.push_front(
+      {key, response, depends_on_contexts, watermarks, expire_time});
+  index_[entries_.front().key] = entries_.begin();
+  if (entries_.size() > config_.max_entries()) {
+    Erase(std::prev(entries_.end()));
+  }
+}
+
+void LineageResultCache::Erase(std::list<Entry>::iterator it) {
+  index_.erase(it->key);
+  entries_.erase(it);
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,172 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_LINEAGE_RESULT_CACHE_H_
+#define ML_METADATA_METADATA_STORE_LINEAGE_RESULT_CACHE_H_
+
+#include <functional>
+#include <list>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/request_coalescer.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+
+// A bounded LRU cache of the results of GetLineageGraph, keyed by the
+// normalized LineageGraphQueryOptions of the traversal, shared by the
+// MetadataStores of a pool. The identical traversals missing the cache at the
+// same time share a single read. It is thread-safe.
+//
+// The cached results are invalidated by two write watermarks, which the
+// writes of the stores sharing the cache advance once they commit: the
+// lineage watermark, advanced by the writes of nodes and events, and the
+// contexts watermark, advanced by the writes of contexts, attributions and
+// associations, which only invalidate the results of the traversals whose
+// query_nodes or boundaries filter by contexts. A result is served only if the
+// watermarks it depends on have not advanced since it was read. The cache does
+// not see the writes of other clients of the database, so the results also
+// expire after a TTL.
+//
+// Usage example:
+//
+//    const std::string key = LineageResultCache::Key(options, max_num_hops,
+//                                                    /*ids_only=*/false);
+//    MLMD_RETURN_IF_ERROR(cache->ReadThrough(
+//        key, LineageResultCache::FiltersByContexts(options),
+//        [&]() { return Traverse(options, &response); }, &response));
+class LineageResultCache {
+ public:
+  using Config =
+      MetadataStoreServerConfig::ConnectionPoolConfig::LineageResultCacheConfig;
+
+  // A read filling the response passed to ReadThrough.
+  using Read = std::function<absl::Status()>;
+
+  // The write watermarks at a point in time.
+  struct Watermarks {
+    int64 lineage = 0;
+    int64 contexts = 0;
+  };
+
+  // The watermarks advanced by a write.
+  struct Write {
+    // Whether the write puts or deletes nodes or events.
+    bool lineage = false;
+    // Whether the write puts contexts, attributions or associations.
+    bool contexts = false;
+
+    // Adds the watermarks of `other` to the write.
+    void Merge(const Write& other) {
+      lineage = lineage || other.lineage;
+      contexts = contexts || other.contexts;
+    }
+
+    // Returns true if the write advances no watermark.
+    bool empty() const { return !lineage && !contexts; }
+  };
+
+  // Creates a cache of `config`, whose entries expire by the time of `clock`.
+  // Check-fails if the max_entries of the config is not positive.
+  explicit LineageResultCache(const Config& config,
+                              std::function<absl::Time()> clock = absl::Now);
+
+  // Not copyable or movable
+  LineageResultCache(const LineageResultCache&) = delete;
+  LineageResultCache& operator=(const LineageResultCache&) = delete;
+
+  // Returns the key of a traversal of `options`, whose stop conditions are
+  // normalized, i.e., the max_num_hops is set to the `max_num_hops` of the
+  // traversal, and a non-positive max_node_size is cleared, so that the
+  // options of the same traversal share their key. `ids_only` is set for the
+  // traversals of GetLineageGraphIds.
+  static std::string Key(const LineageGraphQueryOptions& options,
+                         int64 max_num_hops, bool ids_only);
+
+  // Returns true if the query_nodes or the boundaries of `options` filter by
+  // contexts, i.e., the result of the traversal depends on the contexts
+  // watermark.
+  static bool FiltersByContexts(const LineageGraphQueryOptions& options);
+
+  // Copies the unexpired result of `key` to `response`, unless a watermark it
+  // depends on has advanced since it was read. Otherwise, runs `read` to fill
+  // `response`, or joins the identical read in flight, and caches its OK
+  // result if no watermark it depends on advances while it runs. The result
+  // depends on the contexts watermark, if `depends_on_contexts`.
+  // Returns detailed errors of the read.
+  absl::Status ReadThrough(const std::string& key, bool depends_on_contexts,
+                           const Read& read,
+                           GetLineageGraphResponse* response);
+
+  // Returns the current watermarks.
+  Watermarks watermarks() const;
+
+  // Advances the watermarks of `write`, e.g., once it commits.
+  void Advance(const Write& write);
+
+  // Returns the number of cached results, including the invalidated ones not
+  // yet evicted.
+  int size() const;
+
+ private:
+  // A cached result, the watermarks it was read at and the time it expires.
+  struct Entry {
+    std::string key;
+    GetLineageGraphResponse response;
+    bool depends_on_contexts;
+    Watermarks watermarks;
+    absl::Time expire_time;
+  };
+
+  // Returns true if a result read at `watermarks` is still valid.
+  bool IsCurrent(const Watermarks& watermarks, bool depends_on_contexts) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Copies the valid result of `key` to `response`, and marks it as the most
+  // recently used one. Returns false if there is no such result.
+  bool Find(const std::string& key, GetLineageGraphResponse* response);
+
+  // Inserts the `response` of `key` read at `watermarks`, and evicts the least
+  // recently used entry if the cache is full. The result is dropped if a
+  // watermark it depends on has advanced since.
+  void Insert(const std::string& key, bool depends_on_contexts,
+              const Watermarks& watermarks,
+              const GetLineageGraphResponse& response);
+
+  // Removes the entry at `it`.
+  void Erase(std::list<Entry>::iterator it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const Config config_;
+  const std::function<absl::Time()> clock_;
+  RequestCoalescer coalescer_;
+
+  mutable absl::Mutex mu_;
+  Watermarks watermarks_ ABSL_GUARDED_BY(mu_);
+  // The entries ordered by their last use, the most recent first.
+  std::list<Entry> entries_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, std::list<Entry>::iterator> index_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_LINEAGE_RESULT_CACHE_H_
@@ -0,0 +1,204 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/lineage_result_cache.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+
+class LineageResultCacheTest : public ::testing::Test {
+ protected:
+  // Creates a cache of `config_text`, whose clock is `now_`.
+  std::unique_ptr<LineageResultCache> CreateCache(
+      const std::string& config_text) {
+    return absl::make_unique<LineageResultCache>(
+        ParseTextProtoOrDie<LineageResultCache::Config>(config_text),
+        [this]() { return now_; });
+  }
+
+  // Reads `key` through `cache`, with a read that counts its runs in
+  // `num_reads_` and returns a graph of an artifact named `name`.
+  absl::Status ReadThrough(LineageResultCache* cache, const std::string& key,
+                           const bool depends_on_contexts,
+                           const std::string& name,
+                           GetLineageGraphResponse* response) {
+    return cache->ReadThrough(
+        key, depends_on_contexts,
+        [this, &name, response]() {
+          num_reads_++;
+          response->Clear();
+          response->mutable_subgraph()->add_artifacts()->set_name(name);
+          return absl::OkStatus();
+        },
+        response);
+  }
+
+  absl::Time now_ = absl::UnixEpoch();
+  std::atomic<int> num_reads_{0};
+};
+
+TEST_F(LineageResultCacheTest, NormalizesTheKeysOfTheOptions) {
+  const LineageGraphQueryOptions options =
+      ParseTextProtoOrDie<LineageGraphQueryOptions>(R"pb(
+        artifacts_options { filter_query: "uri = 'a'" }
+      )pb");
+  LineageGraphQueryOptions equivalent_options = options;
+  equivalent_options.mutable_stop_conditions()->set_max_num_hops(20);
+  equivalent_options.set_max_node_size(0);
+  EXPECT_EQ(LineageResultCache::Key(options, 20, /*ids_only=*/false),
+            LineageResultCache::Key(equivalent_options, 20,
+                                    /*ids_only=*/false));
+  EXPECT_NE(LineageResultCache::Key(options, 20, /*ids_only=*/false),
+            LineageResultCache::Key(options, 3, /*ids_only=*/false));
+  EXPECT_NE(LineageResultCache::Key(options, 20, /*ids_only=*/false),
+            LineageResultCache::Key(options, 20, /*ids_only=*/true));
+
+  EXPECT_FALSE(LineageResultCache::FiltersByContexts(options));
+  EXPECT_TRUE(LineageResultCache::FiltersByContexts(
+      ParseTextProtoOrDie<LineageGraphQueryOptions>(R"pb(
+        artifacts_options { filter_query: "contexts_a.name = 'run'" }
+      )pb")));
+  EXPECT_TRUE(LineageResultCache::FiltersByContexts(
+      ParseTextProtoOrDie<LineageGraphQueryOptions>(R"pb(
+        stop_conditions {
+          boundary_executions: "parent_contexts_a.name != 'pipeline'"
+        }
+      )pb")));
+}
+
+TEST_F(LineageResultCacheTest, ServesCachedResultsUntilTheyExpire) {
+  std::unique_ptr<LineageResultCache> cache = CreateCache("ttl_sec: 60");
+  GetLineageGraphResponse response;
+  ASSERT_EQ(absl::OkStatus(),
+            ReadThrough(cache.get(), "a", false, "first", &response));
+  ASSERT_EQ(absl::OkStatus(),
+            ReadThrough(cache.get(), "a", false, "second", &response));
+  EXPECT_EQ(num_reads_, 1);
+  EXPECT_EQ(response.subgraph().artifacts(0).name(), "first");
+
+  now_ += absl::Seconds(60);
+  ASSERT_EQ(absl::OkStatus(),
+            ReadThrough(cache.get(), "a", false, "third", &response));
+  EXPECT_EQ(num_reads_, 2);
+  EXPECT_EQ(response.subgraph().artifacts(0).name(), "third");
+}
+
+TEST_F(LineageResultCacheTest, EvictsLeastRecentlyUsedResults) {
+  std::unique_ptr<LineageResultCache> cache = CreateCache("max_entries: 2");
+  GetLineageGraphResponse response;
+  for (const char* key : {"a", "b", "a", "c", "a", "b"}) {
+    ASSERT_EQ(absl::OkStatus(),
+              ReadThrough(cache.get(), key, false, key, &response));
+  }
+  // `b` is evicted by `c`, and read again.
+  EXPECT_EQ(num_reads_, 4);
+  EXPECT_EQ(cache->size(), 2);
+}
+
+TEST_F(LineageResultCacheTest, InvalidatesResultsByTheirWatermarks) {
+  std::unique_ptr<LineageResultCache> cache = CreateCache("");
+  GetLineageGraphResponse response;
+  ASSERT_EQ(absl::OkStatus(),
+            ReadThrough(cache.get(), "nodes", false, "nodes", &response));
+  ASSERT_EQ(absl::OkStatus(),
+            ReadThrough(cache.get(), "contexts", true, "contexts", &response));
+  ASSERT_EQ(num_reads_, 2);
+
+  // A write of associations only invalidates the results filtering by
+  // contexts.
+  cache->Advance({/*lineage=*/false, /*contexts=*/true});
+  ASSERT_EQ(absl::OkStatus(),
+            ReadThrough(cache.get(), "nodes", false, "nodes", &response));
+  EXPECT_EQ(num_reads_, 2);
+  ASSERT_EQ(absl::OkStatus(),
+            ReadThrough(cache.get(), "contexts", true, "contexts", &response));
+  EXPECT_EQ(num_reads_, 3);
+
+  // A write of events invalidates all of them.
+  cache->Advance({/*lineage=*/true, /*contexts=*/false});
+  ASSERT_EQ(absl::OkStatus(),
+            ReadThrough(cache.get(), "nodes", false, "nodes", &response));
+  ASSERT_EQ(absl::OkStatus(),
+            ReadThrough(cache.get(), "contexts", true, "contexts", &response));
+  EXPECT_EQ(num_reads_, 5);
+}
+
+TEST_F(LineageResultCacheTest, DropsResultsOfReadsRacingWithWrites) {
+  std::unique_ptr<LineageResultCache> cache = CreateCache("");
+  GetLineageGraphResponse response;
+  ASSERT_EQ(absl::OkStatus(),
+            cache->ReadThrough(
+                "a", false,
+                [&cache]() {
+                  cache->Advance({/*lineage=*/true, /*contexts=*/false});
+                  return absl::OkStatus();
+                },
+                &response));
+  EXPECT_EQ(cache->size(), 0);
+}
+
+TEST_F(LineageResultCacheTest, IdenticalMissesShareOneRead) {
+  constexpr int kNumReads = 8;
+  std::unique_ptr<LineageResultCache> cache = CreateCache("");
+  absl::Notification release;
+  std::vector<GetLineageGraphResponse> responses(kNumReads);
+  std::vector<absl::Status> statuses(kNumReads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumReads; i++) {
+    threads.emplace_back([&, i]() {
+      statuses[i] = cache->ReadThrough(
+          "a", false,
+          [&, i]() {
+            num_reads_++;
+            release.WaitForNotification();
+            responses[i].mutable_subgraph()->add_artifacts()->set_name("a");
+            return absl::OkStatus();
+          },
+          &responses[i]);
+    });
+  }
+  // Lets the other reads join the first one before it completes.
+  absl::SleepFor(absl::Milliseconds(200));
+  release.Notify();
+  for (std::thread& thread : threads) thread.join();
+
+  EXPECT_EQ(num_reads_, 1);
+  for (int i = 0; i < kNumReads; i++) {
+    EXPECT_EQ(absl::OkStatus(), statuses[i]);
+    EXPECT_EQ(responses[i].subgraph().artifacts(0).name(), "a");
+  }
+  EXPECT_EQ(cache->size(), 1);
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -29,14 +29,17 @@ namespace ml_metadata {
 
 namespace {
 
+// The column of the CREATE_TIME ordering of the nodes.
+constexpr absl::string_view kCreateTimeColumn = "create_time_since_epoch";
+
 // Helper method to map Proto ListOperationOptions::OrderByField::Field to
-// Database column name.
+// Database column name. CREATE_TIME maps to `create_time_column`.
 absl::Status GetDbColumnNameForProtoField(
     const ListOperationOptions::OrderByField::Field field,
-    std::string& column_name) {
+    absl::string_view create_time_column, std::string& column_name) {
   switch (field) {
     case ListOperationOptions::OrderByField::CREATE_TIME:
-      column_name = "create_time_since_epoch";
+      column_name = std::string(create_time_column);
       break;
     case ListOperationOptions::OrderByField::LAST_UPDATE_TIME:
       column_name = "last_update_time_since_epoch";
@@ -59,6 +62,21 @@ absl::Status ValidateAndDecodeNextPageToken(
     ListOperationNextPageToken& next_page_token) {
   MLMD_RETURN_IF_ERROR(DecodeListOperationNextPageToken(
       options.next_page_token(), next_page_token));
+  if (options.bulk_export() !=
+      next_page_token.has_bulk_export_order_by_field()) {
+    return absl::InvalidArgumentError(
+        "The next_page_token of bulk export can only be used with the "
+        "bulk_export ListOperationOptions.");
+  }
+  if (options.bulk_export()) {
+    ListOperationOptions previous_options;
+    *previous_options.mutable_order_by_field() =
+        next_page_token.bulk_export_order_by_field();
+    previous_options.set_bulk_export(true);
+    MLMD_RETURN_IF_ERROR(
+        ValidateListOperationOptionsAreIdentical(previous_options, options));
+    return absl::OkStatus();
+  }
   MLMD_RETURN_IF_ERROR(ValidateListOperationOptionsAreIdentical(
       next_page_token.set_options(), options));
 
@@ -80,7 +98,7 @@ absl::Status ConstructOrderingFieldClause(
     std::string& ordering_clause) {
   std::string column_name;
   MLMD_RETURN_IF_ERROR(GetDbColumnNameForProtoField(
-      options.order_by_field().field(), column_name));
+      options.order_by_field().field(), kCreateTimeColumn, column_name));
 
   std::string ordering_operator = options.order_by_field().is_asc() ? ">" : "<";
   if (options.order_by_field().field() !=
@@ -184,15 +202,55 @@ absl::Status AppendOrderingThresholdClause(
   return absl::OkStatus();
 }
 
+absl::Status AppendKeysetThresholdClause(const ListOperationOptions& options,
+                                         absl::string_view create_time_column,
+                                         std::string& sql_query_clause) {
+  const ListOperationOptions::OrderByField::Field field =
+      options.order_by_field().field();
+  if (field != ListOperationOptions::OrderByField::CREATE_TIME &&
+      field != ListOperationOptions::OrderByField::ID) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Unsupported field: ",
+        ListOperationOptions::OrderByField::Field_Name(field),
+        " specified in ListOperationOptions of the keyset pagination"));
+  }
+  const bool is_asc = options.order_by_field().is_asc();
+  const std::string column = GetColumnName(
+      absl::nullopt, field == ListOperationOptions::OrderByField::ID
+                         ? "id"
+                         : create_time_column);
+  if (options.next_page_token().empty()) {
+    absl::SubstituteAndAppend(&sql_query_clause, " $0 $1 $2 ", column,
+                              is_asc ? ">=" : "<=", is_asc ? 0 : LLONG_MAX);
+    return absl::OkStatus();
+  }
+  ListOperationNextPageToken next_page_token;
+  MLMD_RETURN_IF_ERROR(
+      ValidateAndDecodeNextPageToken(options, next_page_token));
+  const char* ordering_operator = is_asc ? ">" : "<";
+  if (field == ListOperationOptions::OrderByField::ID) {
+    absl::SubstituteAndAppend(&sql_query_clause, " $0 $1 $2 ", column,
+                              ordering_operator,
+                              next_page_token.field_offset());
+    return absl::OkStatus();
+  }
+  absl::SubstituteAndAppend(
+      &sql_query_clause, " ($0 $1 $2 OR ($0 = $2 AND `id` $1 $3)) ", column,
+      ordering_operator, next_page_token.field_offset(),
+      next_page_token.id_offset());
+  return absl::OkStatus();
+}
+
 absl::Status AppendOrderByClause(const ListOperationOptions& options,
                                  absl::optional<absl::string_view> table_alias,
-                                 std::string& sql_query_clause) {
+                                 std::string& sql_query_clause,
+                                 absl::string_view create_time_column) {
   const std::string ordering_direction =
       options.order_by_field().is_asc() ? "ASC" : "DESC";
 
   std::string column_name;
   MLMD_RETURN_IF_ERROR(GetDbColumnNameForProtoField(
-      options.order_by_field().field(), column_name));
+      options.order_by_field().field(), create_time_column, column_name));
 
   absl::SubstituteAndAppend(&sql_query_clause, " ORDER BY $0 $1",
                             GetColumnName(table_alias, column_name),
@@ -217,9 +275,8 @@ absl::Status AppendLimitClause(const ListOperationOptions& options,
                      options.max_result_size()));
   }
 
-  const int max_result_size =
-      std::min(options.max_result_size(),
-               GetDefaultMaxListOperationResultSize() + 1);
+  const int max_result_size = std::min(
+      options.max_result_size(), GetMaxListOperationResultSize(options) + 1);
   absl::SubstituteAndAppend(&sql_query_clause, " LIMIT $0 ", max_result_size);
   return absl::OkStatus();
 }
@@ -16,6 +16,7 @@ limitations under the License.
 #define THIRD_PARTY_ML_METADATA_METADATA_STORE_LIST_OPERATION_QUERY_HELPER_H_
 
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "ml_metadata/metadata_store/constants.h"
 #include "ml_metadata/metadata_store/types.h"
@@ -54,6 +55,20 @@ absl::Status AppendOrderingThresholdClause(
     absl::optional<absl::string_view> table_alias,
     std::string& sql_query_clause);
 
+// Generates the WHERE clause of the keyset pagination on
+// (|create_time_column|, `id`) for the CREATE_TIME ordering, or on `id` for the
+// ID ordering. Unlike AppendOrderingThresholdClause, it does not assume that
+// the ordering column grows with the ids, e.g., for the client provided
+// `milliseconds_since_epoch` of the events. For the following pages of the
+// CREATE_TIME ordering in ascending order, it appends
+//   (|create_time_column| > |field_offset| OR
+//    (|create_time_column| = |field_offset| AND `id` > |id_offset|))
+// Returns INVALID_ARGUMENT error if the `options` or `next_page_token`
+// specified is invalid, or the ordering is LAST_UPDATE_TIME.
+absl::Status AppendKeysetThresholdClause(const ListOperationOptions& options,
+                                         absl::string_view create_time_column,
+                                         std::string& sql_query_clause);
+
 // Generates the ORDER BY clause for ListOperation.
 // On success `sql_query_clause` is appended with the constructed ORDER BY
 // clause based on |options| and qualifying column names with |table_alias|.
@@ -68,17 +83,20 @@ absl::Status AppendOrderingThresholdClause(
 //    }
 // }
 // Appends "ORDER BY `create_time_since_epoch` DESC, `id` DESC" at the end of
-// `sql_query_clause`.
-absl::Status AppendOrderByClause(const ListOperationOptions& options,
-                                 absl::optional<absl::string_view> table_alias,
-                                 std::string& sql_query_clause);
+// `sql_query_clause`. The CREATE_TIME ordering uses |create_time_column|.
+absl::Status AppendOrderByClause(
+    const ListOperationOptions& options,
+    absl::optional<absl::string_view> table_alias,
+    std::string& sql_query_clause,
+    absl::string_view create_time_column = "create_time_since_epoch");
 
 // Generates the LIMIT clause for ListOperation.
 // On success `sql_query_clause` is appended with the constructed LIMIT clause
 // based on |options|.
 // If |options| does not specify max_result_size a default value of 20 is used
-// and if the max_result_size is greater than 100, the LIMIT clause coerces the
-// value to 100.
+// and if the max_result_size is greater than 100 (100000 in the bulk export
+// mode), the LIMIT clause coerces the value to 101 (100001), which leaves room
+// for the extra node used to detect the last page.
 // For example, given a ListOperationOptions message:
 // {
 //    max_result_size: 1,
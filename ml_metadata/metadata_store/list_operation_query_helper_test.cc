@@ -145,6 +145,38 @@ TEST(ListOperationQueryHelperTest, OrderingWhereClauseById) {
                                 " table_0.`id` < 100 ");
 }
 
+TEST(ListOperationQueryHelperTest, OrderingWhereClauseBulkExport) {
+  ListOperationOptions options =
+      testing::ParseTextProtoOrDie<ListOperationOptions>(R"pb(
+        max_result_size: 10000,
+        order_by_field: { field: CREATE_TIME, is_asc: true }
+        bulk_export: true
+      )pb");
+
+  ListOperationNextPageToken next_page_token =
+      BasicListOperationNextPageToken();
+  *next_page_token.mutable_bulk_export_order_by_field() =
+      options.order_by_field();
+  options.set_next_page_token(
+      absl::WebSafeBase64Escape(next_page_token.SerializeAsString()));
+
+  VerifyAppendOrderingThreshold(
+      options, /*table_alias=*/absl::nullopt, /*expected_clause=*/
+      " `create_time_since_epoch` >= 56894 AND `id` > 100 ");
+
+  // The ordering must not change between the pages.
+  options.mutable_order_by_field()->set_is_asc(false);
+  std::string where_clause;
+  EXPECT_TRUE(absl::IsInvalidArgument(AppendOrderingThresholdClause(
+      options, /*table_alias=*/absl::nullopt, where_clause)));
+
+  // The bulk export tokens can only be used in the bulk export mode.
+  options.mutable_order_by_field()->set_is_asc(true);
+  options.set_bulk_export(false);
+  EXPECT_TRUE(absl::IsInvalidArgument(AppendOrderingThresholdClause(
+      options, /*table_alias=*/absl::nullopt, where_clause)));
+}
+
 TEST(ListOperationQueryHelperTest, OrderByClauseDesc) {
   const ListOperationOptions options = BasicListOperationOptionsDesc();
 
@@ -200,6 +232,19 @@ TEST(ListOperationQueryHelperTest, LimitOverMaxClause) {
   EXPECT_EQ(limit_clause, " LIMIT 101 ");
 }
 
+TEST(ListOperationQueryHelperTest, LimitOverMaxClauseBulkExport) {
+  ListOperationOptions options = BasicListOperationOptionsDesc();
+  options.set_bulk_export(true);
+  options.set_max_result_size(10000);
+  std::string limit_clause;
+  ASSERT_EQ(absl::OkStatus(), AppendLimitClause(options, limit_clause));
+  EXPECT_EQ(limit_clause, " LIMIT 10000 ");
+  limit_clause.clear();
+  options.set_max_result_size(200000);
+  ASSERT_EQ(absl::OkStatus(), AppendLimitClause(options, limit_clause));
+  EXPECT_EQ(limit_clause, " LIMIT 100001 ");
+}
+
 TEST(ListOperationQueryHelperTest, InvalidLimit) {
   ListOperationOptions options = BasicListOperationOptionsDesc();
   options.set_max_result_size(0);
@@ -14,8 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/list_operation_util.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/constants.h"
 
 namespace ml_metadata {
 
@@ -28,6 +33,30 @@ void SetListOperationInitialValues(const ListOperationOptions& options,
   id_offset = field_offset;
 }
 
+int GetMaxListOperationResultSize(const ListOperationOptions& options) {
+  return options.bulk_export() ? kMaxBulkExportListOperationResultSize
+                               : kDefaultMaxListOperationResultSize;
+}
+
+absl::Status ValidateBulkExportListOperationOptions(
+    const ListOperationOptions& options) {
+  if (!options.bulk_export()) {
+    return absl::OkStatus();
+  }
+  if (options.max_result_size() > kMaxBulkExportListOperationResultSize) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "max_result_size field value is required to be less than or equal to ",
+        kMaxBulkExportListOperationResultSize,
+        " in the bulk export mode. Set value: ", options.max_result_size()));
+  }
+  if (options.order_by_field().field() ==
+      ListOperationOptions::OrderByField::LAST_UPDATE_TIME) {
+    return absl::InvalidArgumentError(
+        "LAST_UPDATE_TIME ordering is not supported in the bulk export mode");
+  }
+  return absl::OkStatus();
+}
+
 absl::Status DecodeListOperationNextPageToken(
     const absl::string_view next_page_token,
     ListOperationNextPageToken& list_operation_next_page_token) {
@@ -46,6 +75,29 @@ absl::Status DecodeListOperationNextPageToken(
   return absl::OkStatus();
 }
 
+absl::Status EncodeListOperationNextPageToken(
+    const ListOperationOptions& options,
+    ListOperationNextPageToken& list_operation_next_page_token,
+    std::string* next_page_token) {
+  if (options.bulk_export()) {
+    // The bulk export tokens only keep the ordering to validate the follow-up
+    // requests, as the offsets of the last node identify the next page.
+    *list_operation_next_page_token.mutable_bulk_export_order_by_field() =
+        options.order_by_field();
+    *next_page_token = absl::WebSafeBase64Escape(
+        list_operation_next_page_token.SerializeAsString());
+    return absl::OkStatus();
+  }
+  *list_operation_next_page_token.mutable_set_options() = options;
+  // Clear previous `next_page_token` as it is changing for each request and it
+  // is a set-only field. If not clean this field, the `next_page_token` in
+  // the follow-up request encodes itself and the size grows exponentially.
+  list_operation_next_page_token.mutable_set_options()->clear_next_page_token();
+  *next_page_token = absl::WebSafeBase64Escape(
+      list_operation_next_page_token.SerializeAsString());
+  return absl::OkStatus();
+}
+
 absl::Status ValidateListOperationOptionsAreIdentical(
     const ListOperationOptions& previous_options,
     const ListOperationOptions& current_options) {
@@ -61,4 +113,39 @@ absl::Status ValidateListOperationOptionsAreIdentical(
       previous_options.DebugString(),
       " Current Options: ", current_options.DebugString()));
 }
+
+absl::Status ValidateCountOptions(const CountOptions& options,
+                                  const bool counts_contexts) {
+  std::vector<int> group_by(options.group_by().begin(),
+                            options.group_by().end());
+  std::sort(group_by.begin(), group_by.end());
+  if (std::adjacent_find(group_by.begin(), group_by.end()) != group_by.end()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "CountOptions groups by a dimension twice: ", options.DebugString()));
+  }
+  for (const int dimension : group_by) {
+    switch (dimension) {
+      case CountOptions::TYPE:
+        break;
+      case CountOptions::STATE:
+      case CountOptions::CONTEXT:
+        if (counts_contexts) {
+          return absl::InvalidArgumentError(
+              absl::StrCat("The contexts cannot be counted by ",
+                           CountOptions::GroupBy_Name(dimension)));
+        }
+        break;
+      case CountOptions::CREATE_TIME_BUCKET:
+        if (options.time_bucket_ms() <= 0) {
+          return absl::InvalidArgumentError(
+              "CREATE_TIME_BUCKET requires a positive time_bucket_ms.");
+        }
+        break;
+      default:
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Unsupported CountOptions group_by: ", options.DebugString()));
+    }
+  }
+  return absl::OkStatus();
+}
 }  // namespace ml_metadata
@@ -28,11 +28,29 @@ namespace ml_metadata {
 void SetListOperationInitialValues(const ListOperationOptions& options,
                                    int64& field_offset, int64& id_offset);
 
+// Returns the upper-bound of `max_result_size` for List operation with
+// `options`, which is larger in the bulk export mode.
+int GetMaxListOperationResultSize(const ListOperationOptions& options);
+
+// Returns InvalidArgument error if `options` of the bulk export mode has a
+// `max_result_size` over the upper-bound, or an ordering not supported by the
+// bulk export mode, which pages by the (field, id) offsets only.
+absl::Status ValidateBulkExportListOperationOptions(
+    const ListOperationOptions& options);
+
 // Decodes ListOperationNextPageToken encoded in `next_page_token`.
 absl::Status DecodeListOperationNextPageToken(
     const absl::string_view next_page_token,
     ListOperationNextPageToken& list_operation_next_page_token);
 
+// Encodes `list_operation_next_page_token`, which has the offsets of the last
+// result of a page, with `options` of the List operation to
+// `next_page_token`.
+absl::Status EncodeListOperationNextPageToken(
+    const ListOperationOptions& options,
+    ListOperationNextPageToken& list_operation_next_page_token,
+    std::string* next_page_token);
+
 // Generates encoded list operation next page token string.
 template <typename Node>
 absl::Status BuildListOperationNextPageToken(
@@ -72,14 +90,8 @@ absl::Status BuildListOperationNextPageToken(
                            options.order_by_field().field()),
                        " specified in ListOperationOptions"));
   }
-  *list_operation_next_page_token.mutable_set_options() = options;
-  // Clear previous `next_page_token` as it is changing for each request and it
-  // is a set-only field. If not clean this field, the `next_page_token` in
-  // the follow-up request encodes itself and the size grows exponentially.
-  list_operation_next_page_token.mutable_set_options()->clear_next_page_token();
-  *next_page_token = absl::WebSafeBase64Escape(
-      list_operation_next_page_token.SerializeAsString());
-  return absl::OkStatus();
+  return EncodeListOperationNextPageToken(
+      options, list_operation_next_page_token, next_page_token);
 }
 
 // Ensures that ListOperationOptions have not changed between
@@ -90,6 +102,13 @@ absl::Status BuildListOperationNextPageToken(
 absl::Status ValidateListOperationOptionsAreIdentical(
     const ListOperationOptions& previous_options,
     const ListOperationOptions& current_options);
+
+// Returns InvalidArgument error if `options` of a Count* call groups by a
+// dimension twice, or by the create time without a positive `time_bucket_ms`.
+// With `counts_contexts`, it also returns InvalidArgument error for grouping
+// by the state or the context, which the contexts do not have.
+absl::Status ValidateCountOptions(const CountOptions& options,
+                                  bool counts_contexts);
 }  // namespace ml_metadata
 
 #endif  // THIRD_PARTY_ML_METADATA_METADATA_STORE_LIST_OPERATION_UTIL_H_
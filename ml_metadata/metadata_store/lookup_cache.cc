@@ -0,0 +1,127 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/lookup_cache.h"
+
+#include <iterator>
+#include <utility>
+
+#include <glog/logging.h>
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace ml_metadata {
+
+void LookupCache::Invalidation::AddContexts(
+    const google::protobuf::RepeatedPtrField<Context>& contexts) {
+  for (const Context& context : contexts) {
+    if (context.has_name()) {
+      context_names.insert(context.name());
+    }
+    if (context.has_id()) {
+      context_ids.insert(context.id());
+    }
+  }
+}
+
+void LookupCache::Invalidation::Merge(const Invalidation& other) {
+  all = all || other.all;
+  context_names.insert(other.context_names.begin(), other.context_names.end());
+  context_ids.insert(other.context_ids.begin(), other.context_ids.end());
+}
+
+LookupCache::LookupCache(const Config& config,
+                         std::function<absl::Time()> clock)
+    : config_(config), clock_(std::move(clock)) {
+  CHECK_GT(config_.max_entries(), 0)
+      << "The max_entries of the lookup cache must be positive.";
+}
+
+bool LookupCache::Find(const std::string& key, Result* result) {
+  const absl::Time now = clock_();
+  absl::MutexLock lock(&mu_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return false;
+  }
+  if (it->second->expire_time <= now) {
+    Erase(it->second);
+    return false;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  *result = it->second->result;
+  return true;
+}
+
+int64 LookupCache::generation() const {
+  absl::MutexLock lock(&mu_);
+  return generation_;
+}
+
+void LookupCache::Insert(const std::string& key, const int64 generation,
+                         Result result) {
+  const absl::Duration ttl = absl::Seconds(
+      result.negative ? config_.negative_ttl_sec() : config_.ttl_sec());
+  if (ttl <= absl::ZeroDuration()) {
+    return;
+  }
+  const absl::Time expire_time = clock_() + ttl;
+  absl::MutexLock lock(&mu_);
+  if (generation != generation_) {
+    return;
+  }
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    Erase(it->second);
+  }
+  entries_.push_front({key, std::move(result), expire_time});
+  index_[entries_.front().key] = entries_.begin();
+  if (entries_.size() > config_.max_entries()) {
+    Erase(std::prev(entries_.end()));
+  }
+}
+
+void LookupCache::Invalidate(const Invalidation& invalidation) {
+  if (invalidation.empty()) {
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  generation_++;
+  if (invalidation.all) {
+    entries_.clear();
+    index_.clear();
+    return;
+  }
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    const Result& result = (it++)->result;
+    if ((result.context_name &&
+         invalidation.context_names.contains(*result.context_name)) ||
+        (result.context_id &&
+         invalidation.context_ids.contains(*result.context_id))) {
+      Erase(std::prev(it));
+    }
+  }
+}
+
+int LookupCache::size() const {
+  absl::MutexLock lock(&mu_);
+  return entries_.size();
+}
+
+void LookupCache::Erase(std::list<Entry>::iterator it) {
+  index_.erase(it->key);
+  entries_.erase(it);
+}
+
+}  // namespace ml_metadata
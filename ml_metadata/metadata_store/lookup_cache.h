@@ -0,0 +1,148 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_LOOKUP_CACHE_H_
+#define ML_METADATA_METADATA_STORE_LOOKUP_CACHE_H_
+
+#include <functional>
+#include <list>
+#include <string>
+
+#include "google/protobuf/repeated_field.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// A bounded LRU cache of the results of name-keyed lookups, e.g.,
+// GetArtifactType and GetContextByTypeAndName, shared by the MetadataStores of
+// a pool. The lookups that find nothing are cached as well, with a shorter
+// TTL. The cache does not see the writes of other clients of the database, so
+// the entries expire after a TTL; the writes of the stores sharing the cache
+// invalidate the lookups they make stale. It is thread-safe.
+//
+// A lookup missing the cache captures the generation() before it reads, and
+// its result is only inserted if nothing has been invalidated since, so that a
+// read racing with a write never caches the result overwritten by the write.
+//
+// Usage example:
+//
+//    LookupCache::Result result;
+//    if (!cache->Find(key, &result)) {
+//      const int64 generation = cache->generation();
+//      result.status = Read(&result.response);
+//      cache->Insert(key, generation, result);
+//    }
+class LookupCache {
+ public:
+  using Config =
+      MetadataStoreServerConfig::ConnectionPoolConfig::LookupCacheConfig;
+
+  // The result of a lookup.
+  struct Result {
+    // The status of the lookup, either OK or NOT_FOUND.
+    absl::Status status;
+    // The serialized response of an OK lookup.
+    std::string response;
+    // Whether the lookup found nothing, which expires after negative_ttl_sec.
+    bool negative = false;
+    // The name of the context looked up, and the id of the context found, if
+    // any. The result is invalidated by the writes of a context with the same
+    // name or id.
+    absl::optional<std::string> context_name;
+    absl::optional<int64> context_id;
+  };
+
+  // The lookups made stale by a write.
+  struct Invalidation {
+    // Whether the write puts types, which invalidates all lookups.
+    bool all = false;
+    // The names and ids of the contexts put by the write.
+    absl::flat_hash_set<std::string> context_names;
+    absl::flat_hash_set<int64> context_ids;
+
+    // Adds the names and ids of `contexts` to the invalidation.
+    void AddContexts(
+        const google::protobuf::RepeatedPtrField<Context>& contexts);
+
+    // Adds the lookups of `other` to the invalidation.
+    void Merge(const Invalidation& other);
+
+    // Returns true if the invalidation invalidates nothing.
+    bool empty() const {
+      return !all && context_names.empty() && context_ids.empty();
+    }
+  };
+
+  // Creates a cache of `config`, whose entries expire by the time of `clock`.
+  // Check-fails if the max_entries of the config is not positive.
+  explicit LookupCache(const Config& config,
+                       std::function<absl::Time()> clock = absl::Now);
+
+  // Not copyable or movable
+  LookupCache(const LookupCache&) = delete;
+  LookupCache& operator=(const LookupCache&) = delete;
+
+  // Copies the unexpired result of `key` to `result`, and marks it as the most
+  // recently used one. Returns false if there is no such result.
+  bool Find(const std::string& key, Result* result);
+
+  // Returns the generation of the cache, which is advanced by every
+  // Invalidate() that may invalidate a cached lookup.
+  int64 generation() const;
+
+  // Inserts the `result` of `key` read at `generation`, and evicts the least
+  // recently used entry if the cache is full. The result is dropped if the
+  // cache has been invalidated since `generation`.
+  void Insert(const std::string& key, int64 generation, Result result);
+
+  // Removes the lookups made stale by `invalidation`.
+  void Invalidate(const Invalidation& invalidation);
+
+  // Returns the number of cached lookups.
+  int size() const;
+
+ private:
+  // A cached lookup and the time it expires.
+  struct Entry {
+    std::string key;
+    Result result;
+    absl::Time expire_time;
+  };
+
+  // Removes the entry at `it`.
+  void Erase(std::list<Entry>::iterator it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const Config config_;
+  const std::function<absl::Time()> clock_;
+
+  mutable absl::Mutex mu_;
+  int64 generation_ ABSL_GUARDED_BY(mu_) = 0;
+  // The entries ordered by their last use, the most recent first.
+  std::list<Entry> entries_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, std::list<Entry>::iterator> index_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_LOOKUP_CACHE_H_
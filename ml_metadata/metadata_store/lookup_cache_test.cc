@@ -0,0 +1,153 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/lookup_cache.h"
+
+#include <memory>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+
+class LookupCacheTest : public ::testing::Test {
+ protected:
+  // Creates a cache of `config_text`, whose clock is `now_`.
+  std::unique_ptr<LookupCache> CreateCache(const std::string& config_text) {
+    return absl::make_unique<LookupCache>(
+        ParseTextProtoOrDie<LookupCache::Config>(config_text),
+        [this]() { return now_; });
+  }
+
+  // Returns a result of a lookup finding `response`.
+  static LookupCache::Result Found(const std::string& response) {
+    LookupCache::Result result;
+    result.response = response;
+    return result;
+  }
+
+  // Returns a result of a lookup finding nothing.
+  static LookupCache::Result NotFound() {
+    LookupCache::Result result;
+    result.status = absl::NotFoundError("not found");
+    result.negative = true;
+    return result;
+  }
+
+  absl::Time now_ = absl::UnixEpoch();
+};
+
+TEST_F(LookupCacheTest, FindsInsertedResults) {
+  std::unique_ptr<LookupCache> cache = CreateCache("");
+  LookupCache::Result result;
+  EXPECT_FALSE(cache->Find("a", &result));
+  cache->Insert("a", cache->generation(), Found("response_a"));
+  cache->Insert("b", cache->generation(), NotFound());
+
+  ASSERT_TRUE(cache->Find("a", &result));
+  EXPECT_EQ(result.status, absl::OkStatus());
+  EXPECT_EQ(result.response, "response_a");
+  ASSERT_TRUE(cache->Find("b", &result));
+  EXPECT_TRUE(absl::IsNotFound(result.status));
+  EXPECT_EQ(cache->size(), 2);
+}
+
+TEST_F(LookupCacheTest, ExpiresResultsAfterTheirTtl) {
+  std::unique_ptr<LookupCache> cache =
+      CreateCache("ttl_sec: 60 negative_ttl_sec: 5");
+  cache->Insert("a", cache->generation(), Found("response_a"));
+  cache->Insert("b", cache->generation(), NotFound());
+  LookupCache::Result result;
+
+  now_ += absl::Seconds(5);
+  EXPECT_TRUE(cache->Find("a", &result));
+  EXPECT_FALSE(cache->Find("b", &result));
+  now_ += absl::Seconds(55);
+  EXPECT_FALSE(cache->Find("a", &result));
+  EXPECT_EQ(cache->size(), 0);
+}
+
+TEST_F(LookupCacheTest, EvictsLeastRecentlyUsedResults) {
+  std::unique_ptr<LookupCache> cache = CreateCache("max_entries: 2");
+  cache->Insert("a", cache->generation(), Found("response_a"));
+  cache->Insert("b", cache->generation(), Found("response_b"));
+  LookupCache::Result result;
+  ASSERT_TRUE(cache->Find("a", &result));
+  cache->Insert("c", cache->generation(), Found("response_c"));
+
+  EXPECT_EQ(cache->size(), 2);
+  EXPECT_TRUE(cache->Find("a", &result));
+  EXPECT_FALSE(cache->Find("b", &result));
+  EXPECT_TRUE(cache->Find("c", &result));
+}
+
+TEST_F(LookupCacheTest, InvalidatesContextsByNameAndId) {
+  std::unique_ptr<LookupCache> cache = CreateCache("");
+  LookupCache::Result context_a = Found("context_a");
+  context_a.context_name = "a";
+  context_a.context_id = 1;
+  LookupCache::Result context_b = NotFound();
+  context_b.context_name = "b";
+  cache->Insert("type", cache->generation(), Found("type"));
+  cache->Insert("a", cache->generation(), context_a);
+  cache->Insert("b", cache->generation(), context_b);
+
+  // Renaming the context 1 invalidates the lookup of its former name.
+  LookupCache::Invalidation invalidation;
+  invalidation.AddContexts(
+      ParseTextProtoOrDie<LineageGraph>("contexts { id: 1 name: 'c' }")
+          .contexts());
+  cache->Invalidate(invalidation);
+  LookupCache::Result result;
+  EXPECT_TRUE(cache->Find("type", &result));
+  EXPECT_FALSE(cache->Find("a", &result));
+  EXPECT_TRUE(cache->Find("b", &result));
+
+  // Creating the context `b` invalidates the lookup finding nothing.
+  invalidation = LookupCache::Invalidation();
+  invalidation.context_names.insert("b");
+  cache->Invalidate(invalidation);
+  EXPECT_FALSE(cache->Find("b", &result));
+
+  invalidation = LookupCache::Invalidation();
+  invalidation.all = true;
+  cache->Invalidate(invalidation);
+  EXPECT_EQ(cache->size(), 0);
+}
+
+TEST_F(LookupCacheTest, DropsResultsReadBeforeAnInvalidation) {
+  std::unique_ptr<LookupCache> cache = CreateCache("");
+  const int64 generation = cache->generation();
+  LookupCache::Invalidation invalidation;
+  invalidation.context_names.insert("a");
+  cache->Invalidate(invalidation);
+
+  cache->Insert("type", generation, Found("type"));
+  LookupCache::Result result;
+  EXPECT_FALSE(cache->Find("type", &result));
+  cache->Insert("type", cache->generation(), Found("type"));
+  EXPECT_TRUE(cache->Find("type", &result));
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -23,6 +23,8 @@ limitations under the License.
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/lineage_graph_index.h"
+#include "ml_metadata/metadata_store/property_string_dictionary.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
@@ -78,6 +80,16 @@ class MetadataAccessObject {
   virtual absl::Status InitMetadataSourceIfNotExists(
       bool enable_upgrade_migration = false) = 0;
 
+  // Runs a step of an online upgrade of the schema to the library version in
+  // the current transaction, which rewrites at most `batch_size` rows, and
+  // checkpoints its progress in the metadata source. The steps are run in
+  // their own transactions until `done` is set to true, and the metadata
+  // source is then initialized by InitMetadataSourceIfNotExists.
+  // Returns INVALID_ARGUMENT error, if `batch_size` is not positive.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status UpgradeMetadataSourceOnlineStep(int64 batch_size,
+                                                       bool* done) = 0;
+
 
   // Deletes the metadata source.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -155,6 +167,56 @@ class MetadataAccessObject {
       std::vector<ExecutionType>* execution_types) = 0;
   virtual absl::Status FindTypes(std::vector<ContextType>* context_types) = 0;
 
+  // Creates a batch of types with as few queries as possible, and returns the
+  // assigned ids in `type_ids` in the same order. A type is one of
+  // {ArtifactType, ExecutionType, ContextType}. The id and the base_type of the
+  // given types are ignored.
+  // Returns INVALID_ARGUMENT error, if any name field is not given.
+  // Returns INVALID_ARGUMENT error, if any property type is unknown.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status CreateTypes(absl::Span<const ArtifactType> types,
+                                   std::vector<int64>* type_ids) = 0;
+  virtual absl::Status CreateTypes(absl::Span<const ExecutionType> types,
+                                   std::vector<int64>* type_ids) = 0;
+  virtual absl::Status CreateTypes(absl::Span<const ContextType> types,
+                                   std::vector<int64>* type_ids) = 0;
+
+  // Adds the properties of a batch of types to the stored types with as few
+  // queries as possible. Each given type has the id of a stored type, and only
+  // the properties to add, none of which is stored yet, e.g., as checked
+  // against the types returned by FindTypesByNames.
+  // Returns INVALID_ARGUMENT error, if any type has no id.
+  // Returns INVALID_ARGUMENT error, if any property type is unknown.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status AddTypeProperties(
+      absl::Span<const ArtifactType> types) = 0;
+  virtual absl::Status AddTypeProperties(
+      absl::Span<const ExecutionType> types) = 0;
+  virtual absl::Status AddTypeProperties(
+      absl::Span<const ContextType> types) = 0;
+
+  // Returns the types of all versions whose names are in `names`, with their
+  // properties, using one query per table. The base types are not populated.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindTypesByNames(absl::Span<const std::string> names,
+                                        std::vector<ArtifactType>* types) = 0;
+  virtual absl::Status FindTypesByNames(absl::Span<const std::string> names,
+                                        std::vector<ExecutionType>* types) = 0;
+  virtual absl::Status FindTypesByNames(absl::Span<const std::string> names,
+                                        std::vector<ContextType>* types) = 0;
+
+  // Returns the types whose ids are in `type_ids`, with their properties, in
+  // no particular order. The ids may repeat, and the unknown ids are skipped.
+  // The cached types are served without a query, and the others are read with
+  // one query per table. The base types are not populated.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindTypesByIds(absl::Span<const int64> type_ids,
+                                      std::vector<ArtifactType>* types) = 0;
+  virtual absl::Status FindTypesByIds(absl::Span<const int64> type_ids,
+                                      std::vector<ExecutionType>* types) = 0;
+  virtual absl::Status FindTypesByIds(absl::Span<const int64> type_ids,
+                                      std::vector<ContextType>* types) = 0;
+
   // Creates a parent type, returns OK if successful.
   // Returns INVALID_ARGUMENT error, if type or parent_type does not have id.
   // Returns INVALID_ARGUMENT error, if type and parent_type introduces cycle.
@@ -200,12 +262,38 @@ class MetadataAccessObject {
   virtual absl::Status CreateArtifact(const Artifact& artifact,
                                       int64* artifact_id) = 0;
 
+  // Creates a batch of artifacts with as few queries as possible, and returns
+  // the assigned ids in `artifact_ids` in the same order. The id field of each
+  // artifact is ignored.
+  // Returns the same errors as CreateArtifact, if any artifact is invalid.
+  virtual absl::Status CreateArtifacts(absl::Span<const Artifact> artifacts,
+                                       std::vector<int64>* artifact_ids) = 0;
+
+  // Creates an artifact, unless its ArtifactType already has an artifact with
+  // the same name, in which case the stored artifact is kept unchanged. Returns
+  // the id of the created or the stored artifact, and whether it is created.
+  // Concurrent transactions creating the same artifact do not fail.
+  // Returns INVALID_ARGUMENT error, if the artifact name is empty.
+  // Returns the same errors as CreateArtifact otherwise, except ALREADY_EXISTS.
+  virtual absl::Status CreateArtifactIfNotExist(const Artifact& artifact,
+                                                int64* artifact_id,
+                                                bool* is_created) = 0;
+
   // Retrieves artifacts matching the given 'artifact_ids'.
   // Returns NOT_FOUND error, if any of the given artifact_ids are not found.
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status FindArtifactsById(absl::Span<const int64> artifact_ids,
                                          std::vector<Artifact>* artifact) = 0;
 
+  // Retrieves the last_update_time_since_epoch of the artifacts with
+  // `artifact_ids` in a single query, keyed by the artifact ids, and locks the
+  // artifacts for the updates of the transaction if the database supports it.
+  // The artifacts that are not found are missing from `last_update_times`.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindArtifactLastUpdateTimes(
+      absl::Span<const int64> artifact_ids,
+      absl::flat_hash_map<int64, int64>* last_update_times) = 0;
+
   // Queries artifacts stored in the metadata source
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status FindArtifacts(std::vector<Artifact>* artifacts) = 0;
@@ -264,6 +352,23 @@ class MetadataAccessObject {
                                     std::vector<Context>* contexts,
                                     std::string* next_page_token) = 0;
 
+  // Counts the artifacts selected by the filter query of `options`, grouped
+  // by the dimensions of `options`, without reading them. On success `counts`
+  // has the counts of the non-empty groups, ordered by the dimensions.
+  // Returns INVALID_ARGUMENT error, if `options` is invalid.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status CountArtifacts(const CountOptions& options,
+                                      std::vector<NodeCount>* counts) = 0;
+
+  // Counts the executions selected by `options`, as CountArtifacts.
+  virtual absl::Status CountExecutions(const CountOptions& options,
+                                       std::vector<NodeCount>* counts) = 0;
+
+  // Counts the contexts selected by `options`, as CountArtifacts. The
+  // contexts can be grouped by type and create time only.
+  virtual absl::Status CountContexts(const CountOptions& options,
+                                     std::vector<NodeCount>* counts) = 0;
+
   // Queries an artifact by its type_id and name.
   // Returns NOT_FOUND error, if no artifact can be found.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -307,6 +412,13 @@ class MetadataAccessObject {
   virtual absl::Status CreateExecution(const Execution& execution,
                                        int64* execution_id) = 0;
 
+  // Creates a batch of executions with as few queries as possible, and returns
+  // the assigned ids in `execution_ids` in the same order. The id field of
+  // each execution is ignored.
+  // Returns the same errors as CreateExecution, if any execution is invalid.
+  virtual absl::Status CreateExecutions(absl::Span<const Execution> executions,
+                                        std::vector<int64>* execution_ids) = 0;
+
   // Retrieves executions matching the given 'ids'.
   // Returns NOT_FOUND error, if any of the given ids are not found.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -333,6 +445,14 @@ class MetadataAccessObject {
       absl::optional<ListOperationOptions> list_options,
       std::vector<Execution>* executions, std::string* next_page_token) = 0;
 
+  // Queries the active executions, i.e., the NEW and RUNNING ones, of a given
+  // type_id. Unlike FindExecutionsByTypeId, the terminal executions are not
+  // read, so that the cost is in the number of the active executions.
+  // Returns NOT_FOUND error, if no active execution can be found.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindActiveExecutionsByTypeId(
+      int64 execution_type_id, std::vector<Execution>* executions) = 0;
+
   // Updates an execution.
   // Returns INVALID_ARGUMENT error, if the id field is not given.
   // Returns INVALID_ARGUMENT error, if no execution is found with the given id.
@@ -358,6 +478,22 @@ class MetadataAccessObject {
   virtual absl::Status CreateContext(const Context& context,
                                      int64* context_id) = 0;
 
+  // Creates a batch of contexts with as few queries as possible, and returns
+  // the assigned ids in `context_ids` in the same order. The id field of each
+  // context is ignored.
+  // Returns the same errors as CreateContext, if any context is invalid.
+  virtual absl::Status CreateContexts(absl::Span<const Context> contexts,
+                                      std::vector<int64>* context_ids) = 0;
+
+  // Creates a context, unless its ContextType already has a context with the
+  // same name, in which case the stored context is kept unchanged. Returns the
+  // id of the created or the stored context, and whether it is created.
+  // Concurrent transactions creating the same context do not fail.
+  // Returns the same errors as CreateContext otherwise, except ALREADY_EXISTS.
+  virtual absl::Status CreateContextIfNotExist(const Context& context,
+                                               int64* context_id,
+                                               bool* is_created) = 0;
+
   // Retrieves contexts matching a collection of ids.
   // Returns NOT_FOUND if any of the given ids are not found.
   // Returns detailed INTERNAL error if query execution fails.
@@ -401,6 +537,14 @@ class MetadataAccessObject {
   // Returns ALREADY_EXIST error, if duplicated event is found.
   virtual absl::Status CreateEvent(const Event& event, int64* event_id) = 0;
 
+  // Creates a batch of events and their paths with as few queries as possible,
+  // and returns the assigned ids in `event_ids` in the same order. The id field
+  // of each event is ignored.
+  // Returns the same errors as CreateEvent, if any event is invalid or already
+  // exists.
+  virtual absl::Status CreateEvents(absl::Span<const Event> events,
+                                    std::vector<int64>* event_ids) = 0;
+
   // Queries the events associated with a collection of artifact_ids.
   // Returns NOT_FOUND error, if no `events` can be found.
   // Returns INVALID_ARGUMENT error, if the `events` is null.
@@ -413,6 +557,39 @@ class MetadataAccessObject {
   virtual absl::Status FindEventsByExecutions(
       const std::vector<int64>& execution_ids, std::vector<Event>* events) = 0;
 
+  // Lists a page of the events associated with a collection of artifact_ids,
+  // using `options`. The events are ordered by their ids, or by their
+  // milliseconds_since_epoch for the CREATE_TIME ordering. If `event_types` is
+  // not empty, only the events of the given types are listed.
+  // On success `next_page_token` is set to the token of the next page, or to
+  // empty if it is the last page.
+  // Returns INVALID_ARGUMENT error, if the `options` is invalid, e.g., it has
+  // a filter_query or the LAST_UPDATE_TIME ordering.
+  virtual absl::Status ListEventsByArtifacts(
+      absl::Span<const int64> artifact_ids,
+      absl::Span<const Event::Type> event_types,
+      const ListOperationOptions& options, std::vector<Event>* events,
+      std::string* next_page_token) = 0;
+
+  // Lists a page of the events associated with a collection of execution_ids,
+  // like ListEventsByArtifacts.
+  virtual absl::Status ListEventsByExecutions(
+      absl::Span<const int64> execution_ids,
+      absl::Span<const Event::Type> event_types,
+      const ListOperationOptions& options, std::vector<Event>* events,
+      std::string* next_page_token) = 0;
+
+  // Lists a page of the events whose milliseconds_since_epoch is at least
+  // `min_milliseconds_since_epoch`, and less than
+  // `max_milliseconds_since_epoch` if given, like ListEventsByArtifacts. The
+  // events archived with their executions are not listed.
+  virtual absl::Status ListEventsByTimeRange(
+      int64 min_milliseconds_since_epoch,
+      absl::optional<int64> max_milliseconds_since_epoch,
+      absl::Span<const Event::Type> event_types,
+      const ListOperationOptions& options, std::vector<Event>* events,
+      std::string* next_page_token) = 0;
+
   // Creates an association, returns the assigned association id.
   // Returns INVALID_ARGUMENT error, if no context matches the context_id.
   // Returns INVALID_ARGUMENT error, if no execution matches the execution_id.
@@ -420,12 +597,43 @@ class MetadataAccessObject {
   virtual absl::Status CreateAssociation(const Association& association,
                                          int64* association_id) = 0;
 
+  // Creates a batch of associations with as few queries as possible. The
+  // associations that already exist are skipped.
+  // Returns INVALID_ARGUMENT error, if no context matches a context_id.
+  // Returns INVALID_ARGUMENT error, if no execution matches an execution_id.
+  virtual absl::Status CreateAssociationsIfNotExist(
+      absl::Span<const Association> associations) = 0;
+
 
   // Queries the contexts that an execution_id is associated with.
   // Returns INVALID_ARGUMENT error, if the `contexts` is null.
   virtual absl::Status FindContextsByExecution(
       int64 execution_id, std::vector<Context>* contexts) = 0;
 
+  // Queries the contexts that a collection of `execution_ids` are associated
+  // with. The `associations` are set to the pairs of execution and context
+  // ids, ordered by execution id and then by context id, and the `contexts`
+  // to the associated contexts ordered by id, each of them once.
+  // Returns OK with no associations, if no execution is associated with a
+  // context.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindContextsByExecutions(
+      absl::Span<const int64> execution_ids,
+      std::vector<Association>* associations,
+      std::vector<Context>* contexts) = 0;
+
+  // Queries the executions associated with a collection of `context_ids`. The
+  // `associations` are set to the pairs of context and execution ids, ordered
+  // by context id and then by execution id in descending order, i.e., the
+  // latest executions first. If `max_num_per_context` is positive, at most
+  // that many executions of each context are kept. The `executions` are set to
+  // the executions of the kept associations ordered by id, each of them once.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindExecutionsByContexts(
+      absl::Span<const int64> context_ids, int64 max_num_per_context,
+      std::vector<Association>* associations,
+      std::vector<Execution>* executions) = 0;
+
   // Queries the executions associated with a context_id.
   // Returns INVALID_ARGUMENT error, if the `executions` is null.
   virtual absl::Status FindExecutionsByContext(
@@ -444,6 +652,13 @@ class MetadataAccessObject {
   virtual absl::Status CreateAttribution(const Attribution& attribution,
                                          int64* attribution_id) = 0;
 
+  // Creates a batch of attributions with as few queries as possible. The
+  // attributions that already exist are skipped.
+  // Returns INVALID_ARGUMENT error, if no context matches a context_id.
+  // Returns INVALID_ARGUMENT error, if no artifact matches an artifact_id.
+  virtual absl::Status CreateAttributionsIfNotExist(
+      absl::Span<const Attribution> attributions) = 0;
+
   // Queries the contexts that an artifact_id is attributed to.
   // Returns INVALID_ARGUMENT error, if the `contexts` is null.
   virtual absl::Status FindContextsByArtifact(
@@ -462,6 +677,17 @@ class MetadataAccessObject {
       int64 context_id, absl::optional<ListOperationOptions> list_options,
       std::vector<Artifact>* artifacts, std::string* next_page_token) = 0;
 
+  // Queries the artifacts attributed to a collection of `context_ids`, like
+  // FindExecutionsByContexts: the `attributions` are ordered by context id and
+  // then by artifact id in descending order, at most `max_num_per_context` of
+  // each context are kept if it is positive, and the `artifacts` of the kept
+  // attributions are ordered by id.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindArtifactsByContexts(
+      absl::Span<const int64> context_ids, int64 max_num_per_context,
+      std::vector<Attribution>* attributions,
+      std::vector<Artifact>* artifacts) = 0;
+
   // Creates a parent context, returns OK if succeeds.
   // Returns INVALID_ARGUMENT error, if no context matches the child_id.
   // Returns INVALID_ARGUMENT error, if no context matches the parent_id.
@@ -481,6 +707,22 @@ class MetadataAccessObject {
   virtual absl::Status FindChildContextsByContextId(
       int64 context_id, std::vector<Context>* contexts) = 0;
 
+  // Queries the ancestor contexts of a context_id within `max_depth` levels of
+  // parent contexts with a single query, ordered by the least number of levels
+  // to the ancestor, then by id.
+  // Returns INVALID_ARGUMENT error, if the `contexts` is null or `max_depth` is
+  // not positive.
+  virtual absl::Status FindAncestorContextsByContextId(
+      int64 context_id, int64 max_depth, std::vector<Context>* contexts) = 0;
+
+  // Queries the descendant contexts of a context_id within `max_depth` levels
+  // of child contexts with a single query, ordered by the least number of
+  // levels to the descendant, then by id.
+  // Returns INVALID_ARGUMENT error, if the `contexts` is null or `max_depth` is
+  // not positive.
+  virtual absl::Status FindDescendantContextsByContextId(
+      int64 context_id, int64 max_depth, std::vector<Context>* contexts) = 0;
+
   // Resolves the schema version stored in the metadata source. The `db_version`
   // is set to 0, if it is a 0.13.2 release pre-existing database.
   // Returns DATA_LOSS error, if schema version info table exists but its value
@@ -498,6 +740,13 @@ class MetadataAccessObject {
   // database if needed.
   virtual int64 GetLibraryVersion() = 0;
 
+  // Gets the generation of the stored types, which is increased whenever the
+  // types are changed.
+  // Returns FAILED_PRECONDITION error, if the metadata source has no type
+  //   generation, e.g., its schema is earlier than v9.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status GetTypeGeneration(int64* type_generation) = 0;
+
 
   // Giving a set of `query_nodes` and a set of boundary constraints. The method
   // performs constrained transitive closure and returns a subgraph including
@@ -515,6 +764,72 @@ class MetadataAccessObject {
       absl::optional<std::string> boundary_executions,
       LineageGraph& subgraph) = 0;
 
+  // Like QueryLineageGraph, but the artifacts and executions reached from the
+  // `query_nodes` only have their ids in the `subgraph`, so that the caller can
+  // read them separately, e.g., in parallel on other connections.
+  virtual absl::Status QueryLineageGraphIds(
+      const std::vector<Artifact>& query_nodes, int64 max_num_hops,
+      absl::optional<int64> max_nodes,
+      absl::optional<std::string> boundary_artifacts,
+      absl::optional<std::string> boundary_executions,
+      LineageGraph& subgraph) = 0;
+
+  // Sets the in-memory `index` of the lineage graph, which QueryLineageGraph
+  // and QueryLineageGraphIds traverse instead of the database when they have
+  // no boundary conditions. The `index` may be shared with the objects of
+  // other connections to the same database; null unsets it.
+  virtual void set_lineage_graph_index(
+      std::shared_ptr<LineageGraphIndex> index) = 0;
+
+  // Sets the `dictionary` of the interned string property values, which the
+  // writes look up the ids of the values in. The `dictionary` may be shared
+  // with the objects of other connections to the same database; null stores
+  // the values in the property rows.
+  virtual void set_property_string_dictionary(
+      std::shared_ptr<PropertyStringDictionary> dictionary) = 0;
+
+  // Sets the compression of the large property values written, which the
+  // reads decompress.
+  virtual void set_property_value_compression(
+      const PropertyValueCompressionConfig& config) = 0;
+
+  // Sets the `indexed_properties`, whose dedicated indices are created by
+  // InitMetadataSource and InitMetadataSourceIfNotExists, and which the
+  // filter queries comparing their values use.
+  virtual void set_indexed_properties(
+      std::vector<IndexedProperty> indexed_properties) = 0;
+
+  // Finds the artifacts derived from (`upstream` is false) or deriving
+  // (`upstream` is true) the `artifact_ids` through executions within
+  // `max_num_hops` executions, excluding the `artifact_ids`. If `context_id` is
+  // given, only the executions attributed to the context are followed. The
+  // `artifacts` are ordered by the distance, and then by the id.
+  // Returns FAILED_PRECONDITION error, if the schema has no derivation table.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindArtifactsByDerivation(
+      absl::Span<const int64> artifact_ids, bool upstream, int64 max_num_hops,
+      absl::optional<int64> context_id, std::vector<Artifact>* artifacts) = 0;
+
+  // Finds at most `max_num_entries` change log entries with sequence numbers
+  // larger than `after_sequence_number`, ordered by their sequence numbers.
+  // The entries are appended as the nodes and the events are written.
+  // Returns FAILED_PRECONDITION error, if the schema has no change log.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status FindChangeLogEntries(
+      int64 after_sequence_number, int64 max_num_entries,
+      std::vector<ChangeLogEntry>* entries) = 0;
+
+  // Moves at most `max_num_executions` of the least recently updated
+  // executions, which are not NEW or RUNNING and were last updated at or
+  // before `max_last_update_time_since_epoch`, with their properties and
+  // events to the archive tables, and sets `num_archived_executions`.
+  // The archived executions are still found by id, by context and in the
+  // lineage graph, but they are not listed, filtered, counted or updated.
+  // Returns FAILED_PRECONDITION error, if the schema has no archive tables.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status ArchiveExecutions(int64 max_last_update_time_since_epoch,
+                                         int64 max_num_executions,
+                                         int64* num_archived_executions) = 0;
 
   // Deletes a list of artifacts by id.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -18,6 +18,9 @@ limitations under the License.
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_access_object.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
 #include "ml_metadata/metadata_store/query_config_executor.h"
 #include "ml_metadata/metadata_store/rdbms_metadata_access_object.h"
 #include "ml_metadata/util/return_utils.h"
@@ -46,6 +49,32 @@ absl::Status CreateRDBMSMetadataAccessObject(
   return absl::OkStatus();
 }
 
+// Creates an InMemoryMetadataAccessObject, which reads and writes the database
+// of the InMemoryMetadataSource directly. The database is always at the
+// library schema version, so earlier schema versions are not supported.
+absl::Status CreateInMemoryMetadataAccessObject(
+    const MetadataSourceQueryConfig& query_config,
+    MetadataSource* const metadata_source, absl::optional<int64> schema_version,
+    std::unique_ptr<MetadataAccessObject>* result) {
+  auto* in_memory_metadata_source =
+      dynamic_cast<InMemoryMetadataSource*>(metadata_source);
+  if (in_memory_metadata_source == nullptr) {
+    return absl::InvalidArgumentError(
+        "The in-memory metadata source type requires an "
+        "InMemoryMetadataSource.");
+  }
+  if (schema_version && *schema_version != query_config.schema_version()) {
+    return absl::UnimplementedError(absl::StrCat(
+        "The in-memory metadata source only supports the library schema "
+        "version: ",
+        query_config.schema_version(), ", given: ", *schema_version));
+  }
+  if (!metadata_source->is_connected())
+    MLMD_RETURN_IF_ERROR(metadata_source->Connect());
+  *result = absl::WrapUnique(new InMemoryMetadataAccessObject(
+      in_memory_metadata_source, query_config.schema_version()));
+  return absl::OkStatus();
+}
 
 }  // namespace
 
@@ -72,6 +101,12 @@ absl::Status CreateMetadataAccessObject(
     case SQLITE_METADATA_SOURCE:
       return CreateRDBMSMetadataAccessObject(query_config, metadata_source,
                                              schema_version, result);
+    case POSTGRESQL_METADATA_SOURCE:
+      return CreateRDBMSMetadataAccessObject(query_config, metadata_source,
+                                             schema_version, result);
+    case IN_MEMORY_METADATA_SOURCE:
+      return CreateInMemoryMetadataAccessObject(query_config, metadata_source,
+                                                schema_version, result);
     default:
       return absl::UnimplementedError("Unknown Metadata source type.");
   }
@@ -52,11 +52,11 @@ TEST(MetadataAccessObjectFactory, CreateMetadataAccessObject) {
 
 // Test that the head library is capable of creating MetadataAccessObjects at
 // different query_versions.
-TEST(MetadataAccessObjectFactory, CreateMetadataAccessObjectAtSchemaVersion7) {
+TEST(MetadataAccessObjectFactory, CreateMetadataAccessObjectAtSchemaVersion19) {
   // Create MetadataAccessObject with default schema_version = library_version,
-  // then downgrade the source to 7. Then create an instance of
-  // MetadataAccessObject with that query_version.
-  constexpr int64 kLibSchemaVersion = 8;
+  // then downgrade the source to kLibSchemaVersion - 1. Then create an instance
+  // of MetadataAccessObject with that query_version.
+  constexpr int64 kLibSchemaVersion = 20;
   const int64 earlier_schema_version = kLibSchemaVersion - 1;
   SqliteMetadataSourceConfig config;
   std::unique_ptr<MetadataSource> metadata_source =
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_access_object_test.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -26,6 +27,7 @@ limitations under the License.
 #include "absl/container/node_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
@@ -271,6 +273,7 @@ using ::testing::IsEmpty;
 using ::testing::Pointwise;
 using ::testing::SizeIs;
 using ::testing::UnorderedElementsAre;
+using ::testing::UnorderedElementsAreArray;
 using ::testing::UnorderedPointwise;
 
 // A utility method creates and stores a type based on the given text proto.
@@ -1059,6 +1062,104 @@ TEST_P(MetadataAccessObjectTest, UpdateTypeError) {
   }
 }
 
+TEST_P(MetadataAccessObjectTest, FindTypeWithTypeCache) {
+  if (SkipIfEarlierSchemaLessThan(/*min_schema_version=*/9)) {
+    return;
+  }
+  // The test changes the types with queries behind the cache.
+  if (!metadata_access_object_container_->PerformExtendedTests()) {
+    return;
+  }
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'cached_type'
+    properties { key: 'stored_property' value: STRING })");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+  type.set_id(type_id);
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Commit());
+
+  // The types found in a transaction are cached for the next transactions.
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  ArtifactType got_type;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindTypeById(type_id, &got_type));
+  EXPECT_THAT(got_type, EqualsProto(type));
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQuery(
+                "UPDATE `Type` SET `description` = 'changed';", &record_set));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Commit());
+
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindTypeById(type_id, &got_type));
+  EXPECT_THAT(got_type, EqualsProto(type));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindTypeByNameAndVersion(
+                "cached_type", absl::nullopt, &got_type));
+  EXPECT_THAT(got_type, EqualsProto(type));
+  // Another connection changes the types and increases the type generation.
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQuery(
+                "UPDATE `MLMDEnv` SET `type_generation` = "
+                "`type_generation` + 1;",
+                &record_set));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Commit());
+
+  // The cache is cleared once the type generation changes.
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  type.set_description("changed");
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindTypeById(type_id, &got_type));
+  EXPECT_THAT(got_type, EqualsProto(type));
+
+  // Updating the type invalidates the cache in the same transaction.
+  (*type.mutable_properties())["new_property"] = INT;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->UpdateType(type));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindTypeById(type_id, &got_type));
+  EXPECT_THAT(got_type, EqualsProto(type));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Commit());
+
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindTypeByNameAndVersion(
+                "cached_type", absl::nullopt, &got_type));
+  EXPECT_THAT(got_type, EqualsProto(type));
+}
+
+TEST_P(MetadataAccessObjectTest, FindTypeWithTypeCacheAfterRollback) {
+  if (SkipIfEarlierSchemaLessThan(/*min_schema_version=*/9)) {
+    return;
+  }
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ExecutionType type = ParseTextProtoOrDie<ExecutionType>("name: 'type'");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+  type.set_id(type_id);
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Commit());
+
+  // The updated type is not cached when its transaction rolls back.
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  ExecutionType updated_type = type;
+  (*updated_type.mutable_properties())["new_property"] = INT;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->UpdateType(updated_type));
+  ExecutionType got_type;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindTypeById(type_id, &got_type));
+  EXPECT_THAT(got_type, EqualsProto(updated_type));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Rollback());
+
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindTypeById(type_id, &got_type));
+  EXPECT_THAT(got_type, EqualsProto(type));
+}
+
 TEST_P(MetadataAccessObjectTest, FindTypeById) {
   ASSERT_EQ(absl::OkStatus(), Init());
   ArtifactType want_type = ParseTextProtoOrDie<ArtifactType>(R"(
@@ -1529,6 +1630,52 @@ TEST_P(MetadataAccessObjectTest, CreateArtifactWithCustomProperty) {
   EXPECT_EQ(artifact2_id, 2);
 }
 
+TEST_P(MetadataAccessObjectTest, CreateArtifactWithProtoProperty) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type_with_proto_property'
+    properties { key: 'property_1' value: PROTO }
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+  Artifact artifact = ParseTextProtoOrDie<Artifact>(R"(
+    uri: 'testuri://testing/uri'
+    custom_properties {
+      key: 'custom_property_1'
+      value: {
+        struct_value {
+          fields {
+            key: "json number"
+            value { number_value: 1234 }
+          }
+        }
+      }
+    }
+  )");
+  artifact.set_type_id(type_id);
+  (*artifact.mutable_properties())["property_1"]
+      .mutable_proto_value()
+      ->PackFrom(type);
+
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+  std::vector<Artifact> got_artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsById(
+                                  {artifact_id}, &got_artifacts));
+  ASSERT_THAT(got_artifacts, SizeIs(1));
+  EXPECT_THAT(got_artifacts[0],
+              EqualsProto(artifact, /*ignore_fields=*/{
+                              "id", "create_time_since_epoch",
+                              "last_update_time_since_epoch"}));
+
+  // A string value does not match the proto property type.
+  (*artifact.mutable_properties())["property_1"].set_string_value("3");
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_access_object_->CreateArtifact(artifact, &artifact_id)));
+}
+
 TEST_P(MetadataAccessObjectTest, CreateArtifactError) {
   ASSERT_EQ(absl::OkStatus(), Init());
 
@@ -1580,6 +1727,209 @@ TEST_P(MetadataAccessObjectTest, CreateArtifactWithDuplicatedNameError) {
   ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
 }
 
+TEST_P(MetadataAccessObjectTest, CreateArtifacts) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'property_1' value: INT }
+    properties { key: 'property_2' value: DOUBLE }
+    properties { key: 'property_3' value: STRUCT }
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+
+  // Creates more artifacts than a single multi-row insert can hold.
+  std::vector<Artifact> want_artifacts;
+  for (int i = 0; i < 250; i++) {
+    Artifact artifact = ParseTextProtoOrDie<Artifact>(R"(
+      uri: 'testuri://testing/uri'
+      state: LIVE
+      properties {
+        key: 'property_2'
+        value: { double_value: 0.5 }
+      }
+      properties {
+        key: 'property_3'
+        value: {
+          struct_value {
+            fields {
+              key: "json number"
+              value { number_value: 1234 }
+            }
+          }
+        }
+      }
+      custom_properties {
+        key: 'custom_property_1'
+        value: { string_value: 'it\'s a string' }
+      }
+    )");
+    artifact.set_type_id(type_id);
+    artifact.set_name(absl::StrCat("artifact_", i));
+    (*artifact.mutable_properties())["property_1"].set_int_value(i);
+    want_artifacts.push_back(artifact);
+  }
+  // An artifact without name, state and properties.
+  want_artifacts.push_back(ParseTextProtoOrDie<Artifact>(
+      absl::StrCat("type_id: ", type_id, " uri: 'testuri://testing/uri2'")));
+
+  std::vector<int64> artifact_ids;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateArtifacts(
+                                  want_artifacts, &artifact_ids));
+  ASSERT_THAT(artifact_ids, SizeIs(want_artifacts.size()));
+  std::vector<Artifact> got_artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifactsById(
+                                  artifact_ids, &got_artifacts));
+  ASSERT_THAT(got_artifacts, SizeIs(want_artifacts.size()));
+  absl::flat_hash_map<int64, Artifact> got_artifacts_by_id;
+  for (const Artifact& artifact : got_artifacts) {
+    got_artifacts_by_id[artifact.id()] = artifact;
+  }
+  // The ids are returned in the order of the given artifacts.
+  for (int i = 0; i < want_artifacts.size(); i++) {
+    EXPECT_THAT(got_artifacts_by_id[artifact_ids[i]],
+                EqualsProto(want_artifacts[i], /*ignore_fields=*/{
+                                "id", "create_time_since_epoch",
+                                "last_update_time_since_epoch"}));
+  }
+}
+
+TEST_P(MetadataAccessObjectTest, CreateArtifactsError) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'property_1' value: INT }
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+  Artifact artifact;
+  artifact.set_type_id(type_id);
+  artifact.set_name("test artifact name");
+
+  // type mismatch of any artifact fails the batch
+  Artifact mismatched_artifact;
+  mismatched_artifact.set_type_id(type_id);
+  (*mismatched_artifact.mutable_properties())["property_1"].set_string_value(
+      "3");
+  std::vector<int64> artifact_ids;
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_access_object_->CreateArtifacts(
+      {artifact, mismatched_artifact}, &artifact_ids)));
+  std::vector<Artifact> artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifacts(&artifacts));
+  EXPECT_THAT(artifacts, IsEmpty());
+
+  // unknown type specified
+  Artifact unknown_type_artifact;
+  unknown_type_artifact.set_type_id(type_id + 1);
+  EXPECT_TRUE(absl::IsNotFound(metadata_access_object_->CreateArtifacts(
+      {artifact, unknown_type_artifact}, &artifact_ids)));
+
+  // duplicated names in the batch violate the unique constraint
+  ASSERT_TRUE(absl::IsAlreadyExists(metadata_access_object_->CreateArtifacts(
+      {artifact, artifact}, &artifact_ids)));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Rollback());
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+}
+
+TEST_P(MetadataAccessObjectTest, CreateArtifactIfNotExist) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'property_1' value: INT }
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+  Artifact want_artifact = ParseTextProtoOrDie<Artifact>(R"(
+    uri: 'testuri://testing/uri'
+    name: 'test artifact name'
+    state: LIVE
+    properties {
+      key: 'property_1'
+      value: { int_value: 3 }
+    }
+  )");
+  want_artifact.set_type_id(type_id);
+  int64 artifact_id;
+  bool is_created;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateArtifactIfNotExist(
+                                  want_artifact, &artifact_id, &is_created));
+  EXPECT_TRUE(is_created);
+
+  // the stored artifact is returned and kept as is
+  Artifact other_artifact = want_artifact;
+  other_artifact.set_uri("testuri://testing/other_uri");
+  (*other_artifact.mutable_properties())["property_1"].set_int_value(5);
+  int64 other_artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifactIfNotExist(
+                other_artifact, &other_artifact_id, &is_created));
+  EXPECT_FALSE(is_created);
+  EXPECT_EQ(artifact_id, other_artifact_id);
+  std::vector<Artifact> artifacts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindArtifacts(&artifacts));
+  ASSERT_THAT(artifacts, SizeIs(1));
+  EXPECT_THAT(artifacts[0],
+              EqualsProto(want_artifact,
+                          /*ignore_fields=*/{"id", "create_time_since_epoch",
+                                             "last_update_time_since_epoch"}));
+
+  // the name is required
+  Artifact unnamed_artifact;
+  unnamed_artifact.set_type_id(type_id);
+  EXPECT_TRUE(
+      absl::IsInvalidArgument(metadata_access_object_->CreateArtifactIfNotExist(
+          unnamed_artifact, &artifact_id, &is_created)));
+}
+
+TEST_P(MetadataAccessObjectTest, FindArtifactsByLargeIdSet) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
+    name: 'test_type'
+    properties { key: 'property_1' value: INT }
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+  // Creates more artifacts than the ids bound as a list of values, so that the
+  // ids are bound as a single JSON array.
+  std::vector<Artifact> artifacts(1200);
+  for (int i = 0; i < artifacts.size(); i++) {
+    artifacts[i].set_type_id(type_id);
+    (*artifacts[i].mutable_properties())["property_1"].set_int_value(i);
+  }
+  std::vector<int64> artifact_ids;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifacts(artifacts, &artifact_ids));
+  ASSERT_THAT(artifact_ids, SizeIs(artifacts.size()));
+
+  // Unknown ids in the set are reported as NOT_FOUND, and the known ids are
+  // still returned.
+  std::vector<int64> query_ids = artifact_ids;
+  query_ids.push_back(artifact_ids.back() + 1);
+  std::vector<Artifact> got_artifacts;
+  ASSERT_TRUE(absl::IsNotFound(
+      metadata_access_object_->FindArtifactsById(query_ids, &got_artifacts)));
+  ASSERT_THAT(got_artifacts, SizeIs(artifacts.size()));
+  absl::flat_hash_map<int64, int64> property_by_id;
+  for (const Artifact& artifact : got_artifacts) {
+    property_by_id[artifact.id()] =
+        artifact.properties().at("property_1").int_value();
+  }
+  for (int i = 0; i < artifact_ids.size(); i++) {
+    EXPECT_EQ(property_by_id[artifact_ids[i]], i);
+  }
+
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->DeleteArtifactsById(artifact_ids));
+  std::vector<Artifact> remaining_artifacts;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindArtifacts(&remaining_artifacts));
+  EXPECT_THAT(remaining_artifacts, IsEmpty());
+}
+
 TEST_P(MetadataAccessObjectTest, FindArtifactById) {
   ASSERT_EQ(absl::OkStatus(), Init());
   ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"(
@@ -1817,6 +2167,9 @@ void VerifyListOptions(const std::string& list_option_text_proto,
 }
 
 TEST_P(MetadataAccessObjectTest, ListArtifactsFilterAttributeQuery) {
+  if (!metadata_access_object_container_->HasFilterQuerySupport()) {
+    return;
+  }
   ASSERT_EQ(absl::OkStatus(), Init());
   const ArtifactType type = CreateTypeFromTextProto<ArtifactType>(
       "name: 't1'", *metadata_access_object_);
@@ -2012,6 +2365,9 @@ TEST_P(MetadataAccessObjectTest, ListNodesFilterEventQuery) {
 }
 
 TEST_P(MetadataAccessObjectTest, ListExecutionsFilterAttributeQuery) {
+  if (!metadata_access_object_container_->HasFilterQuerySupport()) {
+    return;
+  }
   ASSERT_EQ(absl::OkStatus(), Init());
   const ExecutionType type = CreateTypeFromTextProto<ExecutionType>(
       "name: 't1'", *metadata_access_object_);
@@ -2118,6 +2474,9 @@ TEST_P(MetadataAccessObjectTest, ListExecutionsFilterAttributeQuery) {
 }
 
 TEST_P(MetadataAccessObjectTest, ListContextsFilterAttributeQuery) {
+  if (!metadata_access_object_container_->HasFilterQuerySupport()) {
+    return;
+  }
   ASSERT_EQ(absl::OkStatus(), Init());
   const ContextType type =
       CreateTypeFromTextProto<ContextType>(R"(
@@ -2212,6 +2571,9 @@ TEST_P(MetadataAccessObjectTest, ListContextsFilterAttributeQuery) {
 }
 
 TEST_P(MetadataAccessObjectTest, ListNodesFilterContextNeighborQuery) {
+  if (!metadata_access_object_container_->HasFilterQuerySupport()) {
+    return;
+  }
   ASSERT_EQ(absl::OkStatus(), Init());
   const ArtifactType artifact_type = CreateTypeFromTextProto<ArtifactType>(
       "name: 'artifact_type'", *metadata_access_object_);
@@ -2655,24 +3017,36 @@ void TestFilteringWithListOptionsImpl(
 }
 
 TEST_P(MetadataAccessObjectTest, ListArtifactsFilterPropertyQuery) {
+  if (!metadata_access_object_container_->HasFilterQuerySupport()) {
+    return;
+  }
   ASSERT_EQ(absl::OkStatus(), Init());
   TestFilteringWithListOptionsImpl<ArtifactType, Artifact>(
       *metadata_access_object_);
 }
 
 TEST_P(MetadataAccessObjectTest, ListExecutionsFilterPropertyQuery) {
+  if (!metadata_access_object_container_->HasFilterQuerySupport()) {
+    return;
+  }
   ASSERT_EQ(absl::OkStatus(), Init());
   TestFilteringWithListOptionsImpl<ExecutionType, Execution>(
       *metadata_access_object_);
 }
 
 TEST_P(MetadataAccessObjectTest, LisContextsFilterPropertyQuery) {
+  if (!metadata_access_object_container_->HasFilterQuerySupport()) {
+    return;
+  }
   ASSERT_EQ(absl::OkStatus(), Init());
   TestFilteringWithListOptionsImpl<ContextType, Context>(
       *metadata_access_object_);
 }
 
 TEST_P(MetadataAccessObjectTest, ListNodesFilterWithErrors) {
+  if (!metadata_access_object_container_->HasFilterQuerySupport()) {
+    return;
+  }
   ASSERT_EQ(absl::OkStatus(), Init());
 
   ListOperationOptions list_options =
@@ -2910,7 +3284,96 @@ TEST_P(MetadataAccessObjectTest, QueryLineageGraphArtifactsOnly) {
                      /*events=*/{}, *metadata_access_object_);
 }
 
+TEST_P(MetadataAccessObjectTest, QueryLineageGraphMultipleHops) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  // Test setup: use a chain of nodes a0 -> e0 -> a1 -> e1 -> a2.
+  const ArtifactType artifact_type = CreateTypeFromTextProto<ArtifactType>(
+      "name: 'artifact_type'", *metadata_access_object_);
+  const ExecutionType execution_type = CreateTypeFromTextProto<ExecutionType>(
+      "name: 'execution_type'", *metadata_access_object_);
+  std::vector<Artifact> want_artifacts(3);
+  std::vector<Execution> want_executions(2);
+  for (int i = 0; i < 3; i++) {
+    CreateNodeFromTextProto(absl::Substitute("uri: 'uri_$0'", i),
+                            artifact_type.id(), *metadata_access_object_,
+                            want_artifacts[i]);
+  }
+  for (int i = 0; i < 2; i++) {
+    CreateNodeFromTextProto("", execution_type.id(), *metadata_access_object_,
+                            want_executions[i]);
+  }
+  std::vector<Event> want_events(4);
+  for (int i = 0; i < 2; i++) {
+    CreateEventFromTextProto("type: INPUT", want_artifacts[i],
+                             want_executions[i], *metadata_access_object_,
+                             want_events[2 * i]);
+    CreateEventFromTextProto("type: OUTPUT", want_artifacts[i + 1],
+                             want_executions[i], *metadata_access_object_,
+                             want_events[2 * i + 1]);
+  }
+
+  {
+    // Query a0 with 3 hops.
+    LineageGraph output_graph;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->QueryLineageGraph(
+                  /*query_nodes=*/{want_artifacts[0]}, /*max_num_hops=*/3,
+                  /*max_nodes=*/absl::nullopt,
+                  /*boundary_artifacts=*/absl::nullopt,
+                  /*boundary_executions=*/absl::nullopt, output_graph));
+    VerifyLineageGraph(output_graph, {want_artifacts[0], want_artifacts[1]},
+                       want_executions,
+                       {want_events[0], want_events[1], want_events[2]},
+                       *metadata_access_object_);
+  }
+
+  {
+    // Query a0 with max_nodes of 3. It keeps the nodes nearest to a0.
+    LineageGraph output_graph;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->QueryLineageGraph(
+                  /*query_nodes=*/{want_artifacts[0]}, /*max_num_hops=*/4,
+                  /*max_nodes=*/3,
+                  /*boundary_artifacts=*/absl::nullopt,
+                  /*boundary_executions=*/absl::nullopt, output_graph));
+    VerifyLineageGraph(output_graph, {want_artifacts[0], want_artifacts[1]},
+                       {want_executions[0]}, {want_events[0], want_events[1]},
+                       *metadata_access_object_);
+  }
+
+  {
+    // Query a2 with 2 hops traverses the events backwards.
+    LineageGraph output_graph;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->QueryLineageGraph(
+                  /*query_nodes=*/{want_artifacts[2]}, /*max_num_hops=*/2,
+                  /*max_nodes=*/absl::nullopt,
+                  /*boundary_artifacts=*/absl::nullopt,
+                  /*boundary_executions=*/absl::nullopt, output_graph));
+    VerifyLineageGraph(output_graph, {want_artifacts[2], want_artifacts[1]},
+                       {want_executions[1]}, {want_events[3], want_events[2]},
+                       *metadata_access_object_);
+  }
+
+  {
+    // Query a2 and a0 with a large hop. It returns all nodes with no
+    // duplicate.
+    LineageGraph output_graph;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->QueryLineageGraph(
+                  /*query_nodes=*/{want_artifacts[2], want_artifacts[0]},
+                  /*max_num_hops=*/20, /*max_nodes=*/absl::nullopt,
+                  /*boundary_artifacts=*/absl::nullopt,
+                  /*boundary_executions=*/absl::nullopt, output_graph));
+    VerifyLineageGraph(output_graph, want_artifacts, want_executions,
+                       want_events, *metadata_access_object_);
+  }
+}
+
 TEST_P(MetadataAccessObjectTest, QueryLineageGraphWithBoundaryConditions) {
+  if (!metadata_access_object_container_->HasFilterQuerySupport()) {
+    return;
+  }
   ASSERT_EQ(absl::OkStatus(), Init());
   // Test setup: use a high fan-out graph to test the boundaries cases
   // a0 -> e1 -> a1 -> e0
@@ -3004,6 +3467,17 @@ TEST_P(MetadataAccessObjectTest, QueryLineageGraphWithBoundaryConditions) {
                 UnorderedPointwise(EqualsProto<Artifact>(), want_artifacts));
     EXPECT_EQ(output_graph.executions().size(), 8);
     EXPECT_EQ(output_graph.events().size(), 9);
+    // The executions with the smallest ids are kept.
+    std::vector<int64> execution_ids;
+    for (const Execution& execution : output_graph.executions()) {
+      execution_ids.push_back(execution.id());
+    }
+    std::vector<int64> want_execution_ids;
+    for (int i = 0; i < 8; i++) {
+      want_execution_ids.push_back(want_executions[i].id());
+    }
+    EXPECT_THAT(execution_ids,
+                UnorderedElementsAreArray(want_execution_ids));
   }
 
   {
@@ -5471,6 +5945,88 @@ TEST_P(MetadataAccessObjectTest, ListContextsByType) {
   }
 }
 
+TEST_P(MetadataAccessObjectTest, CreateExecutionsAndContexts) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ExecutionType execution_type = ParseTextProtoOrDie<ExecutionType>(R"(
+    name: 'test_execution_type'
+    properties { key: 'property_1' value: INT }
+  )");
+  int64 execution_type_id;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateType(
+                                  execution_type, &execution_type_id));
+  ContextType context_type = ParseTextProtoOrDie<ContextType>(R"(
+    name: 'test_context_type'
+    properties { key: 'property_1' value: STRING }
+  )");
+  int64 context_type_id;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateType(
+                                  context_type, &context_type_id));
+
+  std::vector<Execution> want_executions;
+  std::vector<Context> want_contexts;
+  for (int i = 0; i < 3; i++) {
+    Execution execution = ParseTextProtoOrDie<Execution>(R"(
+      last_known_state: RUNNING
+      custom_properties {
+        key: 'custom_property_1'
+        value: { double_value: 1.5 }
+      }
+    )");
+    execution.set_type_id(execution_type_id);
+    (*execution.mutable_properties())["property_1"].set_int_value(i);
+    want_executions.push_back(execution);
+
+    Context context;
+    context.set_type_id(context_type_id);
+    context.set_name(absl::StrCat("context_", i));
+    (*context.mutable_properties())["property_1"].set_string_value(
+        absl::StrCat("value_", i));
+    want_contexts.push_back(context);
+  }
+
+  std::vector<int64> execution_ids;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateExecutions(
+                                  want_executions, &execution_ids));
+  std::vector<Execution> got_executions;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindExecutionsById(
+                                  execution_ids, &got_executions));
+  ASSERT_THAT(got_executions, SizeIs(want_executions.size()));
+  for (const Execution& got_execution : got_executions) {
+    const int i = std::find(execution_ids.begin(), execution_ids.end(),
+                            got_execution.id()) -
+                  execution_ids.begin();
+    ASSERT_LT(i, want_executions.size());
+    EXPECT_THAT(got_execution,
+                EqualsProto(want_executions[i], /*ignore_fields=*/{
+                                "id", "create_time_since_epoch",
+                                "last_update_time_since_epoch"}));
+  }
+
+  std::vector<int64> context_ids;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateContexts(
+                                  want_contexts, &context_ids));
+  std::vector<Context> got_contexts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindContextsById(
+                                  context_ids, &got_contexts));
+  ASSERT_THAT(got_contexts, SizeIs(want_contexts.size()));
+  for (const Context& got_context : got_contexts) {
+    const int i =
+        std::find(context_ids.begin(), context_ids.end(), got_context.id()) -
+        context_ids.begin();
+    ASSERT_LT(i, want_contexts.size());
+    EXPECT_THAT(got_context,
+                EqualsProto(want_contexts[i], /*ignore_fields=*/{
+                                "id", "create_time_since_epoch",
+                                "last_update_time_since_epoch"}));
+  }
+
+  // a context without name fails the batch
+  Context unnamed_context;
+  unnamed_context.set_type_id(context_type_id);
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_access_object_->CreateContexts(
+      {unnamed_context}, &context_ids)));
+}
+
 TEST_P(MetadataAccessObjectTest, CreateContextError) {
   ASSERT_EQ(absl::OkStatus(), Init());
   Context context;
@@ -5526,6 +6082,69 @@ TEST_P(MetadataAccessObjectTest, CreateContextWithDuplicatedNameError) {
   ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
 }
 
+TEST_P(MetadataAccessObjectTest, CreateContextIfNotExist) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  ContextType type = ParseTextProtoOrDie<ContextType>(R"(
+    name: 'test_type'
+    properties { key: 'property_1' value: INT }
+  )");
+  int64 type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(type, &type_id));
+  Context want_context = ParseTextProtoOrDie<Context>(R"(
+    name: 'test context name'
+    properties {
+      key: 'property_1'
+      value: { int_value: 3 }
+    }
+  )");
+  want_context.set_type_id(type_id);
+  int64 context_id;
+  bool is_created;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateContextIfNotExist(
+                                  want_context, &context_id, &is_created));
+  EXPECT_TRUE(is_created);
+
+  // the stored context is returned and kept as is
+  Context other_context = want_context;
+  (*other_context.mutable_properties())["property_1"].set_int_value(5);
+  int64 other_context_id;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateContextIfNotExist(
+                                  other_context, &other_context_id,
+                                  &is_created));
+  EXPECT_FALSE(is_created);
+  EXPECT_EQ(context_id, other_context_id);
+  std::vector<Context> contexts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindContexts(&contexts));
+  ASSERT_THAT(contexts, SizeIs(1));
+  EXPECT_THAT(contexts[0],
+              EqualsProto(want_context,
+                          /*ignore_fields=*/{"id", "create_time_since_epoch",
+                                             "last_update_time_since_epoch"}));
+
+  // a context of another type with the same name is created
+  ContextType other_type;
+  other_type.set_name("other_type");
+  int64 other_type_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateType(other_type, &other_type_id));
+  Context other_type_context;
+  other_type_context.set_type_id(other_type_id);
+  other_type_context.set_name(want_context.name());
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateContextIfNotExist(
+                                  other_type_context, &other_context_id,
+                                  &is_created));
+  EXPECT_TRUE(is_created);
+  EXPECT_NE(context_id, other_context_id);
+
+  // the name is required
+  Context unnamed_context;
+  unnamed_context.set_type_id(type_id);
+  EXPECT_TRUE(
+      absl::IsInvalidArgument(metadata_access_object_->CreateContextIfNotExist(
+          unnamed_context, &context_id, &is_created)));
+}
+
 TEST_P(MetadataAccessObjectTest, UpdateContext) {
   ASSERT_EQ(absl::OkStatus(), Init());
   ContextType type = ParseTextProtoOrDie<ContextType>(R"(
@@ -5876,6 +6495,73 @@ TEST_P(MetadataAccessObjectTest, CreateAssociationError2) {
   ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
 }
 
+TEST_P(MetadataAccessObjectTest,
+       CreateAssociationsAndAttributionsIfNotExist) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 artifact_type_id = InsertType<ArtifactType>("artifact_type");
+  int64 execution_type_id = InsertType<ExecutionType>("execution_type");
+  int64 context_type_id = InsertType<ContextType>("context_type");
+  Artifact artifact;
+  artifact.set_type_id(artifact_type_id);
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+  Execution execution;
+  execution.set_type_id(execution_type_id);
+  int64 execution_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateExecution(execution, &execution_id));
+  Context context1 = ParseTextProtoOrDie<Context>("name: 'context1'");
+  context1.set_type_id(context_type_id);
+  Context context2 = ParseTextProtoOrDie<Context>("name: 'context2'");
+  context2.set_type_id(context_type_id);
+  std::vector<int64> context_ids;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateContexts(
+                                  {context1, context2}, &context_ids));
+
+  Association association1;
+  association1.set_context_id(context_ids[0]);
+  association1.set_execution_id(execution_id);
+  Association association2 = association1;
+  association2.set_context_id(context_ids[1]);
+  int64 association_id;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateAssociation(
+                                  association1, &association_id));
+  // the existing and the repeated associations are skipped.
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateAssociationsIfNotExist(
+                {association1, association2, association2}));
+  std::vector<Context> execution_contexts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindContextsByExecution(
+                                  execution_id, &execution_contexts));
+  EXPECT_EQ(execution_contexts.size(), 2);
+
+  Attribution attribution1;
+  attribution1.set_context_id(context_ids[0]);
+  attribution1.set_artifact_id(artifact_id);
+  Attribution attribution2 = attribution1;
+  attribution2.set_context_id(context_ids[1]);
+  int64 attribution_id;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateAttribution(
+                                  attribution2, &attribution_id));
+  EXPECT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateAttributionsIfNotExist(
+                {attribution1, attribution2, attribution1}));
+  std::vector<Context> artifact_contexts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindContextsByArtifact(
+                                  artifact_id, &artifact_contexts));
+  EXPECT_EQ(artifact_contexts.size(), 2);
+
+  // the context cannot be found
+  association2.set_context_id(context_ids[1] + 1);
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_access_object_->CreateAssociationsIfNotExist(
+          {association1, association2})));
+  attribution2.set_artifact_id(artifact_id + 1);
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_access_object_->CreateAttributionsIfNotExist({attribution2})));
+}
+
 TEST_P(MetadataAccessObjectTest, CreateAndUseAttribution) {
   ASSERT_EQ(absl::OkStatus(), Init());
   int64 artifact_type_id = InsertType<ArtifactType>("test_artifact_type");
@@ -6017,6 +6703,271 @@ TEST_P(MetadataAccessObjectTest, FindEventsByExecutionsNotFound) {
   EXPECT_TRUE(absl::IsNotFound(not_exist_id_status));
 }
 
+TEST_P(MetadataAccessObjectTest, CountNodes) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  const ExecutionType execution_type = CreateTypeFromTextProto<ExecutionType>(
+      "name: 'train'", *metadata_access_object_);
+  const ContextType context_type = CreateTypeFromTextProto<ContextType>(
+      "name: 'pipeline'", *metadata_access_object_);
+  std::vector<Execution> executions(3);
+  CreateNodeFromTextProto("last_known_state: RUNNING", execution_type.id(),
+                          *metadata_access_object_, executions[0]);
+  CreateNodeFromTextProto("last_known_state: COMPLETE", execution_type.id(),
+                          *metadata_access_object_, executions[1]);
+  CreateNodeFromTextProto("", execution_type.id(), *metadata_access_object_,
+                          executions[2]);
+  std::vector<Context> contexts(2);
+  for (int i = 0; i < 2; i++) {
+    CreateNodeFromTextProto(absl::Substitute("name: 'p$0'", i),
+                            context_type.id(), *metadata_access_object_,
+                            contexts[i]);
+  }
+  // The first pipeline has the first two executions, and the second pipeline
+  // has the second one.
+  for (const auto& [execution_index, context_index] :
+       std::vector<std::pair<int, int>>({{0, 0}, {1, 0}, {1, 1}})) {
+    Association association;
+    association.set_execution_id(executions[execution_index].id());
+    association.set_context_id(contexts[context_index].id());
+    int64 association_id;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateAssociation(
+                                    association, &association_id));
+  }
+
+  std::vector<NodeCount> counts;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CountExecutions(
+                                  CountOptions(), &counts));
+  EXPECT_THAT(counts, ElementsAre(EqualsProto(
+                          ParseTextProtoOrDie<NodeCount>("count: 3"))));
+
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CountExecutions(
+                ParseTextProtoOrDie<CountOptions>("group_by: STATE"), &counts));
+  EXPECT_THAT(counts,
+              ElementsAre(EqualsProto(ParseTextProtoOrDie<NodeCount>(
+                              "count: 1")),
+                          EqualsProto(ParseTextProtoOrDie<NodeCount>(
+                              "state: 2 count: 1")),
+                          EqualsProto(ParseTextProtoOrDie<NodeCount>(
+                              "state: 3 count: 1"))));
+
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CountExecutions(
+                ParseTextProtoOrDie<CountOptions>(
+                    "group_by: [ CONTEXT, STATE, TYPE, CREATE_TIME_BUCKET ] "
+                    "time_bucket_ms: 10000000000000"),
+                &counts));
+  EXPECT_THAT(
+      counts,
+      ElementsAre(
+          EqualsProto(ParseTextProtoOrDie<NodeCount>(absl::Substitute(
+              R"pb(context_id: $0
+                   state: 2
+                   type_id: $1
+                   create_time_bucket_start: 0
+                   count: 1)pb",
+              contexts[0].id(), execution_type.id()))),
+          EqualsProto(ParseTextProtoOrDie<NodeCount>(absl::Substitute(
+              R"pb(context_id: $0
+                   state: 3
+                   type_id: $1
+                   create_time_bucket_start: 0
+                   count: 1)pb",
+              contexts[0].id(), execution_type.id()))),
+          EqualsProto(ParseTextProtoOrDie<NodeCount>(absl::Substitute(
+              R"pb(context_id: $0
+                   state: 3
+                   type_id: $1
+                   create_time_bucket_start: 0
+                   count: 1)pb",
+              contexts[1].id(), execution_type.id())))));
+
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CountContexts(
+                ParseTextProtoOrDie<CountOptions>("group_by: TYPE"), &counts));
+  EXPECT_THAT(counts, ElementsAre(EqualsProto(ParseTextProtoOrDie<NodeCount>(
+                          absl::Substitute("type_id: $0 count: 2",
+                                           context_type.id())))));
+
+  if (metadata_access_object_container_->HasFilterQuerySupport()) {
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CountExecutions(
+                  ParseTextProtoOrDie<CountOptions>(R"pb(
+                    group_by: STATE
+                    filter_query: "contexts_a.name = 'p0'"
+                  )pb"),
+                  &counts));
+    EXPECT_THAT(counts,
+                ElementsAre(EqualsProto(ParseTextProtoOrDie<NodeCount>(
+                                "state: 2 count: 1")),
+                            EqualsProto(ParseTextProtoOrDie<NodeCount>(
+                                "state: 3 count: 1"))));
+  }
+
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_access_object_->CountContexts(
+      ParseTextProtoOrDie<CountOptions>("group_by: STATE"), &counts)));
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_access_object_->CountExecutions(
+      ParseTextProtoOrDie<CountOptions>("group_by: CREATE_TIME_BUCKET"),
+      &counts)));
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_access_object_->CountExecutions(
+      ParseTextProtoOrDie<CountOptions>("group_by: [ TYPE, TYPE ]"), &counts)));
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_access_object_->CountArtifacts(
+      ParseTextProtoOrDie<CountOptions>(
+          "group_by: [ TYPE, GROUP_BY_UNSPECIFIED ]"),
+      &counts)));
+}
+
+TEST_P(MetadataAccessObjectTest, ListEventsByArtifactsWithOptions) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 artifact_type_id = InsertType<ArtifactType>("test_artifact_type");
+  int64 execution_type_id = InsertType<ExecutionType>("test_execution_type");
+  Artifact artifact;
+  artifact.set_type_id(artifact_type_id);
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+  // The artifact is output by the first execution, and input by the others,
+  // with decreasing event times.
+  for (int i = 0; i < 5; i++) {
+    Execution execution;
+    execution.set_type_id(execution_type_id);
+    int64 execution_id;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateExecution(
+                                    execution, &execution_id));
+    Event event;
+    event.set_artifact_id(artifact_id);
+    event.set_execution_id(execution_id);
+    event.set_type(i == 0 ? Event::OUTPUT : Event::INPUT);
+    event.set_milliseconds_since_epoch(1000 - i);
+    int64 event_id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateEvent(event, &event_id));
+  }
+
+  ListOperationOptions options = ParseTextProtoOrDie<ListOperationOptions>(R"pb(
+    max_result_size: 2
+    order_by_field: { field: CREATE_TIME is_asc: true }
+  )pb");
+  std::vector<int64> listed_times;
+  int num_pages = 0;
+  do {
+    std::vector<Event> events;
+    std::string next_page_token;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->ListEventsByArtifacts(
+                  {artifact_id}, /*event_types=*/{}, options, &events,
+                  &next_page_token));
+    EXPECT_LE(events.size(), 2);
+    for (const Event& event : events) {
+      listed_times.push_back(event.milliseconds_since_epoch());
+    }
+    options.set_next_page_token(next_page_token);
+    num_pages++;
+  } while (!options.next_page_token().empty());
+  EXPECT_EQ(num_pages, 3);
+  EXPECT_THAT(listed_times, ElementsAre(996, 997, 998, 999, 1000));
+
+  std::vector<Event> output_events;
+  std::string next_page_token;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->ListEventsByArtifacts(
+                {artifact_id}, {Event::OUTPUT},
+                ParseTextProtoOrDie<ListOperationOptions>("max_result_size: 10"),
+                &output_events, &next_page_token));
+  ASSERT_EQ(output_events.size(), 1);
+  EXPECT_EQ(output_events[0].milliseconds_since_epoch(), 1000);
+  EXPECT_EQ(next_page_token, "");
+
+  std::vector<Event> events;
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_access_object_->ListEventsByExecutions(
+          {1}, /*event_types=*/{},
+          ParseTextProtoOrDie<ListOperationOptions>(
+              "order_by_field: { field: LAST_UPDATE_TIME }"),
+          &events, &next_page_token)));
+}
+
+TEST_P(MetadataAccessObjectTest, ArchiveExecutions) {
+  if (SkipIfEarlierSchemaLessThan(/*min_schema_version=*/16)) {
+    return;
+  }
+  ASSERT_EQ(absl::OkStatus(), Init());
+  const int64 artifact_type_id = InsertType<ArtifactType>("test_artifact_type");
+  const int64 execution_type_id =
+      InsertType<ExecutionType>("test_execution_type");
+  Artifact artifact;
+  artifact.set_type_id(artifact_type_id);
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+  std::vector<int64> execution_ids;
+  for (const Execution::State state :
+       {Execution::COMPLETE, Execution::RUNNING, Execution::FAILED}) {
+    Execution execution;
+    execution.set_type_id(execution_type_id);
+    execution.set_last_known_state(state);
+    int64 execution_id;
+    ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateExecution(
+                                    execution, &execution_id));
+    execution_ids.push_back(execution_id);
+    Event event;
+    event.set_artifact_id(artifact_id);
+    event.set_execution_id(execution_id);
+    event.set_type(Event::INPUT);
+    int64 event_id;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_access_object_->CreateEvent(event, &event_id));
+  }
+  const int64 max_time = absl::ToUnixMillis(absl::Now()) + 1;
+
+  // The least recently updated execution is archived first, and the RUNNING
+  // one is never archived.
+  int64 num_archived_executions;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->ArchiveExecutions(
+                max_time, /*max_num_executions=*/1, &num_archived_executions));
+  EXPECT_EQ(num_archived_executions, 1);
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->ArchiveExecutions(
+                max_time, /*max_num_executions=*/10, &num_archived_executions));
+  EXPECT_EQ(num_archived_executions, 1);
+
+  // The archived executions are found by id, but not listed.
+  std::vector<Execution> executions;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindExecutionsById(
+                {execution_ids[0], execution_ids[2]}, &executions));
+  EXPECT_THAT(executions, SizeIs(2));
+  executions.clear();
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->FindExecutions(&executions));
+  ASSERT_THAT(executions, SizeIs(1));
+  EXPECT_EQ(executions[0].id(), execution_ids[1]);
+
+  // Their events are read, but not listed.
+  std::vector<Event> events;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindEventsByArtifacts(
+                                  {artifact_id}, &events));
+  EXPECT_THAT(events, SizeIs(3));
+  events.clear();
+  std::string next_page_token;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->ListEventsByArtifacts(
+                {artifact_id}, /*event_types=*/{},
+                ParseTextProtoOrDie<ListOperationOptions>(
+                    "max_result_size: 10"),
+                &events, &next_page_token));
+  ASSERT_THAT(events, SizeIs(1));
+  EXPECT_EQ(events[0].execution_id(), execution_ids[1]);
+
+  // The archived executions are deleted by id.
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->DeleteExecutionsById(
+                                  {execution_ids[0]}));
+  executions.clear();
+  EXPECT_TRUE(absl::IsNotFound(metadata_access_object_->FindExecutionsById(
+      {execution_ids[0]}, &executions)));
+}
+
 TEST_P(MetadataAccessObjectTest, CreateEventError) {
   ASSERT_EQ(absl::OkStatus(), Init());
 
@@ -6132,6 +7083,92 @@ TEST_P(MetadataAccessObjectTest, PutEventsWithPaths) {
   EXPECT_EQ(events_with_execution.size(), 2);
 }
 
+TEST_P(MetadataAccessObjectTest, CreateEvents) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 artifact_type_id = InsertType<ArtifactType>("test_artifact_type");
+  int64 execution_type_id = InsertType<ExecutionType>("test_execution_type");
+  Artifact artifact;
+  artifact.set_type_id(artifact_type_id);
+  std::vector<int64> artifact_ids;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateArtifacts(
+                                  {artifact, artifact}, &artifact_ids));
+  Execution execution;
+  execution.set_type_id(execution_type_id);
+  int64 execution_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateExecution(execution, &execution_id));
+
+  Event event1 = ParseTextProtoOrDie<Event>(R"pb(
+    type: INPUT
+    milliseconds_since_epoch: 12345
+    path {
+      steps { index: 1 }
+      steps { key: "key" }
+    }
+  )pb");
+  event1.set_artifact_id(artifact_ids[0]);
+  event1.set_execution_id(execution_id);
+  Event event2 = ParseTextProtoOrDie<Event>(R"pb(
+    type: OUTPUT
+    path { steps { key: "output_key" } }
+  )pb");
+  event2.set_artifact_id(artifact_ids[1]);
+  event2.set_execution_id(execution_id);
+  std::vector<int64> event_ids;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->CreateEvents(
+                                  {event1, event2}, &event_ids));
+  ASSERT_EQ(event_ids.size(), 2);
+  EXPECT_NE(event_ids[0], event_ids[1]);
+
+  std::vector<Event> events;
+  ASSERT_EQ(absl::OkStatus(), metadata_access_object_->FindEventsByExecutions(
+                                  {execution_id}, &events));
+  EXPECT_THAT(
+      events,
+      UnorderedElementsAre(
+          EqualsProto(event1),
+          EqualsProto(event2, /*ignore_fields=*/{"milliseconds_since_epoch"})));
+}
+
+TEST_P(MetadataAccessObjectTest, CreateEventsError) {
+  ASSERT_EQ(absl::OkStatus(), Init());
+  int64 artifact_type_id = InsertType<ArtifactType>("test_artifact_type");
+  int64 execution_type_id = InsertType<ExecutionType>("test_execution_type");
+  Artifact artifact;
+  artifact.set_type_id(artifact_type_id);
+  int64 artifact_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateArtifact(artifact, &artifact_id));
+  Execution execution;
+  execution.set_type_id(execution_type_id);
+  int64 execution_id;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_access_object_->CreateExecution(execution, &execution_id));
+  Event event = ParseTextProtoOrDie<Event>("type: INPUT");
+  event.set_artifact_id(artifact_id);
+  event.set_execution_id(execution_id);
+
+  // no event type
+  Event unknown_type_event = event;
+  unknown_type_event.clear_type();
+  std::vector<int64> event_ids;
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_access_object_->CreateEvents(
+      {event, unknown_type_event}, &event_ids)));
+
+  // the execution cannot be found
+  Event unknown_execution_event = event;
+  unknown_execution_event.set_execution_id(execution_id + 1);
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_access_object_->CreateEvents(
+      {event, unknown_execution_event}, &event_ids)));
+
+  // duplicated events
+  EXPECT_TRUE(absl::IsAlreadyExists(
+      metadata_access_object_->CreateEvents({event, event}, &event_ids)));
+
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Rollback());
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+}
+
 TEST_P(MetadataAccessObjectTest, CreateDuplicatedEvents) {
   // Support after Spanner upgrade schema to V8.
   if (!metadata_access_object_container_->HasFilterQuerySupport()) {
@@ -6474,6 +7511,41 @@ TEST_P(MetadataAccessObjectTest, MigrateToCurrentLibVersion) {
       metadata_access_object_container_->VerifyDbSchema(lib_version));
 }
 
+TEST_P(MetadataAccessObjectTest, OnlineMigrateToCurrentLibVersion) {
+  // Skip upgrade/downgrade migration tests for earlier schema version.
+  if (EarlierSchemaEnabled()) { return; }
+  const int64 lib_version = metadata_access_object_->GetLibraryVersion();
+  for (int64 i = metadata_access_object_container_->MinimumVersion();
+       i <= lib_version; i++) {
+    if (!metadata_access_object_container_->HasUpgradeVerification(i)) {
+      continue;
+    }
+    MLMD_ASSERT_OK(
+        metadata_access_object_container_->SetupPreviousVersionForUpgrade(i));
+  }
+
+  // each step of the backfills rewrites at most one row.
+  bool done = false;
+  while (!done) {
+    int64 db_version = 0;
+    MLMD_ASSERT_OK(metadata_access_object_->GetSchemaVersion(&db_version));
+    ASSERT_LE(db_version, lib_version);
+    MLMD_ASSERT_OK(metadata_access_object_->UpgradeMetadataSourceOnlineStep(
+        /*batch_size=*/1, &done));
+  }
+  // the database is at the library version, and needs no more migration.
+  MLMD_ASSERT_OK(metadata_access_object_->InitMetadataSourceIfNotExists());
+  int64 curr_version = 0;
+  MLMD_ASSERT_OK(metadata_access_object_->GetSchemaVersion(&curr_version));
+  ASSERT_EQ(lib_version, curr_version);
+  if (metadata_access_object_container_->HasUpgradeVerification(lib_version)) {
+    MLMD_ASSERT_OK(
+        metadata_access_object_container_->UpgradeVerification(lib_version));
+  }
+  MLMD_ASSERT_OK(
+      metadata_access_object_container_->VerifyDbSchema(lib_version));
+}
+
 TEST_P(MetadataAccessObjectTest, DowngradeToV0FromCurrentLibVersion) {
   // Skip upgrade/downgrade migration tests for earlier schema version.
   if (EarlierSchemaEnabled()) { return; }
@@ -0,0 +1,397 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_node_export.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google/protobuf/util/json_util.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+namespace {
+
+// The columns of the node fields, in the order of the CSV columns.
+constexpr const char* kArtifactColumns[] = {
+    "id",  "type_id", "type", "name", "uri", "state", "create_time_since_epoch",
+    "last_update_time_since_epoch"};
+constexpr const char* kExecutionColumns[] = {
+    "id", "type_id", "type", "name", "last_known_state",
+    "create_time_since_epoch", "last_update_time_since_epoch"};
+constexpr const char* kContextColumns[] = {
+    "id", "type_id", "type", "name", "create_time_since_epoch",
+    "last_update_time_since_epoch"};
+
+// A value of an exported row.
+struct Cell {
+  std::string column;
+  // The text of the value, e.g., "1.5", or the JSON object of a struct value.
+  std::string text;
+  // Whether the value is a string, which is quoted in NDJSON.
+  bool is_string;
+};
+
+void AppendJsonString(absl::string_view value, std::string* out) {
+  out->push_back('"');
+  for (const char c : value) {
+    switch (c) {
+      case '"':
+        out->append("\\\"");
+        break;
+      case '\\':
+        out->append("\\\\");
+        break;
+      case '\n':
+        out->append("\\n");
+        break;
+      case '\r':
+        out->append("\\r");
+        break;
+      case '\t':
+        out->append("\\t");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          absl::StrAppend(out, "\\u", absl::Hex(c, absl::kZeroPad4));
+        } else {
+          out->push_back(c);
+        }
+    }
+  }
+  out->push_back('"');
+}
+
+void AppendCsvField(absl::string_view value, std::string* out) {
+  if (value.find_first_of(",\"\r\n") == absl::string_view::npos) {
+    out->append(value.data(), value.size());
+    return;
+  }
+  out->push_back('"');
+  for (const char c : value) {
+    if (c == '"') out->push_back('"');
+    out->push_back(c);
+  }
+  out->push_back('"');
+}
+
+void AddInt(absl::string_view column, const int64 value,
+            std::vector<Cell>* row) {
+  row->push_back({std::string(column), absl::StrCat(value),
+                  /*is_string=*/false});
+}
+
+void AddString(absl::string_view column, absl::string_view value,
+               std::vector<Cell>* row) {
+  row->push_back({std::string(column), std::string(value),
+                  /*is_string=*/true});
+}
+
+// Adds the `value` of the property `column`, if it is set.
+// Returns INTERNAL error, if a struct value cannot be converted to JSON.
+absl::Status AddValue(absl::string_view column, const Value& value,
+                      std::vector<Cell>* row) {
+  switch (value.value_case()) {
+    case Value::kIntValue:
+      AddInt(column, value.int_value(), row);
+      break;
+    case Value::kDoubleValue:
+      if (std::isnan(value.double_value())) {
+        AddString(column, "NaN", row);
+      } else if (std::isinf(value.double_value())) {
+        AddString(column, value.double_value() > 0 ? "Infinity" : "-Infinity",
+                  row);
+      } else {
+        // 17 significant digits round-trip any double.
+        row->push_back({std::string(column),
+                        absl::StrFormat("%.17g", value.double_value()),
+                        /*is_string=*/false});
+      }
+      break;
+    case Value::kStringValue:
+      AddString(column, value.string_value(), row);
+      break;
+    case Value::kStructValue: {
+      std::string json;
+      if (!::google::protobuf::util::MessageToJsonString(value.struct_value(),
+                                                         &json)
+               .ok()) {
+        return absl::InternalError(
+            absl::StrCat("Cannot convert the struct value of ", column,
+                         " to JSON"));
+      }
+      row->push_back({std::string(column), std::move(json),
+                      /*is_string=*/false});
+      break;
+    }
+    case Value::kProtoValue:
+      // The proto values may be of any type, so they are not converted to
+      // JSON.
+      AddString(column,
+                absl::Base64Escape(value.proto_value().SerializeAsString()),
+                row);
+      break;
+    default:
+      break;
+  }
+  return absl::OkStatus();
+}
+
+// Adds the `properties` as the columns "<prefix>.<name>" in the name order.
+absl::Status AddProperties(
+    absl::string_view prefix,
+    const google::protobuf::Map<std::string, Value>& properties,
+    std::vector<Cell>* row) {
+  std::vector<absl::string_view> names;
+  names.reserve(properties.size());
+  for (const auto& property : properties) {
+    names.push_back(property.first);
+  }
+  std::sort(names.begin(), names.end());
+  for (const absl::string_view name : names) {
+    MLMD_RETURN_IF_ERROR(AddValue(absl::StrCat(prefix, ".", name),
+                                  properties.at(std::string(name)), row));
+  }
+  return absl::OkStatus();
+}
+
+// Adds the fields that only artifacts or executions have.
+void AddKindFields(const Artifact& artifact, std::vector<Cell>* row) {
+  if (artifact.has_uri()) AddString("uri", artifact.uri(), row);
+  if (artifact.has_state()) {
+    AddString("state", Artifact::State_Name(artifact.state()), row);
+  }
+}
+
+void AddKindFields(const Execution& execution, std::vector<Cell>* row) {
+  if (execution.has_last_known_state()) {
+    AddString("last_known_state",
+              Execution::State_Name(execution.last_known_state()), row);
+  }
+}
+
+void AddKindFields(const Context& context, std::vector<Cell>* row) {}
+
+// Sets `row` to the cells of `node`, whose type is named `type`.
+template <typename Node>
+absl::Status ToRow(const Node& node, absl::string_view type,
+                   std::vector<Cell>* row) {
+  row->clear();
+  AddInt("id", node.id(), row);
+  AddInt("type_id", node.type_id(), row);
+  if (!type.empty()) AddString("type", type, row);
+  if (node.has_name()) AddString("name", node.name(), row);
+  AddKindFields(node, row);
+  if (node.has_create_time_since_epoch()) {
+    AddInt("create_time_since_epoch", node.create_time_since_epoch(), row);
+  }
+  if (node.has_last_update_time_since_epoch()) {
+    AddInt("last_update_time_since_epoch",
+           node.last_update_time_since_epoch(), row);
+  }
+  MLMD_RETURN_IF_ERROR(AddProperties("properties", node.properties(), row));
+  return AddProperties("custom_properties", node.custom_properties(), row);
+}
+
+// Writes the rows to an output stream in a NodeExportFormat.
+class RowWriter {
+ public:
+  // For kCsv, the `columns` are the columns of the rows; the cells of other
+  // columns are ignored.
+  RowWriter(const NodeExportFormat format, std::vector<std::string> columns,
+            std::ostream* output)
+      : format_(format), columns_(std::move(columns)), output_(output) {
+    for (int i = 0; i < columns_.size(); i++) {
+      column_indices_[columns_[i]] = i;
+    }
+  }
+
+  // Appends the CSV header line to the buffer.
+  void AddHeader() {
+    if (format_ != NodeExportFormat::kCsv) return;
+    for (int i = 0; i < columns_.size(); i++) {
+      if (i > 0) buffer_.push_back(',');
+      AppendCsvField(columns_[i], &buffer_);
+    }
+    buffer_.push_back('\n');
+  }
+
+  // Appends the line of `row` to the buffer.
+  void AddRow(const std::vector<Cell>& row) {
+    if (format_ == NodeExportFormat::kNdjson) {
+      buffer_.push_back('{');
+      for (int i = 0; i < row.size(); i++) {
+        if (i > 0) buffer_.push_back(',');
+        AppendJsonString(row[i].column, &buffer_);
+        buffer_.push_back(':');
+        if (row[i].is_string) {
+          AppendJsonString(row[i].text, &buffer_);
+        } else {
+          buffer_.append(row[i].text);
+        }
+      }
+      buffer_.append("}\n");
+      return;
+    }
+    std::vector<absl::string_view> fields(columns_.size());
+    for (const Cell& cell : row) {
+      const auto it = column_indices_.find(cell.column);
+      if (it != column_indices_.end()) fields[it->second] = cell.text;
+    }
+    for (int i = 0; i < fields.size(); i++) {
+      if (i > 0) buffer_.push_back(',');
+      AppendCsvField(fields[i], &buffer_);
+    }
+    buffer_.push_back('\n');
+  }
+
+  // Writes the buffer to the output.
+  // Returns INTERNAL error, if the output cannot be written.
+  absl::Status Flush() {
+    output_->write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+    if (!*output_) {
+      return absl::InternalError("Cannot write the exported nodes");
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  const NodeExportFormat format_;
+  const std::vector<std::string> columns_;
+  absl::flat_hash_map<std::string, int> column_indices_;
+  std::ostream* const output_;
+  std::string buffer_;
+};
+
+// Exports the nodes listed by `list` of `store`, e.g., GetArtifacts, whose
+// types are listed by `get_types`, e.g., GetArtifactTypes.
+template <typename TypesRequest, typename TypesResponse, typename Type,
+          typename Request, typename Response, typename Node>
+absl::Status ExportNodesOfKind(
+    absl::Status (MetadataStore::*get_types)(const TypesRequest&,
+                                             TypesResponse*),
+    const google::protobuf::RepeatedPtrField<Type>& (
+        TypesResponse::*response_types)() const,
+    absl::Status (MetadataStore::*list)(const Request&, Response*),
+    const google::protobuf::RepeatedPtrField<Node>& (
+        Response::*response_nodes)() const,
+    absl::Span<const char* const> node_columns,
+    const NodeExportOptions& options, MetadataStore* store,
+    std::ostream* output) {
+  TypesResponse types_response;
+  MLMD_RETURN_IF_ERROR((store->*get_types)(TypesRequest(), &types_response));
+  absl::flat_hash_map<int64, std::string> type_names;
+  for (const Type& type : (types_response.*response_types)()) {
+    type_names[type.id()] = type.name();
+  }
+
+  std::vector<std::string> columns(node_columns.begin(), node_columns.end());
+  if (!options.headers_only) {
+    for (const std::string& name : options.property_names) {
+      columns.push_back(absl::StrCat("properties.", name));
+    }
+    for (const std::string& name : options.property_names) {
+      columns.push_back(absl::StrCat("custom_properties.", name));
+    }
+  }
+  RowWriter writer(options.format, std::move(columns), output);
+  writer.AddHeader();
+
+  Request request;
+  ListOperationOptions& list_options = *request.mutable_options();
+  list_options.set_max_result_size(options.page_size);
+  list_options.set_bulk_export(true);
+  list_options.mutable_order_by_field()->set_field(
+      ListOperationOptions::OrderByField::ID);
+  list_options.mutable_order_by_field()->set_is_asc(true);
+  if (!options.filter_query.empty()) {
+    list_options.set_filter_query(options.filter_query);
+  }
+  if (options.headers_only) {
+    list_options.mutable_property_projection()->set_headers_only(true);
+  } else {
+    for (const std::string& name : options.property_names) {
+      list_options.mutable_property_projection()->add_property_names(name);
+    }
+  }
+  std::vector<Cell> row;
+  while (true) {
+    Response response;
+    MLMD_RETURN_IF_ERROR((store->*list)(request, &response));
+    for (const Node& node : (response.*response_nodes)()) {
+      const auto it = type_names.find(node.type_id());
+      MLMD_RETURN_IF_ERROR(ToRow(
+          node, it == type_names.end() ? absl::string_view() : it->second,
+          &row));
+      writer.AddRow(row);
+    }
+    MLMD_RETURN_IF_ERROR(writer.Flush());
+    if (response.next_page_token().empty()) {
+      return absl::OkStatus();
+    }
+    list_options.set_next_page_token(response.next_page_token());
+  }
+}
+
+}  // namespace
+
+absl::Status ExportNodes(MetadataStore* store, const NodeExportOptions& options,
+                         std::ostream* output) {
+  if (options.page_size <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("page_size must be positive: ", options.page_size));
+  }
+  if (options.format == NodeExportFormat::kCsv &&
+      options.property_names.empty() && !options.headers_only) {
+    return absl::InvalidArgumentError(
+        "The CSV export needs the property_names, or headers_only.");
+  }
+  switch (options.node_kind) {
+    case ExportedNodeKind::kArtifact:
+      return ExportNodesOfKind(
+          &MetadataStore::GetArtifactTypes,
+          &GetArtifactTypesResponse::artifact_types,
+          &MetadataStore::GetArtifacts, &GetArtifactsResponse::artifacts,
+          kArtifactColumns, options, store, output);
+    case ExportedNodeKind::kExecution:
+      return ExportNodesOfKind(
+          &MetadataStore::GetExecutionTypes,
+          &GetExecutionTypesResponse::execution_types,
+          &MetadataStore::GetExecutions, &GetExecutionsResponse::executions,
+          kExecutionColumns, options, store, output);
+    case ExportedNodeKind::kContext:
+      return ExportNodesOfKind(
+          &MetadataStore::GetContextTypes,
+          &GetContextTypesResponse::context_types,
+          &MetadataStore::GetContexts, &GetContextsResponse::contexts,
+          kContextColumns, options, store, output);
+  }
+  return absl::InvalidArgumentError("Unknown node kind.");
+}
+
+}  // namespace ml_metadata
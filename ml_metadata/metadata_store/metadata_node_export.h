@@ -0,0 +1,76 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_METADATA_NODE_EXPORT_H_
+#define ML_METADATA_METADATA_STORE_METADATA_NODE_EXPORT_H_
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+
+namespace ml_metadata {
+
+// The kinds of the nodes exported by ExportNodes.
+enum class ExportedNodeKind { kArtifact, kExecution, kContext };
+
+// The file formats written by ExportNodes.
+enum class NodeExportFormat {
+  // One JSON object per line, e.g.,
+  //   {"id":1,"type_id":2,"type":"DataSet","uri":"/a","properties.span":3}
+  // The unset fields and properties are omitted.
+  kNdjson,
+  // A header line with the column names, and one line per node. The unset
+  // fields and properties are empty.
+  kCsv,
+};
+
+// Options of ExportNodes.
+struct NodeExportOptions {
+  ExportedNodeKind node_kind = ExportedNodeKind::kArtifact;
+  NodeExportFormat format = NodeExportFormat::kNdjson;
+  // A ListOperationOptions.filter_query selecting the exported nodes. All the
+  // nodes are exported if it is empty.
+  std::string filter_query;
+  // The names of the exported properties and custom properties. All of them
+  // are exported if it is empty. It must not be empty for kCsv, whose columns
+  // are fixed, unless `headers_only` is set.
+  std::vector<std::string> property_names;
+  // If true, the nodes are exported without their properties.
+  bool headers_only = false;
+  // The number of nodes listed in each transaction.
+  int page_size = 1000;
+};
+
+// Streams the nodes of `store` selected by `options` to `output`, one row per
+// node in the id order. The properties are flattened to the columns
+// "properties.<name>" and "custom_properties.<name>", and the type ids are
+// complemented with the type names in the column "type". Int and double
+// values are written as numbers, string values as strings, struct values as
+// JSON objects (JSON text in CSV), and proto values as the base64 strings of
+// the serialized google.protobuf.Any. The store is read one page at a time in
+// the bulk export mode with the property projection of `options`, so that
+// only the exported property values are read.
+// Returns INVALID_ARGUMENT error, if the `options` are invalid, e.g., the
+//   `filter_query` cannot be parsed.
+// Returns INTERNAL error, if the `output` cannot be written.
+// Returns detailed INTERNAL error, if the store cannot be read.
+absl::Status ExportNodes(MetadataStore* store, const NodeExportOptions& options,
+                         std::ostream* output);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_METADATA_NODE_EXPORT_H_
@@ -0,0 +1,164 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Exports the artifacts, executions or contexts of a metadata store to an
+// NDJSON or CSV file with flattened properties, e.g., to load them to an
+// analytics tool. See metadata_node_export.h for the file formats.
+//
+// Usage example:
+//
+//    bazel run -c opt //ml_metadata/metadata_store:metadata_node_export_tool --
+//        --connection_config_file=/path/to/mysql_config.pbtxt
+//        --node_kind=artifact --format=csv
+//        --filter_query="type = 'DataSet'" --property_names=span,split
+//        --output_file=/tmp/datasets.csv
+//
+// The connection config file is a text ConnectionConfig, e.g.,
+//    sqlite { filename_uri: "/tmp/mlmd.db" }
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include <glog/logging.h>
+#include "google/protobuf/io/zero_copy_stream_impl.h"
+#include "google/protobuf/text_format.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "ml_metadata/metadata_store/metadata_node_export.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+DEFINE_string(connection_config_file, "",
+              "The text ConnectionConfig of the metadata store to export.");
+DEFINE_string(node_kind, "artifact",
+              "The kind of the exported nodes: artifact, execution or "
+              "context.");
+DEFINE_string(format, "ndjson", "The output format: ndjson or csv.");
+DEFINE_string(filter_query, "",
+              "A ListOperationOptions.filter_query selecting the exported "
+              "nodes. All the nodes are exported if it is empty.");
+DEFINE_string(property_names, "",
+              "The comma-separated names of the exported properties and "
+              "custom properties. All of them are exported if it is empty.");
+DEFINE_bool(headers_only, false,
+            "If true, the nodes are exported without their properties.");
+DEFINE_int32(page_size, 1000,
+             "The number of nodes listed in each transaction.");
+DEFINE_string(output_file, "-",
+              "The file the nodes are exported to, or - for stdout.");
+
+namespace {
+
+// Parses the text ConnectionConfig of `filename` to `config`.
+// Returns INVALID_ARGUMENT error, if the file cannot be read or parsed.
+absl::Status ParseConnectionConfig(const std::string& filename,
+                                   ml_metadata::ConnectionConfig* config) {
+  std::ifstream input_file_stream(filename);
+  if (!input_file_stream) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Cannot open the connection config file ", filename));
+  }
+  google::protobuf::io::IstreamInputStream file_stream(&input_file_stream);
+  if (!google::protobuf::TextFormat::Parse(&file_stream, config)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Cannot parse the connection config file ", filename));
+  }
+  return absl::OkStatus();
+}
+
+// Sets `options` from the flags.
+// Returns INVALID_ARGUMENT error, if the node kind or the format is unknown.
+absl::Status ParseExportOptions(ml_metadata::NodeExportOptions* options) {
+  if ((FLAGS_node_kind) == "artifact") {
+    options->node_kind = ml_metadata::ExportedNodeKind::kArtifact;
+  } else if ((FLAGS_node_kind) == "execution") {
+    options->node_kind = ml_metadata::ExportedNodeKind::kExecution;
+  } else if ((FLAGS_node_kind) == "context") {
+    options->node_kind = ml_metadata::ExportedNodeKind::kContext;
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unknown node_kind: ", (FLAGS_node_kind)));
+  }
+  if ((FLAGS_format) == "ndjson") {
+    options->format = ml_metadata::NodeExportFormat::kNdjson;
+  } else if ((FLAGS_format) == "csv") {
+    options->format = ml_metadata::NodeExportFormat::kCsv;
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unknown format: ", (FLAGS_format)));
+  }
+  options->filter_query = (FLAGS_filter_query);
+  options->property_names =
+      absl::StrSplit((FLAGS_property_names), ',', absl::SkipEmpty());
+  options->headers_only = (FLAGS_headers_only);
+  options->page_size = (FLAGS_page_size);
+  return absl::OkStatus();
+}
+
+absl::Status Export(const ml_metadata::ConnectionConfig& config,
+                    const ml_metadata::NodeExportOptions& options,
+                    const std::string& filename) {
+  std::unique_ptr<ml_metadata::MetadataStore> store;
+  absl::Status status = ml_metadata::CreateMetadataStore(config, &store);
+  if (!status.ok()) {
+    return status;
+  }
+  if (filename == "-") {
+    status = ml_metadata::ExportNodes(store.get(), options, &std::cout);
+    std::cout.flush();
+    return status;
+  }
+  std::ofstream output(filename, std::ios::binary | std::ios::trunc);
+  if (!output) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Cannot open the output file ", filename));
+  }
+  status = ml_metadata::ExportNodes(store.get(), options, &output);
+  if (!status.ok()) {
+    return status;
+  }
+  output.close();
+  if (!output) {
+    return absl::InternalError(
+        absl::StrCat("Cannot write the output file ", filename));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  ml_metadata::ConnectionConfig config;
+  ml_metadata::NodeExportOptions options;
+  absl::Status status =
+      ParseConnectionConfig((FLAGS_connection_config_file), &config);
+  if (status.ok()) {
+    status = ParseExportOptions(&options);
+  }
+  if (status.ok()) {
+    status = Export(config, options, (FLAGS_output_file));
+  }
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,181 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_node_export.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/substitute.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+namespace testing {
+namespace {
+
+using ::testing::EndsWith;
+using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::SizeIs;
+using ::testing::StartsWith;
+
+class MetadataNodeExportTest : public ::testing::Test {
+ protected:
+  // Puts the artifacts a1 and a2 of the type DataSet.
+  void SetUp() override {
+    ConnectionConfig connection_config;
+    connection_config.mutable_fake_database();
+    ASSERT_EQ(absl::OkStatus(),
+              CreateMetadataStore(connection_config, &store_));
+    PutArtifactTypeResponse type_response;
+    ASSERT_EQ(absl::OkStatus(),
+              store_->PutArtifactType(
+                  ParseTextProtoOrDie<PutArtifactTypeRequest>(R"pb(
+                    artifact_type: {
+                      name: 'DataSet'
+                      properties { key: 'span' value: INT }
+                      properties { key: 'note' value: STRING }
+                    }
+                  )pb"),
+                  &type_response));
+    type_id_ = type_response.type_id();
+    PutArtifactsResponse artifacts_response;
+    ASSERT_EQ(absl::OkStatus(),
+              store_->PutArtifacts(
+                  ParseTextProtoOrDie<PutArtifactsRequest>(absl::Substitute(
+                      R"pb(
+                        artifacts: {
+                          type_id: $0
+                          name: 'a1'
+                          uri: '/a'
+                          state: LIVE
+                          properties {
+                            key: 'span'
+                            value: { int_value: 1 }
+                          }
+                          properties {
+                            key: 'note'
+                            value: { string_value: 'x,"y"' }
+                          }
+                          custom_properties {
+                            key: 'score'
+                            value: { double_value: 0.5 }
+                          }
+                        }
+                        artifacts: {
+                          type_id: $0
+                          uri: '/b'
+                          properties {
+                            key: 'span'
+                            value: { int_value: 2 }
+                          }
+                        }
+                      )pb",
+                      type_id_)),
+                  &artifacts_response));
+    a1_id_ = artifacts_response.artifact_ids(0);
+    a2_id_ = artifacts_response.artifact_ids(1);
+  }
+
+  std::unique_ptr<MetadataStore> store_;
+  int64 type_id_;
+  int64 a1_id_;
+  int64 a2_id_;
+};
+
+TEST_F(MetadataNodeExportTest, ExportArtifactsAsNdjson) {
+  NodeExportOptions options;
+  options.page_size = 1;
+  std::ostringstream output;
+  ASSERT_EQ(absl::OkStatus(), ExportNodes(store_.get(), options, &output));
+
+  const std::vector<std::string> lines =
+      absl::StrSplit(output.str(), '\n', absl::SkipEmpty());
+  ASSERT_THAT(lines, SizeIs(2));
+  EXPECT_THAT(lines[0],
+              StartsWith(absl::StrCat(
+                  "{\"id\":", a1_id_, ",\"type_id\":", type_id_,
+                  ",\"type\":\"DataSet\",\"name\":\"a1\",\"uri\":\"/a\","
+                  "\"state\":\"LIVE\",\"create_time_since_epoch\":")));
+  EXPECT_THAT(lines[0],
+              EndsWith(",\"properties.note\":\"x,\\\"y\\\"\","
+                       "\"properties.span\":1,"
+                       "\"custom_properties.score\":0.5}"));
+  EXPECT_THAT(lines[1],
+              StartsWith(absl::StrCat("{\"id\":", a2_id_, ",\"type_id\":",
+                                      type_id_,
+                                      ",\"type\":\"DataSet\",\"uri\":\"/b\",")));
+  EXPECT_THAT(lines[1], EndsWith(",\"properties.span\":2}"));
+}
+
+TEST_F(MetadataNodeExportTest, ExportFilteredArtifactsAsCsv) {
+  NodeExportOptions options;
+  options.format = NodeExportFormat::kCsv;
+  options.filter_query = "uri = '/a'";
+  options.property_names = {"note", "score"};
+  std::ostringstream output;
+  ASSERT_EQ(absl::OkStatus(), ExportNodes(store_.get(), options, &output));
+
+  const std::vector<std::string> lines =
+      absl::StrSplit(output.str(), '\n', absl::SkipEmpty());
+  ASSERT_THAT(lines, SizeIs(2));
+  EXPECT_EQ(lines[0],
+            "id,type_id,type,name,uri,state,create_time_since_epoch,"
+            "last_update_time_since_epoch,properties.note,properties.score,"
+            "custom_properties.note,custom_properties.score");
+  EXPECT_THAT(lines[1], StartsWith(absl::StrCat(a1_id_, ",", type_id_,
+                                                ",DataSet,a1,/a,LIVE,")));
+  EXPECT_THAT(lines[1], EndsWith(",\"x,\"\"y\"\"\",,,0.5"));
+}
+
+TEST_F(MetadataNodeExportTest, ExportHeadersOnly) {
+  NodeExportOptions options;
+  options.headers_only = true;
+  options.filter_query = "uri = '/b'";
+  std::ostringstream output;
+  ASSERT_EQ(absl::OkStatus(), ExportNodes(store_.get(), options, &output));
+  EXPECT_THAT(output.str(), Not(HasSubstr("properties")));
+  EXPECT_THAT(output.str(), StartsWith(absl::StrCat("{\"id\":", a2_id_)));
+}
+
+TEST_F(MetadataNodeExportTest, InvalidOptions) {
+  std::ostringstream output;
+  NodeExportOptions options;
+  options.page_size = 0;
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      ExportNodes(store_.get(), options, &output)));
+  options = NodeExportOptions();
+  options.format = NodeExportFormat::kCsv;
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      ExportNodes(store_.get(), options, &output)));
+  options = NodeExportOptions();
+  options.filter_query = "uri = ";
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      ExportNodes(store_.get(), options, &output)));
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace ml_metadata
@@ -0,0 +1,520 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_snapshot.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/io/coded_stream.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/util/return_utils.h"
+#include "zlib.h"
+
+namespace ml_metadata {
+namespace {
+
+// The upper bound of the serialized size of a chunk, to reject the malformed
+// sizes before allocating them.
+constexpr uint64_t kMaxChunkBytes = uint64_t{1} << 31;
+
+// The maximum size of a 64-bit varint.
+constexpr int kMaxVarint64Bytes = 10;
+
+// Returns the number of the types, nodes and edges of `chunk`.
+int NumItems(const MetadataSnapshotChunk& chunk) {
+  return chunk.artifact_types_size() + chunk.execution_types_size() +
+         chunk.context_types_size() + chunk.artifacts_size() +
+         chunk.executions_size() + chunk.contexts_size() +
+         chunk.events_size() + chunk.attributions_size() +
+         chunk.associations_size() + chunk.parent_contexts_size();
+}
+
+// Writes the chunks of a snapshot to an output stream.
+class SnapshotWriter {
+ public:
+  SnapshotWriter(const int chunk_size, std::ostream* output)
+      : chunk_size_(chunk_size), output_(output) {}
+
+  // The chunk being filled.
+  MetadataSnapshotChunk* chunk() { return &chunk_; }
+
+  // Writes the chunk if it has at least chunk_size items.
+  absl::Status MaybeFlush() {
+    return NumItems(chunk_) >= chunk_size_ ? Flush() : absl::OkStatus();
+  }
+
+  // Writes the chunk if it is not empty.
+  absl::Status Flush() {
+    if (NumItems(chunk_) == 0) {
+      return absl::OkStatus();
+    }
+    std::string serialized;
+    if (!chunk_.SerializeToString(&serialized)) {
+      return absl::InternalError("Cannot serialize a snapshot chunk");
+    }
+    chunk_.Clear();
+    uLongf compressed_size = compressBound(serialized.size());
+    std::string compressed(compressed_size, '\0');
+    if (compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressed_size,
+                  reinterpret_cast<const Bytef*>(serialized.data()),
+                  serialized.size(), Z_BEST_SPEED) != Z_OK) {
+      return absl::InternalError("Cannot compress a snapshot chunk");
+    }
+    uint8_t header[2 * kMaxVarint64Bytes];
+    uint8_t* header_end =
+        google::protobuf::io::CodedOutputStream::WriteVarint64ToArray(
+            serialized.size(), header);
+    header_end = google::protobuf::io::CodedOutputStream::WriteVarint64ToArray(
+        compressed_size, header_end);
+    output_->write(reinterpret_cast<const char*>(header), header_end - header);
+    output_->write(compressed.data(), compressed_size);
+    if (!*output_) {
+      return absl::InternalError("Cannot write the snapshot");
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  const int chunk_size_;
+  std::ostream* const output_;
+  MetadataSnapshotChunk chunk_;
+};
+
+// Reads a varint of `input` to `value`. `eof` is set if `input` ends before
+// the varint.
+// Returns DATA_LOSS error, if `input` ends within the varint.
+absl::Status ReadVarint(std::istream* input, uint64_t* value, bool* eof) {
+  *value = 0;
+  *eof = false;
+  for (int shift = 0; shift < 64; shift += 7) {
+    const int byte = input->get();
+    if (byte == std::istream::traits_type::eof()) {
+      if (shift == 0) {
+        *eof = true;
+        return absl::OkStatus();
+      }
+      break;
+    }
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return absl::OkStatus();
+    }
+  }
+  return absl::DataLossError("The snapshot has a malformed chunk size");
+}
+
+// Reads the next chunk of `input` to `chunk`. `eof` is set if `input` has no
+// more chunks.
+// Returns DATA_LOSS error, if the chunk is malformed.
+absl::Status ReadChunk(std::istream* input, MetadataSnapshotChunk* chunk,
+                       bool* eof) {
+  uint64_t serialized_size, compressed_size;
+  MLMD_RETURN_IF_ERROR(ReadVarint(input, &serialized_size, eof));
+  if (*eof) {
+    return absl::OkStatus();
+  }
+  bool truncated;
+  MLMD_RETURN_IF_ERROR(ReadVarint(input, &compressed_size, &truncated));
+  if (truncated || serialized_size > kMaxChunkBytes ||
+      compressed_size > compressBound(serialized_size)) {
+    return absl::DataLossError("The snapshot has a malformed chunk size");
+  }
+  std::string compressed(compressed_size, '\0');
+  input->read(&compressed[0], compressed_size);
+  if (static_cast<uint64_t>(input->gcount()) != compressed_size) {
+    return absl::DataLossError("The snapshot is truncated");
+  }
+  std::string serialized(serialized_size, '\0');
+  uLongf uncompressed_size = serialized_size;
+  if (uncompress(reinterpret_cast<Bytef*>(&serialized[0]), &uncompressed_size,
+                 reinterpret_cast<const Bytef*>(compressed.data()),
+                 compressed_size) != Z_OK ||
+      uncompressed_size != serialized_size ||
+      !chunk->ParseFromString(serialized)) {
+    return absl::DataLossError("The snapshot has a corrupted chunk");
+  }
+  return absl::OkStatus();
+}
+
+// Returns the options listing all the nodes in pages of `chunk_size` nodes.
+ListOperationOptions BulkExportOptions(const int chunk_size) {
+  ListOperationOptions options;
+  options.set_max_result_size(chunk_size);
+  options.set_bulk_export(true);
+  options.mutable_order_by_field()->set_field(
+      ListOperationOptions::OrderByField::ID);
+  options.mutable_order_by_field()->set_is_asc(true);
+  return options;
+}
+
+// Calls `list` of `store`, e.g., GetArtifacts, with `request` for each page,
+// and `on_page` with the response of each page.
+template <typename Request, typename Response, typename OnPage>
+absl::Status ListPages(Request request,
+                       absl::Status (MetadataStore::*list)(const Request&,
+                                                           Response*),
+                       MetadataStore* store, const OnPage& on_page) {
+  while (true) {
+    Response response;
+    MLMD_RETURN_IF_ERROR((store->*list)(request, &response));
+    MLMD_RETURN_IF_ERROR(on_page(&response));
+    if (response.next_page_token().empty()) {
+      return absl::OkStatus();
+    }
+    request.mutable_options()->set_next_page_token(
+        response.next_page_token());
+  }
+}
+
+// Exports the nodes listed by `list` of `store`, e.g., GetArtifacts, to the
+// `chunk_nodes` of the chunks of `writer`, and their ids to `ids`.
+template <typename Request, typename Response, typename Node>
+absl::Status ExportNodes(
+    const int chunk_size,
+    absl::Status (MetadataStore::*list)(const Request&, Response*),
+    google::protobuf::RepeatedPtrField<Node>* (Response::*response_nodes)(),
+    google::protobuf::RepeatedPtrField<Node>* (
+        MetadataSnapshotChunk::*chunk_nodes)(),
+    MetadataStore* store, SnapshotWriter* writer, std::vector<int64>* ids) {
+  Request request;
+  *request.mutable_options() = BulkExportOptions(chunk_size);
+  return ListPages(
+      request, list, store,
+      [writer, response_nodes, chunk_nodes,
+       ids](Response* response) -> absl::Status {
+        for (const Node& node : *(response->*response_nodes)()) {
+          ids->push_back(node.id());
+        }
+        (writer->chunk()->*chunk_nodes)()->Swap((response->*response_nodes)());
+        return writer->Flush();
+      });
+}
+
+// Sets `id` to the id its `old_id` is imported as in `ids`.
+// Returns DATA_LOSS error, if the `old_id` is not imported.
+absl::Status MapId(const absl::flat_hash_map<int64, int64>& ids,
+                   absl::string_view kind, const int64 old_id, int64* id) {
+  const auto it = ids.find(old_id);
+  if (it == ids.end()) {
+    return absl::DataLossError(absl::StrCat(
+        "The snapshot references ", kind, " ", old_id, " before it is defined"));
+  }
+  *id = it->second;
+  return absl::OkStatus();
+}
+
+// The ids of the imported types and nodes keyed by their ids in the snapshot.
+struct ImportedIds {
+  absl::flat_hash_map<int64, int64> artifact_types;
+  absl::flat_hash_map<int64, int64> execution_types;
+  absl::flat_hash_map<int64, int64> context_types;
+  absl::flat_hash_map<int64, int64> artifacts;
+  absl::flat_hash_map<int64, int64> executions;
+  absl::flat_hash_map<int64, int64> contexts;
+};
+
+// Records the `new_ids` of the `nodes` in `ids`.
+template <typename Node, typename NewIds>
+void AddImportedIds(const google::protobuf::RepeatedPtrField<Node>& old_nodes,
+                    const NewIds& new_ids,
+                    absl::flat_hash_map<int64, int64>* ids) {
+  for (int i = 0; i < old_nodes.size(); i++) {
+    (*ids)[old_nodes.Get(i).id()] = new_ids.Get(i);
+  }
+}
+
+// Prepares the `nodes` to be put as new nodes of the imported types.
+template <typename Node>
+absl::Status PrepareNodes(const absl::flat_hash_map<int64, int64>& type_ids,
+                          google::protobuf::RepeatedPtrField<Node>* nodes) {
+  for (Node& node : *nodes) {
+    int64 type_id;
+    MLMD_RETURN_IF_ERROR(MapId(type_ids, "type", node.type_id(), &type_id));
+    node.set_type_id(type_id);
+    node.clear_id();
+    node.clear_type();
+    node.clear_create_time_since_epoch();
+    node.clear_last_update_time_since_epoch();
+  }
+  return absl::OkStatus();
+}
+
+// Imports the types, nodes and edges of `chunk` to `store`, in this order.
+absl::Status ImportChunk(const MetadataSnapshotChunk& chunk, MetadataStore* store,
+                         ImportedIds* ids) {
+  if (chunk.artifact_types_size() > 0 || chunk.execution_types_size() > 0 ||
+      chunk.context_types_size() > 0) {
+    PutTypesRequest request;
+    *request.mutable_artifact_types() = chunk.artifact_types();
+    *request.mutable_execution_types() = chunk.execution_types();
+    *request.mutable_context_types() = chunk.context_types();
+    for (ArtifactType& type : *request.mutable_artifact_types()) {
+      type.clear_id();
+    }
+    for (ExecutionType& type : *request.mutable_execution_types()) {
+      type.clear_id();
+    }
+    for (ContextType& type : *request.mutable_context_types()) {
+      type.clear_id();
+    }
+    PutTypesResponse response;
+    MLMD_RETURN_IF_ERROR(store->PutTypes(request, &response));
+    AddImportedIds(chunk.artifact_types(), response.artifact_type_ids(),
+                   &ids->artifact_types);
+    AddImportedIds(chunk.execution_types(), response.execution_type_ids(),
+                   &ids->execution_types);
+    AddImportedIds(chunk.context_types(), response.context_type_ids(),
+                   &ids->context_types);
+  }
+  if (chunk.artifacts_size() > 0) {
+    PutArtifactsRequest request;
+    *request.mutable_artifacts() = chunk.artifacts();
+    MLMD_RETURN_IF_ERROR(
+        PrepareNodes(ids->artifact_types, request.mutable_artifacts()));
+    PutArtifactsResponse response;
+    MLMD_RETURN_IF_ERROR(store->PutArtifacts(request, &response));
+    AddImportedIds(chunk.artifacts(), response.artifact_ids(),
+                   &ids->artifacts);
+  }
+  if (chunk.executions_size() > 0) {
+    PutExecutionsRequest request;
+    *request.mutable_executions() = chunk.executions();
+    MLMD_RETURN_IF_ERROR(
+        PrepareNodes(ids->execution_types, request.mutable_executions()));
+    PutExecutionsResponse response;
+    MLMD_RETURN_IF_ERROR(store->PutExecutions(request, &response));
+    AddImportedIds(chunk.executions(), response.execution_ids(),
+                   &ids->executions);
+  }
+  if (chunk.contexts_size() > 0) {
+    PutContextsRequest request;
+    *request.mutable_contexts() = chunk.contexts();
+    MLMD_RETURN_IF_ERROR(
+        PrepareNodes(ids->context_types, request.mutable_contexts()));
+    PutContextsResponse response;
+    MLMD_RETURN_IF_ERROR(store->PutContexts(request, &response));
+    AddImportedIds(chunk.contexts(), response.context_ids(), &ids->contexts);
+  }
+  if (chunk.events_size() > 0) {
+    PutEventsRequest request;
+    for (const Event& old_event : chunk.events()) {
+      Event* event = request.add_events();
+      *event = old_event;
+      int64 artifact_id, execution_id;
+      MLMD_RETURN_IF_ERROR(MapId(ids->artifacts, "artifact",
+                                 old_event.artifact_id(), &artifact_id));
+      MLMD_RETURN_IF_ERROR(MapId(ids->executions, "execution",
+                                 old_event.execution_id(), &execution_id));
+      event->set_artifact_id(artifact_id);
+      event->set_execution_id(execution_id);
+    }
+    PutEventsResponse response;
+    MLMD_RETURN_IF_ERROR(store->PutEvents(request, &response));
+  }
+  if (chunk.attributions_size() > 0 || chunk.associations_size() > 0) {
+    PutAttributionsAndAssociationsRequest request;
+    for (const Attribution& old_attribution : chunk.attributions()) {
+      int64 artifact_id, context_id;
+      MLMD_RETURN_IF_ERROR(MapId(ids->artifacts, "artifact",
+                                 old_attribution.artifact_id(), &artifact_id));
+      MLMD_RETURN_IF_ERROR(MapId(ids->contexts, "context",
+                                 old_attribution.context_id(), &context_id));
+      Attribution* attribution = request.add_attributions();
+      attribution->set_artifact_id(artifact_id);
+      attribution->set_context_id(context_id);
+    }
+    for (const Association& old_association : chunk.associations()) {
+      int64 execution_id, context_id;
+      MLMD_RETURN_IF_ERROR(MapId(ids->executions, "execution",
+                                 old_association.execution_id(),
+                                 &execution_id));
+      MLMD_RETURN_IF_ERROR(MapId(ids->contexts, "context",
+                                 old_association.context_id(), &context_id));
+      Association* association = request.add_associations();
+      association->set_execution_id(execution_id);
+      association->set_context_id(context_id);
+    }
+    PutAttributionsAndAssociationsResponse response;
+    MLMD_RETURN_IF_ERROR(
+        store->PutAttributionsAndAssociations(request, &response));
+  }
+  if (chunk.parent_contexts_size() > 0) {
+    PutParentContextsRequest request;
+    for (const ParentContext& old_parent_context : chunk.parent_contexts()) {
+      int64 child_id, parent_id;
+      MLMD_RETURN_IF_ERROR(MapId(ids->contexts, "context",
+                                 old_parent_context.child_id(), &child_id));
+      MLMD_RETURN_IF_ERROR(MapId(ids->contexts, "context",
+                                 old_parent_context.parent_id(), &parent_id));
+      ParentContext* parent_context = request.add_parent_contexts();
+      parent_context->set_child_id(child_id);
+      parent_context->set_parent_id(parent_id);
+    }
+    PutParentContextsResponse response;
+    MLMD_RETURN_IF_ERROR(store->PutParentContexts(request, &response));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status ExportMetadataSnapshot(MetadataStore* store, const int chunk_size,
+                                    std::ostream* output) {
+  if (chunk_size <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("chunk_size must be positive: ", chunk_size));
+  }
+  output->write(kMetadataSnapshotMagic, std::strlen(kMetadataSnapshotMagic));
+  SnapshotWriter writer(chunk_size, output);
+
+  // The types are few, and are written in a single chunk.
+  GetArtifactTypesResponse artifact_types;
+  MLMD_RETURN_IF_ERROR(store->GetArtifactTypes({}, &artifact_types));
+  GetExecutionTypesResponse execution_types;
+  MLMD_RETURN_IF_ERROR(store->GetExecutionTypes({}, &execution_types));
+  GetContextTypesResponse context_types;
+  MLMD_RETURN_IF_ERROR(store->GetContextTypes({}, &context_types));
+  writer.chunk()->mutable_artifact_types()->Swap(
+      artifact_types.mutable_artifact_types());
+  writer.chunk()->mutable_execution_types()->Swap(
+      execution_types.mutable_execution_types());
+  writer.chunk()->mutable_context_types()->Swap(
+      context_types.mutable_context_types());
+  MLMD_RETURN_IF_ERROR(writer.Flush());
+
+  std::vector<int64> artifact_ids, execution_ids, context_ids;
+  MLMD_RETURN_IF_ERROR(ExportNodes(
+      chunk_size, &MetadataStore::GetArtifacts,
+      &GetArtifactsResponse::mutable_artifacts,
+      &MetadataSnapshotChunk::mutable_artifacts, store, &writer,
+      &artifact_ids));
+  MLMD_RETURN_IF_ERROR(ExportNodes(
+      chunk_size, &MetadataStore::GetExecutions,
+      &GetExecutionsResponse::mutable_executions,
+      &MetadataSnapshotChunk::mutable_executions, store, &writer,
+      &execution_ids));
+  MLMD_RETURN_IF_ERROR(ExportNodes(
+      chunk_size, &MetadataStore::GetContexts,
+      &GetContextsResponse::mutable_contexts,
+      &MetadataSnapshotChunk::mutable_contexts, store, &writer, &context_ids));
+
+  // Each event has a single artifact, so the events of the chunks of the
+  // artifacts are disjoint.
+  for (int i = 0; i < artifact_ids.size(); i += chunk_size) {
+    GetEventsByArtifactIDsRequest request;
+    for (int j = i; j < artifact_ids.size() && j < i + chunk_size; j++) {
+      request.add_artifact_ids(artifact_ids[j]);
+    }
+    GetEventsByArtifactIDsResponse response;
+    MLMD_RETURN_IF_ERROR(store->GetEventsByArtifactIDs(request, &response));
+    writer.chunk()->mutable_events()->Swap(response.mutable_events());
+    MLMD_RETURN_IF_ERROR(writer.Flush());
+  }
+
+  ListOperationOptions headers_only = BulkExportOptions(chunk_size);
+  headers_only.mutable_property_projection()->set_headers_only(true);
+  for (const int64 context_id : context_ids) {
+    GetArtifactsByContextRequest artifacts_request;
+    artifacts_request.set_context_id(context_id);
+    *artifacts_request.mutable_options() = headers_only;
+    MLMD_RETURN_IF_ERROR(ListPages(
+        artifacts_request, &MetadataStore::GetArtifactsByContext, store,
+        [&writer, context_id](
+            GetArtifactsByContextResponse* response) -> absl::Status {
+          for (const Artifact& artifact : response->artifacts()) {
+            Attribution* attribution = writer.chunk()->add_attributions();
+            attribution->set_artifact_id(artifact.id());
+            attribution->set_context_id(context_id);
+          }
+          return writer.MaybeFlush();
+        }));
+    GetExecutionsByContextRequest executions_request;
+    executions_request.set_context_id(context_id);
+    *executions_request.mutable_options() = headers_only;
+    MLMD_RETURN_IF_ERROR(ListPages(
+        executions_request, &MetadataStore::GetExecutionsByContext, store,
+        [&writer, context_id](
+            GetExecutionsByContextResponse* response) -> absl::Status {
+          for (const Execution& execution : response->executions()) {
+            Association* association = writer.chunk()->add_associations();
+            association->set_execution_id(execution.id());
+            association->set_context_id(context_id);
+          }
+          return writer.MaybeFlush();
+        }));
+    GetParentContextsByContextRequest parents_request;
+    parents_request.set_context_id(context_id);
+    GetParentContextsByContextResponse parents_response;
+    MLMD_RETURN_IF_ERROR(
+        store->GetParentContextsByContext(parents_request, &parents_response));
+    for (const Context& parent : parents_response.contexts()) {
+      ParentContext* parent_context = writer.chunk()->add_parent_contexts();
+      parent_context->set_child_id(context_id);
+      parent_context->set_parent_id(parent.id());
+    }
+    MLMD_RETURN_IF_ERROR(writer.MaybeFlush());
+  }
+  return writer.Flush();
+}
+
+absl::Status ImportMetadataSnapshot(std::istream* input,
+                                    MetadataStore* store) {
+  const size_t magic_size = std::strlen(kMetadataSnapshotMagic);
+  std::string magic(magic_size, '\0');
+  input->read(&magic[0], magic_size);
+  if (static_cast<size_t>(input->gcount()) != magic_size ||
+      magic != kMetadataSnapshotMagic) {
+    return absl::DataLossError("The input is not a metadata snapshot");
+  }
+  ImportedIds ids;
+  while (true) {
+    MetadataSnapshotChunk chunk;
+    bool eof;
+    MLMD_RETURN_IF_ERROR(ReadChunk(input, &chunk, &eof));
+    if (eof) {
+      return absl::OkStatus();
+    }
+    MLMD_RETURN_IF_ERROR(ImportChunk(chunk, store, &ids));
+  }
+}
+
+absl::Status ImportMetadataSnapshot(std::istream* input,
+                                    const ConnectionConfig& config) {
+  if (config.has_fake_database()) {
+    return absl::InvalidArgumentError(
+        "A snapshot cannot be imported to a fake database");
+  }
+  {
+    std::unique_ptr<MetadataStore> store;
+    MLMD_RETURN_IF_ERROR(
+        CreateMetadataStoreWithoutSecondaryIndices(config, &store));
+    MLMD_RETURN_IF_ERROR(ImportMetadataSnapshot(input, store.get()));
+  }
+  // Builds the secondary indices of a new database after the load.
+  std::unique_ptr<MetadataStore> store;
+  MLMD_RETURN_IF_ERROR(CreateMetadataStore(config, &store));
+  return store->InitMetadataStore();
+}
+
+}  // namespace ml_metadata
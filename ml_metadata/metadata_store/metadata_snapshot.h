@@ -0,0 +1,64 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_METADATA_SNAPSHOT_H_
+#define ML_METADATA_METADATA_STORE_METADATA_SNAPSHOT_H_
+
+#include <istream>
+#include <ostream>
+
+#include "absl/status/status.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// The bytes a metadata snapshot starts with. They are followed by the
+// MetadataSnapshotChunks, each of which is written as the varint of its
+// serialized size, the varint of its compressed size and its zlib-compressed
+// serialization.
+constexpr char kMetadataSnapshotMagic[] = "MLMDSNAPSHOT1";
+
+// Exports the types, nodes, events, attributions, associations and parent
+// contexts of `store` to `output` as a metadata snapshot, whose chunks have
+// about `chunk_size` nodes or edges. The store is read in many transactions,
+// so it should not be written during the export to get a consistent snapshot.
+// Returns INVALID_ARGUMENT error, if the `chunk_size` is not positive.
+// Returns INTERNAL error, if the `output` cannot be written.
+// Returns detailed INTERNAL error, if the store cannot be read.
+absl::Status ExportMetadataSnapshot(MetadataStore* store, int chunk_size,
+                                    std::ostream* output);
+
+// Imports the metadata snapshot of `input` to `store`, which is usually empty.
+// Each chunk is written with batched puts in its own transactions. The nodes
+// get new ids, and their edges are linked with the new ids. The create and
+// last update times of the nodes are the ones of the import.
+// Returns DATA_LOSS error, if the snapshot is malformed.
+// Returns ALREADY_EXISTS error, if a context or an edge of the snapshot is
+// already in the `store`.
+// Returns detailed INTERNAL error, if the store cannot be written.
+absl::Status ImportMetadataSnapshot(std::istream* input, MetadataStore* store);
+
+// Imports the metadata snapshot of `input` to the database of `config`, whose
+// secondary indices are built after the snapshot is loaded if the database is
+// new.
+// Returns INVALID_ARGUMENT error, if the `config` is a fake database, as each
+// store of it has its own database.
+// Returns the errors of ImportMetadataSnapshot above otherwise.
+absl::Status ImportMetadataSnapshot(std::istream* input,
+                                    const ConnectionConfig& config);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_METADATA_SNAPSHOT_H_
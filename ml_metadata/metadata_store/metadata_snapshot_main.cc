@@ -0,0 +1,132 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Exports a metadata store to a metadata snapshot file, or imports a snapshot
+// file to a metadata store, e.g., to clone or to restore a store, possibly on
+// another backend. See metadata_snapshot.h for the snapshot format.
+//
+// Usage example:
+//
+//    bazel run -c opt //ml_metadata/metadata_store:metadata_snapshot_tool --
+//        --connection_config_file=/path/to/mysql_config.pbtxt
+//        --export_file=/tmp/mlmd.snapshot
+//    bazel run -c opt //ml_metadata/metadata_store:metadata_snapshot_tool --
+//        --connection_config_file=/path/to/sqlite_config.pbtxt
+//        --import_file=/tmp/mlmd.snapshot
+//
+// The connection config file is a text ConnectionConfig, e.g.,
+//    sqlite { filename_uri: "/tmp/mlmd.db" }
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "gflags/gflags.h"
+#include <glog/logging.h>
+#include "google/protobuf/io/zero_copy_stream_impl.h"
+#include "google/protobuf/text_format.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/metadata_snapshot.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+DEFINE_string(connection_config_file, "",
+              "The text ConnectionConfig of the metadata store to export or "
+              "to import to.");
+DEFINE_string(export_file, "",
+              "If set, the metadata store is exported to this snapshot file.");
+DEFINE_string(import_file, "",
+              "If set, this snapshot file is imported to the metadata store, "
+              "which is usually a new database.");
+DEFINE_int32(chunk_size, 1000,
+             "The number of nodes or edges in each chunk of the export.");
+
+namespace {
+
+// Parses the text ConnectionConfig of `filename` to `config`.
+// Returns INVALID_ARGUMENT error, if the file cannot be read or parsed.
+absl::Status ParseConnectionConfig(const std::string& filename,
+                                   ml_metadata::ConnectionConfig* config) {
+  std::ifstream input_file_stream(filename);
+  if (!input_file_stream) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Cannot open the connection config file ", filename));
+  }
+  google::protobuf::io::IstreamInputStream file_stream(&input_file_stream);
+  if (!google::protobuf::TextFormat::Parse(&file_stream, config)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Cannot parse the connection config file ", filename));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Export(const ml_metadata::ConnectionConfig& config,
+                    const std::string& filename, const int chunk_size) {
+  std::unique_ptr<ml_metadata::MetadataStore> store;
+  absl::Status status = ml_metadata::CreateMetadataStore(config, &store);
+  if (!status.ok()) {
+    return status;
+  }
+  std::ofstream output(filename, std::ios::binary | std::ios::trunc);
+  if (!output) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Cannot open the export file ", filename));
+  }
+  status = ml_metadata::ExportMetadataSnapshot(store.get(), chunk_size,
+                                               &output);
+  if (!status.ok()) {
+    return status;
+  }
+  output.close();
+  if (!output) {
+    return absl::InternalError(
+        absl::StrCat("Cannot write the export file ", filename));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Import(const ml_metadata::ConnectionConfig& config,
+                    const std::string& filename) {
+  std::ifstream input(filename, std::ios::binary);
+  if (!input) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Cannot open the import file ", filename));
+  }
+  return ml_metadata::ImportMetadataSnapshot(&input, config);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  if ((FLAGS_export_file).empty() == (FLAGS_import_file).empty()) {
+    LOG(ERROR) << "Exactly one of export_file and import_file must be set.";
+    return 1;
+  }
+  ml_metadata::ConnectionConfig config;
+  absl::Status status =
+      ParseConnectionConfig((FLAGS_connection_config_file), &config);
+  if (status.ok()) {
+    status = (FLAGS_export_file).empty()
+                 ? Import(config, (FLAGS_import_file))
+                 : Export(config, (FLAGS_export_file), (FLAGS_chunk_size));
+  }
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,291 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_snapshot.h"
+
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/substitute.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+namespace testing {
+namespace {
+
+using ::testing::Pointwise;
+using ::testing::SizeIs;
+
+std::unique_ptr<MetadataStore> CreateFakeMetadataStore() {
+  ConnectionConfig connection_config;
+  connection_config.mutable_fake_database();
+  std::unique_ptr<MetadataStore> metadata_store;
+  CHECK_EQ(absl::OkStatus(),
+           CreateMetadataStore(connection_config, &metadata_store));
+  return metadata_store;
+}
+
+// Puts two artifacts, an execution with an input and an output event, and two
+// contexts to `store`, where the execution and its output are attributed to
+// the child context. The ids of the nodes do not start from 1.
+void PrepareStore(MetadataStore* store) {
+  PutTypesResponse types;
+  ASSERT_EQ(absl::OkStatus(),
+            store->PutTypes(ParseTextProtoOrDie<PutTypesRequest>(R"pb(
+                              artifact_types: {
+                                name: 'dataset'
+                                properties { key: 'split' value: STRING }
+                              }
+                              execution_types: { name: 'trainer' }
+                              context_types: { name: 'pipeline' }
+                            )pb"),
+                            &types));
+  PutArtifactsResponse deleted_artifact;
+  ASSERT_EQ(absl::OkStatus(),
+            store->PutArtifacts(
+                ParseTextProtoOrDie<PutArtifactsRequest>(absl::Substitute(
+                    "artifacts: { type_id: $0 uri: 'deleted' }",
+                    types.artifact_type_ids(0))),
+                &deleted_artifact));
+  DeleteArtifactsRequest delete_request;
+  delete_request.add_artifact_ids(deleted_artifact.artifact_ids(0));
+  DeleteArtifactsResponse delete_response;
+  ASSERT_EQ(absl::OkStatus(),
+            store->DeleteArtifacts(delete_request, &delete_response));
+
+  PutExecutionResponse execution;
+  ASSERT_EQ(
+      absl::OkStatus(),
+      store->PutExecution(
+          ParseTextProtoOrDie<PutExecutionRequest>(absl::Substitute(
+              R"pb(
+                execution: { type_id: $1 name: 'train' }
+                artifact_event_pairs: {
+                  artifact: {
+                    type_id: $0
+                    uri: 'in'
+                    properties { key: 'split' value: { string_value: 'a' } }
+                  }
+                  event: {
+                    type: INPUT
+                    path: { steps: { key: 'x' } steps: { index: 1 } }
+                    milliseconds_since_epoch: 12
+                  }
+                }
+                artifact_event_pairs: {
+                  artifact: {
+                    type_id: $0
+                    uri: 'out'
+                    custom_properties {
+                      key: 'score'
+                      value: { double_value: 0.5 }
+                    }
+                  }
+                  event: { type: OUTPUT milliseconds_since_epoch: 34 }
+                }
+                contexts: { type_id: $2 name: 'child' }
+              )pb",
+              types.artifact_type_ids(0), types.execution_type_ids(0),
+              types.context_type_ids(0))),
+          &execution));
+  PutContextsResponse parent;
+  ASSERT_EQ(absl::OkStatus(),
+            store->PutContexts(
+                ParseTextProtoOrDie<PutContextsRequest>(absl::Substitute(
+                    "contexts: { type_id: $0 name: 'parent' }",
+                    types.context_type_ids(0))),
+                &parent));
+  PutParentContextsRequest parent_contexts_request;
+  ParentContext* parent_context =
+      parent_contexts_request.add_parent_contexts();
+  parent_context->set_child_id(execution.context_ids(0));
+  parent_context->set_parent_id(parent.context_ids(0));
+  PutParentContextsResponse parent_contexts_response;
+  ASSERT_EQ(absl::OkStatus(), store->PutParentContexts(
+                                  parent_contexts_request,
+                                  &parent_contexts_response));
+}
+
+// Returns the ids of the nodes of `want` keyed by the ids of the nodes of
+// `got`, after checking that the nodes are the same except for their ids and
+// times.
+template <typename Node>
+absl::flat_hash_map<int64, int64> MatchNodes(
+    const google::protobuf::RepeatedPtrField<Node>& got,
+    const google::protobuf::RepeatedPtrField<Node>& want) {
+  const std::vector<std::string> ignore_fields = {
+      "id", "create_time_since_epoch", "last_update_time_since_epoch"};
+  EXPECT_THAT(got, Pointwise(EqualsProto<Node>(ignore_fields), want));
+  absl::flat_hash_map<int64, int64> ids;
+  for (int i = 0; i < got.size() && i < want.size(); i++) {
+    ids[want.Get(i).id()] = got.Get(i).id();
+  }
+  return ids;
+}
+
+TEST(MetadataSnapshotTest, ExportAndImport) {
+  std::unique_ptr<MetadataStore> source = CreateFakeMetadataStore();
+  PrepareStore(source.get());
+  std::stringstream snapshot;
+  ASSERT_EQ(absl::OkStatus(),
+            ExportMetadataSnapshot(source.get(), /*chunk_size=*/1, &snapshot));
+
+  std::unique_ptr<MetadataStore> target = CreateFakeMetadataStore();
+  ASSERT_EQ(absl::OkStatus(), ImportMetadataSnapshot(&snapshot, target.get()));
+
+  GetArtifactTypesResponse want_artifact_types, got_artifact_types;
+  ASSERT_EQ(absl::OkStatus(),
+            source->GetArtifactTypes({}, &want_artifact_types));
+  ASSERT_EQ(absl::OkStatus(),
+            target->GetArtifactTypes({}, &got_artifact_types));
+  MatchNodes(got_artifact_types.artifact_types(),
+             want_artifact_types.artifact_types());
+
+  GetArtifactsResponse want_artifacts, got_artifacts;
+  ASSERT_EQ(absl::OkStatus(), source->GetArtifacts({}, &want_artifacts));
+  ASSERT_EQ(absl::OkStatus(), target->GetArtifacts({}, &got_artifacts));
+  ASSERT_THAT(got_artifacts.artifacts(), SizeIs(2));
+  absl::flat_hash_map<int64, int64> artifact_ids =
+      MatchNodes(got_artifacts.artifacts(), want_artifacts.artifacts());
+  GetExecutionsResponse want_executions, got_executions;
+  ASSERT_EQ(absl::OkStatus(), source->GetExecutions({}, &want_executions));
+  ASSERT_EQ(absl::OkStatus(), target->GetExecutions({}, &got_executions));
+  absl::flat_hash_map<int64, int64> execution_ids =
+      MatchNodes(got_executions.executions(), want_executions.executions());
+  GetContextsResponse want_contexts, got_contexts;
+  ASSERT_EQ(absl::OkStatus(), source->GetContexts({}, &want_contexts));
+  ASSERT_EQ(absl::OkStatus(), target->GetContexts({}, &got_contexts));
+  ASSERT_THAT(got_contexts.contexts(), SizeIs(2));
+  MatchNodes(got_contexts.contexts(), want_contexts.contexts());
+
+  // The events are linked with the new ids.
+  GetEventsByExecutionIDsRequest want_events_request;
+  want_events_request.add_execution_ids(want_executions.executions(0).id());
+  GetEventsByExecutionIDsResponse want_events;
+  ASSERT_EQ(absl::OkStatus(), source->GetEventsByExecutionIDs(
+                                  want_events_request, &want_events));
+  for (Event& event : *want_events.mutable_events()) {
+    event.set_artifact_id(artifact_ids[event.artifact_id()]);
+    event.set_execution_id(execution_ids[event.execution_id()]);
+  }
+  GetEventsByExecutionIDsRequest got_events_request;
+  got_events_request.add_execution_ids(got_executions.executions(0).id());
+  GetEventsByExecutionIDsResponse got_events;
+  ASSERT_EQ(absl::OkStatus(), target->GetEventsByExecutionIDs(
+                                  got_events_request, &got_events));
+  EXPECT_THAT(got_events.events(),
+              Pointwise(EqualsProto<Event>(), want_events.events()));
+
+  // The attributions, associations and parent contexts are linked with the
+  // new ids.
+  int64 child_id = -1;
+  for (const Context& context : got_contexts.contexts()) {
+    if (context.name() == "child") {
+      child_id = context.id();
+    }
+  }
+  GetArtifactsByContextRequest artifacts_by_context_request;
+  artifacts_by_context_request.set_context_id(child_id);
+  GetArtifactsByContextResponse artifacts_by_context;
+  ASSERT_EQ(absl::OkStatus(),
+            target->GetArtifactsByContext(artifacts_by_context_request,
+                                          &artifacts_by_context));
+  ASSERT_THAT(artifacts_by_context.artifacts(), SizeIs(2));
+  GetExecutionsByContextRequest executions_by_context_request;
+  executions_by_context_request.set_context_id(child_id);
+  GetExecutionsByContextResponse executions_by_context;
+  ASSERT_EQ(absl::OkStatus(),
+            target->GetExecutionsByContext(executions_by_context_request,
+                                           &executions_by_context));
+  ASSERT_THAT(executions_by_context.executions(), SizeIs(1));
+  EXPECT_EQ(executions_by_context.executions(0).name(), "train");
+  GetParentContextsByContextRequest parents_request;
+  parents_request.set_context_id(child_id);
+  GetParentContextsByContextResponse parents;
+  ASSERT_EQ(absl::OkStatus(),
+            target->GetParentContextsByContext(parents_request, &parents));
+  ASSERT_THAT(parents.contexts(), SizeIs(1));
+  EXPECT_EQ(parents.contexts(0).name(), "parent");
+}
+
+TEST(MetadataSnapshotTest, ImportToConnectionConfig) {
+  std::unique_ptr<MetadataStore> source = CreateFakeMetadataStore();
+  PrepareStore(source.get());
+  std::stringstream snapshot;
+  ASSERT_EQ(absl::OkStatus(), ExportMetadataSnapshot(source.get(),
+                                                     /*chunk_size=*/100,
+                                                     &snapshot));
+
+  ConnectionConfig config;
+  config.mutable_sqlite()->set_filename_uri(
+      absl::StrCat(::testing::TempDir(), "/metadata_snapshot_test.db"));
+  std::remove(config.sqlite().filename_uri().c_str());
+  ASSERT_EQ(absl::OkStatus(), ImportMetadataSnapshot(&snapshot, config));
+
+  std::unique_ptr<MetadataStore> target;
+  ASSERT_EQ(absl::OkStatus(), CreateMetadataStore(config, &target));
+  GetArtifactsResponse artifacts;
+  ASSERT_EQ(absl::OkStatus(), target->GetArtifacts({}, &artifacts));
+  EXPECT_THAT(artifacts.artifacts(), SizeIs(2));
+
+  ConnectionConfig fake_config;
+  fake_config.mutable_fake_database();
+  std::stringstream empty_snapshot;
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      ImportMetadataSnapshot(&empty_snapshot, fake_config)));
+}
+
+TEST(MetadataSnapshotTest, ImportMalformedSnapshot) {
+  std::unique_ptr<MetadataStore> source = CreateFakeMetadataStore();
+  PrepareStore(source.get());
+  std::stringstream snapshot;
+  ASSERT_EQ(absl::OkStatus(),
+            ExportMetadataSnapshot(source.get(), /*chunk_size=*/1, &snapshot));
+  const std::string bytes = snapshot.str();
+
+  std::stringstream not_snapshot("not a snapshot");
+  EXPECT_TRUE(absl::IsDataLoss(
+      ImportMetadataSnapshot(&not_snapshot, CreateFakeMetadataStore().get())));
+  std::stringstream truncated(bytes.substr(0, bytes.size() - 1));
+  EXPECT_TRUE(absl::IsDataLoss(
+      ImportMetadataSnapshot(&truncated, CreateFakeMetadataStore().get())));
+  std::string corrupted = bytes;
+  corrupted.back() ^= 0xff;
+  std::stringstream corrupted_snapshot(corrupted);
+  EXPECT_TRUE(absl::IsDataLoss(ImportMetadataSnapshot(
+      &corrupted_snapshot, CreateFakeMetadataStore().get())));
+}
+
+TEST(MetadataSnapshotTest, ExportInvalidChunkSize) {
+  std::unique_ptr<MetadataStore> source = CreateFakeMetadataStore();
+  std::stringstream snapshot;
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      ExportMetadataSnapshot(source.get(), /*chunk_size=*/0, &snapshot)));
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace ml_metadata
@@ -14,10 +14,42 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_source.h"
 
+#include <initializer_list>
+#include <utility>
+
 #include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/record_set_util.h"
+#include "ml_metadata/metadata_store/trace_span.h"
 #include "ml_metadata/util/return_utils.h"
 
 namespace ml_metadata {
+namespace {
+
+// Returns true if the statement `query` starts with one of the `keywords`,
+// ignoring the case and the leading whitespace.
+bool StartsWithKeyword(absl::string_view query,
+                       std::initializer_list<absl::string_view> keywords) {
+  const absl::string_view statement = absl::StripLeadingAsciiWhitespace(query);
+  for (const absl::string_view keyword : keywords) {
+    if (absl::StartsWithIgnoreCase(statement, keyword)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if the statement `query` inserts, updates or deletes rows.
+bool IsWriteStatement(absl::string_view query) {
+  return StartsWithKeyword(query, {"INSERT", "UPDATE", "DELETE", "REPLACE"});
+}
+
+}  // namespace
 
 absl::Status MetadataSource::Connect() {
   if (is_connected_)
@@ -39,12 +71,80 @@ absl::Status MetadataSource::Close() {
 }
 
 absl::Status MetadataSource::ExecuteQuery(const std::string& query,
-                                          RecordSet* results) {
+                                          RecordSet* results,
+                                          absl::string_view query_name) {
   if (!is_connected_)
     return absl::FailedPreconditionError("No opened connection for querying.");
   if (!transaction_open_)
     return absl::FailedPreconditionError("Transaction not open.");
-  return ExecuteQueryImpl(query, results);
+  MLMD_RETURN_IF_ERROR(CheckCancellation());
+  if (!RecordsQueries()) {
+    return QueryStatus(ExecuteQueryImpl(query, results));
+  }
+  const absl::Time start = absl::Now();
+  return QueryStatus(RecordQuery(query_name, query, /*parameters=*/{}, start,
+                                 results, ExecuteQueryImpl(query, results)));
+}
+
+absl::Status MetadataSource::ExecutePreparedQuery(
+    const std::string& query, absl::Span<const Value> parameters,
+    RecordSet* results, const RecordSetLayout layout,
+    absl::string_view query_name) {
+  if (!is_connected_)
+    return absl::FailedPreconditionError("No opened connection for querying.");
+  if (!transaction_open_)
+    return absl::FailedPreconditionError("Transaction not open.");
+  MLMD_RETURN_IF_ERROR(CheckCancellation());
+  if (!RecordsQueries()) {
+    return QueryStatus(
+        ExecutePreparedQueryImpl(query, parameters, results, layout));
+  }
+  const absl::Time start = absl::Now();
+  return QueryStatus(RecordQuery(
+      query_name, query, parameters, start, results,
+      ExecutePreparedQueryImpl(query, parameters, results, layout)));
+}
+
+absl::Status MetadataSource::ExecuteQueries(
+    const absl::Span<const std::string> queries,
+    const absl::Span<RecordSet* const> results,
+    const absl::Span<const absl::string_view> query_names) {
+  if (results.size() != queries.size() ||
+      (!query_names.empty() && query_names.size() != queries.size())) {
+    return absl::InvalidArgumentError(
+        "The queries, results and query names of a batch differ in size.");
+  }
+  if (!SupportsQueryPipelining()) {
+    for (int i = 0; i < queries.size(); i++) {
+      MLMD_RETURN_IF_ERROR(ExecuteQuery(
+          queries[i], results[i], query_names.empty() ? "" : query_names[i]));
+    }
+    return absl::OkStatus();
+  }
+  if (!is_connected_)
+    return absl::FailedPreconditionError("No opened connection for querying.");
+  if (!transaction_open_)
+    return absl::FailedPreconditionError("Transaction not open.");
+  if (queries.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_RETURN_IF_ERROR(CheckCancellation());
+  if (!RecordsQueries()) {
+    return QueryStatus(ExecuteQueriesImpl(queries, results));
+  }
+  const absl::Time start = absl::Now();
+  const absl::Status status = ExecuteQueriesImpl(queries, results);
+  absl::Status recorded_status = status;
+  for (int i = 0; i < queries.size(); i++) {
+    const absl::Status query_status =
+        RecordQuery(query_names.empty() ? "" : query_names[i], queries[i],
+                    /*parameters=*/{}, start, results[i], status,
+                    queries.size());
+    if (recorded_status.ok()) {
+      recorded_status = query_status;
+    }
+  }
+  return QueryStatus(recorded_status);
 }
 
 absl::Status MetadataSource::Begin() {
@@ -52,8 +152,26 @@ absl::Status MetadataSource::Begin() {
     return absl::FailedPreconditionError("No opened connection for querying.");
   if (transaction_open_)
     return absl::FailedPreconditionError("Transaction already open.");
-  MLMD_RETURN_IF_ERROR(BeginImpl());
+  MLMD_RETURN_IF_ERROR(CheckCancellation());
+  const absl::Time start = absl::Now();
+  MLMD_RETURN_IF_ERROR(
+      RecordTransaction(TransactionOperation::kBegin, start, BeginImpl()));
   transaction_open_ = true;
+  ++num_transactions_begun_;
+  return absl::OkStatus();
+}
+
+absl::Status MetadataSource::BeginReadOnly() {
+  if (!is_connected_)
+    return absl::FailedPreconditionError("No opened connection for querying.");
+  if (transaction_open_)
+    return absl::FailedPreconditionError("Transaction already open.");
+  MLMD_RETURN_IF_ERROR(CheckCancellation());
+  const absl::Time start = absl::Now();
+  MLMD_RETURN_IF_ERROR(RecordTransaction(TransactionOperation::kBegin, start,
+                                         BeginReadOnlyImpl()));
+  transaction_open_ = true;
+  ++num_transactions_begun_;
   return absl::OkStatus();
 }
 
@@ -63,8 +181,11 @@ absl::Status MetadataSource::Commit() {
     return absl::FailedPreconditionError("No opened connection for querying.");
   if (!transaction_open_)
     return absl::FailedPreconditionError("Transaction not open.");
-  MLMD_RETURN_IF_ERROR(CommitImpl());
+  const absl::Time start = absl::Now();
+  MLMD_RETURN_IF_ERROR(
+      RecordTransaction(TransactionOperation::kCommit, start, CommitImpl()));
   transaction_open_ = false;
+  last_committed_transaction_ = num_transactions_begun_;
   return absl::OkStatus();
 }
 
@@ -73,9 +194,151 @@ absl::Status MetadataSource::Rollback() {
     return absl::FailedPreconditionError("No opened connection for querying.");
   if (!transaction_open_)
     return absl::FailedPreconditionError("Transaction not open.");
-  MLMD_RETURN_IF_ERROR(RollbackImpl());
+  const absl::Time start = absl::Now();
+  MLMD_RETURN_IF_ERROR(RecordTransaction(TransactionOperation::kRollback,
+                                         start, RollbackImpl()));
   transaction_open_ = false;
   return absl::OkStatus();
 }
 
+void MetadataSource::AppendEscapedString(absl::string_view value,
+                                         std::string* out) const {
+  absl::StrAppend(out, EscapeString(value));
+}
+
+absl::Status MetadataSource::CheckConnection() {
+  if (!is_connected_)
+    return absl::FailedPreconditionError("No opened connection for checking.");
+  return CheckConnectionImpl();
+}
+
+absl::Status MetadataSource::CheckCancellation() const {
+  return cancellation_token_ == nullptr ? absl::OkStatus()
+                                        : cancellation_token_->Check();
+}
+
+absl::Status MetadataSource::QueryStatus(absl::Status status) const {
+  if (status.ok() || cancellation_token_ == nullptr) {
+    return status;
+  }
+  const absl::Status cancellation_status = cancellation_token_->Check();
+  return cancellation_status.ok() ? status : cancellation_status;
+}
+
+absl::Status MetadataSource::RecordQuery(
+    absl::string_view query_name, const std::string& query,
+    const absl::Span<const Value> parameters, const absl::Time start,
+    const RecordSet* results, absl::Status status, const int batch_size) {
+  const absl::Duration latency = absl::Now() - start;
+  int64 num_rows = 0;
+  int64 num_bytes = 0;
+  if (status.ok() && results != nullptr) {
+    num_rows = NumRows(*results);
+    num_bytes = results->ByteSizeLong();
+  }
+  if (instrumentation_ != nullptr) {
+    instrumentation_->OnQuery(query_name, latency, num_rows, num_bytes,
+                              status);
+  }
+  {
+    ScopedTraceSpan span("MetadataSource::ExecuteQuery", start);
+    if (span.recording()) {
+      span.AddAttribute("mlmd.query_name", query_name);
+      span.AddAttribute("mlmd.num_rows", num_rows);
+      if (batch_size > 1) {
+        span.AddAttribute("mlmd.batch_size", batch_size);
+      }
+      span.SetStatus(status);
+    }
+  }
+  if (transaction_stats_ != nullptr) {
+    transaction_stats_->set_num_statements(
+        transaction_stats_->num_statements() + 1);
+    transaction_stats_->set_num_rows_read(transaction_stats_->num_rows_read() +
+                                          num_rows);
+    if (status.ok() && IsWriteStatement(query)) {
+      transaction_stats_->set_num_rows_written(
+          transaction_stats_->num_rows_written() + NumRowsChangedImpl());
+    }
+    transaction_stats_->set_database_time_us(
+        transaction_stats_->database_time_us() +
+        absl::ToInt64Microseconds(latency / batch_size));
+  }
+  if (slow_query_log_ != nullptr && latency >= slow_query_log_->threshold()) {
+    RecordSlowQuery(query_name, query, parameters, latency, num_rows, status);
+  }
+  if (memory_account_ != nullptr && status.ok()) {
+    status = memory_account_->Charge(num_bytes);
+  }
+  return status;
+}
+
+void MetadataSource::RecordSlowQuery(absl::string_view query_name,
+                                     const std::string& query,
+                                     const absl::Span<const Value> parameters,
+                                     const absl::Duration latency,
+                                     const int64 num_rows,
+                                     const absl::Status& status) {
+  SlowQuery slow_query;
+  slow_query.query = query;
+  if (!parameters.empty()) {
+    absl::StrAppend(&slow_query.query, " -- parameters: ",
+                    absl::StrJoin(parameters, ", ",
+                                  [](std::string* out, const Value& value) {
+                                    out->append(value.ShortDebugString());
+                                  }));
+  }
+  slow_query.query_name = std::string(query_name);
+  slow_query.origin = query_origin_;
+  slow_query.latency = latency;
+  slow_query.num_rows = num_rows;
+  slow_query.status = status;
+  // Only the text queries that read are explained, as explaining a write may
+  // run it again on some backends, and the prepared queries have no text the
+  // database can plan without their parameters.
+  if (status.ok() && parameters.empty() && CheckCancellation().ok() &&
+      StartsWithKeyword(query, {"SELECT", "WITH"}) &&
+      slow_query_log_->ShouldExplain()) {
+    RecordSet plan;
+    const absl::Status explain_status = ExplainQueryImpl(query, &plan);
+    slow_query.plan =
+        explain_status.ok()
+            ? FormatQueryPlan(plan)
+            : absl::StrCat("Failed to explain the query: ",
+                           explain_status.message());
+  }
+  slow_query_log_->Record(std::move(slow_query));
+}
+
+absl::Status MetadataSource::RecordTransaction(
+    const TransactionOperation operation, const absl::Time start,
+    absl::Status status) {
+  const absl::Duration latency = absl::Now() - start;
+  if (instrumentation_ != nullptr) {
+    instrumentation_->OnTransaction(operation, latency, status);
+  }
+  {
+    ScopedTraceSpan span("MetadataSource::Transaction", start);
+    span.AddAttribute("mlmd.transaction_operation",
+                      TransactionOperationName(operation));
+    span.SetStatus(status);
+  }
+  if (transaction_stats_ != nullptr) {
+    if (operation == TransactionOperation::kCommit) {
+      transaction_stats_->set_commit_time_us(
+          transaction_stats_->commit_time_us() +
+          absl::ToInt64Microseconds(latency));
+    } else {
+      transaction_stats_->set_database_time_us(
+          transaction_stats_->database_time_us() +
+          absl::ToInt64Microseconds(latency));
+    }
+    if (operation == TransactionOperation::kBegin && status.ok()) {
+      transaction_stats_->set_num_transactions(
+          transaction_stats_->num_transactions() + 1);
+    }
+  }
+  return status;
+}
+
 }  // namespace ml_metadata
@@ -18,13 +18,33 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/call_memory_account.h"
+#include "ml_metadata/metadata_store/cancellation_token.h"
+#include "ml_metadata/metadata_store/metadata_source_instrumentation.h"
+#include "ml_metadata/metadata_store/slow_query_log.h"
+#include "ml_metadata/metadata_store/trace_span.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
 
 namespace ml_metadata {
 
+// The layout of the results of a prepared query.
+enum class RecordSetLayout {
+  // The values are returned as strings in RecordSet.records.
+  kRecords,
+  // The values are returned as typed RecordSet.columns (see
+  // record_set_util.h), which avoids converting numbers to strings.
+  kTypedColumns,
+};
+
 // The base class for all metadata data sources. It provides an interface used
 // by MetadataAccessObject. Each concrete MetadataSource provides a physical
 // backend to persist and query metadata. An implementation of MetadataSource
@@ -77,17 +97,81 @@ class MetadataSource {
   // setting is_auto_comit to false; then the caller is responsible to
   // call Commit and Rollback respectively after multiple ExecuteQuery.
   //
-  // Results are consist of zero or more rows represented in RecordSet.
+  // Results are consist of zero or more rows represented in RecordSet. The
+  // optional `query_name` attributes the query to a template query in the
+  // instrumentation, e.g., "select_artifact_by_id".
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
   // Returns detailed INTERNAL error, if query execution fails.
   // Returns FAILED_PRECONDITION error, if a transaction has not begun.
-  absl::Status ExecuteQuery(const std::string& query, RecordSet* results);
+  // Returns CANCELLED or DEADLINE_EXCEEDED error, if the call of the
+  // cancellation_token() is cancelled or past its deadline.
+  absl::Status ExecuteQuery(const std::string& query, RecordSet* results,
+                            absl::string_view query_name = "");
+
+  // Runs a single statement `query` having `?` placeholders as a prepared
+  // statement, and binds the `parameters` to the placeholders in order. A
+  // parameter without any field set is bound as NULL, and struct values are
+  // not supported. The prepared statement is cached by the metadata source
+  // until the connection is closed, so that the statement is parsed once for
+  // each distinct `query`. The results are returned in the given `layout`.
+  // The optional `query_name` is as in ExecuteQuery.
+  //
+  // Results are consist of zero or more rows represented in RecordSet.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns FAILED_PRECONDITION error, if a transaction has not begun.
+  // Returns UNIMPLEMENTED error, if the metadata source does not support
+  // prepared statements.
+  // Returns INVALID_ARGUMENT error, if the number of `parameters` does not
+  // match the placeholders.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status ExecutePreparedQuery(
+      const std::string& query, absl::Span<const Value> parameters,
+      RecordSet* results, RecordSetLayout layout = RecordSetLayout::kRecords,
+      absl::string_view query_name = "");
+
+  // Returns true if ExecutePreparedQuery is supported and enabled for the
+  // metadata source.
+  virtual bool SupportsPreparedStatements() const { return false; }
+
+  // Runs a batch of independent `queries` in order, and returns the rows of
+  // each query in the `results` of the same index, which may be nullptr. If
+  // the metadata source pipelines queries, the batch is sent in a single round
+  // trip, and the queries after a failed one are not executed. Otherwise the
+  // queries are run one by one as ExecuteQuery. The optional `query_names` are
+  // as in ExecuteQuery, and a pipelined query is reported with the latency of
+  // the batch.
+  // Returns INVALID_ARGUMENT error, if the sizes of the arguments differ.
+  // Returns the errors of ExecuteQuery otherwise.
+  absl::Status ExecuteQueries(absl::Span<const std::string> queries,
+                              absl::Span<RecordSet* const> results,
+                              absl::Span<const absl::string_view> query_names =
+                                  {});
+
+  // Returns true if ExecuteQueries sends a batch in a single round trip.
+  virtual bool SupportsQueryPipelining() const { return false; }
+
+  // Returns the id generated by the last insert statement of the connection,
+  // as the backend reports it with the result of the statement, so that the
+  // callers do not need another query to select it.
+  // Returns absl::nullopt, if the connection is not opened, or if the backend
+  // does not report the id, in which case the callers select it.
+  absl::optional<int64> LastInsertId() {
+    return is_connected_ ? LastInsertIdImpl() : absl::nullopt;
+  }
 
   // Begins (opens) a transaction.
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
   // Returns FAILED_PRECONDITION error, if a transaction has already begun.
+  // Returns CANCELLED or DEADLINE_EXCEEDED error, if the call of the
+  // cancellation_token() is cancelled or past its deadline.
   absl::Status Begin();
 
+  // Begins (opens) a transaction, in which only queries reading the database
+  // are executed. The backend may skip the bookkeeping of writes, e.g., MySQL
+  // allocates no transaction id and reads a consistent snapshot.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns FAILED_PRECONDITION error, if a transaction has already begun.
+  absl::Status BeginReadOnly();
 
   // Commits a transaction.
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
@@ -102,13 +186,107 @@ class MetadataSource {
   // Returns FAILED_PRECONDITION error, if a transaction has not begun.
   absl::Status Rollback();
 
+  // Checks whether the opened connection is still usable, e.g., the server
+  // has not closed it due to inactivity.
+  // Returns FAILED_PRECONDITION error, if Connection() is not opened.
+  // Returns UNAVAILABLE error, if the backend cannot be reached.
+  absl::Status CheckConnection();
+
   // Utility method to escape characters specific to the metadata source. The
   // returned string is used to bind text parameters for query composition. The
   // escaping characters and method depends on the metadata source backend.
   virtual std::string EscapeString(absl::string_view value) const = 0;
 
+  // Appends `value` escaped as by EscapeString to `out`. Backends can escape
+  // into `out` in place, without a copy of the escaped string.
+  virtual void AppendEscapedString(absl::string_view value,
+                                   std::string* out) const;
+
   bool is_connected() const { return is_connected_; }
 
+  // Returns the number of transactions begun on the metadata source. While a
+  // transaction is open, the number identifies the transaction.
+  int64 num_transactions_begun() const { return num_transactions_begun_; }
+
+  // Returns the number of the last transaction committed on the metadata
+  // source, as returned by num_transactions_begun() while it was open, or 0 if
+  // none has been committed.
+  int64 last_committed_transaction() const {
+    return last_committed_transaction_;
+  }
+
+  // Sets the hooks called after each query and transaction operation. The
+  // `instrumentation` is not owned, and must outlast the metadata source;
+  // nullptr disables the instrumentation. By default, it is the one returned
+  // by GetDefaultMetadataSourceInstrumentation() at creation.
+  void set_instrumentation(MetadataSourceInstrumentation* instrumentation) {
+    instrumentation_ = instrumentation;
+  }
+
+  MetadataSourceInstrumentation* instrumentation() const {
+    return instrumentation_;
+  }
+
+  // Sets the log of the queries slower than its threshold. The
+  // `slow_query_log` is not owned, and must outlast the metadata source;
+  // nullptr disables the log. By default, it is the one returned by
+  // GetDefaultSlowQueryLog() at creation.
+  void set_slow_query_log(SlowQueryLog* slow_query_log) {
+    slow_query_log_ = slow_query_log;
+  }
+
+  SlowQueryLog* slow_query_log() const { return slow_query_log_; }
+
+  // Sets the call issuing the queries, e.g., an RPC and its filter, which is
+  // reported with the slow queries. An empty `origin` unsets it.
+  void set_query_origin(std::string origin) {
+    query_origin_ = std::move(origin);
+  }
+
+  const std::string& query_origin() const { return query_origin_; }
+
+  // Sets the statistics of the call running the transactions, which the
+  // transactions and queries started afterwards add to. The `stats` are not
+  // owned, and must outlast their use; nullptr unsets them.
+  void set_transaction_stats(TransactionStats* stats) {
+    transaction_stats_ = stats;
+  }
+
+  TransactionStats* transaction_stats() const { return transaction_stats_; }
+
+  // Sets the token of the call running the transactions, e.g., of an RPC.
+  // Once the call is cancelled or its deadline has passed, no query or
+  // transaction is started, and the failed queries return the error of the
+  // token; the backend may also bound the execution time of the queries by
+  // the deadline. The `token` is not owned, and must outlast its use; nullptr
+  // unsets it.
+  void set_cancellation_token(const CancellationToken* token) {
+    cancellation_token_ = token;
+  }
+
+  const CancellationToken* cancellation_token() const {
+    return cancellation_token_;
+  }
+
+  // Sets the memory account of the call running the transactions, e.g., of
+  // an RPC, which is charged the serialized size of the results of the
+  // queries started afterwards. A query whose results exceed the hard limit
+  // of the account returns its RESOURCE_EXHAUSTED error. The `account` is not
+  // owned, and must outlast its use; nullptr unsets it.
+  void set_memory_account(CallMemoryAccount* account) {
+    memory_account_ = account;
+  }
+
+  CallMemoryAccount* memory_account() const { return memory_account_; }
+
+  // Interrupts the query running on the connection, if any, e.g., once the
+  // client of the call has gone away. Unlike the other methods, it is called
+  // from another thread than the one running the query, and it must not race
+  // with Connect() or Close().
+  // Returns detailed errors of the backend, if the query cannot be
+  // interrupted.
+  absl::Status CancelQuery() { return CancelQueryImpl(); }
+
  protected:
   bool transaction_open() const { return transaction_open_; }
 
@@ -127,9 +305,28 @@ class MetadataSource {
   virtual absl::Status ExecuteQueryImpl(const std::string& query,
                                         RecordSet* results) = 0;
 
+  // Implementation of executing prepared queries.
+  virtual absl::Status ExecutePreparedQueryImpl(
+      const std::string& query, absl::Span<const Value> parameters,
+      RecordSet* results, RecordSetLayout layout) {
+    return absl::UnimplementedError(
+        "Prepared statements are not supported by the metadata source.");
+  }
+
+  // Implementation of executing a batch of queries in a single round trip. It
+  // is only called if SupportsQueryPipelining().
+  virtual absl::Status ExecuteQueriesImpl(absl::Span<const std::string> queries,
+                                          absl::Span<RecordSet* const> results) {
+    return absl::UnimplementedError(
+        "Query pipelining is not supported by the metadata source.");
+  }
+
   // Implementation of opening a transaction.
   virtual absl::Status BeginImpl() = 0;
 
+  // Implementation of opening a read-only transaction. Backends without a
+  // cheaper read-only transaction can keep the default.
+  virtual absl::Status BeginReadOnlyImpl() { return BeginImpl(); }
 
   // Implementation of a transaction commit.
   virtual absl::Status CommitImpl() = 0;
@@ -137,8 +334,88 @@ class MetadataSource {
   // Implementation of a transaction rollback.
   virtual absl::Status RollbackImpl() = 0;
 
+  // Implementation of returning the plan of the read `query` in `plan`, e.g.,
+  // by `EXPLAIN`, which is captured for a sample of the slow queries. It is
+  // run in the transaction of the query. Backends without query plans can
+  // keep the default.
+  virtual absl::Status ExplainQueryImpl(const std::string& query,
+                                        RecordSet* plan) {
+    return absl::UnimplementedError(
+        "Query plans are not supported by the metadata source.");
+  }
+
+  // Returns the number of rows inserted, updated or deleted by the last
+  // statement, which is only called after a statement changing the rows.
+  // Backends without the count can keep the default.
+  virtual int64 NumRowsChangedImpl() { return 0; }
+
+  // Returns the id generated by the last insert statement, as reported by the
+  // client library of the backend without a query. Backends without it can
+  // keep the default.
+  virtual absl::optional<int64> LastInsertIdImpl() { return absl::nullopt; }
+
+  // Implementation of the connection health check. Backends that cannot lose
+  // an opened connection, e.g., embedded databases, can keep the default.
+  virtual absl::Status CheckConnectionImpl() { return absl::OkStatus(); }
+
+  // Implementation of interrupting the running query. Backends whose queries
+  // cannot be interrupted can keep the default.
+  virtual absl::Status CancelQueryImpl() { return absl::OkStatus(); }
+
+  // Returns the error of the `cancellation_token_`, if any, so that a call
+  // cancelled or past its deadline does not start more work.
+  absl::Status CheckCancellation() const;
+
+  // Returns the error of the `cancellation_token_` instead of the error of a
+  // failed query, as the query may have failed by being interrupted.
+  absl::Status QueryStatus(absl::Status status) const;
+
+  // Returns true if the queries are timed for the instrumentation, the slow
+  // query log, the transaction stats or the trace of the call, or charged to
+  // the memory account.
+  bool RecordsQueries() const {
+    return instrumentation_ != nullptr || slow_query_log_ != nullptr ||
+           transaction_stats_ != nullptr || memory_account_ != nullptr ||
+           IsTracing();
+  }
+
+  // Reports the `query` bound to the `parameters`, if any, started at `start`
+  // to the instrumentation, the slow query log, the transaction stats and the
+  // trace of the call, as a span annotated with the `query_name`, and
+  // charges its results to the memory account, if any. The query is one of a
+  // batch of `batch_size` queries sent together.
+  // Returns `status`, or the error of the memory account if its hard limit is
+  // exceeded.
+  absl::Status RecordQuery(absl::string_view query_name,
+                           const std::string& query,
+                           absl::Span<const Value> parameters,
+                           absl::Time start, const RecordSet* results,
+                           absl::Status status, int batch_size = 1);
+
+  // Logs the slow `query` to the slow query log, and captures its plan if it
+  // is sampled.
+  void RecordSlowQuery(absl::string_view query_name, const std::string& query,
+                       absl::Span<const Value> parameters,
+                       absl::Duration latency, int64 num_rows,
+                       const absl::Status& status);
+
+  // Reports a transaction operation started at `start` to the
+  // instrumentation, the transaction stats and the trace of the call, if any,
+  // and returns `status`.
+  absl::Status RecordTransaction(TransactionOperation operation,
+                                 absl::Time start, absl::Status status);
+
+  MetadataSourceInstrumentation* instrumentation_ =
+      GetDefaultMetadataSourceInstrumentation();
+  SlowQueryLog* slow_query_log_ = GetDefaultSlowQueryLog();
+  std::string query_origin_;
+  TransactionStats* transaction_stats_ = nullptr;
+  const CancellationToken* cancellation_token_ = nullptr;
+  CallMemoryAccount* memory_account_ = nullptr;
   bool is_connected_ = false;
   bool transaction_open_ = false;
+  int64 num_transactions_begun_ = 0;
+  int64 last_committed_transaction_ = 0;
 };
 
 }  // namespace ml_metadata
@@ -0,0 +1,48 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_source_instrumentation.h"
+
+#include <atomic>
+
+namespace ml_metadata {
+namespace {
+
+std::atomic<MetadataSourceInstrumentation*> default_instrumentation{nullptr};
+
+}  // namespace
+
+absl::string_view TransactionOperationName(
+    const TransactionOperation operation) {
+  switch (operation) {
+    case TransactionOperation::kBegin:
+      return "begin";
+    case TransactionOperation::kCommit:
+      return "commit";
+    case TransactionOperation::kRollback:
+      return "rollback";
+  }
+  return "unknown";
+}
+
+MetadataSourceInstrumentation* GetDefaultMetadataSourceInstrumentation() {
+  return default_instrumentation.load(std::memory_order_acquire);
+}
+
+void SetDefaultMetadataSourceInstrumentation(
+    MetadataSourceInstrumentation* instrumentation) {
+  default_instrumentation.store(instrumentation, std::memory_order_release);
+}
+
+}  // namespace ml_metadata
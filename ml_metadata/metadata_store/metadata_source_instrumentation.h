@@ -0,0 +1,73 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_METADATA_SOURCE_INSTRUMENTATION_H_
+#define ML_METADATA_METADATA_STORE_METADATA_SOURCE_INSTRUMENTATION_H_
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/types.h"
+
+namespace ml_metadata {
+
+// The transaction operations of a MetadataSource.
+enum class TransactionOperation { kBegin, kCommit, kRollback };
+
+// Returns the name of `operation`, e.g., "commit".
+absl::string_view TransactionOperationName(TransactionOperation operation);
+
+// Hooks called by a MetadataSource after each query and transaction operation,
+// and by the server after each call with a memory account, e.g., to record
+// latency histograms. The hooks are called from every thread using a metadata
+// source, so implementations must be thread-safe and cheap.
+class MetadataSourceInstrumentation {
+ public:
+  virtual ~MetadataSourceInstrumentation() = default;
+
+  // Called after a query is executed. `query_name` is the name of the
+  // MetadataSourceQueryConfig template query, e.g., "select_artifact_by_id",
+  // or empty if the query is not a template query. `num_rows` and `num_bytes`
+  // are the number of rows and the serialized size of the results, which are
+  // zero if the results are not requested or the query fails.
+  virtual void OnQuery(absl::string_view query_name, absl::Duration latency,
+                       int64 num_rows, int64 num_bytes,
+                       const absl::Status& status) = 0;
+
+  // Called after a transaction is begun, committed or rolled back.
+  virtual void OnTransaction(TransactionOperation operation,
+                             absl::Duration latency,
+                             const absl::Status& status) = 0;
+
+  // Called after a call of `method`, e.g., "GetLineageGraph", whose queries
+  // are charged to a CallMemoryAccount. `peak_bytes` are the bytes charged to
+  // the account, and `hard_limit_exceeded` is true if the call failed by
+  // exceeding its hard limit.
+  virtual void OnCallMemory(absl::string_view method, int64 peak_bytes,
+                            bool hard_limit_exceeded) {}
+};
+
+// Returns the instrumentation given to the metadata sources when they are
+// created, or nullptr if the metadata sources are not instrumented.
+MetadataSourceInstrumentation* GetDefaultMetadataSourceInstrumentation();
+
+// Sets the instrumentation given to the metadata sources created afterwards.
+// The `instrumentation` is not owned, and must outlast the metadata sources;
+// nullptr disables the instrumentation of new metadata sources.
+void SetDefaultMetadataSourceInstrumentation(
+    MetadataSourceInstrumentation* instrumentation);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_METADATA_SOURCE_INSTRUMENTATION_H_
@@ -0,0 +1,244 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_source_metrics.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ml_metadata {
+namespace {
+
+// The name the queries that are not template queries are attributed to.
+constexpr char kAdhocQueryName[] = "adhoc";
+
+constexpr TransactionOperation kTransactionOperations[] = {
+    TransactionOperation::kBegin, TransactionOperation::kCommit,
+    TransactionOperation::kRollback};
+
+void Observe(const absl::Duration latency, const absl::Status& status,
+             MetadataSourceMetrics::LatencyHistogram* histogram) {
+  const double seconds = absl::ToDoubleSeconds(latency);
+  for (int i = 0; i < MetadataSourceMetrics::kLatencyBucketBounds.size();
+       i++) {
+    if (seconds <= MetadataSourceMetrics::kLatencyBucketBounds[i]) {
+      histogram->bucket_counts[i]++;
+    }
+  }
+  histogram->bucket_counts.back()++;
+  histogram->sum_seconds += seconds;
+  if (!status.ok()) {
+    histogram->num_errors++;
+  }
+}
+
+// Appends the samples of the histogram `name` with the `label`, e.g.,
+// `query="select_artifact_by_id"`, to `out`.
+void AppendHistogram(absl::string_view name, absl::string_view label,
+                     const MetadataSourceMetrics::LatencyHistogram& histogram,
+                     std::string* out) {
+  for (int i = 0; i < MetadataSourceMetrics::kLatencyBucketBounds.size();
+       i++) {
+    absl::StrAppend(out, name, "_bucket{", label, ",le=\"",
+                    MetadataSourceMetrics::kLatencyBucketBounds[i], "\"} ",
+                    histogram.bucket_counts[i], "\n");
+  }
+  absl::StrAppend(out, name, "_bucket{", label, ",le=\"+Inf\"} ",
+                  histogram.bucket_counts.back(), "\n");
+  absl::StrAppend(out, name, "_sum{", label, "} ", histogram.sum_seconds,
+                  "\n");
+  absl::StrAppend(out, name, "_count{", label, "} ",
+                  histogram.bucket_counts.back(), "\n");
+}
+
+void AppendHeader(absl::string_view name, absl::string_view type,
+                  absl::string_view help, std::string* out) {
+  absl::StrAppend(out, "# HELP ", name, " ", help, "\n");
+  absl::StrAppend(out, "# TYPE ", name, " ", type, "\n");
+}
+
+}  // namespace
+
+void MetadataSourceMetrics::OnQuery(absl::string_view query_name,
+                                    const absl::Duration latency,
+                                    const int64 num_rows, const int64 num_bytes,
+                                    const absl::Status& status) {
+  if (query_name.empty()) {
+    query_name = kAdhocQueryName;
+  }
+  absl::MutexLock lock(&mu_);
+  auto it = query_metrics_.find(query_name);
+  if (it == query_metrics_.end()) {
+    it = query_metrics_.emplace(std::string(query_name), QueryMetrics()).first;
+  }
+  Observe(latency, status, &it->second.latency);
+  it->second.num_rows += num_rows;
+  it->second.num_bytes += num_bytes;
+}
+
+void MetadataSourceMetrics::OnTransaction(const TransactionOperation operation,
+                                          const absl::Duration latency,
+                                          const absl::Status& status) {
+  absl::MutexLock lock(&mu_);
+  Observe(latency, status,
+          &transaction_latency_[static_cast<int>(operation)]);
+}
+
+void MetadataSourceMetrics::OnCallMemory(absl::string_view method,
+                                         const int64 peak_bytes,
+                                         const bool hard_limit_exceeded) {
+  absl::MutexLock lock(&mu_);
+  auto it = call_memory_.find(method);
+  if (it == call_memory_.end()) {
+    it = call_memory_.emplace(std::string(method), CallMemoryHistogram())
+             .first;
+  }
+  CallMemoryHistogram& histogram = it->second;
+  for (int i = 0; i < kMemoryBucketBounds.size(); i++) {
+    if (peak_bytes <= kMemoryBucketBounds[i]) {
+      histogram.bucket_counts[i]++;
+    }
+  }
+  histogram.bucket_counts.back()++;
+  histogram.sum_bytes += peak_bytes;
+  if (hard_limit_exceeded) {
+    histogram.num_exhausted++;
+  }
+}
+
+MetadataSourceMetrics::QueryMetrics MetadataSourceMetrics::GetQueryMetrics(
+    absl::string_view query_name) const {
+  absl::MutexLock lock(&mu_);
+  const auto it = query_metrics_.find(query_name);
+  return it == query_metrics_.end() ? QueryMetrics() : it->second;
+}
+
+MetadataSourceMetrics::LatencyHistogram
+MetadataSourceMetrics::GetTransactionLatency(
+    const TransactionOperation operation) const {
+  absl::MutexLock lock(&mu_);
+  return transaction_latency_[static_cast<int>(operation)];
+}
+
+MetadataSourceMetrics::CallMemoryHistogram MetadataSourceMetrics::GetCallMemory(
+    absl::string_view method) const {
+  absl::MutexLock lock(&mu_);
+  const auto it = call_memory_.find(method);
+  return it == call_memory_.end() ? CallMemoryHistogram() : it->second;
+}
+
+std::string MetadataSourceMetrics::ToPrometheusText() const {
+  absl::MutexLock lock(&mu_);
+  std::string out;
+  AppendHeader("mlmd_query_latency_seconds", "histogram",
+               "Latency of the metadata source queries.", &out);
+  for (const auto& entry : query_metrics_) {
+    AppendHistogram("mlmd_query_latency_seconds",
+                    absl::StrCat("query=\"", entry.first, "\""),
+                    entry.second.latency, &out);
+  }
+  AppendHeader("mlmd_query_errors_total", "counter",
+               "Number of the failed metadata source queries.", &out);
+  for (const auto& entry : query_metrics_) {
+    absl::StrAppend(&out, "mlmd_query_errors_total{query=\"", entry.first,
+                    "\"} ", entry.second.latency.num_errors, "\n");
+  }
+  AppendHeader("mlmd_query_rows_total", "counter",
+               "Number of the rows returned by the metadata source queries.",
+               &out);
+  for (const auto& entry : query_metrics_) {
+    absl::StrAppend(&out, "mlmd_query_rows_total{query=\"", entry.first,
+                    "\"} ", entry.second.num_rows, "\n");
+  }
+  AppendHeader("mlmd_query_bytes_total", "counter",
+               "Serialized size of the results of the metadata source "
+               "queries.",
+               &out);
+  for (const auto& entry : query_metrics_) {
+    absl::StrAppend(&out, "mlmd_query_bytes_total{query=\"", entry.first,
+                    "\"} ", entry.second.num_bytes, "\n");
+  }
+  AppendHeader("mlmd_transaction_latency_seconds", "histogram",
+               "Latency of the metadata source transaction operations.", &out);
+  for (const TransactionOperation operation : kTransactionOperations) {
+    AppendHistogram(
+        "mlmd_transaction_latency_seconds",
+        absl::StrCat("operation=\"", TransactionOperationName(operation),
+                     "\""),
+        transaction_latency_[static_cast<int>(operation)], &out);
+  }
+  AppendHeader("mlmd_transaction_errors_total", "counter",
+               "Number of the failed metadata source transaction operations.",
+               &out);
+  for (const TransactionOperation operation : kTransactionOperations) {
+    absl::StrAppend(&out, "mlmd_transaction_errors_total{operation=\"",
+                    TransactionOperationName(operation), "\"} ",
+                    transaction_latency_[static_cast<int>(operation)]
+                        .num_errors,
+                    "\n");
+  }
+  AppendHeader("mlmd_call_peak_memory_bytes", "histogram",
+               "Bytes of the query results read by the calls with a memory "
+               "account.",
+               &out);
+  for (const auto& entry : call_memory_) {
+    for (int i = 0; i < kMemoryBucketBounds.size(); i++) {
+      absl::StrAppend(&out, "mlmd_call_peak_memory_bytes_bucket{method=\"",
+                      entry.first, "\",le=\"", kMemoryBucketBounds[i],
+                      "\"} ", entry.second.bucket_counts[i], "\n");
+    }
+    absl::StrAppend(&out, "mlmd_call_peak_memory_bytes_bucket{method=\"",
+                    entry.first, "\",le=\"+Inf\"} ",
+                    entry.second.bucket_counts.back(), "\n");
+    absl::StrAppend(&out, "mlmd_call_peak_memory_bytes_sum{method=\"",
+                    entry.first, "\"} ", entry.second.sum_bytes, "\n");
+    absl::StrAppend(&out, "mlmd_call_peak_memory_bytes_count{method=\"",
+                    entry.first, "\"} ", entry.second.bucket_counts.back(),
+                    "\n");
+  }
+  AppendHeader("mlmd_call_memory_exhausted_total", "counter",
+               "Number of the calls failed by exceeding their hard memory "
+               "limit.",
+               &out);
+  for (const auto& entry : call_memory_) {
+    absl::StrAppend(&out, "mlmd_call_memory_exhausted_total{method=\"",
+                    entry.first, "\"} ", entry.second.num_exhausted, "\n");
+  }
+  return out;
+}
+
+absl::Status MetadataSourceMetrics::WritePrometheusTextFile(
+    const std::string& filename) const {
+  const std::string temp_filename = absl::StrCat(filename, ".tmp");
+  {
+    std::ofstream output(temp_filename, std::ios::trunc);
+    output << ToPrometheusText();
+    output.close();
+    if (!output) {
+      return absl::InternalError(
+          absl::StrCat("Cannot write the metrics to ", temp_filename));
+    }
+  }
+  if (std::rename(temp_filename.c_str(), filename.c_str()) != 0) {
+    return absl::InternalError(absl::StrCat(
+        "Cannot rename ", temp_filename, " to ", filename));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace ml_metadata
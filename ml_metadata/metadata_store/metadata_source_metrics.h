@@ -0,0 +1,134 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_METADATA_SOURCE_METRICS_H_
+#define ML_METADATA_METADATA_STORE_METADATA_SOURCE_METRICS_H_
+
+#include <array>
+#include <map>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_source_instrumentation.h"
+#include "ml_metadata/metadata_store/types.h"
+
+namespace ml_metadata {
+
+// A MetadataSourceInstrumentation keeping the latency histograms, and the
+// counts of errors, rows and bytes of the queries of each template query, and
+// the latency histograms of the transaction operations, in memory. The
+// metrics are exported in the Prometheus text exposition format. The queries
+// that are not template queries are attributed to "adhoc". It is thread-safe.
+//
+// Usage example:
+//
+//    MetadataSourceMetrics metrics;
+//    SetDefaultMetadataSourceInstrumentation(&metrics);
+//    // creates and uses metadata stores.
+//    MLMD_RETURN_IF_ERROR(metrics.WritePrometheusTextFile(path));
+class MetadataSourceMetrics : public MetadataSourceInstrumentation {
+ public:
+  // The upper bounds in seconds of the latency histogram buckets, excluding
+  // the implicit +Inf bucket.
+  static constexpr std::array<double, 16> kLatencyBucketBounds = {
+      0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+      0.05,   0.1,     0.25,   0.5,   1,      2.5,   5,     10};
+
+  // The cumulative latency histogram of a query or transaction operation.
+  struct LatencyHistogram {
+    // `bucket_counts[i]` is the number of calls within
+    // `kLatencyBucketBounds[i]`; the last one counts every call.
+    std::array<int64, kLatencyBucketBounds.size() + 1> bucket_counts = {};
+    double sum_seconds = 0;
+    int64 num_errors = 0;
+  };
+
+  // The metrics of the queries of a template query.
+  struct QueryMetrics {
+    LatencyHistogram latency;
+    int64 num_rows = 0;
+    int64 num_bytes = 0;
+  };
+
+  // The upper bounds in bytes of the peak memory histogram buckets of the
+  // calls, excluding the implicit +Inf bucket.
+  static constexpr std::array<int64, 8> kMemoryBucketBounds = {
+      1 << 16, 1 << 18, 1 << 20, 1 << 22, 1 << 24, 1 << 26, 1 << 28, 1 << 30};
+
+  // The cumulative peak memory histogram of the calls of a method.
+  struct CallMemoryHistogram {
+    // `bucket_counts[i]` is the number of calls within
+    // `kMemoryBucketBounds[i]`; the last one counts every call.
+    std::array<int64, kMemoryBucketBounds.size() + 1> bucket_counts = {};
+    int64 sum_bytes = 0;
+    // The number of calls failing by exceeding the hard memory limit.
+    int64 num_exhausted = 0;
+  };
+
+  MetadataSourceMetrics() = default;
+
+  // Disallows copy.
+  MetadataSourceMetrics(const MetadataSourceMetrics&) = delete;
+  MetadataSourceMetrics& operator=(const MetadataSourceMetrics&) = delete;
+
+  void OnQuery(absl::string_view query_name, absl::Duration latency,
+               int64 num_rows, int64 num_bytes,
+               const absl::Status& status) override;
+
+  void OnTransaction(TransactionOperation operation, absl::Duration latency,
+                     const absl::Status& status) override;
+
+  void OnCallMemory(absl::string_view method, int64 peak_bytes,
+                    bool hard_limit_exceeded) override;
+
+  // Returns the metrics of the queries of `query_name`, or empty metrics if it
+  // has not been queried.
+  QueryMetrics GetQueryMetrics(absl::string_view query_name) const;
+
+  // Returns the latency histogram of the transaction `operation`.
+  LatencyHistogram GetTransactionLatency(TransactionOperation operation) const;
+
+  // Returns the peak memory histogram of the calls of `method`, or an empty
+  // histogram if it has not been called with a memory account.
+  CallMemoryHistogram GetCallMemory(absl::string_view method) const;
+
+  // Returns the metrics in the Prometheus text exposition format, e.g.,
+  //   mlmd_query_latency_seconds_bucket{query="...",le="0.001"} 12
+  std::string ToPrometheusText() const;
+
+  // Writes ToPrometheusText() to `filename`, which can be collected by the
+  // textfile collector of the Prometheus node exporter. The file is replaced
+  // atomically by renaming a temporary file.
+  // Returns detailed INTERNAL error, if the file cannot be written.
+  absl::Status WritePrometheusTextFile(const std::string& filename) const;
+
+ private:
+  mutable absl::Mutex mu_;
+  // The query metrics keyed by the template query names.
+  std::map<std::string, QueryMetrics, std::less<>> query_metrics_
+      ABSL_GUARDED_BY(mu_);
+  // The latency histograms indexed by TransactionOperation.
+  std::array<LatencyHistogram, 3> transaction_latency_ ABSL_GUARDED_BY(mu_);
+  // The peak memory histograms keyed by the method names of the calls.
+  std::map<std::string, CallMemoryHistogram, std::less<>> call_memory_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_METADATA_SOURCE_METRICS_H_
@@ -0,0 +1,183 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_source_metrics.h"
+
+#include <memory>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/sqlite_metadata_source.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::HasSubstr;
+
+TEST(MetadataSourceMetricsTest, OnQueryRecordsHistogramAndCounts) {
+  MetadataSourceMetrics metrics;
+  metrics.OnQuery("select_artifact_by_id", absl::Microseconds(300),
+                  /*num_rows=*/2, /*num_bytes=*/40, absl::OkStatus());
+  metrics.OnQuery("select_artifact_by_id", absl::Seconds(20),
+                  /*num_rows=*/0, /*num_bytes=*/0,
+                  absl::InternalError("query failed"));
+
+  const MetadataSourceMetrics::QueryMetrics query_metrics =
+      metrics.GetQueryMetrics("select_artifact_by_id");
+  // 300us is within the bucket of 0.0005s and above.
+  EXPECT_EQ(query_metrics.latency.bucket_counts[1], 0);
+  EXPECT_EQ(query_metrics.latency.bucket_counts[2], 1);
+  // 20s is only within the +Inf bucket.
+  EXPECT_EQ(query_metrics.latency.bucket_counts[15], 1);
+  EXPECT_EQ(query_metrics.latency.bucket_counts[16], 2);
+  EXPECT_NEAR(query_metrics.latency.sum_seconds, 20.0003, 1e-9);
+  EXPECT_EQ(query_metrics.latency.num_errors, 1);
+  EXPECT_EQ(query_metrics.num_rows, 2);
+  EXPECT_EQ(query_metrics.num_bytes, 40);
+
+  EXPECT_EQ(metrics.GetQueryMetrics("select_execution_by_id")
+                .latency.bucket_counts.back(),
+            0);
+}
+
+TEST(MetadataSourceMetricsTest, UnnamedQueriesAreAdhoc) {
+  MetadataSourceMetrics metrics;
+  metrics.OnQuery("", absl::Milliseconds(1), /*num_rows=*/1, /*num_bytes=*/8,
+                  absl::OkStatus());
+  EXPECT_EQ(metrics.GetQueryMetrics("adhoc").latency.bucket_counts.back(), 1);
+  EXPECT_EQ(metrics.GetQueryMetrics("adhoc").num_rows, 1);
+}
+
+TEST(MetadataSourceMetricsTest, ToPrometheusText) {
+  MetadataSourceMetrics metrics;
+  metrics.OnQuery("select_artifact_by_id", absl::Milliseconds(2),
+                  /*num_rows=*/3, /*num_bytes=*/64, absl::OkStatus());
+  metrics.OnTransaction(TransactionOperation::kCommit, absl::Milliseconds(20),
+                        absl::AbortedError("conflict"));
+
+  const std::string text = metrics.ToPrometheusText();
+  EXPECT_THAT(text, HasSubstr("# TYPE mlmd_query_latency_seconds histogram\n"));
+  EXPECT_THAT(text, HasSubstr("mlmd_query_latency_seconds_bucket{query=\""
+                              "select_artifact_by_id\",le=\"0.001\"} 0\n"));
+  EXPECT_THAT(text, HasSubstr("mlmd_query_latency_seconds_bucket{query=\""
+                              "select_artifact_by_id\",le=\"0.0025\"} 1\n"));
+  EXPECT_THAT(text, HasSubstr("mlmd_query_latency_seconds_count{query=\""
+                              "select_artifact_by_id\"} 1\n"));
+  EXPECT_THAT(text, HasSubstr("mlmd_query_rows_total{query=\""
+                              "select_artifact_by_id\"} 3\n"));
+  EXPECT_THAT(text, HasSubstr("mlmd_query_bytes_total{query=\""
+                              "select_artifact_by_id\"} 64\n"));
+  EXPECT_THAT(text, HasSubstr("mlmd_transaction_latency_seconds_count{"
+                              "operation=\"commit\"} 1\n"));
+  EXPECT_THAT(text, HasSubstr("mlmd_transaction_errors_total{"
+                              "operation=\"commit\"} 1\n"));
+  EXPECT_THAT(text, HasSubstr("mlmd_transaction_errors_total{"
+                              "operation=\"begin\"} 0\n"));
+}
+
+TEST(MetadataSourceMetricsTest, OnCallMemoryRecordsHistogram) {
+  MetadataSourceMetrics metrics;
+  metrics.OnCallMemory("GetLineageGraph", /*peak_bytes=*/100000,
+                       /*hard_limit_exceeded=*/false);
+  metrics.OnCallMemory("GetLineageGraph", /*peak_bytes=*/2000000000,
+                       /*hard_limit_exceeded=*/true);
+
+  const MetadataSourceMetrics::CallMemoryHistogram histogram =
+      metrics.GetCallMemory("GetLineageGraph");
+  // 100000 bytes is within the bucket of 256KiB and above.
+  EXPECT_EQ(histogram.bucket_counts[0], 0);
+  EXPECT_EQ(histogram.bucket_counts[1], 1);
+  EXPECT_EQ(histogram.bucket_counts[7], 1);
+  EXPECT_EQ(histogram.bucket_counts[8], 2);
+  EXPECT_EQ(histogram.sum_bytes, 2000100000);
+  EXPECT_EQ(histogram.num_exhausted, 1);
+
+  const std::string text = metrics.ToPrometheusText();
+  EXPECT_THAT(text, HasSubstr("mlmd_call_peak_memory_bytes_bucket{method=\""
+                              "GetLineageGraph\",le=\"262144\"} 1\n"));
+  EXPECT_THAT(text, HasSubstr("mlmd_call_peak_memory_bytes_count{method=\""
+                              "GetLineageGraph\"} 2\n"));
+  EXPECT_THAT(text, HasSubstr("mlmd_call_memory_exhausted_total{method=\""
+                              "GetLineageGraph\"} 1\n"));
+}
+
+TEST(MetadataSourceMetricsTest, InstrumentedMetadataSource) {
+  MetadataSourceMetrics metrics;
+  SqliteMetadataSource metadata_source(SqliteMetadataSourceConfig{});
+  metadata_source.set_instrumentation(&metrics);
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Connect());
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source.ExecuteQuery("CREATE TABLE t1 (c1 INT);", nullptr,
+                                         "create_t1"));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source.ExecuteQuery(
+                "INSERT INTO t1 VALUES (1), (2), (3);", nullptr));
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source.ExecuteQuery("SELECT c1 FROM t1;", &record_set,
+                                         "select_t1"));
+  EXPECT_FALSE(
+      metadata_source.ExecuteQuery("SELECT c2 FROM t1;", nullptr, "select_t1")
+          .ok());
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Commit());
+
+  EXPECT_EQ(metrics.GetQueryMetrics("create_t1").latency.bucket_counts.back(),
+            1);
+  EXPECT_EQ(metrics.GetQueryMetrics("adhoc").latency.bucket_counts.back(), 1);
+  const MetadataSourceMetrics::QueryMetrics select_metrics =
+      metrics.GetQueryMetrics("select_t1");
+  EXPECT_EQ(select_metrics.latency.bucket_counts.back(), 2);
+  EXPECT_EQ(select_metrics.latency.num_errors, 1);
+  EXPECT_EQ(select_metrics.num_rows, 3);
+  EXPECT_EQ(select_metrics.num_bytes, record_set.ByteSizeLong());
+  EXPECT_EQ(metrics.GetTransactionLatency(TransactionOperation::kBegin)
+                .bucket_counts.back(),
+            1);
+  EXPECT_EQ(metrics.GetTransactionLatency(TransactionOperation::kCommit)
+                .bucket_counts.back(),
+            1);
+}
+
+TEST(MetadataSourceMetricsTest, TemplateQueriesAreNamed) {
+  MetadataSourceMetrics metrics;
+  SetDefaultMetadataSourceInstrumentation(&metrics);
+  ConnectionConfig connection_config;
+  connection_config.mutable_fake_database();
+  std::unique_ptr<MetadataStore> metadata_store;
+  ASSERT_EQ(absl::OkStatus(),
+            CreateMetadataStore(connection_config, &metadata_store));
+  SetDefaultMetadataSourceInstrumentation(nullptr);
+
+  PutArtifactTypeResponse response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->PutArtifactType(
+                ParseTextProtoOrDie<PutArtifactTypeRequest>(
+                    "artifact_type: { name: 'test_type' }"),
+                &response));
+  EXPECT_EQ(metrics.GetQueryMetrics("insert_artifact_type")
+                .latency.bucket_counts.back(),
+            1);
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -17,6 +17,10 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/call_memory_account.h"
+#include "ml_metadata/metadata_store/cancellation_token.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 
 namespace ml_metadata {
@@ -179,5 +183,75 @@ TEST(MetadataSourceTest, TestBeginWithoutConnect) {
   EXPECT_TRUE(absl::IsFailedPrecondition(s));
 }
 
+TEST(MetadataSourceTest, TestExecuteQueryOfCancelledCall) {
+  MockMetadataSource mock_metadata_source;
+  std::string query = "some query";
+  RecordSet result;
+  EXPECT_CALL(mock_metadata_source, BeginImpl()).Times(1);
+  EXPECT_CALL(mock_metadata_source, ExecuteQueryImpl(query, &result)).Times(0);
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Begin());
+  CancellationToken token;
+  mock_metadata_source.set_cancellation_token(&token);
+  token.Cancel();
+  absl::Status s = mock_metadata_source.ExecuteQuery(query, &result);
+  EXPECT_TRUE(absl::IsCancelled(s));
+}
+
+TEST(MetadataSourceTest, TestBeginAfterDeadline) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, BeginImpl()).Times(0);
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  CancellationToken token(absl::Now() - absl::Seconds(1));
+  mock_metadata_source.set_cancellation_token(&token);
+  absl::Status s = mock_metadata_source.Begin();
+  EXPECT_TRUE(absl::IsDeadlineExceeded(s));
+}
+
+TEST(MetadataSourceTest, TestFailedQueryOfCancelledCall) {
+  MockMetadataSource mock_metadata_source;
+  std::string query = "some query";
+  RecordSet result;
+  CancellationToken token;
+  EXPECT_CALL(mock_metadata_source, BeginImpl()).Times(1);
+  EXPECT_CALL(mock_metadata_source, ExecuteQueryImpl(query, &result))
+      .WillOnce([&token](const std::string&, RecordSet*) {
+        // The query is interrupted once the call is cancelled.
+        token.Cancel();
+        return absl::InternalError("interrupted");
+      });
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Begin());
+  mock_metadata_source.set_cancellation_token(&token);
+  absl::Status s = mock_metadata_source.ExecuteQuery(query, &result);
+  EXPECT_TRUE(absl::IsCancelled(s));
+}
+
+TEST(MetadataSourceTest, TestQueryOverMemoryLimit) {
+  MockMetadataSource mock_metadata_source;
+  std::string query = "some query";
+  RecordSet result;
+  EXPECT_CALL(mock_metadata_source, BeginImpl()).Times(1);
+  EXPECT_CALL(mock_metadata_source, ExecuteQueryImpl(query, &result))
+      .WillOnce([](const std::string&, RecordSet* results) {
+        results->add_column_names("id");
+        return absl::OkStatus();
+      })
+      .WillOnce([](const std::string&, RecordSet* results) {
+        results->add_records()->add_values("a value over the memory limit");
+        return absl::OkStatus();
+      });
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  EXPECT_EQ(absl::OkStatus(), mock_metadata_source.Begin());
+  CallMemoryAccount account(/*soft_limit_bytes=*/0, /*hard_limit_bytes=*/16);
+  mock_metadata_source.set_memory_account(&account);
+  EXPECT_EQ(absl::OkStatus(),
+            mock_metadata_source.ExecuteQuery(query, &result));
+  EXPECT_EQ(account.charged_bytes(), result.ByteSizeLong());
+  absl::Status s = mock_metadata_source.ExecuteQuery(query, &result);
+  EXPECT_TRUE(absl::IsResourceExhausted(s));
+  EXPECT_GT(account.charged_bytes(), 16);
+  EXPECT_TRUE(account.hard_limit_exceeded());
+}
 
 }  // namespace ml_metadata
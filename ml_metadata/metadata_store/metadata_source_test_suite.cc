@@ -215,6 +215,70 @@ TEST_P(MetadataSourceTestSuite, TestNull) {
   EXPECT_THAT(query_results, EqualsProto(expected_results));
 }
 
+// Test ExecuteQueries with a batch of independent queries.
+// Initialization: creates table t1(c1 INT, c2 VARCHAR(255)) and adds 3 rows to
+// t1: (1,'v1'), (2,'v2'), (3, 'v3').
+// Execution: Update c2 to 'v100' in the row where c1 = 1, and select the rows
+// where c1 = 1 and c1 = 2 in a batch.
+// Expectation: the results of the queries are returned in order.
+TEST_P(MetadataSourceTestSuite, TestExecuteQueries) {
+  metadata_source_container_->InitSchemaAndPopulateRows();
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  RecordSet first_results;
+  RecordSet second_results;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQueries(
+                {"UPDATE t1 SET c2 = 'v100' WHERE c1 = 1;",
+                 "SELECT * FROM t1 WHERE c1 = 1;",
+                 "SELECT * FROM t1 WHERE c1 = 2"},
+                {nullptr, &first_results, &second_results}));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Commit());
+  EXPECT_THAT(first_results, EqualsProto(ParseTextProtoOrDie<RecordSet>(
+                                 R"(column_names: "c1"
+                                    column_names: "c2"
+                                    records: { values: "1" values: "v100" })")));
+  EXPECT_THAT(second_results, EqualsProto(ParseTextProtoOrDie<RecordSet>(
+                                  R"(column_names: "c1"
+                                     column_names: "c2"
+                                     records: { values: "2" values: "v2" })")));
+
+  // The sizes of the queries and the results must match.
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_source_->ExecuteQueries(
+      {"SELECT * FROM t1"}, {&first_results, &second_results})));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Commit());
+}
+
+TEST_P(MetadataSourceTestSuite, TestTransactionStats) {
+  metadata_source_container_->InitSchemaAndPopulateRows();
+  TransactionStats stats;
+  metadata_source_->set_transaction_stats(&stats);
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQuery(
+                "UPDATE t1 SET c2 = 'v100' WHERE c1 <= 2;", nullptr));
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQuery("SELECT * FROM t1;", &record_set));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Commit());
+  metadata_source_->set_transaction_stats(nullptr);
+
+  EXPECT_EQ(stats.num_transactions(), 1);
+  EXPECT_EQ(stats.num_retries(), 0);
+  EXPECT_EQ(stats.num_statements(), 2);
+  EXPECT_EQ(stats.num_rows_read(), 3);
+  EXPECT_EQ(stats.num_rows_written(), 2);
+  EXPECT_GE(stats.database_time_us(), 0);
+  EXPECT_GE(stats.commit_time_us(), 0);
+
+  // The queries of other calls are not counted.
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source_->ExecuteQuery("SELECT * FROM t1;", &record_set));
+  ASSERT_EQ(absl::OkStatus(), metadata_source_->Commit());
+  EXPECT_EQ(stats.num_statements(), 2);
+}
+
 }  // namespace
 }  // namespace testing
 }  // namespace ml_metadata
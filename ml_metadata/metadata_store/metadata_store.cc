@@ -15,11 +15,16 @@ limitations under the License.
 #include "ml_metadata/metadata_store/metadata_store.h"
 
 #include <algorithm>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include <glog/logging.h>
 #include "google/protobuf/descriptor.h"
+#include "google/protobuf/message.h"
 #include "google/protobuf/repeated_field.h"
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
@@ -27,10 +32,16 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
+#include "ml_metadata/metadata_store/batch_id_reference.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/lineage_result_cache.h"
+#include "ml_metadata/metadata_store/list_operation_util.h"
+#include "ml_metadata/metadata_store/lookup_cache.h"
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/metadata_access_object_factory.h"
 #include "ml_metadata/metadata_store/simple_types_util.h"
@@ -203,6 +214,170 @@ absl::Status UpsertType(const T& type, bool can_add_fields,
   return UpsertTypeInheritanceLink(type, *type_id, metadata_access_object);
 }
 
+// Creates the type inheritance links of the `types`, whose ids are `type_ids`,
+// as UpsertTypeInheritanceLink does for each type, with one query to find the
+// parent types of all the types and one to find their base types.
+template <typename T>
+absl::Status UpsertTypeInheritanceLinks(
+    const google::protobuf::RepeatedPtrField<T>& types,
+    absl::Span<const int64> type_ids,
+    MetadataAccessObject* metadata_access_object) {
+  std::vector<int64> child_type_ids;
+  std::vector<std::string> base_type_names;
+  std::vector<int> child_indices;
+  for (int i = 0; i < types.size(); i++) {
+    if (!types[i].has_base_type()) continue;
+    SystemTypeExtension extension;
+    MLMD_RETURN_IF_ERROR(GetSystemTypeExtension(types[i], extension));
+    if (IsUnsetBaseType(extension)) {
+      return absl::UnimplementedError(
+          "base_type deletion is not supported yet");
+    }
+    child_type_ids.push_back(type_ids[i]);
+    base_type_names.push_back(extension.type_name());
+    child_indices.push_back(i);
+  }
+  if (child_type_ids.empty()) return absl::OkStatus();
+
+  absl::flat_hash_map<int64, T> output_parent_types;
+  MLMD_RETURN_IF_ERROR(metadata_access_object->FindParentTypesByTypeId(
+      child_type_ids, output_parent_types));
+  // The base types are the types without a version of the given names.
+  std::vector<T> candidate_base_types;
+  MLMD_RETURN_IF_ERROR(metadata_access_object->FindTypesByNames(
+      base_type_names, &candidate_base_types));
+  absl::flat_hash_map<std::string, T> base_types;
+  for (T& base_type : candidate_base_types) {
+    if (!base_type.version().empty()) continue;
+    auto it = base_types.find(base_type.name());
+    if (it == base_types.end() || base_type.id() < it->second.id()) {
+      base_types[base_type.name()] = std::move(base_type);
+    }
+  }
+
+  for (int i = 0; i < child_type_ids.size(); i++) {
+    const auto parent_it = output_parent_types.find(child_type_ids[i]);
+    if (parent_it != output_parent_types.end()) {
+      if (parent_it->second.name() != base_type_names[i]) {
+        return absl::UnimplementedError(
+            "base_type update is not supported yet");
+      }
+      continue;
+    }
+    const auto base_it = base_types.find(base_type_names[i]);
+    if (base_it == base_types.end()) {
+      return absl::NotFoundError(
+          absl::StrCat("No type found for query, name: `", base_type_names[i],
+                       "`, version: `nullopt`"));
+    }
+    T type_with_id = types[child_indices[i]];
+    type_with_id.set_id(child_type_ids[i]);
+    MLMD_RETURN_IF_ERROR(metadata_access_object->CreateParentTypeInheritanceLink(
+        type_with_id, base_it->second));
+    // A type given more than once is linked once.
+    output_parent_types[child_type_ids[i]] = base_it->second;
+  }
+  return absl::OkStatus();
+}
+
+// Inserts or updates the `types` of a kind as UpsertType does for each type in
+// order, and returns their ids in `type_ids`. Instead of a lookup per type, the
+// stored types of all the given names are read with one query per table, the
+// types are checked against them in memory, and only the new types and the
+// added properties are written, with multi-row inserts.
+template <typename T>
+absl::Status UpsertTypesInBatch(
+    const google::protobuf::RepeatedPtrField<T>& types,
+    const bool can_add_fields, const bool can_omit_fields,
+    MetadataAccessObject* metadata_access_object,
+    std::vector<int64>* type_ids) {
+  type_ids->clear();
+  if (types.empty()) return absl::OkStatus();
+  absl::flat_hash_set<std::string> name_set;
+  std::vector<std::string> names;
+  for (const T& type : types) {
+    if (name_set.insert(type.name()).second) names.push_back(type.name());
+  }
+  std::vector<T> stored_types;
+  MLMD_RETURN_IF_ERROR(
+      metadata_access_object->FindTypesByNames(names, &stored_types));
+
+  // The current version of a type, keyed by its name and version, and whether
+  // it is created or has properties added by this call.
+  struct TypeState {
+    T type;
+    // The index in `types_to_create`, or -1 if the type is stored.
+    int create_index = -1;
+    // The index in `properties_to_add`, or -1 if no property is added.
+    int add_index = -1;
+  };
+  absl::flat_hash_map<std::pair<std::string, std::string>, TypeState> states;
+  for (T& stored_type : stored_types) {
+    TypeState& state = states[{stored_type.name(), stored_type.version()}];
+    // Like FindTypeByNameAndVersion, the first stored type is used.
+    if (!state.type.has_id() || stored_type.id() < state.type.id()) {
+      state.type = std::move(stored_type);
+    }
+  }
+
+  std::vector<T> types_to_create;
+  std::vector<T> properties_to_add;
+  for (const T& type : types) {
+    const std::pair<std::string, std::string> key = {type.name(),
+                                                     type.version()};
+    auto it = states.find(key);
+    // if not found, then it creates a type. `can_add_fields` is ignored.
+    if (it == states.end()) {
+      TypeState& state = states[key];
+      state.type = type;
+      state.create_index = types_to_create.size();
+      types_to_create.push_back(type);
+      continue;
+    }
+    TypeState& state = it->second;
+    T output_type;
+    const absl::Status check_status = CheckFieldsConsistent(
+        state.type, type, can_add_fields, can_omit_fields, output_type);
+    if (!check_status.ok()) {
+      return absl::AlreadyExistsError(
+          absl::StrCat("Type already exists with different properties: ",
+                       std::string(check_status.message())));
+    }
+    if (output_type.properties_size() == state.type.properties_size()) {
+      continue;
+    }
+    if (state.create_index >= 0) {
+      *types_to_create[state.create_index].mutable_properties() =
+          output_type.properties();
+    } else {
+      if (state.add_index < 0) {
+        state.add_index = properties_to_add.size();
+        properties_to_add.emplace_back().set_id(state.type.id());
+      }
+      for (const auto& property : output_type.properties()) {
+        if (state.type.properties().count(property.first) == 0) {
+          (*properties_to_add[state.add_index]
+                .mutable_properties())[property.first] = property.second;
+        }
+      }
+    }
+    state.type = std::move(output_type);
+  }
+
+  std::vector<int64> created_type_ids;
+  MLMD_RETURN_IF_ERROR(
+      metadata_access_object->CreateTypes(types_to_create, &created_type_ids));
+  MLMD_RETURN_IF_ERROR(
+      metadata_access_object->AddTypeProperties(properties_to_add));
+  for (const T& type : types) {
+    const TypeState& state = states.at({type.name(), type.version()});
+    type_ids->push_back(state.create_index >= 0
+                            ? created_type_ids[state.create_index]
+                            : state.type.id());
+  }
+  return UpsertTypeInheritanceLinks(types, *type_ids, metadata_access_object);
+}
+
 // Inserts or updates all the types in the argument list. 'can_add_fields' and
 // 'can_omit_fields' are both enabled. Type ids are inserted into the
 // PutTypesResponse 'response'.
@@ -212,26 +387,24 @@ absl::Status UpsertTypes(
     const google::protobuf::RepeatedPtrField<ContextType>& context_types,
     const bool can_add_fields, const bool can_omit_fields,
     MetadataAccessObject* metadata_access_object, PutTypesResponse* response) {
-  for (const ArtifactType& artifact_type : artifact_types) {
-    int64 artifact_type_id;
-    MLMD_RETURN_IF_ERROR(UpsertType(artifact_type, can_add_fields,
-                                    can_omit_fields, metadata_access_object,
-                                    &artifact_type_id));
-    response->add_artifact_type_ids(artifact_type_id);
-  }
-  for (const ExecutionType& execution_type : execution_types) {
-    int64 execution_type_id;
-    MLMD_RETURN_IF_ERROR(UpsertType(execution_type, can_add_fields,
-                                    can_omit_fields, metadata_access_object,
-                                    &execution_type_id));
-    response->add_execution_type_ids(execution_type_id);
-  }
-  for (const ContextType& context_type : context_types) {
-    int64 context_type_id;
-    MLMD_RETURN_IF_ERROR(UpsertType(context_type, can_add_fields,
-                                    can_omit_fields, metadata_access_object,
-                                    &context_type_id));
-    response->add_context_type_ids(context_type_id);
+  std::vector<int64> type_ids;
+  MLMD_RETURN_IF_ERROR(UpsertTypesInBatch(artifact_types, can_add_fields,
+                                          can_omit_fields,
+                                          metadata_access_object, &type_ids));
+  for (const int64 type_id : type_ids) {
+    response->add_artifact_type_ids(type_id);
+  }
+  MLMD_RETURN_IF_ERROR(UpsertTypesInBatch(execution_types, can_add_fields,
+                                          can_omit_fields,
+                                          metadata_access_object, &type_ids));
+  for (const int64 type_id : type_ids) {
+    response->add_execution_type_ids(type_id);
+  }
+  MLMD_RETURN_IF_ERROR(UpsertTypesInBatch(context_types, can_add_fields,
+                                          can_omit_fields,
+                                          metadata_access_object, &type_ids));
+  for (const int64 type_id : type_ids) {
+    response->add_context_type_ids(type_id);
   }
   return absl::OkStatus();
 }
@@ -247,22 +420,6 @@ absl::Status UpsertSimpleTypes(MetadataAccessObject* metadata_access_object) {
       /*can_omit_fields=*/true, metadata_access_object, &response);
 }
 
-// Updates or inserts an artifact. If the artifact.id is given, it updates the
-// stored artifact, otherwise, it creates a new artifact.
-absl::Status UpsertArtifact(const Artifact& artifact,
-                            MetadataAccessObject* metadata_access_object,
-                            int64* artifact_id) {
-  CHECK(artifact_id) << "artifact_id should not be null";
-  if (artifact.has_id()) {
-    MLMD_RETURN_IF_ERROR(metadata_access_object->UpdateArtifact(artifact));
-    *artifact_id = artifact.id();
-  } else {
-    MLMD_RETURN_IF_ERROR(
-        metadata_access_object->CreateArtifact(artifact, artifact_id));
-  }
-  return absl::OkStatus();
-}
-
 // Updates or inserts an execution. If the execution.id is given, it updates the
 // stored execution, otherwise, it creates a new execution.
 absl::Status UpsertExecution(const Execution& execution,
@@ -295,50 +452,70 @@ absl::Status UpsertContext(const Context& context,
   return absl::OkStatus();
 }
 
-// Inserts an association. If the association already exists it returns OK.
-absl::Status InsertAssociationIfNotExist(
-    int64 context_id, int64 execution_id,
-    MetadataAccessObject* metadata_access_object) {
-  Association association;
-  association.set_execution_id(execution_id);
-  association.set_context_id(context_id);
-  int64 dummy_assocation_id;
-  absl::Status status = metadata_access_object->CreateAssociation(
-      association, &dummy_assocation_id);
-  if (!status.ok() && !absl::IsAlreadyExists(status)) {
-    return status;
-  }
-  return absl::OkStatus();
+// Creates a batch of artifacts, and returns their ids in `artifact_ids`.
+absl::Status CreateNodes(absl::Span<const Artifact> artifacts,
+                         MetadataAccessObject* metadata_access_object,
+                         std::vector<int64>* artifact_ids) {
+  return metadata_access_object->CreateArtifacts(artifacts, artifact_ids);
 }
 
-// Inserts an attribution. If the attribution already exists it returns OK.
-absl::Status InsertAttributionIfNotExist(
-    int64 context_id, int64 artifact_id,
-    MetadataAccessObject* metadata_access_object) {
-  Attribution attribution;
-  attribution.set_artifact_id(artifact_id);
-  attribution.set_context_id(context_id);
-  int64 dummy_attribution_id;
-  absl::Status status = metadata_access_object->CreateAttribution(
-      attribution, &dummy_attribution_id);
-  if (!status.ok() && !absl::IsAlreadyExists(status)) {
-    return status;
+// Creates a batch of executions, and returns their ids in `execution_ids`.
+absl::Status CreateNodes(absl::Span<const Execution> executions,
+                         MetadataAccessObject* metadata_access_object,
+                         std::vector<int64>* execution_ids) {
+  return metadata_access_object->CreateExecutions(executions, execution_ids);
+}
+
+// Creates a batch of contexts, and returns their ids in `context_ids`.
+absl::Status CreateNodes(absl::Span<const Context> contexts,
+                         MetadataAccessObject* metadata_access_object,
+                         std::vector<int64>* context_ids) {
+  return metadata_access_object->CreateContexts(contexts, context_ids);
+}
+
+// Updates or inserts the `nodes` in order, and returns their ids in
+// `node_ids`. A node with an id is updated by `update_node`. The consecutive
+// nodes without ids are created together in a batch, which is flushed before
+// the next update, so that the nodes are still written in the given order.
+template <typename Node>
+absl::Status UpsertNodes(
+    const google::protobuf::RepeatedPtrField<Node>& nodes,
+    const std::function<absl::Status(const Node&)>& update_node,
+    MetadataAccessObject* metadata_access_object,
+    std::vector<int64>* node_ids) {
+  node_ids->clear();
+  std::vector<Node> new_nodes;
+  const auto create_new_nodes = [&]() -> absl::Status {
+    if (new_nodes.empty()) return absl::OkStatus();
+    std::vector<int64> new_node_ids;
+    MLMD_RETURN_IF_ERROR(
+        CreateNodes(new_nodes, metadata_access_object, &new_node_ids));
+    node_ids->insert(node_ids->end(), new_node_ids.begin(),
+                     new_node_ids.end());
+    new_nodes.clear();
+    return absl::OkStatus();
+  };
+  for (const Node& node : nodes) {
+    if (!node.has_id()) {
+      new_nodes.push_back(node);
+      continue;
+    }
+    MLMD_RETURN_IF_ERROR(create_new_nodes());
+    MLMD_RETURN_IF_ERROR(update_node(node));
+    node_ids->push_back(node.id());
   }
-  return absl::OkStatus();
+  return create_new_nodes();
 }
 
-// Updates or inserts a pair of {Artifact, Event}. If artifact is not given,
-// the event.artifact_id must exist, and it inserts the event, and returns the
-// artifact_id. Otherwise if artifact is given, event.artifact_id is optional,
-// if set, then artifact.id and event.artifact_id must align.
-absl::Status UpsertArtifactAndEvent(
-    const PutExecutionRequest::ArtifactAndEvent& artifact_and_event,
-    MetadataAccessObject* metadata_access_object, int64* artifact_id) {
-  CHECK(artifact_id) << "The output artifact_id pointer should not be null";
+// Validates a pair of {Artifact, Event}. If artifact is not given, the
+// event.artifact_id must exist. Otherwise if artifact is given,
+// event.artifact_id is optional, if set, then artifact.id and
+// event.artifact_id must align.
+absl::Status ValidateArtifactAndEvent(
+    const PutExecutionRequest::ArtifactAndEvent& artifact_and_event) {
   if (!artifact_and_event.has_artifact() && !artifact_and_event.has_event()) {
     return absl::OkStatus();
   }
-  // validate event and artifact's id aligns.
   // if artifact is not given, the event.artifact_id must exist
   absl::optional<int64> maybe_event_artifact_id =
       artifact_and_event.has_event() &&
@@ -363,23 +540,7 @@ absl::Status UpsertArtifactAndEvent(
         "Given event.artifact_id is not aligned with the artifact: ",
         artifact_and_event.DebugString()));
   }
-  // upsert artifact if present.
-  if (artifact_and_event.has_artifact()) {
-    MLMD_RETURN_IF_ERROR(UpsertArtifact(artifact_and_event.artifact(),
-                                        metadata_access_object, artifact_id));
-  }
-  // insert event if any.
-  if (!artifact_and_event.has_event()) {
-    return absl::OkStatus();
-  }
-  Event event = artifact_and_event.event();
-  if (artifact_and_event.has_artifact()) {
-    event.set_artifact_id(*artifact_id);
-  } else {
-    *artifact_id = event.artifact_id();
-  }
-  int64 dummy_event_id = -1;
-  return metadata_access_object->CreateEvent(event, &dummy_event_id);
+  return absl::OkStatus();
 }
 
 // A util to handle type_version in type read/write API requests.
@@ -418,15 +579,401 @@ absl::Status SetBaseType(absl::Span<T* const> types,
   return absl::OkStatus();
 }
 
+// Returns INVALID_ARGUMENT error, if the chunk size of `options` is out of
+// range.
+absl::Status ValidateBulkDeleteOptions(const BulkDeleteOptions& options) {
+  if (options.chunk_size() < 1 ||
+      options.chunk_size() > kMaxBulkDeleteChunkSize) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("chunk_size must be in [1, ", kMaxBulkDeleteChunkSize,
+                     "], but got ", options.chunk_size()));
+  }
+  return absl::OkStatus();
+}
+
+// Deletes the nodes of `node_ids` in chunks of `options`, each in its own
+// transaction of `transaction_executor`. `delete_chunk` deletes the nodes of a
+// chunk and the rows referring to them. `num_deleted_ids` is set to the number
+// of leading `node_ids` that are deleted, also when a chunk fails.
+// Returns INVALID_ARGUMENT error, if the chunk size is out of range.
+absl::Status DeleteNodesInChunks(
+    absl::Span<const int64> node_ids, const BulkDeleteOptions& options,
+    const TransactionOptions& transaction_options,
+    const std::function<absl::Status(absl::Span<const int64>)>& delete_chunk,
+    const TransactionExecutor& transaction_executor, int64* num_deleted_ids) {
+  *num_deleted_ids = 0;
+  MLMD_RETURN_IF_ERROR(ValidateBulkDeleteOptions(options));
+  for (int num_chunks = 0; *num_deleted_ids < node_ids.size(); num_chunks++) {
+    if (options.max_num_chunks() > 0 &&
+        num_chunks >= options.max_num_chunks()) {
+      break;
+    }
+    if (num_chunks > 0 && options.chunk_interval_ms() > 0) {
+      absl::SleepFor(absl::Milliseconds(options.chunk_interval_ms()));
+    }
+    const absl::Span<const int64> chunk =
+        node_ids.subspan(*num_deleted_ids, options.chunk_size());
+    MLMD_RETURN_IF_ERROR(transaction_executor.Execute(
+        [&delete_chunk, chunk]() { return delete_chunk(chunk); },
+        transaction_options));
+    *num_deleted_ids += chunk.size();
+  }
+  return absl::OkStatus();
+}
+
+// A TransactionExecutor running the transaction bodies in the transaction that
+// is already open, e.g., the one of MetadataStore::RunInTransaction.
+class JoinedTransactionExecutor : public TransactionExecutor {
+ public:
+  absl::Status Execute(const std::function<absl::Status()>& txn_body,
+                       const TransactionOptions& transaction_options =
+                           TransactionOptions()) const override {
+    return txn_body();
+  }
+};
+
+// Returns the max number of levels of the ParentContext relation traversed by
+// a GetAncestorContexts or GetDescendantContexts request. All the levels are
+// traversed if the max_depth is not positive.
+template <typename Request>
+int64 ContextHierarchyMaxDepth(const Request& request) {
+  return request.max_depth() > 0 ? request.max_depth()
+                                 : std::numeric_limits<int>::max();
+}
+
+// Returns the lookups made stale by a write of types, i.e., all of them, as
+// the lookups of contexts are keyed by the names of their types.
+LookupCache::Invalidation TypesInvalidation() {
+  LookupCache::Invalidation invalidation;
+  invalidation.all = true;
+  return invalidation;
+}
+
+// Returns the lookups made stale by a write of `contexts`.
+LookupCache::Invalidation ContextsInvalidation(
+    const google::protobuf::RepeatedPtrField<Context>& contexts) {
+  LookupCache::Invalidation invalidation;
+  invalidation.AddContexts(contexts);
+  return invalidation;
+}
+
+// Sets whether the lookup `result` of a type found nothing.
+template <typename Request, typename Response>
+void DescribeLookupResult(const Request& request, const Response& response,
+                          LookupCache::Result* result) {
+  result->negative = absl::IsNotFound(result->status);
+}
+
+// Sets whether the lookup `result` of a context found nothing, and the context
+// name and id that invalidate it.
+void DescribeLookupResult(const GetContextByTypeAndNameRequest& request,
+                          const GetContextByTypeAndNameResponse& response,
+                          LookupCache::Result* result) {
+  result->negative = !response.has_context();
+  result->context_name = request.context_name();
+  if (response.has_context()) {
+    result->context_id = response.context().id();
+  }
+}
+
+// Returns the event types of a GetEventsBy{Artifact,Execution}IDs or
+// GetEventsByTimeRange `request`.
+template <typename Request>
+std::vector<Event::Type> EventTypes(const Request& request) {
+  std::vector<Event::Type> event_types;
+  event_types.reserve(request.types_size());
+  for (const int type : request.types()) {
+    event_types.push_back(static_cast<Event::Type>(type));
+  }
+  return event_types;
+}
+
+// Removes the `events` whose types are not in the types of a
+// GetEventsBy{Artifact,Execution}IDs `request`, if any.
+template <typename Request>
+void FilterEventsByType(const Request& request, std::vector<Event>* events) {
+  if (request.types().empty()) return;
+  const absl::flat_hash_set<int> types(request.types().begin(),
+                                       request.types().end());
+  events->erase(std::remove_if(events->begin(), events->end(),
+                               [&types](const Event& event) {
+                                 return !types.contains(event.type());
+                               }),
+                events->end());
+}
+
+// The type generations at which the simple types are known to be stored, keyed
+// by the database keys of the stores of the process.
+struct SimpleTypesGenerations {
+  absl::Mutex mu;
+  absl::flat_hash_map<std::string, int64> generations ABSL_GUARDED_BY(mu);
+};
+
+SimpleTypesGenerations& GetSimpleTypesGenerations() {
+  static auto* const generations = new SimpleTypesGenerations();
+  return *generations;
+}
+
+// Adds the `nodes` to the `groups` of their contexts, in the order of the
+// `links`, i.e., of the attributions or associations ordered by context id.
+// A node linked with several contexts is copied to each of their groups.
+template <typename Link, typename Id, typename Node, typename Group>
+void GroupNodesByContext(const std::vector<Link>& links,
+                         Id (Link::*node_id)() const,
+                         const std::vector<Node>& nodes,
+                         Node* (Group::*add_node)(),
+                         google::protobuf::RepeatedPtrField<Group>* groups) {
+  absl::flat_hash_map<int64, const Node*> node_by_id;
+  for (const Node& node : nodes) {
+    node_by_id[node.id()] = &node;
+  }
+  Group* group = nullptr;
+  for (const Link& link : links) {
+    if (group == nullptr || group->context_id() != link.context_id()) {
+      group = groups->Add();
+      group->set_context_id(link.context_id());
+    }
+    const auto it = node_by_id.find((link.*node_id)());
+    if (it != node_by_id.end()) {
+      *(group->*add_node)() = *it->second;
+    }
+  }
+}
+
+// Truncates the page of `nodes` listed with `options` to the soft limit of the
+// memory `account` of the call, if any, keeping at least one node, and sets
+// the `next_page_token` to continue the listing after the last kept node.
+template <typename Node>
+absl::Status TruncatePageToSoftMemoryLimit(const CallMemoryAccount* account,
+                                           const ListOperationOptions& options,
+                                           std::vector<Node>* nodes,
+                                           std::string* next_page_token) {
+  if (account == nullptr || account->soft_limit_bytes() <= 0) {
+    return absl::OkStatus();
+  }
+  int64 page_bytes = 0;
+  for (int i = 0; i < nodes->size(); i++) {
+    page_bytes += (*nodes)[i].ByteSizeLong();
+    if (i > 0 && page_bytes > account->soft_limit_bytes()) {
+      nodes->resize(i);
+      return BuildListOperationNextPageToken<Node>(*nodes, options,
+                                                   next_page_token);
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Sets the `type` of the `nodes` to the names of their types, which are found
+// with a single lookup of the distinct type ids.
+// Returns detailed INTERNAL error, if query execution fails.
+template <typename Type, typename Node>
+absl::Status PopulateTypeNames(MetadataAccessObject* metadata_access_object,
+                               std::vector<Node>* nodes) {
+  if (nodes->empty()) {
+    return absl::OkStatus();
+  }
+  std::vector<int64> type_ids;
+  type_ids.reserve(nodes->size());
+  for (const Node& node : *nodes) {
+    type_ids.push_back(node.type_id());
+  }
+  std::vector<Type> types;
+  MLMD_RETURN_IF_ERROR(
+      metadata_access_object->FindTypesByIds(type_ids, &types));
+  absl::flat_hash_map<int64, const std::string*> type_names;
+  for (const Type& type : types) {
+    type_names[type.id()] = &type.name();
+  }
+  for (Node& node : *nodes) {
+    const auto it = type_names.find(node.type_id());
+    if (it != type_names.end()) {
+      node.set_type(*it->second);
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Sets the ids of the id_references of a batch `call` in its `request` from
+// the `responses` of the earlier calls, which are null for the failed ones.
+absl::Status ResolveIdReferences(
+    const BatchRequest::Call& call,
+    absl::Span<const std::unique_ptr<google::protobuf::Message>> responses,
+    google::protobuf::Message* request) {
+  for (const BatchRequest::Call::IdReference& reference :
+       call.id_references()) {
+    if (reference.call_index() < 0 ||
+        reference.call_index() >= responses.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("The id reference to call ", reference.call_index(),
+                       " is not to an earlier call of the batch"));
+    }
+    if (responses[reference.call_index()] == nullptr) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "The referenced call ", reference.call_index(), " has failed"));
+    }
+    MLMD_RETURN_IF_ERROR(ApplyIdReference(
+        reference, *responses[reference.call_index()], request));
+  }
+  return absl::OkStatus();
+}
+
+// A call of a batch, which parses the request of the `call`, resolves its id
+// references against the `responses` of the earlier calls, and sets its
+// `response`.
+using BatchCall = std::function<absl::Status(
+    MetadataStore* metadata_store, const BatchRequest::Call& call,
+    absl::Span<const std::unique_ptr<google::protobuf::Message>> responses,
+    std::unique_ptr<google::protobuf::Message>* response)>;
+
+template <typename Request, typename Response>
+BatchCall MakeBatchCall(absl::Status (MetadataStore::*method)(const Request&,
+                                                              Response*)) {
+  return [method](
+             MetadataStore* metadata_store, const BatchRequest::Call& call,
+             absl::Span<const std::unique_ptr<google::protobuf::Message>>
+                 responses,
+             std::unique_ptr<google::protobuf::Message>* response)
+             -> absl::Status {
+    Request request;
+    if (!request.ParseFromString(call.request())) {
+      return absl::InvalidArgumentError("Could not parse proto");
+    }
+    MLMD_RETURN_IF_ERROR(ResolveIdReferences(call, responses, &request));
+    auto method_response = absl::make_unique<Response>();
+    MLMD_RETURN_IF_ERROR(
+        (metadata_store->*method)(request, method_response.get()));
+    *response = std::move(method_response);
+    return absl::OkStatus();
+  };
+}
+
+// Returns the calls of a batch by the names of their methods.
+const absl::flat_hash_map<std::string, BatchCall>& BatchCalls() {
+#define MLMD_BATCH_CALL(method) {#method, MakeBatchCall(&MetadataStore::method)}
+  static const auto* const kBatchCalls =
+      new absl::flat_hash_map<std::string, BatchCall>({
+          MLMD_BATCH_CALL(PutArtifactType),
+          MLMD_BATCH_CALL(GetArtifactType),
+          MLMD_BATCH_CALL(GetArtifactTypesByID),
+          MLMD_BATCH_CALL(GetArtifactTypes),
+          MLMD_BATCH_CALL(PutExecutionType),
+          MLMD_BATCH_CALL(GetExecutionType),
+          MLMD_BATCH_CALL(GetExecutionTypesByID),
+          MLMD_BATCH_CALL(GetExecutionTypes),
+          MLMD_BATCH_CALL(PutContextType),
+          MLMD_BATCH_CALL(GetContextType),
+          MLMD_BATCH_CALL(GetContextTypesByID),
+          MLMD_BATCH_CALL(GetContextTypes),
+          MLMD_BATCH_CALL(PutTypes),
+          MLMD_BATCH_CALL(PutArtifacts),
+          MLMD_BATCH_CALL(PutExecutions),
+          MLMD_BATCH_CALL(PutContexts),
+          MLMD_BATCH_CALL(PutEvents),
+          MLMD_BATCH_CALL(PutExecution),
+          MLMD_BATCH_CALL(PutAttributionsAndAssociations),
+          MLMD_BATCH_CALL(PutParentContexts),
+          MLMD_BATCH_CALL(DeleteArtifacts),
+          MLMD_BATCH_CALL(DeleteExecutions),
+          MLMD_BATCH_CALL(ArchiveExecutions),
+          MLMD_BATCH_CALL(GetArtifactsByID),
+          MLMD_BATCH_CALL(GetExecutionsByID),
+          MLMD_BATCH_CALL(GetContextsByID),
+          MLMD_BATCH_CALL(GetEventsByArtifactIDs),
+          MLMD_BATCH_CALL(GetEventsByExecutionIDs),
+          MLMD_BATCH_CALL(GetEventsByTimeRange),
+          MLMD_BATCH_CALL(GetArtifacts),
+          MLMD_BATCH_CALL(GetArtifactsByType),
+          MLMD_BATCH_CALL(GetArtifactByTypeAndName),
+          MLMD_BATCH_CALL(GetArtifactsByURI),
+          MLMD_BATCH_CALL(GetExecutions),
+          MLMD_BATCH_CALL(GetExecutionsByType),
+          MLMD_BATCH_CALL(GetActiveExecutionsByType),
+          MLMD_BATCH_CALL(GetExecutionByTypeAndName),
+          MLMD_BATCH_CALL(GetContexts),
+          MLMD_BATCH_CALL(GetContextsByType),
+          MLMD_BATCH_CALL(GetContextByTypeAndName),
+          MLMD_BATCH_CALL(GetContextsByArtifact),
+          MLMD_BATCH_CALL(GetContextsByExecution),
+          MLMD_BATCH_CALL(GetExecutionDetails),
+          MLMD_BATCH_CALL(GetArtifactsByContext),
+          MLMD_BATCH_CALL(GetExecutionsByContext),
+          MLMD_BATCH_CALL(GetArtifactsByContexts),
+          MLMD_BATCH_CALL(GetExecutionsByContexts),
+          MLMD_BATCH_CALL(GetParentContextsByContext),
+          MLMD_BATCH_CALL(GetChildrenContextsByContext),
+          MLMD_BATCH_CALL(GetAncestorContexts),
+          MLMD_BATCH_CALL(GetDescendantContexts),
+          MLMD_BATCH_CALL(GetLineageGraph),
+          MLMD_BATCH_CALL(GetArtifactsByDerivation),
+          MLMD_BATCH_CALL(GetChanges),
+          MLMD_BATCH_CALL(CountArtifacts),
+          MLMD_BATCH_CALL(CountExecutions),
+          MLMD_BATCH_CALL(CountContexts),
+      });
+#undef MLMD_BATCH_CALL
+  return *kBatchCalls;
+}
+
 }  // namespace
 
+template <typename Request, typename Response>
+absl::Status MetadataStore::ReadThroughLookupCache(
+    const Request& request, Response* response,
+    const std::function<absl::Status()>& txn_body) {
+  if (lookup_cache_ == nullptr || in_joined_transaction_) {
+    return transaction_executor_->ExecuteReadOnly(
+        txn_body, request.transaction_options());
+  }
+  const std::string key = absl::StrCat(Request::descriptor()->name(), ":",
+                                       request.SerializeAsString());
+  LookupCache::Result result;
+  if (lookup_cache_->Find(key, &result)) {
+    response->Clear();
+    if (result.status.ok() && !response->ParseFromString(result.response)) {
+      return absl::InternalError(
+          absl::StrCat("Cannot parse the cached response of ", key));
+    }
+    return result.status;
+  }
+  // The generation is captured before the read, so that the result is not
+  // cached if a write invalidates it meanwhile.
+  const int64 generation = lookup_cache_->generation();
+  const absl::Status status = transaction_executor_->ExecuteReadOnly(
+      txn_body, request.transaction_options());
+  if (status.ok() || absl::IsNotFound(status)) {
+    result.status = status;
+    if (status.ok()) {
+      result.response = response->SerializeAsString();
+    }
+    DescribeLookupResult(request, *response, &result);
+    lookup_cache_->Insert(key, generation, std::move(result));
+  }
+  return status;
+}
+
+void MetadataStore::InvalidateLookups(
+    const LookupCache::Invalidation& invalidation) {
+  if (in_joined_transaction_) {
+    pending_invalidation_.Merge(invalidation);
+    return;
+  }
+  lookup_cache_->Invalidate(invalidation);
+}
+
+void MetadataStore::AdvanceLineageWatermarks(
+    const LineageResultCache::Write& write) {
+  if (in_joined_transaction_) {
+    pending_lineage_write_.Merge(write);
+    return;
+  }
+  lineage_result_cache_->Advance(write);
+}
+
 absl::Status MetadataStore::InitMetadataStore() {
   MLMD_RETURN_IF_ERROR(transaction_executor_->Execute([this]() -> absl::Status {
     return metadata_access_object_->InitMetadataSource();
   }));
-  return transaction_executor_->Execute([this]() -> absl::Status {
-    return UpsertSimpleTypes(metadata_access_object_.get());
-  });
+  return UpsertSimpleTypesIfChanged();
 }
 
 // TODO(b/187357155): duplicated results when inserting simple types
@@ -438,11 +985,76 @@ absl::Status MetadataStore::InitMetadataStoreIfNotExists(
         return metadata_access_object_->InitMetadataSourceIfNotExists(
             enable_upgrade_migration);
       }));
+  return UpsertSimpleTypesIfChanged();
+}
+
+absl::Status MetadataStore::UpsertSimpleTypesIfChanged() {
+  if (database_key_.empty()) {
+    return transaction_executor_->Execute([this]() -> absl::Status {
+      return UpsertSimpleTypes(metadata_access_object_.get());
+    });
+  }
+  SimpleTypesGenerations& known = GetSimpleTypesGenerations();
+  absl::optional<int64> known_generation;
+  {
+    absl::MutexLock lock(&known.mu);
+    const auto it = known.generations.find(database_key_);
+    if (it != known.generations.end()) known_generation = it->second;
+  }
+  if (known_generation.has_value()) {
+    int64 type_generation = 0;
+    const absl::Status status =
+        transaction_executor_->ExecuteReadOnly([&]() -> absl::Status {
+          return metadata_access_object_->GetTypeGeneration(&type_generation);
+        });
+    // A database without type generation always upserts the simple types.
+    if (!absl::IsFailedPrecondition(status)) {
+      MLMD_RETURN_IF_ERROR(status);
+      // The generation of a new database is 0 before any type is stored.
+      if (type_generation > 0 && type_generation == *known_generation) {
+        return absl::OkStatus();
+      }
+    }
+  }
+  absl::optional<int64> upserted_generation;
+  MLMD_RETURN_IF_ERROR(transaction_executor_->Execute([&]() -> absl::Status {
+    upserted_generation = absl::nullopt;
+    MLMD_RETURN_IF_ERROR(UpsertSimpleTypes(metadata_access_object_.get()));
+    int64 type_generation = 0;
+    const absl::Status status =
+        metadata_access_object_->GetTypeGeneration(&type_generation);
+    if (absl::IsFailedPrecondition(status)) return absl::OkStatus();
+    MLMD_RETURN_IF_ERROR(status);
+    upserted_generation = type_generation;
+    return absl::OkStatus();
+  }));
+  // The generation is known once the upsert commits.
+  if (upserted_generation.has_value()) {
+    absl::MutexLock lock(&known.mu);
+    known.generations[database_key_] = *upserted_generation;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MetadataStore::VerifySchemaVersion() {
   return transaction_executor_->Execute([this]() -> absl::Status {
-    return UpsertSimpleTypes(metadata_access_object_.get());
+    int64 db_version = 0;
+    MLMD_RETURN_IF_ERROR(
+        metadata_access_object_->GetSchemaVersion(&db_version));
+    const int64 lib_version = metadata_access_object_->GetLibraryVersion();
+    if (db_version != lib_version) {
+      return absl::FailedPreconditionError(
+          absl::StrCat("MLMD database version ", db_version,
+                       " is different from library version ", lib_version,
+                       ". Please use a database of the library version."));
+    }
+    return absl::OkStatus();
   });
 }
 
+absl::Status MetadataStore::CheckConnection() {
+  return metadata_source_->CheckConnection();
+}
 
 
 absl::Status MetadataStore::PutTypes(const PutTypesRequest& request,
@@ -450,7 +1062,7 @@ absl::Status MetadataStore::PutTypes(const PutTypesRequest& request,
   if (!request.all_fields_match()) {
     return absl::UnimplementedError("Must match all fields.");
   }
-  return transaction_executor_->Execute(
+  const absl::Status status = transaction_executor_->Execute(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         return UpsertTypes(request.artifact_types(), request.execution_types(),
@@ -459,6 +1071,10 @@ absl::Status MetadataStore::PutTypes(const PutTypesRequest& request,
                            metadata_access_object_.get(), response);
       },
       request.transaction_options());
+  if (lookup_cache_ != nullptr) {
+    InvalidateLookups(TypesInvalidation());
+  }
+  return status;
 }
 
 absl::Status MetadataStore::PutArtifactType(
@@ -466,7 +1082,7 @@ absl::Status MetadataStore::PutArtifactType(
   if (!request.all_fields_match()) {
     return absl::UnimplementedError("Must match all fields.");
   }
-  return transaction_executor_->Execute(
+  const absl::Status status = transaction_executor_->Execute(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         int64 type_id;
@@ -478,6 +1094,10 @@ absl::Status MetadataStore::PutArtifactType(
         return absl::OkStatus();
       },
       request.transaction_options());
+  if (lookup_cache_ != nullptr) {
+    InvalidateLookups(TypesInvalidation());
+  }
+  return status;
 }
 
 absl::Status MetadataStore::PutExecutionType(
@@ -486,7 +1106,7 @@ absl::Status MetadataStore::PutExecutionType(
   if (!request.all_fields_match()) {
     return absl::UnimplementedError("Must match all fields.");
   }
-  return transaction_executor_->Execute(
+  const absl::Status status = transaction_executor_->Execute(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         int64 type_id;
@@ -498,6 +1118,10 @@ absl::Status MetadataStore::PutExecutionType(
         return absl::OkStatus();
       },
       request.transaction_options());
+  if (lookup_cache_ != nullptr) {
+    InvalidateLookups(TypesInvalidation());
+  }
+  return status;
 }
 
 absl::Status MetadataStore::PutContextType(const PutContextTypeRequest& request,
@@ -505,7 +1129,7 @@ absl::Status MetadataStore::PutContextType(const PutContextTypeRequest& request,
   if (!request.all_fields_match()) {
     return absl::UnimplementedError("Must match all fields.");
   }
-  return transaction_executor_->Execute(
+  const absl::Status status = transaction_executor_->Execute(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         int64 type_id;
@@ -517,12 +1141,16 @@ absl::Status MetadataStore::PutContextType(const PutContextTypeRequest& request,
         return absl::OkStatus();
       },
       request.transaction_options());
+  if (lookup_cache_ != nullptr) {
+    InvalidateLookups(TypesInvalidation());
+  }
+  return status;
 }
 
 absl::Status MetadataStore::GetArtifactType(
     const GetArtifactTypeRequest& request, GetArtifactTypeResponse* response) {
-  return transaction_executor_->Execute(
-      [this, &request, &response]() -> absl::Status {
+  return ReadThroughLookupCache(
+      request, response, [this, &request, &response]() -> absl::Status {
         response->Clear();
         ArtifactType type;
         MLMD_RETURN_IF_ERROR(metadata_access_object_->FindTypeByNameAndVersion(
@@ -533,15 +1161,14 @@ absl::Status MetadataStore::GetArtifactType(
                 absl::MakeSpan(types), metadata_access_object_.get()));
         *response->mutable_artifact_type() = type;
         return absl::OkStatus();
-      },
-      request.transaction_options());
+      });
 }
 
 absl::Status MetadataStore::GetExecutionType(
     const GetExecutionTypeRequest& request,
     GetExecutionTypeResponse* response) {
-  return transaction_executor_->Execute(
-      [this, &request, &response]() -> absl::Status {
+  return ReadThroughLookupCache(
+      request, response, [this, &request, &response]() -> absl::Status {
         response->Clear();
         ExecutionType type;
         MLMD_RETURN_IF_ERROR(metadata_access_object_->FindTypeByNameAndVersion(
@@ -552,35 +1179,35 @@ absl::Status MetadataStore::GetExecutionType(
                 absl::MakeSpan(types), metadata_access_object_.get()));
         *response->mutable_execution_type() = type;
         return absl::OkStatus();
-      },
-      request.transaction_options());
+      });
 }
 
 absl::Status MetadataStore::GetContextType(const GetContextTypeRequest& request,
                                            GetContextTypeResponse* response) {
-  return transaction_executor_->Execute(
-      [this, &request, &response]() -> absl::Status {
+  return ReadThroughLookupCache(
+      request, response, [this, &request, &response]() -> absl::Status {
         response->Clear();
         return metadata_access_object_->FindTypeByNameAndVersion(
             request.type_name(), GetRequestTypeVersion(request),
             response->mutable_context_type());
-      },
-      request.transaction_options());
+      });
 }
 
 absl::Status MetadataStore::GetArtifactTypesByID(
     const GetArtifactTypesByIDRequest& request,
     GetArtifactTypesByIDResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
+        response->mutable_artifact_types()->Reserve(request.type_ids_size());
         for (const int64 type_id : request.type_ids()) {
           ArtifactType artifact_type;
           // TODO(b/218884256): replace FindTypeById with FindTypesById.
           const absl::Status status =
               metadata_access_object_->FindTypeById(type_id, &artifact_type);
           if (status.ok()) {
-            *response->mutable_artifact_types()->Add() = artifact_type;
+            *response->mutable_artifact_types()->Add() =
+                std::move(artifact_type);
           } else if (!absl::IsNotFound(status)) {
             return status;
           }
@@ -599,15 +1226,17 @@ absl::Status MetadataStore::GetArtifactTypesByID(
 absl::Status MetadataStore::GetExecutionTypesByID(
     const GetExecutionTypesByIDRequest& request,
     GetExecutionTypesByIDResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
+        response->mutable_execution_types()->Reserve(request.type_ids_size());
         for (const int64 type_id : request.type_ids()) {
           ExecutionType execution_type;
           const absl::Status status =
               metadata_access_object_->FindTypeById(type_id, &execution_type);
           if (status.ok()) {
-            *response->mutable_execution_types()->Add() = execution_type;
+            *response->mutable_execution_types()->Add() =
+                std::move(execution_type);
           } else if (!absl::IsNotFound(status)) {
             return status;
           }
@@ -626,15 +1255,16 @@ absl::Status MetadataStore::GetExecutionTypesByID(
 absl::Status MetadataStore::GetContextTypesByID(
     const GetContextTypesByIDRequest& request,
     GetContextTypesByIDResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
+        response->mutable_context_types()->Reserve(request.type_ids_size());
         for (const int64 type_id : request.type_ids()) {
           ContextType context_type;
           const absl::Status status =
               metadata_access_object_->FindTypeById(type_id, &context_type);
           if (status.ok()) {
-            *response->mutable_context_types()->Add() = context_type;
+            *response->mutable_context_types()->Add() = std::move(context_type);
           } else if (!absl::IsNotFound(status)) {
             return status;
           }
@@ -647,7 +1277,7 @@ absl::Status MetadataStore::GetContextTypesByID(
 absl::Status MetadataStore::GetArtifactsByID(
     const GetArtifactsByIDRequest& request,
     GetArtifactsByIDResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Artifact> artifacts;
@@ -658,7 +1288,12 @@ absl::Status MetadataStore::GetArtifactsByID(
         if (!status.ok() && !absl::IsNotFound(status)) {
           return status;
         }
-        absl::c_copy(artifacts, google::protobuf::RepeatedPtrFieldBackInserter(
+        if (request.populate_type_names()) {
+          MLMD_RETURN_IF_ERROR(PopulateTypeNames<ArtifactType>(
+              metadata_access_object_.get(), &artifacts));
+        }
+        response->mutable_artifacts()->Reserve(artifacts.size());
+        absl::c_move(artifacts, google::protobuf::RepeatedPtrFieldBackInserter(
                                     response->mutable_artifacts()));
         return absl::OkStatus();
       },
@@ -668,7 +1303,7 @@ absl::Status MetadataStore::GetArtifactsByID(
 absl::Status MetadataStore::GetExecutionsByID(
     const GetExecutionsByIDRequest& request,
     GetExecutionsByIDResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Execution> executions;
@@ -679,7 +1314,12 @@ absl::Status MetadataStore::GetExecutionsByID(
         if (!status.ok() && !absl::IsNotFound(status)) {
           return status;
         }
-        absl::c_copy(executions, google::protobuf::RepeatedPtrFieldBackInserter(
+        if (request.populate_type_names()) {
+          MLMD_RETURN_IF_ERROR(PopulateTypeNames<ExecutionType>(
+              metadata_access_object_.get(), &executions));
+        }
+        response->mutable_executions()->Reserve(executions.size());
+        absl::c_move(executions, google::protobuf::RepeatedPtrFieldBackInserter(
                                      response->mutable_executions()));
         return absl::OkStatus();
       },
@@ -688,7 +1328,7 @@ absl::Status MetadataStore::GetExecutionsByID(
 
 absl::Status MetadataStore::GetContextsByID(
     const GetContextsByIDRequest& request, GetContextsByIDResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Context> contexts;
@@ -699,7 +1339,12 @@ absl::Status MetadataStore::GetContextsByID(
         if (!status.ok() && !absl::IsNotFound(status)) {
           return status;
         }
-        absl::c_copy(contexts, google::protobuf::RepeatedFieldBackInserter(
+        if (request.populate_type_names()) {
+          MLMD_RETURN_IF_ERROR(PopulateTypeNames<ContextType>(
+              metadata_access_object_.get(), &contexts));
+        }
+        response->mutable_contexts()->Reserve(contexts.size());
+        absl::c_move(contexts, google::protobuf::RepeatedFieldBackInserter(
                                    response->mutable_contexts()));
         return absl::OkStatus();
       },
@@ -708,81 +1353,118 @@ absl::Status MetadataStore::GetContextsByID(
 
 absl::Status MetadataStore::PutArtifacts(const PutArtifactsRequest& request,
                                          PutArtifactsResponse* response) {
-  return transaction_executor_->Execute([this, &request,
-                                         &response]() -> absl::Status {
-    response->Clear();
-    for (const Artifact& artifact : request.artifacts()) {
-      int64 artifact_id = -1;
-      // Verify the latest_updated_time before upserting the artifact.
-      if (artifact.has_id() &&
-          request.options().abort_if_latest_updated_time_changed()) {
-        Artifact existing_artifact;
-        absl::Status status;
-        {
-          std::vector<Artifact> artifacts;
-          status = metadata_access_object_->FindArtifactsById({artifact.id()},
-                                                              &artifacts);
-          if (status.ok()) {
-            existing_artifact = artifacts.at(0);
+  const absl::Status status = transaction_executor_->Execute(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        // Verifies the last_update_time_since_epoch of the artifacts to update
+        // with a single read, which locks them until the updates are
+        // committed. As each update increases the stored time, an unchanged
+        // time means that no other writer has updated the artifact. An
+        // artifact updated twice by the request is rejected, as its second
+        // update would follow the change of its time by the first one.
+        if (request.options().abort_if_latest_updated_time_changed()) {
+          std::vector<int64> artifact_ids;
+          absl::flat_hash_set<int64> unique_artifact_ids;
+          for (const Artifact& artifact : request.artifacts()) {
+            if (!artifact.has_id()) {
+              continue;
+            }
+            if (!unique_artifact_ids.insert(artifact.id()).second) {
+              return absl::FailedPreconditionError(absl::StrCat(
+                  "`abort_if_latest_updated_time_changed` is set, and the "
+                  "artifact with id = ",
+                  artifact.id(), " is updated more than once by the request."));
+            }
+            artifact_ids.push_back(artifact.id());
           }
-        }
-        if (!absl::IsNotFound(status)) {
-          MLMD_RETURN_IF_ERROR(status);
-          if (artifact.last_update_time_since_epoch() !=
-              existing_artifact.last_update_time_since_epoch()) {
-            return absl::FailedPreconditionError(absl::StrCat(
-                "`abort_if_latest_updated_time_changed` is set, and the stored "
-                "artifact with id = ",
-                artifact.id(),
-                " has a different last_update_time_since_epoch: ",
-                existing_artifact.last_update_time_since_epoch(),
-                " from the one in the given artifact: ",
-                artifact.last_update_time_since_epoch()));
+          absl::flat_hash_map<int64, int64> last_update_times;
+          MLMD_RETURN_IF_ERROR(
+              metadata_access_object_->FindArtifactLastUpdateTimes(
+                  artifact_ids, &last_update_times));
+          for (const Artifact& artifact : request.artifacts()) {
+            const auto it = last_update_times.find(artifact.id());
+            if (!artifact.has_id() || it == last_update_times.end()) {
+              continue;
+            }
+            if (artifact.last_update_time_since_epoch() != it->second) {
+              return absl::FailedPreconditionError(absl::StrCat(
+                  "`abort_if_latest_updated_time_changed` is set, and the "
+                  "stored artifact with id = ",
+                  artifact.id(),
+                  " has a different last_update_time_since_epoch: ",
+                  it->second, " from the one in the given artifact: ",
+                  artifact.last_update_time_since_epoch()));
+            }
           }
-          // If set the option and all check succeeds, we make sure the
-          // timestamp after the update increases.
-          absl::SleepFor(absl::Milliseconds(1));
         }
-      }
-      MLMD_RETURN_IF_ERROR(UpsertArtifact(
-          artifact, metadata_access_object_.get(), &artifact_id));
-      response->add_artifact_ids(artifact_id);
-    }
-    return absl::OkStatus();
-  },
-  request.transaction_options());
+        std::vector<int64> artifact_ids;
+        MLMD_RETURN_IF_ERROR(UpsertNodes<Artifact>(
+            request.artifacts(),
+            [this](const Artifact& artifact) {
+              return metadata_access_object_->UpdateArtifact(artifact);
+            },
+            metadata_access_object_.get(), &artifact_ids));
+        response->mutable_artifact_ids()->Reserve(artifact_ids.size());
+        absl::c_copy(artifact_ids, google::protobuf::RepeatedFieldBackInserter(
+                                       response->mutable_artifact_ids()));
+        return absl::OkStatus();
+      },
+      request.transaction_options());
+  if (lineage_result_cache_ != nullptr) {
+    AdvanceLineageWatermarks({/*lineage=*/true, /*contexts=*/false});
+  }
+  return status;
 }
 
 absl::Status MetadataStore::PutExecutions(const PutExecutionsRequest& request,
                                           PutExecutionsResponse* response) {
-  return transaction_executor_->Execute(
+  const absl::Status status = transaction_executor_->Execute(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
-        for (const Execution& execution : request.executions()) {
-          int64 execution_id = -1;
-          MLMD_RETURN_IF_ERROR(UpsertExecution(
-              execution, metadata_access_object_.get(), &execution_id));
-          response->add_execution_ids(execution_id);
-        }
+        std::vector<int64> execution_ids;
+        MLMD_RETURN_IF_ERROR(UpsertNodes<Execution>(
+            request.executions(),
+            [this](const Execution& execution) {
+              return metadata_access_object_->UpdateExecution(execution);
+            },
+            metadata_access_object_.get(), &execution_ids));
+        response->mutable_execution_ids()->Reserve(execution_ids.size());
+        absl::c_copy(execution_ids, google::protobuf::RepeatedFieldBackInserter(
+                                        response->mutable_execution_ids()));
         return absl::OkStatus();
       },
       request.transaction_options());
+  if (lineage_result_cache_ != nullptr) {
+    AdvanceLineageWatermarks({/*lineage=*/true, /*contexts=*/false});
+  }
+  return status;
 }
 
 absl::Status MetadataStore::PutContexts(const PutContextsRequest& request,
                                         PutContextsResponse* response) {
-  return transaction_executor_->Execute(
+  const absl::Status status = transaction_executor_->Execute(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
-        for (const Context& context : request.contexts()) {
-          int64 context_id = -1;
-          MLMD_RETURN_IF_ERROR(UpsertContext(
-              context, metadata_access_object_.get(), &context_id));
-          response->add_context_ids(context_id);
-        }
+        std::vector<int64> context_ids;
+        MLMD_RETURN_IF_ERROR(UpsertNodes<Context>(
+            request.contexts(),
+            [this](const Context& context) {
+              return metadata_access_object_->UpdateContext(context);
+            },
+            metadata_access_object_.get(), &context_ids));
+        response->mutable_context_ids()->Reserve(context_ids.size());
+        absl::c_copy(context_ids, google::protobuf::RepeatedFieldBackInserter(
+                                      response->mutable_context_ids()));
         return absl::OkStatus();
       },
       request.transaction_options());
+  if (lookup_cache_ != nullptr) {
+    InvalidateLookups(ContextsInvalidation(request.contexts()));
+  }
+  if (lineage_result_cache_ != nullptr) {
+    AdvanceLineageWatermarks({/*lineage=*/false, /*contexts=*/true});
+  }
+  return status;
 }
 
 absl::Status MetadataStore::Create(
@@ -808,6 +1490,20 @@ absl::Status MetadataStore::Create(
         ". Please refer to the migration guide and use lower version of the "
         "library to connect to the metadata store."));
   }
+  // An online upgrade commits each of its steps in its own transaction, so the
+  // database stays available to the clients of the previous schema version.
+  if (migration_options.enable_upgrade_migration() &&
+      migration_options.enable_online_upgrade_migration()) {
+    bool done = false;
+    while (!done) {
+      MLMD_RETURN_IF_ERROR(transaction_executor->Execute(
+          [&migration_options, &metadata_access_object,
+           &done]() -> absl::Status {
+            return metadata_access_object->UpgradeMetadataSourceOnlineStep(
+                migration_options.online_upgrade_batch_size(), &done);
+          }));
+    }
+  }
   *result = absl::WrapUnique(new MetadataStore(
       std::move(metadata_source), std::move(metadata_access_object),
       std::move(transaction_executor)));
@@ -816,7 +1512,7 @@ absl::Status MetadataStore::Create(
 
 absl::Status MetadataStore::PutEvents(const PutEventsRequest& request,
                                       PutEventsResponse* response) {
-  return transaction_executor_->Execute(
+  const absl::Status status = transaction_executor_->Execute(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         for (const Event& event : request.events()) {
@@ -827,12 +1523,17 @@ absl::Status MetadataStore::PutEvents(const PutEventsRequest& request,
         return absl::OkStatus();
       },
       request.transaction_options());
+  if (lineage_result_cache_ != nullptr) {
+    AdvanceLineageWatermarks({/*lineage=*/true, /*contexts=*/false});
+  }
+  return status;
 }
 
 absl::Status MetadataStore::PutExecution(const PutExecutionRequest& request,
                                          PutExecutionResponse* response) {
-  return transaction_executor_->Execute([this, &request,
-                                         &response]() -> absl::Status {
+  const absl::Status status =
+      transaction_executor_->Execute([this, &request,
+                                     &response]() -> absl::Status {
     response->Clear();
     if (!request.has_execution()) {
       return absl::InvalidArgumentError(
@@ -844,89 +1545,130 @@ absl::Status MetadataStore::PutExecution(const PutExecutionRequest& request,
     MLMD_RETURN_IF_ERROR(UpsertExecution(
         execution, metadata_access_object_.get(), &execution_id));
     response->set_execution_id(execution_id);
-    // 2. Upsert Artifacts and insert events
-    for (PutExecutionRequest::ArtifactAndEvent artifact_and_event :
+    // 2. Upsert Artifacts and insert events. The new artifacts and the events
+    // are written in batches.
+    google::protobuf::RepeatedPtrField<Artifact> artifacts;
+    for (const PutExecutionRequest::ArtifactAndEvent& artifact_and_event :
          request.artifact_event_pairs()) {
       // validate execution and event if given
       if (artifact_and_event.has_event()) {
-        Event* event = artifact_and_event.mutable_event();
-        if (event->has_execution_id() &&
-            (!execution.has_id() || execution.id() != event->execution_id())) {
+        const Event& event = artifact_and_event.event();
+        if (event.has_execution_id() &&
+            (!execution.has_id() || execution.id() != event.execution_id())) {
           return absl::InvalidArgumentError(absl::StrCat(
               "Request's event.execution_id does not match with the given "
               "execution: ",
               request.DebugString()));
         }
-        event->set_execution_id(execution_id);
       }
+      MLMD_RETURN_IF_ERROR(ValidateArtifactAndEvent(artifact_and_event));
+      if (artifact_and_event.has_artifact()) {
+        *artifacts.Add() = artifact_and_event.artifact();
+      }
+    }
+    std::vector<int64> upserted_artifact_ids;
+    MLMD_RETURN_IF_ERROR(UpsertNodes<Artifact>(
+        artifacts,
+        [this](const Artifact& artifact) {
+          return metadata_access_object_->UpdateArtifact(artifact);
+        },
+        metadata_access_object_.get(), &upserted_artifact_ids));
+    auto upserted_artifact_id = upserted_artifact_ids.begin();
+    std::vector<Event> events;
+    for (const PutExecutionRequest::ArtifactAndEvent& artifact_and_event :
+         request.artifact_event_pairs()) {
       int64 artifact_id = -1;
-      MLMD_RETURN_IF_ERROR(UpsertArtifactAndEvent(
-          artifact_and_event, metadata_access_object_.get(), &artifact_id));
+      if (artifact_and_event.has_artifact()) {
+        artifact_id = *upserted_artifact_id++;
+      } else if (artifact_and_event.has_event()) {
+        artifact_id = artifact_and_event.event().artifact_id();
+      }
       response->add_artifact_ids(artifact_id);
+      if (artifact_and_event.has_event()) {
+        events.push_back(artifact_and_event.event());
+        events.back().set_artifact_id(artifact_id);
+        events.back().set_execution_id(execution_id);
+      }
     }
-    // 3. Upsert contexts and insert associations and attributions.
+    std::vector<int64> dummy_event_ids;
+    MLMD_RETURN_IF_ERROR(
+        metadata_access_object_->CreateEvents(events, &dummy_event_ids));
+    // 3. Upsert contexts and insert associations and attributions. The
+    // associations and attributions are collected and written in batches, and
+    // the existing ones are skipped.
+    std::vector<Association> associations;
+    std::vector<Attribution> attributions;
     for (const Context& context : request.contexts()) {
       int64 context_id = -1;
-      // Try to reuse existing context if the options is set.
+      // Reuse the stored context with the same name if the option is set. The
+      // context is created or found with a single statement, so concurrent
+      // transactions creating the same new context do not fail.
       if (request.options().reuse_context_if_already_exist() &&
           !context.has_id()) {
-        Context existing_context;
-        const absl::Status status =
-            metadata_access_object_->FindContextByTypeIdAndContextName(
-                context.type_id(), context.name(), &existing_context);
-        if (!absl::IsNotFound(status)) {
-          MLMD_RETURN_IF_ERROR(status);
-          context_id = existing_context.id();
-        }
-      }
-      if (context_id == -1) {
-        const absl::Status status =
-            UpsertContext(context, metadata_access_object_.get(), &context_id);
-        // When `reuse_context_if_already_exist`, there are concurrent timelines
-        // to create the same new context. If use the option, let client side
-        // to retry the failed transaction safely.
-        if (request.options().reuse_context_if_already_exist() &&
-            absl::IsAlreadyExists(status)) {
-          return absl::AbortedError(absl::StrCat(
-              "Concurrent creation of the same context at the first time. "
-              "Retry the transaction to reuse the context: ",
-              context.DebugString()));
-        }
-        MLMD_RETURN_IF_ERROR(status);
+        bool is_created = false;
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->CreateContextIfNotExist(
+            context, &context_id, &is_created));
+      } else {
+        MLMD_RETURN_IF_ERROR(
+            UpsertContext(context, metadata_access_object_.get(), &context_id));
       }
       response->add_context_ids(context_id);
-      MLMD_RETURN_IF_ERROR(InsertAssociationIfNotExist(
-          context_id, response->execution_id(), metadata_access_object_.get()));
+      Association association;
+      association.set_context_id(context_id);
+      association.set_execution_id(execution_id);
+      associations.push_back(association);
       for (const int64 artifact_id : response->artifact_ids()) {
-        MLMD_RETURN_IF_ERROR(InsertAttributionIfNotExist(
-            context_id, artifact_id, metadata_access_object_.get()));
+        Attribution attribution;
+        attribution.set_context_id(context_id);
+        attribution.set_artifact_id(artifact_id);
+        attributions.push_back(attribution);
       }
     }
-    return absl::OkStatus();
+    MLMD_RETURN_IF_ERROR(
+        metadata_access_object_->CreateAssociationsIfNotExist(associations));
+    return metadata_access_object_->CreateAttributionsIfNotExist(attributions);
   },
   request.transaction_options());
+  if (lookup_cache_ != nullptr && !request.contexts().empty()) {
+    InvalidateLookups(ContextsInvalidation(request.contexts()));
+  }
+  if (lineage_result_cache_ != nullptr) {
+    AdvanceLineageWatermarks({/*lineage=*/true, /*contexts=*/true});
+  }
+  return status;
 }
 
 
 absl::Status MetadataStore::GetEventsByExecutionIDs(
     const GetEventsByExecutionIDsRequest& request,
     GetEventsByExecutionIDsResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Event> events;
-        const absl::Status status =
-            metadata_access_object_->FindEventsByExecutions(
-                std::vector<int64>(request.execution_ids().begin(),
-                                   request.execution_ids().end()),
-                &events);
-        if (absl::IsNotFound(status)) {
-          return absl::OkStatus();
-        } else if (!status.ok()) {
-          return status;
+        if (request.has_options()) {
+          const std::vector<Event::Type> event_types = EventTypes(request);
+          MLMD_RETURN_IF_ERROR(metadata_access_object_->ListEventsByExecutions(
+              std::vector<int64>(request.execution_ids().begin(),
+                                 request.execution_ids().end()),
+              event_types, request.options(), &events,
+              response->mutable_next_page_token()));
+        } else {
+          const absl::Status status =
+              metadata_access_object_->FindEventsByExecutions(
+                  std::vector<int64>(request.execution_ids().begin(),
+                                     request.execution_ids().end()),
+                  &events);
+          if (absl::IsNotFound(status)) {
+            return absl::OkStatus();
+          } else if (!status.ok()) {
+            return status;
+          }
+          FilterEventsByType(request, &events);
         }
-        for (const Event& event : events) {
-          *response->mutable_events()->Add() = event;
+        response->mutable_events()->Reserve(events.size());
+        for (Event& event : events) {
+          *response->mutable_events()->Add() = std::move(event);
         }
         return absl::OkStatus();
       },
@@ -936,22 +1678,62 @@ absl::Status MetadataStore::GetEventsByExecutionIDs(
 absl::Status MetadataStore::GetEventsByArtifactIDs(
     const GetEventsByArtifactIDsRequest& request,
     GetEventsByArtifactIDsResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Event> events;
-        const absl::Status status =
-            metadata_access_object_->FindEventsByArtifacts(
-                std::vector<int64>(request.artifact_ids().begin(),
-                                   request.artifact_ids().end()),
-                &events);
-        if (absl::IsNotFound(status)) {
-          return absl::OkStatus();
-        } else if (!status.ok()) {
-          return status;
+        if (request.has_options()) {
+          const std::vector<Event::Type> event_types = EventTypes(request);
+          MLMD_RETURN_IF_ERROR(metadata_access_object_->ListEventsByArtifacts(
+              std::vector<int64>(request.artifact_ids().begin(),
+                                 request.artifact_ids().end()),
+              event_types, request.options(), &events,
+              response->mutable_next_page_token()));
+        } else {
+          const absl::Status status =
+              metadata_access_object_->FindEventsByArtifacts(
+                  std::vector<int64>(request.artifact_ids().begin(),
+                                     request.artifact_ids().end()),
+                  &events);
+          if (absl::IsNotFound(status)) {
+            return absl::OkStatus();
+          } else if (!status.ok()) {
+            return status;
+          }
+          FilterEventsByType(request, &events);
         }
-        for (const Event& event : events) {
-          *response->mutable_events()->Add() = event;
+        response->mutable_events()->Reserve(events.size());
+        for (Event& event : events) {
+          *response->mutable_events()->Add() = std::move(event);
+        }
+        return absl::OkStatus();
+      },
+      request.transaction_options());
+}
+
+absl::Status MetadataStore::GetEventsByTimeRange(
+    const GetEventsByTimeRangeRequest& request,
+    GetEventsByTimeRangeResponse* response) {
+  return transaction_executor_->ExecuteReadOnly(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        ListOperationOptions options = request.options();
+        if (!options.has_order_by_field()) {
+          options.mutable_order_by_field()->set_field(
+              ListOperationOptions::OrderByField::CREATE_TIME);
+        }
+        const std::vector<Event::Type> event_types = EventTypes(request);
+        std::vector<Event> events;
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->ListEventsByTimeRange(
+            request.min_milliseconds_since_epoch(),
+            request.has_max_milliseconds_since_epoch()
+                ? absl::make_optional(request.max_milliseconds_since_epoch())
+                : absl::nullopt,
+            event_types, options, &events,
+            response->mutable_next_page_token()));
+        response->mutable_events()->Reserve(events.size());
+        for (Event& event : events) {
+          *response->mutable_events()->Add() = std::move(event);
         }
         return absl::OkStatus();
       },
@@ -960,7 +1742,7 @@ absl::Status MetadataStore::GetEventsByArtifactIDs(
 
 absl::Status MetadataStore::GetExecutions(const GetExecutionsRequest& request,
                                           GetExecutionsResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Execution> executions;
@@ -978,9 +1760,19 @@ absl::Status MetadataStore::GetExecutions(const GetExecutionsRequest& request,
         } else if (!status.ok()) {
           return status;
         }
+        if (request.has_options()) {
+          MLMD_RETURN_IF_ERROR(TruncatePageToSoftMemoryLimit(
+              metadata_source_->memory_account(), request.options(),
+              &executions, &next_page_token));
+        }
 
-        for (const Execution& execution : executions) {
-          *response->mutable_executions()->Add() = execution;
+        if (request.options().populate_type_names()) {
+          MLMD_RETURN_IF_ERROR(PopulateTypeNames<ExecutionType>(
+              metadata_access_object_.get(), &executions));
+        }
+        response->mutable_executions()->Reserve(executions.size());
+        for (Execution& execution : executions) {
+          *response->mutable_executions()->Add() = std::move(execution);
         }
 
         if (!next_page_token.empty()) {
@@ -993,7 +1785,7 @@ absl::Status MetadataStore::GetExecutions(const GetExecutionsRequest& request,
 
 absl::Status MetadataStore::GetArtifacts(const GetArtifactsRequest& request,
                                          GetArtifactsResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Artifact> artifacts;
@@ -1011,9 +1803,19 @@ absl::Status MetadataStore::GetArtifacts(const GetArtifactsRequest& request,
         } else if (!status.ok()) {
           return status;
         }
+        if (request.has_options()) {
+          MLMD_RETURN_IF_ERROR(TruncatePageToSoftMemoryLimit(
+              metadata_source_->memory_account(), request.options(), &artifacts,
+              &next_page_token));
+        }
 
-        for (const Artifact& artifact : artifacts) {
-          *response->mutable_artifacts()->Add() = artifact;
+        if (request.options().populate_type_names()) {
+          MLMD_RETURN_IF_ERROR(PopulateTypeNames<ArtifactType>(
+              metadata_access_object_.get(), &artifacts));
+        }
+        response->mutable_artifacts()->Reserve(artifacts.size());
+        for (Artifact& artifact : artifacts) {
+          *response->mutable_artifacts()->Add() = std::move(artifact);
         }
 
         if (!next_page_token.empty()) {
@@ -1027,7 +1829,7 @@ absl::Status MetadataStore::GetArtifacts(const GetArtifactsRequest& request,
 
 absl::Status MetadataStore::GetContexts(const GetContextsRequest& request,
                                         GetContextsResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Context> contexts;
@@ -1045,9 +1847,19 @@ absl::Status MetadataStore::GetContexts(const GetContextsRequest& request,
         } else if (!status.ok()) {
           return status;
         }
+        if (request.has_options()) {
+          MLMD_RETURN_IF_ERROR(TruncatePageToSoftMemoryLimit(
+              metadata_source_->memory_account(), request.options(), &contexts,
+              &next_page_token));
+        }
 
-        for (const Context& context : contexts) {
-          *response->mutable_contexts()->Add() = context;
+        if (request.options().populate_type_names()) {
+          MLMD_RETURN_IF_ERROR(PopulateTypeNames<ContextType>(
+              metadata_access_object_.get(), &contexts));
+        }
+        response->mutable_contexts()->Reserve(contexts.size());
+        for (Context& context : contexts) {
+          *response->mutable_contexts()->Add() = std::move(context);
         }
 
         if (!next_page_token.empty()) {
@@ -1062,7 +1874,7 @@ absl::Status MetadataStore::GetContexts(const GetContextsRequest& request,
 absl::Status MetadataStore::GetArtifactTypes(
     const GetArtifactTypesRequest& request,
     GetArtifactTypesResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &response]() -> absl::Status {
         response->Clear();
         std::vector<ArtifactType> artifact_types;
@@ -1073,16 +1885,15 @@ absl::Status MetadataStore::GetArtifactTypes(
         } else if (!status.ok()) {
           return status;
         }
-        absl::c_copy_if(
-            artifact_types,
-            google::protobuf::RepeatedFieldBackInserter(
-                response->mutable_artifact_types()),
-            [](const ArtifactType& type) {
-              // Simple types will not be returned by Get*Types APIs
-              // because they are invisible to users.
-              return std::find(kSimpleTypeNames.begin(), kSimpleTypeNames.end(),
-                               type.name()) == kSimpleTypeNames.end();
-            });
+        response->mutable_artifact_types()->Reserve(artifact_types.size());
+        for (ArtifactType& type : artifact_types) {
+          // Simple types will not be returned by Get*Types APIs
+          // because they are invisible to users.
+          if (std::find(kSimpleTypeNames.begin(), kSimpleTypeNames.end(),
+                        type.name()) == kSimpleTypeNames.end()) {
+            *response->mutable_artifact_types()->Add() = std::move(type);
+          }
+        }
         MLMD_RETURN_IF_ERROR(
             SetBaseType<ArtifactType, ArtifactType::SystemDefinedBaseType>(
                 absl::MakeSpan(const_cast<ArtifactType* const*>(
@@ -1097,7 +1908,7 @@ absl::Status MetadataStore::GetArtifactTypes(
 absl::Status MetadataStore::GetExecutionTypes(
     const GetExecutionTypesRequest& request,
     GetExecutionTypesResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &response]() -> absl::Status {
         response->Clear();
         std::vector<ExecutionType> execution_types;
@@ -1108,16 +1919,15 @@ absl::Status MetadataStore::GetExecutionTypes(
         } else if (!status.ok()) {
           return status;
         }
-        absl::c_copy_if(
-            execution_types,
-            google::protobuf::RepeatedFieldBackInserter(
-                response->mutable_execution_types()),
-            [](const ExecutionType& type) {
-              // Simple types will not be returned by Get*Types APIs
-              // because they are invisible to users.
-              return std::find(kSimpleTypeNames.begin(), kSimpleTypeNames.end(),
-                               type.name()) == kSimpleTypeNames.end();
-            });
+        response->mutable_execution_types()->Reserve(execution_types.size());
+        for (ExecutionType& type : execution_types) {
+          // Simple types will not be returned by Get*Types APIs
+          // because they are invisible to users.
+          if (std::find(kSimpleTypeNames.begin(), kSimpleTypeNames.end(),
+                        type.name()) == kSimpleTypeNames.end()) {
+            *response->mutable_execution_types()->Add() = std::move(type);
+          }
+        }
         MLMD_RETURN_IF_ERROR(
             SetBaseType<ExecutionType, ExecutionType::SystemDefinedBaseType>(
                 absl::MakeSpan(const_cast<ExecutionType* const*>(
@@ -1131,7 +1941,7 @@ absl::Status MetadataStore::GetExecutionTypes(
 
 absl::Status MetadataStore::GetContextTypes(
     const GetContextTypesRequest& request, GetContextTypesResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &response]() -> absl::Status {
         response->Clear();
         std::vector<ContextType> context_types;
@@ -1142,8 +1952,9 @@ absl::Status MetadataStore::GetContextTypes(
         } else if (!status.ok()) {
           return status;
         }
-        for (const ContextType& context_type : context_types) {
-          *response->mutable_context_types()->Add() = context_type;
+        response->mutable_context_types()->Reserve(context_types.size());
+        for (ContextType& context_type : context_types) {
+          *response->mutable_context_types()->Add() = std::move(context_type);
         }
         return absl::OkStatus();
       },
@@ -1165,7 +1976,7 @@ absl::Status MetadataStore::GetArtifactsByURI(
           request.DebugString()));
     }
   }
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         absl::flat_hash_set<std::string> uris(request.uris().begin(),
@@ -1179,8 +1990,9 @@ absl::Status MetadataStore::GetArtifactsByURI(
             // the query execution has internal db errors.
             return status;
           }
-          for (const Artifact& artifact : artifacts) {
-            *response->mutable_artifacts()->Add() = artifact;
+          response->mutable_artifacts()->Reserve(artifacts.size());
+          for (Artifact& artifact : artifacts) {
+            *response->mutable_artifacts()->Add() = std::move(artifact);
           }
         }
         return absl::OkStatus();
@@ -1191,7 +2003,7 @@ absl::Status MetadataStore::GetArtifactsByURI(
 absl::Status MetadataStore::GetArtifactsByType(
     const GetArtifactsByTypeRequest& request,
     GetArtifactsByTypeResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         int64 artifact_type_id;
@@ -1216,8 +2028,13 @@ absl::Status MetadataStore::GetArtifactsByType(
         } else if (!status.ok()) {
           return status;
         }
-        for (const Artifact& artifact : artifacts) {
-          *response->mutable_artifacts()->Add() = artifact;
+        if (request.options().populate_type_names()) {
+          MLMD_RETURN_IF_ERROR(PopulateTypeNames<ArtifactType>(
+              metadata_access_object_.get(), &artifacts));
+        }
+        response->mutable_artifacts()->Reserve(artifacts.size());
+        for (Artifact& artifact : artifacts) {
+          *response->mutable_artifacts()->Add() = std::move(artifact);
         }
         if (request.has_options()) {
           response->set_next_page_token(next_page_token);
@@ -1230,7 +2047,7 @@ absl::Status MetadataStore::GetArtifactsByType(
 absl::Status MetadataStore::GetArtifactByTypeAndName(
     const GetArtifactByTypeAndNameRequest& request,
     GetArtifactByTypeAndNameResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         int64 artifact_type_id;
@@ -1260,7 +2077,7 @@ absl::Status MetadataStore::GetArtifactByTypeAndName(
 absl::Status MetadataStore::GetExecutionsByType(
     const GetExecutionsByTypeRequest& request,
     GetExecutionsByTypeResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         int64 execution_type_id;
@@ -1285,8 +2102,13 @@ absl::Status MetadataStore::GetExecutionsByType(
         } else if (!status.ok()) {
           return status;
         }
-        for (const Execution& execution : executions) {
-          *response->mutable_executions()->Add() = execution;
+        if (request.options().populate_type_names()) {
+          MLMD_RETURN_IF_ERROR(PopulateTypeNames<ExecutionType>(
+              metadata_access_object_.get(), &executions));
+        }
+        response->mutable_executions()->Reserve(executions.size());
+        for (Execution& execution : executions) {
+          *response->mutable_executions()->Add() = std::move(execution);
         }
         if (request.has_options()) {
           response->set_next_page_token(next_page_token);
@@ -1296,10 +2118,43 @@ absl::Status MetadataStore::GetExecutionsByType(
       request.transaction_options());
 }
 
+absl::Status MetadataStore::GetActiveExecutionsByType(
+    const GetActiveExecutionsByTypeRequest& request,
+    GetActiveExecutionsByTypeResponse* response) {
+  return transaction_executor_->ExecuteReadOnly(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        int64 execution_type_id;
+        absl::Status status =
+            metadata_access_object_->FindTypeIdByNameAndVersion(
+                request.type_name(), GetRequestTypeVersion(request),
+                TypeKind::EXECUTION_TYPE, &execution_type_id);
+        if (absl::IsNotFound(status)) {
+          return absl::OkStatus();
+        } else if (!status.ok()) {
+          return status;
+        }
+        std::vector<Execution> executions;
+        status = metadata_access_object_->FindActiveExecutionsByTypeId(
+            execution_type_id, &executions);
+        if (absl::IsNotFound(status)) {
+          return absl::OkStatus();
+        } else if (!status.ok()) {
+          return status;
+        }
+        response->mutable_executions()->Reserve(executions.size());
+        for (Execution& execution : executions) {
+          *response->mutable_executions()->Add() = std::move(execution);
+        }
+        return absl::OkStatus();
+      },
+      request.transaction_options());
+}
+
 absl::Status MetadataStore::GetExecutionByTypeAndName(
     const GetExecutionByTypeAndNameRequest& request,
     GetExecutionByTypeAndNameResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         int64 execution_type_id;
@@ -1329,7 +2184,7 @@ absl::Status MetadataStore::GetExecutionByTypeAndName(
 absl::Status MetadataStore::GetContextsByType(
     const GetContextsByTypeRequest& request,
     GetContextsByTypeResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         int64 context_type_id;
@@ -1359,8 +2214,13 @@ absl::Status MetadataStore::GetContextsByType(
             return status;
           }
         }
-        for (const Context& context : contexts) {
-          *response->mutable_contexts()->Add() = context;
+        if (request.options().populate_type_names()) {
+          MLMD_RETURN_IF_ERROR(PopulateTypeNames<ContextType>(
+              metadata_access_object_.get(), &contexts));
+        }
+        response->mutable_contexts()->Reserve(contexts.size());
+        for (Context& context : contexts) {
+          *response->mutable_contexts()->Add() = std::move(context);
         }
         if (request.has_options()) {
           response->set_next_page_token(next_page_token);
@@ -1373,8 +2233,8 @@ absl::Status MetadataStore::GetContextsByType(
 absl::Status MetadataStore::GetContextByTypeAndName(
     const GetContextByTypeAndNameRequest& request,
     GetContextByTypeAndNameResponse* response) {
-  return transaction_executor_->Execute(
-      [this, &request, &response]() -> absl::Status {
+  return ReadThroughLookupCache(
+      request, response, [this, &request, &response]() -> absl::Status {
         response->Clear();
         int64 context_type_id;
         absl::Status status =
@@ -1396,35 +2256,34 @@ absl::Status MetadataStore::GetContextByTypeAndName(
         }
         *response->mutable_context() = context;
         return absl::OkStatus();
-      },
-      request.transaction_options());
+      });
 }
 
 absl::Status MetadataStore::PutAttributionsAndAssociations(
     const PutAttributionsAndAssociationsRequest& request,
     PutAttributionsAndAssociationsResponse* response) {
-  return transaction_executor_->Execute(
+  const absl::Status status = transaction_executor_->Execute(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
-        for (const Attribution& attribution : request.attributions()) {
-          MLMD_RETURN_IF_ERROR(InsertAttributionIfNotExist(
-              attribution.context_id(), attribution.artifact_id(),
-              metadata_access_object_.get()));
-        }
-        for (const Association& association : request.associations()) {
-          MLMD_RETURN_IF_ERROR(InsertAssociationIfNotExist(
-              association.context_id(), association.execution_id(),
-              metadata_access_object_.get()));
-        }
-        return absl::OkStatus();
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->CreateAttributionsIfNotExist(
+                std::vector<Attribution>(request.attributions().begin(),
+                                         request.attributions().end())));
+        return metadata_access_object_->CreateAssociationsIfNotExist(
+            std::vector<Association>(request.associations().begin(),
+                                     request.associations().end()));
       },
       request.transaction_options());
+  if (lineage_result_cache_ != nullptr) {
+    AdvanceLineageWatermarks({/*lineage=*/false, /*contexts=*/true});
+  }
+  return status;
 }
 
 absl::Status MetadataStore::PutParentContexts(
     const PutParentContextsRequest& request,
     PutParentContextsResponse* response) {
-  return transaction_executor_->Execute(
+  const absl::Status status = transaction_executor_->Execute(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         for (const ParentContext& parent_context : request.parent_contexts()) {
@@ -1434,19 +2293,109 @@ absl::Status MetadataStore::PutParentContexts(
         return absl::OkStatus();
       },
       request.transaction_options());
+  if (lineage_result_cache_ != nullptr) {
+    AdvanceLineageWatermarks({/*lineage=*/false, /*contexts=*/true});
+  }
+  return status;
+}
+
+absl::Status MetadataStore::DeleteArtifacts(
+    const DeleteArtifactsRequest& request, DeleteArtifactsResponse* response) {
+  response->Clear();
+  int64 num_deleted_ids = 0;
+  const std::vector<int64> artifact_ids(request.artifact_ids().begin(),
+                                        request.artifact_ids().end());
+  const absl::Status status = DeleteNodesInChunks(
+      artifact_ids, request.options(), request.transaction_options(),
+      [this](absl::Span<const int64> chunk) -> absl::Status {
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->DeleteEventsByArtifactsId(chunk));
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->DeleteAttributionsByArtifactsId(chunk));
+        return metadata_access_object_->DeleteArtifactsById(chunk);
+      },
+      *transaction_executor_, &num_deleted_ids);
+  response->set_num_deleted_ids(num_deleted_ids);
+  if (lineage_result_cache_ != nullptr) {
+    AdvanceLineageWatermarks({/*lineage=*/true, /*contexts=*/false});
+  }
+  return status;
+}
+
+absl::Status MetadataStore::DeleteExecutions(
+    const DeleteExecutionsRequest& request,
+    DeleteExecutionsResponse* response) {
+  response->Clear();
+  int64 num_deleted_ids = 0;
+  const std::vector<int64> execution_ids(request.execution_ids().begin(),
+                                         request.execution_ids().end());
+  const absl::Status status = DeleteNodesInChunks(
+      execution_ids, request.options(), request.transaction_options(),
+      [this](absl::Span<const int64> chunk) -> absl::Status {
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->DeleteEventsByExecutionsId(chunk));
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->DeleteAssociationsByExecutionsId(chunk));
+        return metadata_access_object_->DeleteExecutionsById(chunk);
+      },
+      *transaction_executor_, &num_deleted_ids);
+  response->set_num_deleted_ids(num_deleted_ids);
+  if (lineage_result_cache_ != nullptr) {
+    AdvanceLineageWatermarks({/*lineage=*/true, /*contexts=*/false});
+  }
+  return status;
+}
+
+absl::Status MetadataStore::ArchiveExecutions(
+    const ArchiveExecutionsRequest& request,
+    ArchiveExecutionsResponse* response) {
+  response->Clear();
+  if (!request.has_max_last_update_time_since_epoch()) {
+    return absl::InvalidArgumentError(
+        "max_last_update_time_since_epoch is not set.");
+  }
+  const BulkDeleteOptions& options = request.options();
+  MLMD_RETURN_IF_ERROR(ValidateBulkDeleteOptions(options));
+  // The oldest executions are archived first, so a chunk archiving fewer
+  // executions than the chunk size is the last one.
+  for (int num_chunks = 0;
+       options.max_num_chunks() <= 0 || num_chunks < options.max_num_chunks();
+       num_chunks++) {
+    if (num_chunks > 0 && options.chunk_interval_ms() > 0) {
+      absl::SleepFor(absl::Milliseconds(options.chunk_interval_ms()));
+    }
+    int64 num_archived_executions = 0;
+    MLMD_RETURN_IF_ERROR(transaction_executor_->Execute(
+        [this, &request, &options, &num_archived_executions]() {
+          return metadata_access_object_->ArchiveExecutions(
+              request.max_last_update_time_since_epoch(), options.chunk_size(),
+              &num_archived_executions);
+        },
+        request.transaction_options()));
+    if (lineage_result_cache_ != nullptr && num_archived_executions > 0) {
+      AdvanceLineageWatermarks({/*lineage=*/true, /*contexts=*/false});
+    }
+    response->set_num_archived_executions(
+        response->num_archived_executions() + num_archived_executions);
+    if (num_archived_executions < options.chunk_size()) {
+      break;
+    }
+  }
+  return absl::OkStatus();
 }
 
 absl::Status MetadataStore::GetContextsByArtifact(
     const GetContextsByArtifactRequest& request,
     GetContextsByArtifactResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Context> contexts;
         MLMD_RETURN_IF_ERROR(metadata_access_object_->FindContextsByArtifact(
             request.artifact_id(), &contexts));
-        for (const Context& context : contexts) {
-          *response->mutable_contexts()->Add() = context;
+        response->mutable_contexts()->Reserve(contexts.size());
+        for (Context& context : contexts) {
+          *response->mutable_contexts()->Add() = std::move(context);
         }
         return absl::OkStatus();
       },
@@ -1456,15 +2405,96 @@ absl::Status MetadataStore::GetContextsByArtifact(
 absl::Status MetadataStore::GetContextsByExecution(
     const GetContextsByExecutionRequest& request,
     GetContextsByExecutionResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Context> contexts;
         MLMD_RETURN_IF_ERROR(metadata_access_object_->FindContextsByExecution(
             request.execution_id(), &contexts));
-        for (const Context& context : contexts) {
-          *response->mutable_contexts()->Add() = context;
+        response->mutable_contexts()->Reserve(contexts.size());
+        for (Context& context : contexts) {
+          *response->mutable_contexts()->Add() = std::move(context);
+        }
+        return absl::OkStatus();
+      },
+      request.transaction_options());
+}
+
+absl::Status MetadataStore::GetExecutionDetails(
+    const GetExecutionDetailsRequest& request,
+    GetExecutionDetailsResponse* response) {
+  return transaction_executor_->ExecuteReadOnly(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        if (request.execution_ids().empty()) {
+          return absl::OkStatus();
+        }
+        std::vector<Execution> executions;
+        absl::Status status = metadata_access_object_->FindExecutionsById(
+            std::vector<int64>(request.execution_ids().begin(),
+                               request.execution_ids().end()),
+            &executions);
+        if (!status.ok() && !absl::IsNotFound(status)) {
+          return status;
+        }
+        if (executions.empty()) {
+          return absl::OkStatus();
+        }
+        std::vector<int64> execution_ids;
+        execution_ids.reserve(executions.size());
+        for (const Execution& execution : executions) {
+          execution_ids.push_back(execution.id());
+        }
+
+        std::vector<Event> events;
+        status = metadata_access_object_->FindEventsByExecutions(execution_ids,
+                                                                 &events);
+        if (!status.ok() && !absl::IsNotFound(status)) {
+          return status;
+        }
+        std::vector<int64> artifact_ids;
+        artifact_ids.reserve(events.size());
+        for (const Event& event : events) {
+          artifact_ids.push_back(event.artifact_id());
+        }
+        std::sort(artifact_ids.begin(), artifact_ids.end());
+        artifact_ids.erase(
+            std::unique(artifact_ids.begin(), artifact_ids.end()),
+            artifact_ids.end());
+        std::vector<Artifact> artifacts;
+        if (!artifact_ids.empty()) {
+          status = metadata_access_object_->FindArtifactsById(artifact_ids,
+                                                              &artifacts);
+          if (!status.ok() && !absl::IsNotFound(status)) {
+            return status;
+          }
+          std::sort(artifacts.begin(), artifacts.end(),
+                    [](const Artifact& a, const Artifact& b) {
+                      return a.id() < b.id();
+                    });
         }
+
+        std::vector<Association> associations;
+        std::vector<Context> contexts;
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->FindContextsByExecutions(
+            execution_ids, &associations, &contexts));
+
+        response->mutable_executions()->Reserve(executions.size());
+        absl::c_move(executions, google::protobuf::RepeatedPtrFieldBackInserter(
+                                     response->mutable_executions()));
+        response->mutable_events()->Reserve(events.size());
+        absl::c_move(events, google::protobuf::RepeatedPtrFieldBackInserter(
+                                 response->mutable_events()));
+        response->mutable_artifacts()->Reserve(artifacts.size());
+        absl::c_move(artifacts, google::protobuf::RepeatedPtrFieldBackInserter(
+                                    response->mutable_artifacts()));
+        response->mutable_contexts()->Reserve(contexts.size());
+        absl::c_move(contexts, google::protobuf::RepeatedPtrFieldBackInserter(
+                                   response->mutable_contexts()));
+        response->mutable_associations()->Reserve(associations.size());
+        absl::c_move(associations,
+                     google::protobuf::RepeatedPtrFieldBackInserter(
+                         response->mutable_associations()));
         return absl::OkStatus();
       },
       request.transaction_options());
@@ -1473,7 +2503,7 @@ absl::Status MetadataStore::GetContextsByExecution(
 absl::Status MetadataStore::GetArtifactsByContext(
     const GetArtifactsByContextRequest& request,
     GetArtifactsByContextResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Artifact> artifacts;
@@ -1484,8 +2514,13 @@ absl::Status MetadataStore::GetArtifactsByContext(
         MLMD_RETURN_IF_ERROR(metadata_access_object_->FindArtifactsByContext(
             request.context_id(), list_options, &artifacts, &next_page_token));
 
-        for (const Artifact& artifact : artifacts) {
-          *response->mutable_artifacts()->Add() = artifact;
+        if (request.options().populate_type_names()) {
+          MLMD_RETURN_IF_ERROR(PopulateTypeNames<ArtifactType>(
+              metadata_access_object_.get(), &artifacts));
+        }
+        response->mutable_artifacts()->Reserve(artifacts.size());
+        for (Artifact& artifact : artifacts) {
+          *response->mutable_artifacts()->Add() = std::move(artifact);
         }
 
         if (!next_page_token.empty()) {
@@ -1500,7 +2535,7 @@ absl::Status MetadataStore::GetArtifactsByContext(
 absl::Status MetadataStore::GetExecutionsByContext(
     const GetExecutionsByContextRequest& request,
     GetExecutionsByContextResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Execution> executions;
@@ -1512,8 +2547,13 @@ absl::Status MetadataStore::GetExecutionsByContext(
         MLMD_RETURN_IF_ERROR(metadata_access_object_->FindExecutionsByContext(
             request.context_id(), list_options, &executions, &next_page_token));
 
-        for (const Execution& execution : executions) {
-          *response->mutable_executions()->Add() = execution;
+        if (request.options().populate_type_names()) {
+          MLMD_RETURN_IF_ERROR(PopulateTypeNames<ExecutionType>(
+              metadata_access_object_.get(), &executions));
+        }
+        response->mutable_executions()->Reserve(executions.size());
+        for (Execution& execution : executions) {
+          *response->mutable_executions()->Add() = std::move(execution);
         }
 
         if (!next_page_token.empty()) {
@@ -1525,10 +2565,52 @@ absl::Status MetadataStore::GetExecutionsByContext(
       request.transaction_options());
 }
 
+absl::Status MetadataStore::GetArtifactsByContexts(
+    const GetArtifactsByContextsRequest& request,
+    GetArtifactsByContextsResponse* response) {
+  return transaction_executor_->ExecuteReadOnly(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        std::vector<Attribution> attributions;
+        std::vector<Artifact> artifacts;
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->FindArtifactsByContexts(
+            std::vector<int64>(request.context_ids().begin(),
+                               request.context_ids().end()),
+            request.max_num_per_context(), &attributions, &artifacts));
+        GroupNodesByContext(
+            attributions, &Attribution::artifact_id, artifacts,
+            &GetArtifactsByContextsResponse::ContextArtifacts::add_artifacts,
+            response->mutable_context_artifacts());
+        return absl::OkStatus();
+      },
+      request.transaction_options());
+}
+
+absl::Status MetadataStore::GetExecutionsByContexts(
+    const GetExecutionsByContextsRequest& request,
+    GetExecutionsByContextsResponse* response) {
+  return transaction_executor_->ExecuteReadOnly(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        std::vector<Association> associations;
+        std::vector<Execution> executions;
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->FindExecutionsByContexts(
+            std::vector<int64>(request.context_ids().begin(),
+                               request.context_ids().end()),
+            request.max_num_per_context(), &associations, &executions));
+        GroupNodesByContext(
+            associations, &Association::execution_id, executions,
+            &GetExecutionsByContextsResponse::ContextExecutions::add_executions,
+            response->mutable_context_executions());
+        return absl::OkStatus();
+      },
+      request.transaction_options());
+}
+
 absl::Status MetadataStore::GetParentContextsByContext(
     const GetParentContextsByContextRequest& request,
     GetParentContextsByContextResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Context> parent_contexts;
@@ -1538,7 +2620,8 @@ absl::Status MetadataStore::GetParentContextsByContext(
         if (!status.ok() && !absl::IsNotFound(status)) {
           return status;
         }
-        absl::c_copy(parent_contexts, google::protobuf::RepeatedPtrFieldBackInserter(
+        response->mutable_contexts()->Reserve(parent_contexts.size());
+        absl::c_move(parent_contexts, google::protobuf::RepeatedPtrFieldBackInserter(
                                           response->mutable_contexts()));
         return absl::OkStatus();
       },
@@ -1548,7 +2631,7 @@ absl::Status MetadataStore::GetParentContextsByContext(
 absl::Status MetadataStore::GetChildrenContextsByContext(
     const GetChildrenContextsByContextRequest& request,
     GetChildrenContextsByContextResponse* response) {
-  return transaction_executor_->Execute(
+  return transaction_executor_->ExecuteReadOnly(
       [this, &request, &response]() -> absl::Status {
         response->Clear();
         std::vector<Context> child_contexts;
@@ -1558,16 +2641,68 @@ absl::Status MetadataStore::GetChildrenContextsByContext(
         if (!status.ok() && !absl::IsNotFound(status)) {
           return status;
         }
-        absl::c_copy(child_contexts, google::protobuf::RepeatedPtrFieldBackInserter(
+        response->mutable_contexts()->Reserve(child_contexts.size());
+        absl::c_move(child_contexts, google::protobuf::RepeatedPtrFieldBackInserter(
                                          response->mutable_contexts()));
         return absl::OkStatus();
       },
       request.transaction_options());
 }
 
+absl::Status MetadataStore::GetAncestorContexts(
+    const GetAncestorContextsRequest& request,
+    GetAncestorContextsResponse* response) {
+  return transaction_executor_->ExecuteReadOnly(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        std::vector<Context> ancestor_contexts;
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->FindAncestorContextsByContextId(
+                request.context_id(), ContextHierarchyMaxDepth(request),
+                &ancestor_contexts));
+        response->mutable_contexts()->Reserve(ancestor_contexts.size());
+        absl::c_move(ancestor_contexts,
+                     google::protobuf::RepeatedPtrFieldBackInserter(
+                         response->mutable_contexts()));
+        return absl::OkStatus();
+      },
+      request.transaction_options());
+}
+
+absl::Status MetadataStore::GetDescendantContexts(
+    const GetDescendantContextsRequest& request,
+    GetDescendantContextsResponse* response) {
+  return transaction_executor_->ExecuteReadOnly(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        std::vector<Context> descendant_contexts;
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->FindDescendantContextsByContextId(
+                request.context_id(), ContextHierarchyMaxDepth(request),
+                &descendant_contexts));
+        response->mutable_contexts()->Reserve(descendant_contexts.size());
+        absl::c_move(descendant_contexts,
+                     google::protobuf::RepeatedPtrFieldBackInserter(
+                         response->mutable_contexts()));
+        return absl::OkStatus();
+      },
+      request.transaction_options());
+}
+
 
 absl::Status MetadataStore::GetLineageGraph(
     const GetLineageGraphRequest& request, GetLineageGraphResponse* response) {
+  return GetLineageGraphImpl(request, /*ids_only=*/false, response);
+}
+
+absl::Status MetadataStore::GetLineageGraphIds(
+    const GetLineageGraphRequest& request, GetLineageGraphResponse* response) {
+  return GetLineageGraphImpl(request, /*ids_only=*/true, response);
+}
+
+absl::Status MetadataStore::GetLineageGraphImpl(
+    const GetLineageGraphRequest& request, const bool ids_only,
+    GetLineageGraphResponse* response) {
   if (!request.options().has_artifacts_options()) {
     return absl::InvalidArgumentError("Missing query_nodes conditions");
   }
@@ -1592,8 +2727,23 @@ absl::Status MetadataStore::GetLineageGraph(
     LOG(INFO) << "stop_conditions.max_num_hops is not set. Use maximum value: "
               << kMaxDistance << " to limit the size of the traversal.";
   }
-  return transaction_executor_->Execute(
-      [this, &request, &response, max_num_hops]() -> absl::Status {
+  if (lineage_result_cache_ == nullptr || in_joined_transaction_) {
+    return TraverseLineageGraph(request, max_num_hops, ids_only, response);
+  }
+  return lineage_result_cache_->ReadThrough(
+      LineageResultCache::Key(request.options(), max_num_hops, ids_only),
+      LineageResultCache::FiltersByContexts(request.options()),
+      [this, &request, max_num_hops, ids_only, response]() {
+        return TraverseLineageGraph(request, max_num_hops, ids_only, response);
+      },
+      response);
+}
+
+absl::Status MetadataStore::TraverseLineageGraph(
+    const GetLineageGraphRequest& request, const int64 max_num_hops,
+    const bool ids_only, GetLineageGraphResponse* response) {
+  return transaction_executor_->ExecuteReadOnly(
+      [this, &request, &response, max_num_hops, ids_only]() -> absl::Status {
         response->Clear();
         std::vector<Artifact> artifacts;
         std::string dummy_token;
@@ -1611,7 +2761,10 @@ absl::Status MetadataStore::GetLineageGraph(
         }
         const LineageGraphQueryOptions::BoundaryConstraint& stop_conditions =
             request.options().stop_conditions();
-        return metadata_access_object_->QueryLineageGraph(
+        const auto query_lineage_graph =
+            ids_only ? &MetadataAccessObject::QueryLineageGraphIds
+                     : &MetadataAccessObject::QueryLineageGraph;
+        return (metadata_access_object_.get()->*query_lineage_graph)(
             artifacts, max_num_hops,
             request.options().max_node_size() > 0
                 ? absl::make_optional<int64>(request.options().max_node_size())
@@ -1629,6 +2782,223 @@ absl::Status MetadataStore::GetLineageGraph(
       request.transaction_options());
 }
 
+absl::Status MetadataStore::GetArtifactsByDerivation(
+    const GetArtifactsByDerivationRequest& request,
+    GetArtifactsByDerivationResponse* response) {
+  if (request.direction() ==
+      GetArtifactsByDerivationRequest::DIRECTION_UNSPECIFIED) {
+    return absl::InvalidArgumentError("Missing direction");
+  }
+  static constexpr int64 kMaxDistance = 100;
+  if (request.max_num_hops() < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("max_num_hops cannot be negative: max_num_hops =",
+                     request.max_num_hops()));
+  }
+  const int64 max_num_hops = request.has_max_num_hops()
+                                 ? request.max_num_hops()
+                                 : kMaxDistance;
+  return transaction_executor_->ExecuteReadOnly(
+      [this, &request, &response, max_num_hops]() -> absl::Status {
+        response->Clear();
+        std::vector<Artifact> artifacts;
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->FindArtifactsByDerivation(
+            std::vector<int64>(request.artifact_ids().begin(),
+                               request.artifact_ids().end()),
+            /*upstream=*/request.direction() ==
+                GetArtifactsByDerivationRequest::UPSTREAM,
+            max_num_hops,
+            request.has_context_id()
+                ? absl::make_optional<int64>(request.context_id())
+                : absl::nullopt,
+            &artifacts));
+        response->mutable_artifacts()->Reserve(artifacts.size());
+        for (Artifact& artifact : artifacts) {
+          *response->add_artifacts() = std::move(artifact);
+        }
+        return absl::OkStatus();
+      },
+      request.transaction_options());
+}
+
+absl::Status MetadataStore::GetChanges(const GetChangesRequest& request,
+                                       GetChangesResponse* response) {
+  if (request.after_sequence_number() < 0 || request.max_result_size() < 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "after_sequence_number and max_result_size cannot be negative: ",
+        request.ShortDebugString()));
+  }
+  const int64 max_num_entries =
+      request.max_result_size() == 0
+          ? kDefaultMaxListOperationResultSize
+          : std::min<int64>(request.max_result_size(), kMaxChangeLogResultSize);
+  return transaction_executor_->ExecuteReadOnly(
+      [this, &request, &response, max_num_entries]() -> absl::Status {
+        response->Clear();
+        std::vector<ChangeLogEntry> entries;
+        MLMD_RETURN_IF_ERROR(metadata_access_object_->FindChangeLogEntries(
+            request.after_sequence_number(), max_num_entries, &entries));
+        response->set_last_sequence_number(
+            entries.empty() ? request.after_sequence_number()
+                            : entries.back().sequence_number());
+        response->mutable_entries()->Reserve(entries.size());
+        for (ChangeLogEntry& entry : entries) {
+          *response->add_entries() = std::move(entry);
+        }
+        return absl::OkStatus();
+      },
+      request.transaction_options());
+}
+
+absl::Status MetadataStore::CountArtifacts(
+    const CountArtifactsRequest& request, CountArtifactsResponse* response) {
+  return transaction_executor_->ExecuteReadOnly(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        std::vector<NodeCount> counts;
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->CountArtifacts(request.options(), &counts));
+        response->mutable_counts()->Reserve(counts.size());
+        for (NodeCount& count : counts) {
+          *response->add_counts() = std::move(count);
+        }
+        return absl::OkStatus();
+      },
+      request.transaction_options());
+}
+
+absl::Status MetadataStore::CountExecutions(
+    const CountExecutionsRequest& request, CountExecutionsResponse* response) {
+  return transaction_executor_->ExecuteReadOnly(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        std::vector<NodeCount> counts;
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->CountExecutions(request.options(), &counts));
+        response->mutable_counts()->Reserve(counts.size());
+        for (NodeCount& count : counts) {
+          *response->add_counts() = std::move(count);
+        }
+        return absl::OkStatus();
+      },
+      request.transaction_options());
+}
+
+absl::Status MetadataStore::CountContexts(
+    const CountContextsRequest& request, CountContextsResponse* response) {
+  return transaction_executor_->ExecuteReadOnly(
+      [this, &request, &response]() -> absl::Status {
+        response->Clear();
+        std::vector<NodeCount> counts;
+        MLMD_RETURN_IF_ERROR(
+            metadata_access_object_->CountContexts(request.options(), &counts));
+        response->mutable_counts()->Reserve(counts.size());
+        for (NodeCount& count : counts) {
+          *response->add_counts() = std::move(count);
+        }
+        return absl::OkStatus();
+      },
+      request.transaction_options());
+}
+
+absl::Status MetadataStore::RunInTransaction(
+    const std::function<absl::Status()>& body,
+    const TransactionOptions& transaction_options) {
+  // The calls of `body` join its transaction instead of opening their own.
+  std::unique_ptr<TransactionExecutor> transaction_executor =
+      std::move(transaction_executor_);
+  transaction_executor_ = absl::make_unique<JoinedTransactionExecutor>();
+  in_joined_transaction_ = true;
+  const absl::Status status =
+      transaction_executor->Execute(body, transaction_options);
+  in_joined_transaction_ = false;
+  transaction_executor_ = std::move(transaction_executor);
+  // The lookups made stale by the writes of `body` are invalidated, and the
+  // lineage watermarks are advanced, once its transaction ends, including for
+  // the attempts rolled back.
+  if (lookup_cache_ != nullptr) {
+    lookup_cache_->Invalidate(pending_invalidation_);
+    pending_invalidation_ = LookupCache::Invalidation();
+  }
+  if (lineage_result_cache_ != nullptr) {
+    lineage_result_cache_->Advance(pending_lineage_write_);
+    pending_lineage_write_ = LineageResultCache::Write();
+  }
+  return status;
+}
+
+absl::Status MetadataStore::GroupCommit(
+    absl::Span<const std::function<absl::Status()>> writes,
+    std::vector<absl::Status>* statuses) {
+  statuses->assign(writes.size(), absl::OkStatus());
+  const absl::Status group_status =
+      RunInTransaction([&writes, statuses]() -> absl::Status {
+        for (int i = 0; i < writes.size(); i++) {
+          (*statuses)[i] = writes[i]();
+          MLMD_RETURN_IF_ERROR((*statuses)[i]);
+        }
+        return absl::OkStatus();
+      });
+  if (group_status.ok()) {
+    return absl::OkStatus();
+  }
+  // The failed group is rolled back, and each write is redone in its own
+  // transaction, so that a failed write does not fail the others.
+  for (int i = 0; i < writes.size(); i++) {
+    (*statuses)[i] = writes[i]();
+  }
+  return group_status;
+}
+
+absl::Status MetadataStore::ExecuteBatch(const BatchRequest& request,
+                                         BatchResponse* response) {
+  std::vector<std::unique_ptr<google::protobuf::Message>> responses;
+  // Runs the call `i` of the batch, and sets its result.
+  const auto run_call = [this, &request, &responses,
+                         response](const int i) -> absl::Status {
+    const BatchRequest::Call& call = request.calls(i);
+    BatchResponse::Result* result = response->add_results();
+    const auto it = BatchCalls().find(call.method());
+    const absl::Status status =
+        it == BatchCalls().end()
+            ? absl::InvalidArgumentError(
+                  absl::StrCat("Unknown method of a batch: ", call.method()))
+            : it->second(this, call, absl::MakeConstSpan(responses.data(), i),
+                         &responses[i]);
+    if (status.ok()) {
+      responses[i]->SerializeToString(result->mutable_response());
+    } else {
+      result->set_error_code(static_cast<int>(status.code()));
+      result->set_error_message(std::string(status.message()));
+    }
+    return status;
+  };
+  if (request.single_transaction()) {
+    return RunInTransaction(
+        [&request, &responses, response, &run_call]() -> absl::Status {
+          response->Clear();
+          responses.clear();
+          responses.resize(request.calls_size());
+          for (int i = 0; i < request.calls_size(); i++) {
+            const absl::Status status = run_call(i);
+            if (!status.ok()) {
+              return absl::Status(
+                  status.code(),
+                  absl::StrCat("Call ", i, " (", request.calls(i).method(),
+                               ") of the batch failed: ", status.message()));
+            }
+          }
+          return absl::OkStatus();
+        },
+        request.transaction_options());
+  }
+  response->Clear();
+  responses.resize(request.calls_size());
+  for (int i = 0; i < request.calls_size(); i++) {
+    run_call(i).IgnoreError();
+  }
+  return absl::OkStatus();
+}
 
 MetadataStore::MetadataStore(
     std::unique_ptr<MetadataSource> metadata_source,
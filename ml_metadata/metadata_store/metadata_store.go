@@ -18,6 +18,7 @@ package mlmetadata
 
 import (
 	"errors"
+	"fmt"
 	"log"
 
 	"github.com/golang/protobuf/proto"
@@ -613,6 +614,63 @@ func (store *Store) GetContextByTypeAndName(typeName string, contextName string)
 	return resp.GetContext(), err
 }
 
+// BatchCall is a call of ExecuteBatch. `Method` names a method of
+// proto/metadata_store_service.proto, e.g., "PutArtifacts", `Request` is its
+// request message, and `Response` is filled with its response message. `Err`
+// is set if the call fails.
+type BatchCall struct {
+	Method   string
+	Request  proto.Message
+	Response proto.Message
+	Err      error
+}
+
+// ExecuteBatch executes a list of calls with a single call to the cc library.
+// If `singleTransaction` is true, all calls are executed in one transaction,
+// and it returns an error and rolls back all calls if any of them fails.
+// Otherwise each call is executed in its own transaction, and the outcome of
+// each call is set to its `Err`.
+func (store *Store) ExecuteBatch(calls []*BatchCall, singleTransaction bool) error {
+	status := wrap.CreateABSLStatus()
+	defer wrap.DestroyABSLStatus(status)
+
+	req := &apipb.BatchRequest{SingleTransaction: proto.Bool(singleTransaction)}
+	for _, call := range calls {
+		b, err := proto.Marshal(call.Request)
+		if err != nil {
+			return err
+		}
+		req.Calls = append(req.Calls, &apipb.BatchRequest_Call{
+			Method:  proto.String(call.Method),
+			Request: b,
+		})
+	}
+	b, err := proto.Marshal(req)
+	if err != nil {
+		return err
+	}
+	wrt := wrap.ExecuteBatch(store.ptr, b, status)
+	defer wrap.FreeBatchResponse(wrt)
+	if !wrap.IsOk(status) {
+		return errors.New(wrap.ErrorMessage(status))
+	}
+	resp := &apipb.BatchResponse{}
+	if err := proto.Unmarshal(wrt, resp); err != nil {
+		return err
+	}
+	if len(resp.GetResults()) != len(calls) {
+		return fmt.Errorf("batch returns %d results for %d calls", len(resp.GetResults()), len(calls))
+	}
+	for i, result := range resp.GetResults() {
+		if result.GetErrorCode() != 0 {
+			calls[i].Err = errors.New(result.GetErrorMessage())
+			continue
+		}
+		calls[i].Err = proto.Unmarshal(result.GetResponse(), calls[i].Response)
+	}
+	return nil
+}
+
 type metadataStoreMethod func(wrap.Ml_metadata_MetadataStore, string, wrap.Absl_Status) string
 
 // callMetadataStoreWrapMethod calls a `metadataStoreMethod` in cc library.
@@ -15,9 +15,20 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_H_
 #define ML_METADATA_METADATA_STORE_METADATA_STORE_H_
 
+#include <functional>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/call_memory_account.h"
+#include "ml_metadata/metadata_store/cancellation_token.h"
+#include "ml_metadata/metadata_store/lineage_graph_index.h"
+#include "ml_metadata/metadata_store/lineage_result_cache.h"
+#include "ml_metadata/metadata_store/property_string_dictionary.h"
+#include "ml_metadata/metadata_store/lookup_cache.h"
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
 #include "ml_metadata/metadata_store/metadata_store_service_interface.h"
@@ -62,6 +73,19 @@ class MetadataStore : public MetadataStoreServiceInterface {
   absl::Status InitMetadataStoreIfNotExists(
       bool enable_upgrade_migration = false);
 
+  // Checks that the database has the schema version of the library, without
+  // checking or creating the tables, e.g., for an immutable database.
+  // Returns NOT_FOUND error, if the database is empty.
+  // Returns FAILED_PRECONDITION error, if library and db have different
+  //   schema versions.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status VerifySchemaVersion();
+
+  // Checks whether the connection to the metadata source is still usable. It
+  // is used to validate long-lived stores before reusing them.
+  // Returns UNAVAILABLE error, if the metadata source cannot be reached.
+  absl::Status CheckConnection();
+
 
 
   // Inserts or updates a ArtifactType/ExecutionType/ContextType.
@@ -267,6 +291,16 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const GetEventsByArtifactIDsRequest& request,
       GetEventsByArtifactIDsResponse* response) override;
 
+  // Gets a page of the events within a time range, which are read from an
+  // index of the events by time. The events are ordered by CREATE_TIME, i.e.,
+  // by milliseconds_since_epoch and id, unless the options order them by ID.
+  // Returns INVALID_ARGUMENT error, if the options or the page token are
+  // invalid.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status GetEventsByTimeRange(
+      const GetEventsByTimeRangeRequest& request,
+      GetEventsByTimeRangeResponse* response) override;
+
   // Gets a list of artifacts by ID.
   // If no artifact with an ID exists, the artifact is skipped.
   // Sets the error field if any other internal errors are returned.
@@ -320,6 +354,14 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const GetExecutionsByTypeRequest& request,
       GetExecutionsByTypeResponse* response) override;
 
+  // Gets the NEW and RUNNING executions of a given type, which are read from
+  // an index of the active executions. If no executions found, it returns OK
+  // and empty response.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status GetActiveExecutionsByType(
+      const GetActiveExecutionsByTypeRequest& request,
+      GetActiveExecutionsByTypeResponse* response) override;
+
   // Gets the execution of a given type and name. If no execution found, it
   // returns OK and empty response.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -372,6 +414,33 @@ class MetadataStore : public MetadataStoreServiceInterface {
   absl::Status PutParentContexts(const PutParentContextsRequest& request,
                                  PutParentContextsResponse* response) override;
 
+  // Deletes artifacts by id with their properties, events, event paths and
+  // attributions, in chunks of `options`, each in its own transaction. The
+  // number of leading ids that are deleted is returned in the response, also
+  // when a chunk fails, so that the deletion can be resumed.
+  // Returns INVALID_ARGUMENT error, if the chunk size is not in [1, 500].
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status DeleteArtifacts(const DeleteArtifactsRequest& request,
+                               DeleteArtifactsResponse* response) override;
+
+  // Deletes executions by id with their properties, events, event paths and
+  // associations. See DeleteArtifacts for the chunks.
+  // Returns INVALID_ARGUMENT error, if the chunk size is not in [1, 500].
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status DeleteExecutions(const DeleteExecutionsRequest& request,
+                                DeleteExecutionsResponse* response) override;
+
+  // Archives the executions that are not NEW or RUNNING and were last updated
+  // at or before the given time, oldest first, in chunks of `options`, each in
+  // its own transaction. The number of archived executions is returned in the
+  // response, also when a chunk fails.
+  // Returns INVALID_ARGUMENT error, if the time is not set, or the chunk size
+  // is not in [1, 500].
+  // Returns FAILED_PRECONDITION error, if the schema has no archive tables.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status ArchiveExecutions(const ArchiveExecutionsRequest& request,
+                                 ArchiveExecutionsResponse* response) override;
+
   // Gets all context that an artifact is attributed to.
   // Returns detailed INTERNAL error, if query execution fails.
   absl::Status GetContextsByArtifact(
@@ -384,6 +453,14 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const GetContextsByExecutionRequest& request,
       GetContextsByExecutionResponse* response) override;
 
+  // Gets the executions of the given ids with their events, the artifacts of
+  // the events and the contexts of the executions in a single transaction.
+  // The number of queries does not depend on the number of executions.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status GetExecutionDetails(
+      const GetExecutionDetailsRequest& request,
+      GetExecutionDetailsResponse* response) override;
+
   // Gets all direct artifacts using list options that a context attributes to.
   // If option is not set in the request, then all artifacts are returned.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -398,6 +475,22 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const GetExecutionsByContextRequest& request,
       GetExecutionsByContextResponse* response) override;
 
+  // Gets the direct artifacts of several contexts grouped per context, with at
+  // most max_num_per_context of the latest artifacts of each context if it is
+  // positive. The attributions are read with a single query, and the
+  // artifacts with a single batch.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status GetArtifactsByContexts(
+      const GetArtifactsByContextsRequest& request,
+      GetArtifactsByContextsResponse* response) override;
+
+  // Gets the direct executions of several contexts grouped per context, like
+  // GetArtifactsByContexts.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status GetExecutionsByContexts(
+      const GetExecutionsByContextsRequest& request,
+      GetExecutionsByContextsResponse* response) override;
+
   // Gets all parent contexts of a context.
   // Returns detailed INTERNAL error, if query execution fails.
   absl::Status GetParentContextsByContext(
@@ -410,6 +503,18 @@ class MetadataStore : public MetadataStoreServiceInterface {
       const GetChildrenContextsByContextRequest& request,
       GetChildrenContextsByContextResponse* response) override;
 
+  // Gets the ancestor contexts of a context within the max depth.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status GetAncestorContexts(
+      const GetAncestorContextsRequest& request,
+      GetAncestorContextsResponse* response) override;
+
+  // Gets the descendant contexts of a context within the max depth.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status GetDescendantContexts(
+      const GetDescendantContextsRequest& request,
+      GetDescendantContextsResponse* response) override;
+
 
   // The method is used for accessing MLMD lineage. Please see
   // metadata_store_service.proto for details. Returns detailed INTERNAL error,
@@ -417,8 +522,221 @@ class MetadataStore : public MetadataStoreServiceInterface {
   absl::Status GetLineageGraph(const GetLineageGraphRequest& request,
                                GetLineageGraphResponse* response) override;
 
+  // Like GetLineageGraph, but the artifacts and executions reached from the
+  // query nodes only have their ids in the subgraph. It is the traversal step
+  // of a GetLineageGraph whose nodes are then read separately, e.g., by
+  // GetArtifactsByID and GetExecutionsByID in parallel on other stores.
+  absl::Status GetLineageGraphIds(const GetLineageGraphRequest& request,
+                                  GetLineageGraphResponse* response);
+
+  // Gets the artifacts upstream or downstream of the given artifacts.
+  // Returns INVALID_ARGUMENT error, if the direction is unspecified or the
+  // max_num_hops is negative.
+  // Returns FAILED_PRECONDITION error, if the schema has no derivation table.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status GetArtifactsByDerivation(
+      const GetArtifactsByDerivationRequest& request,
+      GetArtifactsByDerivationResponse* response) override;
+
+  // Gets the change log entries after the after_sequence_number of the
+  // request.
+  // Returns INVALID_ARGUMENT error, if the after_sequence_number or the
+  // max_result_size is negative.
+  // Returns FAILED_PRECONDITION error, if the schema has no change log.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status GetChanges(const GetChangesRequest& request,
+                          GetChangesResponse* response) override;
+
+  // Counts the artifacts selected by the filter query of the options, grouped
+  // by their type, state, contexts or create time, in the database.
+  // Returns INVALID_ARGUMENT error, if the options are invalid.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status CountArtifacts(const CountArtifactsRequest& request,
+                              CountArtifactsResponse* response) override;
+
+  // Counts the executions, as CountArtifacts.
+  absl::Status CountExecutions(const CountExecutionsRequest& request,
+                               CountExecutionsResponse* response) override;
+
+  // Counts the contexts, as CountArtifacts. The contexts can be grouped by
+  // type and create time only.
+  absl::Status CountContexts(const CountContextsRequest& request,
+                             CountContextsResponse* response) override;
+
+  // Serves the name-keyed lookups, i.e., Get{Artifact,Execution,Context}Type
+  // and GetContextByTypeAndName, from `lookup_cache`, which may be shared with
+  // other stores of the same metadata source. The writes of this store
+  // invalidate the lookups they make stale once they commit. The calls in
+  // RunInTransaction bypass the cache. A null `lookup_cache` disables it.
+  void set_lookup_cache(std::shared_ptr<LookupCache> lookup_cache) {
+    lookup_cache_ = std::move(lookup_cache);
+  }
+
+  // Serves the results of GetLineageGraph from `lineage_result_cache`, which
+  // may be shared with other stores of the same metadata source. The writes of
+  // this store advance its watermarks once they commit. The calls in
+  // RunInTransaction bypass the cache. A null `lineage_result_cache` disables
+  // it.
+  void set_lineage_result_cache(
+      std::shared_ptr<LineageResultCache> lineage_result_cache) {
+    lineage_result_cache_ = std::move(lineage_result_cache);
+  }
+
+  // Traverses the lineage graphs of GetLineageGraph without boundary
+  // conditions in `lineage_graph_index`, which may be shared with other stores
+  // of the same metadata source, and reads only the reached nodes and their
+  // events from the metadata source. A null `lineage_graph_index` disables it.
+  void set_lineage_graph_index(
+      std::shared_ptr<LineageGraphIndex> lineage_graph_index) {
+    metadata_access_object_->set_lineage_graph_index(
+        std::move(lineage_graph_index));
+  }
+
+  // Interns the string property values written by this store in the
+  // PropertyStringValue table of a v17+ schema, looking up their ids in
+  // `dictionary`, which may be shared with other stores of the same metadata
+  // source. A null `dictionary` stores the values in the property rows.
+  void set_property_string_dictionary(
+      std::shared_ptr<PropertyStringDictionary> dictionary) {
+    metadata_access_object_->set_property_string_dictionary(
+        std::move(dictionary));
+  }
+
+  // Compresses the string, struct and proto property values written by this
+  // store, whose serialized size is at least the min_value_size of `config`,
+  // to the `byte_value` column of the property tables of a v17+ schema. The
+  // reads of all the stores decompress them. The filter queries do not match
+  // the compressed values.
+  void set_property_value_compression(
+      const PropertyValueCompressionConfig& config) {
+    metadata_access_object_->set_property_value_compression(config);
+  }
+
+  // Identifies the database of this store among the stores of the process,
+  // e.g., by its connection config. Once a store of the `database_key` has
+  // upserted the simple types, InitMetadataStore and
+  // InitMetadataStoreIfNotExists of the stores of the same key skip upserting
+  // them as long as the type generation of the database is unchanged. An
+  // empty key, e.g., of an in-memory database, upserts them every time. Must
+  // be called before the store is initialized.
+  void set_database_key(std::string database_key) {
+    database_key_ = std::move(database_key);
+  }
+
+  // Indexes the values of the `indexed_properties` by dedicated indices,
+  // which InitMetadataStore and InitMetadataStoreIfNotExists create, and to
+  // which the filter queries of the List* methods comparing the values are
+  // routed. Must be called before the store is initialized.
+  void set_indexed_properties(
+      std::vector<IndexedProperty> indexed_properties) {
+    metadata_access_object_->set_indexed_properties(
+        std::move(indexed_properties));
+  }
+
+  // Sets the token of the call, e.g., of an RPC, running the methods of this
+  // store. Once the call is cancelled or past its deadline, the methods stop
+  // starting transactions and queries, and return CANCELLED or
+  // DEADLINE_EXCEEDED error. The `token` is not owned, and must outlast its
+  // use; nullptr unsets it.
+  void set_cancellation_token(const CancellationToken* token) {
+    metadata_source_->set_cancellation_token(token);
+  }
+
+  // Sets the call running the methods of this store, e.g., an RPC and its
+  // filter, which is reported with the slow queries. An empty `origin` unsets
+  // it.
+  void set_query_origin(std::string origin) {
+    metadata_source_->set_query_origin(std::move(origin));
+  }
+
+  // Sets the statistics of the call, e.g., of an RPC, running the methods of
+  // this store, which its transactions and queries add to. The `stats` are
+  // not owned, and must outlast their use; nullptr unsets them.
+  void set_transaction_stats(TransactionStats* stats) {
+    metadata_source_->set_transaction_stats(stats);
+  }
+
+  // Sets the memory account of the call, e.g., of an RPC, running the methods
+  // of this store, which is charged the results of their queries. The methods
+  // fail with RESOURCE_EXHAUSTED once its hard limit is exceeded, and the
+  // pages of GetArtifacts, GetExecutions and GetContexts with options are
+  // truncated to its soft limit, with a next_page_token to continue from. The
+  // `account` is not owned, and must outlast its use; nullptr unsets it.
+  void set_memory_account(CallMemoryAccount* account) {
+    metadata_source_->set_memory_account(account);
+  }
+
+  // Interrupts the query run by a method of this store, e.g., once the client
+  // of the call has gone away. Unlike the other methods, it is called from
+  // another thread than the one running the method.
+  // Returns detailed errors of the metadata source, if the query cannot be
+  // interrupted.
+  absl::Status CancelQuery() { return metadata_source_->CancelQuery(); }
+
+  // Runs `body`, e.g., calls of several methods of this store, in a single
+  // transaction. The calls must not carry transaction_options, as they join
+  // the transaction of `body`. The transaction is rolled back if `body` fails,
+  // and is retried like the ones of the methods, so `body` must be idempotent,
+  // e.g., it clears its responses first.
+  // Returns the error of `body` or of the transaction.
+  absl::Status RunInTransaction(
+      const std::function<absl::Status()>& body,
+      const TransactionOptions& transaction_options = TransactionOptions());
+
+  // Executes the calls of `request` in order, and sets the result of each in
+  // `response`. The id_references of a call are resolved against the responses
+  // of the earlier calls before it is executed. If single_transaction is set,
+  // the calls run in RunInTransaction with the transaction_options of the
+  // batch. Otherwise, each call runs in its own transaction, and a call
+  // referencing a failed call fails with FAILED_PRECONDITION.
+  // Returns the error of the first failed call, with its index and method, if
+  // single_transaction is set.
+  absl::Status ExecuteBatch(const BatchRequest& request,
+                            BatchResponse* response);
+
+  // Runs `writes`, e.g., calls of PutEvents of this store, in a single
+  // transaction, to amortize the cost of committing many small writes. The
+  // writes must not carry transaction_options, as they join the transaction of
+  // the group. If any of them fails, the group is rolled back and each write is
+  // redone in its own transaction. `statuses` is set to the status of each
+  // write, and the responses of the writes are the ones of their last run.
+  // Returns the error that failed the group, or OK if it is committed.
+  absl::Status GroupCommit(
+      absl::Span<const std::function<absl::Status()>> writes,
+      std::vector<absl::Status>* statuses);
 
  private:
+  // Implements GetLineageGraph, and GetLineageGraphIds if `ids_only`.
+  absl::Status GetLineageGraphImpl(const GetLineageGraphRequest& request,
+                                   bool ids_only,
+                                   GetLineageGraphResponse* response);
+
+  // Reads the lineage graph of `request` within `max_num_hops` hops in a
+  // transaction, bypassing the lineage result cache.
+  absl::Status TraverseLineageGraph(const GetLineageGraphRequest& request,
+                                    int64 max_num_hops, bool ids_only,
+                                    GetLineageGraphResponse* response);
+
+  // Serves the name-keyed lookup `request` from the `lookup_cache_`, or runs
+  // `txn_body` reading it to `response` in a transaction and caches its
+  // result.
+  template <typename Request, typename Response>
+  absl::Status ReadThroughLookupCache(
+      const Request& request, Response* response,
+      const std::function<absl::Status()>& txn_body);
+
+  // Invalidates the lookups of the `lookup_cache_` made stale by a write that
+  // has committed, or by a write of RunInTransaction once it commits.
+  void InvalidateLookups(const LookupCache::Invalidation& invalidation);
+
+  // Advances the watermarks of the `lineage_result_cache_` of a write that
+  // has committed, or of a write of RunInTransaction once it commits.
+  void AdvanceLineageWatermarks(const LineageResultCache::Write& write);
+
+  // Upserts the simple types, unless a store of the `database_key_` has
+  // upserted them at the current type generation of the database.
+  absl::Status UpsertSimpleTypesIfChanged();
+
   // To construct the object, see Create(...).
   MetadataStore(std::unique_ptr<MetadataSource> metadata_source,
                 std::unique_ptr<MetadataAccessObject> metadata_access_object,
@@ -427,6 +745,18 @@ class MetadataStore : public MetadataStoreServiceInterface {
   std::unique_ptr<MetadataSource> metadata_source_;
   std::unique_ptr<MetadataAccessObject> metadata_access_object_;
   std::unique_ptr<TransactionExecutor> transaction_executor_;
+  // The cache of the name-keyed lookups, or null if they are not cached.
+  std::shared_ptr<LookupCache> lookup_cache_;
+  // The cache of the lineage graphs, or null if they are not cached.
+  std::shared_ptr<LineageResultCache> lineage_result_cache_;
+  // The key of the database among the stores of the process, or empty.
+  std::string database_key_;
+  // Whether the calls run in the transaction of RunInTransaction.
+  bool in_joined_transaction_ = false;
+  // The lookups made stale by the writes of RunInTransaction so far.
+  LookupCache::Invalidation pending_invalidation_;
+  // The watermarks advanced by the writes of RunInTransaction so far.
+  LineageResultCache::Write pending_lineage_write_;
 };
 
 }  // namespace ml_metadata
@@ -564,8 +564,8 @@ class MetadataStore(object):
       reuse_context_if_already_exist: when there's a race to publish executions
         with a new context (no id) with the same context.name, by default there
         will be one writer succeeds and the rest of the writers fail with
-        AlreadyExists errors. If set is to True, failed writers will reuse the
-        stored context.
+        AlreadyExists errors. If set is to True, the writers will reuse the
+        stored context without failing.
 
     Returns:
       the execution id, the list of artifact's id, and the list of context's id.
@@ -0,0 +1,571 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_store_async_service.h"
+
+#include <functional>
+#include <memory>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include <glog/logging.h>
+#include "grpcpp/support/async_stream.h"
+#include "grpcpp/support/async_unary_call.h"
+#include "grpcpp/support/status_code_enum.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/metadata_store_response_stream.h"
+#include "ml_metadata/metadata_store/replicated_metadata_store_pool.h"
+#include "ml_metadata/metadata_store/slow_query_log.h"
+#include "ml_metadata/metadata_store/worker_pool.h"
+
+namespace ml_metadata {
+namespace {
+
+using Service = MetadataStoreService::AsyncService;
+
+// Converts from absl Status to GRPC Status.
+::grpc::Status ToGRPCStatus(const ::absl::Status& status) {
+  // Note: the absl and grpc status codes align with each other.
+  return ::grpc::Status(static_cast<::grpc::StatusCode>(status.code()),
+                        std::string(status.message()));
+}
+
+// Returns true if the client of the call asks to read its own writes.
+bool ReadsYourWrites(const ::grpc::ServerContext& context) {
+  const auto it = context.client_metadata().find(kReadYourWritesMetadataKey);
+  return it != context.client_metadata().end() && it->second == "true";
+}
+
+// The state shared by the calls requested on a completion queue.
+struct CallQueue {
+  Service* service;
+  ::grpc::ServerCompletionQueue* cq;
+  ReplicatedMetadataStorePool* metadata_store_pool;
+};
+
+// A class of calls, which are served by the same workers.
+struct CallClass {
+  WorkerPool* workers;
+  // True if the calls only read, so that they can be served by a replica.
+  bool read_only;
+};
+
+// A call in flight. Its address is the tag of the call's operations on the
+// completion queue.
+class Call {
+ public:
+  virtual ~Call() = default;
+
+  // Advances the call when its tag is returned by the completion queue. `ok`
+  // is false if the operation failed, e.g., the server is shutting down.
+  virtual void Proceed(bool ok) = 0;
+};
+
+// A unary call served by a MetadataStore method. The call is requested on
+// construction, handed to the workers of `call_class` when it arrives, and
+// deletes itself once the response is sent.
+template <typename Request, typename Response>
+class UnaryCall final : public Call {
+ public:
+  using RequestMethod = void (Service::*)(
+      ::grpc::ServerContext*, Request*,
+      ::grpc::ServerAsyncResponseWriter<Response>*, ::grpc::CompletionQueue*,
+      ::grpc::ServerCompletionQueue*, void*);
+  using StoreMethod = absl::Status (MetadataStore::*)(const Request&,
+                                                      Response*);
+
+  UnaryCall(const CallQueue& queue, const char* name,
+            const CallClass& call_class, StoreMethod store_method,
+            RequestMethod request_method)
+      : queue_(queue),
+        name_(name),
+        call_class_(call_class),
+        store_method_(store_method),
+        request_method_(request_method),
+        responder_(&context_) {
+    (queue_.service->*request_method_)(&context_, &request_, &responder_,
+                                       queue_.cq, queue_.cq, this);
+  }
+
+  void Proceed(const bool ok) override {
+    if (!ok || responding_) {
+      delete this;
+      return;
+    }
+    // Accepts the next call of the method while this one is served.
+    new UnaryCall(queue_, name_, call_class_, store_method_, request_method_);
+    responding_ = true;
+    if (!call_class_.workers->Schedule([this]() { Serve(); })) {
+      // The queue of the call's class is full, or the server is shutting down.
+      LOG(WARNING) << name_ << " rejected: too many queued calls.";
+      responder_.FinishWithError(
+          ::grpc::Status(::grpc::StatusCode::RESOURCE_EXHAUSTED,
+                         absl::StrCat(name_, " rejected: too many queued "
+                                             "calls, please retry later.")),
+          this);
+    }
+  }
+
+ private:
+  // Runs the call with a leased MetadataStore and sends the response. It runs
+  // in a worker.
+  void Serve() {
+    MetadataStorePool::ScopedStore metadata_store;
+    const ::grpc::Status connection_status = ToGRPCStatus(
+        call_class_.read_only
+            ? queue_.metadata_store_pool->AcquireForRead(
+                  ReadsYourWrites(context_), &metadata_store)
+            : queue_.metadata_store_pool->AcquireForWrite(&metadata_store));
+    if (!connection_status.ok()) {
+      LOG(WARNING) << "Failed to connect to the database: "
+                   << connection_status.error_message();
+      responder_.FinishWithError(connection_status, this);
+      return;
+    }
+    metadata_store->set_query_origin(SlowQueryOrigin(name_, request_));
+    const ::grpc::Status transaction_status = ToGRPCStatus(
+        (metadata_store.get()->*store_method_)(request_, &response_));
+    metadata_store->set_query_origin("");
+    // Returns the store before waiting for the response to be sent.
+    metadata_store.Reset();
+    if (!transaction_status.ok()) {
+      LOG(WARNING) << name_
+                   << " failed: " << transaction_status.error_message();
+      responder_.FinishWithError(transaction_status, this);
+      return;
+    }
+    responder_.Finish(response_, ::grpc::Status::OK, this);
+  }
+
+  const CallQueue queue_;
+  const char* const name_;
+  const CallClass call_class_;
+  const StoreMethod store_method_;
+  const RequestMethod request_method_;
+
+  ::grpc::ServerContext context_;
+  Request request_;
+  Response response_;
+  ::grpc::ServerAsyncResponseWriter<Response> responder_;
+  // True once the call arrived, i.e., the next tag is the sent response.
+  bool responding_ = false;
+};
+
+// A server-streaming call served by a ResponseStream. The call is requested on
+// construction. Once it arrives, each chunk is fetched from the same read pool
+// by the workers of `call_class` and written, and the next chunk is only
+// fetched after the previous one is sent, so that at most one chunk of the
+// call is held in memory. The call deletes itself once the stream is finished.
+template <typename Request, typename Response>
+class StreamingCall final : public Call {
+ public:
+  using RequestMethod = void (Service::*)(
+      ::grpc::ServerContext*, Request*, ::grpc::ServerAsyncWriter<Response>*,
+      ::grpc::CompletionQueue*, ::grpc::ServerCompletionQueue*, void*);
+  using StreamFactory =
+      std::function<std::unique_ptr<ResponseStream<Response>>(const Request&)>;
+
+  StreamingCall(const CallQueue& queue, const char* name,
+                const CallClass& call_class, StreamFactory stream_factory,
+                RequestMethod request_method)
+      : queue_(queue),
+        name_(name),
+        call_class_(call_class),
+        stream_factory_(std::move(stream_factory)),
+        request_method_(request_method),
+        writer_(&context_) {
+    (queue_.service->*request_method_)(&context_, &request_, &writer_,
+                                       queue_.cq, queue_.cq, this);
+  }
+
+  void Proceed(const bool ok) override {
+    switch (state_) {
+      case State::kRequested:
+        if (!ok) {
+          delete this;
+          return;
+        }
+        // Accepts the next call of the method while this one is served.
+        new StreamingCall(queue_, name_, call_class_, stream_factory_,
+                          request_method_);
+        stream_ = stream_factory_(request_);
+        read_pool_ = queue_.metadata_store_pool->SelectReadPool(
+            ReadsYourWrites(context_));
+        ScheduleNextChunk();
+        return;
+      case State::kWriting:
+        if (!ok) {
+          // The client is gone.
+          Finish(::grpc::Status(::grpc::StatusCode::CANCELLED,
+                                "The stream is closed by the client."));
+          return;
+        }
+        ScheduleNextChunk();
+        return;
+      case State::kFinishing:
+        delete this;
+        return;
+    }
+  }
+
+ private:
+  enum class State { kRequested, kWriting, kFinishing };
+
+  // Queues the fetch of the next chunk to the workers.
+  void ScheduleNextChunk() {
+    if (!call_class_.workers->Schedule([this]() { WriteNextChunk(); })) {
+      LOG(WARNING) << name_ << " rejected: too many queued calls.";
+      Finish(::grpc::Status(::grpc::StatusCode::RESOURCE_EXHAUSTED,
+                            absl::StrCat(name_, " rejected: too many queued "
+                                                "calls, please retry later.")));
+    }
+  }
+
+  // Fetches the next chunk and writes it. It runs in a worker.
+  void WriteNextChunk() {
+    bool done = false;
+    response_.Clear();
+    const ::grpc::Status transaction_status =
+        ToGRPCStatus(stream_->Next(read_pool_, &response_, &done));
+    if (!transaction_status.ok()) {
+      LOG(WARNING) << name_
+                   << " failed: " << transaction_status.error_message();
+      Finish(transaction_status);
+      return;
+    }
+    if (done) {
+      state_ = State::kFinishing;
+      writer_.WriteAndFinish(response_, ::grpc::WriteOptions(),
+                             ::grpc::Status::OK, this);
+      return;
+    }
+    state_ = State::kWriting;
+    writer_.Write(response_, this);
+  }
+
+  void Finish(const ::grpc::Status& status) {
+    state_ = State::kFinishing;
+    writer_.Finish(status, this);
+  }
+
+  const CallQueue queue_;
+  const char* const name_;
+  const CallClass call_class_;
+  const StreamFactory stream_factory_;
+  const RequestMethod request_method_;
+
+  ::grpc::ServerContext context_;
+  Request request_;
+  Response response_;
+  ::grpc::ServerAsyncWriter<Response> writer_;
+  std::unique_ptr<ResponseStream<Response>> stream_;
+  MetadataStorePool* read_pool_ = nullptr;
+  // The state is set before an operation is started, as its tag may be
+  // returned to another thread right away.
+  State state_ = State::kRequested;
+};
+
+// Requests a call of the method, whose request and response types are deduced
+// from `store_method`.
+template <typename Request, typename Response>
+void RequestCall(
+    const CallQueue& queue, const char* name, const CallClass& call_class,
+    absl::Status (MetadataStore::*store_method)(const Request&, Response*),
+    typename UnaryCall<Request, Response>::RequestMethod request_method) {
+  new UnaryCall<Request, Response>(queue, name, call_class, store_method,
+                                   request_method);
+}
+
+// Requests a call of the server-streaming method, which streams the pages of
+// `store_method`.
+template <typename Request, typename Response>
+void RequestPagedStreamingCall(
+    const CallQueue& queue, const char* name, const CallClass& call_class,
+    absl::Status (MetadataStore::*store_method)(const Request&, Response*),
+    typename StreamingCall<Request, Response>::RequestMethod request_method) {
+  new StreamingCall<Request, Response>(
+      queue, name, call_class,
+      [store_method](const Request& request)
+          -> std::unique_ptr<ResponseStream<Response>> {
+        return absl::make_unique<PagedResponseStream<Request, Response>>(
+            request, store_method);
+      },
+      request_method);
+}
+
+}  // namespace
+
+MetadataStoreAsyncService::MetadataStoreAsyncService(
+    const ConnectionConfig& connection_config,
+    const MetadataStoreServerConfig::ConnectionPoolConfig& pool_config,
+    const AsyncServerConfig& async_config,
+    const MetadataStoreServerConfig::ReadReplicaConfig& read_replica_config)
+    : metadata_store_pool_(connection_config, pool_config,
+                           read_replica_config),
+      async_config_(async_config),
+      type_read_workers_(async_config.num_type_read_workers(),
+                         async_config.max_queued_calls()),
+      read_workers_(async_config.num_read_workers(),
+                    async_config.max_queued_calls()),
+      write_workers_(async_config.num_write_workers(),
+                     async_config.max_queued_calls()) {
+  CHECK_GT(async_config_.num_completion_queue_threads(), 0)
+      << "The number of completion queue threads must be positive.";
+}
+
+absl::Status MetadataStoreAsyncService::PrefillConnectionPool() {
+  return metadata_store_pool_.Prefill();
+}
+
+absl::Status MetadataStoreAsyncService::WarmUpConnectionPool() {
+  return metadata_store_pool_.WarmUp();
+}
+
+void MetadataStoreAsyncService::RegisterWith(::grpc::ServerBuilder* builder) {
+  CHECK(builder) << "builder should not be null";
+  CHECK(completion_queues_.empty()) << "The service is already registered.";
+  builder->RegisterService(&service_);
+  for (int i = 0; i < async_config_.num_completion_queue_threads(); i++) {
+    completion_queues_.push_back(builder->AddCompletionQueue());
+  }
+}
+
+void MetadataStoreAsyncService::Serve() {
+  CHECK(!completion_queues_.empty()) << "The service is not registered.";
+  std::vector<std::thread> threads;
+  threads.reserve(completion_queues_.size());
+  for (std::unique_ptr<::grpc::ServerCompletionQueue>& cq :
+       completion_queues_) {
+    RequestCalls(cq.get());
+    threads.emplace_back([&cq]() {
+      void* tag;
+      bool ok;
+      // Returns false once the queue is shut down and drained.
+      while (cq->Next(&tag, &ok)) {
+        static_cast<Call*>(tag)->Proceed(ok);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+void MetadataStoreAsyncService::Shutdown() {
+  // The workers finish the calls in progress before the queues shut down.
+  type_read_workers_.Stop();
+  read_workers_.Stop();
+  write_workers_.Stop();
+  for (std::unique_ptr<::grpc::ServerCompletionQueue>& cq :
+       completion_queues_) {
+    cq->Shutdown();
+  }
+}
+
+void MetadataStoreAsyncService::RequestCalls(
+    ::grpc::ServerCompletionQueue* cq) {
+  const CallQueue queue = {&service_, cq, &metadata_store_pool_};
+  const CallClass type_reads = {&type_read_workers_, /*read_only=*/true};
+  const CallClass reads = {&read_workers_, /*read_only=*/true};
+  const CallClass writes = {&write_workers_, /*read_only=*/false};
+  // Type reads.
+  RequestCall(queue, "GetArtifactType", type_reads,
+              &MetadataStore::GetArtifactType,
+              &Service::RequestGetArtifactType);
+  RequestCall(queue, "GetArtifactTypesByID", type_reads,
+              &MetadataStore::GetArtifactTypesByID,
+              &Service::RequestGetArtifactTypesByID);
+  RequestCall(queue, "GetArtifactTypes", type_reads,
+              &MetadataStore::GetArtifactTypes,
+              &Service::RequestGetArtifactTypes);
+  RequestCall(queue, "GetExecutionType", type_reads,
+              &MetadataStore::GetExecutionType,
+              &Service::RequestGetExecutionType);
+  RequestCall(queue, "GetExecutionTypesByID", type_reads,
+              &MetadataStore::GetExecutionTypesByID,
+              &Service::RequestGetExecutionTypesByID);
+  RequestCall(queue, "GetExecutionTypes", type_reads,
+              &MetadataStore::GetExecutionTypes,
+              &Service::RequestGetExecutionTypes);
+  RequestCall(queue, "GetContextType", type_reads,
+              &MetadataStore::GetContextType,
+              &Service::RequestGetContextType);
+  RequestCall(queue, "GetContextTypesByID", type_reads,
+              &MetadataStore::GetContextTypesByID,
+              &Service::RequestGetContextTypesByID);
+  RequestCall(queue, "GetContextTypes", type_reads,
+              &MetadataStore::GetContextTypes,
+              &Service::RequestGetContextTypes);
+  // Node, event and lineage reads.
+  RequestCall(queue, "GetArtifacts", reads, &MetadataStore::GetArtifacts,
+              &Service::RequestGetArtifacts);
+  RequestCall(queue, "GetExecutions", reads, &MetadataStore::GetExecutions,
+              &Service::RequestGetExecutions);
+  RequestCall(queue, "GetContexts", reads, &MetadataStore::GetContexts,
+              &Service::RequestGetContexts);
+  RequestCall(queue, "GetArtifactsByID", reads,
+              &MetadataStore::GetArtifactsByID,
+              &Service::RequestGetArtifactsByID);
+  RequestCall(queue, "GetExecutionsByID", reads,
+              &MetadataStore::GetExecutionsByID,
+              &Service::RequestGetExecutionsByID);
+  RequestCall(queue, "GetContextsByID", reads, &MetadataStore::GetContextsByID,
+              &Service::RequestGetContextsByID);
+  RequestCall(queue, "GetArtifactsByType", reads,
+              &MetadataStore::GetArtifactsByType,
+              &Service::RequestGetArtifactsByType);
+  RequestCall(queue, "GetExecutionsByType", reads,
+              &MetadataStore::GetExecutionsByType,
+              &Service::RequestGetExecutionsByType);
+  RequestCall(queue, "GetActiveExecutionsByType", reads,
+              &MetadataStore::GetActiveExecutionsByType,
+              &Service::RequestGetActiveExecutionsByType);
+  RequestCall(queue, "GetContextsByType", reads,
+              &MetadataStore::GetContextsByType,
+              &Service::RequestGetContextsByType);
+  RequestCall(queue, "GetArtifactByTypeAndName", reads,
+              &MetadataStore::GetArtifactByTypeAndName,
+              &Service::RequestGetArtifactByTypeAndName);
+  RequestCall(queue, "GetExecutionByTypeAndName", reads,
+              &MetadataStore::GetExecutionByTypeAndName,
+              &Service::RequestGetExecutionByTypeAndName);
+  RequestCall(queue, "GetContextByTypeAndName", reads,
+              &MetadataStore::GetContextByTypeAndName,
+              &Service::RequestGetContextByTypeAndName);
+  RequestCall(queue, "GetArtifactsByURI", reads,
+              &MetadataStore::GetArtifactsByURI,
+              &Service::RequestGetArtifactsByURI);
+  RequestCall(queue, "GetEventsByExecutionIDs", reads,
+              &MetadataStore::GetEventsByExecutionIDs,
+              &Service::RequestGetEventsByExecutionIDs);
+  RequestCall(queue, "GetEventsByArtifactIDs", reads,
+              &MetadataStore::GetEventsByArtifactIDs,
+              &Service::RequestGetEventsByArtifactIDs);
+  RequestCall(queue, "GetEventsByTimeRange", reads,
+              &MetadataStore::GetEventsByTimeRange,
+              &Service::RequestGetEventsByTimeRange);
+  RequestCall(queue, "GetContextsByArtifact", reads,
+              &MetadataStore::GetContextsByArtifact,
+              &Service::RequestGetContextsByArtifact);
+  RequestCall(queue, "GetContextsByExecution", reads,
+              &MetadataStore::GetContextsByExecution,
+              &Service::RequestGetContextsByExecution);
+  RequestCall(queue, "GetExecutionDetails", reads,
+              &MetadataStore::GetExecutionDetails,
+              &Service::RequestGetExecutionDetails);
+  RequestCall(queue, "GetParentContextsByContext", reads,
+              &MetadataStore::GetParentContextsByContext,
+              &Service::RequestGetParentContextsByContext);
+  RequestCall(queue, "GetChildrenContextsByContext", reads,
+              &MetadataStore::GetChildrenContextsByContext,
+              &Service::RequestGetChildrenContextsByContext);
+  RequestCall(queue, "GetAncestorContexts", reads,
+              &MetadataStore::GetAncestorContexts,
+              &Service::RequestGetAncestorContexts);
+  RequestCall(queue, "GetDescendantContexts", reads,
+              &MetadataStore::GetDescendantContexts,
+              &Service::RequestGetDescendantContexts);
+  RequestCall(queue, "GetArtifactsByContext", reads,
+              &MetadataStore::GetArtifactsByContext,
+              &Service::RequestGetArtifactsByContext);
+  RequestCall(queue, "GetExecutionsByContext", reads,
+              &MetadataStore::GetExecutionsByContext,
+              &Service::RequestGetExecutionsByContext);
+  RequestCall(queue, "GetArtifactsByContexts", reads,
+              &MetadataStore::GetArtifactsByContexts,
+              &Service::RequestGetArtifactsByContexts);
+  RequestCall(queue, "GetExecutionsByContexts", reads,
+              &MetadataStore::GetExecutionsByContexts,
+              &Service::RequestGetExecutionsByContexts);
+  RequestCall(queue, "GetLineageGraph", reads, &MetadataStore::GetLineageGraph,
+              &Service::RequestGetLineageGraph);
+  RequestCall(queue, "GetArtifactsByDerivation", reads,
+              &MetadataStore::GetArtifactsByDerivation,
+              &Service::RequestGetArtifactsByDerivation);
+  RequestCall(queue, "GetChanges", reads, &MetadataStore::GetChanges,
+              &Service::RequestGetChanges);
+  RequestCall(queue, "CountArtifacts", reads, &MetadataStore::CountArtifacts,
+              &Service::RequestCountArtifacts);
+  RequestCall(queue, "CountExecutions", reads, &MetadataStore::CountExecutions,
+              &Service::RequestCountExecutions);
+  RequestCall(queue, "CountContexts", reads, &MetadataStore::CountContexts,
+              &Service::RequestCountContexts);
+  // Server-streaming reads.
+  RequestPagedStreamingCall(queue, "StreamArtifacts", reads,
+                            &MetadataStore::GetArtifacts,
+                            &Service::RequestStreamArtifacts);
+  RequestPagedStreamingCall(queue, "StreamExecutions", reads,
+                            &MetadataStore::GetExecutions,
+                            &Service::RequestStreamExecutions);
+  RequestPagedStreamingCall(queue, "StreamArtifactsByType", reads,
+                            &MetadataStore::GetArtifactsByType,
+                            &Service::RequestStreamArtifactsByType);
+  new StreamingCall<GetLineageGraphRequest, GetLineageGraphResponse>(
+      queue, "StreamLineageGraph", reads,
+      [](const GetLineageGraphRequest& request)
+          -> std::unique_ptr<ResponseStream<GetLineageGraphResponse>> {
+        return absl::make_unique<LineageGraphResponseStream>(request);
+      },
+      &Service::RequestStreamLineageGraph);
+  new StreamingCall<GetChangesRequest, GetChangesResponse>(
+      queue, "StreamChanges", reads,
+      [](const GetChangesRequest& request)
+          -> std::unique_ptr<ResponseStream<GetChangesResponse>> {
+        return absl::make_unique<ChangeLogResponseStream>(request);
+      },
+      &Service::RequestStreamChanges);
+  // Writes.
+  RequestCall(queue, "PutArtifactType", writes, &MetadataStore::PutArtifactType,
+              &Service::RequestPutArtifactType);
+  RequestCall(queue, "PutExecutionType", writes,
+              &MetadataStore::PutExecutionType,
+              &Service::RequestPutExecutionType);
+  RequestCall(queue, "PutContextType", writes, &MetadataStore::PutContextType,
+              &Service::RequestPutContextType);
+  RequestCall(queue, "PutTypes", writes, &MetadataStore::PutTypes,
+              &Service::RequestPutTypes);
+  RequestCall(queue, "PutArtifacts", writes, &MetadataStore::PutArtifacts,
+              &Service::RequestPutArtifacts);
+  RequestCall(queue, "PutExecutions", writes, &MetadataStore::PutExecutions,
+              &Service::RequestPutExecutions);
+  RequestCall(queue, "PutEvents", writes, &MetadataStore::PutEvents,
+              &Service::RequestPutEvents);
+  RequestCall(queue, "PutExecution", writes, &MetadataStore::PutExecution,
+              &Service::RequestPutExecution);
+  RequestCall(queue, "PutContexts", writes, &MetadataStore::PutContexts,
+              &Service::RequestPutContexts);
+  RequestCall(queue, "PutAttributionsAndAssociations", writes,
+              &MetadataStore::PutAttributionsAndAssociations,
+              &Service::RequestPutAttributionsAndAssociations);
+  RequestCall(queue, "PutParentContexts", writes,
+              &MetadataStore::PutParentContexts,
+              &Service::RequestPutParentContexts);
+  RequestCall(queue, "DeleteArtifacts", writes,
+              &MetadataStore::DeleteArtifacts,
+              &Service::RequestDeleteArtifacts);
+  RequestCall(queue, "DeleteExecutions", writes,
+              &MetadataStore::DeleteExecutions,
+              &Service::RequestDeleteExecutions);
+  RequestCall(queue, "ArchiveExecutions", writes,
+              &MetadataStore::ArchiveExecutions,
+              &Service::RequestArchiveExecutions);
+  RequestCall(queue, "ExecuteBatch", writes, &MetadataStore::ExecuteBatch,
+              &Service::RequestExecuteBatch);
+}
+
+}  // namespace ml_metadata
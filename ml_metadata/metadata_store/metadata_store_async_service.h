@@ -0,0 +1,110 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_ASYNC_SERVICE_H_
+#define ML_METADATA_METADATA_STORE_METADATA_STORE_ASYNC_SERVICE_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "grpcpp/server_builder.h"
+#include "ml_metadata/metadata_store/replicated_metadata_store_pool.h"
+#include "ml_metadata/metadata_store/worker_pool.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.grpc.pb.h"
+
+namespace ml_metadata {
+
+// A metadata store gRPC server that serves MetadataStoreService defined in
+// proto/metadata_store_service.proto with gRPC completion queues.
+// The completion queue threads never wait for the metadata source. Each call
+// is handed to the workers of its class (type reads, reads or writes), which
+// serve it with a MetadataStore leased from a bounded pool of connections, so
+// that a slow database does not hold the gRPC threads, and the cheap type
+// reads are not stuck behind large reads and writes. The type reads and reads
+// are balanced over the read replicas in `read_replica_config`, if any.
+// It is thread-safe.
+//
+// Usage example:
+//
+//    MetadataStoreAsyncService service(connection_config, pool_config,
+//                                      async_config);
+//    ::grpc::ServerBuilder builder;
+//    service.RegisterWith(&builder);
+//    std::unique_ptr<::grpc::Server> server = builder.BuildAndStart();
+//    // blocks until the server is shut down and service.Shutdown() is called.
+//    service.Serve();
+class MetadataStoreAsyncService {
+ public:
+  using AsyncServerConfig = MetadataStoreServerConfig::AsyncServerConfig;
+
+  // Check-fails if `pool_config`, `async_config` or `read_replica_config` is
+  // invalid.
+  MetadataStoreAsyncService(
+      const ConnectionConfig& connection_config,
+      const MetadataStoreServerConfig::ConnectionPoolConfig& pool_config,
+      const AsyncServerConfig& async_config,
+      const MetadataStoreServerConfig::ReadReplicaConfig& read_replica_config =
+          MetadataStoreServerConfig::ReadReplicaConfig());
+
+  // default & copy constructors are disallowed.
+  MetadataStoreAsyncService() = delete;
+  MetadataStoreAsyncService(const MetadataStoreAsyncService&) = delete;
+  MetadataStoreAsyncService& operator=(const MetadataStoreAsyncService&) =
+      delete;
+
+  // Opens `min_size` connections of the pools ahead of serving the calls.
+  // Returns detailed errors, if any connection to the primary fails to open.
+  absl::Status PrefillConnectionPool();
+
+  // Warms up the open connections of the pools, by reading all the types to
+  // their type caches and a node of each kind with each of them.
+  // Returns detailed errors, if a connection to the primary fails to warm up.
+  absl::Status WarmUpConnectionPool();
+
+  // Registers the service and its completion queues to `builder`. It must be
+  // called once, before the server is built.
+  void RegisterWith(::grpc::ServerBuilder* builder);
+
+  // Serves the calls with `num_completion_queue_threads` threads, and returns
+  // after Shutdown() is called. The server built by the builder passed to
+  // RegisterWith must be started.
+  void Serve();
+
+  // Waits for the calls being served by the workers, then shuts down the
+  // completion queues. It must be called after the server is shut down, and
+  // before the service is destructed.
+  void Shutdown();
+
+ private:
+  // Requests a call of every method of the service on `cq`.
+  void RequestCalls(::grpc::ServerCompletionQueue* cq);
+
+  MetadataStoreService::AsyncService service_;
+  ReplicatedMetadataStorePool metadata_store_pool_;
+  const AsyncServerConfig async_config_;
+  std::vector<std::unique_ptr<::grpc::ServerCompletionQueue>>
+      completion_queues_;
+
+  // The workers of each class of calls. They are destructed before the
+  // completion queues and the connection pool used by the calls they serve.
+  WorkerPool type_read_workers_;
+  WorkerPool read_workers_;
+  WorkerPool write_workers_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_METADATA_STORE_ASYNC_SERVICE_H_
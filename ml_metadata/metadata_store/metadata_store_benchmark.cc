@@ -0,0 +1,522 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Benchmarks of the core MetadataStore APIs on synthetic pipeline-shaped
+// workloads, for SQLite (in-memory and file) and MySQL backends. Besides the
+// mean time and the throughput, every benchmark reports the p50 and p99
+// latency of its calls in microseconds.
+//
+// Usage example:
+//
+//    bazel run -c opt //ml_metadata/metadata_store:metadata_store_benchmark --
+//        --benchmark_filter=PutExecution --mysql_host=localhost
+//        --mysql_database=mlmd_benchmark --mysql_user=root
+//
+// The MySQL benchmarks are skipped unless --mysql_host or --mysql_socket is
+// set. The MySQL database is dropped and recreated by every benchmark.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "gflags/gflags.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/mysql_metadata_source.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+DEFINE_string(sqlite_filename, "/tmp/mlmd_benchmark.db",
+              "The SQLite file of the file-backed benchmarks. It is deleted "
+              "before every benchmark.");
+DEFINE_string(mysql_host, "", "Host name or IP address of the MySQL server.");
+DEFINE_int32(mysql_port, 3306, "TCP port of the MySQL server.");
+DEFINE_string(mysql_socket, "", "Unix socket file of the MySQL server.");
+DEFINE_string(mysql_database, "mlmd_benchmark",
+              "The MySQL database used by the benchmarks, which is dropped "
+              "before every benchmark.");
+DEFINE_string(mysql_user, "", "MySQL login id.");
+DEFINE_string(mysql_password, "", "Password of --mysql_user.");
+
+namespace ml_metadata {
+namespace {
+
+// The backends, which are the first argument of every benchmark.
+enum Backend { kSqliteInMemory = 0, kSqliteFile = 1, kMySql = 2 };
+
+// Registers the benchmark for every backend with each of `workload_sizes`.
+void ForEachBackend(benchmark::internal::Benchmark* benchmark,
+                    const std::vector<int64_t>& workload_sizes) {
+  for (const int backend : {kSqliteInMemory, kSqliteFile, kMySql}) {
+    for (const int64_t workload_size : workload_sizes) {
+      benchmark->Args({backend, workload_size});
+    }
+  }
+  benchmark->ArgNames({"backend", "n"});
+}
+
+// Creates an empty MetadataStore of the backend of `state` to `store`.
+// Returns FailedPrecondition error if MySQL is not configured.
+absl::Status CreateEmptyStore(const benchmark::State& state,
+                              std::unique_ptr<MetadataStore>* store) {
+  ConnectionConfig connection_config;
+  switch (state.range(0)) {
+    case kSqliteInMemory:
+      connection_config.mutable_sqlite();
+      break;
+    case kSqliteFile:
+      std::remove(FLAGS_sqlite_filename.c_str());
+      connection_config.mutable_sqlite()->set_filename_uri(
+          FLAGS_sqlite_filename);
+      break;
+    case kMySql: {
+      if (FLAGS_mysql_host.empty() && FLAGS_mysql_socket.empty()) {
+        return absl::FailedPreconditionError(
+            "MySQL is not configured: set --mysql_host or --mysql_socket.");
+      }
+      MySQLDatabaseConfig* config = connection_config.mutable_mysql();
+      config->set_host(FLAGS_mysql_host);
+      config->set_port(FLAGS_mysql_port);
+      config->set_socket(FLAGS_mysql_socket);
+      config->set_database(FLAGS_mysql_database);
+      config->set_user(FLAGS_mysql_user);
+      config->set_password(FLAGS_mysql_password);
+      MySqlMetadataSource metadata_source(*config);
+      absl::Status status = metadata_source.Connect();
+      if (status.ok()) status = metadata_source.Begin();
+      if (status.ok()) {
+        status = metadata_source.ExecuteQuery(
+            absl::StrCat("DROP DATABASE IF EXISTS ", config->database()),
+            nullptr);
+      }
+      if (status.ok()) status = metadata_source.Commit();
+      if (!status.ok()) return status;
+      break;
+    }
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unknown backend: ", state.range(0)));
+  }
+  return CreateMetadataStore(connection_config, store);
+}
+
+// Collects the latencies of the calls of a benchmark, and reports their
+// percentiles as counters.
+class LatencyRecorder {
+ public:
+  void Start() { start_ = absl::Now(); }
+  void Stop() { latencies_.push_back(absl::Now() - start_); }
+
+  // Reports the p50 and p99 latencies in microseconds.
+  void Report(benchmark::State& state) {
+    if (latencies_.empty()) return;
+    std::sort(latencies_.begin(), latencies_.end());
+    state.counters["p50_us"] =
+        absl::ToDoubleMicroseconds(latencies_[latencies_.size() * 50 / 100]);
+    state.counters["p99_us"] =
+        absl::ToDoubleMicroseconds(latencies_[latencies_.size() * 99 / 100]);
+  }
+
+ private:
+  absl::Time start_;
+  std::vector<absl::Duration> latencies_;
+};
+
+// The types of a pipeline-shaped workload.
+struct PipelineTypes {
+  int64 artifact_type_id;
+  int64 execution_type_id;
+  int64 context_type_id;
+};
+
+absl::Status PutPipelineTypes(MetadataStore* store, PipelineTypes* types) {
+  PutTypesRequest request;
+  ArtifactType* artifact_type = request.add_artifact_types();
+  artifact_type->set_name("Examples");
+  (*artifact_type->mutable_properties())["span"] = INT;
+  (*artifact_type->mutable_properties())["split"] = STRING;
+  ExecutionType* execution_type = request.add_execution_types();
+  execution_type->set_name("Trainer");
+  (*execution_type->mutable_properties())["step"] = INT;
+  request.add_context_types()->set_name("PipelineRun");
+  PutTypesResponse response;
+  const absl::Status status = store->PutTypes(request, &response);
+  if (!status.ok()) return status;
+  types->artifact_type_id = response.artifact_type_ids(0);
+  types->execution_type_id = response.execution_type_ids(0);
+  types->context_type_id = response.context_type_ids(0);
+  return absl::OkStatus();
+}
+
+// Returns a PutExecution request of an execution in the run `run_name`, which
+// uses the artifact `input_artifact_id` if it is positive, and outputs
+// `num_output_artifacts` new artifacts.
+PutExecutionRequest MakePutExecutionRequest(const PipelineTypes& types,
+                                            const std::string& run_name,
+                                            const int64 input_artifact_id,
+                                            const int num_output_artifacts) {
+  PutExecutionRequest request;
+  request.mutable_execution()->set_type_id(types.execution_type_id);
+  (*request.mutable_execution()->mutable_properties())["step"].set_int_value(
+      1);
+  request.mutable_execution()->set_last_known_state(Execution::COMPLETE);
+  if (input_artifact_id > 0) {
+    PutExecutionRequest::ArtifactAndEvent* input =
+        request.add_artifact_event_pairs();
+    input->mutable_event()->set_artifact_id(input_artifact_id);
+    input->mutable_event()->set_type(Event::INPUT);
+  }
+  for (int i = 0; i < num_output_artifacts; i++) {
+    PutExecutionRequest::ArtifactAndEvent* output =
+        request.add_artifact_event_pairs();
+    Artifact* artifact = output->mutable_artifact();
+    artifact->set_type_id(types.artifact_type_id);
+    artifact->set_uri(absl::StrCat("/pipeline/", run_name, "/output/", i));
+    (*artifact->mutable_properties())["span"].set_int_value(i);
+    (*artifact->mutable_properties())["split"].set_string_value("train");
+    output->mutable_event()->set_type(Event::OUTPUT);
+  }
+  Context* context = request.add_contexts();
+  context->set_type_id(types.context_type_id);
+  context->set_name(run_name);
+  request.mutable_options()->set_reuse_context_if_already_exist(true);
+  return request;
+}
+
+// Puts a run of `num_executions` executions, each outputting
+// `num_output_artifacts` artifacts, to `store`. The ids of the artifacts and
+// the context of the run are returned in `artifact_ids` and `context_id`.
+absl::Status PutPipelineRun(MetadataStore* store, const PipelineTypes& types,
+                            const std::string& run_name,
+                            const int num_executions,
+                            const int num_output_artifacts,
+                            std::vector<int64>* artifact_ids,
+                            int64* context_id) {
+  for (int i = 0; i < num_executions; i++) {
+    const PutExecutionRequest request =
+        MakePutExecutionRequest(types, run_name, /*input_artifact_id=*/-1,
+                                num_output_artifacts);
+    PutExecutionResponse response;
+    const absl::Status status = store->PutExecution(request, &response);
+    if (!status.ok()) return status;
+    artifact_ids->insert(artifact_ids->end(), response.artifact_ids().begin(),
+                         response.artifact_ids().end());
+    *context_id = response.context_ids(0);
+  }
+  return absl::OkStatus();
+}
+
+// Sets up the store of the benchmark, or skips the benchmark on errors.
+bool SetUpStore(benchmark::State& state, std::unique_ptr<MetadataStore>* store,
+                PipelineTypes* types) {
+  absl::Status status = CreateEmptyStore(state, store);
+  if (status.ok()) status = PutPipelineTypes(store->get(), types);
+  if (!status.ok()) {
+    state.SkipWithError(status.ToString().c_str());
+    return false;
+  }
+  return true;
+}
+
+// Creates a new artifact type in every call.
+void BM_PutArtifactType(benchmark::State& state) {
+  std::unique_ptr<MetadataStore> store;
+  PipelineTypes types;
+  if (!SetUpStore(state, &store, &types)) return;
+  LatencyRecorder latencies;
+  int64 i = 0;
+  for (auto _ : state) {
+    PutArtifactTypeRequest request;
+    request.mutable_artifact_type()->set_name(absl::StrCat("type_", i++));
+    for (int j = 0; j < state.range(1); j++) {
+      (*request.mutable_artifact_type()
+            ->mutable_properties())[absl::StrCat("p_", j)] = STRING;
+    }
+    PutArtifactTypeResponse response;
+    latencies.Start();
+    const absl::Status status = store->PutArtifactType(request, &response);
+    latencies.Stop();
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  latencies.Report(state);
+}
+BENCHMARK(BM_PutArtifactType)->Apply([](benchmark::internal::Benchmark* b) {
+  ForEachBackend(b, /*workload_sizes=*/{1, 10});
+});
+
+// Publishes an execution of a run with `n` output artifacts in every call.
+void BM_PutExecution(benchmark::State& state) {
+  std::unique_ptr<MetadataStore> store;
+  PipelineTypes types;
+  if (!SetUpStore(state, &store, &types)) return;
+  LatencyRecorder latencies;
+  int64 i = 0;
+  for (auto _ : state) {
+    const PutExecutionRequest request =
+        MakePutExecutionRequest(types, absl::StrCat("run_", i++ / 10),
+                                /*input_artifact_id=*/-1, state.range(1));
+    PutExecutionResponse response;
+    latencies.Start();
+    const absl::Status status = store->PutExecution(request, &response);
+    latencies.Stop();
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      break;
+    }
+  }
+  // The throughput is counted in the artifacts published.
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+  latencies.Report(state);
+}
+BENCHMARK(BM_PutExecution)->Apply([](benchmark::internal::Benchmark* b) {
+  ForEachBackend(b, /*workload_sizes=*/{1, 10, 100});
+});
+
+// Reads `n` artifacts by id from a store of 10 runs in every call.
+void BM_GetArtifactsByID(benchmark::State& state) {
+  std::unique_ptr<MetadataStore> store;
+  PipelineTypes types;
+  if (!SetUpStore(state, &store, &types)) return;
+  std::vector<int64> artifact_ids;
+  int64 context_id;
+  for (int i = 0; i < 10; i++) {
+    const absl::Status status =
+        PutPipelineRun(store.get(), types, absl::StrCat("run_", i),
+                       /*num_executions=*/10, /*num_output_artifacts=*/10,
+                       &artifact_ids, &context_id);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  GetArtifactsByIDRequest request;
+  for (int i = 0; i < state.range(1); i++) {
+    request.add_artifact_ids(artifact_ids[i * 7 % artifact_ids.size()]);
+  }
+  LatencyRecorder latencies;
+  for (auto _ : state) {
+    GetArtifactsByIDResponse response;
+    latencies.Start();
+    const absl::Status status = store->GetArtifactsByID(request, &response);
+    latencies.Stop();
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+  latencies.Report(state);
+}
+BENCHMARK(BM_GetArtifactsByID)->Apply([](benchmark::internal::Benchmark* b) {
+  ForEachBackend(b, /*workload_sizes=*/{1, 100});
+});
+
+// Lists the artifacts of a run of `n` executions with 10 output artifacts
+// each, in pages of 100 artifacts.
+void BM_GetArtifactsByContext(benchmark::State& state) {
+  std::unique_ptr<MetadataStore> store;
+  PipelineTypes types;
+  if (!SetUpStore(state, &store, &types)) return;
+  std::vector<int64> artifact_ids;
+  int64 context_id;
+  const absl::Status status =
+      PutPipelineRun(store.get(), types, "run", state.range(1),
+                     /*num_output_artifacts=*/10, &artifact_ids, &context_id);
+  if (!status.ok()) {
+    state.SkipWithError(status.ToString().c_str());
+    return;
+  }
+  LatencyRecorder latencies;
+  for (auto _ : state) {
+    GetArtifactsByContextRequest request;
+    request.set_context_id(context_id);
+    request.mutable_options()->set_max_result_size(100);
+    GetArtifactsByContextResponse response;
+    latencies.Start();
+    const absl::Status status =
+        store->GetArtifactsByContext(request, &response);
+    latencies.Stop();
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          std::min<int64_t>(100, artifact_ids.size()));
+  latencies.Report(state);
+}
+BENCHMARK(BM_GetArtifactsByContext)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+      ForEachBackend(b, /*workload_sizes=*/{10, 100});
+    });
+
+// Lists the latest updated 100 artifacts of a type, using a filter query on
+// the type, from a store of `n` runs of 10 executions with 10 output
+// artifacts each.
+void BM_GetArtifactsOfTypeByLastUpdateTime(benchmark::State& state) {
+  std::unique_ptr<MetadataStore> store;
+  PipelineTypes types;
+  if (!SetUpStore(state, &store, &types)) return;
+  std::vector<int64> artifact_ids;
+  int64 context_id;
+  for (int i = 0; i < state.range(1); i++) {
+    const absl::Status status =
+        PutPipelineRun(store.get(), types, absl::StrCat("run_", i),
+                       /*num_executions=*/10, /*num_output_artifacts=*/10,
+                       &artifact_ids, &context_id);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  GetArtifactsRequest request;
+  request.mutable_options()->set_max_result_size(100);
+  request.mutable_options()->set_filter_query("type = 'Examples'");
+  request.mutable_options()->mutable_order_by_field()->set_field(
+      ListOperationOptions::OrderByField::LAST_UPDATE_TIME);
+  request.mutable_options()->mutable_order_by_field()->set_is_asc(false);
+  LatencyRecorder latencies;
+  for (auto _ : state) {
+    GetArtifactsResponse response;
+    latencies.Start();
+    const absl::Status status = store->GetArtifacts(request, &response);
+    latencies.Stop();
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          std::min<int64_t>(100, artifact_ids.size()));
+  latencies.Report(state);
+}
+BENCHMARK(BM_GetArtifactsOfTypeByLastUpdateTime)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+      ForEachBackend(b, /*workload_sizes=*/{10, 100});
+    });
+
+// Finds the context of an artifact in a store of `n` runs of 10 executions
+// with 10 output artifacts each.
+void BM_GetContextsByArtifact(benchmark::State& state) {
+  std::unique_ptr<MetadataStore> store;
+  PipelineTypes types;
+  if (!SetUpStore(state, &store, &types)) return;
+  std::vector<int64> artifact_ids;
+  int64 context_id;
+  for (int i = 0; i < state.range(1); i++) {
+    const absl::Status status =
+        PutPipelineRun(store.get(), types, absl::StrCat("run_", i),
+                       /*num_executions=*/10, /*num_output_artifacts=*/10,
+                       &artifact_ids, &context_id);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  LatencyRecorder latencies;
+  int64 i = 0;
+  for (auto _ : state) {
+    GetContextsByArtifactRequest request;
+    request.set_artifact_id(artifact_ids[i++ * 7 % artifact_ids.size()]);
+    GetContextsByArtifactResponse response;
+    latencies.Start();
+    const absl::Status status =
+        store->GetContextsByArtifact(request, &response);
+    latencies.Stop();
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+  latencies.Report(state);
+}
+BENCHMARK(BM_GetContextsByArtifact)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+      ForEachBackend(b, /*workload_sizes=*/{10, 100});
+    });
+
+// Queries the lineage of the head of a chain of `n` executions, each using
+// the artifact output by the previous one, i.e., a deep lineage.
+void BM_GetLineageGraph(benchmark::State& state) {
+  std::unique_ptr<MetadataStore> store;
+  PipelineTypes types;
+  if (!SetUpStore(state, &store, &types)) return;
+  int64 head_artifact_id = -1;
+  int64 input_artifact_id = -1;
+  for (int i = 0; i < state.range(1); i++) {
+    const PutExecutionRequest request = MakePutExecutionRequest(
+        types, "run", input_artifact_id, /*num_output_artifacts=*/2);
+    PutExecutionResponse response;
+    const absl::Status status = store->PutExecution(request, &response);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+    // The ids are aligned with the artifact_event_pairs, whose last one is an
+    // output artifact.
+    input_artifact_id = response.artifact_ids(response.artifact_ids_size() - 1);
+    if (head_artifact_id < 0) head_artifact_id = input_artifact_id;
+  }
+  GetLineageGraphRequest request;
+  request.mutable_options()->mutable_artifacts_options()->set_filter_query(
+      absl::StrCat("id = ", head_artifact_id));
+  request.mutable_options()->mutable_stop_conditions()->set_max_num_hops(
+      2 * state.range(1));
+  request.mutable_options()->set_max_node_size(0);
+  LatencyRecorder latencies;
+  int64 num_nodes = 0;
+  for (auto _ : state) {
+    GetLineageGraphResponse response;
+    latencies.Start();
+    const absl::Status status = store->GetLineageGraph(request, &response);
+    latencies.Stop();
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      break;
+    }
+    num_nodes = response.subgraph().artifacts_size() +
+                response.subgraph().executions_size();
+  }
+  // The throughput is counted in the nodes in the lineage.
+  state.SetItemsProcessed(state.iterations() * num_nodes);
+  latencies.Report(state);
+}
+BENCHMARK(BM_GetLineageGraph)->Apply([](benchmark::internal::Benchmark* b) {
+  ForEachBackend(b, /*workload_sizes=*/{4, 32});
+});
+
+}  // namespace
+}  // namespace ml_metadata
+
+int main(int argc, char** argv) {
+  // The benchmark flags are removed from `argv` before the MLMD flags are
+  // parsed.
+  benchmark::Initialize(&argc, argv);
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
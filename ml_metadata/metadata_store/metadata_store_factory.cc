@@ -14,12 +14,17 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
 
+#include <vector>
+
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/in_memory_metadata_source.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
 #include "ml_metadata/metadata_store/transaction_executor.h"
 #ifndef _WIN32
 #include "ml_metadata/metadata_store/mysql_metadata_source.h"
+#include "ml_metadata/metadata_store/postgresql_metadata_source.h"
 #endif
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
 #include "ml_metadata/util/metadata_source_query_config.h"
@@ -29,16 +34,42 @@ namespace ml_metadata {
 
 namespace {
 
+// How a created MetadataStore prepares its database.
+enum class DatabaseInit {
+  // Initializes the database if it does not exist, and checks it otherwise.
+  kInitIfNotExists,
+  // Like kInitIfNotExists, but without the secondary indices.
+  kInitWithoutSecondaryIndices,
+  // Trusts that the database is initialized at the library schema version.
+  kTrustSchema,
+};
+
 #ifndef _WIN32
-absl::Status CreateMySQLMetadataStore(const MySQLDatabaseConfig& config,
-                                      const MigrationOptions& migration_options,
-                                      std::unique_ptr<MetadataStore>* result) {
+absl::Status CreateMySQLMetadataStore(
+    const MySQLDatabaseConfig& config,
+    const MigrationOptions& migration_options,
+    const RetryOptions& retry_options, const DatabaseInit database_init,
+    const std::vector<IndexedProperty>& indexed_properties,
+    std::unique_ptr<MetadataStore>* result) {
   auto metadata_source = absl::make_unique<MySqlMetadataSource>(config);
-  auto transaction_executor =
-      absl::make_unique<RdbmsTransactionExecutor>(metadata_source.get());
+  auto transaction_executor = absl::make_unique<RdbmsTransactionExecutor>(
+      metadata_source.get(), retry_options);
+  MetadataSourceQueryConfig query_config =
+      util::GetMySqlMetadataSourceQueryConfig();
+  if (database_init == DatabaseInit::kInitWithoutSecondaryIndices) {
+    query_config.clear_secondary_indices();
+    query_config.clear_create_indexed_property_index();
+  }
   MLMD_RETURN_IF_ERROR(MetadataStore::Create(
-      util::GetMySqlMetadataSourceQueryConfig(), migration_options,
-      std::move(metadata_source), std::move(transaction_executor), result));
+      query_config, migration_options, std::move(metadata_source),
+      std::move(transaction_executor), result));
+  (*result)->set_indexed_properties(indexed_properties);
+  (*result)->set_database_key(
+      absl::StrCat("mysql:", config.host(), ":", config.port(), ":",
+                   config.socket(), "/", config.database()));
+  if (database_init == DatabaseInit::kTrustSchema) {
+    return absl::OkStatus();
+  }
   return (*result)->InitMetadataStoreIfNotExists(
       migration_options.enable_upgrade_migration());
 }
@@ -46,32 +77,155 @@ absl::Status CreateMySQLMetadataStore(const MySQLDatabaseConfig& config,
 absl::Status CreateMySQLMetadataStore(
     const MySQLDatabaseConfig& config,
     const MigrationOptions& migration_options,
+    const RetryOptions& retry_options,
+    const DatabaseInit database_init,
+    const std::vector<IndexedProperty>& indexed_properties,
     std::unique_ptr<MetadataStore>* result) {
   return absl::UnimplementedError(
              "MySQL is not supported in Windows yet");
 }
 #endif
 
+#ifndef _WIN32
+// PostgreSQL databases are created at the library schema version, and have no
+// migration schemes to upgrade or downgrade them.
+absl::Status CreatePostgreSQLMetadataStore(
+    const PostgreSQLDatabaseConfig& config,
+    const MigrationOptions& migration_options,
+    const RetryOptions& retry_options, const DatabaseInit database_init,
+    const std::vector<IndexedProperty>& indexed_properties,
+    std::unique_ptr<MetadataStore>* result) {
+  auto metadata_source = absl::make_unique<PostgreSQLMetadataSource>(config);
+  auto transaction_executor = absl::make_unique<RdbmsTransactionExecutor>(
+      metadata_source.get(), retry_options);
+  MetadataSourceQueryConfig query_config =
+      util::GetPostgreSQLMetadataSourceQueryConfig();
+  if (database_init == DatabaseInit::kInitWithoutSecondaryIndices) {
+    query_config.clear_secondary_indices();
+    query_config.clear_create_indexed_property_index();
+  }
+  MLMD_RETURN_IF_ERROR(MetadataStore::Create(
+      query_config, migration_options, std::move(metadata_source),
+      std::move(transaction_executor), result));
+  (*result)->set_indexed_properties(indexed_properties);
+  (*result)->set_database_key(absl::StrCat(
+      "postgresql:", config.host(), ":", config.port(), "/", config.dbname()));
+  if (database_init == DatabaseInit::kTrustSchema) {
+    return absl::OkStatus();
+  }
+  return (*result)->InitMetadataStoreIfNotExists(
+      migration_options.enable_upgrade_migration());
+}
+#else
+absl::Status CreatePostgreSQLMetadataStore(
+    const PostgreSQLDatabaseConfig& config,
+    const MigrationOptions& migration_options,
+    const RetryOptions& retry_options, const DatabaseInit database_init,
+    const std::vector<IndexedProperty>& indexed_properties,
+    std::unique_ptr<MetadataStore>* result) {
+  return absl::UnimplementedError(
+      "PostgreSQL is not supported in Windows yet");
+}
+#endif
+
 absl::Status CreateSqliteMetadataStore(
     const SqliteMetadataSourceConfig& config,
     const MigrationOptions& migration_options,
+    const RetryOptions& retry_options,
+    const DatabaseInit database_init,
+    const std::vector<IndexedProperty>& indexed_properties,
     std::unique_ptr<MetadataStore>* result) {
   auto metadata_source = absl::make_unique<SqliteMetadataSource>(config);
-  auto transaction_executor =
-      absl::make_unique<RdbmsTransactionExecutor>(metadata_source.get());
+  auto transaction_executor = absl::make_unique<RdbmsTransactionExecutor>(
+      metadata_source.get(), retry_options);
+  MetadataSourceQueryConfig query_config =
+      util::GetSqliteMetadataSourceQueryConfig();
+  if (database_init == DatabaseInit::kInitWithoutSecondaryIndices) {
+    query_config.clear_secondary_indices();
+    query_config.clear_create_indexed_property_index();
+  }
+  MLMD_RETURN_IF_ERROR(MetadataStore::Create(
+      query_config, migration_options, std::move(metadata_source),
+      std::move(transaction_executor), result));
+  (*result)->set_indexed_properties(indexed_properties);
+  if (config.connection_mode() == SqliteMetadataSourceConfig::IMMUTABLE) {
+    // An immutable database is neither initialized nor migrated.
+    return database_init == DatabaseInit::kTrustSchema
+               ? absl::OkStatus()
+               : (*result)->VerifySchemaVersion();
+  }
+  // Every connection to an in-memory database opens a new empty database.
+  const bool in_memory =
+      config.filename_uri().empty() || config.filename_uri() == ":memory:";
+  if (database_init == DatabaseInit::kTrustSchema && !in_memory) {
+    return absl::OkStatus();
+  }
+  if (!in_memory) {
+    (*result)->set_database_key(absl::StrCat("sqlite:", config.filename_uri()));
+  }
+  return (*result)->InitMetadataStoreIfNotExists(
+      migration_options.enable_upgrade_migration());
+}
+
+absl::Status CreateInMemoryMetadataStore(
+    const MigrationOptions& migration_options,
+    const RetryOptions& retry_options,
+    std::unique_ptr<MetadataStore>* result) {
+  auto metadata_source = absl::make_unique<InMemoryMetadataSource>();
+  auto transaction_executor = absl::make_unique<RdbmsTransactionExecutor>(
+      metadata_source.get(), retry_options);
   MLMD_RETURN_IF_ERROR(MetadataStore::Create(
-      util::GetSqliteMetadataSourceQueryConfig(), migration_options,
+      util::GetInMemoryMetadataSourceQueryConfig(), migration_options,
       std::move(metadata_source), std::move(transaction_executor), result));
+  // Every connection opens a new empty database, which is always initialized.
   return (*result)->InitMetadataStoreIfNotExists(
       migration_options.enable_upgrade_migration());
 }
 
+// Returns InvalidArgument error if an indexed property of `config` has no
+// name or node kind, or a value type other than INT, DOUBLE and STRING.
+absl::Status CheckIndexedProperties(const ConnectionConfig& config) {
+  for (const IndexedProperty& property : config.indexed_properties()) {
+    if (property.property_name().empty()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "The indexed property has no name: ", property.DebugString()));
+    }
+    if (property.node_kind() == IndexedProperty::UNKNOWN) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "The indexed property has no node kind: ", property.DebugString()));
+    }
+    if (property.value_type() != PropertyType::INT &&
+        property.value_type() != PropertyType::DOUBLE &&
+        property.value_type() != PropertyType::STRING) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "The indexed property has an unsupported value type: ",
+          property.DebugString()));
+    }
+  }
+  return absl::OkStatus();
+}
 
-}  // namespace
+// Returns InvalidArgument error if the property value compression of `config`
+// has a non-positive min_value_size, or a level outside [1, 9].
+absl::Status CheckPropertyValueCompression(const ConnectionConfig& config) {
+  const PropertyValueCompressionConfig& compression =
+      config.property_value_compression();
+  if (compression.min_value_size() <= 0 || compression.level() < 1 ||
+      compression.level() > 9) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid property value compression: ",
+                     compression.DebugString()));
+  }
+  return absl::OkStatus();
+}
 
-absl::Status CreateMetadataStore(const ConnectionConfig& config,
-                                 const MigrationOptions& options,
-                                 std::unique_ptr<MetadataStore>* result) {
+// Creates a MetadataStore of the metadata source of `config`, whose database
+// is prepared according to `database_init`.
+absl::Status CreateMetadataStoreOfSource(
+    const ConnectionConfig& config, const MigrationOptions& options,
+    const DatabaseInit database_init,
+    const std::vector<IndexedProperty>& indexed_properties,
+    std::unique_ptr<MetadataStore>* result) {
   switch (config.config_case()) {
     case ConnectionConfig::CONFIG_NOT_SET:
       // TODO(b/123345695): make this longer when that bug is resolved.
@@ -80,19 +234,75 @@ absl::Status CreateMetadataStore(const ConnectionConfig& config,
     case ConnectionConfig::kFakeDatabase:
       // Creates an in-memory SQLite database for testing.
       return CreateSqliteMetadataStore(SqliteMetadataSourceConfig(), options,
+                                       config.transaction_retry_options(),
+                                       database_init, indexed_properties,
                                        result);
     case ConnectionConfig::kMysql:
-      return CreateMySQLMetadataStore(config.mysql(), options, result);
+      return CreateMySQLMetadataStore(config.mysql(), options,
+                                      config.transaction_retry_options(),
+                                      database_init, indexed_properties,
+                                      result);
+    case ConnectionConfig::kPostgresql:
+      return CreatePostgreSQLMetadataStore(config.postgresql(), options,
+                                           config.transaction_retry_options(),
+                                           database_init, indexed_properties,
+                                           result);
     case ConnectionConfig::kSqlite:
-      return CreateSqliteMetadataStore(config.sqlite(), options, result);
+      return CreateSqliteMetadataStore(config.sqlite(), options,
+                                       config.transaction_retry_options(),
+                                       database_init, indexed_properties,
+                                       result);
+    case ConnectionConfig::kInMemory:
+      return CreateInMemoryMetadataStore(
+          options, config.transaction_retry_options(), result);
     default:
       return absl::UnimplementedError("Unknown database type.");
   }
 }
 
+// Creates a MetadataStore of `config`, whose database is prepared according to
+// `database_init`.
+absl::Status CreateMetadataStoreImpl(const ConnectionConfig& config,
+                                     const MigrationOptions& options,
+                                     const DatabaseInit database_init,
+                                     std::unique_ptr<MetadataStore>* result) {
+  MLMD_RETURN_IF_ERROR(CheckIndexedProperties(config));
+  MLMD_RETURN_IF_ERROR(CheckPropertyValueCompression(config));
+  const std::vector<IndexedProperty> indexed_properties(
+      config.indexed_properties().begin(), config.indexed_properties().end());
+  MLMD_RETURN_IF_ERROR(CreateMetadataStoreOfSource(
+      config, options, database_init, indexed_properties, result));
+  if (config.has_property_value_compression()) {
+    (*result)->set_property_value_compression(
+        config.property_value_compression());
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status CreateMetadataStore(const ConnectionConfig& config,
+                                 const MigrationOptions& options,
+                                 std::unique_ptr<MetadataStore>* result) {
+  return CreateMetadataStoreImpl(config, options,
+                                 DatabaseInit::kInitIfNotExists, result);
+}
+
 absl::Status CreateMetadataStore(const ConnectionConfig& config,
                                  std::unique_ptr<MetadataStore>* result) {
   return CreateMetadataStore(config, {}, result);
 }
 
+absl::Status CreateMetadataStoreWithoutSecondaryIndices(
+    const ConnectionConfig& config, std::unique_ptr<MetadataStore>* result) {
+  return CreateMetadataStoreImpl(
+      config, {}, DatabaseInit::kInitWithoutSecondaryIndices, result);
+}
+
+absl::Status CreateMetadataStoreWithTrustedSchema(
+    const ConnectionConfig& config, std::unique_ptr<MetadataStore>* result) {
+  return CreateMetadataStoreImpl(config, {}, DatabaseInit::kTrustSchema,
+                                 result);
+}
+
 }  // namespace ml_metadata
@@ -32,6 +32,22 @@ absl::Status CreateMetadataStore(const ConnectionConfig& config,
                                  const MigrationOptions& options,
                                  std::unique_ptr<MetadataStore>* result);
 
+// Creates a MetadataStore like CreateMetadataStore, but a new database is
+// initialized without the secondary indices, e.g., to bulk load the database
+// before the indices are built. The indices are built by InitMetadataStore of
+// a MetadataStore created by CreateMetadataStore with the same `config`.
+absl::Status CreateMetadataStoreWithoutSecondaryIndices(
+    const ConnectionConfig& config, std::unique_ptr<MetadataStore>* result);
+
+// Creates a MetadataStore like CreateMetadataStore, but trusts that the
+// database is already initialized at the library schema version, e.g., by an
+// earlier CreateMetadataStore with the same `config` in this process. Neither
+// the tables nor the schema version are checked, so creating the store runs no
+// query. An in-memory SQLite database is still initialized, as every
+// connection to it opens a new database.
+absl::Status CreateMetadataStoreWithTrustedSchema(
+    const ConnectionConfig& config, std::unique_ptr<MetadataStore>* result);
+
 }  // namespace ml_metadata
 
 #endif  // THIRD_PARTY_ML_METADATA_METADATA_STORE_METADATA_STORE_FACTORY_H_
@@ -14,14 +14,19 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
 
+#include <cstdio>
 #include <memory>
+#include <string>
 
 #include <glog/logging.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/sqlite_metadata_source.h"
 #include "ml_metadata/metadata_store/test_util.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
@@ -73,5 +78,109 @@ TEST(MetadataStoreFactoryTest, CreateSQLiteMetadataStore) {
   TestPutAndGetArtifactType(connection_config);
 }
 
+TEST(MetadataStoreFactoryTest, CreateImmutableSQLiteMetadataStore) {
+  const std::string filename_uri =
+      absl::StrCat(::testing::TempDir(), "/immutable_metadata_store.db");
+  std::remove(filename_uri.c_str());
+  ConnectionConfig connection_config;
+  connection_config.mutable_sqlite()->set_filename_uri(filename_uri);
+  TestPutAndGetArtifactType(connection_config);
+
+  connection_config.mutable_sqlite()->set_connection_mode(
+      SqliteMetadataSourceConfig::IMMUTABLE);
+  std::unique_ptr<MetadataStore> store;
+  ASSERT_EQ(absl::OkStatus(), CreateMetadataStore(connection_config, &store));
+  GetArtifactTypeResponse get_response;
+  ASSERT_EQ(absl::OkStatus(),
+            store->GetArtifactType(ParseTextProtoOrDie<GetArtifactTypeRequest>(
+                                       "type_name: 'test_type2'"),
+                                   &get_response));
+  EXPECT_EQ(get_response.artifact_type().name(), "test_type2");
+  PutArtifactTypeResponse put_response;
+  EXPECT_FALSE(store
+                   ->PutArtifactType(ParseTextProtoOrDie<PutArtifactTypeRequest>(
+                                         "artifact_type: { name: 'test_type3' }"),
+                                     &put_response)
+                   .ok());
+}
+
+TEST(MetadataStoreFactoryTest, CreateSQLiteMetadataStoreWithIndexedProperties) {
+  ConnectionConfig connection_config = ParseTextProtoOrDie<ConnectionConfig>(
+      R"pb(
+        sqlite {}
+        indexed_properties {
+          node_kind: ARTIFACT
+          property_name: 'model version'
+          is_custom_property: true
+          value_type: STRING
+        }
+      )pb");
+  std::unique_ptr<MetadataStore> store;
+  ASSERT_EQ(absl::OkStatus(), CreateMetadataStore(connection_config, &store));
+  PutArtifactTypeResponse put_type_response;
+  ASSERT_EQ(absl::OkStatus(),
+            store->PutArtifactType(ParseTextProtoOrDie<PutArtifactTypeRequest>(
+                                       "artifact_type: { name: 'model' }"),
+                                   &put_type_response));
+  PutArtifactsRequest put_request;
+  for (const std::string version : {"v1", "v2", "v2"}) {
+    Artifact* artifact = put_request.add_artifacts();
+    artifact->set_type_id(put_type_response.type_id());
+    (*artifact->mutable_custom_properties())["model version"].set_string_value(
+        version);
+  }
+  PutArtifactsResponse put_response;
+  ASSERT_EQ(absl::OkStatus(), store->PutArtifacts(put_request, &put_response));
+
+  GetArtifactsRequest get_request;
+  get_request.mutable_options()->set_filter_query(
+      "custom_properties.`model version`.string_value = 'v2'");
+  GetArtifactsResponse get_response;
+  ASSERT_EQ(absl::OkStatus(), store->GetArtifacts(get_request, &get_response));
+  EXPECT_EQ(get_response.artifacts_size(), 2);
+
+  connection_config.mutable_indexed_properties(0)->clear_property_name();
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      CreateMetadataStore(connection_config, &store)));
+}
+
+TEST(MetadataStoreFactoryTest, SkipsUpsertingSimpleTypesOfSameTypeGeneration) {
+  const std::string filename_uri =
+      absl::StrCat(::testing::TempDir(), "/simple_types_metadata_store.db");
+  std::remove(filename_uri.c_str());
+  ConnectionConfig connection_config;
+  connection_config.mutable_sqlite()->set_filename_uri(filename_uri);
+  std::unique_ptr<MetadataStore> store;
+  ASSERT_EQ(absl::OkStatus(), CreateMetadataStore(connection_config, &store));
+
+  // Removes a simple type behind the stores, keeping the type generation.
+  SqliteMetadataSource metadata_source(connection_config.sqlite());
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Connect());
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Begin());
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source.ExecuteQuery(
+                "DELETE FROM `Type` WHERE `name` = 'mlmd.Train';",
+                &record_set));
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Commit());
+  const GetExecutionTypeRequest get_request =
+      ParseTextProtoOrDie<GetExecutionTypeRequest>("type_name: 'mlmd.Train'");
+  GetExecutionTypeResponse get_response;
+  ASSERT_EQ(absl::OkStatus(), CreateMetadataStore(connection_config, &store));
+  EXPECT_TRUE(absl::IsNotFound(
+      store->GetExecutionType(get_request, &get_response)));
+
+  // Once the types change, the next store upserts the simple types again.
+  PutArtifactTypeResponse put_response;
+  ASSERT_EQ(absl::OkStatus(),
+            store->PutArtifactType(ParseTextProtoOrDie<PutArtifactTypeRequest>(
+                                       "artifact_type: { name: 'test_type' }"),
+                                   &put_response));
+  ASSERT_EQ(absl::OkStatus(), CreateMetadataStore(connection_config, &store));
+  EXPECT_EQ(absl::OkStatus(),
+            store->GetExecutionType(get_request, &get_response));
+  EXPECT_EQ(get_response.execution_type().name(), "mlmd.Train");
+}
+
 }  // namespace
 }  // namespace ml_metadata
@@ -310,6 +310,7 @@ static void* Swig_malloc(int c) {
 #include "absl/status/status.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
 
 template <typename ProtoType>
 absl::Status ParseProto(const string& input, ProtoType* proto) {
@@ -661,6 +662,35 @@ string GetExecutionsByContext(ml_metadata::MetadataStore* metadata_store,
       request, status);
 }
 
+// Executes the calls of the serialized BatchRequest of `request_size` bytes
+// at `request`, and returns the serialized BatchResponse in a buffer
+// allocated by malloc, which the caller frees with Swig_free. The request is
+// parsed in place and the response is serialized into the returned buffer, so
+// neither is copied across the binding, and a batch crosses it only once.
+// If the batch runs in a single transaction and a call fails, `status` is set
+// to its error and nothing is returned.
+_gostring_ ExecuteBatch(ml_metadata::MetadataStore* metadata_store,
+                        const char* request, size_t request_size,
+                        absl::Status* status) {
+  _gostring_ result = {nullptr, 0};
+  ml_metadata::BatchRequest batch_request;
+  if (!batch_request.ParseFromArray(request, request_size)) {
+    status->Update(absl::InvalidArgumentError("Could not parse proto"));
+    return result;
+  }
+  ml_metadata::BatchResponse batch_response;
+  status->Update(
+      metadata_store->ExecuteBatch(batch_request, &batch_response));
+  if (!status->ok()) return result;
+  result.n = batch_response.ByteSizeLong();
+  if (result.n > 0) {
+    result.p = (char*)malloc(result.n);
+    batch_response.SerializeWithCachedSizesToArray(
+        reinterpret_cast<uint8_t*>(result.p));
+  }
+  return result;
+}
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -1497,6 +1527,20 @@ _gostring_ _wrap_GetExecutionsByContext_metadata_store_go_wrap_111d7b2874b915fe(
   return _swig_go_result;
 }
 
+_gostring_ _wrap_ExecuteBatch_metadata_store_go_wrap_111d7b2874b915fe(
+    ml_metadata::MetadataStore *_swig_go_0, _goslice_ _swig_go_1,
+    absl::Status *_swig_go_2) {
+  ml_metadata::MetadataStore *arg1 = (ml_metadata::MetadataStore *) 0 ;
+  absl::Status *arg3 = (absl::Status *) 0 ;
+
+  arg1 = *(ml_metadata::MetadataStore **)&_swig_go_0;
+
+  arg3 = *(absl::Status **)&_swig_go_2;
+
+  return ExecuteBatch(arg1, (const char *)_swig_go_1.array,
+                      (size_t)_swig_go_1.len, arg3);
+}
+
 absl::Status *_wrap_CreateABSLStatus_metadata_store_go_wrap_111d7b2874b915fe() {
   absl::Status *result = 0 ;
   absl::Status *_swig_go_result;
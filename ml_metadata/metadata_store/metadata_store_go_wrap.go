@@ -119,6 +119,8 @@ typedef _gostring_ swig_type_73;
 typedef _gostring_ swig_type_74;
 typedef _gostring_ swig_type_75;
 typedef _gostring_ swig_type_76;
+typedef _gostring_ swig_type_77;
+typedef _goslice_ swig_type_78;
 extern void _wrap_Swig_free_metadata_store_go_wrap_111d7b2874b915fe(uintptr_t arg1);
 extern uintptr_t _wrap_Swig_malloc_metadata_store_go_wrap_111d7b2874b915fe(swig_intgo arg1);
 extern uintptr_t _wrap_CreateMetadataStore_metadata_store_go_wrap_111d7b2874b915fe(swig_type_1 arg1, uintptr_t arg2);
@@ -160,6 +162,7 @@ extern swig_type_68 _wrap_GetContextsByArtifact_metadata_store_go_wrap_111d7b287
 extern swig_type_70 _wrap_GetContextsByExecution_metadata_store_go_wrap_111d7b2874b915fe(uintptr_t arg1, swig_type_71 arg2, uintptr_t arg3);
 extern swig_type_72 _wrap_GetArtifactsByContext_metadata_store_go_wrap_111d7b2874b915fe(uintptr_t arg1, swig_type_73 arg2, uintptr_t arg3);
 extern swig_type_74 _wrap_GetExecutionsByContext_metadata_store_go_wrap_111d7b2874b915fe(uintptr_t arg1, swig_type_75 arg2, uintptr_t arg3);
+extern swig_type_77 _wrap_ExecuteBatch_metadata_store_go_wrap_111d7b2874b915fe(uintptr_t arg1, swig_type_78 arg2, uintptr_t arg3);
 extern uintptr_t _wrap_CreateABSLStatus_metadata_store_go_wrap_111d7b2874b915fe(void);
 extern void _wrap_DestroyABSLStatus_metadata_store_go_wrap_111d7b2874b915fe(uintptr_t arg1);
 extern _Bool _wrap_IsOk_metadata_store_go_wrap_111d7b2874b915fe(uintptr_t arg1);
@@ -779,6 +782,32 @@ func GetExecutionsByContext(arg1 Ml_metadata_MetadataStore, arg2 string, arg3 Ab
 	return swig_r_1
 }
 
+// ExecuteBatch returns the serialized BatchResponse in memory allocated by the
+// cc library, without copying it to Go memory. The returned slice must be
+// released with FreeBatchResponse, and must not be used after that.
+func ExecuteBatch(arg1 Ml_metadata_MetadataStore, arg2 []byte, arg3 Absl_Status) (_swig_ret []byte) {
+	var swig_r []byte
+	_swig_i_0 := arg1.Swigcptr()
+	_swig_i_1 := arg2
+	_swig_i_2 := arg3.Swigcptr()
+	swig_r_p := C._wrap_ExecuteBatch_metadata_store_go_wrap_111d7b2874b915fe(C.uintptr_t(_swig_i_0), *(*C.swig_type_78)(unsafe.Pointer(&_swig_i_1)), C.uintptr_t(_swig_i_2))
+	p := *(*swig_gostring)(unsafe.Pointer(&swig_r_p))
+	if p.p != 0 {
+		swig_r = (*[0x7fffffff]byte)(unsafe.Pointer(p.p))[:p.n:p.n]
+	}
+	if Swig_escape_always_false {
+		Swig_escape_val = arg2
+	}
+	return swig_r
+}
+
+// FreeBatchResponse releases the memory of a response of ExecuteBatch.
+func FreeBatchResponse(arg1 []byte) {
+	if len(arg1) > 0 {
+		Swig_free(uintptr(unsafe.Pointer(&arg1[0])))
+	}
+}
+
 func CreateABSLStatus() (_swig_ret Absl_Status) {
 	var swig_r Absl_Status
 	swig_r = (Absl_Status)(SwigcptrAbsl_Status(C._wrap_CreateABSLStatus_metadata_store_go_wrap_111d7b2874b915fe()))
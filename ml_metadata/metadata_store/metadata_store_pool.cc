@@ -0,0 +1,276 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/lineage_graph_index.h"
+#include "ml_metadata/metadata_store/lineage_result_cache.h"
+#include "ml_metadata/metadata_store/property_string_dictionary.h"
+#include "ml_metadata/metadata_store/lookup_cache.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/trace_span.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+
+absl::Status MetadataStorePool::CreateStore(
+    std::unique_ptr<MetadataStore>* store) {
+  if (schema_verified_.load(std::memory_order_acquire)) {
+    MLMD_RETURN_IF_ERROR(
+        CreateMetadataStoreWithTrustedSchema(connection_config_, store));
+  } else {
+    MLMD_RETURN_IF_ERROR(CreateMetadataStore(connection_config_, store));
+    schema_verified_.store(true, std::memory_order_release);
+  }
+  (*store)->set_lookup_cache(lookup_cache_);
+  (*store)->set_lineage_graph_index(lineage_graph_index_);
+  (*store)->set_lineage_result_cache(lineage_result_cache_);
+  (*store)->set_property_string_dictionary(property_string_dictionary_);
+  return absl::OkStatus();
+}
+
+MetadataStorePool::ScopedStore::ScopedStore(ScopedStore&& other)
+    : pool_(other.pool_),
+      store_(std::move(other.store_)),
+      acquisition_time_(other.acquisition_time_),
+      release_counter_(other.release_counter_) {
+  other.pool_ = nullptr;
+  other.release_counter_ = nullptr;
+}
+
+MetadataStorePool::ScopedStore& MetadataStorePool::ScopedStore::operator=(
+    ScopedStore&& other) {
+  if (this != &other) {
+    Reset();
+    pool_ = other.pool_;
+    store_ = std::move(other.store_);
+    acquisition_time_ = other.acquisition_time_;
+    release_counter_ = other.release_counter_;
+    other.pool_ = nullptr;
+    other.release_counter_ = nullptr;
+  }
+  return *this;
+}
+
+void MetadataStorePool::ScopedStore::Reset() {
+  if (pool_ != nullptr && store_ != nullptr) {
+    pool_->Release(std::move(store_));
+    if (release_counter_ != nullptr) {
+      release_counter_->fetch_add(1);
+    }
+  }
+  pool_ = nullptr;
+  store_.reset();
+  release_counter_ = nullptr;
+}
+
+MetadataStorePool::MetadataStorePool(const ConnectionConfig& connection_config,
+                                     const ConnectionPoolConfig& pool_config)
+    : connection_config_(connection_config), pool_config_(pool_config) {
+  CHECK_GT(pool_config_.max_size(), 0)
+      << "The max_size of the connection pool must be positive.";
+  CHECK_GE(pool_config_.min_size(), 0)
+      << "The min_size of the connection pool cannot be negative.";
+  CHECK_LE(pool_config_.min_size(), pool_config_.max_size())
+      << "The min_size of the connection pool cannot exceed its max_size.";
+  if (pool_config_.has_lookup_cache_config()) {
+    lookup_cache_ =
+        std::make_shared<LookupCache>(pool_config_.lookup_cache_config());
+  }
+  if (pool_config_.has_lineage_result_cache_config()) {
+    lineage_result_cache_ = std::make_shared<LineageResultCache>(
+        pool_config_.lineage_result_cache_config());
+  }
+  if (pool_config_.has_lineage_graph_index_config()) {
+    lineage_graph_index_ = std::make_shared<LineageGraphIndex>(
+        pool_config_.lineage_graph_index_config());
+  }
+  if (pool_config_.has_property_string_dictionary_config()) {
+    property_string_dictionary_ = std::make_shared<PropertyStringDictionary>(
+        pool_config_.property_string_dictionary_config());
+  }
+}
+
+MetadataStorePool::~MetadataStorePool() {
+  absl::MutexLock lock(&mu_);
+  CHECK_EQ(num_open_stores_, idle_stores_.size())
+      << "All leased stores must be returned before destructing the pool.";
+}
+
+absl::Status MetadataStorePool::Acquire(ScopedStore* store) {
+  CHECK(store) << "store should not be null";
+  ScopedTraceSpan span("MetadataStorePool::Acquire");
+  const absl::Time start = absl::Now();
+  std::unique_ptr<MetadataStore> leased_store;
+  absl::Time idle_since;
+  std::vector<std::unique_ptr<MetadataStore>> expired_stores;
+  {
+    absl::MutexLock lock(&mu_);
+    mu_.Await(absl::Condition(this, &MetadataStorePool::CanAcquire));
+    TakeExpiredIdleStores(absl::Now(), &expired_stores);
+    if (!idle_stores_.empty()) {
+      leased_store = std::move(idle_stores_.back().store);
+      idle_since = idle_stores_.back().idle_since;
+      idle_stores_.pop_back();
+    } else {
+      // Reserves a slot for the store being created.
+      num_open_stores_++;
+    }
+  }
+  // Closes the expired connections without holding the lock.
+  expired_stores.clear();
+
+  if (leased_store != nullptr &&
+      pool_config_.health_check_interval_sec() >= 0 &&
+      absl::Now() - idle_since >=
+          absl::Seconds(pool_config_.health_check_interval_sec())) {
+    const absl::Status status = leased_store->CheckConnection();
+    if (!status.ok()) {
+      LOG(WARNING) << "Reconnecting a pooled metadata store, which failed the "
+                      "health check: "
+                   << status;
+      // The slot of the broken store is reused by the store created below.
+      leased_store.reset();
+    }
+  }
+  if (leased_store == nullptr) {
+    span.AddAttribute("mlmd.new_connection", "true");
+    const absl::Status status = CreateStore(&leased_store);
+    if (!status.ok()) {
+      absl::MutexLock lock(&mu_);
+      num_open_stores_--;
+      span.SetStatus(status);
+      return status;
+    }
+  }
+  store->Reset();
+  store->pool_ = this;
+  store->store_ = std::move(leased_store);
+  store->acquisition_time_ = absl::Now() - start;
+  return absl::OkStatus();
+}
+
+absl::Status MetadataStorePool::Prefill() {
+  while (true) {
+    {
+      absl::MutexLock lock(&mu_);
+      if (num_open_stores_ >= pool_config_.min_size()) break;
+      num_open_stores_++;
+    }
+    std::unique_ptr<MetadataStore> store;
+    const absl::Status status = CreateStore(&store);
+    if (!status.ok()) {
+      absl::MutexLock lock(&mu_);
+      num_open_stores_--;
+      return status;
+    }
+    Release(std::move(store));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MetadataStorePool::WarmUp() {
+  std::vector<std::unique_ptr<MetadataStore>> stores;
+  {
+    absl::MutexLock lock(&mu_);
+    for (IdleStore& idle_store : idle_stores_) {
+      stores.push_back(std::move(idle_store.store));
+    }
+    idle_stores_.clear();
+  }
+  absl::Status status;
+  for (std::unique_ptr<MetadataStore>& store : stores) {
+    if (status.ok()) {
+      status = WarmUpStore(store.get());
+    }
+    Release(std::move(store));
+  }
+  return status;
+}
+
+absl::Status MetadataStorePool::WarmUpStore(MetadataStore* store) {
+  GetArtifactTypesResponse artifact_types;
+  MLMD_RETURN_IF_ERROR(store->GetArtifactTypes({}, &artifact_types));
+  GetExecutionTypesResponse execution_types;
+  MLMD_RETURN_IF_ERROR(store->GetExecutionTypes({}, &execution_types));
+  GetContextTypesResponse context_types;
+  MLMD_RETURN_IF_ERROR(store->GetContextTypes({}, &context_types));
+  GetArtifactsRequest get_artifacts_request;
+  get_artifacts_request.mutable_options()->set_max_result_size(1);
+  GetArtifactsResponse artifacts;
+  MLMD_RETURN_IF_ERROR(store->GetArtifacts(get_artifacts_request, &artifacts));
+  GetExecutionsRequest get_executions_request;
+  get_executions_request.mutable_options()->set_max_result_size(1);
+  GetExecutionsResponse executions;
+  MLMD_RETURN_IF_ERROR(
+      store->GetExecutions(get_executions_request, &executions));
+  GetContextsRequest get_contexts_request;
+  get_contexts_request.mutable_options()->set_max_result_size(1);
+  GetContextsResponse contexts;
+  return store->GetContexts(get_contexts_request, &contexts);
+}
+
+int MetadataStorePool::num_open_stores() const {
+  absl::MutexLock lock(&mu_);
+  return num_open_stores_;
+}
+
+int MetadataStorePool::num_idle_stores() const {
+  absl::MutexLock lock(&mu_);
+  return idle_stores_.size();
+}
+
+void MetadataStorePool::Release(std::unique_ptr<MetadataStore> store) {
+  // The token of a call must not outlive it in the idle store.
+  store->set_cancellation_token(nullptr);
+  // Declared before the lock, so that the expired connections are closed
+  // after the lock is released.
+  std::vector<std::unique_ptr<MetadataStore>> expired_stores;
+  absl::MutexLock lock(&mu_);
+  const absl::Time now = absl::Now();
+  TakeExpiredIdleStores(now, &expired_stores);
+  idle_stores_.push_back({std::move(store), now});
+}
+
+void MetadataStorePool::TakeExpiredIdleStores(
+    const absl::Time now,
+    std::vector<std::unique_ptr<MetadataStore>>* expired_stores) {
+  if (pool_config_.idle_timeout_sec() <= 0) return;
+  const absl::Duration idle_timeout =
+      absl::Seconds(pool_config_.idle_timeout_sec());
+  while (!idle_stores_.empty() &&
+         num_open_stores_ > pool_config_.min_size() &&
+         now - idle_stores_.front().idle_since >= idle_timeout) {
+    expired_stores->push_back(std::move(idle_stores_.front().store));
+    idle_stores_.pop_front();
+    num_open_stores_--;
+  }
+}
+
+bool MetadataStorePool::CanAcquire() const {
+  return !idle_stores_.empty() || num_open_stores_ < pool_config_.max_size();
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,186 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_POOL_H_
+#define ML_METADATA_METADATA_STORE_METADATA_STORE_POOL_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/lineage_graph_index.h"
+#include "ml_metadata/metadata_store/lineage_result_cache.h"
+#include "ml_metadata/metadata_store/property_string_dictionary.h"
+#include "ml_metadata/metadata_store/lookup_cache.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// A bounded pool of long-lived MetadataStores connected to the same metadata
+// source. Reusing a store across requests avoids paying for the connection
+// handshake, the query executor setup and the schema version check on every
+// request. Only the first store created by the pool checks the database
+// schema; the later ones trust it, and skip the table and schema version
+// queries. The stores created by the pool do not handle migration. If the
+// `lookup_cache_config` is given, the stores share a LookupCache. If the
+// `lineage_result_cache_config` is given, they share a LineageResultCache. If
+// the `lineage_graph_index_config` is given, they share a LineageGraphIndex.
+// If the `property_string_dictionary_config` is given, they share a
+// PropertyStringDictionary. It is thread-safe.
+//
+// Usage example:
+//
+//    MetadataStorePool pool(connection_config, pool_config);
+//    MetadataStorePool::ScopedStore store;
+//    MLMD_RETURN_IF_ERROR(pool.Acquire(&store));
+//    MLMD_RETURN_IF_ERROR(store->PutArtifacts(request, &response));
+//    // the store goes back to the pool when `store` is out of scope.
+class MetadataStorePool {
+ public:
+  using ConnectionPoolConfig = MetadataStoreServerConfig::ConnectionPoolConfig;
+
+  // A MetadataStore leased from a MetadataStorePool. The store is returned to
+  // the pool when the ScopedStore is destructed or reset.
+  class ScopedStore {
+   public:
+    ScopedStore() = default;
+    ~ScopedStore() { Reset(); }
+
+    // Disallows copy, and allows move.
+    ScopedStore(const ScopedStore&) = delete;
+    ScopedStore& operator=(const ScopedStore&) = delete;
+    ScopedStore(ScopedStore&& other);
+    ScopedStore& operator=(ScopedStore&& other);
+
+    MetadataStore* get() const { return store_.get(); }
+    MetadataStore* operator->() const { return store_.get(); }
+
+    // Returns the leased store, if any, to its pool.
+    void Reset();
+
+    // Returns the time spent by Acquire() leasing the store, including waiting
+    // for a store to be returned and opening a new one.
+    absl::Duration acquisition_time() const { return acquisition_time_; }
+
+   private:
+    friend class MetadataStorePool;
+    friend class ReplicatedMetadataStorePool;
+
+    MetadataStorePool* pool_ = nullptr;
+    std::unique_ptr<MetadataStore> store_;
+    absl::Duration acquisition_time_;
+    // If set, it is incremented once the store is returned, e.g., after the
+    // write of a store leased for writes.
+    std::atomic<int64>* release_counter_ = nullptr;
+  };
+
+  // Creates a pool connecting to `connection_config`. No store is opened until
+  // the first Acquire() or Prefill().
+  // Check-fails if `pool_config` is invalid.
+  MetadataStorePool(const ConnectionConfig& connection_config,
+                    const ConnectionPoolConfig& pool_config);
+
+  // Disallows copy.
+  MetadataStorePool(const MetadataStorePool&) = delete;
+  MetadataStorePool& operator=(const MetadataStorePool&) = delete;
+
+  // All leased stores must be returned before the pool is destructed.
+  ~MetadataStorePool();
+
+  // Leases a store from the pool to `store`. The most recently returned idle
+  // store is reused, and it is health checked first if it has been idle for
+  // longer than `health_check_interval_sec`. If no idle store is available, a
+  // new one is created when fewer than `max_size` stores are open; otherwise
+  // the call waits until a store is returned.
+  // Returns detailed errors from CreateMetadataStore, if a store is needed and
+  // cannot be created.
+  absl::Status Acquire(ScopedStore* store);
+
+  // Opens stores until at least `min_size` stores are open.
+  // Returns detailed errors from CreateMetadataStore, if a store fails to open.
+  absl::Status Prefill();
+
+  // Warms up the idle stores, e.g., after Prefill() and before serving. Each
+  // store reads all the types, which fill its type cache, and the first node
+  // of each node kind, so that its connection prepares the statements of the
+  // hot reads. The stores are leased during the warm-up, so that a concurrent
+  // Acquire() opens another store or waits.
+  // Returns detailed errors of the reads, if a store fails to warm up.
+  absl::Status WarmUp();
+
+  // Returns the number of stores opened by the pool, either idle or leased.
+  int num_open_stores() const;
+
+  // Returns the number of idle stores.
+  int num_idle_stores() const;
+
+ private:
+  // A store kept in the pool and the time it was returned.
+  struct IdleStore {
+    std::unique_ptr<MetadataStore> store;
+    absl::Time idle_since;
+  };
+
+  // Creates a store connecting to `connection_config_`, which checks the
+  // database schema until a store has been created successfully.
+  absl::Status CreateStore(std::unique_ptr<MetadataStore>* store);
+
+  // Reads the types and the first node of each kind with `store`.
+  static absl::Status WarmUpStore(MetadataStore* store);
+
+  // Puts a leased store back to the pool.
+  void Release(std::unique_ptr<MetadataStore> store);
+
+  // Moves the idle stores exceeding `min_size` that expired according to
+  // `idle_timeout_sec` to `expired_stores`, so that the connections can be
+  // closed without holding `mu_`.
+  void TakeExpiredIdleStores(
+      absl::Time now,
+      std::vector<std::unique_ptr<MetadataStore>>* expired_stores)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns true if Acquire() can proceed without waiting.
+  bool CanAcquire() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const ConnectionConfig connection_config_;
+  const ConnectionPoolConfig pool_config_;
+  // The lookup cache shared by the stores, or null if it is disabled.
+  std::shared_ptr<LookupCache> lookup_cache_;
+  // The lineage result cache shared by the stores, or null if it is disabled.
+  std::shared_ptr<LineageResultCache> lineage_result_cache_;
+  // The lineage graph index shared by the stores, or null if it is disabled.
+  std::shared_ptr<LineageGraphIndex> lineage_graph_index_;
+  // The property string dictionary shared by the stores, or null if the
+  // string property values are not interned.
+  std::shared_ptr<PropertyStringDictionary> property_string_dictionary_;
+  // Whether a store has checked the database schema.
+  std::atomic<bool> schema_verified_{false};
+
+  mutable absl::Mutex mu_;
+  // Idle stores ordered by the time they were returned, the oldest first.
+  std::deque<IdleStore> idle_stores_ ABSL_GUARDED_BY(mu_);
+  // The number of idle, leased and being created stores.
+  int num_open_stores_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_METADATA_STORE_POOL_H_
@@ -0,0 +1,279 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>  // NOLINT
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_source_metrics.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using testing::ParseTextProtoOrDie;
+
+ConnectionConfig GetFakeDatabaseConfig() {
+  ConnectionConfig connection_config;
+  connection_config.mutable_fake_database();
+  return connection_config;
+}
+
+TEST(MetadataStorePoolTest, AcquireReusesReturnedStore) {
+  MetadataStorePool pool(
+      GetFakeDatabaseConfig(),
+      ParseTextProtoOrDie<MetadataStorePool::ConnectionPoolConfig>(
+          "max_size: 2"));
+  MetadataStore* first_store = nullptr;
+  {
+    MetadataStorePool::ScopedStore store;
+    ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store));
+    ASSERT_NE(store.get(), nullptr);
+    first_store = store.get();
+    // The store holds its state across leases.
+    PutArtifactTypeRequest put_request;
+    put_request.set_all_fields_match(true);
+    put_request.mutable_artifact_type()->set_name("test_type");
+    PutArtifactTypeResponse put_response;
+    ASSERT_EQ(absl::OkStatus(),
+              store->PutArtifactType(put_request, &put_response));
+    EXPECT_EQ(pool.num_open_stores(), 1);
+    EXPECT_EQ(pool.num_idle_stores(), 0);
+  }
+  EXPECT_EQ(pool.num_idle_stores(), 1);
+
+  MetadataStorePool::ScopedStore store;
+  ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store));
+  EXPECT_EQ(store.get(), first_store);
+  EXPECT_EQ(pool.num_open_stores(), 1);
+  GetArtifactTypeRequest get_request;
+  get_request.set_type_name("test_type");
+  GetArtifactTypeResponse get_response;
+  EXPECT_EQ(absl::OkStatus(),
+            store->GetArtifactType(get_request, &get_response));
+}
+
+TEST(MetadataStorePoolTest, AcquireWaitsWhenMaxSizeIsReached) {
+  MetadataStorePool pool(
+      GetFakeDatabaseConfig(),
+      ParseTextProtoOrDie<MetadataStorePool::ConnectionPoolConfig>(
+          "max_size: 1"));
+  auto store = absl::make_unique<MetadataStorePool::ScopedStore>();
+  ASSERT_EQ(absl::OkStatus(), pool.Acquire(store.get()));
+
+  absl::Notification acquired;
+  std::thread waiting_thread([&pool, &acquired]() {
+    MetadataStorePool::ScopedStore other_store;
+    ASSERT_EQ(absl::OkStatus(), pool.Acquire(&other_store));
+    acquired.Notify();
+  });
+  EXPECT_FALSE(
+      acquired.WaitForNotificationWithTimeout(absl::Milliseconds(100)));
+  EXPECT_EQ(pool.num_open_stores(), 1);
+
+  store.reset();
+  acquired.WaitForNotification();
+  waiting_thread.join();
+  EXPECT_EQ(pool.num_open_stores(), 1);
+  EXPECT_EQ(pool.num_idle_stores(), 1);
+}
+
+TEST(MetadataStorePoolTest, PrefillOpensMinSizeStores) {
+  MetadataStorePool pool(
+      GetFakeDatabaseConfig(),
+      ParseTextProtoOrDie<MetadataStorePool::ConnectionPoolConfig>(
+          "min_size: 2 max_size: 3"));
+  ASSERT_EQ(absl::OkStatus(), pool.Prefill());
+  EXPECT_EQ(pool.num_open_stores(), 2);
+  EXPECT_EQ(pool.num_idle_stores(), 2);
+}
+
+TEST(MetadataStorePoolTest, IdleStoresExceedingMinSizeAreClosed) {
+  MetadataStorePool pool(
+      GetFakeDatabaseConfig(),
+      ParseTextProtoOrDie<MetadataStorePool::ConnectionPoolConfig>(
+          "min_size: 1 max_size: 3 idle_timeout_sec: 1"));
+  {
+    MetadataStorePool::ScopedStore store1, store2, store3;
+    ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store1));
+    ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store2));
+    ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store3));
+  }
+  EXPECT_EQ(pool.num_open_stores(), 3);
+  absl::SleepFor(absl::Milliseconds(1100));
+
+  MetadataStorePool::ScopedStore store;
+  ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store));
+  EXPECT_EQ(pool.num_open_stores(), 1);
+  EXPECT_EQ(pool.num_idle_stores(), 0);
+}
+
+TEST(MetadataStorePoolTest, OnlyFirstStoreChecksSchema) {
+  const std::string filename_uri =
+      absl::StrCat(::testing::TempDir(), "/metadata_store_pool_test.db");
+  std::remove(filename_uri.c_str());
+  ConnectionConfig connection_config;
+  connection_config.mutable_sqlite()->set_filename_uri(filename_uri);
+  MetadataSourceMetrics metrics;
+  SetDefaultMetadataSourceInstrumentation(&metrics);
+  MetadataStorePool pool(
+      connection_config,
+      ParseTextProtoOrDie<MetadataStorePool::ConnectionPoolConfig>(
+          "min_size: 3 max_size: 3"));
+  ASSERT_EQ(absl::OkStatus(), pool.Prefill());
+  SetDefaultMetadataSourceInstrumentation(nullptr);
+  EXPECT_EQ(pool.num_open_stores(), 3);
+  EXPECT_EQ(metrics.GetQueryMetrics("check_type_table")
+                .latency.bucket_counts.back(),
+            1);
+
+  MetadataStorePool::ScopedStore store1, store2, store3;
+  ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store1));
+  ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store2));
+  ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store3));
+  PutArtifactTypeRequest put_request;
+  put_request.set_all_fields_match(true);
+  put_request.mutable_artifact_type()->set_name("test_type");
+  PutArtifactTypeResponse put_response;
+  ASSERT_EQ(absl::OkStatus(),
+            store1->PutArtifactType(put_request, &put_response));
+  for (MetadataStore* store : {store2.get(), store3.get()}) {
+    GetArtifactTypeRequest get_request;
+    get_request.set_type_name("test_type");
+    GetArtifactTypeResponse get_response;
+    EXPECT_EQ(absl::OkStatus(),
+              store->GetArtifactType(get_request, &get_response));
+    EXPECT_EQ(get_response.artifact_type().id(), put_response.type_id());
+  }
+}
+
+TEST(MetadataStorePoolTest, WarmUpFillsTheTypeCaches) {
+  const std::string filename_uri = absl::StrCat(
+      ::testing::TempDir(), "/metadata_store_pool_warm_up_test.db");
+  std::remove(filename_uri.c_str());
+  ConnectionConfig connection_config;
+  connection_config.mutable_sqlite()->set_filename_uri(filename_uri);
+  MetadataSourceMetrics metrics;
+  SetDefaultMetadataSourceInstrumentation(&metrics);
+  MetadataStorePool pool(
+      connection_config,
+      ParseTextProtoOrDie<MetadataStorePool::ConnectionPoolConfig>(
+          "min_size: 2 max_size: 2"));
+  ASSERT_EQ(absl::OkStatus(), pool.Prefill());
+  {
+    MetadataStorePool::ScopedStore store;
+    ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store));
+    PutArtifactTypeRequest put_request;
+    put_request.set_all_fields_match(true);
+    put_request.mutable_artifact_type()->set_name("test_type");
+    PutArtifactTypeResponse put_response;
+    ASSERT_EQ(absl::OkStatus(),
+              store->PutArtifactType(put_request, &put_response));
+  }
+  ASSERT_EQ(absl::OkStatus(), pool.WarmUp());
+  EXPECT_EQ(pool.num_idle_stores(), 2);
+  const int64 num_type_queries =
+      metrics.GetQueryMetrics("select_type_by_name")
+          .latency.bucket_counts.back();
+
+  // Both stores find the type in their type caches.
+  MetadataStorePool::ScopedStore store1, store2;
+  ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store1));
+  ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store2));
+  for (MetadataStore* store : {store1.get(), store2.get()}) {
+    GetArtifactTypeRequest get_request;
+    get_request.set_type_name("test_type");
+    GetArtifactTypeResponse get_response;
+    EXPECT_EQ(absl::OkStatus(),
+              store->GetArtifactType(get_request, &get_response));
+  }
+  SetDefaultMetadataSourceInstrumentation(nullptr);
+  EXPECT_EQ(metrics.GetQueryMetrics("select_type_by_name")
+                .latency.bucket_counts.back(),
+            num_type_queries);
+}
+
+TEST(MetadataStorePoolTest, StoresShareInternedPropertyStrings) {
+  const std::string filename_uri = absl::StrCat(
+      ::testing::TempDir(), "/metadata_store_pool_interning_test.db");
+  std::remove(filename_uri.c_str());
+  ConnectionConfig connection_config;
+  connection_config.mutable_sqlite()->set_filename_uri(filename_uri);
+  MetadataSourceMetrics metrics;
+  SetDefaultMetadataSourceInstrumentation(&metrics);
+  MetadataStorePool pool(
+      connection_config,
+      ParseTextProtoOrDie<MetadataStorePool::ConnectionPoolConfig>(R"pb(
+        min_size: 2
+        max_size: 2
+        property_string_dictionary_config { max_entries: 10 }
+      )pb"));
+  ASSERT_EQ(absl::OkStatus(), pool.Prefill());
+  SetDefaultMetadataSourceInstrumentation(nullptr);
+
+  MetadataStorePool::ScopedStore store1, store2;
+  ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store1));
+  ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store2));
+  PutArtifactTypeRequest put_type_request;
+  put_type_request.set_all_fields_match(true);
+  put_type_request.mutable_artifact_type()->set_name("test_type");
+  PutArtifactTypeResponse put_type_response;
+  ASSERT_EQ(absl::OkStatus(),
+            store1->PutArtifactType(put_type_request, &put_type_response));
+
+  // The value is interned by the first write, and is found in the dictionary
+  // once the stores have seen it committed.
+  for (MetadataStore* store : {store1.get(), store2.get(), store1.get()}) {
+    PutArtifactsRequest put_request;
+    Artifact* artifact = put_request.add_artifacts();
+    artifact->set_type_id(put_type_response.type_id());
+    (*artifact->mutable_custom_properties())["pipeline"].set_string_value(
+        "my_pipeline");
+    PutArtifactsResponse put_response;
+    ASSERT_EQ(absl::OkStatus(),
+              store->PutArtifacts(put_request, &put_response));
+  }
+  EXPECT_EQ(metrics.GetQueryMetrics("insert_property_string_values")
+                .latency.bucket_counts.back(),
+            1);
+  EXPECT_EQ(metrics.GetQueryMetrics("select_property_string_value_ids")
+                .latency.bucket_counts.back(),
+            3);
+
+  GetArtifactsRequest get_request;
+  get_request.mutable_options()->set_filter_query(
+      "custom_properties.pipeline.string_value = 'my_pipeline'");
+  GetArtifactsResponse get_response;
+  ASSERT_EQ(absl::OkStatus(), store2->GetArtifacts(get_request, &get_response));
+  ASSERT_EQ(get_response.artifacts_size(), 3);
+  for (const Artifact& artifact : get_response.artifacts()) {
+    EXPECT_EQ(artifact.custom_properties().at("pipeline").string_value(),
+              "my_pipeline");
+  }
+}
+
+}  // namespace
+}  // namespace ml_metadata
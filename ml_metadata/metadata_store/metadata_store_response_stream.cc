@@ -0,0 +1,177 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_store_response_stream.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <glog/logging.h>
+#include "google/protobuf/repeated_field.h"
+#include "absl/status/status.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+
+namespace ml_metadata {
+namespace {
+
+// Moves the `records` to the chunks at the back of `chunks`, using
+// `mutable_chunk_records` to access the records of a chunk. A new chunk is
+// started whenever the last one has `max_chunk_size` records, counted in
+// `last_chunk_size`.
+template <typename T>
+void MoveToChunks(const int max_chunk_size,
+                  google::protobuf::RepeatedPtrField<T>* (
+                      LineageGraph::*mutable_chunk_records)(),
+                  google::protobuf::RepeatedPtrField<T>* records,
+                  int* last_chunk_size, std::deque<LineageGraph>* chunks) {
+  for (T& record : *records) {
+    if (*last_chunk_size == max_chunk_size) {
+      chunks->emplace_back();
+      *last_chunk_size = 0;
+    }
+    *(chunks->back().*mutable_chunk_records)()->Add() = std::move(record);
+    (*last_chunk_size)++;
+  }
+  records->Clear();
+}
+
+// Replaces the id-only artifacts and executions of `chunk` with the nodes read
+// from `metadata_store` by their ids.
+absl::Status ReadChunkNodes(MetadataStore* metadata_store,
+                            LineageGraph* chunk) {
+  if (chunk->artifacts_size() > 0) {
+    GetArtifactsByIDRequest request;
+    for (const Artifact& artifact : chunk->artifacts()) {
+      request.add_artifact_ids(artifact.id());
+    }
+    GetArtifactsByIDResponse response;
+    const absl::Status status =
+        metadata_store->GetArtifactsByID(request, &response);
+    if (!status.ok()) {
+      return status;
+    }
+    chunk->mutable_artifacts()->Swap(response.mutable_artifacts());
+  }
+  if (chunk->executions_size() > 0) {
+    GetExecutionsByIDRequest request;
+    for (const Execution& execution : chunk->executions()) {
+      request.add_execution_ids(execution.id());
+    }
+    GetExecutionsByIDResponse response;
+    const absl::Status status =
+        metadata_store->GetExecutionsByID(request, &response);
+    if (!status.ok()) {
+      return status;
+    }
+    chunk->mutable_executions()->Swap(response.mutable_executions());
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status LineageGraphResponseStream::Next(
+    MetadataStorePool* metadata_store_pool, GetLineageGraphResponse* response,
+    bool* done) {
+  if (!fetched_) {
+    MetadataStorePool::ScopedStore metadata_store;
+    absl::Status status = metadata_store_pool->Acquire(&metadata_store);
+    if (!status.ok()) {
+      return status;
+    }
+    GetLineageGraphResponse graph_response;
+    status = metadata_store->GetLineageGraphIds(request_, &graph_response);
+    if (!status.ok()) {
+      return status;
+    }
+    fetched_ = true;
+    SplitLineageGraph(kDefaultMaxListOperationResultSize,
+                      graph_response.mutable_subgraph(), &chunks_);
+  }
+  CHECK(!chunks_.empty()) << "The stream is already done.";
+  if (chunks_.front().artifacts_size() > 0 ||
+      chunks_.front().executions_size() > 0) {
+    MetadataStorePool::ScopedStore metadata_store;
+    absl::Status status = metadata_store_pool->Acquire(&metadata_store);
+    if (!status.ok()) {
+      return status;
+    }
+    status = ReadChunkNodes(metadata_store.get(), &chunks_.front());
+    if (!status.ok()) {
+      return status;
+    }
+  }
+  response->Clear();
+  response->mutable_subgraph()->Swap(&chunks_.front());
+  chunks_.pop_front();
+  *done = chunks_.empty();
+  return absl::OkStatus();
+}
+
+ChangeLogResponseStream::ChangeLogResponseStream(
+    const GetChangesRequest& request)
+    : page_request_(request) {
+  if (page_request_.max_result_size() == 0) {
+    page_request_.set_max_result_size(kDefaultMaxListOperationResultSize);
+  }
+}
+
+absl::Status ChangeLogResponseStream::Next(
+    MetadataStorePool* metadata_store_pool, GetChangesResponse* response,
+    bool* done) {
+  MetadataStorePool::ScopedStore metadata_store;
+  absl::Status status = metadata_store_pool->Acquire(&metadata_store);
+  if (!status.ok()) {
+    return status;
+  }
+  status = metadata_store->GetChanges(page_request_, response);
+  if (!status.ok()) {
+    return status;
+  }
+  // The page size is capped by GetChanges, so a full page may be smaller than
+  // the requested one.
+  *done = response->entries_size() <
+          std::min(page_request_.max_result_size(), kMaxChangeLogResultSize);
+  page_request_.set_after_sequence_number(response->last_sequence_number());
+  return absl::OkStatus();
+}
+
+void SplitLineageGraph(const int max_chunk_size, LineageGraph* subgraph,
+                       std::deque<LineageGraph>* chunks) {
+  CHECK_GT(max_chunk_size, 0) << "The max chunk size must be positive.";
+  chunks->clear();
+  chunks->emplace_back();
+  LineageGraph& first_chunk = chunks->front();
+  first_chunk.mutable_artifact_types()->Swap(
+      subgraph->mutable_artifact_types());
+  first_chunk.mutable_execution_types()->Swap(
+      subgraph->mutable_execution_types());
+  first_chunk.mutable_context_types()->Swap(subgraph->mutable_context_types());
+  int last_chunk_size = 0;
+  MoveToChunks(max_chunk_size, &LineageGraph::mutable_artifacts,
+               subgraph->mutable_artifacts(), &last_chunk_size, chunks);
+  MoveToChunks(max_chunk_size, &LineageGraph::mutable_executions,
+               subgraph->mutable_executions(), &last_chunk_size, chunks);
+  MoveToChunks(max_chunk_size, &LineageGraph::mutable_contexts,
+               subgraph->mutable_contexts(), &last_chunk_size, chunks);
+  MoveToChunks(max_chunk_size, &LineageGraph::mutable_events,
+               subgraph->mutable_events(), &last_chunk_size, chunks);
+  MoveToChunks(max_chunk_size, &LineageGraph::mutable_attributions,
+               subgraph->mutable_attributions(), &last_chunk_size, chunks);
+  MoveToChunks(max_chunk_size, &LineageGraph::mutable_associations,
+               subgraph->mutable_associations(), &last_chunk_size, chunks);
+}
+
+}  // namespace ml_metadata
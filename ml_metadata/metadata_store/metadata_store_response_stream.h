@@ -0,0 +1,142 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_RESPONSE_STREAM_H_
+#define ML_METADATA_METADATA_STORE_METADATA_STORE_RESPONSE_STREAM_H_
+
+#include <deque>
+
+#include "absl/status/status.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+
+// The responses of a server-streaming call, which are fetched one chunk at a
+// time with MetadataStores leased from a MetadataStorePool. A store is leased
+// only while a chunk is fetched, so that slow readers of the stream do not
+// hold connections. It is thread-compatible.
+//
+// Usage example:
+//
+//    bool done = false;
+//    while (!done) {
+//      GetArtifactsResponse response;
+//      MLMD_RETURN_IF_ERROR(stream.Next(&pool, &response, &done));
+//      // sends the response.
+//    }
+template <typename Response>
+class ResponseStream {
+ public:
+  virtual ~ResponseStream() = default;
+
+  // Fetches the next chunk of the responses to `response`, and sets `done` to
+  // true if it is the last chunk.
+  // Returns detailed errors of the MetadataStore call.
+  virtual absl::Status Next(MetadataStorePool* metadata_store_pool,
+                            Response* response, bool* done) = 0;
+};
+
+// Streams the pages of a list call, e.g., GetArtifacts. Each page is read in
+// its own transaction, and its next_page_token can be used to resume the
+// stream with a unary call. If the request has no options, the pages are
+// ordered by the default order and have kDefaultMaxListOperationResultSize
+// nodes.
+template <typename Request, typename Response>
+class PagedResponseStream final : public ResponseStream<Response> {
+ public:
+  using StoreMethod = absl::Status (MetadataStore::*)(const Request&,
+                                                      Response*);
+
+  PagedResponseStream(const Request& request, StoreMethod store_method)
+      : page_request_(request), store_method_(store_method) {
+    if (!page_request_.has_options()) {
+      page_request_.mutable_options()->set_max_result_size(
+          kDefaultMaxListOperationResultSize);
+    }
+  }
+
+  absl::Status Next(MetadataStorePool* metadata_store_pool, Response* response,
+                    bool* done) override {
+    MetadataStorePool::ScopedStore metadata_store;
+    absl::Status status = metadata_store_pool->Acquire(&metadata_store);
+    if (!status.ok()) {
+      return status;
+    }
+    status = (metadata_store.get()->*store_method_)(page_request_, response);
+    if (!status.ok()) {
+      return status;
+    }
+    *done = response->next_page_token().empty();
+    page_request_.mutable_options()->set_next_page_token(
+        response->next_page_token());
+    return absl::OkStatus();
+  }
+
+ private:
+  Request page_request_;
+  const StoreMethod store_method_;
+};
+
+// Streams the subgraph of GetLineageGraph in chunks of at most
+// kDefaultMaxListOperationResultSize nodes and edges. The subgraph is traversed
+// by GetLineageGraphIds in one transaction when the first chunk is fetched, so
+// that only the node ids, the events and the types are held by the stream.
+// The nodes of each chunk are read by their ids when the chunk is fetched, in
+// its own transaction; the nodes deleted meanwhile are missing from the chunk.
+// The types are sent in the first chunk.
+class LineageGraphResponseStream final
+    : public ResponseStream<GetLineageGraphResponse> {
+ public:
+  explicit LineageGraphResponseStream(const GetLineageGraphRequest& request)
+      : request_(request) {}
+
+  absl::Status Next(MetadataStorePool* metadata_store_pool,
+                    GetLineageGraphResponse* response, bool* done) override;
+
+ private:
+  const GetLineageGraphRequest request_;
+  bool fetched_ = false;
+  std::deque<LineageGraph> chunks_;
+};
+
+// Streams the change log of GetChanges from the after_sequence_number of the
+// request, one page of max_result_size entries per response, until a page is
+// not full, i.e., the end of the log is reached. Each page is read in its own
+// transaction, and its last_sequence_number is the resume token of the next
+// page.
+class ChangeLogResponseStream final
+    : public ResponseStream<GetChangesResponse> {
+ public:
+  explicit ChangeLogResponseStream(const GetChangesRequest& request);
+
+  absl::Status Next(MetadataStorePool* metadata_store_pool,
+                    GetChangesResponse* response, bool* done) override;
+
+ private:
+  GetChangesRequest page_request_;
+};
+
+// Moves the nodes and edges of `subgraph` to `chunks` of at most
+// `max_chunk_size` nodes and edges, and the types to the first chunk. An empty
+// subgraph results in a single empty chunk.
+void SplitLineageGraph(int max_chunk_size, LineageGraph* subgraph,
+                       std::deque<LineageGraph>* chunks);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_METADATA_STORE_RESPONSE_STREAM_H_
@@ -0,0 +1,179 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/metadata_store_response_stream.h"
+
+#include <deque>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::EqualsProto;
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::ElementsAre;
+using ::testing::SizeIs;
+
+ConnectionConfig GetFakeDatabaseConfig() {
+  ConnectionConfig connection_config;
+  connection_config.mutable_fake_database();
+  return connection_config;
+}
+
+TEST(PagedResponseStreamTest, StreamsAllPages) {
+  MetadataStorePool pool(
+      GetFakeDatabaseConfig(),
+      ParseTextProtoOrDie<MetadataStorePool::ConnectionPoolConfig>(
+          "max_size: 1"));
+  {
+    MetadataStorePool::ScopedStore store;
+    ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store));
+    PutArtifactTypeRequest put_type_request;
+    put_type_request.mutable_artifact_type()->set_name("test_type");
+    PutArtifactTypeResponse put_type_response;
+    ASSERT_EQ(absl::OkStatus(),
+              store->PutArtifactType(put_type_request, &put_type_response));
+    PutArtifactsRequest put_request;
+    for (int i = 0; i < 5; i++) {
+      put_request.add_artifacts()->set_type_id(put_type_response.type_id());
+    }
+    PutArtifactsResponse put_response;
+    ASSERT_EQ(absl::OkStatus(),
+              store->PutArtifacts(put_request, &put_response));
+  }
+
+  GetArtifactsRequest request = ParseTextProtoOrDie<GetArtifactsRequest>(R"pb(
+    options {
+      max_result_size: 2
+      order_by_field: { field: ID is_asc: true }
+    }
+  )pb");
+  PagedResponseStream<GetArtifactsRequest, GetArtifactsResponse> stream(
+      request, &MetadataStore::GetArtifacts);
+  std::vector<int> page_sizes;
+  std::vector<int64> ids;
+  bool done = false;
+  while (!done) {
+    GetArtifactsResponse response;
+    ASSERT_EQ(absl::OkStatus(), stream.Next(&pool, &response, &done));
+    page_sizes.push_back(response.artifacts_size());
+    for (const Artifact& artifact : response.artifacts()) {
+      ids.push_back(artifact.id());
+    }
+  }
+  EXPECT_THAT(page_sizes, ElementsAre(2, 2, 1));
+  EXPECT_THAT(ids, ElementsAre(1, 2, 3, 4, 5));
+  // The stores are only leased while the pages are fetched.
+  EXPECT_EQ(pool.num_idle_stores(), 1);
+}
+
+TEST(LineageGraphResponseStreamTest, ReadsNodesOfEachChunk) {
+  MetadataStorePool pool(
+      GetFakeDatabaseConfig(),
+      ParseTextProtoOrDie<MetadataStorePool::ConnectionPoolConfig>(
+          "max_size: 1"));
+  PutExecutionResponse put_response;
+  {
+    MetadataStorePool::ScopedStore store;
+    ASSERT_EQ(absl::OkStatus(), pool.Acquire(&store));
+    PutTypesResponse put_types_response;
+    ASSERT_EQ(absl::OkStatus(),
+              store->PutTypes(ParseTextProtoOrDie<PutTypesRequest>(R"pb(
+                                artifact_types: { name: 'dataset' }
+                                execution_types: { name: 'trainer' }
+                              )pb"),
+                              &put_types_response));
+    PutExecutionRequest put_request;
+    put_request.mutable_execution()->set_type_id(
+        put_types_response.execution_type_ids(0));
+    for (const Event::Type type : {Event::INPUT, Event::OUTPUT}) {
+      PutExecutionRequest::ArtifactAndEvent* artifact_and_event =
+          put_request.add_artifact_event_pairs();
+      artifact_and_event->mutable_artifact()->set_type_id(
+          put_types_response.artifact_type_ids(0));
+      artifact_and_event->mutable_artifact()->set_uri("uri");
+      artifact_and_event->mutable_event()->set_type(type);
+    }
+    ASSERT_EQ(absl::OkStatus(), store->PutExecution(put_request, &put_response));
+  }
+
+  GetLineageGraphRequest request;
+  request.mutable_options()->mutable_artifacts_options()->set_filter_query(
+      absl::StrCat("id = ", put_response.artifact_ids(0)));
+  request.mutable_options()->mutable_stop_conditions()->set_max_num_hops(2);
+  LineageGraphResponseStream stream(request);
+  GetLineageGraphResponse response;
+  bool done = false;
+  ASSERT_EQ(absl::OkStatus(), stream.Next(&pool, &response, &done));
+  EXPECT_TRUE(done);
+  ASSERT_THAT(response.subgraph().artifacts(), SizeIs(2));
+  for (const Artifact& artifact : response.subgraph().artifacts()) {
+    EXPECT_EQ(artifact.uri(), "uri");
+  }
+  ASSERT_THAT(response.subgraph().executions(), SizeIs(1));
+  EXPECT_TRUE(response.subgraph().executions(0).has_type_id());
+  EXPECT_THAT(response.subgraph().events(), SizeIs(2));
+  EXPECT_THAT(response.subgraph().artifact_types(), SizeIs(1));
+  EXPECT_EQ(pool.num_idle_stores(), 1);
+}
+
+TEST(SplitLineageGraphTest, SplitsNodesAndEdges) {
+  LineageGraph subgraph = ParseTextProtoOrDie<LineageGraph>(R"pb(
+    artifact_types { id: 1 }
+    execution_types { id: 2 }
+    artifacts { id: 1 }
+    artifacts { id: 2 }
+    executions { id: 1 }
+    events { artifact_id: 1 execution_id: 1 }
+    events { artifact_id: 2 execution_id: 1 }
+  )pb");
+  std::deque<LineageGraph> chunks;
+  SplitLineageGraph(/*max_chunk_size=*/2, &subgraph, &chunks);
+  ASSERT_THAT(chunks, SizeIs(3));
+  EXPECT_THAT(chunks[0], EqualsProto(ParseTextProtoOrDie<LineageGraph>(R"pb(
+                artifact_types { id: 1 }
+                execution_types { id: 2 }
+                artifacts { id: 1 }
+                artifacts { id: 2 }
+              )pb")));
+  EXPECT_THAT(chunks[1], EqualsProto(ParseTextProtoOrDie<LineageGraph>(R"pb(
+                executions { id: 1 }
+                events { artifact_id: 1 execution_id: 1 }
+              )pb")));
+  EXPECT_THAT(chunks[2], EqualsProto(ParseTextProtoOrDie<LineageGraph>(R"pb(
+                events { artifact_id: 2 execution_id: 1 }
+              )pb")));
+}
+
+TEST(SplitLineageGraphTest, EmptyGraphIsOneChunk) {
+  LineageGraph subgraph;
+  std::deque<LineageGraph> chunks;
+  SplitLineageGraph(/*max_chunk_size=*/2, &subgraph, &chunks);
+  ASSERT_THAT(chunks, SizeIs(1));
+  EXPECT_THAT(chunks[0], EqualsProto(LineageGraph()));
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -17,8 +17,10 @@ limitations under the License.
 // defined in third_party/ml_metadata/proto/metadata_store_service.proto.
 
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "gflags/gflags.h"
@@ -26,16 +28,29 @@ limitations under the License.
 #include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/text_format.h"
 
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "grpcpp/health_check_service_interface.h"
 #include "grpcpp/security/server_credentials.h"
 #include "grpcpp/server.h"
 #include "grpcpp/server_builder.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_async_service.h"
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
 #include "ml_metadata/metadata_store/metadata_store_service_impl.h"
+#include "ml_metadata/metadata_store/metadata_source_instrumentation.h"
+#include "ml_metadata/metadata_store/metadata_source_metrics.h"
+#include "ml_metadata/metadata_store/request_capture.h"
+#include "ml_metadata/metadata_store/request_replay_caller.h"
+#include "ml_metadata/metadata_store/slow_query_log.h"
+#include "ml_metadata/metadata_store/trace_span.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 
 namespace {
@@ -146,6 +161,257 @@ bool ParseMySQLFlagsBasedServerConfigOrDie(
 
   return true;
 }
+
+// Sets the connection pool config of service_config from the passed flags,
+// unless it is given in the config file.
+void ParseConnectionPoolFlagsBasedServerConfig(
+    const int min_size, const int max_size, const int64 idle_timeout_sec,
+    const int64 health_check_interval_sec,
+    ml_metadata::MetadataStoreServerConfig* server_config) {
+  if (server_config->has_connection_pool_config()) {
+    return;
+  }
+  ml_metadata::MetadataStoreServerConfig::ConnectionPoolConfig* pool_config =
+      server_config->mutable_connection_pool_config();
+  pool_config->set_min_size(min_size);
+  pool_config->set_max_size(max_size);
+  pool_config->set_idle_timeout_sec(idle_timeout_sec);
+  pool_config->set_health_check_interval_sec(health_check_interval_sec);
+}
+
+// Sets the async server config of service_config from the passed flags if
+// enable_async_server is true, unless it is given in the config file.
+void ParseAsyncServerFlagsBasedServerConfig(
+    const bool enable_async_server, const int num_completion_queue_threads,
+    const int num_type_read_workers, const int num_read_workers,
+    const int num_write_workers, const int max_queued_calls,
+    ml_metadata::MetadataStoreServerConfig* server_config) {
+  if (!enable_async_server || server_config->has_async_server_config()) {
+    return;
+  }
+  ml_metadata::MetadataStoreServerConfig::AsyncServerConfig* async_config =
+      server_config->mutable_async_server_config();
+  async_config->set_num_completion_queue_threads(num_completion_queue_threads);
+  async_config->set_num_type_read_workers(num_type_read_workers);
+  async_config->set_num_read_workers(num_read_workers);
+  async_config->set_num_write_workers(num_write_workers);
+  async_config->set_max_queued_calls(max_queued_calls);
+}
+
+// Sets the group commit config of service_config from the passed flags if
+// max_delay_us is positive, unless it is given in the config file.
+void ParseGroupCommitFlagsBasedServerConfig(
+    const int64 max_delay_us, const int max_batch_size,
+    ml_metadata::MetadataStoreServerConfig* server_config) {
+  if (max_delay_us <= 0 || server_config->has_group_commit_config()) {
+    return;
+  }
+  ml_metadata::MetadataStoreServerConfig::GroupCommitConfig*
+      group_commit_config = server_config->mutable_group_commit_config();
+  group_commit_config->set_max_delay_us(max_delay_us);
+  group_commit_config->set_max_batch_size(max_batch_size);
+}
+
+// Sets the parallel read config of service_config from the passed flags if
+// num_workers is positive, unless it is given in the config file.
+void ParseParallelReadFlagsBasedServerConfig(
+    const int num_workers, const int chunk_size,
+    ml_metadata::MetadataStoreServerConfig* server_config) {
+  if (num_workers <= 0 || server_config->has_parallel_read_config()) {
+    return;
+  }
+  ml_metadata::MetadataStoreServerConfig::ParallelReadConfig*
+      parallel_read_config = server_config->mutable_parallel_read_config();
+  parallel_read_config->set_num_workers(num_workers);
+  parallel_read_config->set_chunk_size(chunk_size);
+}
+
+// Sets the admission control config of service_config from the passed flags if
+// max_cost is positive, unless it is given in the config file.
+void ParseAdmissionControlFlagsBasedServerConfig(
+    const int64 max_cost, const int64 max_cost_per_client,
+    const int64 heavy_method_cost,
+    ml_metadata::MetadataStoreServerConfig* server_config) {
+  if (max_cost <= 0 || server_config->has_admission_control_config()) {
+    return;
+  }
+  ml_metadata::MetadataStoreServerConfig::AdmissionControlConfig*
+      admission_control_config =
+          server_config->mutable_admission_control_config();
+  admission_control_config->set_max_cost(max_cost);
+  admission_control_config->set_max_cost_per_client(max_cost_per_client);
+  admission_control_config->set_heavy_method_cost(heavy_method_cost);
+}
+
+// Sets the slow query log config of service_config from the passed flags if
+// threshold_ms is positive, unless it is given in the config file.
+void ParseSlowQueryLogFlagsBasedServerConfig(
+    const int64 threshold_ms, const double explain_sample_rate,
+    ml_metadata::MetadataStoreServerConfig* server_config) {
+  if (threshold_ms <= 0 || server_config->has_slow_query_log_config()) {
+    return;
+  }
+  ml_metadata::MetadataStoreServerConfig::SlowQueryLogConfig*
+      slow_query_log_config = server_config->mutable_slow_query_log_config();
+  slow_query_log_config->set_threshold_ms(threshold_ms);
+  slow_query_log_config->set_explain_sample_rate(explain_sample_rate);
+}
+
+// Sets the request capture config of service_config from the passed flags if
+// filename is non-empty, unless it is given in the config file.
+void ParseRequestCaptureFlagsBasedServerConfig(
+    const std::string& filename, const double sample_rate,
+    ml_metadata::MetadataStoreServerConfig* server_config) {
+  if (filename.empty() || server_config->has_request_capture_config()) {
+    return;
+  }
+  ml_metadata::MetadataStoreServerConfig::RequestCaptureConfig*
+      request_capture_config = server_config->mutable_request_capture_config();
+  request_capture_config->set_filename(filename);
+  request_capture_config->set_sample_rate(sample_rate);
+}
+
+// Sets the call memory budget config of service_config from the passed flags if
+// either limit is positive, unless it is given in the config file.
+void ParseCallMemoryBudgetFlagsBasedServerConfig(
+    const int64 soft_limit_bytes, const int64 hard_limit_bytes,
+    ml_metadata::MetadataStoreServerConfig* server_config) {
+  if ((soft_limit_bytes <= 0 && hard_limit_bytes <= 0) ||
+      server_config->has_call_memory_budget_config()) {
+    return;
+  }
+  ml_metadata::MetadataStoreServerConfig::CallMemoryBudgetConfig*
+      call_memory_budget_config =
+          server_config->mutable_call_memory_budget_config();
+  call_memory_budget_config->set_soft_limit_bytes(soft_limit_bytes);
+  call_memory_budget_config->set_hard_limit_bytes(hard_limit_bytes);
+}
+
+// Sets the tracing config of service_config from the passed flags if filename
+// is non-empty, unless it is given in the config file.
+void ParseTracingFlagsBasedServerConfig(
+    const std::string& filename, const double sample_rate,
+    ml_metadata::MetadataStoreServerConfig* server_config) {
+  if (filename.empty() || server_config->has_tracing_config()) {
+    return;
+  }
+  ml_metadata::MetadataStoreServerConfig::TracingConfig* tracing_config =
+      server_config->mutable_tracing_config();
+  tracing_config->set_filename(filename);
+  tracing_config->set_sample_rate(sample_rate);
+}
+
+// Sets the warm-up config of service_config from the passed flags if
+// enable_warm_up is true or capture_file is non-empty, unless it is given in
+// the config file.
+void ParseWarmUpFlagsBasedServerConfig(
+    const bool enable_warm_up, const std::string& capture_file,
+    const int64 max_replayed_requests,
+    ml_metadata::MetadataStoreServerConfig* server_config) {
+  if ((!enable_warm_up && capture_file.empty()) ||
+      server_config->has_warm_up_config()) {
+    return;
+  }
+  ml_metadata::MetadataStoreServerConfig::WarmUpConfig* warm_up_config =
+      server_config->mutable_warm_up_config();
+  warm_up_config->set_capture_file(capture_file);
+  warm_up_config->set_max_replayed_requests(max_replayed_requests);
+}
+
+// Replays the read calls of the capture file of `config` through the
+// in-process channel of `server`, as fast as its workers allow.
+absl::Status ReplayWarmUpRequests(
+    const ml_metadata::MetadataStoreServerConfig::WarmUpConfig& config,
+    ::grpc::Server* server) {
+  std::ifstream input(config.capture_file(), std::ios::binary);
+  if (!input) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Cannot open the warm-up capture file ", config.capture_file()));
+  }
+  std::vector<ml_metadata::CapturedRequest> captured_requests;
+  absl::Status status =
+      ml_metadata::ReadCapturedRequests(&input, &captured_requests);
+  if (!status.ok()) {
+    return status;
+  }
+  // The writes are not replayed, as the warm-up must not change the store.
+  std::vector<ml_metadata::CapturedRequest> requests;
+  for (ml_metadata::CapturedRequest& request : captured_requests) {
+    if (requests.size() >=
+        static_cast<size_t>(config.max_replayed_requests())) {
+      break;
+    }
+    if (absl::StartsWith(request.method(), "Get")) {
+      requests.push_back(std::move(request));
+    }
+  }
+  ml_metadata::RequestReplayConfig replay_config;
+  replay_config.set_speedup(0);
+  replay_config.set_num_workers(config.num_workers());
+  ml_metadata::GenericReplayCaller caller(
+      server->InProcessChannel(::grpc::ChannelArguments()),
+      absl::Seconds(60));
+  ml_metadata::RequestReplayReport report;
+  status = ml_metadata::ReplayCapturedRequests(
+      requests, replay_config,
+      [&caller](const ml_metadata::CapturedRequest& request) {
+        return caller.Call(request);
+      },
+      &report);
+  if (!status.ok()) {
+    return status;
+  }
+  int64 num_errors = 0;
+  for (const ml_metadata::RequestReplayReport::MethodReport& method_report :
+       report.method_reports()) {
+    for (const auto& code_and_count : method_report.num_errors_by_code()) {
+      num_errors += code_and_count.second;
+    }
+  }
+  LOG(INFO) << "Replayed " << requests.size() << " warm-up requests in "
+            << report.duration_us() << "us, " << num_errors << " failed.";
+  return absl::OkStatus();
+}
+
+// Warms up `server` with `config`, and then reports it SERVING to the health
+// checks: `warm_up_pool` warms up the connections of the pool of its service,
+// and the read calls of the capture file, if any, are replayed. A failed
+// step is logged, and does not keep the server from serving.
+void WarmUpServer(
+    const ml_metadata::MetadataStoreServerConfig::WarmUpConfig& config,
+    const std::function<absl::Status()>& warm_up_pool,
+    ::grpc::Server* server) {
+  const absl::Time start = absl::Now();
+  const absl::Status status = warm_up_pool();
+  LOG_IF(WARNING, !status.ok())
+      << "The connection pool failed to warm up: " << status;
+  if (!config.capture_file().empty()) {
+    const absl::Status replay_status = ReplayWarmUpRequests(config, server);
+    LOG_IF(WARNING, !replay_status.ok())
+        << "The warm-up requests failed to replay: " << replay_status;
+  }
+  LOG(INFO) << "Warmed up in " << absl::Now() - start;
+  server->GetHealthCheckService()->SetServingStatus(true);
+}
+
+// Instruments the metadata sources created afterwards, and writes their
+// metrics to `filename` every `interval_sec` seconds in a background thread.
+void StartMetadataSourceMetricsExport(const std::string& filename,
+                                      const int64 interval_sec) {
+  CHECK_GT(interval_sec, 0)
+      << "--metadata_source_metrics_interval_sec must be positive.";
+  // The metrics outlast the metadata sources, as they are never freed.
+  auto* metrics = new ml_metadata::MetadataSourceMetrics();
+  ml_metadata::SetDefaultMetadataSourceInstrumentation(metrics);
+  std::thread([metrics, filename, interval_sec]() {
+    while (true) {
+      absl::SleepFor(absl::Seconds(interval_sec));
+      const absl::Status status = metrics->WritePrometheusTextFile(filename);
+      LOG_IF(WARNING, !status.ok())
+          << "Failed to export the metadata source metrics: " << status;
+    }
+  }).detach();
+}
 }  // namespace
 
 // gRPC server options
@@ -163,6 +429,171 @@ DEFINE_string(metadata_store_server_config_file, "",
 DEFINE_int32(
     metadata_store_connection_retries, 5,
     "The max number of retries when connecting to the given metadata source");
+DEFINE_int32(metadata_store_connection_pool_min_size, 0,
+             "The number of connections to the metadata source that are kept "
+             "open even when idle. Ignored if connection_pool_config is set in "
+             "--metadata_store_server_config_file");
+DEFINE_int32(metadata_store_connection_pool_max_size, 16,
+             "The max number of connections to the metadata source opened at "
+             "the same time. Ignored if connection_pool_config is set in "
+             "--metadata_store_server_config_file");
+DEFINE_int64(metadata_store_connection_pool_idle_timeout_sec, 300,
+             "Idle connections exceeding the min size are closed after the "
+             "given seconds; <= 0 disables the timeout. Ignored if "
+             "connection_pool_config is set in "
+             "--metadata_store_server_config_file");
+DEFINE_int64(metadata_store_connection_pool_health_check_interval_sec, 30,
+             "Connections idle for longer than the given seconds are pinged "
+             "before reuse; < 0 disables the check. Ignored if "
+             "connection_pool_config is set in "
+             "--metadata_store_server_config_file");
+DEFINE_int64(metadata_store_transaction_max_retries, 0,
+             "The max number of times a transaction returning Aborted error, "
+             "e.g., on a deadlock, is retried by the server before replying. "
+             "Ignored if connection_config.transaction_retry_options is set "
+             "in --metadata_store_server_config_file");
+
+// async server options
+DEFINE_bool(enable_async_server, false,
+            "If true, serves the calls with gRPC completion queues and bounded "
+            "pools of workers for type reads, reads and writes, instead of "
+            "blocking a gRPC thread per call. Implied if async_server_config "
+            "is set in --metadata_store_server_config_file");
+DEFINE_int32(async_server_completion_queue_threads, 2,
+             "The number of threads polling the gRPC completion queues. "
+             "Ignored unless --enable_async_server is set");
+DEFINE_int32(async_server_type_read_workers, 2,
+             "The number of workers serving the type reads. Ignored unless "
+             "--enable_async_server is set");
+DEFINE_int32(async_server_read_workers, 8,
+             "The number of workers serving the node, event and lineage "
+             "reads. Ignored unless --enable_async_server is set");
+DEFINE_int32(async_server_write_workers, 4,
+             "The number of workers serving the writes. Ignored unless "
+             "--enable_async_server is set");
+DEFINE_int32(async_server_max_queued_calls, 1000,
+             "The max number of calls of each class waiting for a worker. "
+             "Ignored unless --enable_async_server is set");
+
+// group commit options
+DEFINE_int64(metadata_store_group_commit_max_delay_us, 0,
+             "If positive, the concurrent PutEvents, PutExecution and "
+             "PutAttributionsAndAssociations calls are committed in groups, "
+             "each in a single transaction, and the first call of a group "
+             "waits up to the given microseconds for the others to join it. "
+             "Ignored if group_commit_config is set in "
+             "--metadata_store_server_config_file, or by the async server");
+DEFINE_int32(metadata_store_group_commit_max_batch_size, 32,
+             "The max number of calls committed in a group. Ignored unless "
+             "--metadata_store_group_commit_max_delay_us is positive");
+
+// parallel read options
+DEFINE_int32(metadata_store_parallel_read_workers, 0,
+             "If positive, GetLineageGraph and the large "
+             "Get{Artifacts,Executions,Contexts}ByID calls read their nodes in "
+             "chunks in parallel with the given number of threads. Ignored if "
+             "parallel_read_config is set in "
+             "--metadata_store_server_config_file, or by the async server");
+DEFINE_int32(metadata_store_parallel_read_chunk_size, 100,
+             "The max number of nodes read by a chunk. Ignored unless "
+             "--metadata_store_parallel_read_workers is positive");
+
+// admission control options
+DEFINE_int64(metadata_store_admission_max_cost, 0,
+             "If positive, the calls are rejected with RESOURCE_EXHAUSTED "
+             "instead of waiting for a connection once the total cost of the "
+             "calls in flight would exceed the given value. Ignored if "
+             "admission_control_config is set in "
+             "--metadata_store_server_config_file, or by the async server");
+DEFINE_int64(metadata_store_admission_max_cost_per_client, 32,
+             "The max total cost of the calls in flight of a client, "
+             "identified by its mlmd-client-id metadata or its address. 0 "
+             "means unlimited. Ignored unless "
+             "--metadata_store_admission_max_cost is positive");
+DEFINE_int64(metadata_store_admission_heavy_method_cost, 8,
+             "The cost of the calls listing or traversing the nodes, e.g., "
+             "GetArtifacts or GetLineageGraph, while the other calls cost 1. "
+             "Ignored unless --metadata_store_admission_max_cost is positive");
+
+// request coalescing options
+DEFINE_bool(metadata_store_enable_request_coalescing, false,
+            "If true, the identical concurrent point reads, e.g., "
+            "GetContextByTypeAndName or GetArtifactsByContext, share a single "
+            "read of the store. Ignored if enable_request_coalescing is set in "
+            "--metadata_store_server_config_file, or by the async server");
+
+// slow query log options
+DEFINE_int64(metadata_store_slow_query_threshold_ms, 0,
+             "If positive, the queries taking at least the given milliseconds "
+             "are logged as warnings, with their SQL and the RPC and filter "
+             "issuing them. Ignored if slow_query_log_config is set in "
+             "--metadata_store_server_config_file");
+DEFINE_double(metadata_store_slow_query_explain_sample_rate, 0,
+              "The fraction in [0, 1] of the slow read queries whose plan is "
+              "captured with EXPLAIN and logged. Ignored unless "
+              "--metadata_store_slow_query_threshold_ms is positive");
+
+// request capture options
+DEFINE_string(metadata_store_request_capture_file, "",
+              "If non-empty, a sample of the requests of the calls is written "
+              "to the file, to be replayed against another server by the "
+              "request_replay_tool. Ignored if request_capture_config is set "
+              "in --metadata_store_server_config_file, or by the async server");
+DEFINE_double(metadata_store_request_capture_sample_rate, 1,
+              "The fraction in (0, 1] of the calls whose requests are written "
+              "to --metadata_store_request_capture_file");
+
+// call memory budget options
+DEFINE_int64(metadata_store_call_memory_soft_limit_bytes, 0,
+             "If positive, the pages of GetArtifacts, GetExecutions and "
+             "GetContexts with options are truncated to the given serialized "
+             "size, with a next_page_token to continue from. Ignored if "
+             "call_memory_budget_config is set in "
+             "--metadata_store_server_config_file, or by the async server");
+DEFINE_int64(metadata_store_call_memory_hard_limit_bytes, 0,
+             "If positive, a call fails with RESOURCE_EXHAUSTED once its "
+             "queries read more than the given bytes of results. Ignored if "
+             "call_memory_budget_config is set in "
+             "--metadata_store_server_config_file, or by the async server");
+
+// warm-up options
+DEFINE_bool(metadata_store_warm_up, false,
+            "If true, the server reports NOT_SERVING to the gRPC health checks "
+            "until the connections of the pool have read all the types to "
+            "their type caches and a node of each kind, which prepares the "
+            "statements of the hot reads. Ignored if warm_up_config is set in "
+            "--metadata_store_server_config_file");
+DEFINE_string(metadata_store_warm_up_capture_file, "",
+              "If non-empty, the read calls of the capture file written with "
+              "--metadata_store_request_capture_file are also replayed through "
+              "the server before it reports SERVING. Implies "
+              "--metadata_store_warm_up");
+DEFINE_int64(metadata_store_warm_up_max_replayed_requests, 1000,
+             "The max number of read calls replayed from "
+             "--metadata_store_warm_up_capture_file");
+
+// tracing options
+DEFINE_string(metadata_store_trace_file, "",
+              "If non-empty, the spans of a sample of the calls, their "
+              "transactions and their queries are appended to the file as "
+              "OpenTelemetry (OTLP) JSON, one span per line. The calls with a "
+              "W3C traceparent metadata continue the trace of the caller. "
+              "Ignored if tracing_config is set in "
+              "--metadata_store_server_config_file, or by the async server");
+DEFINE_double(metadata_store_trace_sample_rate, 1,
+              "The fraction in [0, 1] of the calls without a traceparent "
+              "metadata which are traced to --metadata_store_trace_file");
+
+// metadata source metrics options
+DEFINE_string(metadata_source_metrics_file, "",
+              "If non-empty, records the latency histograms, and the row and "
+              "byte counts of the metadata source queries by template query, "
+              "and the latency histograms of the transactions, and writes "
+              "them periodically to the file in the Prometheus text format, "
+              "e.g., for the textfile collector of the node exporter");
+DEFINE_int64(metadata_source_metrics_interval_sec, 15,
+             "The interval in seconds of writing "
+             "--metadata_source_metrics_file");
 
 // MySQL config command line options
 DEFINE_string(mysql_config_host, "",
@@ -198,6 +629,12 @@ int main(int argc, char** argv) {
     return -1;
   }
 
+  if (!(FLAGS_metadata_source_metrics_file).empty()) {
+    StartMetadataSourceMetricsExport(
+        (FLAGS_metadata_source_metrics_file),
+        (FLAGS_metadata_source_metrics_interval_sec));
+  }
+
   ml_metadata::MetadataStoreServerConfig server_config;
   ml_metadata::ConnectionConfig connection_config;
 
@@ -218,6 +655,11 @@ int main(int argc, char** argv) {
   } else {
     connection_config = server_config.connection_config();
   }
+  if (!connection_config.has_transaction_retry_options() &&
+      (FLAGS_metadata_store_transaction_max_retries) > 0) {
+    connection_config.mutable_transaction_retry_options()->set_max_num_retries(
+        (FLAGS_metadata_store_transaction_max_retries));
+  }
 
   // Creates a metadata_store in the main thread and init schema if necessary.
   std::unique_ptr<ml_metadata::MetadataStore> metadata_store;
@@ -237,12 +679,78 @@ int main(int argc, char** argv) {
       << "MetadataStore cannot be created with the given connection config.";
   // At this point, schema initialization and migration are done.
   metadata_store.reset();
+  for (const auto& tenant : server_config.multi_tenancy_config().tenants()) {
+    CHECK_EQ(absl::OkStatus(),
+             ml_metadata::CreateMetadataStore(tenant.connection_config(),
+                                              server_config.migration_options(),
+                                              &metadata_store))
+        << "MetadataStore cannot be created for the tenant " << tenant.name();
+    metadata_store.reset();
+  }
 
-  ml_metadata::MetadataStoreServiceImpl metadata_store_service(
-      connection_config);
+  ParseConnectionPoolFlagsBasedServerConfig(
+      (FLAGS_metadata_store_connection_pool_min_size),
+      (FLAGS_metadata_store_connection_pool_max_size),
+      (FLAGS_metadata_store_connection_pool_idle_timeout_sec),
+      (FLAGS_metadata_store_connection_pool_health_check_interval_sec),
+      &server_config);
+  ParseAsyncServerFlagsBasedServerConfig(
+      (FLAGS_enable_async_server),
+      (FLAGS_async_server_completion_queue_threads),
+      (FLAGS_async_server_type_read_workers),
+      (FLAGS_async_server_read_workers),
+      (FLAGS_async_server_write_workers),
+      (FLAGS_async_server_max_queued_calls), &server_config);
+  ParseGroupCommitFlagsBasedServerConfig(
+      (FLAGS_metadata_store_group_commit_max_delay_us),
+      (FLAGS_metadata_store_group_commit_max_batch_size), &server_config);
+  ParseParallelReadFlagsBasedServerConfig(
+      (FLAGS_metadata_store_parallel_read_workers),
+      (FLAGS_metadata_store_parallel_read_chunk_size), &server_config);
+  ParseAdmissionControlFlagsBasedServerConfig(
+      (FLAGS_metadata_store_admission_max_cost),
+      (FLAGS_metadata_store_admission_max_cost_per_client),
+      (FLAGS_metadata_store_admission_heavy_method_cost), &server_config);
+  if (!server_config.has_enable_request_coalescing()) {
+    server_config.set_enable_request_coalescing(
+        (FLAGS_metadata_store_enable_request_coalescing));
+  }
+  ParseSlowQueryLogFlagsBasedServerConfig(
+      (FLAGS_metadata_store_slow_query_threshold_ms),
+      (FLAGS_metadata_store_slow_query_explain_sample_rate), &server_config);
+  if (server_config.has_slow_query_log_config()) {
+    // The log outlives the metadata sources of the server, which use it until
+    // the process exits.
+    ml_metadata::SetDefaultSlowQueryLog(new ml_metadata::SlowQueryLog(
+        server_config.slow_query_log_config()));
+  }
+  ParseRequestCaptureFlagsBasedServerConfig(
+      (FLAGS_metadata_store_request_capture_file),
+      (FLAGS_metadata_store_request_capture_sample_rate), &server_config);
+  ParseCallMemoryBudgetFlagsBasedServerConfig(
+      (FLAGS_metadata_store_call_memory_soft_limit_bytes),
+      (FLAGS_metadata_store_call_memory_hard_limit_bytes), &server_config);
+  ParseWarmUpFlagsBasedServerConfig(
+      (FLAGS_metadata_store_warm_up),
+      (FLAGS_metadata_store_warm_up_capture_file),
+      (FLAGS_metadata_store_warm_up_max_replayed_requests), &server_config);
+  ParseTracingFlagsBasedServerConfig((FLAGS_metadata_store_trace_file),
+                                     (FLAGS_metadata_store_trace_sample_rate),
+                                     &server_config);
+  if (server_config.has_tracing_config()) {
+    // The exporter outlives the services of the server, which trace their
+    // calls until the process exits.
+    std::unique_ptr<ml_metadata::TraceSpanFileExporter> trace_exporter;
+    CHECK_EQ(absl::OkStatus(),
+             ml_metadata::TraceSpanFileExporter::Create(
+                 server_config.tracing_config(), &trace_exporter))
+        << "The trace file cannot be written.";
+    ml_metadata::SetDefaultTraceSpanExporter(trace_exporter.release());
+  }
 
   const string server_address =
       absl::StrCat("0.0.0.0:", (FLAGS_grpc_port));
+  ::grpc::EnableDefaultHealthCheckService(true);
   ::grpc::ServerBuilder builder;
 
   std::shared_ptr<::grpc::ServerCredentials> credentials =
@@ -253,12 +761,110 @@ int main(int argc, char** argv) {
 
   builder.AddListeningPort(server_address, credentials);
   AddGrpcChannelArgs((FLAGS_grpc_channel_arguments), &builder);
-  builder.RegisterService(&metadata_store_service);
+
+  // The recorder outlives the service, which is destroyed first.
+  std::unique_ptr<ml_metadata::RequestRecorder> request_recorder;
+  std::unique_ptr<ml_metadata::MetadataStoreServiceImpl> metadata_store_service;
+  std::unique_ptr<ml_metadata::MetadataStoreAsyncService>
+      metadata_store_async_service;
+  if (server_config.has_async_server_config()) {
+    metadata_store_async_service =
+        absl::make_unique<ml_metadata::MetadataStoreAsyncService>(
+            connection_config, server_config.connection_pool_config(),
+            server_config.async_server_config(),
+            server_config.read_replica_config());
+    CHECK_EQ(absl::OkStatus(),
+             metadata_store_async_service->PrefillConnectionPool())
+        << "Connection pool cannot be filled with the given connection "
+           "config.";
+    metadata_store_async_service->RegisterWith(&builder);
+    LOG_IF(WARNING, server_config.has_group_commit_config())
+        << "The group commit is not supported by the async server, and the "
+           "group_commit_config is ignored.";
+    LOG_IF(WARNING, server_config.has_parallel_read_config())
+        << "The parallel reads are not supported by the async server, and the "
+           "parallel_read_config is ignored.";
+    LOG_IF(WARNING, server_config.has_admission_control_config())
+        << "The admission control is not supported by the async server, and "
+           "the admission_control_config is ignored.";
+    LOG_IF(WARNING, server_config.enable_request_coalescing())
+        << "The request coalescing is not supported by the async server, and "
+           "enable_request_coalescing is ignored.";
+    LOG_IF(WARNING, server_config.has_request_capture_config())
+        << "The request capture is not supported by the async server, and the "
+           "request_capture_config is ignored.";
+    LOG_IF(WARNING, server_config.has_call_memory_budget_config())
+        << "The call memory budget is not supported by the async server, and "
+           "the call_memory_budget_config is ignored.";
+    LOG_IF(WARNING, server_config.has_tracing_config())
+        << "The tracing is not supported by the async server, and the "
+           "tracing_config is ignored.";
+    LOG_IF(WARNING, server_config.has_multi_tenancy_config())
+        << "The multi-tenancy is not supported by the async server, and the "
+           "multi_tenancy_config is ignored.";
+  } else {
+    metadata_store_service =
+        absl::make_unique<ml_metadata::MetadataStoreServiceImpl>(
+            connection_config, server_config.connection_pool_config(),
+            server_config.read_replica_config(),
+            server_config.has_group_commit_config()
+                ? absl::make_optional(server_config.group_commit_config())
+                : absl::nullopt,
+            server_config.has_parallel_read_config()
+                ? absl::make_optional(server_config.parallel_read_config())
+                : absl::nullopt,
+            server_config.has_admission_control_config()
+                ? absl::make_optional(server_config.admission_control_config())
+                : absl::nullopt,
+            server_config.enable_request_coalescing(),
+            server_config.has_multi_tenancy_config()
+                ? absl::make_optional(server_config.multi_tenancy_config())
+                : absl::nullopt);
+    CHECK_EQ(absl::OkStatus(), metadata_store_service->PrefillConnectionPool())
+        << "Connection pool cannot be filled with the given connection "
+           "config.";
+    if (server_config.has_request_capture_config()) {
+      CHECK_EQ(absl::OkStatus(),
+               ml_metadata::RequestRecorder::Create(
+                   server_config.request_capture_config(), &request_recorder))
+          << "The request capture file cannot be written.";
+      metadata_store_service->set_request_recorder(request_recorder.get());
+    }
+    if (server_config.has_call_memory_budget_config()) {
+      metadata_store_service->set_call_memory_budget(
+          server_config.call_memory_budget_config());
+    }
+    builder.RegisterService(metadata_store_service.get());
+  }
   std::unique_ptr<::grpc::Server> server(builder.BuildAndStart());
   LOG(INFO) << "Server listening on " << server_address;
 
+  // The warm-up runs beside the serving, as the async server serves in the
+  // main thread, and the server is not reported SERVING until it is done.
+  std::thread warm_up_thread;
+  if (server_config.has_warm_up_config()) {
+    server->GetHealthCheckService()->SetServingStatus(false);
+    const std::function<absl::Status()> warm_up_pool =
+        metadata_store_async_service != nullptr
+            ? std::function<absl::Status()>([&metadata_store_async_service]() {
+                return metadata_store_async_service->WarmUpConnectionPool();
+              })
+            : [&metadata_store_service]() {
+                return metadata_store_service->WarmUpConnectionPool();
+              };
+    warm_up_thread = std::thread([&server_config, warm_up_pool, &server]() {
+      WarmUpServer(server_config.warm_up_config(), warm_up_pool, server.get());
+    });
+  }
+
   // keep the program running until the server shuts down.
+  if (metadata_store_async_service != nullptr) {
+    metadata_store_async_service->Serve();
+  }
   server->Wait();
+  if (warm_up_thread.joinable()) {
+    warm_up_thread.join();
+  }
 
   return 0;
 }
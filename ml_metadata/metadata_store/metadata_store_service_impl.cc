@@ -14,15 +14,51 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/metadata_store_service_impl.h"
 
+#include <chrono>  // NOLINT
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <glog/logging.h>
+#include "google/protobuf/message.h"
+#include "google/protobuf/repeated_field.h"
 #include "grpcpp/support/status_code_enum.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/admission_controller.h"
+#include "ml_metadata/metadata_store/call_memory_account.h"
+#include "ml_metadata/metadata_store/cancellation_token.h"
+#include "ml_metadata/metadata_store/cancellation_watcher.h"
+#include "ml_metadata/metadata_store/group_committer.h"
+#include "ml_metadata/metadata_store/metadata_source_instrumentation.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
-#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/metadata_store_response_stream.h"
+#include "ml_metadata/metadata_store/parallel_reader.h"
+#include "ml_metadata/metadata_store/replicated_metadata_store_pool.h"
+#include "ml_metadata/metadata_store/request_coalescer.h"
+#include "ml_metadata/metadata_store/slow_query_log.h"
+#include "ml_metadata/metadata_store/tenant_router.h"
+#include "ml_metadata/metadata_store/trace_span.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/util/return_utils.h"
 
 namespace ml_metadata {
 namespace {
 
+// How often the running RPCs are checked for cancellation by their clients.
+constexpr absl::Duration kCancellationPollInterval = absl::Milliseconds(100);
+
+// The trailing metadata key of the serialized TransactionStats of an RPC.
+constexpr char kTransactionStatsMetadataKey[] = "mlmd-transaction-stats-bin";
+
 // Converts from absl Status to GRPC Status.
 ::grpc::Status ToGRPCStatus(const ::absl::Status& status) {
   // Note: the absl and grpc status codes align with each other.
@@ -30,30 +66,415 @@ namespace {
                         std::string(status.message()));
 }
 
-// Creates a store on demand. The store created does not handle migration.
-::grpc::Status ConnectMetadataStore(
-    const ConnectionConfig& connection_config,
-    std::unique_ptr<MetadataStore>* metadata_store) {
-  return ToGRPCStatus(CreateMetadataStore(connection_config, metadata_store));
+// Returns true if the client of the call asks to read its own writes.
+bool ReadsYourWrites(const ::grpc::ServerContext& context) {
+  const auto it = context.client_metadata().find(kReadYourWritesMetadataKey);
+  return it != context.client_metadata().end() && it->second == "true";
 }
 
+// Returns the trace context of the caller, i.e., its `traceparent` metadata,
+// if any, and if tracing is enabled.
+absl::optional<TraceContext> RemoteTraceContext(
+    const ::grpc::ServerContext& context) {
+  if (GetDefaultTraceSpanExporter() == nullptr) {
+    return absl::nullopt;
+  }
+  const auto it = context.client_metadata().find(kTraceparentMetadataKey);
+  if (it == context.client_metadata().end()) {
+    return absl::nullopt;
+  }
+  return ParseTraceparent(absl::string_view(it->second.data(),
+                                            it->second.size()));
+}
+
+// Returns the identity of the client of the call, i.e., the value of its
+// `client_id_metadata_key` metadata, or else the address of its peer without
+// the port.
+std::string ClientId(const ::grpc::ServerContext& context,
+                     const std::string& client_id_metadata_key) {
+  const auto it = context.client_metadata().find(client_id_metadata_key);
+  if (it != context.client_metadata().end()) {
+    return std::string(it->second.data(), it->second.size());
+  }
+  const std::string peer = context.peer();
+  const size_t port_pos = peer.rfind(':');
+  return port_pos == std::string::npos ? peer : peer.substr(0, port_pos);
+}
+
+// The ids and nodes of Get{Artifacts,Executions,Contexts}ByID.
+const auto& NodeIds(const GetArtifactsByIDRequest& request) {
+  return request.artifact_ids();
+}
+
+const auto& NodeIds(const GetExecutionsByIDRequest& request) {
+  return request.execution_ids();
+}
+
+const auto& NodeIds(const GetContextsByIDRequest& request) {
+  return request.context_ids();
+}
+
+auto* MutableNodeIds(GetArtifactsByIDRequest* request) {
+  return request->mutable_artifact_ids();
+}
+
+auto* MutableNodeIds(GetExecutionsByIDRequest* request) {
+  return request->mutable_execution_ids();
+}
+
+auto* MutableNodeIds(GetContextsByIDRequest* request) {
+  return request->mutable_context_ids();
+}
+
+google::protobuf::RepeatedPtrField<Artifact>* MutableNodes(
+    GetArtifactsByIDResponse* response) {
+  return response->mutable_artifacts();
+}
+
+google::protobuf::RepeatedPtrField<Execution>* MutableNodes(
+    GetExecutionsByIDResponse* response) {
+  return response->mutable_executions();
+}
+
+google::protobuf::RepeatedPtrField<Context>* MutableNodes(
+    GetContextsByIDResponse* response) {
+  return response->mutable_contexts();
+}
+
+// Adds `id` to the last of the chunked `requests`, or to a new one if the last
+// has `chunk_size` ids already.
+template <typename Request>
+void AddIdToChunks(const int64 id, const int chunk_size,
+                   std::vector<Request>* requests) {
+  if (requests->empty() || NodeIds(requests->back()).size() >= chunk_size) {
+    requests->emplace_back();
+  }
+  MutableNodeIds(&requests->back())->Add(id);
+}
+
+// Appends to `reads` a `read` of each of the chunked `requests` to its
+// `responses`. The requests and responses must outlast the reads.
+template <typename Request, typename Response>
+void AddChunkReads(const std::vector<Request>& requests,
+                   absl::Status (MetadataStore::*read)(const Request&,
+                                                       Response*),
+                   std::vector<Response>* responses,
+                   std::vector<ParallelReader::Read>* reads) {
+  responses->resize(requests.size());
+  for (int i = 0; i < requests.size(); i++) {
+    const Request* request = &requests[i];
+    Response* response = &(*responses)[i];
+    reads->push_back([request, response, read](MetadataStore* metadata_store) {
+      return (metadata_store->*read)(*request, response);
+    });
+  }
+}
+
+// Replaces the id-only `nodes`, i.e., the ones without a type_id, of a lineage
+// graph with the nodes read to `responses`. The nodes that are not read, e.g.,
+// deleted after the traversal, are dropped.
+template <typename Node, typename Response>
+void ReplaceIdOnlyNodes(std::vector<Response>& responses,
+                        google::protobuf::RepeatedPtrField<Node>* nodes) {
+  absl::flat_hash_map<int64, Node*> read_nodes;
+  for (Response& response : responses) {
+    for (Node& node : *MutableNodes(&response)) {
+      read_nodes.insert({node.id(), &node});
+    }
+  }
+  google::protobuf::RepeatedPtrField<Node> hydrated_nodes;
+  hydrated_nodes.Reserve(nodes->size());
+  for (Node& node : *nodes) {
+    if (node.has_type_id()) {
+      *hydrated_nodes.Add() = std::move(node);
+      continue;
+    }
+    const auto it = read_nodes.find(node.id());
+    if (it != read_nodes.end()) {
+      *hydrated_nodes.Add() = std::move(*it->second);
+    }
+  }
+  nodes->Swap(&hydrated_nodes);
+}
+
+// Returns the deadline of the RPC of `context`.
+absl::Time Deadline(const ::grpc::ServerContext& context) {
+  return context.deadline() == std::chrono::system_clock::time_point::max()
+             ? absl::InfiniteFuture()
+             : absl::FromChrono(context.deadline());
+}
+
+// Binds the deadline and the cancellation of an RPC to the queries of its
+// `metadata_store`, while in scope. The deadline bounds the queries and their
+// retries, and a cancelled RPC interrupts its running query through the
+// `watcher`, instead of holding the connection until the query completes.
+class ScopedRpcCancellation {
+ public:
+  ScopedRpcCancellation(::grpc::ServerContext* context,
+                        MetadataStore* metadata_store,
+                        CancellationWatcher* watcher)
+      : token_(Deadline(*context)),
+        metadata_store_(metadata_store),
+        watcher_(watcher) {
+    metadata_store_->set_cancellation_token(&token_);
+    watcher_->Watch(
+        this, [context]() { return context->IsCancelled(); },
+        [this]() {
+          token_.Cancel();
+          const absl::Status status = metadata_store_->CancelQuery();
+          LOG_IF(WARNING, !status.ok())
+              << "Failed to cancel the query: " << status.message();
+        });
+  }
+
+  // Disallows copy.
+  ScopedRpcCancellation(const ScopedRpcCancellation&) = delete;
+  ScopedRpcCancellation& operator=(const ScopedRpcCancellation&) = delete;
+
+  ~ScopedRpcCancellation() {
+    watcher_->Unwatch(this);
+    metadata_store_->set_cancellation_token(nullptr);
+  }
+
+ private:
+  CancellationToken token_;
+  MetadataStore* const metadata_store_;
+  CancellationWatcher* const watcher_;
+};
+
+// Reports the RPC of the `request`, with its filter, as the origin of the slow
+// queries of the `metadata_store`, while in scope. If the transaction options
+// of the `request` set return_transaction_stats, the statistics of the
+// transactions of the RPC are collected, and returned in the trailing metadata
+// of the `context` once out of scope. If the `memory_budget` is given, the
+// query results of the RPC are charged to a memory account with its limits,
+// whose peak is reported to the metadata source instrumentation once out of
+// scope.
+class ScopedCallProfile {
+ public:
+  template <typename Request>
+  ScopedCallProfile(
+      ::grpc::ServerContext* context, const Request& request,
+      const MetadataStorePool::ScopedStore& metadata_store,
+      const absl::optional<MetadataStoreServerConfig::CallMemoryBudgetConfig>&
+          memory_budget)
+      : context_(context), metadata_store_(metadata_store.get()) {
+    method_ = request.GetDescriptor()->name();
+    absl::ConsumeSuffix(&method_, "Request");
+    metadata_store_->set_query_origin(SlowQueryOrigin(method_, request));
+    if (request.transaction_options().GetExtension(return_transaction_stats)) {
+      stats_.emplace();
+      stats_->set_connection_acquisition_time_us(
+          absl::ToInt64Microseconds(metadata_store.acquisition_time()));
+      metadata_store_->set_transaction_stats(&*stats_);
+    }
+    if (memory_budget) {
+      memory_account_.emplace(memory_budget->soft_limit_bytes(),
+                              memory_budget->hard_limit_bytes());
+      metadata_store_->set_memory_account(&*memory_account_);
+    }
+  }
+
+  // Disallows copy.
+  ScopedCallProfile(const ScopedCallProfile&) = delete;
+  ScopedCallProfile& operator=(const ScopedCallProfile&) = delete;
+
+  ~ScopedCallProfile() {
+    metadata_store_->set_query_origin("");
+    if (stats_) {
+      metadata_store_->set_transaction_stats(nullptr);
+      context_->AddTrailingMetadata(kTransactionStatsMetadataKey,
+                                    stats_->SerializeAsString());
+    }
+    if (memory_account_) {
+      metadata_store_->set_memory_account(nullptr);
+      MetadataSourceInstrumentation* instrumentation =
+          GetDefaultMetadataSourceInstrumentation();
+      if (instrumentation != nullptr) {
+        instrumentation->OnCallMemory(method_,
+                                      memory_account_->charged_bytes(),
+                                      memory_account_->hard_limit_exceeded());
+      }
+    }
+  }
+
+ private:
+  ::grpc::ServerContext* const context_;
+  MetadataStore* const metadata_store_;
+  absl::string_view method_;
+  absl::optional<TransactionStats> stats_;
+  absl::optional<CallMemoryAccount> memory_account_;
+};
+
 }  // namespace
 
 MetadataStoreServiceImpl::MetadataStoreServiceImpl(
-    const ConnectionConfig& connection_config)
-    : connection_config_(connection_config) {}
+    const ConnectionConfig& connection_config,
+    const MetadataStoreServerConfig::ConnectionPoolConfig& pool_config,
+    const MetadataStoreServerConfig::ReadReplicaConfig& read_replica_config,
+    const absl::optional<MetadataStoreServerConfig::GroupCommitConfig>&
+        group_commit_config,
+    const absl::optional<MetadataStoreServerConfig::ParallelReadConfig>&
+        parallel_read_config,
+    const absl::optional<MetadataStoreServerConfig::AdmissionControlConfig>&
+        admission_control_config,
+    const bool enable_request_coalescing,
+    const absl::optional<MetadataStoreServerConfig::MultiTenancyConfig>&
+        multi_tenancy_config)
+    : cancellation_watcher_(kCancellationPollInterval) {
+  const int num_tenants =
+      1 + (multi_tenancy_config ? multi_tenancy_config->tenants_size() : 0);
+  const MetadataStoreServerConfig::ConnectionPoolConfig tenant_pool_config =
+      TenantPoolConfig(pool_config,
+                       multi_tenancy_config
+                           ? multi_tenancy_config->max_connections()
+                           : 0,
+                       num_tenants);
+  AddTenant(/*name=*/"", connection_config, tenant_pool_config,
+            read_replica_config, group_commit_config);
+  if (multi_tenancy_config) {
+    tenant_metadata_key_ = multi_tenancy_config->tenant_metadata_key();
+    for (const auto& tenant : multi_tenancy_config->tenants()) {
+      CHECK(!tenant.name().empty()) << "The name of a tenant must be given.";
+      CHECK(!tenant_router_.Contains(tenant.name()))
+          << "The tenant " << tenant.name() << " is given more than once.";
+      AddTenant(tenant.name(), tenant.connection_config(), tenant_pool_config,
+                MetadataStoreServerConfig::ReadReplicaConfig(),
+                group_commit_config);
+    }
+  }
+  if (parallel_read_config) {
+    parallel_reader_ = absl::make_unique<ParallelReader>(*parallel_read_config);
+  }
+  if (enable_request_coalescing) {
+    request_coalescer_ = absl::make_unique<RequestCoalescer>();
+  }
+  if (admission_control_config) {
+    admission_controller_ =
+        absl::make_unique<AdmissionController>(*admission_control_config);
+    client_id_metadata_key_ =
+        admission_control_config->client_id_metadata_key();
+  }
+}
+
+void MetadataStoreServiceImpl::AddTenant(
+    const std::string& name, const ConnectionConfig& connection_config,
+    const MetadataStoreServerConfig::ConnectionPoolConfig& pool_config,
+    const MetadataStoreServerConfig::ReadReplicaConfig& read_replica_config,
+    const absl::optional<MetadataStoreServerConfig::GroupCommitConfig>&
+        group_commit_config) {
+  auto tenant = absl::make_unique<Tenant>(name, connection_config, pool_config,
+                                          read_replica_config);
+  if (group_commit_config) {
+    tenant->group_committer = absl::make_unique<GroupCommitter>(
+        *group_commit_config, &tenant->pool);
+  }
+  tenant_router_.Add(name, tenant.get());
+  tenants_.push_back(std::move(tenant));
+}
+
+MetadataStoreServiceImpl::Tenant* MetadataStoreServiceImpl::FindTenant(
+    const ::grpc::ServerContext& context) {
+  if (tenants_.size() == 1) {
+    return tenants_.front().get();
+  }
+  const auto it = context.client_metadata().find(tenant_metadata_key_);
+  if (it == context.client_metadata().end()) {
+    return tenant_router_.Find(absl::nullopt);
+  }
+  return tenant_router_.Find(
+      absl::string_view(it->second.data(), it->second.size()));
+}
+
+MetadataStoreServiceImpl::Tenant& MetadataStoreServiceImpl::TenantOf(
+    const ::grpc::ServerContext& context) {
+  Tenant* tenant = FindTenant(context);
+  // The calls of unknown tenants are rejected by Admit.
+  CHECK(tenant != nullptr);
+  return *tenant;
+}
+
+absl::Status MetadataStoreServiceImpl::PrefillConnectionPool() {
+  for (const std::unique_ptr<Tenant>& tenant : tenants_) {
+    const absl::Status status = tenant->pool.Prefill();
+    if (!status.ok()) {
+      return absl::Status(
+          status.code(),
+          absl::StrCat("Failed to prefill the pool of the tenant '",
+                       tenant->name, "': ", status.message()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status MetadataStoreServiceImpl::WarmUpConnectionPool() {
+  absl::Status status;
+  for (const std::unique_ptr<Tenant>& tenant : tenants_) {
+    status.Update(tenant->pool.WarmUp());
+  }
+  return status;
+}
+
+void MetadataStoreServiceImpl::set_request_recorder(
+    RequestRecorder* request_recorder) {
+  request_recorder_ = request_recorder;
+}
+
+void MetadataStoreServiceImpl::set_call_memory_budget(
+    const MetadataStoreServerConfig::CallMemoryBudgetConfig& budget) {
+  call_memory_budget_ = budget;
+}
+
+::grpc::Status MetadataStoreServiceImpl::Admit(
+    const char* name, const ::grpc::ServerContext& context,
+    const google::protobuf::Message& request,
+    AdmissionController::Ticket* ticket) {
+  const Tenant* tenant = FindTenant(context);
+  if (tenant == nullptr) {
+    return ::grpc::Status(::grpc::StatusCode::NOT_FOUND,
+                          "The tenant of the call is unknown.");
+  }
+  if (request_recorder_ != nullptr) {
+    request_recorder_->Record(name, request);
+  }
+  if (admission_controller_ == nullptr) {
+    return ::grpc::Status::OK;
+  }
+  // The clients of the tenants are limited apart.
+  const std::string client =
+      tenant->name.empty()
+          ? ClientId(context, client_id_metadata_key_)
+          : absl::StrCat(tenant->name, "/",
+                         ClientId(context, client_id_metadata_key_));
+  const ::grpc::Status admission_status =
+      ToGRPCStatus(admission_controller_->Admit(name, client, ticket));
+  if (!admission_status.ok()) {
+    LOG_EVERY_N(WARNING, 100) << name << " of " << client << " is rejected: "
+                              << admission_status.error_message();
+  }
+  return admission_status;
+}
 
 ::grpc::Status MetadataStoreServiceImpl::PutArtifactType(
     ::grpc::ServerContext* context, const PutArtifactTypeRequest* request,
     PutArtifactTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("PutArtifactType", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("PutArtifactType", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForWrite(&metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->PutArtifactType(*request, response));
   if (!transaction_status.ok()) {
@@ -66,34 +487,37 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactType(
     ::grpc::ServerContext* context, const GetArtifactTypeRequest* request,
     GetArtifactTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetArtifactType(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetArtifactType failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  const ScopedTraceSpan span("GetArtifactType", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetArtifactType", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetArtifactType", context, *request, response,
+                       &MetadataStore::GetArtifactType);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactTypesByID(
     ::grpc::ServerContext* context, const GetArtifactTypesByIDRequest* request,
     GetArtifactTypesByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("GetArtifactTypesByID",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetArtifactTypesByID", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->GetArtifactTypesByID(*request, response));
   if (!transaction_status.ok()) {
@@ -106,14 +530,24 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactTypes(
     ::grpc::ServerContext* context, const GetArtifactTypesRequest* request,
     GetArtifactTypesResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("GetArtifactTypes", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetArtifactTypes", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->GetArtifactTypes(*request, response));
   if (!transaction_status.ok()) {
@@ -126,14 +560,23 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutExecutionType(
     ::grpc::ServerContext* context, const PutExecutionTypeRequest* request,
     PutExecutionTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("PutExecutionType", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("PutExecutionType", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForWrite(&metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->PutExecutionType(*request, response));
   if (!transaction_status.ok()) {
@@ -146,34 +589,37 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionType(
     ::grpc::ServerContext* context, const GetExecutionTypeRequest* request,
     GetExecutionTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetExecutionType(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetExecutionType failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  const ScopedTraceSpan span("GetExecutionType", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetExecutionType", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetExecutionType", context, *request, response,
+                       &MetadataStore::GetExecutionType);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionTypesByID(
     ::grpc::ServerContext* context, const GetExecutionTypesByIDRequest* request,
     GetExecutionTypesByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("GetExecutionTypesByID",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetExecutionTypesByID", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->GetExecutionTypesByID(*request, response));
   if (!transaction_status.ok()) {
@@ -186,14 +632,24 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionTypes(
     ::grpc::ServerContext* context, const GetExecutionTypesRequest* request,
     GetExecutionTypesResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("GetExecutionTypes", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetExecutionTypes", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->GetExecutionTypes(*request, response));
   if (!transaction_status.ok()) {
@@ -206,14 +662,23 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutContextType(
     ::grpc::ServerContext* context, const PutContextTypeRequest* request,
     PutContextTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("PutContextType", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("PutContextType", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForWrite(&metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->PutContextType(*request, response));
   if (!transaction_status.ok()) {
@@ -226,34 +691,37 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetContextType(
     ::grpc::ServerContext* context, const GetContextTypeRequest* request,
     GetContextTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContextType(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetContextType failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  const ScopedTraceSpan span("GetContextType", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetContextType", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetContextType", context, *request, response,
+                       &MetadataStore::GetContextType);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetContextTypesByID(
     ::grpc::ServerContext* context, const GetContextTypesByIDRequest* request,
     GetContextTypesByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("GetContextTypesByID",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetContextTypesByID", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->GetContextTypesByID(*request, response));
   if (!transaction_status.ok()) {
@@ -266,14 +734,24 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetContextTypes(
     ::grpc::ServerContext* context, const GetContextTypesRequest* request,
     GetContextTypesResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("GetContextTypes", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetContextTypes", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->GetContextTypes(*request, response));
   if (!transaction_status.ok()) {
@@ -286,14 +764,23 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutArtifacts(
     ::grpc::ServerContext* context, const PutArtifactsRequest* request,
     PutArtifactsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("PutArtifacts", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("PutArtifacts", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForWrite(&metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->PutArtifacts(*request, response));
   if (!transaction_status.ok()) {
@@ -306,14 +793,23 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutExecutions(
     ::grpc::ServerContext* context, const PutExecutionsRequest* request,
     PutExecutionsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("PutExecutions", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("PutExecutions", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForWrite(&metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->PutExecutions(*request, response));
   if (!transaction_status.ok()) {
@@ -326,14 +822,23 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::PutTypes(
     ::grpc::ServerContext* context, const PutTypesRequest* request,
     PutTypesResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("PutTypes", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("PutTypes", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForWrite(&metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->PutTypes(*request, response));
   if (!transaction_status.ok()) {
@@ -345,135 +850,113 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactsByID(
     ::grpc::ServerContext* context, const GetArtifactsByIDRequest* request,
     GetArtifactsByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetArtifactsByID(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetArtifactsByID failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  const ScopedTraceSpan span("GetArtifactsByID", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetArtifactsByID", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return GetNodesByID("GetArtifactsByID", context, *request, response,
+                      &MetadataStore::GetArtifactsByID);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionsByID(
     ::grpc::ServerContext* context, const GetExecutionsByIDRequest* request,
     GetExecutionsByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetExecutionsByID(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetExecutionsByID failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  const ScopedTraceSpan span("GetExecutionsByID", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetExecutionsByID", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return GetNodesByID("GetExecutionsByID", context, *request, response,
+                      &MetadataStore::GetExecutionsByID);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::PutEvents(
     ::grpc::ServerContext* context, const PutEventsRequest* request,
     PutEventsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->PutEvents(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "PutEvents failed: " << transaction_status.error_message();
-  }
-  return transaction_status;
+  const ScopedTraceSpan span("PutEvents", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("PutEvents", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CommitWrite("PutEvents", context, *request, response,
+                     &MetadataStore::PutEvents);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::PutExecution(
     ::grpc::ServerContext* context, const PutExecutionRequest* request,
     PutExecutionResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->PutExecution(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "PutExecution failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  const ScopedTraceSpan span("PutExecution", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("PutExecution", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CommitWrite("PutExecution", context, *request, response,
+                     &MetadataStore::PutExecution);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetEventsByArtifactIDs(
     ::grpc::ServerContext* context,
     const GetEventsByArtifactIDsRequest* request,
     GetEventsByArtifactIDsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetEventsByArtifactIDs(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetEventsByArtifactIDs failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  const ScopedTraceSpan span("GetEventsByArtifactIDs",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetEventsByArtifactIDs", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetEventsByArtifactIDs", context, *request, response,
+                       &MetadataStore::GetEventsByArtifactIDs);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetEventsByExecutionIDs(
     ::grpc::ServerContext* context,
     const GetEventsByExecutionIDsRequest* request,
     GetEventsByExecutionIDsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetEventsByExecutionIDs(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetEventsByExecutionIDs failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  const ScopedTraceSpan span("GetEventsByExecutionIDs",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetEventsByExecutionIDs", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetEventsByExecutionIDs", context, *request, response,
+                       &MetadataStore::GetEventsByExecutionIDs);
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetEventsByTimeRange(
+    ::grpc::ServerContext* context, const GetEventsByTimeRangeRequest* request,
+    GetEventsByTimeRangeResponse* response) {
+  const ScopedTraceSpan span("GetEventsByTimeRange",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetEventsByTimeRange", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetEventsByTimeRange", context, *request, response,
+                       &MetadataStore::GetEventsByTimeRange);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetArtifacts(
     ::grpc::ServerContext* context, const GetArtifactsRequest* request,
     GetArtifactsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("GetArtifacts", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetArtifacts", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->GetArtifacts(*request, response));
   if (!transaction_status.ok()) {
@@ -486,14 +969,25 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactsByType(
     ::grpc::ServerContext* context, const GetArtifactsByTypeRequest* request,
     GetArtifactsByTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("GetArtifactsByType",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetArtifactsByType", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->GetArtifactsByType(*request, response));
   if (!transaction_status.ok()) {
@@ -507,54 +1001,49 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     ::grpc::ServerContext* context,
     const GetArtifactByTypeAndNameRequest* request,
     GetArtifactByTypeAndNameResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status = ToGRPCStatus(
-      metadata_store->GetArtifactByTypeAndName(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetArtifactByTypeAndName failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  const ScopedTraceSpan span("GetArtifactByTypeAndName",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetArtifactByTypeAndName", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetArtifactByTypeAndName", context, *request, response,
+                       &MetadataStore::GetArtifactByTypeAndName);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactsByURI(
     ::grpc::ServerContext* context, const GetArtifactsByURIRequest* request,
     GetArtifactsByURIResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetArtifactsByURI(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetArtifactsByURI failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  const ScopedTraceSpan span("GetArtifactsByURI", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetArtifactsByURI", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetArtifactsByURI", context, *request, response,
+                       &MetadataStore::GetArtifactsByURI);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetExecutions(
     ::grpc::ServerContext* context, const GetExecutionsRequest* request,
     GetExecutionsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("GetExecutions", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetExecutions", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->GetExecutions(*request, response));
   if (!transaction_status.ok()) {
@@ -567,14 +1056,25 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionsByType(
     ::grpc::ServerContext* context, const GetExecutionsByTypeRequest* request,
     GetExecutionsByTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("GetExecutionsByType",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetExecutionsByType", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->GetExecutionsByType(*request, response));
   if (!transaction_status.ok()) {
@@ -584,38 +1084,54 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
   return transaction_status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::GetActiveExecutionsByType(
+    ::grpc::ServerContext* context,
+    const GetActiveExecutionsByTypeRequest* request,
+    GetActiveExecutionsByTypeResponse* response) {
+  const ScopedTraceSpan span("GetActiveExecutionsByType",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetActiveExecutionsByType", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetActiveExecutionsByType", context, *request,
+                       response, &MetadataStore::GetActiveExecutionsByType);
+}
+
 ::grpc::Status MetadataStoreServiceImpl::GetExecutionByTypeAndName(
     ::grpc::ServerContext* context,
     const GetExecutionByTypeAndNameRequest* request,
     GetExecutionByTypeAndNameResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status = ToGRPCStatus(
-      metadata_store->GetExecutionByTypeAndName(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetExecutionByTypeAndName failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  const ScopedTraceSpan span("GetExecutionByTypeAndName",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetExecutionByTypeAndName", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetExecutionByTypeAndName", context, *request, response,
+                       &MetadataStore::GetExecutionByTypeAndName);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::PutContexts(
     ::grpc::ServerContext* context, const PutContextsRequest* request,
     PutContextsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("PutContexts", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("PutContexts", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForWrite(&metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->PutContexts(*request, response));
   if (!transaction_status.ok()) {
@@ -628,34 +1144,36 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetContextsByID(
     ::grpc::ServerContext* context, const GetContextsByIDRequest* request,
     GetContextsByIDResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
-  const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
-  if (!connection_status.ok()) {
-    LOG(WARNING) << "Failed to connect to the database: "
-                 << connection_status.error_message();
-    return connection_status;
-  }
-  const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContextsByID(*request, response));
-  if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetContextsByID failed: "
-                 << transaction_status.error_message();
-  }
-  return transaction_status;
+  const ScopedTraceSpan span("GetContextsByID", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetContextsByID", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return GetNodesByID("GetContextsByID", context, *request, response,
+                      &MetadataStore::GetContextsByID);
 }
 
 ::grpc::Status MetadataStoreServiceImpl::GetContexts(
     ::grpc::ServerContext* context, const GetContextsRequest* request,
     GetContextsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("GetContexts", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetContexts", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->GetContexts(*request, response));
   if (!transaction_status.ok()) {
@@ -668,14 +1186,24 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
 ::grpc::Status MetadataStoreServiceImpl::GetContextsByType(
     ::grpc::ServerContext* context, const GetContextsByTypeRequest* request,
     GetContextsByTypeResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("GetContextsByType", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetContextsByType", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
       ToGRPCStatus(metadata_store->GetContextsByType(*request, response));
   if (!transaction_status.ok()) {
@@ -689,186 +1217,810 @@ MetadataStoreServiceImpl::MetadataStoreServiceImpl(
     ::grpc::ServerContext* context,
     const GetContextByTypeAndNameRequest* request,
     GetContextByTypeAndNameResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("GetContextByTypeAndName",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetContextByTypeAndName", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetContextByTypeAndName", context, *request, response,
+                       &MetadataStore::GetContextByTypeAndName);
+}
+
+::grpc::Status MetadataStoreServiceImpl::PutAttributionsAndAssociations(
+    ::grpc::ServerContext* context,
+    const PutAttributionsAndAssociationsRequest* request,
+    PutAttributionsAndAssociationsResponse* response) {
+  const ScopedTraceSpan span("PutAttributionsAndAssociations",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("PutAttributionsAndAssociations", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CommitWrite("PutAttributionsAndAssociations", context, *request,
+                     response, &MetadataStore::PutAttributionsAndAssociations);
+}
+
+::grpc::Status MetadataStoreServiceImpl::PutParentContexts(
+    ::grpc::ServerContext* context, const PutParentContextsRequest* request,
+    PutParentContextsResponse* response) {
+  const ScopedTraceSpan span("PutParentContexts", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("PutParentContexts", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForWrite(&metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContextByTypeAndName(*request, response));
+      ToGRPCStatus(metadata_store->PutParentContexts(*request, response));
   if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetContextByTypeAndName failed: "
+    LOG(WARNING) << "PutParentContexts failed: "
                  << transaction_status.error_message();
   }
   return transaction_status;
 }
 
-::grpc::Status MetadataStoreServiceImpl::PutAttributionsAndAssociations(
-    ::grpc::ServerContext* context,
-    const PutAttributionsAndAssociationsRequest* request,
-    PutAttributionsAndAssociationsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+::grpc::Status MetadataStoreServiceImpl::DeleteArtifacts(
+    ::grpc::ServerContext* context, const DeleteArtifactsRequest* request,
+    DeleteArtifactsResponse* response) {
+  const ScopedTraceSpan span("DeleteArtifacts", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("DeleteArtifacts", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForWrite(&metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
-  const ::grpc::Status transaction_status = ToGRPCStatus(
-      metadata_store->PutAttributionsAndAssociations(*request, response));
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->DeleteArtifacts(*request, response));
   if (!transaction_status.ok()) {
-    LOG(WARNING) << "PutAttributionsAndAssociations failed: "
+    LOG(WARNING) << "DeleteArtifacts failed: "
                  << transaction_status.error_message();
   }
   return transaction_status;
 }
 
-::grpc::Status MetadataStoreServiceImpl::PutParentContexts(
-    ::grpc::ServerContext* context, const PutParentContextsRequest* request,
-    PutParentContextsResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+::grpc::Status MetadataStoreServiceImpl::DeleteExecutions(
+    ::grpc::ServerContext* context, const DeleteExecutionsRequest* request,
+    DeleteExecutionsResponse* response) {
+  const ScopedTraceSpan span("DeleteExecutions", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("DeleteExecutions", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForWrite(&metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->PutParentContexts(*request, response));
+      ToGRPCStatus(metadata_store->DeleteExecutions(*request, response));
   if (!transaction_status.ok()) {
-    LOG(WARNING) << "PutParentContexts failed: "
+    LOG(WARNING) << "DeleteExecutions failed: "
                  << transaction_status.error_message();
   }
   return transaction_status;
 }
 
-::grpc::Status MetadataStoreServiceImpl::GetContextsByArtifact(
-    ::grpc::ServerContext* context, const GetContextsByArtifactRequest* request,
-    GetContextsByArtifactResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+::grpc::Status MetadataStoreServiceImpl::ArchiveExecutions(
+    ::grpc::ServerContext* context, const ArchiveExecutionsRequest* request,
+    ArchiveExecutionsResponse* response) {
+  const ScopedTraceSpan span("ArchiveExecutions", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("ArchiveExecutions", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForWrite(&metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContextsByArtifact(*request, response));
+      ToGRPCStatus(metadata_store->ArchiveExecutions(*request, response));
   if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetContextsByArtifact failed: "
+    LOG(WARNING) << "ArchiveExecutions failed: "
                  << transaction_status.error_message();
   }
   return transaction_status;
 }
 
-::grpc::Status MetadataStoreServiceImpl::GetContextsByExecution(
-    ::grpc::ServerContext* context,
-    const GetContextsByExecutionRequest* request,
-    GetContextsByExecutionResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+::grpc::Status MetadataStoreServiceImpl::ExecuteBatch(
+    ::grpc::ServerContext* context, const BatchRequest* request,
+    BatchResponse* response) {
+  const ScopedTraceSpan span("ExecuteBatch", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("ExecuteBatch", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForWrite(&metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetContextsByExecution(*request, response));
+      ToGRPCStatus(metadata_store->ExecuteBatch(*request, response));
   if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetContextsByExecution failed: "
+    LOG(WARNING) << "ExecuteBatch failed: "
                  << transaction_status.error_message();
   }
   return transaction_status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::GetContextsByArtifact(
+    ::grpc::ServerContext* context, const GetContextsByArtifactRequest* request,
+    GetContextsByArtifactResponse* response) {
+  const ScopedTraceSpan span("GetContextsByArtifact",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetContextsByArtifact", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetContextsByArtifact", context, *request, response,
+                       &MetadataStore::GetContextsByArtifact);
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetContextsByExecution(
+    ::grpc::ServerContext* context,
+    const GetContextsByExecutionRequest* request,
+    GetContextsByExecutionResponse* response) {
+  const ScopedTraceSpan span("GetContextsByExecution",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetContextsByExecution", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetContextsByExecution", context, *request, response,
+                       &MetadataStore::GetContextsByExecution);
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetExecutionDetails(
+    ::grpc::ServerContext* context, const GetExecutionDetailsRequest* request,
+    GetExecutionDetailsResponse* response) {
+  const ScopedTraceSpan span("GetExecutionDetails",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetExecutionDetails", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetExecutionDetails", context, *request, response,
+                       &MetadataStore::GetExecutionDetails);
+}
+
 ::grpc::Status MetadataStoreServiceImpl::GetArtifactsByContext(
     ::grpc::ServerContext* context, const GetArtifactsByContextRequest* request,
     GetArtifactsByContextResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+  const ScopedTraceSpan span("GetArtifactsByContext",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetArtifactsByContext", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetArtifactsByContext", context, *request, response,
+                       &MetadataStore::GetArtifactsByContext);
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetExecutionsByContext(
+    ::grpc::ServerContext* context,
+    const GetExecutionsByContextRequest* request,
+    GetExecutionsByContextResponse* response) {
+  const ScopedTraceSpan span("GetExecutionsByContext",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetExecutionsByContext", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetExecutionsByContext", context, *request, response,
+                       &MetadataStore::GetExecutionsByContext);
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetArtifactsByContexts(
+    ::grpc::ServerContext* context,
+    const GetArtifactsByContextsRequest* request,
+    GetArtifactsByContextsResponse* response) {
+  const ScopedTraceSpan span("GetArtifactsByContexts",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetArtifactsByContexts", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetArtifactsByContexts", context, *request, response,
+                       &MetadataStore::GetArtifactsByContexts);
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetExecutionsByContexts(
+    ::grpc::ServerContext* context,
+    const GetExecutionsByContextsRequest* request,
+    GetExecutionsByContextsResponse* response) {
+  const ScopedTraceSpan span("GetExecutionsByContexts",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetExecutionsByContexts", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetExecutionsByContexts", context, *request, response,
+                       &MetadataStore::GetExecutionsByContexts);
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetParentContextsByContext(
+    ::grpc::ServerContext* context,
+    const GetParentContextsByContextRequest* request,
+    GetParentContextsByContextResponse* response) {
+  const ScopedTraceSpan span("GetParentContextsByContext",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetParentContextsByContext", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetParentContextsByContext", context, *request,
+                       response, &MetadataStore::GetParentContextsByContext);
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetChildrenContextsByContext(
+    ::grpc::ServerContext* context,
+    const GetChildrenContextsByContextRequest* request,
+    GetChildrenContextsByContextResponse* response) {
+  const ScopedTraceSpan span("GetChildrenContextsByContext",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetChildrenContextsByContext", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  return CoalescedRead("GetChildrenContextsByContext", context, *request,
+                       response, &MetadataStore::GetChildrenContextsByContext);
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetAncestorContexts(
+    ::grpc::ServerContext* context, const GetAncestorContextsRequest* request,
+    GetAncestorContextsResponse* response) {
+  const ScopedTraceSpan span("GetAncestorContexts",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetAncestorContexts", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetArtifactsByContext(*request, response));
+      ToGRPCStatus(metadata_store->GetAncestorContexts(*request, response));
   if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetArtifactsByContext failed: "
+    LOG(WARNING) << "GetAncestorContexts failed: "
                  << transaction_status.error_message();
   }
   return transaction_status;
 }
 
-::grpc::Status MetadataStoreServiceImpl::GetExecutionsByContext(
+::grpc::Status MetadataStoreServiceImpl::GetDescendantContexts(
     ::grpc::ServerContext* context,
-    const GetExecutionsByContextRequest* request,
-    GetExecutionsByContextResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+    const GetDescendantContextsRequest* request,
+    GetDescendantContextsResponse* response) {
+  const ScopedTraceSpan span("GetDescendantContexts",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetDescendantContexts", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status =
-      ToGRPCStatus(metadata_store->GetExecutionsByContext(*request, response));
+      ToGRPCStatus(metadata_store->GetDescendantContexts(*request, response));
   if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetExecutionsByContext failed: "
+    LOG(WARNING) << "GetDescendantContexts failed: "
                  << transaction_status.error_message();
   }
   return transaction_status;
 }
 
-::grpc::Status MetadataStoreServiceImpl::GetParentContextsByContext(
-    ::grpc::ServerContext* context,
-    const GetParentContextsByContextRequest* request,
-    GetParentContextsByContextResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+template <typename Request, typename Response>
+::grpc::Status MetadataStoreServiceImpl::CommitWrite(
+    const char* name, ::grpc::ServerContext* context, const Request& request,
+    Response* response,
+    absl::Status (MetadataStore::*write)(const Request&, Response*)) {
+  Tenant& tenant = TenantOf(*context);
+  if (tenant.group_committer != nullptr &&
+      !request.has_transaction_options()) {
+    const ::grpc::Status transaction_status =
+        ToGRPCStatus(tenant.group_committer->Commit(
+            [&request, response, write](MetadataStore* metadata_store) {
+              return (metadata_store->*write)(request, response);
+            }));
+    if (!transaction_status.ok()) {
+      LOG(WARNING) << name << " failed: " << transaction_status.error_message();
+    }
+    return transaction_status;
+  }
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(tenant.pool.AcquireForWrite(&metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus((metadata_store.get()->*write)(request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << name << " failed: " << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+template <typename Request, typename Response>
+::grpc::Status MetadataStoreServiceImpl::GetNodesByID(
+    const char* name, ::grpc::ServerContext* context, const Request& request,
+    Response* response,
+    absl::Status (MetadataStore::*read)(const Request&, Response*)) {
+  if (parallel_reader_ == nullptr ||
+      NodeIds(request).size() <= parallel_reader_->chunk_size()) {
+    MetadataStorePool::ScopedStore metadata_store;
+    const ::grpc::Status connection_status =
+        ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+            ReadsYourWrites(*context), &metadata_store));
+    if (!connection_status.ok()) {
+      LOG(WARNING) << "Failed to connect to the database: "
+                   << connection_status.error_message();
+      return connection_status;
+    }
+    const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                              &cancellation_watcher_);
+    const ScopedCallProfile profile(context, request, metadata_store,
+                                    call_memory_budget_);
+    const ::grpc::Status transaction_status =
+        ToGRPCStatus((metadata_store.get()->*read)(request, response));
+    if (!transaction_status.ok()) {
+      LOG(WARNING) << name << " failed: " << transaction_status.error_message();
+    }
+    return transaction_status;
+  }
+  std::vector<Request> chunk_requests;
+  for (const int64 id : NodeIds(request)) {
+    AddIdToChunks(id, parallel_reader_->chunk_size(), &chunk_requests);
+  }
+  if (request.has_transaction_options()) {
+    for (Request& chunk_request : chunk_requests) {
+      *chunk_request.mutable_transaction_options() =
+          request.transaction_options();
+    }
+  }
+  std::vector<Response> chunk_responses;
+  std::vector<ParallelReader::Read> reads;
+  AddChunkReads(chunk_requests, read, &chunk_responses, &reads);
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(parallel_reader_->Run(
+          reads,
+          TenantOf(*context).pool.SelectReadPool(ReadsYourWrites(*context))));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << name << " failed: " << transaction_status.error_message();
+    return transaction_status;
+  }
+  response->Clear();
+  for (Response& chunk_response : chunk_responses) {
+    for (auto& node : *MutableNodes(&chunk_response)) {
+      *MutableNodes(response)->Add() = std::move(node);
+    }
+  }
+  return transaction_status;
+}
+
+template <typename Request, typename Response>
+::grpc::Status MetadataStoreServiceImpl::CoalescedRead(
+    const char* name, ::grpc::ServerContext* context, const Request& request,
+    Response* response,
+    absl::Status (MetadataStore::*read)(const Request&, Response*)) {
+  const bool reads_your_writes = ReadsYourWrites(*context);
+  Tenant& tenant = TenantOf(*context);
+  const auto run_read = [&]() {
+    MetadataStorePool::ScopedStore metadata_store;
+    const absl::Status connection_status =
+        tenant.pool.AcquireForRead(reads_your_writes, &metadata_store);
+    if (!connection_status.ok()) {
+      LOG(WARNING) << "Failed to connect to the database: "
+                   << connection_status.message();
+      return connection_status;
+    }
+    const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                              &cancellation_watcher_);
+    const ScopedCallProfile profile(context, request, metadata_store,
+                                    call_memory_budget_);
+    return (metadata_store.get()->*read)(request, response);
+  };
+  // The calls reading their own writes, or with transaction_options, e.g., to
+  // return their own transaction stats, are not coalesced.
+  const ::grpc::Status transaction_status = ToGRPCStatus(
+      request_coalescer_ == nullptr || reads_your_writes ||
+              request.has_transaction_options()
+          ? run_read()
+          : request_coalescer_->Coalesce(
+                absl::StrCat(tenant.name, "/", name, "/",
+                             request.SerializeAsString()),
+                tenant.pool.write_generation(), Deadline(*context), run_read,
+                response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << name << " failed: " << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+absl::Status MetadataStoreServiceImpl::HydrateLineageGraph(
+    MetadataStorePool* read_pool, LineageGraph* subgraph) {
+  std::vector<GetArtifactsByIDRequest> artifact_requests;
+  for (const Artifact& artifact : subgraph->artifacts()) {
+    if (!artifact.has_type_id()) {
+      AddIdToChunks(artifact.id(), parallel_reader_->chunk_size(),
+                    &artifact_requests);
+    }
+  }
+  std::vector<GetExecutionsByIDRequest> execution_requests;
+  for (const Execution& execution : subgraph->executions()) {
+    if (!execution.has_type_id()) {
+      AddIdToChunks(execution.id(), parallel_reader_->chunk_size(),
+                    &execution_requests);
+    }
+  }
+  std::vector<GetArtifactsByIDResponse> artifact_responses;
+  std::vector<GetExecutionsByIDResponse> execution_responses;
+  std::vector<ParallelReader::Read> reads;
+  AddChunkReads(artifact_requests, &MetadataStore::GetArtifactsByID,
+                &artifact_responses, &reads);
+  AddChunkReads(execution_requests, &MetadataStore::GetExecutionsByID,
+                &execution_responses, &reads);
+  MLMD_RETURN_IF_ERROR(parallel_reader_->Run(reads, read_pool));
+  ReplaceIdOnlyNodes(artifact_responses, subgraph->mutable_artifacts());
+  ReplaceIdOnlyNodes(execution_responses, subgraph->mutable_executions());
+  return absl::OkStatus();
+}
+
+template <typename Response>
+::grpc::Status MetadataStoreServiceImpl::WriteResponseStream(
+    const char* name, ::grpc::ServerContext* context,
+    ResponseStream<Response>* stream, ::grpc::ServerWriter<Response>* writer) {
+  // The chunks are read from the same replica.
+  MetadataStorePool* read_pool =
+      TenantOf(*context).pool.SelectReadPool(ReadsYourWrites(*context));
+  bool done = false;
+  while (!done) {
+    if (context->IsCancelled()) {
+      return ::grpc::Status(::grpc::StatusCode::CANCELLED,
+                            "The client cancelled the stream.");
+    }
+    Response response;
+    const ::grpc::Status transaction_status =
+        ToGRPCStatus(stream->Next(read_pool, &response, &done));
+    if (!transaction_status.ok()) {
+      LOG(WARNING) << name << " failed: " << transaction_status.error_message();
+      return transaction_status;
+    }
+    if (!writer->Write(response)) {
+      return ::grpc::Status(::grpc::StatusCode::CANCELLED,
+                            "The stream is closed by the client.");
+    }
+  }
+  return ::grpc::Status::OK;
+}
+
+::grpc::Status MetadataStoreServiceImpl::StreamArtifacts(
+    ::grpc::ServerContext* context, const GetArtifactsRequest* request,
+    ::grpc::ServerWriter<GetArtifactsResponse>* writer) {
+  const ScopedTraceSpan span("StreamArtifacts", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("StreamArtifacts", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  PagedResponseStream<GetArtifactsRequest, GetArtifactsResponse> stream(
+      *request, &MetadataStore::GetArtifacts);
+  return WriteResponseStream("StreamArtifacts", context, &stream, writer);
+}
+
+::grpc::Status MetadataStoreServiceImpl::StreamExecutions(
+    ::grpc::ServerContext* context, const GetExecutionsRequest* request,
+    ::grpc::ServerWriter<GetExecutionsResponse>* writer) {
+  const ScopedTraceSpan span("StreamExecutions", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("StreamExecutions", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  PagedResponseStream<GetExecutionsRequest, GetExecutionsResponse> stream(
+      *request, &MetadataStore::GetExecutions);
+  return WriteResponseStream("StreamExecutions", context, &stream, writer);
+}
+
+::grpc::Status MetadataStoreServiceImpl::StreamArtifactsByType(
+    ::grpc::ServerContext* context, const GetArtifactsByTypeRequest* request,
+    ::grpc::ServerWriter<GetArtifactsByTypeResponse>* writer) {
+  const ScopedTraceSpan span("StreamArtifactsByType",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("StreamArtifactsByType", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  PagedResponseStream<GetArtifactsByTypeRequest, GetArtifactsByTypeResponse>
+      stream(*request, &MetadataStore::GetArtifactsByType);
+  return WriteResponseStream("StreamArtifactsByType", context, &stream,
+                             writer);
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetLineageGraph(
+    ::grpc::ServerContext* context, const GetLineageGraphRequest* request,
+    GetLineageGraphResponse* response) {
+  const ScopedTraceSpan span("GetLineageGraph", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetLineageGraph", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  // The traversal and the hydration of the nodes are read from the same
+  // replica.
+  MetadataStorePool* read_pool =
+      TenantOf(*context).pool.SelectReadPool(ReadsYourWrites(*context));
+  {
+    MetadataStorePool::ScopedStore metadata_store;
+    const ::grpc::Status connection_status =
+        ToGRPCStatus(read_pool->Acquire(&metadata_store));
+    if (!connection_status.ok()) {
+      LOG(WARNING) << "Failed to connect to the database: "
+                   << connection_status.error_message();
+      return connection_status;
+    }
+    const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                              &cancellation_watcher_);
+    const ScopedCallProfile profile(context, *request, metadata_store,
+                                    call_memory_budget_);
+    const ::grpc::Status transaction_status = ToGRPCStatus(
+        parallel_reader_ == nullptr
+            ? metadata_store->GetLineageGraph(*request, response)
+            : metadata_store->GetLineageGraphIds(*request, response));
+    if (!transaction_status.ok() || parallel_reader_ == nullptr) {
+      LOG_IF(WARNING, !transaction_status.ok())
+          << "GetLineageGraph failed: " << transaction_status.error_message();
+      return transaction_status;
+    }
+  }
+  // The store of the traversal is returned first, as the hydration may need
+  // every store of the pool.
   const ::grpc::Status transaction_status = ToGRPCStatus(
-      metadata_store->GetParentContextsByContext(*request, response));
+      HydrateLineageGraph(read_pool, response->mutable_subgraph()));
   if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetParentContextsByContext failed: "
+    LOG(WARNING) << "GetLineageGraph failed: "
                  << transaction_status.error_message();
   }
   return transaction_status;
 }
 
-::grpc::Status MetadataStoreServiceImpl::GetChildrenContextsByContext(
+::grpc::Status MetadataStoreServiceImpl::StreamLineageGraph(
+    ::grpc::ServerContext* context, const GetLineageGraphRequest* request,
+    ::grpc::ServerWriter<GetLineageGraphResponse>* writer) {
+  const ScopedTraceSpan span("StreamLineageGraph",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("StreamLineageGraph", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  LineageGraphResponseStream stream(*request);
+  return WriteResponseStream("StreamLineageGraph", context, &stream, writer);
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetArtifactsByDerivation(
     ::grpc::ServerContext* context,
-    const GetChildrenContextsByContextRequest* request,
-    GetChildrenContextsByContextResponse* response) {
-  std::unique_ptr<MetadataStore> metadata_store;
+    const GetArtifactsByDerivationRequest* request,
+    GetArtifactsByDerivationResponse* response) {
+  const ScopedTraceSpan span("GetArtifactsByDerivation",
+                             RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetArtifactsByDerivation", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
   const ::grpc::Status connection_status =
-      ConnectMetadataStore(connection_config_, &metadata_store);
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
   if (!connection_status.ok()) {
     LOG(WARNING) << "Failed to connect to the database: "
                  << connection_status.error_message();
     return connection_status;
   }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
   const ::grpc::Status transaction_status = ToGRPCStatus(
-      metadata_store->GetChildrenContextsByContext(*request, response));
+      metadata_store->GetArtifactsByDerivation(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "GetArtifactsByDerivation failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::GetChanges(
+    ::grpc::ServerContext* context, const GetChangesRequest* request,
+    GetChangesResponse* response) {
+  const ScopedTraceSpan span("GetChanges", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("GetChanges", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
+  const ::grpc::Status connection_status =
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->GetChanges(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "GetChanges failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::CountArtifacts(
+    ::grpc::ServerContext* context, const CountArtifactsRequest* request,
+    CountArtifactsResponse* response) {
+  const ScopedTraceSpan span("CountArtifacts", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("CountArtifacts", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
+  const ::grpc::Status connection_status =
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->CountArtifacts(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "CountArtifacts failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::CountExecutions(
+    ::grpc::ServerContext* context, const CountExecutionsRequest* request,
+    CountExecutionsResponse* response) {
+  const ScopedTraceSpan span("CountExecutions", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("CountExecutions", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
+  const ::grpc::Status connection_status =
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->CountExecutions(*request, response));
+  if (!transaction_status.ok()) {
+    LOG(WARNING) << "CountExecutions failed: "
+                 << transaction_status.error_message();
+  }
+  return transaction_status;
+}
+
+::grpc::Status MetadataStoreServiceImpl::CountContexts(
+    ::grpc::ServerContext* context, const CountContextsRequest* request,
+    CountContextsResponse* response) {
+  const ScopedTraceSpan span("CountContexts", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("CountContexts", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  MetadataStorePool::ScopedStore metadata_store;
+  const ::grpc::Status connection_status =
+      ToGRPCStatus(TenantOf(*context).pool.AcquireForRead(
+          ReadsYourWrites(*context), &metadata_store));
+  if (!connection_status.ok()) {
+    LOG(WARNING) << "Failed to connect to the database: "
+                 << connection_status.error_message();
+    return connection_status;
+  }
+  const ScopedRpcCancellation cancellation(context, metadata_store.get(),
+                                            &cancellation_watcher_);
+  const ScopedCallProfile profile(context, *request, metadata_store,
+                                  call_memory_budget_);
+  const ::grpc::Status transaction_status =
+      ToGRPCStatus(metadata_store->CountContexts(*request, response));
   if (!transaction_status.ok()) {
-    LOG(WARNING) << "GetChildrenContextsByContext failed: "
+    LOG(WARNING) << "CountContexts failed: "
                  << transaction_status.error_message();
   }
   return transaction_status;
 }
 
+::grpc::Status MetadataStoreServiceImpl::StreamChanges(
+    ::grpc::ServerContext* context, const GetChangesRequest* request,
+    ::grpc::ServerWriter<GetChangesResponse>* writer) {
+  const ScopedTraceSpan span("StreamChanges", RemoteTraceContext(*context));
+  AdmissionController::Ticket ticket;
+  const ::grpc::Status admission_status =
+      Admit("StreamChanges", *context, *request, &ticket);
+  if (!admission_status.ok()) return admission_status;
+  ChangeLogResponseStream stream(*request);
+  return WriteResponseStream("StreamChanges", context, &stream, writer);
+}
+
 }  // namespace ml_metadata
@@ -15,7 +15,24 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_METADATA_STORE_SERVICE_IMPL_H_
 #define ML_METADATA_METADATA_STORE_METADATA_STORE_SERVICE_IMPL_H_
 
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/message.h"
+#include "absl/status/status.h"
+#include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/admission_controller.h"
+#include "ml_metadata/metadata_store/cancellation_watcher.h"
+#include "ml_metadata/metadata_store/group_committer.h"
 #include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/metadata_store_response_stream.h"
+#include "ml_metadata/metadata_store/parallel_reader.h"
+#include "ml_metadata/metadata_store/replicated_metadata_store_pool.h"
+#include "ml_metadata/metadata_store/request_capture.h"
+#include "ml_metadata/metadata_store/request_coalescer.h"
+#include "ml_metadata/metadata_store/tenant_router.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/proto/metadata_store_service.grpc.pb.h"
 
@@ -23,18 +40,70 @@ namespace ml_metadata {
 
 // A metadata store gRPC server that implements MetadataStoreService defined in
 // proto/metadata_store_service.proto. It is thread-safe.
-// Note, concurrent call to methods in different threads are sequential.
-// TODO(b/123039345) Add a connection pool in metadata_store or grpc service.
+// The calls are served by MetadataStores leased from a bounded pool of
+// connections to the metadata source configured by `pool_config`, so that
+// concurrent calls in different threads can run in parallel. The read-only
+// calls are balanced over the read replicas in `read_replica_config`, if any.
+// If `group_commit_config` is given, the concurrent small writes are committed
+// in groups. If `parallel_read_config` is given, the nodes of GetLineageGraph
+// and of the large Get{Artifacts,Executions,Contexts}ByID are read in parallel
+// chunks.
+// The queries of a call are bounded by its deadline, and are interrupted if
+// its client cancels it. If `admission_control_config` is given, the calls
+// exceeding the limits of the calls in flight are rejected with
+// RESOURCE_EXHAUSTED. If `enable_request_coalescing` is true, the identical
+// concurrent calls of the hot point reads, e.g., GetContextByTypeAndName or
+// GetArtifactsByContext, share a single read of the store. If
+// `multi_tenancy_config` is given, the calls naming one of its tenants in
+// their metadata are served by the database of the tenant, with its own pools
+// and group commits, and the other calls by the `connection_config`.
 class MetadataStoreServiceImpl final
     : public MetadataStoreService::Service {
  public:
-  explicit MetadataStoreServiceImpl(const ConnectionConfig& connection_config);
+  explicit MetadataStoreServiceImpl(
+      const ConnectionConfig& connection_config,
+      const MetadataStoreServerConfig::ConnectionPoolConfig& pool_config =
+          MetadataStoreServerConfig::ConnectionPoolConfig(),
+      const MetadataStoreServerConfig::ReadReplicaConfig& read_replica_config =
+          MetadataStoreServerConfig::ReadReplicaConfig(),
+      const absl::optional<MetadataStoreServerConfig::GroupCommitConfig>&
+          group_commit_config = absl::nullopt,
+      const absl::optional<MetadataStoreServerConfig::ParallelReadConfig>&
+          parallel_read_config = absl::nullopt,
+      const absl::optional<MetadataStoreServerConfig::AdmissionControlConfig>&
+          admission_control_config = absl::nullopt,
+      bool enable_request_coalescing = false,
+      const absl::optional<MetadataStoreServerConfig::MultiTenancyConfig>&
+          multi_tenancy_config = absl::nullopt);
 
   // default & copy constructors are disallowed.
   MetadataStoreServiceImpl() = delete;
   MetadataStoreServiceImpl(const MetadataStoreServiceImpl&) = delete;
   MetadataStoreServiceImpl& operator=(const MetadataStoreServiceImpl&) = delete;
 
+  // Opens `min_size` connections of the pools of all the tenants ahead of
+  // serving the calls.
+  // Returns detailed errors, if any connection to a primary fails to open.
+  absl::Status PrefillConnectionPool();
+
+  // Warms up the open connections of the pools of all the tenants, by reading
+  // all the types to their type caches and a node of each kind with each of
+  // them.
+  // Returns detailed errors, if a connection to a primary fails to warm up.
+  absl::Status WarmUpConnectionPool();
+
+  // Records the requests of the calls to `request_recorder`, which is not
+  // owned and must outlast the service, or stops recording them if it is
+  // nullptr. It must be set before the service serves any call.
+  void set_request_recorder(RequestRecorder* request_recorder);
+
+  // Charges the query results of each call to a memory account with the
+  // limits of `budget`, which fails the call once over its hard limit and
+  // truncates the pages of the listing calls to its soft limit. It must be set
+  // before the service serves any call.
+  void set_call_memory_budget(
+      const MetadataStoreServerConfig::CallMemoryBudgetConfig& budget);
+
   ::grpc::Status PutArtifactType(::grpc::ServerContext* context,
                                  const PutArtifactTypeRequest* request,
                                  PutArtifactTypeResponse* response) override;
@@ -123,6 +192,11 @@ class MetadataStoreServiceImpl final
       const GetEventsByExecutionIDsRequest* request,
       GetEventsByExecutionIDsResponse* response) override;
 
+  ::grpc::Status GetEventsByTimeRange(
+      ::grpc::ServerContext* context,
+      const GetEventsByTimeRangeRequest* request,
+      GetEventsByTimeRangeResponse* response) override;
+
   ::grpc::Status GetArtifacts(::grpc::ServerContext* context,
                               const GetArtifactsRequest* request,
                               GetArtifactsResponse* response) override;
@@ -148,6 +222,11 @@ class MetadataStoreServiceImpl final
       ::grpc::ServerContext* context, const GetExecutionsByTypeRequest* request,
       GetExecutionsByTypeResponse* response) override;
 
+  ::grpc::Status GetActiveExecutionsByType(
+      ::grpc::ServerContext* context,
+      const GetActiveExecutionsByTypeRequest* request,
+      GetActiveExecutionsByTypeResponse* response) override;
+
   ::grpc::Status GetExecutionByTypeAndName(
       ::grpc::ServerContext* context,
       const GetExecutionByTypeAndNameRequest* request,
@@ -183,6 +262,22 @@ class MetadataStoreServiceImpl final
       ::grpc::ServerContext* context, const PutParentContextsRequest* request,
       PutParentContextsResponse* response) override;
 
+  ::grpc::Status DeleteArtifacts(::grpc::ServerContext* context,
+                                 const DeleteArtifactsRequest* request,
+                                 DeleteArtifactsResponse* response) override;
+
+  ::grpc::Status DeleteExecutions(::grpc::ServerContext* context,
+                                  const DeleteExecutionsRequest* request,
+                                  DeleteExecutionsResponse* response) override;
+
+  ::grpc::Status ArchiveExecutions(
+      ::grpc::ServerContext* context, const ArchiveExecutionsRequest* request,
+      ArchiveExecutionsResponse* response) override;
+
+  ::grpc::Status ExecuteBatch(::grpc::ServerContext* context,
+                              const BatchRequest* request,
+                              BatchResponse* response) override;
+
   ::grpc::Status GetContextsByArtifact(
       ::grpc::ServerContext* context,
       const GetContextsByArtifactRequest* request,
@@ -193,6 +288,11 @@ class MetadataStoreServiceImpl final
       const GetContextsByExecutionRequest* request,
       GetContextsByExecutionResponse* response) override;
 
+  ::grpc::Status GetExecutionDetails(
+      ::grpc::ServerContext* context,
+      const GetExecutionDetailsRequest* request,
+      GetExecutionDetailsResponse* response) override;
+
   ::grpc::Status GetArtifactsByContext(
       ::grpc::ServerContext* context,
       const GetArtifactsByContextRequest* request,
@@ -203,6 +303,16 @@ class MetadataStoreServiceImpl final
       const GetExecutionsByContextRequest* request,
       GetExecutionsByContextResponse* response) override;
 
+  ::grpc::Status GetArtifactsByContexts(
+      ::grpc::ServerContext* context,
+      const GetArtifactsByContextsRequest* request,
+      GetArtifactsByContextsResponse* response) override;
+
+  ::grpc::Status GetExecutionsByContexts(
+      ::grpc::ServerContext* context,
+      const GetExecutionsByContextsRequest* request,
+      GetExecutionsByContextsResponse* response) override;
+
   ::grpc::Status GetParentContextsByContext(
       ::grpc::ServerContext* context,
       const GetParentContextsByContextRequest* request,
@@ -213,8 +323,160 @@ class MetadataStoreServiceImpl final
       const GetChildrenContextsByContextRequest* request,
       GetChildrenContextsByContextResponse* response) override;
 
+  ::grpc::Status GetAncestorContexts(
+      ::grpc::ServerContext* context, const GetAncestorContextsRequest* request,
+      GetAncestorContextsResponse* response) override;
+
+  ::grpc::Status GetDescendantContexts(
+      ::grpc::ServerContext* context,
+      const GetDescendantContextsRequest* request,
+      GetDescendantContextsResponse* response) override;
+
+  ::grpc::Status StreamArtifacts(
+      ::grpc::ServerContext* context, const GetArtifactsRequest* request,
+      ::grpc::ServerWriter<GetArtifactsResponse>* writer) override;
+
+  ::grpc::Status StreamExecutions(
+      ::grpc::ServerContext* context, const GetExecutionsRequest* request,
+      ::grpc::ServerWriter<GetExecutionsResponse>* writer) override;
+
+  ::grpc::Status StreamArtifactsByType(
+      ::grpc::ServerContext* context, const GetArtifactsByTypeRequest* request,
+      ::grpc::ServerWriter<GetArtifactsByTypeResponse>* writer) override;
+
+  ::grpc::Status GetLineageGraph(::grpc::ServerContext* context,
+                                 const GetLineageGraphRequest* request,
+                                 GetLineageGraphResponse* response) override;
+
+  ::grpc::Status StreamLineageGraph(
+      ::grpc::ServerContext* context, const GetLineageGraphRequest* request,
+      ::grpc::ServerWriter<GetLineageGraphResponse>* writer) override;
+
+  ::grpc::Status GetArtifactsByDerivation(
+      ::grpc::ServerContext* context,
+      const GetArtifactsByDerivationRequest* request,
+      GetArtifactsByDerivationResponse* response) override;
+
+  ::grpc::Status GetChanges(::grpc::ServerContext* context,
+                            const GetChangesRequest* request,
+                            GetChangesResponse* response) override;
+
+  ::grpc::Status CountArtifacts(::grpc::ServerContext* context,
+                               const CountArtifactsRequest* request,
+                               CountArtifactsResponse* response) override;
+
+  ::grpc::Status CountExecutions(::grpc::ServerContext* context,
+                                const CountExecutionsRequest* request,
+                                CountExecutionsResponse* response) override;
+
+  ::grpc::Status CountContexts(::grpc::ServerContext* context,
+                              const CountContextsRequest* request,
+                              CountContextsResponse* response) override;
+
+  ::grpc::Status StreamChanges(
+      ::grpc::ServerContext* context, const GetChangesRequest* request,
+      ::grpc::ServerWriter<GetChangesResponse>* writer) override;
+
  private:
-  const ConnectionConfig connection_config_;
+  // The database served to the calls of a tenant.
+  struct Tenant {
+    Tenant(const std::string& name, const ConnectionConfig& connection_config,
+           const MetadataStoreServerConfig::ConnectionPoolConfig& pool_config,
+           const MetadataStoreServerConfig::ReadReplicaConfig&
+               read_replica_config)
+        : name(name),
+          pool(connection_config, pool_config, read_replica_config) {}
+
+    // Empty for the default tenant.
+    const std::string name;
+    ReplicatedMetadataStorePool pool;
+    // Null if the group commit is disabled.
+    std::unique_ptr<GroupCommitter> group_committer;
+  };
+
+  // Adds the tenant `name` served by the `connection_config`.
+  void AddTenant(
+      const std::string& name, const ConnectionConfig& connection_config,
+      const MetadataStoreServerConfig::ConnectionPoolConfig& pool_config,
+      const MetadataStoreServerConfig::ReadReplicaConfig& read_replica_config,
+      const absl::optional<MetadataStoreServerConfig::GroupCommitConfig>&
+          group_commit_config);
+
+  // Returns the tenant of the call of `context`, i.e., the one named by its
+  // tenant metadata, if any, or else the default one. Returns nullptr if the
+  // named tenant is unknown.
+  Tenant* FindTenant(const ::grpc::ServerContext& context);
+
+  // Same as above, for a call admitted by Admit, whose tenant is known.
+  Tenant& TenantOf(const ::grpc::ServerContext& context);
+
+  // Admits the call `name` of the client of `context`, which stays in flight
+  // until `ticket` is destroyed, if the admission control is enabled. The
+  // `request` of the call is recorded first, if a request recorder is set.
+  // Returns NOT_FOUND error, if the tenant of the call is unknown.
+  // Returns RESOURCE_EXHAUSTED error, if the call exceeds a limit.
+  ::grpc::Status Admit(const char* name, const ::grpc::ServerContext& context,
+                       const google::protobuf::Message& request,
+                       AdmissionController::Ticket* ticket);
+
+  // Runs `write` of a small write call `name` in a group of the group
+  // committer of its tenant, or in its own transaction if the group commit is
+  // disabled or the call has transaction_options.
+  template <typename Request, typename Response>
+  ::grpc::Status CommitWrite(
+      const char* name, ::grpc::ServerContext* context, const Request& request,
+      Response* response,
+      absl::Status (MetadataStore::*write)(const Request&, Response*));
+
+  // Runs `read` of a Get{Artifacts,Executions,Contexts}ByID call `name` with
+  // a single store, or in chunks of the `parallel_reader_` if the parallel
+  // reads are enabled and the ids do not fit in a chunk.
+  template <typename Request, typename Response>
+  ::grpc::Status GetNodesByID(
+      const char* name, ::grpc::ServerContext* context, const Request& request,
+      Response* response,
+      absl::Status (MetadataStore::*read)(const Request&, Response*));
+
+  // Runs `read` of a read-only call `name` with a store of the read pool. If
+  // the request coalescing is enabled, the call shares the read of an
+  // identical call in flight, by `name` and serialized `request`, if any,
+  // unless a write of its tenant has committed since that read started.
+  template <typename Request, typename Response>
+  ::grpc::Status CoalescedRead(
+      const char* name, ::grpc::ServerContext* context, const Request& request,
+      Response* response,
+      absl::Status (MetadataStore::*read)(const Request&, Response*));
+
+  // Reads the nodes of the id-only `subgraph` of GetLineageGraphIds in
+  // parallel chunks of the `parallel_reader_` with the stores of `read_pool`.
+  absl::Status HydrateLineageGraph(MetadataStorePool* read_pool,
+                                   LineageGraph* subgraph);
+
+  // Writes the chunks of `stream` to `writer` as they are fetched.
+  template <typename Response>
+  ::grpc::Status WriteResponseStream(
+      const char* name, ::grpc::ServerContext* context,
+      ResponseStream<Response>* stream,
+      ::grpc::ServerWriter<Response>* writer);
+
+  // The default tenant first.
+  std::vector<std::unique_ptr<Tenant>> tenants_;
+  TenantRouter<Tenant> tenant_router_;
+  std::string tenant_metadata_key_;
+  // Interrupts the queries of the RPCs cancelled by their clients.
+  CancellationWatcher cancellation_watcher_;
+  // Null if the parallel reads are disabled.
+  std::unique_ptr<ParallelReader> parallel_reader_;
+  // Null if the request coalescing is disabled.
+  std::unique_ptr<RequestCoalescer> request_coalescer_;
+  // Null if the admission control is disabled.
+  std::unique_ptr<AdmissionController> admission_controller_;
+  std::string client_id_metadata_key_;
+  // Null if the requests are not recorded.
+  RequestRecorder* request_recorder_ = nullptr;
+  // Unset if the memory of the calls is not accounted.
+  absl::optional<MetadataStoreServerConfig::CallMemoryBudgetConfig>
+      call_memory_budget_;
 };
 
 }  // namespace ml_metadata
@@ -44,6 +44,9 @@ class MetadataStoreServiceInterface {
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(PutContexts)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(PutAttributionsAndAssociations)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(PutParentContexts)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(DeleteArtifacts)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(DeleteExecutions)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(ArchiveExecutions)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactType)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactTypesByID)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactTypes)
@@ -62,20 +65,33 @@ class MetadataStoreServiceInterface {
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactsByType)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactByTypeAndName)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetExecutionsByType)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetActiveExecutionsByType)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetExecutionByTypeAndName)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetContextsByType)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetContextByTypeAndName)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactsByURI)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetEventsByExecutionIDs)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetEventsByArtifactIDs)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetEventsByTimeRange)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetContextsByArtifact)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetContextsByExecution)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetExecutionDetails)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetParentContextsByContext)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetChildrenContextsByContext)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetAncestorContexts)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetDescendantContexts)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactsByContext)
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetExecutionsByContext)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactsByContexts)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetExecutionsByContexts)
   // The method is used for accessing MLMD lineage.
   METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetLineageGraph)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetArtifactsByDerivation)
+  // The method is used for following the changes of the nodes and the events.
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(GetChanges)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(CountArtifacts)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(CountExecutions)
+  METADATA_STORE_SERVICE_INTERFACE_DECLARE(CountContexts)
 
 #undef METADATA_STORE_SERVICE_INTERFACE_DECLARE
 };
@@ -24,6 +24,8 @@ limitations under the License.
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/lineage_result_cache.h"
+#include "ml_metadata/metadata_store/lookup_cache.h"
 #include "ml_metadata/metadata_store/metadata_store_test_suite.h"
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
 #include "ml_metadata/metadata_store/test_util.h"
@@ -35,6 +37,8 @@ namespace ml_metadata {
 namespace testing {
 namespace {
 
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
 using ::testing::SizeIs;
 using ::testing::UnorderedElementsAreArray;
 using ::testing::UnorderedPointwise;
@@ -286,6 +290,236 @@ TEST(MetadataStoreExtendedTest, GetLineageGraphWithMaxHops) {
       /*want_events=*/{{4, 2}, {4, 3}, {2, 2}, {3, 3}, {5, 3}, {3, 1}, {1, 1}});
 }
 
+// Test GetLineageGraphIds returns the subgraph of GetLineageGraph with the
+// traversed nodes having only their ids.
+TEST(MetadataStoreExtendedTest, GetLineageGraphIds) {
+  std::unique_ptr<MetadataStore> metadata_store = CreateMetadataStore();
+  int64 min_creation_time;
+  std::vector<Artifact> want_artifacts;
+  std::vector<Execution> want_executions;
+  ASSERT_EQ(absl::OkStatus(),
+            CreateLineageGraph(*metadata_store, min_creation_time,
+                               want_artifacts, want_executions));
+  GetLineageGraphRequest req;
+  req.mutable_options()->mutable_artifacts_options()->set_filter_query(
+      "uri = 'uri://foo/a4'");
+  GetLineageGraphResponse resp;
+  ASSERT_EQ(absl::OkStatus(), metadata_store->GetLineageGraph(req, &resp));
+  GetLineageGraphResponse ids_resp;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->GetLineageGraphIds(req, &ids_resp));
+
+  std::vector<int64> want_artifact_ids;
+  for (const Artifact& artifact : resp.subgraph().artifacts()) {
+    want_artifact_ids.push_back(artifact.id());
+  }
+  std::vector<int64> got_artifact_ids;
+  for (const Artifact& artifact : ids_resp.subgraph().artifacts()) {
+    got_artifact_ids.push_back(artifact.id());
+    // Only the query nodes are read.
+    EXPECT_EQ(artifact.has_type_id(), artifact.uri() == "uri://foo/a4");
+  }
+  EXPECT_THAT(got_artifact_ids, UnorderedElementsAreArray(want_artifact_ids));
+  std::vector<int64> want_execution_ids;
+  for (const Execution& execution : resp.subgraph().executions()) {
+    want_execution_ids.push_back(execution.id());
+  }
+  std::vector<int64> got_execution_ids;
+  for (const Execution& execution : ids_resp.subgraph().executions()) {
+    got_execution_ids.push_back(execution.id());
+    EXPECT_FALSE(execution.has_type_id());
+  }
+  EXPECT_THAT(got_execution_ids, UnorderedElementsAreArray(want_execution_ids));
+  EXPECT_THAT(ids_resp.subgraph().events(),
+              SizeIs(resp.subgraph().events_size()));
+}
+
+// Test GetArtifactsByDerivation on the lineage graph created with
+// `CreateLineageGraph`, where e1: a1 -> a3, e2: a2 -> a4 and e3: a3, a4 -> a5.
+TEST(MetadataStoreExtendedTest, GetArtifactsByDerivation) {
+  std::unique_ptr<MetadataStore> metadata_store = CreateMetadataStore();
+  int64 min_creation_time;
+  std::vector<Artifact> want_artifacts;
+  std::vector<Execution> want_executions;
+  ASSERT_EQ(absl::OkStatus(),
+            CreateLineageGraph(*metadata_store, min_creation_time,
+                               want_artifacts, want_executions));
+  // The database ids of the artifacts and executions start from 1.
+  auto get_artifact_ids =
+      [&metadata_store](const int64 artifact_id,
+                        const GetArtifactsByDerivationRequest::Direction
+                            direction,
+                        const absl::optional<int64> max_num_hops,
+                        const absl::optional<int64> context_id) {
+        GetArtifactsByDerivationRequest req;
+        req.add_artifact_ids(artifact_id);
+        req.set_direction(direction);
+        if (max_num_hops) {
+          req.set_max_num_hops(*max_num_hops);
+        }
+        if (context_id) {
+          req.set_context_id(*context_id);
+        }
+        GetArtifactsByDerivationResponse resp;
+        CHECK_EQ(absl::OkStatus(),
+                 metadata_store->GetArtifactsByDerivation(req, &resp));
+        std::vector<int64> ids;
+        for (const Artifact& artifact : resp.artifacts()) {
+          ids.push_back(artifact.id());
+        }
+        return ids;
+      };
+  EXPECT_THAT(get_artifact_ids(6, GetArtifactsByDerivationRequest::UPSTREAM,
+                               absl::nullopt, absl::nullopt),
+              ElementsAre(4, 5, 2, 3));
+  EXPECT_THAT(get_artifact_ids(6, GetArtifactsByDerivationRequest::UPSTREAM,
+                               /*max_num_hops=*/1, absl::nullopt),
+              ElementsAre(4, 5));
+  EXPECT_THAT(get_artifact_ids(2, GetArtifactsByDerivationRequest::DOWNSTREAM,
+                               absl::nullopt, absl::nullopt),
+              ElementsAre(4, 6));
+  EXPECT_THAT(get_artifact_ids(1, GetArtifactsByDerivationRequest::DOWNSTREAM,
+                               absl::nullopt, absl::nullopt),
+              IsEmpty());
+
+  // Only follows e3 when scoped to a context of e3.
+  GetContextTypeRequest get_context_type_req;
+  get_context_type_req.set_type_name("t3");
+  GetContextTypeResponse get_context_type_resp;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->GetContextType(get_context_type_req,
+                                           &get_context_type_resp));
+  PutContextsRequest put_contexts_req;
+  Context* context = put_contexts_req.add_contexts();
+  context->set_type_id(get_context_type_resp.context_type().id());
+  context->set_name("c1");
+  PutContextsResponse put_contexts_resp;
+  ASSERT_EQ(absl::OkStatus(), metadata_store->PutContexts(put_contexts_req,
+                                                          &put_contexts_resp));
+  PutAttributionsAndAssociationsRequest put_associations_req;
+  Association* association = put_associations_req.add_associations();
+  association->set_execution_id(4);
+  association->set_context_id(put_contexts_resp.context_ids(0));
+  PutAttributionsAndAssociationsResponse put_associations_resp;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->PutAttributionsAndAssociations(
+                put_associations_req, &put_associations_resp));
+  EXPECT_THAT(get_artifact_ids(6, GetArtifactsByDerivationRequest::UPSTREAM,
+                               absl::nullopt, put_contexts_resp.context_ids(0)),
+              ElementsAre(4, 5));
+
+  // The derivations of the deleted artifacts are deleted.
+  DeleteArtifactsRequest delete_req;
+  delete_req.add_artifact_ids(4);
+  DeleteArtifactsResponse delete_resp;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->DeleteArtifacts(delete_req, &delete_resp));
+  EXPECT_THAT(get_artifact_ids(6, GetArtifactsByDerivationRequest::UPSTREAM,
+                               absl::nullopt, absl::nullopt),
+              ElementsAre(5, 3));
+
+  GetArtifactsByDerivationRequest invalid_req;
+  invalid_req.add_artifact_ids(6);
+  GetArtifactsByDerivationResponse invalid_resp;
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_store->GetArtifactsByDerivation(invalid_req, &invalid_resp)));
+}
+
+// Test GetChanges on the change log of the puts and deletions of the nodes and
+// the events, read in pages.
+TEST(MetadataStoreExtendedTest, GetChanges) {
+  std::unique_ptr<MetadataStore> metadata_store = CreateMetadataStore();
+  PutTypesResponse put_types_resp;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->PutTypes(ParseTextProtoOrDie<PutTypesRequest>(R"(
+              artifact_types: { name: 'artifact_type' }
+              execution_types: { name: 'execution_type' }
+            )"),
+                                     &put_types_resp));
+  PutArtifactsRequest put_artifacts_req;
+  Artifact* artifact = put_artifacts_req.add_artifacts();
+  artifact->set_type_id(put_types_resp.artifact_type_ids(0));
+  artifact->set_uri("uri://a");
+  PutArtifactsResponse put_artifacts_resp;
+  ASSERT_EQ(absl::OkStatus(), metadata_store->PutArtifacts(
+                                  put_artifacts_req, &put_artifacts_resp));
+  artifact->set_id(put_artifacts_resp.artifact_ids(0));
+  artifact->set_uri("uri://b");
+  ASSERT_EQ(absl::OkStatus(), metadata_store->PutArtifacts(
+                                  put_artifacts_req, &put_artifacts_resp));
+  PutExecutionsRequest put_executions_req;
+  put_executions_req.add_executions()->set_type_id(
+      put_types_resp.execution_type_ids(0));
+  PutExecutionsResponse put_executions_resp;
+  ASSERT_EQ(absl::OkStatus(), metadata_store->PutExecutions(
+                                  put_executions_req, &put_executions_resp));
+  PutEventsRequest put_events_req;
+  Event* event = put_events_req.add_events();
+  event->set_artifact_id(artifact->id());
+  event->set_execution_id(put_executions_resp.execution_ids(0));
+  event->set_type(Event::OUTPUT);
+  PutEventsResponse put_events_resp;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->PutEvents(put_events_req, &put_events_resp));
+  DeleteArtifactsRequest delete_req;
+  delete_req.add_artifact_ids(artifact->id());
+  DeleteArtifactsResponse delete_resp;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->DeleteArtifacts(delete_req, &delete_resp));
+
+  // Reads the change log in pages of 3 entries from the start.
+  std::vector<ChangeLogEntry> entries;
+  GetChangesRequest req;
+  req.set_max_result_size(3);
+  GetChangesResponse resp;
+  ASSERT_EQ(absl::OkStatus(), metadata_store->GetChanges(req, &resp));
+  EXPECT_THAT(resp.entries(), SizeIs(3));
+  EXPECT_EQ(resp.last_sequence_number(), 3);
+  entries.insert(entries.end(), resp.entries().begin(), resp.entries().end());
+  req.set_after_sequence_number(resp.last_sequence_number());
+  ASSERT_EQ(absl::OkStatus(), metadata_store->GetChanges(req, &resp));
+  EXPECT_THAT(resp.entries(), SizeIs(2));
+  EXPECT_EQ(resp.last_sequence_number(), 5);
+  entries.insert(entries.end(), resp.entries().begin(), resp.entries().end());
+  // The resume token is kept at the end of the log.
+  req.set_after_sequence_number(resp.last_sequence_number());
+  ASSERT_EQ(absl::OkStatus(), metadata_store->GetChanges(req, &resp));
+  EXPECT_THAT(resp.entries(), IsEmpty());
+  EXPECT_EQ(resp.last_sequence_number(), 5);
+
+  for (ChangeLogEntry& entry : entries) {
+    EXPECT_GT(entry.milliseconds_since_epoch(), 0);
+    entry.clear_milliseconds_since_epoch();
+  }
+  EXPECT_THAT(
+      entries,
+      ElementsAre(EqualsProto(ParseTextProtoOrDie<ChangeLogEntry>(R"(
+                    sequence_number: 1 kind: ARTIFACT operation: CREATED
+                    artifact_id: 1
+                  )")),
+                  EqualsProto(ParseTextProtoOrDie<ChangeLogEntry>(R"(
+                    sequence_number: 2 kind: ARTIFACT operation: UPDATED
+                    artifact_id: 1
+                  )")),
+                  EqualsProto(ParseTextProtoOrDie<ChangeLogEntry>(R"(
+                    sequence_number: 3 kind: EXECUTION operation: CREATED
+                    execution_id: 1
+                  )")),
+                  EqualsProto(ParseTextProtoOrDie<ChangeLogEntry>(R"(
+                    sequence_number: 4 kind: EVENT operation: CREATED
+                    artifact_id: 1 execution_id: 1
+                  )")),
+                  EqualsProto(ParseTextProtoOrDie<ChangeLogEntry>(R"(
+                    sequence_number: 5 kind: ARTIFACT operation: DELETED
+                    artifact_id: 1
+                  )"))));
+
+  GetChangesRequest invalid_req;
+  invalid_req.set_after_sequence_number(-1);
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_store->GetChanges(invalid_req, &resp)));
+}
+
 // Test valid query options when using GetLineageGraph on the lineage graph
 // created with `CreateLineageGraph`.
 TEST(MetadataStoreExtendedTest, GetLineageGraphWithMaxNodeSize) {
@@ -533,6 +767,196 @@ TEST(MetadataStoreExtendedTest, GetLineageGraphErrors) {
   }
 }
 
+TEST(MetadataStoreExtendedTest, LookupCache) {
+  std::unique_ptr<MetadataStore> metadata_store = CreateMetadataStore();
+  auto lookup_cache = std::make_shared<LookupCache>(LookupCache::Config());
+  metadata_store->set_lookup_cache(lookup_cache);
+  PutContextTypeRequest put_type_req;
+  put_type_req.set_all_fields_match(true);
+  put_type_req.mutable_context_type()->set_name("context_type");
+  PutContextTypeResponse put_type_resp;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->PutContextType(put_type_req, &put_type_resp));
+
+  // The lookups finding nothing are cached.
+  GetContextByTypeAndNameRequest get_context_req;
+  get_context_req.set_type_name("context_type");
+  get_context_req.set_context_name("context");
+  GetContextByTypeAndNameResponse get_context_resp;
+  ASSERT_EQ(absl::OkStatus(), metadata_store->GetContextByTypeAndName(
+                                  get_context_req, &get_context_resp));
+  EXPECT_FALSE(get_context_resp.has_context());
+  GetExecutionTypeRequest get_type_req;
+  get_type_req.set_type_name("execution_type");
+  GetExecutionTypeResponse get_type_resp;
+  EXPECT_TRUE(absl::IsNotFound(
+      metadata_store->GetExecutionType(get_type_req, &get_type_resp)));
+  EXPECT_EQ(lookup_cache->size(), 2);
+
+  // The writes of the store invalidate the lookups they make stale.
+  PutContextsRequest put_contexts_req;
+  Context* context = put_contexts_req.add_contexts();
+  context->set_type_id(put_type_resp.type_id());
+  context->set_name("context");
+  PutContextsResponse put_contexts_resp;
+  ASSERT_EQ(absl::OkStatus(), metadata_store->PutContexts(
+                                  put_contexts_req, &put_contexts_resp));
+  EXPECT_EQ(lookup_cache->size(), 1);
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(absl::OkStatus(), metadata_store->GetContextByTypeAndName(
+                                    get_context_req, &get_context_resp));
+    EXPECT_EQ(get_context_resp.context().id(),
+              put_contexts_resp.context_ids(0));
+  }
+
+  // The calls in a transaction bypass the cache, and their writes invalidate
+  // it once the transaction ends.
+  ASSERT_EQ(absl::OkStatus(), metadata_store->RunInTransaction(
+                                  [&]() -> absl::Status {
+                                    PutExecutionTypeRequest request;
+                                    request.set_all_fields_match(true);
+                                    request.mutable_execution_type()->set_name(
+                                        "execution_type");
+                                    PutExecutionTypeResponse response;
+                                    MLMD_RETURN_IF_ERROR(
+                                        metadata_store->PutExecutionType(
+                                            request, &response));
+                                    return metadata_store->GetExecutionType(
+                                        get_type_req, &get_type_resp);
+                                  }));
+  EXPECT_EQ(get_type_resp.execution_type().name(), "execution_type");
+  EXPECT_EQ(lookup_cache->size(), 0);
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->GetExecutionType(get_type_req, &get_type_resp));
+  EXPECT_EQ(get_type_resp.execution_type().name(), "execution_type");
+}
+
+TEST(MetadataStoreExtendedTest, LineageResultCache) {
+  std::unique_ptr<MetadataStore> metadata_store = CreateMetadataStore();
+  auto lineage_result_cache =
+      std::make_shared<LineageResultCache>(LineageResultCache::Config());
+  metadata_store->set_lineage_result_cache(lineage_result_cache);
+  int64 min_creation_time;
+  std::vector<Artifact> want_artifacts;
+  std::vector<Execution> want_executions;
+  ASSERT_EQ(absl::OkStatus(),
+            CreateLineageGraph(*metadata_store, min_creation_time,
+                               want_artifacts, want_executions));
+
+  // The traversals of the same normalized options share their result.
+  GetLineageGraphRequest get_lineage_req =
+      ParseTextProtoOrDie<GetLineageGraphRequest>(R"(
+        options {
+          artifacts_options { filter_query: "uri = 'uri://foo/a4'" }
+          stop_conditions { max_num_hops: 1 }
+        }
+      )");
+  GetLineageGraphResponse get_lineage_resp;
+  ASSERT_EQ(absl::OkStatus(), metadata_store->GetLineageGraph(
+                                  get_lineage_req, &get_lineage_resp));
+  EXPECT_THAT(get_lineage_resp.subgraph().executions(), SizeIs(2));
+  get_lineage_req.mutable_options()->set_max_node_size(0);
+  ASSERT_EQ(absl::OkStatus(), metadata_store->GetLineageGraph(
+                                  get_lineage_req, &get_lineage_resp));
+  EXPECT_THAT(get_lineage_resp.subgraph().executions(), SizeIs(2));
+  EXPECT_EQ(lineage_result_cache->size(), 1);
+
+  // The writes of events advance the watermark of the cached result.
+  PutExecutionRequest put_execution_req;
+  put_execution_req.mutable_execution()->set_type_id(
+      want_executions[0].type_id());
+  Event* event =
+      put_execution_req.add_artifact_event_pairs()->mutable_event();
+  event->set_artifact_id(want_artifacts[4].id());
+  event->set_type(Event::INPUT);
+  PutExecutionResponse put_execution_resp;
+  ASSERT_EQ(absl::OkStatus(), metadata_store->PutExecution(
+                                  put_execution_req, &put_execution_resp));
+  ASSERT_EQ(absl::OkStatus(), metadata_store->GetLineageGraph(
+                                  get_lineage_req, &get_lineage_resp));
+  EXPECT_THAT(get_lineage_resp.subgraph().executions(), SizeIs(3));
+}
+
+TEST(MetadataStoreExtendedTest, CompressedPropertyValues) {
+  std::unique_ptr<MetadataStore> metadata_store = CreateMetadataStore();
+  metadata_store->set_property_value_compression(
+      ParseTextProtoOrDie<PropertyValueCompressionConfig>(
+          "min_value_size: 1024"));
+  PutExecutionTypeRequest put_type_req;
+  put_type_req.mutable_execution_type()->set_name("trainer");
+  (*put_type_req.mutable_execution_type()->mutable_properties())["config"] =
+      STRING;
+  PutExecutionTypeResponse put_type_resp;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->PutExecutionType(put_type_req, &put_type_resp));
+
+  const std::string large_config(4096, 'c');
+  PutExecutionsRequest put_executions_req;
+  Execution* execution = put_executions_req.add_executions();
+  execution->set_type_id(put_type_resp.type_id());
+  (*execution->mutable_properties())["config"].set_string_value(large_config);
+  (*(*execution->mutable_custom_properties())["payload"]
+        .mutable_struct_value()
+        ->mutable_fields())["data"]
+      .set_string_value(large_config);
+  (*execution->mutable_custom_properties())["run"].set_string_value("r1");
+  PutExecutionsResponse put_executions_resp;
+  ASSERT_EQ(absl::OkStatus(), metadata_store->PutExecutions(
+                                  put_executions_req, &put_executions_resp));
+  execution->set_id(put_executions_resp.execution_ids(0));
+
+  // The compressed values are read back, but cannot be filtered on.
+  GetExecutionsByIDRequest get_req;
+  get_req.add_execution_ids(execution->id());
+  GetExecutionsByIDResponse get_resp;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->GetExecutionsByID(get_req, &get_resp));
+  ASSERT_THAT(get_resp.executions(), SizeIs(1));
+  EXPECT_THAT(get_resp.executions(0),
+              EqualsProto(*execution,
+                          /*ignore_fields=*/{"type", "create_time_since_epoch",
+                                             "last_update_time_since_epoch"}));
+  GetExecutionsRequest list_req;
+  list_req.mutable_options()->set_filter_query(
+      "custom_properties.run.string_value = 'r1'");
+  GetExecutionsResponse list_resp;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->GetExecutions(list_req, &list_resp));
+  EXPECT_THAT(list_resp.executions(), SizeIs(1));
+  for (const char* filter_query :
+       {"properties.config.string_value IS NULL",
+        "properties.config.string_value = 'c'",
+        "custom_properties.run.string_value = 'r1' AND "
+        "custom_properties.payload.string_value IS NOT NULL"}) {
+    SCOPED_TRACE(filter_query);
+    list_req.mutable_options()->set_filter_query(filter_query);
+    EXPECT_TRUE(absl::IsFailedPrecondition(
+        metadata_store->GetExecutions(list_req, &list_resp)));
+  }
+
+  // The updates replace the compressed values, and compress the large ones.
+  (*execution->mutable_properties())["config"].set_string_value("small");
+  (*execution->mutable_custom_properties())["run"].set_string_value(
+      large_config);
+  ASSERT_EQ(absl::OkStatus(), metadata_store->PutExecutions(
+                                  put_executions_req, &put_executions_resp));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->GetExecutionsByID(get_req, &get_resp));
+  EXPECT_THAT(get_resp.executions(0),
+              EqualsProto(*execution,
+                          /*ignore_fields=*/{"type", "create_time_since_epoch",
+                                             "last_update_time_since_epoch"}));
+  list_req.mutable_options()->set_filter_query(
+      "properties.config.string_value = 'small'");
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->GetExecutions(list_req, &list_resp));
+  EXPECT_THAT(list_resp.executions(), SizeIs(1));
+  list_req.mutable_options()->set_filter_query(
+      "custom_properties.run.string_value = 'r1'");
+  EXPECT_TRUE(absl::IsFailedPrecondition(
+      metadata_store->GetExecutions(list_req, &list_resp)));
+}
+
 }  // namespace
 
 INSTANTIATE_TEST_SUITE_P(
@@ -22,6 +22,7 @@ import (
 	"github.com/google/go-cmp/cmp"
 	"github.com/golang/protobuf/proto"
 	mdpb "ml_metadata/proto/metadata_store_go_proto"
+	apipb "ml_metadata/proto/metadata_store_service_go_proto"
 )
 
 func createConnectionConfig(textConfig string) *mdpb.ConnectionConfig {
@@ -1539,3 +1540,65 @@ func TestPutDuplicatedAttributionsAndEmptyAssociations(t *testing.T) {
 		t.Errorf("GetArtifactsByContext returned result is incorrect. want: %v, got: %v", wantArtifact, gotArtifacts[0])
 	}
 }
+
+func TestExecuteBatch(t *testing.T) {
+	store, err := NewStore(fakeDatabaseConfig())
+	if err != nil {
+		t.Fatalf("Cannot create Store: %v", err)
+	}
+	defer store.Close()
+
+	wantType := &mdpb.ArtifactType{Name: proto.String("test_type")}
+	putTypeResp := &apipb.PutArtifactTypeResponse{}
+	getTypesResp := &apipb.GetArtifactTypesResponse{}
+	calls := []*BatchCall{
+		{
+			Method:   "PutArtifactType",
+			Request:  &apipb.PutArtifactTypeRequest{ArtifactType: wantType},
+			Response: putTypeResp,
+		},
+		{
+			Method:   "GetArtifactTypes",
+			Request:  &apipb.GetArtifactTypesRequest{},
+			Response: getTypesResp,
+		},
+		{
+			Method:   "UnknownMethod",
+			Request:  &apipb.GetArtifactTypesRequest{},
+			Response: &apipb.GetArtifactTypesResponse{},
+		},
+	}
+	if err := store.ExecuteBatch(calls, false); err != nil {
+		t.Fatalf("ExecuteBatch failed: %v", err)
+	}
+	if calls[0].Err != nil || calls[1].Err != nil {
+		t.Fatalf("ExecuteBatch calls failed: %v, %v", calls[0].Err, calls[1].Err)
+	}
+	if calls[2].Err == nil {
+		t.Errorf("ExecuteBatch call of an unknown method should fail")
+	}
+	wantType.Id = proto.Int64(putTypeResp.GetTypeId())
+	if len(getTypesResp.GetArtifactTypes()) != 1 || !proto.Equal(wantType, getTypesResp.GetArtifactTypes()[0]) {
+		t.Errorf("ExecuteBatch put and get type mismatch, want: %v, got: %v", wantType, getTypesResp.GetArtifactTypes())
+	}
+
+	// a failing call rolls back the calls of a single transaction batch.
+	calls = []*BatchCall{
+		{
+			Method:   "PutArtifactType",
+			Request:  &apipb.PutArtifactTypeRequest{ArtifactType: &mdpb.ArtifactType{Name: proto.String("rolled_back_type")}},
+			Response: &apipb.PutArtifactTypeResponse{},
+		},
+		{
+			Method:   "PutArtifactType",
+			Request:  &apipb.PutArtifactTypeRequest{},
+			Response: &apipb.PutArtifactTypeResponse{},
+		},
+	}
+	if err := store.ExecuteBatch(calls, true); err == nil {
+		t.Errorf("ExecuteBatch in a single transaction should fail")
+	}
+	if _, err := store.GetArtifactType("rolled_back_type"); err == nil {
+		t.Errorf("ExecuteBatch in a single transaction should roll back all calls")
+	}
+}
@@ -26,6 +26,9 @@ limitations under the License.
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/call_memory_account.h"
 #include "ml_metadata/metadata_store/constants.h"
 #include "ml_metadata/metadata_store/test_util.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
@@ -37,6 +40,7 @@ namespace {
 using ::ml_metadata::testing::EqualsProto;
 using ::ml_metadata::testing::ParseTextProtoOrDie;
 using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
 using ::testing::IsEmpty;
 using ::testing::Pointwise;
 using ::testing::SizeIs;
@@ -1560,6 +1564,338 @@ TEST_P(MetadataStoreTestSuite, PutArtifactsGetArtifactsWithListOptions) {
                                              "last_update_time_since_epoch"}));
 }
 
+TEST_P(MetadataStoreTestSuite, PutArtifactsGetArtifactsWithBulkExport) {
+  PutArtifactTypeRequest put_type_request;
+  put_type_request.mutable_artifact_type()->set_name("test_type");
+  PutArtifactTypeResponse put_type_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->PutArtifactType(
+                                  put_type_request, &put_type_response));
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 150; i++) {
+    put_artifacts_request.add_artifacts()->set_type_id(
+        put_type_response.type_id());
+  }
+  PutArtifactsResponse put_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutArtifacts(put_artifacts_request,
+                                          &put_artifacts_response));
+
+  // The bulk export lists pages over the upper-bound of 100.
+  GetArtifactsRequest get_artifacts_request =
+      ParseTextProtoOrDie<GetArtifactsRequest>(R"pb(
+        options {
+          max_result_size: 120
+          order_by_field: { field: ID is_asc: true }
+          bulk_export: true
+        }
+      )pb");
+  GetArtifactsResponse get_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetArtifacts(get_artifacts_request,
+                                          &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(120));
+  EXPECT_EQ(get_artifacts_response.artifacts(0).id(),
+            put_artifacts_response.artifact_ids(0));
+  ASSERT_THAT(get_artifacts_response.next_page_token(), Not(IsEmpty()));
+  const std::string next_page_token = get_artifacts_response.next_page_token();
+
+  get_artifacts_request.mutable_options()->set_next_page_token(
+      next_page_token);
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetArtifacts(get_artifacts_request,
+                                          &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(30));
+  EXPECT_EQ(get_artifacts_response.artifacts(0).id(),
+            put_artifacts_response.artifact_ids(120));
+  EXPECT_THAT(get_artifacts_response.next_page_token(), IsEmpty());
+
+  // The bulk export tokens cannot be used without the bulk export mode.
+  get_artifacts_request.mutable_options()->set_bulk_export(false);
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_store_->GetArtifacts(
+      get_artifacts_request, &get_artifacts_response)));
+
+  // The bulk export does not support LAST_UPDATE_TIME ordering.
+  get_artifacts_request = ParseTextProtoOrDie<GetArtifactsRequest>(R"pb(
+    options {
+      max_result_size: 120
+      order_by_field: { field: LAST_UPDATE_TIME is_asc: true }
+      bulk_export: true
+    }
+  )pb");
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_store_->GetArtifacts(
+      get_artifacts_request, &get_artifacts_response)));
+}
+
+TEST_P(MetadataStoreTestSuite, GetArtifactsWithCallMemoryAccount) {
+  PutArtifactTypeRequest put_type_request;
+  put_type_request.mutable_artifact_type()->set_name("test_type");
+  PutArtifactTypeResponse put_type_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->PutArtifactType(
+                                  put_type_request, &put_type_response));
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 10; i++) {
+    Artifact* artifact = put_artifacts_request.add_artifacts();
+    artifact->set_type_id(put_type_response.type_id());
+    artifact->set_uri(absl::StrCat("/data/", std::string(100, 'x'), i));
+  }
+  PutArtifactsResponse put_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutArtifacts(put_artifacts_request,
+                                          &put_artifacts_response));
+
+  // The pages are truncated to the soft limit, and continue from the last
+  // artifact of the truncated page.
+  CallMemoryAccount soft_limit_account(/*soft_limit_bytes=*/400,
+                                       /*hard_limit_bytes=*/0);
+  metadata_store_->set_memory_account(&soft_limit_account);
+  GetArtifactsRequest get_artifacts_request =
+      ParseTextProtoOrDie<GetArtifactsRequest>(R"pb(
+        options {
+          max_result_size: 100
+          order_by_field: { field: ID is_asc: true }
+        }
+      )pb");
+  std::vector<int64> listed_ids;
+  int num_pages = 0;
+  do {
+    GetArtifactsResponse get_artifacts_response;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_store_->GetArtifacts(get_artifacts_request,
+                                            &get_artifacts_response));
+    // Each artifact has over 100 bytes.
+    ASSERT_THAT(get_artifacts_response.artifacts(), Not(IsEmpty()));
+    EXPECT_LE(get_artifacts_response.artifacts_size(), 3);
+    for (const Artifact& artifact : get_artifacts_response.artifacts()) {
+      listed_ids.push_back(artifact.id());
+    }
+    get_artifacts_request.mutable_options()->set_next_page_token(
+        get_artifacts_response.next_page_token());
+    num_pages++;
+  } while (!get_artifacts_request.options().next_page_token().empty());
+  EXPECT_GT(num_pages, 1);
+  EXPECT_THAT(listed_ids,
+              ElementsAreArray(put_artifacts_response.artifact_ids()));
+  EXPECT_GT(soft_limit_account.charged_bytes(), 1000);
+
+  // The call fails once its queries read over the hard limit.
+  CallMemoryAccount hard_limit_account(/*soft_limit_bytes=*/0,
+                                       /*hard_limit_bytes=*/500);
+  metadata_store_->set_memory_account(&hard_limit_account);
+  GetArtifactsResponse get_artifacts_response;
+  EXPECT_TRUE(absl::IsResourceExhausted(metadata_store_->GetArtifacts(
+      GetArtifactsRequest(), &get_artifacts_response)));
+  EXPECT_TRUE(hard_limit_account.hard_limit_exceeded());
+  metadata_store_->set_memory_account(nullptr);
+}
+
+TEST_P(MetadataStoreTestSuite, ExecuteBatchWithIdReferences) {
+  PutTypesResponse put_types_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutTypes(ParseTextProtoOrDie<PutTypesRequest>(R"pb(
+                                        execution_types: { name: 'trainer' }
+                                        context_types: { name: 'pipeline' }
+                                      )pb"),
+                                      &put_types_response));
+  // Puts a context and an execution, and associates them by the ids returned
+  // by the earlier calls.
+  BatchRequest batch_request;
+  batch_request.set_single_transaction(true);
+  BatchRequest::Call* put_contexts = batch_request.add_calls();
+  put_contexts->set_method("PutContexts");
+  put_contexts->set_request(
+      ParseTextProtoOrDie<PutContextsRequest>(
+          absl::Substitute("contexts { type_id: $0 name: 'my_pipeline' }",
+                           put_types_response.context_type_ids(0)))
+          .SerializeAsString());
+  BatchRequest::Call* put_execution = batch_request.add_calls();
+  put_execution->set_method("PutExecution");
+  put_execution->set_request(
+      ParseTextProtoOrDie<PutExecutionRequest>(
+          absl::Substitute("execution { type_id: $0 }",
+                           put_types_response.execution_type_ids(0)))
+          .SerializeAsString());
+  BatchRequest::Call* associate = batch_request.add_calls();
+  associate->set_method("PutAttributionsAndAssociations");
+  *associate->add_id_references() =
+      ParseTextProtoOrDie<BatchRequest::Call::IdReference>(R"pb(
+        call_index: 0
+        response_path: 'context_ids[0]'
+        request_path: 'associations[0].context_id'
+      )pb");
+  *associate->add_id_references() =
+      ParseTextProtoOrDie<BatchRequest::Call::IdReference>(R"pb(
+        call_index: 1
+        response_path: 'execution_id'
+        request_path: 'associations[0].execution_id'
+      )pb");
+  BatchResponse batch_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->ExecuteBatch(batch_request, &batch_response));
+  ASSERT_THAT(batch_response.results(), SizeIs(3));
+  PutContextsResponse put_contexts_response;
+  ASSERT_TRUE(put_contexts_response.ParseFromString(
+      batch_response.results(0).response()));
+  PutExecutionResponse put_execution_response;
+  ASSERT_TRUE(put_execution_response.ParseFromString(
+      batch_response.results(1).response()));
+
+  GetExecutionsByContextRequest get_executions_request;
+  get_executions_request.set_context_id(put_contexts_response.context_ids(0));
+  GetExecutionsByContextResponse get_executions_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetExecutionsByContext(get_executions_request,
+                                                    &get_executions_response));
+  ASSERT_THAT(get_executions_response.executions(), SizeIs(1));
+  EXPECT_EQ(get_executions_response.executions(0).id(),
+            put_execution_response.execution_id());
+
+  // A failed call, e.g., of a context without a name, rolls back the batch in
+  // a single transaction, and fails the calls referencing it otherwise.
+  batch_request.mutable_calls(0)->set_request(
+      ParseTextProtoOrDie<PutContextsRequest>(
+          absl::Substitute("contexts { type_id: $0 }",
+                           put_types_response.context_type_ids(0)))
+          .SerializeAsString());
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_store_->ExecuteBatch(batch_request, &batch_response)));
+  GetExecutionsResponse get_all_executions_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetExecutions(GetExecutionsRequest(),
+                                           &get_all_executions_response));
+  EXPECT_THAT(get_all_executions_response.executions(), SizeIs(1));
+
+  batch_request.set_single_transaction(false);
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->ExecuteBatch(batch_request, &batch_response));
+  ASSERT_THAT(batch_response.results(), SizeIs(3));
+  EXPECT_NE(batch_response.results(0).error_code(), 0);
+  EXPECT_EQ(batch_response.results(1).error_code(), 0);
+  EXPECT_EQ(batch_response.results(2).error_code(),
+            static_cast<int>(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST_P(MetadataStoreTestSuite, PutArtifactsGetArtifactsWithPropertyProjection) {
+  PutArtifactTypeResponse put_type_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutArtifactType(
+                ParseTextProtoOrDie<PutArtifactTypeRequest>(R"pb(
+                  artifact_type: {
+                    name: 'test_type'
+                    properties { key: 'p1' value: STRING }
+                    properties { key: 'p2' value: INT }
+                  }
+                )pb"),
+                &put_type_response));
+  Artifact artifact = ParseTextProtoOrDie<Artifact>(R"pb(
+    uri: 'testuri://testing/uri'
+    properties {
+      key: 'p1'
+      value: { string_value: 'a large value' }
+    }
+    properties {
+      key: 'p2'
+      value: { int_value: 2 }
+    }
+    custom_properties {
+      key: 'c1'
+      value: { double_value: 1.5 }
+    }
+  )pb");
+  artifact.set_type_id(put_type_response.type_id());
+  PutArtifactsRequest put_artifacts_request;
+  *put_artifacts_request.add_artifacts() = artifact;
+  PutArtifactsResponse put_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutArtifacts(put_artifacts_request,
+                                          &put_artifacts_response));
+
+  // Only the properties and custom properties of the given names are read.
+  GetArtifactsRequest get_artifacts_request =
+      ParseTextProtoOrDie<GetArtifactsRequest>(R"pb(
+        options {
+          max_result_size: 10
+          property_projection { property_names: 'p2' property_names: 'c1' }
+        }
+      )pb");
+  GetArtifactsResponse get_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetArtifacts(get_artifacts_request,
+                                          &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(1));
+  Artifact projected_artifact = artifact;
+  projected_artifact.mutable_properties()->erase("p1");
+  EXPECT_THAT(get_artifacts_response.artifacts(0),
+              EqualsProto(projected_artifact,
+                          /*ignore_fields=*/{"id", "create_time_since_epoch",
+                                             "last_update_time_since_epoch"}));
+
+  // The headers only projection reads no property.
+  get_artifacts_request.mutable_options()
+      ->mutable_property_projection()
+      ->set_headers_only(true);
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetArtifacts(get_artifacts_request,
+                                          &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(1));
+  EXPECT_EQ(get_artifacts_response.artifacts(0).uri(), artifact.uri());
+  EXPECT_THAT(get_artifacts_response.artifacts(0).properties(), IsEmpty());
+  EXPECT_THAT(get_artifacts_response.artifacts(0).custom_properties(),
+              IsEmpty());
+}
+
+TEST_P(MetadataStoreTestSuite, GetArtifactsWithTypeNames) {
+  std::vector<int64> type_ids;
+  for (const char* type_name : {"type_a", "type_b"}) {
+    PutArtifactTypeRequest put_type_request;
+    put_type_request.mutable_artifact_type()->set_name(type_name);
+    PutArtifactTypeResponse put_type_response;
+    ASSERT_EQ(absl::OkStatus(), metadata_store_->PutArtifactType(
+                                    put_type_request, &put_type_response));
+    type_ids.push_back(put_type_response.type_id());
+  }
+  PutArtifactsRequest put_artifacts_request;
+  put_artifacts_request.add_artifacts()->set_type_id(type_ids[0]);
+  put_artifacts_request.add_artifacts()->set_type_id(type_ids[1]);
+  put_artifacts_request.add_artifacts()->set_type_id(type_ids[0]);
+  PutArtifactsResponse put_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutArtifacts(put_artifacts_request,
+                                          &put_artifacts_response));
+
+  // The type names are not read unless asked for.
+  GetArtifactsByIDRequest get_by_id_request;
+  get_by_id_request.mutable_artifact_ids()->CopyFrom(
+      put_artifacts_response.artifact_ids());
+  GetArtifactsByIDResponse get_by_id_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->GetArtifactsByID(
+                                  get_by_id_request, &get_by_id_response));
+  ASSERT_THAT(get_by_id_response.artifacts(), SizeIs(3));
+  for (const Artifact& artifact : get_by_id_response.artifacts()) {
+    EXPECT_FALSE(artifact.has_type());
+  }
+
+  get_by_id_request.set_populate_type_names(true);
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->GetArtifactsByID(
+                                  get_by_id_request, &get_by_id_response));
+  ASSERT_THAT(get_by_id_response.artifacts(), SizeIs(3));
+  for (const Artifact& artifact : get_by_id_response.artifacts()) {
+    EXPECT_EQ(artifact.type(),
+              artifact.type_id() == type_ids[0] ? "type_a" : "type_b");
+  }
+
+  GetArtifactsRequest get_artifacts_request =
+      ParseTextProtoOrDie<GetArtifactsRequest>(R"pb(
+        options { max_result_size: 2 populate_type_names: true }
+      )pb");
+  GetArtifactsResponse get_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetArtifacts(get_artifacts_request,
+                                          &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(2));
+  EXPECT_EQ(get_artifacts_response.artifacts(0).type(), "type_a");
+  EXPECT_EQ(get_artifacts_response.artifacts(1).type(), "type_b");
+}
+
 TEST_P(MetadataStoreTestSuite, PutArtifactsWhenLatestUpdatedTimeChanged) {
   PutArtifactTypeRequest put_type_request;
   put_type_request.mutable_artifact_type()->set_name("test_type");
@@ -1602,6 +1938,88 @@ TEST_P(MetadataStoreTestSuite, PutArtifactsWhenLatestUpdatedTimeChanged) {
   EXPECT_THAT(update_artifact_response.artifact_ids(), SizeIs(0));
 }
 
+TEST_P(MetadataStoreTestSuite, PutArtifactsWhenLatestUpdatedTimeChangedBatch) {
+  PutArtifactTypeRequest put_type_request;
+  put_type_request.mutable_artifact_type()->set_name("test_type");
+  PutArtifactTypeResponse put_type_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->PutArtifactType(
+                                  put_type_request, &put_type_response));
+  PutArtifactsRequest put_artifacts_request;
+  for (int i = 0; i < 3; i++) {
+    put_artifacts_request.add_artifacts()->set_type_id(
+        put_type_response.type_id());
+  }
+  PutArtifactsResponse put_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutArtifacts(put_artifacts_request,
+                                          &put_artifacts_response));
+  GetArtifactsResponse get_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetArtifacts({}, &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.artifacts(), SizeIs(3));
+
+  // Updates all the artifacts in one call. Their last update times increase,
+  // even if the updates are within the same millisecond as the creation.
+  PutArtifactsRequest update_artifacts_request;
+  update_artifacts_request.mutable_options()
+      ->set_abort_if_latest_updated_time_changed(true);
+  for (const Artifact& artifact : get_artifacts_response.artifacts()) {
+    Artifact* updated_artifact = update_artifacts_request.add_artifacts();
+    *updated_artifact = artifact;
+    updated_artifact->set_state(Artifact::LIVE);
+  }
+  PutArtifactsResponse update_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutArtifacts(update_artifacts_request,
+                                          &update_artifacts_response));
+  GetArtifactsResponse updated_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetArtifacts({}, &updated_artifacts_response));
+  ASSERT_THAT(updated_artifacts_response.artifacts(), SizeIs(3));
+  for (int i = 0; i < 3; i++) {
+    EXPECT_GT(
+        updated_artifacts_response.artifacts(i).last_update_time_since_epoch(),
+        get_artifacts_response.artifacts(i).last_update_time_since_epoch());
+  }
+
+  // If one of the artifacts is stale, none of them is updated.
+  PutArtifactsRequest stale_request;
+  stale_request.mutable_options()->set_abort_if_latest_updated_time_changed(
+      true);
+  *stale_request.add_artifacts() = updated_artifacts_response.artifacts(0);
+  *stale_request.add_artifacts() = get_artifacts_response.artifacts(1);
+  stale_request.mutable_artifacts(0)->set_uri("uri://stale");
+  stale_request.mutable_artifacts(1)->set_uri("uri://stale");
+  PutArtifactsResponse stale_response;
+  EXPECT_TRUE(absl::IsFailedPrecondition(
+      metadata_store_->PutArtifacts(stale_request, &stale_response)));
+  GetArtifactsResponse final_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetArtifacts({}, &final_artifacts_response));
+  EXPECT_THAT(final_artifacts_response.artifacts(),
+              Pointwise(EqualsProto<Artifact>(),
+                        updated_artifacts_response.artifacts()));
+
+  // An artifact updated twice by a request is rejected, as the time of its
+  // second update is changed by the first one.
+  PutArtifactsRequest duplicate_request;
+  duplicate_request.mutable_options()->set_abort_if_latest_updated_time_changed(
+      true);
+  *duplicate_request.add_artifacts() = final_artifacts_response.artifacts(0);
+  *duplicate_request.add_artifacts() = final_artifacts_response.artifacts(0);
+  duplicate_request.mutable_artifacts(0)->set_uri("uri://first");
+  duplicate_request.mutable_artifacts(1)->set_uri("uri://second");
+  PutArtifactsResponse duplicate_response;
+  EXPECT_TRUE(absl::IsFailedPrecondition(
+      metadata_store_->PutArtifacts(duplicate_request, &duplicate_response)));
+  GetArtifactsResponse unchanged_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetArtifacts({}, &unchanged_artifacts_response));
+  EXPECT_THAT(unchanged_artifacts_response.artifacts(),
+              Pointwise(EqualsProto<Artifact>(),
+                        final_artifacts_response.artifacts()));
+}
+
 // Test creating an execution and then updating one of its properties.
 TEST_P(MetadataStoreTestSuite, PutExecutionsUpdateGetExecutionsByID) {
   const PutExecutionTypeRequest put_execution_type_request =
@@ -2061,6 +2479,85 @@ TEST_P(MetadataStoreTestSuite, PutExecutionsGetExecutionsWithEmptyExecution) {
               SizeIs(0));
 }
 
+TEST_P(MetadataStoreTestSuite, GetActiveExecutionsByType) {
+  const PutExecutionTypeRequest put_execution_type_request =
+      ParseTextProtoOrDie<PutExecutionTypeRequest>(
+          R"(
+            all_fields_match: true
+            execution_type: { name: 'scheduled_type' }
+          )");
+  PutExecutionTypeResponse put_execution_type_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutExecutionType(put_execution_type_request,
+                                              &put_execution_type_response));
+  const int64 type_id = put_execution_type_response.type_id();
+
+  // No executions of the type yet.
+  GetActiveExecutionsByTypeRequest get_active_executions_request;
+  get_active_executions_request.set_type_name("scheduled_type");
+  GetActiveExecutionsByTypeResponse get_active_executions_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetActiveExecutionsByType(
+                get_active_executions_request,
+                &get_active_executions_response));
+  EXPECT_THAT(get_active_executions_response.executions(), IsEmpty());
+
+  PutExecutionsRequest put_executions_request =
+      ParseTextProtoOrDie<PutExecutionsRequest>(R"(
+        executions: { last_known_state: NEW }
+        executions: { last_known_state: RUNNING }
+        executions: { last_known_state: COMPLETE }
+        executions: { last_known_state: FAILED }
+        executions: {}
+      )");
+  for (Execution& execution : *put_executions_request.mutable_executions()) {
+    execution.set_type_id(type_id);
+  }
+  PutExecutionsResponse put_executions_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutExecutions(put_executions_request,
+                                           &put_executions_response));
+  ASSERT_THAT(put_executions_response.execution_ids(), SizeIs(5));
+  const int64 new_id = put_executions_response.execution_ids(0);
+  const int64 running_id = put_executions_response.execution_ids(1);
+
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetActiveExecutionsByType(
+                get_active_executions_request,
+                &get_active_executions_response));
+  std::vector<int64> active_ids;
+  for (const Execution& execution :
+       get_active_executions_response.executions()) {
+    active_ids.push_back(execution.id());
+  }
+  EXPECT_THAT(active_ids, UnorderedElementsAre(new_id, running_id));
+
+  // An execution leaves the active ones once it reaches a terminal state.
+  PutExecutionsRequest update_request;
+  Execution* running = update_request.add_executions();
+  *running = get_active_executions_response.executions(0).id() == running_id
+                 ? get_active_executions_response.executions(0)
+                 : get_active_executions_response.executions(1);
+  running->set_last_known_state(Execution::COMPLETE);
+  PutExecutionsResponse update_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutExecutions(update_request, &update_response));
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetActiveExecutionsByType(
+                get_active_executions_request,
+                &get_active_executions_response));
+  ASSERT_THAT(get_active_executions_response.executions(), SizeIs(1));
+  EXPECT_EQ(get_active_executions_response.executions(0).id(), new_id);
+
+  GetActiveExecutionsByTypeRequest not_exist_type_request;
+  not_exist_type_request.set_type_name("not_exist_type");
+  GetActiveExecutionsByTypeResponse not_exist_type_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetActiveExecutionsByType(
+                not_exist_type_request, &not_exist_type_response));
+  EXPECT_THAT(not_exist_type_response.executions(), IsEmpty());
+}
+
 TEST_P(MetadataStoreTestSuite, PutExecutionsGetExecutionsWithListOptions) {
   const PutExecutionTypeRequest put_execution_type_request =
       ParseTextProtoOrDie<PutExecutionTypeRequest>(
@@ -2472,6 +2969,80 @@ TEST_P(MetadataStoreTestSuite, PutEventGetEvents) {
             put_artifacts_response.artifact_ids(0));
 }
 
+TEST_P(MetadataStoreTestSuite, GetEventsByTimeRange) {
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"(
+        artifact_types: { name: 'test_type' }
+        execution_types: { name: 'test_type' }
+      )");
+  PutTypesResponse put_types_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutTypes(put_types_request, &put_types_response));
+  PutArtifactsRequest put_artifacts_request;
+  put_artifacts_request.add_artifacts()->set_type_id(
+      put_types_response.artifact_type_ids(0));
+  PutArtifactsResponse put_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutArtifacts(put_artifacts_request,
+                                          &put_artifacts_response));
+  PutExecutionsRequest put_executions_request;
+  put_executions_request.add_executions()->set_type_id(
+      put_types_response.execution_type_ids(0));
+  PutExecutionsResponse put_executions_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutExecutions(put_executions_request,
+                                           &put_executions_response));
+
+  // The events are put out of the order of their times, and two of them have
+  // the same time, which are ordered by id.
+  PutEventsRequest put_events_request = ParseTextProtoOrDie<PutEventsRequest>(
+      R"(
+        events: { type: INPUT milliseconds_since_epoch: 2000 }
+        events: { type: OUTPUT milliseconds_since_epoch: 1000 }
+        events: { type: DECLARED_INPUT milliseconds_since_epoch: 2000 }
+        events: { type: DECLARED_OUTPUT milliseconds_since_epoch: 3000 }
+      )");
+  for (Event& event : *put_events_request.mutable_events()) {
+    event.set_artifact_id(put_artifacts_response.artifact_ids(0));
+    event.set_execution_id(put_executions_response.execution_ids(0));
+  }
+  PutEventsResponse put_events_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->PutEvents(put_events_request,
+                                                         &put_events_response));
+
+  GetEventsByTimeRangeRequest request;
+  request.set_min_milliseconds_since_epoch(1000);
+  request.set_max_milliseconds_since_epoch(3000);
+  request.mutable_options()->set_max_result_size(2);
+  GetEventsByTimeRangeResponse response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetEventsByTimeRange(request, &response));
+  ASSERT_THAT(response.events(), SizeIs(2));
+  EXPECT_EQ(response.events(0).type(), Event::OUTPUT);
+  EXPECT_EQ(response.events(1).type(), Event::INPUT);
+  ASSERT_FALSE(response.next_page_token().empty());
+
+  request.mutable_options()->set_next_page_token(response.next_page_token());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetEventsByTimeRange(request, &response));
+  ASSERT_THAT(response.events(), SizeIs(1));
+  EXPECT_EQ(response.events(0).type(), Event::DECLARED_INPUT);
+  EXPECT_TRUE(response.next_page_token().empty());
+
+  // Without a max, the range is open-ended.
+  GetEventsByTimeRangeRequest typed_request;
+  typed_request.set_min_milliseconds_since_epoch(1500);
+  typed_request.add_types(Event::INPUT);
+  typed_request.add_types(Event::DECLARED_OUTPUT);
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetEventsByTimeRange(typed_request, &response));
+  ASSERT_THAT(response.events(), SizeIs(2));
+  EXPECT_EQ(response.events(0).type(), Event::INPUT);
+  EXPECT_EQ(response.events(1).type(), Event::DECLARED_OUTPUT);
+  EXPECT_EQ(response.events(1).milliseconds_since_epoch(), 3000);
+  EXPECT_TRUE(response.next_page_token().empty());
+}
+
 TEST_P(MetadataStoreTestSuite, PutTypesGetTypes) {
   const PutTypesRequest put_request = ParseTextProtoOrDie<PutTypesRequest>(
       R"(
@@ -2538,6 +3109,101 @@ TEST_P(MetadataStoreTestSuite, PutTypesGetTypes) {
             get_context_type_response.context_type().id());
 }
 
+TEST_P(MetadataStoreTestSuite, PutTypesAddsFieldsOfStoredAndNewTypes) {
+  const PutTypesRequest stored_request = ParseTextProtoOrDie<PutTypesRequest>(
+      R"pb(
+        artifact_types: {
+          name: 'stored_type'
+          properties { key: 'p1' value: STRING }
+        }
+      )pb");
+  PutTypesResponse stored_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutTypes(stored_request, &stored_response));
+
+  // The stored type gains a property, and the second occurrence of the new
+  // type adds a property to the first one, which is created with both.
+  const PutTypesRequest put_request = ParseTextProtoOrDie<PutTypesRequest>(
+      R"pb(
+        artifact_types: {
+          name: 'stored_type'
+          properties { key: 'p1' value: STRING }
+          properties { key: 'p2' value: INT }
+        }
+        artifact_types: {
+          name: 'new_type'
+          properties { key: 'p1' value: DOUBLE }
+        }
+        artifact_types: {
+          name: 'new_type'
+          properties { key: 'p2' value: STRING }
+        }
+        artifact_types: {
+          name: 'new_type'
+          version: 'v1'
+        }
+        can_add_fields: true
+        can_omit_fields: true
+      )pb");
+  PutTypesResponse put_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutTypes(put_request, &put_response));
+  ASSERT_THAT(put_response.artifact_type_ids(), SizeIs(4));
+  EXPECT_EQ(put_response.artifact_type_ids(0),
+            stored_response.artifact_type_ids(0));
+  EXPECT_EQ(put_response.artifact_type_ids(1),
+            put_response.artifact_type_ids(2));
+  EXPECT_NE(put_response.artifact_type_ids(1),
+            put_response.artifact_type_ids(3));
+
+  GetArtifactTypeResponse stored_type_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetArtifactType(
+                ParseTextProtoOrDie<GetArtifactTypeRequest>(
+                    "type_name: 'stored_type'"),
+                &stored_type_response));
+  EXPECT_THAT(stored_type_response.artifact_type(),
+              EqualsProto(ParseTextProtoOrDie<ArtifactType>(absl::StrCat(
+                  "id: ", put_response.artifact_type_ids(0), R"pb(
+                    name: 'stored_type'
+                    properties { key: 'p1' value: STRING }
+                    properties { key: 'p2' value: INT }
+                  )pb"))));
+
+  GetArtifactTypeResponse new_type_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetArtifactType(
+                ParseTextProtoOrDie<GetArtifactTypeRequest>(
+                    "type_name: 'new_type'"),
+                &new_type_response));
+  EXPECT_THAT(new_type_response.artifact_type(),
+              EqualsProto(ParseTextProtoOrDie<ArtifactType>(absl::StrCat(
+                  "id: ", put_response.artifact_type_ids(1), R"pb(
+                    name: 'new_type'
+                    properties { key: 'p1' value: DOUBLE }
+                    properties { key: 'p2' value: STRING }
+                  )pb"))));
+
+  // A conflicting property type is rejected, and nothing is written.
+  PutTypesResponse conflict_response;
+  EXPECT_TRUE(absl::IsAlreadyExists(metadata_store_->PutTypes(
+      ParseTextProtoOrDie<PutTypesRequest>(R"pb(
+        artifact_types: {
+          name: 'another_type'
+        }
+        artifact_types: {
+          name: 'new_type'
+          properties { key: 'p1' value: INT }
+        }
+        can_omit_fields: true
+      )pb"),
+      &conflict_response)));
+  GetArtifactTypeResponse another_type_response;
+  EXPECT_TRUE(absl::IsNotFound(metadata_store_->GetArtifactType(
+      ParseTextProtoOrDie<GetArtifactTypeRequest>("type_name: 'another_type'"),
+      &another_type_response)));
+}
+
 TEST_P(MetadataStoreTestSuite, PutTypesInsertTypeLink) {
   const PutTypesRequest put_request = ParseTextProtoOrDie<PutTypesRequest>(
       R"pb(
@@ -3940,6 +4606,448 @@ TEST_P(MetadataStoreTestSuite, PutParentContextsAndGetLinkedContextByContext) {
   }
 }
 
+TEST_P(MetadataStoreTestSuite, GetAncestorAndDescendantContexts) {
+  PutContextTypeRequest put_type_request;
+  put_type_request.mutable_context_type()->set_name("context_type_name");
+  PutContextTypeResponse put_type_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->PutContextType(
+                                  put_type_request, &put_type_response));
+
+  // A project with two pipelines, which share a run of a component.
+  const int num_contexts = 5;
+  std::vector<Context> contexts(num_contexts);
+  PutContextsRequest put_contexts_request;
+  for (int i = 0; i < num_contexts; i++) {
+    contexts[i].set_name(absl::StrCat("context_", i));
+    contexts[i].set_type_id(put_type_response.type_id());
+    *put_contexts_request.add_contexts() = contexts[i];
+  }
+  PutContextsResponse put_contexts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutContexts(put_contexts_request,
+                                         &put_contexts_response));
+  for (int i = 0; i < num_contexts; i++) {
+    contexts[i].set_id(put_contexts_response.context_ids(i));
+  }
+  PutParentContextsRequest put_parent_contexts_request;
+  for (const auto& [parent_idx, child_idx] :
+       std::vector<std::pair<int, int>>{{0, 1}, {0, 2}, {1, 3}, {2, 3},
+                                        {3, 4}}) {
+    ParentContext* parent_context =
+        put_parent_contexts_request.add_parent_contexts();
+    parent_context->set_parent_id(contexts[parent_idx].id());
+    parent_context->set_child_id(contexts[child_idx].id());
+  }
+  PutParentContextsResponse put_parent_contexts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutParentContexts(put_parent_contexts_request,
+                                               &put_parent_contexts_response));
+
+  // The contexts are ordered by the number of levels, then by id, and the
+  // contexts reached through both pipelines are returned once.
+  // The matcher keeps a reference to the ignored fields, so they must outlive
+  // it.
+  const std::vector<std::string> ignore_fields = {
+      "create_time_since_epoch", "last_update_time_since_epoch"};
+  const auto equals_context = EqualsProto<Context>(ignore_fields);
+  GetAncestorContextsRequest get_ancestors_request;
+  get_ancestors_request.set_context_id(contexts[4].id());
+  GetAncestorContextsResponse get_ancestors_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetAncestorContexts(get_ancestors_request,
+                                                 &get_ancestors_response));
+  EXPECT_THAT(get_ancestors_response.contexts(),
+              Pointwise(equals_context, {contexts[3], contexts[1], contexts[2],
+                                         contexts[0]}));
+
+  get_ancestors_request.set_max_depth(2);
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetAncestorContexts(get_ancestors_request,
+                                                 &get_ancestors_response));
+  EXPECT_THAT(get_ancestors_response.contexts(),
+              Pointwise(equals_context, {contexts[3], contexts[1], contexts[2]}));
+
+  GetDescendantContextsRequest get_descendants_request;
+  get_descendants_request.set_context_id(contexts[0].id());
+  get_descendants_request.set_max_depth(2);
+  GetDescendantContextsResponse get_descendants_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetDescendantContexts(get_descendants_request,
+                                                   &get_descendants_response));
+  EXPECT_THAT(get_descendants_response.contexts(),
+              Pointwise(equals_context, {contexts[1], contexts[2], contexts[3]}));
+
+  get_descendants_request.set_context_id(contexts[4].id());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetDescendantContexts(get_descendants_request,
+                                                   &get_descendants_response));
+  EXPECT_THAT(get_descendants_response.contexts(), IsEmpty());
+}
+
+TEST_P(MetadataStoreTestSuite, GetExecutionDetails) {
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"pb(
+        artifact_types: { name: 'artifact_type' }
+        execution_types: { name: 'run_type' }
+        context_types: { name: 'context_type' }
+      )pb");
+  PutTypesResponse put_types_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutTypes(put_types_request, &put_types_response));
+  const int64 artifact_type_id = put_types_response.artifact_type_ids(0);
+  const int64 execution_type_id = put_types_response.execution_type_ids(0);
+  const int64 context_type_id = put_types_response.context_type_ids(0);
+
+  // Two runs of a pipeline read the same dataset, and the second one writes a
+  // model and is associated with its own context too.
+  PutExecutionRequest put_request_1;
+  put_request_1.mutable_execution()->set_type_id(execution_type_id);
+  PutExecutionRequest::ArtifactAndEvent* dataset_and_event =
+      put_request_1.add_artifact_event_pairs();
+  dataset_and_event->mutable_artifact()->set_type_id(artifact_type_id);
+  dataset_and_event->mutable_artifact()->set_uri("dataset");
+  dataset_and_event->mutable_event()->set_type(Event::INPUT);
+  Context* pipeline = put_request_1.add_contexts();
+  pipeline->set_type_id(context_type_id);
+  pipeline->set_name("pipeline");
+  PutExecutionResponse put_response_1;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutExecution(put_request_1, &put_response_1));
+
+  PutExecutionRequest put_request_2 = put_request_1;
+  put_request_2.mutable_artifact_event_pairs(0)->mutable_artifact()->set_id(
+      put_response_1.artifact_ids(0));
+  PutExecutionRequest::ArtifactAndEvent* model_and_event =
+      put_request_2.add_artifact_event_pairs();
+  model_and_event->mutable_artifact()->set_type_id(artifact_type_id);
+  model_and_event->mutable_artifact()->set_uri("model");
+  model_and_event->mutable_event()->set_type(Event::OUTPUT);
+  Context* run_context = put_request_2.add_contexts();
+  run_context->set_type_id(context_type_id);
+  run_context->set_name("run_2");
+  put_request_2.mutable_options()->set_reuse_context_if_already_exist(true);
+  PutExecutionResponse put_response_2;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutExecution(put_request_2, &put_response_2));
+
+  // The unknown execution id is skipped, and the shared artifact and context
+  // are returned once.
+  GetExecutionDetailsRequest get_request;
+  get_request.add_execution_ids(put_response_2.execution_id());
+  get_request.add_execution_ids(put_response_1.execution_id());
+  get_request.add_execution_ids(put_response_2.execution_id() + 1000);
+  GetExecutionDetailsResponse get_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetExecutionDetails(get_request, &get_response));
+  std::vector<int64> execution_ids;
+  for (const Execution& execution : get_response.executions()) {
+    execution_ids.push_back(execution.id());
+  }
+  EXPECT_THAT(execution_ids,
+              UnorderedElementsAre(put_response_1.execution_id(),
+                                   put_response_2.execution_id()));
+  EXPECT_THAT(get_response.events(), SizeIs(3));
+  ASSERT_THAT(get_response.artifacts(), SizeIs(2));
+  EXPECT_EQ(get_response.artifacts(0).uri(), "dataset");
+  EXPECT_EQ(get_response.artifacts(1).uri(), "model");
+  ASSERT_THAT(get_response.contexts(), SizeIs(2));
+  EXPECT_EQ(get_response.contexts(0).name(), "pipeline");
+  EXPECT_EQ(get_response.contexts(1).name(), "run_2");
+  EXPECT_THAT(
+      get_response.associations(),
+      ElementsAre(
+          EqualsProto(ParseTextProtoOrDie<Association>(absl::Substitute(
+              "execution_id: $0 context_id: $1", put_response_1.execution_id(),
+              put_response_1.context_ids(0)))),
+          EqualsProto(ParseTextProtoOrDie<Association>(absl::Substitute(
+              "execution_id: $0 context_id: $1", put_response_2.execution_id(),
+              put_response_2.context_ids(0)))),
+          EqualsProto(ParseTextProtoOrDie<Association>(absl::Substitute(
+              "execution_id: $0 context_id: $1", put_response_2.execution_id(),
+              put_response_2.context_ids(1))))));
+
+  get_request.clear_execution_ids();
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetExecutionDetails(get_request, &get_response));
+  EXPECT_THAT(get_response.executions(), IsEmpty());
+}
+
+TEST_P(MetadataStoreTestSuite, GetArtifactsAndExecutionsByContexts) {
+  const PutTypesRequest put_types_request =
+      ParseTextProtoOrDie<PutTypesRequest>(R"pb(
+        artifact_types: { name: 'artifact_type' }
+        execution_types: { name: 'run_type' }
+        context_types: { name: 'context_type' }
+      )pb");
+  PutTypesResponse put_types_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->PutTypes(put_types_request, &put_types_response));
+  const int64 artifact_type_id = put_types_response.artifact_type_ids(0);
+  const int64 execution_type_id = put_types_response.execution_type_ids(0);
+  const int64 context_type_id = put_types_response.context_type_ids(0);
+
+  // The first context has three runs, which write an artifact each, and the
+  // second one has the last run only. The third context has no nodes.
+  std::vector<Context> contexts(3);
+  for (int i = 0; i < contexts.size(); i++) {
+    contexts[i].set_type_id(context_type_id);
+    contexts[i].set_name(absl::StrCat("context_", i));
+  }
+  InsertNodeAndSetNodeID(metadata_store_, contexts);
+  std::vector<int64> artifact_ids;
+  std::vector<int64> execution_ids;
+  for (int i = 0; i < 3; i++) {
+    PutExecutionRequest put_request;
+    put_request.mutable_execution()->set_type_id(execution_type_id);
+    PutExecutionRequest::ArtifactAndEvent* artifact_and_event =
+        put_request.add_artifact_event_pairs();
+    artifact_and_event->mutable_artifact()->set_type_id(artifact_type_id);
+    artifact_and_event->mutable_event()->set_type(Event::OUTPUT);
+    *put_request.add_contexts() = contexts[0];
+    if (i == 2) *put_request.add_contexts() = contexts[1];
+    PutExecutionResponse put_response;
+    ASSERT_EQ(absl::OkStatus(),
+              metadata_store_->PutExecution(put_request, &put_response));
+    artifact_ids.push_back(put_response.artifact_ids(0));
+    execution_ids.push_back(put_response.execution_id());
+  }
+
+  GetArtifactsByContextsRequest get_artifacts_request;
+  get_artifacts_request.add_context_ids(contexts[2].id());
+  get_artifacts_request.add_context_ids(contexts[1].id());
+  get_artifacts_request.add_context_ids(contexts[0].id());
+  GetArtifactsByContextsResponse get_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetArtifactsByContexts(get_artifacts_request,
+                                                    &get_artifacts_response));
+  ASSERT_THAT(get_artifacts_response.context_artifacts(), SizeIs(2));
+  const auto& first_context_artifacts =
+      get_artifacts_response.context_artifacts(0);
+  EXPECT_EQ(first_context_artifacts.context_id(), contexts[0].id());
+  ASSERT_THAT(first_context_artifacts.artifacts(), SizeIs(3));
+  EXPECT_EQ(first_context_artifacts.artifacts(0).id(), artifact_ids[2]);
+  EXPECT_EQ(first_context_artifacts.artifacts(1).id(), artifact_ids[1]);
+  EXPECT_EQ(first_context_artifacts.artifacts(2).id(), artifact_ids[0]);
+  const auto& second_context_artifacts =
+      get_artifacts_response.context_artifacts(1);
+  EXPECT_EQ(second_context_artifacts.context_id(), contexts[1].id());
+  ASSERT_THAT(second_context_artifacts.artifacts(), SizeIs(1));
+  EXPECT_EQ(second_context_artifacts.artifacts(0).id(), artifact_ids[2]);
+
+  // Test: returns the latest two executions of each context.
+  GetExecutionsByContextsRequest get_executions_request;
+  get_executions_request.add_context_ids(contexts[0].id());
+  get_executions_request.add_context_ids(contexts[1].id());
+  get_executions_request.set_max_num_per_context(2);
+  GetExecutionsByContextsResponse get_executions_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetExecutionsByContexts(get_executions_request,
+                                                     &get_executions_response));
+  ASSERT_THAT(get_executions_response.context_executions(), SizeIs(2));
+  const auto& first_context_executions =
+      get_executions_response.context_executions(0);
+  EXPECT_EQ(first_context_executions.context_id(), contexts[0].id());
+  ASSERT_THAT(first_context_executions.executions(), SizeIs(2));
+  EXPECT_EQ(first_context_executions.executions(0).id(), execution_ids[2]);
+  EXPECT_EQ(first_context_executions.executions(1).id(), execution_ids[1]);
+  const auto& second_context_executions =
+      get_executions_response.context_executions(1);
+  EXPECT_EQ(second_context_executions.context_id(), contexts[1].id());
+  ASSERT_THAT(second_context_executions.executions(), SizeIs(1));
+  EXPECT_EQ(second_context_executions.executions(0).id(), execution_ids[2]);
+}
+
+TEST_P(MetadataStoreTestSuite, DeleteExecutionsInChunks) {
+  const int kNumNodes = 5;
+  ExecutionType execution_type;
+  execution_type.set_name("test_type");
+  InsertTypeAndSetTypeID(metadata_store_, execution_type);
+  std::vector<Execution> executions(kNumNodes);
+  for (Execution& execution : executions) {
+    execution.set_type_id(execution_type.id());
+    (*execution.mutable_custom_properties())["p"].set_int_value(1);
+  }
+  InsertNodeAndSetNodeID(metadata_store_, executions);
+  ArtifactType artifact_type;
+  artifact_type.set_name("test_type");
+  InsertTypeAndSetTypeID(metadata_store_, artifact_type);
+  std::vector<Artifact> artifacts(1);
+  artifacts[0].set_type_id(artifact_type.id());
+  InsertNodeAndSetNodeID(metadata_store_, artifacts);
+
+  PutEventsRequest put_events_request;
+  for (const Execution& execution : executions) {
+    Event* event = put_events_request.add_events();
+    event->set_artifact_id(artifacts[0].id());
+    event->set_execution_id(execution.id());
+    event->set_type(Event::OUTPUT);
+    event->mutable_path()->add_steps()->set_key("output");
+  }
+  PutEventsResponse put_events_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->PutEvents(put_events_request,
+                                                         &put_events_response));
+
+  // Test: deletes at most two chunks of two executions.
+  DeleteExecutionsRequest delete_request;
+  for (const Execution& execution : executions) {
+    delete_request.add_execution_ids(execution.id());
+  }
+  delete_request.mutable_options()->set_chunk_size(2);
+  delete_request.mutable_options()->set_max_num_chunks(2);
+  DeleteExecutionsResponse delete_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->DeleteExecutions(
+                                  delete_request, &delete_response));
+  EXPECT_EQ(delete_response.num_deleted_ids(), 4);
+
+  GetExecutionsByIDRequest get_executions_request;
+  for (const Execution& execution : executions) {
+    get_executions_request.add_execution_ids(execution.id());
+  }
+  GetExecutionsByIDResponse get_executions_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetExecutionsByID(get_executions_request,
+                                               &get_executions_response));
+  ASSERT_THAT(get_executions_response.executions(), SizeIs(1));
+  EXPECT_EQ(get_executions_response.executions(0).id(), executions[4].id());
+  GetEventsByArtifactIDsRequest get_events_request;
+  get_events_request.add_artifact_ids(artifacts[0].id());
+  GetEventsByArtifactIDsResponse get_events_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetEventsByArtifactIDs(get_events_request,
+                                                    &get_events_response));
+  ASSERT_THAT(get_events_response.events(), SizeIs(1));
+  EXPECT_EQ(get_events_response.events(0).execution_id(), executions[4].id());
+  EXPECT_THAT(get_events_response.events(0).path().steps(), SizeIs(1));
+
+  // Test: resumes from the ids that are not deleted.
+  delete_request.mutable_execution_ids()->erase(
+      delete_request.mutable_execution_ids()->begin(),
+      delete_request.mutable_execution_ids()->begin() +
+          delete_response.num_deleted_ids());
+  delete_request.mutable_options()->clear_max_num_chunks();
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->DeleteExecutions(
+                                  delete_request, &delete_response));
+  EXPECT_EQ(delete_response.num_deleted_ids(), 1);
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetExecutionsByID(get_executions_request,
+                                               &get_executions_response));
+  EXPECT_THAT(get_executions_response.executions(), IsEmpty());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetEventsByArtifactIDs(get_events_request,
+                                                    &get_events_response));
+  EXPECT_THAT(get_events_response.events(), IsEmpty());
+}
+
+TEST_P(MetadataStoreTestSuite, DeleteArtifactsInvalidChunkSize) {
+  DeleteArtifactsRequest delete_request;
+  delete_request.add_artifact_ids(1);
+  delete_request.mutable_options()->set_chunk_size(0);
+  DeleteArtifactsResponse delete_response;
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_store_->DeleteArtifacts(delete_request, &delete_response)));
+  EXPECT_EQ(delete_response.num_deleted_ids(), 0);
+
+  delete_request.mutable_options()->set_chunk_size(kMaxBulkDeleteChunkSize + 1);
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      metadata_store_->DeleteArtifacts(delete_request, &delete_response)));
+}
+
+TEST_P(MetadataStoreTestSuite, ArchiveExecutions) {
+  ExecutionType execution_type;
+  execution_type.set_name("test_type");
+  InsertTypeAndSetTypeID(metadata_store_, execution_type);
+  std::vector<Execution> executions(2);
+  for (Execution& execution : executions) {
+    execution.set_type_id(execution_type.id());
+    (*execution.mutable_custom_properties())["p"].set_int_value(1);
+  }
+  executions[0].set_last_known_state(Execution::COMPLETE);
+  executions[1].set_last_known_state(Execution::RUNNING);
+  InsertNodeAndSetNodeID(metadata_store_, executions);
+  ArtifactType artifact_type;
+  artifact_type.set_name("test_type");
+  InsertTypeAndSetTypeID(metadata_store_, artifact_type);
+  std::vector<Artifact> artifacts(1);
+  artifacts[0].set_type_id(artifact_type.id());
+  artifacts[0].set_uri("uri://archived");
+  InsertNodeAndSetNodeID(metadata_store_, artifacts);
+  PutEventsRequest put_events_request;
+  for (const Execution& execution : executions) {
+    Event* event = put_events_request.add_events();
+    event->set_artifact_id(artifacts[0].id());
+    event->set_execution_id(execution.id());
+    event->set_type(Event::OUTPUT);
+    event->mutable_path()->add_steps()->set_key("output");
+  }
+  PutEventsResponse put_events_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->PutEvents(put_events_request,
+                                                         &put_events_response));
+
+  // Test: the RUNNING execution is not archived.
+  ArchiveExecutionsRequest archive_request;
+  archive_request.set_max_last_update_time_since_epoch(
+      absl::ToUnixMillis(absl::Now()) + 1);
+  ArchiveExecutionsResponse archive_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->ArchiveExecutions(
+                                  archive_request, &archive_response));
+  EXPECT_EQ(archive_response.num_archived_executions(), 1);
+
+  // Test: the archived execution is only found by id, with its properties.
+  GetExecutionsResponse get_executions_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->GetExecutions(
+                                  {}, &get_executions_response));
+  ASSERT_THAT(get_executions_response.executions(), SizeIs(1));
+  EXPECT_EQ(get_executions_response.executions(0).id(), executions[1].id());
+  GetExecutionsByIDRequest get_executions_by_id_request;
+  get_executions_by_id_request.add_execution_ids(executions[0].id());
+  GetExecutionsByIDResponse get_executions_by_id_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->GetExecutionsByID(
+                                  get_executions_by_id_request,
+                                  &get_executions_by_id_response));
+  ASSERT_THAT(get_executions_by_id_response.executions(), SizeIs(1));
+  EXPECT_EQ(get_executions_by_id_response.executions(0).last_known_state(),
+            Execution::COMPLETE);
+  EXPECT_EQ(get_executions_by_id_response.executions(0)
+                .custom_properties()
+                .at("p")
+                .int_value(),
+            1);
+
+  // Test: the archived event is still read, and in the lineage graph.
+  GetEventsByExecutionIDsRequest get_events_request;
+  get_events_request.add_execution_ids(executions[0].id());
+  GetEventsByExecutionIDsResponse get_events_response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetEventsByExecutionIDs(get_events_request,
+                                                     &get_events_response));
+  ASSERT_THAT(get_events_response.events(), SizeIs(1));
+  EXPECT_EQ(get_events_response.events(0).artifact_id(), artifacts[0].id());
+  EXPECT_THAT(get_events_response.events(0).path().steps(), SizeIs(1));
+  GetLineageGraphRequest lineage_request;
+  lineage_request.mutable_options()->mutable_artifacts_options()
+      ->set_filter_query("uri = 'uri://archived'");
+  GetLineageGraphResponse lineage_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->GetLineageGraph(
+                                  lineage_request, &lineage_response));
+  EXPECT_THAT(lineage_response.subgraph().executions(), SizeIs(2));
+  EXPECT_THAT(lineage_response.subgraph().events(), SizeIs(2));
+
+  // Test: the archived execution is deleted with its event.
+  DeleteExecutionsRequest delete_request;
+  delete_request.add_execution_ids(executions[0].id());
+  DeleteExecutionsResponse delete_response;
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->DeleteExecutions(
+                                  delete_request, &delete_response));
+  ASSERT_EQ(absl::OkStatus(), metadata_store_->GetExecutionsByID(
+                                  get_executions_by_id_request,
+                                  &get_executions_by_id_response));
+  EXPECT_THAT(get_executions_by_id_response.executions(), IsEmpty());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store_->GetEventsByExecutionIDs(get_events_request,
+                                                     &get_events_response));
+  EXPECT_THAT(get_events_response.events(), IsEmpty());
+}
+
 TEST_P(MetadataStoreTestSuite,
        PutTypesAndContextsGetContextsThroughTypeWithOptions) {
   const int kNumNodes = 110;
@@ -14,8 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/mysql_metadata_source.h"
 
+#include <algorithm>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <glog/logging.h>
 #include "absl/status/status.h"
@@ -25,7 +27,10 @@ limitations under the License.
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/record_set_util.h"
 #include "ml_metadata/metadata_store/types.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/util/return_utils.h"
@@ -39,9 +44,22 @@ using absl::Status;
 
 constexpr char kSetIsolationLevel[] = "SET TRANSACTION ISOLATION LEVEL ";
 constexpr char kBeginTransaction[] = "START TRANSACTION";
+// A read-only transaction is not assigned a transaction id, and reads the
+// snapshot established when it begins.
+constexpr char kBeginReadOnlyTransaction[] =
+    "START TRANSACTION READ ONLY, WITH CONSISTENT SNAPSHOT";
 constexpr char kCommitTransaction[] = "COMMIT";
 constexpr char kRollbackTransaction[] = "ROLLBACK";
 
+// The max number of prepared statements cached for a connection. The queries
+// having IN lists are prepared for each list size, so the cache is cleared
+// when it is full.
+constexpr int kMaxNumPreparedStatements = 256;
+
+// The initial buffer size of a column fetched from a prepared statement. Longer
+// values are fetched again with a large enough buffer.
+constexpr int kColumnBufferSize = 256;
+
 // url key used for storing ustom error information in the absl::Status payload.
 constexpr char kStatusErrorInfoUrl[] = "mysql-error-info";
 
@@ -117,6 +135,84 @@ absl::Status BuildErrorStatus(const absl::StatusCode status_code,
                           absl::Cord(error_info.SerializeAsString()));
   return error_status;
 }
+
+// Builds the status of a failed query. Deadlocks (1213) and lock wait timeouts
+// (1205) of concurrent transactions return Aborted for client side to retry.
+absl::Status BuildQueryErrorStatus(const absl::string_view error_message,
+                                   const int64 mysql_error_code,
+                                   const absl::string_view mysql_error_message) {
+  if (mysql_error_code == 1213 || mysql_error_code == 1205) {
+    return BuildErrorStatus(absl::StatusCode::kAborted,
+                            absl::StrCat(error_message, " aborted"),
+                            mysql_error_code, mysql_error_message);
+  }
+  return BuildErrorStatus(absl::StatusCode::kInternal,
+                          absl::StrCat(error_message, " failed"),
+                          mysql_error_code, mysql_error_message);
+}
+
+// Returns the `query` without the trailing `;` and whitespaces, so that the
+// queries of a pipelined batch are joined into a multi-statement query.
+absl::string_view StripStatementTerminator(absl::string_view query) {
+  query = absl::StripTrailingAsciiWhitespace(query);
+  while (absl::ConsumeSuffix(&query, ";")) {
+    query = absl::StripTrailingAsciiWhitespace(query);
+  }
+  return query;
+}
+
+// Connects `db`, initialized by mysql_init, to the server of `config` with the
+// `client_flag`, without selecting a database.
+absl::Status RealConnect(const MySQLDatabaseConfig& config,
+                         const unsigned long client_flag,  // NOLINT
+                         MYSQL* db) {
+  // Set connection options
+  if (config.has_ssl_options()) {
+    const MySQLDatabaseConfig::SSLOptions& ssl = config.ssl_options();
+    // The method set mysql_options, and always return 0. The connection options
+    // are used in the `mysql_real_connect`.
+    mysql_ssl_set(db, ssl.key().empty() ? nullptr : ssl.key().c_str(),
+                  ssl.cert().empty() ? nullptr : ssl.cert().c_str(),
+                  ssl.ca().empty() ? nullptr : ssl.ca().c_str(),
+                  ssl.capath().empty() ? nullptr : ssl.capath().c_str(),
+                  ssl.cipher().empty() ? nullptr : ssl.cipher().c_str());
+    my_bool verify_server_cert = ssl.verify_server_cert() ? 1 : 0;
+    mysql_options(db, MYSQL_OPT_SSL_VERIFY_SERVER_CERT, &verify_server_cert);
+  }
+
+  // Connect to the MYSQL server.
+  if (!mysql_real_connect(
+          db, config.host().empty() ? nullptr : config.host().c_str(),
+          config.user().empty() ? nullptr : config.user().c_str(),
+          config.password().empty() ? nullptr : config.password().c_str(),
+          /*db=*/nullptr, config.port(),
+          config.socket().empty() ? nullptr : config.socket().c_str(),
+          client_flag)) {
+    return BuildErrorStatus(absl::StatusCode::kInternal,
+                            "mysql_real_connect failed", mysql_errno(db),
+                            mysql_error(db));
+  }
+  return absl::OkStatus();
+}
+
+// Returns the type of a typed column fetching the values of `field`. The
+// integer and floating point fields are fetched as numbers, and the others as
+// strings.
+RecordSet::Column::Type GetColumnType(const MYSQL_FIELD& field) {
+  switch (field.type) {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONGLONG:
+      return RecordSet::Column::INT;
+    case MYSQL_TYPE_FLOAT:
+    case MYSQL_TYPE_DOUBLE:
+      return RecordSet::Column::DOUBLE;
+    default:
+      return RecordSet::Column::STRING;
+  }
+}
 }  // namespace
 
 MySqlMetadataSource::MySqlMetadataSource(const MySQLDatabaseConfig& config)
@@ -143,34 +239,16 @@ Status MySqlMetadataSource::ConnectImpl() {
   MLMD_RETURN_WITH_CONTEXT_IF_ERROR(ThreadInitAccess(),
                                     "MySql thread init failed at ConnectImpl");
 
-  // Set connection options
-  if (config_.has_ssl_options()) {
-    const MySQLDatabaseConfig::SSLOptions& ssl = config_.ssl_options();
-    // The method set mysql_options, and always return 0. The connection options
-    // are used in the `mysql_real_connect`.
-    mysql_ssl_set(db_, ssl.key().empty() ? nullptr : ssl.key().c_str(),
-                  ssl.cert().empty() ? nullptr : ssl.cert().c_str(),
-                  ssl.ca().empty() ? nullptr : ssl.ca().c_str(),
-                  ssl.capath().empty() ? nullptr : ssl.capath().c_str(),
-                  ssl.cipher().empty() ? nullptr : ssl.cipher().c_str());
-    my_bool verify_server_cert = ssl.verify_server_cert() ? 1 : 0;
-    mysql_options(db_, MYSQL_OPT_SSL_VERIFY_SERVER_CERT, &verify_server_cert);
-  }
-
   // Connect to the MYSQL server.
-  db_ = mysql_real_connect(
-          db_, config_.host().empty() ? nullptr : config_.host().c_str(),
-          config_.user().empty() ? nullptr : config_.user().c_str(),
-          config_.password().empty() ? nullptr : config_.password().c_str(),
-          /*db=*/nullptr, config_.port(),
-          config_.socket().empty() ? nullptr : config_.socket().c_str(),
-          /*clientflag=*/0UL);
-
-  if (!db_) {
-    return BuildErrorStatus(absl::StatusCode::kInternal,
-                            "mysql_real_connect failed", mysql_errno(db_),
-                            mysql_error(db_));
+  const unsigned long client_flag =  // NOLINT
+      config_.enable_query_pipelining() ? CLIENT_MULTI_STATEMENTS : 0UL;
+  const Status connect_status = RealConnect(config_, client_flag, db_);
+  if (!connect_status.ok()) {
+    mysql_close(db_);
+    db_ = nullptr;
+    return connect_status;
   }
+  connection_id_ = mysql_thread_id(db_);
 
   // Return an error if the default storage engine doesn't support transactions.
   MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
@@ -203,8 +281,11 @@ Status MySqlMetadataSource::CloseImpl() {
   if (db_ != nullptr) {
     MLMD_RETURN_IF_ERROR(ThreadInitAccess());
     DiscardResultSet();
+    ClearPreparedStatements();
     mysql_close(db_);
     db_ = nullptr;
+    connection_id_ = 0;
+    last_insert_id_ = 0;
   }
   return absl::OkStatus();
 }
@@ -215,7 +296,7 @@ Status MySqlMetadataSource::ExecuteQueryImpl(const std::string& query,
       ThreadInitAccess(), "MySql thread init failed at ExecuteQueryImpl");
 
   // Run the query.
-  MLMD_RETURN_IF_ERROR(RunQuery(query));
+  MLMD_RETURN_IF_ERROR(RunQuery(WithMaxExecutionTime(query)));
 
   // If query is successfull, convert the results.
   MLMD_RETURN_WITH_CONTEXT_IF_ERROR(ConvertMySqlRowSetToRecordSet(results),
@@ -224,6 +305,76 @@ Status MySqlMetadataSource::ExecuteQueryImpl(const std::string& query,
   return absl::OkStatus();
 }
 
+Status MySqlMetadataSource::ExplainQueryImpl(const std::string& query,
+                                             RecordSet* plan) {
+  return ExecuteQueryImpl(absl::StrCat("EXPLAIN ", query), plan);
+}
+
+Status MySqlMetadataSource::ExecuteQueriesImpl(
+    const absl::Span<const std::string> queries,
+    const absl::Span<RecordSet* const> results) {
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      ThreadInitAccess(), "MySql thread init failed at ExecuteQueriesImpl");
+  DiscardResultSet();
+  std::vector<std::string> statements;
+  statements.reserve(queries.size());
+  for (const std::string& query : queries) {
+    statements.push_back(
+        WithMaxExecutionTime(std::string(StripStatementTerminator(query))));
+  }
+  const std::string batch = absl::StrJoin(statements, ";\n");
+  if (mysql_real_query(db_, batch.data(), batch.size())) {
+    return BuildQueryErrorStatus("mysql_real_query", mysql_errno(db_),
+                                 mysql_error(db_));
+  }
+  // Each statement returns a result, and the results are read in order. A
+  // failed statement ends the batch.
+  for (int i = 0;; i++) {
+    result_set_ = mysql_store_result(db_);
+    if (!result_set_ && mysql_field_count(db_) != 0) {
+      return BuildErrorStatus(
+          absl::StatusCode::kInternal,
+          absl::StrCat("mysql_store_result of statement ", i,
+                       " returned an unexpected NULL result_set"),
+          mysql_errno(db_), mysql_error(db_));
+    }
+    if (!result_set_ && mysql_insert_id(db_) != 0) {
+      last_insert_id_ = mysql_insert_id(db_);
+    }
+    if (i < results.size()) {
+      MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+          ConvertMySqlRowSetToRecordSet(results[i]),
+          "ConvertMySqlRowSetToRecordSet for query ", queries[i]);
+    }
+    DiscardResultSet();
+    const int next_result_status = mysql_next_result(db_);
+    if (next_result_status == -1) break;
+    if (next_result_status > 0) {
+      return BuildQueryErrorStatus("mysql_next_result", mysql_errno(db_),
+                                   mysql_error(db_));
+    }
+  }
+  return absl::OkStatus();
+}
+
+Status MySqlMetadataSource::ExecutePreparedQueryImpl(
+    const std::string& query, absl::Span<const Value> parameters,
+    RecordSet* results, const RecordSetLayout layout) {
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      ThreadInitAccess(),
+      "MySql thread init failed at ExecutePreparedQueryImpl");
+  DiscardResultSet();
+  MYSQL_STMT* stmt = nullptr;
+  MLMD_RETURN_IF_ERROR(GetPreparedStatement(query, &stmt));
+  const Status status =
+      RunPreparedStatement(stmt, parameters, layout, results);
+  // Releases the buffered rows, so that the statement can be executed again.
+  mysql_stmt_free_result(stmt);
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(status, "RunPreparedStatement for query ",
+                                    query);
+  return absl::OkStatus();
+}
+
 Status MySqlMetadataSource::CommitImpl() {
   MLMD_RETURN_WITH_CONTEXT_IF_ERROR(ThreadInitAccess(),
                                     "MySql thread init failed at CommitImpl");
@@ -244,6 +395,68 @@ Status MySqlMetadataSource::BeginImpl() {
   return RunQuery(kBeginTransaction);
 }
 
+Status MySqlMetadataSource::BeginReadOnlyImpl() {
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      ThreadInitAccess(), "MySql thread init failed at BeginReadOnlyImpl");
+
+  return RunQuery(kBeginReadOnlyTransaction);
+}
+
+Status MySqlMetadataSource::CheckConnectionImpl() {
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      ThreadInitAccess(), "MySql thread init failed at CheckConnectionImpl");
+  if (db_ == nullptr) {
+    return absl::UnavailableError("No MYSQL handler is initialized.");
+  }
+  if (mysql_ping(db_) != 0) {
+    return BuildErrorStatus(absl::StatusCode::kUnavailable,
+                            "mysql_ping failed", mysql_errno(db_),
+                            mysql_error(db_));
+  }
+  return absl::OkStatus();
+}
+
+
+Status MySqlMetadataSource::CancelQueryImpl() {
+  const unsigned long connection_id = connection_id_;  // NOLINT
+  if (connection_id == 0) {
+    return absl::OkStatus();
+  }
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      ThreadInitAccess(), "MySql thread init failed at CancelQueryImpl");
+  MYSQL* db = mysql_init(nullptr);
+  if (!db) {
+    return absl::InternalError("mysql_init failed at CancelQueryImpl");
+  }
+  Status status = RealConnect(config_, /*client_flag=*/0UL, db);
+  if (status.ok()) {
+    const std::string kill_query = absl::StrCat("KILL QUERY ", connection_id);
+    if (mysql_query(db, kill_query.c_str())) {
+      status = BuildQueryErrorStatus("KILL QUERY", mysql_errno(db),
+                                     mysql_error(db));
+    }
+  }
+  mysql_close(db);
+  return status;
+}
+
+std::string MySqlMetadataSource::WithMaxExecutionTime(
+    const std::string& query) const {
+  if (cancellation_token() == nullptr ||
+      cancellation_token()->deadline() == absl::InfiniteFuture()) {
+    return query;
+  }
+  absl::string_view statement = absl::StripLeadingAsciiWhitespace(query);
+  if (!absl::StartsWithIgnoreCase(statement, "SELECT ")) {
+    return query;
+  }
+  statement.remove_prefix(/*SELECT */ 7);
+  // The query is bounded by at least 1 millisecond, as 0 disables the bound.
+  const int64 max_execution_time_ms = std::max<int64>(
+      1, absl::ToInt64Milliseconds(cancellation_token()->TimeLeft()));
+  return absl::StrCat("SELECT /*+ MAX_EXECUTION_TIME(", max_execution_time_ms,
+                      ") */ ", statement);
+}
 
 Status MySqlMetadataSource::CheckTransactionSupport() {
   constexpr char kCheckTransactionSupport[] =
@@ -279,23 +492,15 @@ Status MySqlMetadataSource::RunQuery(const std::string& query) {
     // 2006: sever closes the connection due to inactive client;
     // client reports server has gone away, we reconnect the server for the
     // client if the query is begin transaction.
-    if (error_number == 2006 && query == kBeginTransaction) {
+    if (error_number == 2006 && (query == kBeginTransaction ||
+                                 query == kBeginReadOnlyTransaction)) {
       MLMD_RETURN_IF_ERROR(CloseImpl());
       MLMD_RETURN_IF_ERROR(ConnectImpl());
 
       return RunQuery(query);
     }
-    // When running concurrent transactions for error codes:
-    // 1213: Deadlock detection on wait lock.
-    // 1205: Lock wait timeout.
-    // returns Aborted for client side to retry.
-    if (error_number == 1213 || error_number == 1205) {
-      return BuildErrorStatus(absl::StatusCode::kAborted, "mysql_query aborted",
-                              error_number, mysql_error(db_));
-    }
-
-    return BuildErrorStatus(absl::StatusCode::kInternal, "mysql_query failed",
-                            error_number, mysql_error(db_));
+    return BuildQueryErrorStatus("mysql_query", error_number,
+                                 mysql_error(db_));
   }
   // Updated database_name_ if the incoming query was "USE <database>" query and
   // run successfully.
@@ -309,6 +514,10 @@ Status MySqlMetadataSource::RunQuery(const std::string& query) {
                      "returned an unexpected NULL result_set"),
         mysql_errno(db_), mysql_error(db_));
   }
+  num_rows_changed_ = result_set_ == nullptr ? mysql_affected_rows(db_) : 0;
+  if (result_set_ == nullptr && mysql_insert_id(db_) != 0) {
+    last_insert_id_ = mysql_insert_id(db_);
+  }
 
   return absl::OkStatus();
 }
@@ -347,6 +556,8 @@ Status MySqlMetadataSource::ConvertMySqlRowSetToRecordSet(
 
   MYSQL_ROW row;
   while ((row = mysql_fetch_row(result_set_)) != nullptr) {
+    // The lengths of the values, which may be binary, e.g., the proto values.
+    const unsigned long* lengths = mysql_fetch_lengths(result_set_);  // NOLINT
     RecordSet::Record record;
     std::vector<std::string> col_names;
 
@@ -365,7 +576,7 @@ Status MySqlMetadataSource::ConvertMySqlRowSetToRecordSet(
       if (row[col] == nullptr && !(field->flags & NOT_NULL_FLAG)) {
         record.add_values(kMetadataSourceNull);
       } else {
-        record.add_values(absl::StrCat(row[col]));
+        record.add_values(row[col], lengths[col]);
       }
     }
     *record_set.mutable_records()->Add() = record;
@@ -381,6 +592,221 @@ Status MySqlMetadataSource::ConvertMySqlRowSetToRecordSet(
   return absl::OkStatus();
 }
 
+Status MySqlMetadataSource::GetPreparedStatement(const std::string& query,
+                                                 MYSQL_STMT** stmt) {
+  auto it = prepared_statements_.find(query);
+  if (it != prepared_statements_.end()) {
+    *stmt = it->second;
+    return absl::OkStatus();
+  }
+  *stmt = mysql_stmt_init(db_);
+  if (*stmt == nullptr) {
+    return BuildErrorStatus(absl::StatusCode::kInternal,
+                            "mysql_stmt_init failed", mysql_errno(db_),
+                            mysql_error(db_));
+  }
+  if (mysql_stmt_prepare(*stmt, query.data(), query.size())) {
+    const Status status = BuildErrorStatus(
+        absl::StatusCode::kInternal, "mysql_stmt_prepare failed",
+        mysql_stmt_errno(*stmt), mysql_stmt_error(*stmt));
+    mysql_stmt_close(*stmt);
+    *stmt = nullptr;
+    return status;
+  }
+  if (prepared_statements_.size() >= kMaxNumPreparedStatements) {
+    ClearPreparedStatements();
+  }
+  prepared_statements_.insert({query, *stmt});
+  return absl::OkStatus();
+}
+
+Status MySqlMetadataSource::RunPreparedStatement(
+    MYSQL_STMT* stmt, absl::Span<const Value> parameters,
+    const RecordSetLayout layout, RecordSet* record_set_out) {
+  if (mysql_stmt_param_count(stmt) != parameters.size()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "The query has ", mysql_stmt_param_count(stmt), " placeholders, but ",
+        parameters.size(), " parameters are given."));
+  }
+  // The numeric values are copied, as MYSQL_BIND takes non-const buffers, and
+  // the proto values are serialized.
+  std::vector<MYSQL_BIND> params(parameters.size());
+  std::vector<long long> int_values(parameters.size());  // NOLINT
+  std::vector<double> double_values(parameters.size());
+  std::vector<std::string> proto_values(parameters.size());
+  for (int i = 0; i < parameters.size(); i++) {
+    const Value& parameter = parameters[i];
+    MYSQL_BIND& param = params[i];
+    switch (parameter.value_case()) {
+      case Value::kIntValue:
+        int_values[i] = parameter.int_value();
+        param.buffer_type = MYSQL_TYPE_LONGLONG;
+        param.buffer = &int_values[i];
+        break;
+      case Value::kDoubleValue:
+        double_values[i] = parameter.double_value();
+        param.buffer_type = MYSQL_TYPE_DOUBLE;
+        param.buffer = &double_values[i];
+        break;
+      case Value::kStringValue:
+        param.buffer_type = MYSQL_TYPE_STRING;
+        param.buffer = const_cast<char*>(parameter.string_value().data());
+        param.buffer_length = parameter.string_value().size();
+        break;
+      case Value::kProtoValue:
+        proto_values[i] = parameter.proto_value().SerializeAsString();
+        param.buffer_type = MYSQL_TYPE_BLOB;
+        param.buffer = &proto_values[i][0];
+        param.buffer_length = proto_values[i].size();
+        break;
+      case Value::VALUE_NOT_SET:
+        param.buffer_type = MYSQL_TYPE_NULL;
+        break;
+      default:
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Unsupported parameter type: ", parameter.DebugString()));
+    }
+  }
+  if (!params.empty() && mysql_stmt_bind_param(stmt, params.data())) {
+    return BuildErrorStatus(absl::StatusCode::kInternal,
+                            "mysql_stmt_bind_param failed",
+                            mysql_stmt_errno(stmt), mysql_stmt_error(stmt));
+  }
+  if (mysql_stmt_execute(stmt)) {
+    return BuildQueryErrorStatus("mysql_stmt_execute", mysql_stmt_errno(stmt),
+                                 mysql_stmt_error(stmt));
+  }
+
+  // Returns if the statement does not produce a result set, e.g., insert.
+  MYSQL_RES* metadata = mysql_stmt_result_metadata(stmt);
+  if (metadata == nullptr) {
+    num_rows_changed_ = mysql_stmt_affected_rows(stmt);
+    if (mysql_stmt_insert_id(stmt) != 0) {
+      last_insert_id_ = mysql_stmt_insert_id(stmt);
+    }
+    return absl::OkStatus();
+  }
+  num_rows_changed_ = 0;
+  const uint32 num_cols = mysql_num_fields(metadata);
+  const MYSQL_FIELD* fields = mysql_fetch_fields(metadata);
+  RecordSet record_set;
+  for (uint32 col = 0; col < num_cols; ++col) {
+    record_set.add_column_names(fields[col].org_name);
+    if (layout == RecordSetLayout::kTypedColumns) {
+      record_set.add_columns()->set_type(GetColumnType(fields[col]));
+    }
+  }
+  mysql_free_result(metadata);
+
+  // Fetches the numbers of typed columns in the binary format, and the other
+  // columns as strings, so that the records are converted in the same way as
+  // ConvertMySqlRowSetToRecordSet.
+  std::vector<MYSQL_BIND> columns(num_cols);
+  std::vector<long long> int_buffers(num_cols);  // NOLINT
+  std::vector<double> double_buffers(num_cols);
+  std::vector<std::string> string_buffers(num_cols);
+  std::vector<unsigned long> lengths(num_cols);  // NOLINT
+  std::vector<my_bool> is_nulls(num_cols);
+  for (uint32 col = 0; col < num_cols; ++col) {
+    const RecordSet::Column::Type type = record_set.columns().empty()
+                                             ? RecordSet::Column::STRING
+                                             : record_set.columns(col).type();
+    switch (type) {
+      case RecordSet::Column::INT:
+        columns[col].buffer_type = MYSQL_TYPE_LONGLONG;
+        columns[col].buffer = &int_buffers[col];
+        break;
+      case RecordSet::Column::DOUBLE:
+        columns[col].buffer_type = MYSQL_TYPE_DOUBLE;
+        columns[col].buffer = &double_buffers[col];
+        break;
+      default:
+        string_buffers[col].resize(kColumnBufferSize);
+        columns[col].buffer_type = MYSQL_TYPE_STRING;
+        columns[col].buffer = &string_buffers[col][0];
+        columns[col].buffer_length = kColumnBufferSize;
+    }
+    columns[col].length = &lengths[col];
+    columns[col].is_null = &is_nulls[col];
+  }
+  if (mysql_stmt_bind_result(stmt, columns.data()) ||
+      mysql_stmt_store_result(stmt)) {
+    return BuildErrorStatus(absl::StatusCode::kInternal,
+                            "mysql_stmt_store_result failed",
+                            mysql_stmt_errno(stmt), mysql_stmt_error(stmt));
+  }
+  int num_rows = 0;
+  int fetch_status;
+  while ((fetch_status = mysql_stmt_fetch(stmt)) != MYSQL_NO_DATA) {
+    if (fetch_status != 0 && fetch_status != MYSQL_DATA_TRUNCATED) {
+      return BuildErrorStatus(absl::StatusCode::kInternal,
+                              "mysql_stmt_fetch failed", mysql_stmt_errno(stmt),
+                              mysql_stmt_error(stmt));
+    }
+    num_rows++;
+    RecordSet::Record* record = record_set.columns().empty()
+                                    ? record_set.add_records()
+                                    : nullptr;
+    for (uint32 col = 0; col < num_cols; ++col) {
+      RecordSet::Column* typed_column =
+          record == nullptr ? record_set.mutable_columns(col) : nullptr;
+      if (is_nulls[col]) {
+        if (typed_column != nullptr) {
+          AppendNullValue(typed_column);
+        } else {
+          record->add_values(kMetadataSourceNull);
+        }
+        continue;
+      }
+      if (columns[col].buffer_type == MYSQL_TYPE_LONGLONG) {
+        AppendInt64Value(int_buffers[col], typed_column);
+        continue;
+      }
+      if (columns[col].buffer_type == MYSQL_TYPE_DOUBLE) {
+        AppendDoubleValue(double_buffers[col], typed_column);
+        continue;
+      }
+      std::string value;
+      if (lengths[col] <= kColumnBufferSize) {
+        value.assign(string_buffers[col].data(), lengths[col]);
+      } else {
+        // Fetches the truncated value again with a large enough buffer.
+        value.resize(lengths[col]);
+        MYSQL_BIND column = {};
+        column.buffer_type = MYSQL_TYPE_STRING;
+        column.buffer = &value[0];
+        column.buffer_length = value.size();
+        if (mysql_stmt_fetch_column(stmt, &column, col, /*offset=*/0)) {
+          return BuildErrorStatus(
+              absl::StatusCode::kInternal, "mysql_stmt_fetch_column failed",
+              mysql_stmt_errno(stmt), mysql_stmt_error(stmt));
+        }
+      }
+      if (typed_column != nullptr) {
+        AppendStringValue(value, typed_column);
+      } else {
+        record->add_values(std::move(value));
+      }
+    }
+  }
+  // Keeps the same convention as ConvertMySqlRowSetToRecordSet, which only
+  // sets the column names if any row is returned.
+  if (num_rows == 0) {
+    record_set.Clear();
+  }
+  if (record_set_out != nullptr) {
+    *record_set_out = std::move(record_set);
+  }
+  return absl::OkStatus();
+}
+
+void MySqlMetadataSource::ClearPreparedStatements() {
+  for (const auto& query_and_stmt : prepared_statements_) {
+    mysql_stmt_close(query_and_stmt.second);
+  }
+  prepared_statements_.clear();
+}
+
 std::string MySqlMetadataSource::EscapeString(absl::string_view value) const {
   CHECK(db_ != nullptr);
   // in the worst case, each character needs to be escaped by backslash, and the
@@ -394,4 +820,19 @@ std::string MySqlMetadataSource::EscapeString(absl::string_view value) const {
   return result;
 }
 
+void MySqlMetadataSource::AppendEscapedString(absl::string_view value,
+                                              std::string* out) const {
+  CHECK(db_ != nullptr);
+  // Escapes into the end of `out`, which is resized for the worst case, and
+  // trimmed to the escaped length.
+  const size_t offset = out->size();
+  out->resize(offset + value.length() * 2 + 1);
+  const unsigned long length =  // NOLINT
+      mysql_real_escape_string(db_, &(*out)[offset], value.data(),
+                               value.length());
+  CHECK(length != -1UL) << "NO_BACKSLASH_ESCAPES SQL mode should not be "
+                           "enabled.";
+  out->resize(offset + length);
+}
+
 }  // namespace ml_metadata
@@ -15,9 +15,12 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_MYSQL_METADATA_SOURCE_H_
 #define ML_METADATA_METADATA_STORE_MYSQL_METADATA_SOURCE_H_
 
+#include <atomic>
 #include <string>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
@@ -44,30 +47,94 @@ class MySqlMetadataSource : public MetadataSource {
   // the metadata source is not connected.
   std::string EscapeString(absl::string_view value) const final;
 
+  // Escapes `value` with mysql_real_escape_string into `out`.
+  void AppendEscapedString(absl::string_view value,
+                           std::string* out) const final;
+
+  // Prepared statements are used if `enable_prepared_statements` is set.
+  bool SupportsPreparedStatements() const final {
+    return config_.enable_prepared_statements();
+  }
+
+  // Queries are pipelined as multi-statement queries if
+  // `enable_query_pipelining` is set.
+  bool SupportsQueryPipelining() const final {
+    return config_.enable_query_pipelining();
+  }
+
  private:
   // Connects to the MYSQL backend specified in options_.
   // Returns an INTERNAL error upon any errors from the MYSQL backend.
   absl::Status ConnectImpl() final;
 
   // Closes the existing open connection to the MYSQL backend.
-  // Any existing MYSQL_RES in `result_set_` is also cleaned up.
+  // Any existing MYSQL_RES in `result_set_` and the prepared statements are
+  // also cleaned up.
   absl::Status CloseImpl() final;
 
   // Opens a transaction.
   absl::Status BeginImpl() final;
 
+  // Opens a read-only transaction with a consistent snapshot.
+  absl::Status BeginReadOnlyImpl() final;
+
 
   // Executes a SQL statement and returns the rows if any.
   // Returns an INTERNAL error upon any errors from the MYSQL backend.
   absl::Status ExecuteQueryImpl(const std::string& query,
                                 RecordSet* results) final;
 
+  // Joins the queries into a multi-statement query, runs it in a single round
+  // trip, and reads the result of each statement in order.
+  // Returns an INTERNAL error upon any errors from the MYSQL backend.
+  absl::Status ExecuteQueriesImpl(absl::Span<const std::string> queries,
+                                  absl::Span<RecordSet* const> results) final;
+
+  // Binds the parameters to the cached MYSQL_STMT of the query, which is
+  // prepared with mysql_stmt_prepare at the first use, and fetches the rows.
+  // Returns an INTERNAL error upon any errors from the MYSQL backend.
+  absl::Status ExecutePreparedQueryImpl(const std::string& query,
+                                        absl::Span<const Value> parameters,
+                                        RecordSet* results,
+                                        RecordSetLayout layout) final;
+
+  // Returns the plan of the query with EXPLAIN.
+  // Returns an INTERNAL error upon any errors from the MYSQL backend.
+  absl::Status ExplainQueryImpl(const std::string& query,
+                                RecordSet* plan) final;
+
+  // Returns the rows changed by the last statement, as reported by
+  // mysql_affected_rows or mysql_stmt_affected_rows.
+  int64 NumRowsChangedImpl() final { return num_rows_changed_; }
+
+  // Returns the AUTO_INCREMENT id generated by the last insert, as reported by
+  // mysql_insert_id or mysql_stmt_insert_id.
+  absl::optional<int64> LastInsertIdImpl() final {
+    if (last_insert_id_ == 0) return absl::nullopt;
+    return last_insert_id_;
+  }
+
   // Commits the currently open transaction.
   absl::Status CommitImpl() final;
 
   // Rollbacks the currently open transaction.
   absl::Status RollbackImpl() final;
 
+  // Pings the MYSQL backend with mysql_ping.
+  // Returns an UNAVAILABLE error if the server cannot be reached.
+  absl::Status CheckConnectionImpl() final;
+
+  // Kills the running query of the connection with KILL QUERY, which is run
+  // on a separate short-lived connection, as this one is busy.
+  // Returns an INTERNAL error upon any errors from the MYSQL backend.
+  absl::Status CancelQueryImpl() final;
+
+  // Returns `query` bounded by the time left before the deadline of the
+  // cancellation token, if any, with a MAX_EXECUTION_TIME optimizer hint. The
+  // hint only applies to SELECT statements, and the other ones are returned
+  // as is.
+  std::string WithMaxExecutionTime(const std::string& query) const;
+
   // Returns an error if the default storage engine doesn't support transaction
   // or OK otherwise.
   absl::Status CheckTransactionSupport();
@@ -88,13 +155,42 @@ class MySqlMetadataSource : public MetadataSource {
   // Converts the MYSQL_RES in `result_set_` to `record_set_out`.
   absl::Status ConvertMySqlRowSetToRecordSet(RecordSet* record_set_out);
 
+  // Gets the cached prepared statement of the query, or prepares a new one.
+  // Returns an INTERNAL error upon any errors from the MYSQL backend.
+  absl::Status GetPreparedStatement(const std::string& query,
+                                    MYSQL_STMT** stmt);
+
+  // Binds the parameters to `stmt`, executes it and converts the fetched rows
+  // to `record_set_out`.
+  absl::Status RunPreparedStatement(MYSQL_STMT* stmt,
+                                    absl::Span<const Value> parameters,
+                                    RecordSetLayout layout,
+                                    RecordSet* record_set_out);
+
+  // Closes all cached prepared statements.
+  void ClearPreparedStatements();
+
   // The handler for the connection to the MYSQL backend.
   // Initialized in ConnectImpl().
   MYSQL* db_ = nullptr;
 
+  // The id of the connection, used to kill its running query from another
+  // thread, or 0 if it is not connected.
+  std::atomic<unsigned long> connection_id_{0};  // NOLINT
+
   // The ResultSet from the previously executed query in RunQuery.
   MYSQL_RES* result_set_ = nullptr;
 
+  // The rows changed by the last statement not returning a result set.
+  int64 num_rows_changed_ = 0;
+
+  // The id generated by the last insert of the connection, or 0 if none. As
+  // LAST_INSERT_ID(), it is kept by the statements not generating an id.
+  int64 last_insert_id_ = 0;
+
+  // The prepared statements of the connection keyed by the query.
+  absl::flat_hash_map<std::string, MYSQL_STMT*> prepared_statements_;
+
   // Config to connect to the MYSQL backend.
   const MySQLDatabaseConfig config_;
 
@@ -0,0 +1,92 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/parallel_reader.h"
+
+#include <glog/logging.h>
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+namespace {
+
+// The number of reads that can be queued per worker, beyond which the reads
+// are run by the calling thread.
+constexpr int kMaxQueuedReadsPerWorker = 4;
+
+// Tracks the reads of a Run that are not done yet.
+struct PendingReads {
+  bool AllDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+    return num_pending == 0;
+  }
+
+  absl::Mutex mu;
+  int num_pending ABSL_GUARDED_BY(mu) = 0;
+  absl::Status status ABSL_GUARDED_BY(mu);
+};
+
+// Runs `read` with a store leased from `pool`.
+absl::Status RunRead(const ParallelReader::Read& read,
+                     MetadataStorePool* pool) {
+  MetadataStorePool::ScopedStore store;
+  MLMD_RETURN_IF_ERROR(pool->Acquire(&store));
+  return read(store.get());
+}
+
+// Runs `read`, then records its status in `pending`.
+void RunPendingRead(const ParallelReader::Read& read, MetadataStorePool* pool,
+                    PendingReads* pending) {
+  const absl::Status status = RunRead(read, pool);
+  absl::MutexLock lock(&pending->mu);
+  if (pending->status.ok()) {
+    pending->status = status;
+  }
+  pending->num_pending--;
+}
+
+}  // namespace
+
+ParallelReader::ParallelReader(const ParallelReadConfig& config)
+    : chunk_size_(config.chunk_size()),
+      worker_pool_(config.num_workers(),
+                   config.num_workers() * kMaxQueuedReadsPerWorker) {
+  CHECK_GT(chunk_size_, 0) << "chunk_size must be positive.";
+}
+
+absl::Status ParallelReader::Run(absl::Span<const Read> reads,
+                                 MetadataStorePool* pool) {
+  if (reads.size() <= 1) {
+    return reads.empty() ? absl::OkStatus() : RunRead(reads.front(), pool);
+  }
+  PendingReads pending;
+  {
+    absl::MutexLock lock(&pending.mu);
+    pending.num_pending = reads.size();
+  }
+  for (int i = 1; i < reads.size(); i++) {
+    const Read* read = &reads[i];
+    if (!worker_pool_.Schedule(
+            [read, pool, &pending] { RunPendingRead(*read, pool, &pending); })) {
+      RunPendingRead(*read, pool, &pending);
+    }
+  }
+  RunPendingRead(reads.front(), pool, &pending);
+  absl::MutexLock lock(&pending.mu);
+  pending.mu.Await(absl::Condition(&pending, &PendingReads::AllDone));
+  return pending.status;
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,73 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_PARALLEL_READER_H_
+#define ML_METADATA_METADATA_STORE_PARALLEL_READER_H_
+
+#include <functional>
+
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/worker_pool.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// Runs independent reads in parallel, each with its own store leased from a
+// MetadataStorePool, e.g., to hydrate the nodes of a large request in chunks.
+// The reads run in separate transactions, so they do not see a single
+// snapshot of the store. It is thread-safe.
+//
+// Usage example:
+//
+//    ParallelReader reader(config);
+//    std::vector<ParallelReader::Read> reads;
+//    for (const GetArtifactsByIDRequest& chunk : chunks) {
+//      reads.push_back([&](MetadataStore* store) { ... });
+//    }
+//    MLMD_RETURN_IF_ERROR(reader.Run(reads, pool));
+class ParallelReader {
+ public:
+  using ParallelReadConfig = MetadataStoreServerConfig::ParallelReadConfig;
+
+  // A read of a store, e.g., a call of GetArtifactsByID with a chunk of ids.
+  using Read = std::function<absl::Status(MetadataStore* store)>;
+
+  // Check-fails if `num_workers` or `chunk_size` is not positive.
+  explicit ParallelReader(const ParallelReadConfig& config);
+
+  // Disallows copy.
+  ParallelReader(const ParallelReader&) = delete;
+  ParallelReader& operator=(const ParallelReader&) = delete;
+
+  // Runs `reads` in parallel, each with a store leased from `pool`, and
+  // returns once all of them are done. The calling thread runs a read too, as
+  // well as the reads that cannot be queued for a worker. The caller must not
+  // hold a store of `pool`, as the reads may wait for all of its stores.
+  // Returns the first error of the reads, or of leasing the stores.
+  absl::Status Run(absl::Span<const Read> reads, MetadataStorePool* pool);
+
+  // The max number of ids of nodes to be hydrated by a single read.
+  int chunk_size() const { return chunk_size_; }
+
+ private:
+  const int chunk_size_;
+  WorkerPool worker_pool_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_PARALLEL_READER_H_
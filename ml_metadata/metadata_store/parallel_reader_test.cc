@@ -0,0 +1,84 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/parallel_reader.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+namespace {
+
+using testing::ParseTextProtoOrDie;
+
+ConnectionConfig FakeDatabaseConfig() {
+  ConnectionConfig connection_config;
+  connection_config.mutable_fake_database();
+  return connection_config;
+}
+
+TEST(ParallelReaderTest, RunsAllReads) {
+  ParallelReader reader(
+      ParseTextProtoOrDie<ParallelReader::ParallelReadConfig>(
+          "num_workers: 4 chunk_size: 10"));
+  MetadataStorePool pool(
+      FakeDatabaseConfig(),
+      ParseTextProtoOrDie<MetadataStorePool::ConnectionPoolConfig>(
+          "max_size: 2"));
+  std::atomic<int> num_reads{0};
+  std::vector<ParallelReader::Read> reads;
+  for (int i = 0; i < 32; i++) {
+    reads.push_back([&num_reads](MetadataStore* store) {
+      GetArtifactTypesResponse response;
+      MLMD_RETURN_IF_ERROR(store->GetArtifactTypes({}, &response));
+      num_reads++;
+      return absl::OkStatus();
+    });
+  }
+  EXPECT_EQ(absl::OkStatus(), reader.Run(reads, &pool));
+  EXPECT_EQ(num_reads, 32);
+  EXPECT_LE(pool.num_open_stores(), 2);
+  EXPECT_EQ(reader.chunk_size(), 10);
+}
+
+TEST(ParallelReaderTest, ReturnsFirstError) {
+  ParallelReader reader(
+      ParseTextProtoOrDie<ParallelReader::ParallelReadConfig>(
+          "num_workers: 2"));
+  MetadataStorePool pool(FakeDatabaseConfig(),
+                         MetadataStorePool::ConnectionPoolConfig());
+  std::atomic<int> num_reads{0};
+  std::vector<ParallelReader::Read> reads;
+  for (int i = 0; i < 8; i++) {
+    reads.push_back([&num_reads, i](MetadataStore* store) {
+      num_reads++;
+      return i == 5 ? absl::NotFoundError("not found") : absl::OkStatus();
+    });
+  }
+  EXPECT_TRUE(absl::IsNotFound(reader.Run(reads, &pool)));
+  // The other reads still run.
+  EXPECT_EQ(num_reads, 8);
+  EXPECT_EQ(absl::OkStatus(), reader.Run({}, &pool));
+}
+
+}  // namespace
+}  // namespace ml_metadata
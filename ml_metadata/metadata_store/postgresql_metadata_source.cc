@@ -0,0 +1,886 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/postgresql_metadata_source.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/record_set_util.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/util/return_utils.h"
+#include "libpq-fe.h"
+
+namespace ml_metadata {
+
+namespace {
+
+using absl::Status;
+
+// The write transactions are serializable, so that the queries need no
+// locking clauses, and the conflicting transactions fail with a serialization
+// failure instead.
+constexpr char kBeginTransaction[] = "BEGIN ISOLATION LEVEL SERIALIZABLE";
+// A read-only transaction reads the snapshot established by its first query.
+constexpr char kBeginReadOnlyTransaction[] =
+    "BEGIN ISOLATION LEVEL REPEATABLE READ, READ ONLY";
+constexpr char kCommitTransaction[] = "COMMIT";
+constexpr char kRollbackTransaction[] = "ROLLBACK";
+
+// A failed statement aborts a PostgreSQL transaction, while MySQL and SQLite
+// only fail the statement, and the callers rely on the latter, e.g., to probe
+// for missing tables before creating them. So a write transaction takes a
+// savepoint when it begins, and the statements failing before its first write
+// are rolled back to it.
+constexpr char kSavepoint[] = "SAVEPOINT mlmd_begin";
+constexpr char kRollbackToSavepoint[] = "ROLLBACK TO SAVEPOINT mlmd_begin";
+
+// The database connected to for creating the configured database.
+constexpr char kMaintenanceDatabase[] = "postgres";
+
+// The max number of prepared statements cached for a connection. The queries
+// having IN lists are prepared for each list size, so the cache is cleared
+// when it is full.
+constexpr int kMaxNumPreparedStatements = 256;
+
+// url key used for storing custom error information in the absl::Status
+// payload.
+constexpr char kStatusErrorInfoUrl[] = "postgresql-error-info";
+
+// The SQLSTATE of duplicate_database.
+constexpr char kDuplicateDatabase[] = "42P04";
+
+// The type oids of the values fetched in the binary format (see
+// src/include/catalog/pg_type.dat).
+constexpr Oid kBoolOid = 16;
+constexpr Oid kByteaOid = 17;
+constexpr Oid kCharOid = 18;
+constexpr Oid kNameOid = 19;
+constexpr Oid kInt8Oid = 20;
+constexpr Oid kInt2Oid = 21;
+constexpr Oid kInt4Oid = 23;
+constexpr Oid kTextOid = 25;
+constexpr Oid kOidOid = 26;
+constexpr Oid kJsonOid = 114;
+constexpr Oid kFloat4Oid = 700;
+constexpr Oid kFloat8Oid = 701;
+constexpr Oid kUnknownOid = 705;
+constexpr Oid kBpcharOid = 1042;
+constexpr Oid kVarcharOid = 1043;
+
+// The results are requested in the binary format.
+constexpr int kBinaryFormat = 1;
+
+// Checks if config is valid.
+Status CheckConfig(const PostgreSQLDatabaseConfig& config) {
+  if (config.dbname().empty()) {
+    return absl::InvalidArgumentError("dbname must not be empty");
+  }
+  return absl::OkStatus();
+}
+
+// Returns the error message of libpq without the trailing newline.
+absl::string_view TrimErrorMessage(const char* message) {
+  return absl::StripTrailingAsciiWhitespace(message == nullptr ? "" : message);
+}
+
+// Builds absl::Status for the `status_code` and attaches `sqlstate` to the
+// payload of the status object.
+Status BuildErrorStatus(const absl::StatusCode status_code,
+                        const absl::string_view error_message,
+                        const absl::string_view sqlstate,
+                        const absl::string_view postgresql_error_message) {
+  auto error_status = absl::Status(
+      status_code, absl::StrCat(error_message, ": sqlstate: ", sqlstate,
+                                ", error: ", postgresql_error_message));
+  PostgreSQLSourceErrorInfo error_info;
+  error_info.set_sqlstate(std::string(sqlstate));
+  error_status.SetPayload(kStatusErrorInfoUrl,
+                          absl::Cord(error_info.SerializeAsString()));
+  return error_status;
+}
+
+// Returns true for the SQLSTATEs of the errors of concurrent transactions,
+// which are returned as Aborted for client side to retry:
+// serialization_failure, deadlock_detected and lock_not_available.
+bool IsRetryableSqlState(const absl::string_view sqlstate) {
+  return sqlstate == "40001" || sqlstate == "40P01" || sqlstate == "55P03";
+}
+
+// Builds the status of a failed query from its `result`, or from the error of
+// `conn` if the result is nullptr, e.g., when the server cannot be reached.
+Status BuildQueryErrorStatus(const absl::string_view error_message,
+                             const PGresult* result, const PGconn* conn) {
+  const char* sqlstate =
+      result == nullptr ? nullptr
+                        : PQresultErrorField(result, PG_DIAG_SQLSTATE);
+  const absl::string_view postgresql_error_message =
+      TrimErrorMessage(result == nullptr ? PQerrorMessage(conn)
+                                         : PQresultErrorMessage(result));
+  const absl::string_view code = sqlstate == nullptr ? "" : sqlstate;
+  if (IsRetryableSqlState(code)) {
+    return BuildErrorStatus(absl::StatusCode::kAborted,
+                            absl::StrCat(error_message, " aborted"), code,
+                            postgresql_error_message);
+  }
+  return BuildErrorStatus(absl::StatusCode::kInternal,
+                          absl::StrCat(error_message, " failed"), code,
+                          postgresql_error_message);
+}
+
+// Connects to the server of `config` and the database `dbname`.
+Status ConnectToDatabase(const PostgreSQLDatabaseConfig& config,
+                         const std::string& dbname, PGconn** conn) {
+  std::vector<const char*> keywords;
+  std::vector<const char*> values;
+  const auto add_option = [&](const char* keyword, const std::string& value) {
+    if (!value.empty()) {
+      keywords.push_back(keyword);
+      values.push_back(value.c_str());
+    }
+  };
+  const std::string port =
+      config.has_port() ? absl::StrCat(config.port()) : std::string();
+  add_option("host", config.host());
+  add_option("port", port);
+  add_option("dbname", dbname);
+  add_option("user", config.user());
+  add_option("password", config.password());
+  keywords.push_back("client_encoding");
+  values.push_back("UTF8");
+  if (config.has_ssl_options()) {
+    const PostgreSQLDatabaseConfig::SSLOptions& ssl = config.ssl_options();
+    add_option("sslmode", ssl.sslmode());
+    add_option("sslcert", ssl.sslcert());
+    add_option("sslkey", ssl.sslkey());
+    add_option("sslrootcert", ssl.sslrootcert());
+  }
+  keywords.push_back(nullptr);
+  values.push_back(nullptr);
+  *conn = PQconnectdbParams(keywords.data(), values.data(),
+                            /*expand_dbname=*/0);
+  if (*conn == nullptr) {
+    return absl::InternalError("PQconnectdbParams failed: out of memory");
+  }
+  if (PQstatus(*conn) != CONNECTION_OK) {
+    const Status status = BuildErrorStatus(
+        absl::StatusCode::kInternal,
+        absl::StrCat("PQconnectdbParams to ", dbname, " failed"),
+        /*sqlstate=*/"", TrimErrorMessage(PQerrorMessage(*conn)));
+    PQfinish(*conn);
+    *conn = nullptr;
+    return status;
+  }
+  return absl::OkStatus();
+}
+
+// Creates the database of `config` if it does not exist, on a separate
+// connection to the maintenance database, as CREATE DATABASE cannot run in
+// the configured one before it exists.
+Status CreateDatabaseIfNotExists(const PostgreSQLDatabaseConfig& config) {
+  PGconn* conn = nullptr;
+  MLMD_RETURN_IF_ERROR(ConnectToDatabase(config, kMaintenanceDatabase, &conn));
+  Status status = absl::OkStatus();
+  const char* dbname = config.dbname().c_str();
+  PGresult* result =
+      PQexecParams(conn, "SELECT 1 FROM pg_database WHERE datname = $1",
+                   /*nParams=*/1, /*paramTypes=*/nullptr, &dbname,
+                   /*paramLengths=*/nullptr, /*paramFormats=*/nullptr,
+                   /*resultFormat=*/0);
+  if (PQresultStatus(result) != PGRES_TUPLES_OK) {
+    status = BuildQueryErrorStatus("Checking database", result, conn);
+  } else if (PQntuples(result) == 0) {
+    char* identifier = PQescapeIdentifier(conn, config.dbname().data(),
+                                          config.dbname().size());
+    PQclear(result);
+    result = PQexec(conn, absl::StrCat("CREATE DATABASE ", identifier).c_str());
+    PQfreemem(identifier);
+    const char* sqlstate = PQresultErrorField(result, PG_DIAG_SQLSTATE);
+    // The database may be created by a concurrent connection.
+    if (PQresultStatus(result) != PGRES_COMMAND_OK &&
+        (sqlstate == nullptr ||
+         absl::string_view(sqlstate) != kDuplicateDatabase)) {
+      status = BuildQueryErrorStatus("CREATE DATABASE", result, conn);
+    }
+  }
+  PQclear(result);
+  PQfinish(conn);
+  return status;
+}
+
+// Returns the big-endian unsigned integer of `length` bytes at `data`.
+uint64_t ReadBigEndian(const char* data, const int length) {
+  uint64_t value = 0;
+  for (int i = 0; i < length; i++) {
+    value = (value << 8) | static_cast<unsigned char>(data[i]);
+  }
+  return value;
+}
+
+// Returns the type of a typed column fetching the values of the type `oid`.
+// The integers and booleans are fetched as INT, the floating point numbers as
+// DOUBLE, and the others as strings.
+RecordSet::Column::Type GetColumnType(const Oid oid) {
+  switch (oid) {
+    case kBoolOid:
+    case kInt2Oid:
+    case kInt4Oid:
+    case kInt8Oid:
+    case kOidOid:
+      return RecordSet::Column::INT;
+    case kFloat4Oid:
+    case kFloat8Oid:
+      return RecordSet::Column::DOUBLE;
+    default:
+      return RecordSet::Column::STRING;
+  }
+}
+
+// Decodes a value of the type `oid` in the binary format at `data` to the
+// number or string of its column type.
+Status DecodeBinaryValue(const Oid oid, const char* data, const int length,
+                         int64* int_value, double* double_value,
+                         std::string* string_value) {
+  switch (oid) {
+    case kBoolOid:
+      *int_value = length > 0 && data[0] != 0 ? 1 : 0;
+      return absl::OkStatus();
+    case kInt2Oid:
+      *int_value = static_cast<int16_t>(ReadBigEndian(data, 2));
+      return absl::OkStatus();
+    case kInt4Oid:
+      *int_value = static_cast<int32_t>(ReadBigEndian(data, 4));
+      return absl::OkStatus();
+    case kOidOid:
+      *int_value = static_cast<uint32_t>(ReadBigEndian(data, 4));
+      return absl::OkStatus();
+    case kInt8Oid:
+      *int_value = static_cast<int64>(ReadBigEndian(data, 8));
+      return absl::OkStatus();
+    case kFloat4Oid: {
+      const uint32_t bits = ReadBigEndian(data, 4);
+      float value;
+      std::memcpy(&value, &bits, sizeof(value));
+      *double_value = value;
+      return absl::OkStatus();
+    }
+    case kFloat8Oid: {
+      const uint64_t bits = ReadBigEndian(data, 8);
+      std::memcpy(double_value, &bits, sizeof(*double_value));
+      return absl::OkStatus();
+    }
+    // The binary format of the character types and bytea are the raw bytes.
+    case kByteaOid:
+    case kCharOid:
+    case kNameOid:
+    case kTextOid:
+    case kJsonOid:
+    case kUnknownOid:
+    case kBpcharOid:
+    case kVarcharOid:
+      string_value->assign(data, length);
+      return absl::OkStatus();
+    default:
+      return absl::InternalError(
+          absl::StrCat("Unsupported column type oid: ", oid));
+  }
+}
+
+// Returns the unescaped value of a double quoted string literal, whose
+// characters may be escaped with a backslash, at `query[begin]`, and sets
+// `end` to the position after the closing quote.
+std::string ReadDoubleQuotedLiteral(const absl::string_view query,
+                                    const size_t begin, size_t* end) {
+  std::string value;
+  size_t i = begin + 1;
+  while (i < query.size() && query[i] != '"') {
+    if (query[i] == '\\' && i + 1 < query.size()) {
+      switch (query[i + 1]) {
+        case 'n':
+          value.push_back('\n');
+          break;
+        case 'r':
+          value.push_back('\r');
+          break;
+        case 't':
+          value.push_back('\t');
+          break;
+        default:
+          value.push_back(query[i + 1]);
+      }
+      i += 2;
+    } else {
+      value.push_back(query[i++]);
+    }
+  }
+  *end = std::min(i + 1, query.size());
+  return value;
+}
+
+// Returns true if `c` may be part of an unquoted identifier.
+bool IsIdentifierChar(const char c) {
+  return absl::ascii_isalnum(c) || c == '_';
+}
+
+}  // namespace
+
+std::string TranslateQueryToPostgreSQL(const absl::string_view query,
+                                       int* num_placeholders) {
+  std::string result;
+  result.reserve(query.size());
+  if (num_placeholders != nullptr) {
+    *num_placeholders = 0;
+  }
+  size_t i = 0;
+  while (i < query.size()) {
+    const char c = query[i];
+    if (c == '\'') {
+      // Copies a single quoted literal, in which a quote is escaped as ''.
+      size_t end = i + 1;
+      while (end < query.size()) {
+        if (query[end] == '\'') {
+          if (end + 1 < query.size() && query[end + 1] == '\'') {
+            end += 2;
+            continue;
+          }
+          break;
+        }
+        end++;
+      }
+      end = std::min(end + 1, query.size());
+      absl::StrAppend(&result, query.substr(i, end - i));
+      i = end;
+    } else if (c == '`') {
+      // The unquoted identifiers of the filter queries are folded to lower
+      // case, so that the quoted ones are lower cased to match them.
+      size_t end = query.find('`', i + 1);
+      if (end == absl::string_view::npos) {
+        end = query.size();
+      }
+      absl::StrAppend(&result, "\"",
+                      absl::AsciiStrToLower(query.substr(i + 1, end - i - 1)),
+                      "\"");
+      i = std::min(end + 1, query.size());
+    } else if (c == '"') {
+      size_t end;
+      const std::string value = ReadDoubleQuotedLiteral(query, i, &end);
+      result.push_back('\'');
+      for (const char v : value) {
+        if (v == '\'') {
+          result.push_back('\'');
+        }
+        result.push_back(v);
+      }
+      result.push_back('\'');
+      i = end;
+    } else if ((c == 'X' || c == 'x') && i + 1 < query.size() &&
+               query[i + 1] == '\'' &&
+               (i == 0 || !IsIdentifierChar(query[i - 1]))) {
+      size_t end = query.find('\'', i + 2);
+      if (end == absl::string_view::npos) {
+        end = query.size();
+      }
+      absl::StrAppend(&result, "CAST('\\x", query.substr(i + 2, end - i - 2),
+                      "' AS BYTEA)");
+      i = std::min(end + 1, query.size());
+    } else if (c == '?' && num_placeholders != nullptr) {
+      absl::StrAppend(&result, "$", ++(*num_placeholders));
+      i++;
+    } else {
+      result.push_back(c);
+      i++;
+    }
+  }
+  return result;
+}
+
+PostgreSQLMetadataSource::PostgreSQLMetadataSource(
+    const PostgreSQLDatabaseConfig& config)
+    : MetadataSource(), config_(config) {
+  CHECK_EQ(absl::OkStatus(), CheckConfig(config));
+}
+
+PostgreSQLMetadataSource::~PostgreSQLMetadataSource() {
+  CHECK_EQ(absl::OkStatus(), CloseImpl());
+}
+
+Status PostgreSQLMetadataSource::ConnectImpl() {
+  // Create the database if not already present and skip_db_creation is false.
+  if (!config_.skip_db_creation()) {
+    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(CreateDatabaseIfNotExists(config_),
+                                      "Creating database ", config_.dbname(),
+                                      " in ConnectImpl");
+  }
+  MLMD_RETURN_IF_ERROR(ConnectToDatabase(config_, config_.dbname(), &conn_));
+  cancel_ = PQgetCancel(conn_);
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::CloseImpl() {
+  if (conn_ != nullptr) {
+    if (cancel_ != nullptr) {
+      PQfreeCancel(cancel_);
+      cancel_ = nullptr;
+    }
+    // The prepared statements are released with the session.
+    prepared_statements_.clear();
+    PQfinish(conn_);
+    conn_ = nullptr;
+  }
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::ExecuteQueryImpl(const std::string& query,
+                                                  RecordSet* results) {
+  const std::string statement =
+      TranslateQueryToPostgreSQL(query, /*num_placeholders=*/nullptr);
+  PGresult* result = PQexecParams(
+      conn_, statement.c_str(), /*nParams=*/0, /*paramTypes=*/nullptr,
+      /*paramValues=*/nullptr, /*paramLengths=*/nullptr,
+      /*paramFormats=*/nullptr, kBinaryFormat);
+  const Status status =
+      ConvertResultToRecordSet(result, RecordSetLayout::kRecords, results);
+  PQclear(result);
+  MLMD_RETURN_IF_ERROR(FinishStatement(query, status));
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::ExplainQueryImpl(const std::string& query,
+                                                  RecordSet* plan) {
+  return ExecuteQueryImpl(absl::StrCat("EXPLAIN ", query), plan);
+}
+
+Status PostgreSQLMetadataSource::ExecuteQueriesImpl(
+    const absl::Span<const std::string> queries,
+    const absl::Span<RecordSet* const> results) {
+  if (PQenterPipelineMode(conn_) != 1) {
+    return BuildQueryErrorStatus("PQenterPipelineMode", /*result=*/nullptr,
+                                 conn_);
+  }
+  Status status = absl::OkStatus();
+  int num_sent = 0;
+  for (const std::string& query : queries) {
+    const std::string statement =
+        TranslateQueryToPostgreSQL(query, /*num_placeholders=*/nullptr);
+    if (PQsendQueryParams(conn_, statement.c_str(), /*nParams=*/0,
+                          /*paramTypes=*/nullptr, /*paramValues=*/nullptr,
+                          /*paramLengths=*/nullptr, /*paramFormats=*/nullptr,
+                          kBinaryFormat) != 1) {
+      status = BuildQueryErrorStatus("PQsendQueryParams", /*result=*/nullptr,
+                                     conn_);
+      break;
+    }
+    num_sent++;
+  }
+  if (PQpipelineSync(conn_) != 1 && status.ok()) {
+    status =
+        BuildQueryErrorStatus("PQpipelineSync", /*result=*/nullptr, conn_);
+  }
+  // Each query returns a result followed by nullptr, and the queries after a
+  // failed one return PGRES_PIPELINE_ABORTED.
+  std::vector<Status> query_statuses;
+  for (int i = 0; i < num_sent; i++) {
+    PGresult* result = PQgetResult(conn_);
+    if (result == nullptr) {
+      if (status.ok()) {
+        status = absl::InternalError(
+            absl::StrCat("Missing the result of pipelined query ", i));
+      }
+      break;
+    }
+    query_statuses.push_back(ConvertResultToRecordSet(
+        result, RecordSetLayout::kRecords,
+        i < results.size() ? results[i] : nullptr));
+    PQclear(result);
+    while ((result = PQgetResult(conn_)) != nullptr) {
+      PQclear(result);
+    }
+  }
+  // Reads the results up to the synchronization point, so that the connection
+  // can leave the pipeline mode.
+  while (PQstatus(conn_) == CONNECTION_OK) {
+    PGresult* result = PQgetResult(conn_);
+    if (result == nullptr) {
+      continue;
+    }
+    const bool synced = PQresultStatus(result) == PGRES_PIPELINE_SYNC;
+    PQclear(result);
+    if (synced) break;
+  }
+  if (PQexitPipelineMode(conn_) != 1 && status.ok()) {
+    status =
+        BuildQueryErrorStatus("PQexitPipelineMode", /*result=*/nullptr, conn_);
+  }
+  // The statuses are finished after leaving the pipeline mode, as a failed
+  // statement may be rolled back to the savepoint. The first error is
+  // returned.
+  for (int i = 0; i < query_statuses.size(); i++) {
+    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+        FinishStatement(queries[i], query_statuses[i]),
+        "Pipelined query ", queries[i]);
+  }
+  return status;
+}
+
+Status PostgreSQLMetadataSource::ExecutePreparedQueryImpl(
+    const std::string& query, absl::Span<const Value> parameters,
+    RecordSet* results, const RecordSetLayout layout) {
+  const PreparedStatement* statement = nullptr;
+  MLMD_RETURN_IF_ERROR(GetPreparedStatement(query, &statement));
+  if (statement->num_parameters != parameters.size()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "The query has ", statement->num_parameters, " placeholders, but ",
+        parameters.size(), " parameters are given."));
+  }
+  // The numbers are sent as text, and inferred as the types of the columns
+  // they are compared with or assigned to. The proto values are sent as
+  // binary bytea.
+  std::vector<std::string> buffers(parameters.size());
+  std::vector<const char*> values(parameters.size());
+  std::vector<int> lengths(parameters.size());
+  std::vector<int> formats(parameters.size());
+  for (int i = 0; i < parameters.size(); i++) {
+    const Value& parameter = parameters[i];
+    switch (parameter.value_case()) {
+      case Value::kIntValue:
+        buffers[i] = absl::StrCat(parameter.int_value());
+        values[i] = buffers[i].c_str();
+        break;
+      case Value::kDoubleValue:
+        buffers[i] = absl::StrFormat("%.17g", parameter.double_value());
+        values[i] = buffers[i].c_str();
+        break;
+      case Value::kStringValue:
+        values[i] = parameter.string_value().c_str();
+        break;
+      case Value::kProtoValue:
+        buffers[i] = parameter.proto_value().SerializeAsString();
+        values[i] = buffers[i].data();
+        lengths[i] = buffers[i].size();
+        formats[i] = kBinaryFormat;
+        break;
+      case Value::VALUE_NOT_SET:
+        values[i] = nullptr;
+        break;
+      default:
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Unsupported parameter type: ", parameter.DebugString()));
+    }
+  }
+  PGresult* result =
+      PQexecPrepared(conn_, statement->name.c_str(), parameters.size(),
+                     values.data(), lengths.data(), formats.data(),
+                     kBinaryFormat);
+  const Status status = ConvertResultToRecordSet(result, layout, results);
+  PQclear(result);
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(FinishStatement(query, status),
+                                    "PQexecPrepared for query ", query);
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::CommitImpl() {
+  PGresult* result = PQexec(conn_, kCommitTransaction);
+  Status status = absl::OkStatus();
+  if (PQresultStatus(result) != PGRES_COMMAND_OK) {
+    status = BuildQueryErrorStatus(kCommitTransaction, result, conn_);
+  } else if (absl::string_view(PQcmdStatus(result)) == kRollbackTransaction) {
+    // COMMIT rolls back a transaction aborted by a failed statement.
+    status = absl::AbortedError(
+        "COMMIT rolled back the transaction aborted by a failed statement");
+  }
+  PQclear(result);
+  return status;
+}
+
+Status PostgreSQLMetadataSource::RollbackImpl() {
+  return RunCommand(kRollbackTransaction);
+}
+
+Status PostgreSQLMetadataSource::BeginImpl() {
+  MLMD_RETURN_IF_ERROR(
+      BeginTransaction(absl::StrCat(kBeginTransaction, "; ", kSavepoint)));
+  can_rollback_to_savepoint_ = true;
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::BeginReadOnlyImpl() {
+  can_rollback_to_savepoint_ = false;
+  return BeginTransaction(kBeginReadOnlyTransaction);
+}
+
+Status PostgreSQLMetadataSource::CheckConnectionImpl() {
+  if (conn_ == nullptr) {
+    return absl::UnavailableError("No PostgreSQL connection is initialized.");
+  }
+  PGresult* result = PQexec(conn_, "");
+  const bool ok = PQresultStatus(result) == PGRES_EMPTY_QUERY;
+  PQclear(result);
+  if (!ok || PQstatus(conn_) != CONNECTION_OK) {
+    return BuildErrorStatus(absl::StatusCode::kUnavailable,
+                            "PostgreSQL connection check failed",
+                            /*sqlstate=*/"",
+                            TrimErrorMessage(PQerrorMessage(conn_)));
+  }
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::CancelQueryImpl() {
+  if (cancel_ == nullptr) {
+    return absl::OkStatus();
+  }
+  char error_buffer[256];
+  if (PQcancel(cancel_, error_buffer, sizeof(error_buffer)) != 1) {
+    return BuildErrorStatus(absl::StatusCode::kInternal, "PQcancel failed",
+                            /*sqlstate=*/"", TrimErrorMessage(error_buffer));
+  }
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::BeginTransaction(
+    const std::string& begin_query) {
+  // The server may have closed the connection, e.g., due to an idle timeout,
+  // in which case it is reset before beginning the transaction.
+  if (PQstatus(conn_) == CONNECTION_BAD) {
+    PQreset(conn_);
+    if (PQstatus(conn_) != CONNECTION_OK) {
+      return BuildErrorStatus(absl::StatusCode::kInternal, "PQreset failed",
+                              /*sqlstate=*/"",
+                              TrimErrorMessage(PQerrorMessage(conn_)));
+    }
+    prepared_statements_.clear();
+    if (cancel_ != nullptr) {
+      PQfreeCancel(cancel_);
+    }
+    cancel_ = PQgetCancel(conn_);
+  }
+  if (cancellation_token() == nullptr ||
+      cancellation_token()->deadline() == absl::InfiniteFuture()) {
+    return RunCommand(begin_query);
+  }
+  // The statements are bounded by at least 1 millisecond, as 0 disables the
+  // bound.
+  const int64 statement_timeout_ms = std::max<int64>(
+      1, absl::ToInt64Milliseconds(cancellation_token()->TimeLeft()));
+  return RunCommand(absl::StrCat(
+      begin_query, "; SET LOCAL statement_timeout = ", statement_timeout_ms));
+}
+
+Status PostgreSQLMetadataSource::RunCommand(const std::string& query) {
+  PGresult* result = PQexec(conn_, query.c_str());
+  const ExecStatusType result_status = PQresultStatus(result);
+  Status status = absl::OkStatus();
+  if (result_status != PGRES_COMMAND_OK && result_status != PGRES_TUPLES_OK) {
+    status = BuildQueryErrorStatus(query, result, conn_);
+  }
+  PQclear(result);
+  return status;
+}
+
+Status PostgreSQLMetadataSource::FinishStatement(const std::string& query,
+                                                 const Status& status) {
+  if (!status.ok()) {
+    if (can_rollback_to_savepoint_) {
+      // Keeps the transaction usable, as nothing has been written yet.
+      RunCommand(kRollbackToSavepoint).IgnoreError();
+    }
+    return status;
+  }
+  // A statement other than a plain SELECT may write, e.g., the inserts of the
+  // CTEs, so that the later failures are no longer rolled back.
+  if (can_rollback_to_savepoint_ &&
+      !absl::StartsWithIgnoreCase(absl::StripLeadingAsciiWhitespace(query),
+                                  "SELECT")) {
+    can_rollback_to_savepoint_ = false;
+  }
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::ConvertResultToRecordSet(
+    const PGresult* result, const RecordSetLayout layout,
+    RecordSet* record_set_out) {
+  const ExecStatusType result_status = PQresultStatus(result);
+  if (result_status == PGRES_COMMAND_OK) {
+    int64 num_rows_changed = 0;
+    num_rows_changed_ =
+        absl::SimpleAtoi(PQcmdTuples(const_cast<PGresult*>(result)),
+                         &num_rows_changed)
+            ? num_rows_changed
+            : 0;
+    return absl::OkStatus();
+  }
+  if (result_status != PGRES_TUPLES_OK) {
+    return BuildQueryErrorStatus("PostgreSQL query", result, conn_);
+  }
+  // A SELECT changes no rows, unlike an INSERT ... RETURNING.
+  int64 num_rows_changed = 0;
+  num_rows_changed_ =
+      !absl::StartsWith(PQcmdStatus(const_cast<PGresult*>(result)), "SELECT") &&
+              absl::SimpleAtoi(PQcmdTuples(const_cast<PGresult*>(result)),
+                               &num_rows_changed)
+          ? num_rows_changed
+          : 0;
+
+  const int num_rows = PQntuples(result);
+  const int num_cols = PQnfields(result);
+  // Keeps the same convention as the other metadata sources, which only set
+  // the column names if any row is returned.
+  if (record_set_out == nullptr || num_rows == 0) {
+    if (record_set_out != nullptr) {
+      record_set_out->Clear();
+    }
+    return absl::OkStatus();
+  }
+  RecordSet record_set;
+  std::vector<Oid> types(num_cols);
+  for (int col = 0; col < num_cols; ++col) {
+    record_set.add_column_names(PQfname(result, col));
+    types[col] = PQftype(result, col);
+    if (layout == RecordSetLayout::kTypedColumns) {
+      record_set.add_columns()->set_type(GetColumnType(types[col]));
+    }
+  }
+  for (int row = 0; row < num_rows; ++row) {
+    RecordSet::Record* record = record_set.columns().empty()
+                                    ? record_set.add_records()
+                                    : nullptr;
+    for (int col = 0; col < num_cols; ++col) {
+      RecordSet::Column* typed_column =
+          record == nullptr ? record_set.mutable_columns(col) : nullptr;
+      if (PQgetisnull(result, row, col)) {
+        if (typed_column != nullptr) {
+          AppendNullValue(typed_column);
+        } else {
+          record->add_values(kMetadataSourceNull);
+        }
+        continue;
+      }
+      int64 int_value = 0;
+      double double_value = 0;
+      std::string string_value;
+      MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+          DecodeBinaryValue(types[col], PQgetvalue(result, row, col),
+                            PQgetlength(result, row, col), &int_value,
+                            &double_value, &string_value),
+          "Decoding column ", PQfname(result, col));
+      switch (GetColumnType(types[col])) {
+        case RecordSet::Column::INT:
+          if (typed_column != nullptr) {
+            AppendInt64Value(int_value, typed_column);
+          } else {
+            record->add_values(absl::StrCat(int_value));
+          }
+          break;
+        case RecordSet::Column::DOUBLE:
+          if (typed_column != nullptr) {
+            AppendDoubleValue(double_value, typed_column);
+          } else {
+            // Keeps the full precision of the double.
+            record->add_values(absl::StrFormat("%.17g", double_value));
+          }
+          break;
+        default:
+          if (typed_column != nullptr) {
+            AppendStringValue(string_value, typed_column);
+          } else {
+            record->add_values(std::move(string_value));
+          }
+      }
+    }
+  }
+  *record_set_out = std::move(record_set);
+  return absl::OkStatus();
+}
+
+Status PostgreSQLMetadataSource::GetPreparedStatement(
+    const std::string& query, const PreparedStatement** statement) {
+  auto it = prepared_statements_.find(query);
+  if (it != prepared_statements_.end()) {
+    *statement = &it->second;
+    return absl::OkStatus();
+  }
+  if (prepared_statements_.size() >= kMaxNumPreparedStatements) {
+    ClearPreparedStatements();
+  }
+  PreparedStatement prepared;
+  prepared.name = absl::StrCat("mlmd_", num_prepared_statements_++);
+  const std::string translated_query =
+      TranslateQueryToPostgreSQL(query, &prepared.num_parameters);
+  PGresult* result =
+      PQprepare(conn_, prepared.name.c_str(), translated_query.c_str(),
+                /*nParams=*/0, /*paramTypes=*/nullptr);
+  Status status = absl::OkStatus();
+  if (PQresultStatus(result) != PGRES_COMMAND_OK) {
+    status = FinishStatement(
+        query, BuildQueryErrorStatus("PQprepare", result, conn_));
+  }
+  PQclear(result);
+  MLMD_RETURN_IF_ERROR(status);
+  *statement =
+      &prepared_statements_.insert({query, std::move(prepared)}).first->second;
+  return absl::OkStatus();
+}
+
+void PostgreSQLMetadataSource::ClearPreparedStatements() {
+  RunCommand("DEALLOCATE ALL").IgnoreError();
+  prepared_statements_.clear();
+}
+
+std::string PostgreSQLMetadataSource::EscapeString(
+    absl::string_view value) const {
+  CHECK(conn_ != nullptr);
+  // In the worst case, each character needs to be escaped, and the string is
+  // appended an additional terminating null character.
+  std::string buffer(value.length() * 2 + 1, '\0');
+  int error = 0;
+  const size_t length = PQescapeStringConn(conn_, &buffer[0], value.data(),
+                                           value.length(), &error);
+  CHECK_EQ(error, 0) << "PQescapeStringConn failed: "
+                     << PQerrorMessage(conn_);
+  buffer.resize(length);
+  return buffer;
+}
+
+void PostgreSQLMetadataSource::AppendEscapedString(absl::string_view value,
+                                                   std::string* out) const {
+  CHECK(conn_ != nullptr);
+  // Escapes into the end of `out`, which is resized for the worst case, and
+  // trimmed to the escaped length.
+  const size_t offset = out->size();
+  out->resize(offset + value.length() * 2 + 1);
+  int error = 0;
+  const size_t length = PQescapeStringConn(conn_, &(*out)[offset],
+                                           value.data(), value.length(),
+                                           &error);
+  CHECK_EQ(error, 0) << "PQescapeStringConn failed: " << PQerrorMessage(conn_);
+  out->resize(offset + length);
+}
+
+}  // namespace ml_metadata
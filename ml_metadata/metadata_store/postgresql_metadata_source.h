@@ -0,0 +1,207 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_POSTGRESQL_METADATA_SOURCE_H_
+#define ML_METADATA_METADATA_STORE_POSTGRESQL_METADATA_SOURCE_H_
+
+#include <string>
+
+#include "absl/container/node_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "libpq-fe.h"
+
+namespace ml_metadata {
+
+// Returns `query`, written in the dialect shared by the query configs and the
+// filter query builder, in the PostgreSQL dialect:
+// * the backtick quoted identifiers are double quoted,
+// * the double quoted string literals are single quoted,
+// * the X'..' blob literals are cast to BYTEA, and
+// * if `num_placeholders` is not nullptr, the `?` placeholders are numbered
+//   as $1, $2, and so on, and their number is returned in it.
+// The backtick quoted identifiers are also lower cased, as PostgreSQL folds
+// the unquoted ones of the filter queries to lower case. The single quoted
+// string literals are kept as is.
+std::string TranslateQueryToPostgreSQL(absl::string_view query,
+                                       int* num_placeholders);
+
+// A MetadataSource based on a PostgreSQL backend, using libpq. The results
+// are fetched in the binary format, so that the numbers are not parsed from
+// text. The write transactions are SERIALIZABLE, and the serialization
+// failures and deadlocks are returned as ABORTED for the caller to retry.
+// This class is thread-unsafe.
+class PostgreSQLMetadataSource : public MetadataSource {
+ public:
+  // Initializes the PostgreSQLMetadataSource with given config.
+  // Check-fails if config is invalid.
+  explicit PostgreSQLMetadataSource(const PostgreSQLDatabaseConfig& config);
+
+  // Disallow copy and assign.
+  PostgreSQLMetadataSource(const PostgreSQLMetadataSource&) = delete;
+  PostgreSQLMetadataSource& operator=(const PostgreSQLMetadataSource&) =
+      delete;
+
+  ~PostgreSQLMetadataSource() override;
+
+  // Escapes the single quotes of strings with PQescapeStringConn. It aborts if
+  // the metadata source is not connected.
+  std::string EscapeString(absl::string_view value) const final;
+
+  // Escapes `value` with PQescapeStringConn into `out`.
+  void AppendEscapedString(absl::string_view value,
+                           std::string* out) const final;
+
+  // Prepared statements are used if `enable_prepared_statements` is set.
+  bool SupportsPreparedStatements() const final {
+    return config_.enable_prepared_statements();
+  }
+
+  // Queries are pipelined with the libpq pipeline mode if
+  // `enable_query_pipelining` is set.
+  bool SupportsQueryPipelining() const final {
+    return config_.enable_query_pipelining();
+  }
+
+ private:
+  // Connects to the PostgreSQL backend specified in config_, and creates the
+  // database unless skip_db_creation is set.
+  // Returns an INTERNAL error upon any errors from the PostgreSQL backend.
+  absl::Status ConnectImpl() final;
+
+  // Closes the existing open connection to the PostgreSQL backend, which also
+  // releases its prepared statements.
+  absl::Status CloseImpl() final;
+
+  // Opens a SERIALIZABLE transaction.
+  absl::Status BeginImpl() final;
+
+  // Opens a read-only transaction reading a consistent snapshot.
+  absl::Status BeginReadOnlyImpl() final;
+
+  // Executes a SQL statement and returns the rows if any.
+  // Returns an INTERNAL error upon any errors from the PostgreSQL backend.
+  absl::Status ExecuteQueryImpl(const std::string& query,
+                                RecordSet* results) final;
+
+  // Sends the queries in pipeline mode, and reads the result of each query in
+  // order after a single synchronization point.
+  // Returns an INTERNAL error upon any errors from the PostgreSQL backend.
+  absl::Status ExecuteQueriesImpl(absl::Span<const std::string> queries,
+                                  absl::Span<RecordSet* const> results) final;
+
+  // Executes the statement of the query, which is prepared with PQprepare at
+  // the first use, with the parameters in the text format except the proto
+  // values, which are sent as binary.
+  // Returns an INTERNAL error upon any errors from the PostgreSQL backend.
+  absl::Status ExecutePreparedQueryImpl(const std::string& query,
+                                        absl::Span<const Value> parameters,
+                                        RecordSet* results,
+                                        RecordSetLayout layout) final;
+
+  // Returns the plan of the query with EXPLAIN.
+  // Returns an INTERNAL error upon any errors from the PostgreSQL backend.
+  absl::Status ExplainQueryImpl(const std::string& query,
+                                RecordSet* plan) final;
+
+  // Returns the rows changed by the last statement, as reported by
+  // PQcmdTuples.
+  int64 NumRowsChangedImpl() final { return num_rows_changed_; }
+
+  // Commits the currently open transaction.
+  absl::Status CommitImpl() final;
+
+  // Rollbacks the currently open transaction.
+  absl::Status RollbackImpl() final;
+
+  // Runs an empty query on the connection.
+  // Returns an UNAVAILABLE error if the server cannot be reached.
+  absl::Status CheckConnectionImpl() final;
+
+  // Cancels the running query of the connection with PQcancel, which is safe
+  // to call from another thread.
+  // Returns an INTERNAL error if the cancel request cannot be sent.
+  absl::Status CancelQueryImpl() final;
+
+  // Begins a transaction with `begin_query`, and bounds its statements by the
+  // time left before the deadline of the cancellation token, if any, with a
+  // transaction-local statement_timeout. A connection closed by the server is
+  // reset once.
+  absl::Status BeginTransaction(const std::string& begin_query);
+
+  // Runs a query without parameters and discards the result.
+  // Returns an INTERNAL error upon any errors from the PostgreSQL backend.
+  absl::Status RunCommand(const std::string& query);
+
+  // Returns the `status` of running `query`. If it failed before the first
+  // write of a transaction, the transaction is rolled back to the savepoint
+  // taken when it began, so that it can continue as in the other backends.
+  absl::Status FinishStatement(const std::string& query,
+                               const absl::Status& status);
+
+  // Checks the status of `result`, records the rows changed by the command,
+  // and converts its rows, if any, to `record_set_out` in the given `layout`.
+  // `result` is not cleared.
+  absl::Status ConvertResultToRecordSet(const PGresult* result,
+                                        RecordSetLayout layout,
+                                        RecordSet* record_set_out);
+
+  // A statement prepared on the connection.
+  struct PreparedStatement {
+    // The name given to PQprepare.
+    std::string name;
+    // The number of placeholders of the statement.
+    int num_parameters = 0;
+  };
+
+  // Gets the cached prepared statement of the query, or prepares a new one.
+  // Returns an INTERNAL error upon any errors from the PostgreSQL backend.
+  absl::Status GetPreparedStatement(const std::string& query,
+                                    const PreparedStatement** statement);
+
+  // Deallocates all prepared statements of the connection.
+  void ClearPreparedStatements();
+
+  // The connection to the PostgreSQL backend. Initialized in ConnectImpl().
+  PGconn* conn_ = nullptr;
+
+  // The object to cancel the running query of the connection, or nullptr if
+  // it is not connected.
+  PGcancel* cancel_ = nullptr;
+
+  // The rows changed by the last statement.
+  int64 num_rows_changed_ = 0;
+
+  // Whether the failed statements of the open transaction are rolled back to
+  // its savepoint, i.e., no statement has written yet.
+  bool can_rollback_to_savepoint_ = false;
+
+  // The prepared statements of the connection keyed by the query. The values
+  // are not moved when the map grows, as it is node based.
+  absl::node_hash_map<std::string, PreparedStatement> prepared_statements_;
+
+  // The number of statements prepared on the connection, used to name them.
+  int64 num_prepared_statements_ = 0;
+
+  // Config to connect to the PostgreSQL backend.
+  const PostgreSQLDatabaseConfig config_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_POSTGRESQL_METADATA_SOURCE_H_
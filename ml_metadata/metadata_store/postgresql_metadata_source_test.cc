@@ -0,0 +1,67 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/postgresql_metadata_source.h"
+
+#include <gtest/gtest.h>
+
+namespace ml_metadata {
+namespace {
+
+TEST(TranslateQueryToPostgreSQLTest, QuotesIdentifiers) {
+  EXPECT_EQ(
+      TranslateQueryToPostgreSQL(
+          "SELECT `id`, `type_id` FROM `Artifact` WHERE `uri` = 'a';",
+          /*num_placeholders=*/nullptr),
+      "SELECT \"id\", \"type_id\" FROM \"artifact\" WHERE \"uri\" = 'a';");
+}
+
+TEST(TranslateQueryToPostgreSQLTest, KeepsSingleQuotedLiterals) {
+  EXPECT_EQ(TranslateQueryToPostgreSQL("SELECT 'it''s `a` \"b\" ? x''0a'''",
+                                       /*num_placeholders=*/nullptr),
+            "SELECT 'it''s `a` \"b\" ? x''0a'''");
+}
+
+TEST(TranslateQueryToPostgreSQLTest, SingleQuotesDoubleQuotedLiterals) {
+  EXPECT_EQ(TranslateQueryToPostgreSQL(
+                "WHERE (table_0.uri) LIKE (\"it's \\\"a\\\"\")",
+                /*num_placeholders=*/nullptr),
+            "WHERE (table_0.uri) LIKE ('it''s \"a\"')");
+}
+
+TEST(TranslateQueryToPostgreSQLTest, CastsBlobLiterals) {
+  EXPECT_EQ(TranslateQueryToPostgreSQL("VALUES (X'0aff', max'a')",
+                                       /*num_placeholders=*/nullptr),
+            "VALUES (CAST('\\x0aff' AS BYTEA), max'a')");
+}
+
+TEST(TranslateQueryToPostgreSQLTest, NumbersPlaceholders) {
+  int num_placeholders = 0;
+  EXPECT_EQ(TranslateQueryToPostgreSQL(
+                "SELECT `id` FROM `Type` WHERE `name` = ? AND `id` IN (?, ?) "
+                "AND `version` = '?';",
+                &num_placeholders),
+            "SELECT \"id\" FROM \"type\" WHERE \"name\" = $1 AND \"id\" IN "
+            "($2, $3) AND \"version\" = '?';");
+  EXPECT_EQ(num_placeholders, 3);
+}
+
+TEST(TranslateQueryToPostgreSQLTest, KeepsPlaceholdersUnlessNumbered) {
+  EXPECT_EQ(
+      TranslateQueryToPostgreSQL("SELECT ?", /*num_placeholders=*/nullptr),
+      "SELECT ?");
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -0,0 +1,60 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/property_string_dictionary.h"
+
+#include <glog/logging.h>
+#include "absl/synchronization/mutex.h"
+
+namespace ml_metadata {
+
+PropertyStringDictionary::PropertyStringDictionary(const Config& config)
+    : config_(config) {
+  CHECK_GT(config_.max_entries(), 0)
+      << "The max_entries of the property string dictionary must be positive.";
+}
+
+absl::optional<int64> PropertyStringDictionary::Find(
+    const absl::string_view value) const {
+  absl::ReaderMutexLock lock(&mu_);
+  auto it = ids_.find(value);
+  if (it == ids_.end()) {
+    return absl::nullopt;
+  }
+  return it->second;
+}
+
+void PropertyStringDictionary::Insert(
+    const std::vector<std::pair<std::string, int64>>& entries) {
+  if (entries.empty()) {
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  if (ids_.size() + entries.size() > config_.max_entries()) {
+    ids_.clear();
+  }
+  for (const auto& entry : entries) {
+    if (ids_.size() >= config_.max_entries()) {
+      break;
+    }
+    ids_[entry.first] = entry.second;
+  }
+}
+
+int PropertyStringDictionary::size() const {
+  absl::ReaderMutexLock lock(&mu_);
+  return ids_.size();
+}
+
+}  // namespace ml_metadata
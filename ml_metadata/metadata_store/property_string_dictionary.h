@@ -0,0 +1,87 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_PROPERTY_STRING_DICTIONARY_H_
+#define ML_METADATA_METADATA_STORE_PROPERTY_STRING_DICTIONARY_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// An in-memory dictionary of the string property values interned in the
+// PropertyStringValue table, i.e., of the ids the property rows refer to
+// instead of storing the strings, shared by the MetadataStores of a pool. It
+// saves the queries looking up the ids of the values written again and again,
+// e.g., the names of the pipelines and the components. It is thread-safe.
+//
+// The interned values are never deleted nor changed, so the entries do not
+// expire. Only the ids of committed values may be inserted, as the ids of the
+// values interned by a transaction rolled back may be reused. Once the
+// dictionary is full, it is cleared, so that it follows the values in use.
+//
+// Usage example:
+//
+//    absl::optional<int64> id = dictionary->Find(value);
+//    if (!id) {
+//      id = SelectOrInsertCommitted(value);
+//      dictionary->Insert({{value, *id}});
+//    }
+class PropertyStringDictionary {
+ public:
+  using Config = MetadataStoreServerConfig::ConnectionPoolConfig::
+      PropertyStringDictionaryConfig;
+
+  // The longest string values, in bytes, which are interned. The longer ones
+  // are stored in the property rows.
+  static constexpr int kMaxInternedValueSize = 255;
+
+  // Creates a dictionary of `config`.
+  // Check-fails if the max_entries of the config is not positive.
+  explicit PropertyStringDictionary(const Config& config);
+
+  // Not copyable or movable
+  PropertyStringDictionary(const PropertyStringDictionary&) = delete;
+  PropertyStringDictionary& operator=(const PropertyStringDictionary&) =
+      delete;
+
+  // Returns the id of the interned `value`, or nullopt if it is unknown.
+  absl::optional<int64> Find(absl::string_view value) const;
+
+  // Inserts the (value, id) `entries` of committed values. The dictionary is
+  // cleared first if it cannot hold them.
+  void Insert(const std::vector<std::pair<std::string, int64>>& entries);
+
+  // Returns the number of values in the dictionary.
+  int size() const;
+
+ private:
+  const Config config_;
+
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<std::string, int64> ids_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_PROPERTY_STRING_DICTIONARY_H_
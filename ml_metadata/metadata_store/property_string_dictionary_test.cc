@@ -0,0 +1,67 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/property_string_dictionary.h"
+
+#include <memory>
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::Optional;
+
+std::unique_ptr<PropertyStringDictionary> CreateDictionary(
+    const std::string& config_text) {
+  return absl::make_unique<PropertyStringDictionary>(
+      ParseTextProtoOrDie<PropertyStringDictionary::Config>(config_text));
+}
+
+TEST(PropertyStringDictionaryTest, FindsInsertedValues) {
+  std::unique_ptr<PropertyStringDictionary> dictionary = CreateDictionary("");
+  EXPECT_EQ(dictionary->Find("a"), absl::nullopt);
+  dictionary->Insert({{"a", 1}, {"b", 2}});
+
+  EXPECT_THAT(dictionary->Find("a"), Optional(1));
+  EXPECT_THAT(dictionary->Find("b"), Optional(2));
+  EXPECT_EQ(dictionary->Find("c"), absl::nullopt);
+  EXPECT_EQ(dictionary->size(), 2);
+}
+
+TEST(PropertyStringDictionaryTest, ClearedOnceFull) {
+  std::unique_ptr<PropertyStringDictionary> dictionary =
+      CreateDictionary("max_entries: 2");
+  dictionary->Insert({{"a", 1}, {"b", 2}});
+  ASSERT_EQ(dictionary->size(), 2);
+
+  dictionary->Insert({{"c", 3}});
+  EXPECT_EQ(dictionary->Find("a"), absl::nullopt);
+  EXPECT_EQ(dictionary->Find("b"), absl::nullopt);
+  EXPECT_THAT(dictionary->Find("c"), Optional(3));
+  EXPECT_EQ(dictionary->size(), 1);
+
+  // The entries beyond the max are dropped.
+  dictionary->Insert({{"d", 4}, {"e", 5}, {"f", 6}});
+  EXPECT_EQ(dictionary->size(), 2);
+}
+
+}  // namespace
+}  // namespace ml_metadata
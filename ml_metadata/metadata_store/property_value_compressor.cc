@@ -0,0 +1,111 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/property_value_compressor.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "google/protobuf/io/coded_stream.h"
+#include <glog/logging.h>
+#include "zlib.h"
+
+namespace ml_metadata {
+namespace {
+
+// The upper bound of the size of a serialized value, to reject the malformed
+// sizes before allocating them.
+constexpr uint64_t kMaxValueBytes = uint64_t{1} << 31;
+
+}  // namespace
+
+constexpr char PropertyValueCompressor::kTypeUrl[];
+
+PropertyValueCompressor::PropertyValueCompressor(const Config& config)
+    : config_(config) {
+  CHECK_GT(config_.min_value_size(), 0)
+      << "The min_value_size of the property value compression must be "
+         "positive.";
+  CHECK(config_.level() >= 1 && config_.level() <= 9)
+      << "The level of the property value compression must be within [1, 9].";
+}
+
+bool PropertyValueCompressor::Compress(const Value& value,
+                                       google::protobuf::Any* compressed) const {
+  if (value.value_case() != Value::kStringValue &&
+      value.value_case() != Value::kStructValue &&
+      value.value_case() != Value::kProtoValue) {
+    return false;
+  }
+  const size_t serialized_size = value.ByteSizeLong();
+  if (serialized_size < static_cast<size_t>(config_.min_value_size()) ||
+      serialized_size > kMaxValueBytes) {
+    return false;
+  }
+  const std::string serialized = value.SerializeAsString();
+  std::string buffer(
+      google::protobuf::io::CodedOutputStream::VarintSize64(serialized_size) +
+          compressBound(serialized_size),
+      '\0');
+  uint8_t* const data = reinterpret_cast<uint8_t*>(&buffer[0]);
+  const uint8_t* const compressed_data =
+      google::protobuf::io::CodedOutputStream::WriteVarint64ToArray(
+          serialized_size, data);
+  const size_t header_size = compressed_data - data;
+  uLongf compressed_size = buffer.size() - header_size;
+  if (compress2(const_cast<Bytef*>(compressed_data), &compressed_size,
+                reinterpret_cast<const Bytef*>(serialized.data()),
+                serialized.size(), config_.level()) != Z_OK ||
+      header_size + compressed_size >= serialized_size) {
+    return false;
+  }
+  buffer.resize(header_size + compressed_size);
+  compressed->set_type_url(kTypeUrl);
+  compressed->set_value(std::move(buffer));
+  return true;
+}
+
+absl::Status PropertyValueCompressor::Decompress(
+    const absl::string_view compressed, Value* value) {
+  const absl::Status corrupted =
+      absl::DataLossError("The compressed property value is corrupted");
+  google::protobuf::Any any;
+  if (!any.ParseFromArray(compressed.data(), compressed.size()) ||
+      any.type_url() != kTypeUrl) {
+    return corrupted;
+  }
+  google::protobuf::io::CodedInputStream input(
+      reinterpret_cast<const uint8_t*>(any.value().data()),
+      any.value().size());
+  uint64_t serialized_size;
+  if (!input.ReadVarint64(&serialized_size) ||
+      serialized_size > kMaxValueBytes) {
+    return corrupted;
+  }
+  const size_t header_size = input.CurrentPosition();
+  std::string serialized(serialized_size, '\0');
+  uLongf uncompressed_size = serialized_size;
+  if (uncompress(reinterpret_cast<Bytef*>(&serialized[0]), &uncompressed_size,
+                 reinterpret_cast<const Bytef*>(any.value().data()) +
+                     header_size,
+                 any.value().size() - header_size) != Z_OK ||
+      uncompressed_size != serialized_size ||
+      !value->ParseFromString(serialized)) {
+    return corrupted;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace ml_metadata
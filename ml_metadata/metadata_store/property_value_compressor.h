@@ -0,0 +1,72 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_PROPERTY_VALUE_COMPRESSOR_H_
+#define ML_METADATA_METADATA_STORE_PROPERTY_VALUE_COMPRESSOR_H_
+
+#include "google/protobuf/any.pb.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// Compresses the large string, struct and proto property values, which the
+// property tables of a v17+ schema store in their `byte_value` column. A
+// compressed value is a google.protobuf.Any of kTypeUrl, whose value is the
+// varint of the size of the serialized Value, followed by the zlib-compressed
+// serialized Value, so that the column records how it is compressed. It is
+// thread-safe.
+//
+// Usage example:
+//
+//    PropertyValueCompressor compressor(config);
+//    google::protobuf::Any compressed;
+//    if (compressor.Compress(value, &compressed)) {
+//      // Store compressed.SerializeAsString() in the `byte_value` column.
+//    }
+//    ...
+//    Value value;
+//    MLMD_RETURN_IF_ERROR(
+//        PropertyValueCompressor::Decompress(byte_value, &value));
+class PropertyValueCompressor {
+ public:
+  using Config = PropertyValueCompressionConfig;
+
+  // The type url of the compressed values.
+  static constexpr char kTypeUrl[] = "ml_metadata/zlib/ml_metadata.Value";
+
+  // Creates a compressor of `config`. Check-fails if the min_value_size of the
+  // config is not positive, or its level is not within [1, 9].
+  explicit PropertyValueCompressor(const Config& config);
+
+  // Compresses `value` to `compressed`, if it is a string, struct or proto
+  // value whose serialized size is at least the min_value_size of the config,
+  // and the compression makes it smaller. Returns false if `value` is not
+  // compressed.
+  bool Compress(const Value& value, google::protobuf::Any* compressed) const;
+
+  // Decompresses the serialized `compressed` value, e.g., of a `byte_value`
+  // column, to `value`.
+  // Returns DATA_LOSS error, if the value is not a compressed value or is
+  // corrupted.
+  static absl::Status Decompress(absl::string_view compressed, Value* value);
+
+ private:
+  const Config config_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_PROPERTY_VALUE_COMPRESSOR_H_
@@ -0,0 +1,105 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/property_value_compressor.h"
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "google/protobuf/any.pb.h"
+#include "google/protobuf/struct.pb.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace testing {
+namespace {
+
+// Returns a compressible string of `size` bytes.
+std::string LargeString(const size_t size) {
+  std::string result;
+  while (result.size() < size) {
+    absl::StrAppend(&result, "{\"learning_rate\": 0.01, \"epochs\": 10}");
+  }
+  result.resize(size);
+  return result;
+}
+
+TEST(PropertyValueCompressorTest, CompressesLargeValues) {
+  const PropertyValueCompressor compressor(
+      ParseTextProtoOrDie<PropertyValueCompressionConfig>(
+          "min_value_size: 1024"));
+  Value string_value;
+  string_value.set_string_value(LargeString(4096));
+  Value struct_value;
+  (*struct_value.mutable_struct_value()->mutable_fields())["config"]
+      .set_string_value(LargeString(4096));
+  Value proto_value;
+  proto_value.mutable_proto_value()->PackFrom(struct_value.struct_value());
+
+  for (const Value& value : {string_value, struct_value, proto_value}) {
+    google::protobuf::Any compressed;
+    ASSERT_TRUE(compressor.Compress(value, &compressed));
+    EXPECT_EQ(compressed.type_url(), PropertyValueCompressor::kTypeUrl);
+    EXPECT_LT(compressed.ByteSizeLong(), value.ByteSizeLong() / 4);
+    Value decompressed;
+    ASSERT_EQ(absl::OkStatus(),
+              PropertyValueCompressor::Decompress(
+                  compressed.SerializeAsString(), &decompressed));
+    EXPECT_THAT(decompressed, EqualsProto(value));
+  }
+}
+
+TEST(PropertyValueCompressorTest, LeavesOtherValuesUncompressed) {
+  const PropertyValueCompressor compressor(
+      ParseTextProtoOrDie<PropertyValueCompressionConfig>(
+          "min_value_size: 1024"));
+  google::protobuf::Any compressed;
+  Value value;
+  value.set_string_value(LargeString(1000));
+  EXPECT_FALSE(compressor.Compress(value, &compressed));
+  value.set_int_value(1);
+  EXPECT_FALSE(compressor.Compress(value, &compressed));
+  // An incompressible value is not made larger.
+  std::string random_string(4096, '\0');
+  uint32_t state = 1;
+  for (char& c : random_string) {
+    state = state * 1103515245 + 12345;
+    c = static_cast<char>(state >> 24);
+  }
+  value.set_string_value(random_string);
+  EXPECT_FALSE(compressor.Compress(value, &compressed));
+}
+
+TEST(PropertyValueCompressorTest, DecompressRejectsCorruptedValues) {
+  Value value;
+  EXPECT_TRUE(absl::IsDataLoss(
+      PropertyValueCompressor::Decompress("not a value", &value)));
+  google::protobuf::Any compressed;
+  compressed.set_type_url(PropertyValueCompressor::kTypeUrl);
+  compressed.set_value("\x10truncated");
+  EXPECT_TRUE(absl::IsDataLoss(PropertyValueCompressor::Decompress(
+      compressed.SerializeAsString(), &value)));
+  google::protobuf::Any other;
+  other.PackFrom(value);
+  EXPECT_TRUE(absl::IsDataLoss(
+      PropertyValueCompressor::Decompress(other.SerializeAsString(), &value)));
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace ml_metadata
@@ -13,9 +13,14 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cstdint>
 #include <memory>
+#include <utility>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "ml_metadata/metadata_store/metadata_store_factory.h"
 #include "ml_metadata/metadata_store/simple_types_util.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
@@ -25,9 +30,23 @@ limitations under the License.
 namespace {
 namespace py = pybind11;
 
+// A MetadataStore used by the python threads. The GIL is released during the
+// calls, so the calls of a MetadataStore, which is not thread-safe, are
+// serialized by a mutex, while the calls of different MetadataStores run in
+// parallel.
+struct PyMetadataStore {
+  explicit PyMetadataStore(
+      std::unique_ptr<ml_metadata::MetadataStore> metadata_store)
+      : metadata_store(std::move(metadata_store)) {}
+
+  absl::Mutex mu;
+  std::unique_ptr<ml_metadata::MetadataStore> metadata_store
+      ABSL_GUARDED_BY(mu);
+};
+
 // Creates a MetadataStore object and returns as a unique pointer.
 // Returns python RuntimeError if any error occur during creation.
-std::unique_ptr<ml_metadata::MetadataStore> CreateMetadataStore(
+std::unique_ptr<PyMetadataStore> CreateMetadataStore(
     const std::string& connection_config,
     const std::string& migration_options) {
   ml_metadata::ConnectionConfig proto_connection_config;
@@ -39,12 +58,17 @@ std::unique_ptr<ml_metadata::MetadataStore> CreateMetadataStore(
     throw std::runtime_error("Could not parse proto.");
   }
   std::unique_ptr<ml_metadata::MetadataStore> metadata_store;
-  absl::Status creation_status = ml_metadata::CreateMetadataStore(
-      proto_connection_config, proto_migration_options, &metadata_store);
+  absl::Status creation_status;
+  {
+    // Connecting to the database may block.
+    py::gil_scoped_release release;
+    creation_status = ml_metadata::CreateMetadataStore(
+        proto_connection_config, proto_migration_options, &metadata_store);
+  }
   if (!creation_status.ok()) {
     throw std::runtime_error(std::string(creation_status.message()));
   }
-  return metadata_store;
+  return absl::make_unique<PyMetadataStore>(std::move(metadata_store));
 }
 
 // Loads simple types from
@@ -67,8 +91,8 @@ py::tuple LoadSimpleTypes() {
 // The tuple is consist of serialized method response, and a strong typed
 // error with error_message and canonical error code.
 py::tuple ConvertAccessMetadataStoreResultToPyTuple(
-    const std::string& serialized_proto_message, const absl::Status& status) {
-  return py::make_tuple(py::bytes(serialized_proto_message),
+    py::bytes serialized_proto_message, const absl::Status& status) {
+  return py::make_tuple(std::move(serialized_proto_message),
                         py::bytes(std::string(status.message())),
                         py::int_((int)status.code()));
 }
@@ -76,30 +100,55 @@ py::tuple ConvertAccessMetadataStoreResultToPyTuple(
 // Utility method to dispatch python method calls. The `request` is parsed and
 // passed to the `method` of MetadataStore. It returns the `response` and
 // strong typed errors if any.
+//
+// The GIL is released while the request is parsed, the method is called and
+// the response is serialized. The request is parsed from the buffer of the
+// python bytes, and the response is serialized into the buffer of the
+// returned python bytes, without intermediate copies.
 template <typename InputProto, typename OutputProto>
 py::tuple AccessMetadataStore(
-    ml_metadata::MetadataStore* metadata_store, const std::string& request,
+    PyMetadataStore* py_metadata_store, const py::bytes& request,
     absl::Status (ml_metadata::MetadataStore::*method)(const InputProto&,
                                                        OutputProto*)) {
-  InputProto proto_request;
-  if (!proto_request.ParseFromString(request)) {
-    return ConvertAccessMetadataStoreResultToPyTuple(
-        /*serialized_proto_message=*/"",
-        absl::InvalidArgumentError("Could not parse proto"));
+  char* request_buffer;
+  Py_ssize_t request_size;
+  if (PyBytes_AsStringAndSize(request.ptr(), &request_buffer,
+                              &request_size) != 0) {
+    throw py::error_already_set();
   }
   OutputProto proto_response;
-  absl::Status call_status =
-      ((*metadata_store).*method)(proto_request, &proto_response);
-  std::string response;
-  proto_response.SerializeToString(&response);
-  return ConvertAccessMetadataStoreResultToPyTuple(response, call_status);
+  absl::Status call_status;
+  size_t response_size = 0;
+  {
+    // The python bytes are immutable, and `request` keeps them alive.
+    py::gil_scoped_release release;
+    InputProto proto_request;
+    if (!proto_request.ParseFromArray(request_buffer,
+                                      static_cast<int>(request_size))) {
+      call_status = absl::InvalidArgumentError("Could not parse proto");
+    } else {
+      absl::MutexLock lock(&py_metadata_store->mu);
+      call_status = ((*py_metadata_store->metadata_store).*method)(
+          proto_request, &proto_response);
+    }
+    response_size = proto_response.ByteSizeLong();
+  }
+  py::bytes response(nullptr, response_size);
+  if (response_size > 0) {
+    uint8_t* response_buffer =
+        reinterpret_cast<uint8_t*>(PyBytes_AS_STRING(response.ptr()));
+    py::gil_scoped_release release;
+    proto_response.SerializeWithCachedSizesToArray(response_buffer);
+  }
+  return ConvertAccessMetadataStoreResultToPyTuple(std::move(response),
+                                                   call_status);
 }
 
 // A macro to define pybind module methods.
 #define METADATA_STORE_METHOD_PYBIND11_DECLARE(method)            \
   m.def(#method,                                                  \
-      [](ml_metadata::MetadataStore& metadata_store,              \
-         const std::string& request) -> py::tuple {               \
+      [](PyMetadataStore& metadata_store,                         \
+         const py::bytes& request) -> py::tuple {                 \
         return AccessMetadataStore(                               \
             &metadata_store, request,                             \
             &ml_metadata::MetadataStore::method);                 \
@@ -108,7 +157,7 @@ py::tuple AccessMetadataStore(
 PYBIND11_MODULE(metadata_store_extension, main_module) {
   auto m = main_module.def_submodule("metadata_store");
   m.doc() = "MLMD MetadataStore API pybind11 extension module.";
-  py::class_<ml_metadata::MetadataStore>(m, "MetadataStore");
+  py::class_<PyMetadataStore>(m, "MetadataStore");
   m.def("CreateMetadataStore", &CreateMetadataStore, "Create MetadataStore.");
   m.def("LoadSimpleTypes", &LoadSimpleTypes, "Load MLMD Simple Types.");
   METADATA_STORE_METHOD_PYBIND11_DECLARE(PutArtifactType)
@@ -122,6 +171,10 @@ PYBIND11_MODULE(metadata_store_extension, main_module) {
   METADATA_STORE_METHOD_PYBIND11_DECLARE(PutContexts)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(PutAttributionsAndAssociations)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(PutParentContexts)
+  METADATA_STORE_METHOD_PYBIND11_DECLARE(DeleteArtifacts)
+  METADATA_STORE_METHOD_PYBIND11_DECLARE(DeleteExecutions)
+  METADATA_STORE_METHOD_PYBIND11_DECLARE(ArchiveExecutions)
+  METADATA_STORE_METHOD_PYBIND11_DECLARE(ExecuteBatch)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactType)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactTypesByID)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactTypes)
@@ -140,18 +193,28 @@ PYBIND11_MODULE(metadata_store_extension, main_module) {
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactsByType)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactByTypeAndName)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetExecutionsByType)
+  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetActiveExecutionsByType)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetExecutionByTypeAndName)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetContextsByType)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetContextByTypeAndName)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactsByURI)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetEventsByExecutionIDs)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetEventsByArtifactIDs)
+  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetEventsByTimeRange)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetContextsByArtifact)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetContextsByExecution)
+  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetExecutionDetails)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactsByContext)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetExecutionsByContext)
+  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetArtifactsByContexts)
+  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetExecutionsByContexts)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetParentContextsByContext)
   METADATA_STORE_METHOD_PYBIND11_DECLARE(GetChildrenContextsByContext)
+  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetAncestorContexts)
+  METADATA_STORE_METHOD_PYBIND11_DECLARE(GetDescendantContexts)
+  METADATA_STORE_METHOD_PYBIND11_DECLARE(CountArtifacts)
+  METADATA_STORE_METHOD_PYBIND11_DECLARE(CountExecutions)
+  METADATA_STORE_METHOD_PYBIND11_DECLARE(CountContexts)
 }
 
 }  // namespace
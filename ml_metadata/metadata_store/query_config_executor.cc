@@ -14,30 +14,36 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/query_config_executor.h"
 
+#include <algorithm>
+#include <iterator>
 #include <string>
+#include <tuple>
 #include <vector>
 
+#include "google/protobuf/any.pb.h"
 #include "google/protobuf/struct.pb.h"
 #include "google/protobuf/descriptor.h"
 #include "google/protobuf/text_format.h"
 #include "google/protobuf/util/json_util.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
-#include "absl/strings/str_replace.h"
 #include "absl/strings/substitute.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "ml_metadata/metadata_store/constants.h"
 #include "ml_metadata/metadata_store/list_operation_query_helper.h"
 #include "ml_metadata/metadata_store/list_operation_util.h"
+#include "ml_metadata/metadata_store/record_set_util.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #ifndef _WIN32
-#include "ml_metadata/query/filter_query_ast_resolver.h"
 #include "ml_metadata/query/filter_query_builder.h"
+#include "ml_metadata/query/filter_query_cache.h"
 #endif
 #include "ml_metadata/util/return_utils.h"
 #include "ml_metadata/util/struct_utils.h"
@@ -57,6 +63,99 @@ absl::Status GetTemplateQueryOrDie(
   return absl::OkStatus();
 }
 
+// Returns the version of a type, or nullopt if it is not set or empty, as
+// both are stored as NULL.
+template <typename T>
+absl::optional<std::string> GetTypeVersion(const T& type) {
+  return type.has_version() && !type.version().empty()
+             ? absl::make_optional(type.version())
+             : absl::nullopt;
+}
+
+Value IntValue(const int64 value) {
+  Value result;
+  result.set_int_value(value);
+  return result;
+}
+
+Value DoubleValue(const double value) {
+  Value result;
+  result.set_double_value(value);
+  return result;
+}
+
+Value StringValue(absl::string_view value) {
+  Value result;
+  result.set_string_value(std::string(value));
+  return result;
+}
+
+Value ProtoValue(const google::protobuf::Any& value) {
+  Value result;
+  *result.mutable_proto_value() = value;
+  return result;
+}
+
+// The max number of archived executions moved back at a time by the
+// downgrade from v16.
+constexpr int64 kRestoreArchivedExecutionsChunkSize = 100;
+
+// The bytes reserved for a value of a rendered query, besides its string.
+constexpr size_t kValueReservedSize = 16;
+
+// The property tables and their node id columns.
+constexpr std::pair<absl::string_view, absl::string_view> kPropertyTables[] = {
+    {"ArtifactProperty", "artifact_id"},
+    {"ExecutionProperty", "execution_id"},
+    {"ContextProperty", "context_id"}};
+
+// Parses a (node id, `name`, `is_custom_property`, `string_value`, ...) row of
+// a struct value stored as a string in a property table, and packs the struct
+// in `proto_value`.
+absl::Status ParseStructStringProperty(const RecordSet::Record& record,
+                                       int64* node_id,
+                                       int64* is_custom_property,
+                                       google::protobuf::Any* proto_value) {
+  if (!absl::SimpleAtoi(record.values(0), node_id) ||
+      !absl::SimpleAtoi(record.values(2), is_custom_property)) {
+    return absl::InternalError(
+        absl::StrCat("Could not parse the property: ", record.DebugString()));
+  }
+  google::protobuf::Struct struct_value;
+  MLMD_RETURN_IF_ERROR(StringToStruct(record.values(3), struct_value));
+  proto_value->PackFrom(struct_value);
+  return absl::OkStatus();
+}
+
+// Strips the trailing `;` and whitespaces of a query, as a prepared statement
+// consists of a single statement without the terminator.
+absl::string_view StripStatementTerminator(absl::string_view query) {
+  while (!query.empty() &&
+         (query.back() == ';' || absl::ascii_isspace(query.back()))) {
+    query.remove_suffix(1);
+  }
+  return query;
+}
+
+// Appends the `values` of a query parameter to `out` joined with ", ", where
+// `format` appends a single value. If `row_size` is positive, each row of
+// `row_size` values is enclosed in parentheses.
+template <typename Formatter>
+void AppendParameterValues(const std::vector<Value>& values, const int row_size,
+                           const Formatter& format, std::string* out) {
+  for (int i = 0; i < values.size(); i++) {
+    if (row_size > 0 && i % row_size == 0) {
+      absl::StrAppend(out, i == 0 ? "(" : "), (");
+    } else if (i > 0) {
+      absl::StrAppend(out, ", ");
+    }
+    format(values[i], out);
+  }
+  if (row_size > 0 && !values.empty()) {
+    absl::StrAppend(out, ")");
+  }
+}
+
 }  // namespace
 
 QueryConfigExecutor::QueryConfigExecutor(
@@ -64,7 +163,46 @@ QueryConfigExecutor::QueryConfigExecutor(
     int64 query_version)
     : QueryExecutor(query_version),
       query_config_(query_config),
-      metadata_source_(source) {}
+      metadata_source_(source) {
+  CompileTemplateQueries();
+}
+
+void QueryConfigExecutor::CompileTemplateQueries() {
+  const google::protobuf::Descriptor* descriptor =
+      query_config_.GetDescriptor();
+  const google::protobuf::Reflection* reflection =
+      query_config_.GetReflection();
+  const google::protobuf::Descriptor* template_query_descriptor =
+      MetadataSourceQueryConfig::TemplateQuery::descriptor();
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    const google::protobuf::FieldDescriptor* field = descriptor->field(i);
+    // An unset field is the shared default instance, which is not indexed.
+    if (field->is_repeated() ||
+        field->message_type() != template_query_descriptor ||
+        !reflection->HasField(query_config_, field)) {
+      continue;
+    }
+    const auto* template_query =
+        static_cast<const MetadataSourceQueryConfig::TemplateQuery*>(
+            &reflection->GetMessage(query_config_, field));
+    CompiledTemplateQuery& compiled =
+        compiled_template_queries_[template_query];
+    compiled.name = field->name();
+    compiled.segments = SplitTemplateQuery(template_query->query(),
+                                           template_query->parameter_num());
+  }
+}
+
+const QueryConfigExecutor::CompiledTemplateQuery&
+QueryConfigExecutor::GetCompiledTemplateQuery(
+    const MetadataSourceQueryConfig::TemplateQuery& template_query,
+    CompiledTemplateQuery* uncached) const {
+  const auto it = compiled_template_queries_.find(&template_query);
+  if (it != compiled_template_queries_.end()) return it->second;
+  uncached->segments = SplitTemplateQuery(template_query.query(),
+                                         template_query.parameter_num());
+  return *uncached;
+}
 
 absl::Status QueryConfigExecutor::CheckParentTypeTable() {
   return ExecuteQuery(query_config_.check_parent_type_table());
@@ -98,15 +236,91 @@ absl::Status QueryConfigExecutor::InsertEventPath(
   if (step.has_index()) {
     return ExecuteQuery(
         query_config_.insert_event_path(),
-        {Bind(event_id), "step_index", Bind(true), Bind(step.index())});
+        {Bind(event_id), BindColumnName("step_index"), Bind(true),
+         Bind(step.index())});
   } else if (step.has_key()) {
     return ExecuteQuery(
         query_config_.insert_event_path(),
-        {Bind(event_id), "step_key", Bind(false), Bind(step.key())});
+        {Bind(event_id), BindColumnName("step_key"), Bind(false),
+         Bind(step.key())});
   }
   return absl::OkStatus();
 }
 
+absl::Status QueryConfigExecutor::InsertEvents(
+    const absl::Span<const Event> events, std::vector<int64>* event_ids) {
+  event_ids->clear();
+  // Schema v12 stores the event paths in the EventPath table, which are
+  // inserted with `InsertEventPaths`.
+  const bool with_path = !IsQuerySchemaVersionEquals(12);
+  QueryParameter rows;
+  for (const Event& event : events) {
+    std::vector<QueryParameter> row = {
+        Bind(event.artifact_id()), Bind(event.execution_id()),
+        Bind(event.type()), Bind(event.milliseconds_since_epoch())};
+    if (with_path) {
+      row.push_back(Bind(event.path()));
+    }
+    AppendRow(row, &rows);
+  }
+  return ExecuteMultiRowInsert(with_path
+                                   ? query_config_.insert_events_with_path()
+                                   : query_config_.insert_events(),
+                               rows, event_ids);
+}
+
+absl::Status QueryConfigExecutor::InsertEventPaths(
+    const absl::Span<const int64> event_ids,
+    const absl::Span<const Event> events) {
+  CHECK_EQ(event_ids.size(), events.size()) << "Each event should have an id.";
+  // Since v13, the paths are inserted with the events.
+  if (!IsQuerySchemaVersionEquals(12)) {
+    return absl::OkStatus();
+  }
+  const QueryParameter null_value = {{Value()}};
+  QueryParameter rows;
+  for (int i = 0; i < events.size(); i++) {
+    for (const Event::Path::Step& step : events[i].path().steps()) {
+      // The step value oneof is stored in either step_index or step_key.
+      if (step.has_index()) {
+        AppendRow(
+            {Bind(event_ids[i]), Bind(true), Bind(step.index()), null_value},
+            &rows);
+      } else if (step.has_key()) {
+        AppendRow(
+            {Bind(event_ids[i]), Bind(false), null_value, Bind(step.key())},
+            &rows);
+      }
+    }
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_event_paths(), rows,
+                               /*inserted_ids=*/nullptr);
+}
+
+absl::Status QueryConfigExecutor::InsertAssociationsIfNotExist(
+    const absl::Span<const Association> associations) {
+  QueryParameter rows;
+  for (const Association& association : associations) {
+    AppendRow(
+        {Bind(association.context_id()), Bind(association.execution_id())},
+        &rows);
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_associations_if_not_exist(),
+                               rows, /*inserted_ids=*/nullptr);
+}
+
+absl::Status QueryConfigExecutor::InsertAttributionsIfNotExist(
+    const absl::Span<const Attribution> attributions) {
+  QueryParameter rows;
+  for (const Attribution& attribution : attributions) {
+    AppendRow(
+        {Bind(attribution.context_id()), Bind(attribution.artifact_id())},
+        &rows);
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_attributions_if_not_exist(),
+                               rows, /*inserted_ids=*/nullptr);
+}
+
 absl::Status QueryConfigExecutor::CheckParentContextTable() {
   return ExecuteQuery(query_config_.check_parent_context_table());
 }
@@ -199,18 +413,13 @@ absl::Status QueryConfigExecutor::UpgradeMetadataSourceIfOutOfDate(
   }
 
   // migrate db_version to lib version
-  const auto& migration_schemes = query_config_.migration_schemes();
   while (db_version < lib_version) {
     const int64 to_version = db_version + 1;
-    if (migration_schemes.find(to_version) == migration_schemes.end()) {
-      return absl::InternalError(absl::StrCat(
-          "Cannot find migration_schemes to version ", to_version));
-    }
-    for (const MetadataSourceQueryConfig::TemplateQuery& upgrade_query :
-         migration_schemes.at(to_version).upgrade_queries()) {
-      MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
-          ExecuteQuery(upgrade_query.query()),
-          absl::StrCat("Upgrade query failed: ", upgrade_query.query()));
+    MLMD_RETURN_IF_ERROR(ExecuteUpgradeQueries(to_version));
+    // The struct values stored as base64 strings cannot be decoded in SQL.
+    if (to_version == 14) {
+      MLMD_RETURN_WITH_CONTEXT_IF_ERROR(MoveStructPropertiesToProtoValue(),
+                                        "Failed to move the struct values.");
     }
     MLMD_RETURN_WITH_CONTEXT_IF_ERROR(UpdateSchemaVersion(to_version),
                                       "Failed to update schema.");
@@ -219,7 +428,116 @@ absl::Status QueryConfigExecutor::UpgradeMetadataSourceIfOutOfDate(
   return absl::OkStatus();
 }
 
+absl::Status QueryConfigExecutor::UpgradeMetadataSourceOnlineStep(
+    const int64 batch_size, bool* done) {
+  *done = true;
+  int64 db_version = 0;
+  const absl::Status get_schema_version_status = GetSchemaVersion(&db_version);
+  // An empty database is created at the library version, and a database newer
+  // than the library is rejected, by InitMetadataSourceIfNotExists.
+  if (absl::IsNotFound(get_schema_version_status)) {
+    return absl::OkStatus();
+  }
+  MLMD_RETURN_IF_ERROR(get_schema_version_status);
+  if (db_version >= GetLibraryVersion()) {
+    return absl::OkStatus();
+  }
+  if (batch_size <= 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "The batch size of an online upgrade must be positive: ", batch_size));
+  }
+  *done = false;
+  const int64 to_version = db_version + 1;
+  // The struct values stored as strings are the only rows rewritten by an
+  // upgrade. The other upgrades only change the schema, and are run at once.
+  if (to_version == 14) {
+    return BackfillStructPropertiesOnline(to_version, batch_size);
+  }
+  MLMD_RETURN_IF_ERROR(ExecuteUpgradeQueries(to_version));
+  return UpdateSchemaVersion(to_version);
+}
+
+absl::Status QueryConfigExecutor::ExecuteUpgradeQueries(
+    const int64 to_version) {
+  const auto& migration_schemes = query_config_.migration_schemes();
+  if (migration_schemes.find(to_version) == migration_schemes.end()) {
+    return absl::InternalError(absl::StrCat(
+        "Cannot find migration_schemes to version ", to_version));
+  }
+  for (const MetadataSourceQueryConfig::TemplateQuery& upgrade_query :
+       migration_schemes.at(to_version).upgrade_queries()) {
+    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+        ExecuteQuery(upgrade_query.query()),
+        absl::StrCat("Upgrade query failed: ", upgrade_query.query()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::BackfillStructPropertiesOnline(
+    const int64 to_version, const int64 batch_size) {
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.create_migration_checkpoint_table()));
+  RecordSet checkpoint;
+  MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.select_migration_checkpoint(),
+                                    {Bind(to_version)}, &checkpoint));
+  // The first step adds the `proto_value` columns, which the clients of the
+  // previous version do not read, and starts the backfill.
+  if (checkpoint.records_size() == 0) {
+    MLMD_RETURN_IF_ERROR(ExecuteUpgradeQueries(to_version));
+    return ExecuteQuery(query_config_.insert_migration_checkpoint(),
+                        {Bind(to_version), Bind(0), Bind(int64{0})});
+  }
+  int64 table_index;
+  int64 last_id;
+  if (!absl::SimpleAtoi(checkpoint.records(0).values(0), &table_index) ||
+      !absl::SimpleAtoi(checkpoint.records(0).values(1), &last_id)) {
+    return absl::InternalError(absl::StrCat(
+        "Could not parse the migration checkpoint: ",
+        checkpoint.DebugString()));
+  }
+  if (table_index < static_cast<int64>(std::size(kPropertyTables))) {
+    const auto& table = kPropertyTables[table_index];
+    RecordSet chunk;
+    MLMD_RETURN_IF_ERROR(ExecuteQuery(
+        query_config_.select_property_chunk_end(),
+        {BindColumnName(table.second), BindColumnName(table.first),
+         Bind(last_id), Bind(batch_size)},
+        &chunk));
+    if (chunk.records_size() == 0 ||
+        chunk.records(0).values(0) == kMetadataSourceNull) {
+      LOG(INFO) << "Backfilled the struct values of " << table.first;
+      return ExecuteQuery(query_config_.update_migration_checkpoint(),
+                          {Bind(to_version), Bind(table_index + 1),
+                           Bind(int64{0})});
+    }
+    int64 chunk_end;
+    if (!absl::SimpleAtoi(chunk.records(0).values(0), &chunk_end)) {
+      return absl::InternalError(
+          absl::StrCat("Could not parse the chunk end: ", chunk.DebugString()));
+    }
+    MLMD_RETURN_IF_ERROR(
+        CopyStructPropertiesToProtoValue(table, last_id, chunk_end));
+    return ExecuteQuery(
+        query_config_.update_migration_checkpoint(),
+        {Bind(to_version), Bind(table_index), Bind(chunk_end)});
+  }
+  // The last step moves the struct values written by the clients of the
+  // previous version during the backfill, clears the copied strings, and
+  // makes the database available to the clients of the new version.
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(MoveStructPropertiesToProtoValue(),
+                                    "Failed to move the struct values.");
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.drop_migration_checkpoint_table()));
+  return UpdateSchemaVersion(to_version);
+}
+
 absl::Status QueryConfigExecutor::SelectLastInsertID(int64* last_insert_id) {
+  // The id reported with the result of the insert saves a round trip.
+  const absl::optional<int64> reported_id = metadata_source_->LastInsertId();
+  if (reported_id.has_value()) {
+    *last_insert_id = *reported_id;
+    return absl::OkStatus();
+  }
   RecordSet record_set;
   MLMD_RETURN_IF_ERROR(
       ExecuteQuery(query_config_.select_last_insert_id(), {}, &record_set));
@@ -236,6 +554,49 @@ absl::Status QueryConfigExecutor::SelectLastInsertID(int64* last_insert_id) {
   return absl::OkStatus();
 }
 
+absl::Status QueryConfigExecutor::SelectLastUpsertID(absl::optional<int64>* id,
+                                                     bool* is_inserted) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.select_last_upsert_id(), {}, &record_set));
+  if (record_set.records_size() == 0 ||
+      record_set.records(0).values_size() < 2) {
+    return absl::InternalError("Could not find last upsert ID: no record");
+  }
+  const RecordSet::Record& record = record_set.records(0);
+  int64 row_count;
+  if (!absl::SimpleAtoi(record.values(1), &row_count)) {
+    return absl::InternalError("Could not parse last upsert row count");
+  }
+  *is_inserted = row_count > 0;
+  id->reset();
+  if (record.values(0) == kMetadataSourceNull) return absl::OkStatus();
+  int64 last_upsert_id;
+  if (!absl::SimpleAtoi(record.values(0), &last_upsert_id)) {
+    return absl::InternalError("Could not parse last upsert ID as string");
+  }
+  *id = last_upsert_id;
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::SelectTypeGeneration(
+    int64* type_generation) {
+  MLMD_RETURN_IF_ERROR(VerifyCurrentQueryVersionIsAtLeast(9));
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.select_type_generation(), {},
+                                    &record_set));
+  if (record_set.records_size() != 1 ||
+      record_set.records(0).values_size() != 1) {
+    return absl::InternalError(absl::StrCat(
+        "Expecting a single type generation in MLMDEnv: ",
+        record_set.DebugString()));
+  }
+  if (!absl::SimpleAtoi(record_set.records(0).values(0), type_generation)) {
+    return absl::InternalError("Could not parse type generation as integer");
+  }
+  return absl::OkStatus();
+}
+
 absl::Status ml_metadata::QueryConfigExecutor::CheckTablesIn_V0_13_2() {
   return ExecuteQuery(query_config_.check_tables_in_v0_13_2());
 }
@@ -273,6 +634,24 @@ absl::Status QueryConfigExecutor::DowngradeMetadataSource(
       return absl::InternalError(absl::StrCat(
           "Cannot find migration_schemes to version ", to_version));
     }
+    if (to_version == 13) {
+      MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+          MoveStructPropertiesToStringValue(),
+          "Failed to migrate existing db; the migration transaction rolls "
+          "back.");
+    }
+    if (to_version == 15) {
+      MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+          RestoreArchivedExecutions(),
+          "Failed to migrate existing db; the migration transaction rolls "
+          "back.");
+    }
+    if (to_version == 16) {
+      MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+          DecompressPropertyValues(),
+          "Failed to migrate existing db; the migration transaction rolls "
+          "back.");
+    }
     for (const MetadataSourceQueryConfig::TemplateQuery& downgrade_query :
          migration_schemes.at(to_version).downgrade_queries()) {
       MLMD_RETURN_WITH_CONTEXT_IF_ERROR(ExecuteQuery(downgrade_query),
@@ -291,55 +670,281 @@ absl::Status QueryConfigExecutor::DowngradeMetadataSource(
   return absl::OkStatus();
 }
 
-std::string QueryConfigExecutor::Bind(const char* value) {
-  return absl::StrCat("'", metadata_source_->EscapeString(value), "'");
+absl::Status QueryConfigExecutor::RestoreArchivedExecutions() {
+  int64 last_id = 0;
+  RecordSet record_set;
+  do {
+    record_set.Clear();
+    MLMD_RETURN_IF_ERROR(ExecuteQuery(
+        query_config_.select_archived_executions_after_id(),
+        {Bind(last_id), Bind(kRestoreArchivedExecutionsChunkSize)},
+        &record_set));
+    if (record_set.records().empty()) {
+      break;
+    }
+    std::vector<int64> execution_ids;
+    std::vector<Execution> executions;
+    QueryParameter rows;
+    for (const RecordSet::Record& record : record_set.records()) {
+      google::protobuf::Any archived_execution;
+      Execution execution;
+      if (!absl::SimpleAtoi(record.values(0), &last_id) ||
+          !archived_execution.ParseFromString(record.values(1)) ||
+          !archived_execution.UnpackTo(&execution)) {
+        return absl::InternalError(absl::StrCat(
+            "Could not parse the archived execution: ", record.DebugString()));
+      }
+      AppendRow({Bind(execution.id()), Bind(execution.type_id()),
+                 Bind(execution.has_last_known_state()
+                          ? absl::make_optional(execution.last_known_state())
+                          : absl::nullopt),
+                 Bind(execution.has_name()
+                          ? absl::make_optional(execution.name())
+                          : absl::nullopt),
+                 Bind(execution.create_time_since_epoch()),
+                 Bind(execution.last_update_time_since_epoch())},
+                &rows);
+      execution_ids.push_back(execution.id());
+      executions.push_back(std::move(execution));
+    }
+    MLMD_RETURN_IF_ERROR(
+        ExecuteMultiRowInsert(query_config_.insert_restored_executions(), rows,
+                              /*inserted_ids=*/nullptr));
+    MLMD_RETURN_IF_ERROR(InsertExecutionProperties(execution_ids, executions));
+  } while (record_set.records_size() == kRestoreArchivedExecutionsChunkSize);
+  return absl::OkStatus();
 }
 
-std::string QueryConfigExecutor::Bind(absl::string_view value) {
-  return absl::StrCat("'", metadata_source_->EscapeString(value), "'");
+absl::Status QueryConfigExecutor::CheckPropertyValueSupported(
+    const Value& value) const {
+  if (value.has_proto_value() && !HasPropertyProtoValue()) {
+    return absl::FailedPreconditionError(
+        "Proto property values are not supported before schema version 14.");
+  }
+  return absl::OkStatus();
 }
 
-std::string QueryConfigExecutor::Bind(int value) {
-  return std::to_string(value);
+absl::Status QueryConfigExecutor::MoveStructPropertiesToProtoValue() {
+  for (const auto& table : kPropertyTables) {
+    RecordSet record_set;
+    MLMD_RETURN_IF_ERROR(ExecuteQuery(
+        query_config_.select_struct_string_properties(),
+        {BindColumnName(table.second), BindColumnName(table.first)},
+        &record_set));
+    for (const RecordSet::Record& record : record_set.records()) {
+      int64 node_id;
+      int64 is_custom_property;
+      google::protobuf::Any proto_value;
+      MLMD_RETURN_IF_ERROR(ParseStructStringProperty(
+          record, &node_id, &is_custom_property, &proto_value));
+      // The values copied by an online upgrade are cleared below, unless they
+      // are rewritten by the clients of the previous version meanwhile.
+      if (record.values(4) == proto_value.SerializeAsString()) {
+        continue;
+      }
+      MLMD_RETURN_IF_ERROR(ExecuteQuery(
+          query_config_.update_property_to_proto_value(),
+          {BindColumnName(table.first), {{ProtoValue(proto_value)}},
+           BindColumnName(table.second), Bind(node_id), Bind(record.values(1)),
+           Bind(is_custom_property != 0)}));
+    }
+    MLMD_RETURN_IF_ERROR(
+        ExecuteQuery(query_config_.clear_copied_struct_string_properties(),
+                     {BindColumnName(table.first)}));
+  }
+  return absl::OkStatus();
 }
 
-std::string QueryConfigExecutor::Bind(int64 value) {
-  return std::to_string(value);
+absl::Status QueryConfigExecutor::CopyStructPropertiesToProtoValue(
+    const std::pair<absl::string_view, absl::string_view>& table,
+    const int64 after_id, const int64 last_id) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(ExecuteQuery(
+      query_config_.select_struct_string_properties_in_chunk(),
+      {BindColumnName(table.second), BindColumnName(table.first),
+       Bind(after_id), Bind(last_id)},
+      &record_set));
+  for (const RecordSet::Record& record : record_set.records()) {
+    int64 node_id;
+    int64 is_custom_property;
+    google::protobuf::Any proto_value;
+    MLMD_RETURN_IF_ERROR(ParseStructStringProperty(
+        record, &node_id, &is_custom_property, &proto_value));
+    MLMD_RETURN_IF_ERROR(ExecuteQuery(
+        query_config_.copy_property_to_proto_value(),
+        {BindColumnName(table.first), {{ProtoValue(proto_value)}},
+         BindColumnName(table.second), Bind(node_id), Bind(record.values(1)),
+         Bind(is_custom_property != 0)}));
+  }
+  return absl::OkStatus();
 }
 
-std::string QueryConfigExecutor::Bind(double value) {
-  return std::to_string(value);
+absl::Status QueryConfigExecutor::MoveStructPropertiesToStringValue() {
+  for (const auto& table : kPropertyTables) {
+    RecordSet record_set;
+    MLMD_RETURN_IF_ERROR(ExecuteQuery(
+        query_config_.select_proto_value_properties(),
+        {BindColumnName(table.second), BindColumnName(table.first)},
+        &record_set));
+    for (const RecordSet::Record& record : record_set.records()) {
+      int64 node_id;
+      int64 is_custom_property;
+      google::protobuf::Any proto_value;
+      if (!absl::SimpleAtoi(record.values(0), &node_id) ||
+          !absl::SimpleAtoi(record.values(2), &is_custom_property) ||
+          !proto_value.ParseFromString(record.values(3))) {
+        return absl::InternalError(absl::StrCat(
+            "Could not parse the property: ", record.DebugString()));
+      }
+      // The other proto values cannot be stored before v14, and are deleted by
+      // the downgrade queries.
+      google::protobuf::Struct struct_value;
+      if (!proto_value.UnpackTo(&struct_value)) {
+        continue;
+      }
+      MLMD_RETURN_IF_ERROR(ExecuteQuery(
+          query_config_.update_property_to_string_value(),
+          {BindColumnName(table.first), Bind(StructToString(struct_value)),
+           BindColumnName(table.second), Bind(node_id), Bind(record.values(1)),
+           Bind(is_custom_property != 0)}));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::DecompressPropertyValues() {
+  for (const auto& table : kPropertyTables) {
+    RecordSet record_set;
+    MLMD_RETURN_IF_ERROR(ExecuteQuery(
+        query_config_.select_compressed_properties(),
+        {BindColumnName(table.second), BindColumnName(table.first)},
+        &record_set));
+    for (const RecordSet::Record& record : record_set.records()) {
+      int64 node_id;
+      int64 is_custom_property;
+      if (!absl::SimpleAtoi(record.values(0), &node_id) ||
+          !absl::SimpleAtoi(record.values(2), &is_custom_property)) {
+        return absl::InternalError(absl::StrCat(
+            "Could not parse the property: ", record.DebugString()));
+      }
+      Value value;
+      MLMD_RETURN_IF_ERROR(
+          PropertyValueCompressor::Decompress(record.values(3), &value));
+      QueryParameter string_value = {{Value()}};
+      QueryParameter proto_value = {{Value()}};
+      (value.has_string_value() ? string_value : proto_value) =
+          BindValue(value);
+      MLMD_RETURN_IF_ERROR(ExecuteQuery(
+          query_config_.update_property_to_decompressed_value(),
+          {BindColumnName(table.first), string_value, proto_value,
+           BindColumnName(table.second), Bind(node_id), Bind(record.values(1)),
+           Bind(is_custom_property != 0)}));
+    }
+  }
+  return absl::OkStatus();
+}
+
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(
+    const char* value) {
+  return {{StringValue(value)}};
 }
 
-std::string QueryConfigExecutor::Bind(bool value) { return value ? "1" : "0"; }
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(
+    absl::string_view value) {
+  return {{StringValue(value)}};
+}
+
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(int value) {
+  return {{IntValue(value)}};
+}
+
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(int64 value) {
+  return {{IntValue(value)}};
+}
+
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(double value) {
+  return {{DoubleValue(value)}};
+}
+
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(bool value) {
+  return {{IntValue(value ? 1 : 0)}};
+}
 
 // Utility method to bind an Event::Type enum value to a SQL clause.
 // Event::Type is an enum (integer), EscapeString is not applicable.
-std::string QueryConfigExecutor::Bind(const Event::Type value) {
-  return std::to_string(value);
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(
+    const Event::Type value) {
+  return {{IntValue(value)}};
+}
+
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(
+    const Event::Path& path) {
+  if (path.steps().empty()) {
+    return {{Value()}};
+  }
+  std::string json_output;
+  CHECK(::google::protobuf::util::MessageToJsonString(path, &json_output).ok())
+      << "Could not write proto to JSON: " << path.DebugString();
+  return Bind(json_output);
+}
+
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(
+    PropertyType value) {
+  return {{IntValue((int)value)}};
+}
+
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(TypeKind value) {
+  return {{IntValue((int)value)}};
+}
+
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(
+    Artifact::State value) {
+  return {{IntValue((int)value)}};
 }
 
-std::string QueryConfigExecutor::Bind(PropertyType value) {
-  return std::to_string((int)value);
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(
+    Execution::State value) {
+  return {{IntValue((int)value)}};
 }
 
-std::string QueryConfigExecutor::Bind(TypeKind value) {
-  return std::to_string((int)value);
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(
+    ChangeLogEntry::Kind value) {
+  return {{IntValue((int)value)}};
 }
 
-std::string QueryConfigExecutor::Bind(Artifact::State value) {
-  return std::to_string((int)value);
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(
+    ChangeLogEntry::Operation value) {
+  return {{IntValue((int)value)}};
 }
 
-std::string QueryConfigExecutor::Bind(Execution::State value) {
-  return std::to_string((int)value);
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(
+    const absl::Span<const int64> value) {
+  if (value.size() > kMaxIdListSize) {
+    QueryParameter parameter = {
+        {StringValue(absl::StrCat("[", absl::StrJoin(value, ","), "]"))}};
+    parameter.subquery = query_config_.select_id_set().query();
+    return parameter;
+  }
+  QueryParameter parameter;
+  parameter.values.reserve(value.size());
+  for (const int64 v : value) {
+    parameter.values.push_back(IntValue(v));
+  }
+  return parameter;
 }
 
-std::string QueryConfigExecutor::Bind(const absl::Span<const int64> value) {
-  return absl::StrJoin(value, ", ");
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(
+    const absl::Span<const std::string> value) {
+  QueryParameter parameter;
+  parameter.values.reserve(value.size());
+  for (const std::string& v : value) {
+    parameter.values.push_back(StringValue(v));
+  }
+  return parameter;
 }
 
-std::string QueryConfigExecutor::BindValue(const Value& value) {
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::BindValue(
+    const Value& value) {
   switch (value.value_case()) {
     case PropertyType::INT:
       return Bind(value.int_value());
@@ -347,8 +952,17 @@ std::string QueryConfigExecutor::BindValue(const Value& value) {
       return Bind(value.double_value());
     case PropertyType::STRING:
       return Bind(value.string_value());
-    case PropertyType::STRUCT:
-      return Bind(StructToString(value.struct_value()));
+    case PropertyType::STRUCT: {
+      // Before v14, the struct values are stored as base64 strings.
+      if (!HasPropertyProtoValue()) {
+        return Bind(StructToString(value.struct_value()));
+      }
+      google::protobuf::Any proto_value;
+      proto_value.PackFrom(value.struct_value());
+      return {{ProtoValue(proto_value)}};
+    }
+    case PropertyType::PROTO:
+      return {{value}};
     default:
       LOG(FATAL) << "Unknown registered property type: " << value.value_case()
                  << "This is an internal error: properties should have been "
@@ -357,19 +971,28 @@ std::string QueryConfigExecutor::BindValue(const Value& value) {
   }
 }
 
-std::string QueryConfigExecutor::BindDataType(const Value& value) {
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::BindDataType(
+    const Value& value) {
   switch (value.value_case()) {
     case PropertyType::INT: {
-      return "int_value";
+      return BindColumnName("int_value");
       break;
     }
     case PropertyType::DOUBLE: {
-      return "double_value";
+      return BindColumnName("double_value");
+      break;
+    }
+    case PropertyType::STRING: {
+      return BindColumnName("string_value");
       break;
     }
-    case PropertyType::STRING:
     case PropertyType::STRUCT: {
-      return "string_value";
+      return BindColumnName(HasPropertyProtoValue() ? "proto_value"
+                                                    : "string_value");
+      break;
+    }
+    case PropertyType::PROTO: {
+      return BindColumnName("proto_value");
       break;
     }
     default: {
@@ -378,24 +1001,289 @@ std::string QueryConfigExecutor::BindDataType(const Value& value) {
   }
 }
 
-std::string QueryConfigExecutor::Bind(const ArtifactStructType* message) {
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(
+    const ArtifactStructType* message) {
   if (message) {
     std::string json_output;
     CHECK(::google::protobuf::util::MessageToJsonString(*message, &json_output).ok())
         << "Could not write proto to JSON: " << message->DebugString();
     return Bind(json_output);
   } else {
-    return "null";
+    return {{Value()}};
   }
 }
 
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::BindColumnName(
+    absl::string_view column_name) {
+  return {{}, std::string(column_name)};
+}
+
 #if (!defined(__APPLE__) && !defined(_WIN32))
-string QueryConfigExecutor::Bind(
+QueryConfigExecutor::QueryParameter QueryConfigExecutor::Bind(
     const google::protobuf::int64 value) {
-  return std::to_string(value);
+  return {{IntValue(value)}};
 }
 #endif
 
+void QueryConfigExecutor::AppendRow(const absl::Span<const QueryParameter> row,
+                                    QueryParameter* rows) {
+  const int num_values = rows->values.size();
+  for (const QueryParameter& parameter : row) {
+    CHECK(!parameter.sql_fragment && !parameter.subquery)
+        << "A row can only contain values.";
+    rows->values.insert(rows->values.end(), parameter.values.begin(),
+                        parameter.values.end());
+  }
+  const int row_size = rows->values.size() - num_values;
+  CHECK(rows->row_size == 0 || rows->row_size == row_size)
+      << "All the rows should have the same number of values.";
+  rows->row_size = row_size;
+}
+
+void QueryConfigExecutor::AppendPropertyRow(
+    const int64 node_id, const absl::string_view name,
+    const bool is_custom_property, const Value& value, QueryParameter* rows,
+    const absl::flat_hash_map<std::string, int64>* string_value_ids) {
+  std::vector<QueryParameter> columns =
+      BindPropertyValueColumns(value, string_value_ids);
+  std::vector<QueryParameter> row = {Bind(node_id),    Bind(name),
+                                     Bind(is_custom_property), columns[0],
+                                     columns[1],       columns[2]};
+  if (HasPropertyProtoValue()) {
+    row.push_back(std::move(columns[3]));
+  }
+  if (string_value_ids != nullptr) {
+    row.push_back(std::move(columns[4]));
+    row.push_back(std::move(columns[5]));
+  }
+  AppendRow(row, rows);
+}
+
+std::vector<QueryConfigExecutor::QueryParameter>
+QueryConfigExecutor::BindPropertyValueColumns(
+    const Value& value,
+    const absl::flat_hash_map<std::string, int64>* string_value_ids) {
+  QueryParameter int_value = {{Value()}};
+  QueryParameter double_value = {{Value()}};
+  QueryParameter string_value = {{Value()}};
+  QueryParameter proto_value = {{Value()}};
+  QueryParameter string_value_id = {{Value()}};
+  QueryParameter byte_value = {{Value()}};
+  google::protobuf::Any compressed;
+  if (CompressesPropertyValues() &&
+      property_value_compressor_->Compress(value, &compressed)) {
+    byte_value = {{ProtoValue(compressed)}};
+    return {int_value,   double_value,    string_value,
+            proto_value, string_value_id, byte_value};
+  }
+  switch (value.value_case()) {
+    case Value::kIntValue:
+      int_value = BindValue(value);
+      break;
+    case Value::kDoubleValue:
+      double_value = BindValue(value);
+      break;
+    case Value::kStringValue:
+      if (string_value_ids != nullptr &&
+          string_value_ids->contains(value.string_value())) {
+        string_value_id = Bind(string_value_ids->at(value.string_value()));
+      } else {
+        string_value = BindValue(value);
+      }
+      break;
+    default:
+      // Before v14, the struct values are stored as strings.
+      (HasPropertyProtoValue() ? proto_value : string_value) =
+          BindValue(value);
+  }
+  return {int_value,   double_value,    string_value,
+          proto_value, string_value_id, byte_value};
+}
+
+absl::Status QueryConfigExecutor::InternPropertyStrings(
+    const absl::Span<const std::string> values,
+    absl::flat_hash_map<std::string, int64>* ids) {
+  // The values interned by an earlier transaction are published once it is
+  // committed. The ids of a transaction rolled back may be reused.
+  const int64 transaction = metadata_source_->num_transactions_begun();
+  if (transaction != interning_transaction_) {
+    if (metadata_source_->last_committed_transaction() ==
+        interning_transaction_) {
+      property_string_dictionary_->Insert(
+          {uncommitted_interned_strings_.begin(),
+           uncommitted_interned_strings_.end()});
+    }
+    uncommitted_interned_strings_.clear();
+    interning_transaction_ = transaction;
+  }
+
+  std::vector<std::string> unknown_values;
+  for (const std::string& value : values) {
+    if (value.size() > PropertyStringDictionary::kMaxInternedValueSize ||
+        ids->contains(value)) {
+      continue;
+    }
+    const auto it = uncommitted_interned_strings_.find(value);
+    if (it != uncommitted_interned_strings_.end()) {
+      ids->insert(*it);
+      continue;
+    }
+    const absl::optional<int64> id = property_string_dictionary_->Find(value);
+    if (id) {
+      ids->insert({value, *id});
+      continue;
+    }
+    unknown_values.push_back(value);
+  }
+  if (unknown_values.empty()) return absl::OkStatus();
+  std::sort(unknown_values.begin(), unknown_values.end());
+  unknown_values.erase(
+      std::unique(unknown_values.begin(), unknown_values.end()),
+      unknown_values.end());
+
+  // Reads the (id, value) rows of `record_set` into `ids` and `entries`.
+  const auto read_ids = [ids](const RecordSet& record_set,
+                              std::vector<std::pair<std::string, int64>>*
+                                  entries) -> absl::Status {
+    for (const RecordSet::Record& record : record_set.records()) {
+      int64 id;
+      if (!absl::SimpleAtoi(record.values(0), &id)) {
+        return absl::InternalError(absl::StrCat(
+            "Cannot parse the id of an interned string: ", record.values(0)));
+      }
+      ids->insert({record.values(1), id});
+      entries->push_back({record.values(1), id});
+    }
+    return absl::OkStatus();
+  };
+
+  // The values found are committed by other transactions.
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.select_property_string_value_ids(),
+                   {Bind(absl::MakeConstSpan(unknown_values))}, &record_set));
+  std::vector<std::pair<std::string, int64>> committed;
+  MLMD_RETURN_IF_ERROR(read_ids(record_set, &committed));
+  property_string_dictionary_->Insert(committed);
+
+  std::vector<std::string> new_values;
+  QueryParameter rows;
+  for (const std::string& value : unknown_values) {
+    if (ids->contains(value)) continue;
+    new_values.push_back(value);
+    AppendRow({Bind(value)}, &rows);
+  }
+  if (new_values.empty()) return absl::OkStatus();
+  MLMD_RETURN_IF_ERROR(
+      ExecuteMultiRowInsert(query_config_.insert_property_string_values(),
+                            rows, /*inserted_ids=*/nullptr));
+  // A value interned concurrently by another transaction may not be visible
+  // yet, and is left out.
+  record_set.Clear();
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.select_property_string_value_ids(),
+                   {Bind(absl::MakeConstSpan(new_values))}, &record_set));
+  std::vector<std::pair<std::string, int64>> interned;
+  MLMD_RETURN_IF_ERROR(read_ids(record_set, &interned));
+  uncommitted_interned_strings_.insert(interned.begin(), interned.end());
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::BindPropertyValue(
+    const Value& value, QueryParameter* column, QueryParameter* bound_value) {
+  google::protobuf::Any compressed;
+  if (CompressesPropertyValues() &&
+      property_value_compressor_->Compress(value, &compressed)) {
+    *column = BindColumnName(CompressedValueColumn());
+    *bound_value = {{ProtoValue(compressed)}};
+    return absl::OkStatus();
+  }
+  if (value.has_string_value() && InternsPropertyStrings()) {
+    absl::flat_hash_map<std::string, int64> ids;
+    MLMD_RETURN_IF_ERROR(InternPropertyStrings({value.string_value()}, &ids));
+    const auto it = ids.find(value.string_value());
+    if (it != ids.end()) {
+      *column = BindColumnName("string_value_id");
+      *bound_value = Bind(it->second);
+      return absl::OkStatus();
+    }
+  }
+  *column = BindDataType(value);
+  *bound_value = BindValue(value);
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::UpdatePropertyValue(
+    const std::pair<absl::string_view, absl::string_view>& table,
+    const int64 node_id, const absl::string_view name, const Value& value) {
+  absl::flat_hash_map<std::string, int64> string_value_ids;
+  if (value.has_string_value() && InternsPropertyStrings()) {
+    MLMD_RETURN_IF_ERROR(
+        InternPropertyStrings({value.string_value()}, &string_value_ids));
+  }
+  std::vector<QueryParameter> parameters = {BindColumnName(table.first)};
+  for (QueryParameter& column :
+       BindPropertyValueColumns(value, &string_value_ids)) {
+    parameters.push_back(std::move(column));
+  }
+  parameters.push_back(BindColumnName(table.second));
+  parameters.push_back(Bind(node_id));
+  parameters.push_back(Bind(name));
+  return ExecuteQuery(
+      HasPropertyCompressedValue()
+          ? query_config_.update_property_value_with_compressed_value()
+          : query_config_.update_property_value(),
+      parameters);
+}
+
+void QueryConfigExecutor::AppendRenderedValue(const Value& value,
+                                              std::string* out) const {
+  switch (value.value_case()) {
+    case Value::kIntValue:
+      absl::StrAppend(out, value.int_value());
+      break;
+    case Value::kDoubleValue:
+      absl::StrAppend(out, std::to_string(value.double_value()));
+      break;
+    case Value::kStringValue:
+      out->push_back('\'');
+      metadata_source_->AppendEscapedString(value.string_value(), out);
+      out->push_back('\'');
+      break;
+    case Value::kProtoValue:
+      absl::StrAppend(
+          out, "X'",
+          absl::BytesToHexString(value.proto_value().SerializeAsString()),
+          "'");
+      break;
+    default:
+      absl::StrAppend(out, "NULL");
+  }
+}
+
+template <typename Formatter>
+void QueryConfigExecutor::AppendParameter(const QueryParameter& parameter,
+                                          const Formatter& format,
+                                          std::string* out) const {
+  if (parameter.sql_fragment) {
+    absl::StrAppend(out, *parameter.sql_fragment);
+    return;
+  }
+  if (!parameter.subquery) {
+    AppendParameterValues(parameter.values, parameter.row_size, format, out);
+    return;
+  }
+  // Inlines the values in place of each `$0` of the subquery.
+  absl::string_view subquery = *parameter.subquery;
+  for (size_t pos = subquery.find("$0"); pos != absl::string_view::npos;
+       pos = subquery.find("$0")) {
+    absl::StrAppend(out, subquery.substr(0, pos));
+    AppendParameterValues(parameter.values, parameter.row_size, format, out);
+    subquery.remove_prefix(pos + 2);
+  }
+  absl::StrAppend(out, subquery);
+}
+
 absl::Status QueryConfigExecutor::ExecuteQuery(const std::string& query) {
   RecordSet record_set;
   return metadata_source_->ExecuteQuery(query, &record_set);
@@ -406,9 +1294,191 @@ absl::Status QueryConfigExecutor::ExecuteQuery(const std::string& query,
   return metadata_source_->ExecuteQuery(query, record_set);
 }
 
+std::string QueryConfigExecutor::RenderQuery(
+    const CompiledTemplateQuery& compiled,
+    const absl::Span<const QueryParameter> parameters) const {
+  // Reserves the query for the strings of the parameters, and for a number
+  // with its separator for each other value.
+  size_t reserved_size = 0;
+  for (const TemplateQuerySegment& segment : compiled.segments) {
+    reserved_size += segment.literal.size();
+  }
+  for (const QueryParameter& parameter : parameters) {
+    if (parameter.sql_fragment) reserved_size += parameter.sql_fragment->size();
+    if (parameter.subquery) reserved_size += parameter.subquery->size();
+    for (const Value& value : parameter.values) {
+      reserved_size += value.has_string_value()
+                           ? value.string_value().size() + kValueReservedSize
+                           : kValueReservedSize;
+    }
+  }
+  std::string query;
+  query.reserve(reserved_size);
+  const auto append_value = [this](const Value& value, std::string* out) {
+    AppendRenderedValue(value, out);
+  };
+  AppendTemplateQuery(
+      compiled.segments,
+      [&](const int i, std::string* out) {
+        AppendParameter(parameters[i], append_value, out);
+      },
+      &query);
+  return query;
+}
+
+absl::Status QueryConfigExecutor::ExecuteQueries(
+    const absl::Span<const BoundQuery> queries) {
+  if (!metadata_source_->SupportsQueryPipelining()) {
+    for (const BoundQuery& query : queries) {
+      MLMD_RETURN_IF_ERROR(ExecuteQuery(*query.template_query,
+                                        query.parameters, query.record_set,
+                                        query.layout));
+    }
+    return absl::OkStatus();
+  }
+  std::vector<std::string> rendered_queries;
+  std::vector<RecordSet*> record_sets;
+  std::vector<absl::string_view> query_names;
+  for (const BoundQuery& query : queries) {
+    if (query.template_query->parameter_num() != query.parameters.size()) {
+      LOG(FATAL) << "Template query parameter_num does not match with given "
+                 << "parameters size (" << query.parameters.size()
+                 << "): " << query.template_query->DebugString();
+    }
+    CompiledTemplateQuery uncached;
+    const CompiledTemplateQuery& compiled =
+        GetCompiledTemplateQuery(*query.template_query, &uncached);
+    rendered_queries.push_back(RenderQuery(compiled, query.parameters));
+    record_sets.push_back(query.record_set);
+    query_names.push_back(compiled.name);
+  }
+  return metadata_source_->ExecuteQueries(rendered_queries, record_sets,
+                                          query_names);
+}
+
+absl::Status QueryConfigExecutor::ExecuteNodesAndPropertiesQueries(
+    const BoundQuery& nodes, const BoundQuery& properties) {
+  if (metadata_source_->SupportsQueryPipelining()) {
+    return ExecuteQueries({nodes, properties});
+  }
+  MLMD_RETURN_IF_ERROR(ExecuteQuery(*nodes.template_query, nodes.parameters,
+                                    nodes.record_set, nodes.layout));
+  if (NumRows(*nodes.record_set) == 0) {
+    return absl::OkStatus();
+  }
+  return ExecuteQuery(*properties.template_query, properties.parameters,
+                      properties.record_set, properties.layout);
+}
+
+absl::Status QueryConfigExecutor::SelectArtifactsWithPropertiesByID(
+    const absl::Span<const int64> artifact_ids,
+    const absl::Span<const std::string> property_names,
+    RecordSet* artifact_record_set, RecordSet* property_record_set) {
+  const MetadataSourceQueryConfig::TemplateQuery& select_by_id =
+      SelectPropertyQuery(
+          query_config_.select_artifact_property_with_compressed_value_by_id(),
+          query_config_.select_artifact_property_with_string_value_by_id(),
+          query_config_.select_artifact_property_with_proto_value_by_id(),
+          query_config_.select_artifact_property_by_artifact_id());
+  const MetadataSourceQueryConfig::TemplateQuery& select_by_id_and_name =
+      SelectPropertyQuery(
+          query_config_
+              .select_artifact_property_with_compressed_value_by_id_and_name(),
+          query_config_
+              .select_artifact_property_with_string_value_by_id_and_name(),
+          query_config_
+              .select_artifact_property_with_proto_value_by_id_and_name(),
+          query_config_.select_artifact_property_by_artifact_id_and_name());
+  return ExecuteNodesAndPropertiesQueries(
+      {&query_config_.select_artifact_by_id(),
+       {Bind(artifact_ids)},
+       artifact_record_set,
+       RecordSetLayout::kTypedColumns},
+      property_names.empty()
+          ? BoundQuery{&select_by_id,
+                       {Bind(artifact_ids)},
+                       property_record_set,
+                       RecordSetLayout::kTypedColumns}
+          : BoundQuery{&select_by_id_and_name,
+                       {Bind(artifact_ids), Bind(property_names)},
+                       property_record_set,
+                       RecordSetLayout::kTypedColumns});
+}
+
+absl::Status QueryConfigExecutor::SelectExecutionsWithPropertiesByID(
+    const absl::Span<const int64> execution_ids,
+    const absl::Span<const std::string> property_names,
+    RecordSet* execution_record_set, RecordSet* property_record_set) {
+  const MetadataSourceQueryConfig::TemplateQuery& select_by_id =
+      SelectPropertyQuery(
+          query_config_.select_execution_property_with_compressed_value_by_id(),
+          query_config_.select_execution_property_with_string_value_by_id(),
+          query_config_.select_execution_property_with_proto_value_by_id(),
+          query_config_.select_execution_property_by_execution_id());
+  const MetadataSourceQueryConfig::TemplateQuery& select_by_id_and_name =
+      SelectPropertyQuery(
+          query_config_
+              .select_execution_property_with_compressed_value_by_id_and_name(),
+          query_config_
+              .select_execution_property_with_string_value_by_id_and_name(),
+          query_config_
+              .select_execution_property_with_proto_value_by_id_and_name(),
+          query_config_.select_execution_property_by_execution_id_and_name());
+  return ExecuteNodesAndPropertiesQueries(
+      {&query_config_.select_execution_by_id(),
+       {Bind(execution_ids)},
+       execution_record_set,
+       RecordSetLayout::kTypedColumns},
+      property_names.empty()
+          ? BoundQuery{&select_by_id,
+                       {Bind(execution_ids)},
+                       property_record_set,
+                       RecordSetLayout::kTypedColumns}
+          : BoundQuery{&select_by_id_and_name,
+                       {Bind(execution_ids), Bind(property_names)},
+                       property_record_set,
+                       RecordSetLayout::kTypedColumns});
+}
+
+absl::Status QueryConfigExecutor::SelectContextsWithPropertiesByID(
+    const absl::Span<const int64> context_ids,
+    const absl::Span<const std::string> property_names,
+    RecordSet* context_record_set, RecordSet* property_record_set) {
+  const MetadataSourceQueryConfig::TemplateQuery& select_by_id =
+      SelectPropertyQuery(
+          query_config_.select_context_property_with_compressed_value_by_id(),
+          query_config_.select_context_property_with_string_value_by_id(),
+          query_config_.select_context_property_with_proto_value_by_id(),
+          query_config_.select_context_property_by_context_id());
+  const MetadataSourceQueryConfig::TemplateQuery& select_by_id_and_name =
+      SelectPropertyQuery(
+          query_config_
+              .select_context_property_with_compressed_value_by_id_and_name(),
+          query_config_
+              .select_context_property_with_string_value_by_id_and_name(),
+          query_config_
+              .select_context_property_with_proto_value_by_id_and_name(),
+          query_config_.select_context_property_by_context_id_and_name());
+  return ExecuteNodesAndPropertiesQueries(
+      {&query_config_.select_context_by_id(),
+       {Bind(context_ids)},
+       context_record_set,
+       RecordSetLayout::kTypedColumns},
+      property_names.empty()
+          ? BoundQuery{&select_by_id,
+                       {Bind(context_ids)},
+                       property_record_set,
+                       RecordSetLayout::kTypedColumns}
+          : BoundQuery{&select_by_id_and_name,
+                       {Bind(context_ids), Bind(property_names)},
+                       property_record_set,
+                       RecordSetLayout::kTypedColumns});
+}
+
 absl::Status QueryConfigExecutor::ExecuteQuery(
     const MetadataSourceQueryConfig::TemplateQuery& template_query,
-    const absl::Span<const std::string> parameters, RecordSet* record_set) {
+    const absl::Span<const QueryParameter> parameters, RecordSet* record_set,
+    const RecordSetLayout layout) {
   if (parameters.size() > 10) {
     return absl::InvalidArgumentError(
         "Template query has too many parameters (at most 10 is supported).");
@@ -418,13 +1488,235 @@ absl::Status QueryConfigExecutor::ExecuteQuery(
                << "parameters size (" << parameters.size()
                << "): " << template_query.DebugString();
   }
-  std::vector<std::pair<const std::string, const std::string>> replacements;
-  replacements.reserve(parameters.size());
-  for (int i = 0; i < parameters.size(); i++) {
-    replacements.push_back({absl::StrCat("$", i), parameters[i]});
+  CompiledTemplateQuery uncached;
+  const CompiledTemplateQuery& compiled =
+      GetCompiledTemplateQuery(template_query, &uncached);
+  if (parameters.empty() || !metadata_source_->SupportsPreparedStatements()) {
+    return metadata_source_->ExecuteQuery(RenderQuery(compiled, parameters),
+                                          record_set, compiled.name);
+  }
+  // Replaces each `$i` with one `?` per value, and collects the values in the
+  // order of the placeholders. SQL fragments are inlined.
+  std::string prepared_query;
+  prepared_query.reserve(template_query.query().size());
+  std::vector<Value> values;
+  const auto append_placeholder = [&values](const Value& value,
+                                            std::string* out) {
+    out->push_back('?');
+    values.push_back(value);
+  };
+  for (const TemplateQuerySegment& segment : compiled.segments) {
+    if (segment.parameter < 0) {
+      absl::StrAppend(&prepared_query,
+                      StripStatementTerminator(segment.literal));
+      break;
+    }
+    absl::StrAppend(&prepared_query, segment.literal);
+    AppendParameter(parameters[segment.parameter], append_placeholder,
+                    &prepared_query);
+  }
+  return metadata_source_->ExecutePreparedQuery(
+      prepared_query, values, record_set, layout, compiled.name);
+}
+
+absl::Status QueryConfigExecutor::ExecuteMultiRowInsert(
+    const MetadataSourceQueryConfig::TemplateQuery& query,
+    const QueryParameter& rows, std::vector<int64>* inserted_ids) {
+  if (rows.values.empty()) {
+    return absl::OkStatus();
+  }
+  CHECK_GT(rows.row_size, 0) << "The rows should be appended by AppendRow.";
+  const int num_rows = rows.values.size() / rows.row_size;
+  for (int begin = 0; begin < num_rows; begin += kMaxNumRowsPerInsert) {
+    const int batch_size = std::min(kMaxNumRowsPerInsert, num_rows - begin);
+    QueryParameter batch;
+    batch.row_size = rows.row_size;
+    batch.values.assign(
+        rows.values.begin() + begin * rows.row_size,
+        rows.values.begin() + (begin + batch_size) * rows.row_size);
+    RecordSet returned_ids;
+    MLMD_RETURN_IF_ERROR(ExecuteQuery(
+        query, absl::Span<const QueryParameter>(&batch, 1), &returned_ids));
+    if (inserted_ids == nullptr) {
+      continue;
+    }
+    // Backends whose inserts return the assigned ids (e.g., PostgreSQL's
+    // RETURNING clause) do not need the follow-up id range query.
+    if (returned_ids.records_size() > 0) {
+      if (returned_ids.records_size() != batch_size) {
+        return absl::InternalError(absl::StrCat(
+            "The multi-row insert returned ", returned_ids.records_size(),
+            " ids for ", batch_size, " rows."));
+      }
+      for (const RecordSet::Record& record : returned_ids.records()) {
+        int64 id;
+        if (record.values_size() == 0 ||
+            !absl::SimpleAtoi(record.values(0), &id)) {
+          return absl::InternalError(
+              "Could not parse an id returned by the multi-row insert.");
+        }
+        inserted_ids->push_back(id);
+      }
+      continue;
+    }
+    // Both SQLite and InnoDB assign consecutive ids to the rows of a single
+    // insert statement, whose number of rows is known in advance.
+    RecordSet record_set;
+    MLMD_RETURN_IF_ERROR(
+        ExecuteQuery(query_config_.select_last_insert_id_range(),
+                     {Bind(batch_size)}, &record_set));
+    int64 first_id, last_id;
+    if (record_set.records_size() == 0 ||
+        record_set.records(0).values_size() < 2 ||
+        !absl::SimpleAtoi(record_set.records(0).values(0), &first_id) ||
+        !absl::SimpleAtoi(record_set.records(0).values(1), &last_id)) {
+      return absl::InternalError(
+          "Could not find the ids assigned by the multi-row insert.");
+    }
+    if (last_id - first_id + 1 != batch_size) {
+      return absl::InternalError(absl::StrCat(
+          "The ids assigned by the multi-row insert are not consecutive: [",
+          first_id, ", ", last_id, "] for ", batch_size, " rows."));
+    }
+    for (int64 id = first_id; id <= last_id; id++) {
+      inserted_ids->push_back(id);
+    }
+  }
+  return absl::OkStatus();
+}
+
+template <typename Node>
+absl::Status QueryConfigExecutor::InsertNodeProperties(
+    const MetadataSourceQueryConfig::TemplateQuery& query,
+    const absl::Span<const int64> node_ids, const absl::Span<const Node> nodes) {
+  CHECK_EQ(node_ids.size(), nodes.size()) << "Each node should have an id.";
+  // The string values are interned in a batch before the rows are appended.
+  absl::flat_hash_map<std::string, int64> string_value_ids;
+  if (InternsPropertyStrings()) {
+    std::vector<std::string> string_values;
+    for (const Node& node : nodes) {
+      for (const auto* properties :
+           {&node.properties(), &node.custom_properties()}) {
+        for (const auto& property : *properties) {
+          if (property.second.has_string_value()) {
+            string_values.push_back(property.second.string_value());
+          }
+        }
+      }
+    }
+    MLMD_RETURN_IF_ERROR(
+        InternPropertyStrings(string_values, &string_value_ids));
+  }
+  const absl::flat_hash_map<std::string, int64>* ids =
+      InsertsPropertyValueIdColumns() ? &string_value_ids : nullptr;
+  QueryParameter rows;
+  for (int i = 0; i < nodes.size(); i++) {
+    for (const auto& property : nodes[i].properties()) {
+      MLMD_RETURN_IF_ERROR(CheckPropertyValueSupported(property.second));
+      AppendPropertyRow(node_ids[i], property.first,
+                        /*is_custom_property=*/false, property.second, &rows,
+                        ids);
+    }
+    for (const auto& property : nodes[i].custom_properties()) {
+      MLMD_RETURN_IF_ERROR(CheckPropertyValueSupported(property.second));
+      AppendPropertyRow(node_ids[i], property.first,
+                        /*is_custom_property=*/true, property.second, &rows,
+                        ids);
+    }
+  }
+  return ExecuteMultiRowInsert(query, rows, /*inserted_ids=*/nullptr);
+}
+
+absl::Status QueryConfigExecutor::InsertArtifactDerivations(
+    const absl::Span<const int64> event_ids) {
+  // Schema v10 has no ArtifactDerivation table to maintain.
+  if (event_ids.empty() || IsQuerySchemaVersionEquals(10)) {
+    return absl::OkStatus();
+  }
+  return ExecuteQuery(query_config_.insert_artifact_derivations(),
+                      {Bind(event_ids)});
+}
+
+absl::Status QueryConfigExecutor::SelectArtifactDerivationDistances(
+    const absl::Span<const int64> artifact_ids, const bool upstream,
+    const int64 max_num_hops, const absl::optional<int64> context_id,
+    RecordSet* record_set) {
+  MLMD_RETURN_IF_ERROR(VerifyCurrentQueryVersionIsAtLeast(11));
+  return ExecuteQuery(
+      upstream ? query_config_.select_upstream_artifact_distances()
+               : query_config_.select_downstream_artifact_distances(),
+      {Bind(artifact_ids), Bind(max_num_hops), Bind(context_id.value_or(0))},
+      record_set);
+}
+
+absl::Status QueryConfigExecutor::InsertChangeLogEntries(
+    const absl::Span<const ChangeLogEntry> entries) {
+  // Schema v11 has no ChangeLog table to append to.
+  if (entries.empty() || IsQuerySchemaVersionEquals(11)) {
+    return absl::OkStatus();
   }
-  return metadata_source_->ExecuteQuery(
-      absl::StrReplaceAll(template_query.query(), replacements), record_set);
+  const QueryParameter null_value = {{Value()}};
+  QueryParameter rows;
+  for (const ChangeLogEntry& entry : entries) {
+    AppendRow({Bind(entry.kind()), Bind(entry.operation()),
+               entry.has_artifact_id() ? Bind(entry.artifact_id()) : null_value,
+               entry.has_execution_id() ? Bind(entry.execution_id())
+                                        : null_value,
+               entry.has_context_id() ? Bind(entry.context_id()) : null_value,
+               Bind(entry.milliseconds_since_epoch())},
+              &rows);
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_change_log_entries(), rows,
+                               /*inserted_ids=*/nullptr);
+}
+
+absl::Status QueryConfigExecutor::SelectChangeLogEntries(
+    const int64 after_sequence_number, const int64 max_num_entries,
+    RecordSet* record_set) {
+  MLMD_RETURN_IF_ERROR(VerifyCurrentQueryVersionIsAtLeast(12));
+  return ExecuteQuery(query_config_.select_change_log_entries(),
+                      {Bind(after_sequence_number), Bind(max_num_entries)},
+                      record_set);
+}
+
+absl::Status QueryConfigExecutor::SelectLastChangeLogSequenceNumber(
+    RecordSet* record_set) {
+  MLMD_RETURN_IF_ERROR(VerifyCurrentQueryVersionIsAtLeast(12));
+  return ExecuteQuery(query_config_.select_last_change_log_sequence_number(),
+                      {}, record_set);
+}
+
+absl::Status QueryConfigExecutor::ArchiveExecutions(
+    const absl::Span<const Execution> executions) {
+  MLMD_RETURN_IF_ERROR(VerifyCurrentQueryVersionIsAtLeast(16));
+  if (executions.empty()) {
+    return absl::OkStatus();
+  }
+  std::vector<int64> execution_ids;
+  execution_ids.reserve(executions.size());
+  QueryParameter rows;
+  for (const Execution& execution : executions) {
+    execution_ids.push_back(execution.id());
+    google::protobuf::Any archived_execution;
+    archived_execution.PackFrom(execution);
+    AppendRow({Bind(execution.id()),
+               Bind(execution.last_update_time_since_epoch()),
+               {{ProtoValue(archived_execution)}}},
+              &rows);
+  }
+  MLMD_RETURN_IF_ERROR(
+      ExecuteMultiRowInsert(query_config_.insert_archived_executions(), rows,
+                            /*inserted_ids=*/nullptr));
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.archive_events_by_execution_ids(),
+                   {Bind(execution_ids)}));
+  MLMD_RETURN_IF_ERROR(ExecuteQuery(
+      query_config_.delete_events_by_executions_id(), {Bind(execution_ids)}));
+  MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.delete_executions_by_id(),
+                                    {Bind(execution_ids)}));
+  return ExecuteQuery(
+      query_config_.delete_executions_properties_by_executions_id(),
+      {Bind(execution_ids)});
 }
 
 absl::Status QueryConfigExecutor::IsCompatible(int64 db_version,
@@ -449,6 +1741,9 @@ absl::Status QueryConfigExecutor::InitMetadataSource() {
       ExecuteQuery(query_config_.create_execution_property_table()));
   MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.create_event_table()));
   MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.create_event_path_table()));
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.create_artifact_derivation_table()));
+  MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.create_change_log_table()));
   MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.create_mlmd_env_table()));
   MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.create_context_table()));
   MLMD_RETURN_IF_ERROR(
@@ -457,6 +1752,12 @@ absl::Status QueryConfigExecutor::InitMetadataSource() {
       ExecuteQuery(query_config_.create_parent_context_table()));
   MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.create_association_table()));
   MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.create_attribution_table()));
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.create_execution_archive_table()));
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.create_event_archive_table()));
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.create_property_string_value_table()));
   for (const MetadataSourceQueryConfig::TemplateQuery& index_query :
        query_config_.secondary_indices()) {
     const absl::Status status = ExecuteQuery(index_query);
@@ -468,6 +1769,7 @@ absl::Status QueryConfigExecutor::InitMetadataSource() {
     }
     MLMD_RETURN_IF_ERROR(status);
   }
+  MLMD_RETURN_IF_ERROR(CreateIndexedPropertyIndices());
 
   int64 library_version = GetLibraryVersion();
   absl::Status insert_schema_version_status =
@@ -487,6 +1789,74 @@ absl::Status QueryConfigExecutor::InitMetadataSource() {
   return absl::OkStatus();
 }
 
+absl::Status QueryConfigExecutor::CreateIndexedPropertyIndices() {
+  if (!query_config_.has_create_indexed_property_index()) {
+    return absl::OkStatus();
+  }
+  for (const IndexedProperty& property : indexed_properties_) {
+    absl::string_view node_kind, table, node_id_column;
+    switch (property.node_kind()) {
+      case IndexedProperty::ARTIFACT:
+        std::tie(node_kind, table, node_id_column) =
+            std::make_tuple("artifact", "ArtifactProperty", "artifact_id");
+        break;
+      case IndexedProperty::EXECUTION:
+        std::tie(node_kind, table, node_id_column) =
+            std::make_tuple("execution", "ExecutionProperty", "execution_id");
+        break;
+      case IndexedProperty::CONTEXT:
+        std::tie(node_kind, table, node_id_column) =
+            std::make_tuple("context", "ContextProperty", "context_id");
+        break;
+      default:
+        LOG(FATAL) << "Unknown node kind of an indexed property: "
+                   << property.DebugString()
+                   << "This is an internal error: indexed properties should "
+                      "have been checked before they got here";
+    }
+    // The node id makes the index covering for the joins of the filters.
+    std::string columns;
+    switch (property.value_type()) {
+      case PropertyType::INT:
+        columns = absl::StrCat("`int_value`, `", node_id_column, "`");
+        break;
+      case PropertyType::DOUBLE:
+        columns = absl::StrCat("`double_value`, `", node_id_column, "`");
+        break;
+      case PropertyType::STRING:
+        // The interned values are looked up by their ids, and the others,
+        // whose ids are null, by the values.
+        columns = absl::StrCat(
+            HasPropertyStringValueId() ? "`string_value_id`, " : "",
+            "`string_value`, `", node_id_column, "`");
+        break;
+      default:
+        LOG(FATAL) << "Unsupported value type of an indexed property: "
+                   << property.DebugString()
+                   << "This is an internal error: indexed properties should "
+                      "have been checked before they got here";
+    }
+    // The names which are not identifiers are hex encoded.
+    const std::string& name = property.property_name();
+    const bool is_identifier =
+        std::all_of(name.begin(), name.end(), [](const char c) {
+          return absl::ascii_isalnum(c) || c == '_';
+        });
+    const std::string index_name = absl::StrCat(
+        "idx_", node_kind, property.is_custom_property() ? "_custom" : "",
+        "_property_", is_identifier ? name : absl::BytesToHexString(name), "_",
+        absl::AsciiStrToLower(PropertyType_Name(property.value_type())));
+    MLMD_RETURN_IF_ERROR(ExecuteQuery(
+        query_config_.create_indexed_property_index(),
+        {BindColumnName(index_name), BindColumnName(table),
+         BindColumnName(columns),
+         BindColumnName(
+             absl::StrCat("'", metadata_source_->EscapeString(name), "'")),
+         BindColumnName(property.is_custom_property() ? "1" : "0")}));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status QueryConfigExecutor::InitMetadataSourceIfNotExists(
     const bool enable_upgrade_migration) {
   // If |query_schema_version_| is given, then the query executor is expected to
@@ -509,12 +1879,19 @@ absl::Status QueryConfigExecutor::InitMetadataSourceIfNotExists(
   checks.push_back({CheckExecutionPropertyTable(), "execution_property_table"});
   checks.push_back({CheckEventTable(), "event_table"});
   checks.push_back({CheckEventPathTable(), "event_path_table"});
+  checks.push_back(
+      {CheckArtifactDerivationTable(), "artifact_derivation_table"});
+  checks.push_back({CheckChangeLogTable(), "change_log_table"});
   checks.push_back({CheckMLMDEnvTable(), "mlmd_env_table"});
   checks.push_back({CheckContextTable(), "context_table"});
   checks.push_back({CheckParentContextTable(), "parent_context_table"});
   checks.push_back({CheckContextPropertyTable(), "context_property_table"});
   checks.push_back({CheckAssociationTable(), "association_table"});
   checks.push_back({CheckAttributionTable(), "attribution_table"});
+  checks.push_back({CheckExecutionArchiveTable(), "execution_archive_table"});
+  checks.push_back({CheckEventArchiveTable(), "event_archive_table"});
+  checks.push_back(
+      {CheckPropertyStringValueTable(), "property_string_value_table"});
   std::vector<std::string> missing_schema_error_messages;
   std::vector<std::string> successful_checks;
   std::vector<std::string> failing_checks;
@@ -530,7 +1907,9 @@ absl::Status QueryConfigExecutor::InitMetadataSourceIfNotExists(
   }
 
   // all table required by the current lib version exists
-  if (missing_schema_error_messages.empty()) return absl::OkStatus();
+  if (missing_schema_error_messages.empty()) {
+    return CreateIndexedPropertyIndices();
+  }
 
   // some table exists, but not all.
   if (checks.size() != missing_schema_error_messages.size()) {
@@ -576,6 +1955,260 @@ absl::Status QueryConfigExecutor::InsertContextType(
       {Bind(name), Bind(version), Bind(description)}, type_id);
 }
 
+void QueryConfigExecutor::AppendTypeRow(const ArtifactType& type,
+                                        QueryParameter* rows) {
+  const QueryParameter null_value = {{Value()}};
+  AppendRow({Bind(type.name()), Bind(TypeKind::ARTIFACT_TYPE),
+             Bind(GetTypeVersion(type)),
+             Bind(type.has_description()
+                      ? absl::make_optional(type.description())
+                      : absl::nullopt),
+             null_value, null_value},
+            rows);
+}
+
+void QueryConfigExecutor::AppendTypeRow(const ExecutionType& type,
+                                        QueryParameter* rows) {
+  AppendRow({Bind(type.name()), Bind(TypeKind::EXECUTION_TYPE),
+             Bind(GetTypeVersion(type)),
+             Bind(type.has_description()
+                      ? absl::make_optional(type.description())
+                      : absl::nullopt),
+             Bind(type.has_input_type() ? &type.input_type() : nullptr),
+             Bind(type.has_output_type() ? &type.output_type() : nullptr)},
+            rows);
+}
+
+void QueryConfigExecutor::AppendTypeRow(const ContextType& type,
+                                        QueryParameter* rows) {
+  const QueryParameter null_value = {{Value()}};
+  AppendRow({Bind(type.name()), Bind(TypeKind::CONTEXT_TYPE),
+             Bind(GetTypeVersion(type)),
+             Bind(type.has_description()
+                      ? absl::make_optional(type.description())
+                      : absl::nullopt),
+             null_value, null_value},
+            rows);
+}
+
+template <typename Type>
+absl::Status QueryConfigExecutor::InsertTypesImpl(
+    const absl::Span<const Type> types, std::vector<int64>* type_ids) {
+  type_ids->clear();
+  QueryParameter rows;
+  for (const Type& type : types) {
+    AppendTypeRow(type, &rows);
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_types(), rows, type_ids);
+}
+
+absl::Status QueryConfigExecutor::InsertTypes(
+    const absl::Span<const ArtifactType> types, std::vector<int64>* type_ids) {
+  return InsertTypesImpl(types, type_ids);
+}
+
+absl::Status QueryConfigExecutor::InsertTypes(
+    const absl::Span<const ExecutionType> types, std::vector<int64>* type_ids) {
+  return InsertTypesImpl(types, type_ids);
+}
+
+absl::Status QueryConfigExecutor::InsertTypes(
+    const absl::Span<const ContextType> types, std::vector<int64>* type_ids) {
+  return InsertTypesImpl(types, type_ids);
+}
+
+template <typename Type>
+absl::Status QueryConfigExecutor::InsertTypePropertiesImpl(
+    const absl::Span<const int64> type_ids, const absl::Span<const Type> types) {
+  CHECK_EQ(type_ids.size(), types.size()) << "Each type should have an id.";
+  QueryParameter rows;
+  for (int i = 0; i < types.size(); i++) {
+    for (const auto& property : types[i].properties()) {
+      AppendRow({Bind(type_ids[i]), Bind(property.first),
+                 Bind(property.second)},
+                &rows);
+    }
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_type_properties(), rows,
+                               /*inserted_ids=*/nullptr);
+}
+
+absl::Status QueryConfigExecutor::InsertTypeProperties(
+    const absl::Span<const int64> type_ids,
+    const absl::Span<const ArtifactType> types) {
+  return InsertTypePropertiesImpl(type_ids, types);
+}
+
+absl::Status QueryConfigExecutor::InsertTypeProperties(
+    const absl::Span<const int64> type_ids,
+    const absl::Span<const ExecutionType> types) {
+  return InsertTypePropertiesImpl(type_ids, types);
+}
+
+absl::Status QueryConfigExecutor::InsertTypeProperties(
+    const absl::Span<const int64> type_ids,
+    const absl::Span<const ContextType> types) {
+  return InsertTypePropertiesImpl(type_ids, types);
+}
+
+absl::Status QueryConfigExecutor::InsertArtifacts(
+    const absl::Span<const Artifact> artifacts, const absl::Time create_time,
+    const absl::Time update_time, std::vector<int64>* artifact_ids) {
+  artifact_ids->clear();
+  QueryParameter rows;
+  for (const Artifact& artifact : artifacts) {
+    AppendRow(
+        {Bind(artifact.type_id()), Bind(artifact.uri()),
+         Bind(artifact.has_state() ? absl::make_optional(artifact.state())
+                                   : absl::nullopt),
+         Bind(artifact.has_name() ? absl::make_optional(artifact.name())
+                                  : absl::nullopt),
+         Bind(absl::ToUnixMillis(create_time)),
+         Bind(absl::ToUnixMillis(update_time))},
+        &rows);
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_artifacts(), rows,
+                               artifact_ids);
+}
+
+absl::Status QueryConfigExecutor::InsertArtifactIfNotExist(
+    const int64 type_id, const std::string& artifact_uri,
+    const absl::optional<Artifact::State>& state, const std::string& name,
+    const absl::Time create_time, const absl::Time update_time,
+    int64* artifact_id, bool* is_inserted) {
+  MLMD_RETURN_IF_ERROR(ExecuteQuery(
+      query_config_.insert_artifact_if_not_exist(),
+      {Bind(type_id), Bind(artifact_uri), Bind(state), Bind(name),
+       Bind(absl::ToUnixMillis(create_time)),
+       Bind(absl::ToUnixMillis(update_time))}));
+  absl::optional<int64> id;
+  MLMD_RETURN_IF_ERROR(SelectLastUpsertID(&id, is_inserted));
+  if (id) {
+    *artifact_id = *id;
+    return absl::OkStatus();
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      SelectArtifactByTypeIDAndArtifactName(type_id, name, &record_set));
+  if (record_set.records_size() == 0 ||
+      !absl::SimpleAtoi(record_set.records(0).values(0), artifact_id)) {
+    return absl::InternalError(
+        absl::StrCat("Could not find the artifact with name: ", name));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::InsertArtifactProperties(
+    const absl::Span<const int64> artifact_ids,
+    const absl::Span<const Artifact> artifacts) {
+  if (InsertsPropertyValueIdColumns()) {
+    return InsertNodeProperties(
+        HasPropertyCompressedValue()
+            ? query_config_.insert_artifact_properties_with_compressed_value()
+            : query_config_.insert_artifact_properties_with_string_value_id(),
+        artifact_ids, artifacts);
+  }
+  return InsertNodeProperties(
+      HasPropertyProtoValue()
+          ? query_config_.insert_artifact_properties_with_proto_value()
+          : query_config_.insert_artifact_properties(),
+      artifact_ids, artifacts);
+}
+
+absl::Status QueryConfigExecutor::InsertExecutions(
+    const absl::Span<const Execution> executions, const absl::Time create_time,
+    const absl::Time update_time, std::vector<int64>* execution_ids) {
+  execution_ids->clear();
+  QueryParameter rows;
+  for (const Execution& execution : executions) {
+    AppendRow({Bind(execution.type_id()),
+               Bind(execution.has_last_known_state()
+                        ? absl::make_optional(execution.last_known_state())
+                        : absl::nullopt),
+               Bind(execution.has_name() ? absl::make_optional(execution.name())
+                                         : absl::nullopt),
+               Bind(absl::ToUnixMillis(create_time)),
+               Bind(absl::ToUnixMillis(update_time))},
+              &rows);
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_executions(), rows,
+                               execution_ids);
+}
+
+absl::Status QueryConfigExecutor::InsertExecutionProperties(
+    const absl::Span<const int64> execution_ids,
+    const absl::Span<const Execution> executions) {
+  if (InsertsPropertyValueIdColumns()) {
+    return InsertNodeProperties(
+        HasPropertyCompressedValue()
+            ? query_config_.insert_execution_properties_with_compressed_value()
+            : query_config_.insert_execution_properties_with_string_value_id(),
+        execution_ids, executions);
+  }
+  return InsertNodeProperties(
+      HasPropertyProtoValue()
+          ? query_config_.insert_execution_properties_with_proto_value()
+          : query_config_.insert_execution_properties(),
+      execution_ids, executions);
+}
+
+absl::Status QueryConfigExecutor::InsertContexts(
+    const absl::Span<const Context> contexts, const absl::Time create_time,
+    const absl::Time update_time, std::vector<int64>* context_ids) {
+  context_ids->clear();
+  QueryParameter rows;
+  for (const Context& context : contexts) {
+    AppendRow({Bind(context.type_id()), Bind(context.name()),
+               Bind(absl::ToUnixMillis(create_time)),
+               Bind(absl::ToUnixMillis(update_time))},
+              &rows);
+  }
+  return ExecuteMultiRowInsert(query_config_.insert_contexts(), rows,
+                               context_ids);
+}
+
+absl::Status QueryConfigExecutor::InsertContextIfNotExist(
+    const int64 type_id, const std::string& name, const absl::Time create_time,
+    const absl::Time update_time, int64* context_id, bool* is_inserted) {
+  MLMD_RETURN_IF_ERROR(
+      ExecuteQuery(query_config_.insert_context_if_not_exist(),
+                   {Bind(type_id), Bind(name),
+                    Bind(absl::ToUnixMillis(create_time)),
+                    Bind(absl::ToUnixMillis(update_time))}));
+  absl::optional<int64> id;
+  MLMD_RETURN_IF_ERROR(SelectLastUpsertID(&id, is_inserted));
+  if (id) {
+    *context_id = *id;
+    return absl::OkStatus();
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      SelectContextByTypeIDAndContextName(type_id, name, &record_set));
+  if (record_set.records_size() == 0 ||
+      !absl::SimpleAtoi(record_set.records(0).values(0), context_id)) {
+    return absl::InternalError(
+        absl::StrCat("Could not find the context with name: ", name));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::InsertContextProperties(
+    const absl::Span<const int64> context_ids,
+    const absl::Span<const Context> contexts) {
+  if (InsertsPropertyValueIdColumns()) {
+    return InsertNodeProperties(
+        HasPropertyCompressedValue()
+            ? query_config_.insert_context_properties_with_compressed_value()
+            : query_config_.insert_context_properties_with_string_value_id(),
+        context_ids, contexts);
+  }
+  return InsertNodeProperties(
+      HasPropertyProtoValue()
+          ? query_config_.insert_context_properties_with_proto_value()
+          : query_config_.insert_context_properties(),
+      context_ids, contexts);
+}
+
 absl::Status QueryConfigExecutor::SelectTypesByID(
     const absl::Span<const int64> type_ids, TypeKind type_kind,
     RecordSet* record_set) {
@@ -635,31 +2268,26 @@ absl::Status QueryConfigExecutor::ListNodeIDsUsingOptions(
 #ifndef _WIN32
   if (options.has_filter_query() && !options.filter_query().empty()) {
     node_table_alias = ml_metadata::FilterQueryBuilder<Node>::kBaseTableAlias;
-    ml_metadata::FilterQueryAstResolver<Node> ast_resolver(
-        options.filter_query());
-    const absl::Status ast_gen_status = ast_resolver.Resolve();
-    if (!ast_gen_status.ok()) {
-      return absl::InvalidArgumentError(
-          absl::StrCat("Invalid `filter_query`: ", ast_gen_status.message()));
-    }
-    // Generate SQL
-    ml_metadata::FilterQueryBuilder<Node> query_builder;
-    const absl::Status sql_gen_status =
-        ast_resolver.GetAst()->Accept(&query_builder);
-    if (!sql_gen_status.ok()) {
-      return absl::InternalError(
-          absl::StrCat("Failed to construct valid SQL from `filter_query`: ",
-                       sql_gen_status.message()));
-    }
+    // The compiled SQL of the filter queries is cached across the calls.
+    CompiledFilterQuery compiled_filter_query;
+    MLMD_RETURN_IF_ERROR(FilterQueryCache::GetDefault()->Compile<Node>(
+        options.filter_query(), &compiled_filter_query,
+        /*resolve_interned_strings=*/HasPropertyStringValueId(),
+        GetRoutedIndexedProperties()));
+    MLMD_RETURN_IF_ERROR(CheckFilteredPropertiesUncompressed<Node>(
+        compiled_filter_query.property_names,
+        compiled_filter_query.custom_property_names));
+    // The neighbors having many rows per node are semi-joined by the compiled
+    // filter query, so that each node is selected at most once.
     sql_query = absl::Substitute(
-        "SELECT distinct $0.`id` FROM $1 WHERE $2 AND ", *node_table_alias,
-        query_builder.GetFromClause(), query_builder.GetWhereClause());
+        "SELECT $0.`id` FROM $1 WHERE $2 AND ", *node_table_alias,
+        compiled_filter_query.from_clause, compiled_filter_query.where_clause);
   }
 #endif
 
   if (candidate_ids) {
     absl::SubstituteAndAppend(&sql_query, " `id` IN ($0) AND ",
-                              Bind(*candidate_ids));
+                              absl::StrJoin(*candidate_ids, ", "));
   }
   MLMD_RETURN_IF_ERROR(
       AppendOrderingThresholdClause(options, node_table_alias, sql_query));
@@ -669,6 +2297,81 @@ absl::Status QueryConfigExecutor::ListNodeIDsUsingOptions(
   return ExecuteQuery(sql_query, record_set);
 }
 
+template <typename Node>
+absl::Status QueryConfigExecutor::CompileBoundary(
+    absl::string_view boundary_condition, CompiledBoundary* boundary) {
+  // TODO(b/195700145) MLMD Filtering is not supported in Windows platform since
+  // ZetaSQL currently does not compile on Windows.
+#ifndef _WIN32
+  CompiledFilterQuery compiled_filter_query;
+  MLMD_RETURN_IF_ERROR(FilterQueryCache::GetDefault()->Compile<Node>(
+      boundary_condition, &compiled_filter_query,
+      /*resolve_interned_strings=*/HasPropertyStringValueId(),
+      GetRoutedIndexedProperties()));
+  MLMD_RETURN_IF_ERROR(CheckFilteredPropertiesUncompressed<Node>(
+      compiled_filter_query.property_names,
+      compiled_filter_query.custom_property_names));
+  boundary->node_table_alias =
+      std::string(FilterQueryBuilder<Node>::kBaseTableAlias);
+  boundary->from_clause = std::move(compiled_filter_query.from_clause);
+  boundary->where_clause = std::move(compiled_filter_query.where_clause);
+  return absl::OkStatus();
+#else
+  return absl::UnimplementedError(
+      "The boundary conditions are not supported on Windows.");
+#endif
+}
+
+template <typename Node>
+absl::Status QueryConfigExecutor::CheckFilteredPropertiesUncompressed(
+    const absl::Span<const std::string> property_names,
+    const absl::Span<const std::string> custom_property_names) {
+  // The values are only compressed since v17.
+  if (!HasPropertyStringValueId()) {
+    return absl::OkStatus();
+  }
+  absl::string_view table = kPropertyTables[0].first;
+  if (std::is_same<Node, Execution>::value) {
+    table = kPropertyTables[1].first;
+  } else if (std::is_same<Node, Context>::value) {
+    table = kPropertyTables[2].first;
+  }
+  for (const bool is_custom_property : {false, true}) {
+    for (const std::string& name :
+         is_custom_property ? custom_property_names : property_names) {
+      RecordSet record_set;
+      MLMD_RETURN_IF_ERROR(ExecuteQuery(
+          query_config_.select_compressed_property(),
+          {BindColumnName(table), Bind(name), Bind(is_custom_property),
+           BindColumnName(CompressedValueColumn())},
+          &record_set));
+      if (record_set.records_size() > 0) {
+        return absl::FailedPreconditionError(absl::StrCat(
+            "The filter query compares the ",
+            is_custom_property ? "custom property " : "property ", name,
+            ", which has compressed values that cannot be compared. Filter "
+            "on a property whose values are smaller than the min_value_size "
+            "of the property_value_compression instead."));
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryConfigExecutor::SelectNodeIDsOutsideBoundary(
+    const CompiledBoundary& boundary, absl::Span<const int64> candidate_ids,
+    RecordSet* record_set) {
+  if (candidate_ids.empty()) {
+    return absl::OkStatus();
+  }
+  return ExecuteQuery(query_config_.select_node_ids_outside_boundary(),
+                      {BindColumnName(boundary.node_table_alias),
+                       BindColumnName(boundary.from_clause),
+                       BindColumnName(boundary.where_clause),
+                       Bind(candidate_ids)},
+                      record_set);
+}
+
 absl::Status QueryConfigExecutor::ListArtifactIDsUsingOptions(
     const ListOperationOptions& options,
     absl::optional<absl::Span<const int64>> candidate_ids,
@@ -690,6 +2393,142 @@ absl::Status QueryConfigExecutor::ListContextIDsUsingOptions(
   return ListNodeIDsUsingOptions<Context>(options, candidate_ids, record_set);
 }
 
+template <typename Node>
+absl::Status QueryConfigExecutor::CountNodesUsingOptions(
+    const CountOptions& options, RecordSet* record_set) {
+  MLMD_RETURN_IF_ERROR(ValidateCountOptions(
+      options, /*counts_contexts=*/std::is_same<Node, Context>::value));
+  // The counted nodes are aliased as the base table of the filter queries.
+  constexpr absl::string_view kNodeAlias = "table_0";
+  std::string from_clause;
+  absl::string_view state_column;
+  absl::string_view context_table;
+  absl::string_view node_id_column;
+  if (std::is_same<Node, Artifact>::value) {
+    from_clause = "`Artifact` AS table_0";
+    state_column = "state";
+    context_table = "Attribution";
+    node_id_column = "artifact_id";
+  } else if (std::is_same<Node, Execution>::value) {
+    from_clause = "`Execution` AS table_0";
+    state_column = "last_known_state";
+    context_table = "Association";
+    node_id_column = "execution_id";
+  } else {
+    from_clause = "`Context` AS table_0";
+  }
+  std::string where_clause;
+  // TODO(b/195700145) MLMD Filtering is not supported in Windows platform since
+  // ZetaSQL currently does not compile on Windows.
+#ifndef _WIN32
+  if (!options.filter_query().empty()) {
+    CompiledFilterQuery compiled_filter_query;
+    MLMD_RETURN_IF_ERROR(FilterQueryCache::GetDefault()->Compile<Node>(
+        options.filter_query(), &compiled_filter_query,
+        /*resolve_interned_strings=*/HasPropertyStringValueId(),
+        GetRoutedIndexedProperties()));
+    MLMD_RETURN_IF_ERROR(CheckFilteredPropertiesUncompressed<Node>(
+        compiled_filter_query.property_names,
+        compiled_filter_query.custom_property_names));
+    from_clause = compiled_filter_query.from_clause;
+    where_clause = compiled_filter_query.where_clause;
+  }
+#endif
+
+  std::vector<std::string> dimensions;
+  for (const int group_by : options.group_by()) {
+    switch (group_by) {
+      case CountOptions::TYPE:
+        dimensions.push_back(absl::StrCat(kNodeAlias, ".`type_id`"));
+        break;
+      case CountOptions::STATE:
+        dimensions.push_back(
+            absl::StrCat(kNodeAlias, ".`", state_column, "`"));
+        break;
+      case CountOptions::CONTEXT:
+        absl::SubstituteAndAppend(
+            &from_clause,
+            " JOIN `$0` AS count_context ON count_context.`$1` = $2.`id` ",
+            context_table, node_id_column, kNodeAlias);
+        dimensions.push_back("count_context.`context_id`");
+        break;
+      case CountOptions::CREATE_TIME_BUCKET:
+        dimensions.push_back(
+            absl::Substitute("($0.`create_time_since_epoch` - "
+                             "$0.`create_time_since_epoch` % $1)",
+                             kNodeAlias, options.time_bucket_ms()));
+        break;
+    }
+  }
+  // The filter queries semi-join the neighbors having many rows per node, e.g.,
+  // its contexts, so that each node is counted once.
+  const std::string group_by_clause = absl::StrJoin(dimensions, ", ");
+  std::string sql_query = absl::Substitute(
+      "SELECT $0$1COUNT(*) FROM $2", group_by_clause,
+      dimensions.empty() ? "" : ", ", from_clause);
+  if (!where_clause.empty()) {
+    absl::StrAppend(&sql_query, " WHERE ", where_clause);
+  }
+  if (!dimensions.empty()) {
+    absl::SubstituteAndAppend(&sql_query, " GROUP BY $0 ORDER BY $0",
+                              group_by_clause);
+  }
+  return ExecuteQuery(sql_query, record_set);
+}
+
+
+absl::Status QueryConfigExecutor::ListEventsUsingOptions(
+    const ListOperationOptions& options, absl::string_view id_column,
+    absl::Span<const int64> ids, absl::Span<const Event::Type> event_types,
+    RecordSet* event_record_set) {
+  if (ids.empty()) {
+    return absl::OkStatus();
+  }
+  return ListEventsWhere(
+      options,
+      absl::Substitute("`$0` IN ($1)", id_column, absl::StrJoin(ids, ", ")),
+      event_types, event_record_set);
+}
+
+absl::Status QueryConfigExecutor::ListEventsByTimeRangeUsingOptions(
+    const ListOperationOptions& options,
+    const int64 min_milliseconds_since_epoch,
+    const absl::optional<int64> max_milliseconds_since_epoch,
+    const absl::Span<const Event::Type> event_types,
+    RecordSet* event_record_set) {
+  std::string condition = absl::StrCat("`milliseconds_since_epoch` >= ",
+                                       min_milliseconds_since_epoch);
+  if (max_milliseconds_since_epoch) {
+    absl::StrAppend(&condition, " AND `milliseconds_since_epoch` < ",
+                    *max_milliseconds_since_epoch);
+  }
+  return ListEventsWhere(options, condition, event_types, event_record_set);
+}
+
+absl::Status QueryConfigExecutor::ListEventsWhere(
+    const ListOperationOptions& options, const absl::string_view condition,
+    const absl::Span<const Event::Type> event_types,
+    RecordSet* event_record_set) {
+  if (options.has_filter_query() && !options.filter_query().empty()) {
+    return absl::InvalidArgumentError(
+        "filter_query is not supported when listing the events.");
+  }
+  // Schema v12 stores the event paths in the EventPath table.
+  std::string sql_query = absl::Substitute(
+      "SELECT `id`, `artifact_id`, `execution_id`, `type`, "
+      "`milliseconds_since_epoch`$0 FROM `Event` WHERE $1 AND ",
+      IsQuerySchemaVersionEquals(12) ? "" : ", `path`", condition);
+  if (!event_types.empty()) {
+    absl::SubstituteAndAppend(&sql_query, " `type` IN ($0) AND ",
+                              absl::StrJoin(event_types, ", "));
+  }
+  MLMD_RETURN_IF_ERROR(AppendKeysetThresholdClause(
+      options, "milliseconds_since_epoch", sql_query));
+  MLMD_RETURN_IF_ERROR(AppendOrderByClause(options, absl::nullopt, sql_query,
+                                           "milliseconds_since_epoch"));
+  MLMD_RETURN_IF_ERROR(AppendLimitClause(options, sql_query));
+  return ExecuteQuery(sql_query, event_record_set);
+}
 
 absl::Status QueryConfigExecutor::DeleteExecutionsById(
     const absl::Span<const int64> execution_ids) {
@@ -698,6 +2537,12 @@ absl::Status QueryConfigExecutor::DeleteExecutionsById(
   MLMD_RETURN_IF_ERROR(ExecuteQuery(
       query_config_.delete_executions_properties_by_executions_id(),
       {Bind(execution_ids)}));
+  // Schema v15 has no archive tables.
+  if (!IsQuerySchemaVersionEquals(15)) {
+    MLMD_RETURN_IF_ERROR(
+        ExecuteQuery(query_config_.delete_archived_executions_by_id(),
+                     {Bind(execution_ids)}));
+  }
   return absl::OkStatus();
 }
 
@@ -723,17 +2568,46 @@ absl::Status QueryConfigExecutor::DeleteContextsById(
 
 absl::Status QueryConfigExecutor::DeleteEventsByArtifactsId(
     const absl::Span<const int64> artifact_ids) {
+  // Since v13, the paths are deleted with the events.
+  if (IsQuerySchemaVersionEquals(12)) {
+    MLMD_RETURN_IF_ERROR(
+        ExecuteQuery(query_config_.delete_event_paths_by_artifacts_id(),
+                     {Bind(artifact_ids)}));
+  }
+  if (!IsQuerySchemaVersionEquals(10)) {
+    MLMD_RETURN_IF_ERROR(ExecuteQuery(
+        query_config_.delete_artifact_derivations_by_artifacts_id(),
+        {Bind(artifact_ids)}));
+  }
   MLMD_RETURN_IF_ERROR(ExecuteQuery(
       query_config_.delete_events_by_artifacts_id(), {Bind(artifact_ids)}));
-  MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.delete_event_paths()));
+  if (!IsQuerySchemaVersionEquals(15)) {
+    MLMD_RETURN_IF_ERROR(
+        ExecuteQuery(query_config_.delete_archived_events_by_artifacts_id(),
+                     {Bind(artifact_ids)}));
+  }
   return absl::OkStatus();
 }
 
 absl::Status QueryConfigExecutor::DeleteEventsByExecutionsId(
     const absl::Span<const int64> execution_ids) {
+  if (IsQuerySchemaVersionEquals(12)) {
+    MLMD_RETURN_IF_ERROR(
+        ExecuteQuery(query_config_.delete_event_paths_by_executions_id(),
+                     {Bind(execution_ids)}));
+  }
+  if (!IsQuerySchemaVersionEquals(10)) {
+    MLMD_RETURN_IF_ERROR(ExecuteQuery(
+        query_config_.delete_artifact_derivations_by_executions_id(),
+        {Bind(execution_ids)}));
+  }
   MLMD_RETURN_IF_ERROR(ExecuteQuery(
       query_config_.delete_events_by_executions_id(), {Bind(execution_ids)}));
-  MLMD_RETURN_IF_ERROR(ExecuteQuery(query_config_.delete_event_paths()));
+  if (!IsQuerySchemaVersionEquals(15)) {
+    MLMD_RETURN_IF_ERROR(
+        ExecuteQuery(query_config_.delete_archived_events_by_executions_id(),
+                     {Bind(execution_ids)}));
+  }
   return absl::OkStatus();
 }
 
@@ -16,12 +16,21 @@ limitations under the License.
 #define ML_METADATA_METADATA_STORE_QUERY_CONFIG_EXECUTOR_H_
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include <glog/logging.h>
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/property_string_dictionary.h"
+#include "ml_metadata/metadata_store/property_value_compressor.h"
 #include "ml_metadata/metadata_store/query_executor.h"
+#include "ml_metadata/metadata_store/template_query.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/util/return_utils.h"
@@ -46,7 +55,9 @@ class QueryConfigExecutor : public QueryExecutor {
   // The MetadataSource is not owned by this object, and must outlast it.
   QueryConfigExecutor(const MetadataSourceQueryConfig& query_config,
                       MetadataSource* source)
-      : query_config_(query_config), metadata_source_(source) {}
+      : query_config_(query_config), metadata_source_(source) {
+    CompileTemplateQueries();
+  }
 
   // A `query_version` can be passed to the QueryConfigExecutor to work with
   // an existing db with an earlier schema version.
@@ -97,6 +108,13 @@ class QueryConfigExecutor : public QueryExecutor {
                                  absl::optional<absl::string_view> description,
                                  int64* type_id) final;
 
+  absl::Status InsertTypes(absl::Span<const ArtifactType> types,
+                           std::vector<int64>* type_ids) final;
+  absl::Status InsertTypes(absl::Span<const ExecutionType> types,
+                           std::vector<int64>* type_ids) final;
+  absl::Status InsertTypes(absl::Span<const ContextType> types,
+                           std::vector<int64>* type_ids) final;
+
   absl::Status SelectTypesByID(const absl::Span<const int64> type_ids,
                                TypeKind type_kind, RecordSet* record_set) final;
 
@@ -108,6 +126,13 @@ class QueryConfigExecutor : public QueryExecutor {
       absl::optional<absl::string_view> type_version, TypeKind type_kind,
       RecordSet* record_set) final;
 
+  absl::Status SelectTypesByNames(absl::Span<const std::string> names,
+                                  TypeKind type_kind,
+                                  RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_types_by_names(),
+                        {Bind(names), Bind(type_kind)}, record_set);
+  }
+
   absl::Status SelectAllTypes(TypeKind type_kind, RecordSet* record_set) final;
 
   absl::Status CheckTypePropertyTable() final {
@@ -128,6 +153,22 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(type_id)}, record_set);
   }
 
+  absl::Status InsertTypeProperties(
+      absl::Span<const int64> type_ids,
+      absl::Span<const ArtifactType> types) final;
+  absl::Status InsertTypeProperties(
+      absl::Span<const int64> type_ids,
+      absl::Span<const ExecutionType> types) final;
+  absl::Status InsertTypeProperties(
+      absl::Span<const int64> type_ids,
+      absl::Span<const ContextType> types) final;
+
+  absl::Status SelectPropertiesByTypeIDs(absl::Span<const int64> type_ids,
+                                         RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_properties_by_type_ids(),
+                        {Bind(type_ids)}, record_set);
+  }
+
   absl::Status CheckParentTypeTable() final;
 
   absl::Status InsertParentType(int64 type_id, int64 parent_type_id) final;
@@ -138,9 +179,16 @@ class QueryConfigExecutor : public QueryExecutor {
   absl::Status SelectParentTypesByTypeID(const absl::Span<const int64> type_ids,
                                          RecordSet* record_set) final;
 
-  // Queries the last inserted id.
+  // Gets the last inserted id from the metadata source, or queries it if the
+  // metadata source does not report it.
   absl::Status SelectLastInsertID(int64* id);
 
+  // Queries the id of the node inserted or found by the last
+  // `insert_*_if_not_exist` query, and whether it is inserted. `id` is unset
+  // if the node is found and the database cannot return its id.
+  absl::Status SelectLastUpsertID(absl::optional<int64>* id,
+                                  bool* is_inserted);
+
   absl::Status CheckArtifactTable() final {
     return ExecuteQuery(query_config_.check_artifact_table());
   }
@@ -159,10 +207,21 @@ class QueryConfigExecutor : public QueryExecutor {
         artifact_id);
   }
 
+  absl::Status InsertArtifacts(absl::Span<const Artifact> artifacts,
+                               absl::Time create_time, absl::Time update_time,
+                               std::vector<int64>* artifact_ids) final;
+
+  absl::Status InsertArtifactIfNotExist(
+      int64 type_id, const std::string& artifact_uri,
+      const absl::optional<Artifact::State>& state, const std::string& name,
+      absl::Time create_time, absl::Time update_time, int64* artifact_id,
+      bool* is_inserted) final;
+
   absl::Status SelectArtifactsByID(const absl::Span<const int64> artifact_ids,
                                    RecordSet* record_set) final {
     return ExecuteQuery(query_config_.select_artifact_by_id(),
-                        {Bind(artifact_ids)}, record_set);
+                        {Bind(artifact_ids)}, record_set,
+                        RecordSetLayout::kTypedColumns);
   }
 
   absl::Status SelectArtifactByTypeIDAndArtifactName(
@@ -180,10 +239,22 @@ class QueryConfigExecutor : public QueryExecutor {
 
   absl::Status SelectArtifactsByURI(const absl::string_view uri,
                                     RecordSet* record_set) final {
+    // The hash of the uris is indexed since v15.
+    if (query_config_.has_select_artifacts_by_uri_hash() &&
+        !IsQuerySchemaVersionEquals(14)) {
+      return ExecuteQuery(query_config_.select_artifacts_by_uri_hash(),
+                          {Bind(uri)}, record_set);
+    }
     return ExecuteQuery(query_config_.select_artifacts_by_uri(), {Bind(uri)},
                         record_set);
   }
 
+  absl::Status SelectArtifactLastUpdateTimes(
+      absl::Span<const int64> artifact_ids, RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_artifact_last_update_times(),
+                        {Bind(artifact_ids)}, record_set);
+  }
+
   absl::Status UpdateArtifactDirect(
       int64 artifact_id, int64 type_id, const std::string& uri,
       const absl::optional<Artifact::State>& state,
@@ -201,21 +272,61 @@ class QueryConfigExecutor : public QueryExecutor {
                                       absl::string_view artifact_property_name,
                                       bool is_custom_property,
                                       const Value& property_value) final {
+    MLMD_RETURN_IF_ERROR(CheckPropertyValueSupported(property_value));
+    QueryParameter column, value;
+    MLMD_RETURN_IF_ERROR(BindPropertyValue(property_value, &column, &value));
     return ExecuteQuery(query_config_.insert_artifact_property(),
-                        {BindDataType(property_value), Bind(artifact_id),
-                         Bind(artifact_property_name), Bind(is_custom_property),
-                         BindValue(property_value)});
+                        {column, Bind(artifact_id),
+                         Bind(artifact_property_name),
+                         Bind(is_custom_property), value});
   }
 
+  absl::Status InsertArtifactProperties(
+      absl::Span<const int64> artifact_ids,
+      absl::Span<const Artifact> artifacts) final;
+
   absl::Status SelectArtifactPropertyByArtifactID(
       const absl::Span<const int64> artifact_ids, RecordSet* record_set) final {
-    return ExecuteQuery(query_config_.select_artifact_property_by_artifact_id(),
-                        {Bind(artifact_ids)}, record_set);
+    return ExecuteQuery(
+        SelectPropertyQuery(
+            query_config_
+                .select_artifact_property_with_compressed_value_by_id(),
+            query_config_.select_artifact_property_with_string_value_by_id(),
+            query_config_.select_artifact_property_with_proto_value_by_id(),
+            query_config_.select_artifact_property_by_artifact_id()),
+        {Bind(artifact_ids)}, record_set, RecordSetLayout::kTypedColumns);
   }
 
+  absl::Status SelectArtifactPropertyByArtifactIDAndName(
+      const absl::Span<const int64> artifact_ids,
+      const absl::Span<const std::string> property_names,
+      RecordSet* record_set) final {
+    return ExecuteQuery(
+        SelectPropertyQuery(
+            query_config_
+                .select_artifact_property_with_compressed_value_by_id_and_name(),
+            query_config_
+                .select_artifact_property_with_string_value_by_id_and_name(),
+            query_config_
+                .select_artifact_property_with_proto_value_by_id_and_name(),
+            query_config_.select_artifact_property_by_artifact_id_and_name()),
+        {Bind(artifact_ids), Bind(property_names)}, record_set,
+        RecordSetLayout::kTypedColumns);
+  }
+
+  absl::Status SelectArtifactsWithPropertiesByID(
+      absl::Span<const int64> artifact_ids,
+      absl::Span<const std::string> property_names,
+      RecordSet* artifact_record_set, RecordSet* property_record_set) final;
+
   absl::Status UpdateArtifactProperty(int64 artifact_id,
                                       const absl::string_view property_name,
                                       const Value& property_value) final {
+    MLMD_RETURN_IF_ERROR(CheckPropertyValueSupported(property_value));
+    if (HasPropertyStringValueId()) {
+      return UpdatePropertyValue({"ArtifactProperty", "artifact_id"},
+                                 artifact_id, property_name, property_value);
+    }
     return ExecuteQuery(
         query_config_.update_artifact_property(),
         {BindDataType(property_value), BindValue(property_value),
@@ -244,10 +355,14 @@ class QueryConfigExecutor : public QueryExecutor {
         execution_id);
   }
 
+  absl::Status InsertExecutions(absl::Span<const Execution> executions,
+                                absl::Time create_time, absl::Time update_time,
+                                std::vector<int64>* execution_ids) final;
+
   absl::Status SelectExecutionsByID(const absl::Span<const int64> ids,
                                     RecordSet* record_set) final {
     return ExecuteQuery(query_config_.select_execution_by_id(), {Bind(ids)},
-                        record_set);
+                        record_set, RecordSetLayout::kTypedColumns);
   }
 
   absl::Status SelectExecutionByTypeIDAndExecutionName(
@@ -263,6 +378,12 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(execution_type_id)}, record_set);
   }
 
+  absl::Status SelectActiveExecutionsByTypeID(int64 execution_type_id,
+                                              RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_active_executions_by_type_id(),
+                        {Bind(execution_type_id)}, record_set);
+  }
+
   absl::Status UpdateExecutionDirect(
       int64 execution_id, int64 type_id,
       const absl::optional<Execution::State>& last_known_state,
@@ -281,21 +402,60 @@ class QueryConfigExecutor : public QueryExecutor {
                                        const absl::string_view name,
                                        bool is_custom_property,
                                        const Value& value) final {
+    MLMD_RETURN_IF_ERROR(CheckPropertyValueSupported(value));
+    QueryParameter column, bound_value;
+    MLMD_RETURN_IF_ERROR(BindPropertyValue(value, &column, &bound_value));
     return ExecuteQuery(query_config_.insert_execution_property(),
-                        {BindDataType(value), Bind(execution_id), Bind(name),
-                         Bind(is_custom_property), BindValue(value)});
+                        {column, Bind(execution_id), Bind(name),
+                         Bind(is_custom_property), bound_value});
   }
 
+  absl::Status InsertExecutionProperties(
+      absl::Span<const int64> execution_ids,
+      absl::Span<const Execution> executions) final;
+
   absl::Status SelectExecutionPropertyByExecutionID(
       const absl::Span<const int64> ids, RecordSet* record_set) final {
     return ExecuteQuery(
-        query_config_.select_execution_property_by_execution_id(), {Bind(ids)},
-        record_set);
-  }
+        SelectPropertyQuery(
+            query_config_
+                .select_execution_property_with_compressed_value_by_id(),
+            query_config_.select_execution_property_with_string_value_by_id(),
+            query_config_.select_execution_property_with_proto_value_by_id(),
+            query_config_.select_execution_property_by_execution_id()),
+        {Bind(ids)}, record_set, RecordSetLayout::kTypedColumns);
+  }
+
+  absl::Status SelectExecutionPropertyByExecutionIDAndName(
+      const absl::Span<const int64> ids,
+      const absl::Span<const std::string> property_names,
+      RecordSet* record_set) final {
+    return ExecuteQuery(
+        SelectPropertyQuery(
+            query_config_
+                .select_execution_property_with_compressed_value_by_id_and_name(),
+            query_config_
+                .select_execution_property_with_string_value_by_id_and_name(),
+            query_config_
+                .select_execution_property_with_proto_value_by_id_and_name(),
+            query_config_.select_execution_property_by_execution_id_and_name()),
+        {Bind(ids), Bind(property_names)}, record_set,
+        RecordSetLayout::kTypedColumns);
+  }
+
+  absl::Status SelectExecutionsWithPropertiesByID(
+      absl::Span<const int64> execution_ids,
+      absl::Span<const std::string> property_names,
+      RecordSet* execution_record_set, RecordSet* property_record_set) final;
 
   absl::Status UpdateExecutionProperty(int64 execution_id,
                                        const absl::string_view name,
                                        const Value& value) final {
+    MLMD_RETURN_IF_ERROR(CheckPropertyValueSupported(value));
+    if (HasPropertyStringValueId()) {
+      return UpdatePropertyValue({"ExecutionProperty", "execution_id"},
+                                 execution_id, name, value);
+    }
     return ExecuteQuery(query_config_.update_execution_property(),
                         {BindDataType(value), BindValue(value),
                          Bind(execution_id), Bind(name)});
@@ -322,10 +482,21 @@ class QueryConfigExecutor : public QueryExecutor {
         context_id);
   }
 
+  absl::Status InsertContexts(absl::Span<const Context> contexts,
+                              absl::Time create_time, absl::Time update_time,
+                              std::vector<int64>* context_ids) final;
+
+  absl::Status InsertContextIfNotExist(int64 type_id, const std::string& name,
+                                       absl::Time create_time,
+                                       absl::Time update_time,
+                                       int64* context_id,
+                                       bool* is_inserted) final;
+
   absl::Status SelectContextsByID(const absl::Span<const int64> context_ids,
                                   RecordSet* record_set) final {
     return ExecuteQuery(query_config_.select_context_by_id(),
-                        {Bind(context_ids)}, record_set);
+                        {Bind(context_ids)}, record_set,
+                        RecordSetLayout::kTypedColumns);
   }
 
   absl::Status SelectContextsByTypeID(int64 context_type_id,
@@ -358,20 +529,59 @@ class QueryConfigExecutor : public QueryExecutor {
                                      const absl::string_view name,
                                      bool custom_property,
                                      const Value& value) final {
+    MLMD_RETURN_IF_ERROR(CheckPropertyValueSupported(value));
+    QueryParameter column, bound_value;
+    MLMD_RETURN_IF_ERROR(BindPropertyValue(value, &column, &bound_value));
     return ExecuteQuery(query_config_.insert_context_property(),
-                        {BindDataType(value), Bind(context_id), Bind(name),
-                         Bind(custom_property), BindValue(value)});
+                        {column, Bind(context_id), Bind(name),
+                         Bind(custom_property), bound_value});
   }
 
+  absl::Status InsertContextProperties(
+      absl::Span<const int64> context_ids,
+      absl::Span<const Context> contexts) final;
+
   absl::Status SelectContextPropertyByContextID(
       const absl::Span<const int64> context_ids, RecordSet* record_set) final {
-    return ExecuteQuery(query_config_.select_context_property_by_context_id(),
-                        {Bind(context_ids)}, record_set);
+    return ExecuteQuery(
+        SelectPropertyQuery(
+            query_config_.select_context_property_with_compressed_value_by_id(),
+            query_config_.select_context_property_with_string_value_by_id(),
+            query_config_.select_context_property_with_proto_value_by_id(),
+            query_config_.select_context_property_by_context_id()),
+        {Bind(context_ids)}, record_set, RecordSetLayout::kTypedColumns);
   }
 
+  absl::Status SelectContextPropertyByContextIDAndName(
+      const absl::Span<const int64> context_ids,
+      const absl::Span<const std::string> property_names,
+      RecordSet* record_set) final {
+    return ExecuteQuery(
+        SelectPropertyQuery(
+            query_config_
+                .select_context_property_with_compressed_value_by_id_and_name(),
+            query_config_
+                .select_context_property_with_string_value_by_id_and_name(),
+            query_config_
+                .select_context_property_with_proto_value_by_id_and_name(),
+            query_config_.select_context_property_by_context_id_and_name()),
+        {Bind(context_ids), Bind(property_names)}, record_set,
+        RecordSetLayout::kTypedColumns);
+  }
+
+  absl::Status SelectContextsWithPropertiesByID(
+      absl::Span<const int64> context_ids,
+      absl::Span<const std::string> property_names,
+      RecordSet* context_record_set, RecordSet* property_record_set) final;
+
   absl::Status UpdateContextProperty(int64 context_id,
                                      const absl::string_view property_name,
                                      const Value& property_value) final {
+    MLMD_RETURN_IF_ERROR(CheckPropertyValueSupported(property_value));
+    if (HasPropertyStringValueId()) {
+      return UpdatePropertyValue({"ContextProperty", "context_id"},
+                                 context_id, property_name, property_value);
+    }
     return ExecuteQuery(
         query_config_.update_context_property(),
         {BindDataType(property_value), BindValue(property_value),
@@ -398,18 +608,61 @@ class QueryConfigExecutor : public QueryExecutor {
         event_id);
   }
 
+  absl::Status InsertEvents(absl::Span<const Event> events,
+                            std::vector<int64>* event_ids) final;
+
   absl::Status SelectEventByArtifactIDs(
       const absl::Span<const int64> artifact_ids,
       RecordSet* event_record_set) final {
-    return ExecuteQuery(query_config_.select_event_by_artifact_ids(),
-                        {Bind(artifact_ids)}, event_record_set);
+    // Schema v12 stores the event paths in the EventPath table.
+    return ExecuteQuery(
+        IsQuerySchemaVersionEquals(12)
+            ? query_config_.select_event_by_artifact_ids()
+            : query_config_.select_events_with_path_by_artifact_ids(),
+        {Bind(artifact_ids)}, event_record_set);
   }
 
   absl::Status SelectEventByExecutionIDs(
       const absl::Span<const int64> execution_ids,
       RecordSet* event_record_set) final {
-    return ExecuteQuery(query_config_.select_event_by_execution_ids(),
-                        {Bind(execution_ids)}, event_record_set);
+    return ExecuteQuery(
+        IsQuerySchemaVersionEquals(12)
+            ? query_config_.select_event_by_execution_ids()
+            : query_config_.select_events_with_path_by_execution_ids(),
+        {Bind(execution_ids)}, event_record_set);
+  }
+
+  absl::Status ListEventsByArtifactIDsUsingOptions(
+      const ListOperationOptions& options,
+      absl::Span<const int64> artifact_ids,
+      absl::Span<const Event::Type> event_types,
+      RecordSet* event_record_set) final {
+    return ListEventsUsingOptions(options, "artifact_id", artifact_ids,
+                                  event_types, event_record_set);
+  }
+
+  absl::Status ListEventsByExecutionIDsUsingOptions(
+      const ListOperationOptions& options,
+      absl::Span<const int64> execution_ids,
+      absl::Span<const Event::Type> event_types,
+      RecordSet* event_record_set) final {
+    return ListEventsUsingOptions(options, "execution_id", execution_ids,
+                                  event_types, event_record_set);
+  }
+
+  absl::Status ListEventsByTimeRangeUsingOptions(
+      const ListOperationOptions& options, int64 min_milliseconds_since_epoch,
+      absl::optional<int64> max_milliseconds_since_epoch,
+      absl::Span<const Event::Type> event_types,
+      RecordSet* event_record_set) final;
+
+  absl::Status SelectLineageGraphNodeDistances(
+      const absl::Span<const int64> artifact_ids, int64 max_num_hops,
+      int64 max_num_nodes, RecordSet* record_set) final {
+    return ExecuteQuery(
+        query_config_.select_lineage_graph_node_distances(),
+        {Bind(artifact_ids), Bind(max_num_hops), Bind(max_num_nodes)},
+        record_set);
   }
 
   absl::Status CheckEventPathTable() final {
@@ -419,8 +672,129 @@ class QueryConfigExecutor : public QueryExecutor {
   absl::Status InsertEventPath(int64 event_id,
                                const Event::Path::Step& step) final;
 
+  absl::Status InsertEventPaths(absl::Span<const int64> event_ids,
+                                absl::Span<const Event> events) final;
+
+  absl::Status CheckArtifactDerivationTable() final {
+    return ExecuteQuery(query_config_.check_artifact_derivation_table());
+  }
+
+  absl::Status InsertArtifactDerivations(
+      absl::Span<const int64> event_ids) final;
+
+  absl::Status SelectArtifactDerivationDistances(
+      absl::Span<const int64> artifact_ids, bool upstream, int64 max_num_hops,
+      absl::optional<int64> context_id, RecordSet* record_set) final;
+
+  absl::Status CheckChangeLogTable() final {
+    return ExecuteQuery(query_config_.check_change_log_table());
+  }
+
+  absl::Status InsertChangeLogEntries(
+      absl::Span<const ChangeLogEntry> entries) final;
+
+  absl::Status SelectChangeLogEntries(int64 after_sequence_number,
+                                      int64 max_num_entries,
+                                      RecordSet* record_set) final;
+
+  absl::Status SelectLastChangeLogSequenceNumber(RecordSet* record_set) final;
+
+  absl::Status SelectLineageGraphEdges(int64 after_event_id,
+                                       int64 max_num_events,
+                                       RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_lineage_graph_edges(),
+                        {Bind(after_event_id), Bind(max_num_events)},
+                        record_set);
+  }
+
+  absl::Status CheckExecutionArchiveTable() final {
+    return ExecuteQuery(query_config_.check_execution_archive_table());
+  }
+
+  absl::Status CheckEventArchiveTable() final {
+    return ExecuteQuery(query_config_.check_event_archive_table());
+  }
+
+  absl::Status CheckPropertyStringValueTable() final {
+    return ExecuteQuery(query_config_.check_property_string_value_table());
+  }
+
+  void set_property_string_dictionary(
+      std::shared_ptr<PropertyStringDictionary> dictionary) final {
+    property_string_dictionary_ = std::move(dictionary);
+  }
+
+  void set_property_value_compression(
+      const PropertyValueCompressionConfig& config) final {
+    property_value_compressor_ =
+        absl::make_unique<PropertyValueCompressor>(config);
+  }
+
+  void set_indexed_properties(
+      std::vector<IndexedProperty> indexed_properties) final {
+    indexed_properties_ = std::move(indexed_properties);
+  }
+
+  absl::Status SelectColdExecutionIDs(int64 max_last_update_time_since_epoch,
+                                      int64 max_num_executions,
+                                      RecordSet* record_set) final {
+    MLMD_RETURN_IF_ERROR(VerifyCurrentQueryVersionIsAtLeast(16));
+    return ExecuteQuery(
+        query_config_.select_cold_execution_ids(),
+        {Bind(max_last_update_time_since_epoch), Bind(max_num_executions)},
+        record_set);
+  }
+
+  absl::Status ArchiveExecutions(absl::Span<const Execution> executions) final;
+
+  // Schema v15 has no archive tables to read.
+  absl::Status SelectArchivedExecutionsByID(
+      absl::Span<const int64> execution_ids, RecordSet* record_set) final {
+    if (IsQuerySchemaVersionEquals(15)) {
+      return absl::OkStatus();
+    }
+    return ExecuteQuery(query_config_.select_archived_executions_by_id(),
+                        {Bind(execution_ids)}, record_set);
+  }
+
+  absl::Status SelectArchivedEventsByArtifactIDs(
+      absl::Span<const int64> artifact_ids,
+      RecordSet* event_record_set) final {
+    if (IsQuerySchemaVersionEquals(15)) {
+      return absl::OkStatus();
+    }
+    return ExecuteQuery(query_config_.select_archived_events_by_artifact_ids(),
+                        {Bind(artifact_ids)}, event_record_set);
+  }
+
+  absl::Status SelectArchivedEventsByExecutionIDs(
+      absl::Span<const int64> execution_ids,
+      RecordSet* event_record_set) final {
+    if (IsQuerySchemaVersionEquals(15)) {
+      return absl::OkStatus();
+    }
+    return ExecuteQuery(
+        query_config_.select_archived_events_by_execution_ids(),
+        {Bind(execution_ids)}, event_record_set);
+  }
+
+  absl::Status SelectArchivedLineageGraphEdges(int64 after_event_id,
+                                               int64 max_num_events,
+                                               RecordSet* record_set) final {
+    if (IsQuerySchemaVersionEquals(15)) {
+      return absl::OkStatus();
+    }
+    return ExecuteQuery(query_config_.select_archived_lineage_graph_edges(),
+                        {Bind(after_event_id), Bind(max_num_events)},
+                        record_set);
+  }
+
   absl::Status SelectEventPathByEventIDs(
       const absl::Span<const int64> event_ids, RecordSet* record_set) final {
+    // Since v13, the paths are read with the events.
+    if (!IsQuerySchemaVersionEquals(12)) {
+      return absl::OkStatus();
+    }
     return ExecuteQuery(query_config_.select_event_path_by_event_ids(),
                         {Bind(event_ids)}, record_set);
   }
@@ -436,16 +810,19 @@ class QueryConfigExecutor : public QueryExecutor {
         {Bind(context_id), Bind(execution_id)}, association_id);
   }
 
+  absl::Status InsertAssociationsIfNotExist(
+      absl::Span<const Association> associations) final;
+
   absl::Status SelectAssociationByContextIDs(absl::Span<const int64> context_id,
                                              RecordSet* record_set) final {
     return ExecuteQuery(query_config_.select_association_by_context_id(),
                         {Bind(context_id)}, record_set);
   }
 
-  absl::Status SelectAssociationByExecutionID(int64 execution_id,
-                                              RecordSet* record_set) final {
+  absl::Status SelectAssociationByExecutionIDs(
+      absl::Span<const int64> execution_ids, RecordSet* record_set) final {
     return ExecuteQuery(query_config_.select_association_by_execution_id(),
-                        {Bind(execution_id)}, record_set);
+                        {Bind(execution_ids)}, record_set);
   }
 
   absl::Status CheckAttributionTable() final {
@@ -459,10 +836,13 @@ class QueryConfigExecutor : public QueryExecutor {
                                           attribution_id);
   }
 
-  absl::Status SelectAttributionByContextID(int64 context_id,
-                                            RecordSet* record_set) final {
+  absl::Status InsertAttributionsIfNotExist(
+      absl::Span<const Attribution> attributions) final;
+
+  absl::Status SelectAttributionByContextIDs(
+      absl::Span<const int64> context_ids, RecordSet* record_set) final {
     return ExecuteQuery(query_config_.select_attribution_by_context_id(),
-                        {Bind(context_id)}, record_set);
+                        {Bind(context_ids)}, record_set);
   }
 
   absl::Status SelectAttributionByArtifactID(int64 artifact_id,
@@ -481,6 +861,18 @@ class QueryConfigExecutor : public QueryExecutor {
   absl::Status SelectChildContextsByContextID(int64 context_id,
                                               RecordSet* record_set) final;
 
+  absl::Status SelectAncestorContextIDs(int64 context_id, int64 max_depth,
+                                        RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_ancestor_context_ids(),
+                        {Bind(context_id), Bind(max_depth)}, record_set);
+  }
+
+  absl::Status SelectDescendantContextIDs(int64 context_id, int64 max_depth,
+                                          RecordSet* record_set) final {
+    return ExecuteQuery(query_config_.select_descendant_context_ids(),
+                        {Bind(context_id), Bind(max_depth)}, record_set);
+  }
+
   absl::Status CheckMLMDEnvTable() final {
     return ExecuteQuery(query_config_.check_mlmd_env_table());
   }
@@ -497,6 +889,20 @@ class QueryConfigExecutor : public QueryExecutor {
                         {Bind(schema_version)});
   }
 
+  absl::Status SelectTypeGeneration(int64* type_generation) final;
+
+  absl::Status IncrementTypeGeneration() final {
+    // Schema v8 has no type generation to increase.
+    if (IsQuerySchemaVersionEquals(8)) {
+      return absl::OkStatus();
+    }
+    return ExecuteQuery(query_config_.increment_type_generation());
+  }
+
+  int64 GetTransactionId() final {
+    return metadata_source_->num_transactions_begun();
+  }
+
   absl::Status CheckTablesIn_V0_13_2() final;
 
   absl::Status SelectAllArtifactIDs(RecordSet* set) final {
@@ -518,6 +924,9 @@ class QueryConfigExecutor : public QueryExecutor {
 
   absl::Status DowngradeMetadataSource(const int64 to_schema_version) final;
 
+  absl::Status UpgradeMetadataSourceOnlineStep(int64 batch_size,
+                                               bool* done) final;
+
   absl::Status ListArtifactIDsUsingOptions(
       const ListOperationOptions& options,
       absl::optional<absl::Span<const int64>> candidate_ids,
@@ -533,6 +942,35 @@ class QueryConfigExecutor : public QueryExecutor {
       absl::optional<absl::Span<const int64>> candidate_ids,
       RecordSet* record_set) final;
 
+  absl::Status CompileArtifactBoundary(absl::string_view boundary_artifacts,
+                                       CompiledBoundary* boundary) final {
+    return CompileBoundary<Artifact>(boundary_artifacts, boundary);
+  }
+
+  absl::Status CompileExecutionBoundary(absl::string_view boundary_executions,
+                                        CompiledBoundary* boundary) final {
+    return CompileBoundary<Execution>(boundary_executions, boundary);
+  }
+
+  absl::Status SelectNodeIDsOutsideBoundary(
+      const CompiledBoundary& boundary, absl::Span<const int64> candidate_ids,
+      RecordSet* record_set) final;
+
+  absl::Status CountArtifactsUsingOptions(const CountOptions& options,
+                                          RecordSet* record_set) final {
+    return CountNodesUsingOptions<Artifact>(options, record_set);
+  }
+
+  absl::Status CountExecutionsUsingOptions(const CountOptions& options,
+                                           RecordSet* record_set) final {
+    return CountNodesUsingOptions<Execution>(options, record_set);
+  }
+
+  absl::Status CountContextsUsingOptions(const CountOptions& options,
+                                         RecordSet* record_set) final {
+    return CountNodesUsingOptions<Context>(options, record_set);
+  }
+
 
   absl::Status DeleteArtifactsById(absl::Span<const int64> artifact_ids) final;
 
@@ -566,79 +1004,386 @@ class QueryConfigExecutor : public QueryExecutor {
       const absl::Span<const int64> child_context_ids) final;
 
  private:
+  // The max number of rows inserted by a single multi-row insert statement,
+  // which keeps the number of values bound to a statement under the default
+  // limit of SQLite (999).
+  static constexpr int kMaxNumRowsPerInsert = 100;
+
+  // The max number of ids bound as a list of values. Larger id sets are bound
+  // as a single JSON array, which is expanded by the select_id_set subquery.
+  static constexpr int kMaxIdListSize = 500;
+
+  // A parameter of a template query. A value parameter holds zero or more
+  // values, which are rendered as comma separated SQL literals, or bound to the
+  // placeholders of a prepared statement. A Value without any field set stands
+  // for NULL. A SQL fragment parameter, e.g., a column name, is always inlined
+  // in the query as is.
+  struct QueryParameter {
+    std::vector<Value> values;
+    absl::optional<std::string> sql_fragment;
+    // If positive, the values are rows of `row_size` values each, which are
+    // rendered for a multi-row VALUES clause, e.g., `(1, 'a'), (2, 'b')`.
+    int row_size = 0;
+    // If set, the values are rendered in place of the `$0` of the subquery,
+    // which is inlined in the query.
+    absl::optional<std::string> subquery;
+  };
+
   // Utility method to bind an nullable value.
   template <typename T>
-  std::string Bind(const absl::optional<T>& v) {
-    return v ? Bind(v.value()) : "NULL";
+  QueryParameter Bind(const absl::optional<T>& v) {
+    return v ? Bind(v.value()) : QueryParameter{{Value()}};
   }
 
   // Utility method to bind an string_view value to a SQL clause.
-  std::string Bind(absl::string_view value);
+  QueryParameter Bind(absl::string_view value);
 
   // Utility method to bind an string_view value to a SQL clause.
-  std::string Bind(const char* value);
+  QueryParameter Bind(const char* value);
 
   // Utility method to bind an int value to a SQL clause.
-  std::string Bind(int value);
+  QueryParameter Bind(int value);
 
   // Utility method to bind an int64 value to a SQL clause.
-  std::string Bind(int64 value);
+  QueryParameter Bind(int64 value);
 
   // Utility method to bind a boolean value to a SQL clause.
-  std::string Bind(bool value);
+  QueryParameter Bind(bool value);
 
   // Utility method to bind an double value to a SQL clause.
-  std::string Bind(const double value);
+  QueryParameter Bind(const double value);
 
   // Utility method to bind an PropertyType enum value to a SQL clause.
   // PropertyType is an enum (integer), EscapeString is not applicable.
-  std::string Bind(const PropertyType value);
+  QueryParameter Bind(const PropertyType value);
 
   // Utility method to bind an Event::Type enum value to a SQL clause.
   // Event::Type is an enum (integer), EscapeString is not applicable.
-  std::string Bind(const Event::Type value);
+  QueryParameter Bind(const Event::Type value);
+
+  // Utility method to bind an Event::Path to a SQL clause as JSON. An empty
+  // path is bound as NULL.
+  QueryParameter Bind(const Event::Path& path);
 
   // Utility methods to bind the value to a SQL clause.
-  std::string BindValue(const Value& value);
-  std::string BindDataType(const Value& value);
-  std::string Bind(const ArtifactStructType* message);
+  QueryParameter BindValue(const Value& value);
+  QueryParameter BindDataType(const Value& value);
+  QueryParameter Bind(const ArtifactStructType* message);
+
+  // Utility method to bind a column name to a SQL clause.
+  QueryParameter BindColumnName(absl::string_view column_name);
 
   // Utility method to bind an TypeKind to a SQL clause.
   // TypeKind is an enum (integer), EscapeString is not applicable.
-  std::string Bind(TypeKind value);
+  QueryParameter Bind(TypeKind value);
 
   // Utility methods to bind Artifact::State/Execution::State to SQL clause.
-  std::string Bind(Artifact::State value);
-  std::string Bind(Execution::State value);
+  QueryParameter Bind(Artifact::State value);
+  QueryParameter Bind(Execution::State value);
+
+  // Utility methods to bind ChangeLogEntry::Kind/Operation to SQL clause.
+  QueryParameter Bind(ChangeLogEntry::Kind value);
+  QueryParameter Bind(ChangeLogEntry::Operation value);
 
-  // Utility method to bind an in64 vector to a string joined with "," that can
-  // fit into SQL IN(...) clause.
-  std::string Bind(absl::Span<const int64> value);
+  // Utility method to bind an in64 vector to a list of values joined with ","
+  // that can fit into SQL IN(...) clause. An id set larger than kMaxIdListSize
+  // is bound as a select_id_set subquery of a single JSON array instead.
+  QueryParameter Bind(absl::Span<const int64> value);
+
+  // Utility method to bind a string vector to a list of quoted values joined
+  // with "," that can fit into SQL IN(...) clause.
+  QueryParameter Bind(absl::Span<const std::string> value);
 
   #if (!defined(__APPLE__) && !defined(_WIN32))
-  std::string Bind(const google::protobuf::int64 value);
+  QueryParameter Bind(const google::protobuf::int64 value);
   #endif
 
-  // Execute a template query. All strings in parameters should already be
-  // in a format appropriate for the SQL variant being used (at this point,
-  // they are just inserted).
+  // Utility method to append a row of value parameters to `rows`, which binds
+  // a multi-row VALUES clause. All the rows must have the same number of
+  // values.
+  void AppendRow(absl::Span<const QueryParameter> row, QueryParameter* rows);
+
+  // Utility method to append a row of (node_id, name, is_custom_property,
+  // int_value, double_value, string_value) to `rows`, followed by the
+  // proto_value if HasPropertyProtoValue(), and the string_value_id and
+  // compressed value if `string_value_ids` is not null. The value columns, which do
+  // not match the value type of `value`, are NULL.
+  void AppendPropertyRow(
+      int64 node_id, absl::string_view name, bool is_custom_property,
+      const Value& value, QueryParameter* rows,
+      const absl::flat_hash_map<std::string, int64>* string_value_ids =
+          nullptr);
+
+  // Binds the (int_value, double_value, string_value, proto_value,
+  // string_value_id, compressed value) columns of `value`, of which the ones
+  // not holding the value are NULL. A string value found in `string_value_ids`
+  // is bound as its id instead of the string, and a value compressed by the
+  // property_value_compressor_ as its compressed value, if
+  // CompressesPropertyValues().
+  std::vector<QueryParameter> BindPropertyValueColumns(
+      const Value& value,
+      const absl::flat_hash_map<std::string, int64>* string_value_ids);
+
+  // Returns true if the property tables have the `proto_value` column, which
+  // stores the struct and proto values since v14. Before, the struct values
+  // are stored as strings, and the proto values are not supported.
+  bool HasPropertyProtoValue() const { return !IsQuerySchemaVersionEquals(13); }
+
+  // Returns true if the property tables have the `string_value_id` column,
+  // which refers to the string values interned in the PropertyStringValue
+  // table since v17.
+  bool HasPropertyStringValueId() const {
+    return !IsQuerySchemaVersionEquals(16);
+  }
+
+  // Returns true if the string property values are written as the ids of
+  // their interned values, i.e., a PropertyStringDictionary is set and the
+  // property tables have the `string_value_id` column.
+  bool InternsPropertyStrings() const {
+    return property_string_dictionary_ != nullptr && HasPropertyStringValueId();
+  }
+
+  // Returns true if the property tables have the `compressed_value` column,
+  // which holds the compressed property values since v20. Before, the values
+  // compressed by v17 to v19 are in the `byte_value` column.
+  bool HasPropertyCompressedValue() const {
+    return !IsQuerySchemaVersionEquals(19) && HasPropertyStringValueId();
+  }
+
+  // Returns the column of the compressed property values, i.e.,
+  // `compressed_value` since v20, or else `byte_value`.
+  absl::string_view CompressedValueColumn() const {
+    return HasPropertyCompressedValue() ? "compressed_value" : "byte_value";
+  }
+
+  // Returns true if the large property values are written compressed to the
+  // `compressed_value` column, i.e., a PropertyValueCompressor is set and the
+  // property tables have the column since v20. Before, the values are written
+  // uncompressed.
+  bool CompressesPropertyValues() const {
+    return property_value_compressor_ != nullptr &&
+           HasPropertyCompressedValue();
+  }
+
+  // Returns true if the property rows are inserted with their
+  // `string_value_id` and compressed value columns, i.e., by the
+  // `insert_*_properties_with_compressed_value` queries since v20, or else the
+  // `insert_*_properties_with_string_value_id` ones.
+  bool InsertsPropertyValueIdColumns() const {
+    return InternsPropertyStrings() || CompressesPropertyValues();
+  }
+
+  // Returns the query selecting the node properties in the columns of the
+  // schema, i.e., `with_compressed_value`, which selects the
+  // `compressed_value` column since v20, `with_string_value`, which resolves
+  // the interned string values since v17, `with_proto_value` since v14, or
+  // else `without_both`.
+  const MetadataSourceQueryConfig::TemplateQuery& SelectPropertyQuery(
+      const MetadataSourceQueryConfig::TemplateQuery& with_compressed_value,
+      const MetadataSourceQueryConfig::TemplateQuery& with_string_value,
+      const MetadataSourceQueryConfig::TemplateQuery& with_proto_value,
+      const MetadataSourceQueryConfig::TemplateQuery& without_both) const {
+    if (HasPropertyCompressedValue()) return with_compressed_value;
+    if (HasPropertyStringValueId()) return with_string_value;
+    return HasPropertyProtoValue() ? with_proto_value : without_both;
+  }
+
+  // Adds to `ids` the ids of the interned string `values`, which are looked up
+  // in the dictionary, then in the PropertyStringValue table, and the ones
+  // not found are interned. The values longer than
+  // PropertyStringDictionary::kMaxInternedValueSize are left out, and so are
+  // the ones interned concurrently, whose ids cannot be read yet; they are
+  // stored in the property rows. The ids interned by the current transaction
+  // are inserted in the dictionary after it is committed.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status InternPropertyStrings(
+      absl::Span<const std::string> values,
+      absl::flat_hash_map<std::string, int64>* ids);
+
+  // Binds the value column of `value` to `column`, and `value` to
+  // `bound_value`, for the single property inserts. An interned string value
+  // is bound as its `string_value_id`, and a compressed value as its
+  // `compressed_value`.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status BindPropertyValue(const Value& value, QueryParameter* column,
+                                 QueryParameter* bound_value);
+
+  // Updates the `value` of the property `name` of the node `node_id` in the
+  // property `table` of a v17+ schema, i.e., (table name, node id column). A
+  // string value is written as its interned id if InternsPropertyStrings(),
+  // and a large value compressed if CompressesPropertyValues(). The other
+  // value columns are cleared.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status UpdatePropertyValue(
+      const std::pair<absl::string_view, absl::string_view>& table,
+      int64 node_id, absl::string_view name, const Value& value);
+
+  // Creates the dedicated indices of the `indexed_properties_`, if the
+  // metadata source has partial indices.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status CreateIndexedPropertyIndices();
+
+  // Returns the indexed properties the filter queries are routed to, i.e.,
+  // none if the metadata source has no dedicated indices.
+  absl::Span<const IndexedProperty> GetRoutedIndexedProperties() const {
+    if (!query_config_.has_create_indexed_property_index()) return {};
+    return indexed_properties_;
+  }
+
+  // Returns FAILED_PRECONDITION error, if `value` is a proto value, which the
+  // property tables cannot store before v14.
+  absl::Status CheckPropertyValueSupported(const Value& value) const;
+
+  // Moves the struct values stored as strings in the property tables to their
+  // `proto_value` column. It is run by the upgrade to v14. The values already
+  // copied by CopyStructPropertiesToProtoValue are only cleared.
+  // Returns INVALID_ARGUMENT error, if a stored struct cannot be parsed.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status MoveStructPropertiesToProtoValue();
+
+  // Copies the struct values stored as strings in the rows of a property
+  // `table`, i.e., (table name, node id column), whose node ids are in
+  // (`after_id`, `last_id`], to their `proto_value` column, and keeps the
+  // strings for the clients of v13. It is run by the online upgrade to v14.
+  // Returns INVALID_ARGUMENT error, if a stored struct cannot be parsed.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status CopyStructPropertiesToProtoValue(
+      const std::pair<absl::string_view, absl::string_view>& table,
+      int64 after_id, int64 last_id);
+
+  // Runs a step of the online upgrade to v14, i.e., adds the `proto_value`
+  // columns, copies the struct values of the next chunk of `batch_size` rows
+  // of the property tables, or moves the remaining struct values and updates
+  // the schema version. The progress is checkpointed in `MLMDMigration`.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status BackfillStructPropertiesOnline(int64 to_version,
+                                              int64 batch_size);
+
+  // Runs the upgrade queries of the migration scheme to `to_version`.
+  // Returns INTERNAL error, if there is no migration scheme to `to_version`.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status ExecuteUpgradeQueries(int64 to_version);
+
+  // Moves the struct values in the `proto_value` column of the property tables
+  // back to their `string_value` column. It is run by the downgrade from v14,
+  // which drops the column with the proto values left in it.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status MoveStructPropertiesToStringValue();
+
+  // Moves the archived executions back to the Execution and ExecutionProperty
+  // tables, in chunks. It is run by the downgrade from v16, which moves the
+  // archived events back and drops the archive tables.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status RestoreArchivedExecutions();
+
+  // Writes the compressed values in the `byte_value` column of the property
+  // tables, where the downgrade from v20 moves them, back to their value
+  // columns. It is run by the downgrade from v17, whose property reads do not
+  // select the column.
+  // Returns DATA_LOSS error, if a compressed value is corrupted.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status DecompressPropertyValues();
+
+  // Appends a value as it is inserted in a text query to `out`, i.e., string
+  // values are escaped and quoted, and proto values are hex literals.
+  void AppendRenderedValue(const Value& value, std::string* out) const;
+
+  // Appends a parameter to `out`, where `format` appends a single value of it,
+  // e.g., a SQL literal or a prepared statement placeholder. The values are
+  // joined with ", ", and inlined in the subquery if any. SQL fragments are
+  // appended as is.
+  template <typename Formatter>
+  void AppendParameter(const QueryParameter& parameter,
+                       const Formatter& format, std::string* out) const;
+
+  // Executes a multi-row insert `query` with the given `rows`, splitting them
+  // into statements of at most kMaxNumRowsPerInsert rows. If `inserted_ids` is
+  // not null, the ids assigned to the rows are appended to it in order.
+  // Returns detailed INTERNAL error, if query execution fails, or the assigned
+  // ids cannot be found.
+  absl::Status ExecuteMultiRowInsert(
+      const MetadataSourceQueryConfig::TemplateQuery& query,
+      const QueryParameter& rows, std::vector<int64>* inserted_ids);
+
+  // Appends the row of `type` to the rows of the `insert_types` query.
+  void AppendTypeRow(const ArtifactType& type, QueryParameter* rows);
+  void AppendTypeRow(const ExecutionType& type, QueryParameter* rows);
+  void AppendTypeRow(const ContextType& type, QueryParameter* rows);
+
+  // Inserts the `types` with the multi-row `insert_types` query.
+  template <typename Type>
+  absl::Status InsertTypesImpl(absl::Span<const Type> types,
+                               std::vector<int64>* type_ids);
+
+  // Inserts the properties of the `types`, whose ids are `type_ids`, with the
+  // multi-row `insert_type_properties` query.
+  template <typename Type>
+  absl::Status InsertTypePropertiesImpl(absl::Span<const int64> type_ids,
+                                        absl::Span<const Type> types);
+
+  // Inserts the properties and the custom properties of the `nodes`, whose
+  // ids are `node_ids`, with the multi-row insert `query`.
+  template <typename Node>
+  absl::Status InsertNodeProperties(
+      const MetadataSourceQueryConfig::TemplateQuery& query,
+      absl::Span<const int64> node_ids, absl::Span<const Node> nodes);
+
+  // Execute a template query. If the metadata source supports prepared
+  // statements, the value parameters are bound to the placeholders of a
+  // statement cached by the metadata source, and the results are returned in
+  // the given `layout`. Otherwise the parameters are rendered as SQL literals
+  // and inserted in the query text, and the results are returned as records.
   // Results consist of zero or more rows represented in RecordSet.
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
   // Returns detailed INTERNAL error, if query execution fails.
   // Returns FAILED_PRECONDITION error, if a transaction has not begun.
   absl::Status ExecuteQuery(
       const MetadataSourceQueryConfig::TemplateQuery& template_query,
-      absl::Span<const std::string> parameters, RecordSet* record_set);
+      absl::Span<const QueryParameter> parameters, RecordSet* record_set,
+      RecordSetLayout layout = RecordSetLayout::kRecords);
+
+  // A template query bound to its parameters, whose results are returned in
+  // `record_set` in the given `layout`.
+  struct BoundQuery {
+    const MetadataSourceQueryConfig::TemplateQuery* template_query;
+    std::vector<QueryParameter> parameters;
+    RecordSet* record_set;
+    RecordSetLayout layout = RecordSetLayout::kRecords;
+  };
+
+  // Executes the `nodes` query, then the `properties` query of the nodes, as
+  // the Select*WithPropertiesByID methods describe.
+  absl::Status ExecuteNodesAndPropertiesQueries(const BoundQuery& nodes,
+                                                const BoundQuery& properties);
+
+  // Executes a batch of independent template `queries`. If the metadata source
+  // pipelines queries, the queries are rendered as text queries and sent in a
+  // single round trip, and the results are returned as records. Otherwise the
+  // queries are executed one by one as ExecuteQuery.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status ExecuteQueries(absl::Span<const BoundQuery> queries);
+
+  // A template query split at its `$i` parameters, so that the parameters are
+  // bound in a single pass over the query.
+  struct CompiledTemplateQuery {
+    // The field name of the query in `query_config_`, which attributes the
+    // query in the MetadataSource instrumentation, or empty if it is not one.
+    absl::string_view name;
+    std::vector<TemplateQuerySegment> segments;
+  };
+
+  // Renders a compiled template query as a text query, with the `parameters`
+  // inserted as SQL literals in a single pass.
+  std::string RenderQuery(const CompiledTemplateQuery& compiled,
+                          absl::Span<const QueryParameter> parameters) const;
 
   // Execute a template query and ignore the result.
-  // All strings in parameters should already be in a format appropriate for the
-  // SQL variant being used (at this point, they are just inserted).
   // Returns FAILED_PRECONDITION error, if Connection() is not opened.
   // Returns detailed INTERNAL error, if query execution fails.
   // Returns FAILED_PRECONDITION error, if a transaction has not begun.
   absl::Status ExecuteQuery(
       const MetadataSourceQueryConfig::TemplateQuery& template_query,
-      const absl::Span<const std::string> parameters) {
+      const absl::Span<const QueryParameter> parameters) {
     RecordSet record_set;
     return ExecuteQuery(template_query, parameters, &record_set);
   }
@@ -659,7 +1404,8 @@ class QueryConfigExecutor : public QueryExecutor {
   // Returns INTERNAL error, if it cannot find the last insert ID.
   absl::Status ExecuteQuerySelectLastInsertID(
       const MetadataSourceQueryConfig::TemplateQuery& query,
-      const absl::Span<const std::string> arguments, int64* last_insert_id) {
+      const absl::Span<const QueryParameter> arguments,
+      int64* last_insert_id) {
     MLMD_RETURN_IF_ERROR(ExecuteQuery(query, arguments));
     return SelectLastInsertID(last_insert_id);
   }
@@ -716,10 +1462,81 @@ class QueryConfigExecutor : public QueryExecutor {
       absl::optional<absl::Span<const int64>> candidate_ids,
       RecordSet* record_set);
 
+  // Compiles the filter query `boundary_condition` on the `Node`s to
+  // `boundary`.
+  // Returns INVALID_ARGUMENT errors if the filter query is invalid.
+  template <typename Node>
+  absl::Status CompileBoundary(absl::string_view boundary_condition,
+                               CompiledBoundary* boundary);
+
+  // Checks that the properties and the custom properties of the `Node`s
+  // compared by a filter query, i.e., `property_names` and
+  // `custom_property_names`, hold no compressed values, which the filter
+  // queries cannot compare.
+  // Returns FAILED_PRECONDITION error, if a property has compressed values.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename Node>
+  absl::Status CheckFilteredPropertiesUncompressed(
+      absl::Span<const std::string> property_names,
+      absl::Span<const std::string> custom_property_names);
+
+  // Counts the `Node`s selected by the filter query of `options` with a
+  // GROUP BY query over the dimensions of `options`.
+  // Returns INVALID_ARGUMENT errors if `options` is invalid.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename Node>
+  absl::Status CountNodesUsingOptions(const CountOptions& options,
+                                      RecordSet* record_set);
+
+  // Lists the events whose `id_column`, i.e., `artifact_id` or
+  // `execution_id`, is in `ids` using `options`.
+  absl::Status ListEventsUsingOptions(const ListOperationOptions& options,
+                                      absl::string_view id_column,
+                                      absl::Span<const int64> ids,
+                                      absl::Span<const Event::Type> event_types,
+                                      RecordSet* event_record_set);
+
+  // Lists the events satisfying the SQL `condition` using `options`.
+  absl::Status ListEventsWhere(const ListOperationOptions& options,
+                               absl::string_view condition,
+                               absl::Span<const Event::Type> event_types,
+                               RecordSet* event_record_set);
+
+  // Compiles the template queries of `query_config_`, and indexes them.
+  void CompileTemplateQueries();
+
+  // Returns the compiled `template_query`. A template query which is not one of
+  // `query_config_` is compiled into `uncached`.
+  const CompiledTemplateQuery& GetCompiledTemplateQuery(
+      const MetadataSourceQueryConfig::TemplateQuery& template_query,
+      CompiledTemplateQuery* uncached) const;
+
   MetadataSourceQueryConfig query_config_;
 
+  // The compiled template queries set in `query_config_`, which refer to its
+  // strings.
+  absl::flat_hash_map<const MetadataSourceQueryConfig::TemplateQuery*,
+                      CompiledTemplateQuery>
+      compiled_template_queries_;
+
   // This object does not own the MetadataSource.
   MetadataSource* metadata_source_;
+
+  // The dictionary of the interned string property values, shared by the
+  // stores of a pool, or null if the string values are not interned.
+  std::shared_ptr<PropertyStringDictionary> property_string_dictionary_;
+
+  // The values interned by the transaction `interning_transaction_`, which
+  // are inserted in the dictionary once it is known to be committed.
+  absl::flat_hash_map<std::string, int64> uncommitted_interned_strings_;
+  int64 interning_transaction_ = 0;
+
+  // The compressor of the large property values written, or null if they are
+  // not compressed.
+  std::unique_ptr<PropertyValueCompressor> property_value_compressor_;
+
+  // The properties indexed by dedicated indices.
+  std::vector<IndexedProperty> indexed_properties_;
 };
 
 }  // namespace ml_metadata
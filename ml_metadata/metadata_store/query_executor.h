@@ -24,6 +24,7 @@ limitations under the License.
 #include "absl/types/span.h"
 #include "ml_metadata/metadata_store/constants.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/property_string_dictionary.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 
@@ -43,8 +44,14 @@ namespace ml_metadata {
 // - Column 3: int: property value or NULL
 // - Column 4: double: property value or NULL
 // - Column 5: string: property value or NULL
+// - Column 6: bytes: serialized google.protobuf.Any of a struct or proto
+//   property value or NULL, since v14
 //
 // Some methods might add additional columns
+//
+// The Select{X}sByID and Select{X}PropertyBy{X}ID methods, which are read for
+// every node lookup, may return the RecordSet in typed columns instead of
+// string records. Use the utilities in record_set_util.h to read them.
 class QueryExecutor {
  public:
   // By default, for any empty db, the head schema should be used to init new
@@ -111,6 +118,18 @@ class QueryExecutor {
   virtual absl::Status UpgradeMetadataSourceIfOutOfDate(
       bool enable_migration) = 0;
 
+  // Runs a step of an online upgrade of the database schema version (db_v)
+  // to the library schema version (lib_v) in the current transaction, i.e.,
+  // the upgrade to db_v + 1 if it only changes the schema, or else the next
+  // step of its backfill, which rewrites at most `batch_size` rows and
+  // checkpoints its progress in the database. The db_v is updated once the
+  // backfill completes, and the steps are run until `done` is set to true,
+  // i.e., the database is empty or not older than the library.
+  // Returns INVALID_ARGUMENT error, if `batch_size` is not positive.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status UpgradeMetadataSourceOnlineStep(int64 batch_size,
+                                                       bool* done) = 0;
+
   // Downgrades the schema to `to_schema_version` in the given metadata source.
   // Returns INVALID_ARGUMENT, if `to_schema_version` is less than 0, or newer
   //   than the library version.
@@ -185,6 +204,18 @@ class QueryExecutor {
       const std::string& name, absl::optional<absl::string_view> version,
       absl::optional<absl::string_view> description, int64* type_id) = 0;
 
+  // Inserts a batch of types into the database with as few statements as
+  // possible. The ids assigned to the types are returned in `type_ids` in the
+  // same order. The id, the properties and the base_type of the types are
+  // ignored.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertTypes(absl::Span<const ArtifactType> types,
+                                   std::vector<int64>* type_ids) = 0;
+  virtual absl::Status InsertTypes(absl::Span<const ExecutionType> types,
+                                   std::vector<int64>* type_ids) = 0;
+  virtual absl::Status InsertTypes(absl::Span<const ContextType> types,
+                                   std::vector<int64>* type_ids) = 0;
+
   // Retrieves types from the database by their ids. Not found ids are
   // skipped.
   // Returned messages can be converted to ArtifactType, ContextType, or
@@ -210,6 +241,14 @@ class QueryExecutor {
       absl::optional<absl::string_view> type_version, TypeKind type_kind,
       RecordSet* record_set) = 0;
 
+  // Queries the types of all versions by their names. Not found names are
+  // skipped.
+  // Returns a message that can be converted to an ArtifactType,
+  // ContextType, or ExecutionType.
+  virtual absl::Status SelectTypesByNames(absl::Span<const std::string> names,
+                                          TypeKind type_kind,
+                                          RecordSet* record_set) = 0;
+
   // Queries for all type instances.
   // Returns a message that can be converted to an ArtifactType,
   // ContextType, or ExecutionType.
@@ -229,6 +268,28 @@ class QueryExecutor {
   virtual absl::Status SelectPropertyByTypeID(int64 type_id,
                                               RecordSet* record_set) = 0;
 
+  // Inserts the properties of a batch of types into the database with as few
+  // statements as possible. `type_ids` are the ids of the `types` in the same
+  // order.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertTypeProperties(
+      absl::Span<const int64> type_ids,
+      absl::Span<const ArtifactType> types) = 0;
+  virtual absl::Status InsertTypeProperties(
+      absl::Span<const int64> type_ids,
+      absl::Span<const ExecutionType> types) = 0;
+  virtual absl::Status InsertTypeProperties(
+      absl::Span<const int64> type_ids,
+      absl::Span<const ContextType> types) = 0;
+
+  // Queries the properties of a list of types from the database. Each record
+  // has:
+  // Column 0: int: type_id
+  // Column 1: string: the name of the property
+  // Column 2: int: the data_type of the property
+  virtual absl::Status SelectPropertiesByTypeIDs(
+      absl::Span<const int64> type_ids, RecordSet* record_set) = 0;
+
   // Checks the existence of the ParentType table.
   virtual absl::Status CheckParentTypeTable() = 0;
 
@@ -259,6 +320,26 @@ class QueryExecutor {
       const absl::optional<std::string>& name, absl::Time create_time,
       absl::Time update_time, int64* artifact_id) = 0;
 
+  // Inserts a batch of artifacts into the database with as few statements as
+  // possible. The ids assigned to the artifacts are returned in `artifact_ids`
+  // in the same order. The id and the properties of the artifacts are ignored.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertArtifacts(absl::Span<const Artifact> artifacts,
+                                       absl::Time create_time,
+                                       absl::Time update_time,
+                                       std::vector<int64>* artifact_ids) = 0;
+
+  // Inserts an artifact into the database, unless its type already has an
+  // artifact with the `name`, with a single statement that does not fail when
+  // concurrent transactions insert the same artifact. Returns the id of the
+  // inserted or the existing artifact, and whether it is inserted.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertArtifactIfNotExist(
+      int64 type_id, const std::string& artifact_uri,
+      const absl::optional<Artifact::State>& state, const std::string& name,
+      absl::Time create_time, absl::Time update_time, int64* artifact_id,
+      bool* is_inserted) = 0;
+
   // Retrieves artifacts from the database by their ids. Not found ids are
   // skipped. For each matched artifact, returns a row that contains the
   // following columns (order not important):
@@ -287,7 +368,16 @@ class QueryExecutor {
   virtual absl::Status SelectArtifactsByURI(const absl::string_view uri,
                                             RecordSet* record_set) = 0;
 
-  // Updates an artifact in the database.
+  // Queries the (`id`, `last_update_time_since_epoch`) of the artifacts with
+  // `artifact_ids`, and locks them until the end of the transaction if the
+  // database supports it.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status SelectArtifactLastUpdateTimes(
+      absl::Span<const int64> artifact_ids, RecordSet* record_set) = 0;
+
+  // Updates an artifact in the database. The last update time of the
+  // artifact increases, even if `update_time` is not later than the stored
+  // one.
   virtual absl::Status UpdateArtifactDirect(
       int64 artifact_id, int64 type_id, const std::string& uri,
       const absl::optional<Artifact::State>& state, absl::Time update_time) = 0;
@@ -300,12 +390,37 @@ class QueryExecutor {
       int64 artifact_id, absl::string_view artifact_property_name,
       bool is_custom_property, const Value& property_value) = 0;
 
+  // Inserts the properties and the custom properties of a batch of artifacts
+  // into the database with as few statements as possible. `artifact_ids` are
+  // the ids of the `artifacts` in the same order.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertArtifactProperties(
+      absl::Span<const int64> artifact_ids,
+      absl::Span<const Artifact> artifacts) = 0;
+
   // Queries properties of an artifact from the database by the
   // artifact id. Upon return, each property is mapped to a row in 'record_set'
   // using the convention spelled out in the class docstring.
   virtual absl::Status SelectArtifactPropertyByArtifactID(
       absl::Span<const int64> artifact_ids, RecordSet* record_set) = 0;
 
+  // Queries the properties of artifacts by the artifact ids, like
+  // SelectArtifactPropertyByArtifactID, but only the properties and custom
+  // properties whose names are in `property_names`.
+  virtual absl::Status SelectArtifactPropertyByArtifactIDAndName(
+      absl::Span<const int64> artifact_ids,
+      absl::Span<const std::string> property_names, RecordSet* record_set) = 0;
+
+  // Queries artifacts by their ids as SelectArtifactsByID, and their properties
+  // as SelectArtifactPropertyByArtifactID, or as
+  // SelectArtifactPropertyByArtifactIDAndName if `property_names` is not empty.
+  // The two queries are pipelined if the metadata source supports it.
+  // Otherwise the properties are not queried if no artifact is found.
+  virtual absl::Status SelectArtifactsWithPropertiesByID(
+      absl::Span<const int64> artifact_ids,
+      absl::Span<const std::string> property_names,
+      RecordSet* artifact_record_set, RecordSet* property_record_set) = 0;
+
   // Updates a property of an artifact in the database.
   virtual absl::Status UpdateArtifactProperty(
       int64 artifact_id, const absl::string_view property_name,
@@ -324,6 +439,16 @@ class QueryExecutor {
       const absl::optional<std::string>& name, absl::Time create_time,
       absl::Time update_time, int64* execution_id) = 0;
 
+  // Inserts a batch of executions into the database with as few statements as
+  // possible. The ids assigned to the executions are returned in
+  // `execution_ids` in the same order. The id and the properties of the
+  // executions are ignored.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertExecutions(absl::Span<const Execution> executions,
+                                        absl::Time create_time,
+                                        absl::Time update_time,
+                                        std::vector<int64>* execution_ids) = 0;
+
   // Retrieves Executions based on the given ids. Not found ids are skipped.
   // For each matched execution, returns a row that contains the following
   // columns (order not important):
@@ -345,6 +470,11 @@ class QueryExecutor {
   virtual absl::Status SelectExecutionsByTypeID(int64 execution_type_id,
                                                 RecordSet* record_set) = 0;
 
+  // Queries the ids of the active executions, i.e., the NEW and RUNNING ones,
+  // of the type_id.
+  virtual absl::Status SelectActiveExecutionsByTypeID(
+      int64 execution_type_id, RecordSet* record_set) = 0;
+
   // Updates an execution in the database.
   virtual absl::Status UpdateExecutionDirect(
       int64 execution_id, int64 type_id,
@@ -360,12 +490,37 @@ class QueryExecutor {
                                                bool is_custom_property,
                                                const Value& value) = 0;
 
+  // Inserts the properties and the custom properties of a batch of executions
+  // into the database with as few statements as possible. `execution_ids` are
+  // the ids of the `executions` in the same order.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertExecutionProperties(
+      absl::Span<const int64> execution_ids,
+      absl::Span<const Execution> executions) = 0;
+
   // Queries properties of executions matching the given 'ids'.
   // Upon return, each property is mapped to a row in 'record_set'
   // using the convention spelled out in the class docstring.
   virtual absl::Status SelectExecutionPropertyByExecutionID(
       absl::Span<const int64> execution_ids, RecordSet* record_set) = 0;
 
+  // Queries the properties of executions by the execution ids, like
+  // SelectExecutionPropertyByExecutionID, but only the properties and custom
+  // properties whose names are in `property_names`.
+  virtual absl::Status SelectExecutionPropertyByExecutionIDAndName(
+      absl::Span<const int64> execution_ids,
+      absl::Span<const std::string> property_names, RecordSet* record_set) = 0;
+
+  // Queries executions by their ids as SelectExecutionsByID, and their properties
+  // as SelectExecutionPropertyByExecutionID, or as
+  // SelectExecutionPropertyByExecutionIDAndName if `property_names` is not empty.
+  // The two queries are pipelined if the metadata source supports it.
+  // Otherwise the properties are not queried if no execution is found.
+  virtual absl::Status SelectExecutionsWithPropertiesByID(
+      absl::Span<const int64> execution_ids,
+      absl::Span<const std::string> property_names,
+      RecordSet* execution_record_set, RecordSet* property_record_set) = 0;
+
   // Updates a property of an execution from the database.
   virtual absl::Status UpdateExecutionProperty(int64 execution_id,
                                                const absl::string_view name,
@@ -384,6 +539,27 @@ class QueryExecutor {
                                      const absl::Time update_time,
                                      int64* context_id) = 0;
 
+  // Inserts a batch of contexts into the database with as few statements as
+  // possible. The ids assigned to the contexts are returned in `context_ids`
+  // in the same order. The id and the properties of the contexts are ignored.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertContexts(absl::Span<const Context> contexts,
+                                      absl::Time create_time,
+                                      absl::Time update_time,
+                                      std::vector<int64>* context_ids) = 0;
+
+  // Inserts a context into the database, unless its type already has a
+  // context with the `name`, with a single statement that does not fail when
+  // concurrent transactions insert the same context. Returns the id of the
+  // inserted or the existing context, and whether it is inserted.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertContextIfNotExist(int64 type_id,
+                                               const std::string& name,
+                                               absl::Time create_time,
+                                               absl::Time update_time,
+                                               int64* context_id,
+                                               bool* is_inserted) = 0;
+
   // Retrieves contexts from the database by their ids. For each context,
   // returns a row that contains the following columns (order not important):
   // - int: id
@@ -418,11 +594,36 @@ class QueryExecutor {
                                              bool custom_property,
                                              const Value& value) = 0;
 
+  // Inserts the properties and the custom properties of a batch of contexts
+  // into the database with as few statements as possible. `context_ids` are
+  // the ids of the `contexts` in the same order.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertContextProperties(
+      absl::Span<const int64> context_ids,
+      absl::Span<const Context> contexts) = 0;
+
   // Queries properties of contexts from the database by the
   // given context ids.
   virtual absl::Status SelectContextPropertyByContextID(
       absl::Span<const int64> context_id, RecordSet* record_set) = 0;
 
+  // Queries the properties of contexts by the context ids, like
+  // SelectContextPropertyByContextID, but only the properties and custom
+  // properties whose names are in `property_names`.
+  virtual absl::Status SelectContextPropertyByContextIDAndName(
+      absl::Span<const int64> context_ids,
+      absl::Span<const std::string> property_names, RecordSet* record_set) = 0;
+
+  // Queries contexts by their ids as SelectContextsByID, and their properties
+  // as SelectContextPropertyByContextID, or as
+  // SelectContextPropertyByContextIDAndName if `property_names` is not empty.
+  // The two queries are pipelined if the metadata source supports it.
+  // Otherwise the properties are not queried if no context is found.
+  virtual absl::Status SelectContextsWithPropertiesByID(
+      absl::Span<const int64> context_ids,
+      absl::Span<const std::string> property_names,
+      RecordSet* context_record_set, RecordSet* property_record_set) = 0;
+
   // Updates a property of a context in the database.
   virtual absl::Status UpdateContextProperty(
       int64 context_id, const absl::string_view property_name,
@@ -441,7 +642,17 @@ class QueryExecutor {
                                    int64 event_time_milliseconds,
                                    int64* event_id) = 0;
 
-  // Queries events from the Event table by a collection of artifact ids.
+  // Inserts a batch of events into the database with as few statements as
+  // possible. The ids assigned to the events are returned in `event_ids` in
+  // the same order. The id of the events is ignored, and the events should
+  // have their `milliseconds_since_epoch` set. Their paths are stored in the
+  // Event table since v13, and are inserted with `InsertEventPaths` before.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertEvents(absl::Span<const Event> events,
+                                    std::vector<int64>* event_ids) = 0;
+
+  // Queries events from the Event table by a collection of artifact ids. The
+  // `path` column is included if the |query_schema_version_| has it.
   virtual absl::Status SelectEventByArtifactIDs(
       absl::Span<const int64> artifact_ids, RecordSet* event_record_set) = 0;
 
@@ -449,6 +660,48 @@ class QueryExecutor {
   virtual absl::Status SelectEventByExecutionIDs(
       absl::Span<const int64> execution_ids, RecordSet* event_record_set) = 0;
 
+  // Lists a page of the events of a collection of artifact ids using
+  // `options`, which orders them by `id`, or by `milliseconds_since_epoch` for
+  // CREATE_TIME. If `event_types` is not empty, only the events of the given
+  // types are listed. The `event_record_set` has the columns of
+  // SelectEventByArtifactIDs.
+  // Returns INVALID_ARGUMENT error, if the `options` is invalid.
+  virtual absl::Status ListEventsByArtifactIDsUsingOptions(
+      const ListOperationOptions& options,
+      absl::Span<const int64> artifact_ids,
+      absl::Span<const Event::Type> event_types,
+      RecordSet* event_record_set) = 0;
+
+  // Lists a page of the events of a collection of execution ids, like
+  // ListEventsByArtifactIDsUsingOptions.
+  virtual absl::Status ListEventsByExecutionIDsUsingOptions(
+      const ListOperationOptions& options,
+      absl::Span<const int64> execution_ids,
+      absl::Span<const Event::Type> event_types,
+      RecordSet* event_record_set) = 0;
+
+  // Lists a page of the events whose milliseconds_since_epoch is at least
+  // `min_milliseconds_since_epoch`, and less than
+  // `max_milliseconds_since_epoch` if given, like
+  // ListEventsByArtifactIDsUsingOptions. Since v19 the range and the
+  // CREATE_TIME ordering are read from `idx_event_milliseconds_since_epoch`.
+  virtual absl::Status ListEventsByTimeRangeUsingOptions(
+      const ListOperationOptions& options, int64 min_milliseconds_since_epoch,
+      absl::optional<int64> max_milliseconds_since_epoch,
+      absl::Span<const Event::Type> event_types,
+      RecordSet* event_record_set) = 0;
+
+  // Queries the nodes reachable from the artifacts with `artifact_ids` within
+  // `max_num_hops` through the Event table, by traversing the events in the
+  // database. The `record_set` has a row of (`is_artifact`, `id`, `distance`)
+  // for each reachable node including the given artifacts, ordered by the
+  // least number of hops to the node, then by the executions first and by the
+  // ids. Only the first `max_num_nodes` rows are returned.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status SelectLineageGraphNodeDistances(
+      absl::Span<const int64> artifact_ids, int64 max_num_hops,
+      int64 max_num_nodes, RecordSet* record_set) = 0;
+
   // Checks the existence of the EventPath table.
   virtual absl::Status CheckEventPathTable() = 0;
 
@@ -456,7 +709,133 @@ class QueryExecutor {
   virtual absl::Status InsertEventPath(int64 event_id,
                                        const Event::Path::Step& step) = 0;
 
-  // Queries paths from the database by a collection of event ids.
+  // Inserts the path steps of a batch of events into the EventPath table with
+  // as few statements as possible. `event_ids` are the ids of the `events` in
+  // the same order. Does nothing if the |query_schema_version_| stores the
+  // paths in the Event table.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertEventPaths(absl::Span<const int64> event_ids,
+                                        absl::Span<const Event> events) = 0;
+
+  // Checks the existence of the ArtifactDerivation table.
+  virtual absl::Status CheckArtifactDerivationTable() = 0;
+
+  // Inserts the derivations between the input and output artifacts of the
+  // executions of the inserted events with `event_ids`, and skips the existing
+  // ones. Does nothing if the |query_schema_version_| has no
+  // ArtifactDerivation table.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertArtifactDerivations(
+      absl::Span<const int64> event_ids) = 0;
+
+  // Queries the artifacts upstream, or downstream if `upstream` is false, of
+  // the artifacts with `artifact_ids` within `max_num_hops` derivations
+  // through the ArtifactDerivation table. If `context_id` is given, only the
+  // derivations of the executions associated with the context are traversed.
+  // The `record_set` has a row of (`id`, `distance`) for each reached
+  // artifact, ordered by the least number of derivations to the artifact.
+  // Returns FAILED_PRECONDITION error, if the |query_schema_version_| is
+  //   earlier than the schema version (v11) that has the ArtifactDerivation
+  //   table.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status SelectArtifactDerivationDistances(
+      absl::Span<const int64> artifact_ids, bool upstream, int64 max_num_hops,
+      absl::optional<int64> context_id, RecordSet* record_set) = 0;
+
+  // Checks the existence of the ChangeLog table.
+  virtual absl::Status CheckChangeLogTable() = 0;
+
+  // Appends the `entries` to the change log. Their sequence numbers are
+  // assigned by the database. Does nothing if the |query_schema_version_| has
+  // no ChangeLog table.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertChangeLogEntries(
+      absl::Span<const ChangeLogEntry> entries) = 0;
+
+  // Queries at most `max_num_entries` change log entries with sequence numbers
+  // larger than `after_sequence_number`, ordered by their sequence numbers.
+  // Returns FAILED_PRECONDITION error, if the |query_schema_version_| is
+  //   earlier than the schema version (v12) that has the ChangeLog table.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status SelectChangeLogEntries(int64 after_sequence_number,
+                                              int64 max_num_entries,
+                                              RecordSet* record_set) = 0;
+
+  // Queries the largest sequence number of the change log, or 0 if it is
+  // empty, as a single row.
+  // Returns FAILED_PRECONDITION error, if the |query_schema_version_| is
+  //   earlier than the schema version (v12) that has the ChangeLog table.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status SelectLastChangeLogSequenceNumber(
+      RecordSet* record_set) = 0;
+
+  // Queries the id, artifact_id and execution_id of at most `max_num_events`
+  // events with ids larger than `after_event_id`, ordered by their ids.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status SelectLineageGraphEdges(int64 after_event_id,
+                                               int64 max_num_events,
+                                               RecordSet* record_set) = 0;
+
+  // Checks the existence of the ExecutionArchive table.
+  virtual absl::Status CheckExecutionArchiveTable() = 0;
+
+  // Checks the existence of the EventArchive table.
+  virtual absl::Status CheckEventArchiveTable() = 0;
+
+  // Checks the existence of the PropertyStringValue table.
+  virtual absl::Status CheckPropertyStringValueTable() = 0;
+
+  // Queries the ids of at most `max_num_executions` executions to archive,
+  // i.e., the ones last updated at or before
+  // `max_last_update_time_since_epoch`, which are not NEW or RUNNING.
+  // Returns FAILED_PRECONDITION error, if the |query_schema_version_| is
+  //   earlier than the schema version (v16) that has the archive tables.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status SelectColdExecutionIDs(
+      int64 max_last_update_time_since_epoch, int64 max_num_executions,
+      RecordSet* record_set) = 0;
+
+  // Moves `executions`, which are read with their properties, to the
+  // ExecutionArchive table, and their events to the EventArchive table. Their
+  // rows in the Execution, ExecutionProperty and Event tables are deleted,
+  // while their associations and artifact derivations are kept.
+  // Returns FAILED_PRECONDITION error, if the |query_schema_version_| is
+  //   earlier than the schema version (v16) that has the archive tables.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status ArchiveExecutions(
+      absl::Span<const Execution> executions) = 0;
+
+  // Queries the (`id`, `execution`) of archived executions by id, where
+  // `execution` is a serialized google.protobuf.Any of the Execution. Returns
+  // no rows if the |query_schema_version_| has no archive tables.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status SelectArchivedExecutionsByID(
+      absl::Span<const int64> execution_ids, RecordSet* record_set) = 0;
+
+  // Queries archived events by a collection of artifact ids, in the columns
+  // of SelectEventByArtifactIDs. Returns no rows if the
+  // |query_schema_version_| has no archive tables.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status SelectArchivedEventsByArtifactIDs(
+      absl::Span<const int64> artifact_ids, RecordSet* event_record_set) = 0;
+
+  // Queries archived events by a collection of execution ids, in the columns
+  // of SelectEventByExecutionIDs. Returns no rows if the
+  // |query_schema_version_| has no archive tables.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status SelectArchivedEventsByExecutionIDs(
+      absl::Span<const int64> execution_ids, RecordSet* event_record_set) = 0;
+
+  // Queries the edges of the lineage graph in the EventArchive table, as
+  // SelectLineageGraphEdges does in the Event table. Returns no rows if the
+  // |query_schema_version_| has no archive tables.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status SelectArchivedLineageGraphEdges(
+      int64 after_event_id, int64 max_num_events, RecordSet* record_set) = 0;
+
+  // Queries paths from the EventPath table by a collection of event ids. Does
+  // nothing if the |query_schema_version_| stores the paths in the Event
+  // table, which are read with the events.
   virtual absl::Status SelectEventPathByEventIDs(
       absl::Span<const int64> event_ids, RecordSet* record_set) = 0;
 
@@ -467,6 +846,13 @@ class QueryExecutor {
   virtual absl::Status InsertAssociation(int64 context_id, int64 execution_id,
                                          int64* association_id) = 0;
 
+  // Inserts a batch of associations into the database with as few statements
+  // as possible. The associations that already exist are skipped. The ids of
+  // the associations are ignored.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertAssociationsIfNotExist(
+      absl::Span<const Association> associations) = 0;
+
   // Returns association triplets for the given context id. Each triplet has:
   // Column 0: int: attribution id
   // Column 1: int: context id
@@ -474,12 +860,13 @@ class QueryExecutor {
   virtual absl::Status SelectAssociationByContextIDs(
       absl::Span<const int64> context_id, RecordSet* record_set) = 0;
 
-  // Returns association triplets for the given context id. Each triplet has:
+  // Returns association triplets for the given execution ids. Each triplet
+  // has:
   // Column 0: int: attribution id
   // Column 1: int: context id
   // Column 2: int: execution id
-  virtual absl::Status SelectAssociationByExecutionID(
-      int64 execution_id, RecordSet* record_set) = 0;
+  virtual absl::Status SelectAssociationByExecutionIDs(
+      absl::Span<const int64> execution_ids, RecordSet* record_set) = 0;
 
   // Checks the existence of the Attribution table.
   virtual absl::Status CheckAttributionTable() = 0;
@@ -489,12 +876,19 @@ class QueryExecutor {
                                                int64 artifact_id,
                                                int64* attribution_id) = 0;
 
-  // Returns attribution triplets for the given context id. Each triplet has:
+  // Inserts a batch of attributions into the database with as few statements
+  // as possible. The attributions that already exist are skipped. The ids of
+  // the attributions are ignored.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status InsertAttributionsIfNotExist(
+      absl::Span<const Attribution> attributions) = 0;
+
+  // Returns attribution triplets for the given context ids. Each triplet has:
   // Column 0: int: attribution id
   // Column 1: int: context id
   // Column 2: int: artifact id
-  virtual absl::Status SelectAttributionByContextID(int64 context_id,
-                                                    RecordSet* record_set) = 0;
+  virtual absl::Status SelectAttributionByContextIDs(
+      absl::Span<const int64> context_ids, RecordSet* record_set) = 0;
 
   // Returns attribution triplets for the given artifact id. Each triplet has:
   // Column 0: int: attribution id
@@ -523,6 +917,24 @@ class QueryExecutor {
   virtual absl::Status SelectChildContextsByContextID(
       int64 context_id, RecordSet* record_set) = 0;
 
+  // Queries the ancestor contexts of the given context within `max_depth`
+  // levels through the ParentContext table. Each record has:
+  // Column 0: int: ancestor context id
+  // Column 1: int: the least number of levels to the ancestor
+  // The records are ordered by the number of levels, then by the id.
+  virtual absl::Status SelectAncestorContextIDs(int64 context_id,
+                                                int64 max_depth,
+                                                RecordSet* record_set) = 0;
+
+  // Queries the descendant contexts of the given context within `max_depth`
+  // levels through the ParentContext table. Each record has:
+  // Column 0: int: descendant context id
+  // Column 1: int: the least number of levels to the descendant
+  // The records are ordered by the number of levels, then by the id.
+  virtual absl::Status SelectDescendantContextIDs(int64 context_id,
+                                                  int64 max_depth,
+                                                  RecordSet* record_set) = 0;
+
   // Checks the MLMDEnv table and query the schema version.
   // At MLMD release v0.13.2, by default it is v0.
   virtual absl::Status CheckMLMDEnvTable() = 0;
@@ -533,6 +945,22 @@ class QueryExecutor {
   // Update schema_version
   virtual absl::Status UpdateSchemaVersion(int64 schema_version) = 0;
 
+  // Queries the type generation in the MLMDEnv table. The generation is
+  // increased whenever the stored types are changed.
+  // Returns FAILED_PRECONDITION error, if the |query_schema_version_| is
+  //   earlier than the schema version (v9) that has the type generation.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status SelectTypeGeneration(int64* type_generation) = 0;
+
+  // Increases the type generation in the MLMDEnv table. Does nothing if the
+  // |query_schema_version_| has no type generation.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status IncrementTypeGeneration() = 0;
+
+  // Returns an id of the transaction opened on the metadata source. Each
+  // transaction begun on the metadata source has a different id.
+  virtual int64 GetTransactionId() = 0;
+
   // Check the database is a valid database produced by 0.13.2 MLMD release.
   // The schema version and migration are introduced after that release.
   virtual absl::Status CheckTablesIn_V0_13_2() = 0;
@@ -577,6 +1005,52 @@ class QueryExecutor {
       absl::optional<absl::Span<const int64>> candidate_ids,
       RecordSet* record_set) = 0;
 
+  // A boundary condition of the lineage graph traversal compiled to SQL, which
+  // is reused for every hop of the traversal.
+  struct CompiledBoundary {
+    // The alias of the node table in the clauses.
+    std::string node_table_alias;
+    std::string from_clause;
+    std::string where_clause;
+  };
+
+  // Compiles the filter query `boundary_artifacts` selecting the artifacts
+  // the lineage graph traversal goes through to `boundary`.
+  // Returns INVALID_ARGUMENT errors if the filter query is invalid.
+  virtual absl::Status CompileArtifactBoundary(
+      absl::string_view boundary_artifacts, CompiledBoundary* boundary) = 0;
+
+  // Compiles the filter query `boundary_executions` selecting the executions
+  // the lineage graph traversal goes through to `boundary`.
+  // Returns INVALID_ARGUMENT errors if the filter query is invalid.
+  virtual absl::Status CompileExecutionBoundary(
+      absl::string_view boundary_executions, CompiledBoundary* boundary) = 0;
+
+  // Selects the ids among `candidate_ids` of the nodes outside `boundary`,
+  // i.e., not matching its condition, with a single query.
+  // Returns detailed INTERNAL error, if query execution fails.
+  virtual absl::Status SelectNodeIDsOutsideBoundary(
+      const CompiledBoundary& boundary, absl::Span<const int64> candidate_ids,
+      RecordSet* record_set) = 0;
+
+  // Counts the artifacts selected by the filter query of `options`, grouped
+  // by the dimensions of `options`. On success `record_set` has a row for
+  // each non-empty group, ordered by the dimensions, with the values of the
+  // `group_by` dimensions in their order followed by the count.
+  // Returns INVALID_ARGUMENT errors if `options` is invalid.
+  virtual absl::Status CountArtifactsUsingOptions(const CountOptions& options,
+                                                  RecordSet* record_set) = 0;
+
+  // Counts the executions selected by the filter query of `options`, as
+  // CountArtifactsUsingOptions.
+  virtual absl::Status CountExecutionsUsingOptions(const CountOptions& options,
+                                                   RecordSet* record_set) = 0;
+
+  // Counts the contexts selected by the filter query of `options`, as
+  // CountArtifactsUsingOptions.
+  virtual absl::Status CountContextsUsingOptions(const CountOptions& options,
+                                                 RecordSet* record_set) = 0;
+
 
   // Deletes a list of artifacts by id.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -588,17 +1062,19 @@ class QueryExecutor {
   virtual absl::Status DeleteContextsById(
       absl::Span<const int64> context_ids) = 0;
 
-  // Deletes a list of executions by id.
+  // Deletes a list of executions by id, including the archived ones.
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status DeleteExecutionsById(
       absl::Span<const int64> execution_ids) = 0;
 
-  // Deletes the events corresponding to the |artifact_ids|.
+  // Deletes the events corresponding to the |artifact_ids|, including the
+  // archived ones, and the artifact derivations of the |artifact_ids|.
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status DeleteEventsByArtifactsId(
       const absl::Span<const int64> artifact_ids) = 0;
 
-  // Deletes the events corresponding to the |execution_ids|.
+  // Deletes the events corresponding to the |execution_ids|, including the
+  // archived ones, and the artifact derivations of the |execution_ids|.
   // Returns detailed INTERNAL error, if query execution fails.
   virtual absl::Status DeleteEventsByExecutionsId(
       const absl::Span<const int64> execution_ids) = 0;
@@ -633,6 +1109,32 @@ class QueryExecutor {
   virtual absl::Status DeleteParentContextsByChildIds(
       const absl::Span<const int64> child_context_ids) = 0;
 
+  // Sets the dictionary of the string property values interned in the
+  // PropertyStringValue table. If set, and the |query_schema_version_| has the
+  // table (v17), the string property values of at most
+  // PropertyStringDictionary::kMaxInternedValueSize bytes are written as the
+  // ids of their interned values. Otherwise they are stored in the property
+  // rows. The reads resolve the interned values either way.
+  virtual void set_property_string_dictionary(
+      std::shared_ptr<PropertyStringDictionary> dictionary) = 0;
+
+  // Sets the compression of the large property values. If the
+  // |query_schema_version_| has the `compressed_value` column of the property
+  // tables (v20), the string, struct and proto values of at least the
+  // min_value_size of the `config` are written compressed to the column.
+  // Otherwise they are stored uncompressed. The reads decompress the values
+  // either way, and the filter queries on the properties having compressed
+  // values fail.
+  virtual void set_property_value_compression(
+      const PropertyValueCompressionConfig& config) = 0;
+
+  // Sets the properties indexed by dedicated indices, which are created by
+  // InitMetadataSource and InitMetadataSourceIfNotExists, and to which the
+  // filter queries comparing their values are routed. They are ignored if the
+  // metadata source has no partial indices.
+  virtual void set_indexed_properties(
+      std::vector<IndexedProperty> indexed_properties) = 0;
+
  protected:
   // Uses the method to document the min schema version of an API explicitly.
   // Returns FailedPrecondition, if the |query_schema_version_| is less than the
@@ -23,6 +23,7 @@ limitations under the License.
 #include "absl/time/clock.h"
 #include "absl/types/optional.h"
 #include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/record_set_util.h"
 #include "ml_metadata/metadata_store/test_util.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
@@ -250,7 +251,7 @@ TEST_P(QueryExecutorTest, DeleteContextsById) {
     RecordSet record_set;
     ASSERT_EQ(absl::OkStatus(), query_executor_->SelectContextsByID(
                                     {context_id_1, context_id_2}, &record_set));
-    EXPECT_EQ(record_set.records_size(), 2);
+    EXPECT_EQ(NumRows(record_set), 2);
   }
   // Test: actual deletion on context1
   {
@@ -261,24 +262,23 @@ TEST_P(QueryExecutorTest, DeleteContextsById) {
                                     {context_id_1, context_id_2}, &record_set));
 
     // Verify: context1 was deleted; context2 still remains.
-    ASSERT_EQ(record_set.records_size(), 1);
+    ASSERT_EQ(NumRows(record_set), 1);
     // For different backends, the index for column "id" varies.
     const int id_column_index = GetIdColumnIndex(record_set);
     ASSERT_GE(id_column_index, 0);
-    EXPECT_EQ(record_set.records(0).values(id_column_index),
-              std::to_string(context_id_2));
+    EXPECT_EQ(GetInt64Value(record_set, 0, id_column_index), context_id_2);
 
     // Verify: context properties for context1 were also deleted.
     RecordSet property_record_set;
     ASSERT_EQ(absl::OkStatus(),
               query_executor_->SelectContextPropertyByContextID(
                   {context_id_1}, &property_record_set));
-    EXPECT_EQ(property_record_set.records_size(), 0);
+    EXPECT_EQ(NumRows(property_record_set), 0);
 
     // Verify: arrtibution and association for context1 were not deleted.
     RecordSet attribution_set, association_set;
-    ASSERT_EQ(absl::OkStatus(), query_executor_->SelectAttributionByContextID(
-                                    context_id_1, &attribution_set));
+    ASSERT_EQ(absl::OkStatus(), query_executor_->SelectAttributionByContextIDs(
+                                    {context_id_1}, &attribution_set));
     EXPECT_EQ(attribution_set.records_size(), 1);
     ASSERT_EQ(absl::OkStatus(), query_executor_->SelectAssociationByContextIDs(
                                     {context_id_1}, &association_set));
@@ -294,19 +294,18 @@ TEST_P(QueryExecutorTest, DeleteContextsById) {
               query_executor_->SelectContextsByID({context_id_2}, &record_set));
 
     // Verify: context2 remains because context id was wrong when deleting it.
-    ASSERT_EQ(record_set.records_size(), 1);
+    ASSERT_EQ(NumRows(record_set), 1);
     // For different backends, the index for column "id" varies.
     const int id_column_index = GetIdColumnIndex(record_set);
     ASSERT_GE(id_column_index, 0);
-    EXPECT_EQ(record_set.records(0).values(id_column_index),
-              std::to_string(context_id_2));
+    EXPECT_EQ(GetInt64Value(record_set, 0, id_column_index), context_id_2);
 
     // Verify: context properties for context2 also remain.
     RecordSet property_record_set;
     ASSERT_EQ(absl::OkStatus(),
               query_executor_->SelectContextPropertyByContextID(
                   {context_id_2}, &property_record_set));
-    EXPECT_EQ(property_record_set.records_size(), 1);
+    EXPECT_EQ(NumRows(property_record_set), 1);
   }
 }
 
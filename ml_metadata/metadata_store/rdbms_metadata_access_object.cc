@@ -17,12 +17,15 @@ limitations under the License.
 
 #endif
 
+#include <algorithm>
 #include <iterator>
 #include <string>
 #include <vector>
 
 #include <glog/logging.h>
+#include "google/protobuf/any.pb.h"
 #include "google/protobuf/struct.pb.h"
+#include "google/protobuf/arena.h"
 #include "google/protobuf/descriptor.h"
 #include "google/protobuf/util/json_util.h"
 #include "google/protobuf/util/message_differencer.h"
@@ -47,6 +50,9 @@ limitations under the License.
 // clang-format on
 #include "absl/types/optional.h"
 #include "ml_metadata/metadata_store/list_operation_util.h"
+#include "ml_metadata/metadata_store/property_value_compressor.h"
+#include "ml_metadata/metadata_store/record_set_util.h"
+#include "ml_metadata/metadata_store/trace_span.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "ml_metadata/simple_types/simple_types_constants.h"
@@ -56,6 +62,10 @@ limitations under the License.
 namespace ml_metadata {
 namespace {
 
+// The edges and the change log entries of the lineage graph index are read in
+// pages of this many rows.
+constexpr int64 kLineageGraphIndexPageSize = 10000;
+
 TypeKind ResolveTypeKind(const ArtifactType* const type) {
   return TypeKind::ARTIFACT_TYPE;
 }
@@ -68,30 +78,66 @@ TypeKind ResolveTypeKind(const ContextType* const type) {
   return TypeKind::CONTEXT_TYPE;
 }
 
-// Populates 'node' properties from the rows in 'record'. The assumption is that
-// properties are encoded using the convention in
+// Returns INVALID_ARGUMENT error, if any of the distinct `ids` is missing in
+// the `record_set` of the nodes selected by these ids. The node id should be
+// the first column of the `record_set`.
+absl::Status CheckNodesFound(const absl::flat_hash_set<int64>& ids,
+                             const RecordSet& record_set,
+                             absl::string_view node_kind) {
+  if (NumRows(record_set) == ids.size()) {
+    return absl::OkStatus();
+  }
+  absl::flat_hash_set<int64> found_ids;
+  for (int row = 0; row < NumRows(record_set); row++) {
+    found_ids.insert(GetInt64Value(record_set, row, 0));
+  }
+  for (const int64 id : ids) {
+    if (!found_ids.contains(id)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("No ", node_kind, " with the given id ", id));
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Populates 'node' properties from the `row` in 'record_set'. The assumption is
+// that properties are encoded using the convention in
 // QueryExecutor::Get{X}PropertyBy{X}Id() where X in {Artifact, Execution,
-// Context}.
+// Context}. Since v14, the struct and proto values are in the proto_value
+// column, and the struct values stored as strings are still read. Since v17,
+// the compressed values are in the last column, i.e., the byte_value column,
+// or the compressed_value column since v20.
 template <typename Node>
-absl::Status PopulateNodeProperties(const RecordSet::Record& record,
+absl::Status PopulateNodeProperties(const RecordSet& record_set, const int row,
                                     Node& node) {
   // Populate the property of the node.
-  const std::string& property_name = record.values(1);
-  bool is_custom_property;
-  CHECK(absl::SimpleAtob(record.values(2), &is_custom_property));
+  const std::string property_name = GetStringValue(record_set, row, 1);
+  const bool is_custom_property = GetBoolValue(record_set, row, 2);
   auto& property_value =
       (is_custom_property ? (*node.mutable_custom_properties())[property_name]
                           : (*node.mutable_properties())[property_name]);
-  if (record.values(3) != kMetadataSourceNull) {
-    int64 int_value;
-    CHECK(absl::SimpleAtoi(record.values(3), &int_value));
-    property_value.set_int_value(int_value);
-  } else if (record.values(4) != kMetadataSourceNull) {
-    double double_value;
-    CHECK(absl::SimpleAtod(record.values(4), &double_value));
-    property_value.set_double_value(double_value);
+  if (!IsNullValue(record_set, row, 3)) {
+    property_value.set_int_value(GetInt64Value(record_set, row, 3));
+  } else if (!IsNullValue(record_set, row, 4)) {
+    property_value.set_double_value(GetDoubleValue(record_set, row, 4));
+  } else if (record_set.column_names_size() > 6 &&
+             !IsNullValue(record_set, row, 6)) {
+    google::protobuf::Any proto_value;
+    if (!proto_value.ParseFromString(GetStringValue(record_set, row, 6))) {
+      return absl::InternalError(
+          absl::StrCat("Could not parse the proto value of ", property_name));
+    }
+    if (proto_value.Is<google::protobuf::Struct>()) {
+      proto_value.UnpackTo(property_value.mutable_struct_value());
+    } else {
+      *property_value.mutable_proto_value() = std::move(proto_value);
+    }
+  } else if (record_set.column_names_size() > 7 &&
+             !IsNullValue(record_set, row, 7)) {
+    MLMD_RETURN_IF_ERROR(PropertyValueCompressor::Decompress(
+        GetStringValue(record_set, row, 7), &property_value));
   } else {
-    const std::string& string_value = record.values(5);
+    const std::string string_value = GetStringValue(record_set, row, 5);
     if (IsStructSerializedString(string_value)) {
       MLMD_RETURN_IF_ERROR(
           StringToStruct(string_value, *property_value.mutable_struct_value()));
@@ -106,16 +152,52 @@ absl::Status PopulateNodeProperties(const RecordSet::Record& record,
 // Converts a record set that contains an id column at position per record to a
 // vector.
 std::vector<int64> ConvertToIds(const RecordSet& record_set, int position = 0) {
+  const int num_rows = NumRows(record_set);
   std::vector<int64> result;
-  result.reserve(record_set.records().size());
-  for (const RecordSet::Record& record : record_set.records()) {
-    int64 id;
-    CHECK(absl::SimpleAtoi(record.values(position), &id));
-    result.push_back(id);
+  result.reserve(num_rows);
+  for (int row = 0; row < num_rows; row++) {
+    result.push_back(GetInt64Value(record_set, row, position));
   }
   return result;
 }
 
+// Converts a record set of a Count*UsingOptions query, which has the values of
+// the `group_by` dimensions of `options` followed by the count per record, to
+// `counts`.
+void ConvertToNodeCounts(const CountOptions& options,
+                         const RecordSet& record_set,
+                         std::vector<NodeCount>* counts) {
+  const int num_rows = NumRows(record_set);
+  counts->clear();
+  counts->reserve(num_rows);
+  for (int row = 0; row < num_rows; row++) {
+    NodeCount& count = counts->emplace_back();
+    int column = 0;
+    for (const int group_by : options.group_by()) {
+      if (IsNullValue(record_set, row, column)) {
+        column++;
+        continue;
+      }
+      const int64 value = GetInt64Value(record_set, row, column++);
+      switch (group_by) {
+        case CountOptions::TYPE:
+          count.set_type_id(value);
+          break;
+        case CountOptions::STATE:
+          count.set_state(value);
+          break;
+        case CountOptions::CONTEXT:
+          count.set_context_id(value);
+          break;
+        case CountOptions::CREATE_TIME_BUCKET:
+          count.set_create_time_bucket_start(value);
+          break;
+      }
+    }
+    count.set_count(GetInt64Value(record_set, row, column));
+  }
+}
+
 // Extracts 2 vectors of type ids and corresponding parent type ids from the
 // parent_type triplets.
 void ConvertToTypeAndParentTypeIds(const RecordSet& record_set,
@@ -153,6 +235,39 @@ std::vector<int64> AssociationsToExecutionIds(const RecordSet& record_set) {
   return ConvertToIds(record_set, /*position=*/2);
 }
 
+// Extracts the pairs of context and node ids from attribution or association
+// triplets, ordered by context id and then by node id in descending order.
+// If `max_num_per_context` is positive, at most that many pairs of each
+// context, i.e., the ones of its latest nodes, are kept.
+std::vector<std::pair<int64, int64>> LinksToContextAndNodeIds(
+    const RecordSet& record_set, const int64 max_num_per_context) {
+  const int num_rows = NumRows(record_set);
+  std::vector<std::pair<int64, int64>> links;
+  links.reserve(num_rows);
+  for (int row = 0; row < num_rows; row++) {
+    links.emplace_back(GetInt64Value(record_set, row, /*position=*/1),
+                       GetInt64Value(record_set, row, /*position=*/2));
+  }
+  std::sort(links.begin(), links.end(),
+            [](const std::pair<int64, int64>& a,
+               const std::pair<int64, int64>& b) {
+              return a.first != b.first ? a.first < b.first
+                                        : a.second > b.second;
+            });
+  links.erase(std::unique(links.begin(), links.end()), links.end());
+  if (max_num_per_context <= 0) {
+    return links;
+  }
+  std::vector<std::pair<int64, int64>> kept_links;
+  absl::flat_hash_map<int64, int64> num_links_by_context_id;
+  for (const std::pair<int64, int64>& link : links) {
+    if (++num_links_by_context_id[link.first] <= max_num_per_context) {
+      kept_links.push_back(link);
+    }
+  }
+  return kept_links;
+}
+
 // Extracts a vector of parent context ids from parent context triplets.
 // If is_parent is true, then parent_context_ids are returned.
 // If is_parent is false, then context_ids for children are returned.
@@ -162,29 +277,31 @@ std::vector<int64> ParentContextsToContextIds(const RecordSet& record_set,
   return ConvertToIds(record_set, position);
 }
 
-// Parses and converts a string value to a specific field in a message.
-// If the given string `value` is NULL (encoded as kMetadataSourceNull), then
-// leave the field unset.
+// Parses and converts the value at `row` and `column` of a record set to a
+// specific field in a message. Values in typed columns are converted without
+// a string round-trip. If the value is NULL, then leave the field unset.
 // The field should be a scalar field. The field type must be one of {string,
 // int64, bool, enum, message}.
 absl::Status ParseValueToField(const google::protobuf::FieldDescriptor* field_descriptor,
-                               const absl::string_view value,
+                               const RecordSet& record_set, const int row,
+                               const int column,
                                google::protobuf::Message* message) {
-  if (value == kMetadataSourceNull) {
+  if (IsNullValue(record_set, row, column)) {
     return absl::OkStatus();
   }
   const google::protobuf::Reflection* reflection = message->GetReflection();
   switch (field_descriptor->cpp_type()) {
     case google::protobuf::FieldDescriptor::CppType::CPPTYPE_STRING: {
       if (field_descriptor->is_repeated())
-        reflection->AddString(message, field_descriptor, std::string(value));
+        reflection->AddString(message, field_descriptor,
+                              GetStringValue(record_set, row, column));
       else
-        reflection->SetString(message, field_descriptor, std::string(value));
+        reflection->SetString(message, field_descriptor,
+                              GetStringValue(record_set, row, column));
       break;
     }
     case google::protobuf::FieldDescriptor::CppType::CPPTYPE_INT64: {
-      int64 int64_value;
-      CHECK(absl::SimpleAtoi(value, &int64_value));
+      const int64 int64_value = GetInt64Value(record_set, row, column);
       if (field_descriptor->is_repeated())
         reflection->AddInt64(message, field_descriptor, int64_value);
       else
@@ -192,8 +309,7 @@ absl::Status ParseValueToField(const google::protobuf::FieldDescriptor* field_de
       break;
     }
     case google::protobuf::FieldDescriptor::CppType::CPPTYPE_BOOL: {
-      bool bool_value;
-      CHECK(absl::SimpleAtob(value, &bool_value));
+      const bool bool_value = GetBoolValue(record_set, row, column);
       if (field_descriptor->is_repeated())
         reflection->AddBool(message, field_descriptor, bool_value);
       else
@@ -201,8 +317,7 @@ absl::Status ParseValueToField(const google::protobuf::FieldDescriptor* field_de
       break;
     }
     case google::protobuf::FieldDescriptor::CppType::CPPTYPE_ENUM: {
-      int enum_value;
-      CHECK(absl::SimpleAtoi(value, &enum_value));
+      const int enum_value = GetInt64Value(record_set, row, column);
       if (field_descriptor->is_repeated())
         reflection->AddEnumValue(message, field_descriptor, enum_value);
       else
@@ -212,11 +327,11 @@ absl::Status ParseValueToField(const google::protobuf::FieldDescriptor* field_de
     case google::protobuf::FieldDescriptor::CppType::CPPTYPE_MESSAGE: {
       CHECK(!field_descriptor->is_repeated())
           << "Cannot handle a repeated message";
+      const std::string value = GetStringValue(record_set, row, column);
       if (!value.empty()) {
         ::google::protobuf::Message* sub_message =
             reflection->MutableMessage(message, field_descriptor);
-        if (!::google::protobuf::util::JsonStringToMessage(
-                 std::string(value.begin(), value.size()), sub_message)
+        if (!::google::protobuf::util::JsonStringToMessage(value, sub_message)
                  .ok()) {
           return absl::InternalError(
               ::absl::StrCat("Failed to parse proto: ", value));
@@ -239,15 +354,15 @@ template <typename MessageType>
 absl::Status ParseRecordSetToMessage(const RecordSet& record_set,
                                      MessageType* message,
                                      int record_index = 0) {
-  CHECK_LT(record_index, record_set.records_size());
+  CHECK_LT(record_index, NumRows(record_set));
   const google::protobuf::Descriptor* descriptor = message->descriptor();
   for (int i = 0; i < record_set.column_names_size(); i++) {
     const std::string& column_name = record_set.column_names(i);
     const google::protobuf::FieldDescriptor* field_descriptor =
         descriptor->FindFieldByName(column_name);
     if (field_descriptor != nullptr) {
-      const std::string& value = record_set.records(record_index).values(i);
-      MLMD_RETURN_IF_ERROR(ParseValueToField(field_descriptor, value, message));
+      MLMD_RETURN_IF_ERROR(ParseValueToField(field_descriptor, record_set,
+                                             record_index, i, message));
     }
   }
   return absl::OkStatus();
@@ -257,8 +372,9 @@ absl::Status ParseRecordSetToMessage(const RecordSet& record_set,
 template <typename MessageType>
 absl::Status ParseRecordSetToMessageArray(const RecordSet& record_set,
                                           std::vector<MessageType>* messages) {
-  for (int i = 0; i < record_set.records_size(); i++) {
-    messages->push_back(MessageType());
+  messages->reserve(messages->size() + NumRows(record_set));
+  for (int i = 0; i < NumRows(record_set); i++) {
+    messages->emplace_back();
     MLMD_RETURN_IF_ERROR(
         ParseRecordSetToMessage(record_set, &messages->back(), i));
   }
@@ -286,15 +402,13 @@ absl::Status ParseRecordSetToMapField(const RecordSet& record_set,
   const google::protobuf::FieldDescriptor* value_descriptor =
       map_field_descriptor->message_type()->FindFieldByName("value");
 
-  for (const RecordSet::Record& record : record_set.records()) {
+  for (int row = 0; row < NumRows(record_set); row++) {
     google::protobuf::Message* map_field_message =
         reflection->AddMessage(message, map_field_descriptor);
-    const std::string& key = record.values(0);
-    const std::string& value = record.values(1);
-    MLMD_RETURN_IF_ERROR(
-        ParseValueToField(key_descriptor, key, map_field_message));
-    MLMD_RETURN_IF_ERROR(
-        ParseValueToField(value_descriptor, value, map_field_message));
+    MLMD_RETURN_IF_ERROR(ParseValueToField(key_descriptor, record_set, row,
+                                           /*column=*/0, map_field_message));
+    MLMD_RETURN_IF_ERROR(ParseValueToField(value_descriptor, record_set, row,
+                                           /*column=*/1, map_field_message));
   }
 
   return absl::OkStatus();
@@ -334,6 +448,10 @@ absl::Status ValidatePropertiesWithType(const Node& node, const Type& type) {
         is_type_match = property_value.has_struct_value();
         break;
       }
+      case PropertyType::PROTO: {
+        is_type_match = property_value.has_proto_value();
+        break;
+      }
       default: {
         return absl::InternalError(absl::StrCat(
             "Unknown registered property type: ", type.DebugString()));
@@ -424,6 +542,89 @@ absl::Status CheckCyClicDependency(int64 child_id, int64 parent_id,
   return absl::OkStatus();
 }
 
+// Sets `nodes` to the nodes that only have the `ids`.
+template <typename Node>
+void SetIdOnlyNodes(absl::Span<const int64> ids, std::vector<Node>& nodes) {
+  nodes.resize(ids.size());
+  for (int i = 0; i < ids.size(); i++) {
+    nodes[i].set_id(ids[i]);
+  }
+}
+
+// Returns the property names of `projection` to bind to the property queries.
+std::vector<std::string> ProjectedPropertyNames(
+    const ListOperationOptions::PropertyProjection& projection) {
+  return std::vector<std::string>(projection.property_names().begin(),
+                                  projection.property_names().end());
+}
+
+// Returns the kind of the change log entries of a node.
+ChangeLogEntry::Kind ChangeLogKind(const Artifact&) {
+  return ChangeLogEntry::ARTIFACT;
+}
+ChangeLogEntry::Kind ChangeLogKind(const Execution&) {
+  return ChangeLogEntry::EXECUTION;
+}
+ChangeLogEntry::Kind ChangeLogKind(const Context&) {
+  return ChangeLogEntry::CONTEXT;
+}
+
+// Returns the change log entries of the `operation` on the nodes of `kind`
+// with `node_ids`.
+std::vector<ChangeLogEntry> NodeChangeLogEntries(
+    const ChangeLogEntry::Kind kind, const ChangeLogEntry::Operation operation,
+    absl::Span<const int64> node_ids) {
+  const int64 now = absl::ToUnixMillis(absl::Now());
+  std::vector<ChangeLogEntry> entries(node_ids.size());
+  for (int i = 0; i < node_ids.size(); i++) {
+    ChangeLogEntry& entry = entries[i];
+    entry.set_kind(kind);
+    entry.set_operation(operation);
+    entry.set_milliseconds_since_epoch(now);
+    switch (kind) {
+      case ChangeLogEntry::ARTIFACT:
+        entry.set_artifact_id(node_ids[i]);
+        break;
+      case ChangeLogEntry::EXECUTION:
+        entry.set_execution_id(node_ids[i]);
+        break;
+      case ChangeLogEntry::CONTEXT:
+        entry.set_context_id(node_ids[i]);
+        break;
+      default:
+        LOG(FATAL) << "Unexpected kind of node: " << kind;
+    }
+  }
+  return entries;
+}
+
+// Returns the change log entries of the creation of `events`.
+std::vector<ChangeLogEntry> EventChangeLogEntries(
+    absl::Span<const Event> events) {
+  const int64 now = absl::ToUnixMillis(absl::Now());
+  std::vector<ChangeLogEntry> entries(events.size());
+  for (int i = 0; i < events.size(); i++) {
+    entries[i].set_kind(ChangeLogEntry::EVENT);
+    entries[i].set_operation(ChangeLogEntry::CREATED);
+    entries[i].set_artifact_id(events[i].artifact_id());
+    entries[i].set_execution_id(events[i].execution_id());
+    entries[i].set_milliseconds_since_epoch(now);
+  }
+  return entries;
+}
+
+// Returns INVALID_ARGUMENT error, if any property type of `type` is unknown.
+template <typename Type>
+absl::Status CheckTypePropertiesKnown(const Type& type) {
+  for (const auto& property : type.properties()) {
+    if (property.second == PropertyType::UNKNOWN) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Property ", property.first, " is UNKNOWN."));
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 // Creates an Artifact (without properties).
@@ -464,38 +665,152 @@ absl::Status RDBMSMetadataAccessObject::CreateBasicNode(const Context& context,
                                   node_id);
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateBasicNodeIfNotExist(
+    const Artifact& artifact, int64* node_id, bool* is_created) {
+  const absl::Time now = absl::Now();
+  return executor_->InsertArtifactIfNotExist(
+      artifact.type_id(), artifact.uri(),
+      artifact.has_state() ? absl::make_optional(artifact.state())
+                           : absl::nullopt,
+      artifact.name(), now, now, node_id, is_created);
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateBasicNodeIfNotExist(
+    const Context& context, int64* node_id, bool* is_created) {
+  const absl::Time now = absl::Now();
+  return executor_->InsertContextIfNotExist(context.type_id(), context.name(),
+                                            now, now, node_id, is_created);
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateBasicNodes(
+    const absl::Span<const Artifact> artifacts, std::vector<int64>* node_ids) {
+  const absl::Time now = absl::Now();
+  return executor_->InsertArtifacts(artifacts, now, now, node_ids);
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateBasicNodes(
+    const absl::Span<const Execution> executions,
+    std::vector<int64>* node_ids) {
+  const absl::Time now = absl::Now();
+  return executor_->InsertExecutions(executions, now, now, node_ids);
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateBasicNodes(
+    const absl::Span<const Context> contexts, std::vector<int64>* node_ids) {
+  for (const Context& context : contexts) {
+    if (!context.has_name() || context.name().empty()) {
+      return absl::InvalidArgumentError("Context name should not be empty");
+    }
+  }
+  const absl::Time now = absl::Now();
+  return executor_->InsertContexts(contexts, now, now, node_ids);
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateNodeProperties(
+    const absl::Span<const int64> node_ids,
+    const absl::Span<const Artifact> artifacts) {
+  return executor_->InsertArtifactProperties(node_ids, artifacts);
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateNodeProperties(
+    const absl::Span<const int64> node_ids,
+    const absl::Span<const Execution> executions) {
+  return executor_->InsertExecutionProperties(node_ids, executions);
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateNodeProperties(
+    const absl::Span<const int64> node_ids,
+    const absl::Span<const Context> contexts) {
+  return executor_->InsertContextProperties(node_ids, contexts);
+}
+
 template <>
 absl::Status RDBMSMetadataAccessObject::RetrieveNodesById(
-    const absl::Span<const int64> ids, RecordSet* header, RecordSet* properties,
-    Context* tag) {
-  MLMD_RETURN_IF_ERROR(executor_->SelectContextsByID(ids, header));
-  if (!header->records().empty()) {
-    MLMD_RETURN_IF_ERROR(
-        executor_->SelectContextPropertyByContextID(ids, properties));
+    const absl::Span<const int64> ids,
+    const ListOperationOptions::PropertyProjection& projection,
+    RecordSet* header, RecordSet* properties, Context* tag) {
+  if (projection.headers_only()) {
+    return executor_->SelectContextsByID(ids, header);
   }
-  return absl::OkStatus();
+  return executor_->SelectContextsWithPropertiesByID(
+      ids, ProjectedPropertyNames(projection), header, properties);
 }
 
 template <>
 absl::Status RDBMSMetadataAccessObject::RetrieveNodesById(
-    const absl::Span<const int64> ids, RecordSet* header, RecordSet* properties,
-    Artifact* tag) {
-  MLMD_RETURN_IF_ERROR(executor_->SelectArtifactsByID(ids, header));
-  if (!header->records().empty()) {
-    MLMD_RETURN_IF_ERROR(
-        executor_->SelectArtifactPropertyByArtifactID(ids, properties));
+    const absl::Span<const int64> ids,
+    const ListOperationOptions::PropertyProjection& projection,
+    RecordSet* header, RecordSet* properties, Artifact* tag) {
+  if (projection.headers_only()) {
+    return executor_->SelectArtifactsByID(ids, header);
   }
-  return absl::OkStatus();
+  return executor_->SelectArtifactsWithPropertiesByID(
+      ids, ProjectedPropertyNames(projection), header, properties);
 }
 
 template <>
 absl::Status RDBMSMetadataAccessObject::RetrieveNodesById(
-    const absl::Span<const int64> ids, RecordSet* header, RecordSet* properties,
-    Execution* tag) {
-  MLMD_RETURN_IF_ERROR(executor_->SelectExecutionsByID(ids, header));
-  if (!header->records().empty()) {
-    MLMD_RETURN_IF_ERROR(
-        executor_->SelectExecutionPropertyByExecutionID(ids, properties));
+    const absl::Span<const int64> ids,
+    const ListOperationOptions::PropertyProjection& projection,
+    RecordSet* header, RecordSet* properties, Execution* tag) {
+  if (projection.headers_only()) {
+    return executor_->SelectExecutionsByID(ids, header);
+  }
+  return executor_->SelectExecutionsWithPropertiesByID(
+      ids, ProjectedPropertyNames(projection), header, properties);
+}
+
+template <>
+absl::Status RDBMSMetadataAccessObject::RetrieveArchivedNodesById(
+    const absl::Span<const int64> ids,
+    const ListOperationOptions::PropertyProjection& projection,
+    std::vector<Artifact>& nodes) {
+  return absl::OkStatus();
+}
+
+template <>
+absl::Status RDBMSMetadataAccessObject::RetrieveArchivedNodesById(
+    const absl::Span<const int64> ids,
+    const ListOperationOptions::PropertyProjection& projection,
+    std::vector<Context>& nodes) {
+  return absl::OkStatus();
+}
+
+// The archived executions are serialized with their properties, so the
+// projection is applied after they are parsed.
+template <>
+absl::Status RDBMSMetadataAccessObject::RetrieveArchivedNodesById(
+    const absl::Span<const int64> ids,
+    const ListOperationOptions::PropertyProjection& projection,
+    std::vector<Execution>& nodes) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectArchivedExecutionsByID(ids, &record_set));
+  const absl::flat_hash_set<std::string> property_names(
+      projection.property_names().begin(), projection.property_names().end());
+  const auto project = [&property_names](
+                           google::protobuf::Map<std::string, Value>& properties) {
+    for (auto it = properties.begin(); it != properties.end();) {
+      it = property_names.contains(it->first) ? std::next(it)
+                                              : properties.erase(it);
+    }
+  };
+  for (const RecordSet::Record& record : record_set.records()) {
+    google::protobuf::Any archived_execution;
+    Execution execution;
+    if (!archived_execution.ParseFromString(record.values(1)) ||
+        !archived_execution.UnpackTo(&execution)) {
+      return absl::InternalError(absl::StrCat(
+          "Could not parse the archived execution: ", record.DebugString()));
+    }
+    if (projection.headers_only()) {
+      execution.clear_properties();
+      execution.clear_custom_properties();
+    } else if (!property_names.empty()) {
+      project(*execution.mutable_properties());
+      project(*execution.mutable_custom_properties());
+    }
+    nodes.push_back(std::move(execution));
   }
   return absl::OkStatus();
 }
@@ -684,6 +999,8 @@ absl::Status RDBMSMetadataAccessObject::InsertTypeID(const ContextType& type,
 template <typename Type>
 absl::Status RDBMSMetadataAccessObject::CreateTypeImpl(const Type& type,
                                                        int64* type_id) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::CreateType");
+  span.AddAttribute("mlmd.kind", Type::descriptor()->name());
   const std::string& type_name = type.name();
   const google::protobuf::Map<std::string, PropertyType>& type_properties =
       type.properties();
@@ -695,6 +1012,7 @@ absl::Status RDBMSMetadataAccessObject::CreateTypeImpl(const Type& type,
 
   // insert a type and get its given id
   MLMD_RETURN_IF_ERROR(InsertTypeID(type, type_id));
+  MLMD_RETURN_IF_ERROR(InvalidateTypeCache());
 
   // insert type properties and commit
   for (const auto& property : type_properties) {
@@ -711,6 +1029,140 @@ absl::Status RDBMSMetadataAccessObject::CreateTypeImpl(const Type& type,
   return absl::OkStatus();
 }
 
+template <typename Type>
+absl::Status RDBMSMetadataAccessObject::CreateTypesImpl(
+    const absl::Span<const Type> types, std::vector<int64>* type_ids) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::CreateTypes");
+  span.AddAttribute("mlmd.kind", Type::descriptor()->name());
+  type_ids->clear();
+  for (const Type& type : types) {
+    if (type.name().empty()) {
+      return absl::InvalidArgumentError("No type name is specified.");
+    }
+    MLMD_RETURN_IF_ERROR(CheckTypePropertiesKnown(type));
+  }
+  if (types.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_RETURN_IF_ERROR(executor_->InsertTypes(types, type_ids));
+  MLMD_RETURN_IF_ERROR(InvalidateTypeCache());
+  return executor_->InsertTypeProperties(*type_ids, types);
+}
+
+template <typename Type>
+absl::Status RDBMSMetadataAccessObject::AddTypePropertiesImpl(
+    const absl::Span<const Type> types) {
+  std::vector<int64> type_ids;
+  bool has_properties = false;
+  for (const Type& type : types) {
+    if (!type.has_id()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("No type id is specified: ", type.DebugString()));
+    }
+    MLMD_RETURN_IF_ERROR(CheckTypePropertiesKnown(type));
+    type_ids.push_back(type.id());
+    has_properties |= !type.properties().empty();
+  }
+  if (!has_properties) {
+    return absl::OkStatus();
+  }
+  MLMD_RETURN_IF_ERROR(InvalidateTypeCache());
+  return executor_->InsertTypeProperties(type_ids, types);
+}
+
+template <typename MessageType>
+absl::Status RDBMSMetadataAccessObject::FindTypesByNamesImpl(
+    const absl::Span<const std::string> names,
+    std::vector<MessageType>* types) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::FindTypesByNames");
+  span.AddAttribute("mlmd.kind", MessageType::descriptor()->name());
+  types->clear();
+  if (names.empty()) {
+    return absl::OkStatus();
+  }
+  MessageType dummy_type;
+  const TypeKind type_kind = ResolveTypeKind(&dummy_type);
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectTypesByNames(names, type_kind, &record_set));
+  MLMD_RETURN_IF_ERROR(
+      FindTypesFromRecordSet(record_set, types, /*get_properties=*/false));
+  return FindTypeProperties(types);
+}
+
+template <typename MessageType>
+absl::Status RDBMSMetadataAccessObject::FindTypesByIdsImpl(
+    const absl::Span<const int64> type_ids, std::vector<MessageType>* types) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::FindTypesByIds");
+  span.AddAttribute("mlmd.kind", MessageType::descriptor()->name());
+  types->clear();
+  MLMD_RETURN_IF_ERROR(ValidateTypeCache());
+  absl::flat_hash_set<int64> seen_ids;
+  std::vector<int64> uncached_ids;
+  for (const int64 type_id : type_ids) {
+    if (!seen_ids.insert(type_id).second) continue;
+    const MessageType* cached_type =
+        type_cache_enabled_ ? type_cache_.Find<MessageType>(type_id) : nullptr;
+    if (cached_type != nullptr) {
+      types->push_back(*cached_type);
+    } else {
+      uncached_ids.push_back(type_id);
+    }
+  }
+  span.AddAttribute("mlmd.num_uncached_types", uncached_ids.size());
+  if (uncached_ids.empty()) {
+    return absl::OkStatus();
+  }
+  MessageType dummy_type;
+  const TypeKind type_kind = ResolveTypeKind(&dummy_type);
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectTypesByID(uncached_ids, type_kind, &record_set));
+  std::vector<MessageType> found_types;
+  MLMD_RETURN_IF_ERROR(FindTypesFromRecordSet(record_set, &found_types,
+                                              /*get_properties=*/false));
+  MLMD_RETURN_IF_ERROR(FindTypeProperties(&found_types));
+  for (MessageType& found_type : found_types) {
+    if (type_cache_enabled_) {
+      type_cache_.Insert(found_type);
+    }
+    types->push_back(std::move(found_type));
+  }
+  return absl::OkStatus();
+}
+
+template <typename MessageType>
+absl::Status RDBMSMetadataAccessObject::FindTypeProperties(
+    std::vector<MessageType>* types) {
+  if (types->empty()) {
+    return absl::OkStatus();
+  }
+  // The properties of all the types are read with a single query.
+  std::vector<int64> type_ids;
+  absl::flat_hash_map<int64, MessageType*> types_by_id;
+  for (MessageType& type : *types) {
+    type_ids.push_back(type.id());
+    types_by_id[type.id()] = &type;
+  }
+  RecordSet property_record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectPropertiesByTypeIDs(type_ids, &property_record_set));
+  for (const RecordSet::Record& record : property_record_set.records()) {
+    int64 type_id;
+    int data_type;
+    if (record.values_size() < 3 ||
+        !absl::SimpleAtoi(record.values(0), &type_id) ||
+        !absl::SimpleAtoi(record.values(2), &data_type) ||
+        !PropertyType_IsValid(data_type) || !types_by_id.contains(type_id)) {
+      return absl::InternalError(absl::StrCat(
+          "Cannot parse the type property: ", record.DebugString()));
+    }
+    (*types_by_id[type_id]->mutable_properties())[record.values(1)] =
+        static_cast<PropertyType>(data_type);
+  }
+  return absl::OkStatus();
+}
+
 // Generates a query to find all type instances.
 absl::Status RDBMSMetadataAccessObject::GenerateFindAllTypeInstancesQuery(
     const TypeKind type_kind, RecordSet* record_set) {
@@ -748,6 +1200,8 @@ template <typename MessageType>
 absl::Status RDBMSMetadataAccessObject::FindTypesImpl(
     absl::Span<const int64> type_ids,
     std::vector<MessageType>& types) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::FindTypes");
+  span.AddAttribute("mlmd.kind", MessageType::descriptor()->name());
   if (type_ids.empty()) {
     return absl::InvalidArgumentError("ids cannot be empty");
   }
@@ -785,6 +1239,14 @@ absl::Status RDBMSMetadataAccessObject::FindTypesImpl(
 template <typename MessageType>
 absl::Status RDBMSMetadataAccessObject::FindTypeImpl(int64 type_id,
                                                      MessageType* type) {
+  MLMD_RETURN_IF_ERROR(ValidateTypeCache());
+  if (type_cache_enabled_) {
+    const MessageType* cached_type = type_cache_.Find<MessageType>(type_id);
+    if (cached_type != nullptr) {
+      *type = *cached_type;
+      return absl::OkStatus();
+    }
+  }
   const TypeKind type_kind = ResolveTypeKind(type);
   RecordSet record_set;
   MLMD_RETURN_IF_ERROR(
@@ -795,6 +1257,9 @@ absl::Status RDBMSMetadataAccessObject::FindTypeImpl(int64 type_id,
     return absl::NotFoundError(
         absl::StrCat("No type found for query, type_id: ", type_id));
   }
+  if (type_cache_enabled_) {
+    type_cache_.Insert(types[0]);
+  }
   *type = std::move(types[0]);
   return absl::OkStatus();
 }
@@ -803,6 +1268,15 @@ template <typename MessageType>
 absl::Status RDBMSMetadataAccessObject::FindTypeImpl(
     absl::string_view name, absl::optional<absl::string_view> version,
     MessageType* type) {
+  MLMD_RETURN_IF_ERROR(ValidateTypeCache());
+  if (type_cache_enabled_) {
+    const MessageType* cached_type =
+        type_cache_.Find<MessageType>(name, version);
+    if (cached_type != nullptr) {
+      *type = *cached_type;
+      return absl::OkStatus();
+    }
+  }
   const TypeKind type_kind = ResolveTypeKind(type);
   RecordSet record_set;
   MLMD_RETURN_IF_ERROR(executor_->SelectTypeByNameAndVersion(
@@ -814,22 +1288,75 @@ absl::Status RDBMSMetadataAccessObject::FindTypeImpl(
         absl::StrCat("No type found for query, name: `", name, "`, version: `",
                      version ? *version : "nullopt", "`"));
   }
+  if (type_cache_enabled_) {
+    type_cache_.Insert(types[0]);
+  }
   *type = std::move(types[0]);
   return absl::OkStatus();
 }
 
-// Finds all type instances of the type `MessageType`.
+// Finds all type instances of the type `MessageType`, which are also inserted
+// to the type cache, so that reading all types warms it up, e.g., by
+// MetadataStorePool::WarmUp.
 // Returns detailed INTERNAL error, if query execution fails.
 template <typename MessageType>
 absl::Status RDBMSMetadataAccessObject::FindAllTypeInstancesImpl(
     std::vector<MessageType>* types) {
+  MLMD_RETURN_IF_ERROR(ValidateTypeCache());
   MessageType type;
   const TypeKind type_kind = ResolveTypeKind(&type);
   RecordSet record_set;
   MLMD_RETURN_IF_ERROR(
       GenerateFindAllTypeInstancesQuery(type_kind, &record_set));
 
-  return FindTypesFromRecordSet(record_set, types);
+  MLMD_RETURN_IF_ERROR(FindTypesFromRecordSet(record_set, types));
+  if (type_cache_enabled_) {
+    for (const MessageType& found_type : *types) {
+      type_cache_.Insert(found_type);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::ValidateTypeCache() {
+  const int64 transaction_id = executor_->GetTransactionId();
+  if (type_cache_transaction_id_ == transaction_id) {
+    return absl::OkStatus();
+  }
+  type_cache_transaction_id_ = transaction_id;
+  type_cache_enabled_ = false;
+  int64 type_generation = 0;
+  const absl::Status status = executor_->SelectTypeGeneration(&type_generation);
+  if (absl::IsFailedPrecondition(status)) {
+    // The earlier schema has no type generation to validate the cache with.
+    type_cache_.Clear();
+    type_cache_generation_ = absl::nullopt;
+    return absl::OkStatus();
+  }
+  MLMD_RETURN_IF_ERROR(status);
+  if (type_cache_generation_ != type_generation) {
+    type_cache_.Clear();
+    type_cache_generation_ = type_generation;
+  }
+  type_cache_enabled_ = true;
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::InvalidateTypeCache() {
+  type_cache_.Clear();
+  type_cache_generation_ = absl::nullopt;
+  // The types changed in the current transaction are not cached, as the
+  // transaction may roll back.
+  type_cache_transaction_id_ = executor_->GetTransactionId();
+  type_cache_enabled_ = false;
+  return executor_->IncrementTypeGeneration();
+}
+
+void RDBMSMetadataAccessObject::ResetTypeCache() {
+  type_cache_.Clear();
+  type_cache_generation_ = absl::nullopt;
+  type_cache_transaction_id_ = absl::nullopt;
+  type_cache_enabled_ = false;
 }
 
 // Updates an existing type. A type is one of {ArtifactType, ExecutionType,
@@ -841,6 +1368,8 @@ absl::Status RDBMSMetadataAccessObject::FindAllTypeInstancesImpl(
 // Returns detailed INTERNAL error, if query execution fails.
 template <typename Type>
 absl::Status RDBMSMetadataAccessObject::UpdateTypeImpl(const Type& type) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::UpdateType");
+  span.AddAttribute("mlmd.kind", Type::descriptor()->name());
   if (!type.has_name()) {
     return absl::InvalidArgumentError("No type name is specified.");
   }
@@ -856,6 +1385,7 @@ absl::Status RDBMSMetadataAccessObject::UpdateTypeImpl(const Type& type) {
   // updates the list of type properties
   const google::protobuf::Map<std::string, PropertyType>& stored_properties =
       stored_type.properties();
+  bool is_type_changed = false;
   for (const auto& p : type.properties()) {
     const std::string& property_name = p.first;
     const PropertyType property_type = p.second;
@@ -873,6 +1403,10 @@ absl::Status RDBMSMetadataAccessObject::UpdateTypeImpl(const Type& type) {
       }
       continue;
     }
+    if (!is_type_changed) {
+      MLMD_RETURN_IF_ERROR(InvalidateTypeCache());
+      is_type_changed = true;
+    }
     MLMD_RETURN_IF_ERROR(executor_->InsertTypeProperty(
         stored_type.id(), property_name, property_type));
   }
@@ -928,6 +1462,8 @@ absl::Status RDBMSMetadataAccessObject::FindParentTypesByTypeIdImpl(
 template <typename Node, typename NodeType>
 absl::Status RDBMSMetadataAccessObject::CreateNodeImpl(const Node& node,
                                                        int64* node_id) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::CreateNode");
+  span.AddAttribute("mlmd.kind", Node::descriptor()->name());
   // clear node id
   *node_id = 0;
   // validate type
@@ -959,13 +1495,101 @@ absl::Status RDBMSMetadataAccessObject::CreateNodeImpl(const Node& node,
   MLMD_RETURN_IF_ERROR(ModifyProperties<NodeType>(
       node.custom_properties(), prev_properties, *node_id,
       /*is_custom_property=*/true, num_changed_custom_properties));
-  return absl::OkStatus();
+  return executor_->InsertChangeLogEntries(NodeChangeLogEntries(
+      ChangeLogKind(node), ChangeLogEntry::CREATED, {*node_id}));
+}
+
+// Creates a `Node`, which is one of {`Artifact`, `Context`}, unless its type
+// has a node with the same name. The node and its type are validated as in
+// CreateNodeImpl, and the properties and the change log entry are only written
+// for a created node.
+// Returns INVALID_ARGUMENT error, if the node has no name, or does not align
+// with its type.
+// Returns detailed INTERNAL error, if query execution fails.
+template <typename Node, typename NodeType>
+absl::Status RDBMSMetadataAccessObject::CreateNodeIfNotExistImpl(
+    const Node& node, int64* node_id, bool* is_created) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::CreateNodeIfNotExist");
+  span.AddAttribute("mlmd.kind", Node::descriptor()->name());
+  *node_id = 0;
+  *is_created = false;
+  if (!node.has_type_id())
+    return absl::InvalidArgumentError("Type id is missing.");
+  if (!node.has_name() || node.name().empty()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Node name should not be empty: ",
+                     node.ShortDebugString()));
+  }
+  NodeType node_type;
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(FindTypeImpl(node.type_id(), &node_type),
+                                    "Cannot find type for ",
+                                    node.ShortDebugString());
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(ValidatePropertiesWithType(node, node_type),
+                                    "Cannot validate properties of ",
+                                    node.ShortDebugString());
+
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+      CreateBasicNodeIfNotExist(node, node_id, is_created),
+      "Cannot create node for ", node.ShortDebugString());
+  if (!*is_created) {
+    return absl::OkStatus();
+  }
+  MLMD_RETURN_IF_ERROR(CreateNodeProperties({*node_id}, {node}));
+  return executor_->InsertChangeLogEntries(NodeChangeLogEntries(
+      ChangeLogKind(node), ChangeLogEntry::CREATED, {*node_id}));
+}
+
+// Creates a batch of `Node`s, which is one of {`Artifact`, `Execution`,
+// `Context`}, then returns the assigned node ids. The nodes and their
+// properties are inserted with multi-row insert queries.
+// Returns INVALID_ARGUMENT error, if any node does not align with its type.
+// Returns detailed INTERNAL error, if query execution fails.
+template <typename Node, typename NodeType>
+absl::Status RDBMSMetadataAccessObject::CreateNodesImpl(
+    const absl::Span<const Node> nodes, std::vector<int64>* node_ids) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::CreateNodes");
+  span.AddAttribute("mlmd.kind", Node::descriptor()->name());
+  node_ids->clear();
+  // validate the nodes, and find each of their types once
+  absl::flat_hash_map<int64, NodeType> node_types;
+  for (const Node& node : nodes) {
+    if (!node.has_type_id())
+      return absl::InvalidArgumentError("Type id is missing.");
+    auto it = node_types.find(node.type_id());
+    if (it == node_types.end()) {
+      NodeType node_type;
+      MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+          FindTypeImpl(node.type_id(), &node_type), "Cannot find type for ",
+          node.ShortDebugString());
+      it = node_types.insert({node.type_id(), node_type}).first;
+    }
+    MLMD_RETURN_WITH_CONTEXT_IF_ERROR(
+        ValidatePropertiesWithType(node, it->second),
+        "Cannot validate properties of ", node.ShortDebugString());
+  }
+  if (nodes.empty()) {
+    return absl::OkStatus();
+  }
+
+  // insert the nodes and get the assigned ids
+  MLMD_RETURN_WITH_CONTEXT_IF_ERROR(CreateBasicNodes(nodes, node_ids),
+                                    "Cannot create a batch of ", nodes.size(),
+                                    " nodes: ");
+
+  // insert properties
+  MLMD_RETURN_IF_ERROR(CreateNodeProperties(*node_ids, nodes));
+  return executor_->InsertChangeLogEntries(NodeChangeLogEntries(
+      ChangeLogKind(nodes.front()), ChangeLogEntry::CREATED, *node_ids));
 }
 
 template <typename Node>
 absl::Status RDBMSMetadataAccessObject::FindNodesImpl(
     const absl::Span<const int64> node_ids, const bool skipped_ids_ok,
-    std::vector<Node>& nodes) {
+    std::vector<Node>& nodes,
+    const ListOperationOptions::PropertyProjection& projection,
+    const bool include_archived) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::FindNodes");
+  span.AddAttribute("mlmd.kind", Node::descriptor()->name());
   if (node_ids.empty()) {
     return absl::InvalidArgumentError("ids cannot be empty");
   }
@@ -974,17 +1598,22 @@ absl::Status RDBMSMetadataAccessObject::FindNodesImpl(
     return absl::InvalidArgumentError("nodes parameter is not empty");
   }
 
-  RecordSet node_record_set;
-  RecordSet properties_record_set;
+  // The intermediate record sets are allocated on an arena, so that their
+  // records are allocated in blocks and freed at once.
+  google::protobuf::Arena arena;
+  RecordSet& node_record_set =
+      *google::protobuf::Arena::CreateMessage<RecordSet>(&arena);
+  RecordSet& properties_record_set =
+      *google::protobuf::Arena::CreateMessage<RecordSet>(&arena);
 
-  MLMD_RETURN_IF_ERROR(RetrieveNodesById<Node>(node_ids, &node_record_set,
-                                               &properties_record_set));
+  MLMD_RETURN_IF_ERROR(RetrieveNodesById<Node>(
+      node_ids, projection, &node_record_set, &properties_record_set));
 
   MLMD_RETURN_IF_ERROR(ParseRecordSetToMessageArray(node_record_set, &nodes));
 
   // if there are properties associated with the nodes, parse the returned
   // values.
-  if (!properties_record_set.records().empty()) {
+  if (NumRows(properties_record_set) > 0) {
     // First we build a hash map from node ids to Node messages, to
     // facilitate lookups.
     absl::flat_hash_map<int64, typename std::vector<Node>::iterator> node_by_id;
@@ -992,17 +1621,33 @@ absl::Status RDBMSMetadataAccessObject::FindNodesImpl(
       node_by_id.insert({i->id(), i});
     }
 
-    CHECK_EQ(properties_record_set.column_names_size(), 6);
-    for (const RecordSet::Record& record : properties_record_set.records()) {
+    // The proto_value column is selected since v14.
+    CHECK_GE(properties_record_set.column_names_size(), 6);
+    for (int row = 0; row < NumRows(properties_record_set); row++) {
       // Match the record against a node in the hash map.
-      int64 node_id;
-      CHECK(absl::SimpleAtoi(record.values(0), &node_id));
+      const int64 node_id = GetInt64Value(properties_record_set, row, 0);
       auto iter = node_by_id.find(node_id);
       CHECK(iter != node_by_id.end());
       Node& node = *iter->second;
 
-      MLMD_RETURN_IF_ERROR(PopulateNodeProperties(record, node));
+      MLMD_RETURN_IF_ERROR(
+          PopulateNodeProperties(properties_record_set, row, node));
+    }
+  }
+
+  if (include_archived && node_ids.size() != nodes.size()) {
+    absl::flat_hash_set<int64> found_ids;
+    for (const Node& node : nodes) {
+      found_ids.insert(node.id());
     }
+    std::vector<int64> missing_ids;
+    for (const int64 id : node_ids) {
+      if (!found_ids.contains(id)) {
+        missing_ids.push_back(id);
+      }
+    }
+    MLMD_RETURN_IF_ERROR(
+        RetrieveArchivedNodesById(missing_ids, projection, nodes));
   }
 
   if (node_ids.size() != nodes.size()) {
@@ -1023,13 +1668,31 @@ absl::Status RDBMSMetadataAccessObject::FindNodesImpl(
   return absl::OkStatus();
 }
 
+template <typename Node>
+absl::Status RDBMSMetadataAccessObject::FindNodesOrderedById(
+    std::vector<int64> node_ids, std::vector<Node>* nodes) {
+  std::sort(node_ids.begin(), node_ids.end());
+  node_ids.erase(std::unique(node_ids.begin(), node_ids.end()),
+                 node_ids.end());
+  if (node_ids.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_RETURN_IF_ERROR(
+      FindNodesImpl(node_ids, /*skipped_ids_ok=*/false, *nodes));
+  std::sort(nodes->begin(), nodes->end(),
+            [](const Node& a, const Node& b) { return a.id() < b.id(); });
+  return absl::OkStatus();
+}
+
 template <typename Node>
 absl::Status RDBMSMetadataAccessObject::FindNodeImpl(const int64 node_id,
                                                      Node* node) {
   std::vector<Node> nodes;
-  MLMD_RETURN_IF_ERROR(
-      FindNodesImpl({node_id}, /*skipped_ids_ok=*/true, nodes));
-  *node = nodes.at(0);
+  MLMD_RETURN_IF_ERROR(FindNodesImpl(
+      {node_id}, /*skipped_ids_ok=*/true, nodes,
+      ListOperationOptions::PropertyProjection::default_instance(),
+      /*include_archived=*/false));
+  *node = std::move(nodes.at(0));
 
   return absl::OkStatus();
 }
@@ -1040,6 +1703,8 @@ absl::Status RDBMSMetadataAccessObject::FindNodeImpl(const int64 node_id,
 // Returns detailed INTERNAL error, if query execution fails.
 template <typename Node, typename NodeType>
 absl::Status RDBMSMetadataAccessObject::UpdateNodeImpl(const Node& node) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::UpdateNode");
+  span.AddAttribute("mlmd.kind", Node::descriptor()->name());
   // validate node
   if (!node.has_id()) return absl::InvalidArgumentError("No id is given.");
 
@@ -1084,13 +1749,15 @@ absl::Status RDBMSMetadataAccessObject::UpdateNodeImpl(const Node& node) {
   if (!diff.Compare(node, stored_node) ||
       num_changed_properties + num_changed_custom_properties > 0) {
     MLMD_RETURN_IF_ERROR(RunNodeUpdate(node));
+    MLMD_RETURN_IF_ERROR(executor_->InsertChangeLogEntries(NodeChangeLogEntries(
+        ChangeLogKind(node), ChangeLogEntry::UPDATED, {node.id()})));
   }
   return absl::OkStatus();
 }
 
 // Takes a record set that has one record per event, parses them into Event
-// objects, gets the paths for the events from the database using collected
-// event ids, and assign paths to each corresponding event.
+// objects with their paths. Before v13, the paths are not in the record set,
+// and they are read from the EventPath table using the collected event ids.
 // Returns INVALID_ARGUMENT error, if the `events` is null.
 absl::Status RDBMSMetadataAccessObject::FindEventsFromRecordSet(
     const RecordSet& event_record_set, std::vector<Event>* events) {
@@ -1180,6 +1847,69 @@ absl::Status RDBMSMetadataAccessObject::FindTypes(
   return FindAllTypeInstancesImpl(context_types);
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateTypes(
+    const absl::Span<const ArtifactType> types, std::vector<int64>* type_ids) {
+  return CreateTypesImpl(types, type_ids);
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateTypes(
+    const absl::Span<const ExecutionType> types, std::vector<int64>* type_ids) {
+  return CreateTypesImpl(types, type_ids);
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateTypes(
+    const absl::Span<const ContextType> types, std::vector<int64>* type_ids) {
+  return CreateTypesImpl(types, type_ids);
+}
+
+absl::Status RDBMSMetadataAccessObject::AddTypeProperties(
+    const absl::Span<const ArtifactType> types) {
+  return AddTypePropertiesImpl(types);
+}
+
+absl::Status RDBMSMetadataAccessObject::AddTypeProperties(
+    const absl::Span<const ExecutionType> types) {
+  return AddTypePropertiesImpl(types);
+}
+
+absl::Status RDBMSMetadataAccessObject::AddTypeProperties(
+    const absl::Span<const ContextType> types) {
+  return AddTypePropertiesImpl(types);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindTypesByNames(
+    const absl::Span<const std::string> names,
+    std::vector<ArtifactType>* types) {
+  return FindTypesByNamesImpl(names, types);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindTypesByNames(
+    const absl::Span<const std::string> names,
+    std::vector<ExecutionType>* types) {
+  return FindTypesByNamesImpl(names, types);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindTypesByNames(
+    const absl::Span<const std::string> names,
+    std::vector<ContextType>* types) {
+  return FindTypesByNamesImpl(names, types);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindTypesByIds(
+    const absl::Span<const int64> type_ids, std::vector<ArtifactType>* types) {
+  return FindTypesByIdsImpl(type_ids, types);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindTypesByIds(
+    const absl::Span<const int64> type_ids, std::vector<ExecutionType>* types) {
+  return FindTypesByIdsImpl(type_ids, types);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindTypesByIds(
+    const absl::Span<const int64> type_ids, std::vector<ContextType>* types) {
+  return FindTypesByIdsImpl(type_ids, types);
+}
+
 absl::Status RDBMSMetadataAccessObject::FindTypeByNameAndVersion(
     absl::string_view name, absl::optional<absl::string_view> version,
     ArtifactType* artifact_type) {
@@ -1250,7 +1980,8 @@ absl::Status RDBMSMetadataAccessObject::CreateParentTypeInheritanceLink(
   if (IsUniqueConstraintViolated(status)) {
     return absl::AlreadyExistsError("The ParentType already exists.");
   }
-  return status;
+  MLMD_RETURN_IF_ERROR(status);
+  return InvalidateTypeCache();
 }
 
 absl::Status RDBMSMetadataAccessObject::CreateParentTypeInheritanceLink(
@@ -1267,7 +1998,8 @@ absl::Status RDBMSMetadataAccessObject::CreateParentTypeInheritanceLink(
   if (IsUniqueConstraintViolated(status)) {
     return absl::AlreadyExistsError("The ParentType already exists.");
   }
-  return status;
+  MLMD_RETURN_IF_ERROR(status);
+  return InvalidateTypeCache();
 }
 
 absl::Status RDBMSMetadataAccessObject::CreateParentTypeInheritanceLink(
@@ -1285,12 +2017,14 @@ absl::Status RDBMSMetadataAccessObject::CreateParentTypeInheritanceLink(
   if (IsUniqueConstraintViolated(status)) {
     return absl::AlreadyExistsError("The ParentType already exists.");
   }
-  return status;
+  MLMD_RETURN_IF_ERROR(status);
+  return InvalidateTypeCache();
 }
 
 absl::Status RDBMSMetadataAccessObject::DeleteParentTypeInheritanceLink(
     int64 type_id, int64 parent_type_id) {
-  return executor_->DeleteParentType(type_id, parent_type_id);
+  MLMD_RETURN_IF_ERROR(executor_->DeleteParentType(type_id, parent_type_id));
+  return InvalidateTypeCache();
 }
 
 absl::Status RDBMSMetadataAccessObject::FindParentTypesByTypeId(
@@ -1323,6 +2057,25 @@ absl::Status RDBMSMetadataAccessObject::CreateArtifact(const Artifact& artifact,
   return status;
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateArtifacts(
+    const absl::Span<const Artifact> artifacts,
+    std::vector<int64>* artifact_ids) {
+  const absl::Status status =
+      CreateNodesImpl<Artifact, ArtifactType>(artifacts, artifact_ids);
+  if (IsUniqueConstraintViolated(status)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Some of the given nodes already exist: ", status.ToString()));
+  }
+  return status;
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateArtifactIfNotExist(
+    const Artifact& artifact, int64* artifact_id, bool* is_created) {
+  return CreateNodeIfNotExistImpl<Artifact, ArtifactType>(artifact,
+                                                          artifact_id,
+                                                          is_created);
+}
+
 absl::Status RDBMSMetadataAccessObject::CreateExecution(
     const Execution& execution, int64* execution_id) {
   const absl::Status& status =
@@ -1335,6 +2088,18 @@ absl::Status RDBMSMetadataAccessObject::CreateExecution(
   return status;
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateExecutions(
+    const absl::Span<const Execution> executions,
+    std::vector<int64>* execution_ids) {
+  const absl::Status status =
+      CreateNodesImpl<Execution, ExecutionType>(executions, execution_ids);
+  if (IsUniqueConstraintViolated(status)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Some of the given nodes already exist: ", status.ToString()));
+  }
+  return status;
+}
+
 absl::Status RDBMSMetadataAccessObject::CreateContext(const Context& context,
                                                       int64* context_id) {
   const absl::Status& status =
@@ -1347,6 +2112,23 @@ absl::Status RDBMSMetadataAccessObject::CreateContext(const Context& context,
   return status;
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateContexts(
+    const absl::Span<const Context> contexts, std::vector<int64>* context_ids) {
+  const absl::Status status =
+      CreateNodesImpl<Context, ContextType>(contexts, context_ids);
+  if (IsUniqueConstraintViolated(status)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Some of the given nodes already exist: ", status.ToString()));
+  }
+  return status;
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateContextIfNotExist(
+    const Context& context, int64* context_id, bool* is_created) {
+  return CreateNodeIfNotExistImpl<Context, ContextType>(context, context_id,
+                                                        is_created);
+}
+
 absl::Status RDBMSMetadataAccessObject::FindArtifactsById(
     const absl::Span<const int64> artifact_ids,
     std::vector<Artifact>* artifacts) {
@@ -1390,6 +2172,7 @@ absl::Status RDBMSMetadataAccessObject::UpdateContext(const Context& context) {
 
 absl::Status RDBMSMetadataAccessObject::CreateEvent(const Event& event,
                                                     int64* event_id) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::CreateEvent");
   // validate the given event
   if (!event.has_artifact_id())
     return absl::InvalidArgumentError("No artifact id is specified.");
@@ -1404,36 +2187,82 @@ absl::Status RDBMSMetadataAccessObject::CreateEvent(const Event& event,
   MLMD_RETURN_IF_ERROR(
       executor_->SelectExecutionsByID({event.execution_id()}, &executions));
   RecordSet record_set;
-  if (artifacts.records_size() == 0)
+  if (NumRows(artifacts) == 0)
     return absl::InvalidArgumentError(
         absl::StrCat("No artifact with the given id ", event.artifact_id()));
-  if (executions.records_size() == 0)
+  if (NumRows(executions) == 0)
     return absl::InvalidArgumentError(
         absl::StrCat("No execution with the given id ", event.execution_id()));
 
-  // insert an event and get its given id
-  int64 event_time = event.has_milliseconds_since_epoch()
-                         ? event.milliseconds_since_epoch()
-                         : absl::ToUnixMillis(absl::Now());
-
-  const absl::Status status =
-      executor_->InsertEvent(event.artifact_id(), event.execution_id(),
-                             event.type(), event_time, event_id);
+  // insert an event with its path and get its given id
+  Event new_event = event;
+  if (!new_event.has_milliseconds_since_epoch()) {
+    new_event.set_milliseconds_since_epoch(absl::ToUnixMillis(absl::Now()));
+  }
+  std::vector<int64> event_ids;
+  const absl::Status status = executor_->InsertEvents({new_event}, &event_ids);
   if (IsUniqueConstraintViolated(status)) {
     return absl::AlreadyExistsError(
         absl::StrCat("Given event already exists: ", event.DebugString(),
                      status.ToString()));
   }
-  // insert event paths
-  for (const Event::Path::Step& step : event.path().steps()) {
-    // step value oneof
-    MLMD_RETURN_IF_ERROR(executor_->InsertEventPath(*event_id, step));
+  MLMD_RETURN_IF_ERROR(status);
+  *event_id = event_ids[0];
+  MLMD_RETURN_IF_ERROR(executor_->InsertEventPaths(event_ids, {new_event}));
+  MLMD_RETURN_IF_ERROR(executor_->InsertArtifactDerivations({*event_id}));
+  return executor_->InsertChangeLogEntries(EventChangeLogEntries({event}));
+}
+
+absl::Status RDBMSMetadataAccessObject::CreateEvents(
+    const absl::Span<const Event> events, std::vector<int64>* event_ids) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::CreateEvents");
+  event_ids->clear();
+  if (events.empty()) {
+    return absl::OkStatus();
   }
-  return absl::OkStatus();
+  // validate the given events, and set the event time if not given.
+  const int64 now = absl::ToUnixMillis(absl::Now());
+  std::vector<Event> new_events(events.begin(), events.end());
+  absl::flat_hash_set<int64> artifact_ids, execution_ids;
+  for (Event& event : new_events) {
+    if (!event.has_artifact_id())
+      return absl::InvalidArgumentError("No artifact id is specified.");
+    if (!event.has_execution_id())
+      return absl::InvalidArgumentError("No execution id is specified.");
+    if (!event.has_type() || event.type() == Event::UNKNOWN)
+      return absl::InvalidArgumentError("No event type is specified.");
+    if (!event.has_milliseconds_since_epoch()) {
+      event.set_milliseconds_since_epoch(now);
+    }
+    artifact_ids.insert(event.artifact_id());
+    execution_ids.insert(event.execution_id());
+  }
+  RecordSet artifacts;
+  MLMD_RETURN_IF_ERROR(executor_->SelectArtifactsByID(
+      std::vector<int64>(artifact_ids.begin(), artifact_ids.end()),
+      &artifacts));
+  MLMD_RETURN_IF_ERROR(CheckNodesFound(artifact_ids, artifacts, "artifact"));
+  RecordSet executions;
+  MLMD_RETURN_IF_ERROR(executor_->SelectExecutionsByID(
+      std::vector<int64>(execution_ids.begin(), execution_ids.end()),
+      &executions));
+  MLMD_RETURN_IF_ERROR(
+      CheckNodesFound(execution_ids, executions, "execution"));
+
+  const absl::Status status = executor_->InsertEvents(new_events, event_ids);
+  if (IsUniqueConstraintViolated(status)) {
+    return absl::AlreadyExistsError(absl::StrCat(
+        "Some of the given events already exist: ", status.ToString()));
+  }
+  MLMD_RETURN_IF_ERROR(status);
+  MLMD_RETURN_IF_ERROR(executor_->InsertEventPaths(*event_ids, new_events));
+  MLMD_RETURN_IF_ERROR(executor_->InsertArtifactDerivations(*event_ids));
+  return executor_->InsertChangeLogEntries(EventChangeLogEntries(new_events));
 }
 
 absl::Status RDBMSMetadataAccessObject::FindEventsByArtifacts(
     const std::vector<int64>& artifact_ids, std::vector<Event>* events) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::FindEventsByArtifacts");
   if (events == nullptr) {
     return absl::InvalidArgumentError("Given events is NULL.");
   }
@@ -1442,6 +2271,12 @@ absl::Status RDBMSMetadataAccessObject::FindEventsByArtifacts(
   if (!artifact_ids.empty()) {
     MLMD_RETURN_IF_ERROR(
         executor_->SelectEventByArtifactIDs(artifact_ids, &event_record_set));
+    RecordSet archived_event_record_set;
+    MLMD_RETURN_IF_ERROR(executor_->SelectArchivedEventsByArtifactIDs(
+        artifact_ids, &archived_event_record_set));
+    absl::c_move(*archived_event_record_set.mutable_records(),
+                 google::protobuf::RepeatedFieldBackInserter(
+                     event_record_set.mutable_records()));
   }
 
   if (event_record_set.records_size() == 0) {
@@ -1452,6 +2287,7 @@ absl::Status RDBMSMetadataAccessObject::FindEventsByArtifacts(
 
 absl::Status RDBMSMetadataAccessObject::FindEventsByExecutions(
     const std::vector<int64>& execution_ids, std::vector<Event>* events) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::FindEventsByExecutions");
   if (events == nullptr) {
     return absl::InvalidArgumentError("Given events is NULL.");
   }
@@ -1460,6 +2296,12 @@ absl::Status RDBMSMetadataAccessObject::FindEventsByExecutions(
   if (!execution_ids.empty()) {
     MLMD_RETURN_IF_ERROR(
         executor_->SelectEventByExecutionIDs(execution_ids, &event_record_set));
+    RecordSet archived_event_record_set;
+    MLMD_RETURN_IF_ERROR(executor_->SelectArchivedEventsByExecutionIDs(
+        execution_ids, &archived_event_record_set));
+    absl::c_move(*archived_event_record_set.mutable_records(),
+                 google::protobuf::RepeatedFieldBackInserter(
+                     event_record_set.mutable_records()));
   }
 
   if (event_record_set.records_size() == 0) {
@@ -1468,14 +2310,104 @@ absl::Status RDBMSMetadataAccessObject::FindEventsByExecutions(
   return FindEventsFromRecordSet(event_record_set, events);
 }
 
+template <typename ListEvents>
+absl::Status RDBMSMetadataAccessObject::ListEventsImpl(
+    const ListOperationOptions& options, ListEvents list_events,
+    std::vector<Event>* events, std::string* next_page_token) {
+  if (events == nullptr) {
+    return absl::InvalidArgumentError("Given events is NULL.");
+  }
+  if (options.max_result_size() <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("max_result_size field value is required to be greater "
+                     "than 0 and less than or equal to 100. Set value:",
+                     options.max_result_size()));
+  }
+  MLMD_RETURN_IF_ERROR(ValidateBulkExportListOperationOptions(options));
+  *next_page_token = "";
+  // Retrieving page of size 1 greater that max_result_size to detect if this
+  // is the last page.
+  ListOperationOptions updated_options = options;
+  updated_options.set_max_result_size(options.max_result_size() + 1);
+  RecordSet event_record_set;
+  MLMD_RETURN_IF_ERROR(list_events(updated_options, &event_record_set));
+  if (event_record_set.records_size() > options.max_result_size()) {
+    // Removing the extra event retrieved for last page detection.
+    event_record_set.mutable_records()->RemoveLast();
+    // The last event of the page has the (`id`, `milliseconds_since_epoch`)
+    // offsets of the next page.
+    const int last_row = event_record_set.records_size() - 1;
+    const int64 last_id = GetInt64Value(event_record_set, last_row, 0);
+    ListOperationNextPageToken list_operation_next_page_token;
+    list_operation_next_page_token.set_id_offset(last_id);
+    list_operation_next_page_token.set_field_offset(
+        options.order_by_field().field() ==
+                ListOperationOptions::OrderByField::CREATE_TIME
+            ? GetInt64Value(event_record_set, last_row, 4)
+            : last_id);
+    MLMD_RETURN_IF_ERROR(EncodeListOperationNextPageToken(
+        options, list_operation_next_page_token, next_page_token));
+  }
+  if (event_record_set.records_size() == 0) {
+    return absl::OkStatus();
+  }
+  return FindEventsFromRecordSet(event_record_set, events);
+}
+
+absl::Status RDBMSMetadataAccessObject::ListEventsByArtifacts(
+    const absl::Span<const int64> artifact_ids,
+    const absl::Span<const Event::Type> event_types,
+    const ListOperationOptions& options, std::vector<Event>* events,
+    std::string* next_page_token) {
+  return ListEventsImpl(
+      options,
+      [&](const ListOperationOptions& page_options, RecordSet* record_set) {
+        return executor_->ListEventsByArtifactIDsUsingOptions(
+            page_options, artifact_ids, event_types, record_set);
+      },
+      events, next_page_token);
+}
+
+absl::Status RDBMSMetadataAccessObject::ListEventsByExecutions(
+    const absl::Span<const int64> execution_ids,
+    const absl::Span<const Event::Type> event_types,
+    const ListOperationOptions& options, std::vector<Event>* events,
+    std::string* next_page_token) {
+  return ListEventsImpl(
+      options,
+      [&](const ListOperationOptions& page_options, RecordSet* record_set) {
+        return executor_->ListEventsByExecutionIDsUsingOptions(
+            page_options, execution_ids, event_types, record_set);
+      },
+      events, next_page_token);
+}
+
+absl::Status RDBMSMetadataAccessObject::ListEventsByTimeRange(
+    const int64 min_milliseconds_since_epoch,
+    const absl::optional<int64> max_milliseconds_since_epoch,
+    const absl::Span<const Event::Type> event_types,
+    const ListOperationOptions& options, std::vector<Event>* events,
+    std::string* next_page_token) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::ListEventsByTimeRange");
+  return ListEventsImpl(
+      options,
+      [&](const ListOperationOptions& page_options, RecordSet* record_set) {
+        return executor_->ListEventsByTimeRangeUsingOptions(
+            page_options, min_milliseconds_since_epoch,
+            max_milliseconds_since_epoch, event_types, record_set);
+      },
+      events, next_page_token);
+}
+
 absl::Status RDBMSMetadataAccessObject::CreateAssociation(
     const Association& association, int64* association_id) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::CreateAssociation");
   if (!association.has_context_id())
     return absl::InvalidArgumentError("No context id is specified.");
   RecordSet context_id_header;
   MLMD_RETURN_IF_ERROR(executor_->SelectContextsByID({association.context_id()},
                                                      &context_id_header));
-  if (context_id_header.records_size() == 0)
+  if (NumRows(context_id_header) == 0)
     return absl::InvalidArgumentError("Context id not found.");
 
   if (!association.has_execution_id())
@@ -1483,7 +2415,7 @@ absl::Status RDBMSMetadataAccessObject::CreateAssociation(
   RecordSet execution_id_header;
   MLMD_RETURN_IF_ERROR(executor_->SelectExecutionsByID(
       {association.execution_id()}, &execution_id_header));
-  if (execution_id_header.records_size() == 0)
+  if (NumRows(execution_id_header) == 0)
     return absl::InvalidArgumentError("Execution id not found.");
 
   absl::Status status = executor_->InsertAssociation(
@@ -1498,11 +2430,40 @@ absl::Status RDBMSMetadataAccessObject::CreateAssociation(
 }
 
 
+absl::Status RDBMSMetadataAccessObject::CreateAssociationsIfNotExist(
+    const absl::Span<const Association> associations) {
+  ScopedTraceSpan span(
+      "RDBMSMetadataAccessObject::CreateAssociationsIfNotExist");
+  if (associations.empty()) {
+    return absl::OkStatus();
+  }
+  absl::flat_hash_set<int64> context_ids, execution_ids;
+  for (const Association& association : associations) {
+    if (!association.has_context_id())
+      return absl::InvalidArgumentError("No context id is specified.");
+    if (!association.has_execution_id())
+      return absl::InvalidArgumentError("No execution id is specified");
+    context_ids.insert(association.context_id());
+    execution_ids.insert(association.execution_id());
+  }
+  RecordSet contexts;
+  MLMD_RETURN_IF_ERROR(executor_->SelectContextsByID(
+      std::vector<int64>(context_ids.begin(), context_ids.end()), &contexts));
+  MLMD_RETURN_IF_ERROR(CheckNodesFound(context_ids, contexts, "context"));
+  RecordSet executions;
+  MLMD_RETURN_IF_ERROR(executor_->SelectExecutionsByID(
+      std::vector<int64>(execution_ids.begin(), execution_ids.end()),
+      &executions));
+  MLMD_RETURN_IF_ERROR(
+      CheckNodesFound(execution_ids, executions, "execution"));
+  return executor_->InsertAssociationsIfNotExist(associations);
+}
+
 absl::Status RDBMSMetadataAccessObject::FindContextsByExecution(
     int64 execution_id, std::vector<Context>* contexts) {
   RecordSet record_set;
   MLMD_RETURN_IF_ERROR(
-      executor_->SelectAssociationByExecutionID(execution_id, &record_set));
+      executor_->SelectAssociationByExecutionIDs({execution_id}, &record_set));
   const std::vector<int64> context_ids = AssociationsToContextIds(record_set);
   if (context_ids.empty()) {
     return absl::NotFoundError(
@@ -1511,6 +2472,57 @@ absl::Status RDBMSMetadataAccessObject::FindContextsByExecution(
   return FindNodesImpl(context_ids, /*skipped_ids_ok=*/false, *contexts);
 }
 
+absl::Status RDBMSMetadataAccessObject::FindContextsByExecutions(
+    const absl::Span<const int64> execution_ids,
+    std::vector<Association>* associations, std::vector<Context>* contexts) {
+  associations->clear();
+  contexts->clear();
+  if (execution_ids.empty()) {
+    return absl::OkStatus();
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectAssociationByExecutionIDs(execution_ids, &record_set));
+  const std::vector<int64> context_ids = AssociationsToContextIds(record_set);
+  const std::vector<int64> associated_execution_ids =
+      AssociationsToExecutionIds(record_set);
+  associations->reserve(context_ids.size());
+  for (int i = 0; i < context_ids.size(); i++) {
+    Association& association = associations->emplace_back();
+    association.set_execution_id(associated_execution_ids[i]);
+    association.set_context_id(context_ids[i]);
+  }
+  std::sort(associations->begin(), associations->end(),
+            [](const Association& a, const Association& b) {
+              return std::make_pair(a.execution_id(), a.context_id()) <
+                     std::make_pair(b.execution_id(), b.context_id());
+            });
+  return FindNodesOrderedById(context_ids, contexts);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindExecutionsByContexts(
+    const absl::Span<const int64> context_ids, const int64 max_num_per_context,
+    std::vector<Association>* associations,
+    std::vector<Execution>* executions) {
+  associations->clear();
+  executions->clear();
+  if (context_ids.empty()) {
+    return absl::OkStatus();
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectAssociationByContextIDs(context_ids, &record_set));
+  std::vector<int64> execution_ids;
+  for (const auto& [context_id, execution_id] :
+       LinksToContextAndNodeIds(record_set, max_num_per_context)) {
+    Association& association = associations->emplace_back();
+    association.set_context_id(context_id);
+    association.set_execution_id(execution_id);
+    execution_ids.push_back(execution_id);
+  }
+  return FindNodesOrderedById(std::move(execution_ids), executions);
+}
+
 absl::Status RDBMSMetadataAccessObject::FindExecutionsByContext(
     int64 context_id, std::vector<Execution>* executions) {
   std::string unused_next_page_toke;
@@ -1537,12 +2549,13 @@ absl::Status RDBMSMetadataAccessObject::FindExecutionsByContext(
 
 absl::Status RDBMSMetadataAccessObject::CreateAttribution(
     const Attribution& attribution, int64* attribution_id) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::CreateAttribution");
   if (!attribution.has_context_id())
     return absl::InvalidArgumentError("No context id is specified.");
   RecordSet context_id_header;
   MLMD_RETURN_IF_ERROR(executor_->SelectContextsByID({attribution.context_id()},
                                                      &context_id_header));
-  if (context_id_header.records_size() == 0)
+  if (NumRows(context_id_header) == 0)
     return absl::InvalidArgumentError("Context id not found.");
 
   if (!attribution.has_artifact_id())
@@ -1550,7 +2563,7 @@ absl::Status RDBMSMetadataAccessObject::CreateAttribution(
   RecordSet artifact_id_header;
   MLMD_RETURN_IF_ERROR(executor_->SelectArtifactsByID(
       {attribution.artifact_id()}, &artifact_id_header));
-  if (artifact_id_header.records_size() == 0)
+  if (NumRows(artifact_id_header) == 0)
     return absl::InvalidArgumentError("Artifact id not found.");
 
   absl::Status status = executor_->InsertAttributionDirect(
@@ -1564,6 +2577,34 @@ absl::Status RDBMSMetadataAccessObject::CreateAttribution(
   return status;
 }
 
+absl::Status RDBMSMetadataAccessObject::CreateAttributionsIfNotExist(
+    const absl::Span<const Attribution> attributions) {
+  ScopedTraceSpan span(
+      "RDBMSMetadataAccessObject::CreateAttributionsIfNotExist");
+  if (attributions.empty()) {
+    return absl::OkStatus();
+  }
+  absl::flat_hash_set<int64> context_ids, artifact_ids;
+  for (const Attribution& attribution : attributions) {
+    if (!attribution.has_context_id())
+      return absl::InvalidArgumentError("No context id is specified.");
+    if (!attribution.has_artifact_id())
+      return absl::InvalidArgumentError("No artifact id is specified");
+    context_ids.insert(attribution.context_id());
+    artifact_ids.insert(attribution.artifact_id());
+  }
+  RecordSet contexts;
+  MLMD_RETURN_IF_ERROR(executor_->SelectContextsByID(
+      std::vector<int64>(context_ids.begin(), context_ids.end()), &contexts));
+  MLMD_RETURN_IF_ERROR(CheckNodesFound(context_ids, contexts, "context"));
+  RecordSet artifacts;
+  MLMD_RETURN_IF_ERROR(executor_->SelectArtifactsByID(
+      std::vector<int64>(artifact_ids.begin(), artifact_ids.end()),
+      &artifacts));
+  MLMD_RETURN_IF_ERROR(CheckNodesFound(artifact_ids, artifacts, "artifact"));
+  return executor_->InsertAttributionsIfNotExist(attributions);
+}
+
 absl::Status RDBMSMetadataAccessObject::FindContextsByArtifact(
     int64 artifact_id, std::vector<Context>* contexts) {
   RecordSet record_set;
@@ -1589,7 +2630,7 @@ absl::Status RDBMSMetadataAccessObject::FindArtifactsByContext(
     std::vector<Artifact>* artifacts, std::string* next_page_token) {
   RecordSet record_set;
   MLMD_RETURN_IF_ERROR(
-      executor_->SelectAttributionByContextID(context_id, &record_set));
+      executor_->SelectAttributionByContextIDs({context_id}, &record_set));
   const std::vector<int64> ids = AttributionsToArtifactIds(record_set);
   if (ids.empty()) {
     return absl::OkStatus();
@@ -1601,6 +2642,29 @@ absl::Status RDBMSMetadataAccessObject::FindArtifactsByContext(
   return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *artifacts);
 }
 
+absl::Status RDBMSMetadataAccessObject::FindArtifactsByContexts(
+    const absl::Span<const int64> context_ids, const int64 max_num_per_context,
+    std::vector<Attribution>* attributions,
+    std::vector<Artifact>* artifacts) {
+  attributions->clear();
+  artifacts->clear();
+  if (context_ids.empty()) {
+    return absl::OkStatus();
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectAttributionByContextIDs(context_ids, &record_set));
+  std::vector<int64> artifact_ids;
+  for (const auto& [context_id, artifact_id] :
+       LinksToContextAndNodeIds(record_set, max_num_per_context)) {
+    Attribution& attribution = attributions->emplace_back();
+    attribution.set_context_id(context_id);
+    attribution.set_artifact_id(artifact_id);
+    artifact_ids.push_back(artifact_id);
+  }
+  return FindNodesOrderedById(std::move(artifact_ids), artifacts);
+}
+
 absl::Status RDBMSMetadataAccessObject::CreateParentContext(
     const ParentContext& parent_context) {
   if (!parent_context.has_parent_id() || !parent_context.has_child_id()) {
@@ -1612,7 +2676,7 @@ absl::Status RDBMSMetadataAccessObject::CreateParentContext(
   MLMD_RETURN_IF_ERROR(executor_->SelectContextsByID(
       {parent_context.parent_id(), parent_context.child_id()},
       &contexts_id_header));
-  if (contexts_id_header.records_size() < 2) {
+  if (NumRows(contexts_id_header) < 2) {
     return absl::InvalidArgumentError(absl::StrCat(
         "Given parent / child id in the parent_context cannot be found: ",
         parent_context.DebugString()));
@@ -1671,6 +2735,80 @@ absl::Status RDBMSMetadataAccessObject::FindChildContextsByContextId(
       context_id, ParentContextTraverseDirection::kChild, *contexts);
 }
 
+absl::Status RDBMSMetadataAccessObject::FindContextHierarchyImpl(
+    int64 context_id, int64 max_depth, ParentContextTraverseDirection direction,
+    std::vector<Context>& output_contexts) {
+  if (max_depth <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("max_depth must be positive: ", max_depth));
+  }
+  RecordSet record_set;
+  if (direction == ParentContextTraverseDirection::kParent) {
+    MLMD_RETURN_IF_ERROR(executor_->SelectAncestorContextIDs(
+        context_id, max_depth, &record_set));
+  } else if (direction == ParentContextTraverseDirection::kChild) {
+    MLMD_RETURN_IF_ERROR(executor_->SelectDescendantContextIDs(
+        context_id, max_depth, &record_set));
+  } else {
+    return absl::InternalError("Unexpected ParentContext direction");
+  }
+  const std::vector<int64> ids = ConvertToIds(record_set);
+  output_contexts.clear();
+  if (ids.empty()) {
+    return absl::OkStatus();
+  }
+  MLMD_RETURN_IF_ERROR(
+      FindNodesImpl(ids, /*skipped_ids_ok=*/false, output_contexts));
+  // The contexts are hydrated in a single query, which does not keep the order
+  // of the ids.
+  absl::flat_hash_map<int64, int> positions;
+  for (int i = 0; i < ids.size(); i++) {
+    positions[ids[i]] = i;
+  }
+  absl::c_sort(output_contexts, [&positions](const Context& a,
+                                             const Context& b) {
+    return positions.at(a.id()) < positions.at(b.id());
+  });
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::FindAncestorContextsByContextId(
+    int64 context_id, int64 max_depth, std::vector<Context>* contexts) {
+  if (contexts == nullptr) {
+    return absl::InvalidArgumentError("Given contexts is NULL.");
+  }
+  return FindContextHierarchyImpl(context_id, max_depth,
+                                  ParentContextTraverseDirection::kParent,
+                                  *contexts);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindDescendantContextsByContextId(
+    int64 context_id, int64 max_depth, std::vector<Context>* contexts) {
+  if (contexts == nullptr) {
+    return absl::InvalidArgumentError("Given contexts is NULL.");
+  }
+  return FindContextHierarchyImpl(context_id, max_depth,
+                                  ParentContextTraverseDirection::kChild,
+                                  *contexts);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindArtifactLastUpdateTimes(
+    const absl::Span<const int64> artifact_ids,
+    absl::flat_hash_map<int64, int64>* last_update_times) {
+  last_update_times->clear();
+  if (artifact_ids.empty()) {
+    return absl::OkStatus();
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectArtifactLastUpdateTimes(artifact_ids, &record_set));
+  for (int row = 0; row < NumRows(record_set); row++) {
+    last_update_times->insert({GetInt64Value(record_set, row, 0),
+                               GetInt64Value(record_set, row, 1)});
+  }
+  return absl::OkStatus();
+}
+
 absl::Status RDBMSMetadataAccessObject::FindArtifacts(
     std::vector<Artifact>* artifacts) {
   RecordSet record_set;
@@ -1714,6 +2852,8 @@ absl::Status RDBMSMetadataAccessObject::ListNodes(
     const ListOperationOptions& options,
     absl::optional<absl::Span<const int64>> candidate_ids,
     std::vector<Node>* nodes, std::string* next_page_token) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::ListNodes");
+  span.AddAttribute("mlmd.kind", Node::descriptor()->name());
   if (options.max_result_size() <= 0) {
     return absl::InvalidArgumentError(
         absl::StrCat("max_result_size field value is required to be greater "
@@ -1723,6 +2863,7 @@ absl::Status RDBMSMetadataAccessObject::ListNodes(
   if (!nodes->empty()) {
     return absl::InvalidArgumentError("nodes argument is not empty");
   }
+  MLMD_RETURN_IF_ERROR(ValidateBulkExportListOperationOptions(options));
 
   // Retrieving page of size 1 greater that max_result_size to detect if this
   // is the last page.
@@ -1743,8 +2884,9 @@ absl::Status RDBMSMetadataAccessObject::ListNodes(
     position_by_id[ids.at(i)] = i;
   }
 
-  // Retrieve nodes
-  MLMD_RETURN_IF_ERROR(FindNodesImpl(ids, /*skipped_ids_ok=*/false, *nodes));
+  // Retrieve nodes with the projected properties
+  MLMD_RETURN_IF_ERROR(FindNodesImpl(ids, /*skipped_ids_ok=*/false, *nodes,
+                                     options.property_projection()));
 
   // Sort nodes in the right order
   absl::c_sort(*nodes, [&](const Node& a, const Node& b) {
@@ -1782,6 +2924,33 @@ absl::Status RDBMSMetadataAccessObject::ListContexts(
   return ListNodes<Context>(options, absl::nullopt, contexts, next_page_token);
 }
 
+absl::Status RDBMSMetadataAccessObject::CountArtifacts(
+    const CountOptions& options, std::vector<NodeCount>* counts) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->CountArtifactsUsingOptions(options, &record_set));
+  ConvertToNodeCounts(options, record_set, counts);
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::CountExecutions(
+    const CountOptions& options, std::vector<NodeCount>* counts) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->CountExecutionsUsingOptions(options, &record_set));
+  ConvertToNodeCounts(options, record_set, counts);
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::CountContexts(
+    const CountOptions& options, std::vector<NodeCount>* counts) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->CountContextsUsingOptions(options, &record_set));
+  ConvertToNodeCounts(options, record_set, counts);
+  return absl::OkStatus();
+}
+
 absl::Status RDBMSMetadataAccessObject::FindArtifactByTypeIdAndArtifactName(
     const int64 type_id, const absl::string_view name, Artifact* artifact) {
   RecordSet record_set;
@@ -1874,6 +3043,19 @@ absl::Status RDBMSMetadataAccessObject::FindExecutionsByTypeId(
   }
 }
 
+absl::Status RDBMSMetadataAccessObject::FindActiveExecutionsByTypeId(
+    const int64 type_id, std::vector<Execution>* executions) {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectActiveExecutionsByTypeID(type_id, &record_set));
+  const std::vector<int64> ids = ConvertToIds(record_set);
+  if (ids.empty()) {
+    return absl::NotFoundError(
+        absl::StrCat("No active executions found for type_id:", type_id));
+  }
+  return FindNodesImpl(ids, /*skipped_ids_ok=*/false, *executions);
+}
+
 absl::Status RDBMSMetadataAccessObject::FindContexts(
     std::vector<Context>* contexts) {
   RecordSet record_set;
@@ -1938,40 +3120,32 @@ absl::Status RDBMSMetadataAccessObject::FindContextByTypeIdAndContextName(
 }
 
 
-template <typename Node>
 absl::Status RDBMSMetadataAccessObject::SkipBoundaryNodesImpl(
-    absl::optional<std::string> boundary_condition,
+    const QueryExecutor::CompiledBoundary* boundary,
     absl::flat_hash_set<int64>& unvisited_node_ids) {
-  if (!boundary_condition) {
+  if (boundary == nullptr || unvisited_node_ids.empty()) {
     return absl::OkStatus();
   }
+  // The whole frontier is checked at once; large id sets are bound as a
+  // single parameter by the executor.
   const std::vector<int64> candidate_ids(unvisited_node_ids.begin(),
                                          unvisited_node_ids.end());
-  auto list_ids = absl::MakeConstSpan(candidate_ids);
-  // Uses batched retrieval to bound query length and list query invariant.
-  static constexpr int kBatchSize = 100;
-  for (int i = 0; i * kBatchSize < candidate_ids.size(); i++) {
-    ListOperationOptions boundary_options;
-    boundary_options.set_max_result_size(kBatchSize);
-    boundary_options.set_filter_query(
-        absl::Substitute("NOT($0)", *boundary_condition));
-    RecordSet record_set;
-    MLMD_RETURN_IF_ERROR(ListNodeIds<Node>(
-        boundary_options, list_ids.subspan(i * kBatchSize, kBatchSize),
-        &record_set));
-    for (int64 skip_id : ConvertToIds(record_set)) {
-      unvisited_node_ids.erase(skip_id);
-    }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(executor_->SelectNodeIDsOutsideBoundary(
+      *boundary, candidate_ids, &record_set));
+  for (int64 skip_id : ConvertToIds(record_set)) {
+    unvisited_node_ids.erase(skip_id);
   }
   return absl::OkStatus();
 }
 
 absl::Status RDBMSMetadataAccessObject::ExpandLineageGraphImpl(
     const std::vector<Artifact>& input_artifacts, int64 max_nodes,
-    absl::optional<std::string> boundary_condition,
+    const QueryExecutor::CompiledBoundary* boundary,
     const absl::flat_hash_set<int64>& visited_execution_ids,
     absl::flat_hash_set<int64>& visited_artifact_ids,
     std::vector<Execution>& output_executions, LineageGraph& subgraph) {
+  output_executions.clear();
   if (max_nodes <= 0) {
     return absl::OkStatus();
   }
@@ -1992,24 +3166,26 @@ absl::Status RDBMSMetadataAccessObject::ExpandLineageGraphImpl(
       unvisited_execution_ids.insert(event.execution_id());
     }
   }
-  MLMD_RETURN_IF_ERROR(SkipBoundaryNodesImpl<Execution>(
-      boundary_condition, unvisited_execution_ids));
+  MLMD_RETURN_IF_ERROR(
+      SkipBoundaryNodesImpl(boundary, unvisited_execution_ids));
 
-  // Randomly remove extra nodes if more than max_nodes executions are found.
-  while (unvisited_execution_ids.size() > max_nodes) {
-    unvisited_execution_ids.erase(unvisited_execution_ids.begin());
+  // Keeps the max_nodes executions with the smallest ids, so that the
+  // subgraph is deterministic.
+  std::vector<int64> expand_execution_ids(unvisited_execution_ids.begin(),
+                                          unvisited_execution_ids.end());
+  absl::c_sort(expand_execution_ids);
+  if (expand_execution_ids.size() > max_nodes) {
+    expand_execution_ids.resize(max_nodes);
+    unvisited_execution_ids = absl::flat_hash_set<int64>(
+        expand_execution_ids.begin(), expand_execution_ids.end());
   }
 
-  for (const Event& event : events) {
+  for (Event& event : events) {
     if (unvisited_execution_ids.contains(event.execution_id())) {
-      *subgraph.add_events() = event;
+      *subgraph.add_events() = std::move(event);
     }
   }
-  const std::vector<int64> expand_execution_ids(unvisited_execution_ids.begin(),
-                                                unvisited_execution_ids.end());
-  output_executions.clear();
-  MLMD_RETURN_IF_ERROR(
-      FindExecutionsById(expand_execution_ids, &output_executions));
+  SetIdOnlyNodes(expand_execution_ids, output_executions);
   absl::c_copy(output_executions, google::protobuf::RepeatedFieldBackInserter(
                                       subgraph.mutable_executions()));
   return absl::OkStatus();
@@ -2017,10 +3193,11 @@ absl::Status RDBMSMetadataAccessObject::ExpandLineageGraphImpl(
 
 absl::Status RDBMSMetadataAccessObject::ExpandLineageGraphImpl(
     const std::vector<Execution>& input_executions, int64 max_nodes,
-    absl::optional<std::string> boundary_condition,
+    const QueryExecutor::CompiledBoundary* boundary,
     const absl::flat_hash_set<int64>& visited_artifact_ids,
     absl::flat_hash_set<int64>& visited_execution_ids,
     std::vector<Artifact>& output_artifacts, LineageGraph& subgraph) {
+  output_artifacts.clear();
   if (max_nodes <= 0) {
     return absl::OkStatus();
   }
@@ -2041,42 +3218,361 @@ absl::Status RDBMSMetadataAccessObject::ExpandLineageGraphImpl(
       unvisited_artifact_ids.insert(event.artifact_id());
     }
   }
-  MLMD_RETURN_IF_ERROR(SkipBoundaryNodesImpl<Artifact>(boundary_condition,
-                                                       unvisited_artifact_ids));
+  MLMD_RETURN_IF_ERROR(SkipBoundaryNodesImpl(boundary, unvisited_artifact_ids));
 
-  // Randomly remove extra nodes if more than max_nodes artifacts are found.
-  while (unvisited_artifact_ids.size() > max_nodes) {
-    unvisited_artifact_ids.erase(unvisited_artifact_ids.begin());
+  // Keeps the max_nodes artifacts with the smallest ids, so that the subgraph
+  // is deterministic.
+  std::vector<int64> expand_artifact_ids(unvisited_artifact_ids.begin(),
+                                         unvisited_artifact_ids.end());
+  absl::c_sort(expand_artifact_ids);
+  if (expand_artifact_ids.size() > max_nodes) {
+    expand_artifact_ids.resize(max_nodes);
+    unvisited_artifact_ids = absl::flat_hash_set<int64>(
+        expand_artifact_ids.begin(), expand_artifact_ids.end());
   }
 
-  for (const Event& event : events) {
+  for (Event& event : events) {
     if (unvisited_artifact_ids.contains(event.artifact_id())) {
-      *subgraph.add_events() = event;
+      *subgraph.add_events() = std::move(event);
     }
   }
-  const std::vector<int64> expand_artifact_ids(unvisited_artifact_ids.begin(),
-                                               unvisited_artifact_ids.end());
-  output_artifacts.clear();
-  MLMD_RETURN_IF_ERROR(
-      FindArtifactsById(expand_artifact_ids, &output_artifacts));
+  SetIdOnlyNodes(expand_artifact_ids, output_artifacts);
   absl::c_copy(output_artifacts,
                google::protobuf::RepeatedFieldBackInserter(subgraph.mutable_artifacts()));
   return absl::OkStatus();
 }
 
+absl::Status RDBMSMetadataAccessObject::RebuildLineageGraphIndex() {
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(
+      executor_->SelectLastChangeLogSequenceNumber(&record_set));
+  const int64 sequence_number = GetInt64Value(record_set, 0, 0);
+  std::vector<LineageGraphIndex::Edge> edges;
+  int64 last_event_id = 0;
+  do {
+    record_set.Clear();
+    MLMD_RETURN_IF_ERROR(executor_->SelectLineageGraphEdges(
+        last_event_id, kLineageGraphIndexPageSize, &record_set));
+    for (int i = 0; i < NumRows(record_set); i++) {
+      last_event_id = GetInt64Value(record_set, i, 0);
+      edges.push_back(
+          {GetInt64Value(record_set, i, 1), GetInt64Value(record_set, i, 2)});
+    }
+  } while (NumRows(record_set) == kLineageGraphIndexPageSize);
+  // The archived events are not in the change log, so the index keeps them
+  // once it is built.
+  last_event_id = 0;
+  do {
+    record_set.Clear();
+    MLMD_RETURN_IF_ERROR(executor_->SelectArchivedLineageGraphEdges(
+        last_event_id, kLineageGraphIndexPageSize, &record_set));
+    for (int i = 0; i < NumRows(record_set); i++) {
+      last_event_id = GetInt64Value(record_set, i, 0);
+      edges.push_back(
+          {GetInt64Value(record_set, i, 1), GetInt64Value(record_set, i, 2)});
+    }
+  } while (NumRows(record_set) == kLineageGraphIndexPageSize);
+  lineage_graph_index_->Rebuild(std::move(edges), sequence_number);
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::RefreshLineageGraphIndex() {
+  if (lineage_graph_index_->StartRebuild()) {
+    const absl::Status status = RebuildLineageGraphIndex();
+    if (!status.ok()) {
+      lineage_graph_index_->AbortRebuild();
+      return status;
+    }
+  }
+  // Another connection may be building the index meanwhile.
+  if (!lineage_graph_index_->built()) {
+    return absl::OkStatus();
+  }
+  std::vector<ChangeLogEntry> entries;
+  do {
+    MLMD_RETURN_IF_ERROR(
+        FindChangeLogEntries(lineage_graph_index_->sequence_number(),
+                             kLineageGraphIndexPageSize, &entries));
+    lineage_graph_index_->Apply(entries);
+  } while (entries.size() == kLineageGraphIndexPageSize);
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::TraverseLineageGraphByHops(
+    const absl::Span<const int64> query_artifact_ids, const int64 max_num_hops,
+    const int64 max_nodes, std::vector<LineageGraphIndex::Node>* nodes) {
+  nodes->clear();
+  std::vector<int64> frontier(query_artifact_ids.begin(),
+                              query_artifact_ids.end());
+  absl::c_sort(frontier);
+  frontier.erase(std::unique(frontier.begin(), frontier.end()),
+                 frontier.end());
+  absl::flat_hash_set<int64> visited_artifact_ids(frontier.begin(),
+                                                  frontier.end());
+  absl::flat_hash_set<int64> visited_execution_ids;
+  for (const int64 id : frontier) {
+    if (nodes->size() >= max_nodes) {
+      return absl::OkStatus();
+    }
+    nodes->push_back({/*is_artifact=*/true, id});
+  }
+  bool from_artifacts = true;
+  for (int64 hop = 0; hop < max_num_hops && !frontier.empty(); hop++) {
+    std::vector<Event> events;
+    const absl::Status status =
+        from_artifacts ? FindEventsByArtifacts(frontier, &events)
+                       : FindEventsByExecutions(frontier, &events);
+    if (!status.ok() && !absl::IsNotFound(status)) {
+      return status;
+    }
+    absl::flat_hash_set<int64>& visited_ids =
+        from_artifacts ? visited_execution_ids : visited_artifact_ids;
+    frontier.clear();
+    for (const Event& event : events) {
+      const int64 id =
+          from_artifacts ? event.execution_id() : event.artifact_id();
+      if (visited_ids.insert(id).second) {
+        frontier.push_back(id);
+      }
+    }
+    absl::c_sort(frontier);
+    for (const int64 id : frontier) {
+      if (nodes->size() >= max_nodes) {
+        return absl::OkStatus();
+      }
+      nodes->push_back({/*is_artifact=*/!from_artifacts, id});
+    }
+    from_artifacts = !from_artifacts;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::TraverseLineageGraphImpl(
+    const std::vector<Artifact>& query_nodes, int64 max_num_hops,
+    int64 max_nodes, const bool ids_only, LineageGraph& subgraph) {
+  if (query_nodes.empty() || max_num_hops <= 0 || max_nodes <= 0) {
+    return absl::OkStatus();
+  }
+  std::vector<int64> query_node_ids(query_nodes.size());
+  for (int i = 0; i < query_nodes.size(); i++) {
+    query_node_ids[i] = query_nodes[i].id();
+  }
+  // The query nodes are among the rows, so the rows of at most max_nodes
+  // other nodes are read.
+  const int64 num_query_nodes = query_node_ids.size();
+  const int64 max_num_rows =
+      max_nodes > std::numeric_limits<int64>::max() - num_query_nodes
+          ? std::numeric_limits<int64>::max()
+          : max_nodes + num_query_nodes;
+  std::vector<LineageGraphIndex::Node> nodes;
+  bool from_index = false;
+  if (lineage_graph_index_ != nullptr) {
+    MLMD_RETURN_IF_ERROR(RefreshLineageGraphIndex());
+    from_index = lineage_graph_index_->built();
+  }
+  bool has_archived_events = false;
+  if (!from_index) {
+    RecordSet record_set;
+    MLMD_RETURN_IF_ERROR(executor_->SelectArchivedLineageGraphEdges(
+        /*after_event_id=*/0, /*max_num_events=*/1, &record_set));
+    has_archived_events = NumRows(record_set) > 0;
+  }
+  if (from_index) {
+    lineage_graph_index_->Traverse(query_node_ids, max_num_hops, max_num_rows,
+                                   &nodes);
+  } else if (has_archived_events) {
+    MLMD_RETURN_IF_ERROR(TraverseLineageGraphByHops(
+        query_node_ids, max_num_hops, max_num_rows, &nodes));
+  } else {
+    RecordSet record_set;
+    MLMD_RETURN_IF_ERROR(executor_->SelectLineageGraphNodeDistances(
+        query_node_ids, max_num_hops, max_num_rows, &record_set));
+    nodes.reserve(NumRows(record_set));
+    for (int i = 0; i < NumRows(record_set); i++) {
+      nodes.push_back({/*is_artifact=*/GetInt64Value(record_set, i, 0) == 1,
+                       /*id=*/GetInt64Value(record_set, i, 1)});
+    }
+  }
+
+  // The nodes are ordered by distance, so the nodes nearest to the query
+  // nodes are kept if more than max_nodes nodes are reached.
+  absl::flat_hash_set<int64> artifact_ids(query_node_ids.begin(),
+                                          query_node_ids.end());
+  std::vector<int64> expand_artifact_ids;
+  std::vector<int64> expand_execution_ids;
+  for (const LineageGraphIndex::Node& node : nodes) {
+    if (expand_artifact_ids.size() + expand_execution_ids.size() >=
+        max_nodes) {
+      break;
+    }
+    if (!node.is_artifact) {
+      expand_execution_ids.push_back(node.id);
+    } else if (artifact_ids.insert(node.id).second) {
+      expand_artifact_ids.push_back(node.id);
+    }
+  }
+  if (expand_execution_ids.empty()) {
+    return absl::OkStatus();
+  }
+
+  // The events between any two of the kept nodes are in the subgraph. The
+  // executions reached in the index may have no events in the database.
+  std::vector<Event> events;
+  const absl::Status events_status =
+      FindEventsByExecutions(expand_execution_ids, &events);
+  if (!events_status.ok() &&
+      !(from_index && absl::IsNotFound(events_status))) {
+    return events_status;
+  }
+  for (Event& event : events) {
+    if (artifact_ids.contains(event.artifact_id())) {
+      *subgraph.add_events() = std::move(event);
+    }
+  }
+  std::vector<Execution> executions;
+  if (ids_only) {
+    SetIdOnlyNodes(expand_execution_ids, executions);
+  } else {
+    MLMD_RETURN_IF_ERROR(FindNodesImpl(expand_execution_ids,
+                                       /*skipped_ids_ok=*/from_index,
+                                       executions));
+  }
+  absl::c_move(executions, google::protobuf::RepeatedFieldBackInserter(
+                               subgraph.mutable_executions()));
+  if (!expand_artifact_ids.empty()) {
+    std::vector<Artifact> artifacts;
+    if (ids_only) {
+      SetIdOnlyNodes(expand_artifact_ids, artifacts);
+    } else {
+      MLMD_RETURN_IF_ERROR(FindNodesImpl(
+          expand_artifact_ids, /*skipped_ids_ok=*/from_index, artifacts));
+    }
+    absl::c_move(artifacts, google::protobuf::RepeatedFieldBackInserter(
+                                subgraph.mutable_artifacts()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::ReadLineageGraphNodes(
+    const int num_query_nodes, LineageGraph& subgraph) {
+  std::vector<int64> artifact_ids;
+  for (int i = num_query_nodes; i < subgraph.artifacts_size(); i++) {
+    artifact_ids.push_back(subgraph.artifacts(i).id());
+  }
+  std::vector<int64> execution_ids;
+  for (const Execution& execution : subgraph.executions()) {
+    execution_ids.push_back(execution.id());
+  }
+  subgraph.mutable_artifacts()->DeleteSubrange(
+      num_query_nodes, subgraph.artifacts_size() - num_query_nodes);
+  subgraph.clear_executions();
+  if (!artifact_ids.empty()) {
+    std::vector<Artifact> artifacts;
+    MLMD_RETURN_IF_ERROR(
+        FindNodesImpl(artifact_ids, /*skipped_ids_ok=*/false, artifacts));
+    absl::c_move(artifacts, google::protobuf::RepeatedFieldBackInserter(
+                                subgraph.mutable_artifacts()));
+  }
+  if (!execution_ids.empty()) {
+    std::vector<Execution> executions;
+    MLMD_RETURN_IF_ERROR(
+        FindNodesImpl(execution_ids, /*skipped_ids_ok=*/false, executions));
+    absl::c_move(executions, google::protobuf::RepeatedFieldBackInserter(
+                                 subgraph.mutable_executions()));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status RDBMSMetadataAccessObject::QueryLineageGraph(
     const std::vector<Artifact>& query_nodes, int64 max_num_hops,
     absl::optional<int64> max_nodes,
     absl::optional<std::string> boundary_artifacts,
     absl::optional<std::string> boundary_executions, LineageGraph& subgraph) {
+  return QueryLineageGraphImpl(query_nodes, max_num_hops, max_nodes,
+                               boundary_artifacts, boundary_executions,
+                               /*ids_only=*/false, subgraph);
+}
+
+absl::Status RDBMSMetadataAccessObject::QueryLineageGraphIds(
+    const std::vector<Artifact>& query_nodes, int64 max_num_hops,
+    absl::optional<int64> max_nodes,
+    absl::optional<std::string> boundary_artifacts,
+    absl::optional<std::string> boundary_executions, LineageGraph& subgraph) {
+  return QueryLineageGraphImpl(query_nodes, max_num_hops, max_nodes,
+                               boundary_artifacts, boundary_executions,
+                               /*ids_only=*/true, subgraph);
+}
+
+absl::Status RDBMSMetadataAccessObject::FindArtifactsByDerivation(
+    const absl::Span<const int64> artifact_ids, const bool upstream,
+    const int64 max_num_hops, const absl::optional<int64> context_id,
+    std::vector<Artifact>* artifacts) {
+  artifacts->clear();
+  if (artifact_ids.empty() || max_num_hops <= 0) {
+    return absl::OkStatus();
+  }
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(executor_->SelectArtifactDerivationDistances(
+      artifact_ids, upstream, max_num_hops, context_id, &record_set));
+  const std::vector<int64> ids = ConvertToIds(record_set);
+  std::vector<Artifact> found_artifacts;
+  MLMD_RETURN_IF_ERROR(FindArtifactsById(ids, &found_artifacts));
+  // Keeps the order of the distances, as the artifacts are read by ids.
+  absl::flat_hash_map<int64, int> positions;
+  for (int i = 0; i < ids.size(); i++) {
+    positions[ids[i]] = i;
+  }
+  absl::c_sort(found_artifacts, [&positions](const Artifact& a,
+                                             const Artifact& b) {
+    return positions[a.id()] < positions[b.id()];
+  });
+  *artifacts = std::move(found_artifacts);
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::FindChangeLogEntries(
+    const int64 after_sequence_number, const int64 max_num_entries,
+    std::vector<ChangeLogEntry>* entries) {
+  entries->clear();
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(executor_->SelectChangeLogEntries(
+      after_sequence_number, max_num_entries, &record_set));
+  return ParseRecordSetToMessageArray(record_set, entries);
+}
+
+absl::Status RDBMSMetadataAccessObject::ArchiveExecutions(
+    const int64 max_last_update_time_since_epoch,
+    const int64 max_num_executions, int64* num_archived_executions) {
+  *num_archived_executions = 0;
+  RecordSet record_set;
+  MLMD_RETURN_IF_ERROR(executor_->SelectColdExecutionIDs(
+      max_last_update_time_since_epoch, max_num_executions, &record_set));
+  const std::vector<int64> ids = ConvertToIds(record_set);
+  if (ids.empty()) {
+    return absl::OkStatus();
+  }
+  std::vector<Execution> executions;
+  MLMD_RETURN_IF_ERROR(FindNodesImpl(
+      ids, /*skipped_ids_ok=*/false, executions,
+      ListOperationOptions::PropertyProjection::default_instance(),
+      /*include_archived=*/false));
+  // The archived executions and events stay in the lineage graph, so no
+  // change log entries are written.
+  MLMD_RETURN_IF_ERROR(executor_->ArchiveExecutions(executions));
+  *num_archived_executions = executions.size();
+  return absl::OkStatus();
+}
+
+absl::Status RDBMSMetadataAccessObject::QueryLineageGraphImpl(
+    const std::vector<Artifact>& query_nodes, int64 max_num_hops,
+    absl::optional<int64> max_nodes,
+    absl::optional<std::string> boundary_artifacts,
+    absl::optional<std::string> boundary_executions, const bool ids_only,
+    LineageGraph& subgraph) {
+  ScopedTraceSpan span("RDBMSMetadataAccessObject::QueryLineageGraph");
+  subgraph.mutable_artifacts()->Reserve(query_nodes.size());
   absl::c_copy(query_nodes,
                google::protobuf::RepeatedFieldBackInserter(subgraph.mutable_artifacts()));
-  // Add nodes and edges
-  absl::flat_hash_set<int64> visited_artifacts_ids;
-  absl::flat_hash_set<int64> visited_executions_ids;
-  int64 curr_distance = 0;
-  std::vector<Artifact> output_artifacts;
-  std::vector<Execution> output_executions;
   // If max_nodes is not set, set nodes quota to max int64 value to effectively
   // disable limit the lineage graph by nodes count.
   int64 nodes_quota;
@@ -2086,60 +3582,97 @@ absl::Status RDBMSMetadataAccessObject::QueryLineageGraph(
     nodes_quota = max_nodes.value() - query_nodes.size();
   }
 
-  while (curr_distance < max_num_hops && nodes_quota > 0) {
-    const bool is_traverse_from_artifact = (curr_distance % 2 == 0);
-    if (is_traverse_from_artifact) {
-      if (curr_distance == 0) {
-        MLMD_RETURN_IF_ERROR(ExpandLineageGraphImpl(
-            query_nodes, nodes_quota, boundary_executions,
-            visited_executions_ids, visited_artifacts_ids, output_executions,
-            subgraph));
+  // Without boundary conditions, the traversal is done by the database.
+  if (!boundary_artifacts && !boundary_executions) {
+    MLMD_RETURN_IF_ERROR(TraverseLineageGraphImpl(
+        query_nodes, max_num_hops, nodes_quota, ids_only, subgraph));
+  } else {
+    // The boundary conditions are compiled once, and checked against the
+    // frontier of each hop.
+    QueryExecutor::CompiledBoundary compiled_boundary_artifacts;
+    if (boundary_artifacts) {
+      MLMD_RETURN_IF_ERROR(executor_->CompileArtifactBoundary(
+          *boundary_artifacts, &compiled_boundary_artifacts));
+    }
+    QueryExecutor::CompiledBoundary compiled_boundary_executions;
+    if (boundary_executions) {
+      MLMD_RETURN_IF_ERROR(executor_->CompileExecutionBoundary(
+          *boundary_executions, &compiled_boundary_executions));
+    }
+    const QueryExecutor::CompiledBoundary* artifacts_boundary =
+        boundary_artifacts ? &compiled_boundary_artifacts : nullptr;
+    const QueryExecutor::CompiledBoundary* executions_boundary =
+        boundary_executions ? &compiled_boundary_executions : nullptr;
+    // Add nodes and edges
+    absl::flat_hash_set<int64> visited_artifacts_ids;
+    absl::flat_hash_set<int64> visited_executions_ids;
+    int64 curr_distance = 0;
+    std::vector<Artifact> output_artifacts;
+    std::vector<Execution> output_executions;
+    while (curr_distance < max_num_hops && nodes_quota > 0) {
+      const bool is_traverse_from_artifact = (curr_distance % 2 == 0);
+      if (is_traverse_from_artifact) {
+        if (curr_distance == 0) {
+          MLMD_RETURN_IF_ERROR(ExpandLineageGraphImpl(
+              query_nodes, nodes_quota, executions_boundary,
+              visited_executions_ids, visited_artifacts_ids,
+              output_executions, subgraph));
+        } else {
+          MLMD_RETURN_IF_ERROR(ExpandLineageGraphImpl(
+              output_artifacts, nodes_quota, executions_boundary,
+              visited_executions_ids, visited_artifacts_ids,
+              output_executions, subgraph));
+        }
+        if (output_executions.empty()) {
+          break;
+        }
+        nodes_quota -= output_executions.size();
       } else {
         MLMD_RETURN_IF_ERROR(ExpandLineageGraphImpl(
-            output_artifacts, nodes_quota, boundary_executions,
-            visited_executions_ids, visited_artifacts_ids, output_executions,
-            subgraph));
-      }
-      if (output_executions.empty()) {
-        break;
-      }
-      nodes_quota -= output_executions.size();
-    } else {
-      MLMD_RETURN_IF_ERROR(ExpandLineageGraphImpl(
-          output_executions, nodes_quota, boundary_artifacts,
-          visited_artifacts_ids, visited_executions_ids, output_artifacts,
-          subgraph));
-      if (output_artifacts.empty()) {
-        break;
+            output_executions, nodes_quota, artifacts_boundary,
+            visited_artifacts_ids, visited_executions_ids,
+            output_artifacts, subgraph));
+        if (output_artifacts.empty()) {
+          break;
+        }
+        nodes_quota -= output_artifacts.size();
       }
-      nodes_quota -= output_artifacts.size();
+      curr_distance++;
+    }
+    // The nodes are traversed by their ids, and the kept ones are read once
+    // the traversal is done.
+    if (!ids_only) {
+      MLMD_RETURN_IF_ERROR(ReadLineageGraphNodes(
+          /*num_query_nodes=*/query_nodes.size(), subgraph));
     }
-    curr_distance++;
   }
   // Add node types.
   std::vector<ArtifactType> artifact_types;
   MLMD_RETURN_IF_ERROR(FindTypes(&artifact_types));
-  for (const ArtifactType& artifact_type : artifact_types) {
+  subgraph.mutable_artifact_types()->Reserve(artifact_types.size());
+  for (ArtifactType& artifact_type : artifact_types) {
     const bool is_simple_type =
         std::find(kSimpleTypeNames.begin(), kSimpleTypeNames.end(),
                   artifact_type.name()) != kSimpleTypeNames.end();
     if (!is_simple_type) {
-      *subgraph.mutable_artifact_types()->Add() = artifact_type;
+      *subgraph.mutable_artifact_types()->Add() = std::move(artifact_type);
     }
   }
   std::vector<ExecutionType> execution_types;
   MLMD_RETURN_IF_ERROR(FindTypes(&execution_types));
-  for (const ExecutionType& execution_type : execution_types) {
+  subgraph.mutable_execution_types()->Reserve(execution_types.size());
+  for (ExecutionType& execution_type : execution_types) {
     const bool is_simple_type =
         std::find(kSimpleTypeNames.begin(), kSimpleTypeNames.end(),
                   execution_type.name()) != kSimpleTypeNames.end();
     if (!is_simple_type) {
-      *subgraph.mutable_execution_types()->Add() = execution_type;
+      *subgraph.mutable_execution_types()->Add() = std::move(execution_type);
     }
   }
   std::vector<ContextType> context_types;
   MLMD_RETURN_IF_ERROR(FindTypes(&context_types));
-  absl::c_copy(context_types, google::protobuf::RepeatedFieldBackInserter(
+  subgraph.mutable_context_types()->Reserve(context_types.size());
+  absl::c_move(context_types, google::protobuf::RepeatedFieldBackInserter(
                                   subgraph.mutable_context_types()));
   return absl::OkStatus();
 }
@@ -2149,7 +3682,9 @@ absl::Status RDBMSMetadataAccessObject::DeleteArtifactsById(
   if (artifact_ids.empty()) {
     return absl::OkStatus();
   }
-  return executor_->DeleteArtifactsById(artifact_ids);
+  MLMD_RETURN_IF_ERROR(executor_->DeleteArtifactsById(artifact_ids));
+  return executor_->InsertChangeLogEntries(NodeChangeLogEntries(
+      ChangeLogEntry::ARTIFACT, ChangeLogEntry::DELETED, artifact_ids));
 }
 
 absl::Status RDBMSMetadataAccessObject::DeleteExecutionsById(
@@ -2157,7 +3692,9 @@ absl::Status RDBMSMetadataAccessObject::DeleteExecutionsById(
   if (execution_ids.empty()) {
     return absl::OkStatus();
   }
-  return executor_->DeleteExecutionsById(execution_ids);
+  MLMD_RETURN_IF_ERROR(executor_->DeleteExecutionsById(execution_ids));
+  return executor_->InsertChangeLogEntries(NodeChangeLogEntries(
+      ChangeLogEntry::EXECUTION, ChangeLogEntry::DELETED, execution_ids));
 }
 
 absl::Status RDBMSMetadataAccessObject::DeleteContextsById(
@@ -2165,7 +3702,9 @@ absl::Status RDBMSMetadataAccessObject::DeleteContextsById(
   if (context_ids.empty()) {
     return absl::OkStatus();
   }
-  return executor_->DeleteContextsById(context_ids);
+  MLMD_RETURN_IF_ERROR(executor_->DeleteContextsById(context_ids));
+  return executor_->InsertChangeLogEntries(NodeChangeLogEntries(
+      ChangeLogEntry::CONTEXT, ChangeLogEntry::DELETED, context_ids));
 }
 
 absl::Status RDBMSMetadataAccessObject::DeleteEventsByArtifactsId(
@@ -16,14 +16,18 @@ limitations under the License.
 #define ML_METADATA_METADATA_STORE_RDBMS_METADATA_ACCESS_OBJECT_H_
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
+#include "ml_metadata/metadata_store/lineage_graph_index.h"
 #include "ml_metadata/metadata_store/metadata_access_object.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/property_string_dictionary.h"
 #include "ml_metadata/metadata_store/query_executor.h"
+#include "ml_metadata/metadata_store/type_cache.h"
 #include "ml_metadata/proto/metadata_source.pb.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 
@@ -59,6 +63,7 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // the MetadataSource is dropped.
   // Returns detailed INTERNAL error, if query execution fails.
   absl::Status InitMetadataSource() final {
+    ResetTypeCache();
     return executor_->InitMetadataSource();
   }
 
@@ -72,15 +77,26 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // Returns detailed INTERNAL error, if create schema query execution fails.
   absl::Status InitMetadataSourceIfNotExists(
       bool enable_upgrade_migration = false) final {
+    ResetTypeCache();
     return executor_->InitMetadataSourceIfNotExists(enable_upgrade_migration);
   }
 
+  // Runs a step of an online upgrade of the schema to the library version.
+  // Returns INVALID_ARGUMENT error, if `batch_size` is not positive.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status UpgradeMetadataSourceOnlineStep(int64 batch_size,
+                                               bool* done) final {
+    ResetTypeCache();
+    return executor_->UpgradeMetadataSourceOnlineStep(batch_size, done);
+  }
+
 
   // Deletes the metadata source. All the metadata and other associated data
   // will be deleted. The metadata source can no longer be queried before
   // calling InitMetadataSourceIfNotExists again.
   // Returns detailed INTERNAL error, if update execution fails.
   absl::Status DeleteMetadataSource() final {
+    ResetTypeCache();
     return executor_->DeleteMetadataSource();
   }
 
@@ -91,6 +107,7 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   //   library version.
   // Returns detailed INTERNAL error, if query execution fails.
   absl::Status DowngradeMetadataSource(int64 to_schema_version) final {
+    ResetTypeCache();
     return executor_->DowngradeMetadataSource(to_schema_version);
   }
 
@@ -124,6 +141,31 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   absl::Status FindTypes(std::vector<ExecutionType>* execution_types) final;
   absl::Status FindTypes(std::vector<ContextType>* context_types) final;
 
+  absl::Status CreateTypes(absl::Span<const ArtifactType> types,
+                           std::vector<int64>* type_ids) final;
+  absl::Status CreateTypes(absl::Span<const ExecutionType> types,
+                           std::vector<int64>* type_ids) final;
+  absl::Status CreateTypes(absl::Span<const ContextType> types,
+                           std::vector<int64>* type_ids) final;
+
+  absl::Status AddTypeProperties(absl::Span<const ArtifactType> types) final;
+  absl::Status AddTypeProperties(absl::Span<const ExecutionType> types) final;
+  absl::Status AddTypeProperties(absl::Span<const ContextType> types) final;
+
+  absl::Status FindTypesByNames(absl::Span<const std::string> names,
+                                std::vector<ArtifactType>* types) final;
+  absl::Status FindTypesByNames(absl::Span<const std::string> names,
+                                std::vector<ExecutionType>* types) final;
+  absl::Status FindTypesByNames(absl::Span<const std::string> names,
+                                std::vector<ContextType>* types) final;
+
+  absl::Status FindTypesByIds(absl::Span<const int64> type_ids,
+                              std::vector<ArtifactType>* types) final;
+  absl::Status FindTypesByIds(absl::Span<const int64> type_ids,
+                              std::vector<ExecutionType>* types) final;
+  absl::Status FindTypesByIds(absl::Span<const int64> type_ids,
+                              std::vector<ContextType>* types) final;
+
   absl::Status CreateParentTypeInheritanceLink(
       const ArtifactType& type, const ArtifactType& parent_type) final;
   absl::Status CreateParentTypeInheritanceLink(
@@ -144,9 +186,20 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   absl::Status CreateArtifact(const Artifact& artifact,
                               int64* artifact_id) final;
 
+  absl::Status CreateArtifacts(absl::Span<const Artifact> artifacts,
+                               std::vector<int64>* artifact_ids) final;
+
+  absl::Status CreateArtifactIfNotExist(const Artifact& artifact,
+                                        int64* artifact_id,
+                                        bool* is_created) final;
+
   absl::Status FindArtifactsById(absl::Span<const int64> artifact_ids,
                                  std::vector<Artifact>* artifacts) final;
 
+  absl::Status FindArtifactLastUpdateTimes(
+      absl::Span<const int64> artifact_ids,
+      absl::flat_hash_map<int64, int64>* last_update_times) final;
+
   absl::Status FindArtifacts(std::vector<Artifact>* artifacts) final;
 
   absl::Status ListArtifacts(const ListOperationOptions& options,
@@ -161,6 +214,15 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
                             std::vector<Context>* contexts,
                             std::string* next_page_token) final;
 
+  absl::Status CountArtifacts(const CountOptions& options,
+                              std::vector<NodeCount>* counts) final;
+
+  absl::Status CountExecutions(const CountOptions& options,
+                               std::vector<NodeCount>* counts) final;
+
+  absl::Status CountContexts(const CountOptions& options,
+                             std::vector<NodeCount>* counts) final;
+
   absl::Status FindArtifactsByTypeId(
       int64 artifact_type_id, absl::optional<ListOperationOptions> list_options,
       std::vector<Artifact>* artifacts, std::string* next_page_token) final;
@@ -177,6 +239,9 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   absl::Status CreateExecution(const Execution& execution,
                                int64* execution_id) final;
 
+  absl::Status CreateExecutions(absl::Span<const Execution> executions,
+                                std::vector<int64>* execution_ids) final;
+
   absl::Status FindExecutionsById(absl::Span<const int64> execution_ids,
                                   std::vector<Execution>* executions) final;
 
@@ -190,10 +255,20 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
       absl::optional<ListOperationOptions> list_options,
       std::vector<Execution>* executions, std::string* next_page_token) final;
 
+  absl::Status FindActiveExecutionsByTypeId(
+      int64 execution_type_id, std::vector<Execution>* executions) final;
+
   absl::Status UpdateExecution(const Execution& execution) final;
 
   absl::Status CreateContext(const Context& context, int64* context_id) final;
 
+  absl::Status CreateContexts(absl::Span<const Context> contexts,
+                              std::vector<int64>* context_ids) final;
+
+  absl::Status CreateContextIfNotExist(const Context& context,
+                                       int64* context_id,
+                                       bool* is_created) final;
+
   absl::Status FindContextsById(absl::Span<const int64> context_ids,
                                 std::vector<Context>* contexts) final;
 
@@ -211,19 +286,59 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
 
   absl::Status CreateEvent(const Event& event, int64* event_id) final;
 
+  absl::Status CreateEvents(absl::Span<const Event> events,
+                            std::vector<int64>* event_ids) final;
+
   absl::Status FindEventsByArtifacts(const std::vector<int64>& artifact_ids,
                                      std::vector<Event>* events) final;
 
   absl::Status FindEventsByExecutions(const std::vector<int64>& execution_ids,
                                       std::vector<Event>* events) final;
 
+  absl::Status ListEventsByArtifacts(absl::Span<const int64> artifact_ids,
+                                     absl::Span<const Event::Type> event_types,
+                                     const ListOperationOptions& options,
+                                     std::vector<Event>* events,
+                                     std::string* next_page_token) final;
+
+  absl::Status ListEventsByExecutions(absl::Span<const int64> execution_ids,
+                                      absl::Span<const Event::Type> event_types,
+                                      const ListOperationOptions& options,
+                                      std::vector<Event>* events,
+                                      std::string* next_page_token) final;
+
+  absl::Status ListEventsByTimeRange(
+      int64 min_milliseconds_since_epoch,
+      absl::optional<int64> max_milliseconds_since_epoch,
+      absl::Span<const Event::Type> event_types,
+      const ListOperationOptions& options, std::vector<Event>* events,
+      std::string* next_page_token) final;
+
   absl::Status CreateAssociation(const Association& association,
                                  int64* association_id) final;
 
+  absl::Status CreateAssociationsIfNotExist(
+      absl::Span<const Association> associations) final;
+
 
   absl::Status FindContextsByExecution(int64 execution_id,
                                        std::vector<Context>* contexts) final;
 
+  absl::Status FindContextsByExecutions(
+      absl::Span<const int64> execution_ids,
+      std::vector<Association>* associations,
+      std::vector<Context>* contexts) final;
+
+  absl::Status FindExecutionsByContexts(
+      absl::Span<const int64> context_ids, int64 max_num_per_context,
+      std::vector<Association>* associations,
+      std::vector<Execution>* executions) final;
+
+  absl::Status FindArtifactsByContexts(
+      absl::Span<const int64> context_ids, int64 max_num_per_context,
+      std::vector<Attribution>* attributions,
+      std::vector<Artifact>* artifacts) final;
+
   absl::Status FindExecutionsByContext(
       int64 context_id, std::vector<Execution>* executions) final;
 
@@ -234,6 +349,9 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   absl::Status CreateAttribution(const Attribution& attribution,
                                  int64* attribution_id) final;
 
+  absl::Status CreateAttributionsIfNotExist(
+      absl::Span<const Attribution> attributions) final;
+
   absl::Status FindContextsByArtifact(int64 artifact_id,
                                       std::vector<Context>* contexts) final;
 
@@ -252,12 +370,22 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   absl::Status FindChildContextsByContextId(
       int64 context_id, std::vector<Context>* contexts) final;
 
+  absl::Status FindAncestorContextsByContextId(
+      int64 context_id, int64 max_depth, std::vector<Context>* contexts) final;
+
+  absl::Status FindDescendantContextsByContextId(
+      int64 context_id, int64 max_depth, std::vector<Context>* contexts) final;
+
   absl::Status GetSchemaVersion(int64* db_version) final {
     return executor_->GetSchemaVersion(db_version);
   }
 
   int64 GetLibraryVersion() final { return executor_->GetLibraryVersion(); }
 
+  absl::Status GetTypeGeneration(int64* type_generation) final {
+    return executor_->SelectTypeGeneration(type_generation);
+  }
+
 
   // The method is currently used for accessing MLMD lineage.
   // TODO(b/178491112) Support Execution typed query_nodes.
@@ -269,6 +397,46 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
       absl::optional<std::string> boundary_executions,
       LineageGraph& subgraph) final;
 
+  absl::Status QueryLineageGraphIds(
+      const std::vector<Artifact>& query_nodes, int64 max_num_hops,
+      absl::optional<int64> max_nodes,
+      absl::optional<std::string> boundary_artifacts,
+      absl::optional<std::string> boundary_executions,
+      LineageGraph& subgraph) final;
+
+  void set_lineage_graph_index(
+      std::shared_ptr<LineageGraphIndex> index) final {
+    lineage_graph_index_ = std::move(index);
+  }
+
+  void set_property_string_dictionary(
+      std::shared_ptr<PropertyStringDictionary> dictionary) final {
+    executor_->set_property_string_dictionary(std::move(dictionary));
+  }
+
+  void set_property_value_compression(
+      const PropertyValueCompressionConfig& config) final {
+    executor_->set_property_value_compression(config);
+  }
+
+  void set_indexed_properties(
+      std::vector<IndexedProperty> indexed_properties) final {
+    executor_->set_indexed_properties(std::move(indexed_properties));
+  }
+
+  absl::Status FindArtifactsByDerivation(
+      absl::Span<const int64> artifact_ids, bool upstream, int64 max_num_hops,
+      absl::optional<int64> context_id,
+      std::vector<Artifact>* artifacts) final;
+
+  absl::Status FindChangeLogEntries(
+      int64 after_sequence_number, int64 max_num_entries,
+      std::vector<ChangeLogEntry>* entries) final;
+
+  absl::Status ArchiveExecutions(int64 max_last_update_time_since_epoch,
+                                 int64 max_num_executions,
+                                 int64* num_archived_executions) final;
+
 
   // Deletes a list of artifacts by id.
   // Returns detailed INTERNAL error, if query execution fails.
@@ -341,17 +509,63 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // Creates a Context (without properties).
   absl::Status CreateBasicNode(const Context& context, int64* node_id);
 
+  // Creates an Artifact (without properties) unless its type has an artifact
+  // with the same name.
+  absl::Status CreateBasicNodeIfNotExist(const Artifact& artifact,
+                                         int64* node_id, bool* is_created);
+
+  // Creates a Context (without properties) unless its type has a context with
+  // the same name.
+  absl::Status CreateBasicNodeIfNotExist(const Context& context,
+                                         int64* node_id, bool* is_created);
+
+  // Creates a batch of Artifacts (without properties).
+  absl::Status CreateBasicNodes(absl::Span<const Artifact> artifacts,
+                                std::vector<int64>* node_ids);
+
+  // Creates a batch of Executions (without properties).
+  absl::Status CreateBasicNodes(absl::Span<const Execution> executions,
+                                std::vector<int64>* node_ids);
+
+  // Creates a batch of Contexts (without properties).
+  absl::Status CreateBasicNodes(absl::Span<const Context> contexts,
+                                std::vector<int64>* node_ids);
+
+  // Creates the properties of a batch of Artifacts with ids `node_ids`.
+  absl::Status CreateNodeProperties(absl::Span<const int64> node_ids,
+                                    absl::Span<const Artifact> artifacts);
+
+  // Creates the properties of a batch of Executions with ids `node_ids`.
+  absl::Status CreateNodeProperties(absl::Span<const int64> node_ids,
+                                    absl::Span<const Execution> executions);
+
+  // Creates the properties of a batch of Contexts with ids `node_ids`.
+  absl::Status CreateNodeProperties(absl::Span<const int64> node_ids,
+                                    absl::Span<const Context> contexts);
+
   // Retrieves nodes (and their properties) based on the provided 'ids'.
   // 'header' contains the non-property information, and 'properties' contains
   // information about properties. The node id is present in both record sets
   // and can be used to join the information. The 'properties' are returned
   // using the same convention as
-  // QueryExecutor::Select{Node}PropertyBy{Node}ID().
+  // QueryExecutor::Select{Node}PropertyBy{Node}ID(). Only the properties of
+  // `projection` are retrieved.
   template <typename T>
   absl::Status RetrieveNodesById(
-      absl::Span<const int64> id, RecordSet* header, RecordSet* properties,
+      absl::Span<const int64> id,
+      const ListOperationOptions::PropertyProjection& projection,
+      RecordSet* header, RecordSet* properties,
       T* tag = nullptr /* used only for the template */);
 
+  // Appends the archived nodes of the `ids` to the `nodes`, with only the
+  // properties of `projection`. Only the executions are archived, so no other
+  // nodes are found.
+  template <typename T>
+  absl::Status RetrieveArchivedNodesById(
+      absl::Span<const int64> ids,
+      const ListOperationOptions::PropertyProjection& projection,
+      std::vector<T>& nodes);
+
   // Update an Artifact's type_id and URI.
   absl::Status RunNodeUpdate(const Artifact& artifact);
 
@@ -411,6 +625,43 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   template <typename Type>
   absl::Status CreateTypeImpl(const Type& type, int64* type_id);
 
+  // Creates a batch of types, and their properties, with one multi-row insert
+  // per table.
+  // Returns INVALID_ARGUMENT error, if any name field is not given.
+  // Returns INVALID_ARGUMENT error, if any property type is unknown.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename Type>
+  absl::Status CreateTypesImpl(absl::Span<const Type> types,
+                               std::vector<int64>* type_ids);
+
+  // Adds the properties of the `types` to the stored types of their ids, with
+  // a single multi-row insert.
+  // Returns INVALID_ARGUMENT error, if any type has no id.
+  // Returns INVALID_ARGUMENT error, if any property type is unknown.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename Type>
+  absl::Status AddTypePropertiesImpl(absl::Span<const Type> types);
+
+  // Finds the types of all versions with the given `names`, and their
+  // properties, with one query per table.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename MessageType>
+  absl::Status FindTypesByNamesImpl(absl::Span<const std::string> names,
+                                    std::vector<MessageType>* types);
+
+  // Finds the types with the given `type_ids` from the type cache, and the
+  // missing ones and their properties with one query per table.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename MessageType>
+  absl::Status FindTypesByIdsImpl(absl::Span<const int64> type_ids,
+                                  std::vector<MessageType>* types);
+
+  // Reads the properties of the `types` found without them, with a single
+  // query.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename MessageType>
+  absl::Status FindTypeProperties(std::vector<MessageType>* types);
+
   // Generates a query to find all type instances.
   absl::Status GenerateFindAllTypeInstancesQuery(const TypeKind type_kind,
                                                  RecordSet* record_set);
@@ -450,11 +701,29 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
                             absl::optional<absl::string_view> version,
                             MessageType* type);
 
-  // Finds all type instances of the type `MessageType`.
+  // Finds all type instances of the type `MessageType`, and inserts them to the
+  // type cache.
   // Returns detailed INTERNAL error, if query execution fails.
   template <typename MessageType>
   absl::Status FindAllTypeInstancesImpl(std::vector<MessageType>* types);
 
+  // Validates the `type_cache_` once per transaction, by comparing the type
+  // generation stored in the db with the one of the cached types. The cache is
+  // cleared if the stored types have changed since they were cached. Then
+  // `type_cache_enabled_` tells if the cache can be used in the transaction.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status ValidateTypeCache();
+
+  // Clears the `type_cache_` and increases the type generation in the db, so
+  // that the types cached by other connections are cleared once the current
+  // transaction commits. The cache is not used for the rest of the transaction.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status InvalidateTypeCache();
+
+  // Clears the `type_cache_` when the schema of the db is (re)created or
+  // migrated, which does not change the type generation in the db.
+  void ResetTypeCache();
+
   // Updates an existing type. A type is one of {ArtifactType, ExecutionType,
   // ContextType}
   // Returns INVALID_ARGUMENT error, if name field is not given.
@@ -484,8 +753,28 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   template <typename Node, typename NodeType>
   absl::Status CreateNodeImpl(const Node& node, int64* node_id);
 
+  // Creates a `Node`, which is one of {`Artifact`, `Context`}, unless its
+  // type has a node with the same name, then returns the id of the created or
+  // the stored node. The properties of a stored node are not changed.
+  // Returns INVALID_ARGUMENT error, if the node has no name, or does not align
+  // with its type.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename Node, typename NodeType>
+  absl::Status CreateNodeIfNotExistImpl(const Node& node, int64* node_id,
+                                        bool* is_created);
+
+  // Creates a batch of `Node`s, which is one of {`Artifact`, `Execution`,
+  // `Context`}, then returns the assigned node ids in the same order. The type
+  // of each node is looked up once per batch.
+  // Returns INVALID_ARGUMENT error, if any node does not align with its type.
+  // Returns detailed INTERNAL error, if query execution fails.
+  template <typename Node, typename NodeType>
+  absl::Status CreateNodesImpl(absl::Span<const Node> nodes,
+                               std::vector<int64>* node_ids);
+
   // Queries a `Node` which is one of {`Artifact`, `Execution`, `Context`} by
-  // an id.
+  // an id, to be updated. The archived executions are not updated, so they
+  // are not found.
   // Returns NOT_FOUND error, if the given id cannot be found.
   // Returns detailed INTERNAL error, if query execution fails.
   template <typename Node>
@@ -494,14 +783,27 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   // Retrieves a set of `Node` which is one of {`Artifact`, `Execution`,
   // `Context`} by the given 'ids'.
   // 'skipped_ids_ok' controls the return error value if any of the ids are not
-  // found.
+  // found. The nodes only have the properties of `projection`. The archived
+  // executions are found unless `include_archived` is false.
   // Returns INVALID_ARGUMENT if node_ids is empty or nodes is not empty.
   // Returns detailed INTERNAL error if query execution fails.
   // If any ids are not found then returns NOT_FOUND if skipped_ids_ok is true,
   // otherwise INTERNAL error.
   template <typename Node>
-  absl::Status FindNodesImpl(absl::Span<const int64> node_ids,
-                             bool skipped_ids_ok, std::vector<Node>& nodes);
+  absl::Status FindNodesImpl(
+      absl::Span<const int64> node_ids, bool skipped_ids_ok,
+      std::vector<Node>& nodes,
+      const ListOperationOptions::PropertyProjection& projection =
+          ListOperationOptions::PropertyProjection::default_instance(),
+      bool include_archived = true);
+
+  // Finds the nodes of `node_ids`, which may repeat, with FindNodesImpl, and
+  // sets `nodes` to them ordered by id, each of them once.
+  // Returns detailed INTERNAL error, if query execution fails or an id is not
+  //   found.
+  template <typename Node>
+  absl::Status FindNodesOrderedById(std::vector<int64> node_ids,
+                                    std::vector<Node>* nodes);
 
   // Updates a `Node` which is one of {`Artifact`, `Execution`, `Context`}.
   // Returns INVALID_ARGUMENT error, if the node cannot be found
@@ -517,6 +819,15 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
   absl::Status FindEventsFromRecordSet(const RecordSet& event_record_set,
                                        std::vector<Event>* events);
 
+  // Lists a page of the events using `options`, which are read by
+  // `list_events`, a callable of (const ListOperationOptions&, RecordSet*)
+  // running a List*UsingOptions query of the executor.
+  template <typename ListEvents>
+  absl::Status ListEventsImpl(const ListOperationOptions& options,
+                              ListEvents list_events,
+                              std::vector<Event>* events,
+                              std::string* next_page_token);
+
   // Takes a record set that has one record per association and parses it into
   // an Association object for each record.
   // Returns INVALID_ARGUMENT error, if the `associations` is null.
@@ -569,44 +880,117 @@ class RDBMSMetadataAccessObject : public MetadataAccessObject {
                                       ParentContextTraverseDirection direction,
                                       std::vector<Context>& output_contexts);
 
+  // Queries the contexts within `max_depth` levels of the ParentContext
+  // relation from a context_id in the `direction`, i.e., the ancestors or the
+  // descendants, with a recursive query, and returns them ordered by the least
+  // number of levels, then by id.
+  absl::Status FindContextHierarchyImpl(
+      int64 context_id, int64 max_depth,
+      ParentContextTraverseDirection direction,
+      std::vector<Context>& output_contexts);
+
   // The utilities to expand lineage `subgraph` within one hop from artifacts.
-  // For the `input_artifacts`, their neighborhood executions that do not
-  // satisfy `boundary_condition` are visited and output as `output_executions`.
+  // For the `input_artifacts`, their neighborhood executions within the
+  // `boundary`, if any, are visited and output as `output_executions`.
   // The `output_executions` and the events between `input_artifacts` are added
   // to the `subgraph`. The `visited_execution_ids` captures the already
   // visited executions in previous traversal, while the `visited_artifact_ids`
   // maintains previously visited and the newly visited `input_artifacts`.
+  // The `output_executions` only have their ids, and at most `max_nodes` of
+  // them with the smallest ids are kept.
   absl::Status ExpandLineageGraphImpl(
       const std::vector<Artifact>& input_artifacts, int64 max_nodes,
-      absl::optional<std::string> boundary_condition,
+      const QueryExecutor::CompiledBoundary* boundary,
       const absl::flat_hash_set<int64>& visited_execution_ids,
       absl::flat_hash_set<int64>& visited_artifact_ids,
       std::vector<Execution>& output_executions, LineageGraph& subgraph);
 
   // The utilities to expand lineage `subgraph` within one hop from executions.
-  // For the `input_executions`, their neighborhood artifacts that do not
-  // satisfy `boundary_condition` are visited and output as `output_artifacts`.
+  // For the `input_executions`, their neighborhood artifacts within the
+  // `boundary`, if any, are visited and output as `output_artifacts`.
   // The `output_artifacts` and the events between `input_executions` are added
   // to the `subgraph`. The `visited_artifact_ids` captures the already
   // visited artifacts in previous traversal, while the `visited_execution_ids`
   // maintains previously visited and the newly visited `input_executions`.
+  // The `output_artifacts` only have their ids, and at most `max_nodes` of
+  // them with the smallest ids are kept.
   absl::Status ExpandLineageGraphImpl(
       const std::vector<Execution>& input_executions, int64 max_nodes,
-      absl::optional<std::string> boundary_condition,
+      const QueryExecutor::CompiledBoundary* boundary,
       const absl::flat_hash_set<int64>& visited_artifact_ids,
       absl::flat_hash_set<int64>& visited_execution_ids,
       std::vector<Artifact>& output_artifacts, LineageGraph& subgraph);
 
-  // Given `boundary_condition`, the utility method keeps nodes that satisfy
-  // the `boundary_condition`, and removes any nodes that do not satisfy the
-  // `boundary_condition` from `unvisited_node_ids`.
-  template <typename Node>
+  // Replaces the id-only artifacts after the first `num_query_nodes` ones and
+  // the id-only executions of the `subgraph` with the nodes read by their ids.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status ReadLineageGraphNodes(int num_query_nodes,
+                                     LineageGraph& subgraph);
+
+  // Rebuilds the `lineage_graph_index_` of the events read at the last
+  // sequence number of the change log.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status RebuildLineageGraphIndex();
+
+  // Rebuilds the `lineage_graph_index_`, if it is due to be rebuilt and no
+  // other connection is rebuilding it, and applies the change log entries
+  // after its sequence number to it.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status RefreshLineageGraphIndex();
+
+  // Traverses the lineage graph from the `query_artifact_ids` within
+  // `max_num_hops` with a round-trip per hop, and sets the at most `max_nodes`
+  // reached `nodes` in the order of LineageGraphIndex::Traverse. It is used
+  // instead of the recursive query when there are archived events, which the
+  // recursive query does not read.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status TraverseLineageGraphByHops(
+      absl::Span<const int64> query_artifact_ids, int64 max_num_hops,
+      int64 max_nodes, std::vector<LineageGraphIndex::Node>* nodes);
+
+  // Traverses the lineage `subgraph` from the `query_nodes` within
+  // `max_num_hops` in the `lineage_graph_index_` once it is built, or else in
+  // the database with a recursive query. Keeps at most `max_nodes` reached
+  // nodes that are nearest to the `query_nodes`, then adds them and the events
+  // between the nodes to the `subgraph`. It is used when there are no boundary
+  // conditions, as the traversal then needs a single query instead of a
+  // round-trip per hop. If `ids_only`, the reached nodes only have their ids.
+  // The nodes reached in the index but not in the database, e.g., created
+  // after the transaction started, are dropped.
+  // Returns detailed INTERNAL error, if query execution fails.
+  absl::Status TraverseLineageGraphImpl(
+      const std::vector<Artifact>& query_nodes, int64 max_num_hops,
+      int64 max_nodes, bool ids_only, LineageGraph& subgraph);
+
+  // Implements QueryLineageGraph, and QueryLineageGraphIds if `ids_only`.
+  absl::Status QueryLineageGraphImpl(
+      const std::vector<Artifact>& query_nodes, int64 max_num_hops,
+      absl::optional<int64> max_nodes,
+      absl::optional<std::string> boundary_artifacts,
+      absl::optional<std::string> boundary_executions, bool ids_only,
+      LineageGraph& subgraph);
+
+  // Given a `boundary`, the utility method keeps nodes within the `boundary`,
+  // and removes any nodes outside of it from `unvisited_node_ids` with a
+  // single query. A null `boundary` keeps all the nodes.
   absl::Status SkipBoundaryNodesImpl(
-      absl::optional<std::string> boundary_condition,
+      const QueryExecutor::CompiledBoundary* boundary,
       absl::flat_hash_set<int64>& unvisited_node_ids);
 
   std::unique_ptr<QueryExecutor> executor_;
 
+  // Caches the types found by FindTypeImpl across transactions. The cached
+  // types are read at the `type_cache_generation_` of the stored types.
+  TypeCache type_cache_;
+  absl::optional<int64> type_cache_generation_;
+  // The transaction in which the `type_cache_` is last validated, and whether
+  // it can be used in the transaction.
+  absl::optional<int64> type_cache_transaction_id_;
+  bool type_cache_enabled_ = false;
+
+  // The index of the lineage graph traversed by QueryLineageGraph, or null.
+  std::shared_ptr<LineageGraphIndex> lineage_graph_index_;
+
   friend RDBMSMetadataAccessObjectTest;
 };
 
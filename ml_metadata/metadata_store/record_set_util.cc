@@ -0,0 +1,190 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/record_set_util.h"
+
+#include <string>
+#include <utility>
+
+#include <glog/logging.h>
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+
+namespace ml_metadata {
+
+namespace {
+
+// Returns true if the values in `record_set` are stored in typed columns.
+bool HasTypedColumns(const RecordSet& record_set) {
+  return record_set.columns_size() > 0;
+}
+
+int NumColumnRows(const RecordSet::Column& column) {
+  switch (column.type()) {
+    case RecordSet::Column::INT:
+      return column.int_values_size();
+    case RecordSet::Column::DOUBLE:
+      return column.double_values_size();
+    default:
+      return column.string_values_size();
+  }
+}
+
+// Marks whether the value appended last to `column` is NULL.
+void AppendIsNull(const bool is_null, RecordSet::Column* column) {
+  if (column->is_null().empty()) {
+    if (!is_null) return;
+    // Lazily marks the previous rows when the first NULL is appended.
+    column->mutable_is_null()->Resize(NumColumnRows(*column) - 1, false);
+  }
+  column->add_is_null(is_null);
+}
+
+}  // namespace
+
+int NumRows(const RecordSet& record_set) {
+  if (HasTypedColumns(record_set)) {
+    return NumColumnRows(record_set.columns(0));
+  }
+  return record_set.records_size();
+}
+
+bool IsNullValue(const RecordSet& record_set, const int row,
+                 const int column) {
+  if (HasTypedColumns(record_set)) {
+    const RecordSet::Column& typed_column = record_set.columns(column);
+    return !typed_column.is_null().empty() && typed_column.is_null(row);
+  }
+  return record_set.records(row).values(column) == kMetadataSourceNull;
+}
+
+int64 GetInt64Value(const RecordSet& record_set, const int row,
+                    const int column) {
+  if (HasTypedColumns(record_set)) {
+    const RecordSet::Column& typed_column = record_set.columns(column);
+    if (typed_column.type() == RecordSet::Column::INT) {
+      return typed_column.int_values(row);
+    } else if (typed_column.type() == RecordSet::Column::DOUBLE) {
+      return static_cast<int64>(typed_column.double_values(row));
+    }
+  }
+  int64 value;
+  CHECK(absl::SimpleAtoi(GetStringValue(record_set, row, column), &value));
+  return value;
+}
+
+double GetDoubleValue(const RecordSet& record_set, const int row,
+                      const int column) {
+  if (HasTypedColumns(record_set)) {
+    const RecordSet::Column& typed_column = record_set.columns(column);
+    if (typed_column.type() == RecordSet::Column::DOUBLE) {
+      return typed_column.double_values(row);
+    } else if (typed_column.type() == RecordSet::Column::INT) {
+      return typed_column.int_values(row);
+    }
+  }
+  double value;
+  CHECK(absl::SimpleAtod(GetStringValue(record_set, row, column), &value));
+  return value;
+}
+
+bool GetBoolValue(const RecordSet& record_set, const int row,
+                  const int column) {
+  if (HasTypedColumns(record_set) &&
+      record_set.columns(column).type() == RecordSet::Column::INT) {
+    return record_set.columns(column).int_values(row) != 0;
+  }
+  bool value;
+  CHECK(absl::SimpleAtob(GetStringValue(record_set, row, column), &value));
+  return value;
+}
+
+std::string GetStringValue(const RecordSet& record_set, const int row,
+                           const int column) {
+  if (!HasTypedColumns(record_set)) {
+    return record_set.records(row).values(column);
+  }
+  if (IsNullValue(record_set, row, column)) {
+    return kMetadataSourceNull;
+  }
+  const RecordSet::Column& typed_column = record_set.columns(column);
+  switch (typed_column.type()) {
+    case RecordSet::Column::INT:
+      return absl::StrCat(typed_column.int_values(row));
+    case RecordSet::Column::DOUBLE:
+      // Keeps the full precision of the double.
+      return absl::StrFormat("%.17g", typed_column.double_values(row));
+    default:
+      return typed_column.string_values(row);
+  }
+}
+
+void AppendNullValue(RecordSet::Column* column) {
+  switch (column->type()) {
+    case RecordSet::Column::INT:
+      column->add_int_values(0);
+      break;
+    case RecordSet::Column::DOUBLE:
+      column->add_double_values(0);
+      break;
+    default:
+      column->add_string_values();
+  }
+  AppendIsNull(/*is_null=*/true, column);
+}
+
+void AppendInt64Value(const int64 value, RecordSet::Column* column) {
+  CHECK_EQ(column->type(), RecordSet::Column::INT);
+  column->add_int_values(value);
+  AppendIsNull(/*is_null=*/false, column);
+}
+
+void AppendDoubleValue(const double value, RecordSet::Column* column) {
+  CHECK_EQ(column->type(), RecordSet::Column::DOUBLE);
+  column->add_double_values(value);
+  AppendIsNull(/*is_null=*/false, column);
+}
+
+void AppendStringValue(const absl::string_view value,
+                       RecordSet::Column* column) {
+  CHECK_EQ(column->type(), RecordSet::Column::STRING);
+  column->add_string_values(std::string(value));
+  AppendIsNull(/*is_null=*/false, column);
+}
+
+void ConvertColumnsToRecords(RecordSet* record_set) {
+  if (!HasTypedColumns(*record_set)) return;
+  const int num_rows = NumRows(*record_set);
+  record_set->clear_records();
+  for (int row = 0; row < num_rows; row++) {
+    RecordSet::Record* record = record_set->add_records();
+    for (int column = 0; column < record_set->columns_size(); column++) {
+      RecordSet::Column* typed_column = record_set->mutable_columns(column);
+      if (typed_column->type() == RecordSet::Column::STRING &&
+          !IsNullValue(*record_set, row, column)) {
+        record->add_values(
+            std::move(*typed_column->mutable_string_values(row)));
+      } else {
+        record->add_values(GetStringValue(*record_set, row, column));
+      }
+    }
+  }
+  record_set->clear_columns();
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,69 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_RECORD_SET_UTIL_H_
+#define ML_METADATA_METADATA_STORE_RECORD_SET_UTIL_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+
+namespace ml_metadata {
+
+// Utilities to read a RecordSet returned by a MetadataSource, whose values are
+// either strings in `records`, or typed values in `columns`. The values are
+// read from the typed columns without a string round-trip, and converted only
+// if the requested type differs from the column type.
+// The `row` and `column` must be in range.
+
+// Returns the number of rows in `record_set`.
+int NumRows(const RecordSet& record_set);
+
+// Returns true if the value at `row` and `column` is NULL.
+bool IsNullValue(const RecordSet& record_set, int row, int column);
+
+// Returns the value at `row` and `column` as an int64.
+// Check-fails if the value is a string that cannot be parsed as an int64.
+int64 GetInt64Value(const RecordSet& record_set, int row, int column);
+
+// Returns the value at `row` and `column` as a double.
+// Check-fails if the value is a string that cannot be parsed as a double.
+double GetDoubleValue(const RecordSet& record_set, int row, int column);
+
+// Returns the value at `row` and `column` as a bool.
+// Check-fails if the value is a string that cannot be parsed as a bool.
+bool GetBoolValue(const RecordSet& record_set, int row, int column);
+
+// Returns the value at `row` and `column` as a string. The numbers in typed
+// columns are formatted, and NULL is returned as kMetadataSourceNull.
+std::string GetStringValue(const RecordSet& record_set, int row, int column);
+
+// Appends a NULL value to a typed `column`.
+void AppendNullValue(RecordSet::Column* column);
+
+// Appends a value to a typed `column`.
+// Check-fails if the column type does not match the value.
+void AppendInt64Value(int64 value, RecordSet::Column* column);
+void AppendDoubleValue(double value, RecordSet::Column* column);
+void AppendStringValue(absl::string_view value, RecordSet::Column* column);
+
+// Moves the values of the typed columns in `record_set` to its records, so
+// that the record set can be consumed as string records.
+void ConvertColumnsToRecords(RecordSet* record_set);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_RECORD_SET_UTIL_H_
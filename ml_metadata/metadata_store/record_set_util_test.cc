@@ -0,0 +1,95 @@
+/* Copyright 2021 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/record_set_util.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::EqualsProto;
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+
+// Returns a record set of (id, name, score) with typed columns, whose second
+// row has a NULL name.
+RecordSet GetTypedRecordSet() {
+  RecordSet record_set;
+  record_set.add_column_names("id");
+  record_set.add_column_names("name");
+  record_set.add_column_names("score");
+  RecordSet::Column* id = record_set.add_columns();
+  id->set_type(RecordSet::Column::INT);
+  RecordSet::Column* name = record_set.add_columns();
+  name->set_type(RecordSet::Column::STRING);
+  RecordSet::Column* score = record_set.add_columns();
+  score->set_type(RecordSet::Column::DOUBLE);
+  AppendInt64Value(1, id);
+  AppendStringValue("a", name);
+  AppendDoubleValue(0.5, score);
+  AppendInt64Value(2, id);
+  AppendNullValue(name);
+  AppendDoubleValue(2, score);
+  return record_set;
+}
+
+TEST(RecordSetUtilTest, ReadTypedColumns) {
+  const RecordSet record_set = GetTypedRecordSet();
+  EXPECT_EQ(NumRows(record_set), 2);
+  EXPECT_EQ(GetInt64Value(record_set, /*row=*/1, /*column=*/0), 2);
+  EXPECT_FALSE(IsNullValue(record_set, /*row=*/0, /*column=*/1));
+  EXPECT_EQ(GetStringValue(record_set, /*row=*/0, /*column=*/1), "a");
+  EXPECT_TRUE(IsNullValue(record_set, /*row=*/1, /*column=*/1));
+  EXPECT_EQ(GetStringValue(record_set, /*row=*/1, /*column=*/1),
+            kMetadataSourceNull);
+  EXPECT_EQ(GetDoubleValue(record_set, /*row=*/0, /*column=*/2), 0.5);
+  // Converts the values to the requested types.
+  EXPECT_EQ(GetInt64Value(record_set, /*row=*/1, /*column=*/2), 2);
+  EXPECT_EQ(GetDoubleValue(record_set, /*row=*/0, /*column=*/0), 1.0);
+  EXPECT_TRUE(GetBoolValue(record_set, /*row=*/0, /*column=*/0));
+  EXPECT_EQ(GetStringValue(record_set, /*row=*/0, /*column=*/0), "1");
+}
+
+TEST(RecordSetUtilTest, ReadRecords) {
+  const RecordSet record_set = ParseTextProtoOrDie<RecordSet>(R"pb(
+    column_names: "id"
+    column_names: "name"
+    records: { values: "1" values: "a" }
+    records: { values: "2" values: "__MLMD_NULL__" }
+  )pb");
+  EXPECT_EQ(NumRows(record_set), 2);
+  EXPECT_EQ(GetInt64Value(record_set, /*row=*/1, /*column=*/0), 2);
+  EXPECT_TRUE(GetBoolValue(record_set, /*row=*/0, /*column=*/0));
+  EXPECT_EQ(GetStringValue(record_set, /*row=*/0, /*column=*/1), "a");
+  EXPECT_TRUE(IsNullValue(record_set, /*row=*/1, /*column=*/1));
+}
+
+TEST(RecordSetUtilTest, ConvertColumnsToRecords) {
+  RecordSet record_set = GetTypedRecordSet();
+  ConvertColumnsToRecords(&record_set);
+  EXPECT_THAT(record_set, EqualsProto(ParseTextProtoOrDie<RecordSet>(R"pb(
+                column_names: "id"
+                column_names: "name"
+                column_names: "score"
+                records: { values: "1" values: "a" values: "0.5" }
+                records: { values: "2" values: "__MLMD_NULL__" values: "2" }
+              )pb")));
+}
+
+}  // namespace
+}  // namespace ml_metadata
@@ -0,0 +1,126 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/replicated_metadata_store_pool.h"
+
+#include <glog/logging.h>
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+
+ReplicatedMetadataStorePool::ReplicatedMetadataStorePool(
+    const ConnectionConfig& connection_config,
+    const MetadataStorePool::ConnectionPoolConfig& pool_config,
+    const ReadReplicaConfig& read_replica_config)
+    : primary_(connection_config, pool_config),
+      unhealthy_replica_backoff_(
+          absl::Seconds(read_replica_config.unhealthy_replica_backoff_sec())) {
+  for (const MySQLDatabaseConfig& replica : read_replica_config.replicas()) {
+    ConnectionConfig replica_config = connection_config;
+    *replica_config.mutable_mysql() = replica;
+    replica_config.mutable_mysql()->set_skip_db_creation(true);
+    replicas_.push_back(
+        absl::make_unique<MetadataStorePool>(replica_config, pool_config));
+  }
+  unhealthy_until_.resize(replicas_.size(), absl::InfinitePast());
+}
+
+absl::Status ReplicatedMetadataStorePool::AcquireForWrite(
+    MetadataStorePool::ScopedStore* store) {
+  MLMD_RETURN_IF_ERROR(primary_.Acquire(store));
+  store->release_counter_ = &write_generation_;
+  return absl::OkStatus();
+}
+
+absl::Status ReplicatedMetadataStorePool::AcquireForRead(
+    const bool read_your_writes, MetadataStorePool::ScopedStore* store) {
+  if (!read_your_writes) {
+    // Each replica is tried at most once, as a failed one is marked unhealthy.
+    for (int attempt = 0; attempt < replicas_.size(); attempt++) {
+      const int replica_index = NextHealthyReplica();
+      if (replica_index < 0) break;
+      const absl::Status status = replicas_[replica_index]->Acquire(store);
+      if (status.ok()) {
+        return absl::OkStatus();
+      }
+      LOG(WARNING) << "Read replica " << replica_index
+                   << " failed to connect: " << status;
+      MarkUnhealthy(replica_index);
+    }
+  }
+  return primary_.Acquire(store);
+}
+
+MetadataStorePool* ReplicatedMetadataStorePool::SelectReadPool(
+    const bool read_your_writes) {
+  if (read_your_writes) {
+    return &primary_;
+  }
+  const int replica_index = NextHealthyReplica();
+  return replica_index < 0 ? &primary_ : replicas_[replica_index].get();
+}
+
+absl::Status ReplicatedMetadataStorePool::Prefill() {
+  const absl::Status status = primary_.Prefill();
+  if (!status.ok()) {
+    return status;
+  }
+  for (int i = 0; i < replicas_.size(); i++) {
+    const absl::Status replica_status = replicas_[i]->Prefill();
+    if (!replica_status.ok()) {
+      LOG(WARNING) << "Read replica " << i
+                   << " failed to connect: " << replica_status;
+      MarkUnhealthy(i);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ReplicatedMetadataStorePool::WarmUp() {
+  const absl::Status status = primary_.WarmUp();
+  if (!status.ok()) {
+    return status;
+  }
+  for (int i = 0; i < replicas_.size(); i++) {
+    const absl::Status replica_status = replicas_[i]->WarmUp();
+    LOG_IF(WARNING, !replica_status.ok())
+        << "Read replica " << i << " failed to warm up: " << replica_status;
+  }
+  return absl::OkStatus();
+}
+
+int ReplicatedMetadataStorePool::NextHealthyReplica() {
+  absl::MutexLock lock(&mu_);
+  const absl::Time now = absl::Now();
+  for (int i = 0; i < replicas_.size(); i++) {
+    const int replica_index = next_replica_;
+    next_replica_ = (next_replica_ + 1) % replicas_.size();
+    if (unhealthy_until_[replica_index] <= now) {
+      return replica_index;
+    }
+  }
+  return -1;
+}
+
+void ReplicatedMetadataStorePool::MarkUnhealthy(const int replica_index) {
+  absl::MutexLock lock(&mu_);
+  unhealthy_until_[replica_index] = absl::Now() + unhealthy_replica_backoff_;
+}
+
+}  // namespace ml_metadata
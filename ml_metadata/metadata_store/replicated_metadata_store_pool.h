@@ -0,0 +1,126 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_REPLICATED_METADATA_STORE_POOL_H_
+#define ML_METADATA_METADATA_STORE_REPLICATED_METADATA_STORE_POOL_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// The gRPC metadata key, with which a client pins its reads to the primary to
+// read its own writes.
+constexpr char kReadYourWritesMetadataKey[] = "mlmd-read-your-writes";
+
+// Connection pools to a primary metadata source and its read replicas. The
+// writes use the primary, and the reads are balanced round-robin over the
+// healthy replicas. A replica that fails to connect is skipped for
+// `unhealthy_replica_backoff_sec`, and the reads fall back to the primary when
+// no replica is healthy. Without replicas, every call uses the primary.
+// It is thread-safe.
+//
+// Usage example:
+//
+//    ReplicatedMetadataStorePool pool(connection_config, pool_config,
+//                                     read_replica_config);
+//    MetadataStorePool::ScopedStore store;
+//    MLMD_RETURN_IF_ERROR(
+//        pool.AcquireForRead(/*read_your_writes=*/false, &store));
+//    MLMD_RETURN_IF_ERROR(store->GetArtifacts(request, &response));
+class ReplicatedMetadataStorePool {
+ public:
+  using ReadReplicaConfig = MetadataStoreServerConfig::ReadReplicaConfig;
+
+  // Creates a pool of `pool_config` for the primary `connection_config` and
+  // for each of the MySQL replicas in `read_replica_config`, which share the
+  // other connection options, e.g., the retry options, of the primary.
+  // Check-fails if `pool_config` is invalid.
+  ReplicatedMetadataStorePool(
+      const ConnectionConfig& connection_config,
+      const MetadataStorePool::ConnectionPoolConfig& pool_config,
+      const ReadReplicaConfig& read_replica_config = ReadReplicaConfig());
+
+  // Disallows copy.
+  ReplicatedMetadataStorePool(const ReplicatedMetadataStorePool&) = delete;
+  ReplicatedMetadataStorePool& operator=(const ReplicatedMetadataStorePool&) =
+      delete;
+
+  // Leases a store of the primary to `store`.
+  // Returns detailed errors from MetadataStorePool::Acquire.
+  absl::Status AcquireForWrite(MetadataStorePool::ScopedStore* store);
+
+  // Leases a store for a read-only call to `store`. It is a store of the
+  // primary if `read_your_writes` is true; otherwise the replicas are tried in
+  // turn, and the primary is used if none of them can be connected.
+  // Returns detailed errors from MetadataStorePool::Acquire of the primary.
+  absl::Status AcquireForRead(bool read_your_writes,
+                              MetadataStorePool::ScopedStore* store);
+
+  // Returns the pool that serves the reads of a multi-call operation, e.g., a
+  // stream of pages, which are read from the same replica, or from the primary
+  // if `read_your_writes` is true or no replica is healthy.
+  MetadataStorePool* SelectReadPool(bool read_your_writes);
+
+  // Opens `min_size` connections of every pool. A replica that fails to
+  // connect is marked unhealthy instead of failing the call.
+  // Returns detailed errors, if a connection to the primary fails to open.
+  absl::Status Prefill();
+
+  // Warms up the idle stores of every pool with MetadataStorePool::WarmUp. A
+  // replica failing to warm up is logged instead of failing the call.
+  // Returns detailed errors, if the stores of the primary fail to warm up.
+  absl::Status WarmUp();
+
+  // Returns the number of replicas.
+  int num_replicas() const { return replicas_.size(); }
+
+  // Returns the write generation, i.e., the number of stores leased by
+  // AcquireForWrite and returned so far. It increases once a write has
+  // committed, before its call returns, e.g., to tell whether a read that
+  // started at an earlier generation may miss a write.
+  int64 write_generation() const { return write_generation_.load(); }
+
+ private:
+  // Returns the index of the next healthy replica in the round-robin order, or
+  // -1 if no replica is healthy.
+  int NextHealthyReplica();
+
+  // Skips the `replica_index`-th replica for the backoff.
+  void MarkUnhealthy(int replica_index);
+
+  MetadataStorePool primary_;
+  std::vector<std::unique_ptr<MetadataStorePool>> replicas_;
+  const absl::Duration unhealthy_replica_backoff_;
+  std::atomic<int64> write_generation_{0};
+
+  absl::Mutex mu_;
+  // The replica tried first by the next read.
+  int next_replica_ ABSL_GUARDED_BY(mu_) = 0;
+  // The time until which each replica is skipped.
+  std::vector<absl::Time> unhealthy_until_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_REPLICATED_METADATA_STORE_POOL_H_
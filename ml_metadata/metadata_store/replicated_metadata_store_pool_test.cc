@@ -0,0 +1,105 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/replicated_metadata_store_pool.h"
+
+#include <utility>
+
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "ml_metadata/metadata_store/metadata_store_pool.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using testing::ParseTextProtoOrDie;
+
+ConnectionConfig GetFakeDatabaseConfig() {
+  ConnectionConfig connection_config;
+  connection_config.mutable_fake_database();
+  return connection_config;
+}
+
+TEST(ReplicatedMetadataStorePoolTest, UsesPrimaryWithoutReplicas) {
+  ReplicatedMetadataStorePool pool(
+      GetFakeDatabaseConfig(),
+      ParseTextProtoOrDie<MetadataStorePool::ConnectionPoolConfig>(
+          "max_size: 1"));
+  EXPECT_EQ(pool.num_replicas(), 0);
+  MetadataStore* primary_store = nullptr;
+  {
+    MetadataStorePool::ScopedStore store;
+    ASSERT_EQ(absl::OkStatus(), pool.AcquireForWrite(&store));
+    primary_store = store.get();
+  }
+  MetadataStorePool::ScopedStore store;
+  ASSERT_EQ(absl::OkStatus(),
+            pool.AcquireForRead(/*read_your_writes=*/false, &store));
+  EXPECT_EQ(store.get(), primary_store);
+  EXPECT_EQ(pool.SelectReadPool(/*read_your_writes=*/false),
+            pool.SelectReadPool(/*read_your_writes=*/true));
+}
+
+TEST(ReplicatedMetadataStorePoolTest, CountsTheReturnedWriteStores) {
+  ReplicatedMetadataStorePool pool(
+      GetFakeDatabaseConfig(),
+      ParseTextProtoOrDie<MetadataStorePool::ConnectionPoolConfig>(
+          "max_size: 2"));
+  EXPECT_EQ(pool.write_generation(), 0);
+  MetadataStorePool::ScopedStore write_store;
+  ASSERT_EQ(absl::OkStatus(), pool.AcquireForWrite(&write_store));
+  // The generation increases once the write is done.
+  EXPECT_EQ(pool.write_generation(), 0);
+  MetadataStorePool::ScopedStore moved_store = std::move(write_store);
+  write_store.Reset();
+  EXPECT_EQ(pool.write_generation(), 0);
+  moved_store.Reset();
+  EXPECT_EQ(pool.write_generation(), 1);
+  // The reads, even of the primary, do not change it.
+  {
+    MetadataStorePool::ScopedStore read_store;
+    ASSERT_EQ(absl::OkStatus(),
+              pool.AcquireForRead(/*read_your_writes=*/true, &read_store));
+  }
+  EXPECT_EQ(pool.write_generation(), 1);
+}
+
+TEST(ReplicatedMetadataStorePoolTest, ReadsFallBackToPrimary) {
+  // The replica cannot be connected.
+  ReplicatedMetadataStorePool pool(
+      GetFakeDatabaseConfig(),
+      ParseTextProtoOrDie<MetadataStorePool::ConnectionPoolConfig>(
+          "max_size: 1"),
+      ParseTextProtoOrDie<ReplicatedMetadataStorePool::ReadReplicaConfig>(
+          R"pb(
+            replicas { host: "127.0.0.1" port: 1 database: "mlmd" }
+            unhealthy_replica_backoff_sec: 3600
+          )pb"));
+  EXPECT_EQ(pool.num_replicas(), 1);
+  MetadataStorePool* primary_pool =
+      pool.SelectReadPool(/*read_your_writes=*/true);
+  EXPECT_NE(pool.SelectReadPool(/*read_your_writes=*/false), primary_pool);
+
+  MetadataStorePool::ScopedStore store;
+  ASSERT_EQ(absl::OkStatus(),
+            pool.AcquireForRead(/*read_your_writes=*/false, &store));
+  EXPECT_EQ(primary_pool->num_open_stores(), 1);
+  // The failed replica is skipped during the backoff.
+  EXPECT_EQ(pool.SelectReadPool(/*read_your_writes=*/false), primary_pool);
+}
+
+}  // namespace
+}  // namespace ml_metadata
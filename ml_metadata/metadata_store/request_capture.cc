@@ -0,0 +1,229 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/request_capture.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <glog/logging.h>
+#include "google/protobuf/io/zero_copy_stream_impl.h"
+#include "google/protobuf/util/delimited_message_util.h"
+#include "absl/container/btree_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/worker_pool.h"
+
+namespace ml_metadata {
+namespace {
+
+// The outcome of a replayed call.
+struct ReplayedCall {
+  absl::Duration latency;
+  absl::StatusCode code = absl::StatusCode::kOk;
+};
+
+// Returns the `percent` percentile of the `sorted_latencies` in microseconds.
+int64 LatencyPercentileUs(const std::vector<absl::Duration>& sorted_latencies,
+                          const int percent) {
+  return absl::ToInt64Microseconds(
+      sorted_latencies[sorted_latencies.size() * percent / 100]);
+}
+
+}  // namespace
+
+absl::Status RequestRecorder::Create(
+    const MetadataStoreServerConfig::RequestCaptureConfig& config,
+    std::unique_ptr<RequestRecorder>* recorder) {
+  if (config.filename().empty()) {
+    return absl::InvalidArgumentError(
+        "The filename of the request capture is not given");
+  }
+  if (config.sample_rate() <= 0 || config.sample_rate() > 1) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("The sample_rate of the request capture must be in "
+                     "(0, 1], got ",
+                     config.sample_rate()));
+  }
+  std::ofstream output(config.filename(),
+                       std::ios::binary | std::ios::out | std::ios::trunc);
+  output.write(kRequestCaptureMagic, std::strlen(kRequestCaptureMagic));
+  output.flush();
+  if (!output) {
+    return absl::InternalError(absl::StrCat(
+        "Cannot write the request capture file ", config.filename()));
+  }
+  recorder->reset(new RequestRecorder(config, std::move(output)));
+  return absl::OkStatus();
+}
+
+RequestRecorder::RequestRecorder(
+    const MetadataStoreServerConfig::RequestCaptureConfig& config,
+    std::ofstream output)
+    : sample_rate_(config.sample_rate()),
+      max_requests_(config.max_requests()),
+      output_(std::move(output)) {}
+
+bool RequestRecorder::ShouldRecord() {
+  if (max_requests_ > 0 && num_recorded_ >= max_requests_) {
+    return false;
+  }
+  return sample_rate_ >= 1 || absl::Bernoulli(bitgen_, sample_rate_);
+}
+
+void RequestRecorder::Record(const absl::string_view method,
+                             const google::protobuf::Message& request) {
+  {
+    absl::MutexLock lock(&mu_);
+    if (!ShouldRecord()) {
+      return;
+    }
+  }
+  // The request is serialized out of the lock, so that the concurrent calls
+  // only wait for each other to write.
+  CapturedRequest captured;
+  captured.set_method(std::string(method));
+  request.SerializeToString(captured.mutable_request());
+  absl::MutexLock lock(&mu_);
+  if (max_requests_ > 0 && num_recorded_ >= max_requests_) {
+    return;
+  }
+  // The time is taken under the lock, so that the requests are written in
+  // time order.
+  captured.set_time_us(absl::ToUnixMicros(absl::Now()));
+  if (!google::protobuf::util::SerializeDelimitedToOstream(captured,
+                                                           &output_) ||
+      !output_.flush()) {
+    LOG_EVERY_N(WARNING, 100) << "Cannot write the " << method
+                              << " request to the request capture file";
+    output_.clear();
+    return;
+  }
+  num_recorded_++;
+}
+
+int64 RequestRecorder::num_recorded() const {
+  absl::MutexLock lock(&mu_);
+  return num_recorded_;
+}
+
+absl::Status ReadCapturedRequests(std::istream* input,
+                                  std::vector<CapturedRequest>* requests) {
+  const size_t magic_size = std::strlen(kRequestCaptureMagic);
+  std::string magic(magic_size, '\0');
+  input->read(&magic[0], magic_size);
+  if (static_cast<size_t>(input->gcount()) != magic_size ||
+      magic != kRequestCaptureMagic) {
+    return absl::DataLossError("The input is not a request capture file");
+  }
+  google::protobuf::io::IstreamInputStream stream(input);
+  requests->clear();
+  while (true) {
+    CapturedRequest request;
+    bool clean_eof = false;
+    if (!google::protobuf::util::ParseDelimitedFromZeroCopyStream(
+            &request, &stream, &clean_eof)) {
+      if (clean_eof) {
+        return absl::OkStatus();
+      }
+      return absl::DataLossError(
+          absl::StrCat("The request capture file is malformed after ",
+                       requests->size(), " requests"));
+    }
+    requests->push_back(std::move(request));
+  }
+}
+
+absl::Status ReplayCapturedRequests(
+    const std::vector<CapturedRequest>& requests,
+    const RequestReplayConfig& config, const CapturedRequestCall& call,
+    RequestReplayReport* report) {
+  if (config.num_workers() <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("The num_workers of the replay must be positive, got ",
+                     config.num_workers()));
+  }
+  report->Clear();
+  if (requests.empty()) {
+    return absl::OkStatus();
+  }
+  // Each call writes its own slot, and the slots are read after the workers
+  // are joined.
+  std::vector<ReplayedCall> calls(requests.size());
+  std::vector<absl::Duration> start_delays(requests.size());
+  const absl::Time start = absl::Now();
+  {
+    WorkerPool pool(config.num_workers(), static_cast<int>(requests.size()));
+    for (size_t i = 0; i < requests.size(); ++i) {
+      absl::Time scheduled_time = absl::Now();
+      if (config.speedup() > 0) {
+        scheduled_time =
+            start + absl::Microseconds(requests[i].time_us() -
+                                       requests.front().time_us()) /
+                        config.speedup();
+        absl::SleepFor(scheduled_time - absl::Now());
+      }
+      // The queue holds all the requests, so that none is rejected.
+      CHECK(pool.Schedule([&requests, &call, &calls, &start_delays, i,
+                           scheduled_time]() {
+        const absl::Time call_start = absl::Now();
+        calls[i].code = call(requests[i]).code();
+        calls[i].latency = absl::Now() - call_start;
+        start_delays[i] = call_start - scheduled_time;
+      }));
+    }
+    pool.Stop();
+  }
+  report->set_duration_us(absl::ToInt64Microseconds(absl::Now() - start));
+  report->set_max_start_delay_us(absl::ToInt64Microseconds(std::max(
+      absl::ZeroDuration(),
+      *std::max_element(start_delays.begin(), start_delays.end()))));
+
+  absl::btree_map<std::string, RequestReplayReport::MethodReport>
+      method_reports;
+  absl::btree_map<std::string, std::vector<absl::Duration>> latencies;
+  for (size_t i = 0; i < requests.size(); ++i) {
+    RequestReplayReport::MethodReport& method_report =
+        method_reports[requests[i].method()];
+    method_report.set_num_calls(method_report.num_calls() + 1);
+    if (calls[i].code != absl::StatusCode::kOk) {
+      (*method_report.mutable_num_errors_by_code())[absl::StatusCodeToString(
+          calls[i].code)]++;
+    }
+    latencies[requests[i].method()].push_back(calls[i].latency);
+  }
+  for (auto& method_and_report : method_reports) {
+    std::vector<absl::Duration>& method_latencies =
+        latencies[method_and_report.first];
+    std::sort(method_latencies.begin(), method_latencies.end());
+    RequestReplayReport::MethodReport* method_report =
+        report->add_method_reports();
+    *method_report = std::move(method_and_report.second);
+    method_report->set_method(method_and_report.first);
+    method_report->set_p50_latency_us(
+        LatencyPercentileUs(method_latencies, 50));
+    method_report->set_p90_latency_us(
+        LatencyPercentileUs(method_latencies, 90));
+    method_report->set_p99_latency_us(
+        LatencyPercentileUs(method_latencies, 99));
+    method_report->set_max_latency_us(
+        absl::ToInt64Microseconds(method_latencies.back()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,114 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_REQUEST_CAPTURE_H_
+#define ML_METADATA_METADATA_STORE_REQUEST_CAPTURE_H_
+
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <vector>
+
+#include "google/protobuf/message.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// The bytes a capture file starts with. They are followed by the
+// CapturedRequests, each of which is written as the varint of its serialized
+// size and its serialization, in the order of the arrival of the calls.
+constexpr char kRequestCaptureMagic[] = "MLMDCAPTURE1";
+
+// Writes a sample of the requests of the calls of a server to a capture file,
+// with their method and arrival time, so that the traffic of the server can be
+// replayed against another one with ReplayCapturedRequests. Each request is
+// written and flushed as it is recorded, so that the file is complete up to
+// the last request if the server is killed. It is thread-safe.
+//
+// Usage example:
+//
+//    std::unique_ptr<RequestRecorder> recorder;
+//    CHECK_EQ(absl::OkStatus(), RequestRecorder::Create(config, &recorder));
+//    recorder->Record("PutExecution", request);
+class RequestRecorder {
+ public:
+  // Creates a recorder writing to the `filename` of `config`, which is
+  // truncated.
+  // Returns INVALID_ARGUMENT error, if the filename is empty or the
+  // sample_rate is not in (0, 1].
+  // Returns INTERNAL error, if the file cannot be written.
+  static absl::Status Create(
+      const MetadataStoreServerConfig::RequestCaptureConfig& config,
+      std::unique_ptr<RequestRecorder>* recorder);
+
+  // Disallows copy.
+  RequestRecorder(const RequestRecorder&) = delete;
+  RequestRecorder& operator=(const RequestRecorder&) = delete;
+
+  // Writes the `request` of a call of `method` arriving now, if the call is
+  // sampled and the max number of requests is not reached. A request that
+  // cannot be written is dropped with a warning.
+  void Record(absl::string_view method,
+              const google::protobuf::Message& request);
+
+  // Returns the number of requests written so far.
+  int64 num_recorded() const;
+
+ private:
+  RequestRecorder(const MetadataStoreServerConfig::RequestCaptureConfig& config,
+                  std::ofstream output);
+
+  // Returns true if the next call is to be recorded.
+  bool ShouldRecord() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const double sample_rate_;
+  const int64 max_requests_;
+
+  mutable absl::Mutex mu_;
+  absl::BitGen bitgen_ ABSL_GUARDED_BY(mu_);
+  std::ofstream output_ ABSL_GUARDED_BY(mu_);
+  int64 num_recorded_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// Reads the captured requests of the capture file `input` to `requests`.
+// Returns DATA_LOSS error, if `input` is not a capture file or is malformed.
+absl::Status ReadCapturedRequests(std::istream* input,
+                                  std::vector<CapturedRequest>* requests);
+
+// Issues a captured request to a server and returns the status of the call.
+using CapturedRequestCall =
+    std::function<absl::Status(const CapturedRequest& request)>;
+
+// Replays the `requests`, which are in time order as in a capture file, with
+// `call` issued by the workers of `config`, keeping the time between the
+// requests divided by the speedup of `config`. The latencies and the errors of
+// the calls are reported per method in `report`. The calls failing are
+// reported, and do not stop the replay.
+// Returns INVALID_ARGUMENT error, if the num_workers of `config` is not
+// positive.
+absl::Status ReplayCapturedRequests(
+    const std::vector<CapturedRequest>& requests,
+    const RequestReplayConfig& config, const CapturedRequestCall& call,
+    RequestReplayReport* report);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_REQUEST_CAPTURE_H_
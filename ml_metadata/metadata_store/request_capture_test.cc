@@ -0,0 +1,194 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/request_capture.h"
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+namespace testing {
+namespace {
+
+using ::testing::SizeIs;
+
+MetadataStoreServerConfig::RequestCaptureConfig CaptureConfig(
+    const std::string& filename) {
+  MetadataStoreServerConfig::RequestCaptureConfig config;
+  config.set_filename(absl::StrCat(::testing::TempDir(), "/", filename));
+  return config;
+}
+
+// Returns the requests of the capture file of `config`.
+std::vector<CapturedRequest> ReadCaptureFile(
+    const MetadataStoreServerConfig::RequestCaptureConfig& config) {
+  std::ifstream input(config.filename(), std::ios::binary);
+  std::vector<CapturedRequest> requests;
+  CHECK_EQ(absl::OkStatus(), ReadCapturedRequests(&input, &requests));
+  return requests;
+}
+
+CapturedRequest MakeCapturedRequest(const std::string& method,
+                                    const int64 time_us) {
+  CapturedRequest request;
+  request.set_method(method);
+  request.set_time_us(time_us);
+  return request;
+}
+
+TEST(RequestCaptureTest, RecordAndReadRequests) {
+  const MetadataStoreServerConfig::RequestCaptureConfig config =
+      CaptureConfig("record_and_read.capture");
+  std::unique_ptr<RequestRecorder> recorder;
+  ASSERT_EQ(absl::OkStatus(), RequestRecorder::Create(config, &recorder));
+  const PutExecutionRequest put_execution_request =
+      ParseTextProtoOrDie<PutExecutionRequest>(R"(
+        execution { type_id: 1 name: "trainer" }
+      )");
+  GetContextByTypeAndNameRequest get_context_request;
+  get_context_request.set_type_name("pipeline");
+  get_context_request.set_context_name("my_pipeline");
+  recorder->Record("PutExecution", put_execution_request);
+  recorder->Record("GetContextByTypeAndName", get_context_request);
+  EXPECT_EQ(recorder->num_recorded(), 2);
+
+  const std::vector<CapturedRequest> requests = ReadCaptureFile(config);
+  ASSERT_THAT(requests, SizeIs(2));
+  EXPECT_EQ(requests[0].method(), "PutExecution");
+  PutExecutionRequest captured_put_execution_request;
+  ASSERT_TRUE(
+      captured_put_execution_request.ParseFromString(requests[0].request()));
+  EXPECT_THAT(captured_put_execution_request,
+              EqualsProto(put_execution_request));
+  EXPECT_EQ(requests[1].method(), "GetContextByTypeAndName");
+  GetContextByTypeAndNameRequest captured_get_context_request;
+  ASSERT_TRUE(
+      captured_get_context_request.ParseFromString(requests[1].request()));
+  EXPECT_THAT(captured_get_context_request, EqualsProto(get_context_request));
+  EXPECT_LE(requests[0].time_us(), requests[1].time_us());
+}
+
+TEST(RequestCaptureTest, StopsAtMaxRequests) {
+  MetadataStoreServerConfig::RequestCaptureConfig config =
+      CaptureConfig("max_requests.capture");
+  config.set_max_requests(3);
+  std::unique_ptr<RequestRecorder> recorder;
+  ASSERT_EQ(absl::OkStatus(), RequestRecorder::Create(config, &recorder));
+  for (int i = 0; i < 10; i++) {
+    recorder->Record("GetArtifactTypes", GetArtifactTypesRequest());
+  }
+  EXPECT_EQ(recorder->num_recorded(), 3);
+  EXPECT_THAT(ReadCaptureFile(config), SizeIs(3));
+}
+
+TEST(RequestCaptureTest, CreateWithInvalidConfig) {
+  std::unique_ptr<RequestRecorder> recorder;
+  EXPECT_TRUE(absl::IsInvalidArgument(RequestRecorder::Create(
+      MetadataStoreServerConfig::RequestCaptureConfig(), &recorder)));
+  MetadataStoreServerConfig::RequestCaptureConfig config =
+      CaptureConfig("invalid_config.capture");
+  config.set_sample_rate(0);
+  EXPECT_TRUE(
+      absl::IsInvalidArgument(RequestRecorder::Create(config, &recorder)));
+}
+
+TEST(RequestCaptureTest, ReadMalformedCaptureFile) {
+  std::vector<CapturedRequest> requests;
+  std::istringstream not_a_capture("MLMDSNAPSHOT1");
+  EXPECT_TRUE(
+      absl::IsDataLoss(ReadCapturedRequests(&not_a_capture, &requests)));
+
+  std::string truncated_request;
+  MakeCapturedRequest("GetArtifacts", 1).SerializeToString(&truncated_request);
+  std::istringstream truncated(
+      absl::StrCat(kRequestCaptureMagic, std::string(1, '\x7f'),
+                   truncated_request));
+  EXPECT_TRUE(absl::IsDataLoss(ReadCapturedRequests(&truncated, &requests)));
+}
+
+TEST(RequestCaptureTest, ReplayReportsLatenciesAndErrorsPerMethod) {
+  const std::vector<CapturedRequest> requests = {
+      MakeCapturedRequest("GetArtifacts", 0),
+      MakeCapturedRequest("PutEvents", 1000),
+      MakeCapturedRequest("GetArtifacts", 2000),
+      MakeCapturedRequest("PutEvents", 3000),
+      MakeCapturedRequest("PutEvents", 4000)};
+  std::atomic<int> num_calls(0);
+  const CapturedRequestCall call =
+      [&num_calls](const CapturedRequest& request) -> absl::Status {
+    if (request.method() == "PutEvents" && num_calls++ % 2 == 0) {
+      return absl::AbortedError("Conflict");
+    }
+    return absl::OkStatus();
+  };
+  RequestReplayConfig config;
+  config.set_speedup(0);
+  config.set_num_workers(1);
+  RequestReplayReport report;
+  ASSERT_EQ(absl::OkStatus(),
+            ReplayCapturedRequests(requests, config, call, &report));
+
+  ASSERT_THAT(report.method_reports(), SizeIs(2));
+  EXPECT_EQ(report.method_reports(0).method(), "GetArtifacts");
+  EXPECT_EQ(report.method_reports(0).num_calls(), 2);
+  EXPECT_THAT(report.method_reports(0).num_errors_by_code(), SizeIs(0));
+  EXPECT_EQ(report.method_reports(1).method(), "PutEvents");
+  EXPECT_EQ(report.method_reports(1).num_calls(), 3);
+  EXPECT_EQ(report.method_reports(1).num_errors_by_code().at("ABORTED"), 2);
+  EXPECT_LE(report.method_reports(1).p50_latency_us(),
+            report.method_reports(1).max_latency_us());
+}
+
+TEST(RequestCaptureTest, ReplayKeepsTheTimeBetweenRequests) {
+  const std::vector<CapturedRequest> requests = {
+      MakeCapturedRequest("GetArtifacts", 1000000),
+      MakeCapturedRequest("GetArtifacts", 1100000)};
+  RequestReplayConfig config;
+  config.set_speedup(2);
+  RequestReplayReport report;
+  ASSERT_EQ(absl::OkStatus(),
+            ReplayCapturedRequests(
+                requests, config,
+                [](const CapturedRequest&) { return absl::OkStatus(); },
+                &report));
+  // The 100ms between the requests are replayed in 50ms.
+  EXPECT_GE(report.duration_us(), 50000);
+  ASSERT_THAT(report.method_reports(), SizeIs(1));
+  EXPECT_EQ(report.method_reports(0).num_calls(), 2);
+}
+
+TEST(RequestCaptureTest, ReplayWithInvalidConfig) {
+  RequestReplayConfig config;
+  config.set_num_workers(0);
+  RequestReplayReport report;
+  EXPECT_TRUE(absl::IsInvalidArgument(ReplayCapturedRequests(
+      {MakeCapturedRequest("GetArtifacts", 0)}, config,
+      [](const CapturedRequest&) { return absl::OkStatus(); }, &report)));
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace ml_metadata
@@ -0,0 +1,101 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/request_coalescer.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "google/protobuf/message.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace ml_metadata {
+
+struct RequestCoalescer::Flight {
+  // The write generation at the start of the leader.
+  int64 write_generation = 0;
+  absl::Status status;
+  // The serialized response of the leader, if any read joins it.
+  std::string serialized_response;
+  int num_joined = 0;
+  bool done = false;
+};
+
+absl::Status RequestCoalescer::Coalesce(const std::string& key,
+                                        const int64 write_generation,
+                                        const absl::Time deadline,
+                                        const Read& read,
+                                        google::protobuf::Message* response) {
+  std::shared_ptr<Flight> flight;
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = flights_.find(key);
+    if (it == flights_.end() ||
+        it->second->write_generation < write_generation) {
+      // A write has committed since the start of the leader in flight, if
+      // any, which may miss it. The reads arriving from now on join this one.
+      flight = std::make_shared<Flight>();
+      flight->write_generation = write_generation;
+      flights_[key] = flight;
+    } else {
+      flight = it->second;
+      flight->num_joined++;
+      if (!mu_.AwaitWithDeadline(absl::Condition(&flight->done), deadline)) {
+        return absl::DeadlineExceededError(
+            "The deadline is exceeded while waiting for an identical read.");
+      }
+      if (!absl::IsCancelled(flight->status) &&
+          !absl::IsDeadlineExceeded(flight->status)) {
+        if (flight->status.ok() &&
+            !response->ParseFromString(flight->serialized_response)) {
+          return absl::InternalError("Failed to copy the coalesced response.");
+        }
+        return flight->status;
+      }
+      // The leader is interrupted by its own client, while this read may
+      // still complete.
+      flight.reset();
+    }
+  }
+  if (flight == nullptr) {
+    return read();
+  }
+
+  const absl::Status status = read();
+  int num_joined;
+  {
+    absl::MutexLock lock(&mu_);
+    // The reads arriving from now on lead a new flight, unless a newer leader
+    // has replaced this one.
+    const auto it = flights_.find(key);
+    if (it != flights_.end() && it->second == flight) {
+      flights_.erase(it);
+    }
+    num_joined = flight->num_joined;
+  }
+  std::string serialized_response;
+  if (status.ok() && num_joined > 0) {
+    response->SerializeToString(&serialized_response);
+  }
+  absl::MutexLock lock(&mu_);
+  flight->status = status;
+  flight->serialized_response = std::move(serialized_response);
+  flight->done = true;
+  return status;
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,86 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_REQUEST_COALESCER_H_
+#define ML_METADATA_METADATA_STORE_REQUEST_COALESCER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "google/protobuf/message.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/types.h"
+
+namespace ml_metadata {
+
+// Coalesces the identical reads in flight, so that a single execution of the
+// first of them, the leader, serves the others joining it before it completes.
+// The joining reads wait for the leader and get a copy of its status and
+// response. A read joins a leader only if no write has committed between the
+// start of the leader and the arrival of the read, as told by the write
+// generations passed to Coalesce, so that the read does not miss the writes
+// committed before it. It is thread-safe.
+//
+// Usage example:
+//
+//    RequestCoalescer coalescer;
+//    MLMD_RETURN_IF_ERROR(coalescer.Coalesce(
+//        absl::StrCat("GetArtifactsByContext/", request.SerializeAsString()),
+//        pool.write_generation(), deadline,
+//        [&]() { return store->GetArtifactsByContext(request, &response); },
+//        &response));
+class RequestCoalescer {
+ public:
+  // A read filling the response passed to Coalesce.
+  using Read = std::function<absl::Status()>;
+
+  RequestCoalescer() = default;
+
+  // Disallows copy.
+  RequestCoalescer(const RequestCoalescer&) = delete;
+  RequestCoalescer& operator=(const RequestCoalescer&) = delete;
+
+  // Runs `read` to fill `response`, unless a read of the same `key` is in
+  // flight, in which case `response` is copied from it once it completes.
+  // The `key` identifies the read, e.g., by its method and serialized request.
+  // The `write_generation` counts the writes committed before the read, e.g.,
+  // ReplicatedMetadataStorePool::write_generation(). The read joins a read in
+  // flight only if the latter started at the same or a later generation;
+  // otherwise it leads a new flight, which the later reads join instead.
+  // A joining read waits until `deadline` at most, and runs `read` itself if
+  // the leader is cancelled or runs out of its own deadline.
+  // Returns detailed errors of the read.
+  // Returns DEADLINE_EXCEEDED error, if the leader is not done by `deadline`.
+  absl::Status Coalesce(const std::string& key, int64 write_generation,
+                        absl::Time deadline, const Read& read,
+                        google::protobuf::Message* response);
+
+ private:
+  // A read in flight, shared by its leader and the reads joining it.
+  struct Flight;
+
+  absl::Mutex mu_;
+  // The reads in flight by their keys, the latest leader of a key.
+  absl::flat_hash_map<std::string, std::shared_ptr<Flight>> flights_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_REQUEST_COALESCER_H_
@@ -0,0 +1,219 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/request_coalescer.h"
+
+#include <atomic>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+constexpr int kNumReads = 8;
+
+// Returns a read of `response` that counts its runs in `num_runs`, and blocks
+// until `release` is notified.
+RequestCoalescer::Read BlockingRead(absl::Notification* release,
+                                    std::atomic<int>* num_runs,
+                                    GetContextByTypeAndNameResponse* response,
+                                    absl::Status status = absl::OkStatus()) {
+  return [release, num_runs, response, status]() {
+    (*num_runs)++;
+    release->WaitForNotification();
+    response->mutable_context()->set_name("context");
+    return status;
+  };
+}
+
+TEST(RequestCoalescerTest, IdenticalReadsShareOneRun) {
+  RequestCoalescer coalescer;
+  absl::Notification release;
+  std::atomic<int> num_runs(0);
+  std::vector<GetContextByTypeAndNameResponse> responses(kNumReads);
+  std::vector<absl::Status> statuses(kNumReads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumReads; i++) {
+    threads.emplace_back([&, i]() {
+      statuses[i] = coalescer.Coalesce(
+          "key", /*write_generation=*/0, absl::InfiniteFuture(),
+          BlockingRead(&release, &num_runs, &responses[i]), &responses[i]);
+    });
+  }
+  // Lets the other reads join the first one before it completes.
+  absl::SleepFor(absl::Milliseconds(200));
+  release.Notify();
+  for (std::thread& thread : threads) thread.join();
+
+  EXPECT_EQ(num_runs, 1);
+  for (int i = 0; i < kNumReads; i++) {
+    EXPECT_EQ(absl::OkStatus(), statuses[i]);
+    EXPECT_EQ("context", responses[i].context().name());
+  }
+}
+
+TEST(RequestCoalescerTest, DifferentReadsRunSeparately) {
+  RequestCoalescer coalescer;
+  absl::Notification release;
+  release.Notify();
+  std::atomic<int> num_runs(0);
+  std::vector<GetContextByTypeAndNameResponse> responses(kNumReads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumReads; i++) {
+    threads.emplace_back([&, i]() {
+      EXPECT_EQ(absl::OkStatus(),
+                coalescer.Coalesce(
+                    std::to_string(i), /*write_generation=*/0,
+                    absl::InfiniteFuture(),
+                    BlockingRead(&release, &num_runs, &responses[i]),
+                    &responses[i]));
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  EXPECT_EQ(num_runs, kNumReads);
+}
+
+TEST(RequestCoalescerTest, JoiningReadsShareTheError) {
+  RequestCoalescer coalescer;
+  absl::Notification release;
+  std::atomic<int> num_runs(0);
+  std::vector<GetContextByTypeAndNameResponse> responses(kNumReads);
+  std::vector<absl::Status> statuses(kNumReads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumReads; i++) {
+    threads.emplace_back([&, i]() {
+      statuses[i] = coalescer.Coalesce(
+          "key", /*write_generation=*/0, absl::InfiniteFuture(),
+          BlockingRead(&release, &num_runs, &responses[i],
+                       absl::InvalidArgumentError("bad request")),
+          &responses[i]);
+    });
+  }
+  absl::SleepFor(absl::Milliseconds(200));
+  release.Notify();
+  for (std::thread& thread : threads) thread.join();
+
+  EXPECT_EQ(num_runs, 1);
+  for (const absl::Status& status : statuses) {
+    EXPECT_TRUE(absl::IsInvalidArgument(status));
+  }
+}
+
+TEST(RequestCoalescerTest, JoiningReadsRerunACancelledRead) {
+  RequestCoalescer coalescer;
+  absl::Notification release;
+  std::atomic<int> num_runs(0);
+  GetContextByTypeAndNameResponse leader_response;
+  absl::Status leader_status;
+  std::thread leader([&]() {
+    leader_status = coalescer.Coalesce(
+        "key", /*write_generation=*/0, absl::InfiniteFuture(),
+        BlockingRead(&release, &num_runs, &leader_response,
+                     absl::CancelledError("cancelled by its client")),
+        &leader_response);
+  });
+  absl::SleepFor(absl::Milliseconds(100));
+  GetContextByTypeAndNameResponse response;
+  absl::Status status;
+  std::thread joining([&]() {
+    status = coalescer.Coalesce(
+        "key", /*write_generation=*/0, absl::InfiniteFuture(),
+        BlockingRead(&release, &num_runs, &response), &response);
+  });
+  absl::SleepFor(absl::Milliseconds(100));
+  release.Notify();
+  leader.join();
+  joining.join();
+
+  EXPECT_TRUE(absl::IsCancelled(leader_status));
+  EXPECT_EQ(absl::OkStatus(), status);
+  EXPECT_EQ("context", response.context().name());
+  EXPECT_EQ(num_runs, 2);
+}
+
+TEST(RequestCoalescerTest, ReadsAfterAWriteDoNotJoinAnEarlierRead) {
+  RequestCoalescer coalescer;
+  absl::Notification release_leader;
+  std::atomic<int> num_runs(0);
+  GetContextByTypeAndNameResponse leader_response;
+  std::thread leader([&]() {
+    EXPECT_EQ(absl::OkStatus(),
+              coalescer.Coalesce(
+                  "key", /*write_generation=*/0, absl::InfiniteFuture(),
+                  BlockingRead(&release_leader, &num_runs, &leader_response),
+                  &leader_response));
+  });
+  absl::SleepFor(absl::Milliseconds(100));
+  // A write lands while the leader is in flight, so the reads arriving after
+  // it lead a new flight instead of waiting for the leader.
+  absl::Notification release_after_write;
+  std::vector<GetContextByTypeAndNameResponse> responses(kNumReads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumReads; i++) {
+    threads.emplace_back([&, i]() {
+      EXPECT_EQ(absl::OkStatus(),
+                coalescer.Coalesce(
+                    "key", /*write_generation=*/1, absl::InfiniteFuture(),
+                    BlockingRead(&release_after_write, &num_runs,
+                                 &responses[i]),
+                    &responses[i]));
+    });
+  }
+  absl::SleepFor(absl::Milliseconds(200));
+  release_after_write.Notify();
+  // The reads after the write complete while the leader is still blocked.
+  for (std::thread& thread : threads) thread.join();
+  EXPECT_EQ(num_runs, 2);
+  for (const GetContextByTypeAndNameResponse& response : responses) {
+    EXPECT_EQ("context", response.context().name());
+  }
+  release_leader.Notify();
+  leader.join();
+  EXPECT_EQ(num_runs, 2);
+}
+
+TEST(RequestCoalescerTest, JoiningReadWaitsUntilItsDeadline) {
+  RequestCoalescer coalescer;
+  absl::Notification release;
+  std::atomic<int> num_runs(0);
+  GetContextByTypeAndNameResponse leader_response;
+  std::thread leader([&]() {
+    EXPECT_EQ(absl::OkStatus(),
+              coalescer.Coalesce(
+                  "key", /*write_generation=*/0, absl::InfiniteFuture(),
+                  BlockingRead(&release, &num_runs, &leader_response),
+                  &leader_response));
+  });
+  absl::SleepFor(absl::Milliseconds(100));
+  GetContextByTypeAndNameResponse response;
+  const absl::Status status = coalescer.Coalesce(
+      "key", /*write_generation=*/0, absl::Now() + absl::Milliseconds(100),
+      BlockingRead(&release, &num_runs, &response), &response);
+  release.Notify();
+  leader.join();
+
+  EXPECT_TRUE(absl::IsDeadlineExceeded(status));
+  EXPECT_EQ(num_runs, 1);
+}
+
+}  // namespace
+}  // namespace ml_metadata
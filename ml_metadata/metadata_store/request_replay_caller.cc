@@ -0,0 +1,94 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/request_replay_caller.h"
+
+#include <string>
+#include <utility>
+
+#include <glog/logging.h>
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "grpcpp/grpcpp.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+// Waits for the next operation of `queue` to complete, and returns whether it
+// succeeded.
+bool AwaitNext(::grpc::CompletionQueue* queue) {
+  void* tag;
+  bool ok = false;
+  return queue->Next(&tag, &ok) && ok;
+}
+
+}  // namespace
+
+GenericReplayCaller::GenericReplayCaller(
+    std::shared_ptr<::grpc::Channel> channel, const absl::Duration call_timeout)
+    : stub_(std::move(channel)),
+      service_(GetArtifactsRequest::descriptor()->file()->FindServiceByName(
+          "MetadataStoreService")),
+      call_timeout_(call_timeout) {
+  CHECK(service_ != nullptr);
+}
+
+absl::Status GenericReplayCaller::Call(const CapturedRequest& request) {
+  const google::protobuf::MethodDescriptor* method =
+      service_->FindMethodByName(request.method());
+  if (method == nullptr) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unknown method ", request.method()));
+  }
+  const std::string path =
+      absl::StrCat("/", service_->full_name(), "/", method->name());
+  ::grpc::ClientContext context;
+  context.set_deadline(absl::ToChronoTime(absl::Now() + call_timeout_));
+  ::grpc::Slice slice(request.request());
+  const ::grpc::ByteBuffer request_buffer(&slice, /*nslices=*/1);
+  ::grpc::ByteBuffer response_buffer;
+  ::grpc::Status status;
+  ::grpc::CompletionQueue queue;
+  void* const tag = reinterpret_cast<void*>(1);
+  if (!method->server_streaming()) {
+    std::unique_ptr<::grpc::GenericClientAsyncResponseReader> call =
+        stub_.PrepareUnaryCall(&context, path, request_buffer, &queue);
+    call->StartCall();
+    call->Finish(&response_buffer, &status, tag);
+    AwaitNext(&queue);
+  } else {
+    std::unique_ptr<::grpc::GenericClientAsyncReaderWriter> call =
+        stub_.PrepareCall(&context, path, &queue);
+    call->StartCall(tag);
+    if (AwaitNext(&queue)) {
+      call->Write(request_buffer, tag);
+      AwaitNext(&queue);
+      call->WritesDone(tag);
+      AwaitNext(&queue);
+      do {
+        call->Read(&response_buffer, tag);
+      } while (AwaitNext(&queue));
+    }
+    call->Finish(&status, tag);
+    AwaitNext(&queue);
+  }
+  queue.Shutdown();
+  while (AwaitNext(&queue)) {
+  }
+  return absl::Status(static_cast<absl::StatusCode>(status.error_code()),
+                      status.error_message());
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,65 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_REQUEST_REPLAY_CALLER_H_
+#define ML_METADATA_METADATA_STORE_REQUEST_REPLAY_CALLER_H_
+
+#include <memory>
+
+#include "google/protobuf/descriptor.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "grpcpp/channel.h"
+#include "grpcpp/generic/generic_stub.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// Issues the captured requests as generic calls of MetadataStoreService, so
+// that the requests are sent as captured without being parsed, and the
+// responses are dropped. The server-streaming calls read their whole stream.
+// It is used to replay a capture file, either against another server by the
+// request_replay_tool, or through the in-process channel of a server to warm
+// it up. It is thread-safe.
+//
+// Usage example:
+//
+//    GenericReplayCaller caller(channel, absl::Seconds(60));
+//    MLMD_RETURN_IF_ERROR(ReplayCapturedRequests(
+//        requests, config,
+//        [&caller](const CapturedRequest& request) {
+//          return caller.Call(request);
+//        },
+//        &report));
+class GenericReplayCaller {
+ public:
+  // Creates a caller issuing the calls to `channel` with a deadline of
+  // `call_timeout` each.
+  GenericReplayCaller(std::shared_ptr<::grpc::Channel> channel,
+                      absl::Duration call_timeout);
+
+  // Issues `request` and returns the status of the call.
+  // Returns INVALID_ARGUMENT error, if the method of the request is not a
+  // method of MetadataStoreService.
+  absl::Status Call(const CapturedRequest& request);
+
+ private:
+  ::grpc::GenericStub stub_;
+  const google::protobuf::ServiceDescriptor* const service_;
+  const absl::Duration call_timeout_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_REQUEST_REPLAY_CALLER_H_
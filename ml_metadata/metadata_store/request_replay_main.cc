@@ -0,0 +1,121 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Replays the requests captured by a metadata_store_server with
+// --metadata_store_request_capture_file against another server, e.g., a
+// staging one, for load tests and capacity planning, and prints the latency
+// percentiles and the errors of the calls per method as a text
+// RequestReplayReport. See request_capture.h for the capture format.
+//
+// Usage example:
+//
+//    bazel run -c opt //ml_metadata/metadata_store:request_replay_tool --
+//        --capture_file=/tmp/mlmd.capture --target=staging-mlmd:8080
+//        --speedup=4 --num_workers=32
+//
+// The requests are sent as captured, so that the writes of the capture are
+// redone on the target, and the ids in the requests refer to the nodes of the
+// captured server. It is meant to target a copy of that server, e.g., one
+// restored from its metadata snapshot.
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include <glog/logging.h>
+#include "google/protobuf/text_format.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/security/credentials.h"
+#include "ml_metadata/metadata_store/request_capture.h"
+#include "ml_metadata/metadata_store/request_replay_caller.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+DEFINE_string(capture_file, "",
+              "The request capture file written by the metadata_store_server.");
+DEFINE_string(target, "localhost:8080",
+              "The address of the metadata_store_server to replay to.");
+DEFINE_double(speedup, 1,
+              "The factor by which the time between the captured calls is "
+              "shortened. A value <= 0 replays the calls as fast as the "
+              "workers allow.");
+DEFINE_int32(num_workers, 8, "The max number of calls in flight.");
+DEFINE_int64(call_timeout_sec, 60, "The deadline of each call in seconds.");
+
+namespace {
+
+absl::Status Replay(const std::string& filename, const std::string& target,
+                    const ml_metadata::RequestReplayConfig& config,
+                    ml_metadata::RequestReplayReport* report) {
+  std::ifstream input(filename, std::ios::binary);
+  if (!input) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Cannot open the capture file ", filename));
+  }
+  std::vector<ml_metadata::CapturedRequest> requests;
+  absl::Status status = ml_metadata::ReadCapturedRequests(&input, &requests);
+  if (!status.ok()) {
+    return status;
+  }
+  LOG(INFO) << "Replaying " << requests.size() << " requests to " << target;
+  ml_metadata::GenericReplayCaller caller(
+      ::grpc::CreateChannel(target, ::grpc::InsecureChannelCredentials()),
+      absl::Seconds((FLAGS_call_timeout_sec)));
+  return ml_metadata::ReplayCapturedRequests(
+      requests, config,
+      [&caller](const ml_metadata::CapturedRequest& request) {
+        return caller.Call(request);
+      },
+      report);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  if ((FLAGS_capture_file).empty()) {
+    LOG(ERROR) << "capture_file must be set.";
+    return 1;
+  }
+  ml_metadata::RequestReplayConfig config;
+  config.set_speedup((FLAGS_speedup));
+  config.set_num_workers((FLAGS_num_workers));
+  ml_metadata::RequestReplayReport report;
+  const absl::Status status =
+      Replay((FLAGS_capture_file), (FLAGS_target), config, &report);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+    return 1;
+  }
+  for (const ml_metadata::RequestReplayReport::MethodReport& method_report :
+       report.method_reports()) {
+    int64_t num_errors = 0;
+    for (const auto& code_and_count : method_report.num_errors_by_code()) {
+      num_errors += code_and_count.second;
+    }
+    LOG(INFO) << method_report.method() << ": " << method_report.num_calls()
+              << " calls, error rate "
+              << static_cast<double>(num_errors) / method_report.num_calls()
+              << ", p99 " << method_report.p99_latency_us() << "us";
+  }
+  std::string text_report;
+  google::protobuf::TextFormat::PrintToString(report, &text_report);
+  std::cout << text_report;
+  return 0;
+}
@@ -0,0 +1,786 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/sharded_metadata_store.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include <glog/logging.h>
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/util/message_differencer.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::google::protobuf::FieldDescriptor;
+using ::google::protobuf::Message;
+using ::google::protobuf::Reflection;
+
+constexpr int64 kMaxLocalId = (int64{1} << ShardedMetadataStore::kLocalIdBits);
+
+// The fields other than the `id` of a node that hold node ids, e.g., of the
+// nodes of an event, or the nodes of a request.
+constexpr absl::string_view kNodeIdFieldNames[] = {
+    "artifact_id",  "artifact_ids", "execution_id", "execution_ids",
+    "context_id",   "context_ids",  "parent_id",    "child_id"};
+
+// Returns true if the `field` of `message` holds node ids.
+bool IsNodeIdField(const Message& message, const FieldDescriptor& field) {
+  if (field.cpp_type() != FieldDescriptor::CPPTYPE_INT64) {
+    return false;
+  }
+  if (field.name() == "id") {
+    const auto* descriptor = message.GetDescriptor();
+    return descriptor == Artifact::descriptor() ||
+           descriptor == Execution::descriptor() ||
+           descriptor == Context::descriptor();
+  }
+  for (absl::string_view name : kNodeIdFieldNames) {
+    if (field.name() == name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Replaces every node id of `message` and of its submessages with the result
+// of `rewrite`.
+// Returns the first error of `rewrite`.
+absl::Status RewriteNodeIds(
+    const std::function<absl::StatusOr<int64>(int64)>& rewrite,
+    Message* message) {
+  const Reflection* reflection = message->GetReflection();
+  std::vector<const FieldDescriptor*> fields;
+  reflection->ListFields(*message, &fields);
+  for (const FieldDescriptor* field : fields) {
+    if (field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
+      if (!field->is_repeated()) {
+        MLMD_RETURN_IF_ERROR(RewriteNodeIds(
+            rewrite, reflection->MutableMessage(message, field)));
+        continue;
+      }
+      for (int i = 0; i < reflection->FieldSize(*message, field); i++) {
+        MLMD_RETURN_IF_ERROR(RewriteNodeIds(
+            rewrite, reflection->MutableRepeatedMessage(message, field, i)));
+      }
+      continue;
+    }
+    if (!IsNodeIdField(*message, *field)) {
+      continue;
+    }
+    if (!field->is_repeated()) {
+      MLMD_ASSIGN_OR_RETURN(int64 id,
+                            rewrite(reflection->GetInt64(*message, field)));
+      reflection->SetInt64(message, field, id);
+      continue;
+    }
+    for (int i = 0; i < reflection->FieldSize(*message, field); i++) {
+      MLMD_ASSIGN_OR_RETURN(
+          int64 id, rewrite(reflection->GetRepeatedInt64(*message, field, i)));
+      reflection->SetRepeatedInt64(message, field, i, id);
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Returns the 64-bit FNV-1a hash of `data`, which is stable across processes
+// unlike absl::Hash, as it picks the shard of the persisted contexts.
+uint64_t Fingerprint(absl::string_view data) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (const char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// Returns an error for a paginated list of several shards.
+absl::Status ListOptionsUnsupported(absl::string_view method) {
+  return absl::UnimplementedError(absl::StrCat(
+      method, " with ListOperationOptions is not supported by a sharded "
+              "store, as the pages of several shards cannot be merged."));
+}
+
+// Tracks the calls of a RunOnShards that are not done yet.
+struct PendingCalls {
+  bool AllDone() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+    return num_pending == 0;
+  }
+
+  absl::Mutex mu;
+  int num_pending ABSL_GUARDED_BY(mu) = 0;
+  absl::Status status ABSL_GUARDED_BY(mu);
+};
+
+// Runs `call` with `shard`, then records its status in `pending`.
+void RunPendingCall(const std::function<absl::Status(int)>& call,
+                    const int shard, PendingCalls* pending) {
+  const absl::Status status = call(shard);
+  absl::MutexLock lock(&pending->mu);
+  if (pending->status.ok()) {
+    pending->status = status;
+  }
+  pending->num_pending--;
+}
+
+}  // namespace
+
+constexpr int ShardedMetadataStore::kLocalIdBits;
+constexpr int ShardedMetadataStore::kMaxNumShards;
+
+ShardedMetadataStore::ShardedMetadataStore(
+    std::vector<std::unique_ptr<MetadataStore>> shards)
+    : shards_(std::move(shards)) {
+  if (shards_.size() > 1) {
+    worker_pool_ = absl::make_unique<WorkerPool>(
+        /*num_workers=*/shards_.size() - 1,
+        /*max_queue_size=*/shards_.size());
+  }
+}
+
+absl::Status ShardedMetadataStore::Create(
+    std::vector<std::unique_ptr<MetadataStore>> shards,
+    std::unique_ptr<ShardedMetadataStore>* result) {
+  if (shards.empty() || shards.size() > kMaxNumShards) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("The number of shards must be in [1, ", kMaxNumShards,
+                     "], got: ", shards.size()));
+  }
+  for (const std::unique_ptr<MetadataStore>& shard : shards) {
+    if (shard == nullptr) {
+      return absl::InvalidArgumentError("A shard is null.");
+    }
+  }
+  *result = absl::WrapUnique(new ShardedMetadataStore(std::move(shards)));
+  return absl::OkStatus();
+}
+
+int64 ShardedMetadataStore::EncodeShardedId(const int shard,
+                                            const int64 local_id) {
+  return (int64{shard} << kLocalIdBits) | local_id;
+}
+
+int ShardedMetadataStore::ShardOfId(const int64 id) {
+  return id >> kLocalIdBits;
+}
+
+int64 ShardedMetadataStore::LocalIdOf(const int64 id) {
+  return id & (kMaxLocalId - 1);
+}
+
+int ShardedMetadataStore::ShardOfNewNode(const int64 type_id,
+                                         const absl::string_view name) const {
+  return Fingerprint(absl::StrCat(type_id, ":", name)) % shards_.size();
+}
+
+template <typename Node>
+absl::StatusOr<absl::optional<int>> ShardedMetadataStore::ShardOfNewNamedNodes(
+    const google::protobuf::RepeatedPtrField<Node>& nodes) const {
+  absl::optional<int> shard;
+  for (const Node& node : nodes) {
+    if (node.has_id() || !node.has_name()) {
+      continue;
+    }
+    const int node_shard = ShardOfNewNode(node.type_id(), node.name());
+    if (shard && *shard != node_shard) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "The new named nodes of a call must be in the same shard, got the "
+          "shards ", *shard, " and ", node_shard, "."));
+    }
+    shard = node_shard;
+  }
+  return shard;
+}
+
+absl::StatusOr<absl::optional<int>> ShardedMetadataStore::LocalizeNodeIds(
+    Message* message) const {
+  absl::optional<int> shard;
+  MLMD_RETURN_IF_ERROR(RewriteNodeIds(
+      [this, &shard](const int64 id) -> absl::StatusOr<int64> {
+        if (id < 0 || ShardOfId(id) >= num_shards()) {
+          return absl::InvalidArgumentError(
+              absl::StrCat("The id ", id, " is not of a shard."));
+        }
+        if (shard && *shard != ShardOfId(id)) {
+          return absl::InvalidArgumentError(absl::StrCat(
+              "The nodes of a call must be in the same shard, got the shards ",
+              *shard, " and ", ShardOfId(id), "."));
+        }
+        shard = ShardOfId(id);
+        return LocalIdOf(id);
+      },
+      message));
+  return shard;
+}
+
+absl::Status ShardedMetadataStore::GlobalizeNodeIds(const int shard,
+                                                    Message* message) const {
+  return RewriteNodeIds(
+      [shard](const int64 local_id) -> absl::StatusOr<int64> {
+        if (local_id < 0 || local_id >= kMaxLocalId) {
+          return absl::OutOfRangeError(absl::StrCat(
+              "The id ", local_id, " of shard ", shard,
+              " exceeds the ids of a sharded store."));
+        }
+        return EncodeShardedId(shard, local_id);
+      },
+      message);
+}
+
+absl::Status ShardedMetadataStore::RunOnShards(
+    absl::Span<const int> shards,
+    const std::function<absl::Status(int)>& call) {
+  if (shards.size() <= 1) {
+    return shards.empty() ? absl::OkStatus() : call(shards.front());
+  }
+  PendingCalls pending;
+  {
+    absl::MutexLock lock(&pending.mu);
+    pending.num_pending = shards.size();
+  }
+  for (int i = 1; i < shards.size(); i++) {
+    const int shard = shards[i];
+    if (!worker_pool_->Schedule([&call, shard, &pending] {
+          RunPendingCall(call, shard, &pending);
+        })) {
+      RunPendingCall(call, shard, &pending);
+    }
+  }
+  RunPendingCall(call, shards.front(), &pending);
+  absl::MutexLock lock(&pending.mu);
+  pending.mu.Await(absl::Condition(&pending, &PendingCalls::AllDone));
+  return pending.status;
+}
+
+template <typename Request, typename Response>
+absl::Status ShardedMetadataStore::RouteToShard(
+    const Request& request,
+    absl::Status (MetadataStore::*call)(const Request&, Response*),
+    Response* response, const int default_shard,
+    const absl::optional<int> new_node_shard) {
+  Request local_request = request;
+  MLMD_ASSIGN_OR_RETURN(absl::optional<int> shard,
+                        LocalizeNodeIds(&local_request));
+  if (new_node_shard) {
+    if (shard && *shard != *new_node_shard) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "The nodes of a call must be in the shard of its new nodes ",
+          *new_node_shard, ", got the shard ", *shard, "."));
+    }
+    shard = new_node_shard;
+  }
+  const int target_shard = shard.value_or(default_shard);
+  MLMD_RETURN_IF_ERROR(
+      (shards_[target_shard].get()->*call)(local_request, response));
+  return GlobalizeNodeIds(target_shard, response);
+}
+
+template <typename Request, typename Response>
+absl::Status ShardedMetadataStore::PutTypesOnAllShards(
+    const Request& request,
+    absl::Status (MetadataStore::*call)(const Request&, Response*),
+    Response* response) {
+  MLMD_RETURN_IF_ERROR((shards_[0].get()->*call)(request, response));
+  for (int i = 1; i < shards_.size(); i++) {
+    Response shard_response;
+    MLMD_RETURN_IF_ERROR((shards_[i].get()->*call)(request, &shard_response));
+    if (!google::protobuf::util::MessageDifferencer::Equals(*response,
+                                                  shard_response)) {
+      return absl::InternalError(absl::StrCat(
+          "The types of shard ", i, " diverged from the first shard: ",
+          shard_response.ShortDebugString(), " vs ",
+          response->ShortDebugString()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+template <typename Request, typename Response, typename Ids>
+absl::Status ShardedMetadataStore::ScatterByIds(
+    const Request& request, Ids* (Request::*mutable_ids)(),
+    absl::Status (MetadataStore::*call)(const Request&, Response*),
+    Response* response) {
+  Request ids_request = request;
+  std::vector<Request> shard_requests(shards_.size());
+  std::vector<int> shards;
+  for (const int64 id : *(ids_request.*mutable_ids)()) {
+    if (id < 0 || ShardOfId(id) >= num_shards()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("The id ", id, " is not of a shard."));
+    }
+    const int shard = ShardOfId(id);
+    if (std::find(shards.begin(), shards.end(), shard) == shards.end()) {
+      shard_requests[shard] = request;
+      (shard_requests[shard].*mutable_ids)()->Clear();
+      shards.push_back(shard);
+    }
+    (shard_requests[shard].*mutable_ids)()->Add(LocalIdOf(id));
+  }
+  std::vector<Response> shard_responses(shards_.size());
+  MLMD_RETURN_IF_ERROR(RunOnShards(shards, [&](const int shard) {
+    MLMD_RETURN_IF_ERROR((shards_[shard].get()->*call)(
+        shard_requests[shard], &shard_responses[shard]));
+    return GlobalizeNodeIds(shard, &shard_responses[shard]);
+  }));
+  for (const int shard : shards) {
+    response->MergeFrom(shard_responses[shard]);
+  }
+  return absl::OkStatus();
+}
+
+template <typename Request, typename Response>
+absl::Status ShardedMetadataStore::ScatterToAllShards(
+    const Request& request,
+    absl::Status (MetadataStore::*call)(const Request&, Response*),
+    std::vector<Response>* responses) {
+  std::vector<int> shards(shards_.size());
+  for (int i = 0; i < shards.size(); i++) {
+    shards[i] = i;
+  }
+  responses->resize(shards_.size());
+  return RunOnShards(shards, [&](const int shard) {
+    MLMD_RETURN_IF_ERROR(
+        (shards_[shard].get()->*call)(request, &(*responses)[shard]));
+    return GlobalizeNodeIds(shard, &(*responses)[shard]);
+  });
+}
+
+template <typename Request, typename Response>
+absl::Status ShardedMetadataStore::ScatterAndGather(
+    const Request& request,
+    absl::Status (MetadataStore::*call)(const Request&, Response*),
+    Response* response) {
+  std::vector<Response> responses;
+  MLMD_RETURN_IF_ERROR(ScatterToAllShards(request, call, &responses));
+  for (const Response& shard_response : responses) {
+    response->MergeFrom(shard_response);
+  }
+  return absl::OkStatus();
+}
+
+template <typename Request, typename Response>
+absl::Status ShardedMetadataStore::ScatterAndGetFirst(
+    const Request& request,
+    absl::Status (MetadataStore::*call)(const Request&, Response*),
+    Response* response) {
+  std::vector<Response> responses;
+  MLMD_RETURN_IF_ERROR(ScatterToAllShards(request, call, &responses));
+  for (Response& shard_response : responses) {
+    if (shard_response.ByteSizeLong() > 0) {
+      response->Swap(&shard_response);
+      break;
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataStore::PutArtifactType(
+    const PutArtifactTypeRequest& request, PutArtifactTypeResponse* response) {
+  return PutTypesOnAllShards(request, &MetadataStore::PutArtifactType,
+                             response);
+}
+
+absl::Status ShardedMetadataStore::PutExecutionType(
+    const PutExecutionTypeRequest& request,
+    PutExecutionTypeResponse* response) {
+  return PutTypesOnAllShards(request, &MetadataStore::PutExecutionType,
+                             response);
+}
+
+absl::Status ShardedMetadataStore::PutContextType(
+    const PutContextTypeRequest& request, PutContextTypeResponse* response) {
+  return PutTypesOnAllShards(request, &MetadataStore::PutContextType,
+                             response);
+}
+
+absl::Status ShardedMetadataStore::PutTypes(const PutTypesRequest& request,
+                                            PutTypesResponse* response) {
+  return PutTypesOnAllShards(request, &MetadataStore::PutTypes, response);
+}
+
+absl::Status ShardedMetadataStore::GetArtifactType(
+    const GetArtifactTypeRequest& request, GetArtifactTypeResponse* response) {
+  return shards_[0]->GetArtifactType(request, response);
+}
+
+absl::Status ShardedMetadataStore::GetExecutionType(
+    const GetExecutionTypeRequest& request,
+    GetExecutionTypeResponse* response) {
+  return shards_[0]->GetExecutionType(request, response);
+}
+
+absl::Status ShardedMetadataStore::GetContextType(
+    const GetContextTypeRequest& request, GetContextTypeResponse* response) {
+  return shards_[0]->GetContextType(request, response);
+}
+
+absl::Status ShardedMetadataStore::GetArtifactTypes(
+    const GetArtifactTypesRequest& request,
+    GetArtifactTypesResponse* response) {
+  return shards_[0]->GetArtifactTypes(request, response);
+}
+
+absl::Status ShardedMetadataStore::GetExecutionTypes(
+    const GetExecutionTypesRequest& request,
+    GetExecutionTypesResponse* response) {
+  return shards_[0]->GetExecutionTypes(request, response);
+}
+
+absl::Status ShardedMetadataStore::GetContextTypes(
+    const GetContextTypesRequest& request, GetContextTypesResponse* response) {
+  return shards_[0]->GetContextTypes(request, response);
+}
+
+absl::Status ShardedMetadataStore::GetArtifactTypesByID(
+    const GetArtifactTypesByIDRequest& request,
+    GetArtifactTypesByIDResponse* response) {
+  return shards_[0]->GetArtifactTypesByID(request, response);
+}
+
+absl::Status ShardedMetadataStore::GetExecutionTypesByID(
+    const GetExecutionTypesByIDRequest& request,
+    GetExecutionTypesByIDResponse* response) {
+  return shards_[0]->GetExecutionTypesByID(request, response);
+}
+
+absl::Status ShardedMetadataStore::GetContextTypesByID(
+    const GetContextTypesByIDRequest& request,
+    GetContextTypesByIDResponse* response) {
+  return shards_[0]->GetContextTypesByID(request, response);
+}
+
+absl::Status ShardedMetadataStore::PutArtifacts(
+    const PutArtifactsRequest& request, PutArtifactsResponse* response) {
+  MLMD_ASSIGN_OR_RETURN(const absl::optional<int> new_node_shard,
+                        ShardOfNewNamedNodes(request.artifacts()));
+  const int default_shard = next_shard_;
+  next_shard_ = (next_shard_ + 1) % shards_.size();
+  return RouteToShard(request, &MetadataStore::PutArtifacts, response,
+                      default_shard, new_node_shard);
+}
+
+absl::Status ShardedMetadataStore::PutExecutions(
+    const PutExecutionsRequest& request, PutExecutionsResponse* response) {
+  MLMD_ASSIGN_OR_RETURN(const absl::optional<int> new_node_shard,
+                        ShardOfNewNamedNodes(request.executions()));
+  const int default_shard = next_shard_;
+  next_shard_ = (next_shard_ + 1) % shards_.size();
+  return RouteToShard(request, &MetadataStore::PutExecutions, response,
+                      default_shard, new_node_shard);
+}
+
+absl::Status ShardedMetadataStore::PutContexts(
+    const PutContextsRequest& request, PutContextsResponse* response) {
+  MLMD_ASSIGN_OR_RETURN(const absl::optional<int> new_node_shard,
+                        ShardOfNewNamedNodes(request.contexts()));
+  return RouteToShard(request, &MetadataStore::PutContexts, response,
+                      /*default_shard=*/0, new_node_shard);
+}
+
+absl::Status ShardedMetadataStore::PutEvents(const PutEventsRequest& request,
+                                             PutEventsResponse* response) {
+  return RouteToShard(request, &MetadataStore::PutEvents, response);
+}
+
+absl::Status ShardedMetadataStore::PutExecution(
+    const PutExecutionRequest& request, PutExecutionResponse* response) {
+  absl::optional<int> new_node_shard;
+  if (!request.contexts().empty() && !request.contexts(0).has_id()) {
+    new_node_shard = ShardOfNewNode(request.contexts(0).type_id(),
+                                    request.contexts(0).name());
+  }
+  const int default_shard = next_shard_;
+  next_shard_ = (next_shard_ + 1) % shards_.size();
+  return RouteToShard(request, &MetadataStore::PutExecution, response,
+                      default_shard, new_node_shard);
+}
+
+absl::Status ShardedMetadataStore::PutAttributionsAndAssociations(
+    const PutAttributionsAndAssociationsRequest& request,
+    PutAttributionsAndAssociationsResponse* response) {
+  return RouteToShard(request, &MetadataStore::PutAttributionsAndAssociations,
+                      response);
+}
+
+absl::Status ShardedMetadataStore::PutParentContexts(
+    const PutParentContextsRequest& request,
+    PutParentContextsResponse* response) {
+  return RouteToShard(request, &MetadataStore::PutParentContexts, response);
+}
+
+absl::Status ShardedMetadataStore::DeleteArtifacts(
+    const DeleteArtifactsRequest& request, DeleteArtifactsResponse* response) {
+  return RouteToShard(request, &MetadataStore::DeleteArtifacts, response);
+}
+
+absl::Status ShardedMetadataStore::DeleteExecutions(
+    const DeleteExecutionsRequest& request,
+    DeleteExecutionsResponse* response) {
+  return RouteToShard(request, &MetadataStore::DeleteExecutions, response);
+}
+
+absl::Status ShardedMetadataStore::ArchiveExecutions(
+    const ArchiveExecutionsRequest& request,
+    ArchiveExecutionsResponse* response) {
+  std::vector<ArchiveExecutionsResponse> responses;
+  MLMD_RETURN_IF_ERROR(ScatterToAllShards(
+      request, &MetadataStore::ArchiveExecutions, &responses));
+  response->Clear();
+  for (const ArchiveExecutionsResponse& shard_response : responses) {
+    response->set_num_archived_executions(
+        response->num_archived_executions() +
+        shard_response.num_archived_executions());
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ShardedMetadataStore::GetArtifactsByID(
+    const GetArtifactsByIDRequest& request,
+    GetArtifactsByIDResponse* response) {
+  return ScatterByIds(request, &GetArtifactsByIDRequest::mutable_artifact_ids,
+                      &MetadataStore::GetArtifactsByID, response);
+}
+
+absl::Status ShardedMetadataStore::GetExecutionsByID(
+    const GetExecutionsByIDRequest& request,
+    GetExecutionsByIDResponse* response) {
+  return ScatterByIds(request, &GetExecutionsByIDRequest::mutable_execution_ids,
+                      &MetadataStore::GetExecutionsByID, response);
+}
+
+absl::Status ShardedMetadataStore::GetContextsByID(
+    const GetContextsByIDRequest& request, GetContextsByIDResponse* response) {
+  return ScatterByIds(request, &GetContextsByIDRequest::mutable_context_ids,
+                      &MetadataStore::GetContextsByID, response);
+}
+
+absl::Status ShardedMetadataStore::GetEventsByExecutionIDs(
+    const GetEventsByExecutionIDsRequest& request,
+    GetEventsByExecutionIDsResponse* response) {
+  if (request.has_options()) {
+    return ListOptionsUnsupported("GetEventsByExecutionIDs");
+  }
+  return ScatterByIds(request,
+                      &GetEventsByExecutionIDsRequest::mutable_execution_ids,
+                      &MetadataStore::GetEventsByExecutionIDs, response);
+}
+
+absl::Status ShardedMetadataStore::GetEventsByArtifactIDs(
+    const GetEventsByArtifactIDsRequest& request,
+    GetEventsByArtifactIDsResponse* response) {
+  if (request.has_options()) {
+    return ListOptionsUnsupported("GetEventsByArtifactIDs");
+  }
+  return ScatterByIds(request,
+                      &GetEventsByArtifactIDsRequest::mutable_artifact_ids,
+                      &MetadataStore::GetEventsByArtifactIDs, response);
+}
+
+absl::Status ShardedMetadataStore::GetEventsByTimeRange(
+    const GetEventsByTimeRangeRequest& request,
+    GetEventsByTimeRangeResponse* response) {
+  // The events of a time range are always read a page at a time.
+  return ListOptionsUnsupported("GetEventsByTimeRange");
+}
+
+absl::Status ShardedMetadataStore::GetContextsByArtifact(
+    const GetContextsByArtifactRequest& request,
+    GetContextsByArtifactResponse* response) {
+  return RouteToShard(request, &MetadataStore::GetContextsByArtifact,
+                      response);
+}
+
+absl::Status ShardedMetadataStore::GetContextsByExecution(
+    const GetContextsByExecutionRequest& request,
+    GetContextsByExecutionResponse* response) {
+  return RouteToShard(request, &MetadataStore::GetContextsByExecution,
+                      response);
+}
+
+absl::Status ShardedMetadataStore::GetExecutionDetails(
+    const GetExecutionDetailsRequest& request,
+    GetExecutionDetailsResponse* response) {
+  return ScatterByIds(request,
+                      &GetExecutionDetailsRequest::mutable_execution_ids,
+                      &MetadataStore::GetExecutionDetails, response);
+}
+
+absl::Status ShardedMetadataStore::GetArtifactsByContext(
+    const GetArtifactsByContextRequest& request,
+    GetArtifactsByContextResponse* response) {
+  return RouteToShard(request, &MetadataStore::GetArtifactsByContext,
+                      response);
+}
+
+absl::Status ShardedMetadataStore::GetExecutionsByContext(
+    const GetExecutionsByContextRequest& request,
+    GetExecutionsByContextResponse* response) {
+  return RouteToShard(request, &MetadataStore::GetExecutionsByContext,
+                      response);
+}
+
+absl::Status ShardedMetadataStore::GetArtifactsByContexts(
+    const GetArtifactsByContextsRequest& request,
+    GetArtifactsByContextsResponse* response) {
+  return ScatterByIds(request,
+                      &GetArtifactsByContextsRequest::mutable_context_ids,
+                      &MetadataStore::GetArtifactsByContexts, response);
+}
+
+absl::Status ShardedMetadataStore::GetExecutionsByContexts(
+    const GetExecutionsByContextsRequest& request,
+    GetExecutionsByContextsResponse* response) {
+  return ScatterByIds(request,
+                      &GetExecutionsByContextsRequest::mutable_context_ids,
+                      &MetadataStore::GetExecutionsByContexts, response);
+}
+
+absl::Status ShardedMetadataStore::GetParentContextsByContext(
+    const GetParentContextsByContextRequest& request,
+    GetParentContextsByContextResponse* response) {
+  return RouteToShard(request, &MetadataStore::GetParentContextsByContext,
+                      response);
+}
+
+absl::Status ShardedMetadataStore::GetChildrenContextsByContext(
+    const GetChildrenContextsByContextRequest& request,
+    GetChildrenContextsByContextResponse* response) {
+  return RouteToShard(request, &MetadataStore::GetChildrenContextsByContext,
+                      response);
+}
+
+absl::Status ShardedMetadataStore::GetAncestorContexts(
+    const GetAncestorContextsRequest& request,
+    GetAncestorContextsResponse* response) {
+  return RouteToShard(request, &MetadataStore::GetAncestorContexts, response);
+}
+
+absl::Status ShardedMetadataStore::GetDescendantContexts(
+    const GetDescendantContextsRequest& request,
+    GetDescendantContextsResponse* response) {
+  return RouteToShard(request, &MetadataStore::GetDescendantContexts,
+                      response);
+}
+
+absl::Status ShardedMetadataStore::GetArtifactsByDerivation(
+    const GetArtifactsByDerivationRequest& request,
+    GetArtifactsByDerivationResponse* response) {
+  return RouteToShard(request, &MetadataStore::GetArtifactsByDerivation,
+                      response);
+}
+
+absl::Status ShardedMetadataStore::GetArtifacts(
+    const GetArtifactsRequest& request, GetArtifactsResponse* response) {
+  if (request.has_options()) {
+    return ListOptionsUnsupported("GetArtifacts");
+  }
+  return ScatterAndGather(request, &MetadataStore::GetArtifacts, response);
+}
+
+absl::Status ShardedMetadataStore::GetExecutions(
+    const GetExecutionsRequest& request, GetExecutionsResponse* response) {
+  if (request.has_options()) {
+    return ListOptionsUnsupported("GetExecutions");
+  }
+  return ScatterAndGather(request, &MetadataStore::GetExecutions, response);
+}
+
+absl::Status ShardedMetadataStore::GetContexts(
+    const GetContextsRequest& request, GetContextsResponse* response) {
+  if (request.has_options()) {
+    return ListOptionsUnsupported("GetContexts");
+  }
+  return ScatterAndGather(request, &MetadataStore::GetContexts, response);
+}
+
+absl::Status ShardedMetadataStore::GetArtifactsByType(
+    const GetArtifactsByTypeRequest& request,
+    GetArtifactsByTypeResponse* response) {
+  if (request.has_options()) {
+    return ListOptionsUnsupported("GetArtifactsByType");
+  }
+  return ScatterAndGather(request, &MetadataStore::GetArtifactsByType,
+                          response);
+}
+
+absl::Status ShardedMetadataStore::GetExecutionsByType(
+    const GetExecutionsByTypeRequest& request,
+    GetExecutionsByTypeResponse* response) {
+  if (request.has_options()) {
+    return ListOptionsUnsupported("GetExecutionsByType");
+  }
+  return ScatterAndGather(request, &MetadataStore::GetExecutionsByType,
+                          response);
+}
+
+absl::Status ShardedMetadataStore::GetActiveExecutionsByType(
+    const GetActiveExecutionsByTypeRequest& request,
+    GetActiveExecutionsByTypeResponse* response) {
+  return ScatterAndGather(request, &MetadataStore::GetActiveExecutionsByType,
+                          response);
+}
+
+absl::Status ShardedMetadataStore::GetContextsByType(
+    const GetContextsByTypeRequest& request,
+    GetContextsByTypeResponse* response) {
+  if (request.has_options()) {
+    return ListOptionsUnsupported("GetContextsByType");
+  }
+  return ScatterAndGather(request, &MetadataStore::GetContextsByType,
+                          response);
+}
+
+absl::Status ShardedMetadataStore::GetArtifactsByURI(
+    const GetArtifactsByURIRequest& request,
+    GetArtifactsByURIResponse* response) {
+  return ScatterAndGather(request, &MetadataStore::GetArtifactsByURI,
+                          response);
+}
+
+absl::Status ShardedMetadataStore::GetArtifactByTypeAndName(
+    const GetArtifactByTypeAndNameRequest& request,
+    GetArtifactByTypeAndNameResponse* response) {
+  return ScatterAndGetFirst(request, &MetadataStore::GetArtifactByTypeAndName,
+                            response);
+}
+
+absl::Status ShardedMetadataStore::GetExecutionByTypeAndName(
+    const GetExecutionByTypeAndNameRequest& request,
+    GetExecutionByTypeAndNameResponse* response) {
+  return ScatterAndGetFirst(request,
+                            &MetadataStore::GetExecutionByTypeAndName,
+                            response);
+}
+
+absl::Status ShardedMetadataStore::GetContextByTypeAndName(
+    const GetContextByTypeAndNameRequest& request,
+    GetContextByTypeAndNameResponse* response) {
+  return ScatterAndGetFirst(request, &MetadataStore::GetContextByTypeAndName,
+                            response);
+}
+
+absl::Status ShardedMetadataStore::GetLineageGraph(
+    const GetLineageGraphRequest& request, GetLineageGraphResponse* response) {
+  return ScatterAndGather(request, &MetadataStore::GetLineageGraph, response);
+}
+
+}  // namespace ml_metadata
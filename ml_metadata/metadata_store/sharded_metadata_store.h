@@ -0,0 +1,354 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_SHARDED_METADATA_STORE_H_
+#define ML_METADATA_METADATA_STORE_SHARDED_METADATA_STORE_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "google/protobuf/message.h"
+#include "google/protobuf/repeated_field.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_service_interface.h"
+#include "ml_metadata/metadata_store/worker_pool.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+
+// A metadata store partitioned over the databases of several MetadataStores,
+// the shards, e.g., to scale the writes beyond a single MySQL instance.
+//
+// The types are replicated: a type write is applied to every shard, and the
+// type reads use the first shard. The nodes are partitioned, and the events,
+// attributions, associations and parent contexts of a node are kept in its
+// shard. The shard of a write is picked by its shard key:
+//   - the shard of the node ids in the request, which must all be in the same
+//     shard,
+//   - the shard of the new named nodes of PutArtifacts, PutExecutions or
+//     PutContexts, which is picked by a fingerprint of their type_id and name,
+//     so a name is put in the same shard by every call, and
+//   - the shard of the first context of PutExecution if it is new, e.g., the
+//     pipeline context, which is picked likewise, so the runs of a pipeline
+//     share its shard. The other new nodes of PutExecution are put in that
+//     shard, so a named node must be put with the same first context, or by
+//     the Put call of its nodes.
+// The requests without a shard key, e.g., PutArtifacts of new unnamed
+// artifacts, are spread over the shards round-robin. The shard of a node is
+// encoded in the high bits of its id, so the ids of the first shard are the
+// ones of its database, e.g., an existing database can be kept as the first
+// shard.
+//
+// The reads by ids use the shards of the ids, and the other node reads, e.g.,
+// GetArtifacts and GetLineageGraph, are scattered to all the shards in
+// parallel and gathered. A lineage graph is traversed within each shard, as
+// the events of a node are in its shard.
+//
+// Each write is atomic within its shard, but a type write is applied to the
+// shards one by one, and is retried by calling it again. The reads of several
+// shards do not see a single snapshot. The lists with ListOperationOptions,
+// i.e., the paginated lists, of several shards and GetChanges are not
+// supported. It is not thread-safe, like the MetadataStores of its shards.
+//
+// Usage example:
+//
+//    std::vector<std::unique_ptr<MetadataStore>> shards(2);
+//    MLMD_RETURN_IF_ERROR(CreateMetadataStore(shard_0_config, &shards[0]));
+//    MLMD_RETURN_IF_ERROR(CreateMetadataStore(shard_1_config, &shards[1]));
+//    std::unique_ptr<ShardedMetadataStore> store;
+//    MLMD_RETURN_IF_ERROR(
+//        ShardedMetadataStore::Create(std::move(shards), &store));
+//    MLMD_RETURN_IF_ERROR(store->PutExecution(request, &response));
+class ShardedMetadataStore : public MetadataStoreServiceInterface {
+ public:
+  // The number of low bits of a node id that hold its id in its shard. The
+  // high bits, except the sign bit, hold the shard.
+  static constexpr int kLocalIdBits = 48;
+  static constexpr int kMaxNumShards = 1 << (63 - kLocalIdBits);
+
+  // Creates a store of the initialized `shards` in `result`. The order of the
+  // shards must not change, as it is encoded in the node ids.
+  // Returns INVALID_ARGUMENT error, if there is no shard, more than
+  //   kMaxNumShards shards, or a null shard.
+  static absl::Status Create(
+      std::vector<std::unique_ptr<MetadataStore>> shards,
+      std::unique_ptr<ShardedMetadataStore>* result);
+
+  // Disallows copy.
+  ShardedMetadataStore(const ShardedMetadataStore&) = delete;
+  ShardedMetadataStore& operator=(const ShardedMetadataStore&) = delete;
+
+  // Returns the id of the node with `local_id` in the `shard`-th shard, and
+  // the shard and the local id of a node `id`.
+  static int64 EncodeShardedId(int shard, int64 local_id);
+  static int ShardOfId(int64 id);
+  static int64 LocalIdOf(int64 id);
+
+  int num_shards() const { return shards_.size(); }
+
+  // The type writes, which are applied to every shard.
+  // Returns INTERNAL error, if a shard returns other type ids than the first
+  //   shard, e.g., as the types were put by concurrent writers in different
+  //   orders.
+  absl::Status PutArtifactType(const PutArtifactTypeRequest& request,
+                               PutArtifactTypeResponse* response) override;
+  absl::Status PutExecutionType(const PutExecutionTypeRequest& request,
+                                PutExecutionTypeResponse* response) override;
+  absl::Status PutContextType(const PutContextTypeRequest& request,
+                              PutContextTypeResponse* response) override;
+  absl::Status PutTypes(const PutTypesRequest& request,
+                        PutTypesResponse* response) override;
+
+  // The type reads, which use the first shard.
+  absl::Status GetArtifactType(const GetArtifactTypeRequest& request,
+                               GetArtifactTypeResponse* response) override;
+  absl::Status GetExecutionType(const GetExecutionTypeRequest& request,
+                                GetExecutionTypeResponse* response) override;
+  absl::Status GetContextType(const GetContextTypeRequest& request,
+                              GetContextTypeResponse* response) override;
+  absl::Status GetArtifactTypes(const GetArtifactTypesRequest& request,
+                                GetArtifactTypesResponse* response) override;
+  absl::Status GetExecutionTypes(const GetExecutionTypesRequest& request,
+                                 GetExecutionTypesResponse* response) override;
+  absl::Status GetContextTypes(const GetContextTypesRequest& request,
+                               GetContextTypesResponse* response) override;
+  absl::Status GetArtifactTypesByID(
+      const GetArtifactTypesByIDRequest& request,
+      GetArtifactTypesByIDResponse* response) override;
+  absl::Status GetExecutionTypesByID(
+      const GetExecutionTypesByIDRequest& request,
+      GetExecutionTypesByIDResponse* response) override;
+  absl::Status GetContextTypesByID(
+      const GetContextTypesByIDRequest& request,
+      GetContextTypesByIDResponse* response) override;
+
+  // The node writes, which use the shard of their shard key.
+  // Returns INVALID_ARGUMENT error, if the nodes of the request are in
+  //   different shards, e.g., as its new named nodes are, or an id is not of
+  //   a shard.
+  absl::Status PutArtifacts(const PutArtifactsRequest& request,
+                            PutArtifactsResponse* response) override;
+  absl::Status PutExecutions(const PutExecutionsRequest& request,
+                             PutExecutionsResponse* response) override;
+  absl::Status PutContexts(const PutContextsRequest& request,
+                           PutContextsResponse* response) override;
+  absl::Status PutEvents(const PutEventsRequest& request,
+                         PutEventsResponse* response) override;
+  absl::Status PutExecution(const PutExecutionRequest& request,
+                            PutExecutionResponse* response) override;
+  absl::Status PutAttributionsAndAssociations(
+      const PutAttributionsAndAssociationsRequest& request,
+      PutAttributionsAndAssociationsResponse* response) override;
+  absl::Status PutParentContexts(const PutParentContextsRequest& request,
+                                 PutParentContextsResponse* response) override;
+  absl::Status DeleteArtifacts(const DeleteArtifactsRequest& request,
+                               DeleteArtifactsResponse* response) override;
+  absl::Status DeleteExecutions(const DeleteExecutionsRequest& request,
+                                DeleteExecutionsResponse* response) override;
+  // Archives the executions of every shard, and sums up the numbers of
+  // archived executions.
+  absl::Status ArchiveExecutions(const ArchiveExecutionsRequest& request,
+                                 ArchiveExecutionsResponse* response) override;
+
+  // The reads by ids, which use the shards of the ids.
+  // Returns INVALID_ARGUMENT error, if an id is not of a shard.
+  absl::Status GetArtifactsByID(const GetArtifactsByIDRequest& request,
+                                GetArtifactsByIDResponse* response) override;
+  absl::Status GetExecutionsByID(const GetExecutionsByIDRequest& request,
+                                 GetExecutionsByIDResponse* response) override;
+  absl::Status GetContextsByID(const GetContextsByIDRequest& request,
+                               GetContextsByIDResponse* response) override;
+  absl::Status GetEventsByExecutionIDs(
+      const GetEventsByExecutionIDsRequest& request,
+      GetEventsByExecutionIDsResponse* response) override;
+  absl::Status GetEventsByArtifactIDs(
+      const GetEventsByArtifactIDsRequest& request,
+      GetEventsByArtifactIDsResponse* response) override;
+  absl::Status GetEventsByTimeRange(
+      const GetEventsByTimeRangeRequest& request,
+      GetEventsByTimeRangeResponse* response) override;
+  absl::Status GetContextsByArtifact(
+      const GetContextsByArtifactRequest& request,
+      GetContextsByArtifactResponse* response) override;
+  absl::Status GetContextsByExecution(
+      const GetContextsByExecutionRequest& request,
+      GetContextsByExecutionResponse* response) override;
+  absl::Status GetExecutionDetails(
+      const GetExecutionDetailsRequest& request,
+      GetExecutionDetailsResponse* response) override;
+  absl::Status GetArtifactsByContext(
+      const GetArtifactsByContextRequest& request,
+      GetArtifactsByContextResponse* response) override;
+  absl::Status GetExecutionsByContext(
+      const GetExecutionsByContextRequest& request,
+      GetExecutionsByContextResponse* response) override;
+  absl::Status GetArtifactsByContexts(
+      const GetArtifactsByContextsRequest& request,
+      GetArtifactsByContextsResponse* response) override;
+  absl::Status GetExecutionsByContexts(
+      const GetExecutionsByContextsRequest& request,
+      GetExecutionsByContextsResponse* response) override;
+  absl::Status GetParentContextsByContext(
+      const GetParentContextsByContextRequest& request,
+      GetParentContextsByContextResponse* response) override;
+  absl::Status GetChildrenContextsByContext(
+      const GetChildrenContextsByContextRequest& request,
+      GetChildrenContextsByContextResponse* response) override;
+  absl::Status GetAncestorContexts(
+      const GetAncestorContextsRequest& request,
+      GetAncestorContextsResponse* response) override;
+  absl::Status GetDescendantContexts(
+      const GetDescendantContextsRequest& request,
+      GetDescendantContextsResponse* response) override;
+  absl::Status GetArtifactsByDerivation(
+      const GetArtifactsByDerivationRequest& request,
+      GetArtifactsByDerivationResponse* response) override;
+
+  // The other node reads, which are scattered to all the shards.
+  // Returns UNIMPLEMENTED error, if a list has ListOperationOptions.
+  absl::Status GetArtifacts(const GetArtifactsRequest& request,
+                            GetArtifactsResponse* response) override;
+  absl::Status GetExecutions(const GetExecutionsRequest& request,
+                             GetExecutionsResponse* response) override;
+  absl::Status GetContexts(const GetContextsRequest& request,
+                           GetContextsResponse* response) override;
+  absl::Status GetArtifactsByType(
+      const GetArtifactsByTypeRequest& request,
+      GetArtifactsByTypeResponse* response) override;
+  absl::Status GetExecutionsByType(
+      const GetExecutionsByTypeRequest& request,
+      GetExecutionsByTypeResponse* response) override;
+  absl::Status GetActiveExecutionsByType(
+      const GetActiveExecutionsByTypeRequest& request,
+      GetActiveExecutionsByTypeResponse* response) override;
+  absl::Status GetContextsByType(const GetContextsByTypeRequest& request,
+                                 GetContextsByTypeResponse* response) override;
+  absl::Status GetArtifactsByURI(const GetArtifactsByURIRequest& request,
+                                 GetArtifactsByURIResponse* response) override;
+  absl::Status GetArtifactByTypeAndName(
+      const GetArtifactByTypeAndNameRequest& request,
+      GetArtifactByTypeAndNameResponse* response) override;
+  absl::Status GetExecutionByTypeAndName(
+      const GetExecutionByTypeAndNameRequest& request,
+      GetExecutionByTypeAndNameResponse* response) override;
+  absl::Status GetContextByTypeAndName(
+      const GetContextByTypeAndNameRequest& request,
+      GetContextByTypeAndNameResponse* response) override;
+  // The subgraph is gathered from the subgraphs of the shards, so the
+  // max_node_size of the options bounds the nodes of each shard.
+  absl::Status GetLineageGraph(const GetLineageGraphRequest& request,
+                               GetLineageGraphResponse* response) override;
+
+ private:
+  explicit ShardedMetadataStore(
+      std::vector<std::unique_ptr<MetadataStore>> shards);
+
+  // Returns the shard of a new node, i.e., of the fingerprint of its type_id
+  // and name.
+  int ShardOfNewNode(int64 type_id, absl::string_view name) const;
+
+  // Returns the shard of the new named `nodes`, i.e., the ones without id, or
+  // nullopt if there is none.
+  // Returns INVALID_ARGUMENT error, if they are in different shards.
+  template <typename Node>
+  absl::StatusOr<absl::optional<int>> ShardOfNewNamedNodes(
+      const google::protobuf::RepeatedPtrField<Node>& nodes) const;
+
+  // Replaces the node ids of `message` with the local ids of their shard.
+  // Returns the shard of the ids, or nullopt if there is none.
+  // Returns INVALID_ARGUMENT error, if the ids are in different shards, or an
+  //   id is not of a shard.
+  absl::StatusOr<absl::optional<int>> LocalizeNodeIds(
+      google::protobuf::Message* message) const;
+
+  // Replaces the local node ids of `message` of the `shard`-th shard with
+  // their ids.
+  // Returns OUT_OF_RANGE error, if a local id cannot be encoded.
+  absl::Status GlobalizeNodeIds(int shard,
+                                google::protobuf::Message* message) const;
+
+  // Runs `call` with each of `shards` in parallel, the first one in the
+  // calling thread, and returns once all of them are done.
+  // Returns the first error of the calls.
+  absl::Status RunOnShards(absl::Span<const int> shards,
+                           const std::function<absl::Status(int)>& call);
+
+  // Runs `call` of `request` on the shard of its shard key, or on the
+  // `default_shard` if it has none, with the ids made local, then makes the
+  // ids of `response` global. The `new_node_shard` is the shard of the new
+  // nodes of the request, if any.
+  template <typename Request, typename Response>
+  absl::Status RouteToShard(
+      const Request& request,
+      absl::Status (MetadataStore::*call)(const Request&, Response*),
+      Response* response, int default_shard = 0,
+      absl::optional<int> new_node_shard = absl::nullopt);
+
+  // Runs `call` of `request` on every shard, and checks that the shards
+  // return the same types.
+  template <typename Request, typename Response>
+  absl::Status PutTypesOnAllShards(
+      const Request& request,
+      absl::Status (MetadataStore::*call)(const Request&, Response*),
+      Response* response);
+
+  // Splits the ids of `request` by their shard, runs `call` with the ids of
+  // each shard in parallel, and gathers the responses to `response`.
+  template <typename Request, typename Response, typename Ids>
+  absl::Status ScatterByIds(
+      const Request& request, Ids* (Request::*mutable_ids)(),
+      absl::Status (MetadataStore::*call)(const Request&, Response*),
+      Response* response);
+
+  // Runs `call` of `request` on all the shards in parallel, and returns the
+  // responses of the shards with global ids in `responses`.
+  template <typename Request, typename Response>
+  absl::Status ScatterToAllShards(
+      const Request& request,
+      absl::Status (MetadataStore::*call)(const Request&, Response*),
+      std::vector<Response>* responses);
+
+  // Like ScatterToAllShards, but gathers all the responses to `response`.
+  template <typename Request, typename Response>
+  absl::Status ScatterAndGather(
+      const Request& request,
+      absl::Status (MetadataStore::*call)(const Request&, Response*),
+      Response* response);
+
+  // Like ScatterToAllShards, but returns the first non-empty response, e.g.,
+  // of a node found by its name, in `response`.
+  template <typename Request, typename Response>
+  absl::Status ScatterAndGetFirst(
+      const Request& request,
+      absl::Status (MetadataStore::*call)(const Request&, Response*),
+      Response* response);
+
+  std::vector<std::unique_ptr<MetadataStore>> shards_;
+  // Runs the calls of the shards other than the one of the calling thread.
+  // It is null if there is a single shard.
+  std::unique_ptr<WorkerPool> worker_pool_;
+  // The shard of the next write without a shard key.
+  int next_shard_ = 0;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_SHARDED_METADATA_STORE_H_
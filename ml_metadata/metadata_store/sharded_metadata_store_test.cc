@@ -0,0 +1,270 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/sharded_metadata_store.h"
+
+#include <memory>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/sqlite_metadata_source.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/metadata_store/transaction_executor.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+#include "ml_metadata/util/metadata_source_query_config.h"
+
+namespace ml_metadata {
+namespace testing {
+namespace {
+
+using ::testing::SizeIs;
+using ::testing::UnorderedElementsAre;
+
+constexpr int kNumShards = 3;
+
+std::unique_ptr<MetadataStore> CreateShard() {
+  auto metadata_source =
+      absl::make_unique<SqliteMetadataSource>(SqliteMetadataSourceConfig());
+  auto transaction_executor =
+      absl::make_unique<RdbmsTransactionExecutor>(metadata_source.get());
+  std::unique_ptr<MetadataStore> metadata_store;
+  CHECK_EQ(
+      absl::OkStatus(),
+      MetadataStore::Create(util::GetSqliteMetadataSourceQueryConfig(), {},
+                            std::move(metadata_source),
+                            std::move(transaction_executor), &metadata_store));
+  CHECK_EQ(absl::OkStatus(), metadata_store->InitMetadataStore());
+  return metadata_store;
+}
+
+class ShardedMetadataStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::vector<std::unique_ptr<MetadataStore>> shards;
+    for (int i = 0; i < kNumShards; i++) {
+      shards.push_back(CreateShard());
+      shards_.push_back(shards.back().get());
+    }
+    ASSERT_EQ(absl::OkStatus(),
+              ShardedMetadataStore::Create(std::move(shards), &store_));
+    PutTypesResponse response;
+    ASSERT_EQ(absl::OkStatus(),
+              store_->PutTypes(ParseTextProtoOrDie<PutTypesRequest>(R"(
+                                 artifact_types: { name: 'artifact_type' }
+                                 execution_types: { name: 'execution_type' }
+                                 context_types: { name: 'pipeline' }
+                               )"),
+                               &response));
+    artifact_type_id_ = response.artifact_type_ids(0);
+    execution_type_id_ = response.execution_type_ids(0);
+    context_type_id_ = response.context_type_ids(0);
+  }
+
+  // Puts an execution of the `pipeline` context, and returns the response.
+  PutExecutionResponse PutPipelineRun(const std::string& pipeline) {
+    PutExecutionRequest request;
+    request.mutable_execution()->set_type_id(execution_type_id_);
+    Context* context = request.add_contexts();
+    context->set_type_id(context_type_id_);
+    context->set_name(pipeline);
+    request.mutable_options()->set_reuse_context_if_already_exist(true);
+    PutExecutionResponse response;
+    CHECK_EQ(absl::OkStatus(), store_->PutExecution(request, &response));
+    return response;
+  }
+
+  // Puts a new artifact, and returns its id.
+  int64 PutArtifact() {
+    PutArtifactsRequest request;
+    request.add_artifacts()->set_type_id(artifact_type_id_);
+    PutArtifactsResponse response;
+    CHECK_EQ(absl::OkStatus(), store_->PutArtifacts(request, &response));
+    return response.artifact_ids(0);
+  }
+
+  std::vector<MetadataStore*> shards_;
+  std::unique_ptr<ShardedMetadataStore> store_;
+  int64 artifact_type_id_;
+  int64 execution_type_id_;
+  int64 context_type_id_;
+};
+
+TEST(ShardedMetadataStoreIdTest, EncodesShardInId) {
+  EXPECT_EQ(ShardedMetadataStore::EncodeShardedId(0, 42), 42);
+  const int64 id = ShardedMetadataStore::EncodeShardedId(5, 42);
+  EXPECT_EQ(ShardedMetadataStore::ShardOfId(id), 5);
+  EXPECT_EQ(ShardedMetadataStore::LocalIdOf(id), 42);
+}
+
+TEST(ShardedMetadataStoreCreateTest, RequiresShards) {
+  std::unique_ptr<ShardedMetadataStore> store;
+  EXPECT_TRUE(
+      absl::IsInvalidArgument(ShardedMetadataStore::Create({}, &store)));
+}
+
+TEST_F(ShardedMetadataStoreTest, ReplicatesTypes) {
+  for (MetadataStore* shard : shards_) {
+    GetArtifactTypeRequest request;
+    request.set_type_name("artifact_type");
+    GetArtifactTypeResponse response;
+    ASSERT_EQ(absl::OkStatus(), shard->GetArtifactType(request, &response));
+    EXPECT_EQ(response.artifact_type().id(), artifact_type_id_);
+  }
+}
+
+TEST_F(ShardedMetadataStoreTest, PutsRunsOfPipelineInItsShard) {
+  const PutExecutionResponse run_1 = PutPipelineRun("pipeline");
+  const PutExecutionResponse run_2 = PutPipelineRun("pipeline");
+  ASSERT_THAT(run_1.context_ids(), SizeIs(1));
+  EXPECT_EQ(run_1.context_ids(0), run_2.context_ids(0));
+  const int shard = ShardedMetadataStore::ShardOfId(run_1.context_ids(0));
+  EXPECT_EQ(ShardedMetadataStore::ShardOfId(run_1.execution_id()), shard);
+  EXPECT_EQ(ShardedMetadataStore::ShardOfId(run_2.execution_id()), shard);
+
+  GetExecutionsByContextRequest request;
+  request.set_context_id(run_1.context_ids(0));
+  GetExecutionsByContextResponse response;
+  ASSERT_EQ(absl::OkStatus(),
+            store_->GetExecutionsByContext(request, &response));
+  ASSERT_THAT(response.executions(), SizeIs(2));
+  EXPECT_THAT(
+      (std::vector<int64>{response.executions(0).id(),
+                          response.executions(1).id()}),
+      UnorderedElementsAre(run_1.execution_id(), run_2.execution_id()));
+}
+
+TEST_F(ShardedMetadataStoreTest, PutsNamedContextInTheShardOfItsName) {
+  PutContextsRequest request;
+  Context* context = request.add_contexts();
+  context->set_type_id(context_type_id_);
+  context->set_name("pipeline");
+  PutContextsResponse response;
+  ASSERT_EQ(absl::OkStatus(), store_->PutContexts(request, &response));
+  ASSERT_THAT(response.context_ids(), SizeIs(1));
+  // The second call is routed to the same shard, which keeps the name unique.
+  PutContextsResponse duplicate_response;
+  EXPECT_TRUE(absl::IsAlreadyExists(
+      store_->PutContexts(request, &duplicate_response)));
+  // PutExecution with the context as its first context uses that shard too.
+  const PutExecutionResponse run = PutPipelineRun("pipeline");
+  ASSERT_THAT(run.context_ids(), SizeIs(1));
+  EXPECT_EQ(run.context_ids(0), response.context_ids(0));
+}
+
+TEST_F(ShardedMetadataStoreTest, RejectsNewNamedNodesOfDifferentShards) {
+  bool rejected = false;
+  for (int i = 0; i < 20 && !rejected; i++) {
+    PutContextsRequest request;
+    for (const char* prefix : {"pipeline_a", "pipeline_b"}) {
+      Context* context = request.add_contexts();
+      context->set_type_id(context_type_id_);
+      context->set_name(absl::StrCat(prefix, "_", i));
+    }
+    PutContextsResponse response;
+    const absl::Status status = store_->PutContexts(request, &response);
+    if (status.ok()) {
+      ASSERT_THAT(response.context_ids(), SizeIs(2));
+      EXPECT_EQ(ShardedMetadataStore::ShardOfId(response.context_ids(0)),
+                ShardedMetadataStore::ShardOfId(response.context_ids(1)));
+      continue;
+    }
+    EXPECT_TRUE(absl::IsInvalidArgument(status)) << status;
+    rejected = true;
+  }
+  EXPECT_TRUE(rejected);
+}
+
+TEST_F(ShardedMetadataStoreTest, ScattersReadsToShards) {
+  std::vector<int64> artifact_ids;
+  for (int i = 0; i < kNumShards; i++) {
+    artifact_ids.push_back(PutArtifact());
+  }
+  // The artifacts without a shard key are spread over the shards.
+  EXPECT_THAT((std::vector<int>{
+                  ShardedMetadataStore::ShardOfId(artifact_ids[0]),
+                  ShardedMetadataStore::ShardOfId(artifact_ids[1]),
+                  ShardedMetadataStore::ShardOfId(artifact_ids[2])}),
+              UnorderedElementsAre(0, 1, 2));
+
+  GetArtifactsResponse get_artifacts_response;
+  ASSERT_EQ(absl::OkStatus(),
+            store_->GetArtifacts({}, &get_artifacts_response));
+  EXPECT_THAT(get_artifacts_response.artifacts(), SizeIs(kNumShards));
+
+  GetArtifactsByIDRequest get_by_id_request;
+  get_by_id_request.add_artifact_ids(artifact_ids[2]);
+  get_by_id_request.add_artifact_ids(artifact_ids[0]);
+  GetArtifactsByIDResponse get_by_id_response;
+  ASSERT_EQ(absl::OkStatus(),
+            store_->GetArtifactsByID(get_by_id_request, &get_by_id_response));
+  ASSERT_THAT(get_by_id_response.artifacts(), SizeIs(2));
+  EXPECT_THAT((std::vector<int64>{get_by_id_response.artifacts(0).id(),
+                                  get_by_id_response.artifacts(1).id()}),
+              UnorderedElementsAre(artifact_ids[0], artifact_ids[2]));
+
+  GetArtifactsRequest list_request;
+  list_request.mutable_options()->set_max_result_size(1);
+  EXPECT_TRUE(absl::IsUnimplemented(
+      store_->GetArtifacts(list_request, &get_artifacts_response)));
+}
+
+TEST_F(ShardedMetadataStoreTest, GathersLineageOfShards) {
+  for (const char* pipeline : {"pipeline_1", "pipeline_2", "pipeline_3"}) {
+    const PutExecutionResponse run = PutPipelineRun(pipeline);
+    PutExecutionRequest request;
+    request.mutable_execution()->set_id(run.execution_id());
+    request.mutable_execution()->set_type_id(execution_type_id_);
+    PutExecutionRequest::ArtifactAndEvent* output =
+        request.add_artifact_event_pairs();
+    output->mutable_artifact()->set_type_id(artifact_type_id_);
+    output->mutable_event()->set_type(Event::OUTPUT);
+    PutExecutionResponse response;
+    ASSERT_EQ(absl::OkStatus(), store_->PutExecution(request, &response));
+  }
+
+  GetLineageGraphRequest request;
+  request.mutable_options()->mutable_artifacts_options()->set_filter_query(
+      "type = 'artifact_type'");
+  GetLineageGraphResponse response;
+  ASSERT_EQ(absl::OkStatus(), store_->GetLineageGraph(request, &response));
+  EXPECT_THAT(response.subgraph().artifacts(), SizeIs(3));
+  EXPECT_THAT(response.subgraph().executions(), SizeIs(3));
+  EXPECT_THAT(response.subgraph().events(), SizeIs(3));
+}
+
+TEST_F(ShardedMetadataStoreTest, RejectsWritesAcrossShards) {
+  const int64 artifact_id = PutArtifact();
+  int64 other_artifact_id = PutArtifact();
+  while (ShardedMetadataStore::ShardOfId(other_artifact_id) ==
+         ShardedMetadataStore::ShardOfId(artifact_id)) {
+    other_artifact_id = PutArtifact();
+  }
+  DeleteArtifactsRequest request;
+  request.add_artifact_ids(artifact_id);
+  request.add_artifact_ids(other_artifact_id);
+  DeleteArtifactsResponse response;
+  EXPECT_TRUE(
+      absl::IsInvalidArgument(store_->DeleteArtifacts(request, &response)));
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace ml_metadata
@@ -25,11 +25,21 @@ limitations under the License.
 namespace ml_metadata {
 
 absl::Status LoadSimpleTypes(SimpleTypes& simple_types) {
-  if (!google::protobuf::TextFormat::ParseFromString(std::string(kSimpleTypes),
-                                           &simple_types)) {
+  // The parsed types are null, if kSimpleTypes fails to parse.
+  static const SimpleTypes* const parsed_simple_types = []() {
+    auto* parsed = new SimpleTypes();
+    if (!google::protobuf::TextFormat::ParseFromString(std::string(kSimpleTypes),
+                                             parsed)) {
+      delete parsed;
+      return static_cast<SimpleTypes*>(nullptr);
+    }
+    return parsed;
+  }();
+  if (parsed_simple_types == nullptr) {
     return absl::InvalidArgumentError(
         "Failed to parse simple types from string");
   }
+  simple_types = *parsed_simple_types;
   return absl::OkStatus();
 }
 
@@ -23,6 +23,8 @@ limitations under the License.
 namespace ml_metadata {
 
 // A util to create a SimpleTypes proto from a constant string at runtime.
+// The string is parsed once per process, and the later calls copy the parsed
+// proto.
 absl::Status LoadSimpleTypes(SimpleTypes& simple_types);
 
 // Returns the SystemTypeExtension of the enum field base_type in input 'type'.
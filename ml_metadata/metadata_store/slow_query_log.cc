@@ -0,0 +1,125 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/slow_query_log.h"
+
+#include <atomic>
+#include <utility>
+
+#include <glog/logging.h>
+#include "google/protobuf/descriptor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ml_metadata {
+namespace {
+
+std::atomic<SlowQueryLog*> default_slow_query_log{nullptr};
+
+}  // namespace
+
+SlowQueryLog::SlowQueryLog(
+    const MetadataStoreServerConfig::SlowQueryLogConfig& config)
+    : threshold_(absl::Milliseconds(config.threshold_ms())),
+      explain_sample_rate_(config.explain_sample_rate()),
+      max_recent_queries_(config.max_recent_queries()) {}
+
+bool SlowQueryLog::ShouldExplain() {
+  if (explain_sample_rate_ <= 0) {
+    return false;
+  }
+  if (explain_sample_rate_ >= 1) {
+    return true;
+  }
+  absl::MutexLock lock(&mu_);
+  return absl::Bernoulli(bitgen_, explain_sample_rate_);
+}
+
+void SlowQueryLog::Record(SlowQuery query) {
+  std::string message =
+      absl::StrCat("Slow query", query.query_name.empty() ? "" : " ",
+                   query.query_name, " (", absl::FormatDuration(query.latency),
+                   ", ", query.num_rows, " rows) of ",
+                   query.origin.empty() ? "an unknown call" : query.origin,
+                   ": ", query.query);
+  if (!query.status.ok()) {
+    absl::StrAppend(&message, "\nStatus: ", query.status.ToString());
+  }
+  if (!query.plan.empty()) {
+    absl::StrAppend(&message, "\nPlan:\n", query.plan);
+  }
+  LOG(WARNING) << message;
+  if (max_recent_queries_ <= 0) {
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  recent_queries_.push_back(std::move(query));
+  while (recent_queries_.size() > max_recent_queries_) {
+    recent_queries_.pop_front();
+  }
+}
+
+std::vector<SlowQuery> SlowQueryLog::RecentQueries() const {
+  absl::MutexLock lock(&mu_);
+  return std::vector<SlowQuery>(recent_queries_.begin(),
+                                recent_queries_.end());
+}
+
+std::string FormatQueryPlan(const RecordSet& plan) {
+  std::string result = absl::StrJoin(plan.column_names(), " | ");
+  for (const RecordSet::Record& record : plan.records()) {
+    absl::StrAppend(&result, "\n", absl::StrJoin(record.values(), " | "));
+  }
+  return result;
+}
+
+std::string SlowQueryOrigin(absl::string_view method,
+                            const google::protobuf::Message& request) {
+  std::string origin(method);
+  const google::protobuf::FieldDescriptor* options_field =
+      request.GetDescriptor()->FindFieldByName("options");
+  if (options_field == nullptr ||
+      options_field->type() !=
+          google::protobuf::FieldDescriptor::TYPE_MESSAGE ||
+      options_field->is_repeated() ||
+      !request.GetReflection()->HasField(request, options_field)) {
+    return origin;
+  }
+  const google::protobuf::Message& options =
+      request.GetReflection()->GetMessage(request, options_field);
+  const google::protobuf::FieldDescriptor* filter_query_field =
+      options.GetDescriptor()->FindFieldByName("filter_query");
+  if (filter_query_field == nullptr ||
+      filter_query_field->type() !=
+          google::protobuf::FieldDescriptor::TYPE_STRING ||
+      filter_query_field->is_repeated() ||
+      !options.GetReflection()->HasField(options, filter_query_field)) {
+    return origin;
+  }
+  absl::StrAppend(
+      &origin, " filter_query: \"",
+      options.GetReflection()->GetString(options, filter_query_field), "\"");
+  return origin;
+}
+
+SlowQueryLog* GetDefaultSlowQueryLog() {
+  return default_slow_query_log.load(std::memory_order_acquire);
+}
+
+void SetDefaultSlowQueryLog(SlowQueryLog* slow_query_log) {
+  default_slow_query_log.store(slow_query_log, std::memory_order_release);
+}
+
+}  // namespace ml_metadata
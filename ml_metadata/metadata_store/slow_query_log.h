@@ -0,0 +1,121 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_SLOW_QUERY_LOG_H_
+#define ML_METADATA_METADATA_STORE_SLOW_QUERY_LOG_H_
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/message.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// A query of a MetadataSource slower than the threshold of a SlowQueryLog.
+struct SlowQuery {
+  // The SQL sent to the database. The parameters of a prepared query are
+  // appended to its text.
+  std::string query;
+  // The name of the template query, e.g., "select_artifact_by_id", or empty
+  // if the query is not a template query.
+  std::string query_name;
+  // The call issuing the query, e.g., `GetArtifacts filter_query: "..."`, or
+  // empty if unknown.
+  std::string origin;
+  absl::Duration latency;
+  int64 num_rows = 0;
+  absl::Status status;
+  // The plan returned by `EXPLAIN`, one line per row, or empty if the plan is
+  // not captured for the query.
+  std::string plan;
+};
+
+// Logs the queries of the metadata sources taking at least a threshold as
+// warnings, and keeps the most recent ones in memory. The plan of a sample of
+// the slow queries is captured by the metadata source with `EXPLAIN`, so
+// that the queries generated for list filters missing an index can be found
+// in production. It is thread-safe.
+//
+// Usage example:
+//
+//    SlowQueryLog slow_query_log(config);
+//    SetDefaultSlowQueryLog(&slow_query_log);
+//    // creates and uses metadata stores.
+//    for (const SlowQuery& query : slow_query_log.RecentQueries()) { ... }
+class SlowQueryLog {
+ public:
+  explicit SlowQueryLog(
+      const MetadataStoreServerConfig::SlowQueryLogConfig& config);
+
+  // Disallows copy.
+  SlowQueryLog(const SlowQueryLog&) = delete;
+  SlowQueryLog& operator=(const SlowQueryLog&) = delete;
+
+  // Returns the latency from which a query is logged.
+  absl::Duration threshold() const { return threshold_; }
+
+  // Returns true if the plan of a slow query is to be captured, which is
+  // sampled at the `explain_sample_rate` of the config.
+  bool ShouldExplain();
+
+  // Logs the slow `query` and keeps it in the recent queries.
+  void Record(SlowQuery query);
+
+  // Returns the most recent slow queries, from the oldest one.
+  std::vector<SlowQuery> RecentQueries() const;
+
+ private:
+  const absl::Duration threshold_;
+  const double explain_sample_rate_;
+  const int max_recent_queries_;
+
+  mutable absl::Mutex mu_;
+  absl::BitGen bitgen_ ABSL_GUARDED_BY(mu_);
+  std::deque<SlowQuery> recent_queries_ ABSL_GUARDED_BY(mu_);
+};
+
+// Returns the `plan` returned by `EXPLAIN` as text, with the column names on
+// the first line and the values of each row on the next ones, separated by
+// " | ".
+std::string FormatQueryPlan(const RecordSet& plan);
+
+// Returns the origin of the queries of the call of `method` with the
+// `request`, i.e., the method name followed by the `filter_query` of the
+// `options` of the request, if any, e.g.,
+//   GetArtifacts filter_query: "uri LIKE '%/model'"
+std::string SlowQueryOrigin(absl::string_view method,
+                            const google::protobuf::Message& request);
+
+// Returns the slow query log given to the metadata sources when they are
+// created, or nullptr if the slow queries are not logged.
+SlowQueryLog* GetDefaultSlowQueryLog();
+
+// Sets the slow query log given to the metadata sources created afterwards.
+// The `slow_query_log` is not owned, and must outlast the metadata sources;
+// nullptr disables the log of new metadata sources.
+void SetDefaultSlowQueryLog(SlowQueryLog* slow_query_log);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_SLOW_QUERY_LOG_H_
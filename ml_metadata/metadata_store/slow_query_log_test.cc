@@ -0,0 +1,145 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/slow_query_log.h"
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/metadata_store.h"
+#include "ml_metadata/metadata_store/metadata_store_factory.h"
+#include "ml_metadata/metadata_store/sqlite_metadata_source.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/proto/metadata_store_service.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::Not;
+using ::testing::SizeIs;
+
+TEST(SlowQueryLogTest, RecordKeepsMostRecentQueries) {
+  SlowQueryLog slow_query_log(
+      ParseTextProtoOrDie<MetadataStoreServerConfig::SlowQueryLogConfig>(
+          "threshold_ms: 10 max_recent_queries: 2"));
+  EXPECT_EQ(slow_query_log.threshold(), absl::Milliseconds(10));
+  EXPECT_FALSE(slow_query_log.ShouldExplain());
+  for (const char* query : {"SELECT 1", "SELECT 2", "SELECT 3"}) {
+    SlowQuery slow_query;
+    slow_query.query = query;
+    slow_query_log.Record(slow_query);
+  }
+
+  const std::vector<SlowQuery> recent_queries = slow_query_log.RecentQueries();
+  ASSERT_THAT(recent_queries, SizeIs(2));
+  EXPECT_EQ(recent_queries[0].query, "SELECT 2");
+  EXPECT_EQ(recent_queries[1].query, "SELECT 3");
+}
+
+TEST(SlowQueryLogTest, FormatQueryPlan) {
+  EXPECT_EQ(FormatQueryPlan(ParseTextProtoOrDie<RecordSet>(R"(
+              column_names: 'id'
+              column_names: 'detail'
+              records: { values: '2' values: 'SCAN Artifact' }
+              records: { values: '5' values: 'SEARCH Type USING INDEX' }
+            )")),
+            "id | detail\n2 | SCAN Artifact\n5 | SEARCH Type USING INDEX");
+}
+
+TEST(SlowQueryLogTest, SlowQueryOrigin) {
+  EXPECT_EQ(SlowQueryOrigin("GetArtifacts",
+                            ParseTextProtoOrDie<GetArtifactsRequest>(
+                                "options: { filter_query: \"uri = 'a'\" }")),
+            "GetArtifacts filter_query: \"uri = 'a'\"");
+  EXPECT_EQ(SlowQueryOrigin("GetArtifacts",
+                            ParseTextProtoOrDie<GetArtifactsRequest>(
+                                "options: { max_result_size: 10 }")),
+            "GetArtifacts");
+  EXPECT_EQ(SlowQueryOrigin("GetArtifactType", GetArtifactTypeRequest()),
+            "GetArtifactType");
+}
+
+TEST(SlowQueryLogTest, MetadataSourceLogsSlowQueriesWithPlans) {
+  SlowQueryLog slow_query_log(
+      ParseTextProtoOrDie<MetadataStoreServerConfig::SlowQueryLogConfig>(
+          "threshold_ms: 0 explain_sample_rate: 1"));
+  SqliteMetadataSource metadata_source(SqliteMetadataSourceConfig{});
+  metadata_source.set_slow_query_log(&slow_query_log);
+  metadata_source.set_query_origin("GetArtifacts filter_query: \"c1 = 2\"");
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Connect());
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source.ExecuteQuery("CREATE TABLE t1 (c1 INT);", nullptr,
+                                         "create_t1"));
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source.ExecuteQuery("SELECT c1 FROM t1 WHERE c1 = 2;",
+                                         &record_set, "select_t1"));
+  ASSERT_EQ(absl::OkStatus(), metadata_source.Commit());
+
+  const std::vector<SlowQuery> recent_queries = slow_query_log.RecentQueries();
+  ASSERT_THAT(recent_queries, SizeIs(2));
+  EXPECT_EQ(recent_queries[0].query_name, "create_t1");
+  EXPECT_THAT(recent_queries[0].plan, IsEmpty());
+  EXPECT_EQ(recent_queries[1].query, "SELECT c1 FROM t1 WHERE c1 = 2;");
+  EXPECT_EQ(recent_queries[1].query_name, "select_t1");
+  EXPECT_EQ(recent_queries[1].origin, "GetArtifacts filter_query: \"c1 = 2\"");
+  EXPECT_EQ(recent_queries[1].status, absl::OkStatus());
+  EXPECT_THAT(recent_queries[1].plan, HasSubstr("SCAN t1"));
+}
+
+TEST(SlowQueryLogTest, MetadataStoreLogsTemplateQueries) {
+  SlowQueryLog slow_query_log(
+      ParseTextProtoOrDie<MetadataStoreServerConfig::SlowQueryLogConfig>(
+          "threshold_ms: 0"));
+  SetDefaultSlowQueryLog(&slow_query_log);
+  ConnectionConfig connection_config;
+  connection_config.mutable_fake_database();
+  std::unique_ptr<MetadataStore> metadata_store;
+  ASSERT_EQ(absl::OkStatus(),
+            CreateMetadataStore(connection_config, &metadata_store));
+  SetDefaultSlowQueryLog(nullptr);
+
+  metadata_store->set_query_origin("PutArtifactType");
+  PutArtifactTypeResponse response;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_store->PutArtifactType(
+                ParseTextProtoOrDie<PutArtifactTypeRequest>(
+                    "artifact_type: { name: 'test_type' }"),
+                &response));
+  // The types of the simple types are inserted when the store is created.
+  const std::vector<SlowQuery> recent_queries = slow_query_log.RecentQueries();
+  ASSERT_THAT(recent_queries, Not(IsEmpty()));
+  bool logged_insert = false;
+  for (const SlowQuery& slow_query : recent_queries) {
+    if (slow_query.origin == "PutArtifactType" &&
+        slow_query.query_name == "insert_artifact_type") {
+      logged_insert = true;
+      EXPECT_THAT(slow_query.query, HasSubstr("'test_type'"));
+    }
+  }
+  EXPECT_TRUE(logged_insert);
+}
+
+}  // namespace
+}  // namespace ml_metadata
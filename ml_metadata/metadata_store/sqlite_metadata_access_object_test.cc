@@ -40,11 +40,11 @@ class SqliteMetadataAccessObjectContainer
     : public QueryConfigMetadataAccessObjectContainer {
  public:
   SqliteMetadataAccessObjectContainer(
-      absl::optional<int64> earlier_schema_version = absl::nullopt)
+      absl::optional<int64> earlier_schema_version = absl::nullopt,
+      const SqliteMetadataSourceConfig& config = SqliteMetadataSourceConfig())
       : QueryConfigMetadataAccessObjectContainer(
             util::GetSqliteMetadataSourceQueryConfig(),
             earlier_schema_version) {
-    SqliteMetadataSourceConfig config;
     metadata_source_ = absl::make_unique<SqliteMetadataSource>(config);
     CHECK_EQ(
         absl::OkStatus(),
@@ -71,9 +71,16 @@ class SqliteMetadataAccessObjectContainer
 
 INSTANTIATE_TEST_SUITE_P(
     SqliteMetadataAccessObjectTest, MetadataAccessObjectTest,
-    ::testing::Values([]() {
-      return absl::make_unique<SqliteMetadataAccessObjectContainer>();
-    }));
+    ::testing::Values(
+        []() {
+          return absl::make_unique<SqliteMetadataAccessObjectContainer>();
+        },
+        []() {
+          SqliteMetadataSourceConfig config;
+          config.set_enable_prepared_statements(true);
+          return absl::make_unique<SqliteMetadataAccessObjectContainer>(
+              absl::nullopt, config);
+        }));
 
 }  // namespace testing
 }  // namespace ml_metadata
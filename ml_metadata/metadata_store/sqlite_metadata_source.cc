@@ -14,16 +14,24 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
 
+#include <limits>
 #include <random>
+#include <string>
+#include <vector>
 
 #include <glog/logging.h>
 #include "absl/status/status.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/strip.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "ml_metadata/metadata_store/constants.h"
+#include "ml_metadata/metadata_store/record_set_util.h"
 #include "ml_metadata/metadata_store/sqlite_metadata_source_util.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/util/return_utils.h"
 #include "sqlite3.h"
 
 namespace ml_metadata {
@@ -32,15 +40,22 @@ namespace {
 
 constexpr char kInMemoryConnection[] = ":memory:";
 constexpr char kBeginTransaction[] = "BEGIN;";
+constexpr char kBeginImmediateTransaction[] = "BEGIN IMMEDIATE;";
 constexpr char kCommitTransaction[] = "COMMIT;";
 constexpr char kRollbackTransaction[] = "ROLLBACK;";
 
+// The max number of prepared statements cached for a connection. The queries
+// having IN lists are prepared for each list size, so the cache is cleared
+// when it is full.
+constexpr int kMaxNumPreparedStatements = 256;
+
 // Returns a Sqlite3 connection flags based on the SqliteMetadataSourceConfig.
 // (see https://www.sqlite.org/c3ref/open.html for details)
 int GetConnectionFlag(const SqliteMetadataSourceConfig& config) {
   int result = SQLITE_OPEN_URI;
   switch (config.connection_mode()) {
-    case SqliteMetadataSourceConfig::READONLY: {
+    case SqliteMetadataSourceConfig::READONLY:
+    case SqliteMetadataSourceConfig::IMMUTABLE: {
       result |= SQLITE_OPEN_READONLY;
       break;
     }
@@ -58,6 +73,78 @@ int GetConnectionFlag(const SqliteMetadataSourceConfig& config) {
   return result;
 }
 
+// Returns the PRAGMA statements applying the performance profile of the
+// `config` on a connection. The page size is set before the journal mode, as
+// it cannot be changed once the database is in WAL mode.
+std::vector<std::string> GetPerformanceProfilePragmas(
+    const SqliteMetadataSourceConfig& config) {
+  using Profile = SqliteMetadataSourceConfig::PerformanceProfile;
+  const Profile& profile = config.performance_profile();
+  const bool is_immutable =
+      config.connection_mode() == SqliteMetadataSourceConfig::IMMUTABLE;
+  const bool is_readonly =
+      config.connection_mode() == SqliteMetadataSourceConfig::READONLY ||
+      is_immutable;
+  std::vector<std::string> pragmas;
+  if (profile.has_page_size() && !is_readonly) {
+    pragmas.push_back(absl::StrCat("PRAGMA page_size = ", profile.page_size()));
+  }
+  if (profile.journal_mode() != Profile::JOURNAL_MODE_UNSPECIFIED &&
+      !is_readonly) {
+    pragmas.push_back(absl::StrCat(
+        "PRAGMA journal_mode = ",
+        absl::StripPrefix(Profile::JournalMode_Name(profile.journal_mode()),
+                          "JOURNAL_MODE_")));
+  }
+  if (profile.synchronous() != Profile::SYNCHRONOUS_UNSPECIFIED) {
+    pragmas.push_back(absl::StrCat(
+        "PRAGMA synchronous = ",
+        absl::StripPrefix(Profile::Synchronous_Name(profile.synchronous()),
+                          "SYNCHRONOUS_")));
+  }
+  if (profile.has_mmap_size()) {
+    pragmas.push_back(absl::StrCat("PRAGMA mmap_size = ", profile.mmap_size()));
+  } else if (is_immutable) {
+    // Maps the whole file, as sqlite3 caps the size at SQLITE_MAX_MMAP_SIZE.
+    pragmas.push_back(absl::StrCat("PRAGMA mmap_size = ",
+                                   std::numeric_limits<int64>::max()));
+  }
+  if (profile.has_cache_size()) {
+    pragmas.push_back(
+        absl::StrCat("PRAGMA cache_size = ", profile.cache_size()));
+  }
+  if (profile.temp_store() != Profile::TEMP_STORE_UNSPECIFIED) {
+    pragmas.push_back(absl::StrCat(
+        "PRAGMA temp_store = ",
+        absl::StripPrefix(Profile::TempStore_Name(profile.temp_store()),
+                          "TEMP_STORE_")));
+  }
+  return pragmas;
+}
+
+// Returns the URI opening the database of `filename_uri` with the
+// `immutable=1` parameter. A plain filename is turned into a file URI, whose
+// reserved characters are percent-encoded.
+std::string GetImmutableUri(absl::string_view filename_uri) {
+  std::string uri;
+  if (absl::StartsWith(filename_uri, "file:")) {
+    uri = std::string(filename_uri);
+  } else {
+    uri = "file:";
+    for (const char c : filename_uri) {
+      if (c == '%' || c == '?' || c == '#') {
+        absl::StrAppend(&uri, "%", absl::Hex(static_cast<unsigned char>(c),
+                                             absl::kZeroPad2));
+      } else {
+        uri.push_back(c);
+      }
+    }
+  }
+  absl::StrAppend(&uri, absl::StrContains(uri, "?") ? "&" : "?",
+                  "immutable=1");
+  return uri;
+}
+
 // A set of options when waiting for table locks in a sqlite3_busy_handler.
 // see WaitThenRetry for details.
 struct WaitThenRetryOptions {
@@ -95,6 +182,57 @@ int WaitThenRetry(void* options, int retried_times) {
   return 1;
 }
 
+// Returns the type of a typed column following the affinity rules of its
+// declared type (see https://www.sqlite.org/datatype3.html). The type of an
+// expression, which has no declared type, follows the current row value.
+RecordSet::Column::Type GetColumnType(sqlite3_stmt* stmt, const int column) {
+  const char* declared_type = sqlite3_column_decltype(stmt, column);
+  if (declared_type == nullptr) {
+    switch (sqlite3_column_type(stmt, column)) {
+      case SQLITE_INTEGER:
+        return RecordSet::Column::INT;
+      case SQLITE_FLOAT:
+        return RecordSet::Column::DOUBLE;
+      default:
+        return RecordSet::Column::STRING;
+    }
+  }
+  const std::string type = absl::AsciiStrToUpper(declared_type);
+  if (absl::StrContains(type, "INT")) {
+    return RecordSet::Column::INT;
+  }
+  if (absl::StrContains(type, "REAL") || absl::StrContains(type, "FLOA") ||
+      absl::StrContains(type, "DOUB")) {
+    return RecordSet::Column::DOUBLE;
+  }
+  return RecordSet::Column::STRING;
+}
+
+// Appends the value of the current row at `column` to `typed_column`. The
+// value is read with the sqlite3_column_* function of the column type.
+void AppendColumnValue(sqlite3_stmt* stmt, const int column,
+                       RecordSet::Column* typed_column) {
+  if (sqlite3_column_type(stmt, column) == SQLITE_NULL) {
+    AppendNullValue(typed_column);
+    return;
+  }
+  switch (typed_column->type()) {
+    case RecordSet::Column::INT:
+      AppendInt64Value(sqlite3_column_int64(stmt, column), typed_column);
+      break;
+    case RecordSet::Column::DOUBLE:
+      AppendDoubleValue(sqlite3_column_double(stmt, column), typed_column);
+      break;
+    default: {
+      const char* text =
+          reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+      AppendStringValue(
+          absl::string_view(text, sqlite3_column_bytes(stmt, column)),
+          typed_column);
+    }
+  }
+}
+
 }  // namespace
 
 SqliteMetadataSource::SqliteMetadataSource(
@@ -105,6 +243,16 @@ SqliteMetadataSource::SqliteMetadataSource(
   if (!config_.connection_mode())
     config_.set_connection_mode(
         SqliteMetadataSourceConfig::READWRITE_OPENCREATE);
+  // Every connection to an in-memory database opens a new database, and the
+  // read-only connections never write.
+  const bool writable =
+      config_.connection_mode() == SqliteMetadataSourceConfig::READWRITE ||
+      config_.connection_mode() ==
+          SqliteMetadataSourceConfig::READWRITE_OPENCREATE;
+  if (config_.enable_write_queue() && writable &&
+      config_.filename_uri() != kInMemoryConnection) {
+    write_queue_ = SqliteWriteQueue::Get(config_.filename_uri());
+  }
 }
 
 SqliteMetadataSource::~SqliteMetadataSource() {
@@ -112,21 +260,44 @@ SqliteMetadataSource::~SqliteMetadataSource() {
 }
 
 absl::Status SqliteMetadataSource::ConnectImpl() {
-  if (sqlite3_open_v2(config_.filename_uri().c_str(), &db_,
-                      GetConnectionFlag(config_), nullptr) != SQLITE_OK) {
+  std::string filename_uri = config_.filename_uri();
+  if (is_immutable()) {
+    if (filename_uri == kInMemoryConnection) {
+      return absl::InvalidArgumentError(
+          "An IMMUTABLE connection requires a database file.");
+    }
+    filename_uri = GetImmutableUri(filename_uri);
+  }
+  if (sqlite3_open_v2(filename_uri.c_str(), &db_, GetConnectionFlag(config_),
+                      nullptr) != SQLITE_OK) {
     std::string error_message = sqlite3_errmsg(db_);
     sqlite3_close(db_);
     db_ = nullptr;
     return absl::InternalError(
         absl::StrCat("Cannot connect sqlite3 database: ", error_message));
   }
-  // required to handle cases when tables are locked when executing queries
-  sqlite3_busy_handler(db_, &WaitThenRetry, nullptr);
+  // required to handle cases when tables are locked when executing queries,
+  // which never happens to an immutable database.
+  if (!is_immutable()) {
+    sqlite3_busy_handler(db_, &WaitThenRetry, nullptr);
+  }
+  for (const std::string& pragma : GetPerformanceProfilePragmas(config_)) {
+    const absl::Status status = RunStatement(pragma, nullptr);
+    if (!status.ok()) {
+      sqlite3_close(db_);
+      db_ = nullptr;
+      return status;
+    }
+  }
   return absl::OkStatus();
 }
 
 absl::Status SqliteMetadataSource::CloseImpl() {
+  // Closing the connection rolls back its transaction.
+  DequeueWrite();
   if (db_ != nullptr) {
+    // sqlite3_close fails if there are unfinalized statements.
+    ClearPreparedStatements();
     int error_code = sqlite3_close(db_);
     if (error_code != SQLITE_OK) {
       return absl::InternalError(
@@ -139,17 +310,30 @@ absl::Status SqliteMetadataSource::CloseImpl() {
 
 absl::Status SqliteMetadataSource::RunStatement(const std::string& query,
                                                 RecordSet* results = nullptr) {
-  char* error_message;
-  if (sqlite3_exec(db_, query.c_str(), &ConvertSqliteResultsToRecordSet,
-                   results, &error_message) != SQLITE_OK) {
-    std::string error_details = error_message;
-    sqlite3_free(error_message);
-    if (absl::StrContains(error_details, "database is locked")) {
-      return absl::AbortedError(
+  // The statements are stepped one by one instead of sqlite3_exec, whose
+  // callback receives the values as C strings, so that the blob values, e.g.,
+  // the proto values, are read as is.
+  const char* tail = query.c_str();
+  while (*tail != '\0') {
+    sqlite3_stmt* stmt = nullptr;
+    int error_code = sqlite3_prepare_v2(db_, tail, -1, &stmt, &tail);
+    absl::Status status;
+    if (error_code == SQLITE_BUSY) {
+      status = absl::AbortedError(
           "Concurrent writes aborted after max number of retries.");
+    } else if (error_code != SQLITE_OK) {
+      status = absl::InternalError(sqlite3_errmsg(db_));
+    } else if (stmt != nullptr) {
+      // The stmt is null for a trailing comment or whitespace.
+      status = RunPreparedStatement(stmt, /*parameters=*/{},
+                                    RecordSetLayout::kRecords, results);
+      sqlite3_finalize(stmt);
     }
-    return absl::InternalError(absl::StrCat(
-        "Error when executing query: ", error_details, " query: ", query));
+    if (absl::IsInternal(status)) {
+      return absl::InternalError(absl::StrCat(
+          "Error when executing query: ", status.message(), " query: ", query));
+    }
+    MLMD_RETURN_IF_ERROR(status);
   }
   return absl::OkStatus();
 }
@@ -159,21 +343,228 @@ absl::Status SqliteMetadataSource::ExecuteQueryImpl(const std::string& query,
   return RunStatement(query, results);
 }
 
+absl::Status SqliteMetadataSource::ExplainQueryImpl(const std::string& query,
+                                                    RecordSet* plan) {
+  return RunStatement(absl::StrCat("EXPLAIN QUERY PLAN ", query), plan);
+}
+
+int64 SqliteMetadataSource::NumRowsChangedImpl() {
+  return db_ == nullptr ? 0 : sqlite3_changes(db_);
+}
+
+absl::optional<int64> SqliteMetadataSource::LastInsertIdImpl() {
+  if (db_ == nullptr) return absl::nullopt;
+  return sqlite3_last_insert_rowid(db_);
+}
+
+absl::Status SqliteMetadataSource::ExecutePreparedQueryImpl(
+    const std::string& query, absl::Span<const Value> parameters,
+    RecordSet* results, const RecordSetLayout layout) {
+  sqlite3_stmt* stmt = nullptr;
+  MLMD_RETURN_IF_ERROR(GetPreparedStatement(query, &stmt));
+  const absl::Status status =
+      RunPreparedStatement(stmt, parameters, layout, results);
+  // Resets the statement, so that it does not hold locks until it is reused.
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  if (absl::IsInternal(status)) {
+    return absl::InternalError(absl::StrCat(
+        "Error when executing query: ", status.message(), " query: ", query));
+  }
+  return status;
+}
+
+absl::Status SqliteMetadataSource::GetPreparedStatement(
+    const std::string& query, sqlite3_stmt** stmt) {
+  auto it = prepared_statements_.find(query);
+  if (it != prepared_statements_.end()) {
+    *stmt = it->second;
+    return absl::OkStatus();
+  }
+  const int error_code = sqlite3_prepare_v2(db_, query.c_str(), query.size(),
+                                            stmt, /*pzTail=*/nullptr);
+  if (error_code != SQLITE_OK) {
+    if (error_code == SQLITE_BUSY) {
+      return absl::AbortedError(
+          "Concurrent writes aborted after max number of retries.");
+    }
+    return absl::InternalError(absl::StrCat("Error when preparing query: ",
+                                            sqlite3_errmsg(db_),
+                                            " query: ", query));
+  }
+  if (prepared_statements_.size() >= kMaxNumPreparedStatements) {
+    ClearPreparedStatements();
+  }
+  prepared_statements_.insert({query, *stmt});
+  return absl::OkStatus();
+}
+
+absl::Status SqliteMetadataSource::RunPreparedStatement(
+    sqlite3_stmt* stmt, absl::Span<const Value> parameters,
+    const RecordSetLayout layout, RecordSet* results) {
+  if (sqlite3_bind_parameter_count(stmt) != parameters.size()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "The query has ", sqlite3_bind_parameter_count(stmt),
+        " placeholders, but ", parameters.size(), " parameters are given."));
+  }
+  for (int i = 0; i < parameters.size(); i++) {
+    // The parameter index of sqlite3_bind_* starts from 1.
+    const Value& parameter = parameters[i];
+    int error_code = SQLITE_OK;
+    switch (parameter.value_case()) {
+      case Value::kIntValue:
+        error_code = sqlite3_bind_int64(stmt, i + 1, parameter.int_value());
+        break;
+      case Value::kDoubleValue:
+        error_code = sqlite3_bind_double(stmt, i + 1, parameter.double_value());
+        break;
+      case Value::kStringValue:
+        // The parameters outlive the execution, so the text is not copied.
+        error_code = sqlite3_bind_text(
+            stmt, i + 1, parameter.string_value().data(),
+            parameter.string_value().size(), SQLITE_STATIC);
+        break;
+      case Value::kProtoValue: {
+        const std::string serialized =
+            parameter.proto_value().SerializeAsString();
+        error_code =
+            sqlite3_bind_blob(stmt, i + 1, serialized.data(), serialized.size(),
+                              SQLITE_TRANSIENT);
+        break;
+      }
+      case Value::VALUE_NOT_SET:
+        error_code = sqlite3_bind_null(stmt, i + 1);
+        break;
+      default:
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Unsupported parameter type: ", parameter.DebugString()));
+    }
+    if (error_code != SQLITE_OK) {
+      return absl::InternalError(sqlite3_errmsg(db_));
+    }
+  }
+  int error_code;
+  while ((error_code = sqlite3_step(stmt)) == SQLITE_ROW) {
+    // ignore the results of the query, if the user passes a nullptr for
+    // results.
+    if (results == nullptr) continue;
+    // sets the column names when the first row is returned, which is the same
+    // as what ConvertSqliteResultsToRecordSet does for sqlite3_exec.
+    const int column_num = sqlite3_column_count(stmt);
+    if (results->column_names_size() != column_num) {
+      results->clear_column_names();
+      results->clear_columns();
+      for (int i = 0; i < column_num; i++) {
+        results->add_column_names(sqlite3_column_name(stmt, i));
+        if (layout == RecordSetLayout::kTypedColumns) {
+          results->add_columns()->set_type(GetColumnType(stmt, i));
+        }
+      }
+    }
+    if (layout == RecordSetLayout::kTypedColumns) {
+      for (int i = 0; i < column_num; i++) {
+        AppendColumnValue(stmt, i, results->mutable_columns(i));
+      }
+      continue;
+    }
+    RecordSet::Record* record = results->add_records();
+    for (int i = 0; i < column_num; i++) {
+      if (sqlite3_column_type(stmt, i) == SQLITE_NULL) {
+        record->add_values(kMetadataSourceNull);
+      } else {
+        // sqlite3_column_bytes is called after sqlite3_column_text, as the
+        // text conversion may change the size.
+        const char* text =
+            reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+        record->add_values(text, sqlite3_column_bytes(stmt, i));
+      }
+    }
+  }
+  if (error_code != SQLITE_DONE) {
+    if (error_code == SQLITE_BUSY) {
+      return absl::AbortedError(
+          "Concurrent writes aborted after max number of retries.");
+    }
+    return absl::InternalError(sqlite3_errmsg(db_));
+  }
+  return absl::OkStatus();
+}
+
+void SqliteMetadataSource::ClearPreparedStatements() {
+  for (const auto& query_and_stmt : prepared_statements_) {
+    sqlite3_finalize(query_and_stmt.second);
+  }
+  prepared_statements_.clear();
+}
+
 absl::Status SqliteMetadataSource::BeginImpl() {
+  // An immutable database needs no transaction to read a consistent state.
+  if (is_immutable()) {
+    return absl::OkStatus();
+  }
+  if (write_queue_ == nullptr) {
+    return RunStatement(kBeginTransaction);
+  }
+  // Once it is the turn of the transaction, it takes the write lock up front,
+  // which no other connection of the process holds.
+  write_queue_->Enqueue();
+  write_queue_turn_ = true;
+  const absl::Status status = RunStatement(kBeginImmediateTransaction);
+  if (!status.ok()) {
+    DequeueWrite();
+  }
+  return status;
+}
+
+absl::Status SqliteMetadataSource::BeginReadOnlyImpl() {
+  if (is_immutable()) {
+    return absl::OkStatus();
+  }
   return RunStatement(kBeginTransaction);
 }
 
+void SqliteMetadataSource::DequeueWrite() {
+  if (write_queue_turn_) {
+    write_queue_turn_ = false;
+    write_queue_->Dequeue();
+  }
+}
 
 absl::Status SqliteMetadataSource::CommitImpl() {
-  return RunStatement(kCommitTransaction);
+  if (is_immutable()) {
+    return absl::OkStatus();
+  }
+  const absl::Status status = RunStatement(kCommitTransaction);
+  // A failed commit is rolled back by the caller, which ends the turn.
+  if (status.ok()) {
+    DequeueWrite();
+  }
+  return status;
 }
 
 absl::Status SqliteMetadataSource::RollbackImpl() {
-  return RunStatement(kRollbackTransaction);
+  if (is_immutable()) {
+    return absl::OkStatus();
+  }
+  const absl::Status status = RunStatement(kRollbackTransaction);
+  DequeueWrite();
+  return status;
+}
+
+absl::Status SqliteMetadataSource::CancelQueryImpl() {
+  if (db_ != nullptr) {
+    sqlite3_interrupt(db_);
+  }
+  return absl::OkStatus();
 }
 
 std::string SqliteMetadataSource::EscapeString(absl::string_view value) const {
   return SqliteEscapeString(value);
 }
 
+void SqliteMetadataSource::AppendEscapedString(absl::string_view value,
+                                               std::string* out) const {
+  AppendSqliteEscapedString(value, out);
+}
+
 }  // namespace ml_metadata
@@ -15,8 +15,14 @@ limitations under the License.
 #ifndef ML_METADATA_METADATA_STORE_SQLITE_METADATA_SOURCE_H_
 #define ML_METADATA_METADATA_STORE_SQLITE_METADATA_SOURCE_H_
 
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/sqlite_write_queue.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
 #include "sqlite3.h"
 
@@ -25,7 +31,11 @@ namespace ml_metadata {
 // A MetadataSource based on Sqlite3. By default it uses a in memory Sqlite3
 // database, and destroys it when the metadata source is destructed. It can be
 // configured via a SqliteMetadataSourceConfig to use physical Sqlite3 and open
-// it in read only, read and write, and create if not exists modes.
+// it in read only, read and write, and create if not exists modes, or in the
+// immutable mode, which neither locks the database nor begins transactions.
+// The PRAGMA settings of the config's performance profile are applied on
+// connect. If the config enables the write queue, the write transactions of
+// the process to the database wait for their turn in a SqliteWriteQueue.
 // This class is thread-unsafe. Multiple objects can be created by using the
 // same SqliteMetadataSourceConfig to use the same Sqlite3 database.
 class SqliteMetadataSource : public MetadataSource {
@@ -40,6 +50,15 @@ class SqliteMetadataSource : public MetadataSource {
   // Escape strings having single quotes using built-in printf in Sqlite3 C API.
   std::string EscapeString(absl::string_view value) const final;
 
+  // Escapes the single quotes of `value` into `out`.
+  void AppendEscapedString(absl::string_view value,
+                           std::string* out) const final;
+
+  // Prepared statements are used if `enable_prepared_statements` is set.
+  bool SupportsPreparedStatements() const final {
+    return config_.enable_prepared_statements();
+  }
+
  private:
   // Creates an in memory db.
   // If error happens, Returns INTERNAL error.
@@ -52,24 +71,77 @@ class SqliteMetadataSource : public MetadataSource {
   absl::Status ExecuteQueryImpl(const std::string& query,
                                 RecordSet* results) final;
 
+  // Binds the parameters to the cached sqlite3_stmt of the query, which is
+  // prepared with sqlite3_prepare_v2 at the first use, and steps through the
+  // rows.
+  absl::Status ExecutePreparedQueryImpl(const std::string& query,
+                                        absl::Span<const Value> parameters,
+                                        RecordSet* results,
+                                        RecordSetLayout layout) final;
+
+  // Returns the plan of the query with EXPLAIN QUERY PLAN.
+  absl::Status ExplainQueryImpl(const std::string& query,
+                                RecordSet* plan) final;
+
+  // Returns the rows changed by the last statement with sqlite3_changes.
+  int64 NumRowsChangedImpl() final;
+
+  // Returns the rowid of the last insert with sqlite3_last_insert_rowid.
+  absl::optional<int64> LastInsertIdImpl() final;
+
   // Commits a transaction.
   absl::Status CommitImpl() final;
 
   // Rollbacks a transaction
   absl::Status RollbackImpl() final;
 
-  // Begins a transaction
+  // Begins a transaction, after its turn in the write queue if enabled.
   absl::Status BeginImpl() final;
 
+  // Begins a transaction without waiting in the write queue.
+  absl::Status BeginReadOnlyImpl() final;
+
+  // Ends the turn of the transaction in the write queue, if it has one.
+  void DequeueWrite();
+
+  // Interrupts the running query with sqlite3_interrupt, which is safe to call
+  // from another thread.
+  absl::Status CancelQueryImpl() final;
 
   // Util methods to execute query.
   absl::Status RunStatement(const std::string& query, RecordSet* results);
 
+  // Gets the cached prepared statement of the query, or prepares a new one.
+  absl::Status GetPreparedStatement(const std::string& query,
+                                    sqlite3_stmt** stmt);
+
+  // Runs a prepared statement with the given parameters to completion.
+  absl::Status RunPreparedStatement(sqlite3_stmt* stmt,
+                                    absl::Span<const Value> parameters,
+                                    RecordSetLayout layout, RecordSet* results);
+
+  // Finalizes all cached prepared statements.
+  void ClearPreparedStatements();
+
+  // Returns true if the database is connected in the IMMUTABLE mode.
+  bool is_immutable() const {
+    return config_.connection_mode() == SqliteMetadataSourceConfig::IMMUTABLE;
+  }
+
   // The sqlite3 handle to a database.
   sqlite3* db_ = nullptr;
 
+  // The prepared statements of the connection keyed by the query.
+  absl::flat_hash_map<std::string, sqlite3_stmt*> prepared_statements_;
+
   // A config including connection parameters.
   SqliteMetadataSourceConfig config_;
+
+  // The write queue of the database, if enabled.
+  std::shared_ptr<SqliteWriteQueue> write_queue_;
+
+  // Whether the running transaction has the turn in the write queue.
+  bool write_queue_turn_ = false;
 };
 
 }  // namespace ml_metadata
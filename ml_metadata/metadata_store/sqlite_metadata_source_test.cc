@@ -14,13 +14,22 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/metadata_store/sqlite_metadata_source.h"
 
+#include <cstdio>
 #include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include <glog/logging.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "ml_metadata/metadata_store/metadata_source_test_suite.h"
+#include "ml_metadata/metadata_store/sqlite_write_queue.h"
 #include "ml_metadata/metadata_store/test_util.h"
 
 namespace ml_metadata {
@@ -28,6 +37,7 @@ namespace testing {
 
 namespace {
 using ml_metadata::testing::EqualsProto;
+using ml_metadata::testing::ParseTextProtoOrDie;
 
 class SqliteMetadataSourceContainer : public MetadataSourceContainer {
  public:
@@ -84,6 +94,207 @@ TEST(SqliteMetadataSourceExtendedTest, TestEscapeString) {
   EXPECT_EQ(metadata_source->EscapeString("''"), "''''");
   EXPECT_EQ(metadata_source->EscapeString("'\'"), "''''");
   EXPECT_EQ(metadata_source->EscapeString("'\"text\"'"), "''\"text\"''");
+
+  // Appends the escaped string in place.
+  std::string query = "SELECT '";
+  metadata_source->AppendEscapedString("it's", &query);
+  EXPECT_EQ(query, "SELECT 'it''s");
+}
+
+// Test prepared statements are bound and reused.
+TEST(SqliteMetadataSourceExtendedTest, TestExecutePreparedQuery) {
+  SqliteMetadataSourceConfig config;
+  config.set_enable_prepared_statements(true);
+  SqliteMetadataSourceContainer container(config);
+  container.InitSchemaAndPopulateRows();
+  MetadataSource* metadata_source = container.GetMetadataSource();
+  ASSERT_TRUE(metadata_source->SupportsPreparedStatements());
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  std::vector<Value> parameters(2);
+  parameters[0].set_int_value(4);
+  parameters[1].set_string_value("v'4");
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecutePreparedQuery(
+                "INSERT INTO t1 VALUES (?, ?)", parameters, nullptr));
+  // Reuses the cached statement with a NULL parameter.
+  parameters[0].set_int_value(5);
+  parameters[1].Clear();
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecutePreparedQuery(
+                "INSERT INTO t1 VALUES (?, ?)", parameters, nullptr));
+
+  std::vector<Value> ids(2);
+  ids[0].set_int_value(4);
+  ids[1].set_int_value(5);
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecutePreparedQuery(
+                "SELECT c1, c2 FROM t1 WHERE c1 IN (?, ?) ORDER BY c1", ids,
+                &record_set));
+  EXPECT_THAT(record_set, EqualsProto(ParseTextProtoOrDie<RecordSet>(R"pb(
+                column_names: "c1"
+                column_names: "c2"
+                records: { values: "4" values: "v'4" }
+                records: { values: "5" values: "__MLMD_NULL__" }
+              )pb")));
+
+  EXPECT_TRUE(absl::IsInvalidArgument(metadata_source->ExecutePreparedQuery(
+      "SELECT c1 FROM t1 WHERE c1 = ?", {}, &record_set)));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+}
+
+// Test the id of the last insert is reported without a query.
+TEST(SqliteMetadataSourceExtendedTest, TestLastInsertId) {
+  SqliteMetadataSourceContainer container;
+  MetadataSource* metadata_source = container.GetMetadataSource();
+  EXPECT_EQ(metadata_source->LastInsertId(), absl::nullopt);
+  container.InitSchemaAndPopulateRows();
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery("INSERT INTO t1 VALUES (4, 'v4')",
+                                          nullptr));
+  const absl::optional<int64> last_insert_id = metadata_source->LastInsertId();
+  // A query does not change the id.
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            metadata_source->ExecuteQuery("SELECT last_insert_rowid()",
+                                          &record_set));
+  ASSERT_EQ(absl::OkStatus(), metadata_source->Commit());
+  ASSERT_TRUE(last_insert_id.has_value());
+  EXPECT_EQ(absl::StrCat(*last_insert_id), record_set.records(0).values(0));
+  EXPECT_EQ(metadata_source->LastInsertId(), last_insert_id);
+}
+
+// Test the performance profile is applied on connect, and a READONLY
+// connection reads the database while a writer has an open transaction.
+TEST(SqliteMetadataSourceExtendedTest, TestPerformanceProfile) {
+  const std::string filename_uri =
+      absl::StrCat(::testing::TempDir(), "/performance_profile.db");
+  std::remove(filename_uri.c_str());
+  SqliteMetadataSourceConfig config = ParseTextProtoOrDie<
+      SqliteMetadataSourceConfig>(R"pb(
+    performance_profile {
+      journal_mode: JOURNAL_MODE_WAL
+      synchronous: SYNCHRONOUS_NORMAL
+      mmap_size: 1048576
+      cache_size: -4096
+      temp_store: TEMP_STORE_MEMORY
+      page_size: 8192
+    }
+  )pb");
+  config.set_filename_uri(filename_uri);
+  SqliteMetadataSourceContainer writer_container(config);
+  writer_container.InitSchemaAndPopulateRows();
+  MetadataSource* writer = writer_container.GetMetadataSource();
+  ASSERT_EQ(absl::OkStatus(), writer->Begin());
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            writer->ExecuteQuery("PRAGMA journal_mode", &record_set));
+  EXPECT_EQ(record_set.records(0).values(0), "wal");
+  ASSERT_EQ(absl::OkStatus(),
+            writer->ExecuteQuery("PRAGMA page_size", &record_set));
+  EXPECT_EQ(record_set.records(1).values(0), "8192");
+  ASSERT_EQ(absl::OkStatus(),
+            writer->ExecuteQuery("INSERT INTO t1 VALUES (4, 'v4')", nullptr));
+
+  config.set_connection_mode(SqliteMetadataSourceConfig::READONLY);
+  SqliteMetadataSourceContainer reader_container(config);
+  MetadataSource* reader = reader_container.GetMetadataSource();
+  ASSERT_EQ(absl::OkStatus(), reader->Connect());
+  ASSERT_EQ(absl::OkStatus(), reader->Begin());
+  RecordSet reader_record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            reader->ExecuteQuery("SELECT count(*) FROM t1",
+                                 &reader_record_set));
+  EXPECT_EQ(reader_record_set.records(0).values(0), "3");
+  ASSERT_EQ(absl::OkStatus(), reader->Commit());
+  ASSERT_EQ(absl::OkStatus(), writer->Commit());
+}
+
+TEST(SqliteMetadataSourceExtendedTest, TestImmutableConnectionMode) {
+  const std::string filename_uri =
+      absl::StrCat(::testing::TempDir(), "/immutable.db");
+  std::remove(filename_uri.c_str());
+  SqliteMetadataSourceConfig config;
+  config.set_filename_uri(filename_uri);
+  {
+    SqliteMetadataSourceContainer writer_container(config);
+    writer_container.InitSchemaAndPopulateRows();
+  }
+
+  config.set_connection_mode(SqliteMetadataSourceConfig::IMMUTABLE);
+  SqliteMetadataSourceContainer reader_container(config);
+  MetadataSource* reader = reader_container.GetMetadataSource();
+  ASSERT_EQ(absl::OkStatus(), reader->Connect());
+  ASSERT_EQ(absl::OkStatus(), reader->Begin());
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            reader->ExecuteQuery("SELECT count(*) FROM t1", &record_set));
+  EXPECT_EQ(record_set.records(0).values(0), "3");
+  ASSERT_EQ(absl::OkStatus(),
+            reader->ExecuteQuery("PRAGMA mmap_size", &record_set));
+  EXPECT_NE(record_set.records(1).values(0), "0");
+  EXPECT_FALSE(
+      reader->ExecuteQuery("INSERT INTO t1 VALUES (4, 'v4')", nullptr).ok());
+  ASSERT_EQ(absl::OkStatus(), reader->Commit());
+
+  SqliteMetadataSourceConfig in_memory_config;
+  in_memory_config.set_connection_mode(SqliteMetadataSourceConfig::IMMUTABLE);
+  SqliteMetadataSource in_memory_source(in_memory_config);
+  EXPECT_TRUE(absl::IsInvalidArgument(in_memory_source.Connect()));
+}
+
+TEST(SqliteMetadataSourceExtendedTest, TestWriteQueue) {
+  const std::string filename_uri =
+      absl::StrCat(::testing::TempDir(), "/write_queue.db");
+  std::remove(filename_uri.c_str());
+  SqliteMetadataSourceConfig config = ParseTextProtoOrDie<
+      SqliteMetadataSourceConfig>(R"pb(
+    performance_profile { journal_mode: JOURNAL_MODE_WAL }
+    enable_write_queue: true
+  )pb");
+  config.set_filename_uri(filename_uri);
+  SqliteMetadataSourceContainer writer_container(config);
+  writer_container.InitSchemaAndPopulateRows();
+  MetadataSource* writer = writer_container.GetMetadataSource();
+  ASSERT_EQ(absl::OkStatus(), writer->Begin());
+  ASSERT_EQ(absl::OkStatus(),
+            writer->ExecuteQuery("INSERT INTO t1 VALUES (4, 'v4')", nullptr));
+
+  // The second writer waits in the queue until the first one commits.
+  SqliteMetadataSource queued_writer(config);
+  ASSERT_EQ(absl::OkStatus(), queued_writer.Connect());
+  absl::Status queued_status;
+  std::thread queued_thread([&queued_writer, &queued_status]() {
+    queued_status = queued_writer.Begin();
+    queued_status.Update(
+        queued_writer.ExecuteQuery("INSERT INTO t1 VALUES (5, 'v5')", nullptr));
+    queued_status.Update(queued_writer.Commit());
+  });
+  std::shared_ptr<SqliteWriteQueue> queue = SqliteWriteQueue::Get(filename_uri);
+  while (queue->size() < 2) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+
+  // The readers do not wait in the queue.
+  SqliteMetadataSource reader(config);
+  ASSERT_EQ(absl::OkStatus(), reader.Connect());
+  ASSERT_EQ(absl::OkStatus(), reader.BeginReadOnly());
+  RecordSet record_set;
+  ASSERT_EQ(absl::OkStatus(),
+            reader.ExecuteQuery("SELECT count(*) FROM t1", &record_set));
+  EXPECT_EQ(record_set.records(0).values(0), "3");
+  ASSERT_EQ(absl::OkStatus(), reader.Commit());
+
+  ASSERT_EQ(absl::OkStatus(), writer->Commit());
+  queued_thread.join();
+  ASSERT_EQ(absl::OkStatus(), queued_status);
+  EXPECT_EQ(queue->size(), 0);
+  ASSERT_EQ(absl::OkStatus(), reader.BeginReadOnly());
+  ASSERT_EQ(absl::OkStatus(),
+            reader.ExecuteQuery("SELECT count(*) FROM t1", &record_set));
+  EXPECT_EQ(record_set.records(1).values(0), "5");
+  ASSERT_EQ(absl::OkStatus(), reader.Commit());
 }
 
 }  // namespace
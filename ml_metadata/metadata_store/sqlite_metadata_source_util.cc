@@ -27,6 +27,15 @@ std::string SqliteEscapeString(absl::string_view value) {
   return result;
 }
 
+void AppendSqliteEscapedString(absl::string_view value, std::string* out) {
+  out->reserve(out->size() + value.size());
+  for (const char c : value) {
+    if (c == '\0') break;
+    out->push_back(c);
+    if (c == '\'') out->push_back(c);
+  }
+}
+
 int ConvertSqliteResultsToRecordSet(void* results, int column_num,
                                     char** column_vals, char** column_names) {
   // return if queries return no result, e.g., create, insert, update, etc.
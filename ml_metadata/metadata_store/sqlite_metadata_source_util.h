@@ -24,6 +24,10 @@ namespace ml_metadata {
 // Escapes strings having single quotes using built-in printf in Sqlite3 C API.
 std::string SqliteEscapeString(absl::string_view value);
 
+// Appends `value` escaped as by SqliteEscapeString to `out`, i.e., with the
+// single quotes doubled, up to its first null character.
+void AppendSqliteEscapedString(absl::string_view value, std::string* out);
+
 // Converts the query results (`column_vals`) if any to a RecordSet (`results`).
 // It is used as a callback of sqlite3_exec. The `results` should be owned by
 // the caller of sqlite3_exec. If the given RecordSet (`results`) is nullptr,
@@ -35,10 +35,10 @@ namespace {
 // QueryExecutor based on a SqliteMetadataSource.
 class SqliteQueryConfigExecutorContainer : public QueryConfigExecutorContainer {
  public:
-  SqliteQueryConfigExecutorContainer()
+  explicit SqliteQueryConfigExecutorContainer(
+      const SqliteMetadataSourceConfig& config = SqliteMetadataSourceConfig())
       : QueryConfigExecutorContainer(
             util::GetSqliteMetadataSourceQueryConfig()) {
-    SqliteMetadataSourceConfig config;
     metadata_source_ = absl::make_unique<SqliteMetadataSource>(config);
     if (!metadata_source_->is_connected())
       CHECK_EQ(absl::OkStatus(), metadata_source_->Connect());
@@ -61,9 +61,16 @@ class SqliteQueryConfigExecutorContainer : public QueryConfigExecutorContainer {
 }  // namespace
 
 INSTANTIATE_TEST_SUITE_P(
-    SqliteQueryConfigExecutorTest, QueryExecutorTest, ::testing::Values([]() {
-      return absl::make_unique<SqliteQueryConfigExecutorContainer>();
-    }));
+    SqliteQueryConfigExecutorTest, QueryExecutorTest,
+    ::testing::Values(
+        []() {
+          return absl::make_unique<SqliteQueryConfigExecutorContainer>();
+        },
+        []() {
+          SqliteMetadataSourceConfig config;
+          config.set_enable_prepared_statements(true);
+          return absl::make_unique<SqliteQueryConfigExecutorContainer>(config);
+        }));
 
 }  // namespace testing
 }  // namespace ml_metadata
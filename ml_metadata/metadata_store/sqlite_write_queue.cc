@@ -0,0 +1,60 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/sqlite_write_queue.h"
+
+#include <glog/logging.h>
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ml_metadata {
+
+std::shared_ptr<SqliteWriteQueue> SqliteWriteQueue::Get(
+    const absl::string_view filename_uri) {
+  static absl::Mutex mu(absl::kConstInit);
+  // The queues are held by the connections, and dropped with the last one.
+  static auto* const queues =
+      new absl::flat_hash_map<std::string, std::weak_ptr<SqliteWriteQueue>>();
+  absl::MutexLock lock(&mu);
+  std::weak_ptr<SqliteWriteQueue>& entry = (*queues)[filename_uri];
+  std::shared_ptr<SqliteWriteQueue> queue = entry.lock();
+  if (queue == nullptr) {
+    queue = std::make_shared<SqliteWriteQueue>();
+    entry = queue;
+  }
+  return queue;
+}
+
+void SqliteWriteQueue::Enqueue() {
+  absl::MutexLock lock(&mu_);
+  const int64 ticket = next_ticket_++;
+  while (ticket != serving_ticket_) {
+    turn_.Wait(&mu_);
+  }
+}
+
+void SqliteWriteQueue::Dequeue() {
+  absl::MutexLock lock(&mu_);
+  CHECK_LT(serving_ticket_, next_ticket_)
+      << "Dequeue is called without a write transaction in the queue.";
+  serving_ticket_++;
+  turn_.SignalAll();
+}
+
+int64 SqliteWriteQueue::size() const {
+  absl::MutexLock lock(&mu_);
+  return next_ticket_ - serving_ticket_;
+}
+
+}  // namespace ml_metadata
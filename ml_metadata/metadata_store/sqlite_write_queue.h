@@ -0,0 +1,77 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_SQLITE_WRITE_QUEUE_H_
+#define ML_METADATA_METADATA_STORE_SQLITE_WRITE_QUEUE_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "ml_metadata/metadata_store/types.h"
+
+namespace ml_metadata {
+
+// A first-in first-out queue of the write transactions of the connections of
+// a process to a sqlite3 database. The connections of the same database file
+// share a queue, and each write transaction waits for its turn before it
+// begins, so that at most one of them holds the write lock at a time, and the
+// others wait in the queue instead of in the busy handler of sqlite3. The
+// read transactions do not wait, and with the WAL journal mode they are not
+// blocked by the writer. It is thread-safe.
+//
+// Usage example:
+//
+//    std::shared_ptr<SqliteWriteQueue> queue =
+//        SqliteWriteQueue::Get("file:/tmp/mlmd.db");
+//    queue->Enqueue();
+//    // begins, runs and commits the write transaction.
+//    queue->Dequeue();
+class SqliteWriteQueue {
+ public:
+  // Returns the queue of the database `filename_uri`, which is shared by the
+  // callers in the process while any of them holds it.
+  static std::shared_ptr<SqliteWriteQueue> Get(absl::string_view filename_uri);
+
+  SqliteWriteQueue() = default;
+
+  // Not copyable or movable
+  SqliteWriteQueue(const SqliteWriteQueue&) = delete;
+  SqliteWriteQueue& operator=(const SqliteWriteQueue&) = delete;
+
+  // Waits until the write transactions enqueued before are dequeued, i.e.,
+  // until it is the turn of the caller to write.
+  void Enqueue();
+
+  // Ends the turn of the caller, which must have enqueued, and lets the next
+  // write transaction in the queue begin.
+  void Dequeue();
+
+  // Returns the number of write transactions in the queue, including the
+  // running one.
+  int64 size() const;
+
+ private:
+  mutable absl::Mutex mu_;
+  // The tickets are taken in the order of Enqueue, and served in that order.
+  int64 next_ticket_ ABSL_GUARDED_BY(mu_) = 0;
+  int64 serving_ticket_ ABSL_GUARDED_BY(mu_) = 0;
+  absl::CondVar turn_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_SQLITE_WRITE_QUEUE_H_
@@ -0,0 +1,39 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/template_query.h"
+
+#include "absl/strings/ascii.h"
+
+namespace ml_metadata {
+
+std::vector<TemplateQuerySegment> SplitTemplateQuery(
+    const absl::string_view query, const int parameter_num) {
+  std::vector<TemplateQuerySegment> segments;
+  int literal_begin = 0;
+  for (int pos = 0; pos + 1 < query.size(); pos++) {
+    if (query[pos] != '$' || !absl::ascii_isdigit(query[pos + 1]) ||
+        query[pos + 1] - '0' >= parameter_num) {
+      continue;
+    }
+    segments.push_back({query.substr(literal_begin, pos - literal_begin),
+                        query[pos + 1] - '0'});
+    literal_begin = pos + 2;
+    pos++;
+  }
+  segments.push_back({query.substr(literal_begin), -1});
+  return segments;
+}
+
+}  // namespace ml_metadata
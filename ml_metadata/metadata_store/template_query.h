@@ -0,0 +1,60 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_TEMPLATE_QUERY_H_
+#define ML_METADATA_METADATA_STORE_TEMPLATE_QUERY_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+
+namespace ml_metadata {
+
+// A literal part of a template query, followed by the index of a parameter, or
+// by -1 at the end of the query.
+struct TemplateQuerySegment {
+  absl::string_view literal;
+  int parameter = -1;
+};
+
+// Splits the template `query` at its `$i` parameters, where `i` is a single
+// digit less than `parameter_num`, so that the parameters are bound in a
+// single pass over the query. The segments refer to `query`.
+//
+// The split renders the query as replacing each `$i` in turn would: `$$` is
+// not an escape, and a `$i` with `i` not less than `parameter_num` is kept
+// as is.
+std::vector<TemplateQuerySegment> SplitTemplateQuery(absl::string_view query,
+                                                     int parameter_num);
+
+// Appends the query of `segments` to `out`, where `append_parameter(i, out)`
+// appends the `i`-th parameter.
+template <typename ParameterAppender>
+void AppendTemplateQuery(absl::Span<const TemplateQuerySegment> segments,
+                         const ParameterAppender& append_parameter,
+                         std::string* out) {
+  for (const TemplateQuerySegment& segment : segments) {
+    absl::StrAppend(out, segment.literal);
+    if (segment.parameter >= 0) {
+      append_parameter(segment.parameter, out);
+    }
+  }
+}
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_TEMPLATE_QUERY_H_
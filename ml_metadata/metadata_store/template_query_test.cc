@@ -0,0 +1,189 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/template_query.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "google/protobuf/descriptor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/substitute.h"
+#include "ml_metadata/proto/metadata_source.pb.h"
+#include "ml_metadata/util/metadata_source_query_config.h"
+
+namespace ml_metadata {
+namespace testing {
+namespace {
+
+// The rendered text of the `i`-th parameter, which never contains a `$`.
+std::string ParameterText(const int i) { return absl::StrCat("<p", i, ">"); }
+
+// Renders `query` from its split segments.
+std::string RenderSplit(const absl::string_view query,
+                        const int parameter_num) {
+  const std::vector<TemplateQuerySegment> segments =
+      SplitTemplateQuery(query, parameter_num);
+  std::string rendered;
+  AppendTemplateQuery(
+      segments,
+      [](const int i, std::string* out) {
+        absl::StrAppend(out, ParameterText(i));
+      },
+      &rendered);
+  return rendered;
+}
+
+// Renders `query` by replacing each `$i` with StrReplaceAll, as the executor
+// rendered the queries before they were split.
+std::string RenderReplaced(const absl::string_view query,
+                           const int parameter_num) {
+  std::vector<std::pair<const std::string, const std::string>> replacements;
+  for (int i = 0; i < parameter_num; i++) {
+    replacements.push_back({absl::StrCat("$", i), ParameterText(i)});
+  }
+  return absl::StrReplaceAll(query, replacements);
+}
+
+// Returns true if each `$` of `query` is followed by a digit, i.e., if
+// absl::Substitute renders it as replacing each `$i` does. The JSON paths of
+// the MySQL queries, e.g., `'$[*]'`, are not.
+bool IsSubstituteFormat(const absl::string_view query) {
+  for (int pos = 0; pos < query.size(); pos++) {
+    if (query[pos] == '$' &&
+        (pos + 1 == query.size() || !absl::ascii_isdigit(query[pos + 1]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Renders `query` with absl::Substitute.
+std::string RenderSubstituted(const absl::string_view query) {
+  return absl::Substitute(query, ParameterText(0), ParameterText(1),
+                          ParameterText(2), ParameterText(3), ParameterText(4),
+                          ParameterText(5), ParameterText(6), ParameterText(7),
+                          ParameterText(8), ParameterText(9));
+}
+
+// Returns the template queries set in `config`.
+std::vector<const MetadataSourceQueryConfig::TemplateQuery*> TemplateQueries(
+    const MetadataSourceQueryConfig& config) {
+  const google::protobuf::Descriptor* descriptor = config.GetDescriptor();
+  const google::protobuf::Reflection* reflection = config.GetReflection();
+  std::vector<const MetadataSourceQueryConfig::TemplateQuery*> queries;
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    const google::protobuf::FieldDescriptor* field = descriptor->field(i);
+    if (field->is_repeated() ||
+        field->message_type() !=
+            MetadataSourceQueryConfig::TemplateQuery::descriptor() ||
+        !reflection->HasField(config, field)) {
+      continue;
+    }
+    queries.push_back(
+        static_cast<const MetadataSourceQueryConfig::TemplateQuery*>(
+            &reflection->GetMessage(config, field)));
+  }
+  return queries;
+}
+
+TEST(TemplateQueryTest, RendersTheQueriesOfTheConfigs) {
+  for (const MetadataSourceQueryConfig& config :
+       {util::GetSqliteMetadataSourceQueryConfig(),
+        util::GetMySqlMetadataSourceQueryConfig(),
+        util::GetPostgreSQLMetadataSourceQueryConfig()}) {
+    const std::vector<const MetadataSourceQueryConfig::TemplateQuery*>
+        queries = TemplateQueries(config);
+    ASSERT_FALSE(queries.empty());
+    for (const MetadataSourceQueryConfig::TemplateQuery* query : queries) {
+      SCOPED_TRACE(query->query());
+      const std::string rendered =
+          RenderSplit(query->query(), query->parameter_num());
+      EXPECT_EQ(rendered,
+                RenderReplaced(query->query(), query->parameter_num()));
+      if (IsSubstituteFormat(query->query())) {
+        EXPECT_EQ(rendered, RenderSubstituted(query->query()));
+      }
+    }
+  }
+}
+
+TEST(TemplateQueryTest, RendersRepeatedParameters) {
+  const absl::string_view query =
+      "SELECT `id` FROM `Artifact` WHERE `type_id` = $0 AND `name` = $1 "
+      "UNION SELECT `id` FROM `Execution` WHERE `type_id` = $0 AND "
+      "`name` = $1;";
+  const std::string rendered = RenderSplit(query, /*parameter_num=*/2);
+  EXPECT_EQ(rendered,
+            "SELECT `id` FROM `Artifact` WHERE `type_id` = <p0> AND `name` = "
+            "<p1> UNION SELECT `id` FROM `Execution` WHERE `type_id` = <p0> "
+            "AND `name` = <p1>;");
+  EXPECT_EQ(rendered, RenderReplaced(query, /*parameter_num=*/2));
+  EXPECT_EQ(rendered, RenderSubstituted(query));
+}
+
+TEST(TemplateQueryTest, RendersParametersAtTheStartAndTheEnd) {
+  for (const absl::string_view query :
+       {"$0", "$0$1", "$0 AND $1", "$1 = $0", " $0 ", "$0$0"}) {
+    SCOPED_TRACE(query);
+    const std::string rendered = RenderSplit(query, /*parameter_num=*/2);
+    EXPECT_EQ(rendered, RenderReplaced(query, /*parameter_num=*/2));
+    EXPECT_EQ(rendered, RenderSubstituted(query));
+  }
+  EXPECT_EQ(RenderSplit("$0$1", /*parameter_num=*/2), "<p0><p1>");
+}
+
+TEST(TemplateQueryTest, RendersQueriesWithoutParameters) {
+  for (const absl::string_view query :
+       {"", ";", "SELECT 1;", "SELECT `id` FROM `Artifact`;"}) {
+    SCOPED_TRACE(query);
+    EXPECT_EQ(RenderSplit(query, /*parameter_num=*/0), query);
+    EXPECT_EQ(RenderReplaced(query, /*parameter_num=*/0), query);
+    EXPECT_EQ(RenderSubstituted(query), query);
+    EXPECT_EQ(SplitTemplateQuery(query, /*parameter_num=*/0).size(), 1);
+  }
+}
+
+// `$$` is not an escape of the template queries, unlike in absl::Substitute:
+// as with the StrReplaceAll they were rendered with, both dollars are kept, and
+// a parameter may follow them.
+TEST(TemplateQueryTest, KeepsDoubleDollars) {
+  for (const absl::string_view query :
+       {"$$", "SELECT '$$';", "$$0", "$$$0", "$0$$", "$$ = $1 AND $0 = $$1"}) {
+    SCOPED_TRACE(query);
+    EXPECT_FALSE(IsSubstituteFormat(query));
+    EXPECT_EQ(RenderSplit(query, /*parameter_num=*/2),
+              RenderReplaced(query, /*parameter_num=*/2));
+  }
+  EXPECT_EQ(RenderSplit("SELECT '$$';", /*parameter_num=*/2), "SELECT '$$';");
+  EXPECT_EQ(RenderSplit("$$0", /*parameter_num=*/2), "$<p0>");
+  EXPECT_EQ(RenderSubstituted("SELECT '$$';"), "SELECT '$';");
+}
+
+TEST(TemplateQueryTest, KeepsParametersOutOfRange) {
+  const absl::string_view query = "$0 $1 $2 $";
+  const std::string rendered = RenderSplit(query, /*parameter_num=*/2);
+  EXPECT_EQ(rendered, "<p0> <p1> $2 $");
+  EXPECT_EQ(rendered, RenderReplaced(query, /*parameter_num=*/2));
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace ml_metadata
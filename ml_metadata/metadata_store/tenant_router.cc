@@ -0,0 +1,36 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/tenant_router.h"
+
+#include <algorithm>
+
+namespace ml_metadata {
+
+MetadataStoreServerConfig::ConnectionPoolConfig TenantPoolConfig(
+    const MetadataStoreServerConfig::ConnectionPoolConfig& pool_config,
+    const int max_connections, const int num_tenants) {
+  MetadataStoreServerConfig::ConnectionPoolConfig tenant_pool_config =
+      pool_config;
+  if (max_connections <= 0) {
+    return tenant_pool_config;
+  }
+  const int share = std::max(1, max_connections / num_tenants);
+  tenant_pool_config.set_max_size(std::min(pool_config.max_size(), share));
+  tenant_pool_config.set_min_size(
+      std::min(pool_config.min_size(), tenant_pool_config.max_size()));
+  return tenant_pool_config;
+}
+
+}  // namespace ml_metadata
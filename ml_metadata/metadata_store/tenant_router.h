@@ -0,0 +1,80 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_TENANT_ROUTER_H_
+#define ML_METADATA_METADATA_STORE_TENANT_ROUTER_H_
+
+#include <string>
+
+#include <glog/logging.h>
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// Routes the calls of a multi-tenant server to their tenants, by the name in
+// their tenant metadata. The default tenant, whose name is empty, serves the
+// calls without tenant metadata. It is thread-compatible, and is read-only
+// once the tenants are added.
+//
+// Usage example:
+//
+//    TenantRouter<Tenant> router;
+//    router.Add("", &default_tenant);
+//    router.Add("team-a", &team_a_tenant);
+//    Tenant* tenant = router.Find(tenant_metadata);
+//    if (tenant == nullptr) {
+//      // the call names an unknown tenant.
+//    }
+template <typename Tenant>
+class TenantRouter {
+ public:
+  // Adds the tenant `name`, which must not be added yet. The default tenant
+  // must be added first.
+  void Add(const std::string& name, Tenant* tenant) {
+    CHECK(!tenants_by_name_.empty() || name.empty())
+        << "The default tenant must be added first.";
+    CHECK(tenants_by_name_.emplace(name, tenant).second)
+        << "The tenant " << name << " is added more than once.";
+  }
+
+  // Returns true if the tenant `name` is added.
+  bool Contains(const absl::string_view name) const {
+    return tenants_by_name_.contains(name);
+  }
+
+  // Returns the tenant named by the `tenant_metadata` of a call, or the
+  // default tenant if the call has none. Returns nullptr if the named tenant
+  // is unknown.
+  Tenant* Find(const absl::optional<absl::string_view> tenant_metadata) const {
+    const auto it = tenants_by_name_.find(tenant_metadata.value_or(""));
+    return it == tenants_by_name_.end() ? nullptr : it->second;
+  }
+
+ private:
+  absl::flat_hash_map<std::string, Tenant*> tenants_by_name_;
+};
+
+// Returns the connection pool config of each of `num_tenants` tenants, whose
+// sizes are capped at their even share of `max_connections`, rounded down and
+// at least 1, if `max_connections` is positive.
+MetadataStoreServerConfig::ConnectionPoolConfig TenantPoolConfig(
+    const MetadataStoreServerConfig::ConnectionPoolConfig& pool_config,
+    int max_connections, int num_tenants);
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_TENANT_ROUTER_H_
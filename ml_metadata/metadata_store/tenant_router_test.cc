@@ -0,0 +1,126 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/tenant_router.h"
+
+#include <string>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace testing {
+namespace {
+
+using ConnectionPoolConfig = MetadataStoreServerConfig::ConnectionPoolConfig;
+
+struct FakeTenant {
+  std::string name;
+};
+
+class TenantRouterTest : public ::testing::Test {
+ protected:
+  TenantRouterTest() {
+    router_.Add("", &default_tenant_);
+    router_.Add("team-a", &team_a_);
+    router_.Add("team-b", &team_b_);
+  }
+
+  FakeTenant default_tenant_{""};
+  FakeTenant team_a_{"team-a"};
+  FakeTenant team_b_{"team-b"};
+  TenantRouter<FakeTenant> router_;
+};
+
+TEST_F(TenantRouterTest, RoutesTheCallsWithoutTenantToTheDefaultTenant) {
+  EXPECT_EQ(router_.Find(absl::nullopt), &default_tenant_);
+}
+
+TEST_F(TenantRouterTest, RoutesTheCallsToTheNamedTenant) {
+  EXPECT_EQ(router_.Find("team-a"), &team_a_);
+  EXPECT_EQ(router_.Find("team-b"), &team_b_);
+  // The default tenant is named by the empty name.
+  EXPECT_EQ(router_.Find(""), &default_tenant_);
+}
+
+TEST_F(TenantRouterTest, RejectsTheCallsOfUnknownTenants) {
+  EXPECT_EQ(router_.Find("team-c"), nullptr);
+  // The names are case-sensitive and not trimmed.
+  EXPECT_EQ(router_.Find("Team-A"), nullptr);
+  EXPECT_EQ(router_.Find("team-a "), nullptr);
+}
+
+TEST_F(TenantRouterTest, Contains) {
+  EXPECT_TRUE(router_.Contains(""));
+  EXPECT_TRUE(router_.Contains("team-a"));
+  EXPECT_FALSE(router_.Contains("team-c"));
+}
+
+TEST(TenantPoolConfigTest, KeepsThePoolConfigWithoutMaxConnections) {
+  const ConnectionPoolConfig pool_config =
+      ParseTextProtoOrDie<ConnectionPoolConfig>("max_size: 16 min_size: 4");
+  for (const int max_connections : {0, -1}) {
+    EXPECT_THAT(TenantPoolConfig(pool_config, max_connections,
+                                 /*num_tenants=*/3),
+                EqualsProto(pool_config));
+  }
+}
+
+TEST(TenantPoolConfigTest, SplitsTheMaxConnectionsEvenly) {
+  const ConnectionPoolConfig pool_config =
+      ParseTextProtoOrDie<ConnectionPoolConfig>("max_size: 16 min_size: 4");
+  EXPECT_THAT(
+      TenantPoolConfig(pool_config, /*max_connections=*/12, /*num_tenants=*/4),
+      EqualsProto(ParseTextProtoOrDie<ConnectionPoolConfig>(
+          "max_size: 3 min_size: 3")));
+  EXPECT_THAT(
+      TenantPoolConfig(pool_config, /*max_connections=*/24, /*num_tenants=*/3),
+      EqualsProto(ParseTextProtoOrDie<ConnectionPoolConfig>(
+          "max_size: 8 min_size: 4")));
+}
+
+TEST(TenantPoolConfigTest, RoundsTheShareDown) {
+  const ConnectionPoolConfig pool_config =
+      ParseTextProtoOrDie<ConnectionPoolConfig>("max_size: 16 min_size: 4");
+  // 10 connections for 3 tenants is 3 each, so that 9 are used at most.
+  EXPECT_THAT(
+      TenantPoolConfig(pool_config, /*max_connections=*/10, /*num_tenants=*/3),
+      EqualsProto(ParseTextProtoOrDie<ConnectionPoolConfig>(
+          "max_size: 3 min_size: 3")));
+}
+
+TEST(TenantPoolConfigTest, GivesEachTenantAtLeastOneConnection) {
+  const ConnectionPoolConfig pool_config =
+      ParseTextProtoOrDie<ConnectionPoolConfig>("max_size: 16 min_size: 4");
+  EXPECT_THAT(
+      TenantPoolConfig(pool_config, /*max_connections=*/2, /*num_tenants=*/5),
+      EqualsProto(ParseTextProtoOrDie<ConnectionPoolConfig>(
+          "max_size: 1 min_size: 1")));
+}
+
+TEST(TenantPoolConfigTest, KeepsThePoolSizesBelowTheShare) {
+  const ConnectionPoolConfig pool_config =
+      ParseTextProtoOrDie<ConnectionPoolConfig>("max_size: 4 min_size: 2");
+  EXPECT_THAT(
+      TenantPoolConfig(pool_config, /*max_connections=*/100,
+                       /*num_tenants=*/2),
+      EqualsProto(pool_config));
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace ml_metadata
@@ -0,0 +1,266 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/trace_span.h"
+
+#include <atomic>
+#include <cstdint>
+
+#include "google/protobuf/struct.pb.h"
+#include "google/protobuf/util/json_util.h"
+#include <glog/logging.h>
+#include "absl/random/random.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+
+namespace ml_metadata {
+namespace {
+
+std::atomic<TraceSpanExporter*> default_exporter{nullptr};
+
+// The span in scope on the thread, which parents the spans started on it.
+thread_local ScopedTraceSpan* current_span = nullptr;
+
+// Returns a random id of `num_bytes` bytes as lowercase hex digits, which is
+// not all zeros.
+std::string RandomId(const int num_bytes) {
+  thread_local absl::BitGen bitgen;
+  std::string id;
+  for (int i = 0; i < num_bytes; i += 8) {
+    uint64_t bits = 0;
+    while (bits == 0) bits = absl::Uniform<uint64_t>(bitgen);
+    absl::StrAppend(&id, absl::StrFormat("%016x", bits));
+  }
+  return id;
+}
+
+// Returns true if `id` is `size` lowercase hex digits, not all zeros.
+bool IsValidId(const absl::string_view id, const int size) {
+  if (id.size() != size) return false;
+  bool all_zeros = true;
+  for (const char c : id) {
+    if (!absl::ascii_isxdigit(c) || absl::ascii_isupper(c)) return false;
+    all_zeros &= c == '0';
+  }
+  return !all_zeros;
+}
+
+}  // namespace
+
+absl::optional<TraceContext> ParseTraceparent(
+    const absl::string_view traceparent) {
+  const std::vector<absl::string_view> fields =
+      absl::StrSplit(traceparent, '-');
+  if (fields.size() != 4 || fields[0] != "00" ||
+      !IsValidId(fields[1], 32) || !IsValidId(fields[2], 16) ||
+      fields[3].size() != 2 || !absl::ascii_isxdigit(fields[3][0]) ||
+      !absl::ascii_isxdigit(fields[3][1])) {
+    return absl::nullopt;
+  }
+  TraceContext context;
+  context.trace_id = std::string(fields[1]);
+  context.span_id = std::string(fields[2]);
+  // The sampled flag is the lowest bit of the trace flags.
+  const char flags = absl::ascii_tolower(fields[3][1]);
+  context.sampled = (flags >= 'a' ? flags - 'a' + 10 : flags - '0') & 1;
+  return context;
+}
+
+std::string FormatTraceparent(const TraceContext& context) {
+  return absl::StrCat("00-", context.trace_id, "-", context.span_id,
+                      context.sampled ? "-01" : "-00");
+}
+
+TraceSpanExporter* GetDefaultTraceSpanExporter() {
+  return default_exporter.load(std::memory_order_acquire);
+}
+
+void SetDefaultTraceSpanExporter(TraceSpanExporter* exporter) {
+  default_exporter.store(exporter, std::memory_order_release);
+}
+
+bool IsTracing() {
+  return current_span != nullptr && current_span->recording();
+}
+
+ScopedTraceSpan::ScopedTraceSpan(const absl::string_view name) {
+  if (current_span != nullptr && current_span->recording()) {
+    Start(current_span->exporter_, name, current_span->data_.trace_id,
+          current_span->data_.span_id, absl::Now());
+  }
+}
+
+ScopedTraceSpan::ScopedTraceSpan(const absl::string_view name,
+                                 const absl::Time start_time) {
+  if (current_span != nullptr && current_span->recording()) {
+    Start(current_span->exporter_, name, current_span->data_.trace_id,
+          current_span->data_.span_id, start_time);
+  }
+}
+
+ScopedTraceSpan::ScopedTraceSpan(
+    const absl::string_view name,
+    const absl::optional<TraceContext>& remote_parent) {
+  TraceSpanExporter* exporter = GetDefaultTraceSpanExporter();
+  if (exporter == nullptr) {
+    return;
+  }
+  if (remote_parent) {
+    if (remote_parent->sampled) {
+      Start(exporter, name, remote_parent->trace_id, remote_parent->span_id,
+            absl::Now());
+    }
+    return;
+  }
+  thread_local absl::BitGen bitgen;
+  if (absl::Bernoulli(bitgen, exporter->sample_rate())) {
+    Start(exporter, name, RandomId(16), /*parent_span_id=*/"", absl::Now());
+  }
+}
+
+void ScopedTraceSpan::Start(TraceSpanExporter* exporter,
+                            const absl::string_view name,
+                            std::string trace_id, std::string parent_span_id,
+                            const absl::Time start_time) {
+  exporter_ = exporter;
+  data_.name = std::string(name);
+  data_.trace_id = std::move(trace_id);
+  data_.span_id = RandomId(8);
+  data_.parent_span_id = std::move(parent_span_id);
+  data_.start_time = start_time;
+  previous_ = current_span;
+  current_span = this;
+}
+
+ScopedTraceSpan::~ScopedTraceSpan() {
+  if (!recording()) {
+    return;
+  }
+  // The spans end in the reverse order of their start on a thread.
+  DCHECK_EQ(current_span, this);
+  current_span = previous_;
+  data_.end_time = absl::Now();
+  exporter_->Export(data_);
+}
+
+void ScopedTraceSpan::AddAttribute(const absl::string_view key,
+                                   const absl::string_view value) {
+  if (recording()) {
+    data_.attributes.emplace_back(std::string(key), std::string(value));
+  }
+}
+
+void ScopedTraceSpan::AddAttribute(const absl::string_view key,
+                                   const int64 value) {
+  if (recording()) {
+    data_.attributes.emplace_back(std::string(key), absl::StrCat(value));
+  }
+}
+
+void ScopedTraceSpan::SetStatus(const absl::Status& status) {
+  if (recording()) {
+    data_.status = status;
+  }
+}
+
+absl::optional<TraceContext> ScopedTraceSpan::context() const {
+  if (!recording()) {
+    return absl::nullopt;
+  }
+  TraceContext context;
+  context.trace_id = data_.trace_id;
+  context.span_id = data_.span_id;
+  context.sampled = true;
+  return context;
+}
+
+absl::Status TraceSpanFileExporter::Create(
+    const MetadataStoreServerConfig::TracingConfig& config,
+    std::unique_ptr<TraceSpanFileExporter>* exporter) {
+  if (config.filename().empty()) {
+    return absl::InvalidArgumentError(
+        "The filename of the tracing is not given");
+  }
+  if (config.sample_rate() < 0 || config.sample_rate() > 1) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("The sample_rate of the tracing must be in [0, 1], got ",
+                     config.sample_rate()));
+  }
+  std::ofstream output(config.filename(), std::ios::out | std::ios::app);
+  if (!output) {
+    return absl::InternalError(
+        absl::StrCat("Cannot write the trace file ", config.filename()));
+  }
+  exporter->reset(
+      new TraceSpanFileExporter(config.sample_rate(), std::move(output)));
+  return absl::OkStatus();
+}
+
+TraceSpanFileExporter::TraceSpanFileExporter(const double sample_rate,
+                                             std::ofstream output)
+    : sample_rate_(sample_rate), output_(std::move(output)) {}
+
+void TraceSpanFileExporter::Export(const TraceSpanData& span) {
+  const std::string line = ToJson(span);
+  absl::MutexLock lock(&mu_);
+  output_ << line << '\n';
+  output_.flush();
+  if (!output_) {
+    LOG_EVERY_N(WARNING, 1000) << "Failed to write a span.";
+  }
+}
+
+std::string TraceSpanFileExporter::ToJson(const TraceSpanData& span) {
+  google::protobuf::Struct json;
+  auto& fields = *json.mutable_fields();
+  fields["traceId"].set_string_value(span.trace_id);
+  fields["spanId"].set_string_value(span.span_id);
+  if (!span.parent_span_id.empty()) {
+    fields["parentSpanId"].set_string_value(span.parent_span_id);
+  }
+  fields["name"].set_string_value(span.name);
+  // The 64-bit integers are strings in the OTLP JSON encoding.
+  fields["startTimeUnixNano"].set_string_value(
+      absl::StrCat(absl::ToUnixNanos(span.start_time)));
+  fields["endTimeUnixNano"].set_string_value(
+      absl::StrCat(absl::ToUnixNanos(span.end_time)));
+  google::protobuf::ListValue* attributes =
+      fields["attributes"].mutable_list_value();
+  for (const auto& attribute : span.attributes) {
+    auto& attribute_fields =
+        *attributes->add_values()->mutable_struct_value()->mutable_fields();
+    attribute_fields["key"].set_string_value(attribute.first);
+    (*attribute_fields["value"].mutable_struct_value()->mutable_fields())
+        ["stringValue"]
+            .set_string_value(attribute.second);
+  }
+  // The status code is STATUS_CODE_UNSET for the successful operations, and
+  // STATUS_CODE_ERROR for the failed ones.
+  auto& status_fields =
+      *fields["status"].mutable_struct_value()->mutable_fields();
+  if (!span.status.ok()) {
+    status_fields["code"].set_number_value(2);
+    status_fields["message"].set_string_value(
+        absl::StrCat(absl::StatusCodeToString(span.status.code()), ": ",
+                     span.status.message()));
+  }
+  std::string output;
+  CHECK(google::protobuf::util::MessageToJsonString(json, &output).ok());
+  return output;
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,200 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_TRACE_SPAN_H_
+#define ML_METADATA_METADATA_STORE_TRACE_SPAN_H_
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// The key of the gRPC metadata carrying the W3C trace context of a call.
+constexpr char kTraceparentMetadataKey[] = "traceparent";
+
+// The W3C trace context of a span, i.e., the ids of its trace and itself, and
+// whether the trace is sampled.
+struct TraceContext {
+  // 32 lowercase hex digits, not all zeros.
+  std::string trace_id;
+  // 16 lowercase hex digits, not all zeros.
+  std::string span_id;
+  bool sampled = false;
+};
+
+// Parses a W3C `traceparent` header of version 00, e.g.,
+// "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01". Returns nullopt
+// if it is malformed.
+absl::optional<TraceContext> ParseTraceparent(absl::string_view traceparent);
+
+// Formats `context` as a W3C `traceparent` header of version 00.
+std::string FormatTraceparent(const TraceContext& context);
+
+// A finished span, named after the operation it times, e.g.,
+// "MetadataSource::ExecuteQuery".
+struct TraceSpanData {
+  std::string name;
+  std::string trace_id;
+  std::string span_id;
+  // Empty for the root span of a trace.
+  std::string parent_span_id;
+  absl::Time start_time;
+  absl::Time end_time;
+  absl::Status status;
+  std::vector<std::pair<std::string, std::string>> attributes;
+};
+
+// Receives the spans once they end. The spans are exported from every thread
+// serving calls, so implementations must be thread-safe and cheap.
+class TraceSpanExporter {
+ public:
+  virtual ~TraceSpanExporter() = default;
+
+  // Called when a recorded span ends.
+  virtual void Export(const TraceSpanData& span) = 0;
+
+  // Returns the fraction in [0, 1] of the traces started without a remote
+  // parent that are recorded.
+  virtual double sample_rate() const { return 1; }
+};
+
+// Returns the exporter of the spans, or nullptr if tracing is disabled.
+TraceSpanExporter* GetDefaultTraceSpanExporter();
+
+// Sets the exporter of the spans started afterwards. The `exporter` is not
+// owned, and must outlast the spans; nullptr disables tracing.
+void SetDefaultTraceSpanExporter(TraceSpanExporter* exporter);
+
+// A span timing an operation while in scope, which is exported once out of
+// scope if its trace is recorded. A span started on a thread becomes the
+// current span of the thread while in scope, so the spans of the lower layers
+// nest under it without being passed around, e.g., a service call, the
+// transactions of its store and the queries of its metadata source. The work
+// handed to other threads, e.g., by a ParallelReader, is not traced. Starting
+// a span is a no-op unless its trace is recorded.
+//
+// Usage example:
+//
+//    // The root span of a call, continuing the trace of the caller if given.
+//    ScopedTraceSpan call_span("PutExecution", ParseTraceparent(header));
+//    ...
+//    // A child span of the current span of the thread.
+//    ScopedTraceSpan span("RdbmsTransactionExecutor::Execute");
+//    span.AddAttribute("mlmd.read_only", "false");
+//    span.SetStatus(status);
+class ScopedTraceSpan {
+ public:
+  // Starts a span of `name` as a child of the current span of the thread.
+  explicit ScopedTraceSpan(absl::string_view name);
+
+  // Same as above, but the span started at `start_time`, e.g., of a query
+  // timed by its caller, which ends the span right after.
+  ScopedTraceSpan(absl::string_view name, absl::Time start_time);
+
+  // Starts the root span of `name` of a call, as a child of the span of the
+  // caller if its `remote_parent` is given, which decides whether the trace is
+  // recorded. Otherwise a new trace is started, which is recorded at the
+  // sample rate of the exporter.
+  ScopedTraceSpan(absl::string_view name,
+                  const absl::optional<TraceContext>& remote_parent);
+
+  // Disallows copy and move, as the span is referenced by the thread.
+  ScopedTraceSpan(const ScopedTraceSpan&) = delete;
+  ScopedTraceSpan& operator=(const ScopedTraceSpan&) = delete;
+
+  // Ends the span and exports it, if it is recorded.
+  ~ScopedTraceSpan();
+
+  // Returns true if the span is recorded and exported.
+  bool recording() const { return exporter_ != nullptr; }
+
+  // Adds an attribute to the span, if it is recorded.
+  void AddAttribute(absl::string_view key, absl::string_view value);
+  void AddAttribute(absl::string_view key, int64 value);
+
+  // Sets the status of the operation of the span, if it is recorded.
+  void SetStatus(const absl::Status& status);
+
+  // Returns the trace context of the span, e.g., to pass it to another
+  // process, or nullopt if it is not recorded.
+  absl::optional<TraceContext> context() const;
+
+ private:
+  // Starts recording the span as the current span of the thread, in the trace
+  // `trace_id`, as a child of `parent_span_id`.
+  void Start(TraceSpanExporter* exporter, absl::string_view name,
+             std::string trace_id, std::string parent_span_id,
+             absl::Time start_time);
+
+  // The exporter of the span, or nullptr if it is not recorded.
+  TraceSpanExporter* exporter_ = nullptr;
+  // The current span of the thread before this one.
+  ScopedTraceSpan* previous_ = nullptr;
+  TraceSpanData data_;
+};
+
+// Returns true if the current span of the thread is recorded, i.e., the spans
+// started on the thread are recorded.
+bool IsTracing();
+
+// A TraceSpanExporter writing the spans to a file, one JSON object per line,
+// with the field names of the Span of the OpenTelemetry protocol (OTLP) JSON
+// encoding, e.g., traceId, parentSpanId and startTimeUnixNano, so that the
+// file can be shipped to an OpenTelemetry collector. Each span is flushed as
+// it is written. It is thread-safe.
+class TraceSpanFileExporter : public TraceSpanExporter {
+ public:
+  // Creates an exporter writing to the `filename` of `config`, which is
+  // appended to.
+  // Returns INVALID_ARGUMENT error, if the filename is empty or the
+  // sample_rate is not in [0, 1].
+  // Returns INTERNAL error, if the file cannot be written.
+  static absl::Status Create(
+      const MetadataStoreServerConfig::TracingConfig& config,
+      std::unique_ptr<TraceSpanFileExporter>* exporter);
+
+  // Disallows copy.
+  TraceSpanFileExporter(const TraceSpanFileExporter&) = delete;
+  TraceSpanFileExporter& operator=(const TraceSpanFileExporter&) = delete;
+
+  void Export(const TraceSpanData& span) override;
+
+  double sample_rate() const override { return sample_rate_; }
+
+  // Returns the span as a line of the file, without the newline.
+  static std::string ToJson(const TraceSpanData& span);
+
+ private:
+  TraceSpanFileExporter(double sample_rate, std::ofstream output);
+
+  const double sample_rate_;
+  absl::Mutex mu_;
+  std::ofstream output_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_TRACE_SPAN_H_
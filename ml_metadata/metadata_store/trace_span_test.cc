@@ -0,0 +1,178 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/trace_span.h"
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Pair;
+
+constexpr char kTraceId[] = "4bf92f3577b34da6a3ce929d0e0e4736";
+constexpr char kSpanId[] = "00f067aa0ba902b7";
+
+// Keeps the exported spans in memory.
+class InMemoryExporter : public TraceSpanExporter {
+ public:
+  explicit InMemoryExporter(double sample_rate = 1)
+      : sample_rate_(sample_rate) {}
+
+  void Export(const TraceSpanData& span) override {
+    absl::MutexLock lock(&mu_);
+    spans_.push_back(span);
+  }
+
+  double sample_rate() const override { return sample_rate_; }
+
+  std::vector<TraceSpanData> spans() {
+    absl::MutexLock lock(&mu_);
+    return spans_;
+  }
+
+ private:
+  const double sample_rate_;
+  absl::Mutex mu_;
+  std::vector<TraceSpanData> spans_;
+};
+
+TEST(TraceSpanTest, ParsesAndFormatsTraceparent) {
+  const std::string traceparent =
+      absl::StrCat("00-", kTraceId, "-", kSpanId, "-01");
+  const absl::optional<TraceContext> context = ParseTraceparent(traceparent);
+  ASSERT_TRUE(context);
+  EXPECT_EQ(context->trace_id, kTraceId);
+  EXPECT_EQ(context->span_id, kSpanId);
+  EXPECT_TRUE(context->sampled);
+  EXPECT_EQ(FormatTraceparent(*context), traceparent);
+  EXPECT_FALSE(
+      ParseTraceparent(absl::StrCat("00-", kTraceId, "-", kSpanId, "-00"))
+          ->sampled);
+
+  for (const std::string& malformed :
+       {std::string(""), absl::StrCat("01-", kTraceId, "-", kSpanId, "-01"),
+        absl::StrCat("00-", std::string(32, '0'), "-", kSpanId, "-01"),
+        absl::StrCat("00-", kTraceId, "-", "00F067AA0BA902B7", "-01"),
+        absl::StrCat("00-", kTraceId, "-", kSpanId, "-0x")}) {
+    EXPECT_FALSE(ParseTraceparent(malformed)) << malformed;
+  }
+}
+
+TEST(TraceSpanTest, NestsTheSpansOfAThread) {
+  InMemoryExporter exporter;
+  SetDefaultTraceSpanExporter(&exporter);
+  {
+    ScopedTraceSpan call_span("PutExecution", /*remote_parent=*/absl::nullopt);
+    ASSERT_TRUE(call_span.recording());
+    {
+      ScopedTraceSpan span("RdbmsTransactionExecutor::Execute");
+      const absl::Time query_start = absl::Now();
+      ScopedTraceSpan query_span("MetadataSource::ExecuteQuery", query_start);
+      query_span.AddAttribute("mlmd.query_name", "insert_execution");
+      query_span.AddAttribute("mlmd.num_rows", 1);
+      query_span.SetStatus(absl::AbortedError("deadlock"));
+    }
+    ScopedTraceSpan second_span("RdbmsTransactionExecutor::Execute");
+  }
+  SetDefaultTraceSpanExporter(nullptr);
+
+  const std::vector<TraceSpanData> spans = exporter.spans();
+  ASSERT_EQ(spans.size(), 4);
+  const TraceSpanData& query_span = spans[0];
+  const TraceSpanData& transaction_span = spans[1];
+  const TraceSpanData& second_span = spans[2];
+  const TraceSpanData& call_span = spans[3];
+  EXPECT_EQ(call_span.name, "PutExecution");
+  EXPECT_EQ(call_span.parent_span_id, "");
+  for (const TraceSpanData* span :
+       {&query_span, &transaction_span, &second_span}) {
+    EXPECT_EQ(span->trace_id, call_span.trace_id);
+    EXPECT_LE(call_span.start_time, span->start_time);
+    EXPECT_LE(span->end_time, call_span.end_time);
+  }
+  EXPECT_EQ(transaction_span.parent_span_id, call_span.span_id);
+  EXPECT_EQ(second_span.parent_span_id, call_span.span_id);
+  EXPECT_EQ(query_span.parent_span_id, transaction_span.span_id);
+  EXPECT_THAT(query_span.attributes,
+              ElementsAre(Pair("mlmd.query_name", "insert_execution"),
+                          Pair("mlmd.num_rows", "1")));
+  EXPECT_TRUE(absl::IsAborted(query_span.status));
+}
+
+TEST(TraceSpanTest, FollowsTheSamplingOfTheCaller) {
+  InMemoryExporter exporter(/*sample_rate=*/0);
+  SetDefaultTraceSpanExporter(&exporter);
+  {
+    ScopedTraceSpan unsampled_call("GetArtifacts", absl::nullopt);
+    ScopedTraceSpan span("MetadataStorePool::Acquire");
+    EXPECT_FALSE(unsampled_call.recording());
+    EXPECT_FALSE(span.recording());
+  }
+  {
+    TraceContext parent = {kTraceId, kSpanId, /*sampled=*/false};
+    ScopedTraceSpan unsampled_call("GetArtifacts", parent);
+    EXPECT_FALSE(unsampled_call.recording());
+    parent.sampled = true;
+    ScopedTraceSpan sampled_call("GetArtifacts", parent);
+    EXPECT_TRUE(sampled_call.recording());
+    EXPECT_EQ(sampled_call.context()->trace_id, kTraceId);
+  }
+  SetDefaultTraceSpanExporter(nullptr);
+
+  const std::vector<TraceSpanData> spans = exporter.spans();
+  ASSERT_EQ(spans.size(), 1);
+  EXPECT_EQ(spans[0].trace_id, kTraceId);
+  EXPECT_EQ(spans[0].parent_span_id, kSpanId);
+
+  // No span is recorded without an exporter.
+  ScopedTraceSpan call_span("GetArtifacts",
+                            TraceContext{kTraceId, kSpanId, true});
+  EXPECT_FALSE(call_span.recording());
+}
+
+TEST(TraceSpanTest, WritesOtlpJson) {
+  TraceSpanData span;
+  span.name = "MetadataSource::ExecuteQuery";
+  span.trace_id = kTraceId;
+  span.span_id = kSpanId;
+  span.parent_span_id = "b7ad6b7169203331";
+  span.start_time = absl::FromUnixNanos(1000);
+  span.end_time = absl::FromUnixNanos(3000);
+  span.status = absl::InternalError("\"quoted\"");
+  span.attributes.emplace_back("mlmd.query_name", "select_artifact_by_id");
+  const std::string json = TraceSpanFileExporter::ToJson(span);
+  EXPECT_THAT(json, HasSubstr(absl::StrCat("\"traceId\":\"", kTraceId)));
+  EXPECT_THAT(json, HasSubstr("\"parentSpanId\":\"b7ad6b7169203331\""));
+  EXPECT_THAT(json, HasSubstr("\"startTimeUnixNano\":\"1000\""));
+  EXPECT_THAT(json, HasSubstr("\"endTimeUnixNano\":\"3000\""));
+  EXPECT_THAT(json, HasSubstr("{\"key\":\"mlmd.query_name\",\"value\":{"
+                              "\"stringValue\":\"select_artifact_by_id\"}}"));
+  EXPECT_THAT(json, HasSubstr("\"code\":2"));
+  EXPECT_THAT(json, HasSubstr("INTERNAL: \\\"quoted\\\""));
+}
+
+}  // namespace
+}  // namespace ml_metadata
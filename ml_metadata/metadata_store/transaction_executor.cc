@@ -15,23 +15,86 @@ limitations under the License.
 
 #include "ml_metadata/metadata_store/transaction_executor.h"
 
+#include <algorithm>
+
+#include <glog/logging.h>
+#include "absl/random/random.h"
 #include "absl/status/status.h"
-#include "ml_metadata/util/return_utils.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "ml_metadata/metadata_store/cancellation_token.h"
+#include "ml_metadata/metadata_store/trace_span.h"
 
 namespace ml_metadata {
 
 absl::Status RdbmsTransactionExecutor::Execute(
     const std::function<absl::Status()>& txn_body,
     const TransactionOptions& transaction_options) const {
+  return ExecuteWithRetries(txn_body, /*read_only=*/false);
+}
+
+absl::Status RdbmsTransactionExecutor::ExecuteReadOnly(
+    const std::function<absl::Status()>& txn_body,
+    const TransactionOptions& transaction_options) const {
+  return ExecuteWithRetries(txn_body, /*read_only=*/true);
+}
+
+absl::Status RdbmsTransactionExecutor::ExecuteWithRetries(
+    const std::function<absl::Status()>& txn_body, const bool read_only) const {
   if (metadata_source_ == nullptr || !metadata_source_->is_connected()) {
     return absl::FailedPreconditionError(
         "To use ExecuteTransaction, the metadata_source should be created and "
         "connected");
   }
 
-  MLMD_RETURN_IF_ERROR(metadata_source_->Begin());
+  absl::Status transaction_status = ExecuteOnce(txn_body, read_only);
+  if (!absl::IsAborted(transaction_status) ||
+      retry_options_.max_num_retries() <= 0) {
+    return transaction_status;
+  }
+  absl::BitGen bitgen;
+  absl::Duration backoff =
+      absl::Milliseconds(retry_options_.initial_backoff_ms());
+  const absl::Duration max_backoff =
+      absl::Milliseconds(retry_options_.max_backoff_ms());
+  for (int64 num_retries = 1; num_retries <= retry_options_.max_num_retries();
+       num_retries++) {
+    // The aborted transaction of a cancelled call, or of one past its
+    // deadline, is not retried.
+    const CancellationToken* token = metadata_source_->cancellation_token();
+    if (token != nullptr && !token->Check().ok()) {
+      return token->Check();
+    }
+    VLOG(1) << "Retrying the aborted transaction (" << num_retries << "/"
+            << retry_options_.max_num_retries() << "): " << transaction_status;
+    TransactionStats* stats = metadata_source_->transaction_stats();
+    if (stats != nullptr) {
+      stats->set_num_retries(stats->num_retries() + 1);
+    }
+    absl::SleepFor(backoff * absl::Uniform(bitgen, 0.5, 1.0));
+    backoff = std::min(backoff * 2, max_backoff);
+    transaction_status = ExecuteOnce(txn_body, read_only);
+    if (!absl::IsAborted(transaction_status)) {
+      break;
+    }
+  }
+  return transaction_status;
+}
+
+absl::Status RdbmsTransactionExecutor::ExecuteOnce(
+    const std::function<absl::Status()>& txn_body, const bool read_only) const {
+  // Each attempt is a span, so that the retries of a call are visible.
+  ScopedTraceSpan span("RdbmsTransactionExecutor::Execute");
+  span.AddAttribute("mlmd.read_only", read_only ? "true" : "false");
+  absl::Status transaction_status = read_only
+                                        ? metadata_source_->BeginReadOnly()
+                                        : metadata_source_->Begin();
+  if (!transaction_status.ok()) {
+    span.SetStatus(transaction_status);
+    return transaction_status;
+  }
 
-  absl::Status transaction_status = txn_body();
+  transaction_status = txn_body();
   if (transaction_status.ok()) {
     transaction_status.Update(metadata_source_->Commit());
   }
@@ -39,6 +102,7 @@ absl::Status RdbmsTransactionExecutor::Execute(
   if (!transaction_status.ok()) {
     transaction_status.Update(metadata_source_->Rollback());
   }
+  span.SetStatus(transaction_status);
   return transaction_status;
 }
 
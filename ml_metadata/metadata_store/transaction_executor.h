@@ -40,33 +40,69 @@ class TransactionExecutor {
       const std::function<absl::Status()>& txn_body,
       const TransactionOptions& transaction_options = TransactionOptions())
       const = 0;
+
+  // Runs txn_body, which only reads the database, and return the transaction
+  // status. By default, it is the same as Execute.
+  virtual absl::Status ExecuteReadOnly(
+      const std::function<absl::Status()>& txn_body,
+      const TransactionOptions& transaction_options =
+          TransactionOptions()) const {
+    return Execute(txn_body, transaction_options);
+  }
 };
 
 // An implementation of TransactionExecutor.
 // It contains a method to execute the transaction body and tries to commit
 // the execution result in the database by using Begin/Commit/Rollback
-// methods in MetadataSource.
+// methods in MetadataSource. The transactions returning Aborted error are
+// retried with jittered exponential backoff as configured by `retry_options`.
 class RdbmsTransactionExecutor : public TransactionExecutor {
  public:
-  explicit RdbmsTransactionExecutor(MetadataSource* metadata_source)
-      : metadata_source_(metadata_source) {}
+  // The `retry_options` without `max_num_retries` disables the retries.
+  explicit RdbmsTransactionExecutor(
+      MetadataSource* metadata_source,
+      const RetryOptions& retry_options = RetryOptions())
+      : metadata_source_(metadata_source), retry_options_(retry_options) {}
   ~RdbmsTransactionExecutor() override = default;
 
   // Tries to commit the execution result of txn_body.
   // When the txn_body returns OK, it calls Commit, otherwise it calls Rollback.
+  // If the transaction returns Aborted error, it is rolled back and retried up
+  // to `max_num_retries` times, so the txn_body must be idempotent, e.g., it
+  // clears its outputs first. It is not retried once the call of the
+  // cancellation token of the metadata_source, if any, is cancelled or past
+  // its deadline.
   //
   // Returns FAILED_PRECONDITION if metadata_source is null or not connected.
+  // Returns CANCELLED or DEADLINE_EXCEEDED error, if the call of the
+  // cancellation token is cancelled or past its deadline.
   // Returns detailed internal errors of transaction, i.e.
   //   Begin, Rollback and Commit.
   absl::Status Execute(const std::function<absl::Status()>& txn_body,
                        const TransactionOptions& transaction_options =
                            TransactionOptions()) const override;
 
+  // Same as Execute, but begins the transactions with BeginReadOnly.
+  absl::Status ExecuteReadOnly(const std::function<absl::Status()>& txn_body,
+                               const TransactionOptions& transaction_options =
+                                   TransactionOptions()) const override;
+
  private:
+  // Runs txn_body in transactions begun as `read_only` ones, and retries the
+  // aborted ones.
+  absl::Status ExecuteWithRetries(const std::function<absl::Status()>& txn_body,
+                                  bool read_only) const;
+
+  // Runs txn_body in a transaction once.
+  absl::Status ExecuteOnce(const std::function<absl::Status()>& txn_body,
+                           bool read_only) const;
+
   // The MetadataSource which has the connection to a database.
   // It also supports other database primitves like Commit and Abort.
   // Not owned by this class.
   MetadataSource* metadata_source_;
+
+  const RetryOptions retry_options_;
 };
 
 }  // namespace ml_metadata
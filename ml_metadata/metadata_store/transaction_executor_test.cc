@@ -22,15 +22,19 @@ limitations under the License.
 #include <gtest/gtest.h>
 #include "absl/status/status.h"
 #include "ml_metadata/metadata_store/metadata_source.h"
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
 
 namespace ml_metadata {
 namespace {
 
+using ::ml_metadata::testing::ParseTextProtoOrDie;
 using ::testing::Return;
 
 class MockMetadataSource : public MetadataSource {
  public:
   MOCK_METHOD(absl::Status, BeginImpl, (), (override));
+  MOCK_METHOD(absl::Status, BeginReadOnlyImpl, (), (override));
   MOCK_METHOD(absl::Status, ConnectImpl, (), (override));
   MOCK_METHOD(absl::Status, CloseImpl, (), (override));
   MOCK_METHOD(absl::Status, RollbackImpl, (), (override));
@@ -163,5 +167,109 @@ TEST(TransactionExecutorTest, ReturnConnectErrorWhenConnectFails) {
                 " created and connected"));
 }
 
+TEST(TransactionExecutorTest, RetriesAbortedTransaction) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, BeginImpl())
+      .Times(3)
+      .WillRepeatedly(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, RollbackImpl())
+      .Times(2)
+      .WillRepeatedly(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, CommitImpl())
+      .WillOnce(Return(absl::OkStatus()));
+
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  TransactionStats stats;
+  mock_metadata_source.set_transaction_stats(&stats);
+  RdbmsTransactionExecutor txn_executor(
+      &mock_metadata_source, ParseTextProtoOrDie<RetryOptions>(R"pb(
+        max_num_retries: 3 initial_backoff_ms: 1
+      )pb"));
+
+  int num_calls = 0;
+  EXPECT_EQ(absl::OkStatus(),
+            txn_executor.Execute([&num_calls]() -> absl::Status {
+              num_calls++;
+              return num_calls < 3 ? absl::AbortedError("deadlock")
+                                   : absl::OkStatus();
+            }));
+  EXPECT_EQ(num_calls, 3);
+  EXPECT_EQ(stats.num_transactions(), 3);
+  EXPECT_EQ(stats.num_retries(), 2);
+}
+
+TEST(TransactionExecutorTest, RetriesAbortedCommitUpToMaxNumRetries) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, BeginImpl())
+      .Times(3)
+      .WillRepeatedly(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, CommitImpl())
+      .Times(3)
+      .WillRepeatedly(Return(absl::AbortedError("conflict")));
+  EXPECT_CALL(mock_metadata_source, RollbackImpl())
+      .Times(3)
+      .WillRepeatedly(Return(absl::OkStatus()));
+
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  RdbmsTransactionExecutor txn_executor(
+      &mock_metadata_source, ParseTextProtoOrDie<RetryOptions>(R"pb(
+        max_num_retries: 2 initial_backoff_ms: 1
+      )pb"));
+
+  EXPECT_TRUE(absl::IsAborted(txn_executor.Execute(kFuncReturnOk)));
+}
+
+TEST(TransactionExecutorTest, DoesNotRetryOtherErrorsOrWithoutRetryOptions) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, BeginImpl())
+      .Times(2)
+      .WillRepeatedly(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, RollbackImpl())
+      .Times(2)
+      .WillRepeatedly(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, CommitImpl()).Times(0);
+
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  RdbmsTransactionExecutor retrying_txn_executor(
+      &mock_metadata_source, ParseTextProtoOrDie<RetryOptions>(R"pb(
+        max_num_retries: 3 initial_backoff_ms: 1
+      )pb"));
+  EXPECT_EQ(retrying_txn_executor.Execute(kFuncReturnInternalError),
+            kTfFuncErrorStatus);
+
+  RdbmsTransactionExecutor txn_executor(&mock_metadata_source);
+  EXPECT_TRUE(absl::IsAborted(txn_executor.Execute(
+      []() -> absl::Status { return absl::AbortedError("deadlock"); })));
+}
+
+TEST(TransactionExecutorTest, ExecuteReadOnlyBeginsReadOnlyTransactions) {
+  MockMetadataSource mock_metadata_source;
+  EXPECT_CALL(mock_metadata_source, ConnectImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, BeginReadOnlyImpl())
+      .Times(2)
+      .WillRepeatedly(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, CommitImpl())
+      .WillOnce(Return(absl::AbortedError("conflict")))
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, RollbackImpl())
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metadata_source, BeginImpl()).Times(0);
+
+  ASSERT_EQ(absl::OkStatus(), mock_metadata_source.Connect());
+  RdbmsTransactionExecutor txn_executor(
+      &mock_metadata_source, ParseTextProtoOrDie<RetryOptions>(R"pb(
+        max_num_retries: 1 initial_backoff_ms: 1
+      )pb"));
+
+  EXPECT_EQ(absl::OkStatus(), txn_executor.ExecuteReadOnly(kFuncReturnOk));
+}
+
 }  // namespace
 }  // namespace ml_metadata
@@ -0,0 +1,95 @@
+/* Copyright 2022 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_TYPE_CACHE_H_
+#define ML_METADATA_METADATA_STORE_TYPE_CACHE_H_
+
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "ml_metadata/metadata_store/types.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// An in-memory cache of stored types, i.e., {ArtifactType, ExecutionType,
+// ContextType}, which are looked up by type id, or by type name and an
+// optional version. A type without a version and a type with an empty version
+// share the same key, as they are the same stored type.
+//
+// The cache does not know when the stored types change; the owner is expected
+// to Clear() it when the cached types may be stale.
+class TypeCache {
+ public:
+  TypeCache() = default;
+
+  // default & copy constructors are disallowed.
+  TypeCache(const TypeCache&) = delete;
+  TypeCache& operator=(const TypeCache&) = delete;
+
+  // Inserts the `type`, or replaces the cached type with the same id.
+  template <typename Type>
+  void Insert(const Type& type) {
+    Entries<Type>& entries = std::get<Entries<Type>>(entries_);
+    entries.ids_by_name[{type.name(), type.version()}] = type.id();
+    entries.types[type.id()] = type;
+  }
+
+  // Returns the cached type with `type_id`, or nullptr if it is not cached.
+  template <typename Type>
+  const Type* Find(int64 type_id) const {
+    const Entries<Type>& entries = std::get<Entries<Type>>(entries_);
+    auto it = entries.types.find(type_id);
+    return it == entries.types.end() ? nullptr : &it->second;
+  }
+
+  // Returns the cached type with `name` and `version`, or nullptr if it is not
+  // cached.
+  template <typename Type>
+  const Type* Find(absl::string_view name,
+                   absl::optional<absl::string_view> version) const {
+    const Entries<Type>& entries = std::get<Entries<Type>>(entries_);
+    auto it = entries.ids_by_name.find(
+        std::make_pair(std::string(name), std::string(version.value_or(""))));
+    return it == entries.ids_by_name.end() ? nullptr : Find<Type>(it->second);
+  }
+
+  // Removes all cached types.
+  void Clear() {
+    std::get<Entries<ArtifactType>>(entries_) = {};
+    std::get<Entries<ExecutionType>>(entries_) = {};
+    std::get<Entries<ContextType>>(entries_) = {};
+  }
+
+ private:
+  // The cached types of a type kind, and their ids by (name, version).
+  template <typename Type>
+  struct Entries {
+    absl::flat_hash_map<int64, Type> types;
+    absl::flat_hash_map<std::pair<std::string, std::string>, int64>
+        ids_by_name;
+  };
+
+  std::tuple<Entries<ArtifactType>, Entries<ExecutionType>,
+             Entries<ContextType>>
+      entries_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_TYPE_CACHE_H_
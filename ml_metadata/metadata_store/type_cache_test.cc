@@ -0,0 +1,96 @@
+/* Copyright 2022 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/type_cache.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "ml_metadata/metadata_store/test_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+namespace {
+
+using ::ml_metadata::testing::EqualsProto;
+using ::ml_metadata::testing::ParseTextProtoOrDie;
+using ::testing::IsNull;
+using ::testing::NotNull;
+using ::testing::Pointee;
+
+TEST(TypeCacheTest, FindByIdAndName) {
+  TypeCache cache;
+  const ArtifactType type = ParseTextProtoOrDie<ArtifactType>(R"pb(
+    id: 1
+    name: 'artifact_type'
+    properties { key: 'p' value: INT }
+  )pb");
+  const ArtifactType versioned_type = ParseTextProtoOrDie<ArtifactType>(R"pb(
+    id: 2
+    name: 'artifact_type'
+    version: 'v1'
+  )pb");
+  cache.Insert(type);
+  cache.Insert(versioned_type);
+
+  EXPECT_THAT(cache.Find<ArtifactType>(1), Pointee(EqualsProto(type)));
+  EXPECT_THAT(cache.Find<ArtifactType>(2),
+              Pointee(EqualsProto(versioned_type)));
+  EXPECT_THAT(cache.Find<ArtifactType>(3), IsNull());
+  EXPECT_THAT(cache.Find<ArtifactType>("artifact_type", absl::nullopt),
+              Pointee(EqualsProto(type)));
+  EXPECT_THAT(cache.Find<ArtifactType>("artifact_type", ""),
+              Pointee(EqualsProto(type)));
+  EXPECT_THAT(cache.Find<ArtifactType>("artifact_type", "v1"),
+              Pointee(EqualsProto(versioned_type)));
+  EXPECT_THAT(cache.Find<ArtifactType>("artifact_type", "v2"), IsNull());
+}
+
+TEST(TypeCacheTest, TypeKindsAreCachedSeparately) {
+  TypeCache cache;
+  cache.Insert(ParseTextProtoOrDie<ExecutionType>("id: 1 name: 't'"));
+
+  EXPECT_THAT(cache.Find<ExecutionType>(1), NotNull());
+  EXPECT_THAT(cache.Find<ArtifactType>(1), IsNull());
+  EXPECT_THAT(cache.Find<ContextType>("t", absl::nullopt), IsNull());
+}
+
+TEST(TypeCacheTest, InsertReplacesType) {
+  TypeCache cache;
+  cache.Insert(ParseTextProtoOrDie<ContextType>("id: 1 name: 't'"));
+  const ContextType updated_type = ParseTextProtoOrDie<ContextType>(R"pb(
+    id: 1
+    name: 't'
+    properties { key: 'p' value: STRING }
+  )pb");
+  cache.Insert(updated_type);
+
+  EXPECT_THAT(cache.Find<ContextType>(1), Pointee(EqualsProto(updated_type)));
+  EXPECT_THAT(cache.Find<ContextType>("t", absl::nullopt),
+              Pointee(EqualsProto(updated_type)));
+}
+
+TEST(TypeCacheTest, Clear) {
+  TypeCache cache;
+  cache.Insert(ParseTextProtoOrDie<ArtifactType>("id: 1 name: 'a'"));
+  cache.Insert(ParseTextProtoOrDie<ExecutionType>("id: 2 name: 'e'"));
+  cache.Insert(ParseTextProtoOrDie<ContextType>("id: 3 name: 'c'"));
+  cache.Clear();
+
+  EXPECT_THAT(cache.Find<ArtifactType>(1), IsNull());
+  EXPECT_THAT(cache.Find<ExecutionType>("e", absl::nullopt), IsNull());
+  EXPECT_THAT(cache.Find<ContextType>(3), IsNull());
+}
+
+}  // namespace
+}  // namespace ml_metadata
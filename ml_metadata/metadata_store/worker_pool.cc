@@ -0,0 +1,84 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/worker_pool.h"
+
+#include <cstddef>
+#include <utility>
+
+#include <glog/logging.h>
+#include "absl/synchronization/mutex.h"
+
+namespace ml_metadata {
+
+WorkerPool::WorkerPool(const int num_workers, const int max_queue_size)
+    : max_queue_size_(max_queue_size) {
+  CHECK_GT(num_workers, 0) << "The number of workers must be positive.";
+  CHECK_GE(max_queue_size, 0) << "The max queue size cannot be negative.";
+  workers_.reserve(num_workers);
+  for (int i = 0; i < num_workers; i++) {
+    workers_.emplace_back(&WorkerPool::WorkerLoop, this);
+  }
+}
+
+WorkerPool::~WorkerPool() { Stop(); }
+
+bool WorkerPool::Schedule(std::function<void()> task) {
+  absl::MutexLock lock(&mu_);
+  if (stopping_ || tasks_.size() >= static_cast<size_t>(max_queue_size_)) {
+    return false;
+  }
+  tasks_.push_back(std::move(task));
+  return true;
+}
+
+void WorkerPool::Stop() {
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+  }
+  for (std::thread& worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+int WorkerPool::num_queued_tasks() const {
+  absl::MutexLock lock(&mu_);
+  return tasks_.size();
+}
+
+void WorkerPool::WorkerLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(this, &WorkerPool::HasTaskOrStopping));
+      // The queued tasks are drained before the workers stop.
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+bool WorkerPool::HasTaskOrStopping() const {
+  return !tasks_.empty() || stopping_;
+}
+
+}  // namespace ml_metadata
@@ -0,0 +1,80 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_METADATA_STORE_WORKER_POOL_H_
+#define ML_METADATA_METADATA_STORE_WORKER_POOL_H_
+
+#include <deque>
+#include <functional>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace ml_metadata {
+
+// A fixed number of worker threads running the tasks of a bounded queue in
+// FIFO order. It is thread-safe.
+//
+// Usage example:
+//
+//    WorkerPool pool(/*num_workers=*/4, /*max_queue_size=*/100);
+//    if (!pool.Schedule([]() { ... })) {
+//      // the queue is full, reject the work.
+//    }
+class WorkerPool {
+ public:
+  // Starts `num_workers` threads. At most `max_queue_size` tasks can wait for
+  // a worker. Check-fails if `num_workers` is not positive or
+  // `max_queue_size` is negative.
+  WorkerPool(int num_workers, int max_queue_size);
+
+  // Disallows copy.
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  // Stops the pool if it is not stopped yet.
+  ~WorkerPool();
+
+  // Queues `task` to be run by a worker. Returns false without queueing the
+  // task, if `max_queue_size` tasks are already waiting or the pool is
+  // stopped.
+  bool Schedule(std::function<void()> task);
+
+  // Rejects new tasks, runs the queued tasks, then joins the workers.
+  void Stop();
+
+  // Returns the number of tasks waiting for a worker.
+  int num_queued_tasks() const;
+
+ private:
+  // Runs the queued tasks until the pool is stopped.
+  void WorkerLoop();
+
+  // Returns true if a worker can take a task or should stop.
+  bool HasTaskOrStopping() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int max_queue_size_;
+
+  mutable absl::Mutex mu_;
+  std::deque<std::function<void()>> tasks_ ABSL_GUARDED_BY(mu_);
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_METADATA_STORE_WORKER_POOL_H_
@@ -0,0 +1,65 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/metadata_store/worker_pool.h"
+
+#include <atomic>
+
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "absl/synchronization/notification.h"
+
+namespace ml_metadata {
+namespace {
+
+TEST(WorkerPoolTest, RunsScheduledTasks) {
+  std::atomic<int> num_runs(0);
+  {
+    WorkerPool pool(/*num_workers=*/2, /*max_queue_size=*/10);
+    for (int i = 0; i < 10; i++) {
+      ASSERT_TRUE(pool.Schedule([&num_runs]() { num_runs++; }));
+    }
+  }
+  // The queued tasks are drained when the pool is destructed.
+  EXPECT_EQ(num_runs, 10);
+}
+
+TEST(WorkerPoolTest, ScheduleRejectsTasksWhenQueueIsFull) {
+  auto pool = absl::make_unique<WorkerPool>(/*num_workers=*/1,
+                                            /*max_queue_size=*/1);
+  absl::Notification running, release;
+  ASSERT_TRUE(pool->Schedule([&running, &release]() {
+    running.Notify();
+    release.WaitForNotification();
+  }));
+  running.WaitForNotification();
+
+  std::atomic<int> num_runs(0);
+  EXPECT_TRUE(pool->Schedule([&num_runs]() { num_runs++; }));
+  EXPECT_EQ(pool->num_queued_tasks(), 1);
+  EXPECT_FALSE(pool->Schedule([&num_runs]() { num_runs++; }));
+
+  release.Notify();
+  pool.reset();
+  EXPECT_EQ(num_runs, 1);
+}
+
+TEST(WorkerPoolTest, ScheduleRejectsTasksWhenStopped) {
+  WorkerPool pool(/*num_workers=*/1, /*max_queue_size=*/1);
+  pool.Stop();
+  EXPECT_FALSE(pool.Schedule([]() {}));
+}
+
+}  // namespace
+}  // namespace ml_metadata
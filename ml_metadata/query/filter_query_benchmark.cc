@@ -0,0 +1,344 @@
+/* Copyright 2019 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+// Micro-benchmarks of the compilation of the filter queries of the List
+// operations to SQL, without a database: the ZetaSQL analysis by
+// FilterQueryAstResolver, the SQL generation by FilterQueryBuilder, the
+// FilterQueryCache in front of both, and the ordering, paging and limit
+// clauses of list_operation_query_helper. Besides the mean time, every
+// benchmark reports the heap allocations and the allocated bytes per
+// iteration, and the filter query benchmarks the size of the generated SQL.
+//
+// Usage example:
+//
+//    bazel run -c opt //ml_metadata/query:filter_query_benchmark --
+//        --benchmark_filter=BM_ResolveFilterQuery
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "ml_metadata/metadata_store/list_operation_query_helper.h"
+#include "ml_metadata/metadata_store/list_operation_util.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/query/filter_query_ast_resolver.h"
+#include "ml_metadata/query/filter_query_builder.h"
+#include "ml_metadata/query/filter_query_cache.h"
+
+namespace {
+
+// The heap allocations of the process, counted by the replaced global
+// operator new below.
+std::atomic<int64_t> num_allocations{0};
+std::atomic<int64_t> num_allocated_bytes{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  num_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  void* const ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace ml_metadata {
+namespace {
+
+// The node types of the filter queries.
+enum NodeKind { kArtifact, kExecution, kContext };
+
+// A representative filter query of the List operations.
+struct FilterQueryCase {
+  const char* name;
+  NodeKind node_kind;
+  std::string filter_query;
+};
+
+// Returns a filter query of `depth` nested AND and OR expressions, each
+// mixing an attribute and a property condition.
+std::string NestedBooleanFilterQuery(const int depth) {
+  std::string filter_query = "uri = 'u_0'";
+  for (int i = 1; i < depth; i++) {
+    filter_query = absl::StrCat(
+        "(", filter_query, i % 2 == 0 ? " AND " : " OR ", "(uri = 'u_", i,
+        "' OR properties.p_", i % 4, ".int_value > ", i, "))");
+  }
+  return filter_query;
+}
+
+// The cases of the filter query benchmarks, indexed by their first argument.
+const std::vector<FilterQueryCase>& FilterQueryCases() {
+  static const std::vector<FilterQueryCase>* cases =
+      new std::vector<FilterQueryCase>{
+          {"attribute", kArtifact,
+           "uri LIKE '/pipeline/%' AND state = LIVE AND "
+           "create_time_since_epoch > 1600000000000"},
+          {"property", kArtifact,
+           "properties.span.int_value > 10 AND "
+           "custom_properties.split.string_value = 'train'"},
+          {"context_neighborhood", kArtifact,
+           "contexts_0.type = 'PipelineRun' AND contexts_0.name = 'run_1' AND "
+           "contexts_1.type = 'Pipeline'"},
+          {"parent_context", kContext,
+           "parent_contexts_0.name = 'pipeline' AND "
+           "child_contexts_0.type = 'Trainer'"},
+          {"event", kArtifact,
+           "events_0.execution_id = 1 AND "
+           "events_0.milliseconds_since_epoch > 1600000000000"},
+          {"execution_event", kExecution,
+           "last_known_state = COMPLETE AND events_0.artifact_id = 1"},
+          {"nested_boolean_8", kArtifact, NestedBooleanFilterQuery(8)},
+          {"nested_boolean_32", kArtifact, NestedBooleanFilterQuery(32)},
+      };
+  return *cases;
+}
+
+// Registers the benchmark for every filter query case.
+void ForEachFilterQuery(benchmark::internal::Benchmark* benchmark) {
+  for (int i = 0; i < FilterQueryCases().size(); i++) {
+    benchmark->Arg(i);
+  }
+  benchmark->ArgName("case");
+}
+
+// Counts the heap allocations of the iterations of a benchmark, and reports
+// them per iteration as counters.
+class AllocationRecorder {
+ public:
+  AllocationRecorder()
+      : start_allocations_(num_allocations.load()),
+        start_allocated_bytes_(num_allocated_bytes.load()) {}
+
+  void Report(benchmark::State& state) {
+    state.counters["allocs"] = benchmark::Counter(
+        num_allocations.load() - start_allocations_,
+        benchmark::Counter::kAvgIterations);
+    state.counters["alloc_bytes"] = benchmark::Counter(
+        num_allocated_bytes.load() - start_allocated_bytes_,
+        benchmark::Counter::kAvgIterations);
+  }
+
+ private:
+  const int64_t start_allocations_;
+  const int64_t start_allocated_bytes_;
+};
+
+// Analyzes the filter query of the case with ZetaSQL in every iteration.
+template <typename T>
+void ResolveFilterQuery(benchmark::State& state,
+                        const FilterQueryCase& filter_query_case) {
+  AllocationRecorder allocations;
+  for (auto _ : state) {
+    FilterQueryAstResolver<T> ast_resolver(filter_query_case.filter_query);
+    const absl::Status status = ast_resolver.Resolve();
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+    benchmark::DoNotOptimize(ast_resolver.GetAst());
+  }
+  allocations.Report(state);
+}
+
+// Generates the SQL of the analyzed filter query of the case in every
+// iteration.
+template <typename T>
+void BuildFilterQuery(benchmark::State& state,
+                      const FilterQueryCase& filter_query_case) {
+  FilterQueryAstResolver<T> ast_resolver(filter_query_case.filter_query);
+  const absl::Status resolve_status = ast_resolver.Resolve();
+  if (!resolve_status.ok()) {
+    state.SkipWithError(resolve_status.ToString().c_str());
+    return;
+  }
+  AllocationRecorder allocations;
+  size_t sql_bytes = 0;
+  for (auto _ : state) {
+    // The builder is set up as by FilterQueryCache.
+    FilterQueryBuilder<T> query_builder(/*semi_join_neighbors=*/true,
+                                        /*resolve_interned_strings=*/true);
+    const absl::Status status = ast_resolver.GetAst()->Accept(&query_builder);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+    const std::string from_clause = query_builder.GetFromClause();
+    const std::string where_clause = query_builder.GetWhereClause();
+    sql_bytes = from_clause.size() + where_clause.size();
+  }
+  allocations.Report(state);
+  state.counters["sql_bytes"] = sql_bytes;
+}
+
+// Compiles the filter query of the case through a FilterQueryCache in every
+// iteration, which is a miss, i.e., the analysis, the SQL generation and the
+// lifting of the literals, unless `cached`, and a hit otherwise.
+template <typename T>
+void CompileFilterQuery(benchmark::State& state,
+                        const FilterQueryCase& filter_query_case,
+                        const bool cached) {
+  FilterQueryCache warm_cache(/*capacity=*/1);
+  CompiledFilterQuery compiled;
+  if (cached) {
+    const absl::Status status =
+        warm_cache.Compile<T>(filter_query_case.filter_query, &compiled);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  AllocationRecorder allocations;
+  for (auto _ : state) {
+    FilterQueryCache cold_cache(/*capacity=*/1);
+    FilterQueryCache& cache = cached ? warm_cache : cold_cache;
+    const absl::Status status =
+        cache.Compile<T>(filter_query_case.filter_query, &compiled);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+  }
+  allocations.Report(state);
+  state.counters["sql_bytes"] =
+      compiled.from_clause.size() + compiled.where_clause.size();
+}
+
+void BM_ResolveFilterQuery(benchmark::State& state) {
+  const FilterQueryCase& filter_query_case =
+      FilterQueryCases()[state.range(0)];
+  state.SetLabel(filter_query_case.name);
+  switch (filter_query_case.node_kind) {
+    case kArtifact:
+      ResolveFilterQuery<Artifact>(state, filter_query_case);
+      break;
+    case kExecution:
+      ResolveFilterQuery<Execution>(state, filter_query_case);
+      break;
+    case kContext:
+      ResolveFilterQuery<Context>(state, filter_query_case);
+      break;
+  }
+}
+BENCHMARK(BM_ResolveFilterQuery)->Apply(ForEachFilterQuery);
+
+void BM_BuildFilterQuery(benchmark::State& state) {
+  const FilterQueryCase& filter_query_case =
+      FilterQueryCases()[state.range(0)];
+  state.SetLabel(filter_query_case.name);
+  switch (filter_query_case.node_kind) {
+    case kArtifact:
+      BuildFilterQuery<Artifact>(state, filter_query_case);
+      break;
+    case kExecution:
+      BuildFilterQuery<Execution>(state, filter_query_case);
+      break;
+    case kContext:
+      BuildFilterQuery<Context>(state, filter_query_case);
+      break;
+  }
+}
+BENCHMARK(BM_BuildFilterQuery)->Apply(ForEachFilterQuery);
+
+void BM_CompileFilterQuery(benchmark::State& state) {
+  const FilterQueryCase& filter_query_case =
+      FilterQueryCases()[state.range(0)];
+  const bool cached = state.range(1) != 0;
+  state.SetLabel(filter_query_case.name);
+  switch (filter_query_case.node_kind) {
+    case kArtifact:
+      CompileFilterQuery<Artifact>(state, filter_query_case, cached);
+      break;
+    case kExecution:
+      CompileFilterQuery<Execution>(state, filter_query_case, cached);
+      break;
+    case kContext:
+      CompileFilterQuery<Context>(state, filter_query_case, cached);
+      break;
+  }
+}
+BENCHMARK(BM_CompileFilterQuery)->Apply([](benchmark::internal::Benchmark* b) {
+  for (int i = 0; i < FilterQueryCases().size(); i++) {
+    b->Args({i, /*cached=*/0});
+    b->Args({i, /*cached=*/1});
+  }
+  b->ArgNames({"case", "cached"});
+});
+
+// Builds the ordering threshold, ORDER BY and LIMIT clauses of a List
+// operation ordered by the field of the first argument, of its first page if
+// the second argument is 0, or else of a following page whose token lists
+// that many ids with the last update time of the previous page.
+void BM_AppendListOperationClauses(benchmark::State& state) {
+  ListOperationOptions options;
+  options.set_max_result_size(100);
+  options.mutable_order_by_field()->set_field(
+      static_cast<ListOperationOptions::OrderByField::Field>(state.range(0)));
+  options.mutable_order_by_field()->set_is_asc(false);
+  if (state.range(1) > 0) {
+    ListOperationNextPageToken token;
+    token.set_field_offset(1600000000000);
+    token.set_id_offset(1000);
+    for (int i = 0; i < state.range(1); i++) {
+      token.add_listed_ids(1000 - i);
+    }
+    std::string next_page_token;
+    const absl::Status status =
+        EncodeListOperationNextPageToken(options, token, &next_page_token);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+    options.set_next_page_token(next_page_token);
+  }
+  AllocationRecorder allocations;
+  size_t sql_bytes = 0;
+  for (auto _ : state) {
+    std::string sql_query = "SELECT `id` FROM `Artifact` WHERE";
+    absl::Status status = AppendOrderingThresholdClause(
+        options, /*table_alias=*/absl::nullopt, sql_query);
+    if (status.ok()) {
+      status = AppendOrderByClause(options, /*table_alias=*/absl::nullopt,
+                                   sql_query);
+    }
+    if (status.ok()) status = AppendLimitClause(options, sql_query);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+    sql_bytes = sql_query.size();
+  }
+  allocations.Report(state);
+  state.counters["sql_bytes"] = sql_bytes;
+}
+BENCHMARK(BM_AppendListOperationClauses)
+    ->ArgsProduct({{ListOperationOptions::OrderByField::CREATE_TIME,
+                    ListOperationOptions::OrderByField::LAST_UPDATE_TIME,
+                    ListOperationOptions::OrderByField::ID},
+                   {0, 1, 100}})
+    ->ArgNames({"order_by", "listed_ids"});
+
+}  // namespace
+}  // namespace ml_metadata
+
+BENCHMARK_MAIN();
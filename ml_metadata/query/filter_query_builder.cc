@@ -14,10 +14,16 @@ limitations under the License.
 ==============================================================================*/
 #include "ml_metadata/query/filter_query_builder.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <glog/logging.h>
 #include "zetasql/public/strings.h"
 #include "zetasql/resolved_ast/sql_builder.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_replace.h"
 #include "absl/strings/substitute.h"
 #include "ml_metadata/metadata_store/constants.h"
 #include "ml_metadata/proto/metadata_store.pb.h"
@@ -42,9 +48,12 @@ JOIN (
   WHERE Type.type_kind = $2
 ) AS $1 ON $0.type_id = $1.type_id )sql";
 
+// The neighbors of a node having many rows per node, i.e., its contexts,
+// parent and child contexts and events, are given as a table and the condition
+// relating it to the node, which are either joined with the node, or queried
+// in a correlated EXISTS subquery by a semi-join.
 // $0 is the base node table, $1 is the context related neighborhood table.
-constexpr absl::string_view kContextJoinTableViaAttribution = R"sql(
-JOIN (
+constexpr absl::string_view kContextTableViaAttribution = R"sql((
   SELECT Context.id, Context.name,
          Type.name as type,
          Attribution.artifact_id,
@@ -53,11 +62,12 @@ JOIN (
   FROM Context
        JOIN Type ON Context.type_id = Type.id
        JOIN Attribution ON Context.id = Attribution.context_id
-) AS $1 ON $0.id = $1.artifact_id )sql";
+) AS $1)sql";
+constexpr absl::string_view kContextConditionViaAttribution =
+    "$0.id = $1.artifact_id";
 
 // $0 is the base node table, $1 is the context related neighborhood table.
-constexpr absl::string_view kContextJoinTableViaAssociation = R"sql(
-JOIN (
+constexpr absl::string_view kContextTableViaAssociation = R"sql((
   SELECT Context.id, Context.name,
          Type.name as type,
          Association.execution_id,
@@ -67,31 +77,35 @@ JOIN (
   FROM Context
        JOIN Type ON Context.type_id = Type.id
        JOIN Association ON Context.id = Association.context_id
-) AS $1 ON $0.id = $1.execution_id )sql";
+) AS $1)sql";
+constexpr absl::string_view kContextConditionViaAssociation =
+    "$0.id = $1.execution_id";
 
 // $0 is the base context table, $1 is the context related through ParentContext
 // table.
-constexpr absl::string_view kParentContextJoinTableViaParentContext = R"sql(
-JOIN (
+constexpr absl::string_view kParentContextTableViaParentContext = R"sql((
   SELECT Context.name,
          Type.name as type,
          ParentContext.context_id as child_context_id
   FROM Context
        JOIN Type ON Context.type_id = Type.id
        JOIN ParentContext ON Context.id = ParentContext.parent_context_id
-) AS $1 ON $0.id = $1.child_context_id )sql";
+) AS $1)sql";
+constexpr absl::string_view kParentContextConditionViaParentContext =
+    "$0.id = $1.child_context_id";
 
 // $0 is the base context table, $1 is the context related through ParentContext
 // table.
-constexpr absl::string_view kChildContextJoinTableViaParentContext = R"sql(
-JOIN (
+constexpr absl::string_view kChildContextTableViaParentContext = R"sql((
   SELECT Context.name,
          Type.name as type,
          ParentContext.parent_context_id as parent_context_id
   FROM Context
        JOIN Type ON Context.type_id = Type.id
        JOIN ParentContext ON Context.id = ParentContext.context_id
-) AS $1 ON $0.id = $1.parent_context_id )sql";
+) AS $1)sql";
+constexpr absl::string_view kChildContextConditionViaParentContext =
+    "$0.id = $1.parent_context_id";
 
 // $0 is the base node table. $1 is the property related neighborhood table.
 // $2 is property name, $3 is a boolean for is_custom_property.
@@ -113,11 +127,95 @@ JOIN (
   FROM ContextProperty WHERE name = "$2" AND is_custom_property = $3
 ) AS $1 ON $0.id = $1.context_id )sql";
 
-constexpr absl::string_view kArtifactEventJoinTable = R"sql(
-JOIN Event AS $1 ON $0.id = $1.artifact_id )sql";
+// The property join tables resolving the string values interned in the
+// PropertyStringValue table, with the parameters of the ones above.
+constexpr absl::string_view kArtifactInternedPropertyJoinTable = R"sql(
+JOIN (
+  SELECT P.artifact_id, P.int_value, P.double_value,
+         COALESCE(P.string_value, S.value) AS string_value
+  FROM ArtifactProperty AS P
+       LEFT JOIN PropertyStringValue AS S ON S.id = P.string_value_id
+  WHERE P.name = "$2" AND P.is_custom_property = $3
+) AS $1 ON $0.id = $1.artifact_id )sql";
+
+constexpr absl::string_view kExecutionInternedPropertyJoinTable = R"sql(
+JOIN (
+  SELECT P.execution_id, P.int_value, P.double_value,
+         COALESCE(P.string_value, S.value) AS string_value
+  FROM ExecutionProperty AS P
+       LEFT JOIN PropertyStringValue AS S ON S.id = P.string_value_id
+  WHERE P.name = "$2" AND P.is_custom_property = $3
+) AS $1 ON $0.id = $1.execution_id )sql";
+
+constexpr absl::string_view kContextInternedPropertyJoinTable = R"sql(
+JOIN (
+  SELECT P.context_id, P.int_value, P.double_value,
+         COALESCE(P.string_value, S.value) AS string_value
+  FROM ContextProperty AS P
+       LEFT JOIN PropertyStringValue AS S ON S.id = P.string_value_id
+  WHERE P.name = "$2" AND P.is_custom_property = $3
+) AS $1 ON $0.id = $1.context_id )sql";
+
+// The property join tables of the indexed properties, whose conditions imply
+// the ones of their partial indices. $0 to $1 are the ones above, $2 is the
+// property name escaped in a single-quoted literal, $3 is 1 or 0 for
+// is_custom_property, $4 is the property table, and $5 is its node id column.
+constexpr absl::string_view kIndexedPropertyJoinTable = R"sql(
+JOIN (
+  SELECT $5, int_value, double_value, string_value
+  FROM $4 WHERE name = '$2' AND is_custom_property = $3
+) AS $1 ON $0.id = $1.$5 )sql";
+
+// The interned string values are looked up by their ids, rather than resolved
+// by COALESCE, which the indices cannot be used for.
+constexpr absl::string_view kIndexedInternedStringPropertyJoinTable = R"sql(
+JOIN (
+  SELECT $5, int_value, double_value, string_value
+  FROM $4
+  WHERE name = '$2' AND is_custom_property = $3 AND string_value_id IS NULL
+  UNION ALL
+  SELECT P.$5, P.int_value, P.double_value, S.value AS string_value
+  FROM $4 AS P JOIN PropertyStringValue AS S ON S.id = P.string_value_id
+  WHERE P.name = '$2' AND P.is_custom_property = $3
+) AS $1 ON $0.id = $1.$5 )sql";
+
+constexpr absl::string_view kIndexedInternedPropertyJoinTable = R"sql(
+JOIN (
+  SELECT P.$5, P.int_value, P.double_value,
+         COALESCE(P.string_value, S.value) AS string_value
+  FROM $4 AS P
+       LEFT JOIN PropertyStringValue AS S ON S.id = P.string_value_id
+  WHERE P.name = '$2' AND P.is_custom_property = $3
+) AS $1 ON $0.id = $1.$5 )sql";
+
+constexpr absl::string_view kEventTable = "Event AS $1";
+
+constexpr absl::string_view kArtifactEventCondition = "$0.id = $1.artifact_id";
+
+constexpr absl::string_view kExecutionEventCondition =
+    "$0.id = $1.execution_id";
+
+// A neighbor table of a node and the condition relating it to the node.
+struct NeighborTable {
+  std::string table;
+  std::string condition;
+};
+
+// Returns the neighbor table of the `table_template` and `condition_template`
+// substituted with the `base_alias` and the `neighbor_alias`.
+NeighborTable GetNeighborTable(absl::string_view table_template,
+                               absl::string_view condition_template,
+                               absl::string_view base_alias,
+                               absl::string_view neighbor_alias) {
+  return {absl::Substitute(table_template, base_alias, neighbor_alias),
+          absl::Substitute(condition_template, base_alias, neighbor_alias)};
+}
 
-constexpr absl::string_view kExecutionEventJoinTable = R"sql(
-JOIN Event AS $1 ON $0.id = $1.execution_id )sql";
+// Returns the join clause of the `neighbor` to compose FROM clause.
+std::string GetJoinClause(const NeighborTable& neighbor) {
+  return absl::StrCat("\nJOIN ", neighbor.table, " ON ", neighbor.condition,
+                      " ");
+}
 
 // Returns the persisted type kind value given a node template.
 template <typename T>
@@ -131,46 +229,89 @@ int GetTypeKindValue() {
   }
 }
 
-// Returns the context join clause depending on the node types.
+// Returns the context neighbor table depending on the node types.
 template <typename T>
-absl::string_view GetContextJoinTemplate() {
+NeighborTable GetContextTable(absl::string_view base_alias,
+                              absl::string_view context_alias) {
   if constexpr (std::is_same<T, Artifact>::value) {
-    return kContextJoinTableViaAttribution;
+    return GetNeighborTable(kContextTableViaAttribution,
+                            kContextConditionViaAttribution, base_alias,
+                            context_alias);
   } else if constexpr (std::is_same<T, Execution>::value) {
-    return kContextJoinTableViaAssociation;
+    return GetNeighborTable(kContextTableViaAssociation,
+                            kContextConditionViaAssociation, base_alias,
+                            context_alias);
   } else if constexpr (std::is_same<T, Context>::value) {
     LOG(ERROR) << "Context Join does not apply to T = Context.";
-    return "";
+    return {};
   }
 }
 
 template <typename T>
-absl::string_view GetEventJoinTemplate() {
+NeighborTable GetEventTable(absl::string_view base_alias,
+                            absl::string_view event_alias) {
   if constexpr (std::is_same<T, Artifact>::value) {
-    return kArtifactEventJoinTable;
+    return GetNeighborTable(kEventTable, kArtifactEventCondition, base_alias,
+                            event_alias);
   } else if constexpr (std::is_same<T, Execution>::value) {
-    return kExecutionEventJoinTable;
+    return GetNeighborTable(kEventTable, kExecutionEventCondition, base_alias,
+                            event_alias);
   } else if constexpr (std::is_same<T, Context>::value) {
     LOG(ERROR) << "Event Join does not apply to T = Context.";
-    return "";
+    return {};
   }
 }
 
-// Returns the property join clause depending on the node types.
+// Returns the property join clause depending on the node types, which
+// resolves the interned string values if `resolve_interned_strings`.
 template <typename T>
 std::string GetPropertyJoinTableImpl(absl::string_view base_alias,
                                      absl::string_view property_alias,
                                      absl::string_view property_name,
-                                     bool is_custom_property) {
+                                     bool is_custom_property,
+                                     bool resolve_interned_strings = false) {
+  if constexpr (std::is_same<T, Artifact>::value) {
+    return absl::Substitute(resolve_interned_strings
+                                ? kArtifactInternedPropertyJoinTable
+                                : kArtifactPropertyJoinTable,
+                            base_alias, property_alias, property_name,
+                            is_custom_property);
+  } else if constexpr (std::is_same<T, Execution>::value) {
+    return absl::Substitute(resolve_interned_strings
+                                ? kExecutionInternedPropertyJoinTable
+                                : kExecutionPropertyJoinTable,
+                            base_alias, property_alias, property_name,
+                            is_custom_property);
+  } else if constexpr (std::is_same<T, Context>::value) {
+    return absl::Substitute(resolve_interned_strings
+                                ? kContextInternedPropertyJoinTable
+                                : kContextPropertyJoinTable,
+                            base_alias, property_alias, property_name,
+                            is_custom_property);
+  }
+}
+
+// Returns the node kind of the indexed properties of T.
+template <typename T>
+IndexedProperty::NodeKind GetIndexedPropertyNodeKind() {
   if constexpr (std::is_same<T, Artifact>::value) {
-    return absl::Substitute(kArtifactPropertyJoinTable, base_alias,
-                            property_alias, property_name, is_custom_property);
+    return IndexedProperty::ARTIFACT;
   } else if constexpr (std::is_same<T, Execution>::value) {
-    return absl::Substitute(kExecutionPropertyJoinTable, base_alias,
-                            property_alias, property_name, is_custom_property);
+    return IndexedProperty::EXECUTION;
   } else if constexpr (std::is_same<T, Context>::value) {
-    return absl::Substitute(kContextPropertyJoinTable, base_alias,
-                            property_alias, property_name, is_custom_property);
+    return IndexedProperty::CONTEXT;
+  }
+}
+
+// Returns the property table and its node id column of T.
+template <typename T>
+std::pair<absl::string_view, absl::string_view> GetPropertyTable() {
+  if constexpr (std::is_same<T, Artifact>::value) {
+    return {"ArtifactProperty", "artifact_id"};
+  } else if constexpr (std::is_same<T, Execution>::value) {
+    return {"ExecutionProperty", "execution_id"};
+  } else if constexpr (std::is_same<T, Context>::value) {
+    return {"ContextProperty", "context_id"};
   }
 }
 }  // namespace
@@ -197,22 +338,24 @@ std::string FilterQueryBuilder<T>::GetTypeJoinTable(
 template <typename T>
 std::string FilterQueryBuilder<T>::GetContextJoinTable(
     absl::string_view base_alias, absl::string_view context_alias) {
-  return absl::Substitute(GetContextJoinTemplate<T>(), base_alias,
-                          context_alias);
+  return GetJoinClause(GetContextTable<T>(base_alias, context_alias));
 }
 
 template <typename T>
 std::string FilterQueryBuilder<T>::GetParentContextJoinTable(
     absl::string_view base_alias, absl::string_view parent_context_alias) {
-  return absl::Substitute(kParentContextJoinTableViaParentContext, base_alias,
-                          parent_context_alias);
+  return GetJoinClause(GetNeighborTable(
+      kParentContextTableViaParentContext,
+      kParentContextConditionViaParentContext, base_alias,
+      parent_context_alias));
 }
 
 template <typename T>
 std::string FilterQueryBuilder<T>::GetChildContextJoinTable(
     absl::string_view base_alias, absl::string_view child_context_alias) {
-  return absl::Substitute(kChildContextJoinTableViaParentContext, base_alias,
-                          child_context_alias);
+  return GetJoinClause(GetNeighborTable(kChildContextTableViaParentContext,
+                                        kChildContextConditionViaParentContext,
+                                        base_alias, child_context_alias));
 }
 
 template <typename T>
@@ -234,18 +377,134 @@ std::string FilterQueryBuilder<T>::GetCustomPropertyJoinTable(
 template <typename T>
 std::string FilterQueryBuilder<T>::GetEventJoinTable(
     absl::string_view base_alias, absl::string_view event_alias) {
-  return absl::Substitute(GetEventJoinTemplate<T>(), base_alias, event_alias);
+  return GetJoinClause(GetEventTable<T>(base_alias, event_alias));
+}
+
+template <typename T>
+const IndexedProperty* FilterQueryBuilder<T>::FindIndexedProperty(
+    absl::string_view property_name, const bool is_custom_property) const {
+  for (const IndexedProperty& property : indexed_properties_) {
+    if (property.property_name() == property_name &&
+        property.is_custom_property() == is_custom_property) {
+      return &property;
+    }
+  }
+  return nullptr;
+}
+
+template <typename T>
+std::string FilterQueryBuilder<T>::GetMentionedPropertyJoinTable(
+    absl::string_view base_alias, absl::string_view property_alias,
+    absl::string_view property_name, const bool is_custom_property) const {
+  const IndexedProperty* indexed_property =
+      FindIndexedProperty(property_name, is_custom_property);
+  if (indexed_property == nullptr) {
+    return GetPropertyJoinTableImpl<T>(base_alias, property_alias,
+                                       property_name, is_custom_property,
+                                       resolve_interned_strings_);
+  }
+  absl::string_view join_table = kIndexedPropertyJoinTable;
+  if (resolve_interned_strings_) {
+    join_table = indexed_property->value_type() == PropertyType::STRING
+                     ? kIndexedInternedStringPropertyJoinTable
+                     : kIndexedInternedPropertyJoinTable;
+  }
+  const std::pair<absl::string_view, absl::string_view> table =
+      GetPropertyTable<T>();
+  return absl::Substitute(
+      join_table, base_alias, property_alias,
+      absl::StrReplaceAll(property_name, {{"'", "''"}}),
+      is_custom_property ? 1 : 0, table.first, table.second);
 }
 
 template <typename T>
-FilterQueryBuilder<T>::FilterQueryBuilder() {
+FilterQueryBuilder<T>::FilterQueryBuilder(
+    const bool semi_join_neighbors, const bool resolve_interned_strings,
+    absl::Span<const IndexedProperty> indexed_properties)
+    : semi_join_neighbors_(semi_join_neighbors),
+      resolve_interned_strings_(resolve_interned_strings) {
+  for (const IndexedProperty& property : indexed_properties) {
+    if (property.node_kind() == GetIndexedPropertyNodeKind<T>()) {
+      indexed_properties_.push_back(property);
+    }
+  }
   mentioned_alias_[AtomType::ATTRIBUTE].insert(
       {kBaseTableRef, std::string(kBaseTableAlias)});
 }
 
 template <typename T>
 std::string FilterQueryBuilder<T>::GetWhereClause() {
-  return sql();
+  if (!semi_join_neighbors_) {
+    return sql();
+  }
+  const std::vector<std::pair<std::string, std::string>> neighbors =
+      GetNeighborTables();
+  if (neighbors.empty()) {
+    return sql();
+  }
+  // example output:
+  //   EXISTS (SELECT 1 FROM Event AS table_1
+  //           WHERE table_0.id = table_1.artifact_id AND ((table_1.type) = 3))
+  std::vector<absl::string_view> tables;
+  std::vector<absl::string_view> conditions;
+  for (const auto& neighbor : neighbors) {
+    tables.push_back(neighbor.first);
+    conditions.push_back(neighbor.second);
+  }
+  return absl::StrCat("EXISTS (SELECT 1 FROM ", absl::StrJoin(tables, ", "),
+                      " WHERE ", absl::StrJoin(conditions, " AND "), " AND (",
+                      sql(), "))");
+}
+
+template <typename T>
+std::vector<std::string> FilterQueryBuilder<T>::GetMentionedPropertyNames(
+    const bool is_custom_property) {
+  // The mentioned properties are prefixed by 'properties_' or
+  // 'custom_properties_'.
+  const absl::string_view prefix =
+      is_custom_property ? "custom_properties_" : "properties_";
+  std::vector<std::string> names;
+  for (const auto& mentioned_property :
+       mentioned_alias_[is_custom_property ? AtomType::CUSTOM_PROPERTY
+                                           : AtomType::PROPERTY]) {
+    names.push_back(mentioned_property.first.substr(prefix.length()));
+  }
+  return names;
+}
+
+template <typename T>
+std::vector<std::pair<std::string, std::string>>
+FilterQueryBuilder<T>::GetNeighborTables() {
+  const std::string& base_alias =
+      mentioned_alias_[AtomType::ATTRIBUTE][kBaseTableRef];
+  std::vector<NeighborTable> neighbors;
+  for (const auto& mentioned_context : mentioned_alias_[AtomType::CONTEXT]) {
+    neighbors.push_back(
+        GetContextTable<T>(base_alias, mentioned_context.second));
+  }
+  for (const auto& parent_contexts :
+       mentioned_alias_[AtomType::PARENT_CONTEXT]) {
+    neighbors.push_back(GetNeighborTable(
+        kParentContextTableViaParentContext,
+        kParentContextConditionViaParentContext, base_alias,
+        parent_contexts.second));
+  }
+  for (const auto& child_contexts : mentioned_alias_[AtomType::CHILD_CONTEXT]) {
+    neighbors.push_back(GetNeighborTable(
+        kChildContextTableViaParentContext,
+        kChildContextConditionViaParentContext, base_alias,
+        child_contexts.second));
+  }
+  for (const auto& event : mentioned_alias_[AtomType::EVENT]) {
+    neighbors.push_back(GetEventTable<T>(base_alias, event.second));
+  }
+  std::vector<std::pair<std::string, std::string>> result;
+  result.reserve(neighbors.size());
+  for (NeighborTable& neighbor : neighbors) {
+    result.emplace_back(std::move(neighbor.table),
+                        std::move(neighbor.condition));
+  }
+  return result;
 }
 
 template <typename T>
@@ -258,9 +517,12 @@ std::string FilterQueryBuilder<T>::GetFromClause() {
         mentioned_alias_[AtomType::ATTRIBUTE][kTypeTableRef];
     absl::StrAppend(&result, GetTypeJoinTable(base_alias, type_alias));
   }
-  for (const auto& mentioned_context : mentioned_alias_[AtomType::CONTEXT]) {
-    const std::string& context_alias = mentioned_context.second;
-    absl::StrAppend(&result, GetContextJoinTable(base_alias, context_alias));
+  // The semi-joined neighbors are in the WHERE clause.
+  if (!semi_join_neighbors_) {
+    for (const auto& mentioned_context : mentioned_alias_[AtomType::CONTEXT]) {
+      const std::string& context_alias = mentioned_context.second;
+      absl::StrAppend(&result, GetContextJoinTable(base_alias, context_alias));
+    }
   }
   for (const auto& mentioned_property : mentioned_alias_[AtomType::PROPERTY]) {
     const std::string& property_alias = mentioned_property.second;
@@ -268,8 +530,9 @@ std::string FilterQueryBuilder<T>::GetFromClause() {
     static constexpr absl::string_view kPropertyPrefix = "properties_";
     const std::string property_name =
         mentioned_property.first.substr(kPropertyPrefix.length());
-    absl::StrAppend(&result, GetPropertyJoinTable(base_alias, property_alias,
-                                                  property_name));
+    absl::StrAppend(&result, GetMentionedPropertyJoinTable(
+                                 base_alias, property_alias, property_name,
+                                 /*is_custom_property=*/false));
   }
   for (const auto& mentioned_property :
        mentioned_alias_[AtomType::CUSTOM_PROPERTY]) {
@@ -278,8 +541,12 @@ std::string FilterQueryBuilder<T>::GetFromClause() {
     static constexpr absl::string_view kPropertyPrefix = "custom_properties_";
     const std::string property_name =
         mentioned_property.first.substr(kPropertyPrefix.length());
-    absl::StrAppend(&result, GetCustomPropertyJoinTable(
-                                 base_alias, property_alias, property_name));
+    absl::StrAppend(&result, GetMentionedPropertyJoinTable(
+                                 base_alias, property_alias, property_name,
+                                 /*is_custom_property=*/true));
+  }
+  if (semi_join_neighbors_) {
+    return result;
   }
   for (const auto& parent_contexts :
        mentioned_alias_[AtomType::PARENT_CONTEXT]) {
@@ -15,9 +15,15 @@ limitations under the License.
 #ifndef ML_METADATA_GOOGLE_QUERY_FILTER_QUERY_BUILDER_H
 #define ML_METADATA_GOOGLE_QUERY_FILTER_QUERY_BUILDER_H
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "zetasql/resolved_ast/sql_builder.h"
 #include "absl/container/btree_map.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
 
 namespace ml_metadata {
 
@@ -25,10 +31,32 @@ namespace ml_metadata {
 // boolean expression AST parsed from a filtering query string and generates
 // FROM clauses and WHERE clauses which can be used by MLMD query executors. It
 // can be instantiated with MLMD nodes types: Artifact, Execution and Context.
+//
+// The neighbors having many rows per node, i.e., the contexts, parent and
+// child contexts and events, are joined in the FROM clause by default, so a
+// node is returned once per combination of its neighbors. If
+// `semi_join_neighbors` is set, they are queried by a correlated EXISTS
+// subquery in the WHERE clause instead, so that each node is returned at most
+// once, and a query with a LIMIT can stop at the first matching nodes rather
+// than joining all their neighbors. It can be set when only the columns of the
+// node, e.g., `table_0.id`, are selected.
+//
+// If `resolve_interned_strings` is set, the string property values are
+// resolved from the PropertyStringValue table when they are interned, which
+// the schema supports since v17, so that the filters compare the strings. The
+// compressed property values cannot be compared, so the callers reject the
+// filters on their properties, which GetMentionedPropertyNames returns.
+//
+// The properties of T among the `indexed_properties`, which have dedicated
+// partial indices, are joined by tables whose conditions imply the ones of
+// their indices, i.e., compare the name to a string literal and the
+// is_custom_property to an integer, so that the indices are used.
 template <typename T>
 class FilterQueryBuilder : public zetasql::SQLBuilder {
  public:
-  FilterQueryBuilder();
+  explicit FilterQueryBuilder(
+      bool semi_join_neighbors = false, bool resolve_interned_strings = false,
+      absl::Span<const IndexedProperty> indexed_properties = {});
 
   // Not copyable or movable
   FilterQueryBuilder(const FilterQueryBuilder&) = delete;
@@ -40,6 +68,10 @@ class FilterQueryBuilder : public zetasql::SQLBuilder {
   // Returns the SQL string that can be used in MLMD node listing FROM clause.
   std::string GetFromClause();
 
+  // Returns the names of the properties, or of the custom properties if
+  // `is_custom_property`, of the node compared by the filter query.
+  std::vector<std::string> GetMentionedPropertyNames(bool is_custom_property);
+
   // The alias for the node table used in the query builder implementation.
   static constexpr absl::string_view kBaseTableAlias = "table_0";
 
@@ -133,6 +165,30 @@ class FilterQueryBuilder : public zetasql::SQLBuilder {
   // first seen when walking through the AST.
   std::string GetTableAlias(AtomType atom_type, absl::string_view concept_name);
 
+  // Returns the tables of the neighbors having many rows per node, and the
+  // conditions relating them to the base node, in the order of their aliases.
+  std::vector<std::pair<std::string, std::string>> GetNeighborTables();
+
+  // Returns the indexed property of T named `property_name`, if any.
+  const IndexedProperty* FindIndexedProperty(absl::string_view property_name,
+                                             bool is_custom_property) const;
+
+  // Returns the join clause of `property_name`, which is routed to its
+  // dedicated index if it is indexed.
+  std::string GetMentionedPropertyJoinTable(absl::string_view base_alias,
+                                            absl::string_view property_alias,
+                                            absl::string_view property_name,
+                                            bool is_custom_property) const;
+
+  // Whether the neighbors having many rows per node are semi-joined.
+  const bool semi_join_neighbors_;
+
+  // If true, the property join tables resolve the interned string values.
+  const bool resolve_interned_strings_;
+
+  // The indexed properties of T.
+  std::vector<IndexedProperty> indexed_properties_;
+
   // The alias names of mentioned tables.
   JoinTableAlias mentioned_alias_;
 
@@ -418,5 +418,37 @@ TEST_P(SQLGenerationTest, Context) {
 INSTANTIATE_TEST_SUITE_P(FilterQueryBuilderTest, SQLGenerationTest,
                          ValuesIn(GetTestQueryTuples()));
 
+TEST(FilterQueryBuilderTest, SemiJoinNeighbors) {
+  FilterQueryAstResolver<Artifact> ast_resolver(
+      "uri = 'http://some_path' AND events_0.type = INPUT");
+  ASSERT_EQ(absl::OkStatus(), ast_resolver.Resolve());
+  FilterQueryBuilder<Artifact> query_builder(/*semi_join_neighbors=*/true);
+  ASSERT_EQ(absl::OkStatus(), ast_resolver.GetAst()->Accept(&query_builder));
+  // The events are not joined, so that each artifact is returned once.
+  EXPECT_EQ(query_builder.GetFromClause(),
+            FilterQueryBuilder<Artifact>::GetBaseNodeTable("table_0"));
+  EXPECT_EQ(query_builder.GetWhereClause(),
+            "EXISTS (SELECT 1 FROM Event AS table_1 "
+            "WHERE table_0.id = table_1.artifact_id AND "
+            "(((table_0.uri) = (\"http://some_path\")) AND "
+            "((table_1.type) = 3)))");
+}
+
+TEST(FilterQueryBuilderTest, SemiJoinNeighborsWithoutManyValuedNeighbors) {
+  FilterQueryAstResolver<Artifact> ast_resolver(
+      "type = 'a' AND properties.p0.int_value > 1");
+  ASSERT_EQ(absl::OkStatus(), ast_resolver.Resolve());
+  FilterQueryBuilder<Artifact> semi_join_builder(/*semi_join_neighbors=*/true);
+  ASSERT_EQ(absl::OkStatus(),
+            ast_resolver.GetAst()->Accept(&semi_join_builder));
+  FilterQueryBuilder<Artifact> join_builder;
+  ASSERT_EQ(absl::OkStatus(), ast_resolver.GetAst()->Accept(&join_builder));
+  // The type and the properties have at most one row per node, so they are
+  // joined in both modes.
+  EXPECT_EQ(semi_join_builder.GetFromClause(), join_builder.GetFromClause());
+  EXPECT_EQ(semi_join_builder.GetWhereClause(),
+            join_builder.GetWhereClause());
+}
+
 }  // namespace
 }  // namespace ml_metadata
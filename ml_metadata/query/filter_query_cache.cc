@@ -0,0 +1,363 @@
+/* Copyright 2020 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/query/filter_query_cache.h"
+
+#include <cstdint>
+#include <utility>
+
+#include <glog/logging.h>
+#include "zetasql/public/strings.h"
+#include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/query/filter_query_ast_resolver.h"
+#include "ml_metadata/query/filter_query_builder.h"
+#include "ml_metadata/util/return_utils.h"
+
+namespace ml_metadata {
+namespace {
+
+// The number of entries of the default cache.
+constexpr int kDefaultCapacity = 1024;
+
+// The markers of the lifted literals in the normalized filter queries. `?` is
+// not used by the filter query syntax.
+constexpr char kStringMarker[] = "?s";
+constexpr char kInt64Marker[] = "?i";
+
+// The sentinel integer literals start from it, so that they are unlikely to
+// be in the user queries, and all of them have the same number of digits.
+constexpr int64_t kInt64SentinelBase = 7300000000000000;
+
+bool IsIdentifierChar(const char c) {
+  return absl::ascii_isalnum(c) || c == '_';
+}
+
+// Returns the sentinel literal replacing the `index`-th literal of `kind` in
+// the filter query used to find the literals in the generated SQL.
+std::string GetSentinelLiteral(const FilterQueryLiteral::Kind kind,
+                               const int index) {
+  if (kind == FilterQueryLiteral::Kind::kString) {
+    return absl::StrCat("'mlmd_filter_query_literal_", index, "'");
+  }
+  return absl::StrCat(kInt64SentinelBase + index);
+}
+
+// Returns the SQL of the sentinel literal as generated by FilterQueryBuilder.
+std::string GetSentinelSql(const FilterQueryLiteral::Kind kind,
+                           const int index) {
+  if (kind == FilterQueryLiteral::Kind::kString) {
+    return zetasql::ToStringLiteral(
+        absl::StrCat("mlmd_filter_query_literal_", index));
+  }
+  return absl::StrCat(kInt64SentinelBase + index);
+}
+
+// Compiles the filter query on the node type T with ZetaSQL.
+template <typename T>
+absl::Status CompileUncached(
+    const std::string& filter_query, const bool resolve_interned_strings,
+    absl::Span<const IndexedProperty> indexed_properties,
+    CompiledFilterQuery* compiled) {
+  FilterQueryAstResolver<T> ast_resolver(filter_query);
+  const absl::Status ast_gen_status = ast_resolver.Resolve();
+  if (!ast_gen_status.ok()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid `filter_query`: ", ast_gen_status.message()));
+  }
+  // The nodes are selected by their ids only, so their neighbors are
+  // semi-joined rather than fanning out the rows of the nodes.
+  FilterQueryBuilder<T> query_builder(/*semi_join_neighbors=*/true,
+                                      resolve_interned_strings,
+                                      indexed_properties);
+  const absl::Status sql_gen_status =
+      ast_resolver.GetAst()->Accept(&query_builder);
+  if (!sql_gen_status.ok()) {
+    return absl::InternalError(
+        absl::StrCat("Failed to construct valid SQL from `filter_query`: ",
+                     sql_gen_status.message()));
+  }
+  compiled->from_clause = query_builder.GetFromClause();
+  compiled->where_clause = query_builder.GetWhereClause();
+  compiled->property_names =
+      query_builder.GetMentionedPropertyNames(/*is_custom_property=*/false);
+  compiled->custom_property_names =
+      query_builder.GetMentionedPropertyNames(/*is_custom_property=*/true);
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+bool LiftFilterQueryLiterals(absl::string_view filter_query,
+                             std::string* normalized_query,
+                             std::vector<FilterQueryLiteral>* literals) {
+  normalized_query->clear();
+  const int size = filter_query.size();
+  int i = 0;
+  while (i < size) {
+    const char c = filter_query[i];
+    if (absl::ascii_isspace(c)) {
+      while (i < size && absl::ascii_isspace(filter_query[i])) i++;
+      if (!normalized_query->empty() && i < size) {
+        normalized_query->push_back(' ');
+      }
+    } else if (c == '?') {
+      return false;
+    } else if (c == '`') {
+      // Quoted identifiers are kept verbatim.
+      const size_t end = filter_query.find('`', i + 1);
+      if (end == absl::string_view::npos) return false;
+      absl::StrAppend(normalized_query, filter_query.substr(i, end - i + 1));
+      i = end + 1;
+    } else if (c == '\'' || c == '"') {
+      // Raw, bytes and triple-quoted literals are not lifted.
+      if (i > 0 && IsIdentifierChar(filter_query[i - 1])) return false;
+      if (i + 2 < size && filter_query[i + 1] == c &&
+          filter_query[i + 2] == c) {
+        return false;
+      }
+      int end = i + 1;
+      while (end < size && filter_query[end] != c) {
+        end += filter_query[end] == '\\' ? 2 : 1;
+      }
+      if (end >= size) return false;
+      std::string value;
+      if (!zetasql::ParseStringLiteral(filter_query.substr(i, end - i + 1),
+                                       &value)
+               .ok()) {
+        return false;
+      }
+      literals->push_back(
+          {FilterQueryLiteral::Kind::kString, zetasql::ToStringLiteral(value)});
+      absl::StrAppend(normalized_query, kStringMarker);
+      i = end + 1;
+    } else if (absl::ascii_isdigit(c) &&
+               (i == 0 || (!IsIdentifierChar(filter_query[i - 1]) &&
+                           filter_query[i - 1] != '.'))) {
+      int end = i;
+      while (end < size && absl::ascii_isdigit(filter_query[end])) end++;
+      if (end < size &&
+          (IsIdentifierChar(filter_query[end]) || filter_query[end] == '.')) {
+        // A part of a float or hex literal, which is kept verbatim.
+        absl::StrAppend(normalized_query, filter_query.substr(i, end - i));
+        i = end;
+        continue;
+      }
+      int64_t value;
+      if (!absl::SimpleAtoi(filter_query.substr(i, end - i), &value)) {
+        return false;
+      }
+      literals->push_back(
+          {FilterQueryLiteral::Kind::kInt64, absl::StrCat(value)});
+      absl::StrAppend(normalized_query, kInt64Marker);
+      i = end;
+    } else {
+      normalized_query->push_back(c);
+      i++;
+    }
+  }
+  return true;
+}
+
+FilterQueryCache::FilterQueryCache(const int capacity) : capacity_(capacity) {
+  CHECK_GT(capacity_, 0) << "The capacity of the cache must be positive.";
+}
+
+FilterQueryCache* FilterQueryCache::GetDefault() {
+  static FilterQueryCache* cache = new FilterQueryCache(kDefaultCapacity);
+  return cache;
+}
+
+template <typename T>
+absl::Status FilterQueryCache::Compile(
+    absl::string_view filter_query, CompiledFilterQuery* compiled,
+    const bool resolve_interned_strings,
+    absl::Span<const IndexedProperty> indexed_properties) {
+  // The queries resolving the interned strings, or routed to indices, are
+  // keyed apart. The names are prefixed by their lengths to be unambiguous.
+  std::string node_type =
+      absl::StrCat(T::descriptor()->name(),
+                   resolve_interned_strings ? "+interned" : "");
+  for (const IndexedProperty& property : indexed_properties) {
+    absl::StrAppend(&node_type, "+index:", property.node_kind(), ":",
+                    property.is_custom_property(), ":", property.value_type(),
+                    ":", property.property_name().size(), ":",
+                    property.property_name());
+  }
+  std::string normalized_query;
+  std::vector<FilterQueryLiteral> literals;
+  const bool lifted =
+      LiftFilterQueryLiterals(filter_query, &normalized_query, &literals);
+  const std::string lifted_key =
+      absl::StrCat(node_type, "?", normalized_query);
+  const std::string exact_key = absl::StrCat(node_type, "=", filter_query);
+  Entry entry;
+  if (lifted && Lookup(lifted_key, &entry)) {
+    Render(entry, literals, compiled);
+    return absl::OkStatus();
+  }
+  if (Lookup(exact_key, &entry)) {
+    Render(entry, literals, compiled);
+    return absl::OkStatus();
+  }
+
+  MLMD_RETURN_IF_ERROR(
+      CompileUncached<T>(std::string(filter_query), resolve_interned_strings,
+                         indexed_properties, compiled));
+  entry = Entry();
+  entry.key = exact_key;
+  entry.from_clause = compiled->from_clause;
+  entry.where_clause_parts = {compiled->where_clause};
+  entry.property_names = compiled->property_names;
+  entry.custom_property_names = compiled->custom_property_names;
+  if (!lifted) {
+    Insert(std::move(entry));
+    return absl::OkStatus();
+  }
+
+  // Compiles the filter query with sentinel literals, to find where the
+  // literals are in the generated SQL.
+  std::string probe_query;
+  std::vector<std::string> sentinel_sqls;
+  int literal_index = 0;
+  for (int i = 0; i < normalized_query.size(); i++) {
+    if (normalized_query[i] != '?') {
+      probe_query.push_back(normalized_query[i]);
+      continue;
+    }
+    const FilterQueryLiteral::Kind kind = literals[literal_index].kind;
+    absl::StrAppend(&probe_query, GetSentinelLiteral(kind, literal_index));
+    sentinel_sqls.push_back(GetSentinelSql(kind, literal_index));
+    literal_index++;
+    i++;
+  }
+  CompiledFilterQuery probe;
+  if (!CompileUncached<T>(probe_query, resolve_interned_strings,
+                          indexed_properties, &probe)
+           .ok()) {
+    Insert(std::move(entry));
+    return absl::OkStatus();
+  }
+  Entry lifted_entry;
+  lifted_entry.key = lifted_key;
+  lifted_entry.from_clause = probe.from_clause;
+  lifted_entry.property_names = probe.property_names;
+  lifted_entry.custom_property_names = probe.custom_property_names;
+  std::vector<bool> found(literals.size(), false);
+  absl::string_view rest = probe.where_clause;
+  std::string part;
+  while (!rest.empty()) {
+    int sentinel_index = -1;
+    for (int i = 0; i < sentinel_sqls.size(); i++) {
+      if (absl::StartsWith(rest, sentinel_sqls[i])) {
+        sentinel_index = i;
+        break;
+      }
+    }
+    if (sentinel_index < 0) {
+      part.push_back(rest.front());
+      rest.remove_prefix(1);
+      continue;
+    }
+    lifted_entry.where_clause_parts.push_back(std::move(part));
+    part.clear();
+    lifted_entry.literal_indices.push_back(sentinel_index);
+    found[sentinel_index] = true;
+    rest.remove_prefix(sentinel_sqls[sentinel_index].size());
+  }
+  lifted_entry.where_clause_parts.push_back(std::move(part));
+
+  // The lifted entry is only cached if it generates the same SQL as ZetaSQL
+  // does for the given literals, e.g., a literal coerced to another type is
+  // generated differently and is not lifted.
+  CompiledFilterQuery rendered;
+  Render(lifted_entry, literals, &rendered);
+  bool valid = rendered.from_clause == compiled->from_clause &&
+               rendered.where_clause == compiled->where_clause &&
+               rendered.property_names == compiled->property_names &&
+               rendered.custom_property_names ==
+                   compiled->custom_property_names;
+  for (int i = 0; i < sentinel_sqls.size(); i++) {
+    valid = valid && found[i] &&
+            !absl::StrContains(probe.from_clause, sentinel_sqls[i]);
+  }
+  Insert(valid ? std::move(lifted_entry) : std::move(entry));
+  return absl::OkStatus();
+}
+
+int FilterQueryCache::size() const {
+  absl::MutexLock lock(&mu_);
+  return entries_.size();
+}
+
+void FilterQueryCache::Render(const Entry& entry,
+                              const std::vector<FilterQueryLiteral>& literals,
+                              CompiledFilterQuery* compiled) {
+  compiled->from_clause = entry.from_clause;
+  compiled->where_clause = entry.where_clause_parts[0];
+  compiled->property_names = entry.property_names;
+  compiled->custom_property_names = entry.custom_property_names;
+  for (int i = 0; i < entry.literal_indices.size(); i++) {
+    absl::StrAppend(&compiled->where_clause,
+                    literals[entry.literal_indices[i]].sql,
+                    entry.where_clause_parts[i + 1]);
+  }
+}
+
+bool FilterQueryCache::Lookup(const std::string& key, Entry* entry) {
+  absl::MutexLock lock(&mu_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return false;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  *entry = *it->second;
+  return true;
+}
+
+void FilterQueryCache::Insert(Entry entry) {
+  absl::MutexLock lock(&mu_);
+  auto it = index_.find(entry.key);
+  if (it != index_.end()) {
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  entries_.push_front(std::move(entry));
+  index_[entries_.front().key] = entries_.begin();
+  if (entries_.size() > capacity_) {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+}
+
+// Explicit template instantiation for supported node types.
+template absl::Status FilterQueryCache::Compile<Artifact>(
+    absl::string_view filter_query, CompiledFilterQuery* compiled,
+    bool resolve_interned_strings,
+    absl::Span<const IndexedProperty> indexed_properties);
+template absl::Status FilterQueryCache::Compile<Execution>(
+    absl::string_view filter_query, CompiledFilterQuery* compiled,
+    bool resolve_interned_strings,
+    absl::Span<const IndexedProperty> indexed_properties);
+template absl::Status FilterQueryCache::Compile<Context>(
+    absl::string_view filter_query, CompiledFilterQuery* compiled,
+    bool resolve_interned_strings,
+    absl::Span<const IndexedProperty> indexed_properties);
+
+}  // namespace ml_metadata
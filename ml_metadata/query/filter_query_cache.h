@@ -0,0 +1,139 @@
+/* Copyright 2020 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef ML_METADATA_GOOGLE_QUERY_FILTER_QUERY_CACHE_H
+#define ML_METADATA_GOOGLE_QUERY_FILTER_QUERY_CACHE_H
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+
+namespace ml_metadata {
+
+// The SQL fragments generated by FilterQueryBuilder for a filter query.
+struct CompiledFilterQuery {
+  std::string from_clause;
+  std::string where_clause;
+  // The names of the properties and the custom properties of the node compared
+  // by the filter query.
+  std::vector<std::string> property_names;
+  std::vector<std::string> custom_property_names;
+};
+
+// A string or integer literal lifted out of a filter query.
+struct FilterQueryLiteral {
+  enum class Kind { kString, kInt64 };
+  Kind kind;
+  // The literal in the SQL generated by FilterQueryBuilder, e.g., "foo" or 1.
+  std::string sql;
+};
+
+// Replaces the string and integer literals in `filter_query` with markers, and
+// collapses the whitespaces outside of the literals and quoted identifiers, so
+// that the filter queries differing only in constants have the same
+// `normalized_query`. The lifted literals are appended to `literals` in order.
+// Returns false if the literals of the filter query cannot be lifted, e.g., it
+// has raw or bytes literals.
+bool LiftFilterQueryLiterals(absl::string_view filter_query,
+                             std::string* normalized_query,
+                             std::vector<FilterQueryLiteral>* literals);
+
+// An LRU cache of compiled filter queries, which avoids the ZetaSQL analysis
+// and the SQL rewrite of the filter queries that have been seen before. The
+// entries are keyed by the node type and the normalized filter query, and the
+// literals are lifted out as parameters, so that the filter queries differing
+// only in constants share an entry. It is thread-safe.
+//
+// Usage example:
+//
+//    CompiledFilterQuery compiled;
+//    MLMD_RETURN_IF_ERROR(FilterQueryCache::GetDefault()->Compile<Artifact>(
+//        "uri = 'abc' AND type_id = 1", &compiled));
+//    // uses compiled.from_clause and compiled.where_clause in a SQL query.
+class FilterQueryCache {
+ public:
+  // Creates a cache keeping the `capacity` most recently used entries.
+  // Check-fails if the capacity is not positive.
+  explicit FilterQueryCache(int capacity);
+
+  // Not copyable or movable
+  FilterQueryCache(const FilterQueryCache&) = delete;
+  FilterQueryCache& operator=(const FilterQueryCache&) = delete;
+
+  // Returns the cache shared in the process.
+  static FilterQueryCache* GetDefault();
+
+  // Compiles `filter_query` on the node type T (Artifact, Execution or
+  // Context) to `compiled`, reusing the cached entry if any. If
+  // `resolve_interned_strings` is set, the property filters compare the
+  // string values interned in the PropertyStringValue table, as
+  // FilterQueryBuilder describes. The filters of the `indexed_properties` are
+  // routed to their dedicated indices.
+  // Returns InvalidArgument error if the filter query is invalid.
+  // Returns Internal error if the SQL cannot be generated.
+  template <typename T>
+  absl::Status Compile(
+      absl::string_view filter_query, CompiledFilterQuery* compiled,
+      bool resolve_interned_strings = false,
+      absl::Span<const IndexedProperty> indexed_properties = {});
+
+  // Returns the number of cached entries.
+  int size() const;
+
+ private:
+  // A compiled filter query, whose WHERE clause is split at the literals of
+  // the filter query. The literal `literal_indices[i]` goes between
+  // `where_clause_parts[i]` and `where_clause_parts[i + 1]`.
+  struct Entry {
+    std::string key;
+    std::string from_clause;
+    std::vector<std::string> where_clause_parts;
+    std::vector<int> literal_indices;
+    std::vector<std::string> property_names;
+    std::vector<std::string> custom_property_names;
+  };
+
+  // Renders the compiled filter query of `entry` with the `literals`.
+  static void Render(const Entry& entry,
+                     const std::vector<FilterQueryLiteral>& literals,
+                     CompiledFilterQuery* compiled);
+
+  // Copies the entry of `key` to `entry` and marks it as the most recently
+  // used one. Returns false if there is no entry of `key`.
+  bool Lookup(const std::string& key, Entry* entry);
+
+  // Inserts `entry`, and evicts the least recently used entry if the cache is
+  // full.
+  void Insert(Entry entry);
+
+  const int capacity_;
+
+  mutable absl::Mutex mu_;
+  // The entries ordered by their last use, the most recent first.
+  std::list<Entry> entries_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, std::list<Entry>::iterator> index_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace ml_metadata
+
+#endif  // ML_METADATA_GOOGLE_QUERY_FILTER_QUERY_CACHE_H
@@ -0,0 +1,145 @@
+/* Copyright 2020 Google LLC
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    https://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "ml_metadata/query/filter_query_cache.h"
+
+#include <string>
+#include <vector>
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "ml_metadata/proto/metadata_store.pb.h"
+#include "ml_metadata/query/filter_query_ast_resolver.h"
+#include "ml_metadata/query/filter_query_builder.h"
+
+namespace ml_metadata {
+namespace {
+
+// Compiles the filter query without the cache.
+template <typename T>
+CompiledFilterQuery CompileWithoutCache(const std::string& filter_query) {
+  FilterQueryAstResolver<T> ast_resolver(filter_query);
+  CHECK_EQ(absl::OkStatus(), ast_resolver.Resolve());
+  FilterQueryBuilder<T> query_builder;
+  CHECK_EQ(absl::OkStatus(), ast_resolver.GetAst()->Accept(&query_builder));
+  return {query_builder.GetFromClause(), query_builder.GetWhereClause()};
+}
+
+TEST(LiftFilterQueryLiteralsTest, LiftsStringAndIntegerLiterals) {
+  std::string normalized_query;
+  std::vector<FilterQueryLiteral> literals;
+  ASSERT_TRUE(LiftFilterQueryLiterals("uri = 'abc'  AND\ttype_id = 1",
+                                      &normalized_query, &literals));
+  EXPECT_EQ(normalized_query, "uri = ?s AND type_id = ?i");
+  ASSERT_EQ(literals.size(), 2);
+  EXPECT_EQ(literals[0].kind, FilterQueryLiteral::Kind::kString);
+  EXPECT_EQ(literals[0].sql, "\"abc\"");
+  EXPECT_EQ(literals[1].kind, FilterQueryLiteral::Kind::kInt64);
+  EXPECT_EQ(literals[1].sql, "1");
+}
+
+TEST(LiftFilterQueryLiteralsTest, KeepsIdentifiersAndFloats) {
+  std::string normalized_query;
+  std::vector<FilterQueryLiteral> literals;
+  ASSERT_TRUE(LiftFilterQueryLiterals(
+      "properties.p1.double_value > 1.5 AND `c 1`.name = 'x'",
+      &normalized_query, &literals));
+  EXPECT_EQ(normalized_query,
+            "properties.p1.double_value > 1.5 AND `c 1`.name = ?s");
+  EXPECT_EQ(literals.size(), 1);
+}
+
+TEST(LiftFilterQueryLiteralsTest, RejectsRawLiterals) {
+  std::string normalized_query;
+  std::vector<FilterQueryLiteral> literals;
+  EXPECT_FALSE(
+      LiftFilterQueryLiterals("uri = r'abc'", &normalized_query, &literals));
+}
+
+TEST(FilterQueryCacheTest, SharesEntryForDifferentConstants) {
+  FilterQueryCache cache(/*capacity=*/10);
+  for (const std::string filter_query :
+       {"uri = 'abc' AND type_id = 1", "uri = 'xyz'   AND type_id = 20",
+        "uri = \"f\" AND type_id = 300"}) {
+    CompiledFilterQuery compiled;
+    ASSERT_EQ(absl::OkStatus(),
+              cache.Compile<Artifact>(filter_query, &compiled));
+    const CompiledFilterQuery expected =
+        CompileWithoutCache<Artifact>(filter_query);
+    EXPECT_EQ(compiled.from_clause, expected.from_clause);
+    EXPECT_EQ(compiled.where_clause, expected.where_clause);
+  }
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(FilterQueryCacheTest, KeysEntriesByNodeType) {
+  FilterQueryCache cache(/*capacity=*/10);
+  CompiledFilterQuery compiled;
+  ASSERT_EQ(absl::OkStatus(), cache.Compile<Artifact>("id = 1", &compiled));
+  ASSERT_EQ(absl::OkStatus(), cache.Compile<Execution>("id = 2", &compiled));
+  const CompiledFilterQuery expected = CompileWithoutCache<Execution>("id = 2");
+  EXPECT_EQ(compiled.from_clause, expected.from_clause);
+  EXPECT_EQ(compiled.where_clause, expected.where_clause);
+  EXPECT_EQ(cache.size(), 2);
+}
+
+TEST(FilterQueryCacheTest, ReturnsTheComparedPropertyNames) {
+  FilterQueryCache cache(/*capacity=*/10);
+  // The second query is rendered from the entry of the first one.
+  for (const std::string filter_query :
+       {"properties.p1.int_value = 1 AND custom_properties.p2.string_value = "
+        "'a' AND properties.p1.int_value < 5 AND uri = 'b'",
+        "properties.p1.int_value = 2 AND custom_properties.p2.string_value = "
+        "'c' AND properties.p1.int_value < 6 AND uri = 'd'"}) {
+    CompiledFilterQuery compiled;
+    ASSERT_EQ(absl::OkStatus(),
+              cache.Compile<Artifact>(filter_query, &compiled));
+    EXPECT_EQ(compiled.property_names, std::vector<std::string>({"p1"}));
+    EXPECT_EQ(compiled.custom_property_names,
+              std::vector<std::string>({"p2"}));
+  }
+  EXPECT_EQ(cache.size(), 1);
+  CompiledFilterQuery compiled;
+  ASSERT_EQ(absl::OkStatus(), cache.Compile<Artifact>("id = 1", &compiled));
+  EXPECT_TRUE(compiled.property_names.empty());
+  EXPECT_TRUE(compiled.custom_property_names.empty());
+}
+
+TEST(FilterQueryCacheTest, InvalidFilterQuery) {
+  FilterQueryCache cache(/*capacity=*/10);
+  CompiledFilterQuery compiled;
+  EXPECT_TRUE(absl::IsInvalidArgument(
+      cache.Compile<Artifact>("invalid_column = 1", &compiled)));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(FilterQueryCacheTest, EvictsLeastRecentlyUsedEntry) {
+  FilterQueryCache cache(/*capacity=*/2);
+  CompiledFilterQuery compiled;
+  ASSERT_EQ(absl::OkStatus(), cache.Compile<Artifact>("id = 1", &compiled));
+  ASSERT_EQ(absl::OkStatus(), cache.Compile<Artifact>("uri = 'a'", &compiled));
+  // Uses the `id` entry, so that the `uri` entry is evicted.
+  ASSERT_EQ(absl::OkStatus(), cache.Compile<Artifact>("id = 2", &compiled));
+  ASSERT_EQ(absl::OkStatus(),
+            cache.Compile<Artifact>("type_id = 1", &compiled));
+  EXPECT_EQ(cache.size(), 2);
+  const CompiledFilterQuery expected = CompileWithoutCache<Artifact>("id = 3");
+  ASSERT_EQ(absl::OkStatus(), cache.Compile<Artifact>("id = 3", &compiled));
+  EXPECT_EQ(compiled.where_clause, expected.where_clause);
+  EXPECT_EQ(cache.size(), 2);
+}
+
+}  // namespace
+}  // namespace ml_metadata
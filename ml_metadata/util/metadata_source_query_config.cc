@@ -28,7 +28,7 @@ namespace {
 // no-lint to support vc (C2026) 16380 max length for char[].
 const std::string kBaseQueryConfig = absl::StrCat(  // NOLINT
 R"pb(
-  schema_version: 8
+  schema_version: 20
   drop_type_table { query: " DROP TABLE IF EXISTS `Type`; " }
   create_type_table {
     query: " CREATE TABLE IF NOT EXISTS `Type` ( "
@@ -65,6 +65,13 @@ R"pb(
            ") VALUES($0, 2, $1, $2);"
     parameter_num: 3
   }
+  insert_types {
+    query: " INSERT INTO `Type`( "
+           "   `name`, `type_kind`, `version`, `description`, "
+           "   `input_type`, `output_type` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
   select_types_by_id {
     query: " SELECT `id`, `name`, `version`, `description` "
            " FROM `Type` "
@@ -89,6 +96,12 @@ R"pb(
            " WHERE name = $0 AND version = $1 AND type_kind = $2; "
     parameter_num: 3
   }
+  select_types_by_names {
+    query: " SELECT `id`, `name`, `version`, `description`, "
+           "        `input_type`, `output_type` FROM `Type` "
+           " WHERE name IN ($0) AND type_kind = $1; "
+    parameter_num: 2
+  }
   select_all_types {
     query: " SELECT `id`, `name`, `version`, `description`, "
            "        `input_type`, `output_type` FROM `Type` "
@@ -147,7 +160,32 @@ R"pb(
            " WHERE `type_id` = $0; "
     parameter_num: 1
   }
+  insert_type_properties {
+    query: " INSERT INTO `TypeProperty`( "
+           "   `type_id`, `name`, `data_type` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  select_properties_by_type_ids {
+    query: " SELECT `type_id`, `name`, `data_type` "
+           " FROM `TypeProperty` "
+           " WHERE `type_id` IN ($0); "
+    parameter_num: 1
+  }
   select_last_insert_id { query: " SELECT last_insert_rowid(); " }
+  select_last_insert_id_range {
+    query: " SELECT last_insert_rowid() - $0 + 1, last_insert_rowid(); "
+    parameter_num: 1
+  }
+  # last_insert_rowid() is not changed by an ignored insert.
+  select_last_upsert_id {
+    query: " SELECT CASE WHEN changes() > 0 THEN last_insert_rowid() END, "
+           "        changes(); "
+  }
+  select_id_set {
+    query: " SELECT `value` FROM json_each($0) "
+    parameter_num: 1
+  }
 )pb",
 R"pb(
   drop_artifact_table { query: " DROP TABLE IF EXISTS `Artifact`; " }
@@ -175,6 +213,21 @@ R"pb(
            ") VALUES($0, $1, $2, $3, $4, $5);"
     parameter_num: 6
   }
+  insert_artifacts {
+    query: " INSERT INTO `Artifact`( "
+           "   `type_id`, `uri`, `state`, `name`, `create_time_since_epoch`, "
+           "   `last_update_time_since_epoch` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  insert_artifact_if_not_exist {
+    query: " INSERT INTO `Artifact`( "
+           "   `type_id`, `uri`, `state`, `name`, `create_time_since_epoch`, "
+           "   `last_update_time_since_epoch` "
+           ") VALUES($0, $1, $2, $3, $4, $5) "
+           " ON CONFLICT(`type_id`, `name`) DO NOTHING;"
+    parameter_num: 6
+  }
   select_artifact_by_id {
     query: " SELECT `id`, `type_id`, `uri`, `state`, `name`, "
            "        `create_time_since_epoch`, `last_update_time_since_epoch` "
@@ -194,10 +247,19 @@ R"pb(
     query: " SELECT `id` from `Artifact` WHERE `uri` = $0; "
     parameter_num: 1
   }
+  select_artifact_last_update_times {
+    query: " SELECT `id`, `last_update_time_since_epoch` FROM `Artifact` "
+           " WHERE `id` IN ($0); "
+    parameter_num: 1
+  }
+  # The last_update_time_since_epoch increases with every update, even if the
+  # updates are within the same millisecond.
   update_artifact {
     query: " UPDATE `Artifact` "
            " SET `type_id` = $1, `uri` = $2, `state` = $3, "
-           "     `last_update_time_since_epoch` = $4 "
+           "     `last_update_time_since_epoch` = CASE "
+           "       WHEN $4 > `last_update_time_since_epoch` THEN $4 "
+           "       ELSE `last_update_time_since_epoch` + 1 END "
            " WHERE id = $0;"
     parameter_num: 5
   }
@@ -213,6 +275,9 @@ R"pb(
            "   `double_value` DOUBLE, "
            "   `string_value` TEXT, "
            "   `byte_value` BLOB, "
+           "   `proto_value` BLOB, "
+           "   `string_value_id` INT, "
+           "   `compressed_value` BLOB, "
            " PRIMARY KEY (`artifact_id`, `name`, `is_custom_property`)); "
   }
   check_artifact_property_table {
@@ -226,6 +291,13 @@ R"pb(
            ") VALUES($1, $2, $3, $4);"
     parameter_num: 5
   }
+  insert_artifact_properties {
+    query: " INSERT INTO `ArtifactProperty`( "
+           "   `artifact_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
   select_artifact_property_by_artifact_id {
     query: " SELECT `artifact_id` as `id`, `name` as `key`, "
            "        `is_custom_property`, "
@@ -234,6 +306,37 @@ R"pb(
            " WHERE `artifact_id` IN ($0); "
     parameter_num: 1
   }
+  select_artifact_property_by_artifact_id_and_name {
+    query: " SELECT `artifact_id` as `id`, `name` as `key`, "
+           "        `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value` "
+           " from `ArtifactProperty` "
+           " WHERE `artifact_id` IN ($0) AND `name` IN ($1); "
+    parameter_num: 2
+  }
+  insert_artifact_properties_with_proto_value {
+    query: " INSERT INTO `ArtifactProperty`( "
+           "   `artifact_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value`, `proto_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  select_artifact_property_with_proto_value_by_id {
+    query: " SELECT `artifact_id` as `id`, `name` as `key`, "
+           "        `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value`, `proto_value` "
+           " from `ArtifactProperty` "
+           " WHERE `artifact_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_artifact_property_with_proto_value_by_id_and_name {
+    query: " SELECT `artifact_id` as `id`, `name` as `key`, "
+           "        `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value`, `proto_value` "
+           " from `ArtifactProperty` "
+           " WHERE `artifact_id` IN ($0) AND `name` IN ($1); "
+    parameter_num: 2
+  }
   update_artifact_property {
     query: " UPDATE `ArtifactProperty` "
            " SET `$0` = $1 "
@@ -279,6 +382,13 @@ R"pb(
            ") VALUES($0, $1, $2, $3, $4);"
     parameter_num: 5
   }
+  insert_executions {
+    query: " INSERT INTO `Execution`( "
+           "   `type_id`, `last_known_state`, `name`, "
+           "   `create_time_since_epoch`, `last_update_time_since_epoch` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
   select_execution_by_id {
     query: " SELECT `id`, `type_id`, `last_known_state`, `name`, "
            "        `create_time_since_epoch`, `last_update_time_since_epoch` "
@@ -294,6 +404,11 @@ R"pb(
     query: " SELECT `id` from `Execution` WHERE `type_id` = $0; "
     parameter_num: 1
   }
+  select_active_executions_by_type_id {
+    query: " SELECT `id` from `Execution` "
+           " WHERE `type_id` = $0 AND `last_known_state` IN (1, 2); "
+    parameter_num: 1
+  }
   update_execution {
     query: " UPDATE `Execution` "
            " SET `type_id` = $1, `last_known_state` = $2, "
@@ -313,6 +428,9 @@ R"pb(
            "   `double_value` DOUBLE, "
            "   `string_value` TEXT, "
            "   `byte_value` BLOB, "
+           "   `proto_value` BLOB, "
+           "   `string_value_id` INT, "
+           "   `compressed_value` BLOB, "
            " PRIMARY KEY (`execution_id`, `name`, `is_custom_property`)); "
   }
   check_execution_property_table {
@@ -326,6 +444,13 @@ R"pb(
            ") VALUES($1, $2, $3, $4);"
     parameter_num: 5
   }
+  insert_execution_properties {
+    query: " INSERT INTO `ExecutionProperty`( "
+           "   `execution_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
   select_execution_property_by_execution_id {
     query: " SELECT `execution_id` as `id`, `name` as `key`, "
            "        `is_custom_property`, "
@@ -334,6 +459,37 @@ R"pb(
            " WHERE `execution_id` IN ($0); "
     parameter_num: 1
   }
+  select_execution_property_by_execution_id_and_name {
+    query: " SELECT `execution_id` as `id`, `name` as `key`, "
+           "        `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value` "
+           " from `ExecutionProperty` "
+           " WHERE `execution_id` IN ($0) AND `name` IN ($1); "
+    parameter_num: 2
+  }
+  insert_execution_properties_with_proto_value {
+    query: " INSERT INTO `ExecutionProperty`( "
+           "   `execution_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value`, `proto_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  select_execution_property_with_proto_value_by_id {
+    query: " SELECT `execution_id` as `id`, `name` as `key`, "
+           "        `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value`, `proto_value` "
+           " from `ExecutionProperty` "
+           " WHERE `execution_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_execution_property_with_proto_value_by_id_and_name {
+    query: " SELECT `execution_id` as `id`, `name` as `key`, "
+           "        `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value`, `proto_value` "
+           " from `ExecutionProperty` "
+           " WHERE `execution_id` IN ($0) AND `name` IN ($1); "
+    parameter_num: 2
+  }
   update_execution_property {
     query: " UPDATE `ExecutionProperty` "
            " SET `$0` = $1 "
@@ -378,6 +534,21 @@ R"pb(
            ") VALUES($0, $1, $2, $3);"
     parameter_num: 4
   }
+  insert_contexts {
+    query: " INSERT INTO `Context`( "
+           "   `type_id`, `name`, "
+           "   `create_time_since_epoch`, `last_update_time_since_epoch` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  insert_context_if_not_exist {
+    query: " INSERT INTO `Context`( "
+           "   `type_id`, `name`, "
+           "   `create_time_since_epoch`, `last_update_time_since_epoch` "
+           ") VALUES($0, $1, $2, $3) "
+           " ON CONFLICT(`type_id`, `name`) DO NOTHING;"
+    parameter_num: 4
+  }
   select_context_by_id {
     query: " SELECT `id`, `type_id`, `name`, `create_time_since_epoch`, "
            "        `last_update_time_since_epoch`"
@@ -411,6 +582,9 @@ R"pb(
            "   `double_value` DOUBLE, "
            "   `string_value` TEXT, "
            "   `byte_value` BLOB, "
+           "   `proto_value` BLOB, "
+           "   `string_value_id` INT, "
+           "   `compressed_value` BLOB, "
            " PRIMARY KEY (`context_id`, `name`, `is_custom_property`)); "
   }
   check_context_property_table {
@@ -424,6 +598,13 @@ R"pb(
            ") VALUES($1, $2, $3, $4);"
     parameter_num: 5
   }
+  insert_context_properties {
+    query: " INSERT INTO `ContextProperty`( "
+           "   `context_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
   select_context_property_by_context_id {
     query: " SELECT `context_id` as `id`, `name` as `key`, "
            "        `is_custom_property`, "
@@ -432,6 +613,37 @@ R"pb(
            " WHERE `context_id` IN ($0); "
     parameter_num: 1
   }
+  select_context_property_by_context_id_and_name {
+    query: " SELECT `context_id` as `id`, `name` as `key`, "
+           "        `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value` "
+           " from `ContextProperty` "
+           " WHERE `context_id` IN ($0) AND `name` IN ($1); "
+    parameter_num: 2
+  }
+  insert_context_properties_with_proto_value {
+    query: " INSERT INTO `ContextProperty`( "
+           "   `context_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value`, `proto_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  select_context_property_with_proto_value_by_id {
+    query: " SELECT `context_id` as `id`, `name` as `key`, "
+           "        `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value`, `proto_value` "
+           " from `ContextProperty` "
+           " WHERE `context_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_context_property_with_proto_value_by_id_and_name {
+    query: " SELECT `context_id` as `id`, `name` as `key`, "
+           "        `is_custom_property`, "
+           "        `int_value`, `double_value`, `string_value`, `proto_value` "
+           " from `ContextProperty` "
+           " WHERE `context_id` IN ($0) AND `name` IN ($1); "
+    parameter_num: 2
+  }
   update_context_property {
     query: " UPDATE `ContextProperty` "
            " SET `$0` = $1 "
@@ -472,6 +684,36 @@ R"pb(
            " WHERE `parent_context_id` = $0; "
     parameter_num: 1
   }
+  select_ancestor_context_ids {
+    query: " WITH RECURSIVE `AncestorContext`(`id`, `depth`) AS ( "
+           "   SELECT `parent_context_id`, 1 FROM `ParentContext` "
+           "   WHERE `context_id` = $0 "
+           "   UNION "
+           "   SELECT `P`.`parent_context_id`, `A`.`depth` + 1 "
+           "   FROM `AncestorContext` AS `A` JOIN `ParentContext` AS `P` "
+           "     ON `P`.`context_id` = `A`.`id` "
+           "   WHERE `A`.`depth` < $1 "
+           " ) "
+           " SELECT `id`, MIN(`depth`) AS `min_depth` "
+           " FROM `AncestorContext` GROUP BY `id` "
+           " ORDER BY `min_depth`, `id`; "
+    parameter_num: 2
+  }
+  select_descendant_context_ids {
+    query: " WITH RECURSIVE `DescendantContext`(`id`, `depth`) AS ( "
+           "   SELECT `context_id`, 1 FROM `ParentContext` "
+           "   WHERE `parent_context_id` = $0 "
+           "   UNION "
+           "   SELECT `P`.`context_id`, `D`.`depth` + 1 "
+           "   FROM `DescendantContext` AS `D` JOIN `ParentContext` AS `P` "
+           "     ON `P`.`parent_context_id` = `D`.`id` "
+           "   WHERE `D`.`depth` < $1 "
+           " ) "
+           " SELECT `id`, MIN(`depth`) AS `min_depth` "
+           " FROM `DescendantContext` GROUP BY `id` "
+           " ORDER BY `min_depth`, `id`; "
+    parameter_num: 2
+  }
   delete_contexts_by_id {
     query: "DELETE FROM `Context` WHERE `id` IN ($0); "
     parameter_num: 1
@@ -498,6 +740,7 @@ R"pb(
            "   `execution_id` INT NOT NULL, "
            "   `type` INT NOT NULL, "
            "   `milliseconds_since_epoch` INT, "
+           "   `path` TEXT, "
            "   UNIQUE(`artifact_id`, `execution_id`, `type`) "
            " ); "
   }
@@ -513,6 +756,13 @@ R"pb(
            ") VALUES($0, $1, $2, $3);"
     parameter_num: 4
   }
+  insert_events {
+    query: " INSERT INTO `Event`( "
+           "   `artifact_id`, `execution_id`, `type`, "
+           "   `milliseconds_since_epoch` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
   select_event_by_artifact_ids {
     query: " SELECT `id`, `artifact_id`, `execution_id`, "
            "        `type`, `milliseconds_since_epoch` "
@@ -527,6 +777,48 @@ R"pb(
            " WHERE `execution_id` IN ($0); "
     parameter_num: 1
   }
+  insert_events_with_path {
+    query: " INSERT INTO `Event`( "
+           "   `artifact_id`, `execution_id`, `type`, "
+           "   `milliseconds_since_epoch`, `path` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  select_events_with_path_by_artifact_ids {
+    query: " SELECT `id`, `artifact_id`, `execution_id`, "
+           "        `type`, `milliseconds_since_epoch`, `path` "
+           " from `Event` "
+           " WHERE `artifact_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_events_with_path_by_execution_ids {
+    query: " SELECT `id`, `artifact_id`, `execution_id`, "
+           "        `type`, `milliseconds_since_epoch`, `path` "
+           " from `Event` "
+           " WHERE `execution_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_lineage_graph_node_distances {
+    query: " WITH RECURSIVE `LineageGraph`(`is_artifact`, `id`, `distance`) "
+           " AS ( "
+           "   SELECT 1, `id`, 0 FROM `Artifact` WHERE `id` IN ($0) "
+           "   UNION "
+           "   SELECT 1 - `L`.`is_artifact`, "
+           "          CASE WHEN `L`.`is_artifact` = 1 "
+           "               THEN `E`.`execution_id` "
+           "               ELSE `E`.`artifact_id` END, "
+           "          `L`.`distance` + 1 "
+           "   FROM `LineageGraph` AS `L` JOIN `Event` AS `E` "
+           "     ON (`L`.`is_artifact` = 1 AND `E`.`artifact_id` = `L`.`id`) "
+           "     OR (`L`.`is_artifact` = 0 AND `E`.`execution_id` = `L`.`id`) "
+           "   WHERE `L`.`distance` < $1 "
+           " ) "
+           " SELECT `is_artifact`, `id`, MIN(`distance`) AS `min_distance` "
+           " FROM `LineageGraph` GROUP BY `is_artifact`, `id` "
+           " ORDER BY `min_distance`, `is_artifact`, `id` "
+           " LIMIT $2; "
+    parameter_num: 3
+  }
   drop_event_path_table { query: " DROP TABLE IF EXISTS `EventPath`; " }
   create_event_path_table {
     query: " CREATE TABLE IF NOT EXISTS `EventPath` ( "
@@ -546,6 +838,12 @@ R"pb(
            ") VALUES($0, $2, $3);"
     parameter_num: 4
   }
+  insert_event_paths {
+    query: " INSERT INTO `EventPath`( "
+           "   `event_id`, `is_index_step`, `step_index`, `step_key` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
   select_event_path_by_event_ids {
     query: " SELECT `event_id`, `is_index_step`, `step_index`, `step_key` "
            " from `EventPath` "
@@ -564,116 +862,720 @@ R"pb(
     query: "DELETE FROM `EventPath` WHERE `event_id` NOT IN "
            " (SELECT `id` FROM `Event`); "
   }
-)pb",
-R"pb(
-  drop_association_table { query: " DROP TABLE IF EXISTS `Association`; " }
-  create_association_table {
-    query: " CREATE TABLE IF NOT EXISTS `Association` ( "
-           "   `id` INTEGER PRIMARY KEY AUTOINCREMENT, "
-           "   `context_id` INT NOT NULL, "
+  delete_event_paths_by_artifacts_id {
+    query: "DELETE FROM `EventPath` WHERE `event_id` IN "
+           " (SELECT `id` FROM `Event` WHERE `artifact_id` IN ($0)); "
+    parameter_num: 1
+  }
+  delete_event_paths_by_executions_id {
+    query: "DELETE FROM `EventPath` WHERE `event_id` IN "
+           " (SELECT `id` FROM `Event` WHERE `execution_id` IN ($0)); "
+    parameter_num: 1
+  }
+  drop_artifact_derivation_table {
+    query: " DROP TABLE IF EXISTS `ArtifactDerivation`; "
+  }
+  create_artifact_derivation_table {
+    query: " CREATE TABLE IF NOT EXISTS `ArtifactDerivation` ( "
+           "   `upstream_artifact_id` INT NOT NULL, "
+           "   `downstream_artifact_id` INT NOT NULL, "
            "   `execution_id` INT NOT NULL, "
-           "   UNIQUE(`context_id`, `execution_id`) "
+           "   PRIMARY KEY(`upstream_artifact_id`, `downstream_artifact_id`, "
+           "               `execution_id`) "
            " ); "
   }
-  check_association_table {
-    query: " SELECT `id`, `context_id`, `execution_id` "
-           " FROM `Association` LIMIT 1; "
+  check_artifact_derivation_table {
+    query: " SELECT `upstream_artifact_id`, `downstream_artifact_id`, "
+           "        `execution_id` "
+           " FROM `ArtifactDerivation` LIMIT 1; "
+  }
+  # The input event types are DECLARED_INPUT, INPUT and INTERNAL_INPUT, and
+  # the output event types are DECLARED_OUTPUT, OUTPUT and INTERNAL_OUTPUT.
+  insert_artifact_derivations {
+    query: " INSERT OR IGNORE INTO `ArtifactDerivation`( "
+           "   `upstream_artifact_id`, `downstream_artifact_id`, "
+           "   `execution_id` "
+           " ) "
+           " SELECT `E`.`artifact_id`, `O`.`artifact_id`, `E`.`execution_id` "
+           " FROM `Event` AS `E` JOIN `Event` AS `O` "
+           "   ON `O`.`execution_id` = `E`.`execution_id` "
+           " WHERE `E`.`id` IN ($0) AND `E`.`type` IN (2, 3, 5) AND "
+           "       `O`.`type` IN (1, 4, 6) AND "
+           "       `O`.`artifact_id` != `E`.`artifact_id` "
+           " UNION ALL "
+           " SELECT `I`.`artifact_id`, `E`.`artifact_id`, `E`.`execution_id` "
+           " FROM `Event` AS `E` JOIN `Event` AS `I` "
+           "   ON `I`.`execution_id` = `E`.`execution_id` "
+           " WHERE `E`.`id` IN ($0) AND `E`.`type` IN (1, 4, 6) AND "
+           "       `I`.`type` IN (2, 3, 5) AND "
+           "       `I`.`artifact_id` != `E`.`artifact_id`; "
+    parameter_num: 1
   }
-  insert_association {
-    query: " INSERT INTO `Association`( "
-           "   `context_id`, `execution_id` "
-           ") VALUES($0, $1);"
-    parameter_num: 2
+  select_upstream_artifact_distances {
+    query: " WITH RECURSIVE `Upstream`(`id`, `distance`) AS ( "
+           "   SELECT `id`, 0 FROM `Artifact` WHERE `id` IN ($0) "
+           "   UNION "
+           "   SELECT `D`.`upstream_artifact_id`, `U`.`distance` + 1 "
+           "   FROM `Upstream` AS `U` JOIN `ArtifactDerivation` AS `D` "
+           "     ON `D`.`downstream_artifact_id` = `U`.`id` "
+           "   WHERE `U`.`distance` < $1 AND "
+           "         ($2 = 0 OR `D`.`execution_id` IN ( "
+           "            SELECT `execution_id` FROM `Association` "
+           "            WHERE `context_id` = $2)) "
+           " ) "
+           " SELECT `id`, MIN(`distance`) AS `min_distance` "
+           " FROM `Upstream` WHERE `distance` > 0 GROUP BY `id` "
+           " ORDER BY `min_distance`, `id`; "
+    parameter_num: 3
   }
-  select_association_by_context_id {
-    query: " SELECT `id`, `context_id`, `execution_id` "
-           " from `Association` "
-           " WHERE `context_id` IN ($0); "
+  select_downstream_artifact_distances {
+    query: " WITH RECURSIVE `Downstream`(`id`, `distance`) AS ( "
+           "   SELECT `id`, 0 FROM `Artifact` WHERE `id` IN ($0) "
+           "   UNION "
+           "   SELECT `D`.`downstream_artifact_id`, `U`.`distance` + 1 "
+           "   FROM `Downstream` AS `U` JOIN `ArtifactDerivation` AS `D` "
+           "     ON `D`.`upstream_artifact_id` = `U`.`id` "
+           "   WHERE `U`.`distance` < $1 AND "
+           "         ($2 = 0 OR `D`.`execution_id` IN ( "
+           "            SELECT `execution_id` FROM `Association` "
+           "            WHERE `context_id` = $2)) "
+           " ) "
+           " SELECT `id`, MIN(`distance`) AS `min_distance` "
+           " FROM `Downstream` WHERE `distance` > 0 GROUP BY `id` "
+           " ORDER BY `min_distance`, `id`; "
+    parameter_num: 3
+  }
+  delete_artifact_derivations_by_artifacts_id {
+    query: "DELETE FROM `ArtifactDerivation` "
+           " WHERE `upstream_artifact_id` IN ($0) OR "
+           "       `downstream_artifact_id` IN ($0); "
     parameter_num: 1
   }
-  select_association_by_execution_id {
-    query: " SELECT `id`, `context_id`, `execution_id` "
-           " from `Association` "
-           " WHERE `execution_id` = $0; "
+  delete_artifact_derivations_by_executions_id {
+    query: "DELETE FROM `ArtifactDerivation` WHERE `execution_id` IN ($0); "
     parameter_num: 1
   }
-  drop_attribution_table { query: " DROP TABLE IF EXISTS `Attribution`; " }
-  create_attribution_table {
-    query: " CREATE TABLE IF NOT EXISTS `Attribution` ( "
+)pb",
+R"pb(
+  drop_change_log_table { query: " DROP TABLE IF EXISTS `ChangeLog`; " }
+  create_change_log_table {
+    query: " CREATE TABLE IF NOT EXISTS `ChangeLog` ( "
            "   `id` INTEGER PRIMARY KEY AUTOINCREMENT, "
-           "   `context_id` INT NOT NULL, "
-           "   `artifact_id` INT NOT NULL, "
-           "   UNIQUE(`context_id`, `artifact_id`) "
+           "   `kind` TINYINT NOT NULL, "
+           "   `operation` TINYINT NOT NULL, "
+           "   `artifact_id` INT, "
+           "   `execution_id` INT, "
+           "   `context_id` INT, "
+           "   `milliseconds_since_epoch` BIGINT NOT NULL "
            " ); "
   }
-  check_attribution_table {
-    query: " SELECT `id`, `context_id`, `artifact_id` "
-           " FROM `Attribution` LIMIT 1; "
+  check_change_log_table {
+    query: " SELECT `id`, `kind`, `operation`, `artifact_id`, "
+           "        `execution_id`, `context_id`, `milliseconds_since_epoch` "
+           " FROM `ChangeLog` LIMIT 1; "
   }
-  insert_attribution {
-    query: " INSERT INTO `Attribution`( "
-           "   `context_id`, `artifact_id` "
-           ") VALUES($0, $1);"
+  insert_change_log_entries {
+    query: " INSERT INTO `ChangeLog`( "
+           "   `kind`, `operation`, `artifact_id`, `execution_id`, "
+           "   `context_id`, `milliseconds_since_epoch` "
+           " ) VALUES $0; "
+    parameter_num: 1
+  }
+  select_change_log_entries {
+    query: " SELECT `id` AS `sequence_number`, `kind`, `operation`, "
+           "        `artifact_id`, `execution_id`, `context_id`, "
+           "        `milliseconds_since_epoch` "
+           " FROM `ChangeLog` WHERE `id` > $0 ORDER BY `id` LIMIT $1; "
     parameter_num: 2
   }
-  select_attribution_by_context_id {
-    query: " SELECT `id`, `context_id`, `artifact_id` "
-           " from `Attribution` "
-           " WHERE `context_id` = $0; "
-    parameter_num: 1
+  select_last_change_log_sequence_number {
+    query: " SELECT COALESCE(MAX(`id`), 0) FROM `ChangeLog`; "
   }
-  select_attribution_by_artifact_id {
-    query: " SELECT `id`, `context_id`, `artifact_id` "
-           " from `Attribution` "
-           " WHERE `artifact_id` = $0; "
-    parameter_num: 1
+  select_lineage_graph_edges {
+    query: " SELECT `id`, `artifact_id`, `execution_id` "
+           " FROM `Event` WHERE `id` > $0 ORDER BY `id` LIMIT $1; "
+    parameter_num: 2
   }
-  drop_mlmd_env_table { query: " DROP TABLE IF EXISTS `MLMDEnv`; " }
-  create_mlmd_env_table {
-    query: " CREATE TABLE IF NOT EXISTS `MLMDEnv` ( "
-           "   `schema_version` INTEGER PRIMARY KEY "
+  select_node_ids_outside_boundary {
+    query: " SELECT $0.`id` FROM $1 WHERE NOT ($2) AND $0.`id` IN ($3); "
+    parameter_num: 4
+  }
+)pb",
+R"pb(
+  drop_execution_archive_table {
+    query: " DROP TABLE IF EXISTS `ExecutionArchive`; "
+  }
+  create_execution_archive_table {
+    query: " CREATE TABLE IF NOT EXISTS `ExecutionArchive` ( "
+           "   `id` INTEGER PRIMARY KEY, "
+           "   `last_update_time_since_epoch` INT NOT NULL, "
+           "   `execution` BLOB NOT NULL "
            " ); "
   }
-  check_mlmd_env_table {
-    query: " SELECT `schema_version` FROM `MLMDEnv`; "
+  check_execution_archive_table {
+    query: " SELECT `id`, `last_update_time_since_epoch`, `execution` "
+           " FROM `ExecutionArchive` LIMIT 1; "
   }
-  insert_schema_version {
-    query: " INSERT INTO `MLMDEnv`(`schema_version`) VALUES($0); "
+  drop_event_archive_table { query: " DROP TABLE IF EXISTS `EventArchive`; " }
+  create_event_archive_table {
+    query: " CREATE TABLE IF NOT EXISTS `EventArchive` ( "
+           "   `id` INTEGER PRIMARY KEY, "
+           "   `artifact_id` INT NOT NULL, "
+           "   `execution_id` INT NOT NULL, "
+           "   `type` INT NOT NULL, "
+           "   `milliseconds_since_epoch` INT, "
+           "   `path` TEXT "
+           " ); "
+  }
+  check_event_archive_table {
+    query: " SELECT `id`, `artifact_id`, `execution_id`, "
+           "        `type`, `milliseconds_since_epoch`, `path` "
+           " FROM `EventArchive` LIMIT 1; "
+  }
+  # The NEW and RUNNING executions are still updated, so they are not
+  # archived however old they are.
+  select_cold_execution_ids {
+    query: " SELECT `id` FROM `Execution` "
+           " WHERE `last_update_time_since_epoch` <= $0 AND "
+           "       (`last_known_state` IS NULL OR "
+           "        `last_known_state` NOT IN (1, 2)) "
+           " ORDER BY `last_update_time_since_epoch`, `id` LIMIT $1; "
+    parameter_num: 2
+  }
+  insert_archived_executions {
+    query: " INSERT INTO `ExecutionArchive`( "
+           "   `id`, `last_update_time_since_epoch`, `execution` "
+           " ) VALUES $0; "
     parameter_num: 1
   }
-  update_schema_version {
-    query: " UPDATE `MLMDEnv` SET `schema_version` = $0; "
+  select_archived_executions_by_id {
+    query: " SELECT `id`, `execution` FROM `ExecutionArchive` "
+           " WHERE `id` IN ($0); "
     parameter_num: 1
   }
-  check_tables_in_v0_13_2 {
-    query: " SELECT `Type`.`is_artifact_type` from "
-           " `Artifact`, `Event`, `Execution`, `Type`, `ArtifactProperty`, "
-           " `EventPath`, `ExecutionProperty`, `TypeProperty` LIMIT 1; "
+  select_archived_executions_after_id {
+    query: " SELECT `id`, `execution` FROM `ExecutionArchive` "
+           " WHERE `id` > $0 ORDER BY `id` LIMIT $1; "
+    parameter_num: 2
   }
-  delete_associations_by_contexts_id {
-    query: "DELETE FROM `Association` WHERE `context_id` IN ($0); "
+  insert_restored_executions {
+    query: " INSERT INTO `Execution`( "
+           "   `id`, `type_id`, `last_known_state`, `name`, "
+           "   `create_time_since_epoch`, `last_update_time_since_epoch` "
+           " ) VALUES $0; "
     parameter_num: 1
   }
-  delete_associations_by_executions_id {
-    query: "DELETE FROM `Association` WHERE `execution_id` IN ($0); "
+  archive_events_by_execution_ids {
+    query: " INSERT INTO `EventArchive`( "
+           "   `id`, `artifact_id`, `execution_id`, `type`, "
+           "   `milliseconds_since_epoch`, `path` "
+           " ) "
+           " SELECT `id`, `artifact_id`, `execution_id`, `type`, "
+           "        `milliseconds_since_epoch`, `path` "
+           " FROM `Event` WHERE `execution_id` IN ($0); "
     parameter_num: 1
   }
-  delete_attributions_by_contexts_id {
-    query: "DELETE FROM `Attribution` WHERE `context_id` IN ($0); "
+  select_archived_events_by_artifact_ids {
+    query: " SELECT `id`, `artifact_id`, `execution_id`, "
+           "        `type`, `milliseconds_since_epoch`, `path` "
+           " from `EventArchive` "
+           " WHERE `artifact_id` IN ($0); "
     parameter_num: 1
   }
-  delete_attributions_by_artifacts_id {
-    query: "DELETE FROM `Attribution` WHERE `artifact_id` IN ($0); "
+  select_archived_events_by_execution_ids {
+    query: " SELECT `id`, `artifact_id`, `execution_id`, "
+           "        `type`, `milliseconds_since_epoch`, `path` "
+           " from `EventArchive` "
+           " WHERE `execution_id` IN ($0); "
     parameter_num: 1
   }
-)pb");
-
-// no-lint to support vc (C2026) 16380 max length for char[].
-const std::string kSQLiteMetadataSourceQueryConfig = absl::StrCat(  // NOLINT
-R"pb(
-  metadata_source_type: SQLITE_METADATA_SOURCE
-  # secondary indices in the current schema.
-  secondary_indices {
+  select_archived_lineage_graph_edges {
+    query: " SELECT `id`, `artifact_id`, `execution_id` "
+           " FROM `EventArchive` WHERE `id` > $0 ORDER BY `id` LIMIT $1; "
+    parameter_num: 2
+  }
+  delete_archived_executions_by_id {
+    query: "DELETE FROM `ExecutionArchive` WHERE `id` IN ($0); "
+    parameter_num: 1
+  }
+  delete_archived_events_by_artifacts_id {
+    query: "DELETE FROM `EventArchive` WHERE `artifact_id` IN ($0); "
+    parameter_num: 1
+  }
+  delete_archived_events_by_executions_id {
+    query: "DELETE FROM `EventArchive` WHERE `execution_id` IN ($0); "
+    parameter_num: 1
+  }
+)pb",
+R"pb(
+  drop_property_string_value_table {
+    query: " DROP TABLE IF EXISTS `PropertyStringValue`; "
+  }
+  create_property_string_value_table {
+    query: " CREATE TABLE IF NOT EXISTS `PropertyStringValue` ( "
+           "   `id` INTEGER PRIMARY KEY AUTOINCREMENT, "
+           "   `value` VARCHAR(255) NOT NULL, "
+           "   UNIQUE(`value`) "
+           " ); "
+  }
+  check_property_string_value_table {
+    query: " SELECT `id`, `value` FROM `PropertyStringValue` LIMIT 1; "
+  }
+  insert_property_string_values {
+    query: " INSERT OR IGNORE INTO `PropertyStringValue`(`value`) "
+           " VALUES $0; "
+    parameter_num: 1
+  }
+  select_property_string_value_ids {
+    query: " SELECT `id`, `value` FROM `PropertyStringValue` "
+           " WHERE `value` IN ($0); "
+    parameter_num: 1
+  }
+  update_property_value {
+    query: " UPDATE `$0` SET `int_value` = $1, `double_value` = $2, "
+           "     `string_value` = $3, `proto_value` = $4, "
+           "     `string_value_id` = $5, `byte_value` = $6 "
+           " WHERE `$7` = $8 AND `name` = $9; "
+    parameter_num: 10
+  }
+  update_property_value_with_compressed_value {
+    query: " UPDATE `$0` SET `int_value` = $1, `double_value` = $2, "
+           "     `string_value` = $3, `proto_value` = $4, "
+           "     `string_value_id` = $5, `compressed_value` = $6 "
+           " WHERE `$7` = $8 AND `name` = $9; "
+    parameter_num: 10
+  }
+  select_compressed_property {
+    query: " SELECT 1 FROM `$0` "
+           " WHERE `name` = $1 AND `is_custom_property` = $2 AND "
+           "       `$3` IS NOT NULL "
+           " LIMIT 1; "
+    parameter_num: 4
+  }
+  select_compressed_properties {
+    query: " SELECT `$0`, `name`, `is_custom_property`, `byte_value` "
+           " FROM `$1` WHERE `byte_value` IS NOT NULL; "
+    parameter_num: 2
+  }
+  update_property_to_decompressed_value {
+    query: " UPDATE `$0` SET `string_value` = $1, `proto_value` = $2, "
+           "     `byte_value` = NULL "
+           " WHERE `$3` = $4 AND `name` = $5 AND `is_custom_property` = $6; "
+    parameter_num: 7
+  }
+  insert_artifact_properties_with_string_value_id {
+    query: " INSERT INTO `ArtifactProperty`( "
+           "   `artifact_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value`, `proto_value`, "
+           "   `string_value_id`, `byte_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  insert_execution_properties_with_string_value_id {
+    query: " INSERT INTO `ExecutionProperty`( "
+           "   `execution_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value`, `proto_value`, "
+           "   `string_value_id`, `byte_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  insert_context_properties_with_string_value_id {
+    query: " INSERT INTO `ContextProperty`( "
+           "   `context_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value`, `proto_value`, "
+           "   `string_value_id`, `byte_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  insert_artifact_properties_with_compressed_value {
+    query: " INSERT INTO `ArtifactProperty`( "
+           "   `artifact_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value`, `proto_value`, "
+           "   `string_value_id`, `compressed_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  insert_execution_properties_with_compressed_value {
+    query: " INSERT INTO `ExecutionProperty`( "
+           "   `execution_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value`, `proto_value`, "
+           "   `string_value_id`, `compressed_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  insert_context_properties_with_compressed_value {
+    query: " INSERT INTO `ContextProperty`( "
+           "   `context_id`, `name`, `is_custom_property`, "
+           "   `int_value`, `double_value`, `string_value`, `proto_value`, "
+           "   `string_value_id`, `compressed_value` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+)pb",
+R"pb(
+  select_artifact_property_with_string_value_by_id {
+    query: " SELECT `P`.`artifact_id` as `id`, `P`.`name` as `key`, "
+           "        `P`.`is_custom_property`, "
+           "        `P`.`int_value`, `P`.`double_value`, "
+           "        COALESCE(`P`.`string_value`, `S`.`value`) "
+           "            as `string_value`, "
+           "        `P`.`proto_value`, `P`.`byte_value` "
+           " from `ArtifactProperty` AS `P` "
+           "     LEFT JOIN `PropertyStringValue` AS `S` "
+           "     ON `S`.`id` = `P`.`string_value_id` "
+           " WHERE `P`.`artifact_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_artifact_property_with_string_value_by_id_and_name {
+    query: " SELECT `P`.`artifact_id` as `id`, `P`.`name` as `key`, "
+           "        `P`.`is_custom_property`, "
+           "        `P`.`int_value`, `P`.`double_value`, "
+           "        COALESCE(`P`.`string_value`, `S`.`value`) "
+           "            as `string_value`, "
+           "        `P`.`proto_value`, `P`.`byte_value` "
+           " from `ArtifactProperty` AS `P` "
+           "     LEFT JOIN `PropertyStringValue` AS `S` "
+           "     ON `S`.`id` = `P`.`string_value_id` "
+           " WHERE `P`.`artifact_id` IN ($0) AND `P`.`name` IN ($1); "
+    parameter_num: 2
+  }
+  select_execution_property_with_string_value_by_id {
+    query: " SELECT `P`.`execution_id` as `id`, `P`.`name` as `key`, "
+           "        `P`.`is_custom_property`, "
+           "        `P`.`int_value`, `P`.`double_value`, "
+           "        COALESCE(`P`.`string_value`, `S`.`value`) "
+           "            as `string_value`, "
+           "        `P`.`proto_value`, `P`.`byte_value` "
+           " from `ExecutionProperty` AS `P` "
+           "     LEFT JOIN `PropertyStringValue` AS `S` "
+           "     ON `S`.`id` = `P`.`string_value_id` "
+           " WHERE `P`.`execution_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_execution_property_with_string_value_by_id_and_name {
+    query: " SELECT `P`.`execution_id` as `id`, `P`.`name` as `key`, "
+           "        `P`.`is_custom_property`, "
+           "        `P`.`int_value`, `P`.`double_value`, "
+           "        COALESCE(`P`.`string_value`, `S`.`value`) "
+           "            as `string_value`, "
+           "        `P`.`proto_value`, `P`.`byte_value` "
+           " from `ExecutionProperty` AS `P` "
+           "     LEFT JOIN `PropertyStringValue` AS `S` "
+           "     ON `S`.`id` = `P`.`string_value_id` "
+           " WHERE `P`.`execution_id` IN ($0) AND `P`.`name` IN ($1); "
+    parameter_num: 2
+  }
+  select_context_property_with_string_value_by_id {
+    query: " SELECT `P`.`context_id` as `id`, `P`.`name` as `key`, "
+           "        `P`.`is_custom_property`, "
+           "        `P`.`int_value`, `P`.`double_value`, "
+           "        COALESCE(`P`.`string_value`, `S`.`value`) "
+           "            as `string_value`, "
+           "        `P`.`proto_value`, `P`.`byte_value` "
+           " from `ContextProperty` AS `P` "
+           "     LEFT JOIN `PropertyStringValue` AS `S` "
+           "     ON `S`.`id` = `P`.`string_value_id` "
+           " WHERE `P`.`context_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_context_property_with_string_value_by_id_and_name {
+    query: " SELECT `P`.`context_id` as `id`, `P`.`name` as `key`, "
+           "        `P`.`is_custom_property`, "
+           "        `P`.`int_value`, `P`.`double_value`, "
+           "        COALESCE(`P`.`string_value`, `S`.`value`) "
+           "            as `string_value`, "
+           "        `P`.`proto_value`, `P`.`byte_value` "
+           " from `ContextProperty` AS `P` "
+           "     LEFT JOIN `PropertyStringValue` AS `S` "
+           "     ON `S`.`id` = `P`.`string_value_id` "
+           " WHERE `P`.`context_id` IN ($0) AND `P`.`name` IN ($1); "
+    parameter_num: 2
+  }
+)pb",
+R"pb(
+  select_artifact_property_with_compressed_value_by_id {
+    query: " SELECT `P`.`artifact_id` as `id`, `P`.`name` as `key`, "
+           "        `P`.`is_custom_property`, "
+           "        `P`.`int_value`, `P`.`double_value`, "
+           "        COALESCE(`P`.`string_value`, `S`.`value`) "
+           "            as `string_value`, "
+           "        `P`.`proto_value`, `P`.`compressed_value` "
+           " from `ArtifactProperty` AS `P` "
+           "     LEFT JOIN `PropertyStringValue` AS `S` "
+           "     ON `S`.`id` = `P`.`string_value_id` "
+           " WHERE `P`.`artifact_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_artifact_property_with_compressed_value_by_id_and_name {
+    query: " SELECT `P`.`artifact_id` as `id`, `P`.`name` as `key`, "
+           "        `P`.`is_custom_property`, "
+           "        `P`.`int_value`, `P`.`double_value`, "
+           "        COALESCE(`P`.`string_value`, `S`.`value`) "
+           "            as `string_value`, "
+           "        `P`.`proto_value`, `P`.`compressed_value` "
+           " from `ArtifactProperty` AS `P` "
+           "     LEFT JOIN `PropertyStringValue` AS `S` "
+           "     ON `S`.`id` = `P`.`string_value_id` "
+           " WHERE `P`.`artifact_id` IN ($0) AND `P`.`name` IN ($1); "
+    parameter_num: 2
+  }
+  select_execution_property_with_compressed_value_by_id {
+    query: " SELECT `P`.`execution_id` as `id`, `P`.`name` as `key`, "
+           "        `P`.`is_custom_property`, "
+           "        `P`.`int_value`, `P`.`double_value`, "
+           "        COALESCE(`P`.`string_value`, `S`.`value`) "
+           "            as `string_value`, "
+           "        `P`.`proto_value`, `P`.`compressed_value` "
+           " from `ExecutionProperty` AS `P` "
+           "     LEFT JOIN `PropertyStringValue` AS `S` "
+           "     ON `S`.`id` = `P`.`string_value_id` "
+           " WHERE `P`.`execution_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_execution_property_with_compressed_value_by_id_and_name {
+    query: " SELECT `P`.`execution_id` as `id`, `P`.`name` as `key`, "
+           "        `P`.`is_custom_property`, "
+           "        `P`.`int_value`, `P`.`double_value`, "
+           "        COALESCE(`P`.`string_value`, `S`.`value`) "
+           "            as `string_value`, "
+           "        `P`.`proto_value`, `P`.`compressed_value` "
+           " from `ExecutionProperty` AS `P` "
+           "     LEFT JOIN `PropertyStringValue` AS `S` "
+           "     ON `S`.`id` = `P`.`string_value_id` "
+           " WHERE `P`.`execution_id` IN ($0) AND `P`.`name` IN ($1); "
+    parameter_num: 2
+  }
+  select_context_property_with_compressed_value_by_id {
+    query: " SELECT `P`.`context_id` as `id`, `P`.`name` as `key`, "
+           "        `P`.`is_custom_property`, "
+           "        `P`.`int_value`, `P`.`double_value`, "
+           "        COALESCE(`P`.`string_value`, `S`.`value`) "
+           "            as `string_value`, "
+           "        `P`.`proto_value`, `P`.`compressed_value` "
+           " from `ContextProperty` AS `P` "
+           "     LEFT JOIN `PropertyStringValue` AS `S` "
+           "     ON `S`.`id` = `P`.`string_value_id` "
+           " WHERE `P`.`context_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_context_property_with_compressed_value_by_id_and_name {
+    query: " SELECT `P`.`context_id` as `id`, `P`.`name` as `key`, "
+           "        `P`.`is_custom_property`, "
+           "        `P`.`int_value`, `P`.`double_value`, "
+           "        COALESCE(`P`.`string_value`, `S`.`value`) "
+           "            as `string_value`, "
+           "        `P`.`proto_value`, `P`.`compressed_value` "
+           " from `ContextProperty` AS `P` "
+           "     LEFT JOIN `PropertyStringValue` AS `S` "
+           "     ON `S`.`id` = `P`.`string_value_id` "
+           " WHERE `P`.`context_id` IN ($0) AND `P`.`name` IN ($1); "
+    parameter_num: 2
+  }
+)pb",
+R"pb(
+  drop_association_table { query: " DROP TABLE IF EXISTS `Association`; " }
+  create_association_table {
+    query: " CREATE TABLE IF NOT EXISTS `Association` ( "
+           "   `id` INTEGER PRIMARY KEY AUTOINCREMENT, "
+           "   `context_id` INT NOT NULL, "
+           "   `execution_id` INT NOT NULL, "
+           "   UNIQUE(`context_id`, `execution_id`) "
+           " ); "
+  }
+  check_association_table {
+    query: " SELECT `id`, `context_id`, `execution_id` "
+           " FROM `Association` LIMIT 1; "
+  }
+  insert_association {
+    query: " INSERT INTO `Association`( "
+           "   `context_id`, `execution_id` "
+           ") VALUES($0, $1);"
+    parameter_num: 2
+  }
+  insert_associations_if_not_exist {
+    query: " INSERT OR IGNORE INTO `Association`( "
+           "   `context_id`, `execution_id` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  select_association_by_context_id {
+    query: " SELECT `id`, `context_id`, `execution_id` "
+           " from `Association` "
+           " WHERE `context_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_association_by_execution_id {
+    query: " SELECT `id`, `context_id`, `execution_id` "
+           " from `Association` "
+           " WHERE `execution_id` IN ($0); "
+    parameter_num: 1
+  }
+  drop_attribution_table { query: " DROP TABLE IF EXISTS `Attribution`; " }
+  create_attribution_table {
+    query: " CREATE TABLE IF NOT EXISTS `Attribution` ( "
+           "   `id` INTEGER PRIMARY KEY AUTOINCREMENT, "
+           "   `context_id` INT NOT NULL, "
+           "   `artifact_id` INT NOT NULL, "
+           "   UNIQUE(`context_id`, `artifact_id`) "
+           " ); "
+  }
+  check_attribution_table {
+    query: " SELECT `id`, `context_id`, `artifact_id` "
+           " FROM `Attribution` LIMIT 1; "
+  }
+  insert_attribution {
+    query: " INSERT INTO `Attribution`( "
+           "   `context_id`, `artifact_id` "
+           ") VALUES($0, $1);"
+    parameter_num: 2
+  }
+  insert_attributions_if_not_exist {
+    query: " INSERT OR IGNORE INTO `Attribution`( "
+           "   `context_id`, `artifact_id` "
+           ") VALUES $0;"
+    parameter_num: 1
+  }
+  select_attribution_by_context_id {
+    query: " SELECT `id`, `context_id`, `artifact_id` "
+           " from `Attribution` "
+           " WHERE `context_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_attribution_by_artifact_id {
+    query: " SELECT `id`, `context_id`, `artifact_id` "
+           " from `Attribution` "
+           " WHERE `artifact_id` = $0; "
+    parameter_num: 1
+  }
+  drop_mlmd_env_table { query: " DROP TABLE IF EXISTS `MLMDEnv`; " }
+  create_mlmd_env_table {
+    query: " CREATE TABLE IF NOT EXISTS `MLMDEnv` ( "
+           "   `schema_version` INTEGER PRIMARY KEY, "
+           "   `type_generation` INTEGER NOT NULL DEFAULT 0 "
+           " ); "
+  }
+  check_mlmd_env_table {
+    query: " SELECT `schema_version` FROM `MLMDEnv`; "
+  }
+  insert_schema_version {
+    query: " INSERT INTO `MLMDEnv`(`schema_version`) VALUES($0); "
+    parameter_num: 1
+  }
+  update_schema_version {
+    query: " UPDATE `MLMDEnv` SET `schema_version` = $0; "
+    parameter_num: 1
+  }
+  select_type_generation {
+    query: " SELECT `type_generation` FROM `MLMDEnv`; "
+  }
+  increment_type_generation {
+    query: " UPDATE `MLMDEnv` SET `type_generation` = `type_generation` + 1; "
+  }
+  check_tables_in_v0_13_2 {
+    query: " SELECT `Type`.`is_artifact_type` from "
+           " `Artifact`, `Event`, `Execution`, `Type`, `ArtifactProperty`, "
+           " `EventPath`, `ExecutionProperty`, `TypeProperty` LIMIT 1; "
+  }
+  select_struct_string_properties {
+    query: " SELECT `$0`, `name`, `is_custom_property`, `string_value`, "
+           "        `proto_value` "
+           " FROM `$1` WHERE `string_value` LIKE 'mlmd-struct::%'; "
+    parameter_num: 2
+  }
+  update_property_to_proto_value {
+    query: " UPDATE `$0` SET `proto_value` = $1, `string_value` = NULL "
+           " WHERE `$2` = $3 AND `name` = $4 AND `is_custom_property` = $5; "
+    parameter_num: 6
+  }
+  select_proto_value_properties {
+    query: " SELECT `$0`, `name`, `is_custom_property`, `proto_value` "
+           " FROM `$1` WHERE `proto_value` IS NOT NULL; "
+    parameter_num: 2
+  }
+  update_property_to_string_value {
+    query: " UPDATE `$0` SET `string_value` = $1, `proto_value` = NULL "
+           " WHERE `$2` = $3 AND `name` = $4 AND `is_custom_property` = $5; "
+    parameter_num: 6
+  }
+  create_migration_checkpoint_table {
+    query: " CREATE TABLE IF NOT EXISTS `MLMDMigration` ( "
+           "   `to_version` INTEGER PRIMARY KEY, "
+           "   `table_index` INTEGER NOT NULL, "
+           "   `last_id` BIGINT NOT NULL "
+           " ); "
+  }
+  drop_migration_checkpoint_table {
+    query: " DROP TABLE IF EXISTS `MLMDMigration`; "
+  }
+  select_migration_checkpoint {
+    query: " SELECT `table_index`, `last_id` FROM `MLMDMigration` "
+           " WHERE `to_version` = $0; "
+    parameter_num: 1
+  }
+  insert_migration_checkpoint {
+    query: " INSERT INTO `MLMDMigration`(`to_version`, `table_index`, "
+           "     `last_id`) "
+           " VALUES($0, $1, $2); "
+    parameter_num: 3
+  }
+  update_migration_checkpoint {
+    query: " UPDATE `MLMDMigration` SET `table_index` = $1, `last_id` = $2 "
+           " WHERE `to_version` = $0; "
+    parameter_num: 3
+  }
+  select_property_chunk_end {
+    query: " SELECT MAX(`$0`) FROM ( "
+           "   SELECT `$0` FROM `$1` WHERE `$0` > $2 ORDER BY `$0` LIMIT $3 "
+           " ) AS `Chunk`; "
+    parameter_num: 4
+  }
+  select_struct_string_properties_in_chunk {
+    query: " SELECT `$0`, `name`, `is_custom_property`, `string_value` "
+           " FROM `$1` WHERE `$0` > $2 AND `$0` <= $3 AND "
+           "     `string_value` LIKE 'mlmd-struct::%'; "
+    parameter_num: 4
+  }
+  copy_property_to_proto_value {
+    query: " UPDATE `$0` SET `proto_value` = $1 "
+           " WHERE `$2` = $3 AND `name` = $4 AND `is_custom_property` = $5; "
+    parameter_num: 6
+  }
+  clear_copied_struct_string_properties {
+    query: " UPDATE `$0` SET `string_value` = NULL "
+           " WHERE `proto_value` IS NOT NULL AND "
+           "     `string_value` LIKE 'mlmd-struct::%'; "
+    parameter_num: 1
+  }
+  delete_associations_by_contexts_id {
+    query: "DELETE FROM `Association` WHERE `context_id` IN ($0); "
+    parameter_num: 1
+  }
+  delete_associations_by_executions_id {
+    query: "DELETE FROM `Association` WHERE `execution_id` IN ($0); "
+    parameter_num: 1
+  }
+  delete_attributions_by_contexts_id {
+    query: "DELETE FROM `Attribution` WHERE `context_id` IN ($0); "
+    parameter_num: 1
+  }
+  delete_attributions_by_artifacts_id {
+    query: "DELETE FROM `Attribution` WHERE `artifact_id` IN ($0); "
+    parameter_num: 1
+  }
+)pb");
+
+// no-lint to support vc (C2026) 16380 max length for char[].
+const std::string kSQLiteMetadataSourceQueryConfig = absl::StrCat(  // NOLINT
+R"pb(
+  metadata_source_type: SQLITE_METADATA_SOURCE
+  # The dedicated partial index of an indexed property.
+  create_indexed_property_index {
+    query: " CREATE INDEX IF NOT EXISTS `$0` ON `$1`($2) "
+           " WHERE `name` = $3 AND `is_custom_property` = $4; "
+    parameter_num: 5
+  }
+  # secondary indices in the current schema.
+  secondary_indices {
     query: " CREATE INDEX IF NOT EXISTS `idx_artifact_uri` "
            " ON `Artifact`(`uri`); "
   }
@@ -768,48 +1670,141 @@ R"pb(
            " ON `ContextProperty`(`name`, `is_custom_property`, `string_value`) "
            " WHERE `string_value` IS NOT NULL; "
   }
-)pb",
-R"pb(
-  # downgrade to 0.13.2 (i.e., v0), and drop the MLMDEnv table.
-  migration_schemes {
-    key: 0
-    value: {
-      # downgrade queries from version 1
-      downgrade_queries { query: " DROP TABLE IF EXISTS `MLMDEnv`; " }
-      # check the tables are deleted properly
-      downgrade_verification {
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `sqlite_master` "
-                 " WHERE `tbl_name` = 'MLMDEnv'; "
-        }
-      }
-    }
+  # Only the compressed values are indexed, which are looked up to reject the
+  # filters on their properties.
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_artifact_property_compressed` "
+           " ON `ArtifactProperty`(`name`, `is_custom_property`) "
+           " WHERE `compressed_value` IS NOT NULL; "
   }
-)pb",
-R"pb(
-  # From 0.13.2 to v1, it creates a new MLMDEnv table to track
-  # schema_version.
-  migration_schemes {
-    key: 1
-    value: {
-      upgrade_queries {
-        query: " CREATE TABLE IF NOT EXISTS `MLMDEnv` ( "
-               "   `schema_version` INTEGER PRIMARY KEY "
-               " ); "
-      }
-      upgrade_queries {
-        query: " INSERT INTO `MLMDEnv`(`schema_version`) VALUES(0); "
-      }
-      # v0.13.2 release
-      upgrade_verification {
-        # reproduce the v0.13.2 release table setup
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `Type` ( "
-                 "   `id` INTEGER PRIMARY KEY AUTOINCREMENT, "
-                 "   `name` VARCHAR(255) NOT NULL, "
-                 "   `is_artifact_type` TINYINT(1) NOT NULL, "
-                 "   `input_type` TEXT, "
-                 "   `output_type` TEXT "
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_execution_property_compressed` "
+           " ON `ExecutionProperty`(`name`, `is_custom_property`) "
+           " WHERE `compressed_value` IS NOT NULL; "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_context_property_compressed` "
+           " ON `ContextProperty`(`name`, `is_custom_property`) "
+           " WHERE `compressed_value` IS NOT NULL; "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_type_id_create_time_since_epoch` "
+           " ON `Artifact`(`type_id`, `create_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_type_id_last_update_time_since_epoch` "
+           " ON `Artifact`( "
+           "   `type_id`, `last_update_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_execution_type_id_create_time_since_epoch` "
+           " ON `Execution`(`type_id`, `create_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_execution_type_id_last_update_time_since_epoch` "
+           " ON `Execution`( "
+           "   `type_id`, `last_update_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_context_type_id_create_time_since_epoch` "
+           " ON `Context`(`type_id`, `create_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_context_type_id_last_update_time_since_epoch` "
+           " ON `Context`( "
+           "   `type_id`, `last_update_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_attribution_artifact_id_context_id` "
+           " ON `Attribution`(`artifact_id`, `context_id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_association_execution_id_context_id` "
+           " ON `Association`(`execution_id`, `context_id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_derivation_downstream_artifact_id` "
+           " ON `ArtifactDerivation`( "
+           "   `downstream_artifact_id`, `upstream_artifact_id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_derivation_execution_id` "
+           " ON `ArtifactDerivation`(`execution_id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_event_archive_artifact_id` "
+           " ON `EventArchive`(`artifact_id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_event_archive_execution_id` "
+           " ON `EventArchive`(`execution_id`); "
+  }
+  # Only the active executions, i.e., NEW or RUNNING, are indexed, which are
+  # few compared to the terminal ones.
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_execution_type_id_last_known_state` "
+           " ON `Execution`( "
+           "   `type_id`, `last_known_state`, "
+           "   `last_update_time_since_epoch`, `id`) "
+           " WHERE `last_known_state` IN (1, 2); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_event_milliseconds_since_epoch` "
+           " ON `Event`(`milliseconds_since_epoch`, `id`); "
+  }
+)pb",
+R"pb(
+  # downgrade to 0.13.2 (i.e., v0), and drop the MLMDEnv table.
+  migration_schemes {
+    key: 0
+    value: {
+      # downgrade queries from version 1
+      downgrade_queries { query: " DROP TABLE IF EXISTS `MLMDEnv`; " }
+      # check the tables are deleted properly
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `tbl_name` = 'MLMDEnv'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # From 0.13.2 to v1, it creates a new MLMDEnv table to track
+  # schema_version.
+  migration_schemes {
+    key: 1
+    value: {
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `MLMDEnv` ( "
+               "   `schema_version` INTEGER PRIMARY KEY "
+               " ); "
+      }
+      upgrade_queries {
+        query: " INSERT INTO `MLMDEnv`(`schema_version`) VALUES(0); "
+      }
+      # v0.13.2 release
+      upgrade_verification {
+        # reproduce the v0.13.2 release table setup
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `Type` ( "
+                 "   `id` INTEGER PRIMARY KEY AUTOINCREMENT, "
+                 "   `name` VARCHAR(255) NOT NULL, "
+                 "   `is_artifact_type` TINYINT(1) NOT NULL, "
+                 "   `input_type` TEXT, "
+                 "   `output_type` TEXT "
                  " ); "
         }
         previous_version_setup_queries {
@@ -2067,1448 +3062,4500 @@ R"pb(
         }
       }
       db_verification { total_num_indexes: 32 total_num_tables: 15 }
+      # Downgrade from v9.
+      downgrade_queries {
+        query: " CREATE TABLE `MLMDEnvTemp` ( "
+               "   `schema_version` INTEGER PRIMARY KEY "
+               " ); "
+      }
+      downgrade_queries {
+        query: " INSERT INTO `MLMDEnvTemp` (`schema_version`) "
+               " SELECT `schema_version` FROM `MLMDEnv`; "
+      }
+      downgrade_queries { query: " DROP TABLE `MLMDEnv`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `MLMDEnvTemp` RENAME TO `MLMDEnv`; "
+      }
+      downgrade_verification {
+        previous_version_setup_queries {
+          query: " UPDATE `MLMDEnv` SET `type_generation` = 1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `MLMDEnv`; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM pragma_table_info('MLMDEnv') "
+                 " WHERE `name` = 'type_generation'; "
+        }
+      }
     }
   }
-)pb");
-
-// Template queries for MySQLMetadataSources.
-// no-lint to support vc (C2026) 16380 max length for char[].
-const std::string kMySQLMetadataSourceQueryConfig = absl::StrCat(  // NOLINT
+)pb",
 R"pb(
-  metadata_source_type: MYSQL_METADATA_SOURCE
-  select_last_insert_id { query: " SELECT last_insert_id(); " }
-  select_type_by_name {
-    query: " SELECT `id`, `name`, `version`, `description`, "
-           "        `input_type`, `output_type` FROM `Type` "
-           " WHERE name = $0 AND version IS NULL AND type_kind = $1 "
-           " LOCK IN SHARE MODE; "
-    parameter_num: 2
-  }
-  select_type_by_name_and_version {
-    query: " SELECT `id`, `name`, `version`, `description`, "
-           "        `input_type`, `output_type` FROM `Type` "
-           " WHERE name = $0 AND version = $1 AND type_kind = $2 "
-           " LOCK IN SHARE MODE; "
-    parameter_num: 3
-  }
-  select_context_by_id {
-    query: " SELECT `id`, `type_id`, `name`, `create_time_since_epoch`, "
-           "        `last_update_time_since_epoch`"
-           " from `Context` WHERE id IN ($0) "
-           " LOCK IN SHARE MODE; "
-    parameter_num: 1
-  }
-  select_execution_by_id {
-    query: " SELECT `id`, `type_id`, `last_known_state`, `name`, "
-           "        `create_time_since_epoch`, `last_update_time_since_epoch` "
-           " from `Execution` "
-           " WHERE id IN ($0) "
-           " LOCK IN SHARE MODE; "
-    parameter_num: 1
-  }
-  select_artifact_by_id {
-    query: " SELECT `id`, `type_id`, `uri`, `state`, `name`, "
-           "        `create_time_since_epoch`, `last_update_time_since_epoch` "
-           " from `Artifact` "
-           " WHERE id IN ($0) "
-           " LOCK IN SHARE MODE; "
-    parameter_num: 1
+  # In v9, we added `type_generation` to `MLMDEnv`. It is increased whenever
+  # the stored types change, so that the cached types can be validated.
+  migration_schemes {
+    key: 9
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `MLMDEnv` "
+               " ADD COLUMN `type_generation` INTEGER NOT NULL DEFAULT 0; "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `MLMDEnv` "
+                 " WHERE `type_generation` = 0; "
+        }
+      }
+      db_verification { total_num_indexes: 32 total_num_tables: 15 }
+      # Downgrade from v10.
+      downgrade_queries {
+        query: " DROP INDEX `idx_artifact_type_id_create_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX "
+               "   `idx_artifact_type_id_last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX `idx_execution_type_id_create_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX "
+               "   `idx_execution_type_id_last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX `idx_context_type_id_create_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX "
+               "   `idx_context_type_id_last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX `idx_attribution_artifact_id_context_id`; "
+      }
+      downgrade_queries {
+        query: " DROP INDEX `idx_association_execution_id_context_id`; "
+      }
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Artifact' AND "
+                 "       `name` LIKE 'idx_artifact_type_id_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Execution' AND "
+                 "       `name` LIKE 'idx_execution_type_id_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Context' AND "
+                 "       `name` LIKE 'idx_context_type_id_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Attribution' AND "
+                 "       `name` = 'idx_attribution_artifact_id_context_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Association' AND "
+                 "       `name` = 'idx_association_execution_id_context_id'; "
+        }
+      }
+    }
   }
-  select_parent_type_by_type_id {
-    query: " SELECT `type_id`, `parent_type_id` "
-           " FROM `ParentType` WHERE type_id IN ($0) "
-           " LOCK IN SHARE MODE; "
-    parameter_num: 1
+)pb",
+R"pb(
+  # In v10, we added composite indexes for listing the nodes of a type ordered
+  # by their create or last update time, and for finding the contexts of an
+  # artifact or an execution.
+  migration_schemes {
+    key: 10
+    value: {
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_artifact_type_id_create_time_since_epoch` "
+               " ON `Artifact`(`type_id`, `create_time_since_epoch`, `id`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_artifact_type_id_last_update_time_since_epoch` "
+               " ON `Artifact`( "
+           "   `type_id`, `last_update_time_since_epoch`, `id`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_execution_type_id_create_time_since_epoch` "
+               " ON `Execution`(`type_id`, `create_time_since_epoch`, `id`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_execution_type_id_last_update_time_since_epoch` "
+               " ON `Execution`( "
+           "   `type_id`, `last_update_time_since_epoch`, `id`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_context_type_id_create_time_since_epoch` "
+               " ON `Context`(`type_id`, `create_time_since_epoch`, `id`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_context_type_id_last_update_time_since_epoch` "
+               " ON `Context`( "
+           "   `type_id`, `last_update_time_since_epoch`, `id`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_attribution_artifact_id_context_id` "
+               " ON `Attribution`(`artifact_id`, `context_id`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_association_execution_id_context_id` "
+               " ON `Association`(`execution_id`, `context_id`); "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Artifact' AND "
+                 "       `name` LIKE 'idx_artifact_type_id_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Execution' AND "
+                 "       `name` LIKE 'idx_execution_type_id_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Context' AND "
+                 "       `name` LIKE 'idx_context_type_id_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Attribution' AND "
+                 "       `name` = 'idx_attribution_artifact_id_context_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND `tbl_name` = 'Association' AND "
+                 "       `name` = 'idx_association_execution_id_context_id'; "
+        }
+      }
+      db_verification { total_num_indexes: 40 total_num_tables: 15 }
+      # Downgrade from v11.
+      downgrade_queries {
+        query: " DROP TABLE IF EXISTS `ArtifactDerivation`; "
+      }
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'table' AND "
+                 "       `tbl_name` = 'ArtifactDerivation'; "
+        }
+      }
+    }
   }
-  create_type_table {
-    query: " CREATE TABLE IF NOT EXISTS `Type` ( "
-           "   `id` INT PRIMARY KEY AUTO_INCREMENT, "
-           "   `name` VARCHAR(255) NOT NULL, "
-           "   `version` VARCHAR(255), "
-           "   `type_kind` TINYINT(1) NOT NULL, "
-           "   `description` TEXT, "
-           "   `input_type` TEXT, "
-           "   `output_type` TEXT"
-           " ); "
-  }
-  create_artifact_table {
-    query: " CREATE TABLE IF NOT EXISTS `Artifact` ( "
-           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-           "   `type_id` INT NOT NULL, "
-           "   `uri` TEXT, "
-           "   `state` INT, "
-           "   `name` VARCHAR(255), "
-           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-           "   CONSTRAINT UniqueArtifactTypeName UNIQUE(`type_id`, `name`) "
-           " ); "
-  }
-  create_artifact_property_table {
-    query: " CREATE TABLE IF NOT EXISTS `ArtifactProperty` ( "
-           "   `artifact_id` INT NOT NULL, "
-           "   `name` VARCHAR(255) NOT NULL, "
-           "   `is_custom_property` TINYINT(1) NOT NULL, "
-           "   `int_value` INT, "
-           "   `double_value` DOUBLE, "
-           "   `string_value` MEDIUMTEXT, "
-           "   `byte_value` MEDIUMBLOB, "
-           " PRIMARY KEY (`artifact_id`, `name`, `is_custom_property`)); "
-  }
-  create_execution_table {
-    query: " CREATE TABLE IF NOT EXISTS `Execution` ( "
-           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-           "   `type_id` INT NOT NULL, "
-           "   `last_known_state` INT, "
-           "   `name` VARCHAR(255), "
-           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-           "   CONSTRAINT UniqueExecutionTypeName UNIQUE(`type_id`, `name`) "
-           " ); "
-  }
-  create_execution_property_table {
-    query: " CREATE TABLE IF NOT EXISTS `ExecutionProperty` ( "
-           "   `execution_id` INT NOT NULL, "
-           "   `name` VARCHAR(255) NOT NULL, "
-           "   `is_custom_property` TINYINT(1) NOT NULL, "
-           "   `int_value` INT, "
-           "   `double_value` DOUBLE, "
-           "   `string_value` MEDIUMTEXT, "
-           "   `byte_value` MEDIUMBLOB, "
-           " PRIMARY KEY (`execution_id`, `name`, `is_custom_property`)); "
-  }
-  create_context_table {
-    query: " CREATE TABLE IF NOT EXISTS `Context` ( "
-           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-           "   `type_id` INT NOT NULL, "
-           "   `name` VARCHAR(255) NOT NULL, "
-           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-           "   UNIQUE(`type_id`, `name`) "
-           " ); "
-  }
-  create_context_property_table {
-    query: " CREATE TABLE IF NOT EXISTS `ContextProperty` ( "
-           "   `context_id` INT NOT NULL, "
-           "   `name` VARCHAR(255) NOT NULL, "
-           "   `is_custom_property` TINYINT(1) NOT NULL, "
-           "   `int_value` INT, "
-           "   `double_value` DOUBLE, "
-           "   `string_value` MEDIUMTEXT, "
-           "   `byte_value` MEDIUMBLOB, "
-           " PRIMARY KEY (`context_id`, `name`, `is_custom_property`)); "
-  }
-  create_event_table {
-    query: " CREATE TABLE IF NOT EXISTS `Event` ( "
-           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-           "   `artifact_id` INT NOT NULL, "
-           "   `execution_id` INT NOT NULL, "
-           "   `type` INT NOT NULL, "
-           "   `milliseconds_since_epoch` BIGINT, "
-           "   CONSTRAINT UniqueEvent UNIQUE( "
-           "     `artifact_id`, `execution_id`, `type`) "
-           " ); "
-  }
-  create_association_table {
-    query: " CREATE TABLE IF NOT EXISTS `Association` ( "
-           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-           "   `context_id` INT NOT NULL, "
-           "   `execution_id` INT NOT NULL, "
-           "   UNIQUE(`context_id`, `execution_id`) "
-           " ); "
-  }
-  create_attribution_table {
-    query: " CREATE TABLE IF NOT EXISTS `Attribution` ( "
-           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-           "   `context_id` INT NOT NULL, "
-           "   `artifact_id` INT NOT NULL, "
-           "   UNIQUE(`context_id`, `artifact_id`) "
-           " ); "
-  }
-  # secondary indices in the current schema.
-  secondary_indices {
-    # MySQL does not support arbitrary length string index. Only prefix
-    # index
-    # is supported. Max size for 5.6/5.7 is 255 char for utf8 charset.
-    query: " ALTER TABLE `Artifact` "
-           "  ADD INDEX `idx_artifact_uri`(`uri`(255)), "
-           "  ADD INDEX `idx_artifact_create_time_since_epoch` "
-           "             (`create_time_since_epoch`), "
-           "  ADD INDEX `idx_artifact_last_update_time_since_epoch` "
-           "             (`last_update_time_since_epoch`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `Event` "
-           " ADD INDEX `idx_event_execution_id` (`execution_id`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `ParentContext` "
-           " ADD INDEX "
-           "   `idx_parentcontext_parent_context_id` (`parent_context_id`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `Type` "
-           " ADD INDEX `idx_type_name` (`name`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `Execution` "
-           "  ADD INDEX `idx_execution_create_time_since_epoch` "
-           "             (`create_time_since_epoch`), "
-           "  ADD INDEX `idx_execution_last_update_time_since_epoch` "
-           "             (`last_update_time_since_epoch`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `Context` "
-           "  ADD INDEX `idx_context_create_time_since_epoch` "
-           "             (`create_time_since_epoch`), "
-           "  ADD INDEX `idx_context_last_update_time_since_epoch` "
-           "             (`last_update_time_since_epoch`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `EventPath` "
-           "  ADD INDEX `idx_eventpath_event_id`(`event_id`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `ArtifactProperty` "
-           "  ADD INDEX `idx_artifact_property_int`( "
-           "    `name`, `is_custom_property`, `int_value`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `ArtifactProperty` "
-           "  ADD INDEX `idx_artifact_property_double`( "
-           "    `name`, `is_custom_property`, `double_value`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `ArtifactProperty` "
-           "  ADD INDEX `idx_artifact_property_string`( "
-           "    `name`, `is_custom_property`, `string_value`(255)); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `ExecutionProperty` "
-           "  ADD INDEX `idx_execution_property_int`( "
-           "    `name`, `is_custom_property`, `int_value`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `ExecutionProperty` "
-           "  ADD INDEX `idx_execution_property_double`( "
-           "    `name`, `is_custom_property`, `double_value`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `ExecutionProperty` "
-           "  ADD INDEX `idx_execution_property_string`( "
-           "    `name`, `is_custom_property`, `string_value`(255)); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `ContextProperty` "
-           "  ADD INDEX `idx_context_property_int`( "
-           "    `name`, `is_custom_property`, `int_value`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `ContextProperty` "
-           "  ADD INDEX `idx_context_property_double`( "
-           "    `name`, `is_custom_property`, `double_value`); "
-  }
-  secondary_indices {
-    query: " ALTER TABLE `ContextProperty` "
-           "  ADD INDEX `idx_context_property_string`( "
-           "    `name`, `is_custom_property`, `string_value`(255)); "
-  }
-  # downgrade to 0.13.2 (i.e., v0), and drops the MLMDEnv table.
+)pb",
+R"pb(
+  # In v11, we added the ArtifactDerivation table of the derivations between
+  # the input and output artifacts of the executions, which is backfilled from
+  # the Event table.
   migration_schemes {
-    key: 0
+    key: 11
     value: {
-      # downgrade queries from version 1
-      downgrade_queries { query: " DROP TABLE IF EXISTS `MLMDEnv`; " }
-      # check the tables are deleted properly
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `ArtifactDerivation` ( "
+               "   `upstream_artifact_id` INT NOT NULL, "
+               "   `downstream_artifact_id` INT NOT NULL, "
+               "   `execution_id` INT NOT NULL, "
+               "   PRIMARY KEY(`upstream_artifact_id`, "
+               "               `downstream_artifact_id`, `execution_id`) "
+               " ); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_artifact_derivation_downstream_artifact_id` "
+               " ON `ArtifactDerivation`( "
+               "   `downstream_artifact_id`, `upstream_artifact_id`); "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_artifact_derivation_execution_id` "
+               " ON `ArtifactDerivation`(`execution_id`); "
+      }
+      upgrade_queries {
+        query: " INSERT OR IGNORE INTO `ArtifactDerivation`( "
+               "   `upstream_artifact_id`, `downstream_artifact_id`, "
+               "   `execution_id` "
+               " ) "
+               " SELECT `I`.`artifact_id`, `O`.`artifact_id`, "
+               "        `I`.`execution_id` "
+               " FROM `Event` AS `I` JOIN `Event` AS `O` "
+               "   ON `O`.`execution_id` = `I`.`execution_id` "
+               " WHERE `I`.`type` IN (2, 3, 5) AND `O`.`type` IN (1, 4, 6) "
+               "   AND `O`.`artifact_id` != `I`.`artifact_id`; "
+      }
+      upgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `Event`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Event` "
+                 " (`artifact_id`, `execution_id`, `type`, "
+                 " `milliseconds_since_epoch`) "
+                 " VALUES (1, 1, 3, 1), (2, 1, 4, 1), (2, 2, 3, 1); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ArtifactDerivation`; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ArtifactDerivation` "
+                 " WHERE `upstream_artifact_id` = 1 AND "
+                 "       `downstream_artifact_id` = 2 AND "
+                 "       `execution_id` = 1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND "
+                 "       `tbl_name` = 'ArtifactDerivation' AND "
+                 "       `name` LIKE 'idx_artifact_derivation_%'; "
+        }
+      }
+      db_verification { total_num_indexes: 43 total_num_tables: 16 }
+      # Downgrade from v12.
+      downgrade_queries { query: " DROP TABLE IF EXISTS `ChangeLog`; " }
       downgrade_verification {
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'MLMDEnv'; "
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'table' AND `tbl_name` = 'ChangeLog'; "
         }
       }
     }
   }
 )pb",
 R"pb(
+  # In v12, we added the ChangeLog table, which has an entry for each change of
+  # the nodes and the events. It starts empty, as the earlier changes are not
+  # known.
   migration_schemes {
-    key: 1
+    key: 12
     value: {
       upgrade_queries {
-        query: " CREATE TABLE IF NOT EXISTS `MLMDEnv` ( "
-               "   `schema_version` INTEGER PRIMARY KEY "
+        query: " CREATE TABLE IF NOT EXISTS `ChangeLog` ( "
+               "   `id` INTEGER PRIMARY KEY AUTOINCREMENT, "
+               "   `kind` TINYINT NOT NULL, "
+               "   `operation` TINYINT NOT NULL, "
+               "   `artifact_id` INT, "
+               "   `execution_id` INT, "
+               "   `context_id` INT, "
+               "   `milliseconds_since_epoch` BIGINT NOT NULL "
                " ); "
       }
-      upgrade_queries {
-        query: " INSERT INTO `MLMDEnv`(`schema_version`) VALUES(0); "
-      }
-      # v0.13.2 release
       upgrade_verification {
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `Type` ( "
-                 "   `id` INT PRIMARY KEY AUTO_INCREMENT, "
-                 "   `name` VARCHAR(255) NOT NULL, "
-                 "   `is_artifact_type` TINYINT(1) NOT NULL, "
-                 "   `input_type` TEXT, "
-                 "   `output_type` TEXT"
-                 " ); "
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `ChangeLog`; "
         }
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `TypeProperty` ( "
-                 "   `type_id` INT NOT NULL, "
-                 "   `name` VARCHAR(255) NOT NULL, "
-                 "   `data_type` INT NULL, "
-                 " PRIMARY KEY (`type_id`, `name`)); "
-        }
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `Artifact` ( "
-                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-                 "   `type_id` INT NOT NULL, "
-                 "   `uri` TEXT "
-                 " ); "
-        }
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `ArtifactProperty` ( "
-                 "   `artifact_id` INT NOT NULL, "
-                 "   `name` VARCHAR(255) NOT NULL, "
-                 "   `is_custom_property` TINYINT(1) NOT NULL, "
-                 "   `int_value` INT, "
-                 "   `double_value` DOUBLE, "
-                 "   `string_value` TEXT, "
-                 " PRIMARY KEY (`artifact_id`, `name`, `is_custom_property`)); "
-        }
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `Execution` ( "
-                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-                 "   `type_id` INT NOT NULL "
-                 " ); "
-        }
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `ExecutionProperty` ( "
-                 "   `execution_id` INT NOT NULL, "
-                 "   `name` VARCHAR(255) NOT NULL, "
-                 "   `is_custom_property` TINYINT(1) NOT NULL, "
-                 "   `int_value` INT, "
-                 "   `double_value` DOUBLE, "
-                 "   `string_value` TEXT, "
-                 " PRIMARY KEY (`execution_id`, `name`, `is_custom_property`)); "
-        }
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `Event` ( "
-                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-                 "   `artifact_id` INT NOT NULL, "
-                 "   `execution_id` INT NOT NULL, "
-                 "   `type` INT NOT NULL, "
-                 "   `milliseconds_since_epoch` BIGINT "
-                 " ); "
-        }
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `EventPath` ( "
-                 "   `event_id` INT NOT NULL, "
-                 "   `is_index_step` TINYINT(1) NOT NULL, "
-                 "   `step_index` INT, "
-                 "   `step_key` TEXT "
-                 " ); "
-        }
-        # check the new table has 1 row
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `MLMDEnv`; "
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'table' AND `tbl_name` = 'ChangeLog'; "
         }
       }
-      # downgrade queries from version 2, drop all ContextTypes and rename
-      # the `type_kind` back to `is_artifact_type` column.
+      db_verification { total_num_indexes: 43 total_num_tables: 17 }
+      # Downgrade from v13. The paths are moved back to the EventPath table,
+      # and the Event table is rebuilt without the `path` column.
       downgrade_queries {
-        query: " DELETE FROM `Type` WHERE `type_kind` = 2; "
+        query: " INSERT INTO `EventPath` "
+               " (`event_id`, `is_index_step`, `step_index`, `step_key`) "
+               " SELECT `E`.`id`, "
+               "        json_type(`S`.`value`, '$.index') IS NOT NULL, "
+               "        json_extract(`S`.`value`, '$.index'), "
+               "        json_extract(`S`.`value`, '$.key') "
+               " FROM `Event` AS `E`, json_each(`E`.`path`, '$.steps') AS `S` "
+               " WHERE `E`.`path` IS NOT NULL "
+               " ORDER BY `E`.`id`, `S`.`key`; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `Type` CHANGE COLUMN "
-               " `type_kind` `is_artifact_type` TINYINT(1) NOT NULL; "
+        query: " CREATE TABLE `EventTemp` ( "
+               "   `id` INTEGER PRIMARY KEY AUTOINCREMENT, "
+               "   `artifact_id` INT NOT NULL, "
+               "   `execution_id` INT NOT NULL, "
+               "   `type` INT NOT NULL, "
+               "   `milliseconds_since_epoch` INT, "
+               "   UNIQUE(`artifact_id`, `execution_id`, `type`) "
+               " ); "
+      }
+      downgrade_queries {
+        query: " INSERT INTO `EventTemp` "
+               " (`id`, `artifact_id`, `execution_id`, `type`, "
+               " `milliseconds_since_epoch`) "
+               " SELECT `id`, `artifact_id`, `execution_id`, `type`, "
+               "        `milliseconds_since_epoch` "
+               " FROM `Event`; "
+      }
+      downgrade_queries { query: " DROP TABLE `Event`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `EventTemp` RENAME TO `Event`; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_event_execution_id` "
+               " ON `Event`(`execution_id`); "
       }
-      # check the tables are deleted properly
       downgrade_verification {
-        # populate the `Type` table with context types.
+        previous_version_setup_queries { query: "DELETE FROM `Event`;" }
         previous_version_setup_queries {
-          query: " INSERT INTO `Type` "
-                 " (`name`, `type_kind`, `input_type`, `output_type`) "
-                 " VALUES ('execution_type', 0, 'input', 'output'); "
+          query: " INSERT INTO `Event` "
+                 " (`artifact_id`, `execution_id`, `type`, "
+                 " `milliseconds_since_epoch`, `path`) "
+                 " VALUES (1, 1, 3, 1, "
+                 "   '{\"steps\":[{\"index\":\"1\"},{\"key\":\"a\"}]}'), "
+                 "        (2, 1, 4, 1, NULL); "
         }
-        previous_version_setup_queries {
-          query: " INSERT INTO `Type` "
-                 " (`name`, `type_kind`, `input_type`, `output_type`) "
-                 " VALUES ('artifact_type', 1, 'input', 'output'); "
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `Event`; "
         }
-        previous_version_setup_queries {
-          query: " INSERT INTO `Type` "
-                 " (`name`, `type_kind`, `input_type`, `output_type`) "
-                 " VALUES ('context_type', 2, 'input', 'output'); "
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `EventPath`; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `Type` "
-                 " WHERE `is_artifact_type` = 2; "
+          query: " SELECT count(*) = 1 FROM `EventPath` AS `P` "
+                 " JOIN `Event` AS `E` ON `P`.`event_id` = `E`.`id` "
+                 " WHERE `E`.`artifact_id` = 1 AND `P`.`is_index_step` = 1 "
+                 "       AND `P`.`step_index` = 1; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Type` "
-                 " WHERE `is_artifact_type` = 1 AND `name` = 'artifact_type'; "
+          query: " SELECT count(*) = 1 FROM `EventPath` AS `P` "
+                 " JOIN `Event` AS `E` ON `P`.`event_id` = `E`.`id` "
+                 " WHERE `E`.`artifact_id` = 1 AND `P`.`is_index_step` = 0 "
+                 "       AND `P`.`step_key` = 'a'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Type` "
-                 " WHERE `is_artifact_type` = 0 AND `name` = 'execution_type'; "
+          query: " SELECT count(*) = 0 FROM pragma_table_info('Event') "
+                 " WHERE `name` = 'path'; "
         }
       }
     }
   }
 )pb",
 R"pb(
+  # In v13, we added the `path` column to the Event table, which stores the
+  # path of each event as JSON, so that an event is written and read as one
+  # row. The existing paths are moved from the EventPath table, which is kept
+  # for the downgrade.
   migration_schemes {
-    key: 2
+    key: 13
     value: {
       upgrade_queries {
-        query: " ALTER TABLE `Type` CHANGE COLUMN "
-               " `is_artifact_type` `type_kind` TINYINT(1) NOT NULL; "
+        query: " ALTER TABLE `Event` ADD COLUMN `path` TEXT; "
+      }
+      upgrade_queries {
+        query: " UPDATE `Event` SET `path` = ( "
+               "   SELECT json_object('steps', json_group_array( "
+               "     CASE WHEN `P`.`is_index_step` = 1 "
+               "          THEN json_object('index', `P`.`step_index`) "
+               "          ELSE json_object('key', `P`.`step_key`) END)) "
+               "   FROM `EventPath` AS `P` "
+               "   WHERE `P`.`event_id` = `Event`.`id` "
+               " ) "
+               " WHERE `id` IN (SELECT `event_id` FROM `EventPath`); "
       }
+      upgrade_queries { query: " DELETE FROM `EventPath`; " }
       upgrade_verification {
-        # populate one ArtifactType and one ExecutionType.
+        previous_version_setup_queries { query: "DELETE FROM `Event`;" }
         previous_version_setup_queries {
-          query: " INSERT INTO `Type` (`name`, `is_artifact_type`) VALUES "
-                 " ('artifact_type', 1); "
+          query: " INSERT INTO `Event` "
+                 " (`artifact_id`, `execution_id`, `type`, "
+                 " `milliseconds_since_epoch`) "
+                 " VALUES (1, 1, 3, 1), (2, 1, 4, 1); "
         }
+        previous_version_setup_queries { query: "DELETE FROM `EventPath`;" }
         previous_version_setup_queries {
-          query: " INSERT INTO `Type` "
-                 " (`name`, `is_artifact_type`, `input_type`, `output_type`) "
-                 " VALUES ('execution_type', 0, 'input', 'output'); "
+          query: " INSERT INTO `EventPath` "
+                 " (`event_id`, `is_index_step`, `step_index`, `step_key`) "
+                 " SELECT `id`, 1, 1, NULL FROM `Event` "
+                 " WHERE `artifact_id` = 1; "
         }
-        # check after migration, the existing types are the same including
-        # id.
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Type` WHERE "
-                 " `id` = 1 AND `type_kind` = 1 AND `name` = 'artifact_type'; "
+        previous_version_setup_queries {
+          query: " INSERT INTO `EventPath` "
+                 " (`event_id`, `is_index_step`, `step_index`, `step_key`) "
+                 " SELECT `id`, 0, NULL, 'a' FROM `Event` "
+                 " WHERE `artifact_id` = 1; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Type` WHERE "
-                 " `id` = 2 AND `type_kind` = 0 AND `name` = 'execution_type' "
-                 " AND `input_type` = 'input' AND `output_type` = 'output'; "
+          query: " SELECT count(*) = 1 FROM `Event` "
+                 " WHERE `artifact_id` = 1 AND "
+                 "       `path` = '{\"steps\":[{\"index\":1},{\"key\":\"a\"}]}'; "
         }
-      }
-      # downgrade queries from version 3
-      downgrade_queries { query: " DROP TABLE IF EXISTS `Context`; " }
-      downgrade_queries {
-        query: " DROP TABLE IF EXISTS `ContextProperty`; "
-      }
-      # check the tables are deleted properly
-      downgrade_verification {
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Context'; "
+          query: " SELECT count(*) = 1 FROM `Event` "
+                 " WHERE `artifact_id` = 2 AND `path` IS NULL; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'ContextProperty'; "
+          query: " SELECT count(*) = 0 FROM `EventPath`; "
         }
       }
-    }
-  }
-)pb",
-R"pb(
-  migration_schemes {
-    key: 3
-    value: {
-      upgrade_queries {
-        query: " CREATE TABLE IF NOT EXISTS `Context` ( "
-               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-               "   `type_id` INT NOT NULL, "
-               "   `name` VARCHAR(255) NOT NULL, "
-               "   UNIQUE(`type_id`, `name`) "
-               " ); "
+      db_verification { total_num_indexes: 43 total_num_tables: 17 }
+      # Downgrade from v14. The struct values in the `proto_value` column are
+      # moved back to the `string_value` column by the query executor, the
+      # other proto values are deleted, and the property tables are rebuilt
+      # without the `proto_value` column.
+      downgrade_queries {
+        query: " DELETE FROM `ArtifactProperty` WHERE `proto_value` IS NOT NULL; "
       }
-      upgrade_queries {
-        query: " CREATE TABLE IF NOT EXISTS `ContextProperty` ( "
-               "   `context_id` INT NOT NULL, "
+      downgrade_queries {
+        query: " DELETE FROM `ExecutionProperty` WHERE `proto_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " DELETE FROM `ContextProperty` WHERE `proto_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE TABLE `ArtifactPropertyTemp` ( "
+               "   `artifact_id` INT NOT NULL, "
                "   `name` VARCHAR(255) NOT NULL, "
                "   `is_custom_property` TINYINT(1) NOT NULL, "
                "   `int_value` INT, "
                "   `double_value` DOUBLE, "
                "   `string_value` TEXT, "
-               " PRIMARY KEY (`context_id`, `name`, `is_custom_property`)); "
-      }
-      upgrade_verification {
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM ( "
-                 "   SELECT `id`, `type_id`, `name` FROM `Context` "
-                 " ) as T1; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM ( "
-                 "   SELECT `context_id`, `name`, `is_custom_property`, "
-                 "          `int_value`, `double_value`, `string_value` "
-                 "    FROM `ContextProperty` "
-                 " ) as T2; "
-        }
-      }
-      # downgrade queries from version 4
-      downgrade_queries { query: " DROP TABLE IF EXISTS `Association`; " }
-      downgrade_queries { query: " DROP TABLE IF EXISTS `Attribution`; " }
-      # check the tables are deleted properly
-      downgrade_verification {
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Association'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Attribution'; "
-        }
-      }
-    }
-  }
-)pb",
-R"pb(
-  migration_schemes {
-    key: 4
-    value: {
-      upgrade_queries {
-        query: " CREATE TABLE IF NOT EXISTS `Association` ( "
-               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-               "   `context_id` INT NOT NULL, "
-               "   `execution_id` INT NOT NULL, "
-               "   UNIQUE(`context_id`, `execution_id`) "
-               " ); "
-      }
-      upgrade_queries {
-        query: " CREATE TABLE IF NOT EXISTS `Attribution` ( "
-               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-               "   `context_id` INT NOT NULL, "
-               "   `artifact_id` INT NOT NULL, "
-               "   UNIQUE(`context_id`, `artifact_id`) "
-               " ); "
-      }
-      upgrade_verification {
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM ( "
-                 "   SELECT `id`, `context_id`, `execution_id` "
-                 "   FROM `Association` "
-                 " ) as T1; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM ( "
-                 "   SELECT `id`, `context_id`, `artifact_id` "
-                 "   FROM `Attribution` "
-                 " ) as T1; "
-        }
+               "   `byte_value` BLOB, "
+               " PRIMARY KEY (`artifact_id`, `name`, `is_custom_property`)); "
       }
-      # downgrade queries from version 5
       downgrade_queries {
-        query: " ALTER TABLE `Artifact` "
-               " DROP INDEX UniqueArtifactTypeName; "
+        query: " INSERT INTO `ArtifactPropertyTemp` "
+               " SELECT `artifact_id`, `name`, `is_custom_property`, "
+               "        `int_value`, `double_value`, `string_value`, "
+               "        `byte_value` "
+               " FROM `ArtifactProperty`; "
       }
+      downgrade_queries { query: " DROP TABLE `ArtifactProperty`; " }
       downgrade_queries {
-        query: " ALTER TABLE `Artifact` "
-               " DROP COLUMN `state`, "
-               " DROP COLUMN `name`, "
-               " DROP COLUMN `create_time_since_epoch`, "
-               " DROP COLUMN `last_update_time_since_epoch`; "
+        query: " ALTER TABLE `ArtifactPropertyTemp` "
+               "  RENAME TO `ArtifactProperty`; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `Execution` "
-               " DROP INDEX UniqueExecutionTypeName; "
+        query: " CREATE INDEX IF NOT EXISTS `idx_artifact_property_int` "
+               " ON `ArtifactProperty`(`name`, `is_custom_property`, "
+               " `int_value`) "
+               " WHERE `int_value` IS NOT NULL; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `Execution` "
-               " DROP COLUMN `last_known_state`, "
-               " DROP COLUMN `name`, "
-               " DROP COLUMN `create_time_since_epoch`, "
-               " DROP COLUMN `last_update_time_since_epoch`; "
+        query: " CREATE INDEX IF NOT EXISTS `idx_artifact_property_double` "
+               " ON `ArtifactProperty`(`name`, `is_custom_property`, "
+               " `double_value`) "
+               " WHERE `double_value` IS NOT NULL; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `Context` "
-               " DROP COLUMN `create_time_since_epoch`, "
-               " DROP COLUMN `last_update_time_since_epoch`; "
+        query: " CREATE INDEX IF NOT EXISTS `idx_artifact_property_string` "
+               " ON `ArtifactProperty`(`name`, `is_custom_property`, "
+               " `string_value`) "
+               " WHERE `string_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE TABLE `ExecutionPropertyTemp` ( "
+               "   `execution_id` INT NOT NULL, "
+               "   `name` VARCHAR(255) NOT NULL, "
+               "   `is_custom_property` TINYINT(1) NOT NULL, "
+               "   `int_value` INT, "
+               "   `double_value` DOUBLE, "
+               "   `string_value` TEXT, "
+               "   `byte_value` BLOB, "
+               " PRIMARY KEY (`execution_id`, `name`, `is_custom_property`)); "
+      }
+      downgrade_queries {
+        query: " INSERT INTO `ExecutionPropertyTemp` "
+               " SELECT `execution_id`, `name`, `is_custom_property`, "
+               "        `int_value`, `double_value`, `string_value`, "
+               "        `byte_value` "
+               " FROM `ExecutionProperty`; "
+      }
+      downgrade_queries { query: " DROP TABLE `ExecutionProperty`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionPropertyTemp` "
+               "  RENAME TO `ExecutionProperty`; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_execution_property_int` "
+               " ON `ExecutionProperty`(`name`, `is_custom_property`, "
+               " `int_value`) "
+               " WHERE `int_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_execution_property_double` "
+               " ON `ExecutionProperty`(`name`, `is_custom_property`, "
+               " `double_value`) "
+               " WHERE `double_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_execution_property_string` "
+               " ON `ExecutionProperty`(`name`, `is_custom_property`, "
+               " `string_value`) "
+               " WHERE `string_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE TABLE `ContextPropertyTemp` ( "
+               "   `context_id` INT NOT NULL, "
+               "   `name` VARCHAR(255) NOT NULL, "
+               "   `is_custom_property` TINYINT(1) NOT NULL, "
+               "   `int_value` INT, "
+               "   `double_value` DOUBLE, "
+               "   `string_value` TEXT, "
+               "   `byte_value` BLOB, "
+               " PRIMARY KEY (`context_id`, `name`, `is_custom_property`)); "
+      }
+      downgrade_queries {
+        query: " INSERT INTO `ContextPropertyTemp` "
+               " SELECT `context_id`, `name`, `is_custom_property`, "
+               "        `int_value`, `double_value`, `string_value`, "
+               "        `byte_value` "
+               " FROM `ContextProperty`; "
+      }
+      downgrade_queries { query: " DROP TABLE `ContextProperty`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `ContextPropertyTemp` "
+               "  RENAME TO `ContextProperty`; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_context_property_int` "
+               " ON `ContextProperty`(`name`, `is_custom_property`, "
+               " `int_value`) "
+               " WHERE `int_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_context_property_double` "
+               " ON `ContextProperty`(`name`, `is_custom_property`, "
+               " `double_value`) "
+               " WHERE `double_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_context_property_string` "
+               " ON `ContextProperty`(`name`, `is_custom_property`, "
+               " `string_value`) "
+               " WHERE `string_value` IS NOT NULL; "
       }
-      # verify if the downgrading keeps the existing columns
       downgrade_verification {
-        previous_version_setup_queries { query: "DELETE FROM `Artifact`;" }
-        previous_version_setup_queries {
-          query: " INSERT INTO `Artifact` "
-                 " (`id`, `type_id`, `uri`, `state`, `name`, "
-                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
-                 " VALUES (1, 2, 'uri1', 1, NULL, 0, 1); "
-        }
-        previous_version_setup_queries {
-          query: " INSERT INTO `Artifact` "
-                 " (`id`, `type_id`, `uri`, `state`, `name`, "
-                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
-                 " VALUES (2, 3, 'uri2', NULL, 'name2', 1, 0); "
-        }
-        previous_version_setup_queries { query: "DELETE FROM `Execution`;" }
         previous_version_setup_queries {
-          query: " INSERT INTO `Execution` "
-                 " (`id`, `type_id`, `last_known_state`, `name`, "
-                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
-                 " VALUES (1, 2, 1, NULL, 0, 1); "
+          query: "DELETE FROM `ArtifactProperty`;"
         }
-        previous_version_setup_queries { query: "DELETE FROM `Context`;" }
         previous_version_setup_queries {
-          query: " INSERT INTO `Context` "
-                 " (`id`, `type_id`, `name`, "
-                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
-                 " VALUES (1, 2, 'name1', 1, 0); "
+          query: " INSERT INTO `ArtifactProperty` (`artifact_id`, `name`, "
+                 "     `is_custom_property`, `string_value`, `proto_value`) "
+                 " VALUES (1, 'p1', 0, 'abc', NULL), "
+                 "        (1, 'p2', 1, NULL, X'"
+                 "0A2A747970652E676F6F676C65617069732E636F"
+                 "6D2F676F6F676C652E70726F746F6275662E5374"
+                 "7275637412100A0E0A0161120911000000000000"
+                 "F03F'); "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 2 FROM `Artifact`; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT * FROM `Artifact` "
-                 "   WHERE `id` = 1 and `type_id` = 2 and `uri` = 'uri1' "
-                 " ) as T1; "
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `name` = 'p1' AND `string_value` = 'abc'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT * FROM `Artifact` "
-                 "   WHERE `id` = 2 and `type_id` = 3 and `uri` = 'uri2' "
-                 " ) as T1; "
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `name` = 'p2' AND `string_value` = "
+                 "       'mlmd-struct::Cg4KAWESCREAAAAAAADwPw=='; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Execution`; "
+          query: " SELECT count(*) = 0 "
+                 " FROM pragma_table_info('ArtifactProperty') "
+                 " WHERE `name` = 'proto_value'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT * FROM `Execution` "
-                 "   WHERE `id` = 1 and `type_id` = 2 "
-                 " ) as T1; "
+          query: " SELECT count(*) = 0 "
+                 " FROM pragma_table_info('ExecutionProperty') "
+                 " WHERE `name` = 'proto_value'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT * FROM `Context` "
-                 "   WHERE `id` = 1 and `type_id` = 2 "
-                 " ) as T1; "
+          query: " SELECT count(*) = 0 "
+                 " FROM pragma_table_info('ContextProperty') "
+                 " WHERE `name` = 'proto_value'; "
         }
       }
     }
   }
 )pb",
 R"pb(
+  # In v14, we added the `proto_value` column to the property tables, which
+  # stores the struct values and the proto values as serialized
+  # `google.protobuf.Any` messages. The struct values stored as base64 strings
+  # in `string_value` are moved to it by the query executor after the upgrade
+  # queries.
   migration_schemes {
-    key: 5
+    key: 14
     value: {
-      # upgrade Artifact table
       upgrade_queries {
-        query: " ALTER TABLE `Artifact` ADD ( "
-               "   `state` INT, "
-               "   `name` VARCHAR(255), "
-               "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0 "
-               " ), "
-               " ADD CONSTRAINT UniqueArtifactTypeName "
-               " UNIQUE(`type_id`, `name`); "
+        query: " ALTER TABLE `ArtifactProperty` "
+               " ADD COLUMN `proto_value` BLOB; "
       }
-      # upgrade Execution table
       upgrade_queries {
-        query: " ALTER TABLE `Execution` ADD ( "
-               "   `last_known_state` INT, "
-               "   `name` VARCHAR(255), "
-               "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0 "
-               " ), "
-               " ADD CONSTRAINT UniqueExecutionTypeName "
-               " UNIQUE(`type_id`, `name`); "
+        query: " ALTER TABLE `ExecutionProperty` "
+               " ADD COLUMN `proto_value` BLOB; "
       }
-      # upgrade Context table
       upgrade_queries {
-        query: " ALTER TABLE `Context` ADD ( "
-               "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
-               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0 "
-               " ) "
+        query: " ALTER TABLE `ContextProperty` "
+               " ADD COLUMN `proto_value` BLOB; "
       }
-      # check the expected table columns are created properly.
       upgrade_verification {
-        previous_version_setup_queries { query: "DELETE FROM `Artifact`;" }
-        previous_version_setup_queries {
-          query: " INSERT INTO `Artifact` "
-                 " (`id`, `type_id`, `uri`) VALUES (1, 2, 'uri1'); "
-        }
-        previous_version_setup_queries { query: "DELETE FROM `Execution`;" }
         previous_version_setup_queries {
-          query: " INSERT INTO `Execution` "
-                 " (`id`, `type_id`) VALUES (1, 3); "
-        }
-        previous_version_setup_queries {
-          query: " CREATE TABLE IF NOT EXISTS `Context` ( "
-                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-                 "   `type_id` INT NOT NULL, "
-                 "   `name` VARCHAR(255) NOT NULL, "
-                 "   UNIQUE(`type_id`, `name`) "
-                 " ); "
+          query: "DELETE FROM `ArtifactProperty`;"
         }
         previous_version_setup_queries {
-          query: " INSERT INTO `Context` "
-                 " (`id`, `type_id`, `name`) VALUES (1, 2, 'name1'); "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT `id`, `type_id`, `uri`, `state`, `name`, "
-                 "          `create_time_since_epoch`, "
-                 "          `last_update_time_since_epoch` "
-                 "   FROM `Artifact` "
-                 "   WHERE `id` = 1 AND `type_id` = 2 AND `uri` = 'uri1' AND "
-                 "         `create_time_since_epoch` = 0 AND "
-                 "         `last_update_time_since_epoch` = 0 "
-                 " ) as T1; "
+          query: " INSERT INTO `ArtifactProperty` (`artifact_id`, `name`, "
+                 "     `is_custom_property`, `string_value`) "
+                 " VALUES (1, 'p1', 0, 'abc'), "
+                 "        (1, 'p2', 1, "
+                 "         'mlmd-struct::Cg4KAWESCREAAAAAAADwPw=='); "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT `id`, `type_id`, `last_known_state`, `name`, "
-                 "          `create_time_since_epoch`, "
-                 "          `last_update_time_since_epoch` "
-                 "   FROM `Execution` "
-                 "   WHERE `id` = 1 AND `type_id` = 3 AND "
-                 "         `create_time_since_epoch` = 0 AND "
-                 "         `last_update_time_since_epoch` = 0 "
-                 " ) as T1; "
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `name` = 'p1' AND `string_value` = 'abc' AND "
+                 "       `proto_value` IS NULL; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT `id`, `type_id`, `name`, "
-                 "          `create_time_since_epoch`, "
-                 "          `last_update_time_since_epoch` "
-                 "   FROM `Context` "
-                 "   WHERE `id` = 1 AND `type_id` = 2 AND `name` = 'name1' AND "
-                 "         `create_time_since_epoch` = 0 AND "
-                 "         `last_update_time_since_epoch` = 0 "
-                 " ) as T1; "
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `name` = 'p2' AND `string_value` IS NULL AND "
+                 "       `proto_value` = X'"
+                 "0A2A747970652E676F6F676C65617069732E636F"
+                 "6D2F676F6F676C652E70726F746F6275662E5374"
+                 "7275637412100A0E0A0161120911000000000000"
+                 "F03F'; "
         }
       }
-      # downgrade queries from version 6
-      downgrade_queries { query: " DROP TABLE `ParentType`; " }
-      downgrade_queries { query: " DROP TABLE `ParentContext`; " }
-      downgrade_queries {
-        query: " ALTER TABLE `Type` "
-               " DROP COLUMN `version`, "
-               " DROP COLUMN `description`; "
-      }
-      downgrade_queries {
-        query: " ALTER TABLE `Artifact` "
-               " DROP INDEX `idx_artifact_uri`, "
-               " DROP INDEX `idx_artifact_create_time_since_epoch`, "
-               " DROP INDEX `idx_artifact_last_update_time_since_epoch`; "
-      }
-      downgrade_queries {
-        query: " ALTER TABLE `Event` "
-               " DROP INDEX `idx_event_artifact_id`, "
-               " DROP INDEX `idx_event_execution_id`; "
-      }
-      downgrade_queries {
-        query: " ALTER TABLE `Type` "
-               " DROP INDEX `idx_type_name`; "
-      }
+      db_verification { total_num_indexes: 43 total_num_tables: 17 }
+    }
+  }
+)pb",
+R"pb(
+  # In v15, the `uri_hash` column is added to the Artifact table on MySQL,
+  # whose `idx_artifact_uri` only indexes a prefix of the uris. On SQLite,
+  # `idx_artifact_uri` indexes the whole uris, and the schema is unchanged.
+  migration_schemes {
+    key: 15
+    value: {
+      # The archived executions are moved back by the query executor before
+      # the downgrade queries.
       downgrade_queries {
-        query: " ALTER TABLE `Execution` "
-               " DROP INDEX `idx_execution_create_time_since_epoch`, "
-               " DROP INDEX `idx_execution_last_update_time_since_epoch`; "
+        query: " INSERT INTO `Event`( "
+               "   `id`, `artifact_id`, `execution_id`, `type`, "
+               "   `milliseconds_since_epoch`, `path` "
+               " ) "
+               " SELECT `id`, `artifact_id`, `execution_id`, `type`, "
+               "        `milliseconds_since_epoch`, `path` "
+               " FROM `EventArchive`; "
       }
+      downgrade_queries { query: " DROP TABLE IF EXISTS `EventArchive`; " }
       downgrade_queries {
-        query: " ALTER TABLE `Context` "
-               " DROP INDEX `idx_context_create_time_since_epoch`, "
-               " DROP INDEX `idx_context_last_update_time_since_epoch`; "
+        query: " DROP TABLE IF EXISTS `ExecutionArchive`; "
       }
-      # verify if the downgrading keeps the existing columns
       downgrade_verification {
-        previous_version_setup_queries { query: "DELETE FROM `Type`;" }
+        previous_version_setup_queries { query: "DELETE FROM `Event`;" }
         previous_version_setup_queries {
-          query: " INSERT INTO `Type` "
-                 " (`id`, `name`, `version`, `type_kind`, "
-                 "  `description`, `input_type`, `output_type`) "
-                 " VALUES (1, 't1', 'v1', 1, 'desc1', 'input1', 'output1'); "
+          query: "DELETE FROM `EventArchive`;"
         }
         previous_version_setup_queries {
-          query: " INSERT INTO `Type` "
-                 " (`id`, `name`, `version`, `type_kind`, "
-                 "  `description`, `input_type`, `output_type`) "
-                 " VALUES (2, 't2', 'v2', 2, 'desc2', 'input2', 'output2'); "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 2 FROM `Type`; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM ( "
-                 "   SELECT * FROM `Type` "
-                 "   WHERE `id` = 1 AND `name` = 't1' AND type_kind = 1 "
-                 "   AND `input_type` = 'input1' AND `output_type` = 'output1'"
-                 " ) as T1; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'ParentType'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'ParentContext'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'Artifact' AND "
-                 "       `index_name` LIKE 'idx_artifact_%'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'Event' AND "
-                 "       `index_name` LIKE 'idx_event_%'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'ParentContext' AND "
-                 "       `index_name` LIKE 'idx_parentcontext_%'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'Type' AND "
-                 "       `index_name` LIKE 'idx_type_%'; "
+          query: " INSERT INTO `EventArchive` "
+                 " (`id`, `artifact_id`, `execution_id`, `type`) "
+                 " VALUES (1, 2, 3, 4); "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'Execution' AND "
-                 "       `index_name` LIKE 'idx_execution_%'; "
+          query: " SELECT count(*) = 1 FROM `Event` "
+                 " WHERE `id` = 1 AND `artifact_id` = 2 AND "
+                 "       `execution_id` = 3 AND `type` = 4; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'Context' AND "
-                 "       `index_name` LIKE 'idx_context_%'; "
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'table' AND "
+                 "       `name` IN ('ExecutionArchive', 'EventArchive'); "
         }
       }
+      db_verification { total_num_indexes: 43 total_num_tables: 17 }
     }
   }
 )pb",
 R"pb(
-  # In v6, to support parental type and parental context, we added two
-  # tables `ParentType` and `ParentContext`. In addition, we added `version`
-  # and `description` in the `Type` table for improving type registrations.
-  # We introduce indices on Type.name, Artifact.uri, Event's artifact_id and
-  # execution_id, and create_time_since_epoch, last_update_time_since_epoch
-  # for all nodes.
+  # In v16, we added the ExecutionArchive and EventArchive tables, to which the
+  # cold executions and their events are moved, so that the Execution,
+  # ExecutionProperty and Event tables only keep the recent ones.
   migration_schemes {
-    key: 6
+    key: 16
     value: {
       upgrade_queries {
-        query: " CREATE TABLE IF NOT EXISTS `ParentType` ( "
-               "   `type_id` INT NOT NULL, "
-               "   `parent_type_id` INT NOT NULL, "
-               " PRIMARY KEY (`type_id`, `parent_type_id`)); "
-      }
-      upgrade_queries {
-        query: " CREATE TABLE IF NOT EXISTS `ParentContext` ( "
-               "   `context_id` INT NOT NULL, "
-               "   `parent_context_id` INT NOT NULL, "
-               " PRIMARY KEY (`context_id`, `parent_context_id`)); "
-      }
-      upgrade_queries {
-        query: " ALTER TABLE `Type` ADD ( "
-               "   `version` VARCHAR(255), "
-               "   `description` TEXT "
+        query: " CREATE TABLE IF NOT EXISTS `ExecutionArchive` ( "
+               "   `id` INTEGER PRIMARY KEY, "
+               "   `last_update_time_since_epoch` INT NOT NULL, "
+               "   `execution` BLOB NOT NULL "
                " ); "
       }
       upgrade_queries {
-        query: " ALTER TABLE `Artifact` "
-               " ADD INDEX `idx_artifact_uri`(`uri`(255)), "
-               "  ADD INDEX `idx_artifact_create_time_since_epoch` "
-               "             (`create_time_since_epoch`), "
-               "  ADD INDEX `idx_artifact_last_update_time_since_epoch` "
-               "             (`last_update_time_since_epoch`); "
-      }
-      upgrade_queries {
-        query: " ALTER TABLE `Event` "
-               " ADD INDEX `idx_event_artifact_id` (`artifact_id`), "
-               " ADD INDEX `idx_event_execution_id` (`execution_id`); "
-      }
-      upgrade_queries {
-        query: " ALTER TABLE `ParentContext` "
-               " ADD INDEX "
-               "  `idx_parentcontext_parent_context_id` (`parent_context_id`);"
-      }
-      upgrade_queries {
-        query: " ALTER TABLE `Type` "
-               " ADD INDEX `idx_type_name` (`name`);"
+        query: " CREATE TABLE IF NOT EXISTS `EventArchive` ( "
+               "   `id` INTEGER PRIMARY KEY, "
+               "   `artifact_id` INT NOT NULL, "
+               "   `execution_id` INT NOT NULL, "
+               "   `type` INT NOT NULL, "
+               "   `milliseconds_since_epoch` INT, "
+               "   `path` TEXT "
+               " ); "
       }
       upgrade_queries {
-        query: " ALTER TABLE `Execution` "
-               "  ADD INDEX `idx_execution_create_time_since_epoch` "
-               "             (`create_time_since_epoch`), "
-               "  ADD INDEX `idx_execution_last_update_time_since_epoch` "
-               "             (`last_update_time_since_epoch`); "
+        query: " CREATE INDEX IF NOT EXISTS `idx_event_archive_artifact_id` "
+               " ON `EventArchive`(`artifact_id`); "
       }
       upgrade_queries {
-        query: " ALTER TABLE `Context` "
-               "  ADD INDEX `idx_context_create_time_since_epoch` "
-               "             (`create_time_since_epoch`), "
-               "  ADD INDEX `idx_context_last_update_time_since_epoch` "
-               "             (`last_update_time_since_epoch`); "
+        query: " CREATE INDEX IF NOT EXISTS `idx_event_archive_execution_id` "
+               " ON `EventArchive`(`execution_id`); "
       }
-      # check the expected table columns are created properly.
       upgrade_verification {
-        # check existing rows in previous Type table are migrated properly.
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Type` WHERE "
-                 " `id` = 1 AND `type_kind` = 1 AND `name` = 'artifact_type'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Type` WHERE "
-                 " `id` = 2 AND `type_kind` = 0 AND `name` = 'execution_type' "
-                 " AND `input_type` = 'input' AND `output_type` = 'output'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM ( "
-                 "   SELECT `type_id`, `parent_type_id` "
-                 "   FROM `ParentType` "
-                 " ) as T1; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM ( "
-                 "   SELECT `context_id`, `parent_context_id` "
-                 "   FROM `ParentContext` "
-                 " ) as T1; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Artifact' AND "
-                 "       `index_name` = 'idx_artifact_uri'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Artifact' AND "
-                 "       `index_name` = 'idx_artifact_create_time_since_epoch';"
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Artifact' AND `index_name` = "
-                 "       'idx_artifact_last_update_time_since_epoch';"
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Event' AND "
-                 "       `index_name` = 'idx_event_artifact_id'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Event' AND "
-                 "       `index_name` = 'idx_event_execution_id'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'ParentContext' AND "
-                 "       `index_name` = 'idx_parentcontext_parent_context_id'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Type' AND "
-                 "       `index_name` = 'idx_type_name'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Execution' AND `index_name` = "
-                 "       'idx_execution_create_time_since_epoch'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Execution' AND `index_name` = "
-                 "       'idx_execution_last_update_time_since_epoch'; "
-        }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Context' AND "
-                 "       `index_name` = 'idx_context_create_time_since_epoch'; "
+          query: " SELECT count(*) = 2 FROM `sqlite_master` "
+                 " WHERE `type` = 'table' AND "
+                 "       `name` IN ('ExecutionArchive', 'EventArchive'); "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Context' AND `index_name` = "
-                 "       'idx_context_last_update_time_since_epoch'; "
+          query: " SELECT count(*) = 0 FROM `ExecutionArchive`; "
         }
       }
-      # downgrade queries from version 7
-      # Note v7 for MySQL used mediumtext for string_value, when downgrade
-      # the long text will be truncated to 65536 chars.
+      db_verification { total_num_indexes: 45 total_num_tables: 19 }
+      # Downgrade from v17. The interned string values are moved back to the
+      # `string_value` column, and the property tables are rebuilt without the
+      # `string_value_id` column.
       downgrade_queries {
-        query: " ALTER TABLE `ArtifactProperty` DROP COLUMN `byte_value`; "
+        query: " UPDATE `ArtifactProperty` SET `string_value` = ( "
+               "   SELECT `value` FROM `PropertyStringValue` "
+               "   WHERE `id` = `ArtifactProperty`.`string_value_id`) "
+               " WHERE `string_value_id` IS NOT NULL; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `ExecutionProperty` DROP COLUMN `byte_value`; "
+        query: " UPDATE `ExecutionProperty` SET `string_value` = ( "
+               "   SELECT `value` FROM `PropertyStringValue` "
+               "   WHERE `id` = `ExecutionProperty`.`string_value_id`) "
+               " WHERE `string_value_id` IS NOT NULL; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `ContextProperty` DROP COLUMN `byte_value`; "
+        query: " UPDATE `ContextProperty` SET `string_value` = ( "
+               "   SELECT `value` FROM `PropertyStringValue` "
+               "   WHERE `id` = `ContextProperty`.`string_value_id`) "
+               " WHERE `string_value_id` IS NOT NULL; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `EventPath` DROP INDEX `idx_eventpath_event_id`; "
+        query: " CREATE TABLE `ArtifactPropertyTemp` ( "
+               "   `artifact_id` INT NOT NULL, "
+               "   `name` VARCHAR(255) NOT NULL, "
+               "   `is_custom_property` TINYINT(1) NOT NULL, "
+               "   `int_value` INT, "
+               "   `double_value` DOUBLE, "
+               "   `string_value` TEXT, "
+               "   `byte_value` BLOB, "
+               "   `proto_value` BLOB, "
+               " PRIMARY KEY (`artifact_id`, `name`, `is_custom_property`)); "
       }
       downgrade_queries {
-        query: " UPDATE `ArtifactProperty` "
-               " SET `string_value` = SUBSTRING(`string_value`, 1, 65535); "
+        query: " INSERT INTO `ArtifactPropertyTemp` "
+               " SELECT `artifact_id`, `name`, `is_custom_property`, "
+               "        `int_value`, `double_value`, `string_value`, "
+               "        `byte_value`, `proto_value` "
+               " FROM `ArtifactProperty`; "
       }
+      downgrade_queries { query: " DROP TABLE `ArtifactProperty`; " }
       downgrade_queries {
-        query: " ALTER TABLE `ArtifactProperty` "
-               " MODIFY COLUMN `string_value` TEXT; "
+        query: " ALTER TABLE `ArtifactPropertyTemp` RENAME TO `ArtifactProperty`; "
       }
       downgrade_queries {
-        query: " UPDATE `ExecutionProperty` "
-               " SET `string_value` = SUBSTRING(`string_value`, 1, 65535); "
+        query: " CREATE INDEX IF NOT EXISTS `idx_artifact_property_int` "
+               " ON `ArtifactProperty`(`name`, `is_custom_property`, "
+               " `int_value`) "
+               " WHERE `int_value` IS NOT NULL; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `ExecutionProperty` "
-               " MODIFY COLUMN `string_value` TEXT; "
+        query: " CREATE INDEX IF NOT EXISTS `idx_artifact_property_double` "
+               " ON `ArtifactProperty`(`name`, `is_custom_property`, "
+               " `double_value`) "
+               " WHERE `double_value` IS NOT NULL; "
       }
       downgrade_queries {
-        query: " UPDATE `ContextProperty` "
-               " SET `string_value` = SUBSTRING(`string_value`, 1, 65535); "
+        query: " CREATE INDEX IF NOT EXISTS `idx_artifact_property_string` "
+               " ON `ArtifactProperty`(`name`, `is_custom_property`, "
+               " `string_value`) "
+               " WHERE `string_value` IS NOT NULL; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `ContextProperty` "
-               " MODIFY COLUMN `string_value` TEXT; "
+        query: " CREATE TABLE `ExecutionPropertyTemp` ( "
+               "   `execution_id` INT NOT NULL, "
+               "   `name` VARCHAR(255) NOT NULL, "
+               "   `is_custom_property` TINYINT(1) NOT NULL, "
+               "   `int_value` INT, "
+               "   `double_value` DOUBLE, "
+               "   `string_value` TEXT, "
+               "   `byte_value` BLOB, "
+               "   `proto_value` BLOB, "
+               " PRIMARY KEY (`execution_id`, `name`, `is_custom_property`)); "
       }
-      # verify if the downgrading keeps the existing columns
-      downgrade_verification {
-        previous_version_setup_queries {
-          query: "DELETE FROM `ArtifactProperty`;"
-        }
-        previous_version_setup_queries {
-          query: "DELETE FROM `ExecutionProperty`;"
-        }
-        previous_version_setup_queries {
-          query: "DELETE FROM `ContextProperty`;"
-        }
+      downgrade_queries {
+        query: " INSERT INTO `ExecutionPropertyTemp` "
+               " SELECT `execution_id`, `name`, `is_custom_property`, "
+               "        `int_value`, `double_value`, `string_value`, "
+               "        `byte_value`, `proto_value` "
+               " FROM `ExecutionProperty`; "
+      }
+      downgrade_queries { query: " DROP TABLE `ExecutionProperty`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionPropertyTemp` RENAME TO `ExecutionProperty`; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_execution_property_int` "
+               " ON `ExecutionProperty`(`name`, `is_custom_property`, "
+               " `int_value`) "
+               " WHERE `int_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_execution_property_double` "
+               " ON `ExecutionProperty`(`name`, `is_custom_property`, "
+               " `double_value`) "
+               " WHERE `double_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_execution_property_string` "
+               " ON `ExecutionProperty`(`name`, `is_custom_property`, "
+               " `string_value`) "
+               " WHERE `string_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE TABLE `ContextPropertyTemp` ( "
+               "   `context_id` INT NOT NULL, "
+               "   `name` VARCHAR(255) NOT NULL, "
+               "   `is_custom_property` TINYINT(1) NOT NULL, "
+               "   `int_value` INT, "
+               "   `double_value` DOUBLE, "
+               "   `string_value` TEXT, "
+               "   `byte_value` BLOB, "
+               "   `proto_value` BLOB, "
+               " PRIMARY KEY (`context_id`, `name`, `is_custom_property`)); "
+      }
+      downgrade_queries {
+        query: " INSERT INTO `ContextPropertyTemp` "
+               " SELECT `context_id`, `name`, `is_custom_property`, "
+               "        `int_value`, `double_value`, `string_value`, "
+               "        `byte_value`, `proto_value` "
+               " FROM `ContextProperty`; "
+      }
+      downgrade_queries { query: " DROP TABLE `ContextProperty`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `ContextPropertyTemp` RENAME TO `ContextProperty`; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_context_property_int` "
+               " ON `ContextProperty`(`name`, `is_custom_property`, "
+               " `int_value`) "
+               " WHERE `int_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_context_property_double` "
+               " ON `ContextProperty`(`name`, `is_custom_property`, "
+               " `double_value`) "
+               " WHERE `double_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_context_property_string` "
+               " ON `ContextProperty`(`name`, `is_custom_property`, "
+               " `string_value`) "
+               " WHERE `string_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " DROP TABLE IF EXISTS `PropertyStringValue`; "
+      }
+      downgrade_verification {
         previous_version_setup_queries {
-          query: " INSERT INTO `ArtifactProperty` "
-                 " (`artifact_id`, `name`, `string_value`) "
-                 " VALUES (1, 'p1', CONCAT('_prefix_', REPEAT('a', 160000))), "
-                 "        (1, 'p2', 'abc'); "
+          query: "DELETE FROM `ArtifactProperty`;"
         }
         previous_version_setup_queries {
-          query: " INSERT INTO `ExecutionProperty` "
-                 " (`execution_id`, `name`, `string_value`) "
-                 " VALUES (1, 'p1', CONCAT('_prefix_', REPEAT('e', 160000))), "
-                 "        (1, 'p2', 'abc'); "
+          query: "DELETE FROM `PropertyStringValue`;"
         }
         previous_version_setup_queries {
-          query: " INSERT INTO `ContextProperty` "
-                 " (`context_id`, `name`, `string_value`) "
-                 " VALUES (1, 'p1', CONCAT('_prefix_', REPEAT('c', 160000))), "
-                 "        (1, 'p2', 'abc'); "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'EventPath' AND "
-                 "       `index_name` = 'idx_eventpath_event_id'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 3 FROM `information_schema`.`columns` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` IN ('ArtifactProperty', "
-                 "           'ExecutionProperty', 'ContextProperty') AND "
-                 "       `column_name` = 'string_value' AND "
-                 "       `data_type` = 'text'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`columns` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` IN ('ArtifactProperty', "
-                 "           'ExecutionProperty', 'ContextProperty') AND "
-                 "       `column_name` = 'byte_value'; "
+          query: " INSERT INTO `PropertyStringValue` (`id`, `value`) "
+                 " VALUES (1, 'abc'); "
         }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
-                 " WHERE `artifact_id` = 1 AND `name` = 'p1' AND "
-                 "   `string_value` = CONCAT('_prefix_', REPEAT('a', 65527)); "
+        previous_version_setup_queries {
+          query: " INSERT INTO `ArtifactProperty` "
+                 " (`artifact_id`, `name`, `is_custom_property`, "
+                 "  `string_value_id`) "
+                 " VALUES (1, 'p1', 0, 1); "
         }
         post_migration_verification_queries {
           query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
-                 " WHERE `artifact_id` = 1 AND `name` = 'p2' AND "
-                 "       `string_value` = 'abc'; "
+                 " WHERE `name` = 'p1' AND `string_value` = 'abc'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `ExecutionProperty` "
-                 " WHERE `execution_id` = 1 AND `name` = 'p1' AND "
-                 "   `string_value` = CONCAT('_prefix_', REPEAT('e', 65527)); "
+          query: " SELECT count(*) = 0 "
+                 " FROM pragma_table_info('ArtifactProperty') "
+                 " WHERE `name` = 'string_value_id'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `ExecutionProperty` "
-                 " WHERE `execution_id` = 1 AND `name` = 'p2' AND "
-                 "       `string_value` = 'abc'; "
+          query: " SELECT count(*) = 0 "
+                 " FROM pragma_table_info('ExecutionProperty') "
+                 " WHERE `name` = 'string_value_id'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `ContextProperty` "
-                 " WHERE `context_id` = 1 AND `name` = 'p1' AND "
-                 "   `string_value` = CONCAT('_prefix_', REPEAT('c', 65527)); "
+          query: " SELECT count(*) = 0 "
+                 " FROM pragma_table_info('ContextProperty') "
+                 " WHERE `name` = 'string_value_id'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `ContextProperty` "
-                 " WHERE `context_id` = 1 AND `name` = 'p2' AND "
-                 "       `string_value` = 'abc'; "
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'table' AND `name` = 'PropertyStringValue'; "
         }
       }
     }
   }
 )pb",
 R"pb(
-  # In v7, we added byte_value for property tables for better storing binary
-  # property values. For MySQL, we extends string_value column to be
-  # MEDIUMTEXT in order to persist string value with size upto 16MB. In
-  # addition, we added index for `EventPath` to improve Event reads.
+  # In v17, we added the PropertyStringValue table, in which the repetitive
+  # string property values, e.g., the names of the pipelines and components,
+  # may be interned, and the `string_value_id` column to the property tables,
+  # which refers to the interned value instead of repeating it in the
+  # `string_value` column.
   migration_schemes {
-    key: 7
+    key: 17
     value: {
       upgrade_queries {
-        query: " ALTER TABLE `ArtifactProperty` "
-               " MODIFY COLUMN `string_value` MEDIUMTEXT, "
-               " ADD COLUMN `byte_value` MEDIUMBLOB; "
+        query: " CREATE TABLE IF NOT EXISTS `PropertyStringValue` ( "
+               "   `id` INTEGER PRIMARY KEY AUTOINCREMENT, "
+               "   `value` VARCHAR(255) NOT NULL, "
+               "   UNIQUE(`value`) "
+               " ); "
       }
       upgrade_queries {
-        query: " ALTER TABLE `ExecutionProperty` "
-               " MODIFY COLUMN `string_value` MEDIUMTEXT, "
-               " ADD COLUMN `byte_value` MEDIUMBLOB; "
+        query: " ALTER TABLE `ArtifactProperty` ADD COLUMN `string_value_id` INT; "
       }
       upgrade_queries {
-        query: " ALTER TABLE `ContextProperty` "
-               " MODIFY COLUMN `string_value` MEDIUMTEXT, "
-               " ADD COLUMN `byte_value` MEDIUMBLOB; "
+        query: " ALTER TABLE `ExecutionProperty` ADD COLUMN `string_value_id` INT; "
       }
       upgrade_queries {
-        query: " ALTER TABLE `EventPath` "
-               " ADD INDEX `idx_eventpath_event_id` (`event_id`); "
+        query: " ALTER TABLE `ContextProperty` ADD COLUMN `string_value_id` INT; "
       }
-      # check the expected table columns are created properly.
       upgrade_verification {
-        # check existing rows in previous Type table are migrated properly.
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `ArtifactProperty` WHERE "
-                 " `byte_value` IS NOT NULL; "
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'table' AND `name` = 'PropertyStringValue'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `ExecutionProperty` WHERE "
-                 " `byte_value` IS NOT NULL; "
+          query: " SELECT count(*) = 1 "
+                 " FROM pragma_table_info('ArtifactProperty') "
+                 " WHERE `name` = 'string_value_id'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `ContextProperty` WHERE "
-                 " `byte_value` IS NOT NULL; "
+          query: " SELECT count(*) = 1 "
+                 " FROM pragma_table_info('ExecutionProperty') "
+                 " WHERE `name` = 'string_value_id'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'EventPath' AND "
-                 "       `index_name` = 'idx_eventpath_event_id'; "
+          query: " SELECT count(*) = 1 "
+                 " FROM pragma_table_info('ContextProperty') "
+                 " WHERE `name` = 'string_value_id'; "
         }
+      }
+      db_verification { total_num_indexes: 46 total_num_tables: 20 }
+      # Downgrade from v18.
+      downgrade_queries {
+        query: " DROP INDEX `idx_execution_type_id_last_known_state`; "
+      }
+      downgrade_verification {
         post_migration_verification_queries {
-          query: " SELECT count(*) = 3 FROM `information_schema`.`columns` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` IN ('ArtifactProperty', "
-                 "           'ExecutionProperty', 'ContextProperty') AND "
-                 "       `column_name` = 'string_value' AND "
-                 "       `data_type` = 'mediumtext'; "
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND "
+                 "       `name` = 'idx_execution_type_id_last_known_state'; "
         }
       }
-      db_verification { total_num_indexes: 45 total_num_tables: 15 }
-      # downgrade queries from version 8
+    }
+  }
+)pb",
+R"pb(
+  # In v18, we added a partial index on the active executions, i.e., the NEW
+  # and RUNNING ones, of each type, so that the executions to be scheduled
+  # are found without scanning the terminal ones.
+  migration_schemes {
+    key: 18
+    value: {
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_execution_type_id_last_known_state` "
+               " ON `Execution`( "
+               "   `type_id`, `last_known_state`, "
+               "   `last_update_time_since_epoch`, `id`) "
+               " WHERE `last_known_state` IN (1, 2); "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND "
+                 "       `name` = 'idx_execution_type_id_last_known_state'; "
+        }
+      }
+      db_verification { total_num_indexes: 47 total_num_tables: 20 }
+      # Downgrade from v19.
       downgrade_queries {
-        query: " ALTER TABLE `Event` "
-               " DROP INDEX UniqueEvent; "
+        query: " DROP INDEX `idx_event_milliseconds_since_epoch`; "
+      }
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND "
+                 "       `name` = 'idx_event_milliseconds_since_epoch'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v19, we added an index on the events by time, so that the events
+  # recorded in a time range are read in the time order without scanning the
+  # Event table.
+  migration_schemes {
+    key: 19
+    value: {
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_event_milliseconds_since_epoch` "
+               " ON `Event`(`milliseconds_since_epoch`, `id`); "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND "
+                 "       `name` = 'idx_event_milliseconds_since_epoch'; "
+        }
       }
+      db_verification { total_num_indexes: 48 total_num_tables: 20 }
+      # Downgrade from v20. The compressed values are moved back to the
+      # `byte_value` column, and the property tables are rebuilt without the
+      # `compressed_value` column.
       downgrade_queries {
-        query: " ALTER TABLE `Event` "
-               " ADD INDEX `idx_event_artifact_id` (`artifact_id`); "
+        query: " UPDATE `ArtifactProperty` "
+               " SET `byte_value` = `compressed_value` "
+               " WHERE `compressed_value` IS NOT NULL; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `ArtifactProperty` "
-               " DROP INDEX `idx_artifact_property_int`; "
+        query: " UPDATE `ExecutionProperty` "
+               " SET `byte_value` = `compressed_value` "
+               " WHERE `compressed_value` IS NOT NULL; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `ArtifactProperty` "
-               " DROP INDEX `idx_artifact_property_double`; "
+        query: " UPDATE `ContextProperty` "
+               " SET `byte_value` = `compressed_value` "
+               " WHERE `compressed_value` IS NOT NULL; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `ArtifactProperty` "
-               " DROP INDEX `idx_artifact_property_string`; "
+        query: " CREATE TABLE `ArtifactPropertyTemp` ( "
+               "   `artifact_id` INT NOT NULL, "
+               "   `name` VARCHAR(255) NOT NULL, "
+               "   `is_custom_property` TINYINT(1) NOT NULL, "
+               "   `int_value` INT, "
+               "   `double_value` DOUBLE, "
+               "   `string_value` TEXT, "
+               "   `byte_value` BLOB, "
+               "   `proto_value` BLOB, "
+               "   `string_value_id` INT, "
+               " PRIMARY KEY (`artifact_id`, `name`, `is_custom_property`)); "
       }
       downgrade_queries {
-        query: " ALTER TABLE `ExecutionProperty` "
-               " DROP INDEX `idx_execution_property_int`; "
+        query: " INSERT INTO `ArtifactPropertyTemp` "
+               " SELECT `artifact_id`, `name`, `is_custom_property`, "
+               "        `int_value`, `double_value`, `string_value`, "
+               "        `byte_value`, `proto_value`, `string_value_id` "
+               " FROM `ArtifactProperty`; "
       }
+      downgrade_queries { query: " DROP TABLE `ArtifactProperty`; " }
       downgrade_queries {
-        query: " ALTER TABLE `ExecutionProperty` "
-               " DROP INDEX `idx_execution_property_double`; "
+        query: " ALTER TABLE `ArtifactPropertyTemp` RENAME TO `ArtifactProperty`; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `ExecutionProperty` "
-               " DROP INDEX `idx_execution_property_string`; "
+        query: " CREATE INDEX IF NOT EXISTS `idx_artifact_property_int` "
+               " ON `ArtifactProperty`(`name`, `is_custom_property`, "
+               " `int_value`) "
+               " WHERE `int_value` IS NOT NULL; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `ContextProperty` "
-               " DROP INDEX `idx_context_property_int`; "
+        query: " CREATE INDEX IF NOT EXISTS `idx_artifact_property_double` "
+               " ON `ArtifactProperty`(`name`, `is_custom_property`, "
+               " `double_value`) "
+               " WHERE `double_value` IS NOT NULL; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `ContextProperty` "
-               " DROP INDEX `idx_context_property_double`; "
+        query: " CREATE INDEX IF NOT EXISTS `idx_artifact_property_string` "
+               " ON `ArtifactProperty`(`name`, `is_custom_property`, "
+               " `string_value`) "
+               " WHERE `string_value` IS NOT NULL; "
       }
       downgrade_queries {
-        query: " ALTER TABLE `ContextProperty` "
-               " DROP INDEX `idx_context_property_string`; "
+        query: " CREATE TABLE `ExecutionPropertyTemp` ( "
+               "   `execution_id` INT NOT NULL, "
+               "   `name` VARCHAR(255) NOT NULL, "
+               "   `is_custom_property` TINYINT(1) NOT NULL, "
+               "   `int_value` INT, "
+               "   `double_value` DOUBLE, "
+               "   `string_value` TEXT, "
+               "   `byte_value` BLOB, "
+               "   `proto_value` BLOB, "
+               "   `string_value_id` INT, "
+               " PRIMARY KEY (`execution_id`, `name`, `is_custom_property`)); "
       }
-      downgrade_verification {
-        previous_version_setup_queries {
-          query: " INSERT INTO `Event` "
-                 " (`id`, `artifact_id`, `execution_id`, `type`, "
-                 " `milliseconds_since_epoch`) "
-                 " VALUES (1, 1, 1, 1, 1); "
-        }
+      downgrade_queries {
+        query: " INSERT INTO `ExecutionPropertyTemp` "
+               " SELECT `execution_id`, `name`, `is_custom_property`, "
+               "        `int_value`, `double_value`, `string_value`, "
+               "        `byte_value`, `proto_value`, `string_value_id` "
+               " FROM `ExecutionProperty`; "
+      }
+      downgrade_queries { query: " DROP TABLE `ExecutionProperty`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionPropertyTemp` RENAME TO `ExecutionProperty`; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_execution_property_int` "
+               " ON `ExecutionProperty`(`name`, `is_custom_property`, "
+               " `int_value`) "
+               " WHERE `int_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_execution_property_double` "
+               " ON `ExecutionProperty`(`name`, `is_custom_property`, "
+               " `double_value`) "
+               " WHERE `double_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_execution_property_string` "
+               " ON `ExecutionProperty`(`name`, `is_custom_property`, "
+               " `string_value`) "
+               " WHERE `string_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE TABLE `ContextPropertyTemp` ( "
+               "   `context_id` INT NOT NULL, "
+               "   `name` VARCHAR(255) NOT NULL, "
+               "   `is_custom_property` TINYINT(1) NOT NULL, "
+               "   `int_value` INT, "
+               "   `double_value` DOUBLE, "
+               "   `string_value` TEXT, "
+               "   `byte_value` BLOB, "
+               "   `proto_value` BLOB, "
+               "   `string_value_id` INT, "
+               " PRIMARY KEY (`context_id`, `name`, `is_custom_property`)); "
+      }
+      downgrade_queries {
+        query: " INSERT INTO `ContextPropertyTemp` "
+               " SELECT `context_id`, `name`, `is_custom_property`, "
+               "        `int_value`, `double_value`, `string_value`, "
+               "        `byte_value`, `proto_value`, `string_value_id` "
+               " FROM `ContextProperty`; "
+      }
+      downgrade_queries { query: " DROP TABLE `ContextProperty`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `ContextPropertyTemp` RENAME TO `ContextProperty`; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_context_property_int` "
+               " ON `ContextProperty`(`name`, `is_custom_property`, "
+               " `int_value`) "
+               " WHERE `int_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_context_property_double` "
+               " ON `ContextProperty`(`name`, `is_custom_property`, "
+               " `double_value`) "
+               " WHERE `double_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_context_property_string` "
+               " ON `ContextProperty`(`name`, `is_custom_property`, "
+               " `string_value`) "
+               " WHERE `string_value` IS NOT NULL; "
+      }
+      downgrade_verification {
         previous_version_setup_queries {
-          query: " INSERT INTO `EventPath` "
-                 " (`event_id`, `is_index_step`, `step_index`, `step_key`) "
-                 " VALUES (1, 1, 1, 'a'); "
+          query: "DELETE FROM `ArtifactProperty`;"
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `ArtifactProperty` "
+                 " (`artifact_id`, `name`, `is_custom_property`, "
+                 "  `compressed_value`) "
+                 " VALUES (1, 'p1', 0, X'0A03616263'); "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Event` "
-                 " WHERE `artifact_id` = 1 AND `execution_id` = 1; "
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `name` = 'p1' AND `byte_value` = X'0A03616263'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `EventPath` "
-                 " WHERE `event_id` = 1; "
+          query: " SELECT count(*) = 0 "
+                 " FROM pragma_table_info('ArtifactProperty') "
+                 " WHERE `name` = 'compressed_value'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'Event' AND "
-                 "       `index_name` = 'UniqueEvent'; "
+          query: " SELECT count(*) = 0 "
+                 " FROM pragma_table_info('ExecutionProperty') "
+                 " WHERE `name` = 'compressed_value'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'Event' AND "
-                 "       `index_name` = 'idx_event_artifact_id'; "
+          query: " SELECT count(*) = 0 "
+                 " FROM pragma_table_info('ContextProperty') "
+                 " WHERE `name` = 'compressed_value'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'Event' AND "
-                 "       `index_name` = 'idx_event_execution_id'; "
+          query: " SELECT count(*) = 0 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND "
+                 "       `name` LIKE 'idx_%_property_compressed'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v20, we added the `compressed_value` column to the property tables,
+  # which holds the compressed large values in place of their value columns,
+  # and the partial indices of the compressed values, so that the filters on
+  # the compressed properties are rejected rather than matching nothing.
+  migration_schemes {
+    key: 20
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               " ADD COLUMN `compressed_value` BLOB; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               " ADD COLUMN `compressed_value` BLOB; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               " ADD COLUMN `compressed_value` BLOB; "
+      }
+      # The values compressed in the `byte_value` column by v19 are moved.
+      upgrade_queries {
+        query: " UPDATE `ArtifactProperty` "
+               " SET `compressed_value` = `byte_value`, `byte_value` = NULL "
+               " WHERE `byte_value` IS NOT NULL; "
+      }
+      upgrade_queries {
+        query: " UPDATE `ExecutionProperty` "
+               " SET `compressed_value` = `byte_value`, `byte_value` = NULL "
+               " WHERE `byte_value` IS NOT NULL; "
+      }
+      upgrade_queries {
+        query: " UPDATE `ContextProperty` "
+               " SET `compressed_value` = `byte_value`, `byte_value` = NULL "
+               " WHERE `byte_value` IS NOT NULL; "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_artifact_property_compressed` "
+               " ON `ArtifactProperty`(`name`, `is_custom_property`) "
+               " WHERE `compressed_value` IS NOT NULL; "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS "
+               "   `idx_execution_property_compressed` "
+               " ON `ExecutionProperty`(`name`, `is_custom_property`) "
+               " WHERE `compressed_value` IS NOT NULL; "
+      }
+      upgrade_queries {
+        query: " CREATE INDEX IF NOT EXISTS `idx_context_property_compressed` "
+               " ON `ContextProperty`(`name`, `is_custom_property`) "
+               " WHERE `compressed_value` IS NOT NULL; "
+      }
+      upgrade_verification {
+        previous_version_setup_queries {
+          query: "DELETE FROM `ArtifactProperty`;"
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `ArtifactProperty` "
+                 " (`artifact_id`, `name`, `is_custom_property`, `byte_value`) "
+                 " VALUES (1, 'p1', 0, X'0A03616263'); "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'EventPath' AND "
-                 "       `index_name` = 'idx_eventpath_event_id'; "
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `name` = 'p1' AND `byte_value` IS NULL AND "
+                 "       `compressed_value` = X'0A03616263'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'ArtifactProperty' AND "
-                 "       `index_name` LIKE 'idx_artifact_property_%'; "
+          query: " SELECT count(*) = 1 "
+                 " FROM pragma_table_info('ArtifactProperty') "
+                 " WHERE `name` = 'compressed_value'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'ExecutionProperty' AND "
-                 "       `index_name` LIKE 'idx_execution_property_%'; "
+          query: " SELECT count(*) = 1 "
+                 " FROM pragma_table_info('ExecutionProperty') "
+                 " WHERE `name` = 'compressed_value'; "
         }
         post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
-                 "       `table_name` = 'ContextProperty' AND "
-                 "       `index_name` LIKE 'idx_context_property_%'; "
+          query: " SELECT count(*) = 1 "
+                 " FROM pragma_table_info('ContextProperty') "
+                 " WHERE `name` = 'compressed_value'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 3 FROM `sqlite_master` "
+                 " WHERE `type` = 'index' AND "
+                 "       `name` LIKE 'idx_%_property_compressed'; "
         }
       }
+      db_verification { total_num_indexes: 51 total_num_tables: 20 }
     }
   }
-)pb",
-R"pb(
-  # In v8, we added index for `ArtifactProperty`, `ExecutionProperty`,
-  # `ContextProperty` to improve property queries on name.
-  migration_schemes {
-    key: 8
-    value: {
-      upgrade_queries {
-        query: " ALTER TABLE `ArtifactProperty` "
-               "  ADD INDEX `idx_artifact_property_int`( "
-               "    `name`, `is_custom_property`, `int_value`); "
-      }
-      upgrade_queries {
-        query: " ALTER TABLE `ArtifactProperty` "
-               "  ADD INDEX `idx_artifact_property_double`( "
-               "    `name`, `is_custom_property`, `double_value`); "
-      }
-      upgrade_queries {
-        query: " ALTER TABLE `ArtifactProperty` "
-               "  ADD INDEX `idx_artifact_property_string`( "
-               "    `name`, `is_custom_property`, `string_value`(255)); "
-      }
-      upgrade_queries {
-        query: " ALTER TABLE `ExecutionProperty` "
-               "  ADD INDEX `idx_execution_property_int`( "
-               "    `name`, `is_custom_property`, `int_value`); "
-      }
-      upgrade_queries {
-        query: " ALTER TABLE `ExecutionProperty` "
-               "  ADD INDEX `idx_execution_property_double`( "
-               "    `name`, `is_custom_property`, `double_value`); "
-      }
-      upgrade_queries {
-        query: " ALTER TABLE `ExecutionProperty` "
-               "  ADD INDEX `idx_execution_property_string`( "
-               "    `name`, `is_custom_property`, `string_value`(255)); "
-      }
-      upgrade_queries {
-        query: " ALTER TABLE `ContextProperty` "
-               "  ADD INDEX `idx_context_property_int`( "
-               "    `name`, `is_custom_property`, `int_value`); "
-      }
-      upgrade_queries {
-        query: " ALTER TABLE `ContextProperty` "
-               "  ADD INDEX `idx_context_property_double`( "
-               "    `name`, `is_custom_property`, `double_value`); "
-      }
-      upgrade_queries {
-        query: " ALTER TABLE `ContextProperty` "
-               "  ADD INDEX `idx_context_property_string`( "
-               "    `name`, `is_custom_property`, `string_value`(255)); "
-      }
-      upgrade_queries {
-        query: " CREATE TABLE `EventTemp` ( "
-               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
-               "   `artifact_id` INT NOT NULL, "
-               "   `execution_id` INT NOT NULL, "
-               "   `type` INT NOT NULL, "
-               "   `milliseconds_since_epoch` BIGINT, "
-               "   CONSTRAINT UniqueEvent UNIQUE(`artifact_id`, `execution_id`, `type`) "
-               " ); "
-      }
-      upgrade_queries {
-        query: " INSERT IGNORE INTO `EventTemp` "
-               " (`id`, `artifact_id`, `execution_id`, `type`, "
-               " `milliseconds_since_epoch`) "
-               " SELECT * FROM `Event` ORDER BY `id` desc; "
-      }
-      upgrade_queries { query: " DROP TABLE `Event`; " }
-      upgrade_queries {
-        query: " ALTER TABLE `EventTemp` RENAME TO `Event`, "
-               " ADD INDEX `idx_event_execution_id` (`execution_id`) ; "
-      }
-      upgrade_queries {
-        query: " DELETE FROM `EventPath` "
-               "   WHERE event_id not in ( SELECT `id` from Event ) "
-      }
-      # check the expected indexes are created properly.
-      upgrade_verification {
-        previous_version_setup_queries { query: "DELETE FROM `Event`;" }
-        previous_version_setup_queries {
-          query: " INSERT INTO `Event` "
-                 " (`id`, `artifact_id`, `execution_id`, `type`, "
-                 " `milliseconds_since_epoch`) "
-                 " VALUES (1, 1, 1, 1, 1); "
-        }
-        previous_version_setup_queries {
-          query: " INSERT INTO `Event` "
-                 " (`id`, `artifact_id`, `execution_id`, `type`, "
-                 " `milliseconds_since_epoch`) "
-                 " VALUES (2, 1, 1, 1, 2); "
-        }
-        previous_version_setup_queries { query: "DELETE FROM `EventPath`;" }
-        previous_version_setup_queries {
-          query: " INSERT INTO `EventPath` "
-                 " (`event_id`, `is_index_step`, `step_index`, `step_key`) "
-                 " VALUES (1, 1, 1, 'a'); "
-        }
-        previous_version_setup_queries {
-          query: " INSERT INTO `EventPath` "
-                 " (`event_id`, `is_index_step`, `step_index`, `step_key`) "
-                 " VALUES (2, 1, 1, 'b'); "
-        }
-        previous_version_setup_queries {
-          query: " INSERT INTO `EventPath` "
-                 " (`event_id`, `is_index_step`, `step_index`, `step_key`) "
-                 " VALUES (2, 1, 2, 'c'); "
-        }
-        # check event table unique constraint is applied and event path
-        # records are deleted.
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Event` "
-                 " WHERE `artifact_id` = 1 AND `execution_id` = 1 "
-                 "     AND `type` = 1; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `Event` "
-                 "   WHERE `id` = 2 AND `artifact_id` = 1 AND  "
-                 "       `execution_id` = 1 AND `type` = 1; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 2 FROM `EventPath` "
-                 " WHERE `event_id` = 2; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `EventPath` "
-                 " WHERE `event_id` = 2 AND `step_key` = 'b'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `EventPath` "
-                 " WHERE `event_id` = 2 AND `step_key` = 'c'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 0 FROM `EventPath` "
-                 " WHERE `event_id` = 1; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 3 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Event' AND "
-                 "       `index_name` = 'UniqueEvent'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'Event' AND "
-                 "       `index_name` LIKE 'idx_event_execution_%'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'EventPath' AND "
-                 "       `index_name` LIKE 'idx_eventpath_event_%'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 9 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'ArtifactProperty' AND "
-                 "       `index_name` LIKE 'idx_artifact_property_%'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 9 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'ExecutionProperty' AND "
-                 "       `index_name` LIKE 'idx_execution_property_%'; "
-        }
-        post_migration_verification_queries {
-          query: " SELECT count(*) = 9 FROM `information_schema`.`statistics` "
-                 " WHERE `table_schema` = (SELECT DATABASE()) and "
-                 "       `table_name` = 'ContextProperty' AND "
-                 "       `index_name` LIKE 'idx_context_property_%'; "
-        }
-      }
-      db_verification { total_num_indexes: 74 total_num_tables: 15 }
-    }
+)pb");
+
+// Template queries for MySQLMetadataSources.
+// no-lint to support vc (C2026) 16380 max length for char[].
+const std::string kMySQLMetadataSourceQueryConfig = absl::StrCat(  // NOLINT
+R"pb(
+  metadata_source_type: MYSQL_METADATA_SOURCE
+  select_last_insert_id { query: " SELECT last_insert_id(); " }
+  # A multi-table delete is used, as MySQL does not turn the IN subquery of a
+  # DELETE into a join.
+  delete_event_paths_by_artifacts_id {
+    query: " DELETE `EventPath` FROM `EventPath` "
+           " JOIN `Event` ON `EventPath`.`event_id` = `Event`.`id` "
+           " WHERE `Event`.`artifact_id` IN ($0); "
+    parameter_num: 1
+  }
+  delete_event_paths_by_executions_id {
+    query: " DELETE `EventPath` FROM `EventPath` "
+           " JOIN `Event` ON `EventPath`.`event_id` = `Event`.`id` "
+           " WHERE `Event`.`execution_id` IN ($0); "
+    parameter_num: 1
+  }
+  select_last_insert_id_range {
+    query: " SELECT last_insert_id(), last_insert_id() + $0 - 1; "
+    parameter_num: 1
+  }
+  # The conflicting row sets last_insert_id() to its id, and is not counted
+  # in row_count(), as the client does not set CLIENT_FOUND_ROWS.
+  select_last_upsert_id { query: " SELECT last_insert_id(), row_count(); " }
+  insert_artifact_if_not_exist {
+    query: " INSERT INTO `Artifact`( "
+           "   `type_id`, `uri`, `state`, `name`, `create_time_since_epoch`, "
+           "   `last_update_time_since_epoch` "
+           ") VALUES($0, $1, $2, $3, $4, $5) "
+           " ON DUPLICATE KEY UPDATE `id` = LAST_INSERT_ID(`id`); "
+    parameter_num: 6
+  }
+  insert_context_if_not_exist {
+    query: " INSERT INTO `Context`( "
+           "   `type_id`, `name`, "
+           "   `create_time_since_epoch`, `last_update_time_since_epoch` "
+           ") VALUES($0, $1, $2, $3) "
+           " ON DUPLICATE KEY UPDATE `id` = LAST_INSERT_ID(`id`); "
+    parameter_num: 4
+  }
+  select_id_set {
+    query: " SELECT `id` FROM JSON_TABLE($0, '$[*]' "
+           "   COLUMNS (`id` BIGINT PATH '$')) AS `IdSet` "
+    parameter_num: 1
+  }
+  select_artifacts_by_uri_hash {
+    query: " SELECT `id` FROM `Artifact` "
+           " WHERE `uri_hash` = UNHEX(MD5($0)) AND `uri` = $0; "
+    parameter_num: 1
+  }
+  insert_associations_if_not_exist {
+    query: " INSERT INTO `Association`( "
+           "   `context_id`, `execution_id` "
+           ") VALUES $0 "
+           " ON DUPLICATE KEY UPDATE `id` = `id`; "
+    parameter_num: 1
+  }
+  insert_attributions_if_not_exist {
+    query: " INSERT INTO `Attribution`( "
+           "   `context_id`, `artifact_id` "
+           ") VALUES $0 "
+           " ON DUPLICATE KEY UPDATE `id` = `id`; "
+    parameter_num: 1
+  }
+  insert_artifact_derivations {
+    query: " INSERT IGNORE INTO `ArtifactDerivation`( "
+           "   `upstream_artifact_id`, `downstream_artifact_id`, "
+           "   `execution_id` "
+           " ) "
+           " SELECT `E`.`artifact_id`, `O`.`artifact_id`, `E`.`execution_id` "
+           " FROM `Event` AS `E` JOIN `Event` AS `O` "
+           "   ON `O`.`execution_id` = `E`.`execution_id` "
+           " WHERE `E`.`id` IN ($0) AND `E`.`type` IN (2, 3, 5) AND "
+           "       `O`.`type` IN (1, 4, 6) AND "
+           "       `O`.`artifact_id` != `E`.`artifact_id` "
+           " UNION ALL "
+           " SELECT `I`.`artifact_id`, `E`.`artifact_id`, `E`.`execution_id` "
+           " FROM `Event` AS `E` JOIN `Event` AS `I` "
+           "   ON `I`.`execution_id` = `E`.`execution_id` "
+           " WHERE `E`.`id` IN ($0) AND `E`.`type` IN (1, 4, 6) AND "
+           "       `I`.`type` IN (2, 3, 5) AND "
+           "       `I`.`artifact_id` != `E`.`artifact_id`; "
+    parameter_num: 1
+  }
+  select_type_by_name {
+    query: " SELECT `id`, `name`, `version`, `description`, "
+           "        `input_type`, `output_type` FROM `Type` "
+           " WHERE name = $0 AND version IS NULL AND type_kind = $1 "
+           " LOCK IN SHARE MODE; "
+    parameter_num: 2
+  }
+  select_type_by_name_and_version {
+    query: " SELECT `id`, `name`, `version`, `description`, "
+           "        `input_type`, `output_type` FROM `Type` "
+           " WHERE name = $0 AND version = $1 AND type_kind = $2 "
+           " LOCK IN SHARE MODE; "
+    parameter_num: 3
+  }
+  select_types_by_names {
+    query: " SELECT `id`, `name`, `version`, `description`, "
+           "        `input_type`, `output_type` FROM `Type` "
+           " WHERE name IN ($0) AND type_kind = $1 "
+           " LOCK IN SHARE MODE; "
+    parameter_num: 2
+  }
+  select_context_by_id {
+    query: " SELECT `id`, `type_id`, `name`, `create_time_since_epoch`, "
+           "        `last_update_time_since_epoch`"
+           " from `Context` WHERE id IN ($0) "
+           " LOCK IN SHARE MODE; "
+    parameter_num: 1
+  }
+  select_execution_by_id {
+    query: " SELECT `id`, `type_id`, `last_known_state`, `name`, "
+           "        `create_time_since_epoch`, `last_update_time_since_epoch` "
+           " from `Execution` "
+           " WHERE id IN ($0) "
+           " LOCK IN SHARE MODE; "
+    parameter_num: 1
+  }
+  select_artifact_by_id {
+    query: " SELECT `id`, `type_id`, `uri`, `state`, `name`, "
+           "        `create_time_since_epoch`, `last_update_time_since_epoch` "
+           " from `Artifact` "
+           " WHERE id IN ($0) "
+           " LOCK IN SHARE MODE; "
+    parameter_num: 1
+  }
+  select_artifact_last_update_times {
+    query: " SELECT `id`, `last_update_time_since_epoch` FROM `Artifact` "
+           " WHERE `id` IN ($0) "
+           " FOR UPDATE; "
+    parameter_num: 1
+  }
+  select_parent_type_by_type_id {
+    query: " SELECT `type_id`, `parent_type_id` "
+           " FROM `ParentType` WHERE type_id IN ($0) "
+           " LOCK IN SHARE MODE; "
+    parameter_num: 1
+  }
+)pb",
+R"pb(
+  create_type_table {
+    query: " CREATE TABLE IF NOT EXISTS `Type` ( "
+           "   `id` INT PRIMARY KEY AUTO_INCREMENT, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `version` VARCHAR(255), "
+           "   `type_kind` TINYINT(1) NOT NULL, "
+           "   `description` TEXT, "
+           "   `input_type` TEXT, "
+           "   `output_type` TEXT"
+           " ); "
+  }
+  create_artifact_table {
+    query: " CREATE TABLE IF NOT EXISTS `Artifact` ( "
+           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+           "   `type_id` INT NOT NULL, "
+           "   `uri` TEXT, "
+           "   `uri_hash` BINARY(16) "
+           "       GENERATED ALWAYS AS (UNHEX(MD5(`uri`))) VIRTUAL, "
+           "   `state` INT, "
+           "   `name` VARCHAR(255), "
+           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   CONSTRAINT UniqueArtifactTypeName UNIQUE(`type_id`, `name`) "
+           " ); "
+  }
+  create_artifact_property_table {
+    query: " CREATE TABLE IF NOT EXISTS `ArtifactProperty` ( "
+           "   `artifact_id` INT NOT NULL, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `is_custom_property` TINYINT(1) NOT NULL, "
+           "   `int_value` INT, "
+           "   `double_value` DOUBLE, "
+           "   `string_value` MEDIUMTEXT, "
+           "   `byte_value` MEDIUMBLOB, "
+           "   `proto_value` MEDIUMBLOB, "
+           "   `string_value_id` INT, "
+           "   `compressed_value` MEDIUMBLOB, "
+           " PRIMARY KEY (`artifact_id`, `name`, `is_custom_property`)); "
+  }
+  create_execution_table {
+    query: " CREATE TABLE IF NOT EXISTS `Execution` ( "
+           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+           "   `type_id` INT NOT NULL, "
+           "   `last_known_state` INT, "
+           "   `name` VARCHAR(255), "
+           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   CONSTRAINT UniqueExecutionTypeName UNIQUE(`type_id`, `name`) "
+           " ); "
+  }
+  create_execution_property_table {
+    query: " CREATE TABLE IF NOT EXISTS `ExecutionProperty` ( "
+           "   `execution_id` INT NOT NULL, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `is_custom_property` TINYINT(1) NOT NULL, "
+           "   `int_value` INT, "
+           "   `double_value` DOUBLE, "
+           "   `string_value` MEDIUMTEXT, "
+           "   `byte_value` MEDIUMBLOB, "
+           "   `proto_value` MEDIUMBLOB, "
+           "   `string_value_id` INT, "
+           "   `compressed_value` MEDIUMBLOB, "
+           " PRIMARY KEY (`execution_id`, `name`, `is_custom_property`)); "
+  }
+  create_context_table {
+    query: " CREATE TABLE IF NOT EXISTS `Context` ( "
+           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+           "   `type_id` INT NOT NULL, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   UNIQUE(`type_id`, `name`) "
+           " ); "
+  }
+  create_context_property_table {
+    query: " CREATE TABLE IF NOT EXISTS `ContextProperty` ( "
+           "   `context_id` INT NOT NULL, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `is_custom_property` TINYINT(1) NOT NULL, "
+           "   `int_value` INT, "
+           "   `double_value` DOUBLE, "
+           "   `string_value` MEDIUMTEXT, "
+           "   `byte_value` MEDIUMBLOB, "
+           "   `proto_value` MEDIUMBLOB, "
+           "   `string_value_id` INT, "
+           "   `compressed_value` MEDIUMBLOB, "
+           " PRIMARY KEY (`context_id`, `name`, `is_custom_property`)); "
+  }
+  create_event_table {
+    query: " CREATE TABLE IF NOT EXISTS `Event` ( "
+           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+           "   `artifact_id` INT NOT NULL, "
+           "   `execution_id` INT NOT NULL, "
+           "   `type` INT NOT NULL, "
+           "   `milliseconds_since_epoch` BIGINT, "
+           "   `path` MEDIUMTEXT, "
+           "   CONSTRAINT UniqueEvent UNIQUE( "
+           "     `artifact_id`, `execution_id`, `type`) "
+           " ); "
+  }
+  create_change_log_table {
+    query: " CREATE TABLE IF NOT EXISTS `ChangeLog` ( "
+           "   `id` BIGINT PRIMARY KEY AUTO_INCREMENT, "
+           "   `kind` TINYINT NOT NULL, "
+           "   `operation` TINYINT NOT NULL, "
+           "   `artifact_id` INT, "
+           "   `execution_id` INT, "
+           "   `context_id` INT, "
+           "   `milliseconds_since_epoch` BIGINT NOT NULL "
+           " ); "
+  }
+  create_association_table {
+    query: " CREATE TABLE IF NOT EXISTS `Association` ( "
+           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+           "   `context_id` INT NOT NULL, "
+           "   `execution_id` INT NOT NULL, "
+           "   UNIQUE(`context_id`, `execution_id`) "
+           " ); "
+  }
+  create_attribution_table {
+    query: " CREATE TABLE IF NOT EXISTS `Attribution` ( "
+           "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+           "   `context_id` INT NOT NULL, "
+           "   `artifact_id` INT NOT NULL, "
+           "   UNIQUE(`context_id`, `artifact_id`) "
+           " ); "
+  }
+  # The archive tables are compressed, as they are rarely read.
+  create_execution_archive_table {
+    query: " CREATE TABLE IF NOT EXISTS `ExecutionArchive` ( "
+           "   `id` INTEGER PRIMARY KEY, "
+           "   `last_update_time_since_epoch` BIGINT NOT NULL, "
+           "   `execution` MEDIUMBLOB NOT NULL "
+           " ) ROW_FORMAT=COMPRESSED; "
+  }
+  create_event_archive_table {
+    query: " CREATE TABLE IF NOT EXISTS `EventArchive` ( "
+           "   `id` INTEGER PRIMARY KEY, "
+           "   `artifact_id` INT NOT NULL, "
+           "   `execution_id` INT NOT NULL, "
+           "   `type` INT NOT NULL, "
+           "   `milliseconds_since_epoch` BIGINT, "
+           "   `path` MEDIUMTEXT "
+           " ) ROW_FORMAT=COMPRESSED; "
+  }
+  # The interned values are compared byte by byte, so that the values
+  # differing only in case or trailing spaces have different ids.
+  create_property_string_value_table {
+    query: " CREATE TABLE IF NOT EXISTS `PropertyStringValue` ( "
+           "   `id` INT PRIMARY KEY AUTO_INCREMENT, "
+           "   `value` VARBINARY(255) NOT NULL, "
+           "   UNIQUE(`value`) "
+           " ); "
+  }
+  insert_property_string_values {
+    query: " INSERT INTO `PropertyStringValue`(`value`) VALUES $0 "
+           " ON DUPLICATE KEY UPDATE `id` = `id`; "
+    parameter_num: 1
+  }
+  # secondary indices in the current schema.
+  secondary_indices {
+    # MySQL does not support arbitrary length string index. Only prefix
+    # index
+    # is supported. Max size for 5.6/5.7 is 255 char for utf8 charset.
+    query: " ALTER TABLE `Artifact` "
+           "  ADD INDEX `idx_artifact_uri`(`uri`(255)), "
+           "  ADD INDEX `idx_artifact_uri_hash`(`uri_hash`), "
+           "  ADD INDEX `idx_artifact_create_time_since_epoch` "
+           "             (`create_time_since_epoch`), "
+           "  ADD INDEX `idx_artifact_last_update_time_since_epoch` "
+           "             (`last_update_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Event` "
+           " ADD INDEX `idx_event_execution_id` (`execution_id`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ParentContext` "
+           " ADD INDEX "
+           "   `idx_parentcontext_parent_context_id` (`parent_context_id`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Type` "
+           " ADD INDEX `idx_type_name` (`name`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Execution` "
+           "  ADD INDEX `idx_execution_create_time_since_epoch` "
+           "             (`create_time_since_epoch`), "
+           "  ADD INDEX `idx_execution_last_update_time_since_epoch` "
+           "             (`last_update_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Context` "
+           "  ADD INDEX `idx_context_create_time_since_epoch` "
+           "             (`create_time_since_epoch`), "
+           "  ADD INDEX `idx_context_last_update_time_since_epoch` "
+           "             (`last_update_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `EventPath` "
+           "  ADD INDEX `idx_eventpath_event_id`(`event_id`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ArtifactProperty` "
+           "  ADD INDEX `idx_artifact_property_int`( "
+           "    `name`, `is_custom_property`, `int_value`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ArtifactProperty` "
+           "  ADD INDEX `idx_artifact_property_double`( "
+           "    `name`, `is_custom_property`, `double_value`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ArtifactProperty` "
+           "  ADD INDEX `idx_artifact_property_string`( "
+           "    `name`, `is_custom_property`, `string_value`(255)); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ExecutionProperty` "
+           "  ADD INDEX `idx_execution_property_int`( "
+           "    `name`, `is_custom_property`, `int_value`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ExecutionProperty` "
+           "  ADD INDEX `idx_execution_property_double`( "
+           "    `name`, `is_custom_property`, `double_value`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ExecutionProperty` "
+           "  ADD INDEX `idx_execution_property_string`( "
+           "    `name`, `is_custom_property`, `string_value`(255)); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ContextProperty` "
+           "  ADD INDEX `idx_context_property_int`( "
+           "    `name`, `is_custom_property`, `int_value`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ContextProperty` "
+           "  ADD INDEX `idx_context_property_double`( "
+           "    `name`, `is_custom_property`, `double_value`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ContextProperty` "
+           "  ADD INDEX `idx_context_property_string`( "
+           "    `name`, `is_custom_property`, `string_value`(255)); "
+  }
+  # The compressed values are looked up to reject the filters on their
+  # properties.
+  secondary_indices {
+    query: " ALTER TABLE `ArtifactProperty` "
+           "  ADD INDEX `idx_artifact_property_compressed`( "
+           "    `name`, `is_custom_property`, `compressed_value`(1)); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ExecutionProperty` "
+           "  ADD INDEX `idx_execution_property_compressed`( "
+           "    `name`, `is_custom_property`, `compressed_value`(1)); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ContextProperty` "
+           "  ADD INDEX `idx_context_property_compressed`( "
+           "    `name`, `is_custom_property`, `compressed_value`(1)); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Artifact` "
+           "  ADD INDEX "
+           "    `idx_artifact_type_id_create_time_since_epoch` "
+           "    (`type_id`, `create_time_since_epoch`, `id`), "
+           "  ADD INDEX "
+           "    `idx_artifact_type_id_last_update_time_since_epoch` "
+           "    (`type_id`, `last_update_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Execution` "
+           "  ADD INDEX "
+           "    `idx_execution_type_id_create_time_since_epoch` "
+           "    (`type_id`, `create_time_since_epoch`, `id`), "
+           "  ADD INDEX "
+           "    `idx_execution_type_id_last_update_time_since_epoch` "
+           "    (`type_id`, `last_update_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Context` "
+           "  ADD INDEX "
+           "    `idx_context_type_id_create_time_since_epoch` "
+           "    (`type_id`, `create_time_since_epoch`, `id`), "
+           "  ADD INDEX "
+           "    `idx_context_type_id_last_update_time_since_epoch` "
+           "    (`type_id`, `last_update_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Attribution` "
+           "  ADD INDEX "
+           "    `idx_attribution_artifact_id_context_id` "
+           "    (`artifact_id`, `context_id`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Association` "
+           "  ADD INDEX "
+           "    `idx_association_execution_id_context_id` "
+           "    (`execution_id`, `context_id`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `ArtifactDerivation` "
+           "  ADD INDEX "
+           "    `idx_artifact_derivation_downstream_artifact_id` "
+           "    (`downstream_artifact_id`, `upstream_artifact_id`), "
+           "  ADD INDEX "
+           "    `idx_artifact_derivation_execution_id` (`execution_id`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `EventArchive` "
+           "  ADD INDEX `idx_event_archive_artifact_id` (`artifact_id`), "
+           "  ADD INDEX `idx_event_archive_execution_id` (`execution_id`); "
+  }
+  # MySQL has no partial indexes, so that all the executions are indexed.
+  secondary_indices {
+    query: " ALTER TABLE `Execution` "
+           "  ADD INDEX "
+           "    `idx_execution_type_id_last_known_state` "
+           "    (`type_id`, `last_known_state`, "
+           "     `last_update_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " ALTER TABLE `Event` "
+           "  ADD INDEX `idx_event_milliseconds_since_epoch` "
+           "    (`milliseconds_since_epoch`, `id`); "
+  }
+  # downgrade to 0.13.2 (i.e., v0), and drops the MLMDEnv table.
+  migration_schemes {
+    key: 0
+    value: {
+      # downgrade queries from version 1
+      downgrade_queries { query: " DROP TABLE IF EXISTS `MLMDEnv`; " }
+      # check the tables are deleted properly
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'MLMDEnv'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  migration_schemes {
+    key: 1
+    value: {
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `MLMDEnv` ( "
+               "   `schema_version` INTEGER PRIMARY KEY "
+               " ); "
+      }
+      upgrade_queries {
+        query: " INSERT INTO `MLMDEnv`(`schema_version`) VALUES(0); "
+      }
+      # v0.13.2 release
+      upgrade_verification {
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `Type` ( "
+                 "   `id` INT PRIMARY KEY AUTO_INCREMENT, "
+                 "   `name` VARCHAR(255) NOT NULL, "
+                 "   `is_artifact_type` TINYINT(1) NOT NULL, "
+                 "   `input_type` TEXT, "
+                 "   `output_type` TEXT"
+                 " ); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `TypeProperty` ( "
+                 "   `type_id` INT NOT NULL, "
+                 "   `name` VARCHAR(255) NOT NULL, "
+                 "   `data_type` INT NULL, "
+                 " PRIMARY KEY (`type_id`, `name`)); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `Artifact` ( "
+                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+                 "   `type_id` INT NOT NULL, "
+                 "   `uri` TEXT "
+                 " ); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `ArtifactProperty` ( "
+                 "   `artifact_id` INT NOT NULL, "
+                 "   `name` VARCHAR(255) NOT NULL, "
+                 "   `is_custom_property` TINYINT(1) NOT NULL, "
+                 "   `int_value` INT, "
+                 "   `double_value` DOUBLE, "
+                 "   `string_value` TEXT, "
+                 " PRIMARY KEY (`artifact_id`, `name`, `is_custom_property`)); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `Execution` ( "
+                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+                 "   `type_id` INT NOT NULL "
+                 " ); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `ExecutionProperty` ( "
+                 "   `execution_id` INT NOT NULL, "
+                 "   `name` VARCHAR(255) NOT NULL, "
+                 "   `is_custom_property` TINYINT(1) NOT NULL, "
+                 "   `int_value` INT, "
+                 "   `double_value` DOUBLE, "
+                 "   `string_value` TEXT, "
+                 " PRIMARY KEY (`execution_id`, `name`, `is_custom_property`)); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `Event` ( "
+                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+                 "   `artifact_id` INT NOT NULL, "
+                 "   `execution_id` INT NOT NULL, "
+                 "   `type` INT NOT NULL, "
+                 "   `milliseconds_since_epoch` BIGINT "
+                 " ); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `EventPath` ( "
+                 "   `event_id` INT NOT NULL, "
+                 "   `is_index_step` TINYINT(1) NOT NULL, "
+                 "   `step_index` INT, "
+                 "   `step_key` TEXT "
+                 " ); "
+        }
+        # check the new table has 1 row
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `MLMDEnv`; "
+        }
+      }
+      # downgrade queries from version 2, drop all ContextTypes and rename
+      # the `type_kind` back to `is_artifact_type` column.
+      downgrade_queries {
+        query: " DELETE FROM `Type` WHERE `type_kind` = 2; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Type` CHANGE COLUMN "
+               " `type_kind` `is_artifact_type` TINYINT(1) NOT NULL; "
+      }
+      # check the tables are deleted properly
+      downgrade_verification {
+        # populate the `Type` table with context types.
+        previous_version_setup_queries {
+          query: " INSERT INTO `Type` "
+                 " (`name`, `type_kind`, `input_type`, `output_type`) "
+                 " VALUES ('execution_type', 0, 'input', 'output'); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Type` "
+                 " (`name`, `type_kind`, `input_type`, `output_type`) "
+                 " VALUES ('artifact_type', 1, 'input', 'output'); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Type` "
+                 " (`name`, `type_kind`, `input_type`, `output_type`) "
+                 " VALUES ('context_type', 2, 'input', 'output'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `Type` "
+                 " WHERE `is_artifact_type` = 2; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Type` "
+                 " WHERE `is_artifact_type` = 1 AND `name` = 'artifact_type'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Type` "
+                 " WHERE `is_artifact_type` = 0 AND `name` = 'execution_type'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  migration_schemes {
+    key: 2
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `Type` CHANGE COLUMN "
+               " `is_artifact_type` `type_kind` TINYINT(1) NOT NULL; "
+      }
+      upgrade_verification {
+        # populate one ArtifactType and one ExecutionType.
+        previous_version_setup_queries {
+          query: " INSERT INTO `Type` (`name`, `is_artifact_type`) VALUES "
+                 " ('artifact_type', 1); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Type` "
+                 " (`name`, `is_artifact_type`, `input_type`, `output_type`) "
+                 " VALUES ('execution_type', 0, 'input', 'output'); "
+        }
+        # check after migration, the existing types are the same including
+        # id.
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Type` WHERE "
+                 " `id` = 1 AND `type_kind` = 1 AND `name` = 'artifact_type'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Type` WHERE "
+                 " `id` = 2 AND `type_kind` = 0 AND `name` = 'execution_type' "
+                 " AND `input_type` = 'input' AND `output_type` = 'output'; "
+        }
+      }
+      # downgrade queries from version 3
+      downgrade_queries { query: " DROP TABLE IF EXISTS `Context`; " }
+      downgrade_queries {
+        query: " DROP TABLE IF EXISTS `ContextProperty`; "
+      }
+      # check the tables are deleted properly
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Context'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'ContextProperty'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  migration_schemes {
+    key: 3
+    value: {
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `Context` ( "
+               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+               "   `type_id` INT NOT NULL, "
+               "   `name` VARCHAR(255) NOT NULL, "
+               "   UNIQUE(`type_id`, `name`) "
+               " ); "
+      }
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `ContextProperty` ( "
+               "   `context_id` INT NOT NULL, "
+               "   `name` VARCHAR(255) NOT NULL, "
+               "   `is_custom_property` TINYINT(1) NOT NULL, "
+               "   `int_value` INT, "
+               "   `double_value` DOUBLE, "
+               "   `string_value` TEXT, "
+               " PRIMARY KEY (`context_id`, `name`, `is_custom_property`)); "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM ( "
+                 "   SELECT `id`, `type_id`, `name` FROM `Context` "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM ( "
+                 "   SELECT `context_id`, `name`, `is_custom_property`, "
+                 "          `int_value`, `double_value`, `string_value` "
+                 "    FROM `ContextProperty` "
+                 " ) as T2; "
+        }
+      }
+      # downgrade queries from version 4
+      downgrade_queries { query: " DROP TABLE IF EXISTS `Association`; " }
+      downgrade_queries { query: " DROP TABLE IF EXISTS `Attribution`; " }
+      # check the tables are deleted properly
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Association'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Attribution'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  migration_schemes {
+    key: 4
+    value: {
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `Association` ( "
+               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+               "   `context_id` INT NOT NULL, "
+               "   `execution_id` INT NOT NULL, "
+               "   UNIQUE(`context_id`, `execution_id`) "
+               " ); "
+      }
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `Attribution` ( "
+               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+               "   `context_id` INT NOT NULL, "
+               "   `artifact_id` INT NOT NULL, "
+               "   UNIQUE(`context_id`, `artifact_id`) "
+               " ); "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM ( "
+                 "   SELECT `id`, `context_id`, `execution_id` "
+                 "   FROM `Association` "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM ( "
+                 "   SELECT `id`, `context_id`, `artifact_id` "
+                 "   FROM `Attribution` "
+                 " ) as T1; "
+        }
+      }
+      # downgrade queries from version 5
+      downgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               " DROP INDEX UniqueArtifactTypeName; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               " DROP COLUMN `state`, "
+               " DROP COLUMN `name`, "
+               " DROP COLUMN `create_time_since_epoch`, "
+               " DROP COLUMN `last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Execution` "
+               " DROP INDEX UniqueExecutionTypeName; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Execution` "
+               " DROP COLUMN `last_known_state`, "
+               " DROP COLUMN `name`, "
+               " DROP COLUMN `create_time_since_epoch`, "
+               " DROP COLUMN `last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Context` "
+               " DROP COLUMN `create_time_since_epoch`, "
+               " DROP COLUMN `last_update_time_since_epoch`; "
+      }
+      # verify if the downgrading keeps the existing columns
+      downgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `Artifact`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Artifact` "
+                 " (`id`, `type_id`, `uri`, `state`, `name`, "
+                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
+                 " VALUES (1, 2, 'uri1', 1, NULL, 0, 1); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Artifact` "
+                 " (`id`, `type_id`, `uri`, `state`, `name`, "
+                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
+                 " VALUES (2, 3, 'uri2', NULL, 'name2', 1, 0); "
+        }
+        previous_version_setup_queries { query: "DELETE FROM `Execution`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Execution` "
+                 " (`id`, `type_id`, `last_known_state`, `name`, "
+                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
+                 " VALUES (1, 2, 1, NULL, 0, 1); "
+        }
+        previous_version_setup_queries { query: "DELETE FROM `Context`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Context` "
+                 " (`id`, `type_id`, `name`, "
+                 "  `create_time_since_epoch`, `last_update_time_since_epoch`) "
+                 " VALUES (1, 2, 'name1', 1, 0); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `Artifact`; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT * FROM `Artifact` "
+                 "   WHERE `id` = 1 and `type_id` = 2 and `uri` = 'uri1' "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT * FROM `Artifact` "
+                 "   WHERE `id` = 2 and `type_id` = 3 and `uri` = 'uri2' "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Execution`; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT * FROM `Execution` "
+                 "   WHERE `id` = 1 and `type_id` = 2 "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT * FROM `Context` "
+                 "   WHERE `id` = 1 and `type_id` = 2 "
+                 " ) as T1; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  migration_schemes {
+    key: 5
+    value: {
+      # upgrade Artifact table
+      upgrade_queries {
+        query: " ALTER TABLE `Artifact` ADD ( "
+               "   `state` INT, "
+               "   `name` VARCHAR(255), "
+               "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0 "
+               " ), "
+               " ADD CONSTRAINT UniqueArtifactTypeName "
+               " UNIQUE(`type_id`, `name`); "
+      }
+      # upgrade Execution table
+      upgrade_queries {
+        query: " ALTER TABLE `Execution` ADD ( "
+               "   `last_known_state` INT, "
+               "   `name` VARCHAR(255), "
+               "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0 "
+               " ), "
+               " ADD CONSTRAINT UniqueExecutionTypeName "
+               " UNIQUE(`type_id`, `name`); "
+      }
+      # upgrade Context table
+      upgrade_queries {
+        query: " ALTER TABLE `Context` ADD ( "
+               "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+               "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0 "
+               " ) "
+      }
+      # check the expected table columns are created properly.
+      upgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `Artifact`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Artifact` "
+                 " (`id`, `type_id`, `uri`) VALUES (1, 2, 'uri1'); "
+        }
+        previous_version_setup_queries { query: "DELETE FROM `Execution`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Execution` "
+                 " (`id`, `type_id`) VALUES (1, 3); "
+        }
+        previous_version_setup_queries {
+          query: " CREATE TABLE IF NOT EXISTS `Context` ( "
+                 "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+                 "   `type_id` INT NOT NULL, "
+                 "   `name` VARCHAR(255) NOT NULL, "
+                 "   UNIQUE(`type_id`, `name`) "
+                 " ); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Context` "
+                 " (`id`, `type_id`, `name`) VALUES (1, 2, 'name1'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT `id`, `type_id`, `uri`, `state`, `name`, "
+                 "          `create_time_since_epoch`, "
+                 "          `last_update_time_since_epoch` "
+                 "   FROM `Artifact` "
+                 "   WHERE `id` = 1 AND `type_id` = 2 AND `uri` = 'uri1' AND "
+                 "         `create_time_since_epoch` = 0 AND "
+                 "         `last_update_time_since_epoch` = 0 "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT `id`, `type_id`, `last_known_state`, `name`, "
+                 "          `create_time_since_epoch`, "
+                 "          `last_update_time_since_epoch` "
+                 "   FROM `Execution` "
+                 "   WHERE `id` = 1 AND `type_id` = 3 AND "
+                 "         `create_time_since_epoch` = 0 AND "
+                 "         `last_update_time_since_epoch` = 0 "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT `id`, `type_id`, `name`, "
+                 "          `create_time_since_epoch`, "
+                 "          `last_update_time_since_epoch` "
+                 "   FROM `Context` "
+                 "   WHERE `id` = 1 AND `type_id` = 2 AND `name` = 'name1' AND "
+                 "         `create_time_since_epoch` = 0 AND "
+                 "         `last_update_time_since_epoch` = 0 "
+                 " ) as T1; "
+        }
+      }
+      # downgrade queries from version 6
+      downgrade_queries { query: " DROP TABLE `ParentType`; " }
+      downgrade_queries { query: " DROP TABLE `ParentContext`; " }
+      downgrade_queries {
+        query: " ALTER TABLE `Type` "
+               " DROP COLUMN `version`, "
+               " DROP COLUMN `description`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               " DROP INDEX `idx_artifact_uri`, "
+               " DROP INDEX `idx_artifact_create_time_since_epoch`, "
+               " DROP INDEX `idx_artifact_last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Event` "
+               " DROP INDEX `idx_event_artifact_id`, "
+               " DROP INDEX `idx_event_execution_id`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Type` "
+               " DROP INDEX `idx_type_name`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Execution` "
+               " DROP INDEX `idx_execution_create_time_since_epoch`, "
+               " DROP INDEX `idx_execution_last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Context` "
+               " DROP INDEX `idx_context_create_time_since_epoch`, "
+               " DROP INDEX `idx_context_last_update_time_since_epoch`; "
+      }
+      # verify if the downgrading keeps the existing columns
+      downgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `Type`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Type` "
+                 " (`id`, `name`, `version`, `type_kind`, "
+                 "  `description`, `input_type`, `output_type`) "
+                 " VALUES (1, 't1', 'v1', 1, 'desc1', 'input1', 'output1'); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Type` "
+                 " (`id`, `name`, `version`, `type_kind`, "
+                 "  `description`, `input_type`, `output_type`) "
+                 " VALUES (2, 't2', 'v2', 2, 'desc2', 'input2', 'output2'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `Type`; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM ( "
+                 "   SELECT * FROM `Type` "
+                 "   WHERE `id` = 1 AND `name` = 't1' AND type_kind = 1 "
+                 "   AND `input_type` = 'input1' AND `output_type` = 'output1'"
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'ParentType'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'ParentContext'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Artifact' AND "
+                 "       `index_name` LIKE 'idx_artifact_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` LIKE 'idx_event_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'ParentContext' AND "
+                 "       `index_name` LIKE 'idx_parentcontext_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Type' AND "
+                 "       `index_name` LIKE 'idx_type_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Execution' AND "
+                 "       `index_name` LIKE 'idx_execution_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Context' AND "
+                 "       `index_name` LIKE 'idx_context_%'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v6, to support parental type and parental context, we added two
+  # tables `ParentType` and `ParentContext`. In addition, we added `version`
+  # and `description` in the `Type` table for improving type registrations.
+  # We introduce indices on Type.name, Artifact.uri, Event's artifact_id and
+  # execution_id, and create_time_since_epoch, last_update_time_since_epoch
+  # for all nodes.
+  migration_schemes {
+    key: 6
+    value: {
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `ParentType` ( "
+               "   `type_id` INT NOT NULL, "
+               "   `parent_type_id` INT NOT NULL, "
+               " PRIMARY KEY (`type_id`, `parent_type_id`)); "
+      }
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `ParentContext` ( "
+               "   `context_id` INT NOT NULL, "
+               "   `parent_context_id` INT NOT NULL, "
+               " PRIMARY KEY (`context_id`, `parent_context_id`)); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Type` ADD ( "
+               "   `version` VARCHAR(255), "
+               "   `description` TEXT "
+               " ); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               " ADD INDEX `idx_artifact_uri`(`uri`(255)), "
+               "  ADD INDEX `idx_artifact_create_time_since_epoch` "
+               "             (`create_time_since_epoch`), "
+               "  ADD INDEX `idx_artifact_last_update_time_since_epoch` "
+               "             (`last_update_time_since_epoch`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Event` "
+               " ADD INDEX `idx_event_artifact_id` (`artifact_id`), "
+               " ADD INDEX `idx_event_execution_id` (`execution_id`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ParentContext` "
+               " ADD INDEX "
+               "  `idx_parentcontext_parent_context_id` (`parent_context_id`);"
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Type` "
+               " ADD INDEX `idx_type_name` (`name`);"
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Execution` "
+               "  ADD INDEX `idx_execution_create_time_since_epoch` "
+               "             (`create_time_since_epoch`), "
+               "  ADD INDEX `idx_execution_last_update_time_since_epoch` "
+               "             (`last_update_time_since_epoch`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Context` "
+               "  ADD INDEX `idx_context_create_time_since_epoch` "
+               "             (`create_time_since_epoch`), "
+               "  ADD INDEX `idx_context_last_update_time_since_epoch` "
+               "             (`last_update_time_since_epoch`); "
+      }
+      # check the expected table columns are created properly.
+      upgrade_verification {
+        # check existing rows in previous Type table are migrated properly.
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Type` WHERE "
+                 " `id` = 1 AND `type_kind` = 1 AND `name` = 'artifact_type'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Type` WHERE "
+                 " `id` = 2 AND `type_kind` = 0 AND `name` = 'execution_type' "
+                 " AND `input_type` = 'input' AND `output_type` = 'output'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM ( "
+                 "   SELECT `type_id`, `parent_type_id` "
+                 "   FROM `ParentType` "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM ( "
+                 "   SELECT `context_id`, `parent_context_id` "
+                 "   FROM `ParentContext` "
+                 " ) as T1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Artifact' AND "
+                 "       `index_name` = 'idx_artifact_uri'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Artifact' AND "
+                 "       `index_name` = 'idx_artifact_create_time_since_epoch';"
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Artifact' AND `index_name` = "
+                 "       'idx_artifact_last_update_time_since_epoch';"
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` = 'idx_event_artifact_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` = 'idx_event_execution_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'ParentContext' AND "
+                 "       `index_name` = 'idx_parentcontext_parent_context_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Type' AND "
+                 "       `index_name` = 'idx_type_name'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Execution' AND `index_name` = "
+                 "       'idx_execution_create_time_since_epoch'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Execution' AND `index_name` = "
+                 "       'idx_execution_last_update_time_since_epoch'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Context' AND "
+                 "       `index_name` = 'idx_context_create_time_since_epoch'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Context' AND `index_name` = "
+                 "       'idx_context_last_update_time_since_epoch'; "
+        }
+      }
+      # downgrade queries from version 7
+      # Note v7 for MySQL used mediumtext for string_value, when downgrade
+      # the long text will be truncated to 65536 chars.
+      downgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` DROP COLUMN `byte_value`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` DROP COLUMN `byte_value`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ContextProperty` DROP COLUMN `byte_value`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `EventPath` DROP INDEX `idx_eventpath_event_id`; "
+      }
+      downgrade_queries {
+        query: " UPDATE `ArtifactProperty` "
+               " SET `string_value` = SUBSTRING(`string_value`, 1, 65535); "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               " MODIFY COLUMN `string_value` TEXT; "
+      }
+      downgrade_queries {
+        query: " UPDATE `ExecutionProperty` "
+               " SET `string_value` = SUBSTRING(`string_value`, 1, 65535); "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               " MODIFY COLUMN `string_value` TEXT; "
+      }
+      downgrade_queries {
+        query: " UPDATE `ContextProperty` "
+               " SET `string_value` = SUBSTRING(`string_value`, 1, 65535); "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               " MODIFY COLUMN `string_value` TEXT; "
+      }
+      # verify if the downgrading keeps the existing columns
+      downgrade_verification {
+        previous_version_setup_queries {
+          query: "DELETE FROM `ArtifactProperty`;"
+        }
+        previous_version_setup_queries {
+          query: "DELETE FROM `ExecutionProperty`;"
+        }
+        previous_version_setup_queries {
+          query: "DELETE FROM `ContextProperty`;"
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `ArtifactProperty` "
+                 " (`artifact_id`, `name`, `string_value`) "
+                 " VALUES (1, 'p1', CONCAT('_prefix_', REPEAT('a', 160000))), "
+                 "        (1, 'p2', 'abc'); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `ExecutionProperty` "
+                 " (`execution_id`, `name`, `string_value`) "
+                 " VALUES (1, 'p1', CONCAT('_prefix_', REPEAT('e', 160000))), "
+                 "        (1, 'p2', 'abc'); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `ContextProperty` "
+                 " (`context_id`, `name`, `string_value`) "
+                 " VALUES (1, 'p1', CONCAT('_prefix_', REPEAT('c', 160000))), "
+                 "        (1, 'p2', 'abc'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'EventPath' AND "
+                 "       `index_name` = 'idx_eventpath_event_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 3 FROM `information_schema`.`columns` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` IN ('ArtifactProperty', "
+                 "           'ExecutionProperty', 'ContextProperty') AND "
+                 "       `column_name` = 'string_value' AND "
+                 "       `data_type` = 'text'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`columns` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` IN ('ArtifactProperty', "
+                 "           'ExecutionProperty', 'ContextProperty') AND "
+                 "       `column_name` = 'byte_value'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `artifact_id` = 1 AND `name` = 'p1' AND "
+                 "   `string_value` = CONCAT('_prefix_', REPEAT('a', 65527)); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `artifact_id` = 1 AND `name` = 'p2' AND "
+                 "       `string_value` = 'abc'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ExecutionProperty` "
+                 " WHERE `execution_id` = 1 AND `name` = 'p1' AND "
+                 "   `string_value` = CONCAT('_prefix_', REPEAT('e', 65527)); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ExecutionProperty` "
+                 " WHERE `execution_id` = 1 AND `name` = 'p2' AND "
+                 "       `string_value` = 'abc'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ContextProperty` "
+                 " WHERE `context_id` = 1 AND `name` = 'p1' AND "
+                 "   `string_value` = CONCAT('_prefix_', REPEAT('c', 65527)); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ContextProperty` "
+                 " WHERE `context_id` = 1 AND `name` = 'p2' AND "
+                 "       `string_value` = 'abc'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v7, we added byte_value for property tables for better storing binary
+  # property values. For MySQL, we extends string_value column to be
+  # MEDIUMTEXT in order to persist string value with size upto 16MB. In
+  # addition, we added index for `EventPath` to improve Event reads.
+  migration_schemes {
+    key: 7
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               " MODIFY COLUMN `string_value` MEDIUMTEXT, "
+               " ADD COLUMN `byte_value` MEDIUMBLOB; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               " MODIFY COLUMN `string_value` MEDIUMTEXT, "
+               " ADD COLUMN `byte_value` MEDIUMBLOB; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               " MODIFY COLUMN `string_value` MEDIUMTEXT, "
+               " ADD COLUMN `byte_value` MEDIUMBLOB; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `EventPath` "
+               " ADD INDEX `idx_eventpath_event_id` (`event_id`); "
+      }
+      # check the expected table columns are created properly.
+      upgrade_verification {
+        # check existing rows in previous Type table are migrated properly.
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `ArtifactProperty` WHERE "
+                 " `byte_value` IS NOT NULL; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `ExecutionProperty` WHERE "
+                 " `byte_value` IS NOT NULL; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `ContextProperty` WHERE "
+                 " `byte_value` IS NOT NULL; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'EventPath' AND "
+                 "       `index_name` = 'idx_eventpath_event_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 3 FROM `information_schema`.`columns` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` IN ('ArtifactProperty', "
+                 "           'ExecutionProperty', 'ContextProperty') AND "
+                 "       `column_name` = 'string_value' AND "
+                 "       `data_type` = 'mediumtext'; "
+        }
+      }
+      db_verification { total_num_indexes: 45 total_num_tables: 15 }
+      # downgrade queries from version 8
+      downgrade_queries {
+        query: " ALTER TABLE `Event` "
+               " DROP INDEX UniqueEvent; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Event` "
+               " ADD INDEX `idx_event_artifact_id` (`artifact_id`); "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               " DROP INDEX `idx_artifact_property_int`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               " DROP INDEX `idx_artifact_property_double`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               " DROP INDEX `idx_artifact_property_string`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               " DROP INDEX `idx_execution_property_int`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               " DROP INDEX `idx_execution_property_double`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               " DROP INDEX `idx_execution_property_string`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               " DROP INDEX `idx_context_property_int`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               " DROP INDEX `idx_context_property_double`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               " DROP INDEX `idx_context_property_string`; "
+      }
+      downgrade_verification {
+        previous_version_setup_queries {
+          query: " INSERT INTO `Event` "
+                 " (`id`, `artifact_id`, `execution_id`, `type`, "
+                 " `milliseconds_since_epoch`) "
+                 " VALUES (1, 1, 1, 1, 1); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `EventPath` "
+                 " (`event_id`, `is_index_step`, `step_index`, `step_key`) "
+                 " VALUES (1, 1, 1, 'a'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Event` "
+                 " WHERE `artifact_id` = 1 AND `execution_id` = 1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `EventPath` "
+                 " WHERE `event_id` = 1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` = 'UniqueEvent'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` = 'idx_event_artifact_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` = 'idx_event_execution_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'EventPath' AND "
+                 "       `index_name` = 'idx_eventpath_event_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'ArtifactProperty' AND "
+                 "       `index_name` LIKE 'idx_artifact_property_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'ExecutionProperty' AND "
+                 "       `index_name` LIKE 'idx_execution_property_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'ContextProperty' AND "
+                 "       `index_name` LIKE 'idx_context_property_%'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v8, we added index for `ArtifactProperty`, `ExecutionProperty`,
+  # `ContextProperty` to improve property queries on name.
+  migration_schemes {
+    key: 8
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               "  ADD INDEX `idx_artifact_property_int`( "
+               "    `name`, `is_custom_property`, `int_value`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               "  ADD INDEX `idx_artifact_property_double`( "
+               "    `name`, `is_custom_property`, `double_value`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               "  ADD INDEX `idx_artifact_property_string`( "
+               "    `name`, `is_custom_property`, `string_value`(255)); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               "  ADD INDEX `idx_execution_property_int`( "
+               "    `name`, `is_custom_property`, `int_value`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               "  ADD INDEX `idx_execution_property_double`( "
+               "    `name`, `is_custom_property`, `double_value`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               "  ADD INDEX `idx_execution_property_string`( "
+               "    `name`, `is_custom_property`, `string_value`(255)); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               "  ADD INDEX `idx_context_property_int`( "
+               "    `name`, `is_custom_property`, `int_value`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               "  ADD INDEX `idx_context_property_double`( "
+               "    `name`, `is_custom_property`, `double_value`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               "  ADD INDEX `idx_context_property_string`( "
+               "    `name`, `is_custom_property`, `string_value`(255)); "
+      }
+      upgrade_queries {
+        query: " CREATE TABLE `EventTemp` ( "
+               "   `id` INTEGER PRIMARY KEY AUTO_INCREMENT, "
+               "   `artifact_id` INT NOT NULL, "
+               "   `execution_id` INT NOT NULL, "
+               "   `type` INT NOT NULL, "
+               "   `milliseconds_since_epoch` BIGINT, "
+               "   CONSTRAINT UniqueEvent UNIQUE(`artifact_id`, `execution_id`, `type`) "
+               " ); "
+      }
+      upgrade_queries {
+        query: " INSERT IGNORE INTO `EventTemp` "
+               " (`id`, `artifact_id`, `execution_id`, `type`, "
+               " `milliseconds_since_epoch`) "
+               " SELECT * FROM `Event` ORDER BY `id` desc; "
+      }
+      upgrade_queries { query: " DROP TABLE `Event`; " }
+      upgrade_queries {
+        query: " ALTER TABLE `EventTemp` RENAME TO `Event`, "
+               " ADD INDEX `idx_event_execution_id` (`execution_id`) ; "
+      }
+      upgrade_queries {
+        query: " DELETE FROM `EventPath` "
+               "   WHERE event_id not in ( SELECT `id` from Event ) "
+      }
+      # check the expected indexes are created properly.
+      upgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `Event`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Event` "
+                 " (`id`, `artifact_id`, `execution_id`, `type`, "
+                 " `milliseconds_since_epoch`) "
+                 " VALUES (1, 1, 1, 1, 1); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Event` "
+                 " (`id`, `artifact_id`, `execution_id`, `type`, "
+                 " `milliseconds_since_epoch`) "
+                 " VALUES (2, 1, 1, 1, 2); "
+        }
+        previous_version_setup_queries { query: "DELETE FROM `EventPath`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `EventPath` "
+                 " (`event_id`, `is_index_step`, `step_index`, `step_key`) "
+                 " VALUES (1, 1, 1, 'a'); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `EventPath` "
+                 " (`event_id`, `is_index_step`, `step_index`, `step_key`) "
+                 " VALUES (2, 1, 1, 'b'); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `EventPath` "
+                 " (`event_id`, `is_index_step`, `step_index`, `step_key`) "
+                 " VALUES (2, 1, 2, 'c'); "
+        }
+        # check event table unique constraint is applied and event path
+        # records are deleted.
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Event` "
+                 " WHERE `artifact_id` = 1 AND `execution_id` = 1 "
+                 "     AND `type` = 1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Event` "
+                 "   WHERE `id` = 2 AND `artifact_id` = 1 AND  "
+                 "       `execution_id` = 1 AND `type` = 1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `EventPath` "
+                 " WHERE `event_id` = 2; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `EventPath` "
+                 " WHERE `event_id` = 2 AND `step_key` = 'b'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `EventPath` "
+                 " WHERE `event_id` = 2 AND `step_key` = 'c'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `EventPath` "
+                 " WHERE `event_id` = 1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 3 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` = 'UniqueEvent'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` LIKE 'idx_event_execution_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'EventPath' AND "
+                 "       `index_name` LIKE 'idx_eventpath_event_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 9 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'ArtifactProperty' AND "
+                 "       `index_name` LIKE 'idx_artifact_property_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 9 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'ExecutionProperty' AND "
+                 "       `index_name` LIKE 'idx_execution_property_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 9 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) and "
+                 "       `table_name` = 'ContextProperty' AND "
+                 "       `index_name` LIKE 'idx_context_property_%'; "
+        }
+      }
+      db_verification { total_num_indexes: 74 total_num_tables: 15 }
+      # Downgrade from v9.
+      downgrade_queries {
+        query: " ALTER TABLE `MLMDEnv` DROP COLUMN `type_generation`; "
+      }
+      downgrade_verification {
+        previous_version_setup_queries {
+          query: " UPDATE `MLMDEnv` SET `type_generation` = 1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `MLMDEnv`; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`columns` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'MLMDEnv' AND "
+                 "       `column_name` = 'type_generation'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v9, we added `type_generation` to `MLMDEnv`. It is increased whenever
+  # the stored types change, so that the cached types can be validated.
+  migration_schemes {
+    key: 9
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `MLMDEnv` "
+               " ADD COLUMN `type_generation` INT NOT NULL DEFAULT 0; "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `MLMDEnv` "
+                 " WHERE `type_generation` = 0; "
+        }
+      }
+      db_verification { total_num_indexes: 74 total_num_tables: 15 }
+      # Downgrade from v10.
+      downgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               "  DROP INDEX "
+               "    `idx_artifact_type_id_create_time_since_epoch`, "
+               "  DROP INDEX "
+               "    `idx_artifact_type_id_last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Execution` "
+               "  DROP INDEX "
+               "    `idx_execution_type_id_create_time_since_epoch`, "
+               "  DROP INDEX "
+               "    `idx_execution_type_id_last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Context` "
+               "  DROP INDEX "
+               "    `idx_context_type_id_create_time_since_epoch`, "
+               "  DROP INDEX "
+               "    `idx_context_type_id_last_update_time_since_epoch`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Attribution` "
+               "  DROP INDEX "
+               "    `idx_attribution_artifact_id_context_id`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Association` "
+               "  DROP INDEX "
+               "    `idx_association_execution_id_context_id`; "
+      }
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Artifact' AND "
+                 "       `index_name` LIKE 'idx_artifact_type_id_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Execution' AND "
+                 "       `index_name` LIKE 'idx_execution_type_id_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Context' AND "
+                 "       `index_name` LIKE 'idx_context_type_id_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Attribution' AND "
+                 "       `index_name` = "
+                 "         'idx_attribution_artifact_id_context_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Association' AND "
+                 "       `index_name` = "
+                 "         'idx_association_execution_id_context_id'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v10, we added composite indexes for listing the nodes of a type ordered
+  # by their create or last update time, and for finding the contexts of an
+  # artifact or an execution.
+  migration_schemes {
+    key: 10
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               "  ADD INDEX "
+               "    `idx_artifact_type_id_create_time_since_epoch` "
+               "    (`type_id`, `create_time_since_epoch`, `id`), "
+               "  ADD INDEX "
+               "    `idx_artifact_type_id_last_update_time_since_epoch` "
+               "    (`type_id`, `last_update_time_since_epoch`, `id`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Execution` "
+               "  ADD INDEX "
+               "    `idx_execution_type_id_create_time_since_epoch` "
+               "    (`type_id`, `create_time_since_epoch`, `id`), "
+               "  ADD INDEX "
+               "    `idx_execution_type_id_last_update_time_since_epoch` "
+               "    (`type_id`, `last_update_time_since_epoch`, `id`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Context` "
+               "  ADD INDEX "
+               "    `idx_context_type_id_create_time_since_epoch` "
+               "    (`type_id`, `create_time_since_epoch`, `id`), "
+               "  ADD INDEX "
+               "    `idx_context_type_id_last_update_time_since_epoch` "
+               "    (`type_id`, `last_update_time_since_epoch`, `id`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Attribution` "
+               "  ADD INDEX "
+               "    `idx_attribution_artifact_id_context_id` "
+               "    (`artifact_id`, `context_id`); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `Association` "
+               "  ADD INDEX "
+               "    `idx_association_execution_id_context_id` "
+               "    (`execution_id`, `context_id`); "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 6 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Artifact' AND "
+                 "       `index_name` LIKE 'idx_artifact_type_id_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 6 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Execution' AND "
+                 "       `index_name` LIKE 'idx_execution_type_id_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 6 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Context' AND "
+                 "       `index_name` LIKE 'idx_context_type_id_%'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Attribution' AND "
+                 "       `index_name` = "
+                 "         'idx_attribution_artifact_id_context_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Association' AND "
+                 "       `index_name` = "
+                 "         'idx_association_execution_id_context_id'; "
+        }
+      }
+      db_verification { total_num_indexes: 96 total_num_tables: 15 }
+      # Downgrade from v11.
+      downgrade_queries {
+        query: " DROP TABLE IF EXISTS `ArtifactDerivation`; "
+      }
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'ArtifactDerivation'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v11, we added the ArtifactDerivation table of the derivations between
+  # the input and output artifacts of the executions, which is backfilled from
+  # the Event table.
+  migration_schemes {
+    key: 11
+    value: {
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `ArtifactDerivation` ( "
+               "   `upstream_artifact_id` INT NOT NULL, "
+               "   `downstream_artifact_id` INT NOT NULL, "
+               "   `execution_id` INT NOT NULL, "
+               "   PRIMARY KEY(`upstream_artifact_id`, "
+               "               `downstream_artifact_id`, `execution_id`) "
+               " ); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ArtifactDerivation` "
+               "  ADD INDEX "
+               "    `idx_artifact_derivation_downstream_artifact_id` "
+               "    (`downstream_artifact_id`, `upstream_artifact_id`), "
+               "  ADD INDEX "
+               "    `idx_artifact_derivation_execution_id` (`execution_id`); "
+      }
+      upgrade_queries {
+        query: " INSERT IGNORE INTO `ArtifactDerivation`( "
+               "   `upstream_artifact_id`, `downstream_artifact_id`, "
+               "   `execution_id` "
+               " ) "
+               " SELECT `I`.`artifact_id`, `O`.`artifact_id`, "
+               "        `I`.`execution_id` "
+               " FROM `Event` AS `I` JOIN `Event` AS `O` "
+               "   ON `O`.`execution_id` = `I`.`execution_id` "
+               " WHERE `I`.`type` IN (2, 3, 5) AND `O`.`type` IN (1, 4, 6) "
+               "   AND `O`.`artifact_id` != `I`.`artifact_id`; "
+      }
+      upgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `Event`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Event` "
+                 " (`artifact_id`, `execution_id`, `type`, "
+                 " `milliseconds_since_epoch`) "
+                 " VALUES (1, 1, 3, 1), (2, 1, 4, 1), (2, 2, 3, 1); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ArtifactDerivation`; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ArtifactDerivation` "
+                 " WHERE `upstream_artifact_id` = 1 AND "
+                 "       `downstream_artifact_id` = 2 AND "
+                 "       `execution_id` = 1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 3 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'ArtifactDerivation' AND "
+                 "       `index_name` LIKE 'idx_artifact_derivation_%'; "
+        }
+      }
+      db_verification { total_num_indexes: 102 total_num_tables: 16 }
+      # Downgrade from v12.
+      downgrade_queries { query: " DROP TABLE IF EXISTS `ChangeLog`; " }
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'ChangeLog'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v12, we added the ChangeLog table, which has an entry for each change of
+  # the nodes and the events. It starts empty, as the earlier changes are not
+  # known.
+  migration_schemes {
+    key: 12
+    value: {
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `ChangeLog` ( "
+               "   `id` BIGINT PRIMARY KEY AUTO_INCREMENT, "
+               "   `kind` TINYINT NOT NULL, "
+               "   `operation` TINYINT NOT NULL, "
+               "   `artifact_id` INT, "
+               "   `execution_id` INT, "
+               "   `context_id` INT, "
+               "   `milliseconds_since_epoch` BIGINT NOT NULL "
+               " ); "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `ChangeLog`; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'ChangeLog'; "
+        }
+      }
+      db_verification { total_num_indexes: 103 total_num_tables: 17 }
+      # Downgrade from v13. The paths are moved back to the EventPath table.
+      downgrade_queries {
+        query: " INSERT INTO `EventPath` "
+               " (`event_id`, `is_index_step`, `step_index`, `step_key`) "
+               " SELECT `E`.`id`, `S`.`step_index` IS NOT NULL, "
+               "        `S`.`step_index`, `S`.`step_key` "
+               " FROM `Event` AS `E`, JSON_TABLE(`E`.`path`, '$.steps[*]' "
+               "   COLUMNS (`step_ordinal` FOR ORDINALITY, "
+               "            `step_index` BIGINT PATH '$.index', "
+               "            `step_key` TEXT PATH '$.key')) AS `S` "
+               " WHERE `E`.`path` IS NOT NULL "
+               " ORDER BY `E`.`id`, `S`.`step_ordinal`; "
+      }
+      downgrade_queries { query: " ALTER TABLE `Event` DROP COLUMN `path`; " }
+      downgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `Event`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Event` "
+                 " (`artifact_id`, `execution_id`, `type`, "
+                 " `milliseconds_since_epoch`, `path`) "
+                 " VALUES (1, 1, 3, 1, "
+                 "   '{\"steps\":[{\"index\":\"1\"},{\"key\":\"a\"}]}'), "
+                 "        (2, 1, 4, 1, NULL); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `Event`; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `EventPath`; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `EventPath` AS `P` "
+                 " JOIN `Event` AS `E` ON `P`.`event_id` = `E`.`id` "
+                 " WHERE `E`.`artifact_id` = 1 AND `P`.`is_index_step` = 1 "
+                 "       AND `P`.`step_index` = 1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `EventPath` AS `P` "
+                 " JOIN `Event` AS `E` ON `P`.`event_id` = `E`.`id` "
+                 " WHERE `E`.`artifact_id` = 1 AND `P`.`is_index_step` = 0 "
+                 "       AND `P`.`step_key` = 'a'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`columns` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Event' AND `column_name` = 'path'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v13, we added the `path` column to the Event table, which stores the
+  # path of each event as JSON, so that an event is written and read as one
+  # row. The existing paths are moved from the EventPath table, which is kept
+  # for the downgrade.
+  migration_schemes {
+    key: 13
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `Event` ADD COLUMN `path` MEDIUMTEXT; "
+      }
+      upgrade_queries {
+        query: " UPDATE `Event` AS `E` JOIN ( "
+               "   SELECT `event_id`, "
+               "          JSON_OBJECT('steps', JSON_ARRAYAGG( "
+               "            IF(`is_index_step` = 1, "
+               "               JSON_OBJECT('index', `step_index`), "
+               "               JSON_OBJECT('key', `step_key`)))) AS `path` "
+               "   FROM `EventPath` GROUP BY `event_id` "
+               " ) AS `P` ON `P`.`event_id` = `E`.`id` "
+               " SET `E`.`path` = `P`.`path`; "
+      }
+      upgrade_queries { query: " DELETE FROM `EventPath`; " }
+      upgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `Event`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Event` "
+                 " (`artifact_id`, `execution_id`, `type`, "
+                 " `milliseconds_since_epoch`) "
+                 " VALUES (1, 1, 3, 1), (2, 1, 4, 1); "
+        }
+        previous_version_setup_queries { query: "DELETE FROM `EventPath`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `EventPath` "
+                 " (`event_id`, `is_index_step`, `step_index`, `step_key`) "
+                 " SELECT `id`, 1, 1, NULL FROM `Event` "
+                 " WHERE `artifact_id` = 1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Event` "
+                 " WHERE `artifact_id` = 1 AND "
+                 "       JSON_EXTRACT(`path`, '$.steps[0].index') = 1; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Event` "
+                 " WHERE `artifact_id` = 2 AND `path` IS NULL; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `EventPath`; "
+        }
+      }
+      db_verification { total_num_indexes: 103 total_num_tables: 17 }
+      # Downgrade from v14. The struct values in the `proto_value` column are
+      # moved back to the `string_value` column by the query executor, and the
+      # other proto values are deleted.
+      downgrade_queries {
+        query: " DELETE FROM `ArtifactProperty` WHERE `proto_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " DELETE FROM `ExecutionProperty` WHERE `proto_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " DELETE FROM `ContextProperty` WHERE `proto_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               " DROP COLUMN `proto_value`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               " DROP COLUMN `proto_value`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               " DROP COLUMN `proto_value`; "
+      }
+      downgrade_verification {
+        previous_version_setup_queries {
+          query: "DELETE FROM `ArtifactProperty`;"
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `ArtifactProperty` (`artifact_id`, `name`, "
+                 "     `is_custom_property`, `string_value`, `proto_value`) "
+                 " VALUES (1, 'p1', 0, 'abc', NULL), "
+                 "        (1, 'p2', 1, NULL, X'"
+                 "0A2A747970652E676F6F676C65617069732E636F"
+                 "6D2F676F6F676C652E70726F746F6275662E5374"
+                 "7275637412100A0E0A0161120911000000000000"
+                 "F03F'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `name` = 'p1' AND `string_value` = 'abc'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `name` = 'p2' AND `string_value` = "
+                 "       'mlmd-struct::Cg4KAWESCREAAAAAAADwPw=='; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`columns` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` IN ('ArtifactProperty', "
+                 "           'ExecutionProperty', 'ContextProperty') AND "
+                 "       `column_name` = 'proto_value'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v14, we added the `proto_value` column to the property tables, which
+  # stores the struct values and the proto values as serialized
+  # `google.protobuf.Any` messages. The struct values stored as base64 strings
+  # in `string_value` are moved to it by the query executor after the upgrade
+  # queries.
+  migration_schemes {
+    key: 14
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               " ADD COLUMN `proto_value` MEDIUMBLOB; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               " ADD COLUMN `proto_value` MEDIUMBLOB; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               " ADD COLUMN `proto_value` MEDIUMBLOB; "
+      }
+      upgrade_verification {
+        previous_version_setup_queries {
+          query: "DELETE FROM `ArtifactProperty`;"
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `ArtifactProperty` (`artifact_id`, `name`, "
+                 "     `is_custom_property`, `string_value`) "
+                 " VALUES (1, 'p1', 0, 'abc'), "
+                 "        (1, 'p2', 1, "
+                 "         'mlmd-struct::Cg4KAWESCREAAAAAAADwPw=='); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `name` = 'p1' AND `string_value` = 'abc' AND "
+                 "       `proto_value` IS NULL; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `name` = 'p2' AND `string_value` IS NULL AND "
+                 "       `proto_value` = X'"
+                 "0A2A747970652E676F6F676C65617069732E636F"
+                 "6D2F676F6F676C652E70726F746F6275662E5374"
+                 "7275637412100A0E0A0161120911000000000000"
+                 "F03F'; "
+        }
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               " DROP INDEX `idx_artifact_uri_hash`, "
+               " DROP COLUMN `uri_hash`; "
+      }
+      downgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `Artifact`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Artifact` (`type_id`, `uri`) "
+                 " VALUES (1, 'gs://bucket/a'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Artifact` "
+                 " WHERE `uri` = 'gs://bucket/a'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`columns` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Artifact' AND "
+                 "       `column_name` = 'uri_hash'; "
+        }
+      }
+      db_verification { total_num_indexes: 103 total_num_tables: 17 }
+    }
+  }
+)pb",
+R"pb(
+  # In v15, we added the `uri_hash` column to the Artifact table, which is the
+  # MD5 of the uri. `idx_artifact_uri` only indexes the first 255 characters
+  # of the uris, which often share long prefixes, so the artifacts are looked
+  # up by the index of their fixed-width hash instead. The column is virtual,
+  # so it is computed by the database, and only stored in its index.
+  migration_schemes {
+    key: 15
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `Artifact` "
+               " ADD COLUMN `uri_hash` BINARY(16) "
+               "     GENERATED ALWAYS AS (UNHEX(MD5(`uri`))) VIRTUAL, "
+               " ADD INDEX `idx_artifact_uri_hash`(`uri_hash`); "
+      }
+      upgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `Artifact`;" }
+        previous_version_setup_queries {
+          query: " INSERT INTO `Artifact` (`type_id`, `uri`) "
+                 " VALUES (1, 'gs://bucket/a'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Artifact` "
+                 " WHERE `uri_hash` = UNHEX(MD5('gs://bucket/a')); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 "
+                 " FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Artifact' AND "
+                 "       `index_name` = 'idx_artifact_uri_hash'; "
+        }
+      }
+      # The archived executions are moved back by the query executor before
+      # the downgrade queries.
+      downgrade_queries {
+        query: " INSERT INTO `Event`( "
+               "   `id`, `artifact_id`, `execution_id`, `type`, "
+               "   `milliseconds_since_epoch`, `path` "
+               " ) "
+               " SELECT `id`, `artifact_id`, `execution_id`, `type`, "
+               "        `milliseconds_since_epoch`, `path` "
+               " FROM `EventArchive`; "
+      }
+      downgrade_queries { query: " DROP TABLE IF EXISTS `EventArchive`; " }
+      downgrade_queries {
+        query: " DROP TABLE IF EXISTS `ExecutionArchive`; "
+      }
+      downgrade_verification {
+        previous_version_setup_queries { query: "DELETE FROM `Event`;" }
+        previous_version_setup_queries {
+          query: "DELETE FROM `EventArchive`;"
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `EventArchive` "
+                 " (`id`, `artifact_id`, `execution_id`, `type`) "
+                 " VALUES (1, 2, 3, 4); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `Event` "
+                 " WHERE `id` = 1 AND `artifact_id` = 2 AND "
+                 "       `execution_id` = 3 AND `type` = 4; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` IN ('ExecutionArchive', 'EventArchive'); "
+        }
+      }
+      db_verification { total_num_indexes: 104 total_num_tables: 17 }
+    }
+  }
+)pb",
+R"pb(
+  # In v16, we added the ExecutionArchive and EventArchive tables, to which the
+  # cold executions and their events are moved, so that the Execution,
+  # ExecutionProperty and Event tables, and their indexes, only keep the recent
+  # ones in the buffer pool. The archive tables are compressed, as they are
+  # rarely read.
+  migration_schemes {
+    key: 16
+    value: {
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `ExecutionArchive` ( "
+               "   `id` INTEGER PRIMARY KEY, "
+               "   `last_update_time_since_epoch` BIGINT NOT NULL, "
+               "   `execution` MEDIUMBLOB NOT NULL "
+               " ) ROW_FORMAT=COMPRESSED; "
+      }
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `EventArchive` ( "
+               "   `id` INTEGER PRIMARY KEY, "
+               "   `artifact_id` INT NOT NULL, "
+               "   `execution_id` INT NOT NULL, "
+               "   `type` INT NOT NULL, "
+               "   `milliseconds_since_epoch` BIGINT, "
+               "   `path` MEDIUMTEXT, "
+               "   INDEX `idx_event_archive_artifact_id` (`artifact_id`), "
+               "   INDEX `idx_event_archive_execution_id` (`execution_id`) "
+               " ) ROW_FORMAT=COMPRESSED; "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` IN ('ExecutionArchive', 'EventArchive') "
+                 "       AND `row_format` = 'Compressed'; "
+        }
+      }
+      db_verification { total_num_indexes: 108 total_num_tables: 19 }
+      # Downgrade from v17. The interned string values are moved back to the
+      # `string_value` column before the `string_value_id` column is dropped.
+      downgrade_queries {
+        query: " UPDATE `ArtifactProperty` SET `string_value` = ( "
+               "   SELECT `value` FROM `PropertyStringValue` "
+               "   WHERE `id` = `ArtifactProperty`.`string_value_id`) "
+               " WHERE `string_value_id` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " UPDATE `ExecutionProperty` SET `string_value` = ( "
+               "   SELECT `value` FROM `PropertyStringValue` "
+               "   WHERE `id` = `ExecutionProperty`.`string_value_id`) "
+               " WHERE `string_value_id` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " UPDATE `ContextProperty` SET `string_value` = ( "
+               "   SELECT `value` FROM `PropertyStringValue` "
+               "   WHERE `id` = `ContextProperty`.`string_value_id`) "
+               " WHERE `string_value_id` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` DROP COLUMN `string_value_id`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` DROP COLUMN `string_value_id`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ContextProperty` DROP COLUMN `string_value_id`; "
+      }
+      downgrade_queries {
+        query: " DROP TABLE IF EXISTS `PropertyStringValue`; "
+      }
+      downgrade_verification {
+        previous_version_setup_queries {
+          query: "DELETE FROM `ArtifactProperty`;"
+        }
+        previous_version_setup_queries {
+          query: "DELETE FROM `PropertyStringValue`;"
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `PropertyStringValue` (`id`, `value`) "
+                 " VALUES (1, 'abc'); "
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `ArtifactProperty` "
+                 " (`artifact_id`, `name`, `is_custom_property`, "
+                 "  `string_value_id`) "
+                 " VALUES (1, 'p1', 0, 1); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `name` = 'p1' AND `string_value` = 'abc'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`columns` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `column_name` = 'string_value_id'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'PropertyStringValue'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v17, we added the PropertyStringValue table, in which the repetitive
+  # string property values, e.g., the names of the pipelines and components,
+  # may be interned, and the `string_value_id` column to the property tables,
+  # which refers to the interned value instead of repeating it in the
+  # `string_value` column.
+  migration_schemes {
+    key: 17
+    value: {
+      upgrade_queries {
+        query: " CREATE TABLE IF NOT EXISTS `PropertyStringValue` ( "
+               "   `id` INT PRIMARY KEY AUTO_INCREMENT, "
+               "   `value` VARBINARY(255) NOT NULL, "
+               "   UNIQUE(`value`) "
+               " ); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` ADD COLUMN `string_value_id` INT; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` ADD COLUMN `string_value_id` INT; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ContextProperty` ADD COLUMN `string_value_id` INT; "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `information_schema`.`tables` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'PropertyStringValue'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 3 FROM `information_schema`.`columns` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `column_name` = 'string_value_id'; "
+        }
+      }
+      db_verification { total_num_indexes: 110 total_num_tables: 20 }
+      # Downgrade from v18.
+      downgrade_queries {
+        query: " ALTER TABLE `Execution` "
+               "  DROP INDEX `idx_execution_type_id_last_known_state`; "
+      }
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Execution' AND "
+                 "       `index_name` = "
+                 "         'idx_execution_type_id_last_known_state'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v18, we added an index on the executions by type and state, so that the
+  # active executions, i.e., the NEW and RUNNING ones, of a type are found
+  # without scanning the terminal ones. MySQL has no partial indexes, so that
+  # all the executions are indexed.
+  migration_schemes {
+    key: 18
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `Execution` "
+               "  ADD INDEX "
+               "    `idx_execution_type_id_last_known_state` "
+               "    (`type_id`, `last_known_state`, "
+               "     `last_update_time_since_epoch`, `id`); "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 4 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Execution' AND "
+                 "       `index_name` = "
+                 "         'idx_execution_type_id_last_known_state'; "
+        }
+      }
+      db_verification { total_num_indexes: 114 total_num_tables: 20 }
+      # Downgrade from v19.
+      downgrade_queries {
+        query: " ALTER TABLE `Event` "
+               "  DROP INDEX `idx_event_milliseconds_since_epoch`; "
+      }
+      downgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` = 'idx_event_milliseconds_since_epoch'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v19, we added an index on the events by time, so that the events
+  # recorded in a time range are read in the time order without scanning the
+  # Event table.
+  migration_schemes {
+    key: 19
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `Event` "
+               "  ADD INDEX `idx_event_milliseconds_since_epoch` "
+               "    (`milliseconds_since_epoch`, `id`); "
+      }
+      upgrade_verification {
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 2 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `table_name` = 'Event' AND "
+                 "       `index_name` = 'idx_event_milliseconds_since_epoch'; "
+        }
+      }
+      db_verification { total_num_indexes: 116 total_num_tables: 20 }
+      # Downgrade from v20. The compressed values are moved back to the
+      # `byte_value` column before the `compressed_value` column is dropped.
+      downgrade_queries {
+        query: " UPDATE `ArtifactProperty` "
+               " SET `byte_value` = `compressed_value` "
+               " WHERE `compressed_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " UPDATE `ExecutionProperty` "
+               " SET `byte_value` = `compressed_value` "
+               " WHERE `compressed_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " UPDATE `ContextProperty` "
+               " SET `byte_value` = `compressed_value` "
+               " WHERE `compressed_value` IS NOT NULL; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               "  DROP INDEX `idx_artifact_property_compressed`, "
+               "  DROP COLUMN `compressed_value`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               "  DROP INDEX `idx_execution_property_compressed`, "
+               "  DROP COLUMN `compressed_value`; "
+      }
+      downgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               "  DROP INDEX `idx_context_property_compressed`, "
+               "  DROP COLUMN `compressed_value`; "
+      }
+      downgrade_verification {
+        previous_version_setup_queries {
+          query: "DELETE FROM `ArtifactProperty`;"
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `ArtifactProperty` "
+                 " (`artifact_id`, `name`, `is_custom_property`, "
+                 "  `compressed_value`) "
+                 " VALUES (1, 'p1', 0, X'0A03616263'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `name` = 'p1' AND `byte_value` = X'0A03616263'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`columns` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `column_name` = 'compressed_value'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 0 FROM `information_schema`.`statistics` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `index_name` LIKE 'idx_%_property_compressed'; "
+        }
+      }
+    }
+  }
+)pb",
+R"pb(
+  # In v20, we added the `compressed_value` column to the property tables,
+  # which holds the compressed large values in place of their value columns,
+  # and the indices of the compressed values, so that the filters on the
+  # compressed properties are rejected rather than matching nothing.
+  migration_schemes {
+    key: 20
+    value: {
+      upgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               " ADD COLUMN `compressed_value` MEDIUMBLOB; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               " ADD COLUMN `compressed_value` MEDIUMBLOB; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               " ADD COLUMN `compressed_value` MEDIUMBLOB; "
+      }
+      # The values compressed in the `byte_value` column by v19 are moved.
+      upgrade_queries {
+        query: " UPDATE `ArtifactProperty` "
+               " SET `compressed_value` = `byte_value`, `byte_value` = NULL "
+               " WHERE `byte_value` IS NOT NULL; "
+      }
+      upgrade_queries {
+        query: " UPDATE `ExecutionProperty` "
+               " SET `compressed_value` = `byte_value`, `byte_value` = NULL "
+               " WHERE `byte_value` IS NOT NULL; "
+      }
+      upgrade_queries {
+        query: " UPDATE `ContextProperty` "
+               " SET `compressed_value` = `byte_value`, `byte_value` = NULL "
+               " WHERE `byte_value` IS NOT NULL; "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ArtifactProperty` "
+               "  ADD INDEX `idx_artifact_property_compressed`( "
+               "    `name`, `is_custom_property`, `compressed_value`(1)); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ExecutionProperty` "
+               "  ADD INDEX `idx_execution_property_compressed`( "
+               "    `name`, `is_custom_property`, `compressed_value`(1)); "
+      }
+      upgrade_queries {
+        query: " ALTER TABLE `ContextProperty` "
+               "  ADD INDEX `idx_context_property_compressed`( "
+               "    `name`, `is_custom_property`, `compressed_value`(1)); "
+      }
+      upgrade_verification {
+        previous_version_setup_queries {
+          query: "DELETE FROM `ArtifactProperty`;"
+        }
+        previous_version_setup_queries {
+          query: " INSERT INTO `ArtifactProperty` "
+                 " (`artifact_id`, `name`, `is_custom_property`, `byte_value`) "
+                 " VALUES (1, 'p1', 0, X'0A03616263'); "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 1 FROM `ArtifactProperty` "
+                 " WHERE `name` = 'p1' AND `byte_value` IS NULL AND "
+                 "       `compressed_value` = X'0A03616263'; "
+        }
+        post_migration_verification_queries {
+          query: " SELECT count(*) = 3 FROM `information_schema`.`columns` "
+                 " WHERE `table_schema` = (SELECT DATABASE()) AND "
+                 "       `column_name` = 'compressed_value'; "
+        }
+      }
+      db_verification { total_num_indexes: 125 total_num_tables: 20 }
+    }
+  }
+)pb");
+
+// The queries are written with backtick quoted identifiers like the other
+// configs, and PostgreSQLMetadataSource translates them to the PostgreSQL
+// dialect before running them (see TranslateQueryToPostgreSQL).
+// The write transactions are SERIALIZABLE, so that the queries need no locking
+// clauses: a conflicting transaction fails with a serialization failure, which
+// is returned as Aborted for the caller to retry.
+// PostgreSQL databases are always created at the current schema version, so
+// that no migration schemes are given.
+const std::string kPostgreSQLMetadataSourceQueryConfig = absl::StrCat(  // NOLINT
+R"pb(
+  metadata_source_type: POSTGRESQL_METADATA_SOURCE
+  # The dedicated partial index of an indexed property.
+  create_indexed_property_index {
+    query: " CREATE INDEX IF NOT EXISTS `$0` ON `$1`($2) "
+           " WHERE `name` = $3 AND `is_custom_property` = $4; "
+    parameter_num: 5
+  }
+  select_last_insert_id { query: " SELECT lastval(); " }
+  select_last_insert_id_range {
+    query: " SELECT lastval() - $0 + 1, lastval(); "
+    parameter_num: 1
+  }
+  # The conditional inserts record the inserted id, or an empty string if the
+  # row exists, in a transaction-local setting.
+  select_last_upsert_id {
+    query: " SELECT CAST(NULLIF(current_setting('mlmd.last_upsert_id', TRUE), "
+           "                    '') AS BIGINT), "
+           "        CASE WHEN current_setting('mlmd.last_upsert_id', TRUE) "
+           "                  <> '' THEN 1 ELSE 0 END; "
+  }
+  # The JSON array of ids is bound as a BIGINT array.
+  select_id_set {
+    query: " SELECT unnest(CAST(translate($0, '[]', '{}') AS BIGINT[])) "
+    parameter_num: 1
+  }
+  # The multi-row inserts return the assigned ids, which are used instead of
+  # select_last_insert_id_range.
+  insert_artifacts {
+    query: " INSERT INTO `Artifact`( "
+           "   `type_id`, `uri`, `state`, `name`, `create_time_since_epoch`, "
+           "   `last_update_time_since_epoch` "
+           ") VALUES $0 RETURNING `id`;"
+    parameter_num: 1
+  }
+  insert_executions {
+    query: " INSERT INTO `Execution`( "
+           "   `type_id`, `last_known_state`, `name`, "
+           "   `create_time_since_epoch`, `last_update_time_since_epoch` "
+           ") VALUES $0 RETURNING `id`;"
+    parameter_num: 1
+  }
+  insert_contexts {
+    query: " INSERT INTO `Context`( "
+           "   `type_id`, `name`, "
+           "   `create_time_since_epoch`, `last_update_time_since_epoch` "
+           ") VALUES $0 RETURNING `id`;"
+    parameter_num: 1
+  }
+  insert_types {
+    query: " INSERT INTO `Type`( "
+           "   `name`, `type_kind`, `version`, `description`, "
+           "   `input_type`, `output_type` "
+           ") VALUES $0 RETURNING `id`;"
+    parameter_num: 1
+  }
+  insert_events {
+    query: " INSERT INTO `Event`( "
+           "   `artifact_id`, `execution_id`, `type`, "
+           "   `milliseconds_since_epoch` "
+           ") VALUES $0 RETURNING `id`;"
+    parameter_num: 1
+  }
+  insert_events_with_path {
+    query: " INSERT INTO `Event`( "
+           "   `artifact_id`, `execution_id`, `type`, "
+           "   `milliseconds_since_epoch`, `path` "
+           ") VALUES $0 RETURNING `id`;"
+    parameter_num: 1
+  }
+  insert_artifact_if_not_exist {
+    query: " WITH `Inserted` AS ( "
+           "   INSERT INTO `Artifact`( "
+           "     `type_id`, `uri`, `state`, `name`, "
+           "     `create_time_since_epoch`, `last_update_time_since_epoch` "
+           "   ) VALUES($0, $1, $2, $3, $4, $5) "
+           "   ON CONFLICT(`type_id`, `name`) DO NOTHING RETURNING `id`) "
+           " SELECT set_config('mlmd.last_upsert_id', "
+           "     COALESCE((SELECT CAST(`id` AS TEXT) FROM `Inserted`), ''), "
+           "     TRUE); "
+    parameter_num: 6
+  }
+  insert_context_if_not_exist {
+    query: " WITH `Inserted` AS ( "
+           "   INSERT INTO `Context`( "
+           "     `type_id`, `name`, "
+           "     `create_time_since_epoch`, `last_update_time_since_epoch` "
+           "   ) VALUES($0, $1, $2, $3) "
+           "   ON CONFLICT(`type_id`, `name`) DO NOTHING RETURNING `id`) "
+           " SELECT set_config('mlmd.last_upsert_id', "
+           "     COALESCE((SELECT CAST(`id` AS TEXT) FROM `Inserted`), ''), "
+           "     TRUE); "
+    parameter_num: 4
+  }
+  insert_associations_if_not_exist {
+    query: " INSERT INTO `Association`( "
+           "   `context_id`, `execution_id` "
+           ") VALUES $0 ON CONFLICT DO NOTHING;"
+    parameter_num: 1
+  }
+  insert_attributions_if_not_exist {
+    query: " INSERT INTO `Attribution`( "
+           "   `context_id`, `artifact_id` "
+           ") VALUES $0 ON CONFLICT DO NOTHING;"
+    parameter_num: 1
+  }
+  insert_artifact_derivations {
+    query: " INSERT INTO `ArtifactDerivation`( "
+           "   `upstream_artifact_id`, `downstream_artifact_id`, "
+           "   `execution_id` "
+           " ) "
+           " SELECT `E`.`artifact_id`, `O`.`artifact_id`, `E`.`execution_id` "
+           " FROM `Event` AS `E` JOIN `Event` AS `O` "
+           "   ON `O`.`execution_id` = `E`.`execution_id` "
+           " WHERE `E`.`id` IN ($0) AND `E`.`type` IN (2, 3, 5) AND "
+           "       `O`.`type` IN (1, 4, 6) AND "
+           "       `O`.`artifact_id` != `E`.`artifact_id` "
+           " UNION ALL "
+           " SELECT `I`.`artifact_id`, `E`.`artifact_id`, `E`.`execution_id` "
+           " FROM `Event` AS `E` JOIN `Event` AS `I` "
+           "   ON `I`.`execution_id` = `E`.`execution_id` "
+           " WHERE `E`.`id` IN ($0) AND `E`.`type` IN (1, 4, 6) AND "
+           "       `I`.`type` IN (2, 3, 5) AND "
+           "       `I`.`artifact_id` != `E`.`artifact_id` "
+           " ON CONFLICT DO NOTHING; "
+    parameter_num: 1
+  }
+)pb",
+R"pb(
+  create_type_table {
+    query: " CREATE TABLE IF NOT EXISTS `Type` ( "
+           "   `id` BIGINT GENERATED BY DEFAULT AS IDENTITY PRIMARY KEY, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `version` VARCHAR(255), "
+           "   `type_kind` SMALLINT NOT NULL, "
+           "   `description` TEXT, "
+           "   `input_type` TEXT, "
+           "   `output_type` TEXT"
+           " ); "
+  }
+  create_parent_type_table {
+    query: " CREATE TABLE IF NOT EXISTS `ParentType` ( "
+           "   `type_id` BIGINT NOT NULL, "
+           "   `parent_type_id` BIGINT NOT NULL, "
+           " PRIMARY KEY (`type_id`, `parent_type_id`)); "
+  }
+  create_type_property_table {
+    query: " CREATE TABLE IF NOT EXISTS `TypeProperty` ( "
+           "   `type_id` BIGINT NOT NULL, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `data_type` INT NULL, "
+           " PRIMARY KEY (`type_id`, `name`)); "
+  }
+  create_artifact_table {
+    query: " CREATE TABLE IF NOT EXISTS `Artifact` ( "
+           "   `id` BIGINT GENERATED BY DEFAULT AS IDENTITY PRIMARY KEY, "
+           "   `type_id` BIGINT NOT NULL, "
+           "   `uri` TEXT, "
+           "   `state` INT, "
+           "   `name` VARCHAR(255), "
+           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   UNIQUE(`type_id`, `name`) "
+           " ); "
+  }
+  create_artifact_property_table {
+    query: " CREATE TABLE IF NOT EXISTS `ArtifactProperty` ( "
+           "   `artifact_id` BIGINT NOT NULL, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `is_custom_property` SMALLINT NOT NULL, "
+           "   `int_value` BIGINT, "
+           "   `double_value` DOUBLE PRECISION, "
+           "   `string_value` TEXT, "
+           "   `byte_value` BYTEA, "
+           "   `proto_value` BYTEA, "
+           "   `string_value_id` BIGINT, "
+           "   `compressed_value` BYTEA, "
+           " PRIMARY KEY (`artifact_id`, `name`, `is_custom_property`)); "
+  }
+  create_execution_table {
+    query: " CREATE TABLE IF NOT EXISTS `Execution` ( "
+           "   `id` BIGINT GENERATED BY DEFAULT AS IDENTITY PRIMARY KEY, "
+           "   `type_id` BIGINT NOT NULL, "
+           "   `last_known_state` INT, "
+           "   `name` VARCHAR(255), "
+           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   UNIQUE(`type_id`, `name`) "
+           " ); "
+  }
+  create_execution_property_table {
+    query: " CREATE TABLE IF NOT EXISTS `ExecutionProperty` ( "
+           "   `execution_id` BIGINT NOT NULL, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `is_custom_property` SMALLINT NOT NULL, "
+           "   `int_value` BIGINT, "
+           "   `double_value` DOUBLE PRECISION, "
+           "   `string_value` TEXT, "
+           "   `byte_value` BYTEA, "
+           "   `proto_value` BYTEA, "
+           "   `string_value_id` BIGINT, "
+           "   `compressed_value` BYTEA, "
+           " PRIMARY KEY (`execution_id`, `name`, `is_custom_property`)); "
+  }
+  create_context_table {
+    query: " CREATE TABLE IF NOT EXISTS `Context` ( "
+           "   `id` BIGINT GENERATED BY DEFAULT AS IDENTITY PRIMARY KEY, "
+           "   `type_id` BIGINT NOT NULL, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `create_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   `last_update_time_since_epoch` BIGINT NOT NULL DEFAULT 0, "
+           "   UNIQUE(`type_id`, `name`) "
+           " ); "
+  }
+  create_context_property_table {
+    query: " CREATE TABLE IF NOT EXISTS `ContextProperty` ( "
+           "   `context_id` BIGINT NOT NULL, "
+           "   `name` VARCHAR(255) NOT NULL, "
+           "   `is_custom_property` SMALLINT NOT NULL, "
+           "   `int_value` BIGINT, "
+           "   `double_value` DOUBLE PRECISION, "
+           "   `string_value` TEXT, "
+           "   `byte_value` BYTEA, "
+           "   `proto_value` BYTEA, "
+           "   `string_value_id` BIGINT, "
+           "   `compressed_value` BYTEA, "
+           " PRIMARY KEY (`context_id`, `name`, `is_custom_property`)); "
+  }
+  create_parent_context_table {
+    query: " CREATE TABLE IF NOT EXISTS `ParentContext` ( "
+           "   `context_id` BIGINT NOT NULL, "
+           "   `parent_context_id` BIGINT NOT NULL, "
+           " PRIMARY KEY (`context_id`, `parent_context_id`)); "
+  }
+)pb",
+R"pb(
+  create_event_table {
+    query: " CREATE TABLE IF NOT EXISTS `Event` ( "
+           "   `id` BIGINT GENERATED BY DEFAULT AS IDENTITY PRIMARY KEY, "
+           "   `artifact_id` BIGINT NOT NULL, "
+           "   `execution_id` BIGINT NOT NULL, "
+           "   `type` INT NOT NULL, "
+           "   `milliseconds_since_epoch` BIGINT, "
+           "   `path` TEXT, "
+           "   UNIQUE(`artifact_id`, `execution_id`, `type`) "
+           " ); "
+  }
+  create_event_path_table {
+    query: " CREATE TABLE IF NOT EXISTS `EventPath` ( "
+           "   `event_id` BIGINT NOT NULL, "
+           "   `is_index_step` SMALLINT NOT NULL, "
+           "   `step_index` INT, "
+           "   `step_key` TEXT "
+           " ); "
+  }
+  create_artifact_derivation_table {
+    query: " CREATE TABLE IF NOT EXISTS `ArtifactDerivation` ( "
+           "   `upstream_artifact_id` BIGINT NOT NULL, "
+           "   `downstream_artifact_id` BIGINT NOT NULL, "
+           "   `execution_id` BIGINT NOT NULL, "
+           "   PRIMARY KEY(`upstream_artifact_id`, `downstream_artifact_id`, "
+           "               `execution_id`) "
+           " ); "
+  }
+  create_change_log_table {
+    query: " CREATE TABLE IF NOT EXISTS `ChangeLog` ( "
+           "   `id` BIGINT GENERATED BY DEFAULT AS IDENTITY PRIMARY KEY, "
+           "   `kind` SMALLINT NOT NULL, "
+           "   `operation` SMALLINT NOT NULL, "
+           "   `artifact_id` BIGINT, "
+           "   `execution_id` BIGINT, "
+           "   `context_id` BIGINT, "
+           "   `milliseconds_since_epoch` BIGINT NOT NULL "
+           " ); "
+  }
+  create_association_table {
+    query: " CREATE TABLE IF NOT EXISTS `Association` ( "
+           "   `id` BIGINT GENERATED BY DEFAULT AS IDENTITY PRIMARY KEY, "
+           "   `context_id` BIGINT NOT NULL, "
+           "   `execution_id` BIGINT NOT NULL, "
+           "   UNIQUE(`context_id`, `execution_id`) "
+           " ); "
+  }
+  create_attribution_table {
+    query: " CREATE TABLE IF NOT EXISTS `Attribution` ( "
+           "   `id` BIGINT GENERATED BY DEFAULT AS IDENTITY PRIMARY KEY, "
+           "   `context_id` BIGINT NOT NULL, "
+           "   `artifact_id` BIGINT NOT NULL, "
+           "   UNIQUE(`context_id`, `artifact_id`) "
+           " ); "
+  }
+  create_mlmd_env_table {
+    query: " CREATE TABLE IF NOT EXISTS `MLMDEnv` ( "
+           "   `schema_version` INT PRIMARY KEY, "
+           "   `type_generation` BIGINT NOT NULL DEFAULT 0 "
+           " ); "
+  }
+  create_migration_checkpoint_table {
+    query: " CREATE TABLE IF NOT EXISTS `MLMDMigration` ( "
+           "   `to_version` INT PRIMARY KEY, "
+           "   `table_index` INT NOT NULL, "
+           "   `last_id` BIGINT NOT NULL "
+           " ); "
+  }
+  # The archived executions larger than 2kB are compressed by TOAST.
+  create_execution_archive_table {
+    query: " CREATE TABLE IF NOT EXISTS `ExecutionArchive` ( "
+           "   `id` BIGINT PRIMARY KEY, "
+           "   `last_update_time_since_epoch` BIGINT NOT NULL, "
+           "   `execution` BYTEA NOT NULL "
+           " ); "
+  }
+  create_event_archive_table {
+    query: " CREATE TABLE IF NOT EXISTS `EventArchive` ( "
+           "   `id` BIGINT PRIMARY KEY, "
+           "   `artifact_id` BIGINT NOT NULL, "
+           "   `execution_id` BIGINT NOT NULL, "
+           "   `type` INT NOT NULL, "
+           "   `milliseconds_since_epoch` BIGINT, "
+           "   `path` TEXT "
+           " ); "
+  }
+  create_property_string_value_table {
+    query: " CREATE TABLE IF NOT EXISTS `PropertyStringValue` ( "
+           "   `id` BIGINT GENERATED BY DEFAULT AS IDENTITY PRIMARY KEY, "
+           "   `value` TEXT NOT NULL, "
+           "   UNIQUE(`value`) "
+           " ); "
+  }
+  insert_property_string_values {
+    query: " INSERT INTO `PropertyStringValue`(`value`) VALUES $0 "
+           " ON CONFLICT DO NOTHING; "
+    parameter_num: 1
+  }
+)pb",
+R"pb(
+  # secondary indices in the current schema.
+  # The uri and the string property values may be longer than a btree index
+  # entry allows, so that the uri has a hash index for the equality lookups,
+  # and the string values are not indexed.
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_artifact_uri` "
+           " ON `Artifact` USING HASH (`uri`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_create_time_since_epoch` "
+           " ON `Artifact`(`create_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_last_update_time_since_epoch` "
+           " ON `Artifact`(`last_update_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_event_execution_id` "
+           " ON `Event`(`execution_id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_parentcontext_parent_context_id` "
+           " ON `ParentContext`(`parent_context_id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_type_name` "
+           " ON `Type`(`name`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_execution_create_time_since_epoch` "
+           " ON `Execution`(`create_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_execution_last_update_time_since_epoch` "
+           " ON `Execution`(`last_update_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_context_create_time_since_epoch` "
+           " ON `Context`(`create_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_context_last_update_time_since_epoch` "
+           " ON `Context`(`last_update_time_since_epoch`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_eventpath_event_id` "
+           " ON `EventPath`(`event_id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_artifact_property_int` "
+           " ON `ArtifactProperty`(`name`, `is_custom_property`, `int_value`) "
+           " WHERE `int_value` IS NOT NULL; "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_artifact_property_double` "
+           " ON `ArtifactProperty`(`name`, `is_custom_property`, `double_value`) "
+           " WHERE `double_value` IS NOT NULL; "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_execution_property_int` "
+           " ON `ExecutionProperty`(`name`, `is_custom_property`, `int_value`) "
+           " WHERE `int_value` IS NOT NULL; "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_execution_property_double` "
+           " ON `ExecutionProperty`(`name`, `is_custom_property`, `double_value`) "
+           " WHERE `double_value` IS NOT NULL; "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_context_property_int` "
+           " ON `ContextProperty`(`name`, `is_custom_property`, `int_value`) "
+           " WHERE `int_value` IS NOT NULL; "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_context_property_double` "
+           " ON `ContextProperty`(`name`, `is_custom_property`, `double_value`) "
+           " WHERE `double_value` IS NOT NULL; "
+  }
+  # Only the compressed values are indexed, which are looked up to reject the
+  # filters on their properties.
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_artifact_property_compressed` "
+           " ON `ArtifactProperty`(`name`, `is_custom_property`) "
+           " WHERE `compressed_value` IS NOT NULL; "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_execution_property_compressed` "
+           " ON `ExecutionProperty`(`name`, `is_custom_property`) "
+           " WHERE `compressed_value` IS NOT NULL; "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_context_property_compressed` "
+           " ON `ContextProperty`(`name`, `is_custom_property`) "
+           " WHERE `compressed_value` IS NOT NULL; "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_type_id_create_time_since_epoch` "
+           " ON `Artifact`(`type_id`, `create_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_type_id_last_update_time_since_epoch` "
+           " ON `Artifact`( "
+           "   `type_id`, `last_update_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_execution_type_id_create_time_since_epoch` "
+           " ON `Execution`(`type_id`, `create_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_execution_type_id_last_update_time_since_epoch` "
+           " ON `Execution`( "
+           "   `type_id`, `last_update_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_context_type_id_create_time_since_epoch` "
+           " ON `Context`(`type_id`, `create_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_context_type_id_last_update_time_since_epoch` "
+           " ON `Context`( "
+           "   `type_id`, `last_update_time_since_epoch`, `id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_attribution_artifact_id_context_id` "
+           " ON `Attribution`(`artifact_id`, `context_id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_association_execution_id_context_id` "
+           " ON `Association`(`execution_id`, `context_id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_derivation_downstream_artifact_id` "
+           " ON `ArtifactDerivation`( "
+           "   `downstream_artifact_id`, `upstream_artifact_id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_artifact_derivation_execution_id` "
+           " ON `ArtifactDerivation`(`execution_id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_event_archive_artifact_id` "
+           " ON `EventArchive`(`artifact_id`); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_event_archive_execution_id` "
+           " ON `EventArchive`(`execution_id`); "
+  }
+  # Only the active executions, i.e., NEW or RUNNING, are indexed, which are
+  # few compared to the terminal ones.
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS "
+           "   `idx_execution_type_id_last_known_state` "
+           " ON `Execution`( "
+           "   `type_id`, `last_known_state`, "
+           "   `last_update_time_since_epoch`, `id`) "
+           " WHERE `last_known_state` IN (1, 2); "
+  }
+  secondary_indices {
+    query: " CREATE INDEX IF NOT EXISTS `idx_event_milliseconds_since_epoch` "
+           " ON `Event`(`milliseconds_since_epoch`, `id`); "
   }
 )pb");
 
@@ -3538,6 +7585,25 @@ MetadataSourceQueryConfig GetSqliteMetadataSourceQueryConfig() {
   return config;
 }
 
+MetadataSourceQueryConfig GetPostgreSQLMetadataSourceQueryConfig() {
+  MetadataSourceQueryConfig config;
+  CHECK(google::protobuf::TextFormat::ParseFromString(kBaseQueryConfig, &config));
+  MetadataSourceQueryConfig postgresql_config;
+  CHECK(google::protobuf::TextFormat::ParseFromString(
+      kPostgreSQLMetadataSourceQueryConfig, &postgresql_config));
+  config.MergeFrom(postgresql_config);
+  return config;
+}
+
+MetadataSourceQueryConfig GetInMemoryMetadataSourceQueryConfig() {
+  MetadataSourceQueryConfig base_config;
+  CHECK(google::protobuf::TextFormat::ParseFromString(kBaseQueryConfig, &base_config));
+  MetadataSourceQueryConfig config;
+  config.set_metadata_source_type(IN_MEMORY_METADATA_SOURCE);
+  config.set_schema_version(base_config.schema_version());
+  return config;
+}
+
 
 }  // namespace util
 }  // namespace ml_metadata
@@ -26,9 +26,16 @@ MetadataSourceQueryConfig GetMySqlMetadataSourceQueryConfig();
 // Gets the MetadataSourceQueryConfig for SQLiteMetadataSource.
 MetadataSourceQueryConfig GetSqliteMetadataSourceQueryConfig();
 
+// Gets the MetadataSourceQueryConfig for PostgreSQLMetadataSource.
+MetadataSourceQueryConfig GetPostgreSQLMetadataSourceQueryConfig();
+
 // Gets the MetadataSourceQueryConfig for FakeMetadataSource.
 MetadataSourceQueryConfig GetFakeMetadataSourceQueryConfig();
 
+// Gets the MetadataSourceQueryConfig for InMemoryMetadataSource. It has no
+// template queries, and only names the source type and the schema version.
+MetadataSourceQueryConfig GetInMemoryMetadataSourceQueryConfig();
+
 
 }  // namespace util
 }  // namespace ml_metadata
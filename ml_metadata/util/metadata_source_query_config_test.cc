@@ -30,6 +30,15 @@ TEST(MetadataSourceQueryConfig, GetSqliteMetadataSourceQueryConfig) {
   EXPECT_EQ(config.metadata_source_type(), SQLITE_METADATA_SOURCE);
 }
 
+TEST(MetadataSourceQueryConfig, GetPostgreSQLMetadataSourceQueryConfig) {
+  const MetadataSourceQueryConfig config =
+      GetPostgreSQLMetadataSourceQueryConfig();
+  EXPECT_EQ(config.metadata_source_type(), POSTGRESQL_METADATA_SOURCE);
+  EXPECT_EQ(config.schema_version(),
+            GetSqliteMetadataSourceQueryConfig().schema_version());
+  EXPECT_TRUE(config.migration_schemes().empty());
+}
+
 
 }  // namespace
 }  // namespace util
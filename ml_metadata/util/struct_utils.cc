@@ -25,8 +25,8 @@ limitations under the License.
 namespace ml_metadata {
 namespace {
 
-// TODO(b/178235219): Remove this once we migrate to schema v7 and add a column
-// for storing serialized `Struct` values.
+// Since schema v14, the `Struct` values are stored in the `proto_value` column,
+// and the prefix is only used by the earlier schemas and their migrations.
 constexpr char kSerializedStructPrefix[] = "mlmd-struct::";
 
 }
@@ -15,8 +15,28 @@
 """ML METADATA Data Validation external dependencies that can be loaded in WORKSPACE files.
 """
 
+load("@bazel_tools//tools/build_defs/repo:http.bzl", "http_archive")
 load("//ml_metadata:mysql_configure.bzl", "mysql_configure")
 
 def ml_metadata_workspace():
     """All ML Metadata external dependencies."""
     mysql_configure()
+
+    # The PostgreSQL client library installed on the host, e.g., by the
+    # libpq-dev package.
+    if "libpq" not in native.existing_rules():
+        native.new_local_repository(
+            name = "libpq",
+            path = "/usr",
+            build_file = "//ml_metadata:libpq.BUILD",
+        )
+
+    # For the benchmarks of the metadata store.
+    if "com_github_google_benchmark" not in native.existing_rules():
+        http_archive(
+            name = "com_github_google_benchmark",
+            strip_prefix = "benchmark-1.5.5",
+            urls = [
+                "https://github.com/google/benchmark/archive/refs/tags/v1.5.5.tar.gz",
+            ],
+        )